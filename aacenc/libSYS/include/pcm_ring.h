@@ -0,0 +1,189 @@
+
+/* -----------------------------------------------------------------------------------------------------------
+Software License for The Fraunhofer FDK AAC Codec Library for Android
+
+ Copyright  1995 - 2012 Fraunhofer-Gesellschaft zur Frderung der angewandten Forschung e.V.
+  All rights reserved.
+
+ 1.    INTRODUCTION
+The Fraunhofer FDK AAC Codec Library for Android ("FDK AAC Codec") is software that implements
+the MPEG Advanced Audio Coding ("AAC") encoding and decoding scheme for digital audio.
+This FDK AAC Codec software is intended to be used on a wide variety of Android devices.
+
+AAC's HE-AAC and HE-AAC v2 versions are regarded as today's most efficient general perceptual
+audio codecs. AAC-ELD is considered the best-performing full-bandwidth communications codec by
+independent studies and is widely deployed. AAC has been standardized by ISO and IEC as part
+of the MPEG specifications.
+
+Patent licenses for necessary patent claims for the FDK AAC Codec (including those of Fraunhofer)
+may be obtained through Via Licensing (www.vialicensing.com) or through the respective patent owners
+individually for the purpose of encoding or decoding bit streams in products that are compliant with
+the ISO/IEC MPEG audio standards. Please note that most manufacturers of Android devices already license
+these patent claims through Via Licensing or directly from the patent owners, and therefore FDK AAC Codec
+software may already be covered under those patent licenses when it is used for those licensed purposes only.
+
+Commercially-licensed AAC software libraries, including floating-point versions with enhanced sound quality,
+are also available from Fraunhofer. Users are encouraged to check the Fraunhofer website for additional
+applications information and documentation.
+
+2.    COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification, are permitted without
+payment of copyright license fees provided that you satisfy the following conditions:
+
+You must retain the complete text of this software license in redistributions of the FDK AAC Codec or
+your modifications thereto in source code form.
+
+You must retain the complete text of this software license in the documentation and/or other materials
+provided with redistributions of the FDK AAC Codec or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of the FDK AAC Codec and your
+modifications thereto to recipients of copies in binary form.
+
+The name of Fraunhofer may not be used to endorse or promote products derived from this library without
+prior written permission.
+
+You may not charge copyright license fees for anyone to use, copy or distribute the FDK AAC Codec
+software or your modifications thereto.
+
+Your modified versions of the FDK AAC Codec must carry prominent notices stating that you changed the software
+and the date of any change. For modified versions of the FDK AAC Codec, the term
+"Fraunhofer FDK AAC Codec Library for Android" must be replaced by the term
+"Third-Party Modified Version of the Fraunhofer FDK AAC Codec Library for Android."
+
+3.    NO PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without limitation the patents of Fraunhofer,
+ARE GRANTED BY THIS SOFTWARE LICENSE. Fraunhofer provides no warranty of patent non-infringement with
+respect to this software.
+
+You may use this FDK AAC Codec software or modifications thereto only for purposes that are authorized
+by appropriate patent licenses.
+
+4.    DISCLAIMER
+
+This FDK AAC Codec software is provided by Fraunhofer on behalf of the copyright holders and contributors
+"AS IS" and WITHOUT ANY EXPRESS OR IMPLIED WARRANTIES, including but not limited to the implied warranties
+of merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE for any direct, indirect, incidental, special, exemplary, or consequential damages,
+including but not limited to procurement of substitute goods or services; loss of use, data, or profits,
+or business interruption, however caused and on any theory of liability, whether in contract, strict
+liability, or tort (including negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5.    CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Audio and Multimedia Departments - FDK AAC LL
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+----------------------------------------------------------------------------------------------------------- */
+
+/**************************  Fraunhofer IIS FDK SysLib  **********************
+
+   Author(s):
+   Description: lock-free PCM ring buffer
+
+******************************************************************************/
+
+/** \file   pcm_ring.h
+ *  \brief  Streaming PCM input through a lock-free ring buffer.
+ *
+ *  The ring is an alternative to the WAVE file reader for live input: a
+ *  capture thread writes interleaved samples as they arrive, and the encoder
+ *  thread reads them in frames of the encoder's input granule, e.g. the
+ *  frameLength reported by aacEncInfo() times the number of channels.
+ *  There must be a single writer thread and a single reader thread; neither
+ *  ever blocks. Waiting for data, if needed, is up to the application.
+ */
+
+#ifndef __PCM_RING_H__
+#define __PCM_RING_H__
+
+
+
+#include "genericStds.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct PCM_RING *HANDLE_PCM_RING;
+
+/**
+ * \brief  Create a PCM ring buffer.
+ *
+ * \param pRing        Pointer to store the ring handle.
+ * \param numChannels  Number of interleaved channels.
+ * \param frameLength  Samples per channel of one frame, as read by PCM_RingRead().
+ * \param numFrames    Minimum number of frames the ring can hold.
+ *
+ * \return  0 on success and non-zero on failure.
+ */
+INT PCM_RingOpen (HANDLE_PCM_RING *pRing, UINT numChannels, UINT frameLength, UINT numFrames);
+
+/**
+ * \brief  Write interleaved samples into the ring, from the capture thread.
+ *         Only whole sample groups of all channels are written. Samples that
+ *         do not fit are dropped and counted, see PCM_RingOverruns().
+ *
+ * \param ring        Handle of the ring.
+ * \param samples     Interleaved samples.
+ * \param numSamples  Number of samples (of all channels) in samples.
+ *
+ * \return  Number of samples written.
+ */
+UINT PCM_RingWrite (HANDLE_PCM_RING ring, const INT_PCM *samples, UINT numSamples);
+
+/**
+ * \brief  Signal the end of the stream, from the capture thread. No samples
+ *         may be written afterwards.
+ *
+ * \param ring  Handle of the ring.
+ */
+void PCM_RingEndOfStream (HANDLE_PCM_RING ring);
+
+/**
+ * \brief  Read one frame of interleaved samples, from the encoder thread.
+ *
+ * \param ring    Handle of the ring.
+ * \param buffer  Buffer for numChannels * frameLength samples.
+ *
+ * \return  numChannels * frameLength if a frame was read, 0 if no complete
+ *          frame is available yet and -1 once the stream has ended and all
+ *          samples were read. After the end of the stream, the last frame may
+ *          be shorter, like the last read of WAV_InputRead().
+ */
+INT PCM_RingRead (HANDLE_PCM_RING ring, INT_PCM *buffer);
+
+/**
+ * \brief  Number of complete frames that PCM_RingRead() can read now.
+ *
+ * \param ring  Handle of the ring.
+ * \return      Number of frames.
+ */
+UINT PCM_RingFrames (HANDLE_PCM_RING ring);
+
+/**
+ * \brief  Number of samples dropped by PCM_RingWrite() because the ring was full.
+ *
+ * \param ring  Handle of the ring.
+ * \return      Number of samples.
+ */
+UINT PCM_RingOverruns (HANDLE_PCM_RING ring);
+
+/**
+ * \brief  Free a PCM ring buffer. Neither thread may use it any more.
+ *
+ * \param pRing  Pointer to the ring handle.
+ */
+void PCM_RingClose (HANDLE_PCM_RING *pRing);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* __PCM_RING_H__ */
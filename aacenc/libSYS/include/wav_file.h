@@ -136,6 +136,12 @@ struct WAV
 {
   WAV_HEADER header;
   FDKFILE *fp;
+  UCHAR *readBuf;      /*!< Raw samples read at once before conversion. */
+  const UCHAR *map;    /*!< Data chunk mapped by WAV_InputMap(), or NULL. */
+  UINT mapSize;        /*!< Bytes of data chunk in map. */
+  UINT mapPos;         /*!< Bytes of map already read. */
+  void *mapBase;       /*!< Mapping as returned by the OS, for unmapping. */
+  UINT mapLength;      /*!< Bytes of the mapping. */
 };
 
 typedef struct WAV *HANDLE_WAV;
@@ -164,6 +170,19 @@ INT WAV_InputOpen (HANDLE_WAV *pWav, const char *filename);
  */
 INT WAV_InputRead (HANDLE_WAV wav, void *sampleBuffer, UINT numSamples, int nBufBits);
 
+/**
+ * \brief  Read the data chunk of a WAV file from a memory mapping instead of
+ *         the file stream. Samples are converted straight from the mapping,
+ *         and reading stops at the end of the data chunk. Call it right after
+ *         WAV_InputOpen().
+ *
+ * \param wav  Handle of WAV file.
+ *
+ * \return  0 on success, non-zero if the file cannot be mapped, in which case
+ *          WAV_InputRead() keeps reading from the file stream.
+ */
+INT WAV_InputMap (HANDLE_WAV wav);
+
 /**
  * \brief       Close a WAV file reading handle.
  * \param pWav  Pointer to a WAV file reading handle.
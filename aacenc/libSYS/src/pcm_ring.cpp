@@ -0,0 +1,263 @@
+
+/* -----------------------------------------------------------------------------------------------------------
+Software License for The Fraunhofer FDK AAC Codec Library for Android
+
+ Copyright  1995 - 2012 Fraunhofer-Gesellschaft zur Frderung der angewandten Forschung e.V.
+  All rights reserved.
+
+ 1.    INTRODUCTION
+The Fraunhofer FDK AAC Codec Library for Android ("FDK AAC Codec") is software that implements
+the MPEG Advanced Audio Coding ("AAC") encoding and decoding scheme for digital audio.
+This FDK AAC Codec software is intended to be used on a wide variety of Android devices.
+
+AAC's HE-AAC and HE-AAC v2 versions are regarded as today's most efficient general perceptual
+audio codecs. AAC-ELD is considered the best-performing full-bandwidth communications codec by
+independent studies and is widely deployed. AAC has been standardized by ISO and IEC as part
+of the MPEG specifications.
+
+Patent licenses for necessary patent claims for the FDK AAC Codec (including those of Fraunhofer)
+may be obtained through Via Licensing (www.vialicensing.com) or through the respective patent owners
+individually for the purpose of encoding or decoding bit streams in products that are compliant with
+the ISO/IEC MPEG audio standards. Please note that most manufacturers of Android devices already license
+these patent claims through Via Licensing or directly from the patent owners, and therefore FDK AAC Codec
+software may already be covered under those patent licenses when it is used for those licensed purposes only.
+
+Commercially-licensed AAC software libraries, including floating-point versions with enhanced sound quality,
+are also available from Fraunhofer. Users are encouraged to check the Fraunhofer website for additional
+applications information and documentation.
+
+2.    COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification, are permitted without
+payment of copyright license fees provided that you satisfy the following conditions:
+
+You must retain the complete text of this software license in redistributions of the FDK AAC Codec or
+your modifications thereto in source code form.
+
+You must retain the complete text of this software license in the documentation and/or other materials
+provided with redistributions of the FDK AAC Codec or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of the FDK AAC Codec and your
+modifications thereto to recipients of copies in binary form.
+
+The name of Fraunhofer may not be used to endorse or promote products derived from this library without
+prior written permission.
+
+You may not charge copyright license fees for anyone to use, copy or distribute the FDK AAC Codec
+software or your modifications thereto.
+
+Your modified versions of the FDK AAC Codec must carry prominent notices stating that you changed the software
+and the date of any change. For modified versions of the FDK AAC Codec, the term
+"Fraunhofer FDK AAC Codec Library for Android" must be replaced by the term
+"Third-Party Modified Version of the Fraunhofer FDK AAC Codec Library for Android."
+
+3.    NO PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without limitation the patents of Fraunhofer,
+ARE GRANTED BY THIS SOFTWARE LICENSE. Fraunhofer provides no warranty of patent non-infringement with
+respect to this software.
+
+You may use this FDK AAC Codec software or modifications thereto only for purposes that are authorized
+by appropriate patent licenses.
+
+4.    DISCLAIMER
+
+This FDK AAC Codec software is provided by Fraunhofer on behalf of the copyright holders and contributors
+"AS IS" and WITHOUT ANY EXPRESS OR IMPLIED WARRANTIES, including but not limited to the implied warranties
+of merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE for any direct, indirect, incidental, special, exemplary, or consequential damages,
+including but not limited to procurement of substitute goods or services; loss of use, data, or profits,
+or business interruption, however caused and on any theory of liability, whether in contract, strict
+liability, or tort (including negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5.    CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Audio and Multimedia Departments - FDK AAC LL
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+----------------------------------------------------------------------------------------------------------- */
+
+/**************************  Fraunhofer IIS FDK SysLib  **********************
+
+   Author(s):
+   Description: lock-free PCM ring buffer
+
+******************************************************************************/
+
+#include "pcm_ring.h"
+#include "genericStds.h"
+
+/*
+ * Single producer, single consumer ring. Both positions run freely and wrap
+ * at 2^32; the size is a power of two, so that (pos & mask) stays correct
+ * across the wrap and (writePos - readPos) is the fill level. Each position is
+ * stored only by its own thread, with release semantics after the samples are
+ * copied, and loaded by the other thread with acquire semantics.
+ */
+
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+#define PCM_LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define PCM_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#elif defined(__GNUC__)
+static inline UINT PCM_loadAcquire(volatile UINT *p) { UINT v = *p; __sync_synchronize(); return v; }
+#define PCM_LOAD_ACQUIRE(p)     PCM_loadAcquire(p)
+#define PCM_STORE_RELEASE(p, v) do { __sync_synchronize(); *(p) = (v); } while (0)
+#else
+/* volatile accesses are acquire/release with MSVC on x86 */
+#define PCM_LOAD_ACQUIRE(p)     (*(p))
+#define PCM_STORE_RELEASE(p, v) (*(p) = (v))
+#endif
+
+/* Keeps the positions of both threads out of each other's cache line. */
+#define PCM_CACHE_LINE 64
+
+struct PCM_RING
+{
+  INT_PCM *buf;
+  UINT size;            /*!< Ring size in samples, a power of two. */
+  UINT mask;
+  UINT numChannels;
+  UINT frameSamples;    /*!< Samples of all channels read at once. */
+
+  UCHAR pad0[PCM_CACHE_LINE];
+  volatile UINT writePos;   /*!< Written by the capture thread only. */
+  volatile UINT eos;
+  volatile UINT overruns;
+
+  UCHAR pad1[PCM_CACHE_LINE];
+  volatile UINT readPos;    /*!< Written by the encoder thread only. */
+};
+
+INT PCM_RingOpen (HANDLE_PCM_RING *pRing, UINT numChannels, UINT frameLength, UINT numFrames)
+{
+  HANDLE_PCM_RING ring;
+  UINT frameSamples, size;
+
+  if (pRing == NULL) {
+    return -1;
+  }
+  *pRing = NULL;
+
+  if (numChannels == 0 || frameLength == 0 || numFrames == 0) {
+    return -1;
+  }
+  frameSamples = numChannels * frameLength;
+  if (frameSamples / numChannels != frameLength || frameSamples > 0x40000000 / numFrames) {
+    return -1;
+  }
+
+  for (size = 1; size < frameSamples * numFrames; size <<= 1) ;
+
+  ring = (HANDLE_PCM_RING)FDKcalloc(1, sizeof(struct PCM_RING));
+  if (ring == NULL) {
+    FDKprintfErr("PCM_RingOpen(): Unable to allocate PCM_RING struct.\n");
+    return -1;
+  }
+
+  ring->buf = (INT_PCM*)FDKcalloc(size, sizeof(INT_PCM));
+  if (ring->buf == NULL) {
+    FDKprintfErr("PCM_RingOpen(): Unable to allocate %u samples.\n", size);
+    FDKfree(ring);
+    return -1;
+  }
+
+  ring->size = size;
+  ring->mask = size - 1;
+  ring->numChannels = numChannels;
+  ring->frameSamples = frameSamples;
+
+  *pRing = ring;
+  return 0;
+}
+
+UINT PCM_RingWrite (HANDLE_PCM_RING ring, const INT_PCM *samples, UINT numSamples)
+{
+  UINT w = ring->writePos;
+  UINT r = PCM_LOAD_ACQUIRE(&ring->readPos);
+  UINT n, first;
+
+  n = ring->size - (w - r);
+  if (n > numSamples) n = numSamples;
+  n -= n % ring->numChannels;
+
+  if (n > 0) {
+    first = ring->size - (w & ring->mask);
+    if (first > n) first = n;
+    FDKmemcpy(ring->buf + (w & ring->mask), samples, first * sizeof(INT_PCM));
+    FDKmemcpy(ring->buf, samples + first, (n - first) * sizeof(INT_PCM));
+
+    PCM_STORE_RELEASE(&ring->writePos, w + n);
+  }
+
+  if (n < numSamples) {
+    ring->overruns += numSamples - n;
+  }
+
+  return n;
+}
+
+void PCM_RingEndOfStream (HANDLE_PCM_RING ring)
+{
+  PCM_STORE_RELEASE(&ring->eos, 1);
+}
+
+INT PCM_RingRead (HANDLE_PCM_RING ring, INT_PCM *buffer)
+{
+  UINT r = ring->readPos;
+  UINT w = PCM_LOAD_ACQUIRE(&ring->writePos);
+  UINT n = ring->frameSamples;
+  UINT first;
+
+  if (w - r < n) {
+    if (!PCM_LOAD_ACQUIRE(&ring->eos)) {
+      return 0;
+    }
+    /* Samples written before the end of stream are visible now. */
+    w = PCM_LOAD_ACQUIRE(&ring->writePos);
+    if (w - r < n) {
+      n = w - r;
+    }
+    if (n == 0) {
+      return -1;
+    }
+  }
+
+  first = ring->size - (r & ring->mask);
+  if (first > n) first = n;
+  FDKmemcpy(buffer, ring->buf + (r & ring->mask), first * sizeof(INT_PCM));
+  FDKmemcpy(buffer + first, ring->buf, (n - first) * sizeof(INT_PCM));
+
+  PCM_STORE_RELEASE(&ring->readPos, r + n);
+
+  return (INT)n;
+}
+
+UINT PCM_RingFrames (HANDLE_PCM_RING ring)
+{
+  UINT w = PCM_LOAD_ACQUIRE(&ring->writePos);
+  UINT r = PCM_LOAD_ACQUIRE(&ring->readPos);
+
+  return (w - r) / ring->frameSamples;
+}
+
+UINT PCM_RingOverruns (HANDLE_PCM_RING ring)
+{
+  return ring->overruns;
+}
+
+void PCM_RingClose (HANDLE_PCM_RING *pRing)
+{
+  HANDLE_PCM_RING ring = *pRing;
+
+  if (ring != NULL) {
+    if (ring->buf != NULL) {
+      FDKfree(ring->buf);
+    }
+    FDKfree(ring);
+  }
+  *pRing = NULL;
+}
@@ -93,6 +93,21 @@ amm-info@iis.fraunhofer.de
 #include "wav_file.h"
 #include "genericStds.h"
 
+#if defined(__linux__)
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define WAV_HAVE_MMAP
+#endif
+
+#if defined(__ARM_NEON__) && !defined(__ARMEB__)
+#include <arm_neon.h>
+#define WAV_HAVE_NEON
+#endif
+
+/* Bytes of raw samples read from the file at once by WAV_InputRead(). */
+#define WAV_READ_CHUNK  (16 * 1024)
 
 static INT_PCM ulaw2pcm (UCHAR ulawbyte);
 
@@ -242,6 +257,137 @@ error:
     return -1;
 }
 
+/*
+ * Sample conversion. Each WAVE sample is taken as a signed little endian
+ * integer of bitsPerSample bits and shifted to nBits, into SCHAR, SHORT or
+ * LONG (also for 24 bits) words. The kernels take whole blocks of samples,
+ * the NEON ones 8 samples at a time with the rest done by the generic one.
+ */
+
+static LONG WAV_getSample(const UCHAR *src, INT bytes)
+{
+  switch (bytes) {
+    case 1:  return (LONG)(SCHAR)src[0];
+    case 2:  return (LONG)(SHORT)(src[0] | (src[1] << 8));
+    case 3:  return ((LONG)(SCHAR)src[2] << 16) | (src[1] << 8) | src[0];
+    default: return (LONG)(INT)((UINT)src[0] | ((UINT)src[1] << 8) | ((UINT)src[2] << 16) | ((UINT)src[3] << 24));
+  }
+}
+
+static void WAV_convertGeneric(const UCHAR *src, void *dst, UINT n, INT bps, INT nBits)
+{
+  INT bytes = bps >> 3;
+  UINT i;
+
+  for (i = 0; i < n; i++, src += bytes) {
+    LONG tmp = WAV_getSample(src, bytes);
+
+    /* Full scale */
+    if (bps > nBits)
+      tmp >>= (bps - nBits);
+    else
+      tmp <<= (nBits - bps);
+
+    if (nBits == 8)
+      ((SCHAR*)dst)[i] = (SCHAR)tmp;
+    else if (nBits == 16)
+      ((SHORT*)dst)[i] = (SHORT)tmp;
+    else
+      ((LONG*)dst)[i] = tmp;
+  }
+}
+
+#ifdef WAV_HAVE_NEON
+static UINT WAV_convertNeon(const UCHAR *src, void *dst, UINT n, INT bps, INT nBits)
+{
+  UINT i = 0;
+
+  if (nBits == 16) {
+    SHORT *out = (SHORT*)dst;
+
+    switch (bps) {
+      case 8:
+        for (; i + 8 <= n; i += 8) {
+          vst1q_s16(out + i, vshll_n_s8(vld1_s8((const int8_t*)src + i), 8));
+        }
+        break;
+      case 24:
+        for (; i + 8 <= n; i += 8) {
+          /* the two upper bytes of each sample */
+          uint8x8x3_t v = vld3_u8(src + 3 * i);
+          uint8x8x2_t z = vzip_u8(v.val[1], v.val[2]);
+          vst1q_s16(out + i, vreinterpretq_s16_u8(vcombine_u8(z.val[0], z.val[1])));
+        }
+        break;
+      case 32:
+        for (; i + 8 <= n; i += 8) {
+          int16x8x2_t v = vld2q_s16((const int16_t*)(src + 4 * i));
+          vst1q_s16(out + i, v.val[1]);
+        }
+        break;
+    }
+  } else if (nBits == 32 && sizeof(LONG) == 4) {
+    int32_t *out = (int32_t*)dst;
+
+    switch (bps) {
+      case 16:
+        for (; i + 8 <= n; i += 8) {
+          int16x8_t v = vld1q_s16((const int16_t*)(src + 2 * i));
+          vst1q_s32(out + i, vshll_n_s16(vget_low_s16(v), 16));
+          vst1q_s32(out + i + 4, vshll_n_s16(vget_high_s16(v), 16));
+        }
+        break;
+      case 24:
+        for (; i + 8 <= n; i += 8) {
+          /* 0, b0, b1, b2 */
+          uint8x8x3_t v = vld3_u8(src + 3 * i);
+          uint8x8x2_t lo = vzip_u8(vdup_n_u8(0), v.val[0]);
+          uint8x8x2_t hi = vzip_u8(v.val[1], v.val[2]);
+          uint16x8x2_t w = vzipq_u16(vreinterpretq_u16_u8(vcombine_u8(lo.val[0], lo.val[1])),
+                                     vreinterpretq_u16_u8(vcombine_u8(hi.val[0], hi.val[1])));
+          vst1q_s32(out + i, vreinterpretq_s32_u16(w.val[0]));
+          vst1q_s32(out + i + 4, vreinterpretq_s32_u16(w.val[1]));
+        }
+        break;
+    }
+  }
+
+  return i;
+}
+#endif
+
+static void WAV_convertPcm(const UCHAR *src, void *dst, UINT n, INT bps, INT nBits)
+{
+  UINT done = 0;
+
+#ifdef WAV_HAVE_NEON
+  done = WAV_convertNeon(src, dst, n, bps, nBits);
+#endif
+  if (done < n) {
+    INT outBytes = (nBits == 8) ? 1 : (nBits == 16) ? 2 : sizeof(LONG);
+    WAV_convertGeneric(src + done * (bps >> 3), (UCHAR*)dst + done * outBytes, n - done, bps, nBits);
+  }
+}
+
+static INT_PCM ulawTable[256];
+static INT ulawTableReady = 0;
+
+static void WAV_convertUlaw(const UCHAR *src, INT_PCM *dst, UINT n)
+{
+  UINT i;
+
+  if (!ulawTableReady) {
+    for (i = 0; i < 256; i++) {
+      ulawTable[i] = ulaw2pcm((UCHAR)i);
+    }
+    ulawTableReady = 1;
+  }
+
+  for (i = 0; i < n; i++) {
+    dst[i] = ulawTable[src[i]];
+  }
+}
+
 /*!
  *
  *  \brief Read samples from a WAVEfile. The samples are automatically reorder to the native
@@ -260,63 +406,129 @@ error:
 INT WAV_InputRead (HANDLE_WAV wav, void *buffer, UINT numSamples, int nBits)
 {
   UINT result = 0 ;
-  UINT i;
-  SCHAR *bptr = (SCHAR*)buffer;
-  LONG  *lptr = (LONG*)buffer;
-  SHORT *sptr = (SHORT*)buffer;
+  UINT n, got, bytes, outBytes;
+  const UCHAR *src;
+  INT bps = wav->header.bitsPerSample;
 
   switch (wav->header.compressionCode)
   {
     case 0x01:  /* PCM uncompressed */
-      if (nBits == wav->header.bitsPerSample) {
-        result = FDKfread_EL(buffer, wav->header.bitsPerSample >> 3, numSamples, wav->fp) ;
-      } else {
-        result = 0;
-        for (i=0; i<numSamples; i++)
-        {
-          LONG tmp = 0;
-          result += FDKfread_EL(&tmp, wav->header.bitsPerSample >> 3, 1, wav->fp) ;
-
-          /* Move read bits to lower bits of LONG. */
-          if ( !IS_LITTLE_ENDIAN() && wav->header.bitsPerSample != 24 && wav->header.bitsPerSample < 32) {
-            tmp >>= (32-wav->header.bitsPerSample);
-          }
-
-          /* Full scale */
-          if (wav->header.bitsPerSample > nBits)
-            tmp >>= (wav->header.bitsPerSample-nBits);
-          else
-            tmp <<= (nBits-wav->header.bitsPerSample);
-            
-          if (nBits == 8)
-            *bptr++ = (SCHAR) tmp;
-          if (nBits == 16)
-            *sptr++ = (SHORT) tmp;
-          if (nBits == 32)
-            *lptr++ = (LONG) tmp;
-        }
+      if (nBits == bps && wav->map == NULL) {
+        return FDKfread_EL(buffer, bps >> 3, numSamples, wav->fp) ;
       }
+      outBytes = (nBits == 8) ? 1 : (nBits == 16) ? 2 : sizeof(LONG);
       break;
 
     case 0x07:  /* u-Law compression */
-      for (i=0; i<numSamples; i++) {
-        result += FDKfread(&(bptr[i<<1]), 1, 1, wav->fp) ;
-        sptr[i] = ulaw2pcm(bptr[i<<1]) ;
-      }
+      bps = 8;
+      outBytes = sizeof(INT_PCM);
       break ;
 
     default:
       FDKprintf("WAV_InputRead(): unsupported data-compression!!") ;
-      break ;
+      return 0;
+  }
+
+  bytes = bps >> 3;
+  if (bytes == 0) {
+    return 0;
+  }
+
+  if (wav->map == NULL && wav->readBuf == NULL) {
+    wav->readBuf = (UCHAR*)FDKmalloc(WAV_READ_CHUNK);
+    if (wav->readBuf == NULL) {
+      return 0;
+    }
+  }
+
+  while (result < numSamples) {
+    n = numSamples - result;
+
+    if (wav->map != NULL) {
+      got = (wav->mapSize - wav->mapPos) / bytes;
+      if (n > got) n = got;
+      if (n == 0) break;
+      src = wav->map + wav->mapPos;
+      wav->mapPos += n * bytes;
+      got = n;
+    } else {
+      if (n > WAV_READ_CHUNK / bytes) n = WAV_READ_CHUNK / bytes;
+      got = FDKfread(wav->readBuf, bytes, n, wav->fp);
+      if (got == 0) break;
+      src = wav->readBuf;
+    }
+
+    if (wav->header.compressionCode == 0x07) {
+      WAV_convertUlaw(src, (INT_PCM*)((UCHAR*)buffer + result * outBytes), got);
+    } else {
+      WAV_convertPcm(src, (UCHAR*)buffer + result * outBytes, got, bps, nBits);
+    }
+    result += got;
+
+    if (got < n) break;
   }
+
   return result ;
 }
 
+INT WAV_InputMap (HANDLE_WAV wav)
+{
+#ifdef WAV_HAVE_MMAP
+  struct stat st;
+  LONG pos, start, pageSize;
+  UINT size;
+  void *base;
+  int fd;
+
+  if (wav == NULL || wav->fp == NULL || wav->map != NULL) {
+    return -1;
+  }
+
+  fd = fileno((FILE*)wav->fp);
+  pos = FDKftell(wav->fp);
+  if (fd < 0 || pos < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= pos) {
+    return -1;
+  }
+
+  /* A data chunk size of 0 or past the end of the file means up to the end. */
+  size = (UINT)(st.st_size - pos);
+  if (wav->header.dataSize != 0 && wav->header.dataSize < size) {
+    size = wav->header.dataSize;
+  }
+
+  pageSize = sysconf(_SC_PAGESIZE);
+  start = pos - pos % pageSize;
+  base = mmap(NULL, size + (pos - start), PROT_READ, MAP_PRIVATE, fd, start);
+  if (base == MAP_FAILED) {
+    return -1;
+  }
+  madvise(base, size + (pos - start), MADV_SEQUENTIAL);
+
+  wav->mapBase = base;
+  wav->mapLength = size + (pos - start);
+  wav->map = (const UCHAR*)base + (pos - start);
+  wav->mapSize = size;
+  wav->mapPos = 0;
+
+  return 0;
+#else
+  return -1;
+#endif
+}
+
 void WAV_InputClose(HANDLE_WAV *pWav)
 {
   HANDLE_WAV wav = *pWav;
 
   if (wav != NULL) {
+#ifdef WAV_HAVE_MMAP
+    if (wav->mapBase != NULL) {
+      munmap(wav->mapBase, wav->mapLength);
+    }
+#endif
+    if (wav->readBuf != NULL) {
+      FDKfree(wav->readBuf);
+    }
     if (wav->fp != NULL) {
        FDKfclose(wav->fp);
        wav->fp = NULL;
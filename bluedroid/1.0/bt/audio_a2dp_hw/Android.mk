@@ -5,7 +5,8 @@ LOCAL_PATH := $(call my-dir)
 include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES := \
-	audio_a2dp_hw.c
+	audio_a2dp_hw.c \
+	audio_a2dp_shm.c
 
 LOCAL_C_INCLUDES += \
 	. \
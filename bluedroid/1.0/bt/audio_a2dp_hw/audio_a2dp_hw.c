@@ -43,6 +43,7 @@
 #include <system/audio.h>
 
 #include "audio_a2dp_hw.h"
+#include "audio_a2dp_shm.h"
 #include "bt_utils.h"
 #include "osi/include/hash_map.h"
 #include "osi/include/hash_map_utils.h"
@@ -134,6 +135,7 @@ struct a2dp_stream_common {
     pthread_mutex_t         lock;
     int                     ctrl_fd;
     int                     audio_fd;
+    a2dp_shm_t              *shm;       /* PCM ring, NULL if PCM goes over audio_fd */
     size_t                  buffer_sz;
     struct a2dp_config      cfg;
     a2dp_state_t            state;
@@ -338,6 +340,39 @@ static int skt_write(int fd, const void *p, size_t len)
     return (int)count;
 }
 
+/* PCM goes through the shared memory ring when there is one. The data
+   socket then only tells when the stack goes away. */
+static int a2dp_data_write(struct a2dp_stream_common *common, const void *p, size_t len)
+{
+    if (common->shm == NULL)
+        return skt_write(common->audio_fd, p, len);
+
+    ts_log("shm_write", len, NULL);
+
+    ssize_t sent = a2dp_shm_write(common->shm, p, len, SOCK_SEND_TIMEOUT_MS,
+                                  common->audio_fd);
+    if (sent != (ssize_t)len)
+    {
+        WARN("write to ring failed, sent %zd bytes", sent);
+        return -1;
+    }
+    return (int)sent;
+}
+
+static int a2dp_data_read(struct a2dp_stream_common *common, void *p, size_t len)
+{
+    if (common->shm == NULL)
+        return skt_read(common->audio_fd, p, len);
+
+    ts_log("shm_read", len, NULL);
+
+    ssize_t got = a2dp_shm_read(common->shm, p, len, SOCK_RECV_TIMEOUT_MS,
+                                common->audio_fd);
+    if (got == -1)
+        ERROR("read from ring failed");
+    return (int)got;
+}
+
 static int skt_disconnect(int fd)
 {
     INFO("fd %d", fd);
@@ -518,6 +553,7 @@ static void a2dp_stream_common_init(struct a2dp_stream_common *common)
 
     common->ctrl_fd = AUDIO_SKT_DISCONNECTED;
     common->audio_fd = AUDIO_SKT_DISCONNECTED;
+    common->shm = NULL;
     common->state = AUDIO_A2DP_STATE_STOPPED;
 
     /* manages max capacity of socket pipe */
@@ -552,6 +588,20 @@ static int start_audio_datapath(struct a2dp_stream_common *common)
             ERROR("Audiopath start failed - error opening data socket");
             goto error;
         }
+
+        /* The ring lives as long as the stream, so that a write racing
+           with a disconnect never touches unmapped memory. Without one,
+           PCM goes over the socket. */
+        if (common->shm == NULL)
+            common->shm = a2dp_shm_create(common->buffer_sz);
+
+        if (a2dp_shm_send_hello(common->audio_fd, common->shm) < 0)
+        {
+            ERROR("Audiopath start failed - error sending hello");
+            skt_disconnect(common->audio_fd);
+            common->audio_fd = AUDIO_SKT_DISCONNECTED;
+            goto error;
+        }
     }
     common->state = AUDIO_A2DP_STATE_STARTED;
     return 0;
@@ -659,7 +709,7 @@ static ssize_t out_write(struct audio_stream_out *stream, const void* buffer,
     }
 
     pthread_mutex_unlock(&out->common.lock);
-    sent = skt_write(out->common.audio_fd, buffer,  bytes);
+    sent = a2dp_data_write(&out->common, buffer, bytes);
     pthread_mutex_lock(&out->common.lock);
 
     if (sent == -1) {
@@ -1079,7 +1129,7 @@ static ssize_t in_read(struct audio_stream_in *stream, void* buffer,
     }
 
     pthread_mutex_unlock(&in->common.lock);
-    read = skt_read(in->common.audio_fd, buffer, bytes);
+    read = a2dp_data_read(&in->common, buffer, bytes);
     pthread_mutex_lock(&in->common.lock);
     if (read == -1)
     {
@@ -1277,6 +1327,7 @@ static void adev_close_output_stream(struct audio_hw_device *dev,
 
     skt_disconnect(out->common.ctrl_fd);
     out->common.ctrl_fd = AUDIO_SKT_DISCONNECTED;
+    a2dp_shm_free(out->common.shm);
     free(stream);
     a2dp_dev->output = NULL;
     pthread_mutex_unlock(&out->common.lock);
@@ -1490,6 +1541,7 @@ static void adev_close_input_stream(struct audio_hw_device *dev,
 
     skt_disconnect(in->common.ctrl_fd);
     in->common.ctrl_fd = AUDIO_SKT_DISCONNECTED;
+    a2dp_shm_free(in->common.shm);
     free(stream);
     a2dp_dev->input = NULL;
 
@@ -0,0 +1,560 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/*****************************************************************************
+ *
+ *  Filename:      audio_a2dp_shm.c
+ *
+ *  Description:   Shared memory PCM ring between the A2DP audio HAL and
+ *                 the bluedroid stack
+ *
+ *****************************************************************************/
+
+#define LOG_TAG "bt_a2dp_shm"
+
+#include "audio_a2dp_shm.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "osi/include/log.h"
+#include "osi/include/osi.h"
+
+/*****************************************************************************
+**  Constants & Macros
+******************************************************************************/
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+/* Descriptors passed in the hello message, in this order. */
+#define A2DP_SHM_MEM_FD   0
+#define A2DP_SHM_DATA_FD  1 /* Signalled by the writer when data is added. */
+#define A2DP_SHM_SPACE_FD 2 /* Signalled by the reader when data is removed. */
+#define A2DP_SHM_NUM_FDS  3
+
+/* The ring data starts at this offset of the shared memory. */
+#define A2DP_SHM_DATA_OFFSET 256
+
+#define A2DP_SHM_CACHE_LINE 64
+
+/*****************************************************************************
+**  Local type definitions
+******************************************************************************/
+
+/* Shared by both processes. The positions run freely and wrap at 2^32,
+   which |size| divides. Each side owns the position it moves and the
+   "waiting" fields that tell the other side to signal it. They are kept on
+   separate cache lines so that the two sides do not contend. */
+typedef struct {
+    uint32_t magic;
+    uint32_t size;      /* Power of two. */
+    uint32_t capacity;  /* At most |size|; bounds the latency of the ring. */
+
+    _Alignas(A2DP_SHM_CACHE_LINE) atomic_uint write_pos;
+    atomic_uint writer_waiting;
+    atomic_uint writer_target;  /* Read position the writer waits for. */
+
+    _Alignas(A2DP_SHM_CACHE_LINE) atomic_uint read_pos;
+    atomic_uint reader_waiting;
+    atomic_uint reader_target;  /* Write position the reader waits for. */
+} a2dp_shm_header_t;
+
+_Static_assert(sizeof(a2dp_shm_header_t) <= A2DP_SHM_DATA_OFFSET,
+               "a2dp_shm_header_t does not fit before the ring data");
+
+struct a2dp_shm_t {
+    int fds[A2DP_SHM_NUM_FDS];
+    a2dp_shm_header_t *header;
+    uint8_t *data;
+    size_t map_size;
+};
+
+/*****************************************************************************
+**   Helper functions
+******************************************************************************/
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int memfd_create_compat(const char *name)
+{
+#ifdef __NR_memfd_create
+    return syscall(__NR_memfd_create, name, MFD_CLOEXEC);
+#else
+    UNUSED(name);
+    errno = ENOSYS;
+    return INVALID_FD;
+#endif
+}
+
+static void close_fds(int *fds)
+{
+    for (int i = 0; i < A2DP_SHM_NUM_FDS; ++i)
+    {
+        if (fds[i] != INVALID_FD)
+            close(fds[i]);
+        fds[i] = INVALID_FD;
+    }
+}
+
+static void copy_in(a2dp_shm_t *shm, uint32_t pos, const uint8_t *src, size_t len)
+{
+    size_t offset = pos & (shm->header->size - 1);
+    size_t first = shm->header->size - offset;
+    if (first > len)
+        first = len;
+
+    memcpy(shm->data + offset, src, first);
+    memcpy(shm->data, src + first, len - first);
+}
+
+static void copy_out(a2dp_shm_t *shm, uint32_t pos, uint8_t *dst, size_t len)
+{
+    size_t offset = pos & (shm->header->size - 1);
+    size_t first = shm->header->size - offset;
+    if (first > len)
+        first = len;
+
+    memcpy(dst, shm->data + offset, first);
+    memcpy(dst + first, shm->data, len - first);
+}
+
+/* Signals |evt_fd| if the other side waits for |pos| or an earlier
+   position to be reached. */
+static void notify(atomic_uint *waiting, atomic_uint *target, uint32_t pos, int evt_fd)
+{
+    if (!atomic_load(waiting))
+        return;
+    if ((int32_t)(pos - atomic_load(target)) < 0)
+        return;
+    if (atomic_exchange(waiting, 0))
+        eventfd_write(evt_fd, 1);
+}
+
+/* Waits until |pos| reaches |target|, as announced by the other side
+   through |evt_fd|, |hangup_fd| is hung up or |deadline_ms| passes.
+   Returns 1, -1 and 0 respectively. */
+static int wait_for(atomic_uint *waiting, atomic_uint *target, atomic_uint *pos,
+                    uint32_t target_pos, int evt_fd, int hangup_fd,
+                    uint64_t deadline_ms)
+{
+    atomic_store(target, target_pos);
+    atomic_store(waiting, 1);
+
+    int ret = 1;
+    while ((int32_t)(atomic_load(pos) - target_pos) < 0)
+    {
+        uint64_t now = now_ms();
+        if (now >= deadline_ms)
+        {
+            ret = 0;
+            break;
+        }
+
+        struct pollfd pfds[2] = {
+            { .fd = evt_fd, .events = POLLIN },
+            { .fd = hangup_fd, .events = POLLIN },
+        };
+        int poll_ret;
+        OSI_NO_INTR(poll_ret = poll(pfds, 2, (int)(deadline_ms - now)));
+        if (poll_ret < 0)
+        {
+            LOG_ERROR(LOG_TAG, "%s poll failed: %s", __func__, strerror(errno));
+            ret = -1;
+            break;
+        }
+
+        /* Nothing but a hangup ever comes on the socket after the hello. */
+        if (pfds[1].revents)
+        {
+            ret = -1;
+            break;
+        }
+
+        if (pfds[0].revents & POLLIN)
+        {
+            eventfd_t value;
+            eventfd_read(evt_fd, &value);
+            /* The other side clears |waiting| when it signals. */
+            atomic_store(waiting, 1);
+        }
+    }
+
+    atomic_store(waiting, 0);
+    return ret;
+}
+
+static void reset(a2dp_shm_t *shm)
+{
+    a2dp_shm_header_t *h = shm->header;
+    atomic_store(&h->write_pos, 0);
+    atomic_store(&h->read_pos, 0);
+    atomic_store(&h->writer_waiting, 0);
+    atomic_store(&h->reader_waiting, 0);
+
+    /* Drop stale signals left by a previous connection. */
+    eventfd_t value;
+    eventfd_read(shm->fds[A2DP_SHM_DATA_FD], &value);
+    eventfd_read(shm->fds[A2DP_SHM_SPACE_FD], &value);
+}
+
+static a2dp_shm_t *map_fds(int *fds, size_t map_size)
+{
+    void *map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     fds[A2DP_SHM_MEM_FD], 0);
+    if (map == MAP_FAILED)
+    {
+        LOG_ERROR(LOG_TAG, "%s unable to map ring: %s", __func__, strerror(errno));
+        return NULL;
+    }
+
+    a2dp_shm_t *shm = calloc(1, sizeof(a2dp_shm_t));
+    if (shm == NULL)
+    {
+        munmap(map, map_size);
+        return NULL;
+    }
+
+    memcpy(shm->fds, fds, sizeof(shm->fds));
+    shm->header = map;
+    shm->data = (uint8_t *)map + A2DP_SHM_DATA_OFFSET;
+    shm->map_size = map_size;
+    return shm;
+}
+
+/*****************************************************************************
+**   Ring functions
+******************************************************************************/
+
+a2dp_shm_t *a2dp_shm_create(size_t capacity)
+{
+    int fds[A2DP_SHM_NUM_FDS] = { INVALID_FD, INVALID_FD, INVALID_FD };
+
+    if (capacity == 0 || capacity > (1u << 30))
+        return NULL;
+
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+    size_t map_size = A2DP_SHM_DATA_OFFSET + size;
+
+    fds[A2DP_SHM_MEM_FD] = memfd_create_compat("a2dp_shm");
+    if (fds[A2DP_SHM_MEM_FD] == INVALID_FD)
+    {
+        LOG_WARN(LOG_TAG, "%s unable to create shared memory: %s", __func__,
+                 strerror(errno));
+        goto error;
+    }
+    if (ftruncate(fds[A2DP_SHM_MEM_FD], map_size) < 0)
+    {
+        LOG_ERROR(LOG_TAG, "%s unable to size shared memory: %s", __func__,
+                  strerror(errno));
+        goto error;
+    }
+
+    fds[A2DP_SHM_DATA_FD] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    fds[A2DP_SHM_SPACE_FD] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fds[A2DP_SHM_DATA_FD] == INVALID_FD || fds[A2DP_SHM_SPACE_FD] == INVALID_FD)
+    {
+        LOG_ERROR(LOG_TAG, "%s unable to create eventfd: %s", __func__,
+                  strerror(errno));
+        goto error;
+    }
+
+    a2dp_shm_t *shm = map_fds(fds, map_size);
+    if (shm == NULL)
+        goto error;
+
+    shm->header->magic = A2DP_SHM_HELLO_MAGIC;
+    shm->header->size = size;
+    shm->header->capacity = capacity;
+    reset(shm);
+    return shm;
+
+error:
+    close_fds(fds);
+    return NULL;
+}
+
+void a2dp_shm_free(a2dp_shm_t *shm)
+{
+    if (shm == NULL)
+        return;
+
+    munmap(shm->header, shm->map_size);
+    close_fds(shm->fds);
+    free(shm);
+}
+
+int a2dp_shm_send_hello(int skt_fd, a2dp_shm_t *shm)
+{
+    uint32_t magic = A2DP_SHM_HELLO_MAGIC;
+    struct iovec iov = { .iov_base = &magic, .iov_len = sizeof(magic) };
+    char control[CMSG_SPACE(sizeof(int) * A2DP_SHM_NUM_FDS)];
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    if (shm != NULL)
+    {
+        /* The reader of the previous connection, if any, has hung up. */
+        reset(shm);
+
+        memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * A2DP_SHM_NUM_FDS);
+        memcpy(CMSG_DATA(cmsg), shm->fds, sizeof(int) * A2DP_SHM_NUM_FDS);
+    }
+
+    ssize_t ret;
+    OSI_NO_INTR(ret = sendmsg(skt_fd, &msg, MSG_NOSIGNAL));
+    if (ret != (ssize_t)sizeof(magic))
+    {
+        LOG_ERROR(LOG_TAG, "%s unable to send hello: %s", __func__, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+a2dp_shm_t *a2dp_shm_receive_hello(int skt_fd, int timeout_ms)
+{
+    int fds[A2DP_SHM_NUM_FDS] = { INVALID_FD, INVALID_FD, INVALID_FD };
+    uint32_t magic = 0;
+    struct iovec iov = { .iov_base = &magic, .iov_len = sizeof(magic) };
+    char control[CMSG_SPACE(sizeof(int) * A2DP_SHM_NUM_FDS)];
+    struct msghdr msg;
+
+    struct pollfd pfd = { .fd = skt_fd, .events = POLLIN };
+    int poll_ret;
+    OSI_NO_INTR(poll_ret = poll(&pfd, 1, timeout_ms));
+    if (poll_ret <= 0)
+    {
+        LOG_WARN(LOG_TAG, "%s no hello received", __func__);
+        return NULL;
+    }
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t ret;
+    OSI_NO_INTR(ret = recvmsg(skt_fd, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC));
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len == CMSG_LEN(sizeof(int) * A2DP_SHM_NUM_FDS))
+            memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    }
+
+    if (ret != (ssize_t)sizeof(magic) || magic != A2DP_SHM_HELLO_MAGIC)
+    {
+        LOG_ERROR(LOG_TAG, "%s invalid hello (%zd bytes, magic 0x%08x)", __func__,
+                  ret, magic);
+        goto error;
+    }
+
+    if (fds[A2DP_SHM_MEM_FD] == INVALID_FD)
+    {
+        LOG_INFO(LOG_TAG, "%s using the socket for audio data", __func__);
+        goto error;
+    }
+
+    struct stat st;
+    if (fstat(fds[A2DP_SHM_MEM_FD], &st) < 0 || st.st_size <= A2DP_SHM_DATA_OFFSET)
+    {
+        LOG_ERROR(LOG_TAG, "%s invalid shared memory", __func__);
+        goto error;
+    }
+
+    a2dp_shm_t *shm = map_fds(fds, st.st_size);
+    if (shm == NULL)
+        goto error;
+
+    /* Do not trust the header beyond what the mapping can hold. */
+    const a2dp_shm_header_t *h = shm->header;
+    uint32_t size = h->size;
+    uint32_t capacity = h->capacity;
+    if (h->magic != A2DP_SHM_HELLO_MAGIC || size == 0 || (size & (size - 1)) != 0 ||
+        A2DP_SHM_DATA_OFFSET + (size_t)size != (size_t)st.st_size ||
+        capacity == 0 || capacity > size)
+    {
+        LOG_ERROR(LOG_TAG, "%s invalid ring header", __func__);
+        a2dp_shm_free(shm);
+        return NULL;
+    }
+
+    LOG_INFO(LOG_TAG, "%s using a %u byte shared memory ring for audio data",
+             __func__, capacity);
+    return shm;
+
+error:
+    close_fds(fds);
+    return NULL;
+}
+
+ssize_t a2dp_shm_write(a2dp_shm_t *shm, const void *data, size_t len,
+                       int timeout_ms, int hangup_fd)
+{
+    a2dp_shm_header_t *h = shm->header;
+    const uint32_t capacity = h->capacity;
+    uint32_t write_pos = atomic_load_explicit(&h->write_pos, memory_order_relaxed);
+    uint64_t deadline_ms = 0;
+    bool timed_out = false;
+    size_t done = 0;
+
+    while (done < len)
+    {
+        uint32_t read_pos = atomic_load_explicit(&h->read_pos, memory_order_acquire);
+        uint32_t used = write_pos - read_pos;
+        if (used > capacity)
+        {
+            LOG_ERROR(LOG_TAG, "%s ring corrupted", __func__);
+            return -1;
+        }
+
+        if (used == capacity)
+        {
+            if (timed_out)
+                break;
+
+            /* Wait until there is room for all the rest, or a full ring. */
+            size_t want = len - done;
+            if (want > capacity)
+                want = capacity;
+            if (deadline_ms == 0)
+                deadline_ms = now_ms() + timeout_ms;
+
+            int ret = wait_for(&h->writer_waiting, &h->writer_target, &h->read_pos,
+                               write_pos + want - capacity,
+                               shm->fds[A2DP_SHM_SPACE_FD], hangup_fd, deadline_ms);
+            if (ret < 0)
+                return -1;
+            /* On timeout, take what the other side managed to do. */
+            timed_out = (ret == 0);
+            continue;
+        }
+
+        size_t n = capacity - used;
+        if (n > len - done)
+            n = len - done;
+        copy_in(shm, write_pos, (const uint8_t *)data + done, n);
+        write_pos += n;
+        done += n;
+
+        atomic_store(&h->write_pos, write_pos);
+        notify(&h->reader_waiting, &h->reader_target, write_pos,
+               shm->fds[A2DP_SHM_DATA_FD]);
+    }
+
+    return done;
+}
+
+ssize_t a2dp_shm_read(a2dp_shm_t *shm, void *data, size_t len,
+                      int timeout_ms, int hangup_fd)
+{
+    a2dp_shm_header_t *h = shm->header;
+    const uint32_t capacity = h->capacity;
+    uint32_t read_pos = atomic_load_explicit(&h->read_pos, memory_order_relaxed);
+    uint64_t deadline_ms = 0;
+    bool timed_out = false;
+    size_t done = 0;
+
+    while (done < len)
+    {
+        uint32_t write_pos = atomic_load_explicit(&h->write_pos, memory_order_acquire);
+        uint32_t avail = write_pos - read_pos;
+        if (avail > capacity)
+        {
+            LOG_ERROR(LOG_TAG, "%s ring corrupted", __func__);
+            return -1;
+        }
+
+        if (avail == 0)
+        {
+            if (timed_out)
+                break;
+
+            /* Wait until all the rest is there, or a full ring. */
+            size_t want = len - done;
+            if (want > capacity)
+                want = capacity;
+            if (deadline_ms == 0)
+                deadline_ms = now_ms() + timeout_ms;
+
+            int ret = wait_for(&h->reader_waiting, &h->reader_target, &h->write_pos,
+                               read_pos + want,
+                               shm->fds[A2DP_SHM_DATA_FD], hangup_fd, deadline_ms);
+            if (ret < 0)
+                return -1;
+            /* On timeout, take what the other side managed to do. */
+            timed_out = (ret == 0);
+            continue;
+        }
+
+        size_t n = avail;
+        if (n > len - done)
+            n = len - done;
+        copy_out(shm, read_pos, (uint8_t *)data + done, n);
+        read_pos += n;
+        done += n;
+
+        atomic_store(&h->read_pos, read_pos);
+        notify(&h->writer_waiting, &h->writer_target, read_pos,
+               shm->fds[A2DP_SHM_SPACE_FD]);
+    }
+
+    return done;
+}
+
+void a2dp_shm_flush(a2dp_shm_t *shm)
+{
+    a2dp_shm_header_t *h = shm->header;
+    uint32_t write_pos = atomic_load(&h->write_pos);
+
+    atomic_store(&h->read_pos, write_pos);
+    notify(&h->writer_waiting, &h->writer_target, write_pos,
+           shm->fds[A2DP_SHM_SPACE_FD]);
+}
@@ -0,0 +1,104 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/*****************************************************************************
+ *
+ *  Filename:      audio_a2dp_shm.h
+ *
+ *  Description:   Shared memory PCM ring between the A2DP audio HAL and
+ *                 the bluedroid stack
+ *
+ *  The ring is a single producer, single consumer byte FIFO in a memfd
+ *  mapped by both processes, with an eventfd for each direction of
+ *  signalling. A side only signals the other when it is actually waiting,
+ *  and only once the amount it waits for is reached, so a steady stream
+ *  costs no system calls at all in the common case.
+ *
+ *  The HAL creates the ring when it connects the A2DP data socket and
+ *  passes its descriptors over that socket in a hello message. The socket
+ *  then carries no more data, but is kept open: its hangup is how either
+ *  side learns that the other has gone away. A HAL that cannot create a
+ *  ring sends the hello without descriptors and both sides keep using the
+ *  socket for PCM.
+ *
+ *****************************************************************************/
+
+#ifndef AUDIO_A2DP_SHM_H
+#define AUDIO_A2DP_SHM_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*****************************************************************************
+**  Constants & Macros
+******************************************************************************/
+
+/* First bytes sent over the data socket by the HAL. */
+#define A2DP_SHM_HELLO_MAGIC 0x41324453 /* "A2DS" */
+
+/*****************************************************************************
+**  Type definitions and return values
+******************************************************************************/
+
+typedef struct a2dp_shm_t a2dp_shm_t;
+
+/*****************************************************************************
+**  Functions
+******************************************************************************/
+
+/* Creates a ring holding up to |capacity| bytes. Returns NULL if shared
+   memory is not available. */
+a2dp_shm_t *a2dp_shm_create(size_t capacity);
+
+/* Frees |shm| and closes its descriptors. |shm| may be NULL. */
+void a2dp_shm_free(a2dp_shm_t *shm);
+
+/* Sends the hello message over the data socket |skt_fd|, with the
+   descriptors of |shm| when it is not NULL. |shm| is emptied first, so
+   that it can be reused across connections. Returns 0 on success. */
+int a2dp_shm_send_hello(int skt_fd, a2dp_shm_t *shm);
+
+/* Receives the hello message from the data socket |skt_fd|, waiting up to
+   |timeout_ms| for it. Returns the ring it carries, or NULL if it carries
+   none or could not be received, in which case PCM goes over the socket. */
+a2dp_shm_t *a2dp_shm_receive_hello(int skt_fd, int timeout_ms);
+
+/* Copies |len| bytes from |data| into the ring, waiting up to |timeout_ms|
+   for space. Returns the number of bytes written, which is less than |len|
+   on timeout, or -1 if |hangup_fd| was hung up or the ring is corrupted. */
+ssize_t a2dp_shm_write(a2dp_shm_t *shm, const void *data, size_t len,
+                       int timeout_ms, int hangup_fd);
+
+/* Copies |len| bytes from the ring to |data|, waiting up to |timeout_ms|
+   for them. Returns the number of bytes read, which is less than |len| on
+   timeout, or -1 if |hangup_fd| was hung up or the ring is corrupted. */
+ssize_t a2dp_shm_read(a2dp_shm_t *shm, void *data, size_t len,
+                      int timeout_ms, int hangup_fd);
+
+/* Discards the bytes in the ring. Must be called by the reading side. */
+void a2dp_shm_flush(a2dp_shm_t *shm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_A2DP_SHM_H */
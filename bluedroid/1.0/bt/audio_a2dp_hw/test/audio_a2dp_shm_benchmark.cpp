@@ -0,0 +1,159 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+// Compares the A2DP data socket with the shared memory ring. The argument of
+// each benchmark selects the socket (0) or the ring (1). The HAL side runs
+// in a second thread and writes AudioFlinger sized chunks; the benchmark
+// thread plays the media task and reads encoder sized chunks, as UIPC_Read
+// does. Process CPU time is measured, so both sides are accounted for.
+//
+// BM_Stream reports the cost of moving PCM at full speed. BM_Handoff reports
+// the latency of handing one chunk to a reader that waits for it, which is
+// the situation of the media task on each timer tick.
+
+#include <benchmark/benchmark.h>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+
+extern "C" {
+#include "audio_a2dp_shm.h"
+}
+
+static const size_t CAPACITY = 28 * 512;
+static const size_t HAL_CHUNK = CAPACITY / 4;
+static const size_t ENCODER_CHUNK = 512;
+static const int TIMEOUT_MS = 1000;
+
+struct Transport {
+  explicit Transport(bool use_shm) {
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    int size = CAPACITY;
+    setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+    setsockopt(fds[1], SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    if (use_shm) {
+      hal = a2dp_shm_create(CAPACITY);
+      a2dp_shm_send_hello(fds[0], hal);
+      stack = a2dp_shm_receive_hello(fds[1], TIMEOUT_MS);
+    }
+  }
+
+  ~Transport() {
+    a2dp_shm_free(stack);
+    a2dp_shm_free(hal);
+    close(fds[0]);
+    close(fds[1]);
+  }
+
+  // As skt_write in the HAL.
+  void Write(const uint8_t *data, size_t len) {
+    if (hal) {
+      a2dp_shm_write(hal, data, len, TIMEOUT_MS, fds[0]);
+      return;
+    }
+    while (len > 0) {
+      ssize_t ret = send(fds[0], data, len, MSG_NOSIGNAL);
+      if (ret <= 0)
+        return;
+      data += ret;
+      len -= ret;
+    }
+  }
+
+  // As UIPC_Read in the stack.
+  void Read(uint8_t *data, size_t len) {
+    if (stack) {
+      a2dp_shm_read(stack, data, len, TIMEOUT_MS, fds[1]);
+      return;
+    }
+    while (len > 0) {
+      struct pollfd pfd = { fds[1], POLLIN, 0 };
+      if (poll(&pfd, 1, TIMEOUT_MS) <= 0)
+        return;
+      ssize_t ret = recv(fds[1], data, len, 0);
+      if (ret <= 0)
+        return;
+      data += ret;
+      len -= ret;
+    }
+  }
+
+  int fds[2];
+  a2dp_shm_t *hal = nullptr;
+  a2dp_shm_t *stack = nullptr;
+};
+
+static void BM_Stream(benchmark::State &state) {
+  Transport transport(state.range(0));
+  std::atomic<bool> done(false);
+  std::thread hal([&] {
+    uint8_t chunk[HAL_CHUNK] = {0};
+    while (!done)
+      transport.Write(chunk, sizeof(chunk));
+  });
+
+  uint8_t chunk[ENCODER_CHUNK];
+  while (state.KeepRunning()) {
+    transport.Read(chunk, sizeof(chunk));
+    benchmark::DoNotOptimize(chunk);
+  }
+  state.SetBytesProcessed(state.iterations() * sizeof(chunk));
+
+  done = true;
+  // Hanging up unblocks the HAL thread, as when the media task goes away.
+  shutdown(transport.fds[1], SHUT_RDWR);
+  hal.join();
+}
+BENCHMARK(BM_Stream)->Arg(0)->Arg(1)->MeasureProcessCPUTime()->UseRealTime();
+
+static void BM_Handoff(benchmark::State &state) {
+  Transport transport(state.range(0));
+  std::atomic<int> requested(0);
+  std::atomic<bool> done(false);
+  std::thread hal([&] {
+    uint8_t chunk[ENCODER_CHUNK] = {0};
+    int sent = 0;
+    while (!done) {
+      if (requested.load() == sent) {
+        std::this_thread::yield();
+        continue;
+      }
+      transport.Write(chunk, sizeof(chunk));
+      sent++;
+    }
+  });
+
+  uint8_t chunk[ENCODER_CHUNK];
+  int reads = 0;
+  while (state.KeepRunning()) {
+    // The reader is already waiting when the data is written.
+    requested = ++reads;
+    transport.Read(chunk, sizeof(chunk));
+    benchmark::DoNotOptimize(chunk);
+  }
+
+  done = true;
+  hal.join();
+}
+BENCHMARK(BM_Handoff)->Arg(0)->Arg(1)->MeasureProcessCPUTime()->UseRealTime();
+
+BENCHMARK_MAIN();
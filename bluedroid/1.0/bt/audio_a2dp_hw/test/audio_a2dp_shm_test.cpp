@@ -0,0 +1,157 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <stdint.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "audio_a2dp_shm.h"
+}
+
+static const size_t CAPACITY = 28 * 512;
+
+// The HAL end of the data socket is |fds[0]|, the stack end |fds[1]|. Each
+// end maps the ring separately, as the two processes would.
+class AudioA2dpShmTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    hal = a2dp_shm_create(CAPACITY);
+    ASSERT_TRUE(hal != NULL);
+    ASSERT_EQ(0, a2dp_shm_send_hello(fds[0], hal));
+    stack = a2dp_shm_receive_hello(fds[1], 1000);
+    ASSERT_TRUE(stack != NULL);
+  }
+
+  virtual void TearDown() {
+    a2dp_shm_free(stack);
+    a2dp_shm_free(hal);
+    if (fds[0] != -1)
+      close(fds[0]);
+    close(fds[1]);
+  }
+
+  int fds[2];
+  a2dp_shm_t *hal;
+  a2dp_shm_t *stack;
+};
+
+TEST(AudioA2dpShmHelloTest, test_hello_without_ring) {
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  ASSERT_EQ(0, a2dp_shm_send_hello(fds[0], NULL));
+  EXPECT_TRUE(a2dp_shm_receive_hello(fds[1], 1000) == NULL);
+
+  // The hello is consumed, the socket carries PCM from here on.
+  uint8_t byte = 0x42;
+  ASSERT_EQ(1, write(fds[0], &byte, 1));
+  uint8_t received = 0;
+  ASSERT_EQ(1, read(fds[1], &received, 1));
+  EXPECT_EQ(byte, received);
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(AudioA2dpShmHelloTest, test_no_hello) {
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  EXPECT_TRUE(a2dp_shm_receive_hello(fds[1], 10) == NULL);
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST_F(AudioA2dpShmTest, test_transfer) {
+  const size_t TOTAL = 1024 * 1024;
+
+  std::thread writer([this, TOTAL] {
+    // AudioFlinger sized chunks.
+    uint8_t chunk[3584];
+    size_t written = 0;
+    while (written < TOTAL) {
+      size_t len = std::min(sizeof(chunk), TOTAL - written);
+      for (size_t i = 0; i < len; ++i)
+        chunk[i] = (uint8_t)((written + i) * 7);
+      ASSERT_EQ((ssize_t)len, a2dp_shm_write(hal, chunk, len, 1000, fds[0]));
+      written += len;
+    }
+  });
+
+  // Encoder sized chunks.
+  uint8_t chunk[512];
+  size_t read = 0;
+  while (read < TOTAL) {
+    ASSERT_EQ((ssize_t)sizeof(chunk), a2dp_shm_read(stack, chunk, sizeof(chunk), 1000, fds[1]));
+    for (size_t i = 0; i < sizeof(chunk); ++i)
+      ASSERT_EQ((uint8_t)((read + i) * 7), chunk[i]);
+    read += sizeof(chunk);
+  }
+  writer.join();
+}
+
+TEST_F(AudioA2dpShmTest, test_read_timeout_returns_partial) {
+  uint8_t data[100] = {0};
+  ASSERT_EQ(40, a2dp_shm_write(hal, data, 40, 0, fds[0]));
+  EXPECT_EQ(40, a2dp_shm_read(stack, data, sizeof(data), 10, fds[1]));
+  EXPECT_EQ(0, a2dp_shm_read(stack, data, sizeof(data), 0, fds[1]));
+}
+
+TEST_F(AudioA2dpShmTest, test_write_timeout_when_full) {
+  std::vector<uint8_t> data(CAPACITY + 100);
+  EXPECT_EQ((ssize_t)CAPACITY, a2dp_shm_write(hal, data.data(), data.size(), 10, fds[0]));
+  EXPECT_EQ(0, a2dp_shm_write(hal, data.data(), 1, 0, fds[0]));
+
+  // Room made by the reader becomes available again.
+  EXPECT_EQ(100, a2dp_shm_read(stack, data.data(), 100, 0, fds[1]));
+  EXPECT_EQ(100, a2dp_shm_write(hal, data.data(), 100, 0, fds[0]));
+}
+
+TEST_F(AudioA2dpShmTest, test_flush) {
+  uint8_t data[64] = {0};
+  ASSERT_EQ(64, a2dp_shm_write(hal, data, sizeof(data), 0, fds[0]));
+  a2dp_shm_flush(stack);
+  EXPECT_EQ(0, a2dp_shm_read(stack, data, sizeof(data), 0, fds[1]));
+}
+
+TEST_F(AudioA2dpShmTest, test_hangup_wakes_up_reader) {
+  std::thread hangup([this] {
+    usleep(20 * 1000);
+    close(fds[0]);
+    fds[0] = -1;
+  });
+
+  uint8_t data[64];
+  EXPECT_EQ(-1, a2dp_shm_read(stack, data, sizeof(data), 5000, fds[1]));
+  hangup.join();
+}
+
+TEST_F(AudioA2dpShmTest, test_reconnect_resets_ring) {
+  uint8_t data[64] = {0};
+  ASSERT_EQ(64, a2dp_shm_write(hal, data, sizeof(data), 0, fds[0]));
+  a2dp_shm_free(stack);
+
+  ASSERT_EQ(0, a2dp_shm_send_hello(fds[0], hal));
+  stack = a2dp_shm_receive_hello(fds[1], 1000);
+  ASSERT_TRUE(stack != NULL);
+  EXPECT_EQ(0, a2dp_shm_read(stack, data, sizeof(data), 0, fds[1]));
+}
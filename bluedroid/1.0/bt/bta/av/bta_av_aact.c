@@ -2172,6 +2172,18 @@ void bta_av_str_stopped (tBTA_AV_SCB *p_scb, tBTA_AV_DATA *p_data)
 
     /* if q_info.a2d_list is not empty, drop it now */
     if (BTA_AV_CHNL_AUDIO == p_scb->chnl) {
+        tAVDT_WRITE_STATS write_stats;
+        tL2CAP_CHNL_TX_STATS tx_stats;
+
+        /* media packets are written down the stack in place; report any that were not */
+        if (AVDT_GetWriteStats(p_scb->avdt_handle, &write_stats) == AVDT_SUCCESS &&
+            L2CA_GetChnlTxStats(p_scb->l2c_cid, &tx_stats))
+        {
+            APPL_TRACE_DEBUG("%s: media packets %u, copied by avdt %u, by l2cap %u",
+                             __func__, write_stats.num_pkts, write_stats.num_copies,
+                             tx_stats.num_copies);
+        }
+
         while (!list_is_empty(p_scb->a2d_list))
         {
             p_buf = (BT_HDR *)list_front(p_scb->a2d_list);
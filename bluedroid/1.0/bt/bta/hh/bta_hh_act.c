@@ -46,6 +46,7 @@
 static void bta_hh_cback (UINT8 dev_handle, BD_ADDR addr, UINT8 event,
                             UINT32 data, BT_HDR *pdata);
 static tBTA_HH_STATUS bta_hh_get_trans_status(UINT32 result);
+static BOOLEAN bta_hh_input_fast_path(UINT8 dev_handle, BT_HDR *pdata);
 
 #if BTA_HH_DEBUG
 static char* bta_hh_get_w4_event(UINT16 event);
@@ -1207,6 +1208,8 @@ static void bta_hh_cback (UINT8 dev_handle, BD_ADDR addr, UINT8 event,
         sm_event = BTA_HH_INT_CLOSE_EVT;
         break;
     case HID_HDEV_EVT_INTR_DATA:
+        if (bta_hh_input_fast_path(dev_handle, pdata))
+            return;
         sm_event = BTA_HH_INT_DATA_EVT;
         break;
     case HID_HDEV_EVT_HANDSHAKE:
@@ -1248,6 +1251,38 @@ static void bta_hh_cback (UINT8 dev_handle, BD_ADDR addr, UINT8 event,
     }
 }
 
+/*******************************************************************************
+**
+** Function         bta_hh_input_fast_path
+**
+** Description      Hands an input report of a connected device straight to
+**                  the call-out. The HID callback already runs on the BTA
+**                  thread, so the report does not need to go through the BTA
+**                  message queue, where it would wait behind other events.
+**
+** Returns          TRUE if the report was consumed, FALSE if it must go
+**                  through the state machine.
+**
+*******************************************************************************/
+static BOOLEAN bta_hh_input_fast_path(UINT8 dev_handle, BT_HDR *pdata)
+{
+    UINT8 index = bta_hh_dev_handle_to_cb_idx(dev_handle);
+    tBTA_HH_DEV_CB *p_cb;
+
+    if (pdata == NULL || index == BTA_HH_IDX_INVALID)
+        return FALSE;
+
+    p_cb = &bta_hh_cb.kdev[index];
+    if (!p_cb->in_use || p_cb->state != BTA_HH_CONN_ST)
+        return FALSE;
+
+    bta_hh_co_data(dev_handle, (UINT8 *)(pdata + 1) + pdata->offset, pdata->len,
+                   p_cb->mode, p_cb->sub_class, p_cb->dscp_info.ctry_code, p_cb->addr,
+                   p_cb->app_id);
+    osi_free(pdata);
+    return TRUE;
+}
+
 /*******************************************************************************
 **
 ** Function         bta_hh_get_trans_status
@@ -54,6 +54,9 @@ void module_shut_down(const module_t *module);
 // If not initialized, does nothing.
 void module_clean_up(const module_t *module);
 
+// Writes how long the init and start up of each known module took to |fd|.
+void module_debug_dump(int fd);
+
 // Temporary callbacked wrapper for module start up, so real modules can be
 // spliced into the current janky startup sequence. Runs on a separate thread,
 // which terminates when the module start up has finished. When module startup
@@ -20,7 +20,9 @@
 
 #include <assert.h>
 #include <dlfcn.h>
+#include <inttypes.h>
 #include <pthread.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "btcore/include/module.h"
@@ -29,6 +31,7 @@
 #include "osi/include/hash_map.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
+#include "osi/include/time.h"
 
 typedef enum {
   MODULE_STATE_NONE = 0,
@@ -36,6 +39,15 @@ typedef enum {
   MODULE_STATE_STARTED = 2
 } module_state_t;
 
+typedef struct {
+  module_state_t state;
+  // How long the last init and start up took, and when the last start up
+  // finished, to find what the startup sequence is waiting on.
+  uint32_t init_ms;
+  uint32_t start_up_ms;
+  uint32_t started_at_ms;
+} module_metadata_t;
+
 static const size_t number_of_metadata_buckets = 42;
 static hash_map_t *metadata;
 // Include this lock for now for correctness, while the startup sequence is being refactored
@@ -44,6 +56,8 @@ static pthread_mutex_t metadata_lock;
 static bool call_lifecycle_function(module_lifecycle_fn function);
 static module_state_t get_module_state(const module_t *module);
 static void set_module_state(const module_t *module, module_state_t state);
+static void set_module_init_time(const module_t *module, uint32_t init_ms);
+static void set_module_start_up_time(const module_t *module, uint32_t start_up_ms);
 
 void module_management_start(void) {
   metadata = hash_map_new(
@@ -79,13 +93,17 @@ bool module_init(const module_t *module) {
   assert(get_module_state(module) == MODULE_STATE_NONE);
 
   LOG_INFO(LOG_TAG, "%s Initializing module \"%s\"", __func__, module->name);
+  uint32_t start_ms = time_get_os_boottime_ms();
   if (!call_lifecycle_function(module->init)) {
     LOG_ERROR(LOG_TAG, "%s Failed to initialize module \"%s\"",
               __func__, module->name);
     return false;
   }
-  LOG_INFO(LOG_TAG, "%s Initialized module \"%s\"", __func__, module->name);
+  uint32_t elapsed_ms = time_get_os_boottime_ms() - start_ms;
+  LOG_INFO(LOG_TAG, "%s Initialized module \"%s\" in %" PRIu32 " ms",
+           __func__, module->name, elapsed_ms);
 
+  set_module_init_time(module, elapsed_ms);
   set_module_state(module, MODULE_STATE_INITIALIZED);
   return true;
 }
@@ -99,13 +117,17 @@ bool module_start_up(const module_t *module) {
   assert(get_module_state(module) == MODULE_STATE_INITIALIZED || module->init == NULL);
 
   LOG_INFO(LOG_TAG, "%s Starting module \"%s\"", __func__, module->name);
+  uint32_t start_ms = time_get_os_boottime_ms();
   if (!call_lifecycle_function(module->start_up)) {
     LOG_ERROR(LOG_TAG, "%s Failed to start up module \"%s\"",
               __func__, module->name);
     return false;
   }
-  LOG_INFO(LOG_TAG, "%s Started module \"%s\"", __func__, module->name);
+  uint32_t elapsed_ms = time_get_os_boottime_ms() - start_ms;
+  LOG_INFO(LOG_TAG, "%s Started module \"%s\" in %" PRIu32 " ms",
+           __func__, module->name, elapsed_ms);
 
+  set_module_start_up_time(module, elapsed_ms);
   set_module_state(module, MODULE_STATE_STARTED);
   return true;
 }
@@ -167,26 +189,68 @@ static bool call_lifecycle_function(module_lifecycle_fn function) {
   return future_await(future);
 }
 
+static bool dump_module_metadata(hash_map_entry_t *hash_entry, void *context) {
+  const module_t *module = hash_entry->key;
+  const module_metadata_t *entry = hash_entry->data;
+  int fd = *(int *)context;
+
+  if (entry->state == MODULE_STATE_STARTED)
+    dprintf(fd, "  %-24s init: %6" PRIu32 " ms  start up: %6" PRIu32
+            " ms  started at: %" PRIu32 " ms\n", module->name,
+            entry->init_ms, entry->start_up_ms, entry->started_at_ms);
+  else
+    dprintf(fd, "  %-24s init: %6" PRIu32 " ms  not started\n",
+            module->name, entry->init_ms);
+  return true;
+}
+
+void module_debug_dump(int fd) {
+  dprintf(fd, "\nModule lifecycle times:\n");
+  if (!metadata)
+    return;
+
+  pthread_mutex_lock(&metadata_lock);
+  hash_map_foreach(metadata, dump_module_metadata, &fd);
+  pthread_mutex_unlock(&metadata_lock);
+}
+
 static module_state_t get_module_state(const module_t *module) {
   pthread_mutex_lock(&metadata_lock);
-  module_state_t *state_ptr = hash_map_get(metadata, module);
+  module_metadata_t *entry = hash_map_get(metadata, module);
+  module_state_t state = entry ? entry->state : MODULE_STATE_NONE;
   pthread_mutex_unlock(&metadata_lock);
 
-  return state_ptr ? *state_ptr : MODULE_STATE_NONE;
+  return state;
+}
+
+// Must be called with |metadata_lock| held.
+static module_metadata_t *get_or_create_metadata(const module_t *module) {
+  module_metadata_t *entry = hash_map_get(metadata, module);
+  if (!entry) {
+    entry = osi_calloc(sizeof(module_metadata_t));
+    hash_map_set(metadata, module, entry);
+  }
+  return entry;
 }
 
 static void set_module_state(const module_t *module, module_state_t state) {
   pthread_mutex_lock(&metadata_lock);
+  get_or_create_metadata(module)->state = state;
+  pthread_mutex_unlock(&metadata_lock);
+}
 
-  module_state_t *state_ptr = hash_map_get(metadata, module);
-  if (!state_ptr) {
-    state_ptr = osi_malloc(sizeof(module_state_t));
-    hash_map_set(metadata, module, state_ptr);
-  }
-
+static void set_module_init_time(const module_t *module, uint32_t init_ms) {
+  pthread_mutex_lock(&metadata_lock);
+  get_or_create_metadata(module)->init_ms = init_ms;
   pthread_mutex_unlock(&metadata_lock);
+}
 
-  *state_ptr = state;
+static void set_module_start_up_time(const module_t *module, uint32_t start_up_ms) {
+  pthread_mutex_lock(&metadata_lock);
+  module_metadata_t *entry = get_or_create_metadata(module);
+  entry->start_up_ms = start_up_ms;
+  entry->started_at_ms = time_get_os_boottime_ms();
+  pthread_mutex_unlock(&metadata_lock);
 }
 
 // TODO(zachoverflow): remove when everything modulized
@@ -41,6 +41,7 @@
 #include "bta_hh_api.h"
 #include "bta_hh_co.h"
 #include "btif_hh.h"
+#include "btif_hh_input.h"
 #include "btif_util.h"
 
 const char *dev_path = "/dev/uhid";
@@ -280,6 +281,9 @@ static inline void btif_hh_close_poll_thread(btif_hh_device_t *p_dev)
 
 void bta_hh_co_destroy(int fd)
 {
+    // Reports queued for |fd| must not be written after it is closed.
+    btif_hh_input_flush();
+
     struct uhid_event ev;
     memset(&ev, 0, sizeof(ev));
     ev.type = UHID_DESTROY;
@@ -476,7 +480,8 @@ void bta_hh_co_data(UINT8 dev_handle, UINT8 *p_rpt, UINT16 len, tBTA_HH_PROTO_MO
 #else
     if ((p_dev->fd >= 0) && p_dev->ready_for_data) {
 #endif
-        bta_hh_co_write(p_dev->fd, p_rpt, len);
+        if (!btif_hh_input_write(p_dev->fd, p_rpt, len))
+            bta_hh_co_write(p_dev->fd, p_rpt, len);
     }else {
         APPL_TRACE_WARNING("%s: Error: fd = %d, ready %d, len = %d", __FUNCTION__, p_dev->fd,
                             p_dev->ready_for_data, len);
@@ -25,6 +25,7 @@
 
 #include "osi/include/osi.h"
 #include "osi/include/log.h"
+#include "osi/include/thread_pool.h"
 #include "bt_types.h"
 #include "bta_api.h"
 
@@ -217,6 +218,13 @@ bt_status_t btif_clean_service_id(tBTA_SERVICE_ID service_id);
 
 int btif_is_enabled(void);
 
+// Runs |func| on the Bluetooth worker pool, or on the btif thread when the
+// pool is not running. For work, such as file writes, which need not be
+// ordered with the btif events.
+void btif_worker_post(thread_pool_priority_t priority, thread_fn func, void *context);
+
+void btif_debug_worker_pool_dump(int fd);
+
 /**
  * BTIF_Events
  */
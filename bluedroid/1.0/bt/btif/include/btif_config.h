@@ -27,6 +27,10 @@ static const char BTIF_CONFIG_MODULE[] = "btif_config_module";
 
 typedef struct btif_config_section_iter_t btif_config_section_iter_t;
 
+// Called by |btif_config_foreach| for each key/value pair. The strings are only
+// valid during the call. Return true to continue iterating or false to stop.
+typedef bool (*btif_config_foreach_cb)(const char *section, const char *key, const char *value, void *context);
+
 bool btif_config_has_section(const char *section);
 bool btif_config_exist(const char *section, const char *key);
 bool btif_config_get_int(const char *section, const char *key, int *value);
@@ -44,6 +48,11 @@ const btif_config_section_iter_t *btif_config_section_end(void);
 const btif_config_section_iter_t *btif_config_section_next(const btif_config_section_iter_t *section);
 const char *btif_config_section_name(const btif_config_section_iter_t *section);
 
+// Walks every key/value pair of the config in one pass, holding the config
+// lock for the whole walk. |callback| must not call any other btif_config
+// function. Returns false if |callback| stopped the walk.
+bool btif_config_foreach(btif_config_foreach_cb callback, void *context);
+
 void btif_config_save(void);
 void btif_config_flush(void);
 bool btif_config_clear(void);
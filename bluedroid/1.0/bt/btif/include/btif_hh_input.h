@@ -0,0 +1,49 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fast path for HID input reports. The stack thread hands each report to a
+// lock-free ring, and a dedicated thread writes the reports to uhid, so key
+// presses never wait behind other stack work and the stack never blocks on
+// a uhid write. The time from a report reaching |btif_hh_input_write| to its
+// uhid write completing is kept as a histogram.
+
+// Starts the uhid writer thread. Returns false if it could not be started,
+// in which case |btif_hh_input_write| keeps returning false.
+bool btif_hh_input_start(void);
+
+// Writes the reports still queued and stops the uhid writer thread. Safe to
+// call when the writer is not started.
+void btif_hh_input_stop(void);
+
+// Queues the input report of |len| bytes at |report| for the uhid device
+// |fd|. Returns false if the report was not queued; the caller must then
+// write it to uhid itself. Reports are written in the order they are queued.
+// Must only be called from the stack thread.
+bool btif_hh_input_write(int fd, const uint8_t *report, uint16_t len);
+
+// Waits until every report queued so far has been written. Call before
+// closing a uhid fd that reports may be queued for.
+void btif_hh_input_flush(void);
+
+// Dumps the input latency histogram and the writer statistics.
+void btif_debug_hh_input_dump(int fd);
@@ -26,3 +26,7 @@ btsock_interface_t *btif_sock_get_interface(void);
 
 bt_status_t btif_sock_init(uid_set_t* uid_set);
 void btif_sock_cleanup(void);
+
+// Dumps the data path counters of the connected RFCOMM and L2CAP sockets
+// to |fd|.
+void btif_debug_sock_dump(int fd);
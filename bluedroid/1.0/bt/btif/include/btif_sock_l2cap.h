@@ -19,6 +19,7 @@ bt_status_t btsock_l2cap_listen(const char* name, int channel,
 bt_status_t btsock_l2cap_connect(const bt_bdaddr_t *bd_addr,
                                int channel, int* sock_fd, int flags, int app_uid);
 void btsock_l2cap_signaled(int fd, int flags, uint32_t user_id);
+void btsock_l2cap_debug_dump(int fd);
 void on_l2cap_psm_assigned(int id, int psm);
 
 #endif
@@ -36,5 +36,6 @@ bt_status_t btsock_rfc_listen(const char* name, const uint8_t* uuid, int channel
 bt_status_t btsock_rfc_connect(const bt_bdaddr_t *bd_addr, const uint8_t* uuid,
                                int channel, int* sock_fd, int flags, int app_uid);
 void btsock_rfc_signaled(int fd, int flags, uint32_t user_id);
+void btsock_rfc_debug_dump(int fd);
 
 #endif
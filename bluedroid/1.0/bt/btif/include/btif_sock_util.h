@@ -29,6 +29,20 @@
 
 #include <stdint.h>
 
+/* Data path counters of one RFCOMM or L2CAP socket, shown by dumpsys */
+typedef struct {
+    uint32_t connected_ms;  /* boot time when the channel connected, 0 if not yet */
+    uint64_t tx_bytes;      /* app to stack */
+    uint64_t rx_bytes;      /* stack to app */
+    uint32_t tx_reads;      /* reads from the app socket */
+    uint32_t rx_writes;     /* writes to the app socket */
+    uint32_t app_stalls;    /* times incoming data waited for the app to read */
+    uint32_t stack_stalls;  /* times outgoing data waited for the stack (congestion, credits) */
+} sock_stats_t;
+
+void sock_stats_connected(sock_stats_t *stats);
+void sock_stats_dump(int fd, const char *name, const sock_stats_t *stats);
+
 void dump_bin(const char* title, const char* data, int size);
 
 int sock_send_fd(int sock_fd, const uint8_t* buffer, int len, int send_fd);
@@ -92,6 +92,34 @@ bt_status_t btif_storage_get_remote_device_property(bt_bdaddr_t *remote_bd_addr,
 bt_status_t btif_storage_set_remote_device_property(bt_bdaddr_t *remote_bd_addr,
                                                     bt_property_t *property);
 
+/*******************************************************************************
+**
+** Function         btif_storage_has_fresh_remote_name
+**
+** Description      BTIF storage API - Checks whether the stored name of the
+**                  remote device was learnt within BTIF_STORAGE_NAME_TTL_S
+**
+** Returns          TRUE if the name can be used without a remote name request
+**
+*******************************************************************************/
+BOOLEAN btif_storage_has_fresh_remote_name(const bt_bdaddr_t *remote_bd_addr);
+
+/*******************************************************************************
+**
+** Function         btif_storage_get_fresh_remote_services
+**
+** Description      BTIF storage API - Fetches the stored UUIDs of the remote
+**                  device into |property| if they were discovered within
+**                  BTIF_STORAGE_SERVICE_TTL_S. |property| must be of type
+**                  BT_PROPERTY_UUIDS with memory provided by the caller.
+**
+** Returns          BT_STATUS_SUCCESS if fresh UUIDs were found,
+**                  BT_STATUS_FAIL otherwise
+**
+*******************************************************************************/
+bt_status_t btif_storage_get_fresh_remote_services(bt_bdaddr_t *remote_bd_addr,
+                                                   bt_property_t *property);
+
 /*******************************************************************************
 **
 ** Function         btif_storage_add_remote_device
@@ -148,6 +176,20 @@ bt_status_t btif_storage_remove_bonded_device(bt_bdaddr_t *remote_bd_addr);
 *******************************************************************************/
 bt_status_t btif_storage_load_bonded_devices(void);
 
+/*******************************************************************************
+**
+** Function         btif_storage_hydrate_remote_device
+**
+** Description      BTIF storage API - Sends the properties of a bonded device
+**                  to the framework if they have not been sent since the
+**                  bonded devices were loaded
+**
+** Returns          BT_STATUS_SUCCESS if the properties were sent,
+**                  BT_STATUS_FAIL if there was nothing to send
+**
+*******************************************************************************/
+bt_status_t btif_storage_hydrate_remote_device(bt_bdaddr_t *remote_bd_addr);
+
 /*******************************************************************************
 **
 ** Function         btif_storage_read_hl_apps_cb
@@ -50,6 +50,7 @@
 #include <hardware/bt_sock.h>
 
 #include "bt_utils.h"
+#include "btcore/include/module.h"
 #include "btif_api.h"
 #include "btif_debug.h"
 #include "btsnoop.h"
@@ -60,6 +61,7 @@
 #include "osi/include/log.h"
 #include "osi/include/metrics.h"
 #include "osi/include/osi.h"
+#include "osi/include/slab_allocator.h"
 #include "osi/include/wakelock.h"
 #include "stack_manager.h"
 #include "btif_config.h"
@@ -67,6 +69,8 @@
 #include "btif/include/btif_debug_btsnoop.h"
 #include "btif/include/btif_debug_conn.h"
 #include "btif/include/btif_debug_l2c.h"
+#include "btif/include/btif_hh_input.h"
+#include "btif/include/btif_sock.h"
 #include "btif/include/btif_media.h"
 #if defined(MTK_LINUX_GAP) && (MTK_LINUX_GAP == TRUE)
 #include "stack/include/hcimsgs.h"
@@ -409,10 +413,16 @@ static void dump(int fd, const char **arguments)
     btif_debug_conn_dump(fd);
     btif_debug_bond_event_dump(fd);
     btif_debug_a2dp_dump(fd);
+    btif_debug_hh_input_dump(fd);
     btif_debug_l2c_dump(fd);
+    btif_debug_sock_dump(fd);
     btif_debug_config_dump(fd);
+    btif_debug_worker_pool_dump(fd);
+    module_debug_dump(fd);
     wakelock_debug_dump(fd);
     alarm_debug_dump(fd);
+    slab_allocator_debug_dump(fd);
+    metrics_histogram_debug_dump(fd);
 #if defined(BTSNOOP_MEM) && (BTSNOOP_MEM == TRUE)
     btif_debug_btsnoop_dump(fd);
 #endif
@@ -42,6 +42,7 @@
 #include "osi/include/config.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
+#include "osi/include/time.h"
 #ifdef MTK_BLUEDROID_PATCH
 #include "mdroid_buildcfg.h"
 #endif
@@ -84,6 +85,9 @@ static const char *CONFIG_LEGACY_FILE_PATH = "/data/misc/bluedroid/bt_config.xml
 #endif  // defined(MTK_LINUX)
 
 static const period_ms_t CONFIG_SETTLE_PERIOD_MS = 3000;
+// Each change re-arms the settle timer; this bounds how long a stream of
+// changes can keep the config from being written.
+static const period_ms_t CONFIG_MAX_SETTLE_PERIOD_MS = 10000;
 
 static void timer_config_save_cb(void *data);
 static void btif_config_write(UINT16 event, char *p_param);
@@ -144,6 +148,11 @@ bool btif_get_address_type(const BD_ADDR bd_addr, int *p_addr_type)
 }
 
 static pthread_mutex_t lock;  // protects operations on |config|.
+// Generation of |config| when it was last written, and when it was first
+// changed after that. Both are protected by |lock|.
+static uint64_t saved_generation = UINT64_MAX;
+static uint32_t dirty_since_ms;
+static bool dirty;
 static config_t *config;
 static alarm_t *config_timer;
 
@@ -458,6 +467,17 @@ const char *btif_config_section_name(const btif_config_section_iter_t *section)
   return config_section_name((const config_section_node_t *)section);
 }
 
+bool btif_config_foreach(btif_config_foreach_cb callback, void *context) {
+  assert(config != NULL);
+  assert(callback != NULL);
+
+  pthread_mutex_lock(&lock);
+  bool ret = config_foreach(config, callback, context);
+  pthread_mutex_unlock(&lock);
+
+  return ret;
+}
+
 bool btif_config_remove(const char *section, const char *key) {
   assert(config != NULL);
   assert(section != NULL);
@@ -474,7 +494,20 @@ void btif_config_save(void) {
   assert(config != NULL);
   assert(config_timer != NULL);
 
-  alarm_set(config_timer, CONFIG_SETTLE_PERIOD_MS, timer_config_save_cb, NULL);
+  period_ms_t delay = CONFIG_SETTLE_PERIOD_MS;
+  uint32_t now = time_get_os_boottime_ms();
+
+  pthread_mutex_lock(&lock);
+  if (!dirty) {
+    dirty = true;
+    dirty_since_ms = now;
+  }
+  period_ms_t elapsed = now - dirty_since_ms;
+  if (elapsed + delay > CONFIG_MAX_SETTLE_PERIOD_MS)
+    delay = elapsed < CONFIG_MAX_SETTLE_PERIOD_MS ? CONFIG_MAX_SETTLE_PERIOD_MS - elapsed : 0;
+  pthread_mutex_unlock(&lock);
+
+  alarm_set(config_timer, delay, timer_config_save_cb, NULL);
 }
 
 void btif_config_flush(void) {
@@ -502,15 +535,22 @@ bool btif_config_clear(void) {
 
   bool ret = config_save(config, CONFIG_FILE_PATH);
   btif_config_source = RESET;
+  saved_generation = ret ? config_generation(config) : UINT64_MAX;
+  dirty = false;
   pthread_mutex_unlock(&lock);
   return ret;
 }
 
+static void config_write_cb(UNUSED_ATTR void *context) {
+  btif_config_write(0, NULL);
+}
+
 static void timer_config_save_cb(UNUSED_ATTR void *data) {
-  // Moving file I/O to btif context instead of timer callback because
-  // it usually takes a lot of time to be completed, introducing
-  // delays during A2DP playback causing blips or choppiness.
-  btif_transfer_context(btif_config_write, 0, NULL, 0, NULL);
+  // Moving file I/O off the timer callback because it usually takes a lot
+  // of time to be completed, introducing delays during A2DP playback
+  // causing blips or choppiness. The write holds |lock| throughout, so it
+  // need not run on the btif thread either.
+  btif_worker_post(THREAD_POOL_PRIORITY_LOW, config_write_cb, NULL);
 }
 
 static void btif_config_write(UNUSED_ATTR UINT16 event, UNUSED_ATTR char *p_param) {
@@ -518,11 +558,25 @@ static void btif_config_write(UNUSED_ATTR UINT16 event, UNUSED_ATTR char *p_para
   assert(config_timer != NULL);
 
   pthread_mutex_lock(&lock);
-  rename(CONFIG_FILE_PATH, CONFIG_BACKUP_PATH);
+  dirty = false;
+  uint64_t generation = config_generation(config);
+  if (generation == saved_generation) {
+    pthread_mutex_unlock(&lock);
+    return;
+  }
+
+  // Most changes only touch devices that are not paired and are never
+  // written, so the file often already holds the paired config.
   config_t *config_paired = config_new_clone(config);
   btif_config_remove_unpaired(config_paired);
-  config_save(config_paired, CONFIG_FILE_PATH);
+  bool saved = config_is_saved(config_paired, CONFIG_FILE_PATH);
+  if (!saved) {
+    rename(CONFIG_FILE_PATH, CONFIG_BACKUP_PATH);
+    saved = config_save(config_paired, CONFIG_FILE_PATH);
+  }
   config_free(config_paired);
+  if (saved)
+    saved_generation = generation;
   pthread_mutex_unlock(&lock);
 }
 
@@ -64,6 +64,7 @@
 #include "osi/include/osi.h"
 #include "osi/include/properties.h"
 #include "osi/include/thread.h"
+#include "osi/include/thread_pool.h"
 #include "stack_manager.h"
 
 #ifdef MTK_BLUEDROID_PATCH
@@ -137,6 +138,10 @@ static UINT8 btif_dut_mode = 0;
 
 static thread_t *bt_jni_workqueue_thread;
 static const char *BT_JNI_WORKQUEUE_NAME = "bt_jni_workqueue";
+// Runs work that need not be ordered with the btif events, on idle cores.
+static thread_pool_t *bt_worker_pool;
+static const char *BT_WORKER_POOL_NAME = "bt_worker";
+static const long BT_WORKER_POOL_MAX_THREADS = 4;
 static uid_set_t* uid_set = NULL;
 #if defined(MTK_LINUX_RESET) && (MTK_LINUX_RESET == TRUE)
 static const hci_t *hci;
@@ -344,6 +349,36 @@ void btif_thread_post(thread_fn func, void *context) {
   thread_post(bt_jni_workqueue_thread, func, context);
 }
 
+void btif_worker_post(thread_pool_priority_t priority, thread_fn func, void *context) {
+  if (!bt_worker_pool || !thread_pool_post(bt_worker_pool, priority, func, context))
+    btif_thread_post(func, context);
+}
+
+void btif_debug_worker_pool_dump(int fd) {
+  dprintf(fd, "\nBluetooth Worker Pool:\n");
+
+  if (!bt_worker_pool) {
+    dprintf(fd, "  None\n");
+    return;
+  }
+
+  thread_pool_stats_t stats;
+  thread_pool_get_stats(bt_worker_pool, &stats);
+
+  uint64_t ave_wait_us = 0;
+  if (stats.tasks_run != 0)
+    ave_wait_us = stats.total_wait_us / stats.tasks_run;
+
+  dprintf(fd, "  Tasks (run/stolen)                  : %zu / %zu\n",
+          stats.tasks_run, stats.tasks_stolen);
+  dprintf(fd, "  Queue depth (now/max)               : %zu / %zu\n",
+          stats.queue_depth, stats.max_queue_depth);
+  dprintf(fd, "  Wait time in us (total/max/ave)     : %llu / %llu / %llu\n",
+          (unsigned long long)stats.total_wait_us,
+          (unsigned long long)stats.max_wait_us,
+          (unsigned long long)ave_wait_us);
+}
+
 static bool btif_fetch_property(const char *key, bt_bdaddr_t *addr) {
     char val[PROPERTY_VALUE_MAX] = {0};
 
@@ -471,6 +506,15 @@ bt_status_t btif_init_bluetooth() {
   // Associate this workqueue thread with jni.
   btif_transfer_context(btif_jni_associate, 0, NULL, 0, NULL);
 
+  // Without the pool, its work runs on the workqueue thread.
+  long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (num_cpus < 1)
+    num_cpus = 1;
+  bt_worker_pool = thread_pool_new(BT_WORKER_POOL_NAME,
+      num_cpus < BT_WORKER_POOL_MAX_THREADS ? num_cpus : BT_WORKER_POOL_MAX_THREADS);
+  if (bt_worker_pool == NULL)
+    LOG_WARN(LOG_TAG, "%s Unable to create worker pool %s", __func__, BT_WORKER_POOL_NAME);
+
   return BT_STATUS_SUCCESS;
 
 error_exit:;
@@ -663,6 +707,12 @@ bt_status_t btif_cleanup_bluetooth(void)
     btif_jni_disassociate();
     btif_queue_release();
 
+    // The pool runs what is queued on it before it stops; work posted
+    // meanwhile goes to the workqueue thread.
+    thread_pool_t *pool = bt_worker_pool;
+    bt_worker_pool = NULL;
+    thread_pool_free(pool);
+
     thread_free(bt_jni_workqueue_thread);
     bt_jni_workqueue_thread = NULL;
 
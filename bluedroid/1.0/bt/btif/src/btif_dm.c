@@ -558,6 +558,7 @@ static void bond_state_changed(bt_status_t status, bt_bdaddr_t *bd_addr, bt_bond
 {
 
     btif_stats_add_bond_event(bd_addr, BTIF_DM_FUNC_BOND_STATE_CHANGED, state);
+    btif_storage_hydrate_remote_device(bd_addr);
 
     // Send bonding state only once - based on outgoing/incoming we may receive duplicates
     if ((pairing_cb.state == state) && (state == BT_BOND_STATE_BONDING))
@@ -1885,6 +1886,7 @@ static void btif_dm_upstreams_evt(UINT16 event, char* p_param)
             BTIF_TRACE_DEBUG("BTA_DM_LINK_UP_EVT. Sending BT_ACL_STATE_CONNECTED");
 
             btif_update_remote_version_property(&bd_addr);
+            btif_storage_hydrate_remote_device(&bd_addr);
 
             HAL_CBACK(bt_hal_cbacks, acl_state_changed_cb, BT_STATUS_SUCCESS,
                       &bd_addr, BT_ACL_STATE_CONNECTED);
@@ -2245,9 +2247,16 @@ static void bte_search_devices_evt(tBTA_DM_SEARCH_EVT event, tBTA_DM_SEARCH *p_d
     }
     BTIF_TRACE_DEBUG("%s event=%s param_len=%d", __FUNCTION__, dump_dm_search_event(event), param_len);
 
-    /* if remote name is available in EIR, set teh flag so that stack doesnt trigger RNR */
+    /* if remote name is available in EIR, or was learnt recently enough to be
+       trusted, set the flag so that stack doesnt trigger RNR */
     if (event == BTA_DM_INQ_RES_EVT)
-        p_data->inq_res.remt_name_not_required = check_eir_remote_name(p_data, NULL, NULL);
+    {
+        bt_bdaddr_t bd_addr;
+        bdcpy(bd_addr.address, p_data->inq_res.bd_addr);
+        p_data->inq_res.remt_name_not_required =
+            check_eir_remote_name(p_data, NULL, NULL) ||
+            btif_storage_has_fresh_remote_name(&bd_addr);
+    }
 
     btif_transfer_context (btif_dm_search_devices_evt , (UINT16) event, (void *)p_data, param_len,
         (param_len > sizeof(tBTA_DM_SEARCH)) ? search_devices_copy_cb : NULL);
@@ -2743,6 +2752,36 @@ bt_status_t btif_dm_get_adapter_property(bt_property_t *prop)
     return BT_STATUS_SUCCESS;
 }
 
+/*******************************************************************************
+**
+** Function         btif_dm_cached_services_evt
+**
+** Description      Reports the stored services of a device in place of an
+**                  SDP search, in btif context
+**
+** Returns          void
+**
+*******************************************************************************/
+static void btif_dm_cached_services_evt(UINT16 event, char *p_param)
+{
+    bt_bdaddr_t *bd_addr = (bt_bdaddr_t *)p_param;
+    bt_uuid_t uuids[BT_MAX_NUM_UUIDS];
+    bt_property_t prop;
+    UNUSED(event);
+
+    BTIF_STORAGE_FILL_PROPERTY(&prop, BT_PROPERTY_UUIDS, sizeof(uuids), uuids);
+    if (btif_storage_get_fresh_remote_services(bd_addr, &prop) != BT_STATUS_SUCCESS)
+    {
+        /* Expired or removed since the request was made */
+        BTA_DmDiscover(bd_addr->address, BTA_ALL_SERVICE_MASK,
+                       bte_dm_search_services_evt, TRUE);
+        return;
+    }
+
+    HAL_CBACK(bt_hal_cbacks, remote_device_properties_cb,
+              BT_STATUS_SUCCESS, bd_addr, 1, &prop);
+}
+
 /*******************************************************************************
 **
 ** Function         btif_dm_get_remote_services
@@ -2758,6 +2797,24 @@ bt_status_t btif_dm_get_remote_services(bt_bdaddr_t *remote_addr)
 
     BTIF_TRACE_EVENT("%s: remote_addr=%s", __FUNCTION__, bdaddr_to_string(remote_addr, bdstr, sizeof(bdstr)));
 
+    /* Pairing always searches the device again, as bonding may change the
+       services it exposes. Otherwise a recent result is as good as a new one
+       and saves a page and an SDP search. */
+    if (!(pairing_cb.state == BT_BOND_STATE_BONDING &&
+          bdcmp(pairing_cb.bd_addr, remote_addr->address) == 0))
+    {
+        bt_uuid_t uuids[BT_MAX_NUM_UUIDS];
+        bt_property_t prop;
+
+        BTIF_STORAGE_FILL_PROPERTY(&prop, BT_PROPERTY_UUIDS, sizeof(uuids), uuids);
+        if (btif_storage_get_fresh_remote_services(remote_addr, &prop) == BT_STATUS_SUCCESS)
+        {
+            BTIF_TRACE_DEBUG("%s: using cached services for %s", __FUNCTION__, bdstr);
+            return btif_transfer_context(btif_dm_cached_services_evt, 0,
+                                         (char *)remote_addr, sizeof(bt_bdaddr_t), NULL);
+        }
+    }
+
     BTA_DmDiscover(remote_addr->address, BTA_ALL_SERVICE_MASK,
                    bte_dm_search_services_evt, TRUE);
 
@@ -28,6 +28,7 @@
 
 #include <errno.h>
 #include <hardware/bluetooth.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -50,7 +51,10 @@
 #include "btif_gatt_util.h"
 #include "btif_storage.h"
 #include "btif_storage.h"
+#include "osi/include/alarm.h"
 #include "osi/include/log.h"
+#include "osi/include/osi.h"
+#include "osi/include/time.h"
 #include "vendor_api.h"
 #if defined(MTK_LINUX_GATT) && (MTK_LINUX_GATT == TRUE)
 #include "mtk_bt_gatt.h"
@@ -139,11 +143,29 @@ typedef enum {
 
 #define BTIF_GATT_MAX_OBSERVED_DEV 40
 
-#define BTIF_GATT_OBSERVE_EVT   0x1000
+#define BTIF_GATT_OBSERVE_BATCH_EVT 0x1000
 #define BTIF_GATTC_RSSI_EVT     0x1001
 #define BTIF_GATTC_SCAN_FILTER_EVT  0x1003
 #define BTIF_GATTC_SCAN_PARAM_EVT   0x1004
 
+/* Length of the advertising data of a scan result (advertisement and scan
+** response), as passed to scan_result_cb. */
+#define BTIF_GATT_ADV_DATA_LEN      62
+
+/* Scan results are deduplicated on the btu thread before they are sent up:
+** a report is only delivered if the device is new to the scan, its payload
+** changed, its RSSI moved by BTIF_GATT_SCAN_RSSI_DELTA or more, or
+** BTIF_GATT_SCAN_REPEAT_MS went by since it was last delivered. */
+#define BTIF_GATT_SCAN_SEEN_SIZE    256     /* Power of two */
+#define BTIF_GATT_SCAN_SEEN_PROBES  8
+#define BTIF_GATT_SCAN_RSSI_DELTA   10
+#define BTIF_GATT_SCAN_REPEAT_MS    1000
+
+/* Delivered results are sent to the btif thread in batches of up to
+** BTIF_GATT_SCAN_BATCH_SIZE, or after BTIF_GATT_SCAN_BATCH_MS at the latest. */
+#define BTIF_GATT_SCAN_BATCH_SIZE   16
+#define BTIF_GATT_SCAN_BATCH_MS     50
+
 #define ENABLE_BATCH_SCAN 1
 #define DISABLE_BATCH_SCAN 0
 
@@ -273,15 +295,49 @@ typedef struct
     uint8_t            next_storage_idx;
 }__attribute__((packed)) btif_gattc_dev_cb_t;
 
+typedef struct
+{
+    bt_bdaddr_t     bd_addr;
+    tBT_DEVICE_TYPE device_type;
+    int8_t          rssi;
+    uint8_t         addr_type;
+    uint8_t         flag;
+    uint8_t         value[BTIF_GATT_ADV_DATA_LEN];
+} btif_gattc_scan_result_t;
+
+typedef struct
+{
+    uint8_t                  count;
+    btif_gattc_scan_result_t results[BTIF_GATT_SCAN_BATCH_SIZE];
+} btif_gattc_scan_batch_t;
+
+typedef struct
+{
+    bt_bdaddr_t bd_addr;
+    uint32_t    epoch;              /* Scan the entry belongs to, 0 if unused */
+    uint32_t    payload_hash[2];    /* Advertisement and scan response */
+    uint32_t    delivered_ms;
+    int8_t      rssi;
+} btif_gattc_scan_seen_t;
+
 /*******************************************************************************
 **  Static variables
 ********************************************************************************/
 
 extern const btgatt_callbacks_t *bt_gatt_callbacks;
+extern fixed_queue_t *btu_general_alarm_queue;
 static btif_gattc_dev_cb_t  btif_gattc_dev_cb;
 static btif_gattc_dev_cb_t  *p_dev_cb = &btif_gattc_dev_cb;
 static uint8_t rssi_request_client_if;
 
+/* Owned by the btu thread, except for |scan_epoch| which is bumped on the
+** btif thread before each scan is started. */
+static btif_gattc_scan_seen_t scan_seen[BTIF_GATT_SCAN_SEEN_SIZE];
+static btif_gattc_scan_batch_t scan_batch;
+static alarm_t *scan_batch_timer;
+static uint32_t scan_epoch;
+static uint32_t scan_reports_dropped;
+
 #if defined(MTK_LINUX_GATT) && (MTK_LINUX_GATT == TRUE)
 extern const btgatt_ex_callbacks_t *bt_gatt_ex_callbacks;
 #endif
@@ -466,7 +522,7 @@ static BOOLEAN btif_gattc_find_bdaddr (BD_ADDR p_bda)
     return FALSE;
 }
 
-static void btif_gattc_update_properties ( btif_gattc_cb_t *p_btif_cb )
+static void btif_gattc_update_properties ( btif_gattc_scan_result_t *p_btif_cb )
 {
     uint8_t remote_name_len;
     uint8_t *p_eir_remote_name=NULL;
@@ -493,6 +549,42 @@ static void btif_gattc_update_properties ( btif_gattc_cb_t *p_btif_cb )
     }
 }
 
+static void btif_gattc_deliver_scan_result(btif_gattc_scan_result_t *p_btif_cb)
+{
+    uint8_t remote_name_len;
+    uint8_t *p_eir_remote_name=NULL;
+    bt_device_type_t dev_type;
+    bt_property_t properties;
+
+    p_eir_remote_name = BTM_CheckEirData(p_btif_cb->value,
+                                 BTM_EIR_COMPLETE_LOCAL_NAME_TYPE, &remote_name_len);
+
+    if (p_eir_remote_name == NULL)
+    {
+        p_eir_remote_name = BTM_CheckEirData(p_btif_cb->value,
+                        BT_EIR_SHORTENED_LOCAL_NAME_TYPE, &remote_name_len);
+    }
+
+    if ((p_btif_cb->addr_type != BLE_ADDR_RANDOM) || (p_eir_remote_name))
+    {
+       if (!btif_gattc_find_bdaddr(p_btif_cb->bd_addr.address))
+       {
+          btif_gattc_add_remote_bdaddr(p_btif_cb->bd_addr.address, p_btif_cb->addr_type);
+          btif_gattc_update_properties(p_btif_cb);
+       }
+    }
+
+    dev_type =  p_btif_cb->device_type;
+    BTIF_STORAGE_FILL_PROPERTY(&properties,
+                BT_PROPERTY_TYPE_OF_DEVICE, sizeof(dev_type), &dev_type);
+    btif_storage_set_remote_device_property(&(p_btif_cb->bd_addr), &properties);
+
+    btif_storage_set_remote_addr_type( &p_btif_cb->bd_addr, p_btif_cb->addr_type);
+
+    HAL_CBACK(bt_gatt_callbacks, client->scan_result_cb,
+              &p_btif_cb->bd_addr, p_btif_cb->rssi, p_btif_cb->value);
+}
+
 static void btif_gattc_upstreams_evt(uint16_t event, char* p_param)
 {
     LOG_VERBOSE(LOG_TAG, "%s: Event %d", __FUNCTION__, event);
@@ -626,41 +718,12 @@ static void btif_gattc_upstreams_evt(uint16_t event, char* p_param)
         case BTA_GATTC_CANCEL_OPEN_EVT:
             break;
 
-        case BTIF_GATT_OBSERVE_EVT:
+        case BTIF_GATT_OBSERVE_BATCH_EVT:
         {
-            btif_gattc_cb_t *p_btif_cb = (btif_gattc_cb_t*) p_param;
-            uint8_t remote_name_len;
-            uint8_t *p_eir_remote_name=NULL;
-            bt_device_type_t dev_type;
-            bt_property_t properties;
-
-            p_eir_remote_name = BTM_CheckEirData(p_btif_cb->value,
-                                         BTM_EIR_COMPLETE_LOCAL_NAME_TYPE, &remote_name_len);
-
-            if (p_eir_remote_name == NULL)
-            {
-                p_eir_remote_name = BTM_CheckEirData(p_btif_cb->value,
-                                BT_EIR_SHORTENED_LOCAL_NAME_TYPE, &remote_name_len);
-            }
-
-            if ((p_btif_cb->addr_type != BLE_ADDR_RANDOM) || (p_eir_remote_name))
-            {
-               if (!btif_gattc_find_bdaddr(p_btif_cb->bd_addr.address))
-               {
-                  btif_gattc_add_remote_bdaddr(p_btif_cb->bd_addr.address, p_btif_cb->addr_type);
-                  btif_gattc_update_properties(p_btif_cb);
-               }
-            }
-
-             dev_type =  p_btif_cb->device_type;
-             BTIF_STORAGE_FILL_PROPERTY(&properties,
-                        BT_PROPERTY_TYPE_OF_DEVICE, sizeof(dev_type), &dev_type);
-             btif_storage_set_remote_device_property(&(p_btif_cb->bd_addr), &properties);
-
-            btif_storage_set_remote_addr_type( &p_btif_cb->bd_addr, p_btif_cb->addr_type);
-
-            HAL_CBACK(bt_gatt_callbacks, client->scan_result_cb,
-                      &p_btif_cb->bd_addr, p_btif_cb->rssi, p_btif_cb->value);
+            btif_gattc_scan_batch_t *p_batch = (btif_gattc_scan_batch_t*) p_param;
+            uint8_t i;
+            for (i = 0; i < p_batch->count; i++)
+                btif_gattc_deliver_scan_result(&p_batch->results[i]);
             break;
         }
 
@@ -1075,23 +1138,140 @@ static void bta_batch_scan_reports_cb(tBTA_DM_BLE_REF_VALUE ref_value, UINT8 rep
         osi_free_and_reset((void **)&btif_scan_track_cb.read_reports.p_rep_data);
 }
 
+static uint32_t btif_gattc_scan_hash(const uint8_t *p, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    size_t i;
+    for (i = 0; i < len; i++)
+        hash = (hash ^ p[i]) * 16777619u;
+    return hash;
+}
+
+/* Hashes the AD structures of |p_res|, ignoring the padding after them. */
+static uint32_t btif_gattc_scan_payload_hash(const btif_gattc_scan_result_t *p_res)
+{
+    size_t len = 0;
+    while (len < BTIF_GATT_ADV_DATA_LEN && p_res->value[len] != 0)
+        len += p_res->value[len] + 1;
+    if (len > BTIF_GATT_ADV_DATA_LEN)
+        len = BTIF_GATT_ADV_DATA_LEN;
+    return btif_gattc_scan_hash(p_res->value, len);
+}
+
+/* Returns TRUE if |p_res| tells the upper layers something new about the
+** device, and records it as delivered. Runs on the btu thread. */
+static BOOLEAN btif_gattc_scan_should_deliver(const btif_gattc_scan_result_t *p_res)
+{
+    uint32_t epoch = scan_epoch;
+    uint32_t now_ms = (uint32_t)time_get_os_boottime_ms();
+    uint32_t payload_hash = btif_gattc_scan_payload_hash(p_res);
+    uint32_t home = btif_gattc_scan_hash(p_res->bd_addr.address, BD_ADDR_LEN);
+    btif_gattc_scan_seen_t *p_seen = NULL;
+    btif_gattc_scan_seen_t *p_victim = NULL;
+    int i;
+
+    for (i = 0; i < BTIF_GATT_SCAN_SEEN_PROBES; i++)
+    {
+        btif_gattc_scan_seen_t *p_entry =
+            &scan_seen[(home + i) & (BTIF_GATT_SCAN_SEEN_SIZE - 1)];
+        if (p_entry->epoch != epoch)
+        {
+            if (p_victim == NULL || p_victim->epoch == epoch)
+                p_victim = p_entry;
+            continue;
+        }
+        if (!bdaddr_equals(&p_entry->bd_addr, &p_res->bd_addr))
+        {
+            if (p_victim == NULL || (p_victim->epoch == epoch &&
+                (int32_t)(p_entry->delivered_ms - p_victim->delivered_ms) < 0))
+                p_victim = p_entry;
+            continue;
+        }
+        p_seen = p_entry;
+        break;
+    }
+
+    if (p_seen == NULL)
+    {
+        /* New to this scan, or evicted: it takes the oldest slot. */
+        p_seen = p_victim;
+        bdaddr_copy(&p_seen->bd_addr, &p_res->bd_addr);
+        p_seen->epoch = epoch;
+        p_seen->payload_hash[0] = payload_hash;
+        p_seen->payload_hash[1] = payload_hash;
+    }
+    else if (payload_hash != p_seen->payload_hash[0] &&
+             payload_hash != p_seen->payload_hash[1])
+    {
+        p_seen->payload_hash[1] = p_seen->payload_hash[0];
+        p_seen->payload_hash[0] = payload_hash;
+    }
+    else if (abs(p_res->rssi - p_seen->rssi) < BTIF_GATT_SCAN_RSSI_DELTA &&
+             now_ms - p_seen->delivered_ms < BTIF_GATT_SCAN_REPEAT_MS)
+    {
+        scan_reports_dropped++;
+        return FALSE;
+    }
+
+    p_seen->rssi = p_res->rssi;
+    p_seen->delivered_ms = now_ms;
+    return TRUE;
+}
+
+static void btif_gattc_scan_batch_flush(void)
+{
+    if (scan_batch.count == 0)
+        return;
+
+    btif_transfer_context(btif_gattc_upstreams_evt, BTIF_GATT_OBSERVE_BATCH_EVT,
+        (char*) &scan_batch,
+        offsetof(btif_gattc_scan_batch_t, results) +
+            scan_batch.count * sizeof(btif_gattc_scan_result_t), NULL);
+    scan_batch.count = 0;
+}
+
+static void btif_gattc_scan_batch_timeout(UNUSED_ATTR void *data)
+{
+    btif_gattc_scan_batch_flush();
+}
+
+static void btif_gattc_scan_batch_add(const btif_gattc_scan_result_t *p_res)
+{
+    if (scan_batch_timer == NULL)
+        scan_batch_timer = alarm_new("btif_gattc.scan_batch_timer");
+
+    scan_batch.results[scan_batch.count++] = *p_res;
+    if (scan_batch.count == BTIF_GATT_SCAN_BATCH_SIZE)
+    {
+        alarm_cancel(scan_batch_timer);
+        btif_gattc_scan_batch_flush();
+    }
+    else if (scan_batch.count == 1)
+    {
+        alarm_set_on_queue(scan_batch_timer, BTIF_GATT_SCAN_BATCH_MS,
+                           btif_gattc_scan_batch_timeout, NULL,
+                           btu_general_alarm_queue);
+    }
+}
+
 static void bta_scan_results_cb (tBTA_DM_SEARCH_EVT event, tBTA_DM_SEARCH *p_data)
 {
-    btif_gattc_cb_t btif_cb;
+    btif_gattc_scan_result_t result;
     uint8_t len;
 
     switch (event)
     {
         case BTA_DM_INQ_RES_EVT:
         {
-            bdcpy(btif_cb.bd_addr.address, p_data->inq_res.bd_addr);
-            btif_cb.device_type = p_data->inq_res.device_type;
-            btif_cb.rssi = p_data->inq_res.rssi;
-            btif_cb.addr_type = p_data->inq_res.ble_addr_type;
-            btif_cb.flag = p_data->inq_res.flag;
+            bdcpy(result.bd_addr.address, p_data->inq_res.bd_addr);
+            result.device_type = p_data->inq_res.device_type;
+            result.rssi = p_data->inq_res.rssi;
+            result.addr_type = p_data->inq_res.ble_addr_type;
+            result.flag = p_data->inq_res.flag;
+            memset(result.value, 0, sizeof(result.value));
             if (p_data->inq_res.p_eir)
             {
-                memcpy(btif_cb.value, p_data->inq_res.p_eir, 62);
+                memcpy(result.value, p_data->inq_res.p_eir, BTIF_GATT_ADV_DATA_LEN);
                 if (BTM_CheckEirData(p_data->inq_res.p_eir, BTM_EIR_COMPLETE_LOCAL_NAME_TYPE,
                                       &len))
                 {
@@ -1103,8 +1283,9 @@ static void bta_scan_results_cb (tBTA_DM_SEARCH_EVT event, tBTA_DM_SEARCH *p_dat
 
         case BTA_DM_INQ_CMPL_EVT:
         {
-            BTIF_TRACE_DEBUG("%s  BLE observe complete. Num Resp %d",
-                              __FUNCTION__,p_data->inq_cmpl.num_resps);
+            BTIF_TRACE_DEBUG("%s  BLE observe complete. Num Resp %d, %u duplicates dropped",
+                              __FUNCTION__, p_data->inq_cmpl.num_resps, scan_reports_dropped);
+            btif_gattc_scan_batch_flush();
             return;
         }
 
@@ -1112,8 +1293,9 @@ static void bta_scan_results_cb (tBTA_DM_SEARCH_EVT event, tBTA_DM_SEARCH *p_dat
         BTIF_TRACE_WARNING("%s : Unknown event 0x%x", __FUNCTION__, event);
         return;
     }
-    btif_transfer_context(btif_gattc_upstreams_evt, BTIF_GATT_OBSERVE_EVT,
-                                 (char*) &btif_cb, sizeof(btif_gattc_cb_t), NULL);
+
+    if (btif_gattc_scan_should_deliver(&result))
+        btif_gattc_scan_batch_add(&result);
 }
 
 static void bta_track_adv_event_cb(tBTA_DM_BLE_TRACK_ADV_DATA *p_track_adv_data)
@@ -1240,6 +1422,9 @@ static void btgattc_handle_event(uint16_t event, char* p_param)
 
         case BTIF_GATTC_SCAN_START:
             btif_gattc_init_dev_cb();
+            /* Forget what the previous scan delivered; 0 marks unused entries. */
+            if (++scan_epoch == 0)
+                scan_epoch = 1;
             BTA_DmBleObserve(TRUE, 0, bta_scan_results_cb);
             break;
 
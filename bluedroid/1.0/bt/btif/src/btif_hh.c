@@ -41,6 +41,7 @@
 
 #include "bta_api.h"
 #include "btif_common.h"
+#include "btif_hh_input.h"
 #include "btif_storage.h"
 #include "btif_util.h"
 #include "bt_common.h"
@@ -1694,11 +1695,13 @@ bt_status_t btif_hh_execute_service(BOOLEAN b_enable)
      if (b_enable)
      {
           /* Enable and register with BTA-HH */
+          btif_hh_input_start();
           BTA_HhEnable(BTUI_HH_SECURITY, bte_hh_evt);
      }
      else {
          /* Disable HH */
          BTA_HhDisable();
+         btif_hh_input_stop();
      }
      return BT_STATUS_SUCCESS;
 }
@@ -0,0 +1,277 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#define LOG_TAG "bt_btif_hh_input"
+
+#ifdef MTK_BLUEDROID_PATCH
+#include "mdroid_buildcfg.h"
+#endif
+
+#include "btif/include/btif_hh_input.h"
+
+#include <errno.h>
+#if defined(MTK_LINUX) && defined(MTK_COMMON) && (MTK_COMMON == TRUE)
+#include "uhid.h"
+#else
+#include <linux/uhid.h>
+#endif
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/prctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "osi/include/log.h"
+#include "osi/include/osi.h"
+
+// Number of reports the ring holds, a power of two.
+#define RING_SLOTS 64
+#define RING_MASK (RING_SLOTS - 1)
+
+// Largest report kept in the ring. Boot and gamepad reports are a few bytes;
+// larger ones flush the ring and are written by the caller.
+#define SLOT_DATA_SIZE 128
+
+// Latency buckets: bucket |i| counts writes completing in [2^(i-1), 2^i) us,
+// bucket 0 those under 1 us, and the last one everything slower.
+#define LATENCY_BUCKETS 18
+
+typedef struct {
+  int fd;
+  uint16_t len;
+  uint64_t queued_us;
+  uint8_t data[SLOT_DATA_SIZE];
+} input_slot_t;
+
+static const char *WRITER_THREAD_NAME = "bt_hh_input";
+
+static input_slot_t ring[RING_SLOTS];
+static atomic_size_t write_pos;  // Next slot the stack thread fills.
+static atomic_size_t read_pos;   // Next slot the writer thread empties.
+static atomic_bool running;
+
+static int wakeup_fd = INVALID_FD;
+static pthread_t writer_thread;
+
+// Only used when the ring is full or on a flush.
+static pthread_mutex_t drain_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t drain_cond = PTHREAD_COND_INITIALIZER;
+static atomic_bool drain_waiting;
+
+// Updated by the writer thread only.
+static uint64_t latency_histogram[LATENCY_BUCKETS];
+static uint64_t max_latency_us;
+static uint64_t reports_written;
+static uint64_t write_errors;
+static atomic_uint_least64_t ring_full_count;
+static atomic_uint_least64_t slow_path_count;
+
+static void *writer_thread_fn(void *context);
+
+static uint64_t now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+bool btif_hh_input_start(void) {
+  if (atomic_load(&running))
+    return true;
+
+  if (wakeup_fd == INVALID_FD) {
+    wakeup_fd = eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd == INVALID_FD) {
+      LOG_ERROR(LOG_TAG, "%s unable to create eventfd: %s", __func__, strerror(errno));
+      return false;
+    }
+  }
+
+  atomic_store(&write_pos, 0);
+  atomic_store(&read_pos, 0);
+  atomic_store_explicit(&running, true, memory_order_release);
+
+  if (pthread_create(&writer_thread, NULL, writer_thread_fn, NULL)) {
+    LOG_ERROR(LOG_TAG, "%s unable to create writer thread.", __func__);
+    atomic_store(&running, false);
+    return false;
+  }
+
+  return true;
+}
+
+void btif_hh_input_stop(void) {
+  if (!atomic_exchange(&running, false))
+    return;
+
+  eventfd_write(wakeup_fd, 1);
+  pthread_join(writer_thread, NULL);
+}
+
+// Waits until the writer thread has emptied the ring up to |pos|.
+static void wait_for_read_pos(size_t pos) {
+  pthread_mutex_lock(&drain_lock);
+  for (;;) {
+    // Set before checking |read_pos|, so that the writer thread either sees
+    // the flag or has already moved |read_pos|.
+    atomic_store(&drain_waiting, true);
+    if (!atomic_load(&running) || (ssize_t)(pos - atomic_load(&read_pos)) <= 0)
+      break;
+    eventfd_write(wakeup_fd, 1);
+    pthread_cond_wait(&drain_cond, &drain_lock);
+  }
+  pthread_mutex_unlock(&drain_lock);
+}
+
+bool btif_hh_input_write(int fd, const uint8_t *report, uint16_t len) {
+  if (!atomic_load_explicit(&running, memory_order_acquire))
+    return false;
+
+  size_t pos = atomic_load_explicit(&write_pos, memory_order_relaxed);
+
+  if (len > SLOT_DATA_SIZE) {
+    // Keep the reports in order: let the queued ones go first.
+    atomic_fetch_add_explicit(&slow_path_count, 1, memory_order_relaxed);
+    wait_for_read_pos(pos);
+    return false;
+  }
+
+  if (pos - atomic_load_explicit(&read_pos, memory_order_acquire) == RING_SLOTS) {
+    atomic_fetch_add_explicit(&ring_full_count, 1, memory_order_relaxed);
+    wait_for_read_pos(pos - RING_SLOTS + 1);
+    if (!atomic_load(&running))
+      return false;
+  }
+
+  input_slot_t *slot = &ring[pos & RING_MASK];
+  slot->fd = fd;
+  slot->len = len;
+  slot->queued_us = now_us();
+  memcpy(slot->data, report, len);
+  atomic_store_explicit(&write_pos, pos + 1, memory_order_release);
+
+  eventfd_write(wakeup_fd, 1);
+  return true;
+}
+
+void btif_hh_input_flush(void) {
+  if (!atomic_load(&running))
+    return;
+
+  wait_for_read_pos(atomic_load_explicit(&write_pos, memory_order_acquire));
+}
+
+static void record_latency(uint64_t latency_us) {
+  size_t bucket = 0;
+  while (bucket < LATENCY_BUCKETS - 1 && (latency_us >> bucket) != 0)
+    bucket++;
+
+  latency_histogram[bucket]++;
+  if (latency_us > max_latency_us)
+    max_latency_us = latency_us;
+}
+
+static void write_slot(struct uhid_event *ev, const input_slot_t *slot) {
+  ev->type = UHID_INPUT;
+  ev->u.input.size = slot->len;
+  memcpy(ev->u.input.data, slot->data, slot->len);
+
+  ssize_t ret;
+  OSI_NO_INTR(ret = write(slot->fd, ev, sizeof(*ev)));
+  if (ret != (ssize_t)sizeof(*ev)) {
+    if (write_errors++ == 0)
+      LOG_ERROR(LOG_TAG, "%s unable to write to uhid: %s", __func__, strerror(errno));
+    return;
+  }
+
+  reports_written++;
+  record_latency(now_us() - slot->queued_us);
+}
+
+// Writes all queued reports. Returns true if any were written.
+static bool drain(struct uhid_event *ev) {
+  size_t read = atomic_load_explicit(&read_pos, memory_order_relaxed);
+  size_t end = atomic_load_explicit(&write_pos, memory_order_acquire);
+  if (read == end)
+    return false;
+
+  for (; read != end; ++read) {
+    write_slot(ev, &ring[read & RING_MASK]);
+    atomic_store(&read_pos, read + 1);
+  }
+  return true;
+}
+
+static void wake_drain_waiters(void) {
+  if (!atomic_load(&drain_waiting))
+    return;
+
+  pthread_mutex_lock(&drain_lock);
+  atomic_store(&drain_waiting, false);
+  pthread_cond_broadcast(&drain_cond);
+  pthread_mutex_unlock(&drain_lock);
+}
+
+static void *writer_thread_fn(UNUSED_ATTR void *context) {
+  prctl(PR_SET_NAME, (unsigned long)WRITER_THREAD_NAME, 0, 0, 0);
+
+  // Too large for the stack of a thread that may be created with a small one.
+  static struct uhid_event ev;
+  memset(&ev, 0, sizeof(ev));
+
+  while (atomic_load_explicit(&running, memory_order_acquire)) {
+    if (!drain(&ev)) {
+      eventfd_t value;
+      eventfd_read(wakeup_fd, &value);
+      continue;
+    }
+    wake_drain_waiters();
+  }
+
+  drain(&ev);
+  wake_drain_waiters();
+  return NULL;
+}
+
+void btif_debug_hh_input_dump(int fd) {
+  dprintf(fd, "\nHID input fast path:\n");
+  dprintf(fd, "  Running: %s\n", atomic_load(&running) ? "true" : "false");
+  dprintf(fd, "  Reports written: %llu (errors: %llu)\n",
+          (unsigned long long)reports_written, (unsigned long long)write_errors);
+  dprintf(fd, "  Ring full waits: %llu\n",
+          (unsigned long long)atomic_load(&ring_full_count));
+  dprintf(fd, "  Reports too large for the ring: %llu\n",
+          (unsigned long long)atomic_load(&slow_path_count));
+  dprintf(fd, "  Max queued to uhid write latency: %llu us\n",
+          (unsigned long long)max_latency_us);
+  dprintf(fd, "  Queued to uhid write latency histogram:\n");
+  for (size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+    if (latency_histogram[i] == 0)
+      continue;
+    if (i == 0)
+      dprintf(fd, "    < 1 us: %llu\n", (unsigned long long)latency_histogram[i]);
+    else if (i == LATENCY_BUCKETS - 1)
+      dprintf(fd, "    >= %llu us: %llu\n", 1ULL << (i - 1),
+              (unsigned long long)latency_histogram[i]);
+    else
+      dprintf(fd, "    %llu - %llu us: %llu\n", 1ULL << (i - 1), (1ULL << i) - 1,
+              (unsigned long long)latency_histogram[i]);
+  }
+}
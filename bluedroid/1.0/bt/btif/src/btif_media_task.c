@@ -67,6 +67,7 @@
 #include "osi/include/log.h"
 #include "osi/include/metrics.h"
 #include "osi/include/mutex.h"
+#include "osi/include/osi.h"
 #include "osi/include/thread.h"
 
 #if (BTA_AV_INCLUDED == TRUE)
@@ -183,6 +184,18 @@ enum {
 #define BTIF_MEDIA_AA_AAC_OFFSET (AVDT_MEDIA_OFFSET)
 #endif //MTK_A2DP_SRC_AAC_CODEC
 
+/* The encoders write their frames behind these offsets, leaving room for
+ * the media packet header, if any, and the L2CAP and HCI headers, which
+ * AVDTP and L2CAP then write in place. A buffer with less room is copied
+ * on its way down; see AVDT_GetWriteStats and L2CA_GetChnlTxStats. */
+COMPILE_ASSERT(BTIF_MEDIA_AA_SBC_OFFSET >= AVDT_MEDIA_HDR_SIZE + L2CAP_BASIC_MIN_OFFSET);
+#if defined(MTK_A2DP_SRC_APTX_CODEC) && (MTK_A2DP_SRC_APTX_CODEC == TRUE)
+COMPILE_ASSERT(BTIF_MEDIA_AA_APTX_OFFSET >= L2CAP_BASIC_MIN_OFFSET);
+#endif
+#if defined(MTK_A2DP_SRC_AAC_CODEC) && (MTK_A2DP_SRC_AAC_CODEC == TRUE)
+COMPILE_ASSERT(BTIF_MEDIA_AA_AAC_OFFSET >= AVDT_MEDIA_HDR_SIZE + L2CAP_BASIC_MIN_OFFSET);
+#endif
+
 /* Define the bitrate step when trying to match bitpool value */
 #ifndef BTIF_MEDIA_BITRATE_STEP
 #define BTIF_MEDIA_BITRATE_STEP 5
@@ -247,6 +260,29 @@ enum {
 #define MAX_OUTPUT_A2DP_FRAME_QUEUE_SZ (MAX_PCM_FRAME_NUM_PER_TICK * 2)
 #endif
 
+/**
+ * ADAPTIVE FRAME BUDGETING ::
+ *
+ * The SBC frames encoded on each media tick are budgeted from the time
+ * actually elapsed since the previous tick, so a late tick is caught up
+ * with a burst in the same wakeup, spread over as many packets as needed.
+ * The backlog is bounded to BTIF_MEDIA_MAX_BACKLOG_TICKS ticks worth of
+ * PCM; anything beyond that is written off rather than sent to the sink in
+ * one long burst.
+ *
+ * TxAaQ holds the encoded packets until the AVDTP data path takes them,
+ * which it only does while the L2CAP channel is not congested. Once the
+ * queue holds BTIF_MEDIA_TX_QUEUE_CONGESTED packets the budget is kept
+ * pending in the PCM counter instead of being encoded into a queue that
+ * would overflow and be flushed as a whole.
+ */
+#ifndef BTIF_MEDIA_MAX_BACKLOG_TICKS
+#define BTIF_MEDIA_MAX_BACKLOG_TICKS   3
+#endif
+#ifndef BTIF_MEDIA_TX_QUEUE_CONGESTED
+#define BTIF_MEDIA_TX_QUEUE_CONGESTED  (MAX_OUTPUT_A2DP_FRAME_QUEUE_SZ / 2)
+#endif
+
 /* In case of A2DP SINK, we will delay start by 5 AVDTP Packets*/
 #define MAX_A2DP_DELAYED_START_FRAME_COUNT 5
 #define PACKET_PLAYED_PER_TICK_48 8
@@ -329,6 +365,20 @@ typedef struct {
     size_t media_read_total_limited_frames;
     size_t media_read_max_limited_frames;
     size_t media_read_limited_count;
+
+    size_t tx_sched_underrun_count;
+    uint64_t tx_sched_last_underrun_us;
+
+    size_t tx_sched_burst_count;
+    size_t tx_sched_total_burst_frames;
+    size_t tx_sched_max_burst_frames;
+
+    size_t tx_sched_deferred_count;
+    uint64_t tx_sched_last_deferred_us;
+
+    size_t tx_sched_drop_count;
+    size_t tx_sched_total_dropped_frames;
+    uint64_t tx_sched_last_drop_us;
 } btif_media_stats_t;
 
 typedef struct
@@ -547,6 +597,18 @@ void btif_a2dp_source_accumulate_stats(btif_media_stats_t* src,
         dst->media_read_max_limited_frames = src->media_read_max_limited_frames;
     }
     dst->media_read_limited_count += src->media_read_limited_count;
+    dst->tx_sched_underrun_count += src->tx_sched_underrun_count;
+    dst->tx_sched_last_underrun_us = src->tx_sched_last_underrun_us;
+    dst->tx_sched_burst_count += src->tx_sched_burst_count;
+    dst->tx_sched_total_burst_frames += src->tx_sched_total_burst_frames;
+    if (src->tx_sched_max_burst_frames > dst->tx_sched_max_burst_frames) {
+        dst->tx_sched_max_burst_frames = src->tx_sched_max_burst_frames;
+    }
+    dst->tx_sched_deferred_count += src->tx_sched_deferred_count;
+    dst->tx_sched_last_deferred_us = src->tx_sched_last_deferred_us;
+    dst->tx_sched_drop_count += src->tx_sched_drop_count;
+    dst->tx_sched_total_dropped_frames += src->tx_sched_total_dropped_frames;
+    dst->tx_sched_last_drop_us = src->tx_sched_last_drop_us;
     btif_a2dp_source_accumulate_scheduling_stats(&src->tx_queue_enqueue_stats,
                                                &dst->tx_queue_enqueue_stats);
     btif_a2dp_source_accumulate_scheduling_stats(&src->tx_queue_dequeue_stats,
@@ -3353,10 +3415,47 @@ static void btif_get_num_aa_frame_iteration(UINT8 *num_of_iterations, UINT8 *num
                 us_this_tick = (now_us - last_frame_us);
             last_frame_us = now_us;
 
+            /* A tick later by half a period with nothing left queued means
+             * the link ran dry before this wakeup. */
+            if (us_this_tick > BTIF_MEDIA_TIME_TICK * 1500 &&
+                fixed_queue_is_empty(btif_media_cb.TxAaQ))
+            {
+                btif_media_cb.stats.tx_sched_underrun_count++;
+                btif_media_cb.stats.tx_sched_last_underrun_us = now_us;
+            }
+
             btif_media_cb.media_feeding_state.pcm.counter +=
                                 btif_media_cb.media_feeding_state.pcm.bytes_per_tick *
                                 us_this_tick / (BTIF_MEDIA_TIME_TICK * 1000);
 
+            /* Drop the part of the backlog that is too old to catch up */
+            UINT32 max_backlog = BTIF_MEDIA_MAX_BACKLOG_TICKS *
+                                btif_media_cb.media_feeding_state.pcm.bytes_per_tick;
+            if (btif_media_cb.media_feeding_state.pcm.counter > max_backlog)
+            {
+                UINT32 dropped_nof = (btif_media_cb.media_feeding_state.pcm.counter -
+                                      max_backlog) / pcm_bytes_per_frame;
+                APPL_TRACE_WARNING("%s() - Dropping %d frames of backlog", __func__,
+                                   dropped_nof);
+                btif_media_cb.media_feeding_state.pcm.counter -=
+                                dropped_nof * pcm_bytes_per_frame;
+                btif_media_cb.stats.tx_sched_drop_count++;
+                btif_media_cb.stats.tx_sched_total_dropped_frames += dropped_nof;
+                btif_media_cb.stats.tx_sched_last_drop_us = now_us;
+            }
+
+            /* Keep the budget pending while the link is congested */
+            if (fixed_queue_length(btif_media_cb.TxAaQ) >= BTIF_MEDIA_TX_QUEUE_CONGESTED)
+            {
+                APPL_TRACE_DEBUG("%s TX queue congested (%zu packets), deferring",
+                                 __func__, fixed_queue_length(btif_media_cb.TxAaQ));
+                btif_media_cb.stats.tx_sched_deferred_count++;
+                btif_media_cb.stats.tx_sched_last_deferred_us = now_us;
+                nof = 0;
+                noi = 0;
+                break;
+            }
+
 #if defined(MTK_COMMON) && (MTK_COMMON == TRUE)
             if (first_add_frames < 2)
             {
@@ -3415,6 +3514,12 @@ static void btif_get_num_aa_frame_iteration(UINT8 *num_of_iterations, UINT8 *num
                             APPL_TRACE_ERROR("%s ## Audio Congestion (iterations:%d > max (%d))",
                                  __func__, noi, MAX_PCM_ITER_NUM_PER_TICK);
                             noi = MAX_PCM_ITER_NUM_PER_TICK;
+                            UINT32 dropped_nof =
+                                btif_media_cb.media_feeding_state.pcm.counter /
+                                pcm_bytes_per_frame - noi * nof;
+                            btif_media_cb.stats.tx_sched_drop_count++;
+                            btif_media_cb.stats.tx_sched_total_dropped_frames += dropped_nof;
+                            btif_media_cb.stats.tx_sched_last_drop_us = now_us;
                             btif_media_cb.media_feeding_state.pcm.counter
                                 = noi * nof * pcm_bytes_per_frame;
                         }
@@ -3440,6 +3545,17 @@ static void btif_get_num_aa_frame_iteration(UINT8 *num_of_iterations, UINT8 *num
             }
             btif_media_cb.media_feeding_state.pcm.counter -= noi * nof * pcm_bytes_per_frame;
             APPL_TRACE_DEBUG("%s effective num of frames %u, iterations %u", __func__, nof, noi);
+
+            /* Count catch-up ticks that send more than a tick worth of frames */
+            UINT32 tick_nof = btif_media_cb.media_feeding_state.pcm.bytes_per_tick /
+                              pcm_bytes_per_frame + 1;
+            if ((UINT32)(noi * nof) > tick_nof)
+            {
+                btif_media_cb.stats.tx_sched_burst_count++;
+                btif_media_cb.stats.tx_sched_total_burst_frames += noi * nof;
+                if ((size_t)(noi * nof) > btif_media_cb.stats.tx_sched_max_burst_frames)
+                    btif_media_cb.stats.tx_sched_max_burst_frames = noi * nof;
+            }
         }
         break;
 
@@ -3802,6 +3918,7 @@ static void btif_media_aa_prep_aptx_2_send(UINT8 nb_frame)
             /* Read PCM data  */
             if (btif_media_aa_read_feeding_aptx(UIPC_CH_ID_AV_AUDIO))
             {
+                uint64_t encode_start_us = time_now_us();
                 while(aptx_samples < 16)
                 {
                     for (i=0, j=frame_buf_index; i<4; i++, j++)
@@ -3835,6 +3952,8 @@ static void btif_media_aa_prep_aptx_2_send(UINT8 nb_frame)
                     frame_buf_index+=frameSize;
                     p_buf->len += frameSize;
                 }
+                metrics_histogram_record(METRICS_HISTOGRAM_A2DP_ENCODE,
+                                         time_now_us() - encode_start_us);
                 nb_frame--;
                 p_buf->layer_specific++; //added a frame in the buffer
             }
@@ -3982,7 +4101,11 @@ static void btif_media_aa_prep_aac_2_send(UINT8 nb_frame)
         inArgs.numInSamples = MTK_A2DP_AAC_ENC_INPUT_BUF_SIZE / sizeof(SINT16);
         memcpy(inputBuf, btif_media_cb.aacEncoderParams.as16PcmBuffer, MTK_A2DP_AAC_ENC_INPUT_BUF_SIZE);
 
-        if (AACENC_OK == (errNumber = aacEncEncode(btif_media_cb.aacEncoderParams.aacEncoder, &inputBufDesc, &outputBufDesc, &inArgs, &outArgs)))
+        uint64_t encode_start_us = time_now_us();
+        errNumber = aacEncEncode(btif_media_cb.aacEncoderParams.aacEncoder, &inputBufDesc, &outputBufDesc, &inArgs, &outArgs);
+        metrics_histogram_record(METRICS_HISTOGRAM_A2DP_ENCODE,
+                                 time_now_us() - encode_start_us);
+        if (AACENC_OK == errNumber)
         {
             memcpy(btif_media_cb.aacEncoderParams.pu8Packet, LATM_Header, 9);
             consumedInputBytes += (outArgs.numInSamples * sizeof(UINT16) );
@@ -4057,7 +4180,10 @@ static void btif_media_aa_prep_sbc_2_send(UINT8 nb_frame,
             /* Read PCM data and upsample them if needed */
             if (btif_media_aa_read_feeding(UIPC_CH_ID_AV_AUDIO))
             {
+                uint64_t encode_start_us = time_now_us();
                 SBC_Encoder(&(btif_media_cb.encoder));
+                metrics_histogram_record(METRICS_HISTOGRAM_A2DP_ENCODE,
+                                         time_now_us() - encode_start_us);
 
                 /* Update SBC frame length */
                 p_buf->len += btif_media_cb.encoder.u16PacketLength;
@@ -4397,6 +4523,31 @@ void btif_debug_a2dp_dump(int fd)
             (stats->media_read_last_underrun_us > 0)?
                 (unsigned long long)(now_us - stats->media_read_last_underrun_us) / 1000 : 0);
 
+    dprintf(fd, "  Tick counts (underrun/burst/deferred/drop)              : %zu / %zu / %zu / %zu\n",
+            stats->tx_sched_underrun_count,
+            stats->tx_sched_burst_count,
+            stats->tx_sched_deferred_count,
+            stats->tx_sched_drop_count);
+
+    ave_size = 0;
+    if (stats->tx_sched_burst_count != 0)
+        ave_size = stats->tx_sched_total_burst_frames / stats->tx_sched_burst_count;
+    dprintf(fd, "  Burst frames (total/max/ave)                            : %zu / %zu / %zu\n",
+            stats->tx_sched_total_burst_frames,
+            stats->tx_sched_max_burst_frames,
+            ave_size);
+
+    dprintf(fd, "  Frames dropped by tick scheduler                        : %zu\n",
+            stats->tx_sched_total_dropped_frames);
+
+    dprintf(fd, "  Last update time ago in ms (underrun/deferred/drop)     : %llu / %llu / %llu\n",
+            (stats->tx_sched_last_underrun_us > 0) ?
+                (unsigned long long)(now_us - stats->tx_sched_last_underrun_us) / 1000 : 0,
+            (stats->tx_sched_last_deferred_us > 0) ?
+                (unsigned long long)(now_us - stats->tx_sched_last_deferred_us) / 1000 : 0,
+            (stats->tx_sched_last_drop_us > 0) ?
+                (unsigned long long)(now_us - stats->tx_sched_last_drop_us) / 1000 : 0);
+
     //
     // TxQueue enqueue stats
     //
@@ -101,6 +101,11 @@ error:;
   return BT_STATUS_FAIL;
 }
 
+void btif_debug_sock_dump(int fd) {
+  btsock_rfc_debug_dump(fd);
+  btsock_l2cap_debug_dump(fd);
+}
+
 void btif_sock_cleanup(void) {
   if (thread_handle == -1)
     return;
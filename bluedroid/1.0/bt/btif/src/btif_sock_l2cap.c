@@ -21,6 +21,7 @@
 
 #include <errno.h>
 #include <pthread.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
@@ -55,6 +56,17 @@
 #define asrt(s) if (!(s)) APPL_TRACE_ERROR("## %s assert %s failed at line:%d ##",__FUNCTION__, \
         #s, __LINE__)
 
+/* Messages read from the app socket in one system call. They are handed to the stack one at a
+ * time, the next one once the previous write is done and the channel is not congested, and the
+ * socket is only polled again when all have been written. */
+#define L2CAP_TX_BATCH              8
+
+/* Messages written to the app socket in one system call */
+#define L2CAP_RX_BATCH              16
+
+/* SDU sized transmit buffers kept for reuse */
+#define L2CAP_TX_POOL_SIZE          16
+
 struct packet {
     struct packet *next, *prev;
     uint32_t len;
@@ -80,11 +92,19 @@ typedef struct l2cap_socket {
     struct packet         *last_packet;          //last packet to be delivered to app
 
     fixed_queue_t         *incoming_que;         //data that came in but has not yet been read
+
+    uint8_t               *tx_queue[L2CAP_TX_BATCH];     //messages read from the app
+    uint32_t               tx_queue_len[L2CAP_TX_BATCH];
+    unsigned               tx_head;              //next message to hand to the stack
+    unsigned               tx_count;             //messages in tx_queue
+    sock_stats_t           stats;
+
     unsigned               fixed_chan       :1;  //fixed channel (or psm?)
     unsigned               server           :1;  //is a server? (or connecting?)
     unsigned               connected        :1;  //is connected?
     unsigned               outgoing_congest :1;  //should we hold?
     unsigned               server_psm_sent  :1;  //The server shall only send PSM once.
+    unsigned               tx_in_flight     :1;  //is the stack writing tx_queue[tx_head]?
     BOOLEAN                is_le_coc;            //is le connection oriented channel?
 } l2cap_socket;
 
@@ -98,6 +118,26 @@ static int pth = -1;
 
 static void btsock_l2cap_cbk(tBTA_JV_EVT event, tBTA_JV *p_data, void *user_data);
 
+static uint8_t *tx_pool[L2CAP_TX_POOL_SIZE];
+static unsigned tx_pool_count;
+
+/* only call with mutex taken */
+static uint8_t *tx_buf_get_l(void)
+{
+    if (tx_pool_count)
+        return tx_pool[--tx_pool_count];
+    return osi_malloc(L2CAP_MAX_SDU_LENGTH);
+}
+
+/* only call with mutex taken */
+static void tx_buf_put_l(uint8_t *buf)
+{
+    if (tx_pool_count < L2CAP_TX_POOL_SIZE)
+        tx_pool[tx_pool_count++] = buf;
+    else
+        osi_free(buf);
+}
+
 /* TODO: Consider to remove this buffer, as we have a buffer in l2cap as well, and we risk
  *       a buffer overflow with this implementation if the socket data is not read from
  *       JAVA for a while. In such a case we should use flow control to tell the sender to
@@ -262,6 +302,10 @@ static void btsock_l2cap_free_l(l2cap_socket *sock)
     while (packet_get_head_l(sock, &buf, NULL))
         osi_free(buf);
 
+    /* The buffer being written is released when its write is done */
+    for (unsigned i = sock->tx_head + sock->tx_in_flight; i < sock->tx_count; i++)
+        tx_buf_put_l(sock->tx_queue[i]);
+
     //lower-level close() should be idempotent... so let's call it and see...
     if (sock->is_le_coc)
     {
@@ -378,12 +422,37 @@ bt_status_t btsock_l2cap_cleanup()
     pth = -1;
     while (socks)
         btsock_l2cap_free_l(socks);
+    while (tx_pool_count)
+        osi_free(tx_pool[--tx_pool_count]);
     pthread_mutex_unlock(&state_lock);
     pthread_mutex_destroy(&state_lock);
 
     return BT_STATUS_SUCCESS;
 }
 
+void btsock_l2cap_debug_dump(int fd)
+{
+    dprintf(fd, "\nL2CAP sockets:\n");
+
+    BOOLEAN any = FALSE;
+    pthread_mutex_lock(&state_lock);
+    for (l2cap_socket *sock = socks; sock; sock = sock->next) {
+        if (sock->server)
+            continue;
+
+        char name[64];
+        snprintf(name, sizeof(name), "%s %d (id %u)",
+                 sock->fixed_chan ? "Fixed channel" : sock->is_le_coc ? "LE PSM" : "PSM",
+                 sock->channel, sock->id);
+        sock_stats_dump(fd, name, &sock->stats);
+        any = TRUE;
+    }
+    pthread_mutex_unlock(&state_lock);
+
+    if (!any)
+        dprintf(fd, "    None\n");
+}
+
 static inline BOOLEAN send_app_psm_or_chan_l(l2cap_socket *sock)
 {
     return sock_send_all(sock->our_fd, (const uint8_t*)&sock->channel, sizeof(sock->channel))
@@ -467,6 +536,7 @@ static void on_srv_l2cap_psm_connect_l(tBTA_JV_L2CAP_OPEN *p_open, l2cap_socket
     // Mutex locked by caller
     accept_rs = btsock_l2cap_alloc_l(sock->name, (const bt_bdaddr_t*)p_open->rem_bda, FALSE, 0);
     accept_rs->connected = TRUE;
+    sock_stats_connected(&accept_rs->stats);
     accept_rs->security = sock->security;
     accept_rs->fixed_chan = sock->fixed_chan;
     accept_rs->channel = sock->channel;
@@ -516,6 +586,7 @@ static void on_srv_l2cap_le_connect_l(tBTA_JV_L2CAP_LE_OPEN *p_open, l2cap_socke
 
         accept_rs->handle = p_open->handle;
         accept_rs->connected = TRUE;
+        sock_stats_connected(&accept_rs->stats);
         accept_rs->security = sock->security;
         accept_rs->fixed_chan = sock->fixed_chan;
         accept_rs->channel = sock->channel;
@@ -553,6 +624,7 @@ static void on_cl_l2cap_psm_connect_l(tBTA_JV_L2CAP_OPEN *p_open, l2cap_socket *
                 " server:%d", sock->id, sock->channel, sock->server);
         btsock_thread_add_fd(pth, sock->our_fd, BTSOCK_L2CAP, SOCK_THREAD_FD_RD, sock->id);
         sock->connected = TRUE;
+        sock_stats_connected(&sock->stats);
     }
     else APPL_TRACE_ERROR("send_app_connect_signal failed");
 }
@@ -572,6 +644,7 @@ static void on_cl_l2cap_le_connect_l(tBTA_JV_L2CAP_LE_OPEN *p_open, l2cap_socket
                 " server:%d", sock->id, sock->channel, sock->server);
         btsock_thread_add_fd(pth, sock->our_fd, BTSOCK_L2CAP, SOCK_THREAD_FD_RD, sock->id);
         sock->connected = TRUE;
+        sock_stats_connected(&sock->stats);
     }
     else APPL_TRACE_ERROR("send_app_connect_signal failed");
 }
@@ -624,66 +697,120 @@ static void on_l2cap_close(tBTA_JV_L2CAP_CLOSE * p_close, uint32_t id)
     pthread_mutex_unlock(&state_lock);
 }
 
-static void on_l2cap_outgoing_congest(tBTA_JV_L2CAP_CONG *p, uint32_t id)
+/* Reads up to L2CAP_TX_BATCH messages the app has written into tx_queue. Only call with mutex
+ * taken and tx_queue empty, returns the number of messages read. */
+static unsigned read_tx_batch_l(l2cap_socket *sock)
 {
-    l2cap_socket *sock;
-
-    pthread_mutex_lock(&state_lock);
-    sock = btsock_l2cap_find_by_id_l(id);
-    if (sock) {
-        sock->outgoing_congest = p->cong ? 1 : 0;
-        //mointer the fd for any outgoing data
-        if (!sock->outgoing_congest) {
-            APPL_TRACE_DEBUG("on_l2cap_outgoing_congest: adding fd to btsock_thread...");
-            btsock_thread_add_fd(pth, sock->our_fd, BTSOCK_L2CAP, SOCK_THREAD_FD_RD, sock->id);
+    struct mmsghdr msgs[L2CAP_TX_BATCH];
+    struct iovec iov[L2CAP_TX_BATCH];
+
+    memset(msgs, 0, sizeof(msgs));
+    for (unsigned i = 0; i < L2CAP_TX_BATCH; i++) {
+        sock->tx_queue[i] = tx_buf_get_l();
+        iov[i].iov_base = sock->tx_queue[i];
+        iov[i].iov_len = L2CAP_MAX_SDU_LENGTH;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
 
+    /* The socket is created with SOCK_SEQPACKET, hence each message is one SDU and fits in a
+     * L2CAP_MAX_SDU_LENGTH buffer, as the stack cannot handle larger ones anyway. */
+    int count;
+    OSI_NO_INTR(count = recvmmsg(sock->our_fd, msgs, L2CAP_TX_BATCH,
+                                 MSG_NOSIGNAL | MSG_DONTWAIT, NULL));
+    if (count < 0)
+        count = 0;
+    APPL_TRACE_DEBUG("%s - %d messages received from socket", __func__, count);
+
+    /* Empty messages are only end of stream markers, do not pass them on */
+    sock->tx_head = 0;
+    sock->tx_count = 0;
+    for (int i = 0; i < count; i++) {
+        if (msgs[i].msg_len == 0) {
+            tx_buf_put_l(sock->tx_queue[i]);
+            continue;
         }
+        sock->tx_queue[sock->tx_count] = sock->tx_queue[i];
+        sock->tx_queue_len[sock->tx_count] = msgs[i].msg_len;
+        sock->tx_count++;
+        sock->stats.tx_bytes += msgs[i].msg_len;
     }
-    pthread_mutex_unlock(&state_lock);
+    for (unsigned i = count; i < L2CAP_TX_BATCH; i++)
+        tx_buf_put_l(sock->tx_queue[i]);
+
+    if (count > 0)
+        sock->stats.tx_reads++;
+    return sock->tx_count;
 }
 
-static void on_l2cap_write_done(void* req_id, uint16_t len, uint32_t id)
+/* Hands the messages in tx_queue to the stack one at a time, as long as the channel is not
+ * congested, and polls the app socket for more once all are written. Only call with mutex
+ * taken. */
+static void send_tx_queue_l(l2cap_socket *sock)
 {
-    l2cap_socket *sock;
+    while (!sock->tx_in_flight && !sock->outgoing_congest && sock->tx_head < sock->tx_count) {
+        uint8_t *buffer = sock->tx_queue[sock->tx_head];
+        uint32_t len = sock->tx_queue_len[sock->tx_head];
+        tBTA_JV_STATUS status;
+
+        /* The buffer pointer is passed as |req_id| to find it in the write complete event,
+         * which gives it back to the pool. */
+        sock->tx_in_flight = 1;
+        if (sock->fixed_chan)
+            status = BTA_JvL2capWriteFixed(sock->channel, (BD_ADDR*)&sock->addr,
+                                           PTR_TO_UINT(buffer), btsock_l2cap_cbk, buffer, len,
+                                           UINT_TO_PTR(sock->id));
+        else
+            status = BTA_JvL2capWrite(sock->handle, PTR_TO_UINT(buffer), buffer, len,
+                                      UINT_TO_PTR(sock->id));
+
+        if (status != BTA_JV_SUCCESS) {
+            //the message is dropped, as before batching
+            tx_buf_put_l(buffer);
+            sock->tx_in_flight = 0;
+            sock->tx_head++;
+        }
+    }
 
-    if (req_id != NULL) {
-        osi_free(req_id); //free the buffer
+    if (!sock->tx_in_flight && !sock->outgoing_congest && sock->tx_head == sock->tx_count) {
+        //monitor the fd for any outgoing data
+        btsock_thread_add_fd(pth, sock->our_fd, BTSOCK_L2CAP, SOCK_THREAD_FD_RD, sock->id);
     }
+}
 
-    int app_uid = -1;
+static void on_l2cap_outgoing_congest(tBTA_JV_L2CAP_CONG *p, uint32_t id)
+{
+    l2cap_socket *sock;
 
     pthread_mutex_lock(&state_lock);
     sock = btsock_l2cap_find_by_id_l(id);
     if (sock) {
-        app_uid = sock->app_uid;
-        if (!sock->outgoing_congest) {
-            //monitor the fd for any outgoing data
-            APPL_TRACE_DEBUG("on_l2cap_write_done: adding fd to btsock_thread...");
-            btsock_thread_add_fd(pth, sock->our_fd, BTSOCK_L2CAP, SOCK_THREAD_FD_RD, sock->id);
-        }
+        sock->outgoing_congest = p->cong ? 1 : 0;
+        if (sock->outgoing_congest)
+            sock->stats.stack_stalls++;
+        else
+            send_tx_queue_l(sock);
     }
     pthread_mutex_unlock(&state_lock);
-
-    uid_set_add_tx(uid_set, app_uid, len);
 }
 
-static void on_l2cap_write_fixed_done(void* req_id, uint16_t len, uint32_t id)
+static void on_l2cap_write_done(void* req_id, uint16_t len, uint32_t id)
 {
     l2cap_socket *sock;
 
-    if (req_id != NULL) {
-        osi_free(req_id); //free the buffer
-    }
-
     int app_uid = -1;
+
     pthread_mutex_lock(&state_lock);
     sock = btsock_l2cap_find_by_id_l(id);
+    if (sock && sock->tx_in_flight && sock->tx_queue[sock->tx_head] == req_id) {
+        sock->tx_in_flight = 0;
+        sock->tx_head++;
+    }
+    if (req_id != NULL)
+        tx_buf_put_l(req_id);
     if (sock) {
         app_uid = sock->app_uid;
-        if (!sock->outgoing_congest) {
-            //monitor the fd for any outgoing data
-            btsock_thread_add_fd(pth, sock->our_fd, BTSOCK_L2CAP, SOCK_THREAD_FD_RD, sock->id);
-        }
+        send_tx_queue_l(sock);
     }
     pthread_mutex_unlock(&state_lock);
 
@@ -783,7 +910,7 @@ static void btsock_l2cap_cbk(tBTA_JV_EVT event, tBTA_JV *p_data, void *user_data
 
     case BTA_JV_L2CAP_WRITE_FIXED_EVT:
         APPL_TRACE_DEBUG("BTA_JV_L2CAP_WRITE_FIXED_EVT: id: %u", sock_id);
-        on_l2cap_write_fixed_done(UINT_TO_PTR(p_data->l2c_write_fixed.req_id), p_data->l2c_write.len, sock_id);
+        on_l2cap_write_done(UINT_TO_PTR(p_data->l2c_write_fixed.req_id), p_data->l2c_write.len, sock_id);
         break;
 
     case BTA_JV_L2CAP_CONG_EVT:
@@ -994,33 +1121,55 @@ bt_status_t btsock_l2cap_connect(const bt_bdaddr_t *bd_addr, int channel, int* s
  */
 static BOOLEAN flush_incoming_que_on_wr_signal_l(l2cap_socket *sock)
 {
-    uint8_t *buf;
-    uint32_t len;
-
-    while (packet_get_head_l(sock, &buf, &len)) {
-        ssize_t sent;
-        OSI_NO_INTR(sent = send(sock->our_fd, buf, len, MSG_DONTWAIT));
-        int saved_errno = errno;
+    while (sock->first_packet) {
+        struct mmsghdr msgs[L2CAP_RX_BATCH];
+        struct iovec iov[L2CAP_RX_BATCH];
+        unsigned count = 0;
+
+        memset(msgs, 0, sizeof(msgs));
+        for (struct packet *p = sock->first_packet; p && count < L2CAP_RX_BATCH; p = p->next) {
+            iov[count].iov_base = p->data;
+            iov[count].iov_len = p->len;
+            msgs[count].msg_hdr.msg_iov = &iov[count];
+            msgs[count].msg_hdr.msg_iovlen = 1;
+            count++;
+        }
 
-        if (sent == (signed)len)
-            osi_free(buf);
-        else if (sent >= 0) {
-            packet_put_head_l(sock, buf + sent, len - sent);
-            osi_free(buf);
-            if (!sent) /* special case if other end not keeping up */
-                return TRUE;
+        int sent;
+        OSI_NO_INTR(sent = sendmmsg(sock->our_fd, msgs, count, MSG_DONTWAIT));
+        if (sent < 0) {
+            if (errno != EWOULDBLOCK && errno != EAGAIN)
+                return FALSE;
+            sock->stats.app_stalls++;
+            return TRUE;
         }
-        else {
-            packet_put_head_l(sock, buf, len);
+        sock->stats.rx_writes++;
+
+        for (int i = 0; i < sent; i++) {
+            uint8_t *buf;
+            uint32_t len;
+
+            packet_get_head_l(sock, &buf, &len);
+            sock->stats.rx_bytes += msgs[i].msg_len;
+            if (msgs[i].msg_len < len) {
+                packet_put_head_l(sock, buf + msgs[i].msg_len, len - msgs[i].msg_len);
+                osi_free(buf);
+                sock->stats.app_stalls++;
+                return TRUE;
+            }
             osi_free(buf);
-            return saved_errno == EWOULDBLOCK || saved_errno == EAGAIN;
+        }
+
+        if ((unsigned)sent < count) { /* other end not keeping up */
+            sock->stats.app_stalls++;
+            return TRUE;
         }
     }
 
     return FALSE;
 }
 
-void btsock_l2cap_signaled(int fd, int flags, uint32_t user_id)
+void btsock_l2cap_signaled(UNUSED_ATTR int fd, int flags, uint32_t user_id)
 {
     l2cap_socket *sock;
     char drop_it = FALSE;
@@ -1034,60 +1183,13 @@ void btsock_l2cap_signaled(int fd, int flags, uint32_t user_id)
             if (sock->connected) {
                 int size = 0;
 
-                if (!(flags & SOCK_THREAD_FD_EXCEPTION) || (ioctl(sock->our_fd, FIONREAD, &size)
-                        == 0 && size)) {
-                    uint8_t *buffer = osi_malloc(L2CAP_MAX_SDU_LENGTH);
-                    /* Apparently we hijack the req_id (UINT32) to pass the pointer to the buffer to
-                     * the write complete callback, which call a free... wonder if this works on a
-                     * 64 bit platform? */
-                    /* The socket is created with SOCK_SEQPACKET, hence we read one message at
-                     * the time. The maximum size of a message is allocated to ensure data is
-                     * not lost. This is okay to do as Android uses virtual memory, hence even
-                     * if we only use a fraction of the memory it should not block for others
-                     * to use the memory. As the definition of ioctl(FIONREAD) do not clearly
-                     * define what value will be returned if multiple messages are written to
-                     * the socket before any message is read from the socket, we could
-                     * potentially risk to allocate way more memory than needed. One of the use
-                     * cases for this socket is obex where multiple 64kbyte messages are
-                     * typically written to the socket in a tight loop, hence we risk the ioctl
-                     * will return the total amount of data in the buffer, which could be
-                     * multiple 64kbyte chunks.
-                     * UPDATE: As the stack cannot handle 64kbyte buffers, the size is reduced
-                     * to around 8kbyte - and using malloc for buffer allocation here seems to
-                     * be wrong
-                     * UPDATE: Since we are responsible for freeing the buffer in the
-                     * write_complete_ind, it is OK to use malloc. */
-                    ssize_t count;
-                    OSI_NO_INTR(count = recv(fd, buffer, L2CAP_MAX_SDU_LENGTH,
-                                             MSG_NOSIGNAL | MSG_DONTWAIT));
-                    APPL_TRACE_DEBUG("btsock_l2cap_signaled - %d bytes received from socket",
-                                     count);
-
-                    // TODO(armansito): |buffer|, which is created above via
-                    // malloc, is being cast below to UINT32 to be used as
-                    // the |req_id| parameter of BTA_JvL2capWriteFixed and
-                    // BTA_JvL2capWrite. The "id" then gets freed in an
-                    // obscure callback elsewhere. We need to watch out for
-                    // this type of unsafe practice, as this is error prone
-                    // and difficult to follow.
-                    if (sock->fixed_chan) {
-                        if (BTA_JvL2capWriteFixed(sock->channel,
-                                                  (BD_ADDR*)&sock->addr,
-                                                  PTR_TO_UINT(buffer),
-                                                  btsock_l2cap_cbk, buffer,
-                                                  count,
-                                                  UINT_TO_PTR(user_id)) != BTA_JV_SUCCESS) {
-                            // On fail, free the buffer
-                            on_l2cap_write_fixed_done(buffer, count, user_id);
-                        }
-                    } else {
-                        if (BTA_JvL2capWrite(sock->handle, PTR_TO_UINT(buffer),
-                                             buffer, count,
-                                             UINT_TO_PTR(user_id)) != BTA_JV_SUCCESS) {
-                          // On fail, free the buffer
-                          on_l2cap_write_done(buffer, count, user_id);
-                        }
-                    }
+                /* tx_queue still being written means this is a stale signal, the socket is
+                 * polled again when all of it is written. */
+                if (sock->tx_head == sock->tx_count &&
+                        (!(flags & SOCK_THREAD_FD_EXCEPTION) || (ioctl(sock->our_fd, FIONREAD, &size)
+                        == 0 && size))) {
+                    read_tx_batch_l(sock);
+                    send_tx_queue_l(sock);
                 }
             } else
                 drop_it = TRUE;
@@ -1099,7 +1201,9 @@ void btsock_l2cap_signaled(int fd, int flags, uint32_t user_id)
         }
         if (drop_it || (flags & SOCK_THREAD_FD_EXCEPTION)) {
             int size = 0;
-            if (drop_it || ioctl(sock->our_fd, FIONREAD, &size) != 0 || size == 0)
+            /* Keep the socket until what was read from it is written */
+            if (drop_it || ioctl(sock->our_fd, FIONREAD, &size) != 0 ||
+                    (size == 0 && sock->tx_head == sock->tx_count))
                 btsock_l2cap_free_l(sock);
         }
     }
@@ -22,6 +22,7 @@
 #include <errno.h>
 #include <features.h>
 #include <pthread.h>
+#include <stdio.h>
 #include <string.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
@@ -45,6 +46,7 @@
 #include "btu.h"
 #include "bt_common.h"
 #include "hcimsgs.h"
+#include "osi/include/allocator.h"
 #include "osi/include/compat.h"
 #include "osi/include/list.h"
 #include "osi/include/log.h"
@@ -59,6 +61,13 @@
 #define MAX_RFC_CHANNEL 30  // Maximum number of RFCOMM channels (1-30 inclusive).
 #define MAX_RFC_SESSION 7   // Maximum number of devices we can have an RFCOMM connection with.
 
+// Outgoing data is read from the app socket in chunks of up to this size
+// and handed to the stack from there, one buffer at a time.
+#define RFC_TX_BATCH_SIZE (8 * 1024)
+
+// Maximum number of queued incoming buffers written to the app at once.
+#define RFC_RX_BATCH_COUNT 16
+
 typedef struct {
   int outgoing_congest : 1;
   int pending_sdp_request : 1;
@@ -88,6 +97,10 @@ typedef struct {
   int rfc_port_handle;
   int role;
   list_t *incoming_queue;
+  uint8_t *tx_batch;         // Kept across uses of the slot, freed at cleanup.
+  size_t tx_batch_offset;    // Start of the data not yet taken by the stack.
+  size_t tx_batch_len;
+  sock_stats_t stats;
 } rfc_slot_t;
 
 static rfc_slot_t rfc_slots[MAX_RFC_CHANNEL];
@@ -135,10 +148,33 @@ void btsock_rfc_cleanup(void) {
       cleanup_rfc_slot(&rfc_slots[i]);
     list_free(rfc_slots[i].incoming_queue);
     rfc_slots[i].incoming_queue = NULL;
+    osi_free(rfc_slots[i].tx_batch);
+    rfc_slots[i].tx_batch = NULL;
   }
   pthread_mutex_unlock(&slot_lock);
 }
 
+void btsock_rfc_debug_dump(int fd) {
+  dprintf(fd, "\nRFCOMM sockets:\n");
+
+  bool any = false;
+  pthread_mutex_lock(&slot_lock);
+  for (size_t i = 0; i < ARRAY_SIZE(rfc_slots); ++i) {
+    const rfc_slot_t *slot = &rfc_slots[i];
+    if (!slot->id || slot->f.server)
+      continue;
+
+    char name[64];
+    snprintf(name, sizeof(name), "Channel %d (slot %u)", slot->scn, slot->id);
+    sock_stats_dump(fd, name, &slot->stats);
+    any = true;
+  }
+  pthread_mutex_unlock(&slot_lock);
+
+  if (!any)
+    dprintf(fd, "    None\n");
+}
+
 static rfc_slot_t *find_free_slot(void) {
   for (size_t i = 0; i < ARRAY_SIZE(rfc_slots); ++i)
     if (rfc_slots[i].fd == INVALID_FD)
@@ -239,6 +275,7 @@ static rfc_slot_t *create_srv_accept_rfc_slot(rfc_slot_t *srv_rs, const bt_bdadd
 
   accept_rs->f.server = false;
   accept_rs->f.connected = true;
+  sock_stats_connected(&accept_rs->stats);
   accept_rs->security = srv_rs->security;
   accept_rs->mtu = srv_rs->mtu;
   accept_rs->role = srv_rs->role;
@@ -420,6 +457,9 @@ static void cleanup_rfc_slot(rfc_slot_t *slot) {
 
   free_rfc_slot_scn(slot);
   list_clear(slot->incoming_queue);
+  slot->tx_batch_offset = 0;
+  slot->tx_batch_len = 0;
+  memset(&slot->stats, 0, sizeof(slot->stats));
 
   slot->rfc_port_handle = 0;
   memset(&slot->f, 0, sizeof(slot->f));
@@ -521,9 +561,10 @@ static void on_cli_rfc_connect(tBTA_JV_RFCOMM_OPEN *p_open, uint32_t id) {
   slot->rfc_port_handle = BTA_JvRfcommGetPortHdl(p_open->handle);
   memcpy(slot->addr.address, p_open->rem_bda, 6);
 
-  if (send_app_connect_signal(slot->fd, &slot->addr, slot->scn, 0, -1))
+  if (send_app_connect_signal(slot->fd, &slot->addr, slot->scn, 0, -1)) {
     slot->f.connected = true;
-  else
+    sock_stats_connected(&slot->stats);
+  } else
     LOG_ERROR(LOG_TAG, "%s unable to send connect completion signal to caller.", __func__);
 
 out:;
@@ -541,7 +582,11 @@ static void on_rfc_close(UNUSED_ATTR tBTA_JV_RFCOMM_CLOSE *p_close, uint32_t id)
   pthread_mutex_unlock(&slot_lock);
 }
 
-static void on_rfc_write_done(UNUSED_ATTR tBTA_JV_RFCOMM_WRITE *p, uint32_t id) {
+static bool has_tx_batch(const rfc_slot_t *slot) {
+  return slot->tx_batch_offset < slot->tx_batch_len;
+}
+
+static void on_rfc_write_done(tBTA_JV_RFCOMM_WRITE *p, uint32_t id) {
   int app_uid = -1;
   pthread_mutex_lock(&slot_lock);
 
@@ -549,7 +594,11 @@ static void on_rfc_write_done(UNUSED_ATTR tBTA_JV_RFCOMM_WRITE *p, uint32_t id)
   if (slot) {
     app_uid = slot->app_uid;
     if (!slot->f.outgoing_congest) {
-      btsock_thread_add_fd(pth, slot->fd, BTSOCK_RFCOMM, SOCK_THREAD_FD_RD, slot->id);
+      // Finish what was read ahead from the app before waiting for more.
+      if (has_tx_batch(slot) && p->len > 0)
+        BTA_JvRfcommWrite(slot->rfc_handle, slot->id);
+      else
+        btsock_thread_add_fd(pth, slot->fd, BTSOCK_RFCOMM, SOCK_THREAD_FD_RD, slot->id);
     }
   }
 
@@ -564,7 +613,11 @@ static void on_rfc_outgoing_congest(tBTA_JV_RFCOMM_CONG *p, uint32_t id) {
   rfc_slot_t *slot = find_rfc_slot_by_id(id);
   if (slot) {
     slot->f.outgoing_congest = p->cong ? 1 : 0;
-    if (!slot->f.outgoing_congest)
+    if (slot->f.outgoing_congest)
+      slot->stats.stack_stalls++;
+    else if (has_tx_batch(slot))
+      BTA_JvRfcommWrite(slot->rfc_handle, slot->id);
+    else
       btsock_thread_add_fd(pth, slot->fd, BTSOCK_RFCOMM, SOCK_THREAD_FD_RD, slot->id);
   }
 
@@ -732,48 +785,94 @@ typedef enum {
   SENT_ALL,
 } sent_status_t;
 
-static sent_status_t send_data_to_app(int fd, BT_HDR *p_buf) {
-  if (p_buf->len == 0)
+static sent_status_t send_iov_to_app(rfc_slot_t *slot, struct iovec *iov, int count,
+                                     size_t total, ssize_t *sent) {
+  if (total == 0) {
+    *sent = 0;
     return SENT_ALL;
+  }
 
-  ssize_t sent;
-  OSI_NO_INTR(sent = send(fd, p_buf->data + p_buf->offset, p_buf->len,
-                          MSG_DONTWAIT));
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = count;
+
+  OSI_NO_INTR(*sent = sendmsg(slot->fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL));
 
-  if (sent == -1) {
+  if (*sent == -1) {
     if (errno == EAGAIN || errno == EWOULDBLOCK)
       return SENT_NONE;
     LOG_ERROR(LOG_TAG, "%s error writing RFCOMM data back to app: %s", __func__, strerror(errno));
     return SENT_FAILED;
   }
 
-  if (sent == 0)
+  if (*sent == 0)
     return SENT_FAILED;
 
-  if (sent == p_buf->len)
-    return SENT_ALL;
+  slot->stats.rx_writes++;
+  slot->stats.rx_bytes += *sent;
+  return (size_t)*sent == total ? SENT_ALL : SENT_PARTIAL;
+}
+
+static sent_status_t send_data_to_app(rfc_slot_t *slot, BT_HDR *p_buf) {
+  struct iovec iov = { p_buf->data + p_buf->offset, p_buf->len };
+  ssize_t sent;
+  sent_status_t status = send_iov_to_app(slot, &iov, 1, p_buf->len, &sent);
+  if (status == SENT_PARTIAL) {
+    p_buf->offset += sent;
+    p_buf->len -= sent;
+  }
+  return status;
+}
+
+// Writes the first RFC_RX_BATCH_COUNT buffers of the incoming queue to the
+// app in one system call, and drops from the queue what went out.
+static sent_status_t send_queue_to_app(rfc_slot_t *slot) {
+  struct iovec iov[RFC_RX_BATCH_COUNT];
+  int count = 0;
+  size_t total = 0;
+  for (const list_node_t *node = list_begin(slot->incoming_queue);
+       node != list_end(slot->incoming_queue) && count < RFC_RX_BATCH_COUNT;
+       node = list_next(node)) {
+    BT_HDR *p_buf = list_node(node);
+    iov[count].iov_base = p_buf->data + p_buf->offset;
+    iov[count].iov_len = p_buf->len;
+    total += p_buf->len;
+    ++count;
+  }
 
-  p_buf->offset += sent;
-  p_buf->len -= sent;
-  return SENT_PARTIAL;
+  ssize_t sent;
+  sent_status_t status = send_iov_to_app(slot, iov, count, total, &sent);
+  if (status != SENT_ALL && status != SENT_PARTIAL)
+    return status;
+
+  for (int i = 0; i < count; ++i) {
+    BT_HDR *p_buf = list_front(slot->incoming_queue);
+    if ((size_t)sent < p_buf->len) {
+      p_buf->offset += sent;
+      p_buf->len -= sent;
+      break;
+    }
+    sent -= p_buf->len;
+    list_remove(slot->incoming_queue, p_buf);
+  }
+  return status;
 }
 
 static bool flush_incoming_que_on_wr_signal(rfc_slot_t *slot) {
   while (!list_is_empty(slot->incoming_queue)) {
-    BT_HDR *p_buf = list_front(slot->incoming_queue);
-    switch (send_data_to_app(slot->fd, p_buf)) {
+    switch (send_queue_to_app(slot)) {
       case SENT_NONE:
       case SENT_PARTIAL:
         //monitor the fd to get callback when app is ready to receive data
+        slot->stats.app_stalls++;
         btsock_thread_add_fd(pth, slot->fd, BTSOCK_RFCOMM, SOCK_THREAD_FD_WR, slot->id);
         return true;
 
       case SENT_ALL:
-        list_remove(slot->incoming_queue, p_buf);
         break;
 
       case SENT_FAILED:
-        list_remove(slot->incoming_queue, p_buf);
         return false;
     }
   }
@@ -801,7 +900,8 @@ void btsock_rfc_signaled(UNUSED_ATTR int fd, int flags, uint32_t user_id) {
     if (slot->f.connected) {
       // Make sure there's data pending in case the peer closed the socket.
       int size = 0;
-      if (!(flags & SOCK_THREAD_FD_EXCEPTION) || (ioctl(slot->fd, FIONREAD, &size) == 0 && size)) {
+      if (!(flags & SOCK_THREAD_FD_EXCEPTION) || has_tx_batch(slot) ||
+          (ioctl(slot->fd, FIONREAD, &size) == 0 && size)) {
         BTA_JvRfcommWrite(slot->rfc_handle, slot->id);
       }
     } else {
@@ -821,7 +921,7 @@ void btsock_rfc_signaled(UNUSED_ATTR int fd, int flags, uint32_t user_id) {
   if (need_close || (flags & SOCK_THREAD_FD_EXCEPTION)) {
     // Clean up if there's no data pending.
     int size = 0;
-    if (need_close || ioctl(slot->fd, FIONREAD, &size) != 0 || !size)
+    if (need_close || ioctl(slot->fd, FIONREAD, &size) != 0 || (!size && !has_tx_batch(slot)))
       cleanup_rfc_slot(slot);
   }
 
@@ -845,9 +945,10 @@ int bta_co_rfc_data_incoming(void *user_data, BT_HDR *p_buf) {
   bytes_rx = p_buf->len;
 
   if (list_is_empty(slot->incoming_queue)) {
-    switch (send_data_to_app(slot->fd, p_buf)) {
+    switch (send_data_to_app(slot, p_buf)) {
       case SENT_NONE:
       case SENT_PARTIAL:
+        slot->stats.app_stalls++;
         list_append(slot->incoming_queue, p_buf);
         btsock_thread_add_fd(pth, slot->fd, BTSOCK_RFCOMM, SOCK_THREAD_FD_WR, slot->id);
         break;
@@ -885,6 +986,7 @@ int bta_co_rfc_data_outgoing_size(void *user_data, int *size) {
     goto out;
 
   if (ioctl(slot->fd, FIONREAD, size) == 0) {
+    *size += slot->tx_batch_len - slot->tx_batch_offset;
     ret = true;
   } else {
     LOG_ERROR(LOG_TAG, "%s unable to determine bytes remaining to be read on fd %d: %s", __func__, slot->fd, strerror(errno));
@@ -896,6 +998,27 @@ out:;
   return ret;
 }
 
+// Reads what the app has written, up to RFC_TX_BATCH_SIZE bytes, so that
+// the following calls for stack sized buffers need no system call.
+static bool read_tx_batch(rfc_slot_t *slot) {
+  if (!slot->tx_batch)
+    slot->tx_batch = osi_malloc(RFC_TX_BATCH_SIZE);
+
+  ssize_t received;
+  OSI_NO_INTR(received = recv(slot->fd, slot->tx_batch, RFC_TX_BATCH_SIZE, MSG_DONTWAIT));
+  if (received <= 0) {
+    LOG_ERROR(LOG_TAG, "%s error receiving RFCOMM data from app: %s", __func__,
+              received == 0 ? "socket closed" : strerror(errno));
+    return false;
+  }
+
+  slot->tx_batch_offset = 0;
+  slot->tx_batch_len = received;
+  slot->stats.tx_reads++;
+  slot->stats.tx_bytes += received;
+  return true;
+}
+
 int bta_co_rfc_data_outgoing(void *user_data, uint8_t *buf, uint16_t size) {
   pthread_mutex_lock(&slot_lock);
 
@@ -905,15 +1028,21 @@ int bta_co_rfc_data_outgoing(void *user_data, uint8_t *buf, uint16_t size) {
   if (!slot)
     goto out;
 
-  ssize_t received;
-  OSI_NO_INTR(received = recv(slot->fd, buf, size, 0));
+  while (size > 0) {
+    if (!has_tx_batch(slot) && !read_tx_batch(slot)) {
+      cleanup_rfc_slot(slot);
+      goto out;
+    }
 
-  if(received == size) {
-    ret = true;
-  } else {
-    LOG_ERROR(LOG_TAG, "%s error receiving RFCOMM data from app: %s", __func__, strerror(errno));
-    cleanup_rfc_slot(slot);
+    size_t chunk = slot->tx_batch_len - slot->tx_batch_offset;
+    if (chunk > size)
+      chunk = size;
+    memcpy(buf, slot->tx_batch + slot->tx_batch_offset, chunk);
+    slot->tx_batch_offset += chunk;
+    buf += chunk;
+    size -= chunk;
   }
+  ret = true;
 
 out:;
   pthread_mutex_unlock(&slot_lock);
@@ -49,6 +49,7 @@
 #include "bt_common.h"
 #include "hcimsgs.h"
 #include "osi/include/log.h"
+#include "osi/include/time.h"
 #include "port_api.h"
 #include "sdp_api.h"
 
@@ -146,6 +147,34 @@ int sock_send_fd(int sock_fd, const uint8_t* buf, int len, int send_fd)
     return ret_len;
 }
 
+void sock_stats_connected(sock_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->connected_ms = time_get_os_boottime_ms();
+}
+
+void sock_stats_dump(int fd, const char *name, const sock_stats_t *stats)
+{
+    if (stats->connected_ms == 0)
+    {
+        dprintf(fd, "    %s: not connected\n", name);
+        return;
+    }
+
+    uint32_t elapsed_ms = time_get_os_boottime_ms() - stats->connected_ms;
+    uint64_t divisor = elapsed_ms ? elapsed_ms : 1;
+
+    dprintf(fd, "    %s: connected for %u ms\n", name, elapsed_ms);
+    dprintf(fd, "      TX: %llu bytes (%llu B/s) in %u reads, %u stack stalls\n",
+            (unsigned long long)stats->tx_bytes,
+            (unsigned long long)(stats->tx_bytes * 1000 / divisor),
+            stats->tx_reads, stats->stack_stalls);
+    dprintf(fd, "      RX: %llu bytes (%llu B/s) in %u writes, %u app stalls\n",
+            (unsigned long long)stats->rx_bytes,
+            (unsigned long long)(stats->rx_bytes * 1000 / divisor),
+            stats->rx_writes, stats->app_stalls);
+}
+
 static const char* hex_table = "0123456789abcdef";
 static inline void byte2hex(const char* data, char** str)
 {
@@ -50,6 +50,7 @@
 #include "btif_util.h"
 #include "bt_common.h"
 #include "osi/include/allocator.h"
+#include "osi/include/array.h"
 #include "osi/include/compat.h"
 #include "osi/include/config.h"
 #include "osi/include/log.h"
@@ -72,6 +73,7 @@
 #define BTIF_STORAGE_PATH_REMOTE_DEVCLASS "DevClass"
 #define BTIF_STORAGE_PATH_REMOTE_DEVTYPE "DevType"
 #define BTIF_STORAGE_PATH_REMOTE_NAME "Name"
+#define BTIF_STORAGE_PATH_REMOTE_NAME_TIME "NameTimestamp"
 #define BTIF_STORAGE_PATH_REMOTE_VER_MFCT "Manufacturer"
 #define BTIF_STORAGE_PATH_REMOTE_VER_VER "LmpVer"
 #define BTIF_STORAGE_PATH_REMOTE_VER_SUBVER "LmpSubVer"
@@ -79,6 +81,7 @@
 //#define BTIF_STORAGE_PATH_REMOTE_LINKKEYS "remote_linkkeys"
 #define BTIF_STORAGE_PATH_REMOTE_ALIASE "Aliase"
 #define BTIF_STORAGE_PATH_REMOTE_SERVICE "Service"
+#define BTIF_STORAGE_PATH_REMOTE_SERVICE_TIME "ServiceTimestamp"
 #define BTIF_STORAGE_PATH_REMOTE_HIDINFO "HidInfo"
 #define BTIF_STORAGE_KEY_ADAPTER_NAME "Name"
 #define BTIF_STORAGE_KEY_ADAPTER_SCANMODE "ScanMode"
@@ -154,12 +157,39 @@ typedef struct
     bt_bdaddr_t devices[BTM_SEC_MAX_DEVICE_RECORDS];
 } btif_bonded_devices_t;
 
+/* What the pass over the config learns about one remote device section */
+typedef struct
+{
+    bt_bdaddr_t bd_addr;
+    LINK_KEY link_key;
+    BOOLEAN has_link_key;
+    BOOLEAN has_link_key_type;
+    BOOLEAN has_dev_class;
+    BOOLEAN has_dev_type;
+    int link_key_type;
+    int dev_class;
+    int pin_length;
+    int dev_type;
+} btif_bonded_record_t;
+
+typedef struct
+{
+    array_t *records;               /* btif_bonded_record_t, in config order */
+    const char *section;            /* section of |current|, during the pass */
+    BOOLEAN in_device;              /* whether |section| is a remote device */
+    btif_bonded_record_t current;
+} btif_bonded_scan_t;
+
 /************************************************************************************
 **  External variables
 ************************************************************************************/
 extern UINT16 bta_service_id_to_uuid_lkup_tbl [BTA_MAX_SERVICE_ID];
 extern bt_bdaddr_t btif_local_bd_addr;
 
+/* Bonded devices whose properties have not been sent to the framework since
+   they were loaded. Only used in the btif context. */
+static btif_bonded_devices_t btif_storage_unhydrated;
+
 /************************************************************************************
 **  External functions
 ************************************************************************************/
@@ -173,6 +203,8 @@ extern void btif_gatts_add_bonded_dev_from_nv(BD_ADDR bda);
 static bt_status_t btif_in_fetch_bonded_ble_device(const char *remote_bd_addr,int add,
                                               btif_bonded_devices_t *p_bonded_devices);
 static bt_status_t btif_in_fetch_bonded_device(const char *bdstr);
+static BOOLEAN btif_in_forget_unhydrated(const bt_bdaddr_t *remote_bd_addr);
+static void btif_in_hydrate_remote_devices_evt(UINT16 event, char *p_param);
 
 /************************************************************************************
 **  Static functions
@@ -200,8 +232,12 @@ static int prop2cfg(bt_bdaddr_t *remote_bd_addr, bt_property_t *prop)
             strncpy(value, (char*)prop->val, prop->len);
             value[prop->len]='\0';
             if(remote_bd_addr)
+            {
                 btif_config_set_str(bdstr,
                                 BTIF_STORAGE_PATH_REMOTE_NAME, value);
+                btif_config_set_int(bdstr,
+                                BTIF_STORAGE_PATH_REMOTE_NAME_TIME, (int)time(NULL));
+            }
 #if defined(MTK_LINUX) && defined(MTK_COMMON) && (MTK_COMMON == TRUE)
             else
             {
@@ -256,6 +292,8 @@ static int prop2cfg(bt_bdaddr_t *remote_bd_addr, bt_property_t *prop)
                 strcat(value, " ");
             }
             btif_config_set_str(bdstr, BTIF_STORAGE_PATH_REMOTE_SERVICE, value);
+            btif_config_set_int(bdstr,
+                                BTIF_STORAGE_PATH_REMOTE_SERVICE_TIME, (int)time(NULL));
             break;
         }
         case BT_PROPERTY_REMOTE_VERSION_INFO:
@@ -445,73 +483,186 @@ static bt_status_t btif_in_fetch_bonded_device(const char *bdstr)
     return BT_STATUS_SUCCESS;
 }
 
+/*******************************************************************************
+**
+** Function         btif_in_parse_int
+**
+** Description      Internal helper function to read an integer config value
+**                  the way btif_config_get_int does
+**
+** Returns          The value, or 0 if it is not a number
+**
+*******************************************************************************/
+static int btif_in_parse_int(const char *value)
+{
+    char *endptr;
+    int ret = strtol(value, &endptr, 0);
+    return (*endptr == '\0') ? ret : 0;
+}
+
+/*******************************************************************************
+**
+** Function         btif_in_parse_link_key
+**
+** Description      Internal helper function to read a hex encoded link key
+**                  the way btif_config_get_bin does
+**
+** Returns          TRUE if |value| held a valid key
+**
+*******************************************************************************/
+static BOOLEAN btif_in_parse_link_key(const char *value, LINK_KEY link_key)
+{
+    size_t value_len = strlen(value);
+    if ((value_len % 2) != 0 || value_len > 2 * LINK_KEY_LEN)
+        return FALSE;
+
+    for (size_t i = 0; i < value_len; ++i)
+        if (!isxdigit(value[i]))
+            return FALSE;
+
+    for (size_t i = 0; i < value_len; i += 2)
+        sscanf(value + i, "%02hhx", &link_key[i / 2]);
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         btif_in_finish_bonded_record
+**
+** Description      Internal helper function to keep the record of the section
+**                  just scanned if it may be a bonded device
+**
+** Returns          void
+**
+*******************************************************************************/
+static void btif_in_finish_bonded_record(btif_bonded_scan_t *p_scan)
+{
+    const btif_bonded_record_t *p_rec = &p_scan->current;
+
+    if (!p_scan->in_device)
+        return;
+
+    if ((p_rec->has_link_key && p_rec->has_link_key_type) ||
+        (p_rec->has_dev_type && (p_rec->dev_type & BT_DEVICE_TYPE_BLE) == BT_DEVICE_TYPE_BLE))
+        array_append_ptr(p_scan->records, (void *)p_rec);
+}
+
+/*******************************************************************************
+**
+** Function         btif_in_scan_bonded_entry
+**
+** Description      btif_config_foreach callback collecting the properties
+**                  needed to add the bonded devices to BTA. Runs with the
+**                  config locked, so it only copies what it finds.
+**
+** Returns          TRUE to continue the walk
+**
+*******************************************************************************/
+static bool btif_in_scan_bonded_entry(const char *section, const char *key,
+                                      const char *value, void *context)
+{
+    btif_bonded_scan_t *p_scan = (btif_bonded_scan_t *)context;
+    btif_bonded_record_t *p_rec = &p_scan->current;
+
+    if (section != p_scan->section)
+    {
+        btif_in_finish_bonded_record(p_scan);
+        p_scan->section = section;
+        p_scan->in_device = string_is_bdaddr(section);
+        memset(p_rec, 0, sizeof(*p_rec));
+        if (p_scan->in_device)
+            string_to_bdaddr(section, &p_rec->bd_addr);
+    }
+
+    if (!p_scan->in_device)
+        return true;
+
+    if (!strcmp(key, "LinkKey"))
+        p_rec->has_link_key = btif_in_parse_link_key(value, p_rec->link_key);
+    else if (!strcmp(key, "LinkKeyType"))
+    {
+        p_rec->has_link_key_type = TRUE;
+        p_rec->link_key_type = btif_in_parse_int(value);
+    }
+    else if (!strcmp(key, BTIF_STORAGE_PATH_REMOTE_DEVCLASS))
+    {
+        p_rec->has_dev_class = TRUE;
+        p_rec->dev_class = btif_in_parse_int(value);
+    }
+    else if (!strcmp(key, "PinLength"))
+        p_rec->pin_length = btif_in_parse_int(value);
+    else if (!strcmp(key, BTIF_STORAGE_PATH_REMOTE_DEVTYPE))
+    {
+        p_rec->has_dev_type = TRUE;
+        p_rec->dev_type = btif_in_parse_int(value);
+    }
+    return true;
+}
+
 /*******************************************************************************
 **
 ** Function         btif_in_fetch_bonded_devices
 **
 ** Description      Internal helper function to fetch the bonded devices
-**                  from NVRAM
+**                  from NVRAM. The config is read in a single pass which only
+**                  picks up the keys and what BTA needs with them; names,
+**                  services and the other properties stay in the config
+**                  until they are asked for.
 **
 ** Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
 **
 *******************************************************************************/
 static bt_status_t btif_in_fetch_bonded_devices(btif_bonded_devices_t *p_bonded_devices, int add)
 {
-    memset(p_bonded_devices, 0, sizeof(btif_bonded_devices_t));
-
-    BOOLEAN bt_linkkey_file_found=FALSE;
-    int device_type;
+    btif_bonded_scan_t scan;
 
-    for (const btif_config_section_iter_t *iter = btif_config_section_begin(); iter != btif_config_section_end(); iter = btif_config_section_next(iter)) {
-        const char *name = btif_config_section_name(iter);
-        if (!string_is_bdaddr(name))
-            continue;
-
-        BTIF_TRACE_DEBUG("Remote device:%s", name);
-        LINK_KEY link_key;
-        size_t size = sizeof(link_key);
-        if (btif_config_get_bin(name, "LinkKey", link_key, &size)) {
-            int linkkey_type;
-            if (btif_config_get_int(name, "LinkKeyType", &linkkey_type)) {
-                bt_bdaddr_t bd_addr;
-                string_to_bdaddr(name, &bd_addr);
-                if (add) {
-                    DEV_CLASS dev_class = {0, 0, 0};
-                    int cod;
-                    int pin_length = 0;
-                    if (btif_config_get_int(name, "DevClass", &cod))
-                        uint2devclass((UINT32)cod, dev_class);
-                    btif_config_get_int(name, "PinLength", &pin_length);
-                    BTA_DmAddDevice(bd_addr.address, dev_class, link_key, 0, 0,
-                                    (UINT8)linkkey_type, 0, pin_length);
+    memset(p_bonded_devices, 0, sizeof(btif_bonded_devices_t));
+    memset(&scan, 0, sizeof(scan));
+
+    scan.records = array_new(sizeof(btif_bonded_record_t));
+    if (!scan.records)
+        return BT_STATUS_NOMEM;
+    btif_config_foreach(btif_in_scan_bonded_entry, &scan);
+    btif_in_finish_bonded_record(&scan);
+
+    for (size_t i = 0; i < array_length(scan.records); i++) {
+        btif_bonded_record_t *p_rec = array_at(scan.records, i);
+        BOOLEAN bt_linkkey_file_found = FALSE;
+
+        if (p_rec->has_link_key && p_rec->has_link_key_type) {
+            if (add) {
+                DEV_CLASS dev_class = {0, 0, 0};
+                if (p_rec->has_dev_class)
+                    uint2devclass((UINT32)p_rec->dev_class, dev_class);
+                BTA_DmAddDevice(p_rec->bd_addr.address, dev_class, p_rec->link_key, 0, 0,
+                                (UINT8)p_rec->link_key_type, 0, p_rec->pin_length);
 
 #if BLE_INCLUDED == TRUE
-                    if (btif_config_get_int(name, "DevType", &device_type) &&
-                        (device_type == BT_DEVICE_TYPE_DUMO) ) {
-                        btif_gatts_add_bonded_dev_from_nv(bd_addr.address);
-                    }
-#endif
-                }
-                bt_linkkey_file_found = TRUE;
-                memcpy(&p_bonded_devices->devices[p_bonded_devices->num_devices++], &bd_addr, sizeof(bt_bdaddr_t));
-            } else {
-#if (BLE_INCLUDED == TRUE)
-                bt_linkkey_file_found = FALSE;
-#else
-                BTIF_TRACE_ERROR("bounded device:%s, LinkKeyType or PinLength is invalid", name);
+                if (p_rec->has_dev_type && p_rec->dev_type == BT_DEVICE_TYPE_DUMO)
+                    btif_gatts_add_bonded_dev_from_nv(p_rec->bd_addr.address);
 #endif
             }
+            bt_linkkey_file_found = TRUE;
+            if (p_bonded_devices->num_devices < BTM_SEC_MAX_DEVICE_RECORDS)
+                memcpy(&p_bonded_devices->devices[p_bonded_devices->num_devices++],
+                       &p_rec->bd_addr, sizeof(bt_bdaddr_t));
         }
+        bdstr_t bdstr;
+        bdaddr_to_string(&p_rec->bd_addr, bdstr, sizeof(bdstr));
+        BTIF_TRACE_DEBUG("Remote device:%s", bdstr);
 #if (BLE_INCLUDED == TRUE)
-        if (!btif_in_fetch_bonded_ble_device(name, add, p_bonded_devices) &&
+        if (!btif_in_fetch_bonded_ble_device(bdstr, add, p_bonded_devices) &&
             !bt_linkkey_file_found) {
-            BTIF_TRACE_DEBUG("Remote device:%s, no link key or ble key found", name);
+            BTIF_TRACE_DEBUG("Remote device:%s, no link key or ble key found", bdstr);
         }
 #else
-        if(!bt_linkkey_file_found)
-            BTIF_TRACE_DEBUG("Remote device:%s, no link key", name);
+        if (!bt_linkkey_file_found)
+            BTIF_TRACE_ERROR("bounded device:%s, LinkKeyType or PinLength is invalid", bdstr);
 #endif
     }
+
+    array_free(scan.records);
     return BT_STATUS_SUCCESS;
 }
 
@@ -747,6 +898,76 @@ bt_status_t btif_storage_set_remote_device_property(bt_bdaddr_t *remote_bd_addr,
     return prop2cfg(remote_bd_addr, property) ? BT_STATUS_SUCCESS : BT_STATUS_FAIL;
 }
 
+/*******************************************************************************
+**
+** Function         is_remote_property_fresh
+**
+** Description      Checks whether the timestamp stored under |key| for the
+**                  remote device is less than |max_age_s| seconds old
+**
+** Returns          TRUE if fresh, FALSE if missing or expired
+**
+*******************************************************************************/
+static BOOLEAN is_remote_property_fresh(const bt_bdaddr_t *remote_bd_addr,
+                                        const char *key, int max_age_s)
+{
+    bdstr_t bdstr;
+    int stored = 0;
+
+    bdaddr_to_string(remote_bd_addr, bdstr, sizeof(bdstr));
+    if (!btif_config_get_int(bdstr, key, &stored))
+        return FALSE;
+
+    /* A clock set backwards makes the entry look as if it came from the
+       future; do not trust it in that case either. */
+    int age = (int)time(NULL) - stored;
+    return (age >= 0 && age < max_age_s) ? TRUE : FALSE;
+}
+
+/*******************************************************************************
+**
+** Function         btif_storage_has_fresh_remote_name
+**
+** Description      BTIF storage API - Checks whether the stored name of the
+**                  remote device was learnt within BTIF_STORAGE_NAME_TTL_S
+**
+** Returns          TRUE if the name can be used without a remote name request
+**
+*******************************************************************************/
+BOOLEAN btif_storage_has_fresh_remote_name(const bt_bdaddr_t *remote_bd_addr)
+{
+    return is_remote_property_fresh(remote_bd_addr,
+                                    BTIF_STORAGE_PATH_REMOTE_NAME_TIME,
+                                    BTIF_STORAGE_NAME_TTL_S);
+}
+
+/*******************************************************************************
+**
+** Function         btif_storage_get_fresh_remote_services
+**
+** Description      BTIF storage API - Fetches the stored UUIDs of the remote
+**                  device into |property| if they were discovered within
+**                  BTIF_STORAGE_SERVICE_TTL_S. |property| must be of type
+**                  BT_PROPERTY_UUIDS with memory provided by the caller.
+**
+** Returns          BT_STATUS_SUCCESS if fresh UUIDs were found,
+**                  BT_STATUS_FAIL otherwise
+**
+*******************************************************************************/
+bt_status_t btif_storage_get_fresh_remote_services(bt_bdaddr_t *remote_bd_addr,
+                                                   bt_property_t *property)
+{
+    if (!is_remote_property_fresh(remote_bd_addr,
+                                  BTIF_STORAGE_PATH_REMOTE_SERVICE_TIME,
+                                  BTIF_STORAGE_SERVICE_TTL_S))
+        return BT_STATUS_FAIL;
+
+    if (!cfg2prop(remote_bd_addr, property) || property->len == 0)
+        return BT_STATUS_FAIL;
+
+    return BT_STATUS_SUCCESS;
+}
+
 /*******************************************************************************
 **
 ** Function         btif_storage_add_remote_device
@@ -844,6 +1065,8 @@ bt_status_t btif_storage_remove_bonded_device(bt_bdaddr_t *remote_bd_addr)
     btif_storage_remove_ble_bonding_keys(remote_bd_addr);
 #endif
 
+    btif_in_forget_unhydrated(remote_bd_addr);
+
     int ret = 1;
     if(btif_config_exist(bdstr, "LinkKeyType"))
         ret &= btif_config_remove(bdstr, "LinkKeyType");
@@ -857,14 +1080,139 @@ bt_status_t btif_storage_remove_bonded_device(bt_bdaddr_t *remote_bd_addr)
 
 }
 
+/*******************************************************************************
+**
+** Function         btif_in_forget_unhydrated
+**
+** Description      Internal helper function to take a device off the list of
+**                  bonded devices whose properties have not been sent
+**
+** Returns          TRUE if the device was on the list
+**
+*******************************************************************************/
+static BOOLEAN btif_in_forget_unhydrated(const bt_bdaddr_t *remote_bd_addr)
+{
+    btif_bonded_devices_t *p_devices = &btif_storage_unhydrated;
+
+    for (uint32_t i = 0; i < p_devices->num_devices; i++)
+    {
+        if (bdaddr_equals(&p_devices->devices[i], remote_bd_addr))
+        {
+            p_devices->devices[i] = p_devices->devices[--p_devices->num_devices];
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/*******************************************************************************
+**
+** Function         btif_in_send_remote_properties
+**
+** Description      Internal helper function to read the properties of a bonded
+**                  device from NVRAM and send them to the framework
+**
+** Returns          void
+**
+*******************************************************************************/
+static void btif_in_send_remote_properties(bt_bdaddr_t *p_remote_addr)
+{
+    bt_property_t remote_properties[8];
+    uint32_t num_props = 0;
+    bt_bdname_t name, alias;
+    bt_uuid_t remote_uuids[BT_MAX_NUM_UUIDS];
+
+    /*
+     * TODO: improve handling of missing fields in NVRAM.
+     */
+    uint32_t cod = 0;
+    uint32_t devtype = 0;
+
+    memset(remote_properties, 0, sizeof(remote_properties));
+    BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr, BT_PROPERTY_BDNAME,
+                                 &name, sizeof(name),
+                                 remote_properties[num_props]);
+    num_props++;
+
+    BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr, BT_PROPERTY_REMOTE_FRIENDLY_NAME,
+                                 &alias, sizeof(alias),
+                                 remote_properties[num_props]);
+    num_props++;
+
+    BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr, BT_PROPERTY_CLASS_OF_DEVICE,
+                                 &cod, sizeof(cod),
+                                 remote_properties[num_props]);
+    num_props++;
+
+    BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr, BT_PROPERTY_TYPE_OF_DEVICE,
+                                 &devtype, sizeof(devtype),
+                                 remote_properties[num_props]);
+    num_props++;
+
+    BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr, BT_PROPERTY_UUIDS,
+                                 remote_uuids, sizeof(remote_uuids),
+                                 remote_properties[num_props]);
+    num_props++;
+
+    btif_remote_properties_evt(BT_STATUS_SUCCESS, p_remote_addr,
+                               num_props, remote_properties);
+}
+
+/*******************************************************************************
+**
+** Function         btif_in_hydrate_remote_devices_evt
+**
+** Description      Sends the properties of the bonded devices which have not
+**                  been used since they were loaded. Runs in the btif context
+**                  after the enable has been reported.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void btif_in_hydrate_remote_devices_evt(UNUSED_ATTR UINT16 event,
+                                               UNUSED_ATTR char *p_param)
+{
+    btif_bonded_devices_t devices;
+
+    memcpy(&devices, &btif_storage_unhydrated, sizeof(btif_bonded_devices_t));
+    btif_storage_unhydrated.num_devices = 0;
+
+    for (uint32_t i = 0; i < devices.num_devices; i++)
+        btif_in_send_remote_properties(&devices.devices[i]);
+}
+
+/*******************************************************************************
+**
+** Function         btif_storage_hydrate_remote_device
+**
+** Description      BTIF storage API - Sends the properties of a bonded device
+**                  to the framework if they have not been sent since the
+**                  bonded devices were loaded. Must be called in the btif
+**                  context before the device is reported to the framework.
+**
+** Returns          BT_STATUS_SUCCESS if the properties were sent,
+**                  BT_STATUS_FAIL if there was nothing to send
+**
+*******************************************************************************/
+bt_status_t btif_storage_hydrate_remote_device(bt_bdaddr_t *remote_bd_addr)
+{
+    if (!btif_in_forget_unhydrated(remote_bd_addr))
+        return BT_STATUS_FAIL;
+
+    btif_in_send_remote_properties(remote_bd_addr);
+    return BT_STATUS_SUCCESS;
+}
+
 /*******************************************************************************
 **
 ** Function         btif_storage_load_bonded_devices
 **
 ** Description      BTIF storage API - Loads all the bonded devices from NVRAM
 **                  and adds to the BTA.
-**                  Additionally, this API also invokes the adaper_properties_cb
-**                  and remote_device_properties_cb for each of the bonded devices.
+**                  Additionally, this API also invokes the adaper_properties_cb.
+**                  The remote_device_properties_cb of each bonded device follows
+**                  when it is first used (see btif_storage_hydrate_remote_device),
+**                  or from the btif context once the enable has been reported.
 **
 ** Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
 **
@@ -875,13 +1223,11 @@ bt_status_t btif_storage_load_bonded_devices(void)
     uint32_t i = 0;
     bt_property_t adapter_props[6];
     uint32_t num_props = 0;
-    bt_property_t remote_properties[8];
     bt_bdaddr_t addr;
-    bt_bdname_t name, alias;
+    bt_bdname_t name;
     bt_scan_mode_t mode;
     uint32_t disc_timeout;
     bt_uuid_t local_uuids[BT_MAX_NUM_UUIDS];
-    bt_uuid_t remote_uuids[BT_MAX_NUM_UUIDS];
 
     btif_in_fetch_bonded_devices(&bonded_devices, 1);
 
@@ -941,49 +1287,12 @@ bt_status_t btif_storage_load_bonded_devices(void)
 
     BTIF_TRACE_EVENT("%s: %d bonded devices found", __FUNCTION__, bonded_devices.num_devices);
 
-    {
-        for (i = 0; i < bonded_devices.num_devices; i++)
-        {
-            bt_bdaddr_t *p_remote_addr;
-
-            /*
-             * TODO: improve handling of missing fields in NVRAM.
-             */
-            uint32_t cod = 0;
-            uint32_t devtype = 0;
-
-            num_props = 0;
-            p_remote_addr = &bonded_devices.devices[i];
-            memset(remote_properties, 0, sizeof(remote_properties));
-            BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr, BT_PROPERTY_BDNAME,
-                                         &name, sizeof(name),
-                                         remote_properties[num_props]);
-            num_props++;
-
-            BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr, BT_PROPERTY_REMOTE_FRIENDLY_NAME,
-                                         &alias, sizeof(alias),
-                                         remote_properties[num_props]);
-            num_props++;
-
-            BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr, BT_PROPERTY_CLASS_OF_DEVICE,
-                                         &cod, sizeof(cod),
-                                         remote_properties[num_props]);
-            num_props++;
-
-            BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr, BT_PROPERTY_TYPE_OF_DEVICE,
-                                         &devtype, sizeof(devtype),
-                                         remote_properties[num_props]);
-            num_props++;
-
-            BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr, BT_PROPERTY_UUIDS,
-                                         remote_uuids, sizeof(remote_uuids),
-                                         remote_properties[num_props]);
-            num_props++;
-
-            btif_remote_properties_evt(BT_STATUS_SUCCESS, p_remote_addr,
-                                       num_props, remote_properties);
-        }
-    }
+    /* The remote device properties are sent when the devices are first used,
+       or once the enable has been reported, whichever comes first */
+    memcpy(&btif_storage_unhydrated, &bonded_devices, sizeof(btif_bonded_devices_t));
+    if (bonded_devices.num_devices > 0)
+        btif_transfer_context(btif_in_hydrate_remote_devices_evt, 0, NULL, 0, NULL);
+
     return BT_STATUS_SUCCESS;
 }
 
@@ -1258,7 +1567,8 @@ static bt_status_t btif_in_fetch_bonded_ble_device(const char *remote_bd_addr, i
         // Fill in the bonded devices
         if (device_added)
         {
-            memcpy(&p_bonded_devices->devices[p_bonded_devices->num_devices++], &bd_addr, sizeof(bt_bdaddr_t));
+            if (p_bonded_devices->num_devices < BTM_SEC_MAX_DEVICE_RECORDS)
+                memcpy(&p_bonded_devices->devices[p_bonded_devices->num_devices++], &bd_addr, sizeof(bt_bdaddr_t));
             btif_gatts_add_bonded_dev_from_nv(bta_bd_addr);
         }
 
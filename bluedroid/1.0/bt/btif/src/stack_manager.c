@@ -31,6 +31,7 @@
 #include "osi/include/osi.h"
 #include "osi/include/semaphore.h"
 #include "osi/include/thread.h"
+#include "osi/include/time.h"
 
 // Temp includes
 #include "btif_config.h"
@@ -100,6 +101,7 @@ static void event_init_stack(void *context) {
   semaphore_t *semaphore = (semaphore_t *)context;
 
   LOG_INFO(LOG_TAG, "%s is initializing the stack", __func__);
+  uint32_t start_ms = time_get_os_boottime_ms();
 
  if (stack_is_initialized) {
    LOG_INFO(LOG_TAG, "%s found the stack already in initialized state",
@@ -116,7 +118,8 @@ static void event_init_stack(void *context) {
     stack_is_initialized = true;
   }
 
-  LOG_INFO(LOG_TAG, "%s finished", __func__);
+  LOG_INFO(LOG_TAG, "%s finished in %u ms", __func__,
+           time_get_os_boottime_ms() - start_ms);
 
   if (semaphore)
     semaphore_post(semaphore);
@@ -140,6 +143,7 @@ static void event_start_up_stack(UNUSED_ATTR void *context) {
   ensure_stack_is_initialized();
 
   LOG_INFO(LOG_TAG, "%s is bringing up the stack", __func__);
+  uint32_t start_ms = time_get_os_boottime_ms();
   future_t *local_hack_future = future_new();
   hack_future = local_hack_future;
 
@@ -155,7 +159,8 @@ static void event_start_up_stack(UNUSED_ATTR void *context) {
   }
 
   stack_is_running = true;
-  LOG_INFO(LOG_TAG, "%s finished", __func__);
+  LOG_INFO(LOG_TAG, "%s finished in %u ms", __func__,
+           time_get_os_boottime_ms() - start_ms);
   btif_thread_post(event_signal_stack_up, NULL);
 }
 
@@ -103,6 +103,25 @@ typedef struct {
 } OI_BITSTREAM;
 
 
+/* The NEON versions of the synthesis window and of the dequantizer are used
+ * when building for ARM targets with NEON, unless SBC_DECODER_NO_NEON is
+ * defined. They produce the same output as the C versions, bit for bit. */
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(SBC_DECODER_NO_NEON)
+#define SBC_DECODER_NEON
+#endif
+
+#ifdef SBC_DECODER_NEON
+#include <stdint.h>
+
+/** Used internally. Per frame constants of the NEON dequantizer, one entry
+ * per channel and subband in the order of the samples of a block. */
+typedef struct {
+    uint32_t mult[2 * SBC_MAX_BANDS];   /* dequant_long_scaled[bits] */
+    int32_t shift[2 * SBC_MAX_BANDS];   /* scale_factor - 15 */
+    uint32_t mask[2 * SBC_MAX_BANDS];   /* zero where bits <= 1 */
+} OI_SBC_DEQUANT_PARAMS;
+#endif
+
 #define VALID_INT16(x) (((x) >= OI_INT16_MIN) && ((x) <= OI_INT16_MAX))
 #define VALID_INT32(x) (((x) >= OI_INT32_MIN) && ((x) <= OI_INT32_MAX))
 
@@ -183,6 +202,10 @@ PRIVATE OI_UINT8 OI_SBC_CalculateChecksum(OI_CODEC_SBC_FRAME_INFO *frame, OI_BYT
 PRIVATE void shift_buffer(SBC_BUFFER_T *dest, SBC_BUFFER_T *src, OI_UINT wordCount);
 PRIVATE void cosineModulateSynth4(SBC_BUFFER_T * RESTRICT out, OI_INT32 const * RESTRICT in);
 PRIVATE void SynthWindow40_int32_int32_symmetry_with_sum(OI_INT16 *pcm, SBC_BUFFER_T buffer[80], OI_UINT strideShift);
+PRIVATE void SynthWindow80_generated(OI_INT16 *pcm, SBC_BUFFER_T const * RESTRICT buffer, OI_UINT strideShift);
+#ifdef SBC_DECODER_NEON
+PRIVATE void SynthWindow80_neon(OI_INT16 *pcm, SBC_BUFFER_T const * RESTRICT buffer, OI_UINT strideShift);
+#endif
 
 INLINE void dct3_4(OI_INT32 * RESTRICT out, OI_INT32 const * RESTRICT in);
 PRIVATE void analyze4_generated(SBC_BUFFER_T analysisBuffer[RESTRICT 40],
@@ -212,6 +235,10 @@ PRIVATE void OI_SBC_ReadSamples(OI_CODEC_SBC_DECODER_CONTEXT *common, OI_BITSTRE
 PRIVATE void OI_SBC_ReadSamplesJoint(OI_CODEC_SBC_DECODER_CONTEXT *common, OI_BITSTREAM *global_bs);
 PRIVATE void OI_SBC_SynthFrame(OI_CODEC_SBC_DECODER_CONTEXT *context, OI_INT16 *pcm, OI_UINT start_block, OI_UINT nrof_blocks);
 INLINE OI_INT32 OI_SBC_Dequant(OI_UINT32 raw, OI_UINT scale_factor, OI_UINT bits);
+#ifdef SBC_DECODER_NEON
+PRIVATE void OI_SBC_DequantSetup_neon(OI_SBC_DEQUANT_PARAMS *params, OI_CODEC_SBC_COMMON_CONTEXT const *common);
+PRIVATE void OI_SBC_DequantBlock_neon(OI_INT32 *out, uint32_t const *raw, OI_SBC_DEQUANT_PARAMS const *params, OI_UINT count);
+#endif
 PRIVATE OI_BOOL OI_SBC_ExamineCommandPacket(OI_CODEC_SBC_DECODER_CONTEXT *context, const OI_BYTE *data, OI_UINT32 len);
 PRIVATE void OI_SBC_GenerateTestSignal(OI_INT16 pcmData[][2], OI_UINT32 sampleCount);
 
@@ -184,6 +184,28 @@ PRIVATE void OI_SBC_ReadSamples(OI_CODEC_SBC_DECODER_CONTEXT *context, OI_BITSTR
     OI_UINT32 value = global_bs->value;
     OI_UINT bitPtr = global_bs->bitPtr;
 
+#ifdef SBC_DECODER_NEON
+    const OI_UINT count = common->frameInfo.nrof_channels * common->frameInfo.nrof_subbands;
+    OI_SBC_DEQUANT_PARAMS params;
+
+    OI_SBC_DequantSetup_neon(&params, common);
+    do {
+        uint32_t raws[2 * SBC_MAX_BANDS];
+        OI_UINT i;
+
+        for (i = 0; i < count; ++i) {
+            OI_UINT bits = common->bits.uint8[i];
+            OI_UINT32 raw = 0;
+
+            if (bits) {
+                OI_BITSTREAM_READUINT(raw, bits, ptr, value, bitPtr);
+            }
+            raws[i] = (uint32_t)raw;
+        }
+        OI_SBC_DequantBlock_neon(s, raws, &params, count);
+        s += count;
+    } while (--nrof_blocks);
+#else
     const OI_UINT iter_count = common->frameInfo.nrof_channels * common->frameInfo.nrof_subbands / 4;
     do {
         OI_UINT i;
@@ -218,6 +240,7 @@ PRIVATE void OI_SBC_ReadSamples(OI_CODEC_SBC_DECODER_CONTEXT *context, OI_BITSTR
             }
         }
     } while (--nrof_blocks);
+#endif /* SBC_DECODER_NEON */
 }
 
 
@@ -0,0 +1,107 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/** @file
+
+NEON version of OI_SBC_Dequant(), for a whole block of samples at a time.
+
+The bit allocation and the scale factors are the same for every block of a
+frame, so the multiplier, shift and mask of each sample of a block are set
+up once per frame by OI_SBC_DequantSetup_neon(). The samples are read from
+the bitstream one by one as before, then OI_SBC_DequantBlock_neon() computes
+the same thing as OI_SBC_Dequant() four samples at a time:
+
+@code
+    result = ((raw * 2 + 1) * dequant_long_scaled[bits] - SBC_DEQUANT_LONG_SCALED_OFFSET) >> (15 - scale_factor)
+@endcode
+
+As shown in dequant.c, the product fits 32 bits unsigned and the difference
+fits 32 bits signed, so the 32-bit lanes give the same result as the C code
+whether OI_UINT32 is 32 or 64 bits wide.
+
+@ingroup codec_internal
+*/
+
+/**
+@addtogroup codec_internal
+@{
+*/
+
+#include "oi_codec_sbc_private.h"
+
+#ifdef SBC_DECODER_NEON
+
+#include <arm_neon.h>
+
+#ifndef SBC_DEQUANT_LONG_SCALED_OFFSET
+#define SBC_DEQUANT_LONG_SCALED_OFFSET 1555931970
+#endif
+
+extern const OI_UINT32 dequant_long_scaled[17];
+
+PRIVATE void OI_SBC_DequantSetup_neon(OI_SBC_DEQUANT_PARAMS *params, OI_CODEC_SBC_COMMON_CONTEXT const *common)
+{
+    OI_UINT count = common->frameInfo.nrof_channels * common->frameInfo.nrof_subbands;
+    OI_UINT i;
+
+    OI_ASSERT(count <= 2 * SBC_MAX_BANDS);
+
+    for (i = 0; i < count; i++) {
+        OI_UINT bits = common->bits.uint8[i];
+        OI_INT sf = common->scale_factor[i];
+
+        OI_ASSERT(sf <= 15);
+        OI_ASSERT(bits <= 16);
+
+        params->mult[i] = (uint32_t)dequant_long_scaled[bits];
+        params->shift[i] = sf - 15;
+        params->mask[i] = bits <= 1 ? 0 : 0xffffffff;
+    }
+}
+
+PRIVATE void OI_SBC_DequantBlock_neon(OI_INT32 *out, uint32_t const *raw, OI_SBC_DEQUANT_PARAMS const *params, OI_UINT count)
+{
+    const uint32x4_t one = vdupq_n_u32(1);
+    const uint32x4_t offset = vdupq_n_u32(SBC_DEQUANT_LONG_SCALED_OFFSET);
+    OI_UINT i;
+
+    OI_ASSERT(count % 4 == 0);
+
+    for (i = 0; i < count; i += 4) {
+        uint32x4_t d = vorrq_u32(vshlq_n_u32(vld1q_u32(raw + i), 1), one);
+        int32x4_t result;
+
+        d = vmulq_u32(d, vld1q_u32(params->mult + i));
+        result = vreinterpretq_s32_u32(vsubq_u32(d, offset));
+        result = vshlq_s32(result, vld1q_s32(params->shift + i));
+        result = vreinterpretq_s32_u32(vandq_u32(vreinterpretq_u32_s32(result), vld1q_u32(params->mask + i)));
+
+        if (sizeof(OI_INT32) == sizeof(int32_t)) {
+            vst1q_s32((int32_t *)out + i, result);
+        } else {
+            vst1q_s64((int64_t *)out + i, vmovl_s32(vget_low_s32(result)));
+            vst1q_s64((int64_t *)out + i + 2, vmovl_s32(vget_high_s32(result)));
+        }
+    }
+}
+
+#endif /* SBC_DECODER_NEON */
+
+/**
+@}
+*/
@@ -0,0 +1,160 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/** @file
+
+NEON version of SynthWindow80_generated(), the windowing of the 8-subband
+synthesis filterbank.
+
+SynthWindow80_generated() computes each output sample as a sum of terms
+(coefficient * buffer[i]) shifted left or right by a per-term amount. Every
+term it uses comes from one of the five 16-value "rows" of the buffer, at
+columns 4..12 of the row:
+
+@code
+    pcm[0] uses columns 4 and 12
+    pcm[1] and pcm[7] use columns 5 and 11
+    pcm[2] and pcm[6] use columns 6 and 10
+    pcm[3] and pcm[5] use columns 7 and 9
+    pcm[4] uses column 8
+@endcode
+
+So for each row, two 8-lane loads (columns 5..12 and 4..11) multiplied by
+two coefficient vectors give all the terms of that row, and the terms of
+each output are summed from their lanes at the end. Splitting the terms
+between the "a" loads and the "b" loads this way leaves every lane with at
+most one term per row.
+
+The terms are computed exactly like the C code: a 16x16->32 multiply then a
+shift of the 32-bit product. They are summed in 64 bits and converted to
+OI_INT32 at the end, which gives the same result as the C code's running
+OI_INT32 sum whether OI_INT32 is 32 or 64 bits wide.
+
+@ingroup codec_internal
+*/
+
+/**
+@addtogroup codec_internal
+@{
+*/
+
+#include "oi_codec_sbc_private.h"
+
+#ifdef SBC_DECODER_NEON
+
+#include <arm_neon.h>
+
+#ifndef CLIP_INT16
+#define CLIP_INT16(x) do { if (x > OI_INT16_MAX) { x = OI_INT16_MAX; } else if (x < OI_INT16_MIN) { x = OI_INT16_MIN; } } while (0)
+#endif
+
+/* Coefficients and shifts (positive to the left) of the terms of
+ * SynthWindow80_generated(), by row and by column 5..12 of the row.
+ * Column 5+i contributes to pcm[1, 2, 3, 4, 3, 2, 1, 0][i]. */
+static const int16_t window_a_coef[5][8] = {
+    { -3263, -10385, -16457,  10445,  19083,  24995,  29293,   8235 },
+    { -5229,   -309, -23641,  -5297, -29015,   9161,  30835,  26479 },
+    {-27021, -23063, -12889,  22299,   6145,  27561,  31633,   9399 },
+    { 17319,   2309,  24211,  10603,  23469,  12705,  26663,  26479 },
+    {  4555,   6239,  21223,   9539,  26913,   9251,  12419,   8235 },
+};
+
+static const int32_t window_a_shift[5][8] = {
+    {    -5,     -6,     -6,     -4,     -5,     -5,     -5,     -3 },
+    {     0,      4,     -2,      1,     -4,     -3,     -3,     -2 },
+    {     1,      1,      2,      2,      3,      1,      1,      3 },
+    {     1,      3,     -1,      0,     -2,     -1,     -2,     -2 },
+    {    -1,     -3,     -8,     -4,     -6,     -4,     -4,     -3 },
+};
+
+/* The same for columns 4..11 of each row. Column 4+i contributes to
+ * pcm[0, 7, 6, 5, -, 5, 6, 7][i]; column 8 has no terms here. */
+static const int16_t window_b_coef[5][8] = {
+    {     0,   9293,  11167,  16913,      0,  -8443, -10337,  -6087 },
+    {-23167,   1247,   1917,   3687,      0,   -301, -30605,  -2893 },
+    {-17397,  23671,   8317,  15447,      0,  10255,   9553,  18055 },
+    { 17397,  11537,  22117, -18233,      0,   9405,  16383,   1747 },
+    { 23167,    685,   7543,   1499,      0,  26189,   8603,   8721 },
+};
+
+static const int32_t window_b_shift[5][8] = {
+    {     0,     -3,     -4,     -5,      0,     -7,     -4,     -2 },
+    {    -3,      3,      2,      1,      0,      5,     -1,      3 },
+    {     1,      2,      3,      2,      0,      2,      2,      1 },
+    {     1,     -1,     -4,     -3,      0,     -1,     -2,      1 },
+    {    -3,      1,     -3,     -1,      0,     -7,     -6,     -7 },
+};
+
+/** Adds the shifted products of the lanes of @a v and @a coef to @a lo
+ * (lanes 0..3) and @a hi (lanes 4..7). */
+#define WINDOW_MAC(lo, hi, v, coef, shift) do { \
+        int32x4_t t_lo_ = vshlq_s32(vmull_s16(vget_low_s16(v), vget_low_s16(coef)), vld1q_s32(shift)); \
+        int32x4_t t_hi_ = vshlq_s32(vmull_s16(vget_high_s16(v), vget_high_s16(coef)), vld1q_s32((shift) + 4)); \
+        lo[0] = vaddw_s32(lo[0], vget_low_s32(t_lo_)); \
+        lo[1] = vaddw_s32(lo[1], vget_high_s32(t_lo_)); \
+        hi[0] = vaddw_s32(hi[0], vget_low_s32(t_hi_)); \
+        hi[1] = vaddw_s32(hi[1], vget_high_s32(t_hi_)); \
+    } while (0)
+
+/** Divides like the C code (rounding towards zero), clips and stores. */
+#define WINDOW_OUT(pcm, i, strideShift, sum) do { \
+        OI_INT32 x_ = (OI_INT32)(sum); \
+        x_ /= 32768; CLIP_INT16(x_); (pcm)[(i) << (strideShift)] = (OI_INT16)x_; \
+    } while (0)
+
+PRIVATE void SynthWindow80_neon(OI_INT16 *pcm, SBC_BUFFER_T const * RESTRICT buffer, OI_UINT strideShift)
+{
+    int64x2_t a_lo[2], a_hi[2], b_lo[2], b_hi[2];
+    int64_t a[8], b[8];
+    OI_UINT row;
+
+    a_lo[0] = a_lo[1] = a_hi[0] = a_hi[1] = vdupq_n_s64(0);
+    b_lo[0] = b_lo[1] = b_hi[0] = b_hi[1] = vdupq_n_s64(0);
+
+    for (row = 0; row < 5; row++) {
+        int16x8_t va = vld1q_s16(buffer + 16 * row + 5);
+        int16x8_t vb = vld1q_s16(buffer + 16 * row + 4);
+
+        WINDOW_MAC(a_lo, a_hi, va, vld1q_s16(window_a_coef[row]), window_a_shift[row]);
+        WINDOW_MAC(b_lo, b_hi, vb, vld1q_s16(window_b_coef[row]), window_b_shift[row]);
+    }
+
+    vst1q_s64(a + 0, a_lo[0]);
+    vst1q_s64(a + 2, a_lo[1]);
+    vst1q_s64(a + 4, a_hi[0]);
+    vst1q_s64(a + 6, a_hi[1]);
+    vst1q_s64(b + 0, b_lo[0]);
+    vst1q_s64(b + 2, b_lo[1]);
+    vst1q_s64(b + 4, b_hi[0]);
+    vst1q_s64(b + 6, b_hi[1]);
+
+    WINDOW_OUT(pcm, 0, strideShift, a[7] + b[0]);
+    WINDOW_OUT(pcm, 1, strideShift, a[0] + a[6]);
+    WINDOW_OUT(pcm, 7, strideShift, b[1] + b[7]);
+    WINDOW_OUT(pcm, 2, strideShift, a[1] + a[5]);
+    WINDOW_OUT(pcm, 6, strideShift, b[2] + b[6]);
+    WINDOW_OUT(pcm, 3, strideShift, a[2] + a[4]);
+    WINDOW_OUT(pcm, 5, strideShift, b[3] + b[5]);
+    WINDOW_OUT(pcm, 4, strideShift, a[3]);
+}
+
+#endif /* SBC_DECODER_NEON */
+
+/**
+@}
+*/
@@ -247,6 +247,10 @@ typedef void (*SYNTH_FRAME)(OI_CODEC_SBC_DECODER_CONTEXT *context, OI_INT16 *pcm
 #define DCT2_8(dst, src) dct2_8(dst, src)
 #endif
 
+#if !defined(SYNTH80) && defined(SBC_DECODER_NEON)
+#define SYNTH80 SynthWindow80_neon
+#endif
+
 #ifndef SYNTH80
 #define SYNTH80 SynthWindow80_generated
 #endif
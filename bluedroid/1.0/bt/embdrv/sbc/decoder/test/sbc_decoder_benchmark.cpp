@@ -0,0 +1,116 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+// Cost of the synthesis window and of the dequantizer for one A2DP frame:
+// 16 blocks of 8 subbands in stereo. The argument of each benchmark selects
+// the C version (0) or the NEON version (1), when built with NEON. The
+// "cycles_per_frame" counter uses the CPU frequency that the benchmark
+// library reports, so it is only meaningful with a fixed CPU frequency.
+
+#include <benchmark/benchmark.h>
+
+#include <string.h>
+#include <random>
+
+extern "C" {
+#include "oi_codec_sbc_private.h"
+}
+
+static const int BLOCKS = 16;
+static const int CHANNELS = 2;
+static const int SUBBANDS = 8;
+
+static void set_cycles_per_frame(benchmark::State &state) {
+  state.SetItemsProcessed(state.iterations());
+  state.counters["cycles_per_frame"] = benchmark::Counter(
+      state.iterations() / benchmark::CPUInfo::Get().cycles_per_second,
+      benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+static void BM_SynthWindow80(benchmark::State &state) {
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> sample(-8192, 8192);
+  SBC_BUFFER_T buffer[BLOCKS * SUBBANDS + 80];
+  for (size_t i = 0; i < sizeof(buffer) / sizeof(buffer[0]); ++i)
+    buffer[i] = (SBC_BUFFER_T)sample(rng);
+  OI_INT16 pcm[BLOCKS * SUBBANDS * CHANNELS];
+
+  void (*window)(OI_INT16 *, SBC_BUFFER_T const *, OI_UINT) = SynthWindow80_generated;
+#ifdef SBC_DECODER_NEON
+  if (state.range(0))
+    window = SynthWindow80_neon;
+#endif
+
+  while (state.KeepRunning()) {
+    for (int blk = 0; blk < BLOCKS; ++blk) {
+      for (int ch = 0; ch < CHANNELS; ++ch)
+        window(pcm + blk * SUBBANDS * CHANNELS + ch, buffer + blk * SUBBANDS, 1);
+    }
+    benchmark::DoNotOptimize(pcm);
+  }
+  set_cycles_per_frame(state);
+}
+BENCHMARK(BM_SynthWindow80)->Arg(0)
+#ifdef SBC_DECODER_NEON
+    ->Arg(1)
+#endif
+    ;
+
+static void BM_Dequant(benchmark::State &state) {
+  std::mt19937 rng(2);
+  const OI_UINT count = CHANNELS * SUBBANDS;
+  OI_CODEC_SBC_COMMON_CONTEXT common;
+  memset(&common, 0, sizeof(common));
+  common.frameInfo.nrof_channels = CHANNELS;
+  common.frameInfo.nrof_subbands = SUBBANDS;
+  uint32_t raw[BLOCKS][count];
+  for (OI_UINT i = 0; i < count; ++i) {
+    OI_UINT bits = 2 + rng() % 8;
+    common.bits.uint8[i] = (OI_UINT8)bits;
+    common.scale_factor[i] = (OI_INT8)(rng() % 16);
+    for (int blk = 0; blk < BLOCKS; ++blk)
+      raw[blk][i] = rng() % ((1u << bits) - 1);
+  }
+  OI_INT32 out[BLOCKS][count];
+
+  while (state.KeepRunning()) {
+#ifdef SBC_DECODER_NEON
+    if (state.range(0)) {
+      OI_SBC_DEQUANT_PARAMS params;
+      OI_SBC_DequantSetup_neon(&params, &common);
+      for (int blk = 0; blk < BLOCKS; ++blk)
+        OI_SBC_DequantBlock_neon(out[blk], raw[blk], &params, count);
+      benchmark::DoNotOptimize(out);
+      continue;
+    }
+#endif
+    for (int blk = 0; blk < BLOCKS; ++blk) {
+      for (OI_UINT i = 0; i < count; ++i)
+        out[blk][i] = OI_SBC_Dequant(raw[blk][i], common.scale_factor[i], common.bits.uint8[i]);
+    }
+    benchmark::DoNotOptimize(out);
+  }
+  set_cycles_per_frame(state);
+}
+BENCHMARK(BM_Dequant)->Arg(0)
+#ifdef SBC_DECODER_NEON
+    ->Arg(1)
+#endif
+    ;
+
+BENCHMARK_MAIN();
@@ -0,0 +1,87 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+// Checks that the NEON kernels of the SBC decoder give the same output as
+// the C ones, bit for bit. Without NEON there is nothing to compare.
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+#include <random>
+
+extern "C" {
+#include "oi_codec_sbc_private.h"
+}
+
+#ifdef SBC_DECODER_NEON
+
+static const int ITERATIONS = 100000;
+
+TEST(SbcDecoderNeonTest, test_synth_window_80_matches_c) {
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> sample(OI_INT16_MIN, OI_INT16_MAX);
+  SBC_BUFFER_T buffer[80];
+
+  for (int i = 0; i < ITERATIONS; ++i) {
+    for (int j = 0; j < 80; ++j)
+      buffer[j] = (SBC_BUFFER_T)sample(rng);
+
+    for (OI_UINT strideShift = 0; strideShift <= 1; ++strideShift) {
+      OI_INT16 expected[16] = {0};
+      OI_INT16 actual[16] = {0};
+      SynthWindow80_generated(expected, buffer, strideShift);
+      SynthWindow80_neon(actual, buffer, strideShift);
+      ASSERT_EQ(0, memcmp(expected, actual, sizeof(expected)))
+          << "iteration " << i << ", strideShift " << strideShift;
+    }
+  }
+}
+
+TEST(SbcDecoderNeonTest, test_dequant_block_matches_c) {
+  std::mt19937 rng(2);
+  OI_CODEC_SBC_COMMON_CONTEXT common;
+  memset(&common, 0, sizeof(common));
+
+  for (int i = 0; i < ITERATIONS; ++i) {
+    common.frameInfo.nrof_channels = 1 + (i & 1);
+    common.frameInfo.nrof_subbands = (i & 2) ? 8 : 4;
+    OI_UINT count = common.frameInfo.nrof_channels * common.frameInfo.nrof_subbands;
+
+    uint32_t raw[2 * SBC_MAX_BANDS];
+    for (OI_UINT j = 0; j < count; ++j) {
+      OI_UINT bits = rng() % 17;
+      common.bits.uint8[j] = (OI_UINT8)bits;
+      common.scale_factor[j] = (OI_INT8)(rng() % 16);
+      // Includes the all ones value that conformant encoders do not send.
+      raw[j] = bits ? rng() & ((1u << bits) - 1) : 0;
+    }
+
+    OI_SBC_DEQUANT_PARAMS params;
+    OI_INT32 actual[2 * SBC_MAX_BANDS];
+    OI_SBC_DequantSetup_neon(&params, &common);
+    OI_SBC_DequantBlock_neon(actual, raw, &params, count);
+
+    for (OI_UINT j = 0; j < count; ++j) {
+      ASSERT_EQ(OI_SBC_Dequant(raw[j], common.scale_factor[j], common.bits.uint8[j]), actual[j])
+          << "raw " << raw[j] << ", scale factor " << (int)common.scale_factor[j]
+          << ", bits " << (int)common.bits.uint8[j];
+    }
+  }
+}
+
+#endif  // SBC_DECODER_NEON
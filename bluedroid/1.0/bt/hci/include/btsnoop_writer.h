@@ -0,0 +1,45 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Asynchronous writer for the btsnoop log. Records are appended to an
+// in-memory ring without locks or allocation, and a background thread
+// writes them to the log file and to btsnoop_net in large batches. When
+// the ring is full, records are dropped instead of blocking the caller.
+
+// Starts the writer thread, which writes to |fd| until |btsnoop_writer_stop|
+// is called. |fd| stays owned by the caller. Returns false if the thread
+// could not be started.
+bool btsnoop_writer_start(int fd);
+
+// Writes the records still in the ring and stops the writer thread. Safe to
+// call when the writer is not started.
+void btsnoop_writer_stop(void);
+
+// Appends a record made of |header_len| bytes at |header| followed by
+// |packet_len| bytes at |packet|. Never blocks; the record is dropped if the
+// writer is not started or the ring is full. Safe to call from any thread.
+void btsnoop_writer_write(const void *header, size_t header_len,
+                          const void *packet, size_t packet_len);
+
+// Returns the number of records dropped since the writer was started.
+size_t btsnoop_writer_dropped(void);
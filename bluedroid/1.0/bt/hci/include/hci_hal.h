@@ -19,6 +19,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "osi/include/thread.h"
@@ -32,6 +33,7 @@ typedef enum {
 } serial_data_type_t;
 
 typedef void (*data_ready_cb)(serial_data_type_t type);
+typedef void (*packet_ready_cb)(serial_data_type_t type, const uint8_t *data, size_t length);
 
 typedef struct {
   // Called when the HAL detects inbound data.
@@ -39,6 +41,12 @@ typedef struct {
   // Executes in the context of the thread supplied to |init|.
   data_ready_cb data_ready;
 
+  // Optional. HALs that can find packet boundaries themselves call this
+  // instead of |data_ready|, with a complete packet of |type| in |data|.
+  // |data| is only valid during the call. Executes in the context of the
+  // thread supplied to |init|.
+  packet_ready_cb packet_ready;
+
   /*
   // Called when the HAL detects inbound astronauts named Dave.
   // HAL will deny all requests to open the pod bay doors after this.
@@ -36,6 +36,7 @@
 #include "bt_types.h"
 #include "hci/include/btsnoop.h"
 #include "hci/include/btsnoop_mem.h"
+#include "hci/include/btsnoop_writer.h"
 #include "hci_layer.h"
 #include "osi/include/log.h"
 #include "stack_config.h"
@@ -215,10 +216,20 @@ static void update_logging() {
     umask(prevmask);
 
     write(logfile_fd, "btsnoop\0\0\0\0\1\0\0\x3\xea", 16);
+
+    if (!btsnoop_writer_start(logfile_fd)) {
+      LOG_ERROR(LOG_TAG, "%s unable to start the log writer.", __func__);
+      close(logfile_fd);
+      logfile_fd = INVALID_FD;
+      is_logging = false;
+      return;
+    }
 #endif
   } else {
 #if defined(MTK_BTSNOOPLOG_THREAD) && (MTK_BTSNOOPLOG_THREAD == TRUE)
       twrite_deinit();
+#else
+    btsnoop_writer_stop();
 #endif
     if (logfile_fd != INVALID_FD)
       close(logfile_fd);
@@ -228,17 +239,14 @@ static void update_logging() {
   }
 }
 
-static void btsnoop_write(const void *data, size_t length) {
 #if defined(MTK_BTSNOOPLOG_THREAD) && (MTK_BTSNOOPLOG_THREAD == TRUE)
+static void btsnoop_write(const void *data, size_t length) {
   if ((int)length != twrite_write(data, length))
     LOG_ERROR(LOG_TAG, "%s twrite_write data failed", __func__);
-#else
-  if (logfile_fd != INVALID_FD)
-    write(logfile_fd, data, length);
-#endif
 
   btsnoop_net_write(data, length);
 }
+#endif
 
 static void btsnoop_write_packet(packet_type_t type, const uint8_t *packet, bool is_received) {
   int length_he = 0;
@@ -273,19 +281,23 @@ static void btsnoop_write_packet(packet_type_t type, const uint8_t *packet, bool
   twrite_write_packet(btsnoop_write, type, packet, length_he, length, flags,
     drops, time_hi, time_lo);
 #else
+  // The writer thread writes the record to the log file and to btsnoop_net.
+  uint8_t header[25];
+  drops = btsnoop_writer_dropped();
+
   length = htonl(length_he);
   flags = htonl(flags);
   drops = htonl(drops);
   time_hi = htonl(time_hi);
   time_lo = htonl(time_lo);
 
-  btsnoop_write(&length, 4);
-  btsnoop_write(&length, 4);
-  btsnoop_write(&flags, 4);
-  btsnoop_write(&drops, 4);
-  btsnoop_write(&time_hi, 4);
-  btsnoop_write(&time_lo, 4);
-  btsnoop_write(&type, 1);
-  btsnoop_write(packet, length_he - 1);
+  memcpy(header, &length, 4);
+  memcpy(header + 4, &length, 4);
+  memcpy(header + 8, &flags, 4);
+  memcpy(header + 12, &drops, 4);
+  memcpy(header + 16, &time_hi, 4);
+  memcpy(header + 20, &time_lo, 4);
+  header[24] = type;
+  btsnoop_writer_write(header, sizeof(header), packet, length_he - 1);
 #endif
 }
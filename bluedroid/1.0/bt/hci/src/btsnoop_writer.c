@@ -0,0 +1,267 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#define LOG_TAG "bt_snoop_writer"
+
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+
+#include "hci/include/btsnoop_writer.h"
+#include "osi/include/allocator.h"
+#include "osi/include/log.h"
+#include "osi/include/osi.h"
+
+// Size of the ring, a power of two.
+#define RING_SIZE (512 * 1024)
+#define RING_MASK (RING_SIZE - 1)
+
+// Records are written in batches of up to this many bytes, which is also
+// the largest record accepted (an ACL packet with a 16 bit length fits).
+#define BATCH_SIZE (128 * 1024)
+
+// The writer thread is woken up once this many bytes are pending, and
+// otherwise writes whatever is pending every FLUSH_INTERVAL_MS.
+#define WAKEUP_THRESHOLD (32 * 1024)
+#define FLUSH_INTERVAL_MS 1000
+
+static const char *WRITER_THREAD_NAME = "btsnoop_writer";
+
+void btsnoop_net_write(const void *data, size_t length);
+
+// Each record in the ring starts with its length and is padded to a
+// multiple of 4 bytes, so a length is never split by the end of the ring.
+// A zero length means the producer has reserved the record but not finished
+// copying it in yet; the writer clears the records it consumes to keep it so.
+typedef atomic_uint_least32_t record_length_t;
+
+#define RECORD_SIZE(len) (sizeof(record_length_t) + (((len) + 3) & ~(size_t)3))
+
+// The ring, the batch buffer and the wakeup fd are allocated on the first
+// start and kept afterwards, so a producer that races with
+// |btsnoop_writer_stop| never touches freed memory or a closed fd.
+static uint8_t *ring;
+static uint8_t *batch;
+static int wakeup_fd = INVALID_FD;
+
+static atomic_size_t reserve_pos;  // End of the records reserved by producers.
+static atomic_size_t read_pos;     // Start of the records not consumed yet.
+static atomic_size_t dropped;
+static atomic_bool running;
+
+static int log_fd = INVALID_FD;
+static pthread_t writer_thread;
+
+static void *writer_thread_fn(void *context);
+
+bool btsnoop_writer_start(int fd) {
+  assert(fd != INVALID_FD);
+  assert(!atomic_load(&running));
+
+  if (ring == NULL) {
+    wakeup_fd = eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd == INVALID_FD) {
+      LOG_ERROR(LOG_TAG, "%s unable to create eventfd: %s", __func__, strerror(errno));
+      return false;
+    }
+    ring = osi_calloc(RING_SIZE);
+    batch = osi_malloc(BATCH_SIZE);
+  } else {
+    memset(ring, 0, RING_SIZE);
+  }
+
+  atomic_store(&reserve_pos, 0);
+  atomic_store(&read_pos, 0);
+  atomic_store(&dropped, 0);
+  log_fd = fd;
+  atomic_store_explicit(&running, true, memory_order_release);
+
+  if (pthread_create(&writer_thread, NULL, writer_thread_fn, NULL)) {
+    LOG_ERROR(LOG_TAG, "%s unable to create writer thread.", __func__);
+    atomic_store(&running, false);
+    log_fd = INVALID_FD;
+    return false;
+  }
+
+  return true;
+}
+
+void btsnoop_writer_stop(void) {
+  if (!atomic_exchange(&running, false))
+    return;
+
+  eventfd_write(wakeup_fd, 1);
+  pthread_join(writer_thread, NULL);
+  log_fd = INVALID_FD;
+
+  size_t drops = atomic_load(&dropped);
+  if (drops)
+    LOG_WARN(LOG_TAG, "%s dropped %zu records in total.", __func__, drops);
+}
+
+size_t btsnoop_writer_dropped(void) {
+  return atomic_load_explicit(&dropped, memory_order_relaxed);
+}
+
+static void copy_to_ring(size_t pos, const void *data, size_t length) {
+  size_t offset = pos & RING_MASK;
+  size_t first = RING_SIZE - offset;
+  if (first > length)
+    first = length;
+
+  memcpy(ring + offset, data, first);
+  memcpy(ring, (const uint8_t *)data + first, length - first);
+}
+
+static void copy_from_ring(void *data, size_t pos, size_t length) {
+  size_t offset = pos & RING_MASK;
+  size_t first = RING_SIZE - offset;
+  if (first > length)
+    first = length;
+
+  memcpy(data, ring + offset, first);
+  memcpy((uint8_t *)data + first, ring, length - first);
+}
+
+static void clear_ring(size_t pos, size_t length) {
+  size_t offset = pos & RING_MASK;
+  size_t first = RING_SIZE - offset;
+  if (first > length)
+    first = length;
+
+  memset(ring + offset, 0, first);
+  memset(ring, 0, length - first);
+}
+
+void btsnoop_writer_write(const void *header, size_t header_len,
+                          const void *packet, size_t packet_len) {
+  if (!atomic_load_explicit(&running, memory_order_acquire))
+    return;
+
+  size_t length = header_len + packet_len;
+  size_t size = RECORD_SIZE(length);
+  if (length == 0 || length > BATCH_SIZE) {
+    atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+    return;
+  }
+
+  // |read_pos| is loaded first so that it never runs ahead of |pos|.
+  size_t read;
+  size_t pos;
+  do {
+    read = atomic_load_explicit(&read_pos, memory_order_acquire);
+    pos = atomic_load_explicit(&reserve_pos, memory_order_relaxed);
+    if (pos + size - read > RING_SIZE) {
+      atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+      return;
+    }
+  } while (!atomic_compare_exchange_weak_explicit(&reserve_pos, &pos, pos + size,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed));
+
+  copy_to_ring(pos + sizeof(record_length_t), header, header_len);
+  copy_to_ring(pos + sizeof(record_length_t) + header_len, packet, packet_len);
+  atomic_store_explicit((record_length_t *)(ring + (pos & RING_MASK)),
+                        (uint_least32_t)length, memory_order_release);
+
+  if (pos - read < WAKEUP_THRESHOLD && pos + size - read >= WAKEUP_THRESHOLD)
+    eventfd_write(wakeup_fd, 1);
+}
+
+static void write_batch(size_t length) {
+  static bool write_failed;
+
+  size_t written = 0;
+  while (written < length) {
+    ssize_t ret;
+    OSI_NO_INTR(ret = write(log_fd, batch + written, length - written));
+    if (ret == -1) {
+      if (!write_failed)
+        LOG_ERROR(LOG_TAG, "%s unable to write to log: %s", __func__, strerror(errno));
+      write_failed = true;
+      break;
+    }
+    written += ret;
+  }
+
+  btsnoop_net_write(batch, length);
+}
+
+// Moves the finished records out of the ring and writes them.
+static void drain(void) {
+  size_t read = atomic_load_explicit(&read_pos, memory_order_relaxed);
+  size_t batch_len = 0;
+
+  for (;;) {
+    record_length_t *prefix = (record_length_t *)(ring + (read & RING_MASK));
+    size_t length = atomic_load_explicit(prefix, memory_order_acquire);
+    if (length == 0)
+      break;
+
+    if (batch_len + length > BATCH_SIZE) {
+      write_batch(batch_len);
+      batch_len = 0;
+    }
+    copy_from_ring(batch + batch_len, read + sizeof(record_length_t), length);
+    batch_len += length;
+
+    size_t size = RECORD_SIZE(length);
+    clear_ring(read, size);
+    read += size;
+    atomic_store_explicit(&read_pos, read, memory_order_release);
+  }
+
+  if (batch_len)
+    write_batch(batch_len);
+}
+
+static void *writer_thread_fn(UNUSED_ATTR void *context) {
+  prctl(PR_SET_NAME, (unsigned long)WRITER_THREAD_NAME, 0, 0, 0);
+
+  struct pollfd pfd = { .fd = wakeup_fd, .events = POLLIN };
+  size_t reported_drops = 0;
+
+  while (atomic_load_explicit(&running, memory_order_acquire)) {
+    int ret;
+    OSI_NO_INTR(ret = poll(&pfd, 1, FLUSH_INTERVAL_MS));
+    if (ret > 0) {
+      eventfd_t value;
+      eventfd_read(wakeup_fd, &value);
+    }
+
+    drain();
+
+    size_t drops = atomic_load_explicit(&dropped, memory_order_relaxed);
+    if (drops != reported_drops) {
+      LOG_WARN(LOG_TAG, "%s ring full, dropped %zu records.", __func__,
+               drops - reported_drops);
+      reported_drops = drops;
+    }
+  }
+
+  // Whatever the producers finished before the writer was stopped.
+  drain();
+  return NULL;
+}
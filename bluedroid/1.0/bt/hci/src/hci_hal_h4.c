@@ -24,6 +24,7 @@
 #include <unistd.h>
 
 #include "hci_hal.h"
+#include "hci_internals.h"
 #include "osi/include/eager_reader.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
@@ -34,6 +35,12 @@
 #define HCI_HAL_SERIAL_BUFFER_SIZE 1026
 #define HCI_BLE_EVENT 0x3e
 
+// When the upper layer takes whole packets, the UART is read into a ring
+// with room for two of the largest possible H4 packets, and at most
+// HCI_HAL_PACKET_BATCH packets are handed up per wakeup.
+#define HCI_HAL_SERIAL_RING_SIZE (160 * 1024)
+#define HCI_HAL_PACKET_BATCH 16
+
 // Increased HCI thread priority to keep up with the audio sub-system
 // when streaming time sensitive data (A2DP).
 #define HCI_THREAD_PRIORITY -19
@@ -55,6 +62,8 @@ static bool stream_corruption_detected;
 static uint8_t stream_corruption_bytes_to_ignore;
 
 static void event_uart_has_bytes(eager_reader_t *reader, void *context);
+static void event_uart_has_packets(eager_reader_t *reader, void *context);
+static size_t h4_packet_length(const uint8_t *data, size_t length);
 
 // Interface functions
 
@@ -85,7 +94,10 @@ static bool hal_open() {
     goto error;
   }
 
-  uart_stream = eager_reader_new(uart_fd, &allocator_malloc, HCI_HAL_SERIAL_BUFFER_SIZE, SIZE_MAX, "hci_single_channel");
+  if (callbacks->packet_ready)
+    uart_stream = eager_reader_new_framed(uart_fd, HCI_HAL_SERIAL_RING_SIZE, HCI_HAL_SERIAL_BUFFER_SIZE, h4_packet_length, "hci_single_channel");
+  else
+    uart_stream = eager_reader_new(uart_fd, &allocator_malloc, HCI_HAL_SERIAL_BUFFER_SIZE, SIZE_MAX, "hci_single_channel");
   if (!uart_stream) {
     LOG_ERROR(LOG_TAG, "%s unable to create eager reader for the uart serial port.", __func__);
     goto error;
@@ -94,7 +106,8 @@ static bool hal_open() {
   stream_has_interpretation = false;
   stream_corruption_detected = false;
   stream_corruption_bytes_to_ignore = 0;
-  eager_reader_register(uart_stream, thread_get_reactor(thread), event_uart_has_bytes, NULL);
+  eager_reader_register(uart_stream, thread_get_reactor(thread),
+                        callbacks->packet_ready ? event_uart_has_packets : event_uart_has_bytes, NULL);
 
   // Raise thread priorities to keep up with audio
   thread_set_priority(thread, HCI_THREAD_PRIORITY);
@@ -254,6 +267,64 @@ static void event_uart_has_bytes(eager_reader_t *reader, UNUSED_ATTR void *conte
   }
 }
 
+// Returns the length of the H4 packet at |data|, including the type byte, or
+// 0 if more of it is needed to tell.
+static size_t h4_packet_length(const uint8_t *data, size_t length) {
+  if (length < 1)
+    return 0;
+
+  switch (data[0]) {
+    case DATA_TYPE_ACL:
+      if (length < 1 + HCI_ACL_PREAMBLE_SIZE)
+        return 0;
+      return 1 + HCI_ACL_PREAMBLE_SIZE + (data[3] | (data[4] << 8));
+    case DATA_TYPE_SCO:
+      if (length < 1 + HCI_SCO_PREAMBLE_SIZE)
+        return 0;
+      return 1 + HCI_SCO_PREAMBLE_SIZE + data[3];
+    case DATA_TYPE_EVENT:
+      if (length < 1 + HCI_EVENT_PREAMBLE_SIZE)
+        return 0;
+      return 1 + HCI_EVENT_PREAMBLE_SIZE + data[2];
+    case HCI_BLE_EVENT:
+      // See stream_corrupted_during_le_scan_workaround: the byte after the
+      // bogus type is the number of bytes to skip.
+      if (length < 2)
+        return 0;
+      return 2 + data[1];
+    default:
+      // Reported by event_uart_has_packets; the next byte is taken as a type.
+      return 1;
+  }
+}
+
+// Hands the complete packets waiting in the ring to the upper layer.
+static void event_uart_has_packets(eager_reader_t *reader, UNUSED_ATTR void *context) {
+  for (int i = 0; i < HCI_HAL_PACKET_BATCH; ++i) {
+    const uint8_t *packet;
+    size_t length;
+    if (!eager_reader_peek_frame(reader, &packet, &length))
+      return;
+
+    uint8_t type_byte = packet[0];
+    if (type_byte == HCI_BLE_EVENT) {
+      LOG_ERROR(LOG_TAG, "%s HCI stream corrupted (message type 0x3E)! Skipped %zu bytes.",
+                __func__, length - 1);
+    } else if (type_byte < DATA_TYPE_ACL || type_byte > DATA_TYPE_EVENT) {
+      LOG_ERROR(LOG_TAG, "%s Unknown HCI message type 0x%x (min=0x%x max=0x%x). Aborting...",
+                __func__, type_byte, DATA_TYPE_ACL, DATA_TYPE_EVENT);
+#if !(defined(MTK_LINUX) && defined(MTK_COMMON) && (MTK_COMMON == TRUE))
+      LOG_EVENT_INT(BT_HCI_UNKNOWN_MESSAGE_TYPE_NUM, type_byte);
+#endif
+      assert(false && "Unknown HCI message type");
+    } else {
+      callbacks->packet_ready(type_byte, packet + 1, length - 1);
+    }
+
+    eager_reader_release_frame(reader);
+  }
+}
+
 static const hci_hal_t interface = {
   hal_init,
 
@@ -39,8 +39,10 @@
 #include "osi/include/alarm.h"
 #include "osi/include/list.h"
 #include "osi/include/log.h"
+#include "osi/include/metrics.h"
 #include "osi/include/properties.h"
 #include "osi/include/reactor.h"
+#include "osi/include/time.h"
 #include "packet_fragmenter.h"
 #include "vendor.h"
 
@@ -96,6 +98,7 @@ typedef struct {
   command_status_cb status_callback;
   void *context;
   BT_HDR *command;
+  uint64_t sent_us;
 } waiting_command_t;
 
 // Using a define here, because it can be stringified for the property lookup
@@ -163,6 +166,8 @@ static void event_packet_ready(fixed_queue_t *queue, void *context);
 static void command_timed_out(void *context);
 
 static void hal_says_data_ready(serial_data_type_t type);
+static void hal_says_packet_ready(serial_data_type_t type, const uint8_t *data, size_t length);
+static void dispatch_incoming_packet(serial_data_type_t type, BT_HDR *packet);
 static bool filter_incoming_event(BT_HDR *packet);
 
 static serial_data_type_t event_to_data_type(uint16_t event);
@@ -247,6 +252,9 @@ static future_t *start_up(void) {
 
   fixed_queue_register_dequeue(command_queue, thread_get_reactor(thread), event_command_ready, NULL);
   fixed_queue_register_dequeue(packet_queue, thread_get_reactor(thread), event_packet_ready, NULL);
+  // ACL and SCO data, A2DP included, must not wait behind bursts of
+  // inbound events such as advertising reports.
+  fixed_queue_set_dequeue_priority(packet_queue, REACTOR_PRIORITY_HIGH);
 
   vendor->open(btif_local_bd_addr.address, &interface);
   hal->init(&hal_callbacks, thread);
@@ -500,6 +508,7 @@ static void event_command_ready(fixed_queue_t *queue, UNUSED_ATTR void *context)
     command_credits--;
 
     // Move it to the list of commands awaiting response
+    wait_entry->sent_us = time_get_os_boottime_us();
     pthread_mutex_lock(&commands_pending_response_lock);
     list_append(commands_pending_response, wait_entry);
     pthread_mutex_unlock(&commands_pending_response_lock);
@@ -651,33 +660,7 @@ static void hal_says_data_ready(serial_data_type_t type) {
 
     if (incoming->state == FINISHED) {
       incoming->buffer->len = incoming->index;
-      btsnoop->capture(incoming->buffer, true);
-
-#if defined(MTK_VENDOR_OPCODE) && (MTK_VENDOR_OPCODE == TRUE)
-      if (type != DATA_TYPE_COMMAND) {
-        // Pass all hci event/acl data/sco data to vendor library.
-        bt_vendor_op_handle_vendor_msg_t vend_msg;
-        vend_msg.len = incoming->buffer->len;
-        vend_msg.type = type;
-        vend_msg.data = incoming->buffer->data;
-        vendor->send_async_command(VENDOR_HANDLE_VENDOR_MESSAGE, &vend_msg);
-      }
-#endif
-
-      if (type != DATA_TYPE_EVENT) {
-        packet_fragmenter->reassemble_and_dispatch(incoming->buffer);
-      } else if (!filter_incoming_event(incoming->buffer)) {
-        // Dispatch the event by event code
-        uint8_t *stream = incoming->buffer->data;
-        uint8_t event_code;
-        STREAM_TO_UINT8(event_code, stream);
-
-        data_dispatcher_dispatch(
-          interface.event_dispatcher,
-          event_code,
-          incoming->buffer
-        );
-      }
+      dispatch_incoming_packet(type, incoming->buffer);
 
       // We don't control the buffer anymore
       incoming->buffer = NULL;
@@ -692,6 +675,55 @@ static void hal_says_data_ready(serial_data_type_t type) {
   }
 }
 
+// Receives a complete packet from HALs that find packet boundaries themselves.
+static void hal_says_packet_ready(serial_data_type_t type, const uint8_t *data, size_t length) {
+  size_t buffer_size = BT_HDR_SIZE + length;
+  BT_HDR *packet = (BT_HDR *)buffer_allocator->alloc(buffer_size);
+  if (!packet) {
+    LOG_ERROR(LOG_TAG, "%s error getting buffer for incoming packet of type %d and size %zd", __func__, type, buffer_size);
+    return;
+  }
+
+  packet->offset = 0;
+  packet->layer_specific = 0;
+  packet->event = outbound_event_types[PACKET_TYPE_TO_INDEX(type)];
+  packet->len = length;
+  memcpy(packet->data, data, length);
+
+  dispatch_incoming_packet(type, packet);
+}
+
+// Hands a complete incoming packet to btsnoop and to the upper layers.
+static void dispatch_incoming_packet(serial_data_type_t type, BT_HDR *packet) {
+  btsnoop->capture(packet, true);
+
+#if defined(MTK_VENDOR_OPCODE) && (MTK_VENDOR_OPCODE == TRUE)
+  if (type != DATA_TYPE_COMMAND) {
+    // Pass all hci event/acl data/sco data to vendor library.
+    bt_vendor_op_handle_vendor_msg_t vend_msg;
+    vend_msg.len = packet->len;
+    vend_msg.type = type;
+    vend_msg.data = packet->data;
+    vendor->send_async_command(VENDOR_HANDLE_VENDOR_MESSAGE, &vend_msg);
+  }
+#endif
+
+  if (type != DATA_TYPE_EVENT) {
+    packet_fragmenter->reassemble_and_dispatch(packet);
+  } else if (!filter_incoming_event(packet)) {
+    // Dispatch the event by event code
+    uint8_t *stream = packet->data;
+    uint8_t event_code;
+    STREAM_TO_UINT8(event_code, stream);
+
+    data_dispatcher_dispatch(
+      interface.event_dispatcher,
+      event_code,
+      packet
+    );
+  }
+}
+
 // Returns true if the event was intercepted and should not proceed to
 // higher layers. Also inspects an incoming event for interesting
 // information, like how many commands are now able to be sent.
@@ -745,6 +777,9 @@ intercepted:
   update_command_response_timer();
 
   if (wait_entry) {
+    metrics_histogram_record(METRICS_HISTOGRAM_HCI_COMMAND_ROUND_TRIP,
+                             time_get_os_boottime_us() - wait_entry->sent_us);
+
     // If it has a callback, it's responsible for freeing the packet
     if (event_code == HCI_COMMAND_STATUS_EVT || (!wait_entry->complete_callback && !wait_entry->complete_future))
       buffer_allocator->free(packet);
@@ -865,7 +900,8 @@ void hci_layer_cleanup_interface() {
 }
 
 static const hci_hal_callbacks_t hal_callbacks = {
-  hal_says_data_ready
+  hal_says_data_ready,
+  hal_says_packet_ready
 };
 
 static const packet_fragmenter_callbacks_t packet_fragmenter_callbacks = {
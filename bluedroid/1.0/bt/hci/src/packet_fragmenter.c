@@ -27,8 +27,6 @@
 #include "buffer_allocator.h"
 #include "device/include/controller.h"
 #include "hci_internals.h"
-#include "osi/include/hash_functions.h"
-#include "osi/include/hash_map.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
 
@@ -42,8 +40,16 @@
 #define CONTINUATION_PACKET_BOUNDARY 1
 #define L2CAP_HEADER_SIZE       4
 
-// TODO(zachoverflow): find good value for this
-#define NUMBER_OF_BUCKETS 42
+// Number of ACL links that can have a packet being reassembled at once.
+#define MAX_PARTIAL_PACKETS 16
+
+// A packet being reassembled. |packet| is allocated for the full length
+// given by the L2CAP header of the start fragment, and each continuation is
+// copied straight to its place in it.
+typedef struct {
+  uint16_t handle;
+  BT_HDR *packet;    // NULL when the slot is free.
+} partial_packet_t;
 
 // Our interface and callbacks
 static const packet_fragmenter_t interface;
@@ -51,16 +57,34 @@ static const allocator_t *buffer_allocator;
 static const controller_t *controller;
 static const packet_fragmenter_callbacks_t *callbacks;
 
-static hash_map_t *partial_packets;
+static partial_packet_t partial_packets[MAX_PARTIAL_PACKETS];
 
 static void init(const packet_fragmenter_callbacks_t *result_callbacks) {
   callbacks = result_callbacks;
-  partial_packets = hash_map_new(NUMBER_OF_BUCKETS, hash_function_naive, NULL, NULL, NULL);
+  memset(partial_packets, 0, sizeof(partial_packets));
 }
 
 static void cleanup() {
-  if (partial_packets)
-    hash_map_free(partial_packets);
+  for (size_t i = 0; i < MAX_PARTIAL_PACKETS; ++i) {
+    if (partial_packets[i].packet)
+      buffer_allocator->free(partial_packets[i].packet);
+    partial_packets[i].packet = NULL;
+  }
+}
+
+// Returns the slot of the packet being reassembled for |handle|, or
+// the first free slot if there is none. Returns NULL if all slots are taken.
+static partial_packet_t *find_partial_packet(uint16_t handle) {
+  partial_packet_t *free_slot = NULL;
+  for (size_t i = 0; i < MAX_PARTIAL_PACKETS; ++i) {
+    if (partial_packets[i].packet == NULL) {
+      if (free_slot == NULL)
+        free_slot = &partial_packets[i];
+    } else if (partial_packets[i].handle == handle) {
+      return &partial_packets[i];
+    }
+  }
+  return free_slot;
 }
 
 static void fragment_and_dispatch(BT_HDR *packet) {
@@ -140,13 +164,14 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR *packet) {
     uint8_t boundary_flag = GET_BOUNDARY_FLAG(handle);
     handle = handle & HANDLE_MASK;
 
-    BT_HDR *partial_packet = (BT_HDR *)hash_map_get(partial_packets, (void *)(uintptr_t)handle);
+    partial_packet_t *slot = find_partial_packet(handle);
+    BT_HDR *partial_packet = slot ? slot->packet : NULL;
 
     if (boundary_flag == START_PACKET_BOUNDARY) {
       if (partial_packet) {
         LOG_WARN(LOG_TAG, "%s found unfinished packet for handle with start packet. Dropping old.", __func__);
 
-        hash_map_erase(partial_packets, (void *)(uintptr_t)handle);
+        slot->packet = NULL;
         buffer_allocator->free(partial_packet);
       }
 
@@ -175,6 +200,12 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR *packet) {
         return;
       }
 
+      if (!slot) {
+        LOG_ERROR(LOG_TAG, "%s too many packets being reassembled (%d). Dropping it.", __func__, MAX_PARTIAL_PACKETS);
+        buffer_allocator->free(packet);
+        return;
+      }
+
       partial_packet = (BT_HDR *)buffer_allocator->alloc(full_length + sizeof(BT_HDR));
       partial_packet->event = packet->event;
       partial_packet->len = full_length;
@@ -187,7 +218,8 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR *packet) {
       STREAM_SKIP_UINT16(stream); // skip the handle
       UINT16_TO_STREAM(stream, full_length - HCI_ACL_PREAMBLE_SIZE);
 
-      hash_map_set(partial_packets, (void *)(uintptr_t)handle, partial_packet);
+      slot->handle = handle;
+      slot->packet = partial_packet;
       // Free the old packet buffer, since we don't need it anymore
       buffer_allocator->free(packet);
     } else {
@@ -216,7 +248,7 @@ static void reassemble_and_dispatch(UNUSED_ATTR BT_HDR *packet) {
       partial_packet->offset = projected_offset;
 
       if (partial_packet->offset == partial_packet->len) {
-        hash_map_erase(partial_packets, (void *)(uintptr_t)handle);
+        slot->packet = NULL;
         partial_packet->offset = 0;
         callbacks->reassembled(partial_packet);
       }
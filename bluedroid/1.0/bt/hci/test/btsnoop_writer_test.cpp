@@ -0,0 +1,179 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hci/include/btsnoop_writer.h"
+
+// The records that would be forwarded to btsnoop_net.
+static size_t net_bytes;
+void btsnoop_net_write(const void *data, size_t length) {
+  net_bytes += length;
+}
+}
+
+static const size_t RECORD_COUNT = 20000;
+
+// Each record is a 4 byte header holding its index, and a payload of
+// |index % 256| bytes, all equal to the index.
+static void write_record(uint32_t index) {
+  uint8_t payload[256];
+  size_t payload_len = index % sizeof(payload);
+  memset(payload, (uint8_t)index, payload_len);
+  btsnoop_writer_write(&index, sizeof(index), payload, payload_len);
+}
+
+// Checks that |data| holds records in increasing index order, and returns
+// how many there are.
+static size_t check_records(const std::vector<uint8_t> &data) {
+  size_t count = 0;
+  size_t pos = 0;
+  uint32_t last_index = 0;
+  while (pos < data.size()) {
+    uint32_t index;
+    EXPECT_LE(pos + sizeof(index), data.size());
+    memcpy(&index, &data[pos], sizeof(index));
+    pos += sizeof(index);
+    if (count > 0)
+      EXPECT_GT(index, last_index);
+    last_index = index;
+
+    size_t payload_len = index % 256;
+    EXPECT_LE(pos + payload_len, data.size());
+    for (size_t i = 0; i < payload_len; ++i)
+      EXPECT_EQ((uint8_t)index, data[pos + i]);
+    pos += payload_len;
+    count++;
+  }
+  return count;
+}
+
+class BtsnoopWriterTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_EQ(0, pipe(fds));
+    net_bytes = 0;
+  }
+
+  virtual void TearDown() {
+    close(fds[0]);
+  }
+
+  // Reads the pipe until it is closed.
+  void start_reader() {
+    reader = std::thread([this] {
+      uint8_t buffer[4096];
+      ssize_t ret;
+      while ((ret = read(fds[0], buffer, sizeof(buffer))) > 0)
+        data.insert(data.end(), buffer, buffer + ret);
+    });
+  }
+
+  void stop_reader() {
+    close(fds[1]);
+    reader.join();
+  }
+
+  int fds[2];
+  std::thread reader;
+  std::vector<uint8_t> data;
+};
+
+TEST_F(BtsnoopWriterTest, test_write_is_noop_when_stopped) {
+  write_record(1);
+  EXPECT_EQ(0U, btsnoop_writer_dropped());
+  btsnoop_writer_stop();
+  close(fds[1]);
+}
+
+TEST_F(BtsnoopWriterTest, test_writes_all_records_in_order) {
+  start_reader();
+  ASSERT_TRUE(btsnoop_writer_start(fds[1]));
+  for (uint32_t i = 1; i <= RECORD_COUNT; ++i) {
+    write_record(i);
+    // Give the writer thread time to keep up.
+    if (i % 1000 == 0)
+      usleep(10000);
+  }
+  btsnoop_writer_stop();
+  stop_reader();
+
+  EXPECT_EQ(0U, btsnoop_writer_dropped());
+  EXPECT_EQ(RECORD_COUNT, check_records(data));
+  EXPECT_EQ(data.size(), net_bytes);
+}
+
+TEST_F(BtsnoopWriterTest, test_drops_instead_of_blocking) {
+  // Nothing reads the pipe yet, so the writer thread blocks once the pipe is
+  // full and the ring fills up behind it.
+  ASSERT_TRUE(btsnoop_writer_start(fds[1]));
+  for (uint32_t i = 1; i <= RECORD_COUNT; ++i)
+    write_record(i);
+
+  size_t dropped = btsnoop_writer_dropped();
+  EXPECT_GT(dropped, 0U);
+
+  start_reader();
+  btsnoop_writer_stop();
+  stop_reader();
+
+  EXPECT_EQ(RECORD_COUNT - dropped, check_records(data));
+}
+
+TEST_F(BtsnoopWriterTest, test_concurrent_producers) {
+  start_reader();
+  ASSERT_TRUE(btsnoop_writer_start(fds[1]));
+
+  const int PRODUCERS = 4;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < PRODUCERS; ++p) {
+    producers.emplace_back([] {
+      for (int i = 0; i < 1000; ++i) {
+        uint8_t payload[64];
+        memset(payload, 0x5a, sizeof(payload));
+        uint32_t header = sizeof(payload);
+        btsnoop_writer_write(&header, sizeof(header), payload, sizeof(payload));
+      }
+    });
+  }
+  for (auto &producer : producers)
+    producer.join();
+
+  btsnoop_writer_stop();
+  stop_reader();
+
+  size_t dropped = btsnoop_writer_dropped();
+  size_t record_size = sizeof(uint32_t) + 64;
+  ASSERT_EQ(0U, data.size() % record_size);
+  EXPECT_EQ(PRODUCERS * 1000 - dropped, data.size() / record_size);
+  for (size_t pos = 0; pos < data.size(); pos += record_size) {
+    uint32_t header;
+    memcpy(&header, &data[pos], sizeof(header));
+    ASSERT_EQ(64U, header);
+    for (size_t i = 0; i < 64; ++i)
+      ASSERT_EQ(0x5a, data[pos + sizeof(header) + i]);
+  }
+}
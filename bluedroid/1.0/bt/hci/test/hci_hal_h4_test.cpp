@@ -22,6 +22,7 @@
 
 extern "C" {
 #include <stdint.h>
+#include <string.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <unistd.h>
@@ -40,7 +41,8 @@ DECLARE_TEST_MODES(
   transmit,
   read_synchronous,
   read_async_reentry,
-  type_byte_only
+  type_byte_only,
+  read_packets
 );
 
 // Use as packet type to test stream_corrupted_during_le_scan_workaround()
@@ -56,6 +58,11 @@ static char event_data[100] =   "The edges of a surface are lines.";
 // Test data for stream_corrupted_during_le_scan_workaround()
 static char corrupted_data[] = { 0x5 /* length of remaining data */, 'H', 'e', 'l', 'l', 'o' };
 
+// Well formed packets for the packet_ready mode, which parses the preambles.
+static const uint8_t acl_packet[] = { 0x01, 0x20, 0x04, 0x00, 'a', 'c', 'l', '!' };
+static const uint8_t sco_packet[] = { 0x02, 0x00, 0x03, 's', 'c', 'o' };
+static const uint8_t event_packet[] = { 0x0e, 0x02, 'e', 'v' };
+
 static const hci_hal_t *hal;
 static int dummy_serial_fd;
 static int reentry_i = 0;
@@ -132,19 +139,54 @@ STUB_FUNCTION(void, data_ready_callback, (serial_data_type_t type))
   UNEXPECTED_CALL;
 }
 
+static void expect_packet(const uint8_t *expected, size_t expected_length,
+                          const uint8_t *data, size_t length) {
+  ASSERT_EQ(expected_length, length);
+  EXPECT_EQ(0, memcmp(expected, data, length));
+}
+
+STUB_FUNCTION(void, packet_ready_callback, (serial_data_type_t type, const uint8_t *data, size_t length))
+  DURING(read_packets) {
+    AT_CALL(0) {
+      EXPECT_EQ(DATA_TYPE_ACL, type);
+      expect_packet(acl_packet, sizeof(acl_packet), data, length);
+      return;
+    }
+    AT_CALL(1) {
+      EXPECT_EQ(DATA_TYPE_SCO, type);
+      expect_packet(sco_packet, sizeof(sco_packet), data, length);
+      return;
+    }
+    AT_CALL(2) {
+      EXPECT_EQ(DATA_TYPE_EVENT, type);
+      expect_packet(event_packet, sizeof(event_packet), data, length);
+      semaphore_post(done);
+      return;
+    }
+  }
+
+  UNEXPECTED_CALL;
+}
+
 static void reset_for(TEST_MODES_T next) {
   RESET_CALL_COUNT(vendor_send_command);
   RESET_CALL_COUNT(data_ready_callback);
+  RESET_CALL_COUNT(packet_ready_callback);
   CURRENT_TEST_MODE = next;
 }
 
 class HciHalH4Test : public AllocationTestHarness {
   protected:
+    HciHalH4Test() : use_packet_ready(false) {}
+
     virtual void SetUp() {
       AllocationTestHarness::SetUp();
       hal = hci_hal_h4_get_test_interface(&vendor);
       vendor.send_command = vendor_send_command;
+      memset(&callbacks, 0, sizeof(callbacks));
       callbacks.data_ready = data_ready_callback;
+      if (use_packet_ready)
+        callbacks.packet_ready = packet_ready_callback;
 
       socketpair(AF_LOCAL, SOCK_STREAM, 0, sockfd);
       dummy_serial_fd = sockfd[0];
@@ -173,6 +215,14 @@ class HciHalH4Test : public AllocationTestHarness {
     vendor_t vendor;
     thread_t *thread;
     hci_hal_callbacks_t callbacks;
+    bool use_packet_ready;
+};
+
+class HciHalH4PacketTest : public HciHalH4Test {
+  protected:
+    HciHalH4PacketTest() {
+      use_packet_ready = true;
+    }
 };
 
 static void expect_socket_data(int fd, char first_byte, char *data) {
@@ -271,3 +321,18 @@ TEST_F(HciHalH4Test, test_type_byte_only_must_not_signal_data_ready) {
     select(sockfd[0] + 1, &read_fds, NULL, NULL, &timeout);
   } while(FD_ISSET(sockfd[0], &read_fds));
 }
+
+TEST_F(HciHalH4PacketTest, test_read_packets) {
+  reset_for(read_packets);
+
+  write_packet(sockfd[1], DATA_TYPE_ACL, acl_packet, sizeof(acl_packet));
+  write_packet(sockfd[1], HCI_BLE_EVENT, corrupted_data,
+               sizeof(corrupted_data));
+  write_packet(sockfd[1], DATA_TYPE_SCO, sco_packet, sizeof(sco_packet));
+  write_packet(sockfd[1], DATA_TYPE_EVENT, event_packet, sizeof(event_packet));
+
+  // Wait for all packets to be received before calling the test good
+  semaphore_wait(done);
+  EXPECT_CALL_COUNT(packet_ready_callback, 3);
+  EXPECT_CALL_COUNT(data_ready_callback, 0);
+}
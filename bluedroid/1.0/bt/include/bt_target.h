@@ -175,6 +175,18 @@
 #define BTIF_DM_OOB_TEST  TRUE
 #endif
 
+// How long, in seconds, a remote name or service list learnt by discovery
+// is trusted before the device is asked again. A stored name within this
+// age skips the remote name request of an inquiry, and stored services
+// within it answer get_remote_services without an SDP search.
+#ifndef BTIF_STORAGE_NAME_TTL_S
+#define BTIF_STORAGE_NAME_TTL_S (24 * 60 * 60)
+#endif
+
+#ifndef BTIF_STORAGE_SERVICE_TTL_S
+#define BTIF_STORAGE_SERVICE_TTL_S (60 * 60)
+#endif
+
 // How long to wait before activating sniff mode after entering the
 // idle state for FTS, OPS connections
 #ifndef BTA_FTS_OPS_IDLE_TO_SNIFF_DELAY_MS
@@ -613,6 +625,18 @@
 #define L2CAP_HIGH_PRI_MIN_XMIT_QUOTA       5
 #endif
 
+/* Latency target of a high priority link: when data on it has waited this
+** long, it is served before the other links. 0 disables the target. */
+#ifndef L2CAP_HIGH_PRI_LATENCY_TARGET_MS
+#define L2CAP_HIGH_PRI_LATENCY_TARGET_MS    20
+#endif
+
+/* Relative share of the controller window given to a high priority link by
+** the link scheduler, a normal priority link having a weight of 1. */
+#ifndef L2CAP_HIGH_PRI_LINK_WEIGHT
+#define L2CAP_HIGH_PRI_LINK_WEIGHT          4
+#endif
+
 /* used for monitoring HCI ACL credit management */
 #ifndef L2CAP_HCI_FLOW_CONTROL_DEBUG
 #define L2CAP_HCI_FLOW_CONTROL_DEBUG        TRUE
@@ -818,6 +842,17 @@
 #define SMP_DEBUG            FALSE
 #endif
 
+/* Encrypt the AES-128 blocks of SMP and AES-CMAC with the kernel crypto API
+ * (AF_ALG) when the CPU has no AES instructions, e.g. to use an AES engine */
+#ifndef SMP_CRYPTO_AF_ALG
+#define SMP_CRYPTO_AF_ALG    FALSE
+#endif
+
+/* Check AES-128, AES-CMAC and P-256 against known vectors in SMP_Init() */
+#ifndef SMP_CRYPTO_SELF_TEST
+#define SMP_CRYPTO_SELF_TEST FALSE
+#endif
+
 #ifndef SMP_DEFAULT_AUTH_REQ
 #define SMP_DEFAULT_AUTH_REQ    SMP_AUTH_NB_ENC_ONLY
 #endif
@@ -24,7 +24,8 @@ LOCAL_SRC_FILES+= \
 	../embdrv/sbc/encoder/srce/sbc_packing.c \
 
 LOCAL_SRC_FILES+= \
-	../udrv/ulinux/uipc.c
+	../udrv/ulinux/uipc.c \
+	../audio_a2dp_hw/audio_a2dp_shm.c
 
 LOCAL_C_INCLUDES+= . \
 	$(LOCAL_PATH)/../ \
@@ -92,6 +92,14 @@ static const hci_t *hci;
 *******************************************************************************/
 fixed_queue_t *btu_hci_msg_queue;
 
+// Runs the HCI module start up, which powers on the controller and downloads
+// its firmware, while the stack control blocks are initialized on the
+// bt_workqueue thread. |hci_start_up_future| is ready once it has finished.
+static thread_t *hci_start_up_thread;
+static future_t *hci_start_up_future;
+
+static void event_hci_start_up(void *context);
+
 /******************************************************************************
 **
 ** Function         bte_main_boot_entry
@@ -158,11 +166,44 @@ void bte_main_enable()
     APPL_TRACE_DEBUG("%s", __FUNCTION__);
 
     module_start_up(get_module(BTSNOOP_MODULE));
-    module_start_up(get_module(HCI_MODULE));
+
+    hci_start_up_future = future_new();
+    hci_start_up_thread = thread_new("hci_start_up");
+    if (hci_start_up_thread)
+        thread_post(hci_start_up_thread, event_hci_start_up, NULL);
+    else
+        event_hci_start_up(NULL);
 
     BTU_StartUp();
 }
 
+static void event_hci_start_up(UNUSED_ATTR void *context)
+{
+    bool success = module_start_up(get_module(HCI_MODULE));
+    future_ready(hci_start_up_future, success ? FUTURE_SUCCESS : FUTURE_FAIL);
+}
+
+/******************************************************************************
+**
+** Function         bte_main_wait_hci_start_up
+**
+** Description      BTE MAIN API - Waits for the HCI module start up begun by
+**                  bte_main_enable to finish. Must be called once, before
+**                  anything is sent to the controller.
+**
+** Returns          TRUE if the controller is ready
+**
+******************************************************************************/
+BOOLEAN bte_main_wait_hci_start_up(void)
+{
+    future_t *future = hci_start_up_future;
+    if (!future)
+        return FALSE;
+
+    hci_start_up_future = NULL;
+    return future_await(future) == FUTURE_SUCCESS;
+}
+
 /******************************************************************************
 **
 ** Function         bte_main_disable
@@ -177,6 +218,11 @@ void bte_main_disable(void)
 {
     APPL_TRACE_DEBUG("%s", __FUNCTION__);
 
+    // The stack may be brought down before it waited for the controller.
+    bte_main_wait_hci_start_up();
+    thread_free(hci_start_up_thread);
+    hci_start_up_thread = NULL;
+
     module_shut_down(get_module(HCI_MODULE));
     module_shut_down(get_module(BTSNOOP_MODULE));
 
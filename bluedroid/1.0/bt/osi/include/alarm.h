@@ -71,6 +71,8 @@ void alarm_free(alarm_t *alarm);
 // thread is not same as the caller’s thread. If two (or more)
 // alarms are set back-to-back with the same |interval_ms|, the
 // callbacks will be called in the order the alarms are set.
+// A non-periodic alarm may fire up to a few milliseconds late, so that
+// it expires together with other alarms due at about the same time.
 void alarm_set(alarm_t *alarm, period_ms_t interval_ms,
                alarm_callback_t cb, void *data);
 
@@ -34,6 +34,11 @@ typedef struct {
 extern const allocator_t allocator_malloc;
 extern const allocator_t allocator_calloc;
 
+// allocator_t with the size class allocator of slab_allocator.h, for
+// buffers that are allocated and freed at a high rate. Buffers from it
+// must be freed with its |free|, not with |osi_free|.
+extern const allocator_t allocator_slab;
+
 char *osi_strdup(const char *str);
 char *osi_strndup(const char *str, size_t len);
 
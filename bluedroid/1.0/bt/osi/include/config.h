@@ -17,6 +17,7 @@
 // - All strings are case sensitive.
 
 #include <stdbool.h>
+#include <stdint.h>
 #ifdef MTK_BLUEDROID_PATCH
 #include "mdroid_buildcfg.h"
 #endif
@@ -28,6 +29,11 @@
 typedef struct config_t config_t;
 typedef struct config_section_node_t config_section_node_t;
 
+// Iterator callback prototype used for |config_foreach|. |section|, |key| and
+// |value| are owned by the config module and are only valid during the call.
+// Callback must return true to continue iterating or false to stop iterating.
+typedef bool (*config_foreach_cb)(const char *section, const char *key, const char *value, void *context);
+
 // Creates a new config object with no entries (i.e. not backed by a file).
 // This function returns a config object or NULL on error. Clients must call
 // |config_free| on the returned handle when it is no longer required.
@@ -105,6 +111,18 @@ bool config_remove_section(config_t *config, const char *section);
 // None of |config|, |section|, or |key| may be NULL.
 bool config_remove_key(config_t *config, const char *section, const char *key);
 
+// Returns a counter that changes whenever the contents of |config| change.
+// Setting a key to the value it already has is not a change. Callers can
+// compare two values to tell whether |config| needs to be saved again.
+// |config| may not be NULL.
+uint64_t config_generation(const config_t *config);
+
+// Returns true if the file given by |filename| holds exactly what |config_save|
+// would write for |config|, in which case saving it again can be skipped.
+// Returns false if the file differs or cannot be read. Neither |config| nor
+// |filename| may be NULL.
+bool config_is_saved(const config_t *config, const char *filename);
+
 // Returns an iterator to the first section in the config file. If there are no
 // sections, the iterator will equal the return value of |config_section_end|.
 // The returned pointer must be treated as an opaque handle and must not be freed.
@@ -130,6 +148,13 @@ const config_section_node_t *config_section_next(const config_section_node_t *it
 // equal the value returned by |config_section_end|.
 const char *config_section_name(const config_section_node_t *iter);
 
+// Calls |callback| once for each key/value pair in |config|, section by section
+// and in the order of the file, passing |context| along. This walks the whole
+// config in a single pass, without looking up each section and key by name.
+// |callback| must not mutate |config|. Returns false if |callback| stopped the
+// iteration, true otherwise. Neither |config| nor |callback| may be NULL.
+bool config_foreach(const config_t *config, config_foreach_cb callback, void *context);
+
 // Saves |config| to a file given by |filename|. Note that this could be a destructive
 // operation: if |filename| already exists, it will be overwritten. The config
 // module does not preserve comments or formatting so if a config file was opened
@@ -30,6 +30,13 @@ typedef struct reactor_t reactor_t;
 
 typedef void (*eager_reader_cb)(eager_reader_t *reader, void *context);
 
+// Returns the total length of the frame that starts at |data|, of which
+// |length| bytes have been read so far, or 0 if more bytes are needed to
+// tell. |length| may be 0. The returned length may exceed |length|, and must
+// be greater than zero otherwise. Called from both the read thread and the
+// thread that consumes the frames, so it must not keep state.
+typedef size_t (*eager_reader_frame_cb)(const uint8_t *data, size_t length);
+
 // Creates a new eager reader object, which pulls data from |fd_to_read| into
 // buffers of size |buffer_size| allocated using |allocator|, and has an
 // internal read thread named |thread_name|. The returned object must be freed using
@@ -43,6 +50,22 @@ eager_reader_t *eager_reader_new(
   const char *thread_name
 );
 
+// Creates a new eager reader object which reads from |fd_to_read| into a ring
+// of |ring_size| bytes, up to |read_size| bytes at a time, and splits the data
+// into frames in place using |frame_length|. Complete frames are handed out
+// with |eager_reader_peek_frame| without being copied. When the ring is full,
+// the internal read thread named |thread_name| stops reading until frames are
+// released. |ring_size| must be large enough to hold the largest frame, and
+// preferably a few of them. The returned object must be freed using
+// |eager_reader_free|, and can't be used with |eager_reader_read|.
+eager_reader_t *eager_reader_new_framed(
+  int fd_to_read,
+  size_t ring_size,
+  size_t read_size,
+  eager_reader_frame_cb frame_length,
+  const char *thread_name
+);
+
 // Frees an eager reader object, and associated internal resources.
 // |reader| may be NULL.
 void eager_reader_free(eager_reader_t *reader);
@@ -62,6 +85,16 @@ void eager_reader_unregister(eager_reader_t *reader);
 // otherwise the byte stream probably doesn't make sense.
 size_t eager_reader_read(eager_reader_t *reader, uint8_t *buffer, size_t max_size);
 
+// Returns the oldest complete frame of a reader created with
+// |eager_reader_new_framed| in |data| and |length|, or false if there is none.
+// The frame stays valid, and is returned again, until it is released with
+// |eager_reader_release_frame|. Same thread safety note as |eager_reader_read|.
+bool eager_reader_peek_frame(eager_reader_t *reader, const uint8_t **data, size_t *length);
+
+// Releases the frame returned by the last call to |eager_reader_peek_frame|,
+// making its space in the ring available for reading again.
+void eager_reader_release_frame(eager_reader_t *reader);
+
 // Returns the inbound read thread for a given |reader| or NULL if the thread
 // is not running.
 thread_t* eager_reader_get_read_thread(const eager_reader_t *reader);
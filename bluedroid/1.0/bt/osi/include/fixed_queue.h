@@ -22,6 +22,7 @@
 #include <stdlib.h>
 
 #include "osi/include/list.h"
+#include "osi/include/reactor.h"
 
 #ifdef MTK_BLUEDROID_PATCH
 #include "mdroid_buildcfg.h"
@@ -30,7 +31,6 @@
 
 struct fixed_queue_t;
 typedef struct fixed_queue_t fixed_queue_t;
-typedef struct reactor_t reactor_t;
 
 typedef void (*fixed_queue_free_cb)(void *data);
 typedef void (*fixed_queue_cb)(fixed_queue_t *queue, void *context);
@@ -41,6 +41,22 @@ typedef void (*fixed_queue_cb)(fixed_queue_t *queue, void *context);
 // the returned queue with |fixed_queue_free|.
 fixed_queue_t *fixed_queue_new(size_t capacity);
 
+// Creates a new fixed queue with the given |capacity| whose elements are kept
+// in a preallocated ring instead of a list. Enqueueing and dequeueing do not
+// allocate memory, take a lock or make a system call, except to block the
+// caller and to signal the dequeue fd when the queue goes from empty to
+// non-empty. Any number of threads may enqueue, but only one thread at a time
+// may dequeue from or peek at the queue; a queue registered with
+// |fixed_queue_register_dequeue| must only be dequeued from its reactor
+// thread. The dequeue fd may occasionally be readable while the queue is
+// empty, so dequeue callbacks should use |fixed_queue_try_dequeue|.
+// |fixed_queue_enqueue_front|, |fixed_queue_try_peek_last|,
+// |fixed_queue_try_remove_from_queue|, |fixed_queue_get_list| and
+// |fixed_queue_get_enqueue_fd| are not supported on such a queue. Returns NULL
+// on failure, including when |capacity| elements can not be allocated. The
+// caller must free the returned queue with |fixed_queue_free|.
+fixed_queue_t *fixed_queue_new_ring(size_t capacity);
+
 // Freeing a queue that is currently in use (i.e. has waiters
 // blocked on it) results in undefined behaviour.
 void fixed_queue_free(fixed_queue_t *queue, fixed_queue_free_cb free_cb);
@@ -131,3 +147,8 @@ void fixed_queue_register_dequeue(fixed_queue_t *queue, reactor_t *reactor, fixe
 // Unregisters the dequeue ready callback for |queue| from whichever reactor
 // it is registered with, if any. This function is idempotent.
 void fixed_queue_unregister_dequeue(fixed_queue_t *queue);
+
+// Sets the reactor priority class of the dequeue registration of |queue|; see
+// |reactor_object_set_priority|. |queue| may not be NULL and must be registered
+// with |fixed_queue_register_dequeue|.
+void fixed_queue_set_dequeue_priority(fixed_queue_t *queue, reactor_priority_t priority);
@@ -44,8 +44,8 @@ typedef void (*data_free_fn)(void *data);
 
 // Returns a new, empty hash_map. Returns NULL if not enough memory could be allocated
 // for the hash_map structure. The returned hash_map must be freed with |hash_map_free|.
-// The |num_bucket| specifies the number of hashable buckets for the map and must not
-// be zero.  The |hash_fn| specifies a hash function to be used and must not be NULL.
+// The |num_bucket| specifies the number of elements expected in the map and must not
+// be zero; the map grows as needed when more are added.  The |hash_fn| specifies a hash function to be used and must not be NULL.
 // The |key_fn| and |data_fn| are called whenever a hash_map element is removed from
 // the hash_map. They can be used to release resources held by the hash_map element,
 // e.g.  memory or file descriptor.  |key_fn| and |data_fn| may be NULL if no cleanup
@@ -71,8 +71,8 @@ bool hash_map_is_empty(const hash_map_t *hash_map);
 // NULL |hash_map|.
 size_t hash_map_size(const hash_map_t *hash_map);
 
-// Returns the number of buckets in the hash map.  This function does not accept a
-// NULL |hash_map|.
+// Returns the number of slots currently allocated in the hash map, which is at
+// least |hash_map_size|.  This function does not accept a NULL |hash_map|.
 size_t hash_map_num_buckets(const hash_map_t *hash_map);
 
 // Returns true if the hash_map has a valid entry for the presented key.
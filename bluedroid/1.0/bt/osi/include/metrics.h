@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -91,6 +92,44 @@ void metrics_log_a2dp_session(A2dpSessionMetrics_t* metrics);
 
 void metrics_write_base64(int fd, bool clear);
 
+// Latency histograms for the hot paths of the stack. Each histogram has a
+// fixed set of buckets whose bounds are powers of two microseconds, which
+// are updated with relaxed atomic increments only, so recording a sample
+// takes no lock and allocates nothing and may be done from any thread.
+typedef enum {
+  METRICS_HISTOGRAM_HCI_COMMAND_ROUND_TRIP,  // Command sent to its response.
+  METRICS_HISTOGRAM_ACL_TX_QUEUE_DELAY,      // Wait of an L2CAP TX queue head.
+  METRICS_HISTOGRAM_A2DP_ENCODE,             // Encoding of one A2DP frame.
+  METRICS_HISTOGRAM_ALARM_LATENESS,          // Alarm callback past deadline.
+  METRICS_HISTOGRAM_COUNT,
+} metrics_histogram_t;
+
+// Bucket 0 holds samples under 1us, bucket |i| samples in [2^(i-1), 2^i) us
+// and the last bucket everything from 2^(METRICS_HISTOGRAM_NUM_BUCKETS - 2)
+// us (about 1s) upwards.
+#define METRICS_HISTOGRAM_NUM_BUCKETS 22
+
+typedef struct {
+  uint64_t count;
+  uint64_t total_us;
+  uint64_t max_us;
+  uint64_t buckets[METRICS_HISTOGRAM_NUM_BUCKETS];
+} metrics_histogram_snapshot_t;
+
+// Records a sample of |value_us| microseconds in |histogram|.
+void metrics_histogram_record(metrics_histogram_t histogram, uint64_t value_us);
+
+// Copies the current state of |histogram| to |snapshot|. Samples recorded
+// concurrently may or may not be included, and may be partially included.
+void metrics_histogram_get(metrics_histogram_t histogram,
+                           metrics_histogram_snapshot_t* snapshot);
+
+// Clears all the histograms.
+void metrics_histogram_reset(void);
+
+// Dumps all the histograms in human readable form to |fd|.
+void metrics_histogram_debug_dump(int fd);
+
 #ifdef __cplusplus
 }
 #endif
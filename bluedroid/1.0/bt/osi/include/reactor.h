@@ -19,6 +19,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "osi/include/osi.h"
@@ -29,6 +30,9 @@
 typedef struct reactor_t reactor_t;
 typedef struct reactor_object_t reactor_object_t;
 
+// The largest number of ready objects serviced in one reactor wakeup.
+#define REACTOR_MAX_EVENTS 64
+
 // Enumerates the reasons a reactor has stopped.
 typedef enum {
   REACTOR_STATUS_STOP,     // |reactor_stop| was called.
@@ -36,6 +40,30 @@ typedef enum {
   REACTOR_STATUS_DONE,     // the reactor completed its work (for the _run_once* variants).
 } reactor_status_t;
 
+// Priority classes of registered objects. Of the objects that are ready at the
+// same time, the reactor services all the high priority ones first, then the
+// normal ones, then the low ones. Objects in the same class are serviced in
+// the order the kernel reported them.
+typedef enum {
+  REACTOR_PRIORITY_HIGH,    // audio and data paths.
+  REACTOR_PRIORITY_NORMAL,  // the default.
+  REACTOR_PRIORITY_LOW,     // bulk or best-effort work.
+} reactor_priority_t;
+
+#define REACTOR_PRIORITY_COUNT 3
+
+// Latency statistics of a registered object, in microseconds. |wait| is the
+// time from the reactor waking up to the object's callbacks starting, i.e.
+// how long the object waited behind the other ready objects. |run| is the
+// time spent in the object's callbacks.
+typedef struct {
+  uint64_t dispatch_count;
+  uint64_t total_wait_us;
+  uint64_t max_wait_us;
+  uint64_t total_run_us;
+  uint64_t max_run_us;
+} reactor_object_stats_t;
+
 // Creates a new reactor object. Returns NULL on failure. The returned object
 // must be freed by calling |reactor_free|.
 reactor_t *reactor_new(void);
@@ -55,6 +83,14 @@ reactor_status_t reactor_run_once(reactor_t *reactor);
 // |reactor| may not be NULL.
 void reactor_stop(reactor_t *reactor);
 
+// Sets the maximum number of ready objects the reactor services each time it wakes
+// up. Objects that are left over stay ready and are serviced on the next wakeup. A
+// smaller value bounds how long one wakeup can take, at the cost of more wakeups.
+// |max_events| must be between 1 and |REACTOR_MAX_EVENTS|; the default is
+// |REACTOR_MAX_EVENTS|. This function must be called while the reactor is not running.
+// |reactor| may not be NULL.
+void reactor_set_max_events(reactor_t *reactor, size_t max_events);
+
 // Registers a file descriptor with the reactor. The file descriptor, |fd|, must be valid
 // when this function is called and its ownership is not transferred to the reactor. The
 // |context| variable is a user-defined opaque handle that is passed back to the |read_ready|
@@ -77,6 +113,15 @@ bool reactor_change_registration(reactor_object_t *object,
     void (*read_ready)(void *context),
     void (*write_ready)(void *context));
 
+// Sets the priority class of |object|; objects are registered with
+// |REACTOR_PRIORITY_NORMAL|. The change applies from the next reactor wakeup.
+// |object| may not be NULL.
+void reactor_object_set_priority(reactor_object_t *object, reactor_priority_t priority);
+
+// Copies the latency statistics of |object| into |stats|. Must not be called from
+// the callbacks of |object|. Neither |object| nor |stats| may be NULL.
+void reactor_object_get_stats(reactor_object_t *object, reactor_object_stats_t *stats);
+
 // Unregisters a previously registered file descriptor with its reactor. |obj| may not be NULL.
 // |obj| is invalid after calling this function so the caller must drop all references to it.
 void reactor_unregister(reactor_object_t *obj);
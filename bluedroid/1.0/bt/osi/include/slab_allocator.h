@@ -0,0 +1,47 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+
+// A size class allocator for the small, short lived buffers of the stack
+// (BT_HDR buffers of HCI packets, L2CAP fragments and A2DP frames).
+// Blocks are carved from larger slabs, one free list per size class, and
+// each thread keeps a few free blocks of every class so that most
+// allocations and frees do not take a lock. Blocks that are too large for
+// the largest size class come from malloc. Slabs are never returned to the
+// system.
+//
+// These functions do no allocation tracking; use |allocator_slab| (see
+// allocator.h), or build with OSI_SLAB_ALLOCATOR set to TRUE to have
+// |osi_malloc| and |osi_free| use this allocator.
+
+// Allocates a block of at least |size| bytes. Never returns NULL.
+void *slab_malloc(size_t size);
+
+// Allocates a zeroed block of at least |size| bytes. Never returns NULL.
+void *slab_calloc(size_t size);
+
+// Frees a block returned by |slab_malloc| or |slab_calloc|, from any
+// thread. |ptr| may be NULL.
+void slab_free(void *ptr);
+
+// Dump the allocation statistics to the |fd| file descriptor.
+// The caller is responsible for closing the |fd|.
+void slab_allocator_debug_dump(int fd);
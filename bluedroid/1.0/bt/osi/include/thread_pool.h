@@ -0,0 +1,71 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2014 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "osi/include/thread.h"
+
+// A pool of worker threads for work that may run on any core and in any
+// order, such as parsing, crypto or file writes. Each worker has its own
+// queue per priority; a worker with nothing to do takes work from the
+// others. Work which must stay ordered with respect to a module's other
+// events belongs on that module's |thread_t| instead.
+typedef struct thread_pool_t thread_pool_t;
+
+typedef enum {
+  THREAD_POOL_PRIORITY_HIGH,
+  THREAD_POOL_PRIORITY_NORMAL,
+  THREAD_POOL_PRIORITY_LOW,
+  THREAD_POOL_PRIORITY_COUNT
+} thread_pool_priority_t;
+
+typedef struct {
+  size_t queue_depth;         // Tasks waiting to run now
+  size_t max_queue_depth;     // Most tasks ever waiting at once
+  size_t tasks_run;           // Tasks run so far
+  size_t tasks_stolen;        // Of those, tasks run by another worker
+  uint64_t total_wait_us;     // Sum of the times tasks waited to start
+  uint64_t max_wait_us;       // Longest time a task waited to start
+} thread_pool_stats_t;
+
+// Creates a pool of |num_workers| threads, named |name| followed by their
+// index. Returns NULL if a thread could not be started. The returned pool
+// must be freed with |thread_pool_free|. |name| may not be NULL and
+// |num_workers| may not be 0.
+thread_pool_t *thread_pool_new(const char *name, size_t num_workers);
+
+// Runs the tasks still queued on |pool|, stops its threads and frees it.
+// The calling thread blocks until they have exited, so it must not be one
+// of them. Tasks posted after this is called are refused. |pool| may be
+// NULL.
+void thread_pool_free(thread_pool_t *pool);
+
+// Calls |func| with the argument |context| on one of the workers of |pool|,
+// before any task of a lower |priority| that has not started. Tasks of the
+// same priority may run in any order, and concurrently. Neither |pool| nor
+// |func| may be NULL. |context| may be NULL. Returns false if |pool| is
+// being freed, otherwise true.
+bool thread_pool_post(thread_pool_t *pool, thread_pool_priority_t priority,
+                      thread_fn func, void *context);
+
+// Copies the statistics of |pool| into |stats|. Neither may be NULL.
+void thread_pool_get_stats(thread_pool_t *pool, thread_pool_stats_t *stats);
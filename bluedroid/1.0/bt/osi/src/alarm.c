@@ -36,8 +36,8 @@
 
 #include "osi/include/allocator.h"
 #include "osi/include/fixed_queue.h"
-#include "osi/include/list.h"
 #include "osi/include/log.h"
+#include "osi/include/metrics.h"
 #include "osi/include/osi.h"
 #include "osi/include/semaphore.h"
 #include "osi/include/thread.h"
@@ -85,9 +85,26 @@ struct alarm_t {
   fixed_queue_t *queue;         // The processing queue to add this alarm to
   alarm_callback_t callback;
   void *data;
+  size_t heap_index;            // Position in |alarms|, or NOT_PENDING
+  uint64_t sequence;            // Orders alarms with the same deadline
   alarm_stats_t stats;
 };
 
+#define NOT_PENDING SIZE_MAX
+
+// The pending alarms, as a binary min-heap ordered by deadline, so that
+// setting and canceling an alarm is O(log n) in the number of pending
+// alarms and the next one to expire is always at |entries[0]|.
+typedef struct {
+  alarm_t **entries;
+  size_t size;
+  size_t capacity;
+  size_t max_size;              // High-water mark, for alarm_debug_dump
+  uint64_t next_sequence;
+} alarm_heap_t;
+
+static const size_t ALARM_HEAP_INITIAL_CAPACITY = 32;
+
 
 // If the next wakeup time is less than this threshold, we should acquire
 // a wakelock instead of setting a wake alarm so we're not bouncing in
@@ -96,6 +113,13 @@ struct alarm_t {
 int64_t TIMER_INTERVAL_FOR_WAKELOCK_IN_MS = 3000;
 static const clockid_t CLOCK_ID = CLOCK_BOOTTIME;
 
+// One-shot alarms that are due within this window after the next alarm are
+// coalesced with it: the timer is armed for the latest of them, so that they
+// all expire with a single timer wakeup and are dispatched together. Periodic
+// alarms are never delayed. This value is externally visible to allow unit
+// tests to change it. It should not be modified by production code.
+int64_t ALARM_COALESCING_WINDOW_MS = 5;
+
 #if defined(KERNEL_MISSING_CLOCK_BOOTTIME_ALARM) && (KERNEL_MISSING_CLOCK_BOOTTIME_ALARM == TRUE)
 static const clockid_t CLOCK_ID_ALARM = CLOCK_BOOTTIME;
 #else
@@ -104,12 +128,18 @@ static const clockid_t CLOCK_ID_ALARM = CLOCK_BOOTTIME_ALARM;
 
 // This mutex ensures that the |alarm_set|, |alarm_cancel|, and alarm callback
 // functions execute serially and not concurrently. As a result, this mutex
-// also protects the |alarms| list.
+// also protects the |alarms| heap.
 static pthread_mutex_t monitor;
-static list_t *alarms;
+static alarm_heap_t *alarms;
 static timer_t timer;
 static timer_t wakeup_timer;
 static bool timer_set;
+// The deadlines |timer| and |wakeup_timer| are armed for, or 0 if disarmed.
+static period_ms_t timer_deadline;
+static period_ms_t wakeup_timer_deadline;
+static size_t timer_rearm_count;
+static size_t timer_rearm_skipped_count;
+static size_t coalesced_count;
 
 // All alarm callbacks are dispatched from |dispatcher_thread|
 static thread_t *dispatcher_thread;
@@ -139,6 +169,13 @@ static void update_scheduling_stats(alarm_stats_t *stats,
                                     period_ms_t deadline_ms,
                                     period_ms_t execution_delta_ms);
 
+static alarm_heap_t *alarm_heap_new(void);
+static void alarm_heap_free(alarm_heap_t *heap);
+static void alarm_heap_push(alarm_heap_t *heap, alarm_t *alarm);
+static void alarm_heap_remove(alarm_heap_t *heap, alarm_t *alarm);
+static alarm_t *alarm_heap_front(const alarm_heap_t *heap);
+static period_ms_t coalesced_deadline(const alarm_heap_t *heap);
+
 static void update_stat(stat_t *stat, period_ms_t delta)
 {
   if (stat->max_ms < delta)
@@ -184,6 +221,7 @@ static alarm_t *alarm_new_internal(const char *name, bool is_periodic) {
   }
 
   ret->is_periodic = is_periodic;
+  ret->heap_index = NOT_PENDING;
 
   alarm_stats_t *stats = &ret->stats;
   stats->name = osi_strdup(name);
@@ -283,7 +321,7 @@ void alarm_cancel(alarm_t *alarm) {
 // Internal implementation of canceling an alarm.
 // The caller must hold the |monitor| lock.
 static void alarm_cancel_internal(alarm_t *alarm) {
-  bool needs_reschedule = (!list_is_empty(alarms) && list_front(alarms) == alarm);
+  bool needs_reschedule = (alarm_heap_front(alarms) == alarm);
 
   remove_pending_alarm(alarm);
 
@@ -326,8 +364,10 @@ void alarm_cleanup(void) {
   semaphore_free(alarm_expired);
   alarm_expired = NULL;
 
-  list_free(alarms);
+  alarm_heap_free(alarms);
   alarms = NULL;
+  timer_deadline = 0;
+  wakeup_timer_deadline = 0;
 
   pthread_mutex_unlock(&monitor);
   pthread_mutex_destroy(&monitor);
@@ -343,11 +383,7 @@ static bool lazy_initialize(void) {
 
   pthread_mutex_init(&monitor, NULL);
 
-  alarms = list_new(NULL);
-  if (!alarms) {
-    LOG_ERROR(LOG_TAG, "%s unable to allocate alarm list.", __func__);
-    goto error;
-  }
+  alarms = alarm_heap_new();
 
   if (!timer_create_internal(CLOCK_ID, &timer))
     goto error;
@@ -411,7 +447,7 @@ error:
   if (timer_initialized)
     timer_delete(timer);
 
-  list_free(alarms);
+  alarm_heap_free(alarms);
   alarms = NULL;
 
   pthread_mutex_destroy(&monitor);
@@ -432,10 +468,10 @@ static period_ms_t now(void) {
   return (ts.tv_sec * 1000LL) + (ts.tv_nsec / 1000000LL);
 }
 
-// Remove alarm from internal alarm list and the processing queue
+// Remove alarm from internal alarm heap and the processing queue
 // The caller must hold the |monitor| lock.
 static void remove_pending_alarm(alarm_t *alarm) {
-  list_remove(alarms, alarm);
+  alarm_heap_remove(alarms, alarm);
   while (fixed_queue_try_remove_from_queue(alarm->queue, alarm) != NULL) {
     // Remove all repeated alarm instances from the queue.
     // NOTE: We are defensive here - we shouldn't have repeated alarm instances
@@ -444,9 +480,9 @@ static void remove_pending_alarm(alarm_t *alarm) {
 
 // Must be called with monitor held
 static void schedule_next_instance(alarm_t *alarm) {
-  // If the alarm is currently set and it's at the start of the list,
+  // If the alarm is currently set and it's at the top of the heap,
   // we'll need to re-schedule since we've adjusted the earliest deadline.
-  bool needs_reschedule = (!list_is_empty(alarms) && list_front(alarms) == alarm);
+  bool needs_reschedule = (alarm_heap_front(alarms) == alarm);
   if (alarm->callback)
     remove_pending_alarm(alarm);
 
@@ -457,23 +493,14 @@ static void schedule_next_instance(alarm_t *alarm) {
     ms_into_period = ((just_now - alarm->creation_time) % alarm->period);
   alarm->deadline = just_now + (alarm->period - ms_into_period);
 
-  // Add it into the timer list sorted by deadline (earliest deadline first).
-  if (list_is_empty(alarms) ||
-      ((alarm_t *)list_front(alarms))->deadline > alarm->deadline) {
-    list_prepend(alarms, alarm);
-  } else {
-    for (list_node_t *node = list_begin(alarms); node != list_end(alarms); node = list_next(node)) {
-      list_node_t *next = list_next(node);
-      if (next == list_end(alarms) || ((alarm_t *)list_node(next))->deadline > alarm->deadline) {
-        list_insert_after(alarms, node, alarm);
-        break;
-      }
-    }
-  }
+  // Add it into the timer heap (earliest deadline first).
+  alarm_heap_push(alarms, alarm);
 
-  // If the new alarm has the earliest deadline, we need to re-evaluate our schedule.
+  // If the new alarm has the earliest deadline, or may be coalesced with
+  // it, we need to re-evaluate our schedule.
+  const alarm_t *root = alarm_heap_front(alarms);
   if (needs_reschedule ||
-      (!list_is_empty(alarms) && list_front(alarms) == alarm)) {
+      alarm->deadline <= root->deadline + ALARM_COALESCING_WINDOW_MS) {
     reschedule_root_alarm();
   }
 }
@@ -488,11 +515,11 @@ static void reschedule_root_alarm(void) {
   struct itimerspec timer_time;
   memset(&timer_time, 0, sizeof(timer_time));
 
-  if (list_is_empty(alarms))
+  if (alarm_heap_front(alarms) == NULL)
     goto done;
 
-  const alarm_t *next = list_front(alarms);
-  const int64_t next_expiration = next->deadline - now();
+  const period_ms_t deadline = coalesced_deadline(alarms);
+  const int64_t next_expiration = deadline - now();
   if (next_expiration < TIMER_INTERVAL_FOR_WAKELOCK_IN_MS) {
     if (!timer_set) {
       if (!wakelock_acquire()) {
@@ -501,8 +528,8 @@ static void reschedule_root_alarm(void) {
       }
     }
 
-    timer_time.it_value.tv_sec = (next->deadline / 1000);
-    timer_time.it_value.tv_nsec = (next->deadline % 1000) * 1000000LL;
+    timer_time.it_value.tv_sec = (deadline / 1000);
+    timer_time.it_value.tv_nsec = (deadline % 1000) * 1000000LL;
 
     // It is entirely unsafe to call timer_settime(2) with a zeroed timerspec
     // for timers with *_ALARM clock IDs. Although the man page states that the
@@ -516,10 +543,13 @@ static void reschedule_root_alarm(void) {
     // If we've reached this code path, we're going to grab a wake lock and
     // wait for the next timer to fire. In that case, there's no reason to
     // have a pending wakeup timer so we simply cancel it.
-    struct itimerspec end_of_time;
-    memset(&end_of_time, 0, sizeof(end_of_time));
-    end_of_time.it_value.tv_sec = (time_t)(1LL << (sizeof(time_t) * 8 - 2));
-    timer_settime(wakeup_timer, TIMER_ABSTIME, &end_of_time, NULL);
+    if (wakeup_timer_deadline != 0) {
+      struct itimerspec end_of_time;
+      memset(&end_of_time, 0, sizeof(end_of_time));
+      end_of_time.it_value.tv_sec = (time_t)(1LL << (sizeof(time_t) * 8 - 2));
+      timer_settime(wakeup_timer, TIMER_ABSTIME, &end_of_time, NULL);
+      wakeup_timer_deadline = 0;
+    }
   } else {
     // WARNING: do not attempt to use relative timers with *_ALARM clock IDs
     // in kernels before 3.17 unless you have the following patch:
@@ -528,11 +558,14 @@ static void reschedule_root_alarm(void) {
     memset(&wakeup_time, 0, sizeof(wakeup_time));
 
 
-    wakeup_time.it_value.tv_sec = (next->deadline / 1000);
-    wakeup_time.it_value.tv_nsec = (next->deadline % 1000) * 1000000LL;
-    if (timer_settime(wakeup_timer, TIMER_ABSTIME, &wakeup_time, NULL) == -1)
-      LOG_ERROR(LOG_TAG, "%s unable to set wakeup timer: %s",
-                __func__, strerror(errno));
+    wakeup_time.it_value.tv_sec = (deadline / 1000);
+    wakeup_time.it_value.tv_nsec = (deadline % 1000) * 1000000LL;
+    if (wakeup_timer_deadline != deadline || deadline <= now()) {
+      if (timer_settime(wakeup_timer, TIMER_ABSTIME, &wakeup_time, NULL) == -1)
+        LOG_ERROR(LOG_TAG, "%s unable to set wakeup timer: %s",
+                  __func__, strerror(errno));
+      wakeup_timer_deadline = deadline;
+    }
   }
 
 done:
@@ -541,6 +574,18 @@ done:
     wakelock_release();
   }
 
+  // Re-arming a timer for the deadline it is already armed for would not
+  // change anything: once that deadline has passed, the timer has fired and
+  // the expired alarms are dispatched before rescheduling.
+  const period_ms_t new_timer_deadline = timer_set ?
+      (period_ms_t)timer_time.it_value.tv_sec * 1000 + timer_time.it_value.tv_nsec / 1000000LL : 0;
+  if (new_timer_deadline == timer_deadline && new_timer_deadline > now()) {
+    timer_rearm_skipped_count++;
+    return;
+  }
+  timer_deadline = new_timer_deadline;
+  timer_rearm_count++;
+
   if (timer_settime(timer, TIMER_ABSTIME, &timer_time, NULL) == -1)
     LOG_ERROR(LOG_TAG, "%s unable to set timer: %s", __func__, strerror(errno));
 
@@ -579,17 +624,23 @@ void alarm_unregister_processing_queue(fixed_queue_t *queue) {
 
   fixed_queue_unregister_dequeue(queue);
 
-  // Cancel all alarms that are using this queue
+  // Cancel all alarms that are using this queue. Canceling reorders the
+  // heap, so collect them first.
   pthread_mutex_lock(&monitor);
-  for (list_node_t *node = list_begin(alarms); node != list_end(alarms); ) {
-    alarm_t *alarm = (alarm_t *)list_node(node);
-    node = list_next(node);
+  size_t count = 0;
+  alarm_t **canceled = NULL;
+  if (alarms->size != 0)
+    canceled = osi_malloc(alarms->size * sizeof(alarm_t *));
+  for (size_t i = 0; i < alarms->size; ++i) {
     // TODO: Each module is responsible for tearing down its alarms; currently,
     // this is not the case. In the future, this check should be replaced by
     // an assert.
-    if (alarm->queue == queue)
-      alarm_cancel_internal(alarm);
+    if (alarms->entries[i]->queue == queue)
+      canceled[count++] = alarms->entries[i];
   }
+  for (size_t i = 0; i < count; ++i)
+    alarm_cancel_internal(canceled[i]);
+  osi_free(canceled);
   pthread_mutex_unlock(&monitor);
 }
 
@@ -626,6 +677,8 @@ static void alarm_queue_ready(fixed_queue_t *queue,
   pthread_mutex_unlock(&monitor);
 
   period_ms_t t0 = now();
+  metrics_histogram_record(METRICS_HISTOGRAM_ALARM_LATENESS,
+                           t0 > deadline ? (uint64_t)(t0 - deadline) * 1000 : 0);
   callback(data);
   period_ms_t t1 = now();
 
@@ -653,31 +706,36 @@ static void callback_dispatch(UNUSED_ATTR void *context) {
       break;
 
     pthread_mutex_lock(&monitor);
-    alarm_t *alarm;
 
     // Take into account that the alarm may get cancelled before we get to it.
-    // We're done here if there are no alarms or the alarm at the front is in
-    // the future. Release the monitor lock and exit right away since there's
-    // nothing left to do.
-    if (list_is_empty(alarms) ||
-        (alarm = list_front(alarms))->deadline > now()) {
-      reschedule_root_alarm();
-      pthread_mutex_unlock(&monitor);
-      continue;
-    }
+    // Dispatch every alarm that has expired, including the ones coalesced
+    // with the first, then arm the timer once for the rest. If none has
+    // expired, this only re-arms the timer.
+    const period_ms_t just_now = now();
+    size_t dispatched = 0;
+    alarm_t *alarm;
+    while ((alarm = alarm_heap_front(alarms)) != NULL &&
+           alarm->deadline <= just_now) {
+      alarm_heap_remove(alarms, alarm);
+
+      if (alarm->is_periodic) {
+        alarm->prev_deadline = alarm->deadline;
+        schedule_next_instance(alarm);
+        alarm->stats.rescheduled_count++;
+      }
 
-    list_remove(alarms, alarm);
+      // Enqueue the alarm for processing
+      fixed_queue_enqueue(alarm->queue, alarm);
+      if (++dispatched > 1)
+        coalesced_count++;
 
-    if (alarm->is_periodic) {
-      alarm->prev_deadline = alarm->deadline;
-      schedule_next_instance(alarm);
-      alarm->stats.rescheduled_count++;
+      // A periodic alarm with a zero period is due again right away; leave
+      // it to the next wakeup so that it cannot starve the others.
+      if (alarm->is_periodic && alarm->period == 0)
+        break;
     }
     reschedule_root_alarm();
 
-    // Enqueue the alarm for processing
-    fixed_queue_enqueue(alarm->queue, alarm);
-
     pthread_mutex_unlock(&monitor);
   }
 
@@ -752,12 +810,16 @@ void alarm_debug_dump(int fd)
 
   period_ms_t just_now = now();
 
-  dprintf(fd, "  Total Alarms: %zu\n\n", list_length(alarms));
+  dprintf(fd, "  Total Alarms: %zu\n", alarms->size);
+  dprintf(fd, "  Heap occupancy (pending/peak/capacity): %zu / %zu / %zu\n",
+          alarms->size, alarms->max_size, alarms->capacity);
+  dprintf(fd, "  Timer re-arms (done/skipped): %zu / %zu\n",
+          timer_rearm_count, timer_rearm_skipped_count);
+  dprintf(fd, "  Coalesced alarm expirations: %zu\n\n", coalesced_count);
 
   // Dump info for each alarm
-  for (list_node_t *node = list_begin(alarms); node != list_end(alarms);
-       node = list_next(node)) {
-    alarm_t *alarm = (alarm_t *)list_node(node);
+  for (size_t i = 0; i < alarms->size; ++i) {
+    alarm_t *alarm = alarms->entries[i];
     alarm_stats_t *stats = &alarm->stats;
 
     dprintf(fd, "  Alarm : %s (%s)\n", stats->name,
@@ -792,3 +854,142 @@ void alarm_debug_dump(int fd)
   }
   pthread_mutex_unlock(&monitor);
 }
+
+static alarm_heap_t *alarm_heap_new(void) {
+  alarm_heap_t *heap = osi_calloc(sizeof(alarm_heap_t));
+  heap->capacity = ALARM_HEAP_INITIAL_CAPACITY;
+  heap->entries = osi_malloc(heap->capacity * sizeof(alarm_t *));
+  return heap;
+}
+
+static void alarm_heap_free(alarm_heap_t *heap) {
+  if (!heap)
+    return;
+
+  for (size_t i = 0; i < heap->size; ++i)
+    heap->entries[i]->heap_index = NOT_PENDING;
+  osi_free(heap->entries);
+  osi_free(heap);
+}
+
+// Returns true if |a| expires before |b|.
+static bool alarm_heap_less(const alarm_t *a, const alarm_t *b) {
+  if (a->deadline != b->deadline)
+    return a->deadline < b->deadline;
+  return a->sequence < b->sequence;
+}
+
+static void alarm_heap_place(alarm_heap_t *heap, size_t index, alarm_t *alarm) {
+  heap->entries[index] = alarm;
+  alarm->heap_index = index;
+}
+
+static void alarm_heap_sift_up(alarm_heap_t *heap, size_t index) {
+  alarm_t *alarm = heap->entries[index];
+  while (index > 0) {
+    size_t parent = (index - 1) / 2;
+    if (!alarm_heap_less(alarm, heap->entries[parent]))
+      break;
+    alarm_heap_place(heap, index, heap->entries[parent]);
+    index = parent;
+  }
+  alarm_heap_place(heap, index, alarm);
+}
+
+static void alarm_heap_sift_down(alarm_heap_t *heap, size_t index) {
+  alarm_t *alarm = heap->entries[index];
+  for (;;) {
+    size_t child = 2 * index + 1;
+    if (child >= heap->size)
+      break;
+    if (child + 1 < heap->size &&
+        alarm_heap_less(heap->entries[child + 1], heap->entries[child]))
+      child++;
+    if (!alarm_heap_less(heap->entries[child], alarm))
+      break;
+    alarm_heap_place(heap, index, heap->entries[child]);
+    index = child;
+  }
+  alarm_heap_place(heap, index, alarm);
+}
+
+static void alarm_heap_push(alarm_heap_t *heap, alarm_t *alarm) {
+  assert(alarm->heap_index == NOT_PENDING);
+
+  if (heap->size == heap->capacity) {
+    alarm_t **entries = osi_malloc(2 * heap->capacity * sizeof(alarm_t *));
+    memcpy(entries, heap->entries, heap->size * sizeof(alarm_t *));
+    osi_free(heap->entries);
+    heap->entries = entries;
+    heap->capacity *= 2;
+  }
+
+  alarm->sequence = heap->next_sequence++;
+  heap->entries[heap->size] = alarm;
+  heap->size++;
+  if (heap->size > heap->max_size)
+    heap->max_size = heap->size;
+  alarm_heap_sift_up(heap, heap->size - 1);
+}
+
+// Removes |alarm| if it is pending; does nothing otherwise.
+static void alarm_heap_remove(alarm_heap_t *heap, alarm_t *alarm) {
+  size_t index = alarm->heap_index;
+  if (index == NOT_PENDING)
+    return;
+
+  assert(index < heap->size && heap->entries[index] == alarm);
+  alarm->heap_index = NOT_PENDING;
+  heap->size--;
+  if (index == heap->size)
+    return;
+
+  // Move the last entry into the hole, then restore the heap order in
+  // whichever direction it is broken.
+  heap->entries[index] = heap->entries[heap->size];
+  heap->entries[index]->heap_index = index;
+  if (index > 0 && alarm_heap_less(heap->entries[index], heap->entries[(index - 1) / 2]))
+    alarm_heap_sift_up(heap, index);
+  else
+    alarm_heap_sift_down(heap, index);
+}
+
+static alarm_t *alarm_heap_front(const alarm_heap_t *heap) {
+  return heap->size ? heap->entries[0] : NULL;
+}
+
+// Finds the latest one-shot deadline within the coalescing window of the
+// first deadline, stopping short of any periodic alarm in the window.
+// Only the part of the heap with deadlines inside the window is visited.
+static void find_coalesced_deadline(const alarm_heap_t *heap, size_t index,
+                                    period_ms_t window_end,
+                                    period_ms_t *latest, period_ms_t *limit) {
+  if (index >= heap->size)
+    return;
+
+  const alarm_t *alarm = heap->entries[index];
+  if (alarm->deadline > window_end)
+    return;
+
+  if (alarm->is_periodic) {
+    if (alarm->deadline < *limit)
+      *limit = alarm->deadline;
+  } else if (alarm->deadline > *latest) {
+    *latest = alarm->deadline;
+  }
+
+  find_coalesced_deadline(heap, 2 * index + 1, window_end, latest, limit);
+  find_coalesced_deadline(heap, 2 * index + 2, window_end, latest, limit);
+}
+
+// Returns the deadline to arm the timer for. The heap may not be empty.
+static period_ms_t coalesced_deadline(const alarm_heap_t *heap) {
+  const alarm_t *root = alarm_heap_front(heap);
+  if (root->is_periodic || ALARM_COALESCING_WINDOW_MS <= 0)
+    return root->deadline;
+
+  period_ms_t latest = root->deadline;
+  period_ms_t limit = root->deadline + ALARM_COALESCING_WINDOW_MS;
+  find_coalesced_deadline(heap, 0, limit, &latest, &limit);
+  return (latest < limit) ? latest : limit;
+}
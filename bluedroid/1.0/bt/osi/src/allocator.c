@@ -21,13 +21,27 @@
 
 #include "osi/include/allocator.h"
 #include "osi/include/allocation_tracker.h"
+#include "osi/include/slab_allocator.h"
 
 static const allocator_id_t alloc_allocator_id = 42;
+static const allocator_id_t slab_allocator_id = 43;
+
+// With OSI_SLAB_ALLOCATOR, all osi_* allocations come from the slab
+// allocator, so that any buffer may still be freed with |osi_free|.
+#if defined(OSI_SLAB_ALLOCATOR) && (OSI_SLAB_ALLOCATOR == TRUE)
+#define backend_malloc(size) slab_malloc(size)
+#define backend_calloc(size) slab_calloc(size)
+#define backend_free(ptr) slab_free(ptr)
+#else
+#define backend_malloc(size) malloc(size)
+#define backend_calloc(size) calloc(1, (size))
+#define backend_free(ptr) free(ptr)
+#endif
 
 char *osi_strdup(const char *str) {
   size_t size = strlen(str) + 1;  // + 1 for the null terminator
   size_t real_size = allocation_tracker_resize_for_canary(size);
-  void *ptr = malloc(real_size);
+  void *ptr = backend_malloc(real_size);
   assert(ptr);
 
   char *new_string = allocation_tracker_notify_alloc(
@@ -47,7 +61,7 @@ char *osi_strndup(const char *str, size_t len) {
     size = len;
 
   size_t real_size = allocation_tracker_resize_for_canary(size + 1);
-  void *ptr = malloc(real_size);
+  void *ptr = backend_malloc(real_size);
   assert(ptr);
 
   char *new_string = allocation_tracker_notify_alloc(
@@ -64,14 +78,14 @@ char *osi_strndup(const char *str, size_t len) {
 
 void *osi_malloc(size_t size) {
   size_t real_size = allocation_tracker_resize_for_canary(size);
-  void *ptr = malloc(real_size);
+  void *ptr = backend_malloc(real_size);
   assert(ptr);
   return allocation_tracker_notify_alloc(alloc_allocator_id, ptr, size);
 }
 
 void *osi_calloc(size_t size) {
   size_t real_size = allocation_tracker_resize_for_canary(size);
-  void *ptr = calloc(1, real_size);
+  void *ptr = backend_calloc(real_size);
   assert(ptr);
   return allocation_tracker_notify_alloc(alloc_allocator_id, ptr, size);
 }
@@ -84,7 +98,7 @@ void osi_free(void *ptr) {
   }
 #endif
 
-  free(allocation_tracker_notify_free(alloc_allocator_id, ptr));
+  backend_free(allocation_tracker_notify_free(alloc_allocator_id, ptr));
 }
 
 void osi_free_and_reset(void **p_ptr)
@@ -110,3 +124,18 @@ const allocator_t allocator_malloc = {
   osi_malloc,
   osi_free
 };
+
+static void *slab_allocator_alloc(size_t size) {
+  size_t real_size = allocation_tracker_resize_for_canary(size);
+  void *ptr = slab_malloc(real_size);
+  return allocation_tracker_notify_alloc(slab_allocator_id, ptr, size);
+}
+
+static void slab_allocator_free(void *ptr) {
+  slab_free(allocation_tracker_notify_free(slab_allocator_id, ptr));
+}
+
+const allocator_t allocator_slab = {
+  slab_allocator_alloc,
+  slab_allocator_free
+};
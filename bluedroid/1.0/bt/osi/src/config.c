@@ -32,27 +32,46 @@
 #include <sys/stat.h>
 
 #include "osi/include/allocator.h"
+#include "osi/include/hash_functions.h"
+#include "osi/include/hash_map.h"
 #include "osi/include/list.h"
 #include "osi/include/log.h"
 
+#define SECTION_BUCKETS 64
+#define ENTRY_BUCKETS 16
+
 typedef struct {
   char *key;
   char *value;
 } entry_t;
 
+// The lists keep the order of the file; the maps index the same objects by
+// name and do not own them.
 typedef struct {
   char *name;
   list_t *entries;
+  hash_map_t *entry_map;
 } section_t;
 
 struct config_t {
   list_t *sections;
+  hash_map_t *section_map;
+  uint64_t generation;
 };
 
+// Text of a config as written to a file.
+typedef struct {
+  char *data;
+  size_t length;
+  size_t capacity;
+} text_t;
+
 // Empty definition; this type is aliased to list_node_t.
 struct config_section_iter_t {};
 
 static bool config_parse(FILE *fp, config_t *config);
+static void config_serialize(const config_t *config, text_t *text);
+static bool string_equal(const void *x, const void *y);
 
 static section_t *section_new(const char *name);
 static void section_free(void *ptr);
@@ -71,6 +90,12 @@ config_t *config_new_empty(void) {
     goto error;
   }
 
+  config->section_map = hash_map_new(SECTION_BUCKETS, hash_function_string, NULL, NULL, string_equal);
+  if (!config->section_map) {
+    LOG_ERROR(LOG_TAG, "%s unable to allocate map for sections.", __func__);
+    goto error;
+  }
+
   return config;
 
 error:;
@@ -132,6 +157,7 @@ void config_free(config_t *config) {
   if (!config)
     return;
 
+  hash_map_free(config->section_map);
   list_free(config->sections);
   osi_free(config);
 }
@@ -229,19 +255,23 @@ void config_set_string(config_t *config, const char *section, const char *key, c
   if (!sec) {
     sec = section_new(section);
     list_append(config->sections, sec);
+    hash_map_set(config->section_map, sec->name, sec);
   }
 
-  for (const list_node_t *node = list_begin(sec->entries); node != list_end(sec->entries); node = list_next(node)) {
-    entry_t *entry = list_node(node);
-    if (!strcmp(entry->key, key)) {
+  entry_t *entry = hash_map_get(sec->entry_map, key);
+  if (entry) {
+    if (strcmp(entry->value, value)) {
       osi_free(entry->value);
       entry->value = osi_strdup(value);
-      return;
+      config->generation++;
     }
+    return;
   }
 
-  entry_t *entry = entry_new(key, value);
+  entry = entry_new(key, value);
   list_append(sec->entries, entry);
+  hash_map_set(sec->entry_map, entry->key, entry);
+  config->generation++;
 }
 
 bool config_remove_section(config_t *config, const char *section) {
@@ -252,6 +282,8 @@ bool config_remove_section(config_t *config, const char *section) {
   if (!sec)
     return false;
 
+  hash_map_erase(config->section_map, sec->name);
+  config->generation++;
   return list_remove(config->sections, sec);
 }
 
@@ -265,9 +297,39 @@ bool config_remove_key(config_t *config, const char *section, const char *key) {
   if (!sec || !entry)
     return false;
 
+  hash_map_erase(sec->entry_map, entry->key);
+  config->generation++;
   return list_remove(sec->entries, entry);
 }
 
+uint64_t config_generation(const config_t *config) {
+  assert(config != NULL);
+  return config->generation;
+}
+
+bool config_is_saved(const config_t *config, const char *filename) {
+  assert(config != NULL);
+  assert(filename != NULL);
+
+  FILE *fp = fopen(filename, "rb");
+  if (!fp)
+    return false;
+
+  text_t text = { NULL, 0, 0 };
+  config_serialize(config, &text);
+
+  // One byte more than expected, to tell a longer file from an equal one.
+  char *contents = osi_malloc(text.length + 1);
+  size_t read = fread(contents, 1, text.length + 1, fp);
+  bool saved = !ferror(fp) && read == text.length &&
+      !memcmp(contents, text.data, text.length);
+
+  fclose(fp);
+  osi_free(contents);
+  osi_free(text.data);
+  return saved;
+}
+
 const config_section_node_t *config_section_begin(const config_t *config) {
   assert(config != NULL);
   return (const config_section_node_t *)list_begin(config->sections);
@@ -290,6 +352,22 @@ const char *config_section_name(const config_section_node_t *node) {
   return section->name;
 }
 
+bool config_foreach(const config_t *config, config_foreach_cb callback, void *context) {
+  assert(config != NULL);
+  assert(callback != NULL);
+
+  for (const list_node_t *node = list_begin(config->sections); node != list_end(config->sections); node = list_next(node)) {
+    const section_t *section = (const section_t *)list_node(node);
+
+    for (const list_node_t *enode = list_begin(section->entries); enode != list_end(section->entries); enode = list_next(enode)) {
+      const entry_t *entry = (const entry_t *)list_node(enode);
+      if (!callback(section->name, entry->key, entry->value, context))
+        return false;
+    }
+  }
+  return true;
+}
+
 bool config_save(const config_t *config, const char *filename) {
   assert(config != NULL);
   assert(filename != NULL);
@@ -305,6 +383,7 @@ bool config_save(const config_t *config, const char *filename) {
   //    This ensures directory entries are up-to-date.
   int dir_fd = -1;
   FILE *fp = NULL;
+  text_t text = { NULL, 0, 0 };
 
   // Build temp config file based on config file (e.g. bt_config.conf.new).
   static const char *temp_file_ext = ".new";
@@ -333,28 +412,10 @@ bool config_save(const config_t *config, const char *filename) {
     goto error;
   }
 
-  for (const list_node_t *node = list_begin(config->sections); node != list_end(config->sections); node = list_next(node)) {
-    const section_t *section = (const section_t *)list_node(node);
-    if (fprintf(fp, "[%s]\n", section->name) < 0) {
-      LOG_ERROR(LOG_TAG, "%s unable to write to file '%s': %s", __func__, temp_filename, strerror(errno));
-      goto error;
-    }
-
-    for (const list_node_t *enode = list_begin(section->entries); enode != list_end(section->entries); enode = list_next(enode)) {
-      const entry_t *entry = (const entry_t *)list_node(enode);
-      if (fprintf(fp, "%s = %s\n", entry->key, entry->value) < 0) {
-        LOG_ERROR(LOG_TAG, "%s unable to write to file '%s': %s", __func__, temp_filename, strerror(errno));
-        goto error;
-      }
-    }
-
-    // Only add a separating newline if there are more sections.
-    if (list_next(node) != list_end(config->sections)) {
-      if (fputc('\n', fp) == EOF) {
-        LOG_ERROR(LOG_TAG, "%s unable to write to file '%s': %s", __func__, temp_filename, strerror(errno));
-        goto error;
-      }
-    }
+  config_serialize(config, &text);
+  if (fwrite(text.data, 1, text.length, fp) != text.length) {
+    LOG_ERROR(LOG_TAG, "%s unable to write to file '%s': %s", __func__, temp_filename, strerror(errno));
+    goto error;
   }
 #if defined(MTK_LINUX_GAP) && (MTK_LINUX_GAP == TRUE)
   if (fflush(fp) == EOF)
@@ -395,6 +456,7 @@ bool config_save(const config_t *config, const char *filename) {
     goto error;
   }
 
+  osi_free(text.data);
   osi_free(temp_filename);
   osi_free(temp_dirname);
   return true;
@@ -406,11 +468,50 @@ error:
     fclose(fp);
   if (dir_fd != -1)
     close(dir_fd);
+  osi_free(text.data);
   osi_free(temp_filename);
   osi_free(temp_dirname);
   return false;
 }
 
+static void text_append(text_t *text, const char *str) {
+  size_t length = strlen(str);
+  if (text->length + length > text->capacity) {
+    size_t capacity = text->capacity ? text->capacity * 2 : 1024;
+    while (capacity < text->length + length)
+      capacity *= 2;
+    char *data = osi_malloc(capacity);
+    if (text->data)
+      memcpy(data, text->data, text->length);
+    osi_free(text->data);
+    text->data = data;
+    text->capacity = capacity;
+  }
+  memcpy(text->data + text->length, str, length);
+  text->length += length;
+}
+
+static void config_serialize(const config_t *config, text_t *text) {
+  for (const list_node_t *node = list_begin(config->sections); node != list_end(config->sections); node = list_next(node)) {
+    const section_t *section = (const section_t *)list_node(node);
+    text_append(text, "[");
+    text_append(text, section->name);
+    text_append(text, "]\n");
+
+    for (const list_node_t *enode = list_begin(section->entries); enode != list_end(section->entries); enode = list_next(enode)) {
+      const entry_t *entry = (const entry_t *)list_node(enode);
+      text_append(text, entry->key);
+      text_append(text, " = ");
+      text_append(text, entry->value);
+      text_append(text, "\n");
+    }
+
+    // Only add a separating newline if there are more sections.
+    if (list_next(node) != list_end(config->sections))
+      text_append(text, "\n");
+  }
+}
+
 static char *trim(char *str) {
   while (isspace(*str))
     ++str;
@@ -470,6 +571,7 @@ static section_t *section_new(const char *name) {
 
   section->name = osi_strdup(name);
   section->entries = list_new(entry_free);
+  section->entry_map = hash_map_new(ENTRY_BUCKETS, hash_function_string, NULL, NULL, string_equal);
   return section;
 }
 
@@ -478,19 +580,14 @@ static void section_free(void *ptr) {
     return;
 
   section_t *section = ptr;
+  hash_map_free(section->entry_map);
   osi_free(section->name);
   list_free(section->entries);
   osi_free(section);
 }
 
 static section_t *section_find(const config_t *config, const char *section) {
-  for (const list_node_t *node = list_begin(config->sections); node != list_end(config->sections); node = list_next(node)) {
-    section_t *sec = list_node(node);
-    if (!strcmp(sec->name, section))
-      return sec;
-  }
-
-  return NULL;
+  return hash_map_get(config->section_map, section);
 }
 
 static entry_t *entry_new(const char *key, const char *value) {
@@ -516,13 +613,11 @@ static entry_t *entry_find(const config_t *config, const char *section, const ch
   if (!sec)
     return NULL;
 
-  for (const list_node_t *node = list_begin(sec->entries); node != list_end(sec->entries); node = list_next(node)) {
-    entry_t *entry = list_node(node);
-    if (!strcmp(entry->key, key))
-      return entry;
-  }
+  return hash_map_get(sec->entry_map, key);
+}
 
-  return NULL;
+static bool string_equal(const void *x, const void *y) {
+  return !strcmp(x, y);
 }
 
 #if defined(MTK_STACK_CONFIG) && (MTK_STACK_CONFIG == TRUE)
@@ -22,6 +22,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <pthread.h>
 #include <string.h>
 #include <sys/eventfd.h>
 #include <unistd.h>
@@ -56,10 +57,32 @@ struct eager_reader_t {
   reactor_object_t *outbound_registration;
   eager_reader_cb outbound_read_ready;
   void *outbound_context;
+
+  // Only used by framed readers, for which |ring| is not NULL. The ring holds
+  // up to two regions of contiguous frames. When |ring_wrapped| is false there
+  // is one, [|ring_head|, |ring_tail|), and otherwise the older one is
+  // [|ring_head|, |ring_wrap_end|) and the newer one is [0, |ring_tail|). The
+  // bytes of the newer region after |ring_parsed| don't form a complete frame
+  // yet. |bytes_available_fd| counts complete frames instead of bytes.
+  eager_reader_frame_cb frame_length;
+  pthread_mutex_t ring_lock;
+  pthread_cond_t ring_space;
+  uint8_t *ring;
+  size_t ring_size;
+  size_t ring_head;
+  size_t ring_wrap_end;
+  size_t ring_parsed;
+  size_t ring_tail;
+  bool ring_wrapped;
+  bool ring_closing;
+  size_t peeked_length;
 };
 
+static bool start_reading(eager_reader_t *reader, const char *thread_name, void (*read_ready)(void *context));
 static bool has_byte(const eager_reader_t *reader);
+static bool has_frame(eager_reader_t *reader);
 static void inbound_data_waiting(void *context);
+static void inbound_frame_data_waiting(void *context);
 static void internal_outbound_read_ready(void *context);
 
 eager_reader_t *eager_reader_new(
@@ -94,19 +117,47 @@ eager_reader_t *eager_reader_new(
     goto error;
   }
 
-  ret->inbound_read_thread = thread_new(thread_name);
-  if (!ret->inbound_read_thread) {
-    LOG_ERROR(LOG_TAG, "%s unable to make reading thread.", __func__);
+  if (!start_reading(ret, thread_name, inbound_data_waiting))
+    goto error;
+
+  return ret;
+
+error:;
+  eager_reader_free(ret);
+  return NULL;
+}
+
+eager_reader_t *eager_reader_new_framed(
+    int fd_to_read,
+    size_t ring_size,
+    size_t read_size,
+    eager_reader_frame_cb frame_length,
+    const char *thread_name) {
+
+  assert(fd_to_read != INVALID_FD);
+  assert(read_size > 0);
+  assert(ring_size >= read_size);
+  assert(frame_length != NULL);
+  assert(thread_name != NULL && *thread_name != '\0');
+
+  eager_reader_t *ret = osi_calloc(sizeof(eager_reader_t));
+
+  ret->inbound_fd = fd_to_read;
+  ret->buffer_size = read_size;
+  ret->frame_length = frame_length;
+  pthread_mutex_init(&ret->ring_lock, NULL);
+  pthread_cond_init(&ret->ring_space, NULL);
+  ret->ring_size = ring_size;
+  ret->ring = osi_malloc(ring_size);
+
+  ret->bytes_available_fd = eventfd(0, 0);
+  if (ret->bytes_available_fd == INVALID_FD) {
+    LOG_ERROR(LOG_TAG, "%s unable to create output reading semaphore.", __func__);
     goto error;
   }
 
-  ret->inbound_read_object = reactor_register(
-    thread_get_reactor(ret->inbound_read_thread),
-    fd_to_read,
-    ret,
-    inbound_data_waiting,
-    NULL
-  );
+  if (!start_reading(ret, thread_name, inbound_frame_data_waiting))
+    goto error;
 
   return ret;
 
@@ -121,6 +172,14 @@ void eager_reader_free(eager_reader_t *reader) {
 
   eager_reader_unregister(reader);
 
+  // Wake up the read thread if it waits for space in the ring.
+  if (reader->ring) {
+    pthread_mutex_lock(&reader->ring_lock);
+    reader->ring_closing = true;
+    pthread_cond_signal(&reader->ring_space);
+    pthread_mutex_unlock(&reader->ring_lock);
+  }
+
   // Only unregister from the input if we actually did register
   if (reader->inbound_read_object)
     reactor_unregister(reader->inbound_read_object);
@@ -133,8 +192,16 @@ void eager_reader_free(eager_reader_t *reader) {
   if (reader->current_buffer)
     reader->allocator->free(reader->current_buffer);
 
-  fixed_queue_free(reader->buffers, reader->allocator->free);
+  if (reader->buffers)
+    fixed_queue_free(reader->buffers, reader->allocator->free);
   thread_free(reader->inbound_read_thread);
+
+  if (reader->ring) {
+    osi_free(reader->ring);
+    pthread_cond_destroy(&reader->ring_space);
+    pthread_mutex_destroy(&reader->ring_lock);
+  }
+
   osi_free(reader);
 }
 
@@ -164,6 +231,7 @@ void eager_reader_unregister(eager_reader_t *reader) {
 size_t eager_reader_read(eager_reader_t *reader, uint8_t *buffer, size_t max_size) {
   assert(reader != NULL);
   assert(buffer != NULL);
+  assert(reader->ring == NULL);
 
   // Poll to see if we have any bytes available before reading.
   if (!has_byte(reader))
@@ -206,11 +274,65 @@ size_t eager_reader_read(eager_reader_t *reader, uint8_t *buffer, size_t max_siz
   return bytes_consumed;
 }
 
+// SEE HEADER FOR THREAD SAFETY NOTE
+bool eager_reader_peek_frame(eager_reader_t *reader, const uint8_t **data, size_t *length) {
+  assert(reader != NULL);
+  assert(reader->ring != NULL);
+  assert(data != NULL);
+  assert(length != NULL);
+
+  pthread_mutex_lock(&reader->ring_lock);
+  size_t end = reader->ring_wrapped ? reader->ring_wrap_end : reader->ring_parsed;
+  bool ret = reader->ring_head < end;
+  if (ret) {
+    *data = reader->ring + reader->ring_head;
+    *length = reader->frame_length(*data, end - reader->ring_head);
+    reader->peeked_length = *length;
+  }
+  pthread_mutex_unlock(&reader->ring_lock);
+
+  return ret;
+}
+
+void eager_reader_release_frame(eager_reader_t *reader) {
+  assert(reader != NULL);
+  assert(reader->ring != NULL);
+
+  pthread_mutex_lock(&reader->ring_lock);
+  assert(reader->peeked_length > 0);
+  reader->ring_head += reader->peeked_length;
+  reader->peeked_length = 0;
+  if (reader->ring_wrapped && reader->ring_head == reader->ring_wrap_end) {
+    reader->ring_head = 0;
+    reader->ring_wrapped = false;
+  }
+  pthread_cond_signal(&reader->ring_space);
+  pthread_mutex_unlock(&reader->ring_lock);
+}
+
 thread_t* eager_reader_get_read_thread(const eager_reader_t *reader) {
   assert(reader != NULL);
   return reader->inbound_read_thread;
 }
 
+static bool start_reading(eager_reader_t *reader, const char *thread_name, void (*read_ready)(void *context)) {
+  reader->inbound_read_thread = thread_new(thread_name);
+  if (!reader->inbound_read_thread) {
+    LOG_ERROR(LOG_TAG, "%s unable to make reading thread.", __func__);
+    return false;
+  }
+
+  reader->inbound_read_object = reactor_register(
+    thread_get_reactor(reader->inbound_read_thread),
+    reader->inbound_fd,
+    reader,
+    read_ready,
+    NULL
+  );
+
+  return true;
+}
+
 static bool has_byte(const eager_reader_t *reader) {
   assert(reader != NULL);
 
@@ -235,6 +357,100 @@ static bool has_byte(const eager_reader_t *reader) {
   return FD_ISSET(reader->bytes_available_fd, &read_fds);
 }
 
+static bool has_frame(eager_reader_t *reader) {
+  pthread_mutex_lock(&reader->ring_lock);
+  size_t end = reader->ring_wrapped ? reader->ring_wrap_end : reader->ring_parsed;
+  bool ret = reader->ring_head < end;
+  pthread_mutex_unlock(&reader->ring_lock);
+  return ret;
+}
+
+// Returns the contiguous space available after |ring_tail|. When little is
+// left at the end of the ring, the incomplete frame at the tail is moved to
+// the start, so that frames never wrap around. Called with |ring_lock| held.
+static size_t make_room(eager_reader_t *reader) {
+  if (reader->ring_wrapped)
+    return reader->ring_head - reader->ring_tail;
+
+  size_t room = reader->ring_size - reader->ring_tail;
+  if (room >= reader->buffer_size)
+    return room;
+
+  size_t partial = reader->ring_tail - reader->ring_parsed;
+  if (reader->ring_head == reader->ring_parsed) {
+    // Everything before the incomplete frame has been released.
+    reader->ring_head = 0;
+  } else if (partial < reader->ring_head &&
+             (room == 0 || reader->ring_head - partial >= reader->buffer_size)) {
+    // Start the newer region at the beginning of the ring.
+    reader->ring_wrap_end = reader->ring_parsed;
+    reader->ring_wrapped = true;
+  } else {
+    return room;
+  }
+
+  memmove(reader->ring, reader->ring + reader->ring_parsed, partial);
+  reader->ring_parsed = 0;
+  reader->ring_tail = partial;
+
+  if (reader->ring_wrapped)
+    return reader->ring_head - reader->ring_tail;
+  return reader->ring_size - reader->ring_tail;
+}
+
+static void inbound_frame_data_waiting(void *context) {
+  eager_reader_t *reader = (eager_reader_t *)context;
+
+  // Wait for the consumer to release frames if the ring is full. Meanwhile the
+  // data stays in the kernel and flow control pushes back on the sender.
+  pthread_mutex_lock(&reader->ring_lock);
+  size_t room;
+  while ((room = make_room(reader)) == 0 && !reader->ring_closing)
+    pthread_cond_wait(&reader->ring_space, &reader->ring_lock);
+  uint8_t *tail = reader->ring + reader->ring_tail;
+  pthread_mutex_unlock(&reader->ring_lock);
+
+  if (room == 0)
+    return;
+
+  // Only this thread writes past |ring_tail|, so the read happens unlocked.
+  ssize_t bytes_read;
+  OSI_NO_INTR(bytes_read = read(reader->inbound_fd, tail, room));
+  if (bytes_read <= 0) {
+    if (bytes_read == 0)
+      LOG_WARN(LOG_TAG, "%s fd said bytes existed, but none were found.", __func__);
+    else
+      LOG_WARN(LOG_TAG, "%s unable to read from file descriptor: %s", __func__, strerror(errno));
+    return;
+  }
+
+  pthread_mutex_lock(&reader->ring_lock);
+  reader->ring_tail += bytes_read;
+
+  eventfd_t frames = 0;
+  size_t length;
+  for (;;) {
+    size_t available = reader->ring_tail - reader->ring_parsed;
+    length = reader->frame_length(reader->ring + reader->ring_parsed, available);
+    if (length == 0 || length > available)
+      break;
+
+    reader->ring_parsed += length;
+    frames++;
+  }
+  pthread_mutex_unlock(&reader->ring_lock);
+
+  if (length > reader->ring_size) {
+    LOG_ERROR(LOG_TAG, "%s frame of %zu bytes doesn't fit in the ring.", __func__, length);
+    assert(false && "Frame larger than the ring");
+  }
+
+  // Tell consumers frames are available by incrementing
+  // the semaphore by the number of frames we just completed
+  if (frames)
+    eventfd_write(reader->bytes_available_fd, frames);
+}
+
 static void inbound_data_waiting(void *context) {
   eager_reader_t *reader = (eager_reader_t *)context;
 
@@ -272,5 +488,15 @@ static void internal_outbound_read_ready(void *context) {
   assert(context != NULL);
 
   eager_reader_t *reader = (eager_reader_t *)context;
+  if (!reader->ring) {
+    reader->outbound_read_ready(reader, reader->outbound_context);
+    return;
+  }
+
+  // The callback may leave frames for later; signal again if it did.
+  eventfd_t frames;
+  eventfd_read(reader->bytes_available_fd, &frames);
   reader->outbound_read_ready(reader, reader->outbound_context);
+  if (has_frame(reader))
+    eventfd_write(reader->bytes_available_fd, 1);
 }
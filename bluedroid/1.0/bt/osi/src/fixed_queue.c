@@ -16,19 +16,48 @@
  *
  ******************************************************************************/
 
+#define LOG_TAG "bt_osi_fixed_queue"
+
 #include <assert.h>
+#include <errno.h>
+#include <poll.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 #include "osi/include/allocator.h"
 #include "osi/include/fixed_queue.h"
 #include "osi/include/list.h"
+#include "osi/include/log.h"
 #include "osi/include/osi.h"
 #include "osi/include/semaphore.h"
 #include "osi/include/reactor.h"
 
+// A slot of a ring queue. |sequence| tells whose turn it is: it equals the
+// enqueue position of the slot when the slot is free, and that position + 1
+// once |data| has been stored for the consumer.
+typedef struct {
+  atomic_size_t sequence;
+  void *data;
+} ring_slot_t;
+
+// Bounded lock-free queue for many producers and one consumer.
+typedef struct {
+  ring_slot_t *slots;
+  atomic_size_t enqueue_pos;
+  size_t dequeue_pos;            // Only accessed by the consumer.
+  atomic_size_t length;
+  atomic_uint enqueue_waiters;   // Producers blocked in |fixed_queue_enqueue|.
+  pthread_cond_t not_full;       // Used with the queue's |lock|.
+  int dequeue_fd;                // Readable when the ring is not empty.
+} ring_t;
+
 typedef struct fixed_queue_t {
   list_t *list;
+  ring_t *ring;                  // Instead of |list| and the semaphores.
   semaphore_t *enqueue_sem;
   semaphore_t *dequeue_sem;
   pthread_mutex_t lock;
@@ -40,6 +69,12 @@ typedef struct fixed_queue_t {
 } fixed_queue_t;
 
 static void internal_dequeue_ready(void *context);
+static bool ring_try_enqueue(fixed_queue_t *queue, void *data);
+static void *ring_try_dequeue(fixed_queue_t *queue);
+static void ring_enqueue(fixed_queue_t *queue, void *data);
+static void *ring_dequeue(fixed_queue_t *queue);
+static void *ring_try_peek_first(fixed_queue_t *queue);
+static void ring_free(fixed_queue_t *queue, fixed_queue_free_cb free_cb);
 
 fixed_queue_t *fixed_queue_new(size_t capacity) {
   fixed_queue_t *ret = osi_calloc(sizeof(fixed_queue_t));
@@ -66,12 +101,51 @@ error:
   return NULL;
 }
 
+fixed_queue_t *fixed_queue_new_ring(size_t capacity) {
+  if (capacity > SIZE_MAX / 2 / sizeof(ring_slot_t)) {
+    LOG_ERROR(LOG_TAG, "%s capacity %zu too large for a ring", __func__, capacity);
+    return NULL;
+  }
+
+  fixed_queue_t *ret = osi_calloc(sizeof(fixed_queue_t));
+
+  pthread_mutex_init(&ret->lock, NULL);
+  ret->capacity = capacity;
+
+  ring_t *ring = osi_calloc(sizeof(ring_t));
+  ret->ring = ring;
+  ring->slots = osi_calloc((capacity ? capacity : 1) * sizeof(ring_slot_t));
+  for (size_t i = 0; i < capacity; ++i)
+    atomic_init(&ring->slots[i].sequence, i);
+  atomic_init(&ring->enqueue_pos, 0);
+  atomic_init(&ring->length, 0);
+  atomic_init(&ring->enqueue_waiters, 0);
+  pthread_cond_init(&ring->not_full, NULL);
+
+  ring->dequeue_fd = eventfd(0, EFD_NONBLOCK);
+  if (ring->dequeue_fd == INVALID_FD) {
+    LOG_ERROR(LOG_TAG, "%s unable to create dequeue fd: %s", __func__, strerror(errno));
+    goto error;
+  }
+
+  return ret;
+
+error:
+  fixed_queue_free(ret, NULL);
+  return NULL;
+}
+
 void fixed_queue_free(fixed_queue_t *queue, fixed_queue_free_cb free_cb) {
   if (!queue)
     return;
 
   fixed_queue_unregister_dequeue(queue);
 
+  if (queue->ring) {
+    ring_free(queue, free_cb);
+    return;
+  }
+
   if (free_cb)
     for (const list_node_t *node = list_begin(queue->list); node != list_end(queue->list); node = list_next(node))
       free_cb(list_node(node));
@@ -87,6 +161,9 @@ bool fixed_queue_is_empty(fixed_queue_t *queue) {
   if (queue == NULL)
     return true;
 
+  if (queue->ring)
+    return atomic_load(&queue->ring->length) == 0;
+
   pthread_mutex_lock(&queue->lock);
   bool is_empty = list_is_empty(queue->list);
   pthread_mutex_unlock(&queue->lock);
@@ -98,6 +175,9 @@ size_t fixed_queue_length(fixed_queue_t *queue) {
   if (queue == NULL)
     return 0;
 
+  if (queue->ring)
+    return atomic_load(&queue->ring->length);
+
   pthread_mutex_lock(&queue->lock);
   size_t length = list_length(queue->list);
   pthread_mutex_unlock(&queue->lock);
@@ -115,6 +195,11 @@ void fixed_queue_enqueue(fixed_queue_t *queue, void *data) {
   assert(queue != NULL);
   assert(data != NULL);
 
+  if (queue->ring) {
+    ring_enqueue(queue, data);
+    return;
+  }
+
   semaphore_wait(queue->enqueue_sem);
 
   pthread_mutex_lock(&queue->lock);
@@ -128,6 +213,7 @@ void fixed_queue_enqueue(fixed_queue_t *queue, void *data) {
 void fixed_queue_enqueue_front(fixed_queue_t *queue, void *data) {
   assert(queue != NULL);
   assert(data != NULL);
+  assert(queue->ring == NULL);
 
   semaphore_wait(queue->enqueue_sem);
 
@@ -142,6 +228,9 @@ void fixed_queue_enqueue_front(fixed_queue_t *queue, void *data) {
 void *fixed_queue_dequeue(fixed_queue_t *queue) {
   assert(queue != NULL);
 
+  if (queue->ring)
+    return ring_dequeue(queue);
+
   semaphore_wait(queue->dequeue_sem);
 
   pthread_mutex_lock(&queue->lock);
@@ -158,6 +247,9 @@ bool fixed_queue_try_enqueue(fixed_queue_t *queue, void *data) {
   assert(queue != NULL);
   assert(data != NULL);
 
+  if (queue->ring)
+    return ring_try_enqueue(queue, data);
+
   if (!semaphore_try_wait(queue->enqueue_sem))
     return false;
 
@@ -173,6 +265,9 @@ void *fixed_queue_try_dequeue(fixed_queue_t *queue) {
   if (queue == NULL)
     return NULL;
 
+  if (queue->ring)
+    return ring_try_dequeue(queue);
+
   if (!semaphore_try_wait(queue->dequeue_sem))
     return NULL;
 
@@ -190,6 +285,9 @@ void *fixed_queue_try_peek_first(fixed_queue_t *queue) {
   if (queue == NULL)
     return NULL;
 
+  if (queue->ring)
+    return ring_try_peek_first(queue);
+
   pthread_mutex_lock(&queue->lock);
   void *ret = list_is_empty(queue->list) ? NULL : list_front(queue->list);
   pthread_mutex_unlock(&queue->lock);
@@ -201,6 +299,10 @@ void *fixed_queue_try_peek_last(fixed_queue_t *queue) {
   if (queue == NULL)
     return NULL;
 
+  assert(queue->ring == NULL);
+  if (queue->ring)
+    return NULL;
+
   pthread_mutex_lock(&queue->lock);
   void *ret = list_is_empty(queue->list) ? NULL : list_back(queue->list);
   pthread_mutex_unlock(&queue->lock);
@@ -212,6 +314,10 @@ void *fixed_queue_try_remove_from_queue(fixed_queue_t *queue, void *data) {
   if (queue == NULL)
     return NULL;
 
+  assert(queue->ring == NULL);
+  if (queue->ring)
+    return NULL;
+
   bool removed = false;
   pthread_mutex_lock(&queue->lock);
   if (list_contains(queue->list, data) &&
@@ -230,6 +336,7 @@ void *fixed_queue_try_remove_from_queue(fixed_queue_t *queue, void *data) {
 
 list_t *fixed_queue_get_list(fixed_queue_t *queue) {
   assert(queue != NULL);
+  assert(queue->ring == NULL);
 
   // NOTE: This function is not thread safe, and there is no point for
   // calling pthread_mutex_lock() / pthread_mutex_unlock()
@@ -239,11 +346,16 @@ list_t *fixed_queue_get_list(fixed_queue_t *queue) {
 
 int fixed_queue_get_dequeue_fd(const fixed_queue_t *queue) {
   assert(queue != NULL);
+  if (queue->ring)
+    return queue->ring->dequeue_fd;
   return semaphore_get_fd(queue->dequeue_sem);
 }
 
 int fixed_queue_get_enqueue_fd(const fixed_queue_t *queue) {
   assert(queue != NULL);
+  assert(queue->ring == NULL);
+  if (queue->ring)
+    return INVALID_FD;
   return semaphore_get_fd(queue->enqueue_sem);
 }
 
@@ -275,9 +387,158 @@ void fixed_queue_unregister_dequeue(fixed_queue_t *queue) {
   }
 }
 
+void fixed_queue_set_dequeue_priority(fixed_queue_t *queue, reactor_priority_t priority) {
+  assert(queue != NULL);
+  assert(queue->dequeue_object != NULL);
+
+  reactor_object_set_priority(queue->dequeue_object, priority);
+}
+
 static void internal_dequeue_ready(void *context) {
   assert(context != NULL);
 
   fixed_queue_t *queue = context;
   queue->dequeue_ready(queue, queue->dequeue_context);
 }
+
+// Marks the ring readable for the consumer.
+static void ring_signal(ring_t *ring) {
+  if (eventfd_write(ring->dequeue_fd, 1ULL) == -1)
+    LOG_ERROR(LOG_TAG, "%s unable to signal dequeue fd: %s", __func__, strerror(errno));
+}
+
+// Makes the dequeue fd unreadable unless the ring is not empty. Producers
+// only signal on the transition from empty to non-empty, so check again after
+// draining in case one of them did so in the meantime.
+static void ring_clear_signal(ring_t *ring) {
+  eventfd_t value;
+  eventfd_read(ring->dequeue_fd, &value);
+  if (atomic_load(&ring->length) != 0)
+    ring_signal(ring);
+}
+
+static bool ring_try_enqueue(fixed_queue_t *queue, void *data) {
+  ring_t *ring = queue->ring;
+  if (queue->capacity == 0)
+    return false;
+
+  // Claim the slot at the current enqueue position, unless the consumer has
+  // not yet taken the element that was stored there one round ago.
+  size_t pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+  ring_slot_t *slot;
+  for (;;) {
+    slot = &ring->slots[pos % queue->capacity];
+    size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&ring->enqueue_pos, &pos, pos + 1,
+                                                memory_order_relaxed, memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+    }
+  }
+
+  slot->data = data;
+  atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+
+  if (atomic_fetch_add(&ring->length, 1) == 0)
+    ring_signal(ring);
+  return true;
+}
+
+static void *ring_try_dequeue(fixed_queue_t *queue) {
+  ring_t *ring = queue->ring;
+  if (queue->capacity == 0)
+    return NULL;
+
+  size_t pos = ring->dequeue_pos;
+  ring_slot_t *slot = &ring->slots[pos % queue->capacity];
+  if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != pos + 1) {
+    // Either empty, or a producer has claimed the slot but not filled it yet.
+    if (atomic_load(&ring->length) == 0)
+      ring_clear_signal(ring);
+    return NULL;
+  }
+
+  void *data = slot->data;
+  atomic_store_explicit(&slot->sequence, pos + queue->capacity, memory_order_release);
+  ring->dequeue_pos = pos + 1;
+
+  if (atomic_fetch_sub(&ring->length, 1) == 1)
+    ring_clear_signal(ring);
+
+  // Pairs with the fence in |ring_enqueue|: either a blocked producer sees the
+  // free slot, or we see that it is waiting.
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(&ring->enqueue_waiters, memory_order_relaxed) != 0) {
+    pthread_mutex_lock(&queue->lock);
+    pthread_cond_broadcast(&ring->not_full);
+    pthread_mutex_unlock(&queue->lock);
+  }
+
+  return data;
+}
+
+static void ring_enqueue(fixed_queue_t *queue, void *data) {
+  ring_t *ring = queue->ring;
+  if (ring_try_enqueue(queue, data))
+    return;
+
+  // The ring is full: wait for the consumer to make room.
+  atomic_fetch_add(&ring->enqueue_waiters, 1);
+  atomic_thread_fence(memory_order_seq_cst);
+  pthread_mutex_lock(&queue->lock);
+  while (!ring_try_enqueue(queue, data))
+    pthread_cond_wait(&ring->not_full, &queue->lock);
+  pthread_mutex_unlock(&queue->lock);
+  atomic_fetch_sub(&ring->enqueue_waiters, 1);
+}
+
+static void *ring_dequeue(fixed_queue_t *queue) {
+  struct pollfd pfd = { .fd = queue->ring->dequeue_fd, .events = POLLIN };
+  for (;;) {
+    void *data = ring_try_dequeue(queue);
+    if (data)
+      return data;
+
+    int ret;
+    OSI_NO_INTR(ret = poll(&pfd, 1, -1));
+    if (ret == -1) {
+      LOG_ERROR(LOG_TAG, "%s unable to wait on dequeue fd: %s", __func__, strerror(errno));
+      return NULL;
+    }
+  }
+}
+
+static void *ring_try_peek_first(fixed_queue_t *queue) {
+  ring_t *ring = queue->ring;
+  if (queue->capacity == 0)
+    return NULL;
+
+  size_t pos = ring->dequeue_pos;
+  ring_slot_t *slot = &ring->slots[pos % queue->capacity];
+  if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != pos + 1)
+    return NULL;
+  return slot->data;
+}
+
+static void ring_free(fixed_queue_t *queue, fixed_queue_free_cb free_cb) {
+  ring_t *ring = queue->ring;
+
+  if (free_cb) {
+    void *data;
+    while ((data = ring_try_dequeue(queue)) != NULL)
+      free_cb(data);
+  }
+
+  if (ring->dequeue_fd != INVALID_FD)
+    close(ring->dequeue_fd);
+  pthread_cond_destroy(&ring->not_full);
+  osi_free(ring->slots);
+  osi_free(ring);
+  pthread_mutex_destroy(&queue->lock);
+  osi_free(queue);
+}
@@ -17,36 +17,45 @@
  ******************************************************************************/
 
 #include <assert.h>
+#include <string.h>
 
 #include "osi/include/allocator.h"
 #include "osi/include/hash_map.h"
-#include "osi/include/list.h"
 #include "osi/include/osi.h"
 
-struct hash_map_t;
-
-typedef struct hash_map_bucket_t {
-  list_t *list;
-} hash_map_bucket_t;
-
-typedef struct hash_map_t {
-  hash_map_bucket_t *bucket;
-  size_t num_bucket;
+// Entries are kept in one array of slots with open addressing and Robin Hood
+// probing: an entry that is further from its home slot takes the place of one
+// that is closer to its own. This keeps probe sequences short, so a lookup
+// can stop as soon as it reaches an entry closer to home than the key would
+// be. Erasing shifts the following entries back instead of leaving
+// tombstones. The array doubles when it is more than 3/4 full.
+
+#define MIN_CAPACITY_BITS 3
+
+typedef struct {
+  hash_map_entry_t entry;
+  hash_index_t hash;
+  uint32_t distance;  // Probe distance from the home slot plus one; 0 if empty.
+} hash_map_slot_t;
+
+struct hash_map_t {
+  hash_map_slot_t *slots;
+  size_t capacity;
+  unsigned capacity_bits;
   size_t hash_size;
   hash_index_fn hash_fn;
   key_free_fn key_fn;
   data_free_fn data_fn;
   const allocator_t *allocator;
   key_equality_fn keys_are_equal;
-} hash_map_t;
-
-// Hidden constructor for list, only to be used by us.
-list_t *list_new_internal(list_free_cb callback, const allocator_t *zeroed_allocator);
+};
 
-static void bucket_free_(void *data);
 static bool default_key_equality(const void *x, const void *y);
-static hash_map_entry_t *find_bucket_entry_(list_t *hash_bucket_list,
-    const void *key);
+static hash_map_slot_t *find_slot_(const hash_map_t *hash_map, const void *key,
+    hash_index_t hash);
+static void insert_slot_(hash_map_t *hash_map, hash_map_slot_t slot);
+static bool grow_(hash_map_t *hash_map);
+static void free_entry_(const hash_map_t *hash_map, hash_map_entry_t *entry);
 
 // Hidden constructor, only to be used by the allocation tracker. Behaves the same as
 // |hash_map_new|, except you get to specify the allocator.
@@ -71,9 +80,14 @@ hash_map_t *hash_map_new_internal(
   hash_map->allocator = zeroed_allocator;
   hash_map->keys_are_equal = equality_fn ? equality_fn : default_key_equality;
 
-  hash_map->num_bucket = num_bucket;
-  hash_map->bucket = zeroed_allocator->alloc(sizeof(hash_map_bucket_t) * num_bucket);
-  if (hash_map->bucket == NULL) {
+  // |num_bucket| is taken as the number of entries expected.
+  hash_map->capacity_bits = MIN_CAPACITY_BITS;
+  while (((size_t)1 << hash_map->capacity_bits) < num_bucket)
+    hash_map->capacity_bits++;
+  hash_map->capacity = (size_t)1 << hash_map->capacity_bits;
+
+  hash_map->slots = zeroed_allocator->alloc(sizeof(hash_map_slot_t) * hash_map->capacity);
+  if (hash_map->slots == NULL) {
     zeroed_allocator->free(hash_map);
     return NULL;
   }
@@ -93,7 +107,7 @@ void hash_map_free(hash_map_t *hash_map) {
   if (hash_map == NULL)
     return;
   hash_map_clear(hash_map);
-  hash_map->allocator->free(hash_map->bucket);
+  hash_map->allocator->free(hash_map->slots);
   hash_map->allocator->free(hash_map);
 }
 
@@ -109,77 +123,75 @@ size_t hash_map_size(const hash_map_t *hash_map) {
 
 size_t hash_map_num_buckets(const hash_map_t *hash_map) {
   assert(hash_map != NULL);
-  return hash_map->num_bucket;
+  return hash_map->capacity;
 }
 
 bool hash_map_has_key(const hash_map_t *hash_map, const void *key) {
   assert(hash_map != NULL);
 
-  hash_index_t hash_key = hash_map->hash_fn(key) % hash_map->num_bucket;
-  list_t *hash_bucket_list = hash_map->bucket[hash_key].list;
-
-  hash_map_entry_t *hash_map_entry = find_bucket_entry_(hash_bucket_list, key);
-  return (hash_map_entry != NULL);
+  return find_slot_(hash_map, key, hash_map->hash_fn(key)) != NULL;
 }
 
 bool hash_map_set(hash_map_t *hash_map, const void *key, void *data) {
   assert(hash_map != NULL);
   assert(data != NULL);
 
-  hash_index_t hash_key = hash_map->hash_fn(key) % hash_map->num_bucket;
-
-  if (hash_map->bucket[hash_key].list == NULL) {
-    hash_map->bucket[hash_key].list = list_new_internal(bucket_free_, hash_map->allocator);
-    if (hash_map->bucket[hash_key].list == NULL)
-        return false;
+  hash_index_t hash = hash_map->hash_fn(key);
+  hash_map_slot_t *slot = find_slot_(hash_map, key, hash);
+  if (slot) {
+    free_entry_(hash_map, &slot->entry);
+    slot->entry.key = key;
+    slot->entry.data = data;
+    return true;
   }
-  list_t *hash_bucket_list = hash_map->bucket[hash_key].list;
-
-  hash_map_entry_t *hash_map_entry = find_bucket_entry_(hash_bucket_list, key);
 
-  if (hash_map_entry) {
-    // Calls hash_map callback to delete the hash_map_entry.
-    UNUSED_ATTR bool rc = list_remove(hash_bucket_list, hash_map_entry);
-    assert(rc == true);
-  } else {
-    hash_map->hash_size++;
-  }
-  hash_map_entry = hash_map->allocator->alloc(sizeof(hash_map_entry_t));
-  if (hash_map_entry == NULL)
+  // Still insert when growing fails, as long as one slot stays empty to end
+  // the probe sequences.
+  if ((hash_map->hash_size + 1) * 4 > hash_map->capacity * 3 &&
+      !grow_(hash_map) && hash_map->hash_size + 1 >= hash_map->capacity)
     return false;
 
-  hash_map_entry->key = key;
-  hash_map_entry->data = data;
-  hash_map_entry->hash_map = hash_map;
-
-  return list_append(hash_bucket_list, hash_map_entry);
+  hash_map_slot_t new_slot = {
+    .entry = { .key = key, .data = data, .hash_map = hash_map },
+    .hash = hash,
+    .distance = 1,
+  };
+  insert_slot_(hash_map, new_slot);
+  hash_map->hash_size++;
+  return true;
 }
 
 bool hash_map_erase(hash_map_t *hash_map, const void *key) {
   assert(hash_map != NULL);
 
-  hash_index_t hash_key = hash_map->hash_fn(key) % hash_map->num_bucket;
-  list_t *hash_bucket_list = hash_map->bucket[hash_key].list;
-
-  hash_map_entry_t *hash_map_entry = find_bucket_entry_(hash_bucket_list, key);
-  if (hash_map_entry == NULL) {
+  hash_map_slot_t *slot = find_slot_(hash_map, key, hash_map->hash_fn(key));
+  if (slot == NULL)
     return false;
-  }
 
+  free_entry_(hash_map, &slot->entry);
   hash_map->hash_size--;
 
-  return list_remove(hash_bucket_list, hash_map_entry);
+  // Shift the entries that follow back by one, until one that is empty or
+  // already in its home slot.
+  size_t mask = hash_map->capacity - 1;
+  size_t i = slot - hash_map->slots;
+  size_t next = (i + 1) & mask;
+  while (hash_map->slots[next].distance > 1) {
+    hash_map->slots[i] = hash_map->slots[next];
+    hash_map->slots[i].distance--;
+    i = next;
+    next = (next + 1) & mask;
+  }
+  memset(&hash_map->slots[i], 0, sizeof(hash_map->slots[i]));
+  return true;
 }
 
 void *hash_map_get(const hash_map_t *hash_map, const void *key) {
   assert(hash_map != NULL);
 
-  hash_index_t hash_key = hash_map->hash_fn(key) % hash_map->num_bucket;
-  list_t *hash_bucket_list = hash_map->bucket[hash_key].list;
-
-  hash_map_entry_t *hash_map_entry = find_bucket_entry_(hash_bucket_list, key);
-  if (hash_map_entry != NULL)
-    return hash_map_entry->data;
+  hash_map_slot_t *slot = find_slot_(hash_map, key, hash_map->hash_fn(key));
+  if (slot != NULL)
+    return slot->entry.data;
 
   return NULL;
 }
@@ -187,58 +199,95 @@ void *hash_map_get(const hash_map_t *hash_map, const void *key) {
 void hash_map_clear(hash_map_t *hash_map) {
   assert(hash_map != NULL);
 
-  for (hash_index_t i = 0; i < hash_map->num_bucket; i++){
-    if (hash_map->bucket[i].list == NULL)
-      continue;
-    list_free(hash_map->bucket[i].list);
-    hash_map->bucket[i].list = NULL;
+  for (size_t i = 0; i < hash_map->capacity; i++) {
+    if (hash_map->slots[i].distance)
+      free_entry_(hash_map, &hash_map->slots[i].entry);
   }
+  memset(hash_map->slots, 0, sizeof(hash_map_slot_t) * hash_map->capacity);
+  hash_map->hash_size = 0;
 }
 
 void hash_map_foreach(hash_map_t *hash_map, hash_map_iter_cb callback, void *context) {
   assert(hash_map != NULL);
   assert(callback != NULL);
 
-  for (hash_index_t i = 0; i < hash_map->num_bucket; ++i){
-    if (hash_map->bucket[i].list == NULL)
+  for (size_t i = 0; i < hash_map->capacity; ++i) {
+    if (!hash_map->slots[i].distance)
       continue;
-    for (const list_node_t *iter = list_begin(hash_map->bucket[i].list);
-        iter != list_end(hash_map->bucket[i].list);
-        iter = list_next(iter)) {
-       hash_map_entry_t *hash_map_entry = (hash_map_entry_t *)list_node(iter);
-       if (!callback(hash_map_entry, context))
-        return;
-    }
+    if (!callback(&hash_map->slots[i].entry, context))
+      return;
   }
 }
 
-static void bucket_free_(void *data) {
-  assert(data != NULL);
-  hash_map_entry_t *hash_map_entry = (hash_map_entry_t *)data;
-  const hash_map_t *hash_map = hash_map_entry->hash_map;
-
-  if (hash_map->key_fn)
-    hash_map->key_fn((void *)hash_map_entry->key);
-  if (hash_map->data_fn)
-    hash_map->data_fn(hash_map_entry->data);
-  hash_map->allocator->free(hash_map_entry);
+// Fibonacci hashing: spreads hashes whose low bits are all alike (pointers,
+// small integers) over the whole table.
+static size_t home_slot_(const hash_map_t *hash_map, hash_index_t hash) {
+  return (size_t)(((uint64_t)hash * 0x9E3779B97F4A7C15ULL) >> (64 - hash_map->capacity_bits));
 }
 
-static hash_map_entry_t * find_bucket_entry_(list_t *hash_bucket_list,
-    const void *key) {
+static hash_map_slot_t *find_slot_(const hash_map_t *hash_map, const void *key,
+    hash_index_t hash) {
+  size_t mask = hash_map->capacity - 1;
+  size_t i = home_slot_(hash_map, hash);
+
+  for (uint32_t distance = 1; ; ++distance) {
+    hash_map_slot_t *slot = &hash_map->slots[i];
+    if (slot->distance < distance)
+      return NULL;
+    if (slot->hash == hash && hash_map->keys_are_equal(slot->entry.key, key))
+      return slot;
+    i = (i + 1) & mask;
+  }
+}
 
-  if (hash_bucket_list == NULL)
-    return NULL;
+static void insert_slot_(hash_map_t *hash_map, hash_map_slot_t slot) {
+  size_t mask = hash_map->capacity - 1;
+  size_t i = home_slot_(hash_map, slot.hash);
 
-  for (const list_node_t *iter = list_begin(hash_bucket_list);
-      iter != list_end(hash_bucket_list);
-      iter = list_next(iter)) {
-    hash_map_entry_t *hash_map_entry = (hash_map_entry_t *)list_node(iter);
-    if (hash_map_entry->hash_map->keys_are_equal(hash_map_entry->key, key)) {
-      return hash_map_entry;
+  for (;;) {
+    hash_map_slot_t *current = &hash_map->slots[i];
+    if (!current->distance) {
+      *current = slot;
+      return;
+    }
+    if (current->distance < slot.distance) {
+      hash_map_slot_t displaced = *current;
+      *current = slot;
+      slot = displaced;
     }
+    i = (i + 1) & mask;
+    slot.distance++;
   }
-  return NULL;
+}
+
+static bool grow_(hash_map_t *hash_map) {
+  size_t capacity = hash_map->capacity * 2;
+  hash_map_slot_t *slots = hash_map->allocator->alloc(sizeof(hash_map_slot_t) * capacity);
+  if (slots == NULL)
+    return false;
+
+  hash_map_slot_t *old_slots = hash_map->slots;
+  size_t old_capacity = hash_map->capacity;
+  hash_map->slots = slots;
+  hash_map->capacity = capacity;
+  hash_map->capacity_bits++;
+
+  for (size_t i = 0; i < old_capacity; ++i) {
+    if (!old_slots[i].distance)
+      continue;
+    hash_map_slot_t slot = old_slots[i];
+    slot.distance = 1;
+    insert_slot_(hash_map, slot);
+  }
+  hash_map->allocator->free(old_slots);
+  return true;
+}
+
+static void free_entry_(const hash_map_t *hash_map, hash_map_entry_t *entry) {
+  if (hash_map->key_fn)
+    hash_map->key_fn((void *)entry->key);
+  if (hash_map->data_fn)
+    hash_map->data_fn(entry->data);
 }
 
 static bool default_key_equality(const void *x, const void *y) {
@@ -0,0 +1,154 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "osi/include/metrics.h"
+
+typedef struct {
+  atomic_uint_least64_t count;
+  atomic_uint_least64_t total_us;
+  atomic_uint_least64_t max_us;
+  atomic_uint_least64_t buckets[METRICS_HISTOGRAM_NUM_BUCKETS];
+} histogram_t;
+
+static histogram_t histograms[METRICS_HISTOGRAM_COUNT];
+
+static const char *histogram_names[METRICS_HISTOGRAM_COUNT] = {
+  "HCI command round trip",
+  "ACL TX queueing delay",
+  "A2DP encode time",
+  "Alarm dispatch lateness",
+};
+
+static size_t bucket_index(uint64_t value_us) {
+  if (value_us == 0)
+    return 0;
+
+  // One more than the index of the highest bit set.
+  size_t index = 64 - __builtin_clzll(value_us);
+  if (index >= METRICS_HISTOGRAM_NUM_BUCKETS)
+    index = METRICS_HISTOGRAM_NUM_BUCKETS - 1;
+  return index;
+}
+
+// Returns the exclusive upper bound of the bucket at |index|, or 0 for the
+// last bucket which has none.
+static uint64_t bucket_limit_us(size_t index) {
+  if (index == METRICS_HISTOGRAM_NUM_BUCKETS - 1)
+    return 0;
+  return 1ULL << index;
+}
+
+void metrics_histogram_record(metrics_histogram_t histogram, uint64_t value_us) {
+  assert(histogram < METRICS_HISTOGRAM_COUNT);
+
+  histogram_t *h = &histograms[histogram];
+  atomic_fetch_add_explicit(&h->buckets[bucket_index(value_us)], 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&h->total_us, value_us, memory_order_relaxed);
+  atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+
+  uint64_t max = atomic_load_explicit(&h->max_us, memory_order_relaxed);
+  while (value_us > max &&
+         !atomic_compare_exchange_weak_explicit(&h->max_us, &max, value_us,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+  }
+}
+
+void metrics_histogram_get(metrics_histogram_t histogram,
+                           metrics_histogram_snapshot_t *snapshot) {
+  assert(histogram < METRICS_HISTOGRAM_COUNT);
+  assert(snapshot != NULL);
+
+  histogram_t *h = &histograms[histogram];
+  snapshot->count = atomic_load_explicit(&h->count, memory_order_relaxed);
+  snapshot->total_us = atomic_load_explicit(&h->total_us, memory_order_relaxed);
+  snapshot->max_us = atomic_load_explicit(&h->max_us, memory_order_relaxed);
+  for (size_t i = 0; i < METRICS_HISTOGRAM_NUM_BUCKETS; ++i)
+    snapshot->buckets[i] = atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+}
+
+void metrics_histogram_reset(void) {
+  for (size_t i = 0; i < METRICS_HISTOGRAM_COUNT; ++i) {
+    histogram_t *h = &histograms[i];
+    atomic_store_explicit(&h->count, 0, memory_order_relaxed);
+    atomic_store_explicit(&h->total_us, 0, memory_order_relaxed);
+    atomic_store_explicit(&h->max_us, 0, memory_order_relaxed);
+    for (size_t j = 0; j < METRICS_HISTOGRAM_NUM_BUCKETS; ++j)
+      atomic_store_explicit(&h->buckets[j], 0, memory_order_relaxed);
+  }
+}
+
+// Returns the upper bound of the bucket holding the |percent| percentile of
+// |snapshot|, or its maximum when that is the last bucket.
+static uint64_t percentile_us(const metrics_histogram_snapshot_t *snapshot,
+                              unsigned percent) {
+  // The buckets are read one by one and may add up to more than |count|.
+  uint64_t total = 0;
+  for (size_t i = 0; i < METRICS_HISTOGRAM_NUM_BUCKETS; ++i)
+    total += snapshot->buckets[i];
+
+  uint64_t rank = (total * percent + 99) / 100;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < METRICS_HISTOGRAM_NUM_BUCKETS; ++i) {
+    seen += snapshot->buckets[i];
+    if (seen >= rank && seen > 0) {
+      uint64_t limit = bucket_limit_us(i);
+      return (limit == 0 || limit > snapshot->max_us) ? snapshot->max_us : limit;
+    }
+  }
+  return snapshot->max_us;
+}
+
+void metrics_histogram_debug_dump(int fd) {
+  dprintf(fd, "\nBluetooth Latency Histograms (us):\n");
+
+  for (size_t i = 0; i < METRICS_HISTOGRAM_COUNT; ++i) {
+    metrics_histogram_snapshot_t snapshot;
+    metrics_histogram_get((metrics_histogram_t)i, &snapshot);
+
+    dprintf(fd, "  %s:\n", histogram_names[i]);
+    if (snapshot.count == 0) {
+      dprintf(fd, "    None\n");
+      continue;
+    }
+
+    dprintf(fd, "    Count: %" PRIu64 "  Avg: %" PRIu64 "  Max: %" PRIu64
+            "  P50: <=%" PRIu64 "  P90: <=%" PRIu64 "  P99: <=%" PRIu64 "\n",
+            snapshot.count, snapshot.total_us / snapshot.count, snapshot.max_us,
+            percentile_us(&snapshot, 50), percentile_us(&snapshot, 90),
+            percentile_us(&snapshot, 99));
+
+    dprintf(fd, "    Buckets:");
+    for (size_t j = 0; j < METRICS_HISTOGRAM_NUM_BUCKETS; ++j) {
+      if (snapshot.buckets[j] == 0)
+        continue;
+      uint64_t limit = bucket_limit_us(j);
+      if (limit == 0)
+        dprintf(fd, " >=%" PRIu64 ":%" PRIu64, bucket_limit_us(j - 1),
+                snapshot.buckets[j]);
+      else
+        dprintf(fd, " <%" PRIu64 ":%" PRIu64, limit, snapshot.buckets[j]);
+    }
+    dprintf(fd, "\n");
+  }
+}
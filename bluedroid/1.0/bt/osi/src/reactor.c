@@ -27,6 +27,7 @@
 #include <string.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "osi/include/allocator.h"
@@ -45,6 +46,7 @@ struct reactor_t {
   pthread_t run_thread;       // the pthread on which reactor_run is executing.
   bool is_running;            // indicates whether |run_thread| is valid.
   bool object_removed;
+  size_t max_events;          // the most events handled per wakeup.
 };
 
 struct reactor_object_t {
@@ -55,11 +57,17 @@ struct reactor_object_t {
 
   void (*read_ready)(void *context);   // function to call when the file descriptor becomes readable.
   void (*write_ready)(void *context);  // function to call when the file descriptor becomes writeable.
+
+  reactor_priority_t priority;         // the lane this object is serviced in.
+  reactor_object_stats_t stats;        // protected by |lock|.
 };
 
 static reactor_status_t run_reactor(reactor_t *reactor, int iterations);
+static uint64_t now_us(void);
+static int order_events(reactor_t *reactor, struct epoll_event *events, int count,
+    struct epoll_event **ordered);
+static void update_stats(reactor_object_stats_t *stats, uint64_t wait_us, uint64_t run_us);
 
-static const size_t MAX_EVENTS = 64;
 static const eventfd_t EVENT_REACTOR_STOP = 1;
 
 reactor_t *reactor_new(void) {
@@ -67,8 +75,9 @@ reactor_t *reactor_new(void) {
 
   ret->epoll_fd = INVALID_FD;
   ret->event_fd = INVALID_FD;
+  ret->max_events = REACTOR_MAX_EVENTS;
 
-  ret->epoll_fd = epoll_create(MAX_EVENTS);
+  ret->epoll_fd = epoll_create(REACTOR_MAX_EVENTS);
   if (ret->epoll_fd == INVALID_FD) {
     LOG_ERROR(LOG_TAG, "%s unable to create epoll instance: %s", __func__, strerror(errno));
     goto error;
@@ -129,6 +138,13 @@ void reactor_stop(reactor_t *reactor) {
   eventfd_write(reactor->event_fd, EVENT_REACTOR_STOP);
 }
 
+void reactor_set_max_events(reactor_t *reactor, size_t max_events) {
+  assert(reactor != NULL);
+  assert(max_events > 0 && max_events <= REACTOR_MAX_EVENTS);
+
+  reactor->max_events = max_events;
+}
+
 reactor_object_t *reactor_register(reactor_t *reactor,
     int fd, void *context,
     void (*read_ready)(void *context),
@@ -144,6 +160,7 @@ reactor_object_t *reactor_register(reactor_t *reactor,
   object->context = context;
   object->read_ready = read_ready;
   object->write_ready = write_ready;
+  object->priority = REACTOR_PRIORITY_NORMAL;
   pthread_mutex_init(&object->lock, NULL);
 
   struct epoll_event event;
@@ -190,6 +207,24 @@ bool reactor_change_registration(reactor_object_t *object,
   return true;
 }
 
+void reactor_object_set_priority(reactor_object_t *object, reactor_priority_t priority) {
+  assert(object != NULL);
+  assert(priority < REACTOR_PRIORITY_COUNT);
+
+  // Only read by the reactor thread while it sorts the ready objects, and a
+  // stale value there only delays the change by one wakeup.
+  object->priority = priority;
+}
+
+void reactor_object_get_stats(reactor_object_t *object, reactor_object_stats_t *stats) {
+  assert(object != NULL);
+  assert(stats != NULL);
+
+  pthread_mutex_lock(&object->lock);
+  *stats = object->stats;
+  pthread_mutex_unlock(&object->lock);
+}
+
 void reactor_unregister(reactor_object_t *obj) {
   assert(obj != NULL);
 
@@ -230,32 +265,37 @@ static reactor_status_t run_reactor(reactor_t *reactor, int iterations) {
   reactor->run_thread = pthread_self();
   reactor->is_running = true;
 
-  struct epoll_event events[MAX_EVENTS];
+  struct epoll_event events[REACTOR_MAX_EVENTS];
+  struct epoll_event *ordered[REACTOR_MAX_EVENTS];
   for (int i = 0; iterations == 0 || i < iterations; ++i) {
     pthread_mutex_lock(&reactor->list_lock);
     list_clear(reactor->invalidation_list);
     pthread_mutex_unlock(&reactor->list_lock);
 
     int ret;
-    OSI_NO_INTR(ret = epoll_wait(reactor->epoll_fd, events, MAX_EVENTS, -1));
+    OSI_NO_INTR(ret = epoll_wait(reactor->epoll_fd, events, reactor->max_events, -1));
     if (ret == -1) {
       LOG_ERROR(LOG_TAG, "%s error in epoll_wait: %s", __func__, strerror(errno));
       reactor->is_running = false;
       return REACTOR_STATUS_ERROR;
     }
 
-    for (int j = 0; j < ret; ++j) {
+    uint64_t wakeup_us = now_us();
+    int count = order_events(reactor, events, ret, ordered);
+
+    for (int j = 0; j < count; ++j) {
       // The event file descriptor is the only one that registers with
       // a NULL data pointer. We use the NULL to identify it and break
       // out of the reactor loop.
-      if (events[j].data.ptr == NULL) {
+      if (ordered[j]->data.ptr == NULL) {
         eventfd_t value;
         eventfd_read(reactor->event_fd, &value);
         reactor->is_running = false;
         return REACTOR_STATUS_STOP;
       }
 
-      reactor_object_t *object = (reactor_object_t *)events[j].data.ptr;
+      reactor_object_t *object = (reactor_object_t *)ordered[j]->data.ptr;
+      uint32_t ready_events = ordered[j]->events;
 
       pthread_mutex_lock(&reactor->list_lock);
       if (list_contains(reactor->invalidation_list, object)) {
@@ -267,11 +307,15 @@ static reactor_status_t run_reactor(reactor_t *reactor, int iterations) {
       pthread_mutex_lock(&object->lock);
       pthread_mutex_unlock(&reactor->list_lock);
 
+      uint64_t start_us = now_us();
       reactor->object_removed = false;
-      if (events[j].events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP | EPOLLERR) && object->read_ready)
+      if (ready_events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP | EPOLLERR) && object->read_ready)
         object->read_ready(object->context);
-      if (!reactor->object_removed && events[j].events & EPOLLOUT && object->write_ready)
+      if (!reactor->object_removed && ready_events & EPOLLOUT && object->write_ready)
         object->write_ready(object->context);
+
+      if (!reactor->object_removed)
+        update_stats(&object->stats, start_us - wakeup_us, now_us() - start_us);
       pthread_mutex_unlock(&object->lock);
 
       if (reactor->object_removed) {
@@ -284,3 +328,63 @@ static reactor_status_t run_reactor(reactor_t *reactor, int iterations) {
   reactor->is_running = false;
   return REACTOR_STATUS_DONE;
 }
+
+static uint64_t now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// Fills |ordered| with the |count| |events| sorted by the priority of their
+// objects, keeping the kernel's order within a priority. Events of objects
+// that were unregistered are left out. The stop event goes first. Returns the
+// number of events in |ordered|.
+static int order_events(reactor_t *reactor, struct epoll_event *events, int count,
+    struct epoll_event **ordered) {
+  int lane_count[REACTOR_PRIORITY_COUNT] = { 0 };
+  uint8_t lane[REACTOR_MAX_EVENTS];
+
+  // Holding the list lock keeps other threads from freeing the objects
+  // while their priority is read.
+  pthread_mutex_lock(&reactor->list_lock);
+  for (int i = 0; i < count; ++i) {
+    reactor_object_t *object = (reactor_object_t *)events[i].data.ptr;
+    if (object == NULL)
+      lane[i] = REACTOR_PRIORITY_HIGH;
+    else if (list_contains(reactor->invalidation_list, object))
+      lane[i] = REACTOR_PRIORITY_COUNT;
+    else
+      lane[i] = object->priority;
+
+    if (lane[i] < REACTOR_PRIORITY_COUNT)
+      lane_count[lane[i]]++;
+  }
+  pthread_mutex_unlock(&reactor->list_lock);
+
+  int next[REACTOR_PRIORITY_COUNT];
+  int total = 0;
+  for (int p = 0; p < REACTOR_PRIORITY_COUNT; ++p) {
+    next[p] = total;
+    total += lane_count[p];
+  }
+
+  for (int i = 0; i < count; ++i) {
+    if (events[i].data.ptr == NULL)
+      ordered[next[REACTOR_PRIORITY_HIGH]++] = &events[i];
+  }
+  for (int i = 0; i < count; ++i) {
+    if (events[i].data.ptr != NULL && lane[i] < REACTOR_PRIORITY_COUNT)
+      ordered[next[lane[i]]++] = &events[i];
+  }
+  return total;
+}
+
+static void update_stats(reactor_object_stats_t *stats, uint64_t wait_us, uint64_t run_us) {
+  stats->dispatch_count++;
+  stats->total_wait_us += wait_us;
+  stats->total_run_us += run_us;
+  if (wait_us > stats->max_wait_us)
+    stats->max_wait_us = wait_us;
+  if (run_us > stats->max_run_us)
+    stats->max_run_us = run_us;
+}
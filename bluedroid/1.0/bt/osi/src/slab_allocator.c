@@ -0,0 +1,290 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "osi/include/osi.h"
+#include "osi/include/slab_allocator.h"
+
+#define BLOCK_MAGIC 0x51ab0ccu
+#define LARGE_CLASS UINT32_MAX
+
+// Precedes every block; keeps the payload as aligned as malloc's.
+typedef struct {
+  uint32_t magic;
+  uint32_t size_class;
+  uint64_t reserved;
+} block_header_t;
+
+COMPILE_ASSERT(sizeof(block_header_t) == 16);
+
+// Overlays the payload of a free block.
+typedef struct free_block_t {
+  struct free_block_t *next;
+} free_block_t;
+
+// Payload sizes of the size classes. The larger ones are the common stack
+// buffers with a BT_HDR and the allocation tracker canaries.
+static const size_t class_sizes[] = {
+  32,
+  64,
+  128,
+  256,
+  512,
+  704,    // BT_SMALL_BUFFER_SIZE: HCI commands and events
+  1024,
+  1728,   // L2CAP_MTU_SIZE: L2CAP fragments
+  2048,
+  4160,   // BT_DEFAULT_BUFFER_SIZE: ACL packets and A2DP frames
+};
+
+#define NUM_CLASSES ARRAY_SIZE(class_sizes)
+
+// Slabs are at least this large, and hold at least MIN_SLAB_BLOCKS blocks.
+#define SLAB_SIZE (64 * 1024)
+#define MIN_SLAB_BLOCKS 8
+
+// Thread caches hold up to about this many bytes of each class.
+#define THREAD_CACHE_BYTES (32 * 1024)
+#define THREAD_CACHE_MIN_BLOCKS 4
+#define THREAD_CACHE_MAX_BLOCKS 64
+
+typedef struct {
+  pthread_mutex_t lock;
+  free_block_t *free_list;        // Guarded by |lock|.
+  size_t free_count;              // Guarded by |lock|.
+  size_t slab_count;              // Guarded by |lock|.
+  size_t block_count;             // Guarded by |lock|.
+  size_t cache_limit;             // Per thread, constant.
+  atomic_size_t alloc_count;
+  atomic_size_t free_count_total;
+} size_class_t;
+
+typedef struct {
+  free_block_t *head;
+  size_t count;
+} cache_list_t;
+
+typedef struct {
+  cache_list_t lists[NUM_CLASSES];
+} thread_cache_t;
+
+static size_class_t size_classes[NUM_CLASSES];
+static atomic_size_t large_alloc_count;
+static atomic_size_t large_free_count;
+
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+static pthread_key_t thread_cache_key;
+static __thread thread_cache_t *thread_cache;
+
+static void thread_cache_free(void *context);
+
+static void init(void) {
+  for (size_t i = 0; i < NUM_CLASSES; ++i) {
+    size_class_t *sc = &size_classes[i];
+    pthread_mutex_init(&sc->lock, NULL);
+    size_t limit = THREAD_CACHE_BYTES / class_sizes[i];
+    if (limit < THREAD_CACHE_MIN_BLOCKS)
+      limit = THREAD_CACHE_MIN_BLOCKS;
+    if (limit > THREAD_CACHE_MAX_BLOCKS)
+      limit = THREAD_CACHE_MAX_BLOCKS;
+    sc->cache_limit = limit;
+  }
+  pthread_key_create(&thread_cache_key, thread_cache_free);
+}
+
+static thread_cache_t *get_thread_cache(void) {
+  if (thread_cache == NULL) {
+    pthread_once(&init_once, init);
+    thread_cache = calloc(1, sizeof(thread_cache_t));
+    assert(thread_cache);
+    // Only used to flush the cache when the thread exits.
+    pthread_setspecific(thread_cache_key, thread_cache);
+  }
+  return thread_cache;
+}
+
+// Returns the smallest class that holds |size| bytes, or LARGE_CLASS.
+static uint32_t class_for_size(size_t size) {
+  for (uint32_t i = 0; i < NUM_CLASSES; ++i)
+    if (size <= class_sizes[i])
+      return i;
+  return LARGE_CLASS;
+}
+
+// Carves a new slab into blocks for |sc|. |sc->lock| must be held.
+static void grow(size_class_t *sc, uint32_t size_class) {
+  size_t block_size = sizeof(block_header_t) + class_sizes[size_class];
+  size_t count = SLAB_SIZE / block_size;
+  if (count < MIN_SLAB_BLOCKS)
+    count = MIN_SLAB_BLOCKS;
+
+  char *slab = malloc(count * block_size);
+  assert(slab);
+
+  for (size_t i = 0; i < count; ++i) {
+    block_header_t *header = (block_header_t *)(slab + i * block_size);
+    header->magic = BLOCK_MAGIC;
+    header->size_class = size_class;
+    free_block_t *block = (free_block_t *)(header + 1);
+    block->next = sc->free_list;
+    sc->free_list = block;
+  }
+  sc->free_count += count;
+  sc->block_count += count;
+  sc->slab_count++;
+}
+
+// Moves half a cache worth of blocks from the shared list to |list|.
+static void refill(cache_list_t *list, uint32_t size_class) {
+  size_class_t *sc = &size_classes[size_class];
+  size_t wanted = sc->cache_limit / 2;
+
+  pthread_mutex_lock(&sc->lock);
+  if (sc->free_count < wanted)
+    grow(sc, size_class);
+  for (size_t i = 0; i < wanted; ++i) {
+    free_block_t *block = sc->free_list;
+    sc->free_list = block->next;
+    block->next = list->head;
+    list->head = block;
+  }
+  sc->free_count -= wanted;
+  pthread_mutex_unlock(&sc->lock);
+
+  list->count += wanted;
+}
+
+// Moves |count| blocks from |list| back to the shared list.
+static void flush(cache_list_t *list, uint32_t size_class, size_t count) {
+  if (count == 0)
+    return;
+
+  free_block_t *first = list->head;
+  free_block_t *last = first;
+  for (size_t i = 1; i < count; ++i)
+    last = last->next;
+  list->head = last->next;
+  list->count -= count;
+
+  size_class_t *sc = &size_classes[size_class];
+  pthread_mutex_lock(&sc->lock);
+  last->next = sc->free_list;
+  sc->free_list = first;
+  sc->free_count += count;
+  pthread_mutex_unlock(&sc->lock);
+}
+
+static void thread_cache_free(void *context) {
+  thread_cache_t *cache = context;
+  for (uint32_t i = 0; i < NUM_CLASSES; ++i)
+    flush(&cache->lists[i], i, cache->lists[i].count);
+  if (thread_cache == cache)
+    thread_cache = NULL;
+  free(cache);
+}
+
+void *slab_malloc(size_t size) {
+  uint32_t size_class = class_for_size(size);
+  if (size_class == LARGE_CLASS) {
+    block_header_t *header = malloc(sizeof(block_header_t) + size);
+    assert(header);
+    header->magic = BLOCK_MAGIC;
+    header->size_class = LARGE_CLASS;
+    atomic_fetch_add_explicit(&large_alloc_count, 1, memory_order_relaxed);
+    return header + 1;
+  }
+
+  cache_list_t *list = &get_thread_cache()->lists[size_class];
+  if (list->head == NULL)
+    refill(list, size_class);
+
+  free_block_t *block = list->head;
+  list->head = block->next;
+  list->count--;
+  atomic_fetch_add_explicit(&size_classes[size_class].alloc_count, 1, memory_order_relaxed);
+  return block;
+}
+
+void *slab_calloc(size_t size) {
+  void *ptr = slab_malloc(size);
+  memset(ptr, 0, size);
+  return ptr;
+}
+
+void slab_free(void *ptr) {
+  if (ptr == NULL)
+    return;
+
+  block_header_t *header = (block_header_t *)ptr - 1;
+  assert(header->magic == BLOCK_MAGIC);
+  uint32_t size_class = header->size_class;
+  if (size_class == LARGE_CLASS) {
+    atomic_fetch_add_explicit(&large_free_count, 1, memory_order_relaxed);
+    free(header);
+    return;
+  }
+  assert(size_class < NUM_CLASSES);
+
+  cache_list_t *list = &get_thread_cache()->lists[size_class];
+  free_block_t *block = ptr;
+  block->next = list->head;
+  list->head = block;
+  list->count++;
+  atomic_fetch_add_explicit(&size_classes[size_class].free_count_total, 1, memory_order_relaxed);
+
+  size_t limit = size_classes[size_class].cache_limit;
+  if (list->count > limit)
+    flush(list, size_class, list->count - limit / 2);
+}
+
+void slab_allocator_debug_dump(int fd) {
+  pthread_once(&init_once, init);
+
+  dprintf(fd, "\nBluetooth Slab Allocator Statistics:\n");
+  dprintf(fd, "  %8s %10s %10s %10s %8s %10s %10s\n",
+          "Size", "Allocs", "Frees", "In use", "Slabs", "Reserved", "Shared free");
+  size_t total_reserved = 0;
+  for (size_t i = 0; i < NUM_CLASSES; ++i) {
+    size_class_t *sc = &size_classes[i];
+    // Frees first, so that a concurrent free does not make "In use" negative.
+    size_t frees = atomic_load_explicit(&sc->free_count_total, memory_order_relaxed);
+    size_t allocs = atomic_load_explicit(&sc->alloc_count, memory_order_relaxed);
+
+    pthread_mutex_lock(&sc->lock);
+    size_t slabs = sc->slab_count;
+    size_t reserved = sc->block_count * (sizeof(block_header_t) + class_sizes[i]);
+    size_t shared_free = sc->free_count;
+    pthread_mutex_unlock(&sc->lock);
+
+    total_reserved += reserved;
+    dprintf(fd, "  %8zu %10zu %10zu %10zu %8zu %10zu %10zu\n",
+            class_sizes[i], allocs, frees, allocs - frees, slabs, reserved, shared_free);
+  }
+  size_t large_frees = atomic_load_explicit(&large_free_count, memory_order_relaxed);
+  size_t large_allocs = atomic_load_explicit(&large_alloc_count, memory_order_relaxed);
+  dprintf(fd, "  %8s %10zu %10zu %10zu\n",
+          "Large", large_allocs, large_frees, large_allocs - large_frees);
+  dprintf(fd, "  Total reserved in slabs (bytes): %zu\n", total_reserved);
+}
@@ -0,0 +1,270 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2014 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#define LOG_TAG "bt_osi_thread_pool"
+
+#include "osi/include/thread_pool.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/prctl.h>
+
+#include "osi/include/allocator.h"
+#include "osi/include/list.h"
+#include "osi/include/log.h"
+#include "osi/include/semaphore.h"
+#include "osi/include/time.h"
+
+typedef struct {
+  thread_pool_t *pool;
+  size_t index;
+  bool started;
+  pthread_t pthread;
+  char name[THREAD_NAME_MAX + 1];
+
+  // Protects |queues|.
+  pthread_mutex_t lock;
+  list_t *queues[THREAD_POOL_PRIORITY_COUNT];
+} worker_t;
+
+struct thread_pool_t {
+  worker_t *workers;
+  size_t num_workers;
+
+  // Posted once for each task queued and, when the pool is freed, once for
+  // each worker. A worker which takes a post but finds no task exits.
+  semaphore_t *pending;
+
+  // Protects the fields below.
+  pthread_mutex_t lock;
+  bool stopping;
+  size_t next_worker;
+  thread_pool_stats_t stats;
+};
+
+typedef struct {
+  thread_fn func;
+  void *context;
+  uint64_t queued_us;
+} task_t;
+
+static void *run_worker(void *context);
+static worker_t *current_worker(thread_pool_t *pool);
+static task_t *take_task(worker_t *worker, bool *stolen);
+static void stop_workers(thread_pool_t *pool);
+
+thread_pool_t *thread_pool_new(const char *name, size_t num_workers) {
+  assert(name != NULL);
+  assert(num_workers != 0);
+
+  thread_pool_t *pool = osi_calloc(sizeof(thread_pool_t));
+  pool->workers = osi_calloc(sizeof(worker_t) * num_workers);
+  pool->num_workers = num_workers;
+  pthread_mutex_init(&pool->lock, NULL);
+
+  for (size_t i = 0; i < num_workers; ++i) {
+    worker_t *worker = &pool->workers[i];
+    worker->pool = pool;
+    worker->index = i;
+    snprintf(worker->name, sizeof(worker->name), "%s%zu", name, i);
+    pthread_mutex_init(&worker->lock, NULL);
+    // Tasks are freed by the worker which runs them.
+    for (size_t p = 0; p < THREAD_POOL_PRIORITY_COUNT; ++p)
+      worker->queues[p] = list_new(NULL);
+  }
+
+  pool->pending = semaphore_new(0);
+  if (!pool->pending)
+    goto error;
+
+  for (size_t i = 0; i < num_workers; ++i) {
+    worker_t *worker = &pool->workers[i];
+    if (pthread_create(&worker->pthread, NULL, run_worker, worker) != 0) {
+      LOG_ERROR(LOG_TAG, "%s unable to start worker %s", __func__, worker->name);
+      goto error;
+    }
+    worker->started = true;
+  }
+
+  return pool;
+
+error:;
+  thread_pool_free(pool);
+  return NULL;
+}
+
+void thread_pool_free(thread_pool_t *pool) {
+  if (!pool)
+    return;
+
+  stop_workers(pool);
+
+  for (size_t i = 0; i < pool->num_workers; ++i) {
+    worker_t *worker = &pool->workers[i];
+    for (size_t p = 0; p < THREAD_POOL_PRIORITY_COUNT; ++p) {
+      assert(list_is_empty(worker->queues[p]));
+      list_free(worker->queues[p]);
+    }
+    pthread_mutex_destroy(&worker->lock);
+  }
+
+  semaphore_free(pool->pending);
+  pthread_mutex_destroy(&pool->lock);
+  osi_free(pool->workers);
+  osi_free(pool);
+}
+
+bool thread_pool_post(thread_pool_t *pool, thread_pool_priority_t priority,
+                      thread_fn func, void *context) {
+  assert(pool != NULL);
+  assert(func != NULL);
+  assert(priority < THREAD_POOL_PRIORITY_COUNT);
+
+  task_t *task = osi_malloc(sizeof(task_t));
+  task->func = func;
+  task->context = context;
+  task->queued_us = time_get_os_boottime_us();
+
+  pthread_mutex_lock(&pool->lock);
+  if (pool->stopping) {
+    pthread_mutex_unlock(&pool->lock);
+    osi_free(task);
+    return false;
+  }
+
+  // A task posted by a worker stays on that worker unless another one is
+  // idle; others are spread over the workers in turn.
+  worker_t *worker = current_worker(pool);
+  if (!worker) {
+    worker = &pool->workers[pool->next_worker];
+    pool->next_worker = (pool->next_worker + 1) % pool->num_workers;
+  }
+
+  pthread_mutex_lock(&worker->lock);
+  list_append(worker->queues[priority], task);
+  pthread_mutex_unlock(&worker->lock);
+
+  if (++pool->stats.queue_depth > pool->stats.max_queue_depth)
+    pool->stats.max_queue_depth = pool->stats.queue_depth;
+  pthread_mutex_unlock(&pool->lock);
+
+  semaphore_post(pool->pending);
+  return true;
+}
+
+void thread_pool_get_stats(thread_pool_t *pool, thread_pool_stats_t *stats) {
+  assert(pool != NULL);
+  assert(stats != NULL);
+
+  pthread_mutex_lock(&pool->lock);
+  *stats = pool->stats;
+  pthread_mutex_unlock(&pool->lock);
+}
+
+static void *run_worker(void *context) {
+  assert(context != NULL);
+
+  worker_t *worker = (worker_t *)context;
+  thread_pool_t *pool = worker->pool;
+
+  if (prctl(PR_SET_NAME, (unsigned long)worker->name) == -1)
+    LOG_WARN(LOG_TAG, "%s unable to set thread name: %s", __func__, strerror(errno));
+
+  for (;;) {
+    semaphore_wait(pool->pending);
+
+    bool stolen = false;
+    task_t *task = take_task(worker, &stolen);
+    if (!task)
+      break;
+
+    uint64_t wait_us = time_get_os_boottime_us() - task->queued_us;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stats.queue_depth--;
+    pool->stats.tasks_run++;
+    if (stolen)
+      pool->stats.tasks_stolen++;
+    pool->stats.total_wait_us += wait_us;
+    if (wait_us > pool->stats.max_wait_us)
+      pool->stats.max_wait_us = wait_us;
+    pthread_mutex_unlock(&pool->lock);
+
+    task->func(task->context);
+    osi_free(task);
+  }
+
+  return NULL;
+}
+
+static worker_t *current_worker(thread_pool_t *pool) {
+  pthread_t self = pthread_self();
+  for (size_t i = 0; i < pool->num_workers; ++i) {
+    if (pool->workers[i].started && pthread_equal(self, pool->workers[i].pthread))
+      return &pool->workers[i];
+  }
+  return NULL;
+}
+
+// Takes the oldest task of the highest priority queued anywhere in the
+// pool, looking at |worker|'s own queue first at each priority.
+static task_t *take_task(worker_t *worker, bool *stolen) {
+  thread_pool_t *pool = worker->pool;
+
+  for (size_t p = 0; p < THREAD_POOL_PRIORITY_COUNT; ++p) {
+    for (size_t i = 0; i < pool->num_workers; ++i) {
+      worker_t *victim = &pool->workers[(worker->index + i) % pool->num_workers];
+
+      task_t *task = NULL;
+      pthread_mutex_lock(&victim->lock);
+      if (!list_is_empty(victim->queues[p])) {
+        task = list_front(victim->queues[p]);
+        list_remove(victim->queues[p], task);
+      }
+      pthread_mutex_unlock(&victim->lock);
+
+      if (task) {
+        *stolen = (victim != worker);
+        return task;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+static void stop_workers(thread_pool_t *pool) {
+  pthread_mutex_lock(&pool->lock);
+  pool->stopping = true;
+  pthread_mutex_unlock(&pool->lock);
+
+  for (size_t i = 0; i < pool->num_workers; ++i) {
+    if (pool->workers[i].started)
+      semaphore_post(pool->pending);
+  }
+
+  for (size_t i = 0; i < pool->num_workers; ++i) {
+    if (pool->workers[i].started) {
+      pthread_join(pool->workers[i].pthread, NULL);
+      pool->workers[i].started = false;
+    }
+  }
+}
@@ -301,6 +301,37 @@ TEST_F(AlarmTest, test_callback_ordering) {
 
 // Test whether the callbacks are involed in the expected order on a
 // separate queue.
+// Alarms set in reverse order of their deadlines, with every other one
+// canceled, fire in deadline order.
+TEST_F(AlarmTest, test_callback_ordering_by_deadline) {
+  alarm_t *alarms[100];
+
+  for (int i = 0; i < 100; i++) {
+    const std::string alarm_name = "alarm_test.test_callback_ordering_by_deadline[" +
+      std::to_string(i) + "]";
+    alarms[i] = alarm_new(alarm_name.c_str());
+  }
+
+  for (int i = 99; i >= 0; i--) {
+    alarm_set(alarms[i], 50 + i, ordered_cb, INT_TO_PTR(i / 2));
+  }
+
+  for (int i = 1; i < 100; i += 2)
+    alarm_cancel(alarms[i]);
+
+  for (int i = 1; i <= 50; i++) {
+    semaphore_wait(semaphore);
+    EXPECT_GE(cb_counter, i);
+  }
+  EXPECT_EQ(cb_counter, 50);
+  EXPECT_EQ(cb_misordered_counter, 0);
+
+  for (int i = 0; i < 100; i++)
+    alarm_free(alarms[i]);
+
+  EXPECT_FALSE(WakeLockHeld());
+}
+
 TEST_F(AlarmTest, test_callback_ordering_on_queue) {
   alarm_t *alarms[100];
   fixed_queue_t *queue = fixed_queue_new(SIZE_MAX);
@@ -16,6 +16,8 @@
  *
  ******************************************************************************/
 #include <cstring>
+#include <pthread.h>
+#include <time.h>
 
 #include <gtest/gtest.h>
 
@@ -23,6 +25,9 @@
 
 extern "C" {
 #include "osi/include/allocator.h"
+#include "osi/include/fixed_queue.h"
+#include "osi/include/osi.h"
+#include "osi/include/slab_allocator.h"
 }
 
 class AllocatorTest : public AllocationTestHarness {};
@@ -52,3 +57,98 @@ TEST_F(AllocatorTest, test_osi_strndup) {
   EXPECT_EQ(0, strcmp(str, copy_str));
   osi_free(copy_str);
 }
+
+TEST_F(AllocatorTest, test_allocator_slab) {
+  // Every size class, the sizes at their limits, and a large block
+  static const size_t sizes[] = { 0, 1, 32, 33, 660, 704, 705, 1691, 4112, 4160, 4161, 65536 };
+  void *ptrs[ARRAY_SIZE(sizes)];
+
+  for (size_t i = 0; i < ARRAY_SIZE(sizes); i++) {
+    ptrs[i] = allocator_slab.alloc(sizes[i]);
+    ASSERT_TRUE(ptrs[i] != NULL);
+    EXPECT_EQ(0U, (uintptr_t)ptrs[i] % sizeof(void *));
+    memset(ptrs[i], (int)i, sizes[i]);
+  }
+  for (size_t i = 0; i < ARRAY_SIZE(sizes); i++) {
+    for (size_t j = 0; j < sizes[i]; j++)
+      ASSERT_EQ((uint8_t)i, ((uint8_t *)ptrs[i])[j]);
+    allocator_slab.free(ptrs[i]);
+  }
+  allocator_slab.free(NULL);
+
+  // A freed block is reused
+  void *ptr = slab_malloc(100);
+  slab_free(ptr);
+  EXPECT_EQ(ptr, slab_malloc(100));
+  slab_free(ptr);
+
+  uint8_t *zeroed = (uint8_t *)slab_calloc(4000);
+  for (size_t i = 0; i < 4000; i++)
+    ASSERT_EQ(0, zeroed[i]);
+  slab_free(zeroed);
+}
+
+static const size_t THROUGHPUT_ROUNDS = 20000;
+static const size_t THROUGHPUT_BURST = 32;
+// Typical sizes of HCI events, A2DP frames, L2CAP fragments and ACL packets
+static const size_t THROUGHPUT_SIZES[] = { 64, 660, 1021, 1691, 4112 };
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Allocates and frees bursts of buffers, returns the nanoseconds per buffer.
+static double measure_bursts(const allocator_t *allocator) {
+  void *buffers[THROUGHPUT_BURST];
+  uint64_t start = now_ns();
+  for (size_t round = 0; round < THROUGHPUT_ROUNDS; round++) {
+    for (size_t i = 0; i < THROUGHPUT_BURST; i++) {
+      buffers[i] = allocator->alloc(THROUGHPUT_SIZES[(round + i) % ARRAY_SIZE(THROUGHPUT_SIZES)]);
+      *(uint8_t *)buffers[i] = 0;
+    }
+    for (size_t i = 0; i < THROUGHPUT_BURST; i++)
+      allocator->free(buffers[i]);
+  }
+  return (double)(now_ns() - start) / (THROUGHPUT_ROUNDS * THROUGHPUT_BURST);
+}
+
+TEST_F(AllocatorTest, test_allocator_slab_throughput) {
+  double malloc_ns = measure_bursts(&allocator_malloc);
+  double slab_ns = measure_bursts(&allocator_slab);
+  printf("osi_malloc: %.1f ns per buffer, slab: %.1f ns per buffer\n", malloc_ns, slab_ns);
+}
+
+typedef struct {
+  const allocator_t *allocator;
+  fixed_queue_t *queue;
+} throughput_context_t;
+
+static void *throughput_producer(void *context) {
+  throughput_context_t *ctx = (throughput_context_t *)context;
+  for (size_t i = 0; i < THROUGHPUT_ROUNDS * THROUGHPUT_BURST; i++)
+    fixed_queue_enqueue(ctx->queue,
+        ctx->allocator->alloc(THROUGHPUT_SIZES[i % ARRAY_SIZE(THROUGHPUT_SIZES)]));
+  return NULL;
+}
+
+// Buffers allocated on one thread and freed on another, as HCI packets are.
+static double measure_cross_thread(const allocator_t *allocator) {
+  throughput_context_t ctx = { allocator, fixed_queue_new_ring(THROUGHPUT_BURST) };
+  pthread_t thread;
+  uint64_t start = now_ns();
+  pthread_create(&thread, NULL, throughput_producer, &ctx);
+  for (size_t i = 0; i < THROUGHPUT_ROUNDS * THROUGHPUT_BURST; i++)
+    allocator->free(fixed_queue_dequeue(ctx.queue));
+  pthread_join(thread, NULL);
+  double ns = (double)(now_ns() - start) / (THROUGHPUT_ROUNDS * THROUGHPUT_BURST);
+  fixed_queue_free(ctx.queue, NULL);
+  return ns;
+}
+
+TEST_F(AllocatorTest, test_allocator_slab_cross_thread_throughput) {
+  double malloc_ns = measure_cross_thread(&allocator_malloc);
+  double slab_ns = measure_cross_thread(&allocator_slab);
+  printf("osi_malloc: %.1f ns per buffer, slab: %.1f ns per buffer\n", malloc_ns, slab_ns);
+}
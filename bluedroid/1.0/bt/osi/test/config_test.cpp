@@ -196,8 +196,102 @@ TEST_F(ConfigTest, config_section_end) {
   config_free(config);
 }
 
+static bool count_entry(const char *section, const char *key, const char *value, void *context) {
+  int *counts = (int *)context;
+  if (!strcmp(section, "DID")) {
+    ++counts[1];
+    if (!strcmp(key, "version"))
+      EXPECT_STREQ("0x1436", value);
+  } else {
+    EXPECT_STREQ(CONFIG_DEFAULT_SECTION, section);
+    ++counts[0];
+  }
+  return true;
+}
+
+static bool stop_at_first_entry(const char *, const char *, const char *, void *context) {
+  ++*(int *)context;
+  return false;
+}
+
+TEST_F(ConfigTest, config_foreach) {
+  config_t *config = config_new(CONFIG_FILE);
+  int counts[2] = { 0, 0 };
+  EXPECT_TRUE(config_foreach(config, count_entry, counts));
+  EXPECT_EQ(1, counts[0]);
+  EXPECT_EQ(4, counts[1]);
+
+  int calls = 0;
+  EXPECT_FALSE(config_foreach(config, stop_at_first_entry, &calls));
+  EXPECT_EQ(1, calls);
+  config_free(config);
+}
+
+TEST_F(ConfigTest, config_foreach_empty) {
+  config_t *config = config_new_empty();
+  int calls = 0;
+  EXPECT_TRUE(config_foreach(config, stop_at_first_entry, &calls));
+  EXPECT_EQ(0, calls);
+  config_free(config);
+}
+
 TEST_F(ConfigTest, config_save_basic) {
   config_t *config = config_new(CONFIG_FILE);
   EXPECT_TRUE(config_save(config, CONFIG_FILE));
   config_free(config);
 }
+
+TEST_F(ConfigTest, config_generation) {
+  config_t *config = config_new(CONFIG_FILE);
+  uint64_t generation = config_generation(config);
+
+  config_set_string(config, "DID", "version", "0x1436");
+  EXPECT_EQ(generation, config_generation(config));
+
+  config_set_string(config, "DID", "version", "0x1437");
+  EXPECT_NE(generation, config_generation(config));
+
+  generation = config_generation(config);
+  EXPECT_FALSE(config_remove_key(config, "DID", "meow"));
+  EXPECT_EQ(generation, config_generation(config));
+  EXPECT_TRUE(config_remove_key(config, "DID", "version"));
+  EXPECT_NE(generation, config_generation(config));
+  config_free(config);
+}
+
+TEST_F(ConfigTest, config_is_saved) {
+  config_t *config = config_new(CONFIG_FILE);
+  EXPECT_FALSE(config_is_saved(config, CONFIG_FILE));
+  EXPECT_TRUE(config_save(config, CONFIG_FILE));
+  EXPECT_TRUE(config_is_saved(config, CONFIG_FILE));
+
+  config_set_string(config, "DID", "version", "0x1437");
+  EXPECT_FALSE(config_is_saved(config, CONFIG_FILE));
+
+  config_t *empty = config_new_empty();
+  EXPECT_FALSE(config_is_saved(empty, CONFIG_FILE));
+  EXPECT_FALSE(config_is_saved(config, "/meow"));
+  config_free(empty);
+  config_free(config);
+}
+
+TEST_F(ConfigTest, config_many_sections) {
+  config_t *config = config_new_empty();
+  char section[32];
+  for (int i = 0; i < 500; ++i) {
+    snprintf(section, sizeof(section), "00:00:00:00:%02x:%02x", i >> 8, i & 0xff);
+    config_set_int(config, section, "DevType", i);
+  }
+
+  for (int i = 0; i < 500; i += 2) {
+    snprintf(section, sizeof(section), "00:00:00:00:%02x:%02x", i >> 8, i & 0xff);
+    EXPECT_TRUE(config_remove_section(config, section));
+  }
+
+  for (int i = 0; i < 500; ++i) {
+    snprintf(section, sizeof(section), "00:00:00:00:%02x:%02x", i >> 8, i & 0xff);
+    EXPECT_EQ(i % 2 == 1, config_has_section(config, section));
+    EXPECT_EQ(i % 2 == 1 ? i : -1, config_get_int(config, section, "DevType", -1));
+  }
+  config_free(config);
+}
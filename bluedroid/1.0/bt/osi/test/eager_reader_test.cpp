@@ -22,6 +22,7 @@
 
 extern "C" {
 #include <stdint.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "osi/include/allocator.h"
@@ -145,3 +146,90 @@ TEST_F(EagerReaderTest, test_large_data_multibyte) {
   eager_reader_free(reader);
   thread_free(read_thread);
 }
+
+// Frames used by the framed reader tests: one length byte, followed by that
+// many bytes all equal to the frame's sequence number.
+static size_t test_frame_length(const uint8_t *data, size_t length) {
+  if (length < 1)
+    return 0;
+  return 1 + data[0];
+}
+
+static size_t test_frame_payload(int sequence) {
+  return sequence % 23;
+}
+
+static size_t write_test_frames(uint8_t *buffer, int first, int count) {
+  size_t length = 0;
+  for (int i = first; i < first + count; i++) {
+    size_t payload = test_frame_payload(i);
+    buffer[length++] = (uint8_t)payload;
+    memset(buffer + length, (uint8_t)i, payload);
+    length += payload;
+  }
+  return length;
+}
+
+static const int FRAME_COUNT = 2000;
+static int frames_received;
+
+static void expect_frames(eager_reader_t *reader, UNUSED_ATTR void *context) {
+  const uint8_t *data;
+  size_t length;
+  while (eager_reader_peek_frame(reader, &data, &length)) {
+    size_t payload = test_frame_payload(frames_received);
+    EXPECT_EQ(1 + payload, length);
+    EXPECT_EQ(payload, data[0]);
+    for (size_t i = 1; i < length; i++)
+      EXPECT_EQ((uint8_t)frames_received, data[i]);
+
+    eager_reader_release_frame(reader);
+    if (++frames_received == FRAME_COUNT)
+      semaphore_post(done);
+  }
+}
+
+TEST_F(EagerReaderTest, test_framed_new_free_simple) {
+  eager_reader_t *reader = eager_reader_new_framed(pipefd[0], 256, BUFFER_SIZE, test_frame_length, "test_thread");
+  ASSERT_TRUE(reader != NULL);
+  eager_reader_free(reader);
+}
+
+TEST_F(EagerReaderTest, test_framed_split_writes) {
+  eager_reader_t *reader = eager_reader_new_framed(pipefd[0], 4096, BUFFER_SIZE, test_frame_length, "test_thread");
+
+  frames_received = 0;
+  thread_t *read_thread = thread_new("read_thread");
+  eager_reader_register(reader, thread_get_reactor(read_thread), expect_frames, NULL);
+
+  // Writes that end in the middle of frames, or of their length byte.
+  static uint8_t data[FRAME_COUNT * 24];
+  size_t length = write_test_frames(data, 0, FRAME_COUNT);
+  for (size_t offset = 0; offset < length; offset += 7)
+    write(pipefd[1], data + offset, length - offset < 7 ? length - offset : 7);
+
+  semaphore_wait(done);
+  EXPECT_EQ(FRAME_COUNT, frames_received);
+
+  eager_reader_free(reader);
+  thread_free(read_thread);
+}
+
+TEST_F(EagerReaderTest, test_framed_small_ring) {
+  // The ring only holds a few frames, so it wraps around and fills up often.
+  eager_reader_t *reader = eager_reader_new_framed(pipefd[0], 64, 16, test_frame_length, "test_thread");
+
+  frames_received = 0;
+  thread_t *read_thread = thread_new("read_thread");
+  eager_reader_register(reader, thread_get_reactor(read_thread), expect_frames, NULL);
+
+  static uint8_t data[FRAME_COUNT * 24];
+  size_t length = write_test_frames(data, 0, FRAME_COUNT);
+  write(pipefd[1], data, length);
+
+  semaphore_wait(done);
+  EXPECT_EQ(FRAME_COUNT, frames_received);
+
+  eager_reader_free(reader);
+  thread_free(read_thread);
+}
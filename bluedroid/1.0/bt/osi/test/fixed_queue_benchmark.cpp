@@ -0,0 +1,89 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+// Compares the list based fixed queue with the ring based one. The argument
+// of each benchmark selects the queue: 0 for |fixed_queue_new| and 1 for
+// |fixed_queue_new_ring|.
+
+#include <benchmark/benchmark.h>
+#include <pthread.h>
+
+extern "C" {
+#include "osi/include/fixed_queue.h"
+#include "osi/include/osi.h"
+}
+
+static const size_t BENCHMARK_QUEUE_SIZE = 64;
+static const char *DUMMY_DATA_STRING = "Dummy data string";
+
+static fixed_queue_t *new_queue(const benchmark::State &state, size_t capacity) {
+  return state.range(0) ? fixed_queue_new_ring(capacity) : fixed_queue_new(capacity);
+}
+
+// One thread enqueues and dequeues, as when a task queues work for itself.
+static void BM_FixedQueueTryEnqueueDequeue(benchmark::State &state) {
+  fixed_queue_t *queue = new_queue(state, BENCHMARK_QUEUE_SIZE);
+  while (state.KeepRunning()) {
+    fixed_queue_try_enqueue(queue, (void *)DUMMY_DATA_STRING);
+    benchmark::DoNotOptimize(fixed_queue_try_dequeue(queue));
+  }
+  fixed_queue_free(queue, NULL);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FixedQueueTryEnqueueDequeue)->Arg(0)->Arg(1);
+
+// Fills the queue in bursts before draining it, as the A2DP encoder does.
+static void BM_FixedQueueBurst(benchmark::State &state) {
+  fixed_queue_t *queue = new_queue(state, BENCHMARK_QUEUE_SIZE);
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < BENCHMARK_QUEUE_SIZE; i++)
+      fixed_queue_enqueue(queue, (void *)DUMMY_DATA_STRING);
+    while (!fixed_queue_is_empty(queue))
+      benchmark::DoNotOptimize(fixed_queue_dequeue(queue));
+  }
+  fixed_queue_free(queue, NULL);
+  state.SetItemsProcessed(state.iterations() * BENCHMARK_QUEUE_SIZE);
+}
+BENCHMARK(BM_FixedQueueBurst)->Arg(0)->Arg(1);
+
+static const size_t PRODUCER_ITEMS = 100000;
+
+static void *producer(void *context) {
+  fixed_queue_t *queue = (fixed_queue_t *)context;
+  for (size_t i = 0; i < PRODUCER_ITEMS; i++)
+    fixed_queue_enqueue(queue, (void *)DUMMY_DATA_STRING);
+  return NULL;
+}
+
+// A producer thread and a consumer thread, blocking on the queue when it is
+// full or empty, as between the HCI layer and the stack.
+static void BM_FixedQueueProducerConsumer(benchmark::State &state) {
+  while (state.KeepRunning()) {
+    fixed_queue_t *queue = new_queue(state, BENCHMARK_QUEUE_SIZE);
+    pthread_t thread;
+    pthread_create(&thread, NULL, producer, queue);
+    for (size_t i = 0; i < PRODUCER_ITEMS; i++)
+      benchmark::DoNotOptimize(fixed_queue_dequeue(queue));
+    pthread_join(thread, NULL);
+    fixed_queue_free(queue, NULL);
+  }
+  state.SetItemsProcessed(state.iterations() * PRODUCER_ITEMS);
+}
+BENCHMARK(BM_FixedQueueProducerConsumer)->Arg(0)->Arg(1)->UseRealTime();
+
+BENCHMARK_MAIN();
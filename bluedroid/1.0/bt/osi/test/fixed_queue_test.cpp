@@ -305,3 +305,123 @@ TEST_F(FixedQueueTest, test_fixed_queue_register_dequeue) {
   thread_free(worker_thread);
   fixed_queue_free(queue, NULL);
 }
+
+TEST_F(FixedQueueTest, test_fixed_queue_ring_new_free) {
+  fixed_queue_t *queue;
+
+  // Test a corner case: queue of size 0
+  queue = fixed_queue_new_ring(0);
+  ASSERT_TRUE(queue != NULL);
+  EXPECT_EQ((size_t)0, fixed_queue_capacity(queue));
+  EXPECT_FALSE(fixed_queue_try_enqueue(queue, (void *)DUMMY_DATA_STRING));
+  EXPECT_EQ(NULL, fixed_queue_try_dequeue(queue));
+  fixed_queue_free(queue, NULL);
+
+  // A ring can not be allocated for the maximum size
+  EXPECT_EQ(NULL, fixed_queue_new_ring((size_t)-1));
+
+  // Test freeing a queue that still holds allocated elements
+  queue = fixed_queue_new_ring(TEST_QUEUE_SIZE);
+  ASSERT_TRUE(queue != NULL);
+  EXPECT_EQ(TEST_QUEUE_SIZE, fixed_queue_capacity(queue));
+  fixed_queue_enqueue(queue, osi_malloc(1));
+  fixed_queue_enqueue(queue, osi_malloc(1));
+  fixed_queue_free(queue, osi_free);
+}
+
+TEST_F(FixedQueueTest, test_fixed_queue_ring_enqueue_dequeue) {
+  fixed_queue_t *queue = fixed_queue_new_ring(TEST_QUEUE_SIZE);
+  ASSERT_TRUE(queue != NULL);
+  int dequeue_fd = fixed_queue_get_dequeue_fd(queue);
+  EXPECT_TRUE(dequeue_fd >= 0);
+  EXPECT_TRUE(fixed_queue_is_empty(queue));
+  EXPECT_FALSE(is_fd_readable(dequeue_fd));
+
+  // Test blocking enqueue and blocking dequeue
+  fixed_queue_enqueue(queue, (void *)DUMMY_DATA_STRING);
+  EXPECT_EQ((size_t)1, fixed_queue_length(queue));
+  EXPECT_TRUE(is_fd_readable(dequeue_fd));
+  EXPECT_EQ(DUMMY_DATA_STRING, fixed_queue_dequeue(queue));
+  EXPECT_EQ((size_t)0, fixed_queue_length(queue));
+  EXPECT_FALSE(is_fd_readable(dequeue_fd));
+
+  // Fill the ring several times over so that the positions wrap around,
+  // and check that the elements come out in order
+  const char *strings[] = { DUMMY_DATA_STRING1, DUMMY_DATA_STRING2, DUMMY_DATA_STRING3 };
+  for (size_t round = 0; round < 3; round++) {
+    for (size_t i = 0; i < TEST_QUEUE_SIZE; i++) {
+      EXPECT_TRUE(fixed_queue_try_enqueue(queue, (void *)strings[i % 3]));
+    }
+    EXPECT_FALSE(fixed_queue_try_enqueue(queue, (void *)DUMMY_DATA_STRING));
+    EXPECT_EQ(TEST_QUEUE_SIZE, fixed_queue_length(queue));
+    EXPECT_EQ(strings[0], fixed_queue_try_peek_first(queue));
+    for (size_t i = 0; i < TEST_QUEUE_SIZE; i++) {
+      EXPECT_TRUE(is_fd_readable(dequeue_fd));
+      EXPECT_EQ(strings[i % 3], fixed_queue_try_dequeue(queue));
+    }
+    EXPECT_EQ(NULL, fixed_queue_try_dequeue(queue));
+    EXPECT_EQ(NULL, fixed_queue_try_peek_first(queue));
+    EXPECT_FALSE(is_fd_readable(dequeue_fd));
+  }
+
+  fixed_queue_free(queue, NULL);
+}
+
+TEST_F(FixedQueueTest, test_fixed_queue_ring_register_dequeue) {
+  fixed_queue_t *queue = fixed_queue_new_ring(TEST_QUEUE_SIZE);
+  ASSERT_TRUE(queue != NULL);
+
+  received_message_future = future_new();
+  ASSERT_TRUE(received_message_future != NULL);
+
+  thread_t *worker_thread = thread_new("test_fixed_queue_worker_thread");
+  ASSERT_TRUE(worker_thread != NULL);
+
+  fixed_queue_register_dequeue(queue,
+                               thread_get_reactor(worker_thread),
+                               fixed_queue_ready,
+                               NULL);
+
+  // Add a message to the queue, and expect to receive it
+  fixed_queue_enqueue(queue, (void *)DUMMY_DATA_STRING);
+  const char *msg = (const char *)future_await(received_message_future);
+  EXPECT_EQ(DUMMY_DATA_STRING, msg);
+
+  fixed_queue_unregister_dequeue(queue);
+  thread_free(worker_thread);
+  fixed_queue_free(queue, NULL);
+}
+
+static const size_t RING_PRODUCERS = 4;
+static const size_t RING_ITEMS_PER_PRODUCER = 20000;
+
+static void *ring_producer(void *context) {
+  fixed_queue_t *queue = (fixed_queue_t *)context;
+  for (size_t i = 1; i <= RING_ITEMS_PER_PRODUCER; i++)
+    fixed_queue_enqueue(queue, UINT_TO_PTR(i));
+  return NULL;
+}
+
+TEST_F(FixedQueueTest, test_fixed_queue_ring_multiple_producers) {
+  // A small ring, so that the producers keep blocking on a full queue
+  fixed_queue_t *queue = fixed_queue_new_ring(4);
+  ASSERT_TRUE(queue != NULL);
+
+  pthread_t producers[RING_PRODUCERS];
+  for (size_t i = 0; i < RING_PRODUCERS; i++)
+    ASSERT_EQ(0, pthread_create(&producers[i], NULL, ring_producer, queue));
+
+  // Each producer enqueues 1..N, so the sum of what is dequeued is known
+  unsigned long long sum = 0;
+  for (size_t i = 0; i < RING_PRODUCERS * RING_ITEMS_PER_PRODUCER; i++)
+    sum += PTR_TO_UINT(fixed_queue_dequeue(queue));
+
+  for (size_t i = 0; i < RING_PRODUCERS; i++)
+    pthread_join(producers[i], NULL);
+
+  EXPECT_EQ(RING_PRODUCERS * RING_ITEMS_PER_PRODUCER * (RING_ITEMS_PER_PRODUCER + 1) / 2, sum);
+  EXPECT_TRUE(fixed_queue_is_empty(queue));
+  EXPECT_EQ(NULL, fixed_queue_try_dequeue(queue));
+
+  fixed_queue_free(queue, NULL);
+}
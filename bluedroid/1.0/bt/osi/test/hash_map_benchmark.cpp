@@ -0,0 +1,103 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+
+// Costs of the hash_map operations on the kinds of keys the stack uses. The
+// argument of each benchmark is the number of entries in the map.
+
+#include <benchmark/benchmark.h>
+#include <stdlib.h>
+#include <vector>
+
+extern "C" {
+#include "osi/include/hash_functions.h"
+#include "osi/include/hash_map.h"
+#include "osi/include/osi.h"
+}
+
+// As small as the maps in peer.c and the L2CAP tables start out, so inserts
+// also pay for growing the map.
+static const size_t BENCHMARK_BUCKETS = 16;
+
+// Connection handles and similar small integers.
+static void BM_HashMapSetEraseHandles(benchmark::State &state) {
+  const uintptr_t count = state.range(0);
+  hash_map_t *hash_map = hash_map_new(BENCHMARK_BUCKETS, hash_function_naive, NULL, NULL, NULL);
+  while (state.KeepRunning()) {
+    for (uintptr_t i = 1; i <= count; i++)
+      hash_map_set(hash_map, UINT_TO_PTR(i), UINT_TO_PTR(i));
+    for (uintptr_t i = 1; i <= count; i++)
+      hash_map_erase(hash_map, UINT_TO_PTR(i));
+  }
+  hash_map_free(hash_map);
+  state.SetItemsProcessed(state.iterations() * count * 2);
+}
+BENCHMARK(BM_HashMapSetEraseHandles)->Arg(16)->Arg(1024)->Arg(65536);
+
+static void BM_HashMapGetHandles(benchmark::State &state) {
+  const uintptr_t count = state.range(0);
+  hash_map_t *hash_map = hash_map_new(BENCHMARK_BUCKETS, hash_function_naive, NULL, NULL, NULL);
+  for (uintptr_t i = 1; i <= count; i++)
+    hash_map_set(hash_map, UINT_TO_PTR(i), UINT_TO_PTR(i));
+  while (state.KeepRunning()) {
+    for (uintptr_t i = 1; i <= count; i++)
+      benchmark::DoNotOptimize(hash_map_get(hash_map, UINT_TO_PTR(i)));
+  }
+  hash_map_free(hash_map);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_HashMapGetHandles)->Arg(16)->Arg(1024)->Arg(65536);
+
+// Lookups of keys that are not in the map, as for a packet on an unknown
+// handle.
+static void BM_HashMapGetMissing(benchmark::State &state) {
+  const uintptr_t count = state.range(0);
+  hash_map_t *hash_map = hash_map_new(BENCHMARK_BUCKETS, hash_function_naive, NULL, NULL, NULL);
+  for (uintptr_t i = 1; i <= count; i++)
+    hash_map_set(hash_map, UINT_TO_PTR(i), UINT_TO_PTR(i));
+  while (state.KeepRunning()) {
+    for (uintptr_t i = count + 1; i <= 2 * count; i++)
+      benchmark::DoNotOptimize(hash_map_get(hash_map, UINT_TO_PTR(i)));
+  }
+  hash_map_free(hash_map);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_HashMapGetMissing)->Arg(16)->Arg(1024)->Arg(65536);
+
+// Heap pointers, as in the allocation tracker.
+static void BM_HashMapGetPointers(benchmark::State &state) {
+  const size_t count = state.range(0);
+  std::vector<void *> keys(count);
+  for (size_t i = 0; i < count; i++)
+    keys[i] = malloc(32);
+
+  hash_map_t *hash_map = hash_map_new(BENCHMARK_BUCKETS, hash_function_pointer, NULL, NULL, NULL);
+  for (size_t i = 0; i < count; i++)
+    hash_map_set(hash_map, keys[i], keys[i]);
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < count; i++)
+      benchmark::DoNotOptimize(hash_map_get(hash_map, keys[i]));
+  }
+  hash_map_free(hash_map);
+  for (size_t i = 0; i < count; i++)
+    free(keys[i]);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_HashMapGetPointers)->Arg(16)->Arg(1024)->Arg(65536);
+
+BENCHMARK_MAIN();
@@ -200,3 +200,51 @@ TEST_F(HashMapTest, test_iter) {
 
   hash_map_free(hash_map);
 }
+
+TEST_F(HashMapTest, test_clear) {
+  hash_map_t *hash_map = hash_map_new(5, hash_map_fn00, key_free_fn00, data_free_fn00, NULL);
+  ASSERT_TRUE(hash_map != NULL);
+  g_data_free = 0;
+  g_key_free = 0;
+
+  size_t hash_test_iter_data_sz = sizeof(hash_test_iter_data)/sizeof(hash_test_iter_data[0]);
+  for (size_t i = 0; i < hash_test_iter_data_sz; i++)
+    hash_map_set(hash_map, hash_test_iter_data[i].key, (void*)hash_test_iter_data[i].data);
+
+  hash_map_clear(hash_map);
+  EXPECT_TRUE(hash_map_is_empty(hash_map));
+  EXPECT_EQ(hash_test_iter_data_sz, g_data_free);
+  EXPECT_EQ(hash_test_iter_data_sz, g_key_free);
+  EXPECT_TRUE(hash_map_get(hash_map, hash_test_iter_data[0].key) == NULL);
+
+  hash_map_free(hash_map);
+}
+
+// Small integer keys that all hash to a few home slots, to exercise long
+// probe sequences and the shifting on erase.
+static hash_index_t hash_map_fn_colliding(const void *key) {
+  return PTR_TO_UINT(key) % 3;
+}
+
+TEST_F(HashMapTest, test_grow_and_erase) {
+  hash_map_t *hash_map = hash_map_new(2, hash_map_fn_colliding, NULL, NULL, NULL);
+  ASSERT_TRUE(hash_map != NULL);
+
+  const uintptr_t count = 200;
+  for (uintptr_t i = 0; i < count; i++)
+    EXPECT_TRUE(hash_map_set(hash_map, (void *)i, (void *)(i + 1)));
+  EXPECT_EQ(count, hash_map_size(hash_map));
+  EXPECT_LE(count, hash_map_num_buckets(hash_map));
+
+  for (uintptr_t i = 0; i < count; i += 2)
+    EXPECT_TRUE(hash_map_erase(hash_map, (void *)i));
+  EXPECT_EQ(count / 2, hash_map_size(hash_map));
+
+  for (uintptr_t i = 0; i < count; i++) {
+    EXPECT_EQ(i % 2 == 1, hash_map_has_key(hash_map, (void *)i));
+    EXPECT_EQ(i % 2 == 1 ? (void *)(i + 1) : NULL, hash_map_get(hash_map, (void *)i));
+  }
+  EXPECT_FALSE(hash_map_erase(hash_map, (void *)0));
+
+  hash_map_free(hash_map);
+}
@@ -0,0 +1,123 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2017 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "osi/include/metrics.h"
+}
+
+class MetricsHistogramTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() { metrics_histogram_reset(); }
+  virtual void TearDown() { metrics_histogram_reset(); }
+};
+
+TEST_F(MetricsHistogramTest, test_buckets) {
+  metrics_histogram_record(METRICS_HISTOGRAM_A2DP_ENCODE, 0);
+  metrics_histogram_record(METRICS_HISTOGRAM_A2DP_ENCODE, 1);
+  metrics_histogram_record(METRICS_HISTOGRAM_A2DP_ENCODE, 2);
+  metrics_histogram_record(METRICS_HISTOGRAM_A2DP_ENCODE, 3);
+  metrics_histogram_record(METRICS_HISTOGRAM_A2DP_ENCODE, 1023);
+  metrics_histogram_record(METRICS_HISTOGRAM_A2DP_ENCODE, 1024);
+  metrics_histogram_record(METRICS_HISTOGRAM_A2DP_ENCODE, 60ULL * 1000 * 1000);
+
+  metrics_histogram_snapshot_t snapshot;
+  metrics_histogram_get(METRICS_HISTOGRAM_A2DP_ENCODE, &snapshot);
+  EXPECT_EQ(7U, snapshot.count);
+  EXPECT_EQ(60ULL * 1000 * 1000, snapshot.max_us);
+  EXPECT_EQ(60ULL * 1000 * 1000 + 2053, snapshot.total_us);
+
+  EXPECT_EQ(1U, snapshot.buckets[0]);
+  EXPECT_EQ(1U, snapshot.buckets[1]);
+  EXPECT_EQ(2U, snapshot.buckets[2]);
+  EXPECT_EQ(1U, snapshot.buckets[10]);
+  EXPECT_EQ(1U, snapshot.buckets[11]);
+  EXPECT_EQ(1U, snapshot.buckets[METRICS_HISTOGRAM_NUM_BUCKETS - 1]);
+
+  // The other histograms are untouched.
+  metrics_histogram_get(METRICS_HISTOGRAM_ALARM_LATENESS, &snapshot);
+  EXPECT_EQ(0U, snapshot.count);
+}
+
+TEST_F(MetricsHistogramTest, test_reset) {
+  metrics_histogram_record(METRICS_HISTOGRAM_HCI_COMMAND_ROUND_TRIP, 500);
+  metrics_histogram_reset();
+
+  metrics_histogram_snapshot_t snapshot;
+  metrics_histogram_get(METRICS_HISTOGRAM_HCI_COMMAND_ROUND_TRIP, &snapshot);
+  EXPECT_EQ(0U, snapshot.count);
+  EXPECT_EQ(0U, snapshot.total_us);
+  EXPECT_EQ(0U, snapshot.max_us);
+  for (size_t i = 0; i < METRICS_HISTOGRAM_NUM_BUCKETS; ++i)
+    EXPECT_EQ(0U, snapshot.buckets[i]);
+}
+
+TEST_F(MetricsHistogramTest, test_concurrent_record) {
+  const int THREADS = 4;
+  const int SAMPLES = 10000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; ++t) {
+    threads.emplace_back([t, SAMPLES] {
+      for (int i = 0; i < SAMPLES; ++i)
+        metrics_histogram_record(METRICS_HISTOGRAM_ACL_TX_QUEUE_DELAY, t * 100 + i % 100);
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  metrics_histogram_snapshot_t snapshot;
+  metrics_histogram_get(METRICS_HISTOGRAM_ACL_TX_QUEUE_DELAY, &snapshot);
+  EXPECT_EQ((uint64_t)THREADS * SAMPLES, snapshot.count);
+  EXPECT_EQ((uint64_t)(THREADS - 1) * 100 + 99, snapshot.max_us);
+
+  uint64_t bucket_total = 0;
+  for (size_t i = 0; i < METRICS_HISTOGRAM_NUM_BUCKETS; ++i)
+    bucket_total += snapshot.buckets[i];
+  EXPECT_EQ(snapshot.count, bucket_total);
+}
+
+TEST_F(MetricsHistogramTest, test_debug_dump) {
+  for (int i = 0; i < 100; ++i)
+    metrics_histogram_record(METRICS_HISTOGRAM_ALARM_LATENESS, i < 90 ? 10 : 5000);
+
+  char path[] = "/tmp/metrics_histogram_test.XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(-1, fd);
+  unlink(path);
+  metrics_histogram_debug_dump(fd);
+
+  char buffer[4096];
+  ssize_t length = pread(fd, buffer, sizeof(buffer) - 1, 0);
+  close(fd);
+  ASSERT_GT(length, 0);
+  buffer[length] = '\0';
+
+  EXPECT_NE(nullptr, strstr(buffer, "Alarm dispatch lateness:\n"
+                                    "    Count: 100  Avg: 509  Max: 5000"
+                                    "  P50: <=16  P90: <=16  P99: <=5000\n"
+                                    "    Buckets: <16:90 <8192:10\n"));
+  EXPECT_NE(nullptr, strstr(buffer, "HCI command round trip:\n    None\n"));
+}
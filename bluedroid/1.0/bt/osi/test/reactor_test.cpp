@@ -117,3 +117,114 @@ TEST_F(ReactorTest, reactor_unregister_from_separate_thread) {
   close(fd);
   reactor_free(reactor);
 }
+
+#define ORDER_OBJECTS 3
+
+typedef struct {
+  int fd;
+  int id;
+} order_arg_t;
+
+static int order[ORDER_OBJECTS];
+static int order_count;
+
+static void order_cb(void *context) {
+  order_arg_t *arg = (order_arg_t *)context;
+  eventfd_t value;
+  eventfd_read(arg->fd, &value);
+  order[order_count++] = arg->id;
+}
+
+TEST_F(ReactorTest, reactor_priority_order) {
+  reactor_t *reactor = reactor_new();
+
+  order_arg_t args[ORDER_OBJECTS];
+  reactor_object_t *objects[ORDER_OBJECTS];
+  for (int i = 0; i < ORDER_OBJECTS; ++i) {
+    args[i].fd = eventfd(0, 0);
+    args[i].id = i;
+    objects[i] = reactor_register(reactor, args[i].fd, &args[i], order_cb, NULL);
+  }
+  reactor_object_set_priority(objects[0], REACTOR_PRIORITY_LOW);
+  reactor_object_set_priority(objects[2], REACTOR_PRIORITY_HIGH);
+
+  for (int i = 0; i < ORDER_OBJECTS; ++i)
+    eventfd_write(args[i].fd, 1);
+
+  order_count = 0;
+  EXPECT_EQ(REACTOR_STATUS_DONE, reactor_run_once(reactor));
+  EXPECT_EQ(ORDER_OBJECTS, order_count);
+  EXPECT_EQ(2, order[0]);
+  EXPECT_EQ(1, order[1]);
+  EXPECT_EQ(0, order[2]);
+
+  for (int i = 0; i < ORDER_OBJECTS; ++i) {
+    reactor_unregister(objects[i]);
+    close(args[i].fd);
+  }
+  reactor_free(reactor);
+}
+
+TEST_F(ReactorTest, reactor_max_events) {
+  reactor_t *reactor = reactor_new();
+  reactor_set_max_events(reactor, 1);
+
+  order_arg_t args[ORDER_OBJECTS];
+  reactor_object_t *objects[ORDER_OBJECTS];
+  for (int i = 0; i < ORDER_OBJECTS; ++i) {
+    args[i].fd = eventfd(0, 0);
+    args[i].id = i;
+    objects[i] = reactor_register(reactor, args[i].fd, &args[i], order_cb, NULL);
+    eventfd_write(args[i].fd, 1);
+  }
+
+  order_count = 0;
+  for (int i = 1; i <= ORDER_OBJECTS; ++i) {
+    EXPECT_EQ(REACTOR_STATUS_DONE, reactor_run_once(reactor));
+    EXPECT_EQ(i, order_count);
+  }
+
+  for (int i = 0; i < ORDER_OBJECTS; ++i) {
+    reactor_unregister(objects[i]);
+    close(args[i].fd);
+  }
+  reactor_free(reactor);
+}
+
+static void slow_cb(void *context) {
+  order_arg_t *arg = (order_arg_t *)context;
+  eventfd_t value;
+  eventfd_read(arg->fd, &value);
+  usleep(10 * 1000);
+}
+
+TEST_F(ReactorTest, reactor_object_stats) {
+  reactor_t *reactor = reactor_new();
+
+  order_arg_t slow = { eventfd(0, 0), 0 };
+  order_arg_t waiting = { eventfd(0, 0), 1 };
+  reactor_object_t *slow_object = reactor_register(reactor, slow.fd, &slow, slow_cb, NULL);
+  reactor_object_t *waiting_object = reactor_register(reactor, waiting.fd, &waiting, order_cb, NULL);
+  reactor_object_set_priority(slow_object, REACTOR_PRIORITY_HIGH);
+
+  eventfd_write(slow.fd, 1);
+  eventfd_write(waiting.fd, 1);
+  order_count = 0;
+  EXPECT_EQ(REACTOR_STATUS_DONE, reactor_run_once(reactor));
+
+  reactor_object_stats_t stats;
+  reactor_object_get_stats(slow_object, &stats);
+  EXPECT_EQ(1U, stats.dispatch_count);
+  EXPECT_GE(stats.max_run_us, 10000U);
+  EXPECT_EQ(stats.max_run_us, stats.total_run_us);
+
+  reactor_object_get_stats(waiting_object, &stats);
+  EXPECT_EQ(1U, stats.dispatch_count);
+  EXPECT_GE(stats.max_wait_us, 10000U);
+
+  reactor_unregister(slow_object);
+  reactor_unregister(waiting_object);
+  close(slow.fd);
+  close(waiting.fd);
+  reactor_free(reactor);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <unistd.h>
+
+#include "AllocationTestHarness.h"
+
+extern "C" {
+#include "osi/include/osi.h"
+#include "osi/include/semaphore.h"
+#include "osi/include/thread_pool.h"
+}
+
+class ThreadPoolTest : public AllocationTestHarness {};
+
+static std::atomic<int> run_count;
+
+static void count_fn(UNUSED_ATTR void *context) {
+  run_count++;
+}
+
+static void wait_fn(void *context) {
+  semaphore_wait((semaphore_t *)context);
+}
+
+TEST_F(ThreadPoolTest, test_new_free) {
+  thread_pool_t *pool = thread_pool_new("test_pool", 2);
+  ASSERT_TRUE(pool != NULL);
+  thread_pool_free(pool);
+}
+
+TEST_F(ThreadPoolTest, test_free_null) {
+  thread_pool_free(NULL);
+}
+
+TEST_F(ThreadPoolTest, test_free_runs_queued) {
+  thread_pool_t *pool = thread_pool_new("test_pool", 1);
+  semaphore_t *gate = semaphore_new(0);
+  run_count = 0;
+
+  EXPECT_TRUE(thread_pool_post(pool, THREAD_POOL_PRIORITY_NORMAL, wait_fn, gate));
+  for (int i = 0; i < 10; ++i)
+    EXPECT_TRUE(thread_pool_post(pool, THREAD_POOL_PRIORITY_LOW, count_fn, NULL));
+
+  semaphore_post(gate);
+  thread_pool_free(pool);
+  EXPECT_EQ(10, run_count);
+
+  semaphore_free(gate);
+}
+
+static int order[3];
+static std::atomic<int> order_count;
+
+static void record_fn(void *context) {
+  order[order_count++] = (int)(intptr_t)context;
+}
+
+TEST_F(ThreadPoolTest, test_priority) {
+  thread_pool_t *pool = thread_pool_new("test_pool", 1);
+  semaphore_t *gate = semaphore_new(0);
+  order_count = 0;
+
+  // The only worker is busy until the gate opens, so all three are queued.
+  thread_pool_post(pool, THREAD_POOL_PRIORITY_HIGH, wait_fn, gate);
+  thread_pool_post(pool, THREAD_POOL_PRIORITY_LOW, record_fn, (void *)THREAD_POOL_PRIORITY_LOW);
+  thread_pool_post(pool, THREAD_POOL_PRIORITY_NORMAL, record_fn, (void *)THREAD_POOL_PRIORITY_NORMAL);
+  thread_pool_post(pool, THREAD_POOL_PRIORITY_HIGH, record_fn, (void *)THREAD_POOL_PRIORITY_HIGH);
+
+  semaphore_post(gate);
+  thread_pool_free(pool);
+
+  EXPECT_EQ(3, order_count);
+  EXPECT_EQ(THREAD_POOL_PRIORITY_HIGH, order[0]);
+  EXPECT_EQ(THREAD_POOL_PRIORITY_NORMAL, order[1]);
+  EXPECT_EQ(THREAD_POOL_PRIORITY_LOW, order[2]);
+
+  semaphore_free(gate);
+}
+
+static thread_pool_t *steal_pool;
+static semaphore_t *steal_done;
+static semaphore_t *steal_finished;
+
+static void signal_fn(UNUSED_ATTR void *context) {
+  semaphore_post(steal_done);
+}
+
+static void spawn_fn(UNUSED_ATTR void *context) {
+  // These go on this worker's own queue; they can only run while it waits
+  // if the other worker takes them.
+  for (int i = 0; i < 4; ++i)
+    thread_pool_post(steal_pool, THREAD_POOL_PRIORITY_NORMAL, signal_fn, NULL);
+  for (int i = 0; i < 4; ++i)
+    semaphore_wait(steal_done);
+  semaphore_post(steal_finished);
+}
+
+TEST_F(ThreadPoolTest, test_steal) {
+  steal_pool = thread_pool_new("test_pool", 2);
+  steal_done = semaphore_new(0);
+  steal_finished = semaphore_new(0);
+
+  thread_pool_post(steal_pool, THREAD_POOL_PRIORITY_NORMAL, spawn_fn, NULL);
+  semaphore_wait(steal_finished);
+
+  thread_pool_stats_t stats;
+  thread_pool_get_stats(steal_pool, &stats);
+  EXPECT_GE(stats.tasks_stolen, 4U);
+  thread_pool_free(steal_pool);
+
+  semaphore_free(steal_finished);
+  semaphore_free(steal_done);
+}
+
+TEST_F(ThreadPoolTest, test_stats) {
+  thread_pool_t *pool = thread_pool_new("test_pool", 1);
+  semaphore_t *gate = semaphore_new(0);
+  thread_pool_stats_t stats;
+
+  thread_pool_get_stats(pool, &stats);
+  EXPECT_EQ(0U, stats.tasks_run);
+  EXPECT_EQ(0U, stats.queue_depth);
+
+  thread_pool_post(pool, THREAD_POOL_PRIORITY_NORMAL, wait_fn, gate);
+  for (int i = 0; i < 5; ++i)
+    thread_pool_post(pool, THREAD_POOL_PRIORITY_NORMAL, count_fn, NULL);
+
+  thread_pool_get_stats(pool, &stats);
+  EXPECT_GE(stats.queue_depth, 5U);
+  EXPECT_GE(stats.max_queue_depth, 5U);
+
+  // Run a task once the others are done to read the final counts.
+  semaphore_post(gate);
+  thread_pool_post(pool, THREAD_POOL_PRIORITY_LOW, wait_fn, gate);
+  while (true) {
+    thread_pool_get_stats(pool, &stats);
+    if (stats.tasks_run == 7)
+      break;
+    usleep(1000);
+  }
+  EXPECT_EQ(0U, stats.queue_depth);
+  EXPECT_EQ(0U, stats.tasks_stolen);
+  EXPECT_GE(stats.total_wait_us, stats.max_wait_us);
+
+  semaphore_post(gate);
+  thread_pool_free(pool);
+  semaphore_free(gate);
+}
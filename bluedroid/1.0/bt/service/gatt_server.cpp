@@ -37,6 +37,9 @@ bool operator!=(const bt_bdaddr_t& lhs, const bt_bdaddr_t& rhs) {
 
 }  // namespace
 
+const size_t GattServer::kMaxNotificationsInFlight = 8;
+const size_t GattServer::kMaxQueuedNotifications = 64;
+
 // GattServer implementation
 // ========================================================
 
@@ -404,36 +407,17 @@ bool GattServer::SendNotification(
   // Send the notification/indication on all matching connections.
   int send_count = 0;
   for (auto conn : conn_iter->second) {
-    // Make sure that one isn't already pending for this connection.
-    if (pending_indications_.find(conn->conn_id) !=
-        pending_indications_.end()) {
-      VLOG(1) << "A" << (confirm ? "n indication" : " notification")
-              << " is already pending for connection: " << conn->conn_id;
-      continue;
-    }
-
-    // The HAL API takes char* rather const char* for |value|, so we have to
-    // cast away the const.
-    // TODO(armansito): Make HAL accept const char*.
-    bt_status_t status = hal::BluetoothGattInterface::Get()->
-        GetServerHALInterface()->send_indication(
-            server_id_,
-            handle_iter->second,
-            conn->conn_id,
-            value.size(),
-            confirm,
-            reinterpret_cast<char*>(const_cast<uint8_t*>(value.data())));
-
     // Increment the send count if this was successful. We don't immediately
     // fail if the HAL returned an error. It's better to report success as long
     // as we sent out at least one notification to this device as
     // multi-transport GATT connections from the same BD_ADDR will be rare
     // enough already.
-    if (status != BT_STATUS_SUCCESS)
+    if (!SendOrQueueNotification(
+            conn.get(), value,
+            OutgoingNotification(handle_iter->second, confirm, pending_ind)))
       continue;
 
     send_count++;
-    pending_indications_[conn->conn_id] = pending_ind;
   }
 
   if (send_count == 0) {
@@ -463,7 +447,11 @@ void GattServer::ConnectionCallback(
   if (!connected) {
     // Erase the entry if we were connected to it.
     VLOG(1) << "No longer connected: " << device_address;
-    conn_id_map_.erase(conn_id);
+    auto conn_id_iter = conn_id_map_.find(conn_id);
+    if (conn_id_iter != conn_id_map_.end()) {
+      FailNotifications(conn_id_iter->second.get(), GATT_ERROR_UNLIKELY);
+      conn_id_map_.erase(conn_id_iter);
+    }
     auto iter = conn_addr_map_.find(device_address);
     if (iter == conn_addr_map_.end())
       return;
@@ -526,7 +514,7 @@ void GattServer::ServiceAddedCallback(
   CHECK(-1 == pending_decl_->service_handle);
   pending_decl_->service_handle = service_handle;
 
-  HandleNextEntry(gatt_iface);
+  SubmitPendingEntries(gatt_iface);
 }
 
 void GattServer::CharacteristicAddedCallback(
@@ -540,26 +528,13 @@ void GattServer::CharacteristicAddedCallback(
   if (server_id != server_id_)
     return;
 
-  CHECK(pending_decl_);
-  CHECK(pending_decl_->service_handle == service_handle);
-  CHECK(pending_id_);
-  CHECK(pending_id_->IsCharacteristic());
-  CHECK(pending_id_->characteristic_uuid() == UUID(uuid));
-
   VLOG(1) << __func__ << " - status: " << status
           << " server_id: " << server_id
           << " service_handle: " << service_handle
           << " char_handle: " << char_handle;
 
-  if (status != BT_STATUS_SUCCESS) {
-    NotifyEndCallbackAndClearData(static_cast<BLEStatus>(status),
-                                  pending_decl_->service_id);
-    return;
-  }
-
-  // Add this to the handle map and continue.
-  pending_handle_map_[*pending_id_] = char_handle;
-  HandleNextEntry(gatt_iface);
+  CompletePendingEntry(gatt_iface, status, service_handle, UUID(uuid),
+                       char_handle);
 }
 
 void GattServer::DescriptorAddedCallback(
@@ -573,26 +548,13 @@ void GattServer::DescriptorAddedCallback(
   if (server_id != server_id_)
     return;
 
-  CHECK(pending_decl_);
-  CHECK(pending_decl_->service_handle == service_handle);
-  CHECK(pending_id_);
-  CHECK(pending_id_->IsDescriptor());
-  CHECK(pending_id_->descriptor_uuid() == UUID(uuid));
-
   VLOG(1) << __func__ << " - status: " << status
           << " server_id: " << server_id
           << " service_handle: " << service_handle
           << " desc_handle: " << desc_handle;
 
-  if (status != BT_STATUS_SUCCESS) {
-    NotifyEndCallbackAndClearData(static_cast<BLEStatus>(status),
-                                  pending_decl_->service_id);
-    return;
-  }
-
-  // Add this to the handle map and contiue.
-  pending_handle_map_[*pending_id_] = desc_handle;
-  HandleNextEntry(gatt_iface);
+  CompletePendingEntry(gatt_iface, status, service_handle, UUID(uuid),
+                       desc_handle);
 }
 
 void GattServer::ServiceStartedCallback(
@@ -653,8 +615,8 @@ void GattServer::RequestReadCallback(
           << " is_long: " << is_long;
 
   // Make sure that the handle is valid.
-  auto iter = handle_to_id_map_.find(attribute_handle);
-  if (iter == handle_to_id_map_.end()) {
+  const GattIdentifier* gatt_id = GetAttribute(attribute_handle);
+  if (!gatt_id) {
     LOG(ERROR) << "Request received for unknown handle: " << attribute_handle;
     return;
   }
@@ -672,12 +634,12 @@ void GattServer::RequestReadCallback(
     return;
   }
 
-  if (iter->second.IsCharacteristic()) {
+  if (gatt_id->IsCharacteristic()) {
     delegate_->OnCharacteristicReadRequest(
-        this, device_address, trans_id, offset, is_long, iter->second);
-  } else if (iter->second.IsDescriptor()) {
+        this, device_address, trans_id, offset, is_long, *gatt_id);
+  } else if (gatt_id->IsDescriptor()) {
     delegate_->OnDescriptorReadRequest(
-        this, device_address, trans_id, offset, is_long, iter->second);
+        this, device_address, trans_id, offset, is_long, *gatt_id);
   } else {
     // Our API only delegates to applications those read requests for
     // characteristic value and descriptor attributes. Everything else should be
@@ -714,8 +676,8 @@ void GattServer::RequestWriteCallback(
           << " is_prep: " << is_prep;
 
   // Make sure that the handle is valid.
-  auto iter = handle_to_id_map_.find(attr_handle);
-  if (iter == handle_to_id_map_.end()) {
+  const GattIdentifier* gatt_id = GetAttribute(attr_handle);
+  if (!gatt_id) {
     LOG(ERROR) << "Request received for unknown handle: " << attr_handle;
     return;
   }
@@ -739,14 +701,14 @@ void GattServer::RequestWriteCallback(
 
   std::vector<uint8_t> value_vec(value, value + length);
 
-  if (iter->second.IsCharacteristic()) {
+  if (gatt_id->IsCharacteristic()) {
     delegate_->OnCharacteristicWriteRequest(
         this, device_address, trans_id, offset, is_prep, need_rsp,
-        value_vec, iter->second);
-  } else if (iter->second.IsDescriptor()) {
+        value_vec, *gatt_id);
+  } else if (gatt_id->IsDescriptor()) {
     delegate_->OnDescriptorWriteRequest(
         this, device_address, trans_id, offset, is_prep, need_rsp,
-        value_vec, iter->second);
+        value_vec, *gatt_id);
   } else {
     // Our API only delegates to applications those read requests for
     // characteristic value and descriptor attributes. Everything else should be
@@ -796,24 +758,21 @@ void GattServer::IndicationSentCallback(
   VLOG(1) << __func__ << " conn_id: " << conn_id << " status: " << status;
   lock_guard<mutex> lock(mutex_);
 
-  const auto& pending_ind_iter = pending_indications_.find(conn_id);
-  if (pending_ind_iter == pending_indications_.end()) {
-    VLOG(1) << "Unknown connection: " << conn_id;
+  auto conn_iter = conn_id_map_.find(conn_id);
+  if (conn_iter == conn_id_map_.end() ||
+      conn_iter->second->notifications_in_flight.empty()) {
+    VLOG(1) << "No notification pending for connection: " << conn_id;
     return;
   }
 
-  std::shared_ptr<PendingIndication> pending_ind = pending_ind_iter->second;
-  pending_indications_.erase(pending_ind_iter);
-
-  if (status == BT_STATUS_SUCCESS)
-    pending_ind->has_success = true;
+  Connection* conn = conn_iter->second.get();
+  std::shared_ptr<PendingIndication> pending_ind =
+      std::move(conn->notifications_in_flight.front().pending_ind);
+  conn->notifications_in_flight.pop_front();
 
-  // Invoke it if this was the last reference to the confirmation callback.
-  if (pending_ind.unique() && pending_ind->callback) {
-    pending_ind->callback(
-        pending_ind->has_success ?
-        GATT_ERROR_NONE : static_cast<GATTError>(status));
-  }
+  CompleteNotification(std::move(pending_ind),
+                       static_cast<GATTError>(status));
+  SendQueuedNotifications(conn);
 }
 
 void GattServer::NotifyEndCallbackAndClearData(
@@ -824,8 +783,13 @@ void GattServer::NotifyEndCallbackAndClearData(
   if (status == BLE_STATUS_SUCCESS) {
     id_to_handle_map_.insert(pending_handle_map_.begin(),
                              pending_handle_map_.end());
-    for (auto& iter : pending_handle_map_)
-      handle_to_id_map_[iter.second] = iter.first;
+    for (auto& iter : pending_handle_map_) {
+      CHECK(iter.second >= 0);
+      size_t handle = static_cast<size_t>(iter.second);
+      if (handle >= attribute_table_.size())
+        attribute_table_.resize(handle + 1);
+      attribute_table_[handle] = iter.first;
+    }
   }
 
   pending_end_decl_cb_(status, id);
@@ -840,69 +804,208 @@ void GattServer::CleanUpPendingData() {
   pending_handle_map_.clear();
 }
 
-void GattServer::HandleNextEntry(hal::BluetoothGattInterface* gatt_iface) {
+void GattServer::SubmitPendingEntries(
+    hal::BluetoothGattInterface* gatt_iface) {
   CHECK(pending_decl_);
   CHECK(gatt_iface);
 
-  auto next_entry = PopNextEntry();
-  if (!next_entry) {
-    // No more entries. Call start_service to finish up.
-    bt_status_t status = gatt_iface->GetServerHALInterface()->start_service(
-        server_id_,
-        pending_decl_->service_handle,
-        TRANSPORT_BREDR | TRANSPORT_LE);
+  // The stack processes these in order and reports each handle in a separate
+  // callback, so there is no need to wait for one before adding the next.
+  while (auto next_entry = PopNextEntry()) {
+    bt_status_t status;
+    if (next_entry->id.IsCharacteristic()) {
+      bt_uuid_t char_uuid = next_entry->id.characteristic_uuid().GetBlueDroid();
+      status = gatt_iface->GetServerHALInterface()->add_characteristic(
+          server_id_,
+          pending_decl_->service_handle,
+          &char_uuid,
+          next_entry->char_properties,
+          next_entry->permissions);
+    } else if (next_entry->id.IsDescriptor()) {
+      bt_uuid_t desc_uuid = next_entry->id.descriptor_uuid().GetBlueDroid();
+      status = gatt_iface->GetServerHALInterface()->add_descriptor(
+          server_id_,
+          pending_decl_->service_handle,
+          &desc_uuid,
+          next_entry->permissions);
+    } else {
+      NOTREACHED() << "Unexpected entry type";
+      status = BT_STATUS_FAIL;
+    }
 
-    // Terminate the procedure in the case of an error.
+    // Terminate the procedure in the case of an error. Results for the entries
+    // that were already added get ignored.
     if (status != BT_STATUS_SUCCESS) {
       NotifyEndCallbackAndClearData(static_cast<BLEStatus>(status),
                                     pending_decl_->service_id);
+      return;
     }
 
+    pending_decl_->in_flight.push_back(*next_entry);
+  }
+
+  if (!pending_decl_->in_flight.empty())
     return;
+
+  // No entries. Call start_service to finish up.
+  bt_status_t status = gatt_iface->GetServerHALInterface()->start_service(
+      server_id_,
+      pending_decl_->service_handle,
+      TRANSPORT_BREDR | TRANSPORT_LE);
+
+  // Terminate the procedure in the case of an error.
+  if (status != BT_STATUS_SUCCESS) {
+    NotifyEndCallbackAndClearData(static_cast<BLEStatus>(status),
+                                  pending_decl_->service_id);
   }
+}
 
-  if (next_entry->id.IsCharacteristic()) {
-    bt_uuid_t char_uuid = next_entry->id.characteristic_uuid().GetBlueDroid();
-    bt_status_t status = gatt_iface->GetServerHALInterface()->
-        add_characteristic(
-            server_id_,
-            pending_decl_->service_handle,
-            &char_uuid,
-            next_entry->char_properties,
-            next_entry->permissions);
+void GattServer::CompletePendingEntry(
+    hal::BluetoothGattInterface* gatt_iface,
+    int status, int service_handle,
+    const UUID& uuid, int handle) {
+  // The declaration may have been terminated while some of its entries were
+  // still being added.
+  if (!pending_decl_ || pending_decl_->in_flight.empty()) {
+    VLOG(1) << "Ignoring result for terminated service declaration";
+    return;
+  }
 
-    // Terminate the procedure in the case of an error.
-    if (status != BT_STATUS_SUCCESS) {
-      NotifyEndCallbackAndClearData(static_cast<BLEStatus>(status),
-                                    pending_decl_->service_id);
-      return;
-    }
+  CHECK(pending_decl_->service_handle == service_handle);
 
-    pending_id_.reset(new GattIdentifier(next_entry->id));
+  AttributeEntry entry = pending_decl_->in_flight.front();
+  pending_decl_->in_flight.pop_front();
+  if (entry.id.IsCharacteristic())
+    CHECK(entry.id.characteristic_uuid() == uuid);
+  else
+    CHECK(entry.id.descriptor_uuid() == uuid);
+
+  if (status != BT_STATUS_SUCCESS) {
+    NotifyEndCallbackAndClearData(static_cast<BLEStatus>(status),
+                                  pending_decl_->service_id);
     return;
   }
 
-  if (next_entry->id.IsDescriptor()) {
-    bt_uuid_t desc_uuid = next_entry->id.descriptor_uuid().GetBlueDroid();
-    bt_status_t status = gatt_iface->GetServerHALInterface()->
-        add_descriptor(
+  // Add this to the handle map and finish up after the last entry.
+  pending_handle_map_[entry.id] = handle;
+  if (pending_decl_->in_flight.empty())
+    SubmitPendingEntries(gatt_iface);
+}
+
+const GattIdentifier* GattServer::GetAttribute(int handle) const {
+  if (handle < 0 || static_cast<size_t>(handle) >= attribute_table_.size())
+    return nullptr;
+
+  const GattIdentifier* gatt_id = &attribute_table_[handle];
+  if (!gatt_id->IsService() && !gatt_id->IsCharacteristic() &&
+      !gatt_id->IsDescriptor())
+    return nullptr;
+
+  return gatt_id;
+}
+
+bool GattServer::SendOrQueueNotification(
+    Connection* conn,
+    const std::vector<uint8_t>& value,
+    OutgoingNotification notification) {
+  CHECK(conn);
+
+  // Anything already queued goes first.
+  if (conn->notification_queue.empty() &&
+      CanSendNotification(*conn, notification.confirm)) {
+    // The HAL API takes char* rather const char* for |value|, so we have to
+    // cast away the const.
+    // TODO(armansito): Make HAL accept const char*.
+    bt_status_t status = hal::BluetoothGattInterface::Get()->
+        GetServerHALInterface()->send_indication(
             server_id_,
-            pending_decl_->service_handle,
-            &desc_uuid,
-            next_entry->permissions);
+            notification.handle,
+            conn->conn_id,
+            value.size(),
+            notification.confirm,
+            reinterpret_cast<char*>(const_cast<uint8_t*>(value.data())));
+    if (status != BT_STATUS_SUCCESS)
+      return false;
+
+    conn->notifications_in_flight.push_back(std::move(notification));
+    return true;
+  }
+
+  if (conn->notification_queue.size() >= kMaxQueuedNotifications) {
+    VLOG(1) << "Notification queue full for connection: " << conn->conn_id;
+    return false;
+  }
 
-    // Terminate the procedure in the case of an error.
+  notification.value = value;
+  conn->notification_queue.push_back(std::move(notification));
+  return true;
+}
+
+bool GattServer::CanSendNotification(const Connection& conn,
+                                     bool confirm) const {
+  if (conn.notifications_in_flight.empty())
+    return true;
+
+  // Nothing else goes out while an indication waits for its confirmation.
+  if (confirm || conn.notifications_in_flight.back().confirm)
+    return false;
+
+  return conn.notifications_in_flight.size() < kMaxNotificationsInFlight;
+}
+
+void GattServer::SendQueuedNotifications(Connection* conn) {
+  CHECK(conn);
+
+  while (!conn->notification_queue.empty() &&
+         CanSendNotification(*conn, conn->notification_queue.front().confirm)) {
+    OutgoingNotification notification =
+        std::move(conn->notification_queue.front());
+    conn->notification_queue.pop_front();
+
+    bt_status_t status = hal::BluetoothGattInterface::Get()->
+        GetServerHALInterface()->send_indication(
+            server_id_,
+            notification.handle,
+            conn->conn_id,
+            notification.value.size(),
+            notification.confirm,
+            reinterpret_cast<char*>(notification.value.data()));
     if (status != BT_STATUS_SUCCESS) {
-      NotifyEndCallbackAndClearData(static_cast<BLEStatus>(status),
-                                    pending_decl_->service_id);
-      return;
+      LOG(ERROR) << "Failed to send queued notification on connection: "
+                 << conn->conn_id;
+      CompleteNotification(std::move(notification.pending_ind),
+                           static_cast<GATTError>(status));
+      continue;
     }
 
-    pending_id_.reset(new GattIdentifier(next_entry->id));
-    return;
+    notification.value.clear();
+    conn->notifications_in_flight.push_back(std::move(notification));
   }
+}
+
+void GattServer::FailNotifications(Connection* conn, GATTError error) {
+  CHECK(conn);
 
-  NOTREACHED() << "Unexpected entry type";
+  std::deque<OutgoingNotification> notifications;
+  notifications.swap(conn->notifications_in_flight);
+  for (auto& notification : conn->notification_queue)
+    notifications.push_back(std::move(notification));
+  conn->notification_queue.clear();
+
+  for (auto& notification : notifications)
+    CompleteNotification(std::move(notification.pending_ind), error);
+}
+
+void GattServer::CompleteNotification(
+    std::shared_ptr<PendingIndication> pending_ind, GATTError error) {
+  if (error == GATT_ERROR_NONE)
+    pending_ind->has_success = true;
+
+  // Invoke it if this was the last reference to the confirmation callback.
+  if (pending_ind.unique() && pending_ind->callback) {
+    pending_ind->callback(
+        pending_ind->has_success ? GATT_ERROR_NONE : error);
+  }
 }
 
 std::shared_ptr<GattServer::Connection> GattServer::GetConnection(
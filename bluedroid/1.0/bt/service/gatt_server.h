@@ -18,6 +18,7 @@
 
 #include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 #include <unordered_set>
@@ -186,11 +187,23 @@ class GattServer : public BluetoothInstance,
   // If |confirm| is true, then |callback| will be run when the remote device
   // sends a ATT Handle-Value Confirmation packet. Otherwise, it will be run as
   // soon as the notification has been sent out.
+  //
+  // Up to kMaxNotificationsInFlight notifications are handed to the stack per
+  // connection without waiting for the previous ones to be sent; further ones
+  // are queued, up to kMaxQueuedNotifications, and go out in order as the
+  // earlier ones complete. An indication waits until nothing else is in flight
+  // and holds back everything queued after it until it is confirmed. A
+  // connection whose queue is full is skipped, so this returns false if all
+  // connections to |device_address| are backed up.
   bool SendNotification(const std::string& device_address,
                         const GattIdentifier& characteristic_id,
                         bool confirm, const std::vector<uint8_t>& value,
                         const GattCallback& callback);
 
+  // See SendNotification.
+  static const size_t kMaxNotificationsInFlight;
+  static const size_t kMaxQueuedNotifications;
+
  private:
   friend class GattServerFactory;
 
@@ -216,6 +229,34 @@ class GattServer : public BluetoothInstance,
     GattIdentifier service_id;
     int service_handle;
     std::deque<AttributeEntry> attributes;
+
+    // Entries that were passed to the stack and whose "added" callbacks have
+    // not arrived yet. The stack reports them in the order they were added.
+    std::deque<AttributeEntry> in_flight;
+  };
+
+  // Used to keep track of a pending Handle-Value indication. It is shared by
+  // all connections it is sent on, as a device may have simultaneous BR/EDR &
+  // LE GATT connections, and records whether at least one of them succeeded.
+  struct PendingIndication {
+    PendingIndication(const GattCallback& callback)
+        : has_success(false), callback(callback) {}
+
+    bool has_success;
+    GattCallback callback;
+  };
+
+  // A Handle-Value notification or indication for one connection. |value| is
+  // only populated while the entry is queued.
+  struct OutgoingNotification {
+    OutgoingNotification(int handle, bool confirm,
+                         const std::shared_ptr<PendingIndication>& pending_ind)
+        : handle(handle), confirm(confirm), pending_ind(pending_ind) {}
+
+    int handle;
+    bool confirm;
+    std::vector<uint8_t> value;
+    std::shared_ptr<PendingIndication> pending_ind;
   };
 
   // Used for the internal remote connection tracking. Keeps track of the
@@ -231,15 +272,11 @@ class GattServer : public BluetoothInstance,
     int conn_id;
     std::unordered_map<int, int> request_id_to_handle;
     bt_bdaddr_t bdaddr;
-  };
 
-  // Used to keep track of a pending Handle-Value indication.
-  struct PendingIndication {
-    PendingIndication(const GattCallback& callback)
-        : has_success(false), callback(callback) {}
-
-    bool has_success;
-    GattCallback callback;
+    // Notifications handed to the stack and waiting for
+    // IndicationSentCallback, oldest first, and the ones waiting to be sent.
+    std::deque<OutgoingNotification> notifications_in_flight;
+    std::deque<OutgoingNotification> notification_queue;
   };
 
   // Constructor shouldn't be called directly as instances are meant to be
@@ -309,8 +346,40 @@ class GattServer : public BluetoothInstance,
                                      const GattIdentifier& id);
   void CleanUpPendingData();
 
-  // Handles the next attribute entry in the pending service declaration.
-  void HandleNextEntry(hal::BluetoothGattInterface* gatt_iface);
+  // Passes all remaining attribute entries of the pending service declaration
+  // to the stack, or starts the service if there are none.
+  void SubmitPendingEntries(hal::BluetoothGattInterface* gatt_iface);
+
+  // Records the handle of the oldest in-flight entry of the pending service
+  // declaration, which must match |uuid|, and starts the service once all
+  // entries are added. Results for a terminated declaration are ignored.
+  void CompletePendingEntry(hal::BluetoothGattInterface* gatt_iface,
+                            int status, int service_handle,
+                            const UUID& uuid, int handle);
+
+  // Returns the identifier of the started attribute at |handle|, or nullptr.
+  const GattIdentifier* GetAttribute(int handle) const;
+
+  // Sends |notification| on |conn| right away if its window allows, and queues
+  // it otherwise. Returns false if the stack refused it or the queue is full.
+  bool SendOrQueueNotification(Connection* conn,
+                               const std::vector<uint8_t>& value,
+                               OutgoingNotification notification);
+
+  // Returns true if a notification or, if |confirm| is true, an indication can
+  // be handed to the stack for |conn| now.
+  bool CanSendNotification(const Connection& conn, bool confirm) const;
+
+  // Sends as many queued notifications of |conn| as its window allows.
+  void SendQueuedNotifications(Connection* conn);
+
+  // Drops every queued and in-flight notification of |conn|.
+  void FailNotifications(Connection* conn, GATTError error);
+
+  // Drops a reference to |pending_ind| and runs its callback if it was the
+  // last one.
+  void CompleteNotification(std::shared_ptr<PendingIndication> pending_ind,
+                            GATTError error);
 
   // Helper method that returns a pointer to an internal Connection instance
   // that matches the given parameters.
@@ -333,9 +402,11 @@ class GattServer : public BluetoothInstance,
   ResultCallback pending_end_decl_cb_;
   std::unordered_map<GattIdentifier, int> pending_handle_map_;
 
-  // Mapping of handles and GATT identifiers for started services.
+  // Mapping of GATT identifiers to handles for started services, and the
+  // reverse mapping, indexed by attribute handle. Handles that don't belong to
+  // a started attribute hold a default-constructed GattIdentifier.
   std::unordered_map<GattIdentifier, int> id_to_handle_map_;
-  std::unordered_map<int, GattIdentifier> handle_to_id_map_;
+  std::vector<GattIdentifier> attribute_table_;
 
   // GATT connection mappings from stack-provided "conn_id" IDs and remote
   // device addresses to Connection structures. The conn_id map is one-to-one
@@ -345,13 +416,6 @@ class GattServer : public BluetoothInstance,
   std::unordered_map<std::string, std::vector<std::shared_ptr<Connection>>>
       conn_addr_map_;
 
-  // Connections for which a Handle-Value indication is pending. Since there can
-  // be multiple indications to the same device (in the case of a dual-mode
-  // device with simulatenous BR/EDR & LE GATT connections), we also keep track
-  // of whether there has been at least one successful confirmation.
-  std::unordered_map<int, std::shared_ptr<PendingIndication>>
-      pending_indications_;
-
   // Raw handle to the Delegate, which must outlive this GattServer instance.
   Delegate* delegate_;
 
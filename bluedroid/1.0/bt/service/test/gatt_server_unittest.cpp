@@ -586,10 +586,13 @@ TEST_F(GattServerPostRegisterTest, AddCharacteristic) {
   // progress.
   EXPECT_EQ(nullptr, gatt_server_->AddCharacteristic(char_uuid, props, perms));
 
+  // All characteristics are added as soon as the service is, and each restart
+  // adds them again.
   EXPECT_CALL(*mock_handler_, AddCharacteristic(_, _, _, _, _))
-      .Times(8)
+      .Times(9)
       .WillOnce(Return(BT_STATUS_FAIL))      // char_id0 - try 1
       .WillOnce(Return(BT_STATUS_SUCCESS))   // char_id0 - try 2
+      .WillOnce(Return(BT_STATUS_SUCCESS))   // char_id1 - try 2
       .WillOnce(Return(BT_STATUS_SUCCESS))   // char_id0 - try 3
       .WillOnce(Return(BT_STATUS_FAIL))      // char_id1 - try 3
       .WillOnce(Return(BT_STATUS_SUCCESS))   // char_id0 - try 4
@@ -597,7 +600,7 @@ TEST_F(GattServerPostRegisterTest, AddCharacteristic) {
       .WillOnce(Return(BT_STATUS_SUCCESS))   // char_id0 - try 5
       .WillOnce(Return(BT_STATUS_SUCCESS));  // char_id1 - try 5
 
-  // First AddCharacteristic call will fail.
+  // First AddCharacteristic call will fail. The second one is never made.
   fake_hal_gatt_iface_->NotifyServiceAddedCallback(
       BT_STATUS_SUCCESS, kDefaultServerId, hal_id, srvc_handle);
   EXPECT_EQ(1, cb_count);
@@ -615,7 +618,7 @@ TEST_F(GattServerPostRegisterTest, AddCharacteristic) {
       BT_STATUS_SUCCESS, kDefaultServerId, hal_id, srvc_handle);
   EXPECT_EQ(1, cb_count);
 
-  // Report failure for pending AddCharacteristic.
+  // Report failure for the first pending AddCharacteristic.
   fake_hal_gatt_iface_->NotifyCharacteristicAddedCallback(
       BT_STATUS_FAIL, kDefaultServerId, hal_char_uuid,
       srvc_handle, char_handle0);
@@ -623,6 +626,12 @@ TEST_F(GattServerPostRegisterTest, AddCharacteristic) {
   EXPECT_NE(BLE_STATUS_SUCCESS, cb_status);
   EXPECT_TRUE(cb_id == *service_id);
 
+  // The result for the second characteristic should get ignored.
+  fake_hal_gatt_iface_->NotifyCharacteristicAddedCallback(
+      BT_STATUS_SUCCESS, kDefaultServerId, hal_char_uuid,
+      srvc_handle, char_handle1);
+  EXPECT_EQ(2, cb_count);
+
   // Restart. (try 3)
   service_id = gatt_server_->BeginServiceDeclaration(service_uuid, true);
   char_id0 = gatt_server_->AddCharacteristic(char_uuid, props, perms);
@@ -630,18 +639,18 @@ TEST_F(GattServerPostRegisterTest, AddCharacteristic) {
   hal::GetHALServiceId(*service_id, &hal_id);
   EXPECT_TRUE(gatt_server_->EndServiceDeclaration(callback));
 
+  // The call for the second characteristic will fail right away.
   fake_hal_gatt_iface_->NotifyServiceAddedCallback(
       BT_STATUS_SUCCESS, kDefaultServerId, hal_id, srvc_handle);
-  EXPECT_EQ(2, cb_count);
+  EXPECT_EQ(3, cb_count);
+  EXPECT_NE(BLE_STATUS_SUCCESS, cb_status);
+  EXPECT_TRUE(cb_id == *service_id);
 
-  // Report success for pending AddCharacteristic we should receive a call for
-  // the second characteristic which will fail.
+  // The result for the first characteristic should get ignored.
   fake_hal_gatt_iface_->NotifyCharacteristicAddedCallback(
       BT_STATUS_SUCCESS, kDefaultServerId, hal_char_uuid,
       srvc_handle, char_handle0);
   EXPECT_EQ(3, cb_count);
-  EXPECT_NE(BLE_STATUS_SUCCESS, cb_status);
-  EXPECT_TRUE(cb_id == *service_id);
 
   // Restart. (try 4)
   service_id = gatt_server_->BeginServiceDeclaration(service_uuid, true);
@@ -654,8 +663,8 @@ TEST_F(GattServerPostRegisterTest, AddCharacteristic) {
       BT_STATUS_SUCCESS, kDefaultServerId, hal_id, srvc_handle);
   EXPECT_EQ(3, cb_count);
 
-  // Report success for pending AddCharacteristic. Second characteristic call
-  // will start normally. We shouldn't receive any new callback.
+  // Report success for the first pending AddCharacteristic. We shouldn't
+  // receive any new callback.
   fake_hal_gatt_iface_->NotifyCharacteristicAddedCallback(
       BT_STATUS_SUCCESS, kDefaultServerId, hal_char_uuid,
       srvc_handle, char_handle0);
@@ -681,8 +690,8 @@ TEST_F(GattServerPostRegisterTest, AddCharacteristic) {
       BT_STATUS_SUCCESS, kDefaultServerId, hal_id, srvc_handle);
   EXPECT_EQ(4, cb_count);
 
-  // Report success for pending AddCharacteristic. Second characteristic call
-  // will start normally. We shouldn't receive any new callback.
+  // Report success for the first pending AddCharacteristic. We shouldn't
+  // receive any new callback.
   fake_hal_gatt_iface_->NotifyCharacteristicAddedCallback(
       BT_STATUS_SUCCESS, kDefaultServerId, hal_char_uuid,
       srvc_handle, char_handle0);
@@ -769,14 +778,13 @@ TEST_F(GattServerPostRegisterTest, AddDescriptor) {
   // Cannot add any more descriptors while EndServiceDeclaration is in progress.
   EXPECT_EQ(nullptr, gatt_server_->AddDescriptor(desc_uuid, perms));
 
-  fake_hal_gatt_iface_->NotifyServiceAddedCallback(
-      BT_STATUS_SUCCESS, kDefaultServerId, hal_id, srvc_handle);
-  EXPECT_EQ(0, cb_count);
-
+  // All attributes are added as soon as the service is, and each restart adds
+  // them again.
   EXPECT_CALL(*mock_handler_, AddDescriptor(_, _, _, _))
-      .Times(8)
+      .Times(9)
       .WillOnce(Return(BT_STATUS_FAIL))      // desc_id0 - try 1
       .WillOnce(Return(BT_STATUS_SUCCESS))   // desc_id0 - try 2
+      .WillOnce(Return(BT_STATUS_SUCCESS))   // desc_id1 - try 2
       .WillOnce(Return(BT_STATUS_SUCCESS))   // desc_id0 - try 3
       .WillOnce(Return(BT_STATUS_FAIL))      // desc_id1 - try 3
       .WillOnce(Return(BT_STATUS_SUCCESS))   // desc_id0 - try 4
@@ -784,17 +792,21 @@ TEST_F(GattServerPostRegisterTest, AddDescriptor) {
       .WillOnce(Return(BT_STATUS_SUCCESS))   // desc_id0 - try 5
       .WillOnce(Return(BT_STATUS_SUCCESS));  // desc_id1 - try 5
 
-  // Notify success for both characteristics. First descriptor call will fail.
+  // First descriptor call will fail.
+  fake_hal_gatt_iface_->NotifyServiceAddedCallback(
+      BT_STATUS_SUCCESS, kDefaultServerId, hal_id, srvc_handle);
+  EXPECT_EQ(1, cb_count);
+  EXPECT_NE(BLE_STATUS_SUCCESS, cb_status);
+  EXPECT_TRUE(cb_id == *service_id);
+
+  // Results for the characteristics should get ignored.
   fake_hal_gatt_iface_->NotifyCharacteristicAddedCallback(
       BT_STATUS_SUCCESS, kDefaultServerId, hal_char_uuid0,
       srvc_handle, char_handle0);
-  EXPECT_EQ(0, cb_count);
   fake_hal_gatt_iface_->NotifyCharacteristicAddedCallback(
       BT_STATUS_SUCCESS, kDefaultServerId, hal_char_uuid1,
       srvc_handle, char_handle1);
   EXPECT_EQ(1, cb_count);
-  EXPECT_NE(BLE_STATUS_SUCCESS, cb_status);
-  EXPECT_TRUE(cb_id == *service_id);
 
   // Restart (try 2)
   cb_count = 0;
@@ -828,6 +840,12 @@ TEST_F(GattServerPostRegisterTest, AddDescriptor) {
   EXPECT_NE(BLE_STATUS_SUCCESS, cb_status);
   EXPECT_TRUE(cb_id == *service_id);
 
+  // The result for the second descriptor should get ignored.
+  fake_hal_gatt_iface_->NotifyDescriptorAddedCallback(
+      BT_STATUS_SUCCESS, kDefaultServerId, hal_desc_uuid,
+      srvc_handle, desc_handle1);
+  EXPECT_EQ(1, cb_count);
+
   // Restart (try 3)
   cb_count = 0;
   service_id = gatt_server_->BeginServiceDeclaration(service_uuid, true);
@@ -840,23 +858,9 @@ TEST_F(GattServerPostRegisterTest, AddDescriptor) {
   ASSERT_NE(nullptr, desc_id1);
   EXPECT_TRUE(gatt_server_->EndServiceDeclaration(callback));
 
+  // The second descriptor call will fail right away.
   fake_hal_gatt_iface_->NotifyServiceAddedCallback(
       BT_STATUS_SUCCESS, kDefaultServerId, hal_id, srvc_handle);
-  EXPECT_EQ(0, cb_count);
-  fake_hal_gatt_iface_->NotifyCharacteristicAddedCallback(
-      BT_STATUS_SUCCESS, kDefaultServerId, hal_char_uuid0,
-      srvc_handle, char_handle0);
-  EXPECT_EQ(0, cb_count);
-  fake_hal_gatt_iface_->NotifyCharacteristicAddedCallback(
-      BT_STATUS_SUCCESS, kDefaultServerId, hal_char_uuid1,
-      srvc_handle, char_handle1);
-  EXPECT_EQ(0, cb_count);
-
-  // Notify success for first descriptor; the second descriptor will fail
-  // immediately.
-  fake_hal_gatt_iface_->NotifyDescriptorAddedCallback(
-      BT_STATUS_SUCCESS, kDefaultServerId, hal_desc_uuid,
-      srvc_handle, desc_handle0);
   EXPECT_EQ(1, cb_count);
   EXPECT_NE(BLE_STATUS_SUCCESS, cb_status);
   EXPECT_TRUE(cb_id == *service_id);
@@ -1281,19 +1285,47 @@ TEST_F(GattServerPostRegisterTest, SendNotification) {
       kTestAddress0,
       test_char_id_, true, value, callback));
 
-  // Calls are already pending.
-  EXPECT_FALSE(gatt_server_->SendNotification(
+  // Calls are already pending, so this one gets queued on both connections.
+  EXPECT_TRUE(gatt_server_->SendNotification(
       kTestAddress0, test_char_id_, true, value, callback));
 
-  // Trigger one confirmation callback. We should get calls for two callbacks
-  // since we have two separate calls pending.
+  // Complete the notification on |kConnId0|. Its callback runs and the first
+  // indication queued behind it goes out.
+  EXPECT_CALL(*mock_handler_,
+              SendIndication(kDefaultServerId, char_handle_, kConnId0,
+                             value.size(), 1, nullptr))
+      .Times(2)
+      .WillRepeatedly(Return(BT_STATUS_SUCCESS));
   fake_hal_gatt_iface_->NotifyIndicationSentCallback(
       kConnId0, BT_STATUS_SUCCESS);
+  EXPECT_EQ(1, callback_count);
+
+  // Confirm the first indication on |kConnId1|. It is still pending on
+  // |kConnId0|, so no callback runs yet, but the second indication goes out.
+  EXPECT_CALL(*mock_handler_,
+              SendIndication(kDefaultServerId, char_handle_, kConnId1,
+                             value.size(), 1, nullptr))
+      .Times(1)
+      .WillOnce(Return(BT_STATUS_SUCCESS));
   fake_hal_gatt_iface_->NotifyIndicationSentCallback(
       kConnId1, BT_STATUS_SUCCESS);
+  EXPECT_EQ(1, callback_count);
+
+  // Confirm the first indication on |kConnId0|.
+  fake_hal_gatt_iface_->NotifyIndicationSentCallback(
+      kConnId0, BT_STATUS_SUCCESS);
   EXPECT_EQ(2, callback_count);
+
+  // Confirm the second indication on both connections.
+  fake_hal_gatt_iface_->NotifyIndicationSentCallback(
+      kConnId0, BT_STATUS_SUCCESS);
+  fake_hal_gatt_iface_->NotifyIndicationSentCallback(
+      kConnId1, BT_STATUS_SUCCESS);
+  EXPECT_EQ(3, callback_count);
   EXPECT_EQ(GATT_ERROR_NONE, gatt_error);
 
+  testing::Mock::VerifyAndClearExpectations(mock_handler_.get());
+
   callback_count = 0;
 
   // Restart. Both calls succeed now.
@@ -1332,5 +1364,68 @@ TEST_F(GattServerPostRegisterTest, SendNotification) {
   EXPECT_EQ(GATT_ERROR_NONE, gatt_error);
 }
 
+TEST_F(GattServerPostRegisterTest, SendNotificationQueue) {
+  SetUpTestService();
+
+  const std::string kTestAddress = "01:23:45:67:89:AB";
+  const int kConnId = 0;
+  const int kInFlight = GattServer::kMaxNotificationsInFlight;
+  const int kQueued = GattServer::kMaxQueuedNotifications;
+  std::vector<uint8_t> value;
+  bt_bdaddr_t hal_addr;
+  ASSERT_TRUE(util::BdAddrFromString(kTestAddress, &hal_addr));
+
+  fake_hal_gatt_iface_->NotifyServerConnectionCallback(
+      kConnId, kDefaultServerId, true, hal_addr);
+
+  GATTError gatt_error = GATT_ERROR_NONE;
+  int callback_count = 0;
+  auto callback = [&](GATTError in_error) {
+    gatt_error = in_error;
+    callback_count++;
+  };
+
+  // The first notifications are handed to the stack right away and the rest
+  // get queued until the queue is full.
+  EXPECT_CALL(*mock_handler_,
+              SendIndication(kDefaultServerId, char_handle_, kConnId,
+                             value.size(), 0, nullptr))
+      .Times(kInFlight)
+      .WillRepeatedly(Return(BT_STATUS_SUCCESS));
+  for (int i = 0; i < kInFlight + kQueued; i++) {
+    EXPECT_TRUE(gatt_server_->SendNotification(
+        kTestAddress, test_char_id_, false, value, callback));
+  }
+  EXPECT_FALSE(gatt_server_->SendNotification(
+      kTestAddress, test_char_id_, false, value, callback));
+  EXPECT_EQ(0, callback_count);
+
+  testing::Mock::VerifyAndClearExpectations(mock_handler_.get());
+
+  // Each completed notification makes room for a queued one.
+  EXPECT_CALL(*mock_handler_,
+              SendIndication(kDefaultServerId, char_handle_, kConnId,
+                             value.size(), 0, nullptr))
+      .Times(1)
+      .WillOnce(Return(BT_STATUS_SUCCESS));
+  fake_hal_gatt_iface_->NotifyIndicationSentCallback(
+      kConnId, BT_STATUS_SUCCESS);
+  EXPECT_EQ(1, callback_count);
+  EXPECT_EQ(GATT_ERROR_NONE, gatt_error);
+
+  testing::Mock::VerifyAndClearExpectations(mock_handler_.get());
+
+  // Disconnecting fails everything that is still pending.
+  fake_hal_gatt_iface_->NotifyServerConnectionCallback(
+      kConnId, kDefaultServerId, false, hal_addr);
+  EXPECT_EQ(kInFlight + kQueued, callback_count);
+  EXPECT_NE(GATT_ERROR_NONE, gatt_error);
+
+  // Late results for the connection are ignored.
+  fake_hal_gatt_iface_->NotifyIndicationSentCallback(
+      kConnId, BT_STATUS_SUCCESS);
+  EXPECT_EQ(kInFlight + kQueued, callback_count);
+}
+
 }  // namespace
 }  // namespace bluetooth
@@ -1130,6 +1130,30 @@ UINT16 AVDT_GetSignalChannel(UINT8 handle, BD_ADDR bd_addr)
 }
 
 #if AVDT_MULTIPLEXING == TRUE
+/*******************************************************************************
+**
+** Function         AVDT_GetWriteStats
+**
+** Description      Get the media write statistics of the given handle,
+**                  counted since the stream was created.
+**
+** Returns          AVDT_SUCCESS if successful, otherwise error.
+**
+*******************************************************************************/
+UINT16 AVDT_GetWriteStats(UINT8 handle, tAVDT_WRITE_STATS *p_stats)
+{
+    tAVDT_SCB       *p_scb;
+
+    /* map handle to scb */
+    if ((p_scb = avdt_scb_by_hdl(handle)) == NULL)
+    {
+        return AVDT_BAD_HANDLE;
+    }
+
+    *p_stats = p_scb->write_stats;
+    return AVDT_SUCCESS;
+}
+
 /*******************************************************************************
 **
 ** Function         AVDT_SetMediaBuf
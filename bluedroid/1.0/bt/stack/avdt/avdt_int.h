@@ -501,6 +501,7 @@ typedef struct {
     UINT8           curr_evt;       /* current event; set only by state machine */
     BOOLEAN         cong;           /* Whether media transport channel is congested */
     UINT8           close_code;     /* Error code received in close response */
+    tAVDT_WRITE_STATS write_stats;  /* media write statistics */
 #if AVDT_MULTIPLEXING == TRUE
     fixed_queue_t   *frag_q;        /* Queue for outgoing media fragments */
     UINT32          frag_off;       /* length of already received media fragments */
@@ -1209,6 +1209,46 @@ void avdt_scb_hdl_tc_open_sto(tAVDT_SCB *p_scb, tAVDT_SCB_EVT *p_data)
 }
 #endif
 
+/*******************************************************************************
+**
+** Function         avdt_scb_ensure_headroom
+**
+** Description      Counts a media packet in the write statistics and, if its
+**                  offset has no room for the media packet header and the
+**                  L2CAP headers, replaces it with a copy that has.  The
+**                  headers are then written in place all the way down.
+**
+** Returns          Nothing.
+**
+*******************************************************************************/
+static void avdt_scb_ensure_headroom(tAVDT_SCB *p_scb, tAVDT_SCB_APIWRITE *p_write)
+{
+    BT_HDR  *p_buf = p_write->p_buf;
+    UINT16  headroom = L2CAP_BASIC_MIN_OFFSET;
+
+    if (!(p_write->opt & AVDT_DATA_OPT_NO_RTP))
+        headroom += AVDT_MEDIA_HDR_SIZE;
+
+    p_scb->write_stats.num_pkts++;
+    if (p_buf->offset >= headroom)
+        return;
+
+    AVDT_TRACE_WARNING("%s: copying media packet with offset %d, needs %d",
+                       __func__, p_buf->offset, headroom);
+
+    BT_HDR *p_copy = (BT_HDR *)osi_malloc(BT_HDR_SIZE + AVDT_MEDIA_OFFSET + p_buf->len);
+    p_copy->event = p_buf->event;
+    p_copy->len = p_buf->len;
+    p_copy->offset = AVDT_MEDIA_OFFSET;
+    p_copy->layer_specific = p_buf->layer_specific;
+    memcpy((UINT8 *)(p_copy + 1) + p_copy->offset,
+           (UINT8 *)(p_buf + 1) + p_buf->offset, p_buf->len);
+    osi_free(p_buf);
+    p_write->p_buf = p_copy;
+
+    p_scb->write_stats.num_copies++;
+}
+
 /*******************************************************************************
 **
 ** Function         avdt_scb_hdl_write_req_no_frag
@@ -1240,6 +1280,8 @@ void avdt_scb_hdl_write_req_no_frag(tAVDT_SCB *p_scb, tAVDT_SCB_EVT *p_data)
         p_data->apiwrite.opt |= AVDT_DATA_OPT_NO_RTP;
     }
 #endif //#if (MTK_A2DP_SRC_APTX_CODEC == TRUE)
+    avdt_scb_ensure_headroom(p_scb, &p_data->apiwrite);
+
     if ( !(p_data->apiwrite.opt & AVDT_DATA_OPT_NO_RTP) )
     {
         ssrc = avdt_scb_gen_ssrc(p_scb);
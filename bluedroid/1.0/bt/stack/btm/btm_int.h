@@ -406,6 +406,12 @@ typedef struct
     UINT16           hci_handle;        /* HCI Handle                   */
     BOOLEAN          is_orig;           /* TRUE if the originator       */
     BOOLEAN          rem_bd_known;      /* TRUE if remote BD addr known */
+    UINT64           setup_start_us;    /* When the (e)SCO setup started */
+#if BTM_SCO_HCI_INCLUDED == TRUE
+    UINT64           last_rx_us;        /* When the last SCO packet arrived */
+    UINT32           last_rx_gap_us;    /* Time between the last two packets */
+#endif
+    tBTM_SCO_STATS   stats;             /* See BTM_ReadScoStats() */
 
 } tSCO_CONN;
 
@@ -35,6 +35,7 @@
 #include "hcidefs.h"
 #include "bt_utils.h"
 #include "device/include/controller.h"
+#include "osi/include/time.h"
 
 
 #if BTM_SCO_INCLUDED == TRUE
@@ -148,7 +149,6 @@ void btm_sco_flush_sco_data(UINT16 sco_inx)
         p = &btm_cb.sco_cb.sco_db[sco_inx];
         while ((p_buf = (BT_HDR *)fixed_queue_try_dequeue(p->xmit_data_q)) != NULL)
             osi_free(p_buf);
-        }
     }
 #else
     UNUSED(sco_inx);
@@ -184,6 +184,27 @@ void btm_sco_init (void)
     btm_cb.sco_cb.desired_sco_mode = BTM_DEFAULT_SCO_MODE;
 }
 
+/*******************************************************************************
+**
+** Function         btm_sco_setup_started
+**
+** Description      This function is called when we request a SCO link or the
+**                  peer does, to time its setup and to clear the statistics
+**                  of the previous connection on this instance.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void btm_sco_setup_started (tSCO_CONN *p)
+{
+    p->setup_start_us = time_get_os_boottime_us();
+    memset(&p->stats, 0, sizeof(p->stats));
+#if BTM_SCO_HCI_INCLUDED == TRUE
+    p->last_rx_us = 0;
+    p->last_rx_gap_us = 0;
+#endif
+}
+
 /*******************************************************************************
 **
 ** Function         btm_esco_conn_rsp
@@ -352,6 +373,44 @@ void btm_sco_check_send_pkts (UINT16 sco_inx)
         HCI_SCO_DATA_TO_LOWER(p_buf);
     }
 }
+
+/*******************************************************************************
+**
+** Function         btm_sco_rx_stats
+**
+** Description      This function accounts a SCO packet received over HCI and
+**                  updates the interarrival jitter of the link.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void btm_sco_rx_stats (tSCO_CONN *p, UINT8 pkt_status)
+{
+    UINT64  now_us = time_get_os_boottime_us();
+    UINT32  gap_us;
+    UINT32  delta_us;
+
+    p->stats.rx_pkts++;
+    if (pkt_status != BTM_SCO_DATA_CORRECT)
+        p->stats.rx_errs++;
+
+    if (p->last_rx_us != 0)
+    {
+        gap_us = (UINT32)(now_us - p->last_rx_us);
+        if (gap_us > p->stats.rx_max_gap_us)
+            p->stats.rx_max_gap_us = gap_us;
+
+        /* J += (|D| - J) / 16, D being the change of the interarrival time */
+        if (p->last_rx_gap_us != 0)
+        {
+            delta_us = (gap_us > p->last_rx_gap_us) ? (gap_us - p->last_rx_gap_us)
+                                                     : (p->last_rx_gap_us - gap_us);
+            p->stats.rx_jitter_us += ((INT32)delta_us - (INT32)p->stats.rx_jitter_us) / 16;
+        }
+        p->last_rx_gap_us = gap_us;
+    }
+    p->last_rx_us = now_us;
+}
 #endif /* BTM_SCO_HCI_INCLUDED == TRUE */
 
 /*******************************************************************************
@@ -380,6 +439,8 @@ void  btm_route_sco_data(BT_HDR *p_msg)
 
     if ((sco_inx = btm_find_scb_by_handle(handle)) != BTM_MAX_SCO_LINKS )
     {
+        btm_sco_rx_stats(&btm_cb.sco_cb.sco_db[sco_inx], pkt_status);
+
         /* send data callback */
         if (!btm_cb.sco_cb.p_data_cb )
             /* if no data callback registered,  just free the buffer  */
@@ -456,6 +517,7 @@ tBTM_STATUS BTM_WriteScoData (UINT16 sco_inx, BT_HDR *p_buf)
             p_buf->len += HCI_SCO_PREAMBLE_SIZE;
 
             fixed_queue_enqueue(p_ccb->xmit_data_q, p_buf);
+            p_ccb->stats.tx_pkts++;
 
             btm_sco_check_send_pkts (sco_inx);
         }
@@ -807,6 +869,7 @@ tBTM_STATUS BTM_CreateSco (BD_ADDR remote_bda, BOOLEAN is_orig, UINT16 pkt_types
             p->p_disc_cb  = p_disc_cb;
             p->hci_handle = BTM_INVALID_HCI_HANDLE;
             p->is_orig = is_orig;
+            btm_sco_setup_started(p);
 
             if( p->state != SCO_ST_PEND_UNPARK )
             {
@@ -984,6 +1047,10 @@ void btm_sco_conn_req (BD_ADDR bda,  DEV_CLASS dev_class, UINT8 link_type)
             p->state = SCO_ST_W4_CONN_RSP;
             memcpy (p->esco.data.bd_addr, bda, BD_ADDR_LEN);
 
+            /* A racing request of ours keeps its own start time */
+            if (!p->is_orig)
+                btm_sco_setup_started(p);
+
             /* If no callback, auto-accept the connection if packet types match */
             if (!p->esco.p_esco_cback)
             {
@@ -1027,6 +1094,7 @@ void btm_sco_conn_req (BD_ADDR bda,  DEV_CLASS dev_class, UINT8 link_type)
             {
                 p->is_orig = FALSE;
                 p->state = SCO_ST_LISTENING;
+                btm_sco_setup_started(p);
 
                 p->esco.data.link_type = link_type;
                 memcpy (p->esco.data.bd_addr, bda, BD_ADDR_LEN);
@@ -1117,6 +1185,10 @@ void btm_sco_connected (UINT8 hci_status, BD_ADDR bda, UINT16 hci_handle,
             p->state = SCO_ST_CONNECTED;
             p->hci_handle = hci_handle;
 
+            p->stats.setup_ms = (UINT32)((time_get_os_boottime_us() - p->setup_start_us) / 1000);
+            BTM_TRACE_EVENT("%s: (e)SCO handle 0x%04x set up in %u ms", __func__,
+                            hci_handle, p->stats.setup_ms);
+
             if (!btm_cb.sco_cb.esco_supported)
             {
                 p->esco.data.link_type = BTM_LINK_TYPE_SCO;
@@ -1278,6 +1350,11 @@ void btm_sco_removed (UINT16 hci_handle, UINT8 reason)
     {
         if ((p->state != SCO_ST_UNUSED) && (p->state != SCO_ST_LISTENING) && (p->hci_handle == hci_handle))
         {
+            BTM_TRACE_EVENT("%s: (e)SCO handle 0x%04x setup %u ms, rx %u (%u bad) jitter %u us "
+                            "max gap %u us, tx %u", __func__, hci_handle, p->stats.setup_ms,
+                            p->stats.rx_pkts, p->stats.rx_errs, p->stats.rx_jitter_us,
+                            p->stats.rx_max_gap_us, p->stats.tx_pkts);
+
             btm_sco_flush_sco_data(xx);
 
             p->state = SCO_ST_UNUSED;
@@ -1508,6 +1585,30 @@ UINT8 *BTM_ReadScoBdAddr (UINT16 sco_inx)
 #endif
 }
 
+/*******************************************************************************
+**
+** Function         BTM_ReadScoStats
+**
+** Description      This function returns the setup latency of a SCO link and,
+**                  when SCO is routed over HCI, its packet counts and jitter,
+**                  for the current or the last connection of the instance.
+**
+** Returns          BTM_SUCCESS if the statistics were copied to p_stats.
+**                  BTM_UNKNOWN_ADDR: invalid SCO index.
+**
+*******************************************************************************/
+tBTM_STATUS BTM_ReadScoStats (UINT16 sco_inx, tBTM_SCO_STATS *p_stats)
+{
+#if (BTM_MAX_SCO_LINKS>0)
+    if (sco_inx < BTM_MAX_SCO_LINKS)
+    {
+        *p_stats = btm_cb.sco_cb.sco_db[sco_inx].stats;
+        return (BTM_SUCCESS);
+    }
+#endif
+    return (BTM_UNKNOWN_ADDR);
+}
+
 /*******************************************************************************
 **
 ** Function         BTM_SetEScoMode
@@ -1936,5 +2037,6 @@ tBTM_STATUS BTM_ReadEScoLinkParms (UINT16 sco_inx, tBTM_ESCO_DATA *p_parms) { re
 tBTM_STATUS BTM_ChangeEScoLinkParms (UINT16 sco_inx, tBTM_CHG_ESCO_PARAMS *p_parms) { return (BTM_MODE_UNSUPPORTED);}
 void BTM_EScoConnRsp (UINT16 sco_inx, UINT8 hci_status, tBTM_ESCO_PARAMS *p_parms) {}
 UINT8 BTM_GetNumScoLinks (void)  {return (0);}
+tBTM_STATUS BTM_ReadScoStats (UINT16 sco_inx, tBTM_SCO_STATS *p_stats) {return (BTM_UNKNOWN_ADDR);}
 
 #endif /* If SCO is being used */
@@ -87,6 +87,7 @@ extern void b3ds_process_timeout(UNUSED_ATTR void *data);
 #endif
 
 extern void BTE_InitStack(void);
+extern BOOLEAN bte_main_wait_hci_start_up(void);
 
 /* Define BTU storage area
 */
@@ -168,14 +169,6 @@ static void btu_hci_msg_process(BT_HDR *p_msg) {
 }
 
 void btu_task_start_up(UNUSED_ATTR void *context) {
-  BT_TRACE(TRACE_LAYER_BTU, TRACE_TYPE_API,
-      "btu_task pending for preload complete event");
-
-  LOG_INFO(LOG_TAG, "Bluetooth chip preload is complete");
-
-  BT_TRACE(TRACE_LAYER_BTU, TRACE_TYPE_API,
-      "btu_task received preload complete event");
-
   /* Initialize the mandatory core stack control blocks
      (BTU, BTM, L2CAP, and SDP)
    */
@@ -193,6 +186,19 @@ void btu_task_start_up(UNUSED_ATTR void *context) {
   module_init(get_module(BTE_LOGMSG_MODULE));
 #endif
 
+  // The control blocks above do not touch the controller, so they were set
+  // up while its firmware was downloaded. Everything from here on may.
+  BT_TRACE(TRACE_LAYER_BTU, TRACE_TYPE_API,
+      "btu_task pending for preload complete event");
+
+  if (bte_main_wait_hci_start_up())
+    LOG_INFO(LOG_TAG, "Bluetooth chip preload is complete");
+  else
+    LOG_ERROR(LOG_TAG, "%s HCI module failed to start up", __func__);
+
+  BT_TRACE(TRACE_LAYER_BTU, TRACE_TYPE_API,
+      "btu_task received preload complete event");
+
   // Inform the bt jni thread initialization is ok.
   btif_transfer_context(btif_init_ok, 0, NULL, 0, NULL);
 
@@ -408,6 +408,14 @@ typedef struct {
 
 typedef UINT8 tAVDT_DATA_OPT_MASK;
 
+/* Media write statistics of a stream, returned by AVDT_GetWriteStats.
+** A packet is copied when its offset leaves no room for the media packet
+** header and L2CAP_BASIC_MIN_OFFSET, so an encoder honouring the
+** AVDT_WriteReq offset rule sees num_copies stay at 0. */
+typedef struct {
+    UINT32          num_pkts;           /* Media packets written */
+    UINT32          num_copies;         /* Packets copied for lack of headroom */
+} tAVDT_WRITE_STATS;
 
 
 /*****************************************************************************
@@ -894,6 +902,18 @@ extern UINT16 AVDT_GetL2CapChannel(UINT8 handle);
 *******************************************************************************/
 extern UINT16 AVDT_GetSignalChannel(UINT8 handle, BD_ADDR bd_addr);
 
+/*******************************************************************************
+**
+** Function         AVDT_GetWriteStats
+**
+** Description      Get the media write statistics of the given handle,
+**                  counted since the stream was created.
+**
+** Returns          AVDT_SUCCESS if successful, otherwise error.
+**
+*******************************************************************************/
+extern UINT16 AVDT_GetWriteStats(UINT8 handle, tAVDT_WRITE_STATS *p_stats);
+
 /*******************************************************************************
 **
 ** Function         AVDT_SetMediaBuf
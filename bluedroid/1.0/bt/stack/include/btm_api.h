@@ -1105,6 +1105,17 @@ typedef struct
     UINT8   air_mode;
 } tBTM_ESCO_DATA;
 
+/* Returned by BTM_ReadScoStats() */
+typedef struct
+{
+    UINT32  setup_ms;       /* from the setup request (or the peer's) to connection complete */
+    UINT32  rx_pkts;        /* packets received over HCI */
+    UINT32  rx_errs;        /* received packets the controller flagged as erroneous or lost */
+    UINT32  rx_jitter_us;   /* interarrival jitter, smoothed as in RFC 3550 */
+    UINT32  rx_max_gap_us;  /* longest time between two received packets */
+    UINT32  tx_pkts;        /* packets written with BTM_WriteScoData() */
+} tBTM_SCO_STATS;
+
 typedef struct
 {
     UINT16  sco_inx;
@@ -4021,6 +4032,20 @@ extern tBTM_STATUS BTM_ConfigScoPath (tBTM_SCO_ROUTE_TYPE path,
 *******************************************************************************/
 extern tBTM_STATUS BTM_WriteScoData (UINT16 sco_inx, BT_HDR *p_buf);
 
+/*******************************************************************************
+**
+** Function         BTM_ReadScoStats
+**
+** Description      This function returns the setup latency of a SCO link and,
+**                  when SCO is routed over HCI, its packet counts and jitter,
+**                  for the current or the last connection of the instance.
+**
+** Returns          BTM_SUCCESS if the statistics were copied to p_stats.
+**                  BTM_UNKNOWN_ADDR: invalid SCO index.
+**
+*******************************************************************************/
+extern tBTM_STATUS BTM_ReadScoStats (UINT16 sco_inx, tBTM_SCO_STATS *p_stats);
+
 /*******************************************************************************
 **
 ** Function         BTM_SetARCMode
@@ -39,6 +39,11 @@
 */
 #define L2CAP_MIN_OFFSET    13     /* plus control(2), SDU length(2) */
 
+/* The part of L2CAP_MIN_OFFSET used by a basic mode channel, which writes
+** its headers in place. A packet with a smaller offset is copied.
+*/
+#define L2CAP_BASIC_MIN_OFFSET  9
+
 #define L2CAP_LCC_SDU_LENGTH    2
 #define L2CAP_LCC_OFFSET        (L2CAP_MIN_OFFSET + L2CAP_LCC_SDU_LENGTH)  /* plus SDU length(2) */
 
@@ -63,6 +68,17 @@
 
 typedef UINT8 tL2CAP_CHNL_PRIORITY;
 
+/* Transmit statistics of a channel, returned by L2CA_GetChnlTxStats. The
+** wait of a packet is the time it spent at the head of the channel queue
+** before the link scheduler sent it. */
+typedef struct
+{
+    UINT32  num_pkts;           /* Packets sent to the controller */
+    UINT32  total_wait_ms;      /* Sum of the head-of-queue waits */
+    UINT32  max_wait_ms;        /* Longest head-of-queue wait */
+    UINT32  num_copies;         /* Basic mode packets copied for lack of headroom */
+} tL2CAP_CHNL_TX_STATS;
+
 /* Values for Tx/Rx data rate parameter to L2CA_SetChnlDataRate */
 #define L2CAP_CHNL_DATA_RATE_HIGH       3
 #define L2CAP_CHNL_DATA_RATE_MEDIUM     2
@@ -761,6 +777,33 @@ extern BOOLEAN L2CA_SendTestSFrame (UINT16 cid, UINT8 sup_type,
 *******************************************************************************/
 extern BOOLEAN L2CA_SetTxPriority (UINT16 cid, tL2CAP_CHNL_PRIORITY priority);
 
+/*******************************************************************************
+**
+** Function         L2CA_SetLinkLatencyTarget
+**
+** Description      Sets the latency target of an ACL link. When data queued
+**                  on the link has waited longer than the target, the link
+**                  is served before the other links. A target of 0 removes
+**                  it; high priority links default to
+**                  L2CAP_HIGH_PRI_LATENCY_TARGET_MS.
+**
+** Returns          TRUE if a valid link, else FALSE
+**
+*******************************************************************************/
+extern BOOLEAN L2CA_SetLinkLatencyTarget (BD_ADDR bd_addr, tBT_TRANSPORT transport,
+                                          UINT16 target_ms);
+
+/*******************************************************************************
+**
+** Function         L2CA_GetChnlTxStats
+**
+** Description      Gets the transmit statistics of a channel.
+**
+** Returns          TRUE if a valid channel, else FALSE
+**
+*******************************************************************************/
+extern BOOLEAN L2CA_GetChnlTxStats (UINT16 cid, tL2CAP_CHNL_TX_STATS *p_stats);
+
 /*******************************************************************************
 **
 ** Function         L2CA_RegForNoCPEvt
@@ -1403,6 +1403,60 @@ BOOLEAN L2CA_SetTxPriority (UINT16 cid, tL2CAP_CHNL_PRIORITY priority)
     return (TRUE);
 }
 
+/*******************************************************************************
+**
+** Function         L2CA_SetLinkLatencyTarget
+**
+** Description      Sets the latency target of an ACL link. When data queued
+**                  on the link has waited longer than the target, the link
+**                  is served before the other links. A target of 0 removes
+**                  it.
+**
+** Returns          TRUE if a valid link, else FALSE
+**
+*******************************************************************************/
+BOOLEAN L2CA_SetLinkLatencyTarget (BD_ADDR bd_addr, tBT_TRANSPORT transport, UINT16 target_ms)
+{
+    tL2C_LCB        *p_lcb;
+
+    L2CAP_TRACE_API ("L2CA_SetLinkLatencyTarget()  transport: %d, target: %u ms",
+                     transport, target_ms);
+
+    if ((p_lcb = l2cu_find_lcb_by_bd_addr (bd_addr, transport)) == NULL)
+    {
+        L2CAP_TRACE_WARNING ("L2CAP - no LCB for L2CA_SetLinkLatencyTarget");
+        return (FALSE);
+    }
+
+    p_lcb->latency_target_ms  = target_ms;
+    p_lcb->latency_target_set = TRUE;
+
+    return (TRUE);
+}
+
+/*******************************************************************************
+**
+** Function         L2CA_GetChnlTxStats
+**
+** Description      Gets the transmit statistics of a channel.
+**
+** Returns          TRUE if a valid channel, else FALSE
+**
+*******************************************************************************/
+BOOLEAN L2CA_GetChnlTxStats (UINT16 cid, tL2CAP_CHNL_TX_STATS *p_stats)
+{
+    tL2C_CCB        *p_ccb;
+
+    if ((p_ccb = l2cu_find_ccb_by_cid (NULL, cid)) == NULL)
+    {
+        L2CAP_TRACE_WARNING ("L2CAP - no CCB for L2CA_GetChnlTxStats, CID: %d", cid);
+        return (FALSE);
+    }
+
+    *p_stats = p_ccb->tx_stats;
+    return (TRUE);
+}
+
 /*******************************************************************************
 **
 ** Function         L2CA_SetChnlDataRate
@@ -2282,6 +2336,9 @@ UINT16 L2CA_FlushChannel (UINT16 lcid, UINT16 num_to_flush)
         num_flushed2++;
     }
 
+    if (fixed_queue_is_empty(p_ccb->xmit_hold_q) && fixed_queue_is_empty(p_ccb->fcrb.retrans_q))
+        p_ccb->tx_wait_start_ms = 0;
+
     /* If app needs to track all packets, call him */
     if ( (p_ccb->p_rcb) && (p_ccb->p_rcb->api.pL2CA_TxComplete_Cb) && (num_flushed2) )
         (*p_ccb->p_rcb->api.pL2CA_TxComplete_Cb)(p_ccb->local_cid, num_flushed2);
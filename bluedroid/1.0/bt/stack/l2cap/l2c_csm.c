@@ -1638,6 +1638,26 @@ void l2c_enqueue_peer_data (tL2C_CCB *p_ccb, BT_HDR *p_buf)
     }
     else
     {
+        /* The headers go in front of the data, so a packet without room for
+        ** them has to be copied to one that has it */
+        if (p_buf->offset < L2CAP_BASIC_MIN_OFFSET)
+        {
+            BT_HDR *p_copy = (BT_HDR *)osi_malloc(BT_HDR_SIZE + L2CAP_MIN_OFFSET + p_buf->len);
+
+            p_copy->event          = p_buf->event;
+            p_copy->len            = p_buf->len;
+            p_copy->offset         = L2CAP_MIN_OFFSET;
+            p_copy->layer_specific = p_buf->layer_specific;
+            memcpy ((UINT8 *)(p_copy + 1) + p_copy->offset,
+                    (UINT8 *)(p_buf + 1) + p_buf->offset, p_buf->len);
+            osi_free(p_buf);
+            p_buf = p_copy;
+
+            p_ccb->tx_stats.num_copies++;
+            L2CAP_TRACE_DEBUG ("L2CAP - CID: 0x%04x  copied packet with offset below %d",
+                               p_ccb->local_cid, L2CAP_BASIC_MIN_OFFSET);
+        }
+
         /* Save the channel ID for faster counting */
         p_buf->event = p_ccb->local_cid;
 
@@ -1659,6 +1679,7 @@ void l2c_enqueue_peer_data (tL2C_CCB *p_ccb, BT_HDR *p_buf)
                         p_ccb->local_cid, p_ccb->remote_cid);
     }
     fixed_queue_enqueue(p_ccb->xmit_hold_q, p_buf);
+    l2cu_tx_queued (p_ccb);
 
     l2cu_check_channel_congestion (p_ccb);
 
@@ -313,6 +313,8 @@ typedef struct t_l2c_ccb
     UINT16              buff_quota;             /* Buffer quota before sending congestion   */
 
     tL2CAP_CHNL_PRIORITY ccb_priority;          /* Channel priority                 */
+    period_ms_t         tx_wait_start_ms;       /* Since when the queue head waits, 0 if idle */
+    tL2CAP_CHNL_TX_STATS tx_stats;              /* Queueing delay counters          */
     tL2CAP_CHNL_DATA_RATE tx_data_rate;         /* Channel Tx data rate             */
     tL2CAP_CHNL_DATA_RATE rx_data_rate;         /* Channel Rx data rate             */
 
@@ -417,6 +419,9 @@ typedef struct t_l2c_linkcb
     BT_HDR              *p_hcit_rcv_acl;            /* Current HCIT ACL buf being rcvd  */
     UINT16              idle_timeout_sv;            /* Save current Idle timeout        */
     UINT8               acl_priority;               /* L2C_PRIORITY_NORMAL or L2C_PRIORITY_HIGH */
+    UINT16              latency_target_ms;          /* Serve first past this wait, 0 if none */
+    BOOLEAN             latency_target_set;         /* Set through L2CA_SetLinkLatencyTarget */
+    UINT32              tx_vtime;                   /* Virtual time of the link scheduler */
     tL2CA_NOCP_CB       *p_nocp_cb;                 /* Num Cmpl pkts callback           */
 
 #if (L2CAP_NUM_FIXED_CHNLS > 0)
@@ -464,6 +469,7 @@ typedef struct
     BOOLEAN         check_round_robin;              /* Do a round robin check           */
 
     BOOLEAN         is_cong_cback_context;
+    UINT32          tx_vtime;                       /* Virtual time of the last served link */
 
     tL2C_LCB        lcb_pool[MAX_L2CAP_LINKS];      /* Link Control Block pool          */
     tL2C_CCB        ccb_pool[MAX_L2CAP_CHANNELS];   /* Channel Control Block pool       */
@@ -625,6 +631,7 @@ extern void     l2cu_reject_connection (tL2C_LCB *p_lcb, UINT16 remote_cid, UINT
 extern void     l2cu_send_peer_info_req (tL2C_LCB *p_lcb, UINT16 info_type);
 extern void     l2cu_set_acl_hci_header (BT_HDR *p_buf, tL2C_CCB *p_ccb);
 extern void     l2cu_check_channel_congestion (tL2C_CCB *p_ccb);
+extern void     l2cu_tx_queued (tL2C_CCB *p_ccb);
 extern void     l2cu_disconnect_chnl (tL2C_CCB *p_ccb);
 
 #if (L2CAP_NON_FLUSHABLE_PB_INCLUDED == TRUE)
@@ -705,6 +712,7 @@ extern BOOLEAN  l2c_link_hci_qos_violation (UINT16 handle);
 extern void     l2c_link_timeout (tL2C_LCB *p_lcb);
 extern void     l2c_info_resp_timer_timeout(void *data);
 extern void     l2c_link_check_send_pkts (tL2C_LCB *p_lcb, tL2C_CCB *p_ccb, BT_HDR *p_buf);
+extern void     l2c_link_service_links (tBT_TRANSPORT transport);
 extern void     l2c_link_adjust_allocation (void);
 extern void     l2c_link_process_num_completed_pkts (UINT8 *p);
 extern void     l2c_link_process_num_completed_blocks (UINT8 controller_id, UINT8 *p, UINT16 evt_len);
@@ -41,6 +41,7 @@
 #include "btm_api.h"
 #include "btm_int.h"
 #include "btcore/include/bdaddr.h"
+#include "osi/include/time.h"
 #if defined(MTK_STACK_CONFIG_BL) && (MTK_STACK_CONFIG_BL == TRUE)
 #include "interop_mtk.h"
 #endif
@@ -49,6 +50,10 @@ extern fixed_queue_t *btu_general_alarm_queue;
 
 static BOOLEAN l2c_link_send_to_lower (tL2C_LCB *p_lcb, BT_HDR *p_buf);
 
+/* Virtual time charged to a normal priority link for each segment it sends.
+** A high priority link is charged L2CAP_HIGH_PRI_LINK_WEIGHT times less. */
+#define L2C_LINK_VTIME_PER_SEG  64
+
 /*******************************************************************************
 **
 ** Function         l2c_link_hci_conn_req
@@ -1137,6 +1142,244 @@ BOOLEAN l2c_link_check_power_mode (tL2C_LCB *p_lcb)
 }
 #endif /* L2CAP_WAKE_PARKED_LINK == TRUE) */
 
+/*******************************************************************************
+**
+** Function         l2c_link_latency_target
+**
+** Description      Returns the latency target of a link in ms, 0 if none.
+**
+*******************************************************************************/
+static UINT16 l2c_link_latency_target (const tL2C_LCB *p_lcb)
+{
+    if (p_lcb->latency_target_set)
+        return p_lcb->latency_target_ms;
+
+    return (p_lcb->acl_priority == L2CAP_PRIORITY_HIGH) ? L2CAP_HIGH_PRI_LATENCY_TARGET_MS : 0;
+}
+
+/*******************************************************************************
+**
+** Function         l2c_link_has_tx_data
+**
+** Description      Checks whether a link has data queued for transmission,
+**                  and finds since when the oldest channel queue head waits.
+**
+** Returns          TRUE if there is data, with *p_oldest_ms set to 0 if none
+**                  of it is timed (link queue or retransmissions only)
+**
+*******************************************************************************/
+static BOOLEAN l2c_link_has_tx_data (tL2C_LCB *p_lcb, period_ms_t *p_oldest_ms)
+{
+    BOOLEAN     has_data = !list_is_empty(p_lcb->link_xmit_data_q);
+    tL2C_CCB    *p_ccb;
+
+    *p_oldest_ms = 0;
+
+    for (p_ccb = p_lcb->ccb_queue.p_first_ccb; p_ccb; p_ccb = p_ccb->p_next_ccb)
+    {
+        if (!fixed_queue_is_empty(p_ccb->fcrb.retrans_q))
+            has_data = TRUE;
+
+        if (p_ccb->tx_wait_start_ms == 0)
+            continue;
+
+        has_data = TRUE;
+        if (*p_oldest_ms == 0 || p_ccb->tx_wait_start_ms < *p_oldest_ms)
+            *p_oldest_ms = p_ccb->tx_wait_start_ms;
+    }
+
+#if (L2CAP_NUM_FIXED_CHNLS > 0)
+    int         xx;
+
+    for (xx = 0; xx < L2CAP_NUM_FIXED_CHNLS; xx++)
+    {
+        if ((p_ccb = p_lcb->p_fixed_ccbs[xx]) == NULL || p_ccb->tx_wait_start_ms == 0)
+            continue;
+
+        has_data = TRUE;
+        if (*p_oldest_ms == 0 || p_ccb->tx_wait_start_ms < *p_oldest_ms)
+            *p_oldest_ms = p_ccb->tx_wait_start_ms;
+    }
+#endif
+
+    return has_data;
+}
+
+/*******************************************************************************
+**
+** Function         l2c_link_window_open
+**
+** Description      Checks whether the controller can take a packet for a
+**                  link, given its transport and whether it is served in
+**                  round-robin.
+**
+** Returns          TRUE if a packet can be sent
+**
+*******************************************************************************/
+static BOOLEAN l2c_link_window_open (const tL2C_LCB *p_lcb)
+{
+#if (BLE_INCLUDED == TRUE)
+    if (p_lcb->transport == BT_TRANSPORT_LE)
+    {
+        if (p_lcb->link_xmit_quota == 0)
+            return (l2cb.controller_le_xmit_window != 0)
+                && (l2cb.ble_round_robin_unacked < l2cb.ble_round_robin_quota);
+
+        return (l2cb.controller_le_xmit_window != 0)
+            && (p_lcb->sent_not_acked < p_lcb->link_xmit_quota);
+    }
+#endif
+
+    if (p_lcb->link_xmit_quota == 0)
+        return (l2cb.controller_xmit_window != 0)
+            && (l2cb.round_robin_unacked < l2cb.round_robin_quota);
+
+    return (l2cb.controller_xmit_window != 0)
+        && (p_lcb->sent_not_acked < p_lcb->link_xmit_quota);
+}
+
+/*******************************************************************************
+**
+** Function         l2c_link_pick_next
+**
+** Description      Picks the next link to send a packet from, among the
+**                  round-robin links (round_robin TRUE) or the links of
+**                  |transport| that have their own quota. Links are served
+**                  in weighted fair order of their virtual time, except that
+**                  a link whose data waited past its latency target goes
+**                  first. Links marked in |p_skip| are not considered.
+**
+** Returns          the link, or NULL if none can send
+**
+*******************************************************************************/
+static tL2C_LCB *l2c_link_pick_next (BOOLEAN round_robin, tBT_TRANSPORT transport,
+                                     const BOOLEAN *p_skip)
+{
+    period_ms_t now = time_get_os_boottime_ms();
+    tL2C_LCB    *p_best = NULL;
+    BOOLEAN     best_overdue = FALSE;
+    int         xx;
+
+    for (xx = 0; xx < MAX_L2CAP_LINKS; xx++)
+    {
+        tL2C_LCB    *p_lcb = &l2cb.lcb_pool[xx];
+        period_ms_t oldest_ms;
+        UINT16      target_ms;
+        BOOLEAN     overdue;
+
+        if ( (p_skip[xx])
+           || (!p_lcb->in_use)
+           || (p_lcb->partial_segment_being_sent)
+           || (p_lcb->link_state != LST_CONNECTED) )
+            continue;
+
+        if (round_robin)
+        {
+            if (p_lcb->link_xmit_quota != 0)
+                continue;
+        }
+        else if ((p_lcb->link_xmit_quota == 0) || (p_lcb->transport != transport))
+            continue;
+
+        if ( (!l2c_link_window_open (p_lcb))
+           || (!l2c_link_has_tx_data (p_lcb, &oldest_ms))
+           || (L2C_LINK_CHECK_POWER_MODE (p_lcb)) )
+            continue;
+
+        target_ms = l2c_link_latency_target (p_lcb);
+        overdue = (target_ms != 0) && (oldest_ms != 0) && (now - oldest_ms >= target_ms);
+
+        if ( (p_best == NULL)
+          || (overdue && !best_overdue)
+          || ((overdue == best_overdue) && ((INT32)(p_lcb->tx_vtime - p_best->tx_vtime) < 0)) )
+        {
+            p_best = p_lcb;
+            best_overdue = overdue;
+        }
+    }
+
+    return p_best;
+}
+
+/*******************************************************************************
+**
+** Function         l2c_link_send_one
+**
+** Description      Sends one packet of a link, from its link queue first and
+**                  then, unless link_q_only is set, from its channels.
+**
+** Returns          TRUE if a packet was sent
+**
+*******************************************************************************/
+static BOOLEAN l2c_link_send_one (tL2C_LCB *p_lcb, BOOLEAN link_q_only)
+{
+    BT_HDR      *p_buf;
+#if defined(MTK_COMMON) && (MTK_COMMON == TRUE)
+    UINT16      fixd_cid = 0;
+#endif
+
+    if (!list_is_empty(p_lcb->link_xmit_data_q))
+    {
+        p_buf = (BT_HDR *)list_front(p_lcb->link_xmit_data_q);
+        list_remove(p_lcb->link_xmit_data_q, p_buf);
+        return l2c_link_send_to_lower (p_lcb, p_buf);
+    }
+
+    if (link_q_only)
+        return FALSE;
+
+#if defined(MTK_COMMON) && (MTK_COMMON == TRUE)
+    if ((p_buf = l2cu_get_next_buffer_to_send (p_lcb, &fixd_cid)) == NULL)
+#else
+    if ((p_buf = l2cu_get_next_buffer_to_send (p_lcb)) == NULL)
+#endif
+        return FALSE;
+
+    if (!l2c_link_send_to_lower (p_lcb, p_buf))
+        return FALSE;
+
+#if defined(MTK_COMMON) && (MTK_COMMON == TRUE)
+    if (0 != fixd_cid)
+    {
+        L2CAP_TRACE_DEBUG("l2c_link_send_one: fixed_cid = %d, send tx complete", fixd_cid);
+        /* send tx complete */
+        if (l2cb.fixed_reg[fixd_cid - L2CAP_FIRST_FIXED_CHNL].pL2CA_FixedTxComplete_Cb)
+        {
+            (*l2cb.fixed_reg[fixd_cid - L2CAP_FIRST_FIXED_CHNL].pL2CA_FixedTxComplete_Cb)(fixd_cid, 1);
+        }
+    }
+#endif
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         l2c_link_service_links
+**
+** Description      This function is called when controller buffers are freed
+**                  to send the packets waiting on the links of |transport|
+**                  that have their own quota, one packet at a time in the
+**                  order chosen by l2c_link_pick_next.
+**
+** Returns          void
+**
+*******************************************************************************/
+void l2c_link_service_links (tBT_TRANSPORT transport)
+{
+    BOOLEAN     skip[MAX_L2CAP_LINKS];
+    tL2C_LCB    *p_lcb;
+
+    if (l2cb.is_cong_cback_context)
+        return;
+
+    memset(skip, 0, sizeof(skip));
+    while ((p_lcb = l2c_link_pick_next (FALSE, transport, skip)) != NULL)
+    {
+        if (!l2c_link_send_one (p_lcb, FALSE))
+            skip[p_lcb - l2cb.lcb_pool] = TRUE;
+    }
+}
+
 /*******************************************************************************
 **
 ** Function         l2c_link_check_send_pkts
@@ -1188,100 +1431,33 @@ void l2c_link_check_send_pkts (tL2C_LCB *p_lcb, tL2C_CCB *p_ccb, BT_HDR *p_buf)
         return;
 
     /* If we are in a scenario where there are not enough buffers for each link to
-    ** have at least 1, then do a round-robin for all the LCBs
+    ** have at least 1, then do a round-robin for all the LCBs. Each link with
+    ** data sends one packet, in the order chosen by l2c_link_pick_next.
     */
     if ( (p_lcb == NULL) || (p_lcb->link_xmit_quota == 0) )
     {
-        if (p_lcb == NULL)
-            p_lcb = l2cb.lcb_pool;
-        else if (!single_write)
-            p_lcb++;
+        BOOLEAN served[MAX_L2CAP_LINKS];
 
-        /* Loop through, starting at the next */
-        for (xx = 0; xx < MAX_L2CAP_LINKS; xx++, p_lcb++)
+        memset(served, 0, sizeof(served));
+        for (xx = 0; xx < MAX_L2CAP_LINKS; xx++)
         {
-#if defined(MTK_COMMON) && (MTK_COMMON == TRUE)
-            /* Check for wraparound */
-            if (p_lcb == &l2cb.lcb_pool[MAX_L2CAP_LINKS])
-            {
-                p_lcb = &l2cb.lcb_pool[0];
-            }
-#endif
-
-            /* If controller window is full, nothing to do */
-            if (((l2cb.controller_xmit_window == 0 ||
-                  (l2cb.round_robin_unacked >= l2cb.round_robin_quota))
-#if (BLE_INCLUDED == TRUE)
-                && (p_lcb->transport == BT_TRANSPORT_BR_EDR)
-                )
-              || (p_lcb->transport == BT_TRANSPORT_LE &&
-                 (l2cb.ble_round_robin_unacked >= l2cb.ble_round_robin_quota ||
-                  l2cb.controller_le_xmit_window == 0 )))
-#else
-                ))
-#endif
-            break;
-
+            if ((p_lcb = l2c_link_pick_next (TRUE, BT_TRANSPORT_BR_EDR, served)) == NULL)
+                break;
 
-#if defined(MTK_COMMON) && (MTK_COMMON == FALSE)
-            /* Check for wraparound */
-            if (p_lcb == &l2cb.lcb_pool[MAX_L2CAP_LINKS])
-                p_lcb = &l2cb.lcb_pool[0];
+            served[p_lcb - l2cb.lcb_pool] = TRUE;
 
-#endif
-            if ( (!p_lcb->in_use)
-               || (p_lcb->partial_segment_being_sent)
-               || (p_lcb->link_state != LST_CONNECTED)
-               || (p_lcb->link_xmit_quota != 0)
-               || (L2C_LINK_CHECK_POWER_MODE (p_lcb)) )
-                continue;
-
-            /* See if we can send anything from the Link Queue */
-            if (!list_is_empty(p_lcb->link_xmit_data_q)) {
-                p_buf = (BT_HDR *)list_front(p_lcb->link_xmit_data_q);
-                list_remove(p_lcb->link_xmit_data_q, p_buf);
-                l2c_link_send_to_lower (p_lcb, p_buf);
-            }
-            else if (single_write)
-            {
-                /* If only doing one write, break out */
-                break;
-            }
-            /* If nothing on the link queue, check the channel queue */
-#if defined(MTK_COMMON) && (MTK_COMMON == TRUE)
-            else if ((p_buf = l2cu_get_next_buffer_to_send (p_lcb, &fixd_cid)) != NULL)
-#else
-            else if ((p_buf = l2cu_get_next_buffer_to_send (p_lcb)) != NULL)
-#endif
-            {
-                l2c_link_send_to_lower (p_lcb, p_buf);
-#if defined(MTK_COMMON) && (MTK_COMMON == TRUE)
-                if(0 != fixd_cid)
-                {
-                    L2CAP_TRACE_DEBUG("l2c_link_check_send_pkts: rr fixed_cid = %d, send tx complete", fixd_cid);
-                    /* send tx complete */
-                    if (l2cb.fixed_reg[fixd_cid - L2CAP_FIRST_FIXED_CHNL].pL2CA_FixedTxComplete_Cb)
-                    {
-                        (*l2cb.fixed_reg[fixd_cid - L2CAP_FIRST_FIXED_CHNL].pL2CA_FixedTxComplete_Cb)(fixd_cid, 1);
-                    }
-                }
-#endif
-            }
+            /* If only doing one write, only the link queues are served */
+            l2c_link_send_one (p_lcb, single_write);
         }
 
         /* If we finished without using up our quota, no need for a safety check */
         if ( (l2cb.controller_xmit_window > 0)
-          && (l2cb.round_robin_unacked < l2cb.round_robin_quota)
-#if (BLE_INCLUDED == TRUE)
-          && (p_lcb->transport == BT_TRANSPORT_BR_EDR)
-#endif
-          )
+          && (l2cb.round_robin_unacked < l2cb.round_robin_quota) )
             l2cb.check_round_robin = FALSE;
 
 #if (BLE_INCLUDED == TRUE)
         if ( (l2cb.controller_le_xmit_window > 0)
-          && (l2cb.ble_round_robin_unacked < l2cb.ble_round_robin_quota)
-          && (p_lcb->transport == BT_TRANSPORT_LE))
+          && (l2cb.ble_round_robin_unacked < l2cb.ble_round_robin_quota) )
             l2cb.ble_check_round_robin = FALSE;
 #endif
     }
@@ -1358,6 +1534,29 @@ void l2c_link_check_send_pkts (tL2C_LCB *p_lcb, tL2C_CCB *p_ccb, BT_HDR *p_buf)
     }
 }
 
+/*******************************************************************************
+**
+** Function         l2c_link_charge_vtime
+**
+** Description      Advances the virtual time of a link by the segments it
+**                  sends, scaled down by its weight. A link coming back from
+**                  idle starts at the current virtual time, so it cannot
+**                  bank service while it has nothing to send.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void l2c_link_charge_vtime (tL2C_LCB *p_lcb, UINT16 num_segs)
+{
+    UINT32 weight = (p_lcb->acl_priority == L2CAP_PRIORITY_HIGH) ? L2CAP_HIGH_PRI_LINK_WEIGHT : 1;
+
+    if ((INT32)(p_lcb->tx_vtime - l2cb.tx_vtime) < 0)
+        p_lcb->tx_vtime = l2cb.tx_vtime;
+
+    l2cb.tx_vtime = p_lcb->tx_vtime;
+    p_lcb->tx_vtime += (num_segs * L2C_LINK_VTIME_PER_SEG) / weight;
+}
+
 /*******************************************************************************
 **
 ** Function         l2c_link_send_to_lower
@@ -1393,6 +1592,7 @@ static BOOLEAN l2c_link_send_to_lower (tL2C_LCB *p_lcb, BT_HDR *p_buf)
         }
         p_lcb->sent_not_acked++;
         p_buf->layer_specific = 0;
+        l2c_link_charge_vtime (p_lcb, 1);
 
 #if (BLE_INCLUDED == TRUE)
         if (p_lcb->transport == BT_TRANSPORT_LE)
@@ -1465,6 +1665,7 @@ static BOOLEAN l2c_link_send_to_lower (tL2C_LCB *p_lcb, BT_HDR *p_buf)
         }
 
         p_lcb->sent_not_acked += num_segs;
+        l2c_link_charge_vtime (p_lcb, num_segs);
 #if BLE_INCLUDED == TRUE
         if (p_lcb->transport == BT_TRANSPORT_LE)
         {
@@ -1576,7 +1777,12 @@ void l2c_link_process_num_completed_pkts (UINT8 *p)
             else
                 p_lcb->sent_not_acked = 0;
 
-            l2c_link_check_send_pkts (p_lcb, NULL, NULL);
+            /* Links with their own quota may have been held back by the
+            ** controller window, not only this one, so serve all of them. */
+            if (p_lcb->link_xmit_quota == 0)
+                l2c_link_check_send_pkts (p_lcb, NULL, NULL);
+            else
+                l2c_link_service_links (p_lcb->transport);
 
             /* If we were doing round-robin for low priority links, check 'em */
             if ( (p_lcb->acl_priority == L2CAP_PRIORITY_HIGH)
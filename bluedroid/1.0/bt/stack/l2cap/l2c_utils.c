@@ -39,6 +39,8 @@
 #include "hcidefs.h"
 #include "bt_utils.h"
 #include "osi/include/allocator.h"
+#include "osi/include/metrics.h"
+#include "osi/include/time.h"
 
 extern fixed_queue_t *btu_general_alarm_queue;
 
@@ -1603,6 +1605,8 @@ tL2C_CCB *l2cu_allocate_ccb (tL2C_LCB *p_lcb, UINT16 cid)
 
     p_ccb->cong_sent    = FALSE;
     p_ccb->buff_quota   = 2;                /* This gets set after config */
+    p_ccb->tx_wait_start_ms = 0;
+    memset(&p_ccb->tx_stats, 0, sizeof(p_ccb->tx_stats));
 
     /* If CCB was reserved Config_Done can already have some value */
     if (cid == 0)
@@ -2613,15 +2617,16 @@ BOOLEAN l2cu_set_acl_priority (BD_ADDR bd_addr, UINT8 priority, BOOLEAN reset_af
             UINT8_TO_STREAM  (pp, vs_param);
 
             BTM_VendorSpecificCommand (HCI_BRCM_SET_ACL_PRIORITY, HCI_BRCM_ACL_PRIORITY_PARAM_SIZE, command, NULL);
-
-            /* Adjust lmp buffer allocation for this channel if priority changed */
-            if (p_lcb->acl_priority != priority)
-            {
-                p_lcb->acl_priority = priority;
-                l2c_link_adjust_allocation();
-            }
         }
     }
+
+    /* Adjust lmp buffer allocation for this channel if priority changed. The
+    ** host side share does not depend on the controller supporting the VSC. */
+    if (!reset_after_rs && (p_lcb->acl_priority != priority))
+    {
+        p_lcb->acl_priority = priority;
+        l2c_link_adjust_allocation();
+    }
     return(TRUE);
 }
 
@@ -3563,6 +3568,54 @@ static tL2C_CCB *l2cu_get_next_channel(tL2C_LCB *p_lcb)
 }
 #endif /* (L2CAP_ROUND_ROBIN_CHANNEL_SERVICE == TRUE) */
 
+/******************************************************************************
+**
+** Function         l2cu_tx_queued
+**
+** Description      Called when data is queued on a channel, to start timing
+**                  the wait of the queue head.
+**
+** Returns          void
+**
+*******************************************************************************/
+void l2cu_tx_queued (tL2C_CCB *p_ccb)
+{
+    if (p_ccb->tx_wait_start_ms == 0)
+        p_ccb->tx_wait_start_ms = time_get_os_boottime_ms();
+}
+
+/******************************************************************************
+**
+** Function         l2cu_tx_sent
+**
+** Description      Called when a packet of a channel is handed to the link,
+**                  to account for the wait of the queue head. The next
+**                  packet, if any, starts waiting now.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void l2cu_tx_sent (tL2C_CCB *p_ccb)
+{
+    period_ms_t now = time_get_os_boottime_ms();
+
+    if (p_ccb->tx_wait_start_ms != 0)
+    {
+        UINT32 wait_ms = (UINT32)(now - p_ccb->tx_wait_start_ms);
+
+        p_ccb->tx_stats.total_wait_ms += wait_ms;
+        if (wait_ms > p_ccb->tx_stats.max_wait_ms)
+            p_ccb->tx_stats.max_wait_ms = wait_ms;
+        metrics_histogram_record(METRICS_HISTOGRAM_ACL_TX_QUEUE_DELAY, (UINT64)wait_ms * 1000);
+    }
+    p_ccb->tx_stats.num_pkts++;
+
+    if (fixed_queue_is_empty(p_ccb->xmit_hold_q) && fixed_queue_is_empty(p_ccb->fcrb.retrans_q))
+        p_ccb->tx_wait_start_ms = 0;
+    else
+        p_ccb->tx_wait_start_ms = now;
+}
+
 /******************************************************************************
 **
 ** Function         l2cu_get_next_buffer_to_send
@@ -3610,6 +3663,7 @@ BT_HDR *l2cu_get_next_buffer_to_send (tL2C_LCB *p_lcb)
 
             if ((p_buf = l2c_fcr_get_next_xmit_sdu_seg(p_ccb, 0)) != NULL)
             {
+                l2cu_tx_sent (p_ccb);
                 l2cu_check_channel_congestion (p_ccb);
                 l2cu_set_acl_hci_header (p_buf, p_ccb);
                 return (p_buf);
@@ -3637,6 +3691,7 @@ BT_HDR *l2cu_get_next_buffer_to_send (tL2C_LCB *p_lcb)
                     (*l2cb.fixed_reg[xx].pL2CA_FixedTxComplete_Cb)(p_ccb->local_cid, 1);
 #endif
 
+                l2cu_tx_sent (p_ccb);
                 l2cu_check_channel_congestion (p_ccb);
                 l2cu_set_acl_hci_header (p_buf, p_ccb);
                 return (p_buf);
@@ -3690,7 +3745,7 @@ BT_HDR *l2cu_get_next_buffer_to_send (tL2C_LCB *p_lcb)
     if ( p_ccb->p_rcb && p_ccb->p_rcb->api.pL2CA_TxComplete_Cb && (p_ccb->peer_cfg.fcr.mode != L2CAP_FCR_ERTM_MODE) )
         (*p_ccb->p_rcb->api.pL2CA_TxComplete_Cb)(p_ccb->local_cid, 1);
 
-
+    l2cu_tx_sent (p_ccb);
     l2cu_check_channel_congestion (p_ccb);
 
     l2cu_set_acl_hci_header (p_buf, p_ccb);
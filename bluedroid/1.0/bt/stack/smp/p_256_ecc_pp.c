@@ -259,4 +259,159 @@ void ECC_PointMult_Bin_NAF(Point *q, Point *p, DWORD *n, uint32_t keyLength)
     multiprecision_mersenns_mult_mod(q->y, q->y, q->z, keyLength);
 }
 
+// Width of the window used by ECC_PointMult_wNAF, the digits are odd and in
+// [-(2^(w-1)-1), 2^(w-1)-1], and P, 3P, ..., (2^(w-1)-1)P are precomputed
+#define ECC_WNAF_WINDOW 4
+#define ECC_WNAF_POINTS (1 << (ECC_WNAF_WINDOW - 2))
 
+// Computing the width-w Non-Adjacent Form of a positive integer
+static void ECC_wNAF(int8_t *naf, uint32_t *NumNAF, DWORD *k, uint32_t keyLength)
+{
+    int32_t digit;
+    int i = 0;
+    int j;
+
+    while (multiprecision_most_signbits(k, keyLength) >= 1)
+    {
+        if (k[0] & 0x01)  // k is odd
+        {
+            digit = k[0] & ((1 << ECC_WNAF_WINDOW) - 1);
+            if (digit >= (1 << (ECC_WNAF_WINDOW - 1)))
+                digit -= (1 << ECC_WNAF_WINDOW);
+
+            // k = k-naf[i]
+            if (digit > 0)
+                k[0] -= digit;  // no borrow, the low bits of k are digit
+            else
+            {
+                k[0] = (UINT32)(k[0] - digit);
+                if (k[0] < (DWORD)(-digit))  //overflow
+                {
+                    j = 1;
+                    do
+                    {
+                        k[j] = (UINT32)(k[j] + 1);
+                    } while (k[j++] == 0);  //overflow
+                }
+            }
+        }
+        else
+            digit = 0;
+
+        multiprecision_rshift(k, k, keyLength);
+        naf[i++] = (int8_t)digit;
+    }
+
+    *NumNAF = i;
+}
+
+// Converts the jacobian points p[0]..p[num-1] to affine coordinates sharing a
+// single inversion (Montgomery's trick), none of them may be infinity
+static void ECC_Normalize(Point *p, uint32_t num, uint32_t keyLength)
+{
+    DWORD acc[ECC_WNAF_POINTS][KEY_LENGTH_DWORDS_P256];
+    DWORD inv[KEY_LENGTH_DWORDS_P256];
+    DWORD t1[KEY_LENGTH_DWORDS_P256];
+    DWORD t2[KEY_LENGTH_DWORDS_P256];
+
+    // acc[i] = z0*z1*...*zi
+    multiprecision_copy(acc[0], p[0].z, keyLength);
+    for (uint32_t i = 1; i < num; i++)
+        multiprecision_mersenns_mult_mod(acc[i], acc[i - 1], p[i].z, keyLength);
+
+    multiprecision_copy(t1, acc[num - 1], keyLength);  // inv_mod consumes its input
+    multiprecision_inv_mod(inv, t1, keyLength);
+
+    for (int i = num - 1; i >= 0; i--)
+    {
+        if (i > 0)
+        {
+            multiprecision_mersenns_mult_mod(t1, inv, acc[i - 1], keyLength);  // t1=1/zi
+            multiprecision_mersenns_mult_mod(inv, inv, p[i].z, keyLength);
+        }
+        else
+            multiprecision_copy(t1, inv, keyLength);
+
+        multiprecision_mersenns_squa_mod(t2, t1, keyLength);
+        multiprecision_mersenns_mult_mod(p[i].x, p[i].x, t2, keyLength);
+        multiprecision_mersenns_mult_mod(t2, t2, t1, keyLength);
+        multiprecision_mersenns_mult_mod(p[i].y, p[i].y, t2, keyLength);
+        multiprecision_init(p[i].z, keyLength);
+        p[i].z[0] = 1;
+    }
+}
+
+// Window Non-Adjacent Form for point multiplication, about 1/(w+1) of the
+// digits are non zero against 1/3 for ECC_PointMult_Bin_NAF, for the cost of
+// precomputing the odd multiples of p and two inversions
+void ECC_PointMult_wNAF(Point *q, Point *p, DWORD *n, uint32_t keyLength)
+{
+    int8_t naf[256 + 1];
+    uint32_t NumNaf;
+    Point table[ECC_WNAF_POINTS];
+    Point minus_table[ECC_WNAF_POINTS];
+    Point p2;
+    Point r;
+    DWORD *modp;
+    int digit;
+
+    if (keyLength == KEY_LENGTH_DWORDS_P256)
+    {
+        modp = curve_p256.p;
+    }
+    else
+    {
+        modp = curve.p;
+    }
+
+    multiprecision_init(p->z, keyLength);
+    p->z[0] = 1;
+
+    // table[i] = (2i+1)p, table[0] is already affine
+    p_256_copy_point(&table[0], p);
+    ECC_Double(&p2, p, keyLength);
+    ECC_Normalize(&p2, 1, keyLength);
+    for (int i = 1; i < ECC_WNAF_POINTS; i++)
+    {
+        p_256_copy_point(&r, &table[i - 1]);
+        ECC_Add(&table[i], &r, &p2, keyLength);
+    }
+    ECC_Normalize(&table[1], ECC_WNAF_POINTS - 1, keyLength);
+
+    // minus_table[i] = -table[i]
+    for (int i = 0; i < ECC_WNAF_POINTS; i++)
+    {
+        p_256_copy_point(&minus_table[i], &table[i]);
+        multiprecision_sub(minus_table[i].y, modp, table[i].y, keyLength);
+    }
+
+    // initialization
+    p_256_init_point(q);
+
+    // wNAF
+    ECC_wNAF(naf, &NumNaf, n, keyLength);
+
+    for (int i = NumNaf - 1; i >= 0; i--)
+    {
+        p_256_copy_point(&r, q);
+        ECC_Double(q, &r, keyLength);
+        digit = naf[i];
+
+        if (digit > 0)
+        {
+            p_256_copy_point(&r, q);
+            ECC_Add(q, &r, &table[digit >> 1], keyLength);
+        }
+        else if (digit < 0)
+        {
+            p_256_copy_point(&r, q);
+            ECC_Add(q, &r, &minus_table[(-digit) >> 1], keyLength);
+        }
+    }
+
+    multiprecision_inv_mod(r.x, q->z, keyLength);
+    multiprecision_mersenns_squa_mod(q->z, r.x, keyLength);
+    multiprecision_mersenns_mult_mod(q->x, q->x, q->z, keyLength);
+    multiprecision_mersenns_mult_mod(q->z, q->z, r.x, keyLength);
+    multiprecision_mersenns_mult_mod(q->y, q->y, q->z, keyLength);
+}
@@ -57,8 +57,9 @@ extern elliptic_curve_t curve;
 extern elliptic_curve_t curve_p256;
 
 void ECC_PointMult_Bin_NAF(Point *q, Point *p, DWORD *n, uint32_t keyLength);
+void ECC_PointMult_wNAF(Point *q, Point *p, DWORD *n, uint32_t keyLength);
 
-#define ECC_PointMult(q, p, n, keyLength)  ECC_PointMult_Bin_NAF(q, p, n, keyLength)
+#define ECC_PointMult(q, p, n, keyLength)  ECC_PointMult_wNAF(q, p, n, keyLength)
 
 void p_256_init_curve(UINT32 keyLength);
 
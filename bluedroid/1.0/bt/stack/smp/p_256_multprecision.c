@@ -192,7 +192,17 @@ void multiprecision_mersenns_mult_mod(DWORD *c, DWORD *a, DWORD *b, uint32_t key
 // Curve specific optimization when p is a pseudo-Mersenns prime
 void multiprecision_mersenns_squa_mod(DWORD *c, DWORD *a, uint32_t keyLength)
 {
-    multiprecision_mersenns_mult_mod(c, a, a, keyLength);
+    DWORD cc[2*KEY_LENGTH_DWORDS_P256];
+
+    multiprecision_squa(cc, a, keyLength);
+    if (keyLength == 6)
+    {
+        multiprecision_fast_mod(c, cc);
+    }
+    else if (keyLength == 8)
+    {
+        multiprecision_fast_mod_P256(c, cc);
+    }
 }
 
 // c=(a+b) mod p, b<p, a<p
@@ -268,11 +278,9 @@ DWORD multiprecision_lshift(DWORD * c, DWORD * a, uint32_t keyLength)
 // c=a*b; c must have a buffer of 2*Key_LENGTH_DWORDS, c != a != b
 void multiprecision_mult(DWORD *c, DWORD *a, DWORD *b, uint32_t keyLength)
 {
-    DWORD W;
+    uint64_t t;
     DWORD U;
-    DWORD V;
 
-    U = V = W = 0;
     multiprecision_init(c, keyLength);
 
     //assume little endian right now
@@ -281,19 +289,56 @@ void multiprecision_mult(DWORD *c, DWORD *a, DWORD *b, uint32_t keyLength)
         U = 0;
         for (uint32_t j = 0; j < keyLength; j++)
         {
-            uint64_t result;
-            result = ((UINT64)a[i]) * ((uint64_t) b[j]);
-            W = result >> 32;
-            V = a[i] * b[j];
-            V = V + U;
-            U = (V < U);
-            U += W;
-            V = V + c[i+j];
-            U += (V < c[i+j]);
-            c[i+j] = V;
+            // (2^32-1)^2 + 2*(2^32-1) still fits in 64 bits, so a single
+            // multiply-accumulate (UMULL/UMLAL on ARM) per word is enough
+            t = ((uint64_t)a[i]) * ((uint64_t)b[j]) + (uint64_t)c[i+j] + U;
+            c[i+j] = (UINT32)t;
+            U = (UINT32)(t >> 32);
+        }
+        c[i+keyLength] = U;
+    }
+}
+
+// c=a*a; c must have a buffer of 2*Key_LENGTH_DWORDS, c != a
+void multiprecision_squa(DWORD *c, DWORD *a, uint32_t keyLength)
+{
+    uint64_t t;
+    DWORD U;
+
+    multiprecision_init(c, keyLength);
+
+    // cross products a[i]*a[j], i<j, are only computed once ...
+    for (uint32_t i = 0; i < keyLength; i++)
+    {
+        U = 0;
+        for (uint32_t j = i + 1; j < keyLength; j++)
+        {
+            t = ((uint64_t)a[i]) * ((uint64_t)a[j]) + (uint64_t)c[i+j] + U;
+            c[i+j] = (UINT32)t;
+            U = (UINT32)(t >> 32);
         }
         c[i+keyLength] = U;
     }
+
+    // ... then doubled
+    U = 0;
+    for (uint32_t i = 0; i < 2 * keyLength; i++)
+    {
+        t = c[i];
+        c[i] = (UINT32)((t << 1) | U);
+        U = (UINT32)(t >> 31);
+    }
+
+    // and the squares on the diagonal added in
+    U = 0;
+    for (uint32_t i = 0; i < keyLength; i++)
+    {
+        t = ((uint64_t)a[i]) * ((uint64_t)a[i]) + (uint64_t)c[2*i] + U;
+        c[2*i] = (UINT32)t;
+        t = (t >> 32) + (uint64_t)c[2*i+1];
+        c[2*i+1] = (UINT32)t;
+        U = (UINT32)(t >> 32);
+    }
 }
 
 void multiprecision_fast_mod(DWORD *c, DWORD *a)
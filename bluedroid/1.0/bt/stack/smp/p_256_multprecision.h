@@ -52,6 +52,7 @@ void multiprecision_rshift(DWORD * c, DWORD * a, uint32_t keyLength);  // c=a>>1
 void multiprecision_lshift_mod(DWORD * c, DWORD * a, uint32_t keyLength); // c=a<<b, return carrier
 DWORD multiprecision_lshift(DWORD * c, DWORD * a, uint32_t keyLength);  // c=a<<b, return carrier
 void multiprecision_mult(DWORD *c, DWORD *a, DWORD *b, uint32_t keyLength); // c=a*b
+void multiprecision_squa(DWORD *c, DWORD *a, uint32_t keyLength); // c=a*a
 void multiprecision_mersenns_mult_mod(DWORD *c, DWORD *a, DWORD *b, uint32_t keyLength);
 void multiprecision_mersenns_squa_mod(DWORD *c, DWORD *a, uint32_t keyLength);
 DWORD multiprecision_lshift(DWORD * c, DWORD * a, uint32_t keyLength);
@@ -65,6 +65,11 @@ void SMP_Init(void)
     /* initialization of P-256 parameters */
     p_256_init_curve(KEY_LENGTH_DWORDS_P256);
 
+#if SMP_CRYPTO_SELF_TEST == TRUE
+    if (!smp_crypto_self_test())
+        SMP_TRACE_ERROR ("%s crypto self test failed", __func__);
+#endif
+
     /* Initialize failure case for certification */
     smp_cb.cert_failure = stack_config_get_interface()->get_pts_smp_failure_case();
     if (smp_cb.cert_failure)
@@ -118,6 +118,7 @@ static void cmac_aes_cleanup(void)
 {
     osi_free(cmac_cb.text);
     memset(&cmac_cb, 0, sizeof(tCMAC_CB));
+    smp_aes_cleanup();
 }
 
 /*******************************************************************************
@@ -324,51 +325,5 @@ BOOLEAN aes_cipher_msg_auth_code(BT_OCTET16 key, UINT8 *input, UINT16 length,
     return ret;
 }
 
-    #if 0 /* testing code, sample data from spec */
-void test_cmac_cback(UINT8 *p_mac, UINT16 tlen)
-{
-    SMP_TRACE_EVENT ("test_cmac_cback ");
-    SMP_TRACE_ERROR("test_cmac_cback");
-}
-
-void test_cmac(void)
-{
-    SMP_TRACE_EVENT ("test_cmac ");
-    UINT8 M[64] = {
-        0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
-        0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
-        0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
-        0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
-        0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11,
-        0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
-        0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17,
-        0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
-    };
-
-    UINT8 key[16] = {
-        0x3c, 0x4f, 0xcf, 0x09, 0x88, 0x15, 0xf7, 0xab,
-        0xa6, 0xd2, 0xae, 0x28, 0x16, 0x15, 0x7e, 0x2b
-    };
-    UINT8 i =0, tmp;
-    UINT16 len;
-
-    len = 64;
-
-    for (i = 0; i < len/2; i ++)
-    {
-        tmp = M[i];
-        M[i] = M[len -1 - i];
-        M[len -1 - i] = tmp;
-    }
-
-
-    memset(&cmac_cb, 0, sizeof(tCMAC_CB));
-
-    SMP_TRACE_WARNING("\n Example 1: len = %d\n", len);
-
-    aes_cipher_msg_auth_code(key, M, len, 128, test_cmac_cback, 0);
-
-}
-    #endif
 #endif
 
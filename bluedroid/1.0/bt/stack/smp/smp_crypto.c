@@ -0,0 +1,429 @@
+/******************************************************************************
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  This file contains the AES-128 block encryption backends used by SMP and
+ *  AES-CMAC, and the known answer tests of the SMP crypto primitives.
+ *
+ *  The block is encrypted with the ARMv8 AES instructions when the stack is
+ *  built for a CPU with the crypto extension, with the kernel crypto API
+ *  (AF_ALG) when SMP_CRYPTO_AF_ALG is TRUE, and with aes.c otherwise.
+ *
+ ******************************************************************************/
+#include "bt_target.h"
+
+#if SMP_INCLUDED == TRUE
+#include <string.h>
+#include "smp_int.h"
+#include "aes.h"
+
+/* the AES instructions are preferred over a system call per block */
+#if defined(__ARM_FEATURE_CRYPTO)
+#include <arm_neon.h>
+#elif SMP_CRYPTO_AF_ALG == TRUE
+#define SMP_AES_AF_ALG
+#endif
+
+#if defined(SMP_AES_AF_ALG)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/if_alg.h>
+#include "osi/include/osi.h"
+
+#ifndef AF_ALG
+#define AF_ALG  38
+#endif
+#ifndef SOL_ALG
+#define SOL_ALG 279
+#endif
+#endif
+
+#if SMP_CRYPTO_SELF_TEST == TRUE
+#include "osi/include/time.h"
+#include "p_256_ecc_pp.h"
+#endif
+
+/* Key schedule of the last key. AES-CMAC encrypts every block of a message
+ * with the same key, so it is only expanded once per message. */
+static aes_context smp_aes_ctx;
+static UINT8 smp_aes_key[N_BLOCK];
+static BOOLEAN smp_aes_key_valid = FALSE;
+
+#if defined(SMP_AES_AF_ALG)
+static int smp_alg_tfm_fd = -1;      /* "ecb(aes)" transform */
+static int smp_alg_op_fd = -1;       /* operation socket keyed with smp_aes_key */
+static BOOLEAN smp_alg_failed = FALSE;
+
+/*******************************************************************************
+**
+** Function         smp_alg_close
+**
+** Description      Close the AF_ALG sockets and fall back to the software
+**                  AES for the rest of the session.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void smp_alg_close(void)
+{
+    SMP_TRACE_WARNING("%s AF_ALG aes unavailable (errno %d)", __func__, errno);
+
+    if (smp_alg_op_fd >= 0)
+        close(smp_alg_op_fd);
+    if (smp_alg_tfm_fd >= 0)
+        close(smp_alg_tfm_fd);
+    smp_alg_op_fd = -1;
+    smp_alg_tfm_fd = -1;
+    smp_alg_failed = TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         smp_alg_set_key
+**
+** Description      Key the AF_ALG transform and open an operation socket
+**                  for it, the transform is bound on first use.
+**
+** Returns          TRUE if the kernel accepted the key.
+**
+*******************************************************************************/
+static BOOLEAN smp_alg_set_key(const UINT8 *key)
+{
+    struct sockaddr_alg sa;
+
+    if (smp_alg_failed)
+        return FALSE;
+
+    if (smp_alg_tfm_fd < 0)
+    {
+        memset(&sa, 0, sizeof(sa));
+        sa.salg_family = AF_ALG;
+        strlcpy((char *)sa.salg_type, "skcipher", sizeof(sa.salg_type));
+        strlcpy((char *)sa.salg_name, "ecb(aes)", sizeof(sa.salg_name));
+
+        smp_alg_tfm_fd = socket(AF_ALG, SOCK_SEQPACKET, 0);
+        if (smp_alg_tfm_fd < 0 ||
+            bind(smp_alg_tfm_fd, (struct sockaddr *)&sa, sizeof(sa)) < 0)
+        {
+            smp_alg_close();
+            return FALSE;
+        }
+    }
+
+    if (smp_alg_op_fd >= 0)
+    {
+        close(smp_alg_op_fd);
+        smp_alg_op_fd = -1;
+    }
+
+    if (setsockopt(smp_alg_tfm_fd, SOL_ALG, ALG_SET_KEY, key, N_BLOCK) < 0 ||
+        (smp_alg_op_fd = accept(smp_alg_tfm_fd, NULL, 0)) < 0)
+    {
+        smp_alg_close();
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         smp_alg_encrypt
+**
+** Description      Encrypt one block with the keyed AF_ALG operation socket.
+**
+** Returns          TRUE if the kernel returned the cipher text.
+**
+*******************************************************************************/
+static BOOLEAN smp_alg_encrypt(const UINT8 *in, UINT8 *out)
+{
+    char cbuf[CMSG_SPACE(sizeof(UINT32))];
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    struct iovec iov;
+    ssize_t len;
+
+    if (smp_alg_op_fd < 0)
+        return FALSE;
+
+    memset(cbuf, 0, sizeof(cbuf));
+    memset(&msg, 0, sizeof(msg));
+    iov.iov_base = (void *)in;
+    iov.iov_len = N_BLOCK;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_ALG;
+    cmsg->cmsg_type = ALG_SET_OP;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(UINT32));
+    *(UINT32 *)CMSG_DATA(cmsg) = ALG_OP_ENCRYPT;
+
+    OSI_NO_INTR(len = sendmsg(smp_alg_op_fd, &msg, 0));
+    if (len != N_BLOCK)
+    {
+        smp_alg_close();
+        return FALSE;
+    }
+
+    OSI_NO_INTR(len = read(smp_alg_op_fd, out, N_BLOCK));
+    if (len != N_BLOCK)
+    {
+        smp_alg_close();
+        return FALSE;
+    }
+
+    return TRUE;
+}
+#endif
+
+#if defined(__ARM_FEATURE_CRYPTO)
+/*******************************************************************************
+**
+** Function         smp_aes_encrypt_armv8
+**
+** Description      Encrypt one block with the ARMv8 AES instructions, using
+**                  the round keys expanded by aes_set_key().
+**
+** Returns          void
+**
+*******************************************************************************/
+static void smp_aes_encrypt_armv8(const aes_context *ctx, const UINT8 *in, UINT8 *out)
+{
+    uint8x16_t state = vld1q_u8(in);
+    UINT8 r;
+
+    /* AESE is AddRoundKey, SubBytes and ShiftRows, AESMC is MixColumns */
+    for (r = 0; r < ctx->rnd - 1; r++)
+        state = vaesmcq_u8(vaeseq_u8(state, vld1q_u8(ctx->ksch + r * N_BLOCK)));
+
+    state = vaeseq_u8(state, vld1q_u8(ctx->ksch + r * N_BLOCK));
+    state = veorq_u8(state, vld1q_u8(ctx->ksch + (r + 1) * N_BLOCK));
+    vst1q_u8(out, state);
+}
+#endif
+
+/*******************************************************************************
+**
+** Function         smp_aes_encrypt
+**
+** Description      AES-128 encryption of one block. Key, plain text and
+**                  cipher text are in the big endian order of FIPS-197,
+**                  not in the little endian order used by the rest of SMP.
+**
+** Returns          void
+**
+*******************************************************************************/
+void smp_aes_encrypt(const UINT8 *key, const UINT8 *in, UINT8 *out)
+{
+    if (!smp_aes_key_valid || memcmp(key, smp_aes_key, N_BLOCK) != 0)
+    {
+        aes_set_key(key, N_BLOCK, &smp_aes_ctx);
+        memcpy(smp_aes_key, key, N_BLOCK);
+        smp_aes_key_valid = TRUE;
+#if defined(SMP_AES_AF_ALG)
+        smp_alg_set_key(key);
+#endif
+    }
+
+#if defined(__ARM_FEATURE_CRYPTO)
+    smp_aes_encrypt_armv8(&smp_aes_ctx, in, out);
+#else
+#if defined(SMP_AES_AF_ALG)
+    if (smp_alg_encrypt(in, out))
+        return;
+#endif
+    aes_encrypt(in, out, &smp_aes_ctx);
+#endif
+}
+
+/*******************************************************************************
+**
+** Function         smp_aes_cleanup
+**
+** Description      Forget the cached key and its schedule.
+**
+** Returns          void
+**
+*******************************************************************************/
+void smp_aes_cleanup(void)
+{
+    memset(&smp_aes_ctx, 0, sizeof(smp_aes_ctx));
+    memset(smp_aes_key, 0, sizeof(smp_aes_key));
+    smp_aes_key_valid = FALSE;
+
+#if defined(SMP_AES_AF_ALG)
+    if (smp_alg_op_fd >= 0)
+    {
+        close(smp_alg_op_fd);
+        smp_alg_op_fd = -1;
+    }
+#endif
+}
+
+#if SMP_CRYPTO_SELF_TEST == TRUE
+/* FIPS-197 appendix C.1 */
+static const UINT8 smp_test_aes_key[N_BLOCK] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const UINT8 smp_test_aes_plain[N_BLOCK] = {
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+    0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+static const UINT8 smp_test_aes_cipher[N_BLOCK] = {
+    0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+    0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+};
+
+/* RFC 4493 section 4, in the big endian order of the RFC */
+static const UINT8 smp_test_cmac_key[BT_OCTET16_LEN] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+    0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const UINT8 smp_test_cmac_msg[64] = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+    0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+    0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+    0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11,
+    0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+    0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17,
+    0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+static const struct {
+    UINT16 len;
+    UINT8 mac[BT_OCTET16_LEN];
+} smp_test_cmac[] = {
+    {0,  {0xbb, 0x1d, 0x69, 0x29, 0xe9, 0x59, 0x37, 0x28,
+          0x7f, 0xa3, 0x7d, 0x12, 0x9b, 0x75, 0x67, 0x46}},
+    {16, {0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44,
+          0xf7, 0x9b, 0xdd, 0x9d, 0xd0, 0x4a, 0x28, 0x7c}},
+    {40, {0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30,
+          0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27}},
+    {64, {0x51, 0xf0, 0xbe, 0xbf, 0x7e, 0x3b, 0x9d, 0x92,
+          0xfc, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3c, 0xfe}},
+};
+
+/* Debug key pair of the Core specification, Vol 3 Part H 2.3.5.6.1, as
+ * little endian DWORDs */
+static const DWORD smp_test_ecc_private[KEY_LENGTH_DWORDS_P256] = {
+    0xcd3c1abd, 0x5899b8a6, 0xeb40b799, 0x4aff607b,
+    0xd2103f50, 0x74c9b3e3, 0xa3c55f38, 0x3f49f6d4
+};
+static const DWORD smp_test_ecc_public_x[KEY_LENGTH_DWORDS_P256] = {
+    0x0e359de6, 0xcc030148, 0xacf4fddb, 0xeff49111,
+    0xe9f9a5b9, 0x5e2c83a7, 0xf297be2c, 0x20b003d2
+};
+static const DWORD smp_test_ecc_public_y[KEY_LENGTH_DWORDS_P256] = {
+    0x1589d28b, 0x741c8ed0, 0x8fed3024, 0x766345c2,
+    0x5a52155c, 0x63329abf, 0x652aeb6d, 0xdc809c49
+};
+
+#define SMP_TEST_AES_ROUNDS     1000
+#define SMP_TEST_CMAC_ROUNDS    100
+#define SMP_TEST_ECC_ROUNDS     4
+
+/*******************************************************************************
+**
+** Function         smp_crypto_self_test
+**
+** Description      Check AES-128, AES-CMAC and the P-256 point multiplication
+**                  against known vectors, and trace how long each takes.
+**
+** Returns          TRUE if all the vectors matched.
+**
+*******************************************************************************/
+BOOLEAN smp_crypto_self_test(void)
+{
+    UINT8 out[N_BLOCK];
+    UINT8 key[BT_OCTET16_LEN];
+    UINT8 msg[sizeof(smp_test_cmac_msg)];
+    UINT8 mac[BT_OCTET16_LEN];
+    DWORD private_key[KEY_LENGTH_DWORDS_P256];
+    Point public_key;
+    uint64_t start;
+    BOOLEAN ok = TRUE;
+    UINT16 i, j;
+
+    /* AES-128 */
+    start = time_get_os_boottime_us();
+    for (i = 0; i < SMP_TEST_AES_ROUNDS; i++)
+        smp_aes_encrypt(smp_test_aes_key, smp_test_aes_plain, out);
+    SMP_TRACE_WARNING("%s AES-128: %llu us for %d blocks", __func__,
+        (unsigned long long)(time_get_os_boottime_us() - start), SMP_TEST_AES_ROUNDS);
+    smp_aes_cleanup();
+
+    if (memcmp(out, smp_test_aes_cipher, N_BLOCK) != 0)
+    {
+        SMP_TRACE_ERROR("%s AES-128 vector mismatch", __func__);
+        ok = FALSE;
+    }
+
+    /* AES-CMAC, key, message and MAC are little endian as used by SMP */
+    for (j = 0; j < BT_OCTET16_LEN; j++)
+        key[j] = smp_test_cmac_key[BT_OCTET16_LEN - 1 - j];
+
+    for (i = 0; i < sizeof(smp_test_cmac) / sizeof(smp_test_cmac[0]); i++)
+    {
+        UINT16 len = smp_test_cmac[i].len;
+
+        for (j = 0; j < len; j++)
+            msg[j] = smp_test_cmac_msg[len - 1 - j];
+
+        start = time_get_os_boottime_us();
+        for (j = 0; j < SMP_TEST_CMAC_ROUNDS; j++)
+            aes_cipher_msg_auth_code(key, msg, len, BT_OCTET16_LEN, mac);
+        SMP_TRACE_WARNING("%s AES-CMAC %d bytes: %llu us for %d messages", __func__, len,
+            (unsigned long long)(time_get_os_boottime_us() - start), SMP_TEST_CMAC_ROUNDS);
+
+        for (j = 0; j < BT_OCTET16_LEN; j++)
+        {
+            if (mac[j] != smp_test_cmac[i].mac[BT_OCTET16_LEN - 1 - j])
+            {
+                SMP_TRACE_ERROR("%s AES-CMAC vector %d mismatch", __func__, i + 1);
+                ok = FALSE;
+                break;
+            }
+        }
+    }
+
+    /* P-256, the point multiplication consumes the private key */
+    start = time_get_os_boottime_us();
+    for (i = 0; i < SMP_TEST_ECC_ROUNDS; i++)
+    {
+        memcpy(private_key, smp_test_ecc_private, sizeof(private_key));
+        ECC_PointMult(&public_key, &(curve_p256.G), private_key, KEY_LENGTH_DWORDS_P256);
+    }
+    SMP_TRACE_WARNING("%s P-256 public key: %llu us", __func__,
+        (unsigned long long)(time_get_os_boottime_us() - start) / SMP_TEST_ECC_ROUNDS);
+
+    if (memcmp(public_key.x, smp_test_ecc_public_x, sizeof(public_key.x)) != 0 ||
+        memcmp(public_key.y, smp_test_ecc_public_y, sizeof(public_key.y)) != 0)
+    {
+        SMP_TRACE_ERROR("%s P-256 vector mismatch", __func__);
+        ok = FALSE;
+    }
+
+    return ok;
+}
+#endif
+
+#endif
@@ -542,6 +542,13 @@ extern BOOLEAN aes_cipher_msg_auth_code(BT_OCTET16 key, UINT8 *input, UINT16 len
                                                  UINT16 tlen, UINT8 *p_signature);
 extern void print128(BT_OCTET16 x, const UINT8 *key_name);
 
+/* smp_crypto.c */
+extern void smp_aes_encrypt(const UINT8 *key, const UINT8 *in, UINT8 *out);
+extern void smp_aes_cleanup(void);
+#if SMP_CRYPTO_SELF_TEST == TRUE
+extern BOOLEAN smp_crypto_self_test(void);
+#endif
+
 #endif
 
 #endif /* SMP_INT_H */
@@ -34,7 +34,6 @@
 #include "btm_int.h"
 #include "btm_ble_int.h"
 #include "hcimsgs.h"
-#include "aes.h"
 #include "p_256_ecc_pp.h"
 #include "device/include/controller.h"
 
@@ -124,8 +123,7 @@ BOOLEAN smp_encrypt_data (UINT8 *key, UINT8 key_len,
                           UINT8 *plain_text, UINT8 pt_len,
                           tSMP_ENC *p_out)
 {
-    aes_context ctx;
-    UINT8 *p_start = NULL;
+    UINT8 p_start[SMP_ENCRYT_DATA_SIZE * 4];
     UINT8 *p = NULL;
     UINT8 *p_rev_data = NULL;    /* input data in big endilan format */
     UINT8 *p_rev_key = NULL;     /* input key in big endilan format */
@@ -138,7 +136,7 @@ BOOLEAN smp_encrypt_data (UINT8 *key, UINT8 key_len,
         return FALSE;
     }
 
-    p_start = (UINT8 *)osi_calloc(SMP_ENCRYT_DATA_SIZE * 4);
+    memset(p_start, 0, sizeof(p_start));
 
     if (pt_len > SMP_ENCRYT_DATA_SIZE)
         pt_len = SMP_ENCRYT_DATA_SIZE;
@@ -155,8 +153,7 @@ BOOLEAN smp_encrypt_data (UINT8 *key, UINT8 key_len,
     smp_debug_print_nbyte_little_endian(p_start, (const UINT8 *)"Plain text", SMP_ENCRYT_DATA_SIZE);
 #endif
     p_rev_output = p;
-    aes_set_key(p_rev_key, SMP_ENCRYT_KEY_SIZE, &ctx);
-    aes_encrypt(p_rev_data, p, &ctx);  /* outputs in byte 48 to byte 63 */
+    smp_aes_encrypt(p_rev_key, p_rev_data, p);  /* outputs in byte 48 to byte 63 */
 
     p = p_out->param_buf;
     REVERSE_ARRAY_TO_STREAM (p, p_rev_output, SMP_ENCRYT_DATA_SIZE);
@@ -168,8 +165,6 @@ BOOLEAN smp_encrypt_data (UINT8 *key, UINT8 key_len,
     p_out->status = HCI_SUCCESS;
     p_out->opcode =  HCI_BLE_ENCRYPT;
 
-    osi_free(p_start);
-
     return TRUE;
 }
 
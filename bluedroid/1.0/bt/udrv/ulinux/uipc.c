@@ -41,6 +41,7 @@
 #include <unistd.h>
 
 #include "audio_a2dp_hw.h"
+#include "audio_a2dp_shm.h"
 #include "bt_types.h"
 #include "bt_utils.h"
 #include "bt_common.h"
@@ -67,6 +68,13 @@
 
 #define UIPC_FLUSH_BUFFER_SIZE 1024
 
+/* The HAL sends the hello right after connecting */
+#define UIPC_SHM_HELLO_TMO_MS 500
+
+/* How long UIPC_Send waits for room in the ring, kept short as it holds
+   the uipc lock */
+#define UIPC_SHM_SEND_TMO_MS 100
+
 /*****************************************************************************
 **  Local type definitions
 ******************************************************************************/
@@ -84,6 +92,7 @@ typedef struct {
     pthread_mutex_t cond_mutex;
     pthread_cond_t  cond;
     tUIPC_RCV_CBACK *cback;
+    a2dp_shm_t *shm;      /* PCM ring of the connection, NULL if PCM goes over fd */
 } tUIPC_CHAN;
 
 typedef struct {
@@ -267,7 +276,11 @@ void uipc_main_cleanup(void)
 
     /* close any open channels */
     for (i=0; i<UIPC_CH_NUM; i++)
+    {
         uipc_close_ch_locked(i);
+        a2dp_shm_free(uipc_main.ch[i].shm);
+        uipc_main.ch[i].shm = NULL;
+    }
 }
 
 
@@ -322,6 +335,17 @@ static int uipc_check_fd_locked(tUIPC_CH_ID ch_id)
             return -1;
         }
 
+        if (ch_id == UIPC_CH_ID_AV_AUDIO)
+        {
+            /* The ring of the previous connection is only released here, as
+               a media task read may still be running when a channel closes. */
+            a2dp_shm_free(uipc_main.ch[ch_id].shm);
+            uipc_main.ch[ch_id].shm =
+                a2dp_shm_receive_hello(uipc_main.ch[ch_id].fd, UIPC_SHM_HELLO_TMO_MS);
+            BTIF_TRACE_EVENT("CH %d PCM OVER %s", ch_id,
+                             uipc_main.ch[ch_id].shm ? "SHARED MEMORY" : "SOCKET");
+        }
+
         if (uipc_main.ch[ch_id].cback)
             uipc_main.ch[ch_id].cback(ch_id, UIPC_OPEN_EVT);
     }
@@ -406,6 +430,12 @@ static void uipc_flush_ch_locked(tUIPC_CH_ID ch_id)
         return;
     }
 
+    if (uipc_main.ch[ch_id].shm)
+    {
+        a2dp_shm_flush(uipc_main.ch[ch_id].shm);
+        return;
+    }
+
     while (1)
     {
         int ret;
@@ -716,6 +746,21 @@ BOOLEAN UIPC_Send(tUIPC_CH_ID ch_id, UINT16 msg_evt, UINT8 *p_buf,
     UIPC_LOCK();
 
     ssize_t ret;
+    if (uipc_main.ch[ch_id].shm)
+    {
+        ret = a2dp_shm_write(uipc_main.ch[ch_id].shm, p_buf, msglen,
+                             UIPC_SHM_SEND_TMO_MS, uipc_main.ch[ch_id].fd);
+        if (ret < 0) {
+            BTIF_TRACE_WARNING("UIPC_Send : channel detached remotely");
+            uipc_close_locked(ch_id);
+        } else if (ret < msglen) {
+            BTIF_TRACE_WARNING("UIPC_Send : ring full, dropped %d bytes",
+                               msglen - (int)ret);
+        }
+        UIPC_UNLOCK();
+        return FALSE;
+    }
+
     OSI_NO_INTR(ret = write(uipc_main.ch[ch_id].fd, p_buf, msglen));
     if (ret < 0) {
         BTIF_TRACE_ERROR("failed to write (%s)", strerror(errno));
@@ -758,6 +803,21 @@ UINT32 UIPC_Read(tUIPC_CH_ID ch_id, UINT16 *p_msg_evt, UINT8 *p_buf, UINT32 len)
     //BTIF_TRACE_DEBUG("UIPC_Read : ch_id %d, len %d, fd %d, polltmo %d", ch_id, len,
     //        fd, uipc_main.ch[ch_id].read_poll_tmo_ms);
 
+    if (uipc_main.ch[ch_id].shm)
+    {
+        ssize_t n = a2dp_shm_read(uipc_main.ch[ch_id].shm, p_buf, len,
+                                  uipc_main.ch[ch_id].read_poll_tmo_ms, fd);
+        if (n < 0)
+        {
+            BTIF_TRACE_WARNING("UIPC_Read : channel detached remotely");
+            UIPC_LOCK();
+            uipc_close_locked(ch_id);
+            UIPC_UNLOCK();
+            return 0;
+        }
+        return (UINT32)n;
+    }
+
     while (n_read < (int)len)
     {
         pfd.fd = fd;
@@ -13,7 +13,9 @@
 // mount_main() calls singlemount() which calls mount_it_now().
 //
 // mount_main() can loop through /etc/fstab for mount -a
-// singlemount() can loop through /etc/filesystems for fstype detection.
+// (mount -a -F forks one mount_main() child per independent mount point)
+// singlemount() can loop through /etc/filesystems for fstype detection,
+// after trying the type found by probing the superblock.
 // mount_it_now() does the actual mount.
 //
 #include <mntent.h>
@@ -61,6 +63,13 @@
 #else
 # define resolve_mount_spec(fsname) ((void)0)
 #endif
+// volume_id knows the type of what it probed only with the blkid TYPE
+#if ENABLE_FEATURE_MOUNT_LABEL && ENABLE_FEATURE_BLKID_TYPE
+# include "volume_id/volume_id_internal.h"
+# define PROBE_FSTYPE 1
+#else
+# define PROBE_FSTYPE 0
+#endif
 
 // Needed for nfs support only
 #include <sys/utsname.h>
@@ -98,7 +107,7 @@ enum {
 };
 
 
-#define OPTION_STR "o:t:rwanfvsiO:"
+#define OPTION_STR "o:t:rwanfvsiO:F"
 enum {
 	OPT_o = (1 << 0),
 	OPT_t = (1 << 1),
@@ -111,6 +120,7 @@ enum {
 	OPT_s = (1 << 8),
 	OPT_i = (1 << 9),
 	OPT_O = (1 << 10),
+	OPT_F = (1 << 11),
 };
 
 #if ENABLE_FEATURE_MTAB_SUPPORT
@@ -1581,6 +1591,34 @@ int nfsmount(struct mntent *mp, long vfsflags, char *filteropts);
 
 #endif // !ENABLE_FEATURE_MOUNT_NFS
 
+#if PROBE_FSTYPE
+// Find the filesystem type of a block device from its superblock.
+// Returns NULL for unknown.  Mounting with the right type at once saves
+// the failed mount(2) of every type listed before it, each of which
+// reads and rejects the superblock (several for NTFS/exFAT drivers).
+static const char *probe_fstype(const char *device)
+{
+	struct volume_id *vid;
+	const char *type = NULL;
+	uint64_t size;
+	int fd;
+
+	fd = open(device, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	// fd is owned by vid now
+	vid = volume_id_open_node(fd);
+	if (ioctl(fd, BLKGETSIZE64, &size) != 0)
+		size = 0;
+	if (volume_id_probe_all(vid, size) == 0)
+		type = vid->type; // static string
+	free_volume_id(vid);
+	if (verbose)
+		bb_error_msg("%s: probed type %s", device, type ? type : "unknown");
+	return type;
+}
+#endif
+
 // Mount one directory.  Handles CIFS, NFS, loopback, autobind, and filesystem
 // type detection.  Returns 0 for success, nonzero for failure.
 // NB: mp->xxx fields may be trashed on exit
@@ -1714,6 +1752,22 @@ static int singlemount(struct mntent *mp, int ignore_busy)
 	if (mp->mnt_type || (vfsflags & (MS_REMOUNT | MS_BIND | MS_MOVE))) {
 		rc = mount_it_now(mp, vfsflags, filteropts);
 	} else {
+		const char *probed = NULL;
+
+		// Try the type the superblock says first.  If that fails
+		// (e.g. the kernel calls its NTFS driver something else),
+		// fall back to trying them all.
+#if PROBE_FSTYPE
+		if (mp->mnt_fsname)
+			probed = probe_fstype(mp->mnt_fsname);
+		if (probed) {
+			mp->mnt_type = (char*)probed;
+			rc = mount_it_now(mp, vfsflags, filteropts);
+			if (!rc)
+				goto mounted;
+		}
+#endif
+
 		// Loop through filesystem types until mount succeeds
 		// or we run out
 
@@ -1727,12 +1781,17 @@ static int singlemount(struct mntent *mp, int ignore_busy)
 		}
 
 		for (fl = fslist; fl; fl = fl->link) {
+			if (probed && strcmp(fl->data, probed) == 0)
+				continue; // already failed
 			mp->mnt_type = fl->data;
 			rc = mount_it_now(mp, vfsflags, filteropts);
 			if (!rc)
 				break;
 		}
 	}
+#if PROBE_FSTYPE
+ mounted:
+#endif
 
 	// If mount failed, clean up loop file (if any).
 	if (ENABLE_FEATURE_MOUNT_LOOP && rc && loopFile) {
@@ -1811,6 +1870,66 @@ static int match_opt(const char *fs_opt_in, const char *O_opt)
 	return 1;
 }
 
+#if BB_MMU
+// "mount -a -F": mount the fstab entries in parallel, one child each,
+// so that e.g. all partitions of a hotplugged disk are probed at once
+// instead of one after another.  Only mount points which are nested
+// (one is under the other, or the same) must still be mounted in fstab
+// order: the parent directory has to be mounted first.
+struct mount_child {
+	pid_t pid;
+	char *dir;
+};
+
+// Is one of a and b a subdirectory of the other (or the same)?
+static int dirs_nested(const char *a, const char *b)
+{
+	size_t la = strlen(a);
+	size_t lb = strlen(b);
+
+	while (la > 1 && a[la - 1] == '/')
+		la--;
+	while (lb > 1 && b[lb - 1] == '/')
+		lb--;
+	if (la > lb) {
+		const char *t = a;
+		a = b;
+		b = t;
+		la = lb;
+	}
+	// now a is the shorter one
+	if (la == 1 && a[0] == '/')
+		return 1;
+	return strncmp(a, b, la) == 0 && (b[la] == '/' || b[la] == '\0');
+}
+
+// Wait for the children mounting on dir, or on all dirs if dir is NULL.
+// Returns the number of failed mounts.
+static int wait_mount_children(struct mount_child *child, int *count,
+		const char *dir)
+{
+	int failed = 0;
+	int i = 0;
+
+	while (i < *count) {
+		int status;
+
+		if (dir && !dirs_nested(child[i].dir, dir)) {
+			i++;
+			continue;
+		}
+		if (safe_waitpid(child[i].pid, &status, 0) < 0
+		 || !WIFEXITED(status) || WEXITSTATUS(status) != 0
+		) {
+			failed++;
+		}
+		free(child[i].dir);
+		child[i] = child[--*count];
+	}
+	return failed;
+}
+#endif
+
 // Parse options, if necessary parse fstab/mtab, and call singlemount for
 // each directory to be mounted.
 int mount_main(int argc, char **argv) MAIN_EXTERNALLY_VISIBLE;
@@ -1827,6 +1946,10 @@ int mount_main(int argc UNUSED_PARAM, char **argv)
 	int rc = EXIT_SUCCESS;
 	unsigned opt;
 	struct mntent mtpair[2], *mtcur = mtpair;
+#if BB_MMU
+	struct mount_child *child = NULL;
+	int children = 0;
+#endif
 	IF_NOT_DESKTOP(const int nonroot = 0;)
 
 	IF_DESKTOP(int nonroot = ) sanitize_env_if_suid();
@@ -1986,6 +2109,12 @@ int mount_main(int argc UNUSED_PARAM, char **argv)
 			// NFS mounts want this to be xrealloc-able
 			mtcur->mnt_opts = xstrdup(mtcur->mnt_opts);
 
+#if BB_MMU
+			// A parent (or the same) directory may still be
+			// being mounted by a child, let it finish first
+			if (opt & OPT_F)
+				rc += wait_mount_children(child, &children, mtcur->mnt_dir);
+#endif
 			// If nothing is mounted on this directory...
 			// (otherwise repeated "mount -a" mounts everything again)
 			mp = find_mount_point(mtcur->mnt_dir, /*subdir_too:*/ 0);
@@ -1999,6 +2128,22 @@ int mount_main(int argc UNUSED_PARAM, char **argv)
 						bb_path_mtab_file,
 						mp->mnt_fsname, mp->mnt_dir);
 				}
+#if BB_MMU
+			} else if (opt & OPT_F) {
+				pid_t pid;
+
+				fflush_all();
+				pid = xfork();
+				if (pid == 0) {
+					// child: mount this thing
+					exit(singlemount(mtcur, /*ignore_busy:*/ 1)
+						? EXIT_FAILURE : EXIT_SUCCESS);
+				}
+				child = xrealloc_vector(child, 4, children);
+				child[children].pid = pid;
+				child[children].dir = xstrdup(mtcur->mnt_dir);
+				children++;
+#endif
 			} else {
 				// ...mount this thing
 				if (singlemount(mtcur, /*ignore_busy:*/ 1)) {
@@ -2010,6 +2155,13 @@ int mount_main(int argc UNUSED_PARAM, char **argv)
 		}
 	}
 
+#if BB_MMU
+	// Count the failed mounts of "mount -a -F" too
+	rc += wait_mount_children(child, &children, NULL);
+	if (ENABLE_FEATURE_CLEAN_UP)
+		free(child);
+#endif
+
 	// End of fstab/mtab is reached.
 	// Were we looking for something specific?
 	if (argv[0]) { // yes
@@ -69,10 +69,21 @@ void cJSON_InitHooks(cJSON_Hooks* hooks)
     cJSON_free   = (hooks->free_fn)?hooks->free_fn:free;
 }
 
+/* Block of items being filled by cJSON_ParseInPlace, or 0. */
+static cJSON *block_next,*block_end;
+
 /* Internal constructor. */
 static cJSON *cJSON_New_Item(void)
 {
-    cJSON* node = (cJSON*)cJSON_malloc(sizeof(cJSON));
+    cJSON* node;
+    if (block_next)
+    {
+        if (block_next==block_end) return 0;    /* cannot happen: the block is sized from the text. */
+        node=block_next++;
+        memset(node,0,sizeof(cJSON));
+        return node;
+    }
+    node = (cJSON*)cJSON_malloc(sizeof(cJSON));
     if (node) memset(node,0,sizeof(cJSON));
     return node;
 }
@@ -85,9 +96,10 @@ void cJSON_Delete(cJSON *c)
     {
         next=c->next;
         if (!(c->type&cJSON_IsReference) && c->child) cJSON_Delete(c->child);
-        if (!(c->type&cJSON_IsReference) && c->valuestring) cJSON_free(c->valuestring);
-        if (c->string) cJSON_free(c->string);
-        cJSON_free(c);
+        if (c->hash) cJSON_free(c->hash);
+        if (!(c->type&(cJSON_IsReference|cJSON_IsInPlace)) && c->valuestring) cJSON_free(c->valuestring);
+        if (c->string && !(c->type&cJSON_IsInPlace)) cJSON_free(c->string);
+        if (!(c->type&cJSON_IsInPlace) || (c->type&cJSON_IsInPlaceRoot)) cJSON_free(c);  /* the root of an in-place tree is its block. */
         c=next;
     }
 }
@@ -114,19 +126,50 @@ static const char *parse_number(cJSON *item,const char *num)
     return num;
 }
 
+/* Output buffer of the printer, grown as needed. */
+typedef struct {char *buffer; int length; int offset; } printbuffer;
+
+/* Make room for needed more bytes at p->offset, and return where they go. */
+static char* ensure(printbuffer *p,int needed)
+{
+    char *newbuffer;int newsize;
+    if (!p->buffer) return 0;
+    needed+=p->offset;
+    if (needed<=p->length) return p->buffer+p->offset;
+
+    for (newsize=p->length;newsize<needed;newsize*=2);
+    newbuffer=(char*)cJSON_malloc(newsize);
+    if (!newbuffer) {cJSON_free(p->buffer);p->length=0,p->buffer=0;return 0;}
+    memcpy(newbuffer,p->buffer,p->offset);
+    cJSON_free(p->buffer);
+    p->length=newsize;
+    p->buffer=newbuffer;
+    return newbuffer+p->offset;
+}
+
+/* Append a constant string. */
+static int print_raw(printbuffer *p,const char *str,int len)
+{
+    char *out=ensure(p,len+1);
+    if (!out) return 0;
+    memcpy(out,str,len);out[len]=0;
+    p->offset+=len;
+    return 1;
+}
+
 /* Render the number nicely from the given item into a string. */
-static char *print_number(cJSON *item)
+static int print_number(cJSON *item,printbuffer *p)
 {
     char *str;
     double d=item->valuedouble;
     if (fabs(((double)item->valueint)-d)<=DBL_EPSILON && d<=INT_MAX && d>=INT_MIN)
     {
-        str=(char*)cJSON_malloc(21);    /* 2^64+1 can be represented in 21 chars. */
+        str=ensure(p,21);    /* 2^64+1 can be represented in 21 chars. */
         if (str) sprintf(str,"%d",item->valueint);
     }
     else
     {
-        str=(char*)cJSON_malloc(64);    /* This is a nice tradeoff. */
+        str=ensure(p,64);    /* This is a nice tradeoff. */
         if (str)
         {
             if (fabs(floor(d)-d)<=DBL_EPSILON && fabs(d)<1.0e60)sprintf(str,"%.0f",d);
@@ -134,7 +177,9 @@ static char *print_number(cJSON *item)
             else                                                sprintf(str,"%f",d);
         }
     }
-    return str;
+    if (!str) return 0;
+    p->offset+=strlen(str);
+    return 1;
 }
 
 static unsigned parse_hex4(const char *str)
@@ -157,10 +202,14 @@ static const char *parse_string(cJSON *item,const char *str)
     const char *ptr=str+1;char *ptr2;char *out;int len=0;unsigned uc,uc2;
     if (*str!='\"') {ep=str;return 0;}  /* not a string! */
     
-    while (*ptr!='\"' && *ptr && ++len) if (*ptr++ == '\\') ptr++;  /* Skip escaped quotes. */
-    
-    out=(char*)cJSON_malloc(len+1); /* This is how long we need for the string, roughly. */
-    if (!out) return 0;
+    if (block_next) out=(char*)ptr; /* In place: unescaped text never outgrows the escaped one. */
+    else
+    {
+        while (*ptr!='\"' && *ptr && ++len) if (*ptr++ == '\\') ptr++;  /* Skip escaped quotes. */
+
+        out=(char*)cJSON_malloc(len+1); /* This is how long we need for the string, roughly. */
+        if (!out) return 0;
+    }
     
     ptr=str+1;ptr2=out;
     while (*ptr!='\"' && *ptr)
@@ -204,22 +253,22 @@ static const char *parse_string(cJSON *item,const char *str)
             ptr++;
         }
     }
-    *ptr2=0;
     if (*ptr=='\"') ptr++;
+    *ptr2=0;    /* in place, this may overwrite the closing quote, which is why it is skipped first. */
     item->valuestring=out;
     item->type=cJSON_String;
     return ptr;
 }
 
 /* Render the cstring provided to an escaped version that can be printed. */
-static char *print_string_ptr(const char *str)
+static int print_string_ptr(const char *str,printbuffer *p)
 {
     const char *ptr;char *ptr2,*out;int len=0;unsigned char token;
     
-    if (!str) return cJSON_strdup("");
+    if (!str) return print_raw(p,"\"\"",2);
     ptr=str;while ((token=*ptr) && ++len) {if (strchr("\"\\\b\f\n\r\t",token)) len++; else if (token<32) len+=5;ptr++;}
     
-    out=(char*)cJSON_malloc(len+3);
+    out=ensure(p,len+3);
     if (!out) return 0;
 
     ptr2=out;ptr=str;
@@ -243,19 +292,20 @@ static char *print_string_ptr(const char *str)
             }
         }
     }
-    *ptr2++='\"';*ptr2++=0;
-    return out;
+    *ptr2++='\"';*ptr2=0;
+    p->offset+=len+2;
+    return 1;
 }
 /* Invote print_string_ptr (which is useful) on an item. */
-static char *print_string(cJSON *item)  {return print_string_ptr(item->valuestring);}
+static int print_string(cJSON *item,printbuffer *p)    {return print_string_ptr(item->valuestring,p);}
 
 /* Predeclare these prototypes. */
 static const char *parse_value(cJSON *item,const char *value);
-static char *print_value(cJSON *item,int depth,int fmt);
+static int print_value(cJSON *item,int depth,int fmt,printbuffer *p);
 static const char *parse_array(cJSON *item,const char *value);
-static char *print_array(cJSON *item,int depth,int fmt);
+static int print_array(cJSON *item,int depth,int fmt,printbuffer *p);
 static const char *parse_object(cJSON *item,const char *value);
-static char *print_object(cJSON *item,int depth,int fmt);
+static int print_object(cJSON *item,int depth,int fmt,printbuffer *p);
 
 /* Utility to jump whitespace and cr/lf */
 static const char *skip(const char *in) {while (in && *in && (unsigned char)*in<=32) in++; return in;}
@@ -279,9 +329,40 @@ cJSON *cJSON_ParseWithOpts(const char *value,const char **return_parse_end,int r
 /* Default options for cJSON_Parse */
 cJSON *cJSON_Parse(const char *value) {return cJSON_ParseWithOpts(value,0,0);}
 
-/* Render a cJSON item/entity/structure to text. */
-char *cJSON_Print(cJSON *item)              {return print_value(item,0,1);}
-char *cJSON_PrintUnformatted(cJSON *item)   {return print_value(item,0,0);}
+/* Parse into one block of items, leaving the strings in value. */
+cJSON *cJSON_ParseInPlace(char *value)
+{
+    const char *end;const char *ptr;cJSON *block,*c;int count=1;
+    ep=0;
+    if (!value) return 0;
+    for (ptr=value;*ptr;ptr++) if (*ptr==',' || *ptr=='[' || *ptr=='{') count++;     /* Every item but the root follows one of these. */
+
+    block=(cJSON*)cJSON_malloc(count*sizeof(cJSON));
+    if (!block) return 0;   /* memory fail */
+    block_next=block;block_end=block+count;
+
+    end=parse_value(c=cJSON_New_Item(),skip(value));
+    for (c=block;c<block_next;c++) c->type|=cJSON_IsInPlace;
+    block_next=block_end=0;
+    if (!end)   {cJSON_free(block);return 0;}   /* parse failure. ep is set. */
+
+    block->type|=cJSON_IsInPlaceRoot;
+    return block;
+}
+
+/* Render a cJSON item/entity/structure to text, into one buffer grown as needed. */
+char *cJSON_PrintBuffered(cJSON *item,int prebuffer,int fmt)
+{
+    printbuffer p;
+    p.length=prebuffer>0?prebuffer:1;
+    p.buffer=(char*)cJSON_malloc(p.length);
+    p.offset=0;
+    if (!p.buffer) return 0;
+    if (!print_value(item,0,fmt,&p)) {if (p.buffer) cJSON_free(p.buffer);return 0;}
+    return p.buffer;
+}
+char *cJSON_Print(cJSON *item)              {return cJSON_PrintBuffered(item,256,1);}
+char *cJSON_PrintUnformatted(cJSON *item)   {return cJSON_PrintBuffered(item,256,0);}
 
 /* Parser core - when encountering text, process appropriately. */
 static const char *parse_value(cJSON *item,const char *value)
@@ -299,21 +380,20 @@ static const char *parse_value(cJSON *item,const char *value)
 }
 
 /* Render a value to text. */
-static char *print_value(cJSON *item,int depth,int fmt)
+static int print_value(cJSON *item,int depth,int fmt,printbuffer *p)
 {
-    char *out=0;
     if (!item) return 0;
     switch ((item->type)&255)
     {
-        case cJSON_NULL:    out=cJSON_strdup("null");   break;
-        case cJSON_False:   out=cJSON_strdup("false");break;
-        case cJSON_True:    out=cJSON_strdup("true"); break;
-        case cJSON_Number:  out=print_number(item);break;
-        case cJSON_String:  out=print_string(item);break;
-        case cJSON_Array:   out=print_array(item,depth,fmt);break;
-        case cJSON_Object:  out=print_object(item,depth,fmt);break;
+        case cJSON_NULL:    return print_raw(p,"null",4);
+        case cJSON_False:   return print_raw(p,"false",5);
+        case cJSON_True:    return print_raw(p,"true",4);
+        case cJSON_Number:  return print_number(item,p);
+        case cJSON_String:  return print_string(item,p);
+        case cJSON_Array:   return print_array(item,depth,fmt,p);
+        case cJSON_Object:  return print_object(item,depth,fmt,p);
     }
-    return out;
+    return 0;
 }
 
 /* Build an array from input text. */
@@ -345,61 +425,18 @@ static const char *parse_array(cJSON *item,const char *value)
 }
 
 /* Render an array to text */
-static char *print_array(cJSON *item,int depth,int fmt)
+static int print_array(cJSON *item,int depth,int fmt,printbuffer *p)
 {
-    char **entries;
-    char *out=0,*ptr,*ret;int len=5;
     cJSON *child=item->child;
-    int numentries=0,i=0,fail=0;
     
-    /* How many entries in the array? */
-    while (child) numentries++,child=child->next;
-    /* Explicitly handle numentries==0 */
-    if (!numentries)
-    {
-        out=(char*)cJSON_malloc(3);
-        if (out) strcpy(out,"[]");
-        return out;
-    }
-    /* Allocate an array to hold the values for each */
-    entries=(char**)cJSON_malloc(numentries*sizeof(char*));
-    if (!entries) return 0;
-    memset(entries,0,numentries*sizeof(char*));
-    /* Retrieve all the results: */
-    child=item->child;
-    while (child && !fail)
+    if (!print_raw(p,"[",1)) return 0;
+    while (child)
     {
-        ret=print_value(child,depth+1,fmt);
-        entries[i++]=ret;
-        if (ret) len+=strlen(ret)+2+(fmt?1:0); else fail=1;
+        if (!print_value(child,depth+1,fmt,p)) return 0;
+        if (child->next && !print_raw(p,", ",fmt?2:1)) return 0;
         child=child->next;
     }
-    
-    /* If we didn't fail, try to malloc the output string */
-    if (!fail) out=(char*)cJSON_malloc(len);
-    /* If that fails, we fail. */
-    if (!out) fail=1;
-
-    /* Handle failure. */
-    if (fail)
-    {
-        for (i=0;i<numentries;i++) if (entries[i]) cJSON_free(entries[i]);
-        cJSON_free(entries);
-        return 0;
-    }
-    
-    /* Compose the output array. */
-    *out='[';
-    ptr=out+1;*ptr=0;
-    for (i=0;i<numentries;i++)
-    {
-        strcpy(ptr,entries[i]);ptr+=strlen(entries[i]);
-        if (i!=numentries-1) {*ptr++=',';if(fmt)*ptr++=' ';*ptr=0;}
-        cJSON_free(entries[i]);
-    }
-    cJSON_free(entries);
-    *ptr++=']';*ptr++=0;
-    return out; 
+    return print_raw(p,"]",1);
 }
 
 /* Build an object from the text. */
@@ -438,98 +475,124 @@ static const char *parse_object(cJSON *item,const char *value)
     ep=value;return 0;  /* malformed. */
 }
 
+/* Append n tabs. */
+static int print_tabs(printbuffer *p,int n)
+{
+    char *out;
+    if (n<0) n=0;
+    if (!(out=ensure(p,n+1))) return 0;
+    memset(out,'\t',n);out[n]=0;
+    p->offset+=n;
+    return 1;
+}
+
 /* Render an object to text. */
-static char *print_object(cJSON *item,int depth,int fmt)
+static int print_object(cJSON *item,int depth,int fmt,printbuffer *p)
 {
-    char **entries=0,**names=0;
-    char *out=0,*ptr,*ret,*str;int len=7,i=0,j;
     cJSON *child=item->child;
-    int numentries=0,fail=0;
-    /* Count the number of entries. */
-    while (child) numentries++,child=child->next;
+    
+    if (!print_raw(p,"{",1)) return 0;
     /* Explicitly handle empty object case */
-    if (!numentries)
+    if (!child)
     {
-        out=(char*)cJSON_malloc(fmt?depth+4:3);
-        if (!out)   return 0;
-        ptr=out;*ptr++='{';
-        if (fmt) {*ptr++='\n';for (i=0;i<depth-1;i++) *ptr++='\t';}
-        *ptr++='}';*ptr++=0;
-        return out;
+        if (fmt && (!print_raw(p,"\n",1) || !print_tabs(p,depth-1))) return 0;
+        return print_raw(p,"}",1);
     }
-    /* Allocate space for the names and the objects */
-    entries=(char**)cJSON_malloc(numentries*sizeof(char*));
-    if (!entries) return 0;
-    names=(char**)cJSON_malloc(numentries*sizeof(char*));
-    if (!names) {cJSON_free(entries);return 0;}
-    memset(entries,0,sizeof(char*)*numentries);
-    memset(names,0,sizeof(char*)*numentries);
-
-    /* Collect all the results into our arrays: */
-    child=item->child;depth++;if (fmt) len+=depth;
+    if (fmt && !print_raw(p,"\n",1)) return 0;
+
+    depth++;
     while (child)
     {
-        names[i]=str=print_string_ptr(child->string);
-        entries[i++]=ret=print_value(child,depth,fmt);
-        if (str && ret) len+=strlen(ret)+strlen(str)+2+(fmt?2+depth:0); else fail=1;
+        if (fmt && !print_tabs(p,depth)) return 0;
+        if (!print_string_ptr(child->string,p)) return 0;
+        if (!print_raw(p,":\t",fmt?2:1)) return 0;
+        if (!print_value(child,depth,fmt,p)) return 0;
+        if (child->next && !print_raw(p,",",1)) return 0;
+        if (fmt && !print_raw(p,"\n",1)) return 0;
         child=child->next;
     }
-    
-    /* Try to allocate the output string */
-    if (!fail) out=(char*)cJSON_malloc(len);
-    if (!out) fail=1;
+    if (fmt && !print_tabs(p,depth-1)) return 0;
+    return print_raw(p,"}",1);
+}
+
+/* Get Array size/item / object item. */
+int    cJSON_GetArraySize(cJSON *array)                         {cJSON *c=array->child;int i=0;while(c)i++,c=c->next;return i;}
+cJSON *cJSON_GetArrayItem(cJSON *array,int item)                {cJSON *c=array->child;  while (c && item>0) item--,c=c->next; return c;}
 
-    /* Handle failure */
-    if (fail)
+/* Index of an object's members: open addressing on the case-folded name, filled in member order,
+   so that the first of several equal names is also the first one probed. */
+struct cJSON_Hash {int mask; cJSON *slot[1];};
+#define CJSON_HASH_MIN 16   /* Below this many members, walking the list is as cheap. */
+
+static unsigned cJSON_hash(const char *str)
+{
+    unsigned h=2166136261u;
+    while (*str) h=(h^(unsigned)tolower(*(const unsigned char *)str++))*16777619u;
+    return h;
+}
+
+/* Drop the index of an object whose members change. */
+static void cJSON_DropHash(cJSON *object) {if (object->hash) {cJSON_free(object->hash);object->hash=0;}}
+
+/* Build the index of a large object; leaves it unindexed if small, unnamed members are found or memory fails. */
+static struct cJSON_Hash *cJSON_BuildHash(cJSON *object)
+{
+    struct cJSON_Hash *hash;cJSON *c;int count=0,size=1;unsigned i;
+    if (object->type&cJSON_IsReference) return 0;   /* the list belongs to another item. */
+    for (c=object->child;c;c=c->next) {if (!c->string) return 0;count++;}
+    if (count<CJSON_HASH_MIN) return 0;
+
+    while (size<count*2) size<<=1;
+    hash=(struct cJSON_Hash*)cJSON_malloc(sizeof(struct cJSON_Hash)+(size-1)*sizeof(cJSON*));
+    if (!hash) return 0;
+    memset(hash->slot,0,size*sizeof(cJSON*));
+    hash->mask=size-1;
+    for (c=object->child;c;c=c->next)
     {
-        for (i=0;i<numentries;i++) {if (names[i]) cJSON_free(names[i]);if (entries[i]) cJSON_free(entries[i]);}
-        cJSON_free(names);cJSON_free(entries);
-        return 0;
+        for (i=cJSON_hash(c->string)&hash->mask;hash->slot[i];i=(i+1)&hash->mask);
+        hash->slot[i]=c;
     }
-    
-    /* Compose the output: */
-    *out='{';ptr=out+1;if (fmt)*ptr++='\n';*ptr=0;
-    for (i=0;i<numentries;i++)
+    return object->hash=hash;
+}
+
+/* Look a member up, by the index if the object is large enough to have one. */
+static cJSON *cJSON_FindMember(cJSON *object,const char *string,int case_sensitive)
+{
+    struct cJSON_Hash *hash=object->hash;cJSON *c;unsigned i;
+    if (string && (hash || (object->child && (hash=cJSON_BuildHash(object)))))
     {
-        if (fmt) for (j=0;j<depth;j++) *ptr++='\t';
-        strcpy(ptr,names[i]);ptr+=strlen(names[i]);
-        *ptr++=':';if (fmt) *ptr++='\t';
-        strcpy(ptr,entries[i]);ptr+=strlen(entries[i]);
-        if (i!=numentries-1) *ptr++=',';
-        if (fmt) *ptr++='\n';*ptr=0;
-        cJSON_free(names[i]);cJSON_free(entries[i]);
+        for (i=cJSON_hash(string)&hash->mask;(c=hash->slot[i]);i=(i+1)&hash->mask)
+            if (!(case_sensitive?strcmp(c->string,string):cJSON_strcasecmp(c->string,string))) return c;
+        return 0;
     }
-    
-    cJSON_free(names);cJSON_free(entries);
-    if (fmt) for (i=0;i<depth-1;i++) *ptr++='\t';
-    *ptr++='}';*ptr++=0;
-    return out; 
+    c=object->child;
+    if (case_sensitive) {while (c && (!c->string || !string || strcmp(c->string,string))) c=c->next;}
+    else                {while (c && cJSON_strcasecmp(c->string,string)) c=c->next;}
+    return c;
 }
 
-/* Get Array size/item / object item. */
-int    cJSON_GetArraySize(cJSON *array)                         {cJSON *c=array->child;int i=0;while(c)i++,c=c->next;return i;}
-cJSON *cJSON_GetArrayItem(cJSON *array,int item)                {cJSON *c=array->child;  while (c && item>0) item--,c=c->next; return c;}
-cJSON *cJSON_GetObjectItem(cJSON *object,const char *string)    {cJSON *c=object->child; while (c && cJSON_strcasecmp(c->string,string)) c=c->next; return c;}
+cJSON *cJSON_GetObjectItem(cJSON *object,const char *string)                {return cJSON_FindMember(object,string,0);}
+cJSON *cJSON_GetObjectItemCaseSensitive(cJSON *object,const char *string)   {return cJSON_FindMember(object,string,1);}
 
 /* Utility for array list handling. */
 static void suffix_object(cJSON *prev,cJSON *item) {prev->next=item;item->prev=prev;}
 /* Utility for handling references. */
-static cJSON *create_reference(cJSON *item) {cJSON *ref=cJSON_New_Item();if (!ref) return 0;memcpy(ref,item,sizeof(cJSON));ref->string=0;ref->type|=cJSON_IsReference;ref->next=ref->prev=0;return ref;}
+static cJSON *create_reference(cJSON *item) {cJSON *ref=cJSON_New_Item();if (!ref) return 0;memcpy(ref,item,sizeof(cJSON));ref->string=0;ref->type=(ref->type&~(cJSON_IsInPlace|cJSON_IsInPlaceRoot))|cJSON_IsReference;ref->next=ref->prev=0;ref->hash=0;return ref;}
 
 /* Add item to array/object. */
-void   cJSON_AddItemToArray(cJSON *array, cJSON *item)                      {cJSON *c=array->child;if (!item) return; if (!c) {array->child=item;} else {while (c && c->next) c=c->next; suffix_object(c,item);}}
-void   cJSON_AddItemToObject(cJSON *object,const char *string,cJSON *item)  {if (!item) return; if (item->string) cJSON_free(item->string);item->string=cJSON_strdup(string);cJSON_AddItemToArray(object,item);}
+void   cJSON_AddItemToArray(cJSON *array, cJSON *item)                      {cJSON *c=array->child;if (!item) return; cJSON_DropHash(array); if (!c) {array->child=item;} else {while (c && c->next) c=c->next; suffix_object(c,item);}}
+void   cJSON_AddItemToObject(cJSON *object,const char *string,cJSON *item)  {if (!item) return; if (item->string && !(item->type&cJSON_IsInPlace)) cJSON_free(item->string);item->string=cJSON_strdup(string);cJSON_AddItemToArray(object,item);}
 void    cJSON_AddItemReferenceToArray(cJSON *array, cJSON *item)                        {cJSON_AddItemToArray(array,create_reference(item));}
 void    cJSON_AddItemReferenceToObject(cJSON *object,const char *string,cJSON *item)    {cJSON_AddItemToObject(object,string,create_reference(item));}
 
-cJSON *cJSON_DetachItemFromArray(cJSON *array,int which)            {cJSON *c=array->child;while (c && which>0) c=c->next,which--;if (!c) return 0;
+cJSON *cJSON_DetachItemFromArray(cJSON *array,int which)            {cJSON *c=array->child;while (c && which>0) c=c->next,which--;if (!c) return 0;cJSON_DropHash(array);
     if (c->prev) c->prev->next=c->next;if (c->next) c->next->prev=c->prev;if (c==array->child) array->child=c->next;c->prev=c->next=0;return c;}
 void   cJSON_DeleteItemFromArray(cJSON *array,int which)            {cJSON_Delete(cJSON_DetachItemFromArray(array,which));}
 cJSON *cJSON_DetachItemFromObject(cJSON *object,const char *string) {int i=0;cJSON *c=object->child;while (c && cJSON_strcasecmp(c->string,string)) i++,c=c->next;if (c) return cJSON_DetachItemFromArray(object,i);return 0;}
 void   cJSON_DeleteItemFromObject(cJSON *object,const char *string) {cJSON_Delete(cJSON_DetachItemFromObject(object,string));}
 
 /* Replace array/object items with new ones. */
-void   cJSON_ReplaceItemInArray(cJSON *array,int which,cJSON *newitem)      {cJSON *c=array->child;while (c && which>0) c=c->next,which--;if (!c) return;
+void   cJSON_ReplaceItemInArray(cJSON *array,int which,cJSON *newitem)      {cJSON *c=array->child;while (c && which>0) c=c->next,which--;if (!c) return;cJSON_DropHash(array);
     newitem->next=c->next;newitem->prev=c->prev;if (newitem->next) newitem->next->prev=newitem;
     if (c==array->child) array->child=newitem; else newitem->prev->next=newitem;c->next=c->prev=0;cJSON_Delete(c);}
 void   cJSON_ReplaceItemInObject(cJSON *object,const char *string,cJSON *newitem){int i=0;cJSON *c=object->child;while(c && cJSON_strcasecmp(c->string,string))i++,c=c->next;if(c){newitem->string=cJSON_strdup(string);cJSON_ReplaceItemInArray(object,i,newitem);}}
@@ -560,7 +623,7 @@ cJSON *cJSON_Duplicate(cJSON *item,int recurse)
     newitem=cJSON_New_Item();
     if (!newitem) return 0;
     /* Copy over all vars */
-    newitem->type=item->type&(~cJSON_IsReference),newitem->valueint=item->valueint,newitem->valuedouble=item->valuedouble;
+    newitem->type=item->type&(~(cJSON_IsReference|cJSON_IsInPlace|cJSON_IsInPlaceRoot)),newitem->valueint=item->valueint,newitem->valuedouble=item->valuedouble;
     if (item->valuestring)  {newitem->valuestring=cJSON_strdup(item->valuestring);  if (!newitem->valuestring)  {cJSON_Delete(newitem);return 0;}}
     if (item->string)       {newitem->string=cJSON_strdup(item->string);            if (!newitem->string)       {cJSON_Delete(newitem);return 0;}}
     /* If non-recursive, then we're done! */
@@ -38,6 +38,8 @@ extern "C"
 #define cJSON_Object 6
     
 #define cJSON_IsReference 256
+#define cJSON_IsInPlace 512
+#define cJSON_IsInPlaceRoot 1024
 
 /* The cJSON structure: */
 typedef struct cJSON {
@@ -51,6 +53,8 @@ typedef struct cJSON {
     double valuedouble;         /* The item's number, if type==cJSON_Number */
 
     char *string;               /* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
+
+    struct cJSON_Hash *hash;    /* Index of a large object's members, built by the first lookup and dropped when they change. */
 } cJSON;
 
 typedef struct cJSON_Hooks {
@@ -77,6 +81,9 @@ extern int    cJSON_GetArraySize(cJSON *array);
 extern cJSON *cJSON_GetArrayItem(cJSON *array,int item);
 /* Get item "string" from object. Case insensitive. */
 extern cJSON *cJSON_GetObjectItem(cJSON *object,const char *string);
+/* As GetObjectItem, but the name must match exactly. Objects of 16 members or more are indexed by their first lookup;
+   the calls below that change members drop the index, so relink or rename members by hand only before looking up. */
+extern cJSON *cJSON_GetObjectItemCaseSensitive(cJSON *object,const char *string);
 
 /* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when cJSON_Parse() returns 0. 0 when cJSON_Parse() succeeds. */
 extern const char *cJSON_GetErrorPtr(void);
@@ -123,6 +130,14 @@ The item->next and ->prev pointers are always zero on return from Duplicate. */
 /* ParseWithOpts allows you to require (and check) that the JSON is null terminated, and to retrieve the pointer to the final byte parsed. */
 extern cJSON *cJSON_ParseWithOpts(const char *value,const char **return_parse_end,int require_null_terminated);
 
+/* ParseInPlace takes a writable, null terminated block of JSON and unescapes the strings into it, so that the
+items' strings point into value; all the items come from a single allocation. Call cJSON_Delete on the root
+when finished, and keep value until then. Items of such a tree must not be renamed or outlive its root, and
+carry cJSON_IsInPlace in their type, so test (type&255). */
+extern cJSON *cJSON_ParseInPlace(char *value);
+/* PrintBuffered renders into a buffer of prebuffer bytes, grown as needed; a good guess saves reallocations. fmt=0 gives unformatted, =1 gives formatted. */
+extern char *cJSON_PrintBuffered(cJSON *item,int prebuffer,int fmt);
+
 extern void cJSON_Minify(char *json);
 
 /* Macros for creating things quickly. */
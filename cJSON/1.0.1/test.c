@@ -22,6 +22,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "cJSON.h"
 
 /* Parse text to JSON, then render back to text, and print! */
@@ -49,6 +51,37 @@ void dofile(char *filename)
 	free(data);
 }
 
+/* Time parsing and printing a file, with and without parsing in place. */
+void benchfile(const char *filename,int iterations)
+{
+	FILE *f=fopen(filename,"rb");if (!f) {printf("Cannot open %s\n",filename);return;}
+	fseek(f,0,SEEK_END);long len=ftell(f);fseek(f,0,SEEK_SET);
+	char *data=(char*)malloc(len+1),*copy=(char*)malloc(len+1);fread(data,1,len,f);fclose(f);data[len]=0;
+	cJSON *json;char *out;clock_t start;int i;
+
+	start=clock();
+	for (i=0;i<iterations;i++) {json=cJSON_Parse(data);cJSON_Delete(json);}
+	printf("%s: Parse        %.3fs\n",filename,(double)(clock()-start)/CLOCKS_PER_SEC);
+
+	start=clock();
+	for (i=0;i<iterations;i++) {memcpy(copy,data,len+1);json=cJSON_ParseInPlace(copy);cJSON_Delete(json);}
+	printf("%s: ParseInPlace %.3fs\n",filename,(double)(clock()-start)/CLOCKS_PER_SEC);
+
+	json=cJSON_Parse(data);
+	if (!json) printf("Error before: [%s]\n",cJSON_GetErrorPtr());
+	else
+	{
+		start=clock();
+		for (i=0;i<iterations;i++) {out=cJSON_PrintUnformatted(json);free(out);}
+		printf("%s: Print        %.3fs\n",filename,(double)(clock()-start)/CLOCKS_PER_SEC);
+		start=clock();
+		for (i=0;i<iterations;i++) {out=cJSON_PrintBuffered(json,(int)len,0);free(out);}
+		printf("%s: PrintBuffered %.3fs\n",filename,(double)(clock()-start)/CLOCKS_PER_SEC);
+		cJSON_Delete(json);
+	}
+	free(copy);free(data);
+}
+
 /* Used by some code below as an example datatype. */
 struct record {const char *precision;double lat,lon;const char *address,*city,*state,*zip,*country; };
 
@@ -128,6 +161,14 @@ void create_objects()
 }
 
 int main (int argc, const char * argv[]) {
+	/* With files given, benchmark them instead: */
+	if (argc>1)
+	{
+		int i;
+		for (i=1;i<argc;i++) benchfile(argv[i],1000);
+		return 0;
+	}
+
 	/* a bunch of json: */
 	char text1[]="{\n\"name\": \"Jack (\\\"Bee\\\") Nimble\", \n\"format\": {\"type\":       \"rect\", \n\"width\":      1920, \n\"height\":     1080, \n\"interlace\":  false,\"frame rate\": 24\n}\n}";	
 	char text2[]="[\"Sunday\", \"Monday\", \"Tuesday\", \"Wednesday\", \"Thursday\", \"Friday\", \"Saturday\"]";
@@ -0,0 +1,43 @@
+/* copy-progress.h -- progress reports of the regular file copies in copy.c
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.  */
+
+#ifndef COPY_PROGRESS_H
+# define COPY_PROGRESS_H
+
+# include <stdint.h>
+# include <time.h>
+
+struct copy_progress
+{
+  char const *src_name;
+  char const *dst_name;
+
+  /* Bytes copied so far, and the size of the source file, or 0 when
+     the source is not a regular file.  */
+  uintmax_t copied;
+  uintmax_t total;
+
+  /* Time since the copy of this file started.  COPIED / ELAPSED is the
+     throughput, from which (TOTAL - COPIED) gives the remaining time.  */
+  struct timespec elapsed;
+};
+
+/* Called about every 8 MiB copied, and once when a file is done.  */
+typedef void (*copy_progress_fn) (struct copy_progress const *, void *);
+
+void copy_set_progress (copy_progress_fn fn, void *arg);
+
+#endif
@@ -295,6 +295,14 @@ struct e2fsck_struct {
 	int process_inode_size;
 	int inode_buffer_blocks;
 	unsigned int htree_slack_percentage;
+	unsigned int readahead_kb;	/* Inode tables read ahead in pass 1 */
+
+	/*
+	 * Inode table readahead for pass 1
+	 */
+	dgrp_t readahead_groups;	/* Groups to read ahead of the scan */
+	dgrp_t readahead_next;		/* First group not read ahead yet */
+	blk64_t	readahead_blocks;	/* Blocks read ahead */
 
 	/*
 	 * ext3 journal support
@@ -463,6 +471,10 @@ extern errcode_t e2fsck_adjust_inode_count(e2fsck_t ctx, ext2_ino_t ino,
 					   int adj);
 
 
+/* readahead.c */
+extern void e2fsck_readahead_init(e2fsck_t ctx);
+extern void e2fsck_readahead_itable(e2fsck_t ctx, dgrp_t group);
+
 /* region.c */
 extern region_t region_create(region_addr_t min, region_addr_t max);
 extern void region_free(region_t region);
@@ -483,6 +495,7 @@ extern void *e2fsck_allocate_memory(e2fsck_t ctx, unsigned int size,
 extern int ask(e2fsck_t ctx, const char * string, int def);
 extern int ask_yn(const char * string, int def);
 extern void fatal_error(e2fsck_t ctx, const char * fmt_string);
+extern void e2fsck_set_bitmap_type(e2fsck_t ctx);
 extern void e2fsck_read_bitmaps(e2fsck_t ctx);
 extern void e2fsck_write_bitmaps(e2fsck_t ctx);
 extern void preenhalt(e2fsck_t ctx);
@@ -688,6 +688,8 @@ void e2fsck_pass1(e2fsck_t ctx)
 	scan_struct.ctx = ctx;
 	scan_struct.block_buf = block_buf;
 	ext2fs_set_inode_callback(scan, scan_callback, &scan_struct);
+	e2fsck_readahead_init(ctx);
+	e2fsck_readahead_itable(ctx, 0);
 	if (ctx->progress)
 		if ((ctx->progress)(ctx, 1, 0, ctx->fs->group_desc_count))
 			return;
@@ -1171,6 +1173,12 @@ endit:
 	ext2fs_free_mem(&inode);
 
 	print_resource_track(ctx, _("Pass 1"), &rtrack, ctx->fs->io);
+#ifdef RESOURCE_TRACK
+	if ((ctx->options & E2F_OPT_TIME2) && ctx->readahead_groups)
+		printf(_("Pass 1: readahead: %lluMB, %u groups ahead\n"),
+		       (ctx->readahead_blocks * fs->blocksize + 1048575) /
+		       1048576, ctx->readahead_groups);
+#endif
 }
 
 /*
@@ -1188,6 +1196,7 @@ static errcode_t scan_callback(ext2_filsys fs,
 	ctx = scan_struct->ctx;
 
 	process_inodes((e2fsck_t) fs->priv_data, scan_struct->block_buf);
+	e2fsck_readahead_itable(ctx, group + 1);
 
 	if (ctx->progress)
 		if ((ctx->progress)(ctx, 1, group+1,
@@ -100,6 +100,76 @@ static void print_bitmap_problem(e2fsck_t ctx, int problem,
 	pctx->ino = pctx->ino2 = 0;
 }
 
+/*
+ * Most groups of a consistent filesystem have the same bitmaps in
+ * memory and on disk, so the bitmaps are first compared a whole group
+ * at a time, and only the groups which differ are checked bit by bit.
+ */
+static int group_bits_equal(const unsigned char *a, const unsigned char *b,
+			    unsigned int num)
+{
+	unsigned int	bytes = num >> 3;
+
+	if (memcmp(a, b, bytes))
+		return 0;
+	if ((num & 7) && ((a[bytes] ^ b[bytes]) & ((1 << (num & 7)) - 1)))
+		return 0;
+	return 1;
+}
+
+static unsigned int group_bits_count(const unsigned char *bits,
+				     const unsigned char *mask,
+				     unsigned int num)
+{
+	static const unsigned char nibble_bits[16] = {
+		0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+	unsigned int	i, count = 0;
+	unsigned char	c;
+
+	for (i = 0; i < (num + 7) >> 3; i++) {
+		c = mask ? bits[i] & mask[i] : bits[i];
+		if ((i == num >> 3) && (num & 7))
+			c &= (1 << (num & 7)) - 1;
+		count += nibble_bits[c & 15] + nibble_bits[c >> 4];
+	}
+	return count;
+}
+
+/*
+ * The blocks that a group with BLOCK_UNINIT uses within itself: its
+ * superblock and descriptor backups, its bitmaps and its inode table.
+ */
+static void uninit_group_bits(ext2_filsys fs, dgrp_t group, blk_t first,
+			      blk_t num, unsigned char *bits)
+{
+	blk_t	super_blk, old_desc_blk, new_desc_blk, blk;
+	blk_t	itable = fs->group_desc[group].bg_inode_table;
+	int	old_desc_blocks;
+
+	ext2fs_super_and_bgd_loc(fs, group, &super_blk,
+				 &old_desc_blk, &new_desc_blk, 0);
+
+	if (fs->super->s_feature_incompat & EXT2_FEATURE_INCOMPAT_META_BG)
+		old_desc_blocks = fs->super->s_first_meta_bg;
+	else
+		old_desc_blocks = fs->desc_blocks +
+			fs->super->s_reserved_gdt_blocks;
+
+	memset(bits, 0, (num + 7) >> 3);
+	for (blk = first; blk < first + num; blk++) {
+		if ((blk == super_blk) ||
+		    (old_desc_blk && old_desc_blocks &&
+		     (blk >= old_desc_blk) &&
+		     (blk < old_desc_blk + old_desc_blocks)) ||
+		    (new_desc_blk && (blk == new_desc_blk)) ||
+		    (blk == fs->group_desc[group].bg_block_bitmap) ||
+		    (blk == fs->group_desc[group].bg_inode_bitmap) ||
+		    ((blk >= itable) &&
+		     (blk < itable + fs->inode_blocks_per_group)))
+			ext2fs_set_bit(blk - first, bits);
+	}
+}
+
 static void check_block_bitmaps(e2fsck_t ctx)
 {
 	ext2_filsys fs = ctx->fs;
@@ -115,10 +185,16 @@ static void check_block_bitmaps(e2fsck_t ctx)
 	errcode_t	retval;
 	int		csum_flag;
 	int		skip_group = 0;
+	blk_t		num = 0;
+	unsigned int	nbytes = (fs->super->s_blocks_per_group + 7) >> 3;
+	unsigned char	*found_bits, *disk_bits;
 
 	clear_problem_context(&pctx);
 	free_array = (int *) e2fsck_allocate_memory(ctx,
 	    fs->group_desc_count * sizeof(int), "free block count array");
+	found_bits = (unsigned char *) e2fsck_allocate_memory(ctx,
+	    nbytes * 2, "group block bitmaps");
+	disk_bits = found_bits + nbytes;
 
 	if ((fs->super->s_first_data_block <
 	     ext2fs_get_block_bitmap_start(ctx->block_found_map)) ||
@@ -162,40 +238,32 @@ redo_counts:
 	for (i = fs->super->s_first_data_block;
 	     i < fs->super->s_blocks_count;
 	     i++) {
+		if (blocks == 0) {
+			num = fs->super->s_blocks_per_group;
+			if (num > fs->super->s_blocks_count - i)
+				num = fs->super->s_blocks_count - i;
+			if (skip_group)
+				uninit_group_bits(fs, group, i, num,
+						  disk_bits);
+			else if (ext2fs_get_block_bitmap_range(fs->block_map,
+							i, num, disk_bits))
+				num = 0;
+			if (num && !ext2fs_get_block_bitmap_range(
+				    ctx->block_found_map, i, num, found_bits) &&
+			    group_bits_equal(found_bits, disk_bits, num)) {
+				group_free = num -
+					group_bits_count(disk_bits, 0, num);
+				free_blocks += group_free;
+				blocks = num - 1;
+				i += num - 1;
+				goto next_block;
+			}
+		}
+
 		actual = ext2fs_fast_test_block_bitmap(ctx->block_found_map, i);
 
 		if (skip_group) {
-			blk_t	super_blk, old_desc_blk, new_desc_blk;
-			int	old_desc_blocks;
-
-			ext2fs_super_and_bgd_loc(fs, group, &super_blk,
-					 &old_desc_blk, &new_desc_blk, 0);
-
-			if (fs->super->s_feature_incompat &
-			    EXT2_FEATURE_INCOMPAT_META_BG)
-				old_desc_blocks = fs->super->s_first_meta_bg;
-			else
-				old_desc_blocks = fs->desc_blocks +
-					fs->super->s_reserved_gdt_blocks;
-
-			bitmap = 0;
-			if (i == super_blk)
-				bitmap = 1;
-			if (old_desc_blk && old_desc_blocks &&
-			    (i >= old_desc_blk) &&
-			    (i < old_desc_blk + old_desc_blocks))
-				bitmap = 1;
-			if (new_desc_blk &&
-			    (i == new_desc_blk))
-				bitmap = 1;
-			if (i == fs->group_desc[group].bg_block_bitmap)
-				bitmap = 1;
-			else if (i == fs->group_desc[group].bg_inode_bitmap)
-				bitmap = 1;
-			else if (i >= fs->group_desc[group].bg_inode_table &&
-				 (i < fs->group_desc[group].bg_inode_table
-				  + fs->inode_blocks_per_group))
-				bitmap = 1;
+			bitmap = ext2fs_test_bit(blocks, disk_bits);
 			actual = (actual != 0);
 		} else
 			bitmap = ext2fs_fast_test_block_bitmap(fs->block_map, i);
@@ -246,6 +314,7 @@ redo_counts:
 			group_free++;
 			free_blocks++;
 		}
+	next_block:
 		blocks ++;
 		if ((blocks == fs->super->s_blocks_per_group) ||
 		    (i == fs->super->s_blocks_count-1)) {
@@ -320,6 +389,7 @@ redo_counts:
 			ext2fs_unmark_valid(fs);
 	}
 errout:
+	ext2fs_free_mem(&found_bits);
 	ext2fs_free_mem(&free_array);
 }
 
@@ -340,6 +410,8 @@ static void check_inode_bitmaps(e2fsck_t ctx)
 	int		problem, save_problem, fixit, had_problem;
 	int		csum_flag;
 	int		skip_group = 0;
+	unsigned int	nbytes = (fs->super->s_inodes_per_group + 7) >> 3;
+	unsigned char	*found_bits, *disk_bits, *dir_bits;
 
 	clear_problem_context(&pctx);
 	free_array = (int *) e2fsck_allocate_memory(ctx,
@@ -348,6 +420,11 @@ static void check_inode_bitmaps(e2fsck_t ctx)
 	dir_array = (int *) e2fsck_allocate_memory(ctx,
 	   fs->group_desc_count * sizeof(int), "directory count array");
 
+	found_bits = (unsigned char *) e2fsck_allocate_memory(ctx,
+	    nbytes * 3, "group inode bitmaps");
+	disk_bits = found_bits + nbytes;
+	dir_bits = disk_bits + nbytes;
+
 	if ((1 < ext2fs_get_inode_bitmap_start(ctx->inode_used_map)) ||
 	    (fs->super->s_inodes_count >
 	     ext2fs_get_inode_bitmap_end(ctx->inode_used_map))) {
@@ -387,6 +464,32 @@ redo_counts:
 
 	/* Protect loop from wrap-around if inodes_count is maxed */
 	for (i = 1; i <= fs->super->s_inodes_count && i > 0; i++) {
+		if ((inodes == 0) &&
+		    (fs->super->s_inodes_count - i >=
+		     fs->super->s_inodes_per_group - 1)) {
+			unsigned int num = fs->super->s_inodes_per_group;
+
+			if (skip_group)
+				memset(disk_bits, 0, nbytes);
+			if ((skip_group ||
+			     !ext2fs_get_inode_bitmap_range(fs->inode_map,
+							i, num, disk_bits)) &&
+			    !ext2fs_get_inode_bitmap_range(ctx->inode_used_map,
+							i, num, found_bits) &&
+			    !ext2fs_get_inode_bitmap_range(ctx->inode_dir_map,
+							i, num, dir_bits) &&
+			    group_bits_equal(found_bits, disk_bits, num)) {
+				dirs_count = group_bits_count(disk_bits,
+							      dir_bits, num);
+				group_free = num -
+					group_bits_count(disk_bits, 0, num);
+				free_inodes += group_free;
+				inodes = num - 1;
+				i += num - 1;
+				goto next_inode;
+			}
+		}
+
 		actual = ext2fs_fast_test_inode_bitmap(ctx->inode_used_map, i);
 		if (skip_group)
 			bitmap = 0;
@@ -445,6 +548,7 @@ do_counts:
 			group_free++;
 			free_inodes++;
 		}
+next_inode:
 		inodes++;
 		if ((inodes == fs->super->s_inodes_per_group) ||
 		    (i == fs->super->s_inodes_count)) {
@@ -537,6 +641,7 @@ do_counts:
 			ext2fs_unmark_valid(fs);
 	}
 errout:
+	ext2fs_free_mem(&found_bits);
 	ext2fs_free_mem(&free_array);
 	ext2fs_free_mem(&dir_array);
 }
@@ -0,0 +1,101 @@
+/*
+ * readahead.c --- read inode tables ahead of the pass 1 inode scan
+ *
+ * %Begin-Header%
+ * This file may be redistributed under the terms of the GNU Public
+ * License.
+ * %End-Header%
+ */
+
+/*
+ * The inode scan reads each inode table a few blocks at a time, and
+ * checks the inodes between the reads.  On slow devices such as USB
+ * disks most of pass 1 is then spent waiting for the device.  Asking
+ * the I/O manager to read the tables of the next groups into the page
+ * cache lets the device work on them while the current group is
+ * checked, so that the reads of the scan mostly hit the cache.
+ */
+
+#include "e2fsck.h"
+
+#define READAHEAD_KB_DEFAULT	16384
+
+void e2fsck_readahead_init(e2fsck_t ctx)
+{
+	ext2_filsys fs = ctx->fs;
+	unsigned long long itable_kb;
+
+	ctx->readahead_groups = 0;
+	ctx->readahead_next = 0;
+	ctx->readahead_blocks = 0;
+
+	if (ctx->readahead_kb == ~0U)
+		profile_get_uint(ctx->profile, "options", "readahead_kb",
+				 0, READAHEAD_KB_DEFAULT, &ctx->readahead_kb);
+	if (!ctx->readahead_kb || !fs->io->manager->cache_readahead)
+		return;
+
+	itable_kb = ((unsigned long long) fs->inode_blocks_per_group *
+		     fs->blocksize + 1023) / 1024;
+	if (!itable_kb)
+		return;
+	ctx->readahead_groups = ctx->readahead_kb / itable_kb;
+	if (!ctx->readahead_groups)
+		ctx->readahead_groups = 1;
+}
+
+/*
+ * Issue the readahead of the inode tables of the groups after group,
+ * up to the readahead window.  Groups whose inode tables are
+ * contiguous, as with flex_bg, are read in a single request.
+ */
+void e2fsck_readahead_itable(e2fsck_t ctx, dgrp_t group)
+{
+	ext2_filsys fs = ctx->fs;
+	int	csum = EXT2_HAS_RO_COMPAT_FEATURE(fs->super,
+					  EXT4_FEATURE_RO_COMPAT_GDT_CSUM);
+	int	inode_size = EXT2_INODE_SIZE(fs->super);
+	blk64_t	start = 0, count = 0, blk, num;
+	dgrp_t	end, g;
+	__u32	inodes;
+
+	if (!ctx->readahead_groups)
+		return;
+
+	end = group + ctx->readahead_groups;
+	if (end > fs->group_desc_count || end < group)
+		end = fs->group_desc_count;
+	if (ctx->readahead_next < group)
+		ctx->readahead_next = group;
+
+	for (g = ctx->readahead_next; g < end; g++) {
+		blk = fs->group_desc[g].bg_inode_table;
+		num = fs->inode_blocks_per_group;
+		if (csum) {
+			/* The scan skips the same inodes */
+			if (fs->group_desc[g].bg_flags & EXT2_BG_INODE_UNINIT)
+				continue;
+			inodes = EXT2_INODES_PER_GROUP(fs->super) -
+				fs->group_desc[g].bg_itable_unused;
+			num = ((blk64_t) inodes +
+			       (fs->blocksize / inode_size - 1)) *
+				inode_size / fs->blocksize;
+		}
+		if (!blk || !num || blk >= fs->super->s_blocks_count)
+			continue;
+
+		if (count && blk == start + count) {
+			count += num;
+			continue;
+		}
+		if (count)
+			io_channel_cache_readahead(fs->io, start, count);
+		ctx->readahead_blocks += count;
+		start = blk;
+		count = num;
+	}
+	if (count)
+		io_channel_cache_readahead(fs->io, start, count);
+	ctx->readahead_blocks += count;
+	ctx->readahead_next = end;
+}
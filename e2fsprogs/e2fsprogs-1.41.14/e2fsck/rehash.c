@@ -51,6 +51,12 @@
 #include "e2fsck.h"
 #include "problem.h"
 
+#ifdef NO_INLINE_FUNCS
+#define _INLINE_
+#else
+#define _INLINE_ inline
+#endif
+
 struct fill_dir_struct {
 	char *buf;
 	struct ext2_inode *inode;
@@ -220,6 +226,83 @@ static EXT2_QSORT_TYPE hash_cmp(const void *a, const void *b)
 	return ret;
 }
 
+/*
+ * Directories smaller than this are sorted with qsort; the radix sort
+ * only pays for its histograms and scratch copy on large directories.
+ */
+#define RADIX_SORT_MIN	256
+
+static _INLINE_ __u64 hash_key(const struct hash_entry *ent)
+{
+	return ((__u64) ent->hash << 32) | ent->minor_hash;
+}
+
+/*
+ * Sort the hash entries into the same order as qsort with hash_cmp,
+ * using a LSD radix sort on the major and minor hashes.  Byte
+ * positions where every entry has the same value are skipped, and
+ * only the runs of entries with identical hashes are left for
+ * name_cmp.  If the scratch array cannot be allocated, fall back to
+ * qsort.
+ */
+static void sort_by_hash(struct hash_entry *harray, int num)
+{
+	unsigned int		count[8][256];
+	unsigned int		c, sum;
+	struct hash_entry	*tmp, *src, *dst, *swap;
+	__u64			key;
+	int			i, j, pass;
+
+	if (num < RADIX_SORT_MIN)
+		tmp = 0;
+	else
+		tmp = malloc(num * sizeof(struct hash_entry));
+	if (!tmp) {
+		qsort(harray, num, sizeof(struct hash_entry), hash_cmp);
+		return;
+	}
+
+	memset(count, 0, sizeof(count));
+	for (i = 0; i < num; i++) {
+		key = hash_key(harray + i);
+		for (pass = 0; pass < 8; pass++)
+			count[pass][(key >> (pass * 8)) & 0xFF]++;
+	}
+
+	src = harray;
+	dst = tmp;
+	for (pass = 0; pass < 8; pass++) {
+		c = (hash_key(src) >> (pass * 8)) & 0xFF;
+		if (count[pass][c] == (unsigned int) num)
+			continue;
+		for (sum = 0, j = 0; j < 256; j++) {
+			c = count[pass][j];
+			count[pass][j] = sum;
+			sum += c;
+		}
+		for (i = 0; i < num; i++) {
+			c = (hash_key(src + i) >> (pass * 8)) & 0xFF;
+			dst[count[pass][c]++] = src[i];
+		}
+		swap = src;
+		src = dst;
+		dst = swap;
+	}
+	if (src != harray)
+		memcpy(harray, src, num * sizeof(struct hash_entry));
+	free(tmp);
+
+	for (i = 0; i < num; i = j) {
+		for (j = i + 1; j < num; j++)
+			if ((harray[j].hash != harray[i].hash) ||
+			    (harray[j].minor_hash != harray[i].minor_hash))
+				break;
+		if (j - i > 1)
+			qsort(harray + i, j - i, sizeof(struct hash_entry),
+			      name_cmp);
+	}
+}
+
 static errcode_t alloc_size_dir(ext2_filsys fs, struct out_dir *outdir,
 				int blocks)
 {
@@ -626,10 +709,59 @@ struct write_dir_struct {
 	errcode_t	err;
 	e2fsck_t	ctx;
 	int		cleared;
+	blk_t		run_blk;	/* first block of the pending write */
+	e2_blkcnt_t	run_cnt;	/* its logical block number */
+	int		run_len;
 };
 
 /*
- * Helper function which writes out a directory block.
+ * Write out the run of directory blocks which are contiguous both in
+ * the directory and on disk with a single I/O.
+ */
+static errcode_t flush_dir_run(ext2_filsys fs, struct write_dir_struct *wd)
+{
+	errcode_t	retval;
+
+	if (!wd->run_len)
+		return 0;
+	retval = io_channel_write_blk64(fs->io, wd->run_blk, wd->run_len,
+					wd->outdir->buf +
+					(wd->run_cnt * fs->blocksize));
+	wd->run_len = 0;
+	return retval;
+}
+
+#ifdef WORDS_BIGENDIAN
+/*
+ * The out_dir buffer is thrown away after it is written, so the
+ * directory entries can be byte-swapped in place.
+ */
+static errcode_t swab_dir_block(ext2_filsys fs, char *buf)
+{
+	struct ext2_dir_entry	*dirent;
+	char			*p, *end;
+	unsigned int		rec_len;
+	errcode_t		retval;
+
+	p = buf;
+	end = buf + fs->blocksize;
+	while (p < end) {
+		dirent = (struct ext2_dir_entry *) p;
+		if ((retval = ext2fs_get_rec_len(fs, dirent, &rec_len)) != 0)
+			return retval;
+		if ((rec_len < 8) || (rec_len % 4))
+			return EXT2_ET_DIR_CORRUPTED;
+		p += rec_len;
+		dirent->inode = ext2fs_swab32(dirent->inode);
+		dirent->rec_len = ext2fs_swab16(dirent->rec_len);
+		dirent->name_len = ext2fs_swab16(dirent->name_len);
+	}
+	return 0;
+}
+#endif
+
+/*
+ * Helper function which queues a directory block to be written out.
  */
 static int write_dir_block(ext2_filsys fs,
 			   blk_t	*block_nr,
@@ -657,9 +789,23 @@ static int write_dir_block(ext2_filsys fs,
 		return 0;
 
 	dir = wd->outdir->buf + (blockcnt * fs->blocksize);
-	wd->err = ext2fs_write_dir_block(fs, *block_nr, dir);
+#ifdef WORDS_BIGENDIAN
+	wd->err = swab_dir_block(fs, dir);
 	if (wd->err)
 		return BLOCK_ABORT;
+#endif
+	if (wd->run_len &&
+	    ((*block_nr != wd->run_blk + wd->run_len) ||
+	     (blockcnt != wd->run_cnt + wd->run_len))) {
+		wd->err = flush_dir_run(fs, wd);
+		if (wd->err)
+			return BLOCK_ABORT;
+	}
+	if (!wd->run_len) {
+		wd->run_blk = *block_nr;
+		wd->run_cnt = blockcnt;
+	}
+	wd->run_len++;
 	return 0;
 }
 
@@ -679,6 +825,7 @@ static errcode_t write_directory(e2fsck_t ctx, ext2_filsys fs,
 	wd.err = 0;
 	wd.ctx = ctx;
 	wd.cleared = 0;
+	wd.run_len = 0;
 
 	retval = ext2fs_block_iterate2(fs, ino, 0, 0,
 				       write_dir_block, &wd);
@@ -686,6 +833,9 @@ static errcode_t write_directory(e2fsck_t ctx, ext2_filsys fs,
 		return retval;
 	if (wd.err)
 		return wd.err;
+	retval = flush_dir_run(fs, &wd);
+	if (retval)
+		return retval;
 
 	e2fsck_read_inode(ctx, ino, &inode, "rehash_dir");
 	if (compress)
@@ -764,11 +914,9 @@ retry_nohash:
 	/* Sort the list */
 resort:
 	if (fd.compress)
-		qsort(fd.harray+2, fd.num_array-2, sizeof(struct hash_entry),
-		      hash_cmp);
+		sort_by_hash(fd.harray+2, fd.num_array-2);
 	else
-		qsort(fd.harray, fd.num_array, sizeof(struct hash_entry),
-		      hash_cmp);
+		sort_by_hash(fd.harray, fd.num_array);
 
 	/*
 	 * Look for duplicates
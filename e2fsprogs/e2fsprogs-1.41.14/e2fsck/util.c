@@ -210,6 +210,51 @@ int ask (e2fsck_t ctx, const char * string, int def)
 	return ask_yn(string, def);
 }
 
+/*
+ * The block and inode bitmaps e2fsck can have in memory at once: the
+ * filesystem's own, the ones pass 1 builds and the copies pass 5
+ * makes.
+ */
+#define E2FSCK_BLOCK_BITMAPS	4
+#define E2FSCK_INODE_BITMAPS	7
+
+/*
+ * Choose how the filesystem's bitmaps are kept in memory.  Flat bit
+ * arrays are the fastest, but on a large disk they take a byte for
+ * every 8 blocks, several times over; so unless e2fsck.conf says
+ * otherwise, the two-level bitmaps are used when the flat ones would
+ * need more than half of the free memory.
+ */
+void e2fsck_set_bitmap_type(e2fsck_t ctx)
+{
+	ext2_filsys	fs = ctx->fs;
+	char		*type = 0;
+	unsigned long long need, avail = 0;
+
+	profile_get_string(ctx->profile, "options", "bitmaps", 0, "auto",
+			   &type);
+	if (type && !strcmp(type, "bitarray"))
+		fs->default_bitmap_type = EXT2FS_BMAP_BITARRAY;
+	else if (type && !strcmp(type, "twolevel"))
+		fs->default_bitmap_type = EXT2FS_BMAP_TWOLEVEL;
+	else {
+		need = (E2FSCK_BLOCK_BITMAPS *
+			(unsigned long long) fs->super->s_blocks_count +
+			E2FSCK_INODE_BITMAPS *
+			(unsigned long long) fs->super->s_inodes_count) / 8;
+#if defined(_SC_AVPHYS_PAGES) && defined(_SC_PAGESIZE)
+		if (sysconf(_SC_AVPHYS_PAGES) > 0 && sysconf(_SC_PAGESIZE) > 0)
+			avail = (unsigned long long) sysconf(_SC_AVPHYS_PAGES) *
+				sysconf(_SC_PAGESIZE);
+#endif
+		if (avail && need > avail / 2)
+			fs->default_bitmap_type = EXT2FS_BMAP_TWOLEVEL;
+		else
+			fs->default_bitmap_type = EXT2FS_BMAP_BITARRAY;
+	}
+	free(type);
+}
+
 void e2fsck_read_bitmaps(e2fsck_t ctx)
 {
 	ext2_filsys fs = ctx->fs;
@@ -376,6 +421,12 @@ void print_resource_track(e2fsck_t ctx, const char *desc,
 		       mbytes(bytes_read), mbytes(bytes_written),
 		       (double)mbytes(bytes_read + bytes_written) /
 		       timeval_subtract(&time_end, &track->time_start));
+		if (!desc && delta && (delta->num_fields >= 7))
+			printf(_("I/O cache: %llu hits, %llu misses, "
+				 "%llu reads, %llu writes (%llu merged)\n"),
+			       delta->cache_hits, delta->cache_misses,
+			       delta->read_ops, delta->write_ops,
+			       delta->merged_ops);
 	}
 }
 #endif /* RESOURCE_TRACK */
@@ -61,6 +61,11 @@ struct struct_io_stats {
 	int			reserved;
 	unsigned long long	bytes_read;
 	unsigned long long	bytes_written;
+	unsigned long long	cache_hits;	/* blocks read from the cache */
+	unsigned long long	cache_misses;	/* blocks read into the cache */
+	unsigned long long	read_ops;	/* read requests to the device */
+	unsigned long long	write_ops;	/* write requests to the device */
+	unsigned long long	merged_ops;	/* writes of several cached blocks */
 };
 
 struct struct_io_manager {
@@ -83,7 +88,10 @@ struct struct_io_manager {
 					int count, void *data);
 	errcode_t (*write_blk64)(io_channel channel, unsigned long long block,
 					int count, const void *data);
-	long	reserved[16];
+	errcode_t (*cache_readahead)(io_channel channel,
+				     unsigned long long block,
+				     unsigned long long count);
+	long	reserved[15];
 };
 
 #define IO_FLAG_RW		0x0001
@@ -112,6 +120,9 @@ extern errcode_t io_channel_read_blk64(io_channel channel,
 extern errcode_t io_channel_write_blk64(io_channel channel,
 					unsigned long long block,
 					int count, const void *data);
+extern errcode_t io_channel_cache_readahead(io_channel io,
+					    unsigned long long block,
+					    unsigned long long count);
 
 /* unix_io.c */
 extern io_manager unix_io_manager;
@@ -103,6 +103,18 @@ typedef struct ext2fs_struct_generic_bitmap *ext2fs_generic_bitmap;
 typedef struct ext2fs_struct_generic_bitmap *ext2fs_inode_bitmap;
 typedef struct ext2fs_struct_generic_bitmap *ext2fs_block_bitmap;
 
+/*
+ * How the bits of a bitmap are kept in memory.  A bitmap allocated
+ * for a filesystem gets the filesystem's default_bitmap_type, and a
+ * copy gets the type of the original.
+ *
+ * EXT2FS_BMAP_BITARRAY keeps one flat array for the whole range.
+ * EXT2FS_BMAP_TWOLEVEL splits it into 32768-bit chunks, and only
+ * allocates the chunks which are neither all clear nor all set.
+ */
+#define EXT2FS_BMAP_BITARRAY	0
+#define EXT2FS_BMAP_TWOLEVEL	1
+
 #define EXT2_FIRST_INODE(s)	EXT2_FIRST_INO(s)
 
 
@@ -185,8 +197,10 @@ typedef struct ext2_file *ext2_file_t;
  * Flags for mkjournal
  *
  * EXT2_MKJOURNAL_V1_SUPER	Make a (deprecated) V1 journal superblock
+ * EXT2_MKJOURNAL_LAZYINIT	Don't zero the journal blocks
  */
 #define EXT2_MKJOURNAL_V1_SUPER	0x0000001
+#define EXT2_MKJOURNAL_LAZYINIT	0x0000002
 
 struct struct_ext2_filsys {
 	errcode_t			magic;
@@ -216,10 +230,11 @@ struct struct_ext2_filsys {
 	struct ext2_image_hdr *		image_header;
 	__u32				umask;
 	time_t				now;
+	int				default_bitmap_type;
 	/*
 	 * Reserved for future expansion
 	 */
-	__u32				reserved[7];
+	__u32				reserved[6];
 
 	/*
 	 * Reserved for the use of the calling application.
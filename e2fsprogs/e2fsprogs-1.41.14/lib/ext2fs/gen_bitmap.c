@@ -35,9 +35,27 @@ struct ext2fs_struct_generic_bitmap {
 	char	*	description;
 	char	*	bitmap;
 	errcode_t	base_error_code;
-	__u32		reserved[7];
+	int		type;
+	char	**	chunks;
+	__u16	*	chunk_bits;
+	__u32		reserved[2];
 };
 
+/*
+ * An EXT2FS_BMAP_TWOLEVEL bitmap has no flat bitmap.  Instead,
+ * chunks[] points to the memory of each chunk of CHUNK_BITS bits, and
+ * chunk_bits[] counts the bits set in each chunk.  A chunk with no
+ * bits set or with all of them set has no memory; a NULL chunk is
+ * clear if its count is 0 and set if its count is CHUNK_BITS.
+ *
+ * Most of a large filesystem is in long runs of used or of free
+ * blocks, so most chunks of its block bitmaps take no memory.
+ */
+#define CHUNK_BYTES	4096
+#define CHUNK_BITS	(CHUNK_BYTES * 8)
+
+#define IS_TWOLEVEL(bmap)	((bmap)->type == EXT2FS_BMAP_TWOLEVEL)
+
 /*
  * Used by previously inlined function, so we have to export this and
  * not change the function signature
@@ -63,10 +81,259 @@ static errcode_t check_magic(ext2fs_generic_bitmap bitmap)
 	return 0;
 }
 
-errcode_t ext2fs_make_generic_bitmap(errcode_t magic, ext2_filsys fs,
-				     __u32 start, __u32 end, __u32 real_end,
-				     const char *descr, char *init_map,
-				     ext2fs_generic_bitmap *ret)
+static unsigned int count_bits(const unsigned char *mem, size_t len)
+{
+	static const unsigned char nibble_bits[16] = {
+		0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+	unsigned int	count = 0;
+
+	while (len--) {
+		count += nibble_bits[*mem & 15] + nibble_bits[*mem >> 4];
+		mem++;
+	}
+	return count;
+}
+
+/*
+ * Set or clear len bits from bit start of addr, a byte at a time
+ * where the range allows it.
+ */
+static void set_bits(char *addr, unsigned int start, unsigned int len)
+{
+	for (; len && (start & 7); start++, len--)
+		ext2fs_fast_set_bit(start, addr);
+	memset(addr + (start >> 3), 0xff, len >> 3);
+	start += len & ~7;
+	for (len &= 7; len; start++, len--)
+		ext2fs_fast_set_bit(start, addr);
+}
+
+static void clear_bits(char *addr, unsigned int start, unsigned int len)
+{
+	for (; len && (start & 7); start++, len--)
+		ext2fs_fast_clear_bit(start, addr);
+	memset(addr + (start >> 3), 0, len >> 3);
+	start += len & ~7;
+	for (len &= 7; len; start++, len--)
+		ext2fs_fast_clear_bit(start, addr);
+}
+
+/*
+ * Two-level bitmap routines.  Bit numbers are relative to the start
+ * of the bitmap.
+ */
+
+static __u32 twolevel_chunk_count(ext2fs_generic_bitmap bmap, __u32 real_end)
+{
+	return ((real_end - bmap->start) / CHUNK_BITS) + 1;
+}
+
+static errcode_t twolevel_alloc(ext2fs_generic_bitmap bmap)
+{
+	__u32		n = twolevel_chunk_count(bmap, bmap->real_end);
+	errcode_t	retval;
+
+	retval = ext2fs_get_array(n, sizeof(char *), &bmap->chunks);
+	if (retval)
+		return retval;
+	retval = ext2fs_get_array(n, sizeof(__u16), &bmap->chunk_bits);
+	if (retval) {
+		ext2fs_free_mem(&bmap->chunks);
+		return retval;
+	}
+	memset(bmap->chunks, 0, n * sizeof(char *));
+	memset(bmap->chunk_bits, 0, n * sizeof(__u16));
+	return 0;
+}
+
+static void twolevel_free_chunks(ext2fs_generic_bitmap bmap, __u32 first,
+				 __u32 n)
+{
+	__u32	i;
+
+	for (i = first; i < n; i++) {
+		if (bmap->chunks[i])
+			ext2fs_free_mem(&bmap->chunks[i]);
+		bmap->chunks[i] = 0;
+		bmap->chunk_bits[i] = 0;
+	}
+}
+
+/*
+ * Return the memory of a chunk, allocating it if the chunk has none.
+ */
+static char *twolevel_get_chunk(ext2fs_generic_bitmap bmap, __u32 chunk)
+{
+	char	*mem;
+
+	if (bmap->chunks[chunk])
+		return bmap->chunks[chunk];
+	if (ext2fs_get_mem(CHUNK_BYTES, &mem)) {
+#ifndef OMIT_COM_ERR
+		com_err(0, EXT2_ET_NO_MEMORY, "for a chunk of %s",
+			bmap->description ? bmap->description : "a bitmap");
+#endif
+		return 0;
+	}
+	memset(mem, bmap->chunk_bits[chunk] ? 0xff : 0, CHUNK_BYTES);
+	bmap->chunks[chunk] = mem;
+	return mem;
+}
+
+/*
+ * Free the memory of a chunk which has become all clear or all set.
+ */
+static void twolevel_put_chunk(ext2fs_generic_bitmap bmap, __u32 chunk)
+{
+	if (bmap->chunks[chunk] &&
+	    (bmap->chunk_bits[chunk] == 0 ||
+	     bmap->chunk_bits[chunk] == CHUNK_BITS))
+		ext2fs_free_mem(&bmap->chunks[chunk]);
+}
+
+static int twolevel_test(ext2fs_generic_bitmap bmap, __u32 bit)
+{
+	__u32	chunk = bit / CHUNK_BITS;
+
+	if (!bmap->chunks[chunk])
+		return bmap->chunk_bits[chunk] != 0;
+	return ext2fs_test_bit(bit % CHUNK_BITS, bmap->chunks[chunk]);
+}
+
+static int twolevel_mark(ext2fs_generic_bitmap bmap, __u32 bit)
+{
+	__u32	chunk = bit / CHUNK_BITS;
+	char	*mem;
+
+	if (!bmap->chunks[chunk] && bmap->chunk_bits[chunk] == CHUNK_BITS)
+		return 1;
+	mem = twolevel_get_chunk(bmap, chunk);
+	if (!mem)
+		return 0;
+	if (ext2fs_set_bit(bit % CHUNK_BITS, mem))
+		return 1;
+	bmap->chunk_bits[chunk]++;
+	twolevel_put_chunk(bmap, chunk);
+	return 0;
+}
+
+static int twolevel_unmark(ext2fs_generic_bitmap bmap, __u32 bit)
+{
+	__u32	chunk = bit / CHUNK_BITS;
+	char	*mem;
+
+	if (!bmap->chunks[chunk] && bmap->chunk_bits[chunk] == 0)
+		return 0;
+	mem = twolevel_get_chunk(bmap, chunk);
+	if (!mem)
+		return 0;
+	if (!ext2fs_clear_bit(bit % CHUNK_BITS, mem))
+		return 0;
+	bmap->chunk_bits[chunk]--;
+	twolevel_put_chunk(bmap, chunk);
+	return 1;
+}
+
+static void twolevel_mark_range(ext2fs_generic_bitmap bmap, __u32 bit,
+				__u32 num, int set)
+{
+	__u32		chunk, first, len;
+	char		*mem;
+
+	while (num) {
+		chunk = bit / CHUNK_BITS;
+		first = bit % CHUNK_BITS;
+		len = CHUNK_BITS - first;
+		if (len > num)
+			len = num;
+
+		if (len == CHUNK_BITS) {
+			if (bmap->chunks[chunk])
+				ext2fs_free_mem(&bmap->chunks[chunk]);
+			bmap->chunk_bits[chunk] = set ? CHUNK_BITS : 0;
+		} else if (bmap->chunks[chunk] ||
+			   bmap->chunk_bits[chunk] != (set ? CHUNK_BITS : 0)) {
+			mem = twolevel_get_chunk(bmap, chunk);
+			if (!mem)
+				return;
+			if (set)
+				set_bits(mem, first, len);
+			else
+				clear_bits(mem, first, len);
+			bmap->chunk_bits[chunk] =
+				count_bits((unsigned char *) mem, CHUNK_BYTES);
+			twolevel_put_chunk(bmap, chunk);
+		}
+		bit += len;
+		num -= len;
+	}
+}
+
+/*
+ * Copy len bytes of the bitmap from byte offset to out, or from in to
+ * the bitmap.
+ */
+static void twolevel_get_bytes(ext2fs_generic_bitmap bmap, size_t offset,
+			       size_t len, char *out)
+{
+	size_t		chunk, first, n;
+
+	while (len) {
+		chunk = offset / CHUNK_BYTES;
+		first = offset % CHUNK_BYTES;
+		n = CHUNK_BYTES - first;
+		if (n > len)
+			n = len;
+		if (bmap->chunks[chunk])
+			memcpy(out, bmap->chunks[chunk] + first, n);
+		else
+			memset(out, bmap->chunk_bits[chunk] ? 0xff : 0, n);
+		offset += n;
+		out += n;
+		len -= n;
+	}
+}
+
+static errcode_t twolevel_set_bytes(ext2fs_generic_bitmap bmap,
+				    size_t offset, size_t len, const char *in)
+{
+	size_t		chunk, first, n;
+	unsigned int	bits;
+	char		*mem;
+
+	while (len) {
+		chunk = offset / CHUNK_BYTES;
+		first = offset % CHUNK_BYTES;
+		n = CHUNK_BYTES - first;
+		if (n > len)
+			n = len;
+
+		bits = count_bits((const unsigned char *) in, n);
+		if (n == CHUNK_BYTES && (bits == 0 || bits == CHUNK_BITS)) {
+			if (bmap->chunks[chunk])
+				ext2fs_free_mem(&bmap->chunks[chunk]);
+			bmap->chunk_bits[chunk] = bits;
+		} else {
+			mem = twolevel_get_chunk(bmap, chunk);
+			if (!mem)
+				return EXT2_ET_NO_MEMORY;
+			memcpy(mem + first, in, n);
+			if (n != CHUNK_BYTES)
+				bits = count_bits((unsigned char *) mem,
+						  CHUNK_BYTES);
+			bmap->chunk_bits[chunk] = bits;
+			twolevel_put_chunk(bmap, chunk);
+		}
+		offset += n;
+		in += n;
+		len -= n;
+	}
+	return 0;
+}
+
+static errcode_t make_bitmap(errcode_t magic, ext2_filsys fs, int type,
+			     __u32 start, __u32 end, __u32 real_end,
+			     const char *descr, ext2fs_generic_bitmap *ret)
 {
 	ext2fs_generic_bitmap	bitmap;
 	errcode_t		retval;
@@ -82,6 +349,10 @@ errcode_t ext2fs_make_generic_bitmap(errcode_t magic, ext2_filsys fs,
 	bitmap->start = start;
 	bitmap->end = end;
 	bitmap->real_end = real_end;
+	bitmap->type = type;
+	bitmap->bitmap = 0;
+	bitmap->chunks = 0;
+	bitmap->chunk_bits = 0;
 	switch (magic) {
 	case EXT2_ET_MAGIC_INODE_BITMAP:
 		bitmap->base_error_code = EXT2_ET_BAD_INODE_MARK;
@@ -102,20 +373,52 @@ errcode_t ext2fs_make_generic_bitmap(errcode_t magic, ext2_filsys fs,
 	} else
 		bitmap->description = 0;
 
-	size = (size_t) (((bitmap->real_end - bitmap->start) / 8) + 1);
-	/* Round up to allow for the BT x86 instruction */
-	size = (size + 7) & ~3;
-	retval = ext2fs_get_mem(size, &bitmap->bitmap);
+	if (IS_TWOLEVEL(bitmap))
+		retval = twolevel_alloc(bitmap);
+	else {
+		size = (size_t) (((bitmap->real_end - bitmap->start) / 8) + 1);
+		/* Round up to allow for the BT x86 instruction */
+		size = (size + 7) & ~3;
+		retval = ext2fs_get_mem(size, &bitmap->bitmap);
+		if (!retval)
+			memset(bitmap->bitmap, 0, size);
+	}
 	if (retval) {
-		ext2fs_free_mem(&bitmap->description);
+		if (bitmap->description)
+			ext2fs_free_mem(&bitmap->description);
 		ext2fs_free_mem(&bitmap);
 		return retval;
 	}
+	*ret = bitmap;
+	return 0;
+}
 
-	if (init_map)
-		memcpy(bitmap->bitmap, init_map, size);
-	else
-		memset(bitmap->bitmap, 0, size);
+errcode_t ext2fs_make_generic_bitmap(errcode_t magic, ext2_filsys fs,
+				     __u32 start, __u32 end, __u32 real_end,
+				     const char *descr, char *init_map,
+				     ext2fs_generic_bitmap *ret)
+{
+	ext2fs_generic_bitmap	bitmap;
+	errcode_t		retval;
+
+	retval = make_bitmap(magic, fs,
+			     fs ? fs->default_bitmap_type : EXT2FS_BMAP_BITARRAY,
+			     start, end, real_end, descr, &bitmap);
+	if (retval)
+		return retval;
+
+	if (init_map) {
+		if (IS_TWOLEVEL(bitmap))
+			retval = twolevel_set_bytes(bitmap, 0,
+				(((real_end - start) / 8) + 1), init_map);
+		else
+			memcpy(bitmap->bitmap, init_map,
+			       ((((real_end - start) / 8) + 1) + 7) & ~3);
+		if (retval) {
+			ext2fs_free_generic_bitmap(bitmap);
+			return retval;
+		}
+	}
 	*ret = bitmap;
 	return 0;
 }
@@ -133,11 +436,37 @@ errcode_t ext2fs_allocate_generic_bitmap(__u32 start,
 errcode_t ext2fs_copy_generic_bitmap(ext2fs_generic_bitmap src,
 				     ext2fs_generic_bitmap *dest)
 {
-	return (ext2fs_make_generic_bitmap(src->magic, src->fs,
-					   src->start, src->end,
-					   src->real_end,
-					   src->description, src->bitmap,
-					   dest));
+	ext2fs_generic_bitmap	bitmap;
+	errcode_t		retval;
+	__u32			i, n;
+
+	retval = make_bitmap(src->magic, src->fs, src->type, src->start,
+			     src->end, src->real_end, src->description,
+			     &bitmap);
+	if (retval)
+		return retval;
+
+	if (!IS_TWOLEVEL(src)) {
+		memcpy(bitmap->bitmap, src->bitmap,
+		       ((((src->real_end - src->start) / 8) + 1) + 7) & ~3);
+		*dest = bitmap;
+		return 0;
+	}
+
+	n = twolevel_chunk_count(src, src->real_end);
+	for (i = 0; i < n; i++) {
+		bitmap->chunk_bits[i] = src->chunk_bits[i];
+		if (!src->chunks[i])
+			continue;
+		retval = ext2fs_get_mem(CHUNK_BYTES, &bitmap->chunks[i]);
+		if (retval) {
+			ext2fs_free_generic_bitmap(bitmap);
+			return retval;
+		}
+		memcpy(bitmap->chunks[i], src->chunks[i], CHUNK_BYTES);
+	}
+	*dest = bitmap;
+	return 0;
 }
 
 void ext2fs_free_generic_bitmap(ext2fs_inode_bitmap bitmap)
@@ -154,6 +483,12 @@ void ext2fs_free_generic_bitmap(ext2fs_inode_bitmap bitmap)
 		ext2fs_free_mem(&bitmap->bitmap);
 		bitmap->bitmap = 0;
 	}
+	if (bitmap->chunks) {
+		twolevel_free_chunks(bitmap, 0,
+			twolevel_chunk_count(bitmap, bitmap->real_end));
+		ext2fs_free_mem(&bitmap->chunks);
+		ext2fs_free_mem(&bitmap->chunk_bits);
+	}
 	ext2fs_free_mem(&bitmap);
 }
 
@@ -164,6 +499,8 @@ int ext2fs_test_generic_bitmap(ext2fs_generic_bitmap bitmap,
 		ext2fs_warn_bitmap2(bitmap, EXT2FS_TEST_ERROR, bitno);
 		return 0;
 	}
+	if (IS_TWOLEVEL(bitmap))
+		return twolevel_test(bitmap, bitno - bitmap->start);
 	return ext2fs_test_bit(bitno - bitmap->start, bitmap->bitmap);
 }
 
@@ -174,6 +511,8 @@ int ext2fs_mark_generic_bitmap(ext2fs_generic_bitmap bitmap,
 		ext2fs_warn_bitmap2(bitmap, EXT2FS_MARK_ERROR, bitno);
 		return 0;
 	}
+	if (IS_TWOLEVEL(bitmap))
+		return twolevel_mark(bitmap, bitno - bitmap->start);
 	return ext2fs_set_bit(bitno - bitmap->start, bitmap->bitmap);
 }
 
@@ -184,6 +523,8 @@ int ext2fs_unmark_generic_bitmap(ext2fs_generic_bitmap bitmap,
 		ext2fs_warn_bitmap2(bitmap, EXT2FS_UNMARK_ERROR, bitno);
 		return 0;
 	}
+	if (IS_TWOLEVEL(bitmap))
+		return twolevel_unmark(bitmap, bitno - bitmap->start);
 	return ext2fs_clear_bit(bitno - bitmap->start, bitmap->bitmap);
 }
 
@@ -202,6 +543,11 @@ void ext2fs_clear_generic_bitmap(ext2fs_generic_bitmap bitmap)
 	if (check_magic(bitmap))
 		return;
 
+	if (IS_TWOLEVEL(bitmap)) {
+		twolevel_free_chunks(bitmap, 0,
+			twolevel_chunk_count(bitmap, bitmap->real_end));
+		return;
+	}
 	memset(bitmap->bitmap, 0,
 	       (size_t) (((bitmap->real_end - bitmap->start) / 8) + 1));
 }
@@ -239,14 +585,50 @@ errcode_t ext2fs_resize_generic_bitmap(errcode_t magic,
 		bitno = bmap->real_end;
 		if (bitno > new_end)
 			bitno = new_end;
-		for (; bitno > bmap->end; bitno--)
-			ext2fs_clear_bit(bitno - bmap->start, bmap->bitmap);
+		if (IS_TWOLEVEL(bmap)) {
+			if (bitno > bmap->end)
+				twolevel_mark_range(bmap,
+						    bmap->end + 1 - bmap->start,
+						    bitno - bmap->end, 0);
+		} else
+			for (; bitno > bmap->end; bitno--)
+				ext2fs_clear_bit(bitno - bmap->start,
+						 bmap->bitmap);
 	}
 	if (new_real_end == bmap->real_end) {
 		bmap->end = new_end;
 		return 0;
 	}
 
+	if (IS_TWOLEVEL(bmap)) {
+		__u32	n = twolevel_chunk_count(bmap, bmap->real_end);
+		__u32	new_n = twolevel_chunk_count(bmap, new_real_end);
+
+		if (new_n < n)
+			twolevel_free_chunks(bmap, new_n, n);
+		if (new_n != n) {
+			retval = ext2fs_resize_mem(n * sizeof(char *),
+						   new_n * sizeof(char *),
+						   &bmap->chunks);
+			if (retval)
+				return retval;
+			retval = ext2fs_resize_mem(n * sizeof(__u16),
+						   new_n * sizeof(__u16),
+						   &bmap->chunk_bits);
+			if (retval)
+				return retval;
+		}
+		if (new_n > n) {
+			memset(bmap->chunks + n, 0,
+			       (new_n - n) * sizeof(char *));
+			memset(bmap->chunk_bits + n, 0,
+			       (new_n - n) * sizeof(__u16));
+		}
+		bmap->end = new_end;
+		bmap->real_end = new_real_end;
+		return 0;
+	}
+
 	size = ((bmap->real_end - bmap->start) / 8) + 1;
 	new_size = ((new_real_end - bmap->start) / 8) + 1;
 
@@ -275,9 +657,39 @@ errcode_t ext2fs_compare_generic_bitmap(errcode_t magic, errcode_t neq,
 		return magic;
 
 	if ((bm1->start != bm2->start) ||
-	    (bm1->end != bm2->end) ||
-	    (memcmp(bm1->bitmap, bm2->bitmap,
-		    (size_t) (bm1->end - bm1->start)/8)))
+	    (bm1->end != bm2->end))
+		return neq;
+
+	if (IS_TWOLEVEL(bm1) || IS_TWOLEVEL(bm2)) {
+		char		*buf1, *buf2;
+		size_t		offset, n, len;
+		errcode_t	retval;
+		int		differ = 0;
+
+		retval = ext2fs_get_mem(2 * CHUNK_BYTES, &buf1);
+		if (retval)
+			return retval;
+		buf2 = buf1 + CHUNK_BYTES;
+		len = (size_t) (bm1->end - bm1->start)/8;
+		for (offset = 0; offset < len && !differ; offset += n) {
+			n = len - offset;
+			if (n > CHUNK_BYTES)
+				n = CHUNK_BYTES;
+			if (IS_TWOLEVEL(bm1))
+				twolevel_get_bytes(bm1, offset, n, buf1);
+			else
+				memcpy(buf1, bm1->bitmap + offset, n);
+			if (IS_TWOLEVEL(bm2))
+				twolevel_get_bytes(bm2, offset, n, buf2);
+			else
+				memcpy(buf2, bm2->bitmap + offset, n);
+			differ = memcmp(buf1, buf2, n);
+		}
+		ext2fs_free_mem(&buf1);
+		if (differ)
+			return neq;
+	} else if (memcmp(bm1->bitmap, bm2->bitmap,
+			  (size_t) (bm1->end - bm1->start)/8))
 		return neq;
 
 	for (i = bm1->end - ((bm1->end - bm1->start) % 8); i <= bm1->end; i++)
@@ -292,6 +704,13 @@ void ext2fs_set_generic_bitmap_padding(ext2fs_generic_bitmap map)
 {
 	__u32	i, j;
 
+	if (IS_TWOLEVEL(map)) {
+		if (map->real_end > map->end)
+			twolevel_mark_range(map, map->end + 1 - map->start,
+					    map->real_end - map->end, 1);
+		return;
+	}
+
 	/* Protect loop from wrap-around if map->real_end is maxed */
 	for (i=map->end+1, j = i - map->start;
 	     i <= map->real_end && i > map->end;
@@ -310,7 +729,10 @@ errcode_t ext2fs_get_generic_bitmap_range(ext2fs_generic_bitmap bmap,
 	if ((start < bmap->start) || (start+num-1 > bmap->real_end))
 		return EXT2_ET_INVALID_ARGUMENT;
 
-	memcpy(out, bmap->bitmap + (start >> 3), (num+7) >> 3);
+	if (IS_TWOLEVEL(bmap))
+		twolevel_get_bytes(bmap, start >> 3, (num+7) >> 3, out);
+	else
+		memcpy(out, bmap->bitmap + (start >> 3), (num+7) >> 3);
 	return 0;
 }
 
@@ -325,6 +747,8 @@ errcode_t ext2fs_set_generic_bitmap_range(ext2fs_generic_bitmap bmap,
 	if ((start < bmap->start) || (start+num-1 > bmap->real_end))
 		return EXT2_ET_INVALID_ARGUMENT;
 
+	if (IS_TWOLEVEL(bmap))
+		return twolevel_set_bytes(bmap, start >> 3, (num+7) >> 3, in);
 	memcpy(bmap->bitmap + (start >> 3), in, (num+7) >> 3);
 	return 0;
 }
@@ -350,11 +774,10 @@ static int mem_is_zero(const char *mem, size_t len)
 }
 
 /*
- * Return true if all of the bits in a specified range are clear
+ * Return true if all of the bits in a specified range of ADDR are clear
  */
-static int ext2fs_test_clear_generic_bitmap_range(ext2fs_generic_bitmap bitmap,
-						  unsigned int start,
-						  unsigned int len)
+static int test_clear_bits(const char *ADDR, unsigned int start,
+			   unsigned int len)
 {
 	size_t start_byte, len_byte = len >> 3;
 	unsigned int start_bit, len_bit = len % 8;
@@ -363,9 +786,7 @@ static int ext2fs_test_clear_generic_bitmap_range(ext2fs_generic_bitmap bitmap,
 	int mark_count = 0;
 	int mark_bit = 0;
 	int i;
-	const char *ADDR = bitmap->bitmap;
 
-	start -= bitmap->start;
 	start_byte = start >> 3;
 	start_bit = start % 8;
 
@@ -424,6 +845,36 @@ static int ext2fs_test_clear_generic_bitmap_range(ext2fs_generic_bitmap bitmap,
 	return mem_is_zero(ADDR + start_byte, len_byte);
 }
 
+/*
+ * Return true if all of the bits in a specified range are clear
+ */
+static int ext2fs_test_clear_generic_bitmap_range(ext2fs_generic_bitmap bitmap,
+						  unsigned int start,
+						  unsigned int len)
+{
+	__u32	chunk, first, n;
+
+	start -= bitmap->start;
+	if (!IS_TWOLEVEL(bitmap))
+		return test_clear_bits(bitmap->bitmap, start, len);
+
+	while (len) {
+		chunk = start / CHUNK_BITS;
+		first = start % CHUNK_BITS;
+		n = CHUNK_BITS - first;
+		if (n > len)
+			n = len;
+		if (bitmap->chunks[chunk]) {
+			if (!test_clear_bits(bitmap->chunks[chunk], first, n))
+				return 0;
+		} else if (bitmap->chunk_bits[chunk])
+			return 0;
+		start += n;
+		len -= n;
+	}
+	return 1;
+}
+
 int ext2fs_test_block_bitmap_range(ext2fs_block_bitmap bitmap,
 				   blk_t block, int num)
 {
@@ -453,28 +904,27 @@ int ext2fs_test_inode_bitmap_range(ext2fs_inode_bitmap bitmap,
 void ext2fs_mark_block_bitmap_range(ext2fs_block_bitmap bitmap,
 				    blk_t block, int num)
 {
-	int	i;
-
 	if ((block < bitmap->start) || (block+num-1 > bitmap->end)) {
 		ext2fs_warn_bitmap(EXT2_ET_BAD_BLOCK_MARK, block,
 				   bitmap->description);
 		return;
 	}
-	for (i=0; i < num; i++)
-		ext2fs_fast_set_bit(block + i - bitmap->start, bitmap->bitmap);
+	if (IS_TWOLEVEL(bitmap))
+		twolevel_mark_range(bitmap, block - bitmap->start, num, 1);
+	else
+		set_bits(bitmap->bitmap, block - bitmap->start, num);
 }
 
 void ext2fs_unmark_block_bitmap_range(ext2fs_block_bitmap bitmap,
 					       blk_t block, int num)
 {
-	int	i;
-
 	if ((block < bitmap->start) || (block+num-1 > bitmap->end)) {
 		ext2fs_warn_bitmap(EXT2_ET_BAD_BLOCK_UNMARK, block,
 				   bitmap->description);
 		return;
 	}
-	for (i=0; i < num; i++)
-		ext2fs_fast_clear_bit(block + i - bitmap->start,
-				      bitmap->bitmap);
+	if (IS_TWOLEVEL(bitmap))
+		twolevel_mark_range(bitmap, block - bitmap->start, num, 0);
+	else
+		clear_bits(bitmap->bitmap, block - bitmap->start, num);
 }
@@ -145,11 +145,13 @@ errout:
  * programs that check for memory leaks happy.)
  */
 #define STRIDE_LENGTH 8
+#define MAX_STRIDE_BYTES 4194304	/* stride used for long runs */
 errcode_t ext2fs_zero_blocks(ext2_filsys fs, blk_t blk, int num,
 			     blk_t *ret_blk, int *ret_count)
 {
-	int		j, count;
+	int		j, count, stride;
 	static char	*buf;
+	static int	buf_size;
 	errcode_t	retval;
 
 	/* If fs is null, clean up the static buffer and return */
@@ -157,27 +159,44 @@ errcode_t ext2fs_zero_blocks(ext2_filsys fs, blk_t blk, int num,
 		if (buf) {
 			free(buf);
 			buf = 0;
+			buf_size = 0;
 		}
 		return 0;
 	}
+	/*
+	 * Long runs, such as a new journal, are written a few
+	 * megabytes at a time, so that they go out as large
+	 * sequential writes rather than thousands of small ones.
+	 */
+	stride = STRIDE_LENGTH;
+	if ((num > STRIDE_LENGTH) &&
+	    (MAX_STRIDE_BYTES / (int) fs->blocksize > STRIDE_LENGTH))
+		stride = MAX_STRIDE_BYTES / fs->blocksize;
 	/* Allocate the zeroizing buffer if necessary */
-	if (!buf) {
-		buf = malloc(fs->blocksize * STRIDE_LENGTH);
+	if (buf_size < (int) fs->blocksize * stride) {
+		free(buf);
+		buf_size = 0;
+		buf = malloc(fs->blocksize * stride);
+		if (!buf && (stride > STRIDE_LENGTH)) {
+			stride = STRIDE_LENGTH;
+			buf = malloc(fs->blocksize * stride);
+		}
 		if (!buf)
 			return ENOMEM;
-		memset(buf, 0, fs->blocksize * STRIDE_LENGTH);
+		buf_size = fs->blocksize * stride;
+		memset(buf, 0, buf_size);
 	}
 	/* OK, do the write loop */
 	j=0;
 	while (j < num) {
-		if (blk % STRIDE_LENGTH) {
-			count = STRIDE_LENGTH - (blk % STRIDE_LENGTH);
+		if (blk % stride) {
+			count = stride - (blk % stride);
 			if (count > (num - j))
 				count = num - j;
 		} else {
 			count = num - j;
-			if (count > STRIDE_LENGTH)
-				count = STRIDE_LENGTH;
+			if (count > stride)
+				count = stride;
 		}
 		retval = io_channel_write_blk(fs->io, blk, count, buf);
 		if (retval) {
@@ -201,6 +220,7 @@ struct mkjournal_struct {
 	blk_t		goal;
 	blk_t		blk_to_zero;
 	int		zero_count;
+	int		flags;
 	char		*buf;
 	errcode_t	err;
 };
@@ -232,10 +252,9 @@ static int mkjournal_proc(ext2_filsys	fs,
 	retval = 0;
 	if (blockcnt <= 0)
 		retval = io_channel_write_blk(fs->io, new_blk, 1, es->buf);
-	else {
+	else if (!(es->flags & EXT2_MKJOURNAL_LAZYINIT)) {
 		if (es->zero_count) {
-			if ((es->blk_to_zero + es->zero_count == new_blk) &&
-			    (es->zero_count < 1024))
+			if (es->blk_to_zero + es->zero_count == new_blk)
 				es->zero_count++;
 			else {
 				retval = ext2fs_zero_blocks(fs,
@@ -297,6 +316,7 @@ static errcode_t write_journal_inode(ext2_filsys fs, ext2_ino_t journal_ino,
 	es.buf = buf;
 	es.err = 0;
 	es.zero_count = 0;
+	es.flags = flags;
 
 	if (fs->super->s_feature_incompat & EXT3_FEATURE_INCOMPAT_EXTENTS) {
 		inode.i_flags |= EXT4_EXTENTS_FL;
@@ -37,6 +37,149 @@ int bits_list[] = {
 
 #define BIG_TEST_BIT   (((unsigned) 1 << 31) + 42)
 
+#define TWOLEVEL_START		1
+#define TWOLEVEL_END		200000
+#define TWOLEVEL_REAL_END	(TWOLEVEL_END + 123)
+
+static void check_twolevel(ext2fs_block_bitmap flat,
+			   ext2fs_block_bitmap twolevel, const char *what)
+{
+	__u32	i;
+
+	for (i = TWOLEVEL_START; i <= TWOLEVEL_REAL_END; i++) {
+		if (!ext2fs_fast_test_block_bitmap(flat, i) !=
+		    !ext2fs_fast_test_block_bitmap(twolevel, i)) {
+			printf("two-level bitmap differs at bit %u after %s\n",
+			       i, what);
+			exit(1);
+		}
+	}
+}
+
+/*
+ * Make the same changes to a flat and a two-level bitmap, and check
+ * that they always agree.
+ */
+static void test_twolevel(void)
+{
+	struct struct_ext2_filsys fs;
+	ext2fs_block_bitmap flat, twolevel, copy;
+	static char	buf[TWOLEVEL_END / 8];
+	__u32		blk, num;
+	int		i;
+	errcode_t	retval;
+
+	memset(&fs, 0, sizeof(fs));
+	fs.default_bitmap_type = EXT2FS_BMAP_TWOLEVEL;
+	retval = ext2fs_make_generic_bitmap(EXT2_ET_MAGIC_BLOCK_BITMAP, 0,
+					    TWOLEVEL_START, TWOLEVEL_END,
+					    TWOLEVEL_REAL_END, "flat", 0,
+					    &flat);
+	if (!retval)
+		retval = ext2fs_make_generic_bitmap(EXT2_ET_MAGIC_BLOCK_BITMAP,
+						    &fs, TWOLEVEL_START,
+						    TWOLEVEL_END,
+						    TWOLEVEL_REAL_END,
+						    "two-level", 0, &twolevel);
+	if (retval) {
+		com_err("test_twolevel", retval, "while allocating bitmaps");
+		exit(1);
+	}
+
+	srandom(42);
+	for (i = 0; i < 20000; i++) {
+		blk = TWOLEVEL_START + random() % TWOLEVEL_END;
+		num = 1 + random() % (i % 5 ? 64 : 100000);
+		if (blk + num - 1 > TWOLEVEL_END)
+			num = TWOLEVEL_END - blk + 1;
+		switch (random() % 5) {
+		case 0:
+			ext2fs_mark_block_bitmap(flat, blk);
+			ext2fs_mark_block_bitmap(twolevel, blk);
+			break;
+		case 1:
+			ext2fs_unmark_block_bitmap(flat, blk);
+			ext2fs_unmark_block_bitmap(twolevel, blk);
+			break;
+		case 2:
+			ext2fs_mark_block_bitmap_range(flat, blk, num);
+			ext2fs_mark_block_bitmap_range(twolevel, blk, num);
+			break;
+		case 3:
+			ext2fs_unmark_block_bitmap_range(flat, blk, num);
+			ext2fs_unmark_block_bitmap_range(twolevel, blk, num);
+			break;
+		case 4:
+			if (!ext2fs_test_block_bitmap_range(flat, blk, num) !=
+			    !ext2fs_test_block_bitmap_range(twolevel, blk,
+							    num)) {
+				printf("two-level range test differs at "
+				       "%u+%u\n", blk, num);
+				exit(1);
+			}
+			break;
+		}
+	}
+	check_twolevel(flat, twolevel, "mark and unmark");
+	if (ext2fs_compare_block_bitmap(flat, twolevel)) {
+		printf("two-level bitmap compares unequal\n");
+		exit(1);
+	}
+
+	/* Ranges both ways, with runs of whole chunks set and clear */
+	memset(buf, 0, sizeof(buf));
+	memset(buf + 8192, 0xff, 8192);
+	buf[3] = 0x5a;
+	buf[sizeof(buf) - 1] = 0x81;
+	ext2fs_set_generic_bitmap_range(flat, EXT2_ET_MAGIC_BLOCK_BITMAP,
+					TWOLEVEL_START, TWOLEVEL_END, buf);
+	ext2fs_set_generic_bitmap_range(twolevel, EXT2_ET_MAGIC_BLOCK_BITMAP,
+					TWOLEVEL_START, TWOLEVEL_END, buf);
+	check_twolevel(flat, twolevel, "set_range");
+	ext2fs_mark_block_bitmap_range(twolevel, 1000, 5000);
+	ext2fs_get_generic_bitmap_range(twolevel, EXT2_ET_MAGIC_BLOCK_BITMAP,
+					TWOLEVEL_START, TWOLEVEL_END, buf);
+	ext2fs_set_generic_bitmap_range(flat, EXT2_ET_MAGIC_BLOCK_BITMAP,
+					TWOLEVEL_START, TWOLEVEL_END, buf);
+	check_twolevel(flat, twolevel, "get_range");
+
+	retval = ext2fs_copy_bitmap(twolevel, &copy);
+	if (retval) {
+		com_err("test_twolevel", retval, "while copying bitmap");
+		exit(1);
+	}
+	check_twolevel(flat, copy, "copy");
+	if (ext2fs_test_block_bitmap(copy, 8888))
+		ext2fs_unmark_block_bitmap(copy, 8888);
+	else
+		ext2fs_mark_block_bitmap(copy, 8888);
+	if (ext2fs_compare_block_bitmap(flat, copy) !=
+	    EXT2_ET_NEQ_BLOCK_BITMAP) {
+		printf("changed two-level copy compares equal\n");
+		exit(1);
+	}
+	ext2fs_free_block_bitmap(copy);
+
+	ext2fs_resize_generic_bitmap(EXT2_ET_MAGIC_BLOCK_BITMAP, 70000,
+				     150000, flat);
+	ext2fs_resize_generic_bitmap(EXT2_ET_MAGIC_BLOCK_BITMAP, 70000,
+				     150000, twolevel);
+	check_twolevel(flat, twolevel, "shrinking");
+	ext2fs_resize_generic_bitmap(EXT2_ET_MAGIC_BLOCK_BITMAP, TWOLEVEL_END,
+				     TWOLEVEL_REAL_END, flat);
+	ext2fs_resize_generic_bitmap(EXT2_ET_MAGIC_BLOCK_BITMAP, TWOLEVEL_END,
+				     TWOLEVEL_REAL_END, twolevel);
+	check_twolevel(flat, twolevel, "growing");
+
+	ext2fs_clear_block_bitmap(flat);
+	ext2fs_clear_block_bitmap(twolevel);
+	check_twolevel(flat, twolevel, "clear");
+
+	ext2fs_free_block_bitmap(flat);
+	ext2fs_free_block_bitmap(twolevel);
+	printf("two-level bitmap test succeeded.\n");
+}
+
 
 int main(int argc, char **argv)
 {
@@ -169,5 +312,7 @@ int main(int argc, char **argv)
 
 	printf("ext2fs_fast_set_bit big_test successful\n");
 
+	test_twolevel();
+
 	exit(0);
 }
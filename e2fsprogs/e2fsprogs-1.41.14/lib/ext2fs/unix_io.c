@@ -2,7 +2,9 @@
  * unix_io.c --- This is the Unix (well, really POSIX) implementation
  * 	of the I/O manager.
  *
- * Implements a one-block write-through cache.
+ * Implements a write-back LRU block cache, whose size can be set
+ * with the "cache_size" channel option.  Dirty blocks which are
+ * adjacent on disk are written out together with writev().
  *
  * Includes support for Windows NT support under Cygwin.
  *
@@ -47,6 +49,9 @@
 #if HAVE_SYS_RESOURCE_H
 #include <sys/resource.h>
 #endif
+#if HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 
 #if defined(__linux__) && defined(_IO) && !defined(BLKROGET)
 #define BLKROGET   _IO(0x12, 94) /* Get read-only status (0 = read_write).  */
@@ -70,24 +75,33 @@
 
 struct unix_cache {
 	char		*buf;
-	unsigned long	block;
-	int		access_time;
+	unsigned long long block;
+	struct unix_cache *hash_next;	/* next block in the same bucket */
+	struct unix_cache *lru_prev;	/* more recently used block */
+	struct unix_cache *lru_next;	/* less recently used block */
 	unsigned	dirty:1;
 	unsigned	in_use:1;
 };
 
-#define CACHE_SIZE 8
-#define WRITE_DIRECT_SIZE 4	/* Must be smaller than CACHE_SIZE */
-#define READ_DIRECT_SIZE 4	/* Should be smaller than CACHE_SIZE */
+#define CACHE_SIZE 256	/* Default number of cached blocks */
+#define MIN_CACHE_SIZE 8
+#define MAX_CACHE_SIZE 65536
+#define WRITE_DIRECT_SIZE 4	/* Must be smaller than MIN_CACHE_SIZE */
+#define READ_DIRECT_SIZE 4	/* Should be smaller than MIN_CACHE_SIZE */
+#define MAX_MERGE_BLOCKS 64	/* Most blocks written by one writev() */
 
 struct unix_private_data {
 	int	magic;
 	int	dev;
 	int	flags;
 	int	align;
-	int	access_time;
 	ext2_loff_t offset;
-	struct unix_cache cache[CACHE_SIZE];
+	int	cache_size;
+	int	hash_size;		/* a power of two */
+	struct unix_cache *cache;
+	struct unix_cache **hash;
+	struct unix_cache *lru_head, *lru_tail;
+	struct unix_cache **flush_list;
 	void	*bounce;
 	struct struct_io_stats io_stats;
 };
@@ -115,6 +129,9 @@ static errcode_t unix_read_blk64(io_channel channel, unsigned long long block,
 			       int count, void *data);
 static errcode_t unix_write_blk64(io_channel channel, unsigned long long block,
 				int count, const void *data);
+static errcode_t unix_cache_readahead(io_channel channel,
+				      unsigned long long block,
+				      unsigned long long count);
 
 static struct struct_io_manager struct_unix_manager = {
 	EXT2_ET_MAGIC_IO_MANAGER,
@@ -130,6 +147,7 @@ static struct struct_io_manager struct_unix_manager = {
 	unix_get_stats,
 	unix_read_blk64,
 	unix_write_blk64,
+	unix_cache_readahead,
 };
 
 io_manager unix_io_manager = &struct_unix_manager;
@@ -165,6 +183,7 @@ static errcode_t raw_read_blk(io_channel channel,
 
 	size = (count < 0) ? -count : count * channel->block_size;
 	data->io_stats.bytes_read += size;
+	data->io_stats.read_ops++;
 	location = ((ext2_loff_t) block * channel->block_size) + data->offset;
 	if (ext2fs_llseek(data->dev, location, SEEK_SET) != location) {
 		retval = errno ? errno : EXT2_ET_LLSEEK_FAILED;
@@ -232,6 +251,7 @@ static errcode_t raw_write_blk(io_channel channel,
 			size = count * channel->block_size;
 	}
 	data->io_stats.bytes_written += size;
+	data->io_stats.write_ops++;
 
 	location = ((ext2_loff_t) block * channel->block_size) + data->offset;
 	if (ext2fs_llseek(data->dev, location, SEEK_SET) != location) {
@@ -291,6 +311,69 @@ error_out:
  * Here we implement the cache functions
  */
 
+/*
+ * The cache blocks are kept on a list from the most to the least
+ * recently used one; blocks which are not in use are at its tail.
+ */
+static void lru_unlink(struct unix_private_data *data,
+		       struct unix_cache *cache)
+{
+	if (cache->lru_prev)
+		cache->lru_prev->lru_next = cache->lru_next;
+	else
+		data->lru_head = cache->lru_next;
+	if (cache->lru_next)
+		cache->lru_next->lru_prev = cache->lru_prev;
+	else
+		data->lru_tail = cache->lru_prev;
+	cache->lru_prev = cache->lru_next = 0;
+}
+
+static void lru_add_head(struct unix_private_data *data,
+			 struct unix_cache *cache)
+{
+	cache->lru_prev = 0;
+	cache->lru_next = data->lru_head;
+	if (data->lru_head)
+		data->lru_head->lru_prev = cache;
+	else
+		data->lru_tail = cache;
+	data->lru_head = cache;
+}
+
+static void lru_add_tail(struct unix_private_data *data,
+			 struct unix_cache *cache)
+{
+	cache->lru_next = 0;
+	cache->lru_prev = data->lru_tail;
+	if (data->lru_tail)
+		data->lru_tail->lru_next = cache;
+	else
+		data->lru_head = cache;
+	data->lru_tail = cache;
+}
+
+static struct unix_cache **hash_bucket(struct unix_private_data *data,
+				       unsigned long long block)
+{
+	return data->hash + (block & (data->hash_size - 1));
+}
+
+static void hash_remove(struct unix_private_data *data,
+			struct unix_cache *cache)
+{
+	struct unix_cache	**pp;
+
+	for (pp = hash_bucket(data, cache->block); *pp;
+	     pp = &(*pp)->hash_next) {
+		if (*pp == cache) {
+			*pp = cache->hash_next;
+			break;
+		}
+	}
+	cache->hash_next = 0;
+}
+
 /* Allocate the cache buffers */
 static errcode_t alloc_cache(io_channel channel,
 			     struct unix_private_data *data)
@@ -299,18 +382,35 @@ static errcode_t alloc_cache(io_channel channel,
 	struct unix_cache	*cache;
 	int			i;
 
-	data->access_time = 0;
-	for (i=0, cache = data->cache; i < CACHE_SIZE; i++, cache++) {
-		cache->block = 0;
-		cache->access_time = 0;
-		cache->dirty = 0;
-		cache->in_use = 0;
-		if (cache->buf)
-			ext2fs_free_mem(&cache->buf);
+	if (!data->cache_size)
+		data->cache_size = CACHE_SIZE;
+	for (data->hash_size = 1; data->hash_size < data->cache_size;
+	     data->hash_size <<= 1)
+		;
+	data->lru_head = data->lru_tail = 0;
+
+	retval = ext2fs_get_array(data->cache_size, sizeof(struct unix_cache),
+				  &data->cache);
+	if (retval)
+		return retval;
+	memset(data->cache, 0, data->cache_size * sizeof(struct unix_cache));
+	retval = ext2fs_get_array(data->hash_size, sizeof(struct unix_cache *),
+				  &data->hash);
+	if (retval)
+		return retval;
+	memset(data->hash, 0, data->hash_size * sizeof(struct unix_cache *));
+	retval = ext2fs_get_array(data->cache_size,
+				  sizeof(struct unix_cache *),
+				  &data->flush_list);
+	if (retval)
+		return retval;
+
+	for (i=0, cache = data->cache; i < data->cache_size; i++, cache++) {
 		retval = ext2fs_get_memalign(channel->block_size,
 					     data->align, &cache->buf);
 		if (retval)
 			return retval;
+		lru_add_tail(data, cache);
 	}
 	if (data->align) {
 		if (data->bounce)
@@ -327,20 +427,40 @@ static void free_cache(struct unix_private_data *data)
 	struct unix_cache	*cache;
 	int			i;
 
-	data->access_time = 0;
-	for (i=0, cache = data->cache; i < CACHE_SIZE; i++, cache++) {
-		cache->block = 0;
-		cache->access_time = 0;
-		cache->dirty = 0;
-		cache->in_use = 0;
-		if (cache->buf)
-			ext2fs_free_mem(&cache->buf);
+	if (data->cache) {
+		for (i=0, cache = data->cache; i < data->cache_size;
+		     i++, cache++) {
+			if (cache->buf)
+				ext2fs_free_mem(&cache->buf);
+		}
+		ext2fs_free_mem(&data->cache);
 	}
+	if (data->hash)
+		ext2fs_free_mem(&data->hash);
+	if (data->flush_list)
+		ext2fs_free_mem(&data->flush_list);
+	data->lru_head = data->lru_tail = 0;
 	if (data->bounce)
 		ext2fs_free_mem(&data->bounce);
 }
 
 #ifndef NO_IO_CACHE
+/*
+ * Look up a block in the cache without changing its place in the LRU
+ * list.
+ */
+static struct unix_cache *peek_cached_block(struct unix_private_data *data,
+					    unsigned long long block)
+{
+	struct unix_cache	*cache;
+
+	for (cache = *hash_bucket(data, block); cache;
+	     cache = cache->hash_next)
+		if (cache->block == block)
+			return cache;
+	return 0;
+}
+
 /*
  * Try to find a block in the cache.  If the block is not found, and
  * eldest is a non-zero pointer, then fill in eldest with the cache
@@ -350,29 +470,109 @@ static struct unix_cache *find_cached_block(struct unix_private_data *data,
 					    unsigned long long block,
 					    struct unix_cache **eldest)
 {
-	struct unix_cache	*cache, *unused_cache, *oldest_cache;
-	int			i;
+	struct unix_cache	*cache;
 
-	unused_cache = oldest_cache = 0;
-	for (i=0, cache = data->cache; i < CACHE_SIZE; i++, cache++) {
-		if (!cache->in_use) {
-			if (!unused_cache)
-				unused_cache = cache;
-			continue;
-		}
-		if (cache->block == block) {
-			cache->access_time = ++data->access_time;
-			return cache;
-		}
-		if (!oldest_cache ||
-		    (cache->access_time < oldest_cache->access_time))
-			oldest_cache = cache;
+	cache = peek_cached_block(data, block);
+	if (cache) {
+		lru_unlink(data, cache);
+		lru_add_head(data, cache);
+		return cache;
 	}
 	if (eldest)
-		*eldest = (unused_cache) ? unused_cache : oldest_cache;
+		*eldest = data->lru_tail;
 	return 0;
 }
 
+/*
+ * Drop a block from the cache, without writing it out.
+ */
+static void invalidate_cache(struct unix_private_data *data,
+			     struct unix_cache *cache)
+{
+	if (!cache->in_use)
+		return;
+	hash_remove(data, cache);
+	cache->in_use = 0;
+	cache->dirty = 0;
+	lru_unlink(data, cache);
+	lru_add_tail(data, cache);
+}
+
+/*
+ * Write out a list of dirty cache blocks with consecutive block
+ * numbers.  They are written with a single writev() where that is
+ * possible; if it fails, each block is retried on its own so that the
+ * write_error callback sees the exact block which failed.
+ */
+static errcode_t write_cached_run(io_channel channel,
+				  struct unix_private_data *data,
+				  struct unix_cache **run, int count)
+{
+	errcode_t	retval, retval2 = 0;
+	int		i;
+#if HAVE_SYS_UIO_H
+	struct iovec	iov[MAX_MERGE_BLOCKS];
+	ext2_loff_t	location;
+	ssize_t		size;
+
+	if ((count > 1) &&
+	    ((data->align == 0) ||
+	     IS_ALIGNED(channel->block_size, data->align))) {
+		size = (ssize_t) count * channel->block_size;
+		for (i = 0; i < count; i++) {
+			iov[i].iov_base = run[i]->buf;
+			iov[i].iov_len = channel->block_size;
+		}
+		location = ((ext2_loff_t) run[0]->block * channel->block_size) +
+			data->offset;
+		if ((ext2fs_llseek(data->dev, location, SEEK_SET) == location) &&
+		    (writev(data->dev, iov, count) == size)) {
+			data->io_stats.bytes_written += size;
+			data->io_stats.write_ops++;
+			data->io_stats.merged_ops++;
+			for (i = 0; i < count; i++)
+				run[i]->dirty = 0;
+			return 0;
+		}
+	}
+#endif
+	for (i = 0; i < count; i++) {
+		retval = raw_write_blk(channel, data, run[i]->block, 1,
+				       run[i]->buf);
+		if (retval)
+			retval2 = retval;
+		else
+			run[i]->dirty = 0;
+	}
+	return retval2;
+}
+
+/*
+ * Write out a dirty cache block, together with the dirty blocks which
+ * surround it on disk.
+ */
+static errcode_t write_cached_block(io_channel channel,
+				    struct unix_private_data *data,
+				    struct unix_cache *cache)
+{
+	struct unix_cache	*run[MAX_MERGE_BLOCKS], *c;
+	unsigned long long	first;
+	int			count;
+
+	first = cache->block;
+	while ((first > 0) && (cache->block - first < MAX_MERGE_BLOCKS - 1) &&
+	       (c = peek_cached_block(data, first - 1)) && c->dirty)
+		first--;
+	count = 0;
+	while (count < MAX_MERGE_BLOCKS) {
+		c = peek_cached_block(data, first + count);
+		if (!c || !c->dirty)
+			break;
+		run[count++] = c;
+	}
+	return write_cached_run(channel, data, run, count);
+}
+
 /*
  * Reuse a particular cache entry for another block.
  */
@@ -380,12 +580,27 @@ static void reuse_cache(io_channel channel, struct unix_private_data *data,
 		 struct unix_cache *cache, unsigned long long block)
 {
 	if (cache->dirty && cache->in_use)
-		raw_write_blk(channel, data, cache->block, 1, cache->buf);
+		write_cached_block(channel, data, cache);
 
+	if (cache->in_use)
+		hash_remove(data, cache);
 	cache->in_use = 1;
 	cache->dirty = 0;
 	cache->block = block;
-	cache->access_time = ++data->access_time;
+	cache->hash_next = *hash_bucket(data, block);
+	*hash_bucket(data, block) = cache;
+	lru_unlink(data, cache);
+	lru_add_head(data, cache);
+}
+
+static EXT2_QSORT_TYPE cache_block_cmp(const void *a, const void *b)
+{
+	const struct unix_cache *ca = *(const struct unix_cache * const *) a;
+	const struct unix_cache *cb = *(const struct unix_cache * const *) b;
+
+	if (ca->block < cb->block)
+		return -1;
+	return ca->block > cb->block;
 }
 
 /*
@@ -396,27 +611,31 @@ static errcode_t flush_cached_blocks(io_channel channel,
 				     int invalidate)
 
 {
-	struct unix_cache	*cache;
+	struct unix_cache	*cache, **list = data->flush_list;
 	errcode_t		retval, retval2;
-	int			i;
+	int			i, j, num;
 
 	retval2 = 0;
-	for (i=0, cache = data->cache; i < CACHE_SIZE; i++, cache++) {
-		if (!cache->in_use)
-			continue;
-
-		if (invalidate)
-			cache->in_use = 0;
-
-		if (!cache->dirty)
-			continue;
-
-		retval = raw_write_blk(channel, data,
-				       cache->block, 1, cache->buf);
+	num = 0;
+	for (i=0, cache = data->cache; i < data->cache_size; i++, cache++)
+		if (cache->in_use && cache->dirty)
+			list[num++] = cache;
+	if (num > 1)
+		qsort(list, num, sizeof(struct unix_cache *), cache_block_cmp);
+
+	for (i = 0; i < num; i = j) {
+		for (j = i + 1; (j < num) && (j - i < MAX_MERGE_BLOCKS); j++)
+			if (list[j]->block != list[j-1]->block + 1)
+				break;
+		retval = write_cached_run(channel, data, list + i, j - i);
 		if (retval)
 			retval2 = retval;
-		else
-			cache->dirty = 0;
+	}
+
+	if (invalidate) {
+		for (i=0, cache = data->cache; i < data->cache_size;
+		     i++, cache++)
+			invalidate_cache(data, cache);
 	}
 	return retval2;
 }
@@ -458,7 +677,7 @@ static errcode_t unix_open(const char *name, int flags, io_channel *channel)
 
 	memset(data, 0, sizeof(struct unix_private_data));
 	data->magic = EXT2_ET_MAGIC_UNIX_IO_CHANNEL;
-	data->io_stats.num_fields = 2;
+	data->io_stats.num_fields = 7;
 
 	open_flags = (flags & IO_FLAG_RW) ? O_RDWR : O_RDONLY;
 	if (flags & IO_FLAG_EXCLUSIVE)
@@ -613,7 +832,7 @@ static errcode_t unix_read_blk64(io_channel channel, unsigned long long block,
 			       int count, void *buf)
 {
 	struct unix_private_data *data;
-	struct unix_cache *cache, *reuse[READ_DIRECT_SIZE];
+	struct unix_cache *cache, *reuse;
 	errcode_t	retval;
 	char		*cp;
 	int		i, j;
@@ -626,22 +845,38 @@ static errcode_t unix_read_blk64(io_channel channel, unsigned long long block,
 	return raw_read_blk(channel, data, block, count, buf);
 #else
 	/*
-	 * If we're doing an odd-sized read or a very large read,
-	 * flush out the cache and then do a direct read.
+	 * If we're doing an odd-sized read, flush out the cache and
+	 * then do a direct read.
 	 */
-	if (count < 0 || count > WRITE_DIRECT_SIZE) {
+	if (count < 0) {
 		if ((retval = flush_cached_blocks(channel, data, 0)))
 			return retval;
 		return raw_read_blk(channel, data, block, count, buf);
 	}
 
+	/*
+	 * A very large read goes directly to the disk as well, and then
+	 * picks up the cached blocks which have not been written yet.
+	 */
+	if (count > READ_DIRECT_SIZE) {
+		if ((retval = raw_read_blk(channel, data, block, count, buf)))
+			return retval;
+		for (i = 0, cp = buf; i < count; i++, cp += channel->block_size) {
+			cache = peek_cached_block(data, block + i);
+			if (cache && cache->dirty)
+				memcpy(cp, cache->buf, channel->block_size);
+		}
+		return 0;
+	}
+
 	cp = buf;
 	while (count > 0) {
 		/* If it's in the cache, use it! */
-		if ((cache = find_cached_block(data, block, &reuse[0]))) {
+		if ((cache = find_cached_block(data, block, &reuse))) {
 #ifdef DEBUG
-			printf("Using cached block %lu\n", block);
+			printf("Using cached block %llu\n", block);
 #endif
+			data->io_stats.cache_hits++;
 			memcpy(cp, cache->buf, channel->block_size);
 			count--;
 			block++;
@@ -653,11 +888,12 @@ static errcode_t unix_read_blk64(io_channel channel, unsigned long long block,
 			 * Special case where we read directly into the
 			 * cache buffer; important in the O_DIRECT case
 			 */
-			cache = reuse[0];
+			data->io_stats.cache_misses++;
+			cache = reuse;
 			reuse_cache(channel, data, cache, block);
 			if ((retval = raw_read_blk(channel, data, block, 1,
 						   cache->buf))) {
-				cache->in_use = 0;
+				invalidate_cache(data, cache);
 				return retval;
 			}
 			memcpy(cp, cache->buf, channel->block_size);
@@ -669,18 +905,19 @@ static errcode_t unix_read_blk64(io_channel channel, unsigned long long block,
 		 * single read request
 		 */
 		for (i=1; i < count; i++)
-			if (find_cached_block(data, block+i, &reuse[i]))
+			if (peek_cached_block(data, block+i))
 				break;
 #ifdef DEBUG
-		printf("Reading %d blocks starting at %lu\n", i, block);
+		printf("Reading %d blocks starting at %llu\n", i, block);
 #endif
+		data->io_stats.cache_misses += i;
 		if ((retval = raw_read_blk(channel, data, block, i, cp)))
 			return retval;
 
 		/* Save the results in the cache */
 		for (j=0; j < i; j++) {
 			count--;
-			cache = reuse[j];
+			cache = data->lru_tail;
 			reuse_cache(channel, data, cache, block++);
 			memcpy(cache->buf, cp, channel->block_size);
 			cp += channel->block_size;
@@ -703,7 +940,7 @@ static errcode_t unix_write_blk64(io_channel channel, unsigned long long block,
 	struct unix_cache *cache, *reuse;
 	errcode_t	retval = 0;
 	const char	*cp;
-	int		writethrough;
+	int		i, writethrough;
 
 	EXT2_CHECK_MAGIC(channel, EXT2_ET_MAGIC_IO_CHANNEL);
 	data = (struct unix_private_data *) channel->private_data;
@@ -713,15 +950,29 @@ static errcode_t unix_write_blk64(io_channel channel, unsigned long long block,
 	return raw_write_blk(channel, data, block, count, buf);
 #else
 	/*
-	 * If we're doing an odd-sized write or a very large write,
-	 * flush out the cache completely and then do a direct write.
+	 * If we're doing an odd-sized write, flush out the cache
+	 * completely and then do a direct write.
 	 */
-	if (count < 0 || count > WRITE_DIRECT_SIZE) {
+	if (count < 0) {
 		if ((retval = flush_cached_blocks(channel, data, 1)))
 			return retval;
 		return raw_write_blk(channel, data, block, count, buf);
 	}
 
+	/*
+	 * A very large write goes directly to the disk; the cached
+	 * copies of the blocks it covers are simply dropped, since the
+	 * write replaces them.
+	 */
+	if (count > WRITE_DIRECT_SIZE) {
+		for (i = 0; i < count; i++) {
+			cache = peek_cached_block(data, block + i);
+			if (cache)
+				invalidate_cache(data, cache);
+		}
+		return raw_write_blk(channel, data, block, count, buf);
+	}
+
 	/*
 	 * For a moderate-sized multi-block write, first force a write
 	 * if we're in write-through cache mode, and then fill the
@@ -754,6 +1005,31 @@ static errcode_t unix_write_blk(io_channel channel, unsigned long block,
 	return unix_write_blk64(channel, block, count, buf);
 }
 
+/*
+ * Ask the kernel to start reading blocks into the page cache, so that
+ * the later reads of them do not have to wait for the device.
+ */
+static errcode_t unix_cache_readahead(io_channel channel,
+				      unsigned long long block,
+				      unsigned long long count)
+{
+#ifdef HAVE_POSIX_FADVISE
+	struct unix_private_data *data;
+
+	EXT2_CHECK_MAGIC(channel, EXT2_ET_MAGIC_IO_CHANNEL);
+	data = (struct unix_private_data *) channel->private_data;
+	EXT2_CHECK_MAGIC(data, EXT2_ET_MAGIC_UNIX_IO_CHANNEL);
+
+	return posix_fadvise(data->dev,
+			     (ext2_loff_t)block * channel->block_size +
+			     data->offset,
+			     (ext2_loff_t)count * channel->block_size,
+			     POSIX_FADV_WILLNEED);
+#else
+	return EXT2_ET_OP_NOT_SUPPORTED;
+#endif
+}
+
 static errcode_t unix_write_byte(io_channel channel, unsigned long offset,
 				 int size, const void *buf)
 {
@@ -815,6 +1091,7 @@ static errcode_t unix_set_option(io_channel channel, const char *option,
 	struct unix_private_data *data;
 	unsigned long long tmp;
 	char *end;
+	errcode_t retval;
 
 	EXT2_CHECK_MAGIC(channel, EXT2_ET_MAGIC_IO_CHANNEL);
 	data = (struct unix_private_data *) channel->private_data;
@@ -832,5 +1109,48 @@ static errcode_t unix_set_option(io_channel channel, const char *option,
 			return EXT2_ET_INVALID_ARGUMENT;
 		return 0;
 	}
+	if (!strcmp(option, "cache_size")) {
+		if (!arg)
+			return EXT2_ET_INVALID_ARGUMENT;
+
+		tmp = strtoull(arg, &end, 0);
+		if (*end || (tmp < MIN_CACHE_SIZE) || (tmp > MAX_CACHE_SIZE))
+			return EXT2_ET_INVALID_ARGUMENT;
+#ifndef NO_IO_CACHE
+		if ((retval = flush_cached_blocks(channel, data, 0)))
+			return retval;
+#endif
+		free_cache(data);
+		data->cache_size = tmp;
+		return alloc_cache(channel, data);
+	}
+#if defined(__linux__) && defined(O_DIRECT)
+	/*
+	 * Linux lets O_DIRECT be set on a descriptor which is already
+	 * open, so uncached I/O can be asked for like any other option.
+	 */
+	if (!strcmp(option, "direct_io")) {
+		int	fl;
+
+		if (arg)
+			return EXT2_ET_INVALID_ARGUMENT;
+		if (data->flags & IO_FLAG_DIRECT_IO)
+			return 0;
+#ifndef NO_IO_CACHE
+		if ((retval = flush_cached_blocks(channel, data, 0)))
+			return retval;
+#endif
+		fl = fcntl(data->dev, F_GETFL);
+		if ((fl < 0) || (fcntl(data->dev, F_SETFL, fl | O_DIRECT) < 0))
+			return errno;
+		data->flags |= IO_FLAG_DIRECT_IO;
+#ifdef BLKSSZGET
+		if (ioctl(data->dev, BLKSSZGET, &data->align) != 0)
+#endif
+			data->align = channel->block_size;
+		free_cache(data);
+		return alloc_cache(channel, data);
+	}
+#endif
 	return EXT2_ET_INVALID_ARGUMENT;
 }
@@ -86,6 +86,7 @@ int	noaction;
 int	journal_size;
 int	journal_flags;
 int	lazy_itable_init;
+int	lazy_journal_init;
 char	*bad_blocks_filename;
 __u32	fs_stride;
 
@@ -806,6 +807,11 @@ static void parse_extended_opts(struct ext2_super_block *param,
 				lazy_itable_init = strtoul(arg, &p, 0);
 			else
 				lazy_itable_init = 1;
+		} else if (!strcmp(token, "lazy_journal_init")) {
+			if (arg)
+				lazy_journal_init = strtoul(arg, &p, 0);
+			else
+				lazy_journal_init = 1;
 		} else if (!strcmp(token, "discard")) {
 			discard = 1;
 		} else if (!strcmp(token, "nodiscard")) {
@@ -825,6 +831,7 @@ static void parse_extended_opts(struct ext2_super_block *param,
 			"\tstripe-width=<RAID stride * data disks in blocks>\n"
 			"\tresize=<resize maximum size in blocks>\n"
 			"\tlazy_itable_init=<0 to disable, 1 to enable>\n"
+			"\tlazy_journal_init=<0 to disable, 1 to enable>\n"
 			"\ttest_fs\n"
 			"\tdiscard\n"
 			"\tnodiscard\n\n"),
@@ -1787,6 +1794,8 @@ got_size:
 	lazy_itable_init = get_bool_from_profile(fs_types,
 						 "lazy_itable_init",
 						 lazy_itable_init);
+	lazy_journal_init = get_bool_from_profile(fs_types,
+						  "lazy_journal_init", 0);
 	discard = get_bool_from_profile(fs_types, "discard" , discard);
 
 	/* Get options from profile */
@@ -2120,6 +2129,7 @@ int main (int argc, char *argv[])
 					 " - skipping inode table wipe\n"));
 			lazy_itable_init = 1;
 			itable_zeroed = 1;
+			lazy_journal_init = 1;
 		}
 	}
 
@@ -2337,6 +2347,8 @@ int main (int argc, char *argv[])
 			       journal_blocks);
 			fflush(stdout);
 		}
+		if (lazy_journal_init)
+			journal_flags |= EXT2_MKJOURNAL_LAZYINIT;
 		retval = ext2fs_add_journal_inode(fs, journal_blocks,
 						  journal_flags);
 		if (retval) {
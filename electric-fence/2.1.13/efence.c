@@ -34,6 +34,7 @@
 #include <unistd.h>
 #include <memory.h>
 #include <string.h>
+#include <malloc.h>
 #include <pthread.h>
 
 #ifdef	malloc
@@ -54,6 +55,17 @@ static const char	version[] = "\n  Electric Fence 2.1"
  */
 #define			MEMORY_CREATION_SIZE	1024 * 1024
 
+/*
+ * The pool allocator has POOL_CLASSES sizes of slots, of 1, 2, 4 ... pages.
+ * Each thread caches up to POOL_CACHE_SLOTS free slots of each size, and
+ * exchanges POOL_BATCH of them at a time with the global free lists.
+ * POOL_DEFAULT_SIZE is the default arena size, in megabytes.
+ */
+#define			POOL_CLASSES		6
+#define			POOL_CACHE_SLOTS	32
+#define			POOL_BATCH		16
+#define			POOL_DEFAULT_SIZE	(sizeof(void *) > 4 ? 4096 : 256)
+
 /*
  * Enum Mode indicates the status of a malloc buffer.
  */
@@ -135,6 +147,28 @@ int		EF_ALLOW_MALLOC_0 = -1;
  */
 int            EF_FREE_WIPES = -1;
 
+/*
+ * EF_POOL is set if Electric Fence is to use the pool allocator, which
+ * hands out guarded slots of a large arena reserved at start-up without
+ * any system call, from per-thread caches. It is much faster than the
+ * classic allocator, but only detects over-runs (or under-runs), not
+ * accesses to free memory unless EF_PROTECT_FREE is set too.
+ */
+int		EF_POOL = -1;
+
+/*
+ * EF_POOL_SIZE is the size of the pool's arena in megabytes. It is only
+ * address space; memory is used when the slots are.
+ */
+int		EF_POOL_SIZE = -1;
+
+/*
+ * EF_SAMPLE, when greater than 1 and EF_POOL is set, makes Electric Fence
+ * guard only about one allocation in EF_SAMPLE; the others come from the
+ * C library malloc().
+ */
+int		EF_SAMPLE = -1;
+
 /*
  * allocationList points to the array of slot structures used to manage the
  * malloc arena.
@@ -192,6 +226,61 @@ static pthread_mutex_t mutex ;
 static pthread_t mutexpid=0;
 static int locknr=0;
 
+/*
+ * Struct PoolClass describes the slots of one size in the pool's arena.
+ * Each slot is "pages" accessible pages and a guard page, which is after
+ * them, or before them if EF_PROTECT_BELOW is set. The accessible pages
+ * are opened once, when the slot is first used, and the guard pages are
+ * never opened.
+ */
+#define	SLOT_FREE	((size_t)-1)
+#define	SLOT_PROTECTED	((size_t)-2)
+
+struct _PoolClass {
+	char *		base;		/* The first slot. */
+	size_t		pages;		/* Accessible pages per slot. */
+	size_t		stride;		/* Bytes per slot, with the guard page. */
+	size_t		slots;		/* Number of slots. */
+	size_t		unUsed;		/* Slots from here on were never used. */
+	size_t		freeCount;
+	unsigned int *	freeList;	/* Free slots not in any thread cache. */
+	size_t *	userSize;	/* Per slot, or SLOT_FREE. */
+};
+typedef struct _PoolClass	PoolClass;
+
+/*
+ * Struct PoolCache holds the free slots cached by one thread, so that
+ * most allocations take neither a lock nor a system call.
+ */
+struct _PoolCache {
+	unsigned int	count[POOL_CLASSES];
+	unsigned int	slot[POOL_CLASSES][POOL_CACHE_SLOTS];
+	unsigned int	seed;		/* Random numbers for EF_SAMPLE. */
+	int		untilSample;
+	int		registered;	/* Flushed by poolThreadExit(). */
+};
+typedef struct _PoolCache	PoolCache;
+
+/*
+ * The arena is POOL_CLASSES regions of poolRegionSize bytes, one for each
+ * slot size, followed by the memory of the classic allocator, which gets
+ * the allocations too large for a slot. free() thus knows from the
+ * address alone which allocator, or the C library, a buffer is from.
+ */
+static PoolClass	poolClass[POOL_CLASSES];
+static char *		poolStart = 0;
+static char *		poolClassEnd = 0;
+static char *		poolEnd = 0;
+static char *		classicNext = 0;
+static size_t		poolRegionSize = 0;
+static pthread_mutex_t	poolMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t	poolOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t	poolKey;
+static __thread PoolCache	poolCache;
+
+extern C_LINKAGE void *	__libc_memalign(size_t alignment, size_t size);
+extern C_LINKAGE void	__libc_free(void * address);
+
 static void *
 efence_memalign(size_t alignment, size_t userSize);
 
@@ -242,16 +331,42 @@ internalError(void)
 }
 
 /*
- * initialize sets up the memory allocation arena and the run-time
- * configuration information.
+ * createMemory gets memory for the classic allocator from the operating
+ * system, or from the pool's arena when the pool allocator is in use.
+ */
+static void *
+createMemory(size_t size)
+{
+	char *	allocation;
+
+	if ( !EF_POOL )
+		return Page_Create(size);
+
+	pthread_mutex_lock(&poolMutex);
+	if ( size > (size_t)(poolEnd - classicNext) ) {
+		pthread_mutex_unlock(&poolMutex);
+		EF_Exit("The pool is full, increase EF_POOL_SIZE.");
+	}
+	allocation = classicNext;
+	classicNext += size;
+	pthread_mutex_unlock(&poolMutex);
+
+	Page_AllowAccess(allocation, size);
+	return allocation;
+}
+
+/*
+ * readConfiguration sets up the run-time configuration information.
  */
 static void
-initialize(void)
+readConfiguration(void)
 {
-	size_t	size = MEMORY_CREATION_SIZE;
-	size_t	slack;
+	static int	configured = 0;
 	char *	string;
-	Slot *	slot;
+
+	if ( configured )
+		return;
+	configured = 1;
 
        if ( EF_DISABLE_BANNER == -1 ) {
                if ( (string = getenv("EF_DISABLE_BANNER")) != 0 )
@@ -331,10 +446,48 @@ initialize(void)
 	                EF_FREE_WIPES = 0;
 	}
 
+	/*
+	 * See if the user wants the pool allocator, how large its arena
+	 * should be, and which allocations it should guard.
+	 */
+	if ( EF_POOL == -1 ) {
+		if ( (string = getenv("EF_POOL")) != 0 )
+			EF_POOL = (atoi(string) != 0);
+		else
+			EF_POOL = 0;
+	}
+
+	if ( EF_POOL_SIZE == -1 ) {
+		if ( (string = getenv("EF_POOL_SIZE")) != 0 )
+			EF_POOL_SIZE = atoi(string);
+		if ( EF_POOL_SIZE <= 0 )
+			EF_POOL_SIZE = POOL_DEFAULT_SIZE;
+	}
+
+	if ( EF_SAMPLE == -1 ) {
+		if ( (string = getenv("EF_SAMPLE")) != 0 )
+			EF_SAMPLE = atoi(string);
+		else
+			EF_SAMPLE = 0;
+	}
+
 	/*
 	 * Get the run-time configuration of the virtual memory page size.
  	 */
 	bytesPerPage = Page_Size();
+}
+
+/*
+ * initialize sets up the memory allocation arena.
+ */
+static void
+initialize(void)
+{
+	size_t	size = MEMORY_CREATION_SIZE;
+	size_t	slack;
+	Slot *	slot;
+
+	readConfiguration();
 
 	/*
 	 * Figure out how many Slot structures to allocate at one time.
@@ -353,7 +506,7 @@ initialize(void)
 	 * first buffer will be used for Slot structures, the second will
 	 * be marked free.
 	 */
-	slot = allocationList = (Slot *)Page_Create(size);
+	slot = allocationList = (Slot *)createMemory(size);
 	memset((char *)allocationList, 0, allocationListSize);
 
 	slot[0].internalSize = slot[0].userSize = allocationListSize;
@@ -551,7 +704,7 @@ efence_memalign(size_t alignment, size_t userSize)
 		/* Use up one of the empty slots to make the full slot. */
 		fullSlot = emptySlots[0];
 		emptySlots[0] = emptySlots[1];
-		fullSlot->internalAddress = Page_Create(chunkSize);
+		fullSlot->internalAddress = createMemory(chunkSize);
 		fullSlot->internalSize = chunkSize;
 		fullSlot->mode = FREE;
 		unUsedSlots--;
@@ -825,10 +978,9 @@ efence_malloc(size_t size)
 {
         void  *allocation;   
  
-        if ( allocationList == 0 ) {
-                pthread_mutex_init(&mutex, NULL); 
+        /* The mutex was set up by poolInitialize(). */
+        if ( allocationList == 0 )
                 initialize();   /* This sets EF_ALIGNMENT */
-        }       
         lock();
         allocation=efence_memalign(EF_ALIGNMENT, size); 
 
@@ -869,39 +1021,433 @@ efence_valloc (size_t size)
 }
 
 
+/*
+ * The pool allocator, used when EF_POOL is set.
+ *
+ * The classic allocator above makes one or two mprotect() calls and
+ * searches the whole slot list for every malloc() and free(), under one
+ * lock, so a program that allocates much runs a hundred times slower
+ * under it. The pool reserves a large arena of inaccessible address
+ * space once, and hands out the slots described by PoolClass from per
+ * thread caches: once a slot has been used, allocating and freeing it
+ * again costs no system call, and usually no lock either.
+ *
+ * With EF_SAMPLE set to N, only about one allocation in N (at random) is
+ * guarded, the others come from the C library. That still finds
+ * over-runs which happen again and again, at a cost low enough for long
+ * soak tests.
+ */
+
+/*
+ * poolThreadExit gives the slots cached by a thread which is exiting
+ * back to the global free lists.
+ */
+static void
+poolThreadExit(void * arg)
+{
+	PoolCache *	cache = (PoolCache *)arg;
+	int		c;
+
+	pthread_mutex_lock(&poolMutex);
+	for ( c = 0; c < POOL_CLASSES; c++ ) {
+		PoolClass *	pc = &poolClass[c];
+
+		while ( cache->count[c] > 0 )
+			pc->freeList[pc->freeCount++]
+			 = cache->slot[c][--cache->count[c]];
+	}
+	pthread_mutex_unlock(&poolMutex);
+}
+
+/*
+ * poolInitialize reserves the pool's arena and sets up its slots, if
+ * EF_POOL is set.
+ */
+static void
+poolInitialize(void)
+{
+	size_t	arenaSize;
+	size_t	metaSize;
+	size_t	slack;
+	char *	meta;
+	int	c;
+
+	readConfiguration();
+	pthread_mutex_init(&mutex, NULL);
+	if ( !EF_POOL )
+		return;
+
+	arenaSize = (size_t)EF_POOL_SIZE * 1024 * 1024;
+	poolRegionSize = arenaSize / (POOL_CLASSES + 1);
+	poolRegionSize -= poolRegionSize % bytesPerPage;
+	arenaSize = poolRegionSize * (POOL_CLASSES + 1);
+
+	poolStart = (char *)Page_Reserve(arenaSize);
+	poolClassEnd = poolStart + poolRegionSize * POOL_CLASSES;
+	poolEnd = poolStart + arenaSize;
+	classicNext = poolClassEnd;
+
+	metaSize = 0;
+	for ( c = 0; c < POOL_CLASSES; c++ ) {
+		PoolClass *	pc = &poolClass[c];
+
+		pc->base = poolStart + poolRegionSize * c;
+		pc->pages = (size_t)1 << c;
+		pc->stride = (pc->pages + 1) * bytesPerPage;
+		pc->slots = poolRegionSize / pc->stride;
+		metaSize += pc->slots * (sizeof(size_t) + sizeof(unsigned int));
+	}
+	if ( (slack = metaSize % bytesPerPage) != 0 )
+		metaSize += bytesPerPage - slack;
+
+	meta = (char *)Page_Create(metaSize);
+	for ( c = 0; c < POOL_CLASSES; c++ ) {
+		PoolClass *	pc = &poolClass[c];
+
+		pc->userSize = (size_t *)meta;
+		meta += pc->slots * sizeof(size_t);
+		memset(pc->userSize, 0xff, pc->slots * sizeof(size_t));
+		pc->freeList = (unsigned int *)meta;
+		meta += pc->slots * sizeof(unsigned int);
+	}
+
+	pthread_key_create(&poolKey, poolThreadExit);
+}
+
+/*
+ * poolEnabled tells if the pool allocator is used, setting it up on the
+ * first call.
+ */
+static int
+poolEnabled(void)
+{
+	pthread_once(&poolOnce, poolInitialize);
+	return EF_POOL;
+}
+
+static void
+poolRegister(PoolCache * cache)
+{
+	cache->registered = 1;
+	pthread_setspecific(poolKey, cache);
+}
+
+/*
+ * poolSampled decides if this allocation is guarded, when EF_SAMPLE is
+ * set. The interval to the next guarded allocation is random, with an
+ * average of EF_SAMPLE, so that a regular allocation pattern can not
+ * keep the same buffer from ever being guarded.
+ */
+static int
+poolSampled(PoolCache * cache)
+{
+	unsigned int	x;
+
+	if ( --cache->untilSample > 0 )
+		return 0;
+
+	if ( cache->seed == 0 )
+		cache->seed = ((unsigned int)(size_t)cache ^ getpid()) | 1;
+	x = cache->seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	cache->seed = x;
+	cache->untilSample = 1 + x % (2 * (unsigned int)EF_SAMPLE - 1);
+	return 1;
+}
+
+/*
+ * poolSlotData is the address of the accessible pages of a slot.
+ */
+static char *
+poolSlotData(PoolClass * pc, size_t index)
+{
+	char *	slot = pc->base + index * pc->stride;
+
+	if ( EF_PROTECT_BELOW )
+		return slot + bytesPerPage;
+	return slot;
+}
+
+/*
+ * poolRefill takes some free slots of class c from the global lists, or
+ * opens never used ones. Returns 0 if all slots of class c are in use.
+ */
+static int
+poolRefill(PoolCache * cache, int c)
+{
+	PoolClass *	pc = &poolClass[c];
+	unsigned int	count = 0;
+
+	if ( !cache->registered )
+		poolRegister(cache);
+
+	pthread_mutex_lock(&poolMutex);
+	while ( count < POOL_BATCH && pc->freeCount > 0 )
+		cache->slot[c][count++] = pc->freeList[--pc->freeCount];
+	while ( count < POOL_BATCH && pc->unUsed < pc->slots ) {
+		Page_AllowAccess(poolSlotData(pc, pc->unUsed)
+		 ,pc->pages * bytesPerPage);
+		cache->slot[c][count++] = pc->unUsed++;
+	}
+	pthread_mutex_unlock(&poolMutex);
+
+	cache->count[c] = count;
+	return count > 0;
+}
+
+/*
+ * poolUserAddress is the address given to the user for a slot: the one
+ * just below the guard page, or the first after it with EF_PROTECT_BELOW.
+ */
+static char *
+poolUserAddress(PoolClass * pc, size_t index, size_t userSize)
+{
+	char *	data = poolSlotData(pc, index);
+
+	if ( EF_PROTECT_BELOW )
+		return data;
+	return data + pc->pages * bytesPerPage - userSize;
+}
+
+/*
+ * classicUserSize is the size of a buffer from the classic allocator.
+ */
+static size_t
+classicUserSize(void * address)
+{
+	Slot *	slot;
+	size_t	size;
+
+	lock();
+	Page_AllowAccess(allocationList, allocationListSize);
+	slot = slotForUserAddress(address);
+	if ( slot == 0 || slot->mode != ALLOCATED )
+		EF_Abort("realloc(%a): address not from malloc().", address);
+	size = slot->userSize;
+	Page_DenyAccess(allocationList, allocationListSize);
+	unlock();
+
+	return size;
+}
+
+/*
+ * poolSlot finds the class and the slot of an address in the pool's
+ * slot regions, and checks that it was given out by poolMemalign().
+ */
+static PoolClass *
+poolSlot(void * address, size_t * index, const char * caller)
+{
+	char *		a = (char *)address;
+	PoolClass *	pc = &poolClass[(a - poolStart) / poolRegionSize];
+	size_t		userSize;
+
+	*index = (a - pc->base) / pc->stride;
+	if ( *index >= pc->slots )
+		EF_Abort("%s(%a): address not from malloc().", caller, address);
+
+	userSize = pc->userSize[*index];
+	if ( userSize == SLOT_FREE || userSize == SLOT_PROTECTED )
+		EF_Abort("%s(%a): freeing free memory.", caller, address);
+	if ( poolUserAddress(pc, *index, userSize) != a )
+		EF_Abort("%s(%a): address not from malloc().", caller, address);
+	return pc;
+}
+
+static void *
+poolMemalign(size_t alignment, size_t userSize)
+{
+	PoolCache *	cache = &poolCache;
+	PoolClass *	pc;
+	size_t		index;
+	size_t		pages;
+	size_t		slack;
+	void *		allocation;
+	int		c;
+
+	if ( userSize == 0 && !EF_ALLOW_MALLOC_0 )
+		EF_Abort("Allocating 0 bytes, probably a bug.");
+
+	if ( EF_SAMPLE > 1 && !poolSampled(cache) )
+		return __libc_memalign(alignment, userSize);
+
+	if ( !EF_PROTECT_BELOW && alignment > 1 ) {
+		if ( (slack = userSize % alignment) != 0 )
+			userSize += alignment - slack;
+	}
+
+	pages = (userSize + bytesPerPage - 1) / bytesPerPage;
+	for ( c = 0; c < POOL_CLASSES && ((size_t)1 << c) < pages; c++ )
+		;
+
+	if ( c == POOL_CLASSES || alignment > bytesPerPage
+	 || (cache->count[c] == 0 && !poolRefill(cache, c)) ) {
+		/*
+		 * Too large for a slot, or all slots of this size are in use:
+		 * the classic allocator guards it.
+		 */
+		lock();
+		allocation = efence_memalign(alignment, userSize);
+		unlock();
+		return allocation;
+	}
+
+	pc = &poolClass[c];
+	index = cache->slot[c][--cache->count[c]];
+	pc->userSize[index] = userSize;
+	return poolUserAddress(pc, index, userSize);
+}
+
+static void
+poolFree(void * address)
+{
+	PoolCache *	cache = &poolCache;
+	PoolClass *	pc;
+	size_t		index;
+	int		c;
+
+	if ( address == 0 )
+		return;
+
+	if ( (char *)address < poolStart || (char *)address >= poolEnd ) {
+		__libc_free(address);
+		return;
+	}
+	if ( (char *)address >= poolClassEnd ) {
+		efence_free(address);
+		return;
+	}
+
+	pc = poolSlot(address, &index, "free");
+	c = pc - poolClass;
+
+	if ( EF_FREE_WIPES )
+		memset(address, 0xbd, pc->userSize[index]);
+
+	if ( EF_PROTECT_FREE ) {
+		/* Never used again. */
+		pc->userSize[index] = SLOT_PROTECTED;
+		Page_DenyAccess(poolSlotData(pc, index), pc->pages * bytesPerPage);
+		return;
+	}
+	pc->userSize[index] = SLOT_FREE;
+
+	if ( !cache->registered )
+		poolRegister(cache);
+
+	if ( cache->count[c] == POOL_CACHE_SLOTS ) {
+		pthread_mutex_lock(&poolMutex);
+		while ( cache->count[c] > POOL_CACHE_SLOTS - POOL_BATCH )
+			pc->freeList[pc->freeCount++]
+			 = cache->slot[c][--cache->count[c]];
+		pthread_mutex_unlock(&poolMutex);
+	}
+	cache->slot[c][cache->count[c]++] = index;
+}
+
+static void *
+poolRealloc(void * oldBuffer, size_t newSize)
+{
+	void *	newBuffer;
+	size_t	size;
+
+	if ( oldBuffer == 0 )
+		return poolMemalign(EF_ALIGNMENT, newSize);
+
+	if ( (char *)oldBuffer < poolStart || (char *)oldBuffer >= poolEnd )
+		size = malloc_usable_size(oldBuffer);
+	else if ( (char *)oldBuffer >= poolClassEnd )
+		size = classicUserSize(oldBuffer);
+	else {
+		PoolClass *	pc;
+		size_t		index;
+
+		pc = poolSlot(oldBuffer, &index, "realloc");
+		size = pc->userSize[index];
+	}
+
+	newBuffer = poolMemalign(EF_ALIGNMENT, newSize);
+
+	if ( newSize < size )
+		size = newSize;
+	if ( size > 0 )
+		memcpy(newBuffer, oldBuffer, size);
+	poolFree(oldBuffer);
+
+	if ( size < newSize )
+		memset(&(((char *)newBuffer)[size]), 0, newSize - size);
+
+	return newBuffer;
+}
+
+static void *
+poolCalloc(size_t nelem, size_t elsize)
+{
+	size_t	size = nelem * elsize;
+	void *	allocation;
+
+	if ( elsize != 0 && size / elsize != nelem )
+		EF_Abort("calloc(%d, %d): size overflow."
+		 ,(int)nelem, (int)elsize);
+
+	allocation = poolMemalign(EF_ALIGNMENT, size);
+	memset(allocation, 0, size);
+	return allocation;
+}
+
+
 extern C_LINKAGE void *
 memalign(size_t alignment, size_t userSize)
 {
-    efence_memalign(alignment, userSize);
+	void *	allocation;
+
+	if ( poolEnabled() )
+		return poolMemalign(alignment, userSize);
+
+	lock();
+	allocation = efence_memalign(alignment, userSize);
+	unlock();
+	return allocation;
 }
 
 extern C_LINKAGE void
 free(void * address)
 {
-    efence_free(address);
+	if ( poolEnabled() )
+		poolFree(address);
+	else
+		efence_free(address);
 }
 
 extern C_LINKAGE void *
 realloc(void * oldBuffer, size_t newSize)
 {
-    efence_realloc(oldBuffer, newSize);
+	if ( poolEnabled() )
+		return poolRealloc(oldBuffer, newSize);
+	return efence_realloc(oldBuffer, newSize);
 }
 
 extern C_LINKAGE void *
 malloc(size_t size)
 {
-    efence_malloc(size);
+	if ( poolEnabled() )
+		return poolMemalign(EF_ALIGNMENT, size);
+	return efence_malloc(size);
 }
 
 extern C_LINKAGE void *
 calloc(size_t nelem, size_t elsize)
 {
-    efence_calloc(nelem, elsize);
+	if ( poolEnabled() )
+		return poolCalloc(nelem, elsize);
+	return efence_calloc(nelem, elsize);
 }
 
 extern C_LINKAGE void *
 valloc (size_t size)
 {
-    efence_valloc(size);
+	if ( poolEnabled() )
+		return poolMemalign(bytesPerPage, size);
+	return efence_valloc(size);
 }
-
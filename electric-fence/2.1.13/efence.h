@@ -31,6 +31,7 @@ typedef unsigned long		ef_number;
 
 void			Page_AllowAccess(void * address, size_t size);
 void *			Page_Create(size_t size);
+void *			Page_Reserve(size_t size);
 void			Page_Delete(void * address, size_t size);
 void			Page_DenyAccess(void * address, size_t size);
 size_t			Page_Size(void);
@@ -21,6 +21,10 @@
 #define	MAP_ANONYMOUS	MAP_ANON
 #endif
 
+#ifndef	MAP_NORESERVE
+#define	MAP_NORESERVE	0
+#endif
+
 /*
  * For some reason, I can't find mprotect() in any of the headers on
  * IRIX or SunOS 4.1.2
@@ -136,6 +140,40 @@ Page_Create(size_t size)
 }
 #endif
 
+/*
+ * Reserve address space, which is made accessible later with
+ * Page_AllowAccess(). Until then it is denied access the way that
+ * Page_DenyAccess() does, and uses no memory.
+ */
+#if defined(MAP_ANONYMOUS)
+void *
+Page_Reserve(size_t size)
+{
+	caddr_t		allocation;
+
+	allocation = (caddr_t) mmap(
+	 0
+	,size
+	,PROT_READ
+	,MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE
+	,-1
+	,0);
+
+	if ( allocation == (caddr_t)-1 )
+		EF_Exit("mmap() failed: %s", stringErrorReport());
+	return (void *)allocation;
+}
+#else
+void *
+Page_Reserve(size_t size)
+{
+	void *	allocation = Page_Create(size);
+
+	Page_DenyAccess(allocation, size);
+	return allocation;
+}
+#endif
+
 static void
 mprotectFailed(void)
 {
@@ -113,6 +113,10 @@ static char rcsid[] = "$Id: //DTV/PROD_BR/DTV_X_IDTV1501/apollo/oss/source/gzip/
 #  include <utimens.h>
 #endif
 
+#ifndef NO_PARALLEL
+#  include <sys/wait.h>
+#endif
+
 #define RW_USER (S_IRUSR | S_IWUSR)  /* creation mode for open() */
 
 #ifndef MAX_PATH_LEN
@@ -158,6 +162,14 @@ static char rcsid[] = "$Id: //DTV/PROD_BR/DTV_X_IDTV1501/apollo/oss/source/gzip/
 # define ELOOP EINVAL
 #endif
 
+#ifndef MAX_PROCESSES
+#  define MAX_PROCESSES 32 /* max number of compressing processes (-p) */
+#endif
+
+#ifndef BLOCK_SIZE
+#  define BLOCK_SIZE 1024 /* default -p block size in KiB (--blocksize) */
+#endif
+
 /* Separator for file name parts (see shorten_name()) */
 #ifdef NO_MULTIPLE_DOTS
 #  define PART_SEP "-"
@@ -197,6 +209,8 @@ char *program_name;   /* program name */
 int maxbits = BITS;   /* max bits per code for LZW */
 int method = DEFLATED;/* compression method */
 int level = 6;        /* compression level */
+int processes = 1;    /* number of compressing processes (-p) */
+off_t block_size = (off_t) BLOCK_SIZE << 10; /* input bytes per block (-p) */
 int exit_code = OK;   /* program exit code */
 int save_orig_name;   /* set if original name must be saved */
 int last_member;      /* set for .zip and .Z files */
@@ -232,6 +246,12 @@ unsigned insize;           /* valid bytes in inbuf */
 unsigned inptr;            /* index of next byte to be processed in inbuf */
 unsigned outcnt;           /* bytes in output buffer */
 
+/* Long options without a short equivalent */
+enum
+{
+  BLOCKSIZE_OPTION = CHAR_MAX + 1
+};
+
 struct option longopts[] =
 {
  /* { name  has_arg  *flag  val } */
@@ -251,6 +271,8 @@ struct option longopts[] =
     {"quiet",      0, 0, 'q'}, /* quiet mode */
     {"silent",     0, 0, 'q'}, /* quiet mode */
     {"recursive",  0, 0, 'r'}, /* recurse through directories */
+    {"processes",  1, 0, 'p'}, /* compress on several processes */
+    {"blocksize",  1, 0, BLOCKSIZE_OPTION}, /* input block size for -p */
     {"suffix",     1, 0, 'S'}, /* use given suffix instead of .gz */
     {"test",       0, 0, 't'}, /* test compressed file integrity */
     {"no-time",    0, 0, 'T'}, /* don't save or restore the time stamp */
@@ -285,6 +307,10 @@ local void install_signal_handlers OF((void));
 local void remove_output_file OF((void));
 local RETSIGTYPE abort_gzip_signal OF((int));
 local void do_exit      OF((int exitcode)) ATTRIBUTE_NORETURN;
+local long get_number   OF((char *opt, long min, long max));
+#ifndef NO_PARALLEL
+local int  zip_parallel OF((int in, int out));
+#endif
       int main          OF((int argc, char **argv));
 int (*work) OF((int infile, int outfile)) = zip; /* function to call */
 
@@ -330,6 +356,10 @@ local void help()
  "  -q, --quiet       suppress all warnings",
 #if ! NO_DIR
  "  -r, --recursive   operate recursively on directories",
+#endif
+#ifndef NO_PARALLEL
+ "  -p, --processes=N compress on N processes, in independent blocks",
+ "      --blocksize=KIB  size of those blocks in KiB (default 1024)",
 #endif
  "  -S, --suffix=SUF  use suffix SUF on compressed files",
  "  -t, --test        test compressed file integrity",
@@ -369,6 +399,26 @@ local void version()
     printf ("Written by Jean-loup Gailly.\n");
 }
 
+/* ========================================================================
+ * Return the numeric operand of option opt, which must be in [min, max].
+ */
+local long get_number(opt, min, max)
+    char *opt;
+    long min, max;
+{
+    char *end;
+    long n;
+
+    errno = 0;
+    n = strtol(optarg, &end, 10);
+    if (errno || end == optarg || *end || n < min || max < n) {
+	fprintf (stderr, "%s: %s operand must be between %ld and %ld\n",
+		 program_name, opt, min, max);
+	try_help ();
+    }
+    return n;
+}
+
 local void progerror (string)
     char *string;
 {
@@ -423,7 +473,7 @@ int main (argc, argv)
     z_suffix = Z_SUFFIX;
     z_len = strlen(z_suffix);
 
-    while ((optc = getopt_long (argc, argv, "ab:cdfhH?lLmMnNqrS:tvVZ123456789",
+    while ((optc = getopt_long (argc, argv, "ab:cdfhH?lLmMnNp:qrS:tvVZ123456789",
 				longopts, (int *)0)) != -1) {
 	switch (optc) {
         case 'a':
@@ -458,6 +508,18 @@ int main (argc, argv)
 	    no_name = no_time = 1; break;
 	case 'N':
 	    no_name = no_time = 0; break;
+	case 'p':
+#ifndef NO_PARALLEL
+	    processes = (int) get_number("-p", 1, MAX_PROCESSES);
+#else
+	    fprintf(stderr, "%s: -p not supported in this version\n",
+		    program_name);
+	    try_help ();
+#endif
+	    break;
+	case BLOCKSIZE_OPTION:
+	    block_size = (off_t) get_number("--blocksize", 32, 1L << 20) << 10;
+	    break;
 	case 'q':
 	    quiet = 1; verbose = 0; break;
 	case 'r':
@@ -803,6 +865,13 @@ local void treat_file(iname)
 	fprintf(stderr, "%s:\t", ifname);
     }
 
+#ifndef NO_PARALLEL
+    if (processes > 1 && work == zip && S_ISREG (istat.st_mode)
+	&& ifile_size > block_size) {
+	if (zip_parallel(ifd, ofd) != OK)
+	    method = -1; /* force cleanup */
+    } else
+#endif
     /* Actually do the compression/decompression. Loop over zipped members.
      */
     for (;;) {
@@ -869,6 +938,192 @@ local void treat_file(iname)
     }
 }
 
+#ifndef NO_PARALLEL
+/* A block which is being compressed by a child process */
+struct zip_block {
+    pid_t pid;     /* compressing process, 0 if none */
+    FILE *tmp;     /* compressed member, read back once the child is done */
+};
+
+/* ========================================================================
+ * Copy bytes [start, start+len) of the input file into the pipe fd.
+ * Runs in its own process, so that the compressing child can read its
+ * block as if it were a whole file.  Return OK or ERROR.
+ */
+local int feed_block(in, fd, start, len)
+    int in, fd;
+    off_t start, len;
+{
+    ssize_t n;
+
+    while (len > 0) {
+	n = pread(in, inbuf, len < INBUFSIZ ? (size_t) len : INBUFSIZ, start);
+	if (n <= 0)
+	    return ERROR;
+	write_buf(fd, inbuf, (unsigned) n);
+	start += n;
+	len -= n;
+    }
+    return OK;
+}
+
+/* ========================================================================
+ * Compress one block into b->tmp on a child process.  The first block
+ * carries the original name; the others are bare members.
+ */
+local int start_block(b, in, start, len)
+    struct zip_block *b;
+    int in;
+    off_t start, len;
+{
+    int fd[2];
+    int status;
+    pid_t feeder;
+
+    if ((b->tmp = tmpfile()) == NULL) {
+	progerror("tmpfile");
+	return ERROR;
+    }
+    b->pid = fork();
+    if (b->pid < 0) {
+	progerror("fork");
+	b->pid = 0;
+	fclose(b->tmp);
+	b->tmp = NULL;
+	return ERROR;
+    }
+    if (b->pid > 0)
+	return OK;
+
+    /* The child must never remove the output of its parent */
+    remove_ofname_fd = -1;
+    if (pipe(fd) != 0) {
+	progerror("pipe");
+	_exit(ERROR);
+    }
+    feeder = fork();
+    if (feeder < 0) {
+	progerror("fork");
+	_exit(ERROR);
+    }
+    if (feeder == 0) {
+	close(fd[0]);
+	_exit(feed_block(in, fd[1], start, len));
+    }
+    close(fd[1]);
+
+    clear_bufs();
+    if (start != 0) save_orig_name = 0;
+    exit_code = zip(fd[0], fileno(b->tmp));
+    close(fd[0]);
+
+    if (waitpid(feeder, &status, 0) != feeder
+	|| !WIFEXITED(status) || WEXITSTATUS(status) != OK) {
+	read_error();
+    }
+    _exit(exit_code);
+}
+
+/* ========================================================================
+ * Wait for the child compressing b and, if out is not negative, append
+ * its member to out.  Return OK or ERROR.
+ */
+local int finish_block(b, out)
+    struct zip_block *b;
+    int out;
+{
+    int status;
+    int n;
+    int err = OK;
+
+    if (b->pid) {
+	if (waitpid(b->pid, &status, 0) != b->pid
+	    || !WIFEXITED(status) || WEXITSTATUS(status) != OK)
+	    err = ERROR;
+	b->pid = 0;
+    }
+    if (b->tmp == NULL)
+	return ERROR;
+
+    if (out >= 0 && err == OK) {
+	if (lseek(fileno(b->tmp), (off_t) 0, SEEK_SET) != 0) {
+	    progerror("tmpfile");
+	    err = ERROR;
+	} else {
+	    while ((n = read(fileno(b->tmp), outbuf, OUTBUFSIZ)) > 0) {
+		write_buf(out, outbuf, (unsigned) n);
+		bytes_out += n;
+	    }
+	    if (n < 0) {
+		progerror("tmpfile");
+		err = ERROR;
+	    }
+	}
+    }
+    fclose(b->tmp);
+    b->tmp = NULL;
+    return err;
+}
+
+/* ========================================================================
+ * Compress the regular file in into out on several processes.
+ * The input is cut into blocks of block_size bytes which are compressed
+ * independently into gzip members of their own; a sequence of members
+ * is a valid gzip file which any gunzip expands in one go.  Up to
+ * processes blocks are in flight, and they are written out in order.
+ * Return OK or ERROR.
+ */
+local int zip_parallel(in, out)
+    int in, out;
+{
+    struct zip_block blocks[MAX_PROCESSES];
+    off_t start = 0;
+    off_t len;
+    int next = 0;   /* slot of the oldest block in flight */
+    int running = 0;
+    int err = OK;
+    int i;
+
+    memset(blocks, 0, sizeof(blocks));
+    /* Do not let the children flush what is buffered here */
+    fflush(stdout);
+    fflush(stderr);
+
+    while (err == OK && (start < ifile_size || running)) {
+	if (start < ifile_size && running < processes) {
+	    len = ifile_size - start;
+	    if (len > block_size) len = block_size;
+	    i = (next + running) % processes;
+	    if (start_block(&blocks[i], in, start, len) != OK) {
+		err = ERROR;
+		break;
+	    }
+	    running++;
+	    start += len;
+	    continue;
+	}
+	err = finish_block(&blocks[next], out);
+	next = (next + 1) % processes;
+	running--;
+    }
+
+    /* Reap what is left after an error */
+    while (running--) {
+	if (blocks[next].pid)
+	    kill(blocks[next].pid, SIGTERM);
+	finish_block(&blocks[next], -1);
+	next = (next + 1) % processes;
+    }
+
+    bytes_in = ifile_size;
+    /* Each member has its own header; none is counted as overhead */
+    header_bytes = 0;
+    if (err != OK)
+	exit_code = ERROR;
+    return err;
+}
+#endif /* NO_PARALLEL */
+
 /* ========================================================================
  * Create the output file. Return OK or ERROR.
  * Try several times if necessary to avoid truncating the z_suffix. For
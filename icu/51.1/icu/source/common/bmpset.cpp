@@ -1,7 +1,7 @@
 /*
 ******************************************************************************
 *
-*   Copyright (C) 2007-2012, International Business Machines
+*   Copyright (C) 2007-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 ******************************************************************************
@@ -56,9 +56,48 @@ BMPSet::BMPSet(const BMPSet &otherBMPSet, const int32_t *newParentList, int32_t
     uprv_memcpy(list4kStarts, otherBMPSet.list4kStarts, sizeof(list4kStarts));
 }
 
+BMPSet::BMPSet(const int32_t *bits, const int32_t *parentList, int32_t parentListLength) :
+        list(parentList), listLength(parentListLength) {
+    const uint8_t *p=(const uint8_t *)bits;
+    uprv_memcpy(asciiBytes, p, sizeof(asciiBytes));
+    p+=sizeof(asciiBytes);
+    uprv_memcpy(table7FF, p, sizeof(table7FF));
+    p+=sizeof(table7FF);
+    uprv_memcpy(bmpBlockBits, p, sizeof(bmpBlockBits));
+    p+=sizeof(bmpBlockBits);
+    uprv_memcpy(list4kStarts, p, sizeof(list4kStarts));
+}
+
 BMPSet::~BMPSet() {
 }
 
+void BMPSet::serializeBits(int32_t *dest) const {
+    uint8_t *p=(uint8_t *)dest;
+    uprv_memcpy(p, asciiBytes, sizeof(asciiBytes));
+    p+=sizeof(asciiBytes);
+    uprv_memcpy(p, table7FF, sizeof(table7FF));
+    p+=sizeof(table7FF);
+    uprv_memcpy(p, bmpBlockBits, sizeof(bmpBlockBits));
+    p+=sizeof(bmpBlockBits);
+    uprv_memcpy(p, list4kStarts, sizeof(list4kStarts));
+}
+
+UBool BMPSet::isValidSerializedBits(const int32_t *bits, int32_t parentListLength) {
+    U_ASSERT(sizeof(asciiBytes)+sizeof(table7FF)+sizeof(bmpBlockBits)+sizeof(list4kStarts)==
+             SERIALIZED_LENGTH*4);
+    // The list4kStarts are the only values that are used as indexes.
+    // They must be ascending indexes into the parent list.
+    const int32_t *starts=bits+SERIALIZED_LENGTH-18;
+    int32_t prev=0;
+    for(int32_t i=0; i<18; ++i) {
+        if(starts[i]<prev || starts[i]>=parentListLength) {
+            return FALSE;
+        }
+        prev=starts[i];
+    }
+    return starts[0x11]==parentListLength-1;
+}
+
 /*
  * Set bits in a bit rectangle in "vertical" bit organization.
  * start<limit<=0x800
@@ -36,8 +36,28 @@ class BMPSet : public UMemory {
 public:
     BMPSet(const int32_t *parentList, int32_t parentListLength);
     BMPSet(const BMPSet &otherBMPSet, const int32_t *newParentList, int32_t newParentListLength);
+    /*
+     * Constructs a BMPSet from the bit tables written by serializeBits(),
+     * for UnicodeSet::createFromFrozen().
+     * The caller must have checked the data with isValidSerializedBits().
+     */
+    BMPSet(const int32_t *bits, const int32_t *parentList, int32_t parentListLength);
     virtual ~BMPSet();
 
+    /* Number of 32-bit integers written by serializeBits(). */
+    enum { SERIALIZED_LENGTH = (0xc0 / 4) + 64 + 64 + 18 };
+
+    /*
+     * Writes the bit tables into dest[0..SERIALIZED_LENGTH-1].
+     */
+    void serializeBits(int32_t *dest) const;
+
+    /*
+     * Returns TRUE if the serialized bit tables can be used with
+     * a parent list of the given length.
+     */
+    static UBool isValidSerializedBits(const int32_t *bits, int32_t parentListLength);
+
     virtual UBool contains(UChar32 c) const;
 
     /*
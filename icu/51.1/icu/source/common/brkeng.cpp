@@ -1,6 +1,6 @@
 /*
  ************************************************************************************
- * Copyright (C) 2006-2012, International Business Machines Corporation
+ * Copyright (C) 2006-2013, International Business Machines Corporation
  * and others. All Rights Reserved.
  ************************************************************************************
  */
@@ -27,6 +27,9 @@
 #include "umutex.h"
 #include "uresimp.h"
 #include "ubrkimpl.h"
+#include "udatamem.h"
+#include "umapfile.h"
+#include "cstring.h"
 
 U_NAMESPACE_BEGIN
 
@@ -276,6 +279,74 @@ ICULanguageBreakFactory::loadEngineFor(UChar32 c, int32_t breakType) {
     return NULL;
 }
 
+static UBool U_CALLCONV
+isDictionaryAcceptable(void * /*context*/,
+                       const char * /*type*/, const char * /*name*/,
+                       const UDataInfo *pInfo) {
+    return
+        pInfo->size>=20 &&
+        pInfo->isBigEndian==U_IS_BIG_ENDIAN &&
+        pInfo->charsetFamily==U_CHARSET_FAMILY &&
+        pInfo->dataFormat[0]==0x44 &&   // dataFormat="Dict"
+        pInfo->dataFormat[1]==0x69 &&
+        pInfo->dataFormat[2]==0x63 &&
+        pInfo->dataFormat[3]==0x74 &&
+        pInfo->formatVersion[0]==1;
+}
+
+/*
+ * Map a compiled (gendict) dictionary file from the directory named by the
+ * ICU_DICTIONARY_DIR environment variable, if it is set.
+ * The file is mapped read-only and shared, so all processes using the same
+ * file share its pages, and only the parts of the trie that are actually
+ * visited are ever read in.
+ * Returns NULL if there is no such directory or no acceptable file in it;
+ * the caller then falls back to the dictionary in the ICU data.
+ */
+static UDataMemory *
+openMappedDictionary(const char *name, const char *ext, UErrorCode &status) {
+#if !UCONFIG_NO_FILE_IO && !defined(ICU_NO_USER_DATA_OVERRIDE)
+    const char *dir = getenv("ICU_DICTIONARY_DIR");
+    if (U_FAILURE(status) || dir == NULL || *dir == 0) {
+        return NULL;
+    }
+    CharString path(dir, status);
+    if (path[path.length() - 1] != U_FILE_SEP_CHAR) {
+        path.append(U_FILE_SEP_CHAR, status);
+    }
+    path.append(name, status);
+    if (*ext != 0) {
+        path.append('.', status).append(ext, status);
+    }
+    UDataMemory mapped;
+    UDataMemory_init(&mapped);
+    if (U_FAILURE(status) || !uprv_mapFile(&mapped, path.data())) {
+        return NULL;
+    }
+    const DataHeader *pHeader = mapped.pHeader;
+    if (pHeader->dataHeader.magic1 != 0xda || pHeader->dataHeader.magic2 != 0x27 ||
+            !isDictionaryAcceptable(NULL, ext, name, &pHeader->info)) {
+        udata_close(&mapped);
+        return NULL;
+    }
+    UDataMemory *file = UDataMemory_createNewInstance(&status);
+    if (U_FAILURE(status)) {
+        udata_close(&mapped);
+        return NULL;
+    }
+    // Hand off the mapping; udata_close(file) unmaps it.
+    file->pHeader = pHeader;
+    file->mapAddr = mapped.mapAddr;
+    file->map     = mapped.map;
+    return file;
+#else
+    (void)name;
+    (void)ext;
+    (void)status;
+    return NULL;
+#endif
+}
+
 DictionaryMatcher *
 ICULanguageBreakFactory::loadDictionaryMatcherFor(UScriptCode script, int32_t /* brkType */) { 
     UErrorCode status = U_ZERO_ERROR;
@@ -300,7 +371,10 @@ ICULanguageBreakFactory::loadDictionaryMatcherFor(UScriptCode script, int32_t /*
     dictnbuf.appendInvariantChars(UnicodeString(FALSE, dictfname, dictnlength), status);
     ures_close(b);
 
-    UDataMemory *file = udata_open(U_ICUDATA_BRKITR, ext.data(), dictnbuf.data(), &status);
+    UDataMemory *file = openMappedDictionary(dictnbuf.data(), ext.data(), status);
+    if (file == NULL) {
+        file = udata_open(U_ICUDATA_BRKITR, ext.data(), dictnbuf.data(), &status);
+    }
     if (U_SUCCESS(status)) {
         // build trie
         const uint8_t *data = (const uint8_t *)udata_getMemory(file);
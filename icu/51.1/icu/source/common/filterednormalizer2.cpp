@@ -23,6 +23,7 @@
 #include "unicode/unistr.h"
 #include "unicode/unorm.h"
 #include "cpputils.h"
+#include "ustrarena.h"
 
 U_NAMESPACE_BEGIN
 
@@ -42,6 +43,7 @@ FilteredNormalizer2::normalize(const UnicodeString &src,
         return dest;
     }
     dest.remove();
+    UnicodeStringArena arena;  // for tempDest
     return normalize(src, dest, USET_SPAN_SIMPLE, errorCode);
 }
 
@@ -87,6 +89,7 @@ UnicodeString &
 FilteredNormalizer2::normalizeSecondAndAppend(UnicodeString &first,
                                               const UnicodeString &second,
                                               UErrorCode &errorCode) const {
+    UnicodeStringArena arena;  // for the prefix, middle and rest strings
     return normalizeSecondAndAppend(first, second, TRUE, errorCode);
 }
 
@@ -94,6 +97,7 @@ UnicodeString &
 FilteredNormalizer2::append(UnicodeString &first,
                             const UnicodeString &second,
                             UErrorCode &errorCode) const {
+    UnicodeStringArena arena;  // for the prefix, middle and rest strings
     return normalizeSecondAndAppend(first, second, FALSE, errorCode);
 }
 
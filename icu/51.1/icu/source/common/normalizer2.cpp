@@ -28,6 +28,8 @@
 #include "normalizer2impl.h"
 #include "ucln_cmn.h"
 #include "uhash.h"
+#include "usimd.h"
+#include "ustrarena.h"
 
 U_NAMESPACE_BEGIN
 
@@ -139,16 +141,23 @@ public:
             dest.setToBogus();
             return dest;
         }
+        int32_t length=src.length();
+        if(usimd_spanUCharsBelow(sArray, length, getMinLookupCP())==length) {
+            // Nothing to look up: src is already normalized.
+            return dest=src;
+        }
         dest.remove();
         ReorderingBuffer buffer(impl, dest);
-        if(buffer.init(src.length(), errorCode)) {
-            normalize(sArray, sArray+src.length(), buffer, errorCode);
+        if(buffer.init(length, errorCode)) {
+            normalize(sArray, sArray+length, buffer, errorCode);
         }
         return dest;
     }
     virtual void
     normalize(const UChar *src, const UChar *limit,
               ReorderingBuffer &buffer, UErrorCode &errorCode) const = 0;
+    // Code points below this one are normalized and never interact with their neighbors.
+    virtual UChar32 getMinLookupCP() const = 0;
 
     // normalize and append
     virtual UnicodeString &
@@ -179,6 +188,8 @@ public:
         }
         int32_t firstLength=first.length();
         UnicodeString safeMiddle;
+        // for the Normalizer2Impl::...AndAppend() middle strings
+        UnicodeStringArena arena;
         {
             ReorderingBuffer buffer(impl, first);
             if(buffer.init(firstLength+second.length(), errorCode)) {
@@ -290,6 +301,7 @@ private:
         impl.decompose(src, limit, &buffer, errorCode);
     }
     using Normalizer2WithImpl::normalize;  // Avoid warning about hiding base class function.
+    virtual UChar32 getMinLookupCP() const { return impl.getMinDecompNoCP(); }
     virtual void
     normalizeAndAppend(const UChar *src, const UChar *limit, UBool doNormalize,
                        UnicodeString &safeMiddle,
@@ -324,6 +336,7 @@ private:
         impl.compose(src, limit, onlyContiguous, TRUE, buffer, errorCode);
     }
     using Normalizer2WithImpl::normalize;  // Avoid warning about hiding base class function.
+    virtual UChar32 getMinLookupCP() const { return impl.getMinCompNoMaybeCP(); }
     virtual void
     normalizeAndAppend(const UChar *src, const UChar *limit, UBool doNormalize,
                        UnicodeString &safeMiddle,
@@ -397,6 +410,7 @@ private:
         impl.makeFCD(src, limit, &buffer, errorCode);
     }
     using Normalizer2WithImpl::normalize;  // Avoid warning about hiding base class function.
+    virtual UChar32 getMinLookupCP() const { return Normalizer2Impl::MIN_CCC_LCCC_CP; }
     virtual void
     normalizeAndAppend(const UChar *src, const UChar *limit, UBool doNormalize,
                        UnicodeString &safeMiddle,
@@ -28,6 +28,7 @@
 #include "putilimp.h"
 #include "uassert.h"
 #include "uset_imp.h"
+#include "usimd.h"
 #include "utrie2.h"
 #include "uvector.h"
 
@@ -446,7 +447,9 @@ Normalizer2Impl::decompose(const UChar *src, const UChar *limit,
 
     for(;;) {
         // count code units below the minimum or with irrelevant data for the quick check
-        for(prevSrc=src; src!=limit;) {
+        prevSrc=src;
+        src+=usimd_spanUCharsBelow(src, (int32_t)(limit-src), minNoCP);
+        while(src!=limit) {
             if( (c=*src)<minNoCP ||
                 isMostDecompYesAndZeroCC(norm16=UTRIE2_GET16_FROM_U16_SINGLE_LEAD(normTrie, c))
             ) {
@@ -1065,7 +1068,9 @@ Normalizer2Impl::compose(const UChar *src, const UChar *limit,
 
     for(;;) {
         // count code units below the minimum or with irrelevant data for the quick check
-        for(prevSrc=src; src!=limit;) {
+        prevSrc=src;
+        src+=usimd_spanUCharsBelow(src, (int32_t)(limit-src), minNoMaybeCP);
+        while(src!=limit) {
             if( (c=*src)<minNoMaybeCP ||
                 isCompYesAndZeroCC(norm16=UTRIE2_GET16_FROM_U16_SINGLE_LEAD(normTrie, c))
             ) {
@@ -1309,7 +1314,9 @@ Normalizer2Impl::composeQuickCheck(const UChar *src, const UChar *limit,
 
     for(;;) {
         // count code units below the minimum or with irrelevant data for the quick check
-        for(prevSrc=src;;) {
+        prevSrc=src;
+        src+=usimd_spanUCharsBelow(src, (int32_t)(limit-src), minNoMaybeCP);
+        for(;;) {
             if(src==limit) {
                 return src;
             }
@@ -229,6 +229,11 @@ public:
 
     const UTrie2 *getNormTrie() const { return normTrie; }
 
+    // Text with only code units below these is already normalized
+    // in the decomposition or composition modes, respectively.
+    UChar32 getMinDecompNoCP() const { return minDecompNoCP; }
+    UChar32 getMinCompNoMaybeCP() const { return minCompNoMaybeCP; }
+
     UBool ensureCanonIterData(UErrorCode &errorCode) const;
 
     uint16_t getNorm16(UChar32 c) const { return UTRIE2_GET16(normTrie, c); }
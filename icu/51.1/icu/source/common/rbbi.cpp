@@ -21,6 +21,7 @@
 #include "unicode/uchriter.h"
 #include "unicode/udata.h"
 #include "unicode/uclean.h"
+#include "rbbicache.h"
 #include "rbbidata.h"
 #include "rbbirb.h"
 #include "cmemory.h"
@@ -208,6 +209,8 @@ RuleBasedBreakIterator::~RuleBasedBreakIterator() {
         uprv_free(fCachedBreakPositions);
         fCachedBreakPositions = NULL;
     }
+    delete fBoundaryCache;
+    fBoundaryCache = NULL;
     if (fLanguageBreakEngines) {
         delete fLanguageBreakEngines;
         fLanguageBreakEngines = NULL;
@@ -228,6 +231,9 @@ RuleBasedBreakIterator::operator=(const RuleBasedBreakIterator& that) {
         return *this;
     }
     reset();    // Delete break cache information
+    if (fBoundaryCache != NULL) {
+        fBoundaryCache->clear();
+    }
     fBreakType = that.fBreakType;
     if (fLanguageBreakEngines != NULL) {
         delete fLanguageBreakEngines;
@@ -289,6 +295,7 @@ void RuleBasedBreakIterator::init() {
     fUnhandledBreakEngine    = NULL;
     fNumCachedBreakPositions = 0;
     fPositionInCache         = 0;
+    fBoundaryCache           = new RBBIBoundaryCache;   // NULL just disables the cache.
 
 #ifdef RBBI_DEBUG
     static UBool debugInitDone = FALSE;
@@ -363,6 +370,9 @@ void RuleBasedBreakIterator::setText(UText *ut, UErrorCode &status) {
         return;
     }
     reset();
+    if (fBoundaryCache != NULL) {
+        fBoundaryCache->clear();
+    }
     fText = utext_clone(fText, ut, FALSE, TRUE, &status);
 
     // Set up a dummy CharacterIterator to be returned if anyone
@@ -445,6 +455,9 @@ RuleBasedBreakIterator::adoptText(CharacterIterator* newText) {
     fCharIter = newText;
     UErrorCode status = U_ZERO_ERROR;
     reset();
+    if (fBoundaryCache != NULL) {
+        fBoundaryCache->clear();
+    }
     if (newText==NULL || newText->startIndex() != 0) {   
         // startIndex !=0 wants to be an error, but there's no way to report it.
         // Make the iterator text be an empty string.
@@ -464,6 +477,9 @@ void
 RuleBasedBreakIterator::setText(const UnicodeString& newText) {
     UErrorCode status = U_ZERO_ERROR;
     reset();
+    if (fBoundaryCache != NULL) {
+        fBoundaryCache->clear();
+    }
     fText = utext_openConstUnicodeString(fText, &newText, &status);
 
     // Set up a character iterator on the string.  
@@ -530,6 +546,9 @@ int32_t RuleBasedBreakIterator::first(void) {
     //    return BreakIterator::DONE;
 
     utext_setNativeIndex(fText, 0);
+    if (fBoundaryCache != NULL) {
+        fBoundaryCache->setBoundary(0, fLastRuleStatusIndex);
+    }
     return 0;
 }
 
@@ -548,6 +567,9 @@ int32_t RuleBasedBreakIterator::last(void) {
     fLastStatusIndexValid = FALSE;
     int32_t pos = (int32_t)utext_nativeLength(fText);
     utext_setNativeIndex(fText, pos);
+    if (fBoundaryCache != NULL) {
+        fBoundaryCache->setBoundary(pos, RBBIBoundaryCache::UNKNOWN_STATUS);
+    }
     return pos;
 }
 
@@ -578,6 +600,20 @@ int32_t RuleBasedBreakIterator::next(int32_t n) {
  * @return The position of the first boundary after this one.
  */
 int32_t RuleBasedBreakIterator::next(void) {
+    int32_t pos, statusIdx;
+    if (fBoundaryCache != NULL && fBoundaryCache->next(pos, statusIdx)) {
+        return setCachedPosition(pos, statusIdx);
+    }
+
+    int32_t startPos = current();
+    int32_t result   = computeNext();
+    if (fBoundaryCache != NULL && result != BreakIterator::DONE) {
+        fBoundaryCache->addFollowing(startPos, result, getCachedStatusIdx());
+    }
+    return result;
+}
+
+int32_t RuleBasedBreakIterator::computeNext(void) {
     // if we have cached break positions and we're still in the range
     // covered by them, just move one step forward in the cache
     if (fCachedBreakPositions != NULL) {
@@ -605,6 +641,20 @@ int32_t RuleBasedBreakIterator::next(void) {
  * @return The position of the last boundary position preceding this one.
  */
 int32_t RuleBasedBreakIterator::previous(void) {
+    int32_t pos, statusIdx;
+    if (fBoundaryCache != NULL && fBoundaryCache->previous(pos, statusIdx)) {
+        return setCachedPosition(pos, statusIdx);
+    }
+
+    int32_t startPos = current();
+    int32_t result   = computePrevious();
+    if (fBoundaryCache != NULL && result != BreakIterator::DONE) {
+        fBoundaryCache->addPreceding(startPos, result, getCachedStatusIdx());
+    }
+    return result;
+}
+
+int32_t RuleBasedBreakIterator::computePrevious(void) {
     int32_t result;
     int32_t startPos;
 
@@ -667,7 +717,7 @@ int32_t RuleBasedBreakIterator::previous(void) {
     // point is our return value
 
     for (;;) {
-        result         = next();
+        result         = computeNext();
         if (result == BreakIterator::DONE || result >= start) {
             break;
         }
@@ -702,6 +752,28 @@ int32_t RuleBasedBreakIterator::previous(void) {
  * @return The position of the first break after the current position.
  */
 int32_t RuleBasedBreakIterator::following(int32_t offset) {
+    int32_t pos, statusIdx;
+    if (fBoundaryCache != NULL) {
+        if (fBoundaryCache->following(offset, pos, statusIdx)) {
+            return setCachedPosition(pos, statusIdx);
+        }
+        if (fBoundaryCache->seek(offset, statusIdx)) {
+            // offset is the last cached boundary; the answer is the one after it.
+            setCachedPosition(offset, statusIdx);
+            return next();
+        }
+    }
+
+    int32_t result = computeFollowing(offset);
+    if (fBoundaryCache != NULL) {
+        // At the end of the text, the status is that of the failed next() call.
+        fBoundaryCache->setBoundary(current(), result == BreakIterator::DONE ?
+            (int32_t)RBBIBoundaryCache::UNKNOWN_STATUS : getCachedStatusIdx());
+    }
+    return result;
+}
+
+int32_t RuleBasedBreakIterator::computeFollowing(int32_t offset) {
     // if we have cached break positions and offset is in the range
     // covered by them, use them
     // TODO: could use binary search
@@ -730,7 +802,7 @@ int32_t RuleBasedBreakIterator::following(int32_t offset) {
     fLastStatusIndexValid = TRUE;
     if (fText == NULL || offset >= utext_nativeLength(fText)) {
         last();
-        return next();
+        return computeNext();
     }
     else if (offset < 0) {
         return first();
@@ -751,9 +823,9 @@ int32_t RuleBasedBreakIterator::following(int32_t offset) {
         (void)UTEXT_NEXT32(fText);
         // handlePrevious will move most of the time to < 1 boundary away
         handlePrevious(fData->fSafeRevTable);
-        int32_t result = next();
+        int32_t result = computeNext();
         while (result <= offset) {
-            result = next();
+            result = computeNext();
         }
         return result;
     }
@@ -766,17 +838,17 @@ int32_t RuleBasedBreakIterator::following(int32_t offset) {
         // previous will give result 0 or 1 boundary away from offset,
         // most of the time
         // we have to
-        int32_t oldresult = previous();
+        int32_t oldresult = computePrevious();
         while (oldresult > offset) {
-            int32_t result = previous();
+            int32_t result = computePrevious();
             if (result <= offset) {
                 return oldresult;
             }
             oldresult = result;
         }
-        int32_t result = next();
+        int32_t result = computeNext();
         if (result <= offset) {
-            return next();
+            return computeNext();
         }
         return result;
     }
@@ -792,12 +864,12 @@ int32_t RuleBasedBreakIterator::following(int32_t offset) {
     utext_setNativeIndex(fText, offset);
     if (offset==0 || 
         (offset==1  && utext_getNativeIndex(fText)==0)) {
-        return next();
+        return computeNext();
     }
-    result = previous();
+    result = computePrevious();
 
     while (result != BreakIterator::DONE && result <= offset) {
-        result = next();
+        result = computeNext();
     }
 
     return result;
@@ -810,6 +882,27 @@ int32_t RuleBasedBreakIterator::following(int32_t offset) {
  * @return The position of the last boundary before the starting position.
  */
 int32_t RuleBasedBreakIterator::preceding(int32_t offset) {
+    int32_t pos, statusIdx;
+    if (fBoundaryCache != NULL) {
+        if (fBoundaryCache->preceding(offset, pos, statusIdx)) {
+            return setCachedPosition(pos, statusIdx);
+        }
+        if (fBoundaryCache->seek(offset, statusIdx)) {
+            // offset is the first cached boundary; the answer is the one before it.
+            setCachedPosition(offset, statusIdx);
+            return previous();
+        }
+    }
+
+    int32_t result = computePreceding(offset);
+    if (fBoundaryCache != NULL) {
+        fBoundaryCache->setBoundary(current(), result == BreakIterator::DONE ?
+            (int32_t)RBBIBoundaryCache::UNKNOWN_STATUS : getCachedStatusIdx());
+    }
+    return result;
+}
+
+int32_t RuleBasedBreakIterator::computePreceding(int32_t offset) {
     // if we have cached break positions and offset is in the range
     // covered by them, use them
     if (fCachedBreakPositions != NULL) {
@@ -873,7 +966,7 @@ int32_t RuleBasedBreakIterator::preceding(int32_t offset) {
         handleNext(fData->fSafeFwdTable);
         int32_t result = (int32_t)UTEXT_GETNATIVEINDEX(fText);
         while (result >= offset) {
-            result = previous();
+            result = computePrevious();
         }
         return result;
     }
@@ -892,24 +985,24 @@ int32_t RuleBasedBreakIterator::preceding(int32_t offset) {
         // next will give result 0 or 1 boundary away from offset,
         // most of the time
         // we have to
-        int32_t oldresult = next();
+        int32_t oldresult = computeNext();
         while (oldresult < offset) {
-            int32_t result = next();
+            int32_t result = computeNext();
             if (result >= offset) {
                 return oldresult;
             }
             oldresult = result;
         }
-        int32_t result = previous();
+        int32_t result = computePrevious();
         if (result >= offset) {
-            return previous();
+            return computePrevious();
         }
         return result;
     }
 
     // old rule syntax
     utext_setNativeIndex(fText, offset);
-    return previous();
+    return computePrevious();
 }
 
 /**
@@ -1416,6 +1509,41 @@ RuleBasedBreakIterator::reset()
 }
 
 
+//-------------------------------------------------------------------------------
+//
+//   setCachedPosition()   Move to a boundary that came from the boundary cache.
+//                         Any dictionary break cache is kept in step with the
+//                         new position, or dropped if the position is outside of it.
+//
+//-------------------------------------------------------------------------------
+int32_t RuleBasedBreakIterator::setCachedPosition(int32_t pos, int32_t statusIdx) {
+    if (fCachedBreakPositions != NULL) {
+        int32_t i = 0;
+        while (i < fNumCachedBreakPositions && fCachedBreakPositions[i] < pos) {
+            ++i;
+        }
+        if (i < fNumCachedBreakPositions && fCachedBreakPositions[i] == pos) {
+            fPositionInCache = i;
+        } else {
+            reset();
+        }
+    }
+    if (statusIdx == RBBIBoundaryCache::UNKNOWN_STATUS) {
+        fLastRuleStatusIndex  = 0;
+        fLastStatusIndexValid = FALSE;
+    } else {
+        fLastRuleStatusIndex  = statusIdx;
+        fLastStatusIndexValid = TRUE;
+    }
+    utext_setNativeIndex(fText, pos);
+    return pos;
+}
+
+int32_t RuleBasedBreakIterator::getCachedStatusIdx(void) const {
+    return fLastStatusIndexValid ? fLastRuleStatusIndex : (int32_t)RBBIBoundaryCache::UNKNOWN_STATUS;
+}
+
+
 
 //-------------------------------------------------------------------------------
 //
@@ -1444,7 +1572,11 @@ void RuleBasedBreakIterator::makeRuleStatusValid() {
             if (fNumCachedBreakPositions > 0) {
                 reset();                // Blow off the dictionary cache
             }
-            int32_t pb = next();
+            // Run the rules forward, even if the boundary is cached.
+            int32_t pb = computeNext();
+            if (fBoundaryCache != NULL) {
+                fBoundaryCache->setBoundary(pb, fLastRuleStatusIndex);
+            }
             if (pa != pb) {
                 // note: the if (pa != pb) test is here only to eliminate warnings for
                 //       unused local variables on gcc.  Logically, it isn't needed.
@@ -1773,10 +1905,10 @@ int32_t RuleBasedBreakIterator::checkDictionary(int32_t startPos,
             // proposed break by one of the breaks we found. Use following() and
             // preceding() to do the work. They should never recurse in this case.
             if (reverse) {
-                return preceding(endPos);
+                return computePreceding(endPos);
             }
             else {
-                return following(startPos);
+                return computeFollowing(startPos);
             }
         }
         // If the allocation failed, just fall through to the "no breaks found" case.
@@ -1934,6 +2066,9 @@ RuleBasedBreakIterator::getLanguageBreakEngine(UChar32 c) {
 void RuleBasedBreakIterator::setBreakType(int32_t type) {
     fBreakType = type;
     reset();
+    if (fBoundaryCache != NULL) {
+        fBoundaryCache->clear();
+    }
 }
 
 U_NAMESPACE_END
@@ -0,0 +1,207 @@
+/*
+***************************************************************************
+*   Copyright (C) 2013 International Business Machines Corporation        *
+*   and others. All rights reserved.                                      *
+***************************************************************************
+*/
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_BREAK_ITERATION
+
+#include "rbbicache.h"
+
+U_NAMESPACE_BEGIN
+
+RBBIBoundaryCache::RBBIBoundaryCache() {
+    clear();
+}
+
+void RBBIBoundaryCache::clear() {
+    fStart   = 0;
+    fLength  = 0;
+    fCurrent = -1;
+}
+
+//-------------------------------------------------------------------------------
+//
+//   Lookups.  Indexes are logical, 0 being the lowest cached boundary.
+//
+//-------------------------------------------------------------------------------
+
+// Index of the last boundary at or before offset, or -1 if offset precedes the cache.
+int32_t RBBIBoundaryCache::search(int32_t offset) const {
+    // Queries usually land on or next to the current boundary.
+    if (fCurrent >= 0 && positionAt(fCurrent) <= offset) {
+        if (fCurrent + 1 == fLength || offset < positionAt(fCurrent + 1)) {
+            return fCurrent;
+        }
+        if (fCurrent + 2 == fLength || offset < positionAt(fCurrent + 2)) {
+            return fCurrent + 1;
+        }
+    }
+    int32_t lo = 0;
+    int32_t hi = fLength;
+    while (lo < hi) {
+        int32_t mid = (lo + hi) / 2;
+        if (positionAt(mid) <= offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo - 1;
+}
+
+UBool RBBIBoundaryCache::moveTo(int32_t i, int32_t &pos, int32_t &statusIdx) {
+    fCurrent  = i;
+    pos       = positionAt(i);
+    statusIdx = fStatuses[physicalIndex(i)];
+    return TRUE;
+}
+
+void RBBIBoundaryCache::setStatusAt(int32_t i, int32_t statusIdx) {
+    if (statusIdx != UNKNOWN_STATUS) {
+        fStatuses[physicalIndex(i)] = statusIdx;
+    }
+}
+
+UBool RBBIBoundaryCache::next(int32_t &pos, int32_t &statusIdx) {
+    if (fCurrent < 0 || fCurrent + 1 >= fLength) {
+        return FALSE;
+    }
+    return moveTo(fCurrent + 1, pos, statusIdx);
+}
+
+UBool RBBIBoundaryCache::previous(int32_t &pos, int32_t &statusIdx) {
+    if (fCurrent <= 0) {
+        return FALSE;
+    }
+    return moveTo(fCurrent - 1, pos, statusIdx);
+}
+
+UBool RBBIBoundaryCache::following(int32_t offset, int32_t &pos, int32_t &statusIdx) {
+    if (fLength == 0 || offset < positionAt(0) || offset >= positionAt(fLength - 1)) {
+        return FALSE;
+    }
+    return moveTo(search(offset) + 1, pos, statusIdx);
+}
+
+UBool RBBIBoundaryCache::preceding(int32_t offset, int32_t &pos, int32_t &statusIdx) {
+    if (fLength == 0 || offset <= positionAt(0) || offset > positionAt(fLength - 1)) {
+        return FALSE;
+    }
+    return moveTo(search(offset - 1), pos, statusIdx);
+}
+
+UBool RBBIBoundaryCache::seek(int32_t pos, int32_t &statusIdx) {
+    int32_t i = search(pos);
+    if (i < 0 || positionAt(i) != pos) {
+        return FALSE;
+    }
+    return moveTo(i, pos, statusIdx);
+}
+
+//-------------------------------------------------------------------------------
+//
+//   Updates.
+//
+//-------------------------------------------------------------------------------
+
+void RBBIBoundaryCache::append(int32_t pos, int32_t statusIdx) {
+    if (fLength == CACHE_SIZE) {
+        // Drop the lowest boundary.
+        fStart = physicalIndex(1);
+        --fLength;
+        if (fCurrent >= 0) {
+            --fCurrent;
+        }
+    }
+    int32_t i = physicalIndex(fLength++);
+    fPositions[i] = pos;
+    fStatuses[i]  = statusIdx;
+}
+
+void RBBIBoundaryCache::prepend(int32_t pos, int32_t statusIdx) {
+    if (fLength == CACHE_SIZE) {
+        // Drop the highest boundary.
+        --fLength;
+        if (fCurrent >= fLength) {
+            fCurrent = -1;
+        }
+    }
+    fStart = physicalIndex(CACHE_SIZE - 1);
+    ++fLength;
+    if (fCurrent >= 0) {
+        ++fCurrent;
+    }
+    fPositions[fStart] = pos;
+    fStatuses[fStart]  = statusIdx;
+}
+
+void RBBIBoundaryCache::addFollowing(int32_t from, int32_t pos, int32_t statusIdx) {
+    if (fCurrent >= 0 && positionAt(fCurrent) == from) {
+        if (fCurrent + 1 == fLength) {
+            append(pos, statusIdx);
+            fCurrent = fLength - 1;
+            return;
+        }
+        if (positionAt(fCurrent + 1) == pos) {
+            setStatusAt(++fCurrent, statusIdx);
+            return;
+        }
+    } else if (fLength > 0 && positionAt(0) == pos) {
+        prepend(from, UNKNOWN_STATUS);
+        fCurrent = 1;
+        setStatusAt(fCurrent, statusIdx);
+        return;
+    }
+    // Not adjacent to the cached boundaries; start over.
+    clear();
+    append(from, UNKNOWN_STATUS);
+    append(pos, statusIdx);
+    fCurrent = 1;
+}
+
+void RBBIBoundaryCache::addPreceding(int32_t from, int32_t pos, int32_t statusIdx) {
+    if (fCurrent >= 0 && positionAt(fCurrent) == from) {
+        if (fCurrent == 0) {
+            prepend(pos, statusIdx);
+            fCurrent = 0;
+            return;
+        }
+        if (positionAt(fCurrent - 1) == pos) {
+            setStatusAt(--fCurrent, statusIdx);
+            return;
+        }
+    } else if (fLength > 0 && positionAt(fLength - 1) == pos) {
+        append(from, UNKNOWN_STATUS);
+        fCurrent = fLength - 2;
+        setStatusAt(fCurrent, statusIdx);
+        return;
+    }
+    clear();
+    append(pos, statusIdx);
+    append(from, UNKNOWN_STATUS);
+    fCurrent = 0;
+}
+
+void RBBIBoundaryCache::setBoundary(int32_t pos, int32_t statusIdx) {
+    int32_t i = search(pos);
+    if (i >= 0 && positionAt(i) == pos) {
+        fCurrent = i;
+        setStatusAt(i, statusIdx);
+    } else if (fLength > 0 && (i < 0 || i == fLength - 1)) {
+        // Outside of the cached range.  Keep the cache for later lookups.
+        fCurrent = -1;
+    } else {
+        // Either the cache is empty, or it is missing a boundary; start over.
+        clear();
+        append(pos, statusIdx);
+        fCurrent = 0;
+    }
+}
+
+U_NAMESPACE_END
+
+#endif /* #if !UCONFIG_NO_BREAK_ITERATION */
@@ -0,0 +1,97 @@
+/*
+*******************************************************************************
+*
+*   Copyright (C) 2013, International Business Machines
+*   Corporation and others.  All Rights Reserved.
+*
+*******************************************************************************
+*   file name:  rbbicache.h
+*   encoding:   US-ASCII
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   RBBIBoundaryCache  -  A ring of recently found, adjacent boundary positions
+*                         of a RuleBasedBreakIterator, together with the rule
+*                         status of each boundary.
+*
+*                         Random access (following(), preceding(), isBoundary())
+*                         and reverse iteration near text that has already been
+*                         visited are answered from the cache, without rerunning
+*                         the state machine from a safe point.
+*
+*                         Invariant: the cached positions are increasing, and
+*                         there is no boundary between any two neighboring entries.
+*/
+
+#ifndef __RBBICACHE_H__
+#define __RBBICACHE_H__
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_BREAK_ITERATION
+
+#include "unicode/uobject.h"
+
+U_NAMESPACE_BEGIN
+
+class RBBIBoundaryCache : public UMemory {
+public:
+    enum {
+        /** Number of boundaries kept; must be a power of 2.  */
+        CACHE_SIZE = 128,
+        /** Rule status value for boundaries whose status has not been computed. */
+        UNKNOWN_STATUS = -1
+    };
+
+    RBBIBoundaryCache();
+
+    /** Forget all boundaries.  Must be called whenever the text changes. */
+    void clear();
+
+    /**
+     *  Functions for moving the current boundary within the cache.
+     *  Each returns TRUE and sets pos and statusIdx to the new current boundary
+     *  if the answer is in the cache, and FALSE otherwise.
+     */
+    UBool next(int32_t &pos, int32_t &statusIdx);
+    UBool previous(int32_t &pos, int32_t &statusIdx);
+    UBool following(int32_t offset, int32_t &pos, int32_t &statusIdx);
+    UBool preceding(int32_t offset, int32_t &pos, int32_t &statusIdx);
+
+    /** Make pos the current boundary if it is cached.  */
+    UBool seek(int32_t pos, int32_t &statusIdx);
+
+    /**
+     *  Record the boundaries found by the iterator.
+     *  addFollowing(): pos is the boundary following the boundary from.
+     *  addPreceding(): pos is the boundary preceding the boundary from.
+     *  setBoundary():  pos is a boundary with unknown neighbors.
+     *  In all cases, pos becomes the current boundary.
+     *  The status of from is not taken from the iterator: after a next() has
+     *  returned DONE, the iterator's status no longer describes its position.
+     */
+    void addFollowing(int32_t from, int32_t pos, int32_t statusIdx);
+    void addPreceding(int32_t from, int32_t pos, int32_t statusIdx);
+    void setBoundary(int32_t pos, int32_t statusIdx);
+
+private:
+    int32_t physicalIndex(int32_t i) const { return (fStart + i) & (CACHE_SIZE - 1); }
+    int32_t positionAt(int32_t i) const { return fPositions[physicalIndex(i)]; }
+    void    setStatusAt(int32_t i, int32_t statusIdx);
+    int32_t search(int32_t offset) const;
+    UBool   moveTo(int32_t i, int32_t &pos, int32_t &statusIdx);
+    void    append(int32_t pos, int32_t statusIdx);
+    void    prepend(int32_t pos, int32_t statusIdx);
+
+    int32_t fPositions[CACHE_SIZE];
+    int32_t fStatuses[CACHE_SIZE];
+    int32_t fStart;      // Physical index of the first (lowest) cached boundary.
+    int32_t fLength;     // Number of cached boundaries.
+    int32_t fCurrent;    // Logical index of the boundary at the iteration position, or -1.
+};
+
+U_NAMESPACE_END
+
+#endif /* #if !UCONFIG_NO_BREAK_ITERATION */
+
+#endif
@@ -1,7 +1,7 @@
 /*
 ******************************************************************************
 *
-*   Copyright (C) 1999-2012, International Business Machines
+*   Copyright (C) 1999-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 ******************************************************************************
@@ -22,6 +22,7 @@
 #include "unicode/utf16.h"
 #include "ubidi_props.h"
 #include "ubidiimp.h"
+#include "umutex.h"
 #include "uassert.h"
 
 /*
@@ -144,6 +145,7 @@ ubidi_openSized(int32_t maxLength, int32_t maxRunCount, UErrorCode *pErrorCode)
 
     /* reset the object, all pointers NULL, all flags FALSE, all sizes 0 */
     uprv_memset(pBiDi, 0, sizeof(UBiDi));
+    pBiDi->cachedTextLength=-1;
 
     /* get BiDi properties */
     pBiDi->bdp=ubidi_getSingleton();
@@ -249,6 +251,9 @@ ubidi_close(UBiDi *pBiDi) {
         if(pBiDi->insertPoints.points!=NULL) {
             uprv_free(pBiDi->insertPoints.points);
         }
+        if(pBiDi->cachedTextMemory!=NULL) {
+            uprv_free(pBiDi->cachedTextMemory);
+        }
 
         uprv_free(pBiDi);
     }
@@ -262,6 +267,7 @@ ubidi_setInverse(UBiDi *pBiDi, UBool isInverse) {
         pBiDi->isInverse=isInverse;
         pBiDi->reorderingMode = isInverse ? UBIDI_REORDER_INVERSE_NUMBERS_AS_L
                                           : UBIDI_REORDER_DEFAULT;
+        pBiDi->cachedTextLength=-1;
     }
 }
 
@@ -295,6 +301,7 @@ ubidi_setReorderingMode(UBiDi *pBiDi, UBiDiReorderingMode reorderingMode) {
                         && (reorderingMode < UBIDI_REORDER_COUNT)) {
         pBiDi->reorderingMode = reorderingMode;
         pBiDi->isInverse = (UBool)(reorderingMode == UBIDI_REORDER_INVERSE_NUMBERS_AS_L);
+        pBiDi->cachedTextLength=-1;
     }
 }
 
@@ -314,6 +321,7 @@ ubidi_setReorderingOptions(UBiDi *pBiDi, uint32_t reorderingOptions) {
     }
     if (pBiDi!=NULL) {
         pBiDi->reorderingOptions=reorderingOptions;
+        pBiDi->cachedTextLength=-1;
     }
 }
 
@@ -541,6 +549,99 @@ getDirProps(UBiDi *pBiDi) {
     pBiDi->lastArabicPos=lastArabicPos;
 }
 
+/*
+ * Bidi classes of U+0000..U+058F, for getDirPropsLTR().
+ * There are no strong RTL characters (R, AL), no AN and no explicit
+ * embedding, override or mark characters below U+0590.
+ */
+#define LTR_FAST_LIMIT 0x590
+
+static DirProp gLowDirProps[LTR_FAST_LIMIT];
+static UBool gHaveLowDirProps=FALSE;
+
+static void
+initLowDirProps(const UBiDiProps *bdp) {
+    DirProp dirProps[LTR_FAST_LIMIT];
+    UChar32 c;
+    for(c=0; c<LTR_FAST_LIMIT; ++c) {
+        dirProps[c]=(DirProp)ubidi_getClass(bdp, c);
+    }
+    umtx_lock(NULL);
+    if(!gHaveLowDirProps) {
+        uprv_memcpy(gLowDirProps, dirProps, sizeof(gLowDirProps));
+        UMTX_RELEASE_BARRIER;
+        gHaveLowDirProps=TRUE;
+    }
+    umtx_unlock(NULL);
+}
+
+/*
+ * Fast path for getDirProps() for text that is certainly LTR.
+ * It succeeds if the text has only characters below U+0590,
+ * at most one paragraph, and the paragraph level resolves to LTR.
+ * Then it sets the same dirProps, flags and paraLevel as getDirProps();
+ * the whole text is unidirectional LTR and the resolution steps
+ * are skipped.
+ * Otherwise it returns FALSE and getDirProps() must be called.
+ */
+static UBool
+getDirPropsLTR(UBiDi *pBiDi) {
+    const UChar *text=pBiDi->text;
+    DirProp *dirProps=pBiDi->dirPropsMemory;    /* pBiDi->dirProps is const */
+    int32_t i, length=pBiDi->originalLength;
+    UBiDiLevel paraLevel=pBiDi->paraLevel;
+    Flags flags=0;
+    DirProp dirProp;
+    UChar uchar;
+    UBool haveLowDirProps;
+
+    if(pBiDi->fnClassCallback!=NULL ||
+       (pBiDi->reorderingOptions & UBIDI_OPTION_STREAMING) ||
+       ((paraLevel&1)!=0 && !IS_DEFAULT_LEVEL(paraLevel))) {
+        return FALSE;
+    }
+    /* contextual levels need the prologue, and differ for some inverse modes */
+    if(IS_DEFAULT_LEVEL(paraLevel) &&
+       (pBiDi->proLength>0 ||
+        pBiDi->reorderingMode==UBIDI_REORDER_INVERSE_LIKE_DIRECT ||
+        pBiDi->reorderingMode==UBIDI_REORDER_INVERSE_FOR_NUMBERS_SPECIAL)) {
+        return FALSE;
+    }
+    /* pre-scan: any character at or above U+0590 may be RTL */
+    for(i=0; i<length; ++i) {
+        if(text[i]>=LTR_FAST_LIMIT) {
+            return FALSE;
+        }
+    }
+
+    UMTX_CHECK(NULL, gHaveLowDirProps, haveLowDirProps);
+    if(!haveLowDirProps) {
+        initLowDirProps(pBiDi->bdp);
+    }
+    for(i=0; i<length; ++i) {
+        uchar=text[i];
+        dirProp=gLowDirProps[uchar];
+        if(dirProp==B && (i+1)<length) {
+            return FALSE;               /* multiple paragraphs */
+        }
+        flags|=DIRPROP_FLAG(dirProp);
+        dirProps[i]=dirProp;
+    }
+    /* with UBIDI_DEFAULT_RTL, a paragraph without L would be RTL */
+    if(paraLevel==UBIDI_DEFAULT_RTL && !(flags&DIRPROP_FLAG(L))) {
+        return FALSE;
+    }
+    if(IS_DEFAULT_LEVEL(paraLevel)) {
+        pBiDi->paraLevel=0;
+    }
+    flags|=DIRPROP_FLAG_LR(pBiDi->paraLevel);
+
+    pBiDi->controlCount=0;
+    pBiDi->flags=flags;
+    pBiDi->lastArabicPos=-1;
+    return TRUE;
+}
+
 /* perform (X1)..(X9) ------------------------------------------------------- */
 
 /* determine if the text is mixed-directional or single-directional */
@@ -1689,6 +1790,7 @@ ubidi_setContext(UBiDi *pBiDi,
     }
     pBiDi->prologue=prologue;
     pBiDi->epilogue=epilogue;
+    pBiDi->cachedTextLength=-1;
 }
 
 static void
@@ -1914,6 +2016,7 @@ ubidi_setPara(UBiDi *pBiDi, const UChar *text, int32_t length,
 
     /* initialize the UBiDi structure */
     pBiDi->pParaBiDi=NULL;          /* mark unfinished setPara */
+    pBiDi->cachedTextLength=-1;
     pBiDi->text=text;
     pBiDi->length=pBiDi->originalLength=pBiDi->resultLength=length;
     pBiDi->paraLevel=paraLevel;
@@ -1968,7 +2071,9 @@ ubidi_setPara(UBiDi *pBiDi, const UChar *text, int32_t length,
      */
     if(getDirPropsMemory(pBiDi, length)) {
         pBiDi->dirProps=pBiDi->dirPropsMemory;
-        getDirProps(pBiDi);
+        if(!getDirPropsLTR(pBiDi)) {
+            getDirProps(pBiDi);
+        }
     } else {
         *pErrorCode=U_MEMORY_ALLOCATION_ERROR;
         return;
@@ -2191,10 +2296,63 @@ ubidi_setPara(UBiDi *pBiDi, const UChar *text, int32_t length,
     setParaSuccess(pBiDi);              /* mark successful setPara */
 }
 
+/* counts for ubidi_getParaCacheCounts() */
+static int32_t gParaCacheHits=0;
+static int32_t gParaCacheMisses=0;
+
+U_CAPI void U_EXPORT2
+ubidi_setParaCached(UBiDi *pBiDi, const UChar *text, int32_t length,
+                    UBiDiLevel paraLevel, UErrorCode *pErrorCode) {
+    /* check the argument values */
+    RETURN_VOID_IF_NULL_OR_FAILING_ERRCODE(pErrorCode);
+    if(pBiDi==NULL || text==NULL || length<-1) {
+        *pErrorCode=U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+    if(length==-1) {
+        length=u_strlen(text);
+    }
+
+    if(pBiDi->pParaBiDi==pBiDi && pBiDi->cachedTextLength==length &&
+       pBiDi->cachedParaLevel==paraLevel &&
+       (length==0 || uprv_memcmp(pBiDi->cachedTextMemory, text, length*U_SIZEOF_UCHAR)==0)) {
+        /* same paragraph as last time: the results are still valid */
+        pBiDi->text=text;
+        umtx_atomic_inc(&gParaCacheHits);
+        return;
+    }
+    umtx_atomic_inc(&gParaCacheMisses);
+
+    ubidi_setPara(pBiDi, text, length, paraLevel, NULL, pErrorCode);
+    /*
+     * RUNS_ONLY runs the algorithm twice and ends with the results
+     * for different text; caching is not worth the special handling.
+     */
+    if(U_SUCCESS(*pErrorCode) && pBiDi->reorderingMode!=UBIDI_REORDER_RUNS_ONLY &&
+       (length==0 || getCachedTextMemory(pBiDi, length))) {
+        if(length>0) {
+            uprv_memcpy(pBiDi->cachedTextMemory, text, length*U_SIZEOF_UCHAR);
+        }
+        pBiDi->cachedTextLength=length;
+        pBiDi->cachedParaLevel=paraLevel;
+    }
+}
+
+U_CAPI void U_EXPORT2
+ubidi_getParaCacheCounts(int32_t *pHits, int32_t *pMisses) {
+    if(pHits!=NULL) {
+        *pHits=gParaCacheHits;
+    }
+    if(pMisses!=NULL) {
+        *pMisses=gParaCacheMisses;
+    }
+}
+
 U_CAPI void U_EXPORT2
 ubidi_orderParagraphsLTR(UBiDi *pBiDi, UBool orderParagraphsLTR) {
     if(pBiDi!=NULL) {
         pBiDi->orderParagraphsLTR=orderParagraphsLTR;
+        pBiDi->cachedTextLength=-1;
     }
 }
 
@@ -2338,6 +2496,7 @@ ubidi_setClassCallback(UBiDi *pBiDi, UBiDiClassCallback *newFn,
     }
     pBiDi->fnClassCallback = newFn;
     pBiDi->coClassCallback = newContext;
+    pBiDi->cachedTextLength=-1;
 }
 
 U_CAPI void U_EXPORT2
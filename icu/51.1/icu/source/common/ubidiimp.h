@@ -1,7 +1,7 @@
 /*
 ******************************************************************************
 *
-*   Copyright (C) 1999-2011, International Business Machines
+*   Copyright (C) 1999-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 ******************************************************************************
@@ -303,6 +303,14 @@ struct UBiDi {
     /* for Bidi class callback */
     UBiDiClassCallback *fnClassCallback;    /* action pointer */
     const void *coClassCallback;            /* context pointer */
+
+    /* for ubidi_setParaCached(): copy of the text of the last
+     * successful ubidi_setParaCached() and its paraLevel;
+     * cachedTextLength==-1 if the current result is not cached */
+    UChar *cachedTextMemory;
+    int32_t cachedTextSize;
+    int32_t cachedTextLength;
+    UBiDiLevel cachedParaLevel;
 };
 
 #define IS_VALID_PARA(x) ((x) && ((x)->pParaBiDi==(x)))
@@ -365,6 +373,10 @@ ubidi_getMemory(BidiMemoryForAllocation *pMemory, int32_t *pSize, UBool mayAlloc
         ubidi_getMemory((BidiMemoryForAllocation *)&(pBiDi)->levelsMemory, &(pBiDi)->levelsSize, \
                         (pBiDi)->mayAllocateText, (length))
 
+#define getCachedTextMemory(pBiDi, length) \
+        ubidi_getMemory((BidiMemoryForAllocation *)&(pBiDi)->cachedTextMemory, &(pBiDi)->cachedTextSize, \
+                        (pBiDi)->mayAllocateText, (length)*U_SIZEOF_UCHAR)
+
 #define getRunsMemory(pBiDi, length) \
         ubidi_getMemory((BidiMemoryForAllocation *)&(pBiDi)->runsMemory, &(pBiDi)->runsSize, \
                         (pBiDi)->mayAllocateRuns, (length)*sizeof(Run))
@@ -1,7 +1,7 @@
 /*
 *******************************************************************************
 *
-*   Copyright (C) 2004-2012, International Business Machines
+*   Copyright (C) 2004-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 *******************************************************************************
@@ -52,6 +52,47 @@ ucase_getSingleton() {
     return &ucase_props_singleton;
 }
 
+/* Latin-1 fast path tables ------------------------------------------------- */
+
+/*
+ * Characters without exceptions have only simple, context-independent mappings,
+ * per the trie value's type and delta. For them, case folding is the same as lowercasing,
+ * so UCASE_LATIN1_FOLD shares the lowercase table.
+ */
+static UChar gLatin1Lower[0x100], gLatin1Upper[0x100];
+static icu::UInitOnce gLatin1InitOnce = U_INITONCE_INITIALIZER;
+
+static void initLatin1Mappings() {
+    const UCaseProps *csp=&ucase_props_singleton;
+    UChar32 c;
+    gLatin1Lower[0]=gLatin1Upper[0]=0;
+    for(c=1; c<=0xff; ++c) {
+        uint16_t props=UTRIE2_GET16(&csp->trie, c);
+        UChar32 lower=c, upper=c;
+        if(props&UCASE_EXCEPTION) {
+            /* conditional or string mapping: leave it to the full functions */
+            gLatin1Lower[c]=gLatin1Upper[c]=0;
+            continue;
+        }
+        if(UCASE_GET_TYPE(props)>=UCASE_UPPER) {
+            lower=c+UCASE_GET_DELTA(props);
+        } else if(UCASE_GET_TYPE(props)==UCASE_LOWER) {
+            upper=c+UCASE_GET_DELTA(props);
+        }
+        gLatin1Lower[c]=(UChar)lower;
+        gLatin1Upper[c]=(UChar)upper;
+    }
+}
+
+U_CFUNC const UChar *
+ucase_getLatin1Mappings(const UCaseProps *csp, int32_t which) {
+    if(csp!=&ucase_props_singleton) {
+        return NULL;
+    }
+    umtx_initOnce(gLatin1InitOnce, &initLatin1Mappings);
+    return which==UCASE_LATIN1_UPPER ? gLatin1Upper : gLatin1Lower;
+}
+
 /* set of property starts for UnicodeSet ------------------------------------ */
 
 static UBool U_CALLCONV
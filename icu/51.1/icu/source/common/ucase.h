@@ -1,7 +1,7 @@
 /*
 *******************************************************************************
 *
-*   Copyright (C) 2004-2012, International Business Machines
+*   Copyright (C) 2004-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 *******************************************************************************
@@ -273,6 +273,31 @@ ucase_toFullFolding(const UCaseProps *csp, UChar32 c,
 U_CFUNC int32_t U_EXPORT2
 ucase_hasBinaryProperty(UChar32 c, UProperty which);
 
+/* Selectors for ucase_getLatin1Mappings() */
+enum {
+    UCASE_LATIN1_LOWER,
+    UCASE_LATIN1_UPPER,
+    UCASE_LATIN1_FOLD
+};
+
+/**
+ * Get a table of the case mappings of U+0000..U+00FF that are single code points
+ * and independent of the context, the locale and the case folding options.
+ * This allows string case mapping functions to process runs of such characters
+ * without calling the full mapping functions.
+ *
+ * table[c]==0 means that c must be mapped with ucase_toFullLower() etc.,
+ * for example U+0049 (Turkic and Lithuanian mappings) and U+00DF (maps to a string).
+ * U+0000 is always 0 in the table.
+ *
+ * @param csp Case mapping properties.
+ * @param which UCASE_LATIN1_LOWER, UCASE_LATIN1_UPPER or UCASE_LATIN1_FOLD
+ * @return Table of 256 mappings, or NULL if there is none for csp.
+ * @internal
+ */
+U_CFUNC const UChar *
+ucase_getLatin1Mappings(const UCaseProps *csp, int32_t which);
+
 
 U_CDECL_BEGIN
 
@@ -1,7 +1,7 @@
 /*
 *******************************************************************************
 *
-*   Copyright (C) 2005-2011, International Business Machines
+*   Copyright (C) 2005-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 *******************************************************************************
@@ -174,6 +174,56 @@ appendResult(uint8_t *dest, int32_t destIndex, int32_t destCapacity,
     return destIndex;
 }
 
+/*
+ * Maps a run of characters starting at src[srcIndex] that have simple,
+ * context-independent mappings in a table from ucase_getLatin1Mappings().
+ * Handles ASCII bytes and the UTF-8 forms of U+0080..U+00FF, and
+ * stops before the first character that needs the full mapping function.
+ * Advances destIndex by the length of each result, and writes each result
+ * only if it fits, as appendResult() does.
+ * @return the new srcIndex
+ */
+static inline int32_t
+mapLatin1Run(const UChar *latin1,
+             uint8_t *dest, int32_t &destIndex, int32_t destCapacity,
+             const uint8_t *src, int32_t srcIndex, int32_t srcLimit) {
+    UChar32 c;
+    UChar m;
+    int32_t length;
+    while(srcIndex<srcLimit) {
+        c=src[srcIndex];
+        length=1;
+        if(c>=0x80) {
+            if( (c==0xc2 || c==0xc3) && (srcIndex+1)<srcLimit &&
+                (uint8_t)(src[srcIndex+1]-0x80)<=0x3f
+            ) {
+                c=((c&0x1f)<<6)|(src[srcIndex+1]&0x3f);
+                length=2;
+            } else {
+                break;
+            }
+        }
+        m=latin1[c];
+        if(m==0 || m>0x7ff) {
+            break;
+        }
+        if(m<=0x7f) {
+            if(destIndex<destCapacity) {
+                dest[destIndex]=(uint8_t)m;
+            }
+            ++destIndex;
+        } else {
+            if((destIndex+2)<=destCapacity) {
+                dest[destIndex]=(uint8_t)(0xc0|(m>>6));
+                dest[destIndex+1]=(uint8_t)(0x80|(m&0x3f));
+            }
+            destIndex+=2;
+        }
+        srcIndex+=length;
+    }
+    return srcIndex;
+}
+
 static UChar32 U_CALLCONV
 utf8_caseContextIterator(void *context, int8_t dir) {
     UCaseContext *csc=(UCaseContext *)context;
@@ -211,7 +261,7 @@ utf8_caseContextIterator(void *context, int8_t dir) {
  * context [0..srcLength[ into account.
  */
 static int32_t
-_caseMap(const UCaseMap *csm, UCaseMapFull *map,
+_caseMap(const UCaseMap *csm, UCaseMapFull *map, int32_t latin1Which,
          uint8_t *dest, int32_t destCapacity,
          const uint8_t *src, UCaseContext *csc,
          int32_t srcStart, int32_t srcLimit,
@@ -220,6 +270,7 @@ _caseMap(const UCaseMap *csm, UCaseMapFull *map,
     UChar32 c, c2 = 0;
     int32_t srcIndex, destIndex;
     int32_t locCache;
+    const UChar *latin1=ucase_getLatin1Mappings(csm->csp, latin1Which);
 
     locCache=csm->locCache;
 
@@ -227,6 +278,12 @@ _caseMap(const UCaseMap *csm, UCaseMapFull *map,
     srcIndex=srcStart;
     destIndex=0;
     while(srcIndex<srcLimit) {
+        if(latin1!=NULL) {
+            srcIndex=mapLatin1Run(latin1, dest, destIndex, destCapacity, src, srcIndex, srcLimit);
+            if(srcIndex==srcLimit) {
+                break;
+            }
+        }
         csc->cpStart=srcIndex;
         U8_NEXT(src, srcIndex, srcLimit, c);
         csc->cpLimit=srcIndex;
@@ -358,7 +415,7 @@ ucasemap_internalUTF8ToTitle(const UCaseMap *csm,
                         /* Normal operation: Lowercase the rest of the word. */
                         destIndex+=
                             _caseMap(
-                                csm, ucase_toFullLower,
+                                csm, ucase_toFullLower, UCASE_LATIN1_LOWER,
                                 dest+destIndex, destCapacity-destIndex,
                                 src, &csc,
                                 titleLimit, idx,
@@ -395,7 +452,7 @@ ucasemap_internalUTF8ToLower(const UCaseMap *csm,
     csc.p=(void *)src;
     csc.limit=srcLength;
     return _caseMap(
-        csm, ucase_toFullLower,
+        csm, ucase_toFullLower, UCASE_LATIN1_LOWER,
         dest, destCapacity,
         src, &csc, 0, srcLength,
         pErrorCode);
@@ -410,7 +467,7 @@ ucasemap_internalUTF8ToUpper(const UCaseMap *csm,
     csc.p=(void *)src;
     csc.limit=srcLength;
     return _caseMap(
-        csm, ucase_toFullUpper,
+        csm, ucase_toFullUpper, UCASE_LATIN1_UPPER,
         dest, destCapacity,
         src, &csc, 0, srcLength,
         pErrorCode);
@@ -427,10 +484,17 @@ utf8_foldCase(const UCaseProps *csp,
     const UChar *s;
     UChar32 c, c2;
     int32_t start;
+    const UChar *latin1=ucase_getLatin1Mappings(csp, UCASE_LATIN1_FOLD);
 
     /* case mapping loop */
     srcIndex=destIndex=0;
     while(srcIndex<srcLength) {
+        if(latin1!=NULL) {
+            srcIndex=mapLatin1Run(latin1, dest, destIndex, destCapacity, src, srcIndex, srcLength);
+            if(srcIndex==srcLength) {
+                break;
+            }
+        }
         start=srcIndex;
         U8_NEXT(src, srcIndex, srcLength, c);
         if(c<0) {
@@ -1,7 +1,7 @@
 /*
  ********************************************************************
  * COPYRIGHT:
- * Copyright (c) 1996-2012, International Business Machines Corporation and
+ * Copyright (c) 1996-2013, International Business Machines Corporation and
  * others. All Rights Reserved.
  ********************************************************************
  *
@@ -90,9 +90,9 @@ converterData[UCNV_NUMBER_OF_SUPPORTED_CONVERTER_TYPES]={
     &_UTF7Data, &_Bocu1Data, &_UTF16Data, &_UTF32Data, &_CESU8Data, &_IMAPData,
 
 #if UCONFIG_NO_LEGACY_CONVERSION
-    NULL,
+    NULL, NULL
 #else
-    &_CompoundTextData
+    &_CompoundTextData, &_DVBData
 #endif
 };
 
@@ -107,6 +107,8 @@ static struct {
   { "bocu1", UCNV_BOCU1 },
   { "cesu8", UCNV_CESU8 },
 #if !UCONFIG_NO_LEGACY_CONVERSION
+  { "dvb", UCNV_DVB },
+  { "en300468", UCNV_DVB },
   { "hz",UCNV_HZ },
 #endif
   { "imapmailboxname", UCNV_IMAP_MAILBOX },
@@ -1035,6 +1037,138 @@ ucnv_createConverterFromSharedData(UConverter *myUConverter,
     return myUConverter;
 }
 
+/* converter pool for ucnv_borrow()/ucnv_return() ------------------------- */
+
+/*
+Reset converters returned with ucnv_return(), keyed by their canonical names.
+Borrowing one skips the alias lookup, the shared data cache lookup under
+cnvCacheMutex, and the allocation and initialization of the UConverter.
+The pool is small: it is meant for code that opens and closes the same few
+converters over and over, not as a general cache.
+*/
+#define UCNV_POOL_SIZE 8
+
+typedef struct UConverterPoolEntry {
+    char name[UCNV_MAX_CONVERTER_NAME_LENGTH];  /* ucnv_getName() of cnv */
+    UConverter *cnv;
+} UConverterPoolEntry;
+
+static UConverterPoolEntry gConverterPool[UCNV_POOL_SIZE];
+static int32_t gConverterPoolNext = 0;   /* next slot to evict when the pool is full */
+static UMutex cnvPoolMutex = U_MUTEX_INITIALIZER;
+
+static UConverter *
+ucnv_takeFromPool(const char *name) {
+    UConverter *cnv = NULL;
+    int32_t i;
+    umtx_lock(&cnvPoolMutex);
+    for (i = 0; i < UCNV_POOL_SIZE; ++i) {
+        if (gConverterPool[i].cnv != NULL && uprv_strcmp(gConverterPool[i].name, name) == 0) {
+            cnv = gConverterPool[i].cnv;
+            gConverterPool[i].cnv = NULL;
+            break;
+        }
+    }
+    umtx_unlock(&cnvPoolMutex);
+    return cnv;
+}
+
+/*
+ * A converter can only be pooled if ucnv_reset() returns it to the state
+ * of a newly opened one, that is, if the caller did not change its callbacks,
+ * substitution characters or fallback behavior, and if it owns its memory.
+ */
+static UBool
+ucnv_isPoolable(const UConverter *cnv) {
+    const UConverterStaticData *staticData = cnv->sharedData->staticData;
+    return (UBool)(
+        !cnv->isCopyLocal &&
+        cnv->fromCharErrorBehaviour == UCNV_TO_U_DEFAULT_CALLBACK &&
+        cnv->fromUCharErrorBehaviour == UCNV_FROM_U_DEFAULT_CALLBACK &&
+        cnv->toUContext == NULL &&
+        cnv->fromUContext == NULL &&
+        !cnv->useFallback &&
+        cnv->subChars == (uint8_t *)cnv->subUChars &&
+        cnv->subCharLen == staticData->subCharLen &&
+        cnv->subChar1 == staticData->subChar1 &&
+        uprv_memcmp(cnv->subChars, staticData->subChar, cnv->subCharLen) == 0);
+}
+
+U_CAPI UConverter * U_EXPORT2
+ucnv_borrow(const char *name, UErrorCode *err) {
+    const char *key;
+    UConverter *cnv;
+
+    if (err == NULL || U_FAILURE(*err)) {
+        return NULL;
+    }
+
+    key = (name == NULL || *name == 0) ? ucnv_getDefaultName() : name;
+    cnv = ucnv_takeFromPool(key);
+    if (cnv == NULL && uprv_strchr(key, UCNV_OPTION_SEP_CHAR) == NULL) {
+        /* Try again with the canonical name, which is what ucnv_return() uses. */
+        UErrorCode localErr = U_ZERO_ERROR;
+        UBool containsOption;
+        const char *canonicalName = ucnv_io_getConverterName(key, &containsOption, &localErr);
+        if (U_SUCCESS(localErr) && canonicalName != NULL && uprv_strcmp(canonicalName, key) != 0) {
+            cnv = ucnv_takeFromPool(canonicalName);
+        }
+    }
+    if (cnv == NULL) {
+        cnv = ucnv_open(name, err);
+    }
+    return cnv;
+}
+
+U_CAPI void U_EXPORT2
+ucnv_return(UConverter *cnv) {
+    UErrorCode errorCode = U_ZERO_ERROR;
+    UConverter *evicted = NULL;
+    const char *name;
+    int32_t i;
+
+    if (cnv == NULL) {
+        return;
+    }
+    name = ucnv_getName(cnv, &errorCode);
+    if (U_FAILURE(errorCode) || uprv_strlen(name) >= UCNV_MAX_CONVERTER_NAME_LENGTH || !ucnv_isPoolable(cnv)) {
+        ucnv_close(cnv);
+        return;
+    }
+    ucnv_reset(cnv);
+
+    umtx_lock(&cnvPoolMutex);
+    for (i = 0; i < UCNV_POOL_SIZE && gConverterPool[i].cnv != NULL; ++i) {}
+    if (i == UCNV_POOL_SIZE) {
+        i = gConverterPoolNext;
+        gConverterPoolNext = (gConverterPoolNext + 1) % UCNV_POOL_SIZE;
+        evicted = gConverterPool[i].cnv;
+    }
+    uprv_strcpy(gConverterPool[i].name, name);
+    gConverterPool[i].cnv = cnv;
+    umtx_unlock(&cnvPoolMutex);
+
+    ucnv_close(evicted);
+}
+
+/* Close the pooled converters so that ucnv_flushCache() can unload their data. */
+static void
+ucnv_flushPool() {
+    UConverter *pooled[UCNV_POOL_SIZE];
+    int32_t i;
+
+    umtx_lock(&cnvPoolMutex);
+    for (i = 0; i < UCNV_POOL_SIZE; ++i) {
+        pooled[i] = gConverterPool[i].cnv;
+        gConverterPool[i].cnv = NULL;
+    }
+    umtx_unlock(&cnvPoolMutex);
+
+    for (i = 0; i < UCNV_POOL_SIZE; ++i) {
+        ucnv_close(pooled[i]);
+    }
+}
+
 /*Frees all shared immutable objects that aren't referred to (reference count = 0)
  */
 U_CAPI int32_t U_EXPORT2
@@ -1051,6 +1185,7 @@ ucnv_flushCache ()
 
     /* Close the default converter without creating a new one so that everything will be flushed. */
     u_flushDefaultConverter();
+    ucnv_flushPool();
 
     /*if shared data hasn't even been lazy evaluated yet
     * return 0
@@ -29,6 +29,7 @@
 #include "ucnv_bld.h"
 #include "ucnv_cnv.h"
 #include "cmemory.h"
+#include "usimd.h"
 
 /* Prototypes --------------------------------------------------------------- */
 
@@ -98,7 +99,7 @@ static void ucnv_toUnicode_UTF8 (UConverterToUnicodeArgs * args,
     unsigned char *toUBytes = cnv->toUBytes;
     UBool isCESU8 = (UBool)(cnv->sharedData == &_CESU8Data);
     uint32_t ch, ch2 = 0;
-    int32_t i, inBytes;
+    int32_t i, inBytes, count;
   
     /* Restore size of current sequence */
     if (cnv->toUnicodeStatus && myTarget < targetLimit)
@@ -118,10 +119,51 @@ static void ucnv_toUnicode_UTF8 (UConverterToUnicodeArgs * args,
         ch = *(mySource++);
         if (ch < 0x80)        /* Simple case */
         {
-            *(myTarget++) = (UChar) ch;
+            count = (int32_t)(sourceLimit - mySource) + 1;
+            if (count > (int32_t)(targetLimit - myTarget))
+            {
+                count = (int32_t)(targetLimit - myTarget);
+            }
+            if (count >= USIMD_MIN_RUN)
+            {
+                /* copy a run of ASCII at once */
+                count = usimd_asciiToUChars(myTarget, mySource - 1, count);
+                mySource += count - 1;
+                myTarget += count;
+            }
+            else
+            {
+                *(myTarget++) = (UChar) ch;
+            }
         }
         else
         {
+            if (USIMD_NEON && ((inBytes = bytesFromUTF8[ch]) == 2 || inBytes == 3))
+            {
+                /*
+                 * Convert a run of valid 2- or 3-byte sequences at once.
+                 * The kernels do not convert surrogates or supplementary code points,
+                 * which are the only differences between UTF-8 and CESU-8.
+                 */
+                count = (int32_t)(sourceLimit - mySource + 1) / inBytes;
+                if (count > (int32_t)(targetLimit - myTarget))
+                {
+                    count = (int32_t)(targetLimit - myTarget);
+                }
+                if (count >= USIMD_MIN_RUN)
+                {
+                    count = (inBytes == 2) ?
+                        usimd_utf8TwoByteToUChars(myTarget, mySource - 1, count) :
+                        usimd_utf8ThreeByteToUChars(myTarget, mySource - 1, count);
+                    if (count > 0)
+                    {
+                        mySource += inBytes * count - 1;
+                        myTarget += count;
+                        continue;
+                    }
+                }
+            }
+
             /* store the first char */
             toUBytes[0] = (char)ch;
             inBytes = bytesFromUTF8[ch]; /* lookup current sequence length */
@@ -356,7 +398,7 @@ U_CFUNC void ucnv_fromUnicode_UTF8 (UConverterFromUnicodeArgs * args,
     uint8_t *tempPtr;
     UChar32 ch;
     uint8_t tempBuf[4];
-    int32_t indexToWrite;
+    int32_t indexToWrite, count;
     UBool isNotCESU8 = (UBool)(cnv->sharedData != &_CESU8Data);
 
     if (cnv->fromUChar32 && myTarget < targetLimit)
@@ -370,6 +412,29 @@ U_CFUNC void ucnv_fromUnicode_UTF8 (UConverterFromUnicodeArgs * args,
     {
         ch = *(mySource++);
 
+        if (ch < 0x80 || (USIMD_NEON && !U16_IS_SURROGATE(ch)))
+        {
+            /* Convert a run of UChars of the same UTF-8 length at once. */
+            indexToWrite = (ch < 0x80) ? 1 : (ch < 0x800) ? 2 : 3;
+            count = (int32_t)(targetLimit - myTarget) / indexToWrite;
+            if (count > (int32_t)(sourceLimit - mySource) + 1)
+            {
+                count = (int32_t)(sourceLimit - mySource) + 1;
+            }
+            if (count >= USIMD_MIN_RUN)
+            {
+                count = (indexToWrite == 1) ? usimd_asciiFromUChars(myTarget, mySource - 1, count) :
+                        (indexToWrite == 2) ? usimd_utf8TwoByteFromUChars(myTarget, mySource - 1, count) :
+                        usimd_utf8ThreeByteFromUChars(myTarget, mySource - 1, count);
+                if (count > 0)
+                {
+                    mySource += count - 1;
+                    myTarget += indexToWrite * count;
+                    continue;
+                }
+            }
+        }
+
         if (ch < 0x80)        /* Single byte */
         {
             *(myTarget++) = (uint8_t) ch;
@@ -0,0 +1,1368 @@
+/*
+**********************************************************************
+*
+* File UCNVDVB.C
+*
+**********************************************************************
+*/
+
+/*
+ * DVB text, the strings of the DVB service information (service names,
+ * event titles and descriptions), as defined in ETSI EN 300 468 annex A.
+ *
+ * A string begins with a character table selector when its first byte is
+ * below 0x20:
+ *   0x01..0x0b          ISO/IEC 8859-5..15 (0x08 would be 8859-12)
+ *   0x10 0x00 0xnn      ISO/IEC 8859-nn
+ *   0x11, 0x14          ISO/IEC 10646 BMP, two bytes big-endian
+ *   0x12                KS X 1001 (EUC-KR)
+ *   0x13                GB 2312 (EUC-CN)
+ *   0x15                UTF-8
+ *   0x1f 0xnn           the encoding of encoding_type_id nn
+ * Otherwise it is in table 00, ISO/IEC 6937 with the euro sign at 0xa4,
+ * in which the non-spacing diacritics 0xc1..0xcf come before the letter
+ * they go with and are composed with it here.
+ *
+ * The control codes are 0x80..0x9f in the single-byte tables and
+ * U+E080..U+E09F in the others. CR/LF (0x8a) is converted to U+000A, the
+ * others, such as emphasis on and off (0x86, 0x87), have no output.
+ *
+ * Each conversion with flush set is one string, so that the selector is
+ * read again after it; strings converted in pieces must be flushed at
+ * their ends or the converter reset between them. The two-byte tables
+ * come from the converter data; without them those strings are
+ * unassigned, while the others still convert.
+ *
+ * From Unicode, text is converted to table 00, with no selector.
+ */
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_CONVERSION && !UCONFIG_NO_LEGACY_CONVERSION
+
+#include "unicode/ucnv.h"
+#include "unicode/uset.h"
+#include "unicode/utf8.h"
+#include "unicode/utf16.h"
+#include "ucnv_bld.h"
+#include "ucnv_cnv.h"
+#include "ucnv_imp.h"
+#include "ucnvmbcs.h"
+#include "usimd.h"
+#include "cmemory.h"
+
+#define LENGTHOF(array) (int32_t)(sizeof(array)/sizeof((array)[0]))
+
+/* cnv->mode, the character table of the string, 0 after a reset */
+#define DVB_SELECTOR    0       /* the selector is next */
+/* 1..15: ISO/IEC 8859-1..15 */
+#define DVB_UCS2        0x11
+#define DVB_KSC         0x12
+#define DVB_GB          0x13
+#define DVB_UTF8        0x15
+#define DVB_6937        0x20
+
+#define DVB_CR_LF       0x8a
+
+/* U+E080..U+E09F are the control codes of the multi-byte tables */
+#define DVB_IS_CONTROL(c) (((c)&~0x1f)==0xe080)
+
+typedef struct {
+    UConverterSharedData *ksc;
+    UConverterSharedData *gb;
+} UConverterDataDVB;
+
+/*
+ * Bytes 0xa0..0xff of table 00 and of the ISO/IEC 8859 parts, 0 where
+ * unassigned. In table 00, 0xc1..0xcf are the combining marks of the
+ * diacritics.
+ */
+static const UChar dvbHighToU[16][96]={
+    /* ISO/IEC 6937 */
+    {
+        0x00a0, 0x00a1, 0x00a2, 0x00a3, 0x20ac, 0x00a5, 0x0023, 0x00a7,
+        0x00a4, 0x2018, 0x201c, 0x00ab, 0x2190, 0x2191, 0x2192, 0x2193,
+        0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x00d7, 0x00b5, 0x00b6, 0x00b7,
+        0x00f7, 0x2019, 0x201d, 0x00bb, 0x00bc, 0x00bd, 0x00be, 0x00bf,
+        0x0000, 0x0300, 0x0301, 0x0302, 0x0303, 0x0304, 0x0306, 0x0307,
+        0x0308, 0x0000, 0x030a, 0x0327, 0x0000, 0x030b, 0x0328, 0x030c,
+        0x2015, 0x00b9, 0x00ae, 0x00a9, 0x2122, 0x266a, 0x00ac, 0x00a6,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x215b, 0x215c, 0x215d, 0x215e,
+        0x2126, 0x00c6, 0x0110, 0x00aa, 0x0126, 0x0000, 0x0132, 0x013f,
+        0x0141, 0x00d8, 0x0152, 0x00ba, 0x00de, 0x0166, 0x014a, 0x0149,
+        0x0138, 0x00e6, 0x0111, 0x00f0, 0x0127, 0x0131, 0x0133, 0x0140,
+        0x0142, 0x00f8, 0x0153, 0x00df, 0x00fe, 0x0167, 0x014b, 0x00ad
+    },
+    /* ISO/IEC 8859-1 */
+    {
+        0x00a0, 0x00a1, 0x00a2, 0x00a3, 0x00a4, 0x00a5, 0x00a6, 0x00a7,
+        0x00a8, 0x00a9, 0x00aa, 0x00ab, 0x00ac, 0x00ad, 0x00ae, 0x00af,
+        0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x00b4, 0x00b5, 0x00b6, 0x00b7,
+        0x00b8, 0x00b9, 0x00ba, 0x00bb, 0x00bc, 0x00bd, 0x00be, 0x00bf,
+        0x00c0, 0x00c1, 0x00c2, 0x00c3, 0x00c4, 0x00c5, 0x00c6, 0x00c7,
+        0x00c8, 0x00c9, 0x00ca, 0x00cb, 0x00cc, 0x00cd, 0x00ce, 0x00cf,
+        0x00d0, 0x00d1, 0x00d2, 0x00d3, 0x00d4, 0x00d5, 0x00d6, 0x00d7,
+        0x00d8, 0x00d9, 0x00da, 0x00db, 0x00dc, 0x00dd, 0x00de, 0x00df,
+        0x00e0, 0x00e1, 0x00e2, 0x00e3, 0x00e4, 0x00e5, 0x00e6, 0x00e7,
+        0x00e8, 0x00e9, 0x00ea, 0x00eb, 0x00ec, 0x00ed, 0x00ee, 0x00ef,
+        0x00f0, 0x00f1, 0x00f2, 0x00f3, 0x00f4, 0x00f5, 0x00f6, 0x00f7,
+        0x00f8, 0x00f9, 0x00fa, 0x00fb, 0x00fc, 0x00fd, 0x00fe, 0x00ff
+    },
+    /* ISO/IEC 8859-2 */
+    {
+        0x00a0, 0x0104, 0x02d8, 0x0141, 0x00a4, 0x013d, 0x015a, 0x00a7,
+        0x00a8, 0x0160, 0x015e, 0x0164, 0x0179, 0x00ad, 0x017d, 0x017b,
+        0x00b0, 0x0105, 0x02db, 0x0142, 0x00b4, 0x013e, 0x015b, 0x02c7,
+        0x00b8, 0x0161, 0x015f, 0x0165, 0x017a, 0x02dd, 0x017e, 0x017c,
+        0x0154, 0x00c1, 0x00c2, 0x0102, 0x00c4, 0x0139, 0x0106, 0x00c7,
+        0x010c, 0x00c9, 0x0118, 0x00cb, 0x011a, 0x00cd, 0x00ce, 0x010e,
+        0x0110, 0x0143, 0x0147, 0x00d3, 0x00d4, 0x0150, 0x00d6, 0x00d7,
+        0x0158, 0x016e, 0x00da, 0x0170, 0x00dc, 0x00dd, 0x0162, 0x00df,
+        0x0155, 0x00e1, 0x00e2, 0x0103, 0x00e4, 0x013a, 0x0107, 0x00e7,
+        0x010d, 0x00e9, 0x0119, 0x00eb, 0x011b, 0x00ed, 0x00ee, 0x010f,
+        0x0111, 0x0144, 0x0148, 0x00f3, 0x00f4, 0x0151, 0x00f6, 0x00f7,
+        0x0159, 0x016f, 0x00fa, 0x0171, 0x00fc, 0x00fd, 0x0163, 0x02d9
+    },
+    /* ISO/IEC 8859-3 */
+    {
+        0x00a0, 0x0126, 0x02d8, 0x00a3, 0x00a4, 0x0000, 0x0124, 0x00a7,
+        0x00a8, 0x0130, 0x015e, 0x011e, 0x0134, 0x00ad, 0x0000, 0x017b,
+        0x00b0, 0x0127, 0x00b2, 0x00b3, 0x00b4, 0x00b5, 0x0125, 0x00b7,
+        0x00b8, 0x0131, 0x015f, 0x011f, 0x0135, 0x00bd, 0x0000, 0x017c,
+        0x00c0, 0x00c1, 0x00c2, 0x0000, 0x00c4, 0x010a, 0x0108, 0x00c7,
+        0x00c8, 0x00c9, 0x00ca, 0x00cb, 0x00cc, 0x00cd, 0x00ce, 0x00cf,
+        0x0000, 0x00d1, 0x00d2, 0x00d3, 0x00d4, 0x0120, 0x00d6, 0x00d7,
+        0x011c, 0x00d9, 0x00da, 0x00db, 0x00dc, 0x016c, 0x015c, 0x00df,
+        0x00e0, 0x00e1, 0x00e2, 0x0000, 0x00e4, 0x010b, 0x0109, 0x00e7,
+        0x00e8, 0x00e9, 0x00ea, 0x00eb, 0x00ec, 0x00ed, 0x00ee, 0x00ef,
+        0x0000, 0x00f1, 0x00f2, 0x00f3, 0x00f4, 0x0121, 0x00f6, 0x00f7,
+        0x011d, 0x00f9, 0x00fa, 0x00fb, 0x00fc, 0x016d, 0x015d, 0x02d9
+    },
+    /* ISO/IEC 8859-4 */
+    {
+        0x00a0, 0x0104, 0x0138, 0x0156, 0x00a4, 0x0128, 0x013b, 0x00a7,
+        0x00a8, 0x0160, 0x0112, 0x0122, 0x0166, 0x00ad, 0x017d, 0x00af,
+        0x00b0, 0x0105, 0x02db, 0x0157, 0x00b4, 0x0129, 0x013c, 0x02c7,
+        0x00b8, 0x0161, 0x0113, 0x0123, 0x0167, 0x014a, 0x017e, 0x014b,
+        0x0100, 0x00c1, 0x00c2, 0x00c3, 0x00c4, 0x00c5, 0x00c6, 0x012e,
+        0x010c, 0x00c9, 0x0118, 0x00cb, 0x0116, 0x00cd, 0x00ce, 0x012a,
+        0x0110, 0x0145, 0x014c, 0x0136, 0x00d4, 0x00d5, 0x00d6, 0x00d7,
+        0x00d8, 0x0172, 0x00da, 0x00db, 0x00dc, 0x0168, 0x016a, 0x00df,
+        0x0101, 0x00e1, 0x00e2, 0x00e3, 0x00e4, 0x00e5, 0x00e6, 0x012f,
+        0x010d, 0x00e9, 0x0119, 0x00eb, 0x0117, 0x00ed, 0x00ee, 0x012b,
+        0x0111, 0x0146, 0x014d, 0x0137, 0x00f4, 0x00f5, 0x00f6, 0x00f7,
+        0x00f8, 0x0173, 0x00fa, 0x00fb, 0x00fc, 0x0169, 0x016b, 0x02d9
+    },
+    /* ISO/IEC 8859-5 */
+    {
+        0x00a0, 0x0401, 0x0402, 0x0403, 0x0404, 0x0405, 0x0406, 0x0407,
+        0x0408, 0x0409, 0x040a, 0x040b, 0x040c, 0x00ad, 0x040e, 0x040f,
+        0x0410, 0x0411, 0x0412, 0x0413, 0x0414, 0x0415, 0x0416, 0x0417,
+        0x0418, 0x0419, 0x041a, 0x041b, 0x041c, 0x041d, 0x041e, 0x041f,
+        0x0420, 0x0421, 0x0422, 0x0423, 0x0424, 0x0425, 0x0426, 0x0427,
+        0x0428, 0x0429, 0x042a, 0x042b, 0x042c, 0x042d, 0x042e, 0x042f,
+        0x0430, 0x0431, 0x0432, 0x0433, 0x0434, 0x0435, 0x0436, 0x0437,
+        0x0438, 0x0439, 0x043a, 0x043b, 0x043c, 0x043d, 0x043e, 0x043f,
+        0x0440, 0x0441, 0x0442, 0x0443, 0x0444, 0x0445, 0x0446, 0x0447,
+        0x0448, 0x0449, 0x044a, 0x044b, 0x044c, 0x044d, 0x044e, 0x044f,
+        0x2116, 0x0451, 0x0452, 0x0453, 0x0454, 0x0455, 0x0456, 0x0457,
+        0x0458, 0x0459, 0x045a, 0x045b, 0x045c, 0x00a7, 0x045e, 0x045f
+    },
+    /* ISO/IEC 8859-6 */
+    {
+        0x00a0, 0x0000, 0x0000, 0x0000, 0x00a4, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x060c, 0x00ad, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x061b, 0x0000, 0x0000, 0x0000, 0x061f,
+        0x0000, 0x0621, 0x0622, 0x0623, 0x0624, 0x0625, 0x0626, 0x0627,
+        0x0628, 0x0629, 0x062a, 0x062b, 0x062c, 0x062d, 0x062e, 0x062f,
+        0x0630, 0x0631, 0x0632, 0x0633, 0x0634, 0x0635, 0x0636, 0x0637,
+        0x0638, 0x0639, 0x063a, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0640, 0x0641, 0x0642, 0x0643, 0x0644, 0x0645, 0x0646, 0x0647,
+        0x0648, 0x0649, 0x064a, 0x064b, 0x064c, 0x064d, 0x064e, 0x064f,
+        0x0650, 0x0651, 0x0652, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000
+    },
+    /* ISO/IEC 8859-7 */
+    {
+        0x00a0, 0x2018, 0x2019, 0x00a3, 0x20ac, 0x20af, 0x00a6, 0x00a7,
+        0x00a8, 0x00a9, 0x037a, 0x00ab, 0x00ac, 0x00ad, 0x0000, 0x2015,
+        0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x0384, 0x0385, 0x0386, 0x00b7,
+        0x0388, 0x0389, 0x038a, 0x00bb, 0x038c, 0x00bd, 0x038e, 0x038f,
+        0x0390, 0x0391, 0x0392, 0x0393, 0x0394, 0x0395, 0x0396, 0x0397,
+        0x0398, 0x0399, 0x039a, 0x039b, 0x039c, 0x039d, 0x039e, 0x039f,
+        0x03a0, 0x03a1, 0x0000, 0x03a3, 0x03a4, 0x03a5, 0x03a6, 0x03a7,
+        0x03a8, 0x03a9, 0x03aa, 0x03ab, 0x03ac, 0x03ad, 0x03ae, 0x03af,
+        0x03b0, 0x03b1, 0x03b2, 0x03b3, 0x03b4, 0x03b5, 0x03b6, 0x03b7,
+        0x03b8, 0x03b9, 0x03ba, 0x03bb, 0x03bc, 0x03bd, 0x03be, 0x03bf,
+        0x03c0, 0x03c1, 0x03c2, 0x03c3, 0x03c4, 0x03c5, 0x03c6, 0x03c7,
+        0x03c8, 0x03c9, 0x03ca, 0x03cb, 0x03cc, 0x03cd, 0x03ce, 0x0000
+    },
+    /* ISO/IEC 8859-8 */
+    {
+        0x00a0, 0x0000, 0x00a2, 0x00a3, 0x00a4, 0x00a5, 0x00a6, 0x00a7,
+        0x00a8, 0x00a9, 0x00d7, 0x00ab, 0x00ac, 0x00ad, 0x00ae, 0x00af,
+        0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x00b4, 0x00b5, 0x00b6, 0x00b7,
+        0x00b8, 0x00b9, 0x00f7, 0x00bb, 0x00bc, 0x00bd, 0x00be, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x2017,
+        0x05d0, 0x05d1, 0x05d2, 0x05d3, 0x05d4, 0x05d5, 0x05d6, 0x05d7,
+        0x05d8, 0x05d9, 0x05da, 0x05db, 0x05dc, 0x05dd, 0x05de, 0x05df,
+        0x05e0, 0x05e1, 0x05e2, 0x05e3, 0x05e4, 0x05e5, 0x05e6, 0x05e7,
+        0x05e8, 0x05e9, 0x05ea, 0x0000, 0x0000, 0x200e, 0x200f, 0x0000
+    },
+    /* ISO/IEC 8859-9 */
+    {
+        0x00a0, 0x00a1, 0x00a2, 0x00a3, 0x00a4, 0x00a5, 0x00a6, 0x00a7,
+        0x00a8, 0x00a9, 0x00aa, 0x00ab, 0x00ac, 0x00ad, 0x00ae, 0x00af,
+        0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x00b4, 0x00b5, 0x00b6, 0x00b7,
+        0x00b8, 0x00b9, 0x00ba, 0x00bb, 0x00bc, 0x00bd, 0x00be, 0x00bf,
+        0x00c0, 0x00c1, 0x00c2, 0x00c3, 0x00c4, 0x00c5, 0x00c6, 0x00c7,
+        0x00c8, 0x00c9, 0x00ca, 0x00cb, 0x00cc, 0x00cd, 0x00ce, 0x00cf,
+        0x011e, 0x00d1, 0x00d2, 0x00d3, 0x00d4, 0x00d5, 0x00d6, 0x00d7,
+        0x00d8, 0x00d9, 0x00da, 0x00db, 0x00dc, 0x0130, 0x015e, 0x00df,
+        0x00e0, 0x00e1, 0x00e2, 0x00e3, 0x00e4, 0x00e5, 0x00e6, 0x00e7,
+        0x00e8, 0x00e9, 0x00ea, 0x00eb, 0x00ec, 0x00ed, 0x00ee, 0x00ef,
+        0x011f, 0x00f1, 0x00f2, 0x00f3, 0x00f4, 0x00f5, 0x00f6, 0x00f7,
+        0x00f8, 0x00f9, 0x00fa, 0x00fb, 0x00fc, 0x0131, 0x015f, 0x00ff
+    },
+    /* ISO/IEC 8859-10 */
+    {
+        0x00a0, 0x0104, 0x0112, 0x0122, 0x012a, 0x0128, 0x0136, 0x00a7,
+        0x013b, 0x0110, 0x0160, 0x0166, 0x017d, 0x00ad, 0x016a, 0x014a,
+        0x00b0, 0x0105, 0x0113, 0x0123, 0x012b, 0x0129, 0x0137, 0x00b7,
+        0x013c, 0x0111, 0x0161, 0x0167, 0x017e, 0x2015, 0x016b, 0x014b,
+        0x0100, 0x00c1, 0x00c2, 0x00c3, 0x00c4, 0x00c5, 0x00c6, 0x012e,
+        0x010c, 0x00c9, 0x0118, 0x00cb, 0x0116, 0x00cd, 0x00ce, 0x00cf,
+        0x00d0, 0x0145, 0x014c, 0x00d3, 0x00d4, 0x00d5, 0x00d6, 0x0168,
+        0x00d8, 0x0172, 0x00da, 0x00db, 0x00dc, 0x00dd, 0x00de, 0x00df,
+        0x0101, 0x00e1, 0x00e2, 0x00e3, 0x00e4, 0x00e5, 0x00e6, 0x012f,
+        0x010d, 0x00e9, 0x0119, 0x00eb, 0x0117, 0x00ed, 0x00ee, 0x00ef,
+        0x00f0, 0x0146, 0x014d, 0x00f3, 0x00f4, 0x00f5, 0x00f6, 0x0169,
+        0x00f8, 0x0173, 0x00fa, 0x00fb, 0x00fc, 0x00fd, 0x00fe, 0x0138
+    },
+    /* ISO/IEC 8859-11 */
+    {
+        0x00a0, 0x0e01, 0x0e02, 0x0e03, 0x0e04, 0x0e05, 0x0e06, 0x0e07,
+        0x0e08, 0x0e09, 0x0e0a, 0x0e0b, 0x0e0c, 0x0e0d, 0x0e0e, 0x0e0f,
+        0x0e10, 0x0e11, 0x0e12, 0x0e13, 0x0e14, 0x0e15, 0x0e16, 0x0e17,
+        0x0e18, 0x0e19, 0x0e1a, 0x0e1b, 0x0e1c, 0x0e1d, 0x0e1e, 0x0e1f,
+        0x0e20, 0x0e21, 0x0e22, 0x0e23, 0x0e24, 0x0e25, 0x0e26, 0x0e27,
+        0x0e28, 0x0e29, 0x0e2a, 0x0e2b, 0x0e2c, 0x0e2d, 0x0e2e, 0x0e2f,
+        0x0e30, 0x0e31, 0x0e32, 0x0e33, 0x0e34, 0x0e35, 0x0e36, 0x0e37,
+        0x0e38, 0x0e39, 0x0e3a, 0x0000, 0x0000, 0x0000, 0x0000, 0x0e3f,
+        0x0e40, 0x0e41, 0x0e42, 0x0e43, 0x0e44, 0x0e45, 0x0e46, 0x0e47,
+        0x0e48, 0x0e49, 0x0e4a, 0x0e4b, 0x0e4c, 0x0e4d, 0x0e4e, 0x0e4f,
+        0x0e50, 0x0e51, 0x0e52, 0x0e53, 0x0e54, 0x0e55, 0x0e56, 0x0e57,
+        0x0e58, 0x0e59, 0x0e5a, 0x0e5b, 0x0000, 0x0000, 0x0000, 0x0000
+    },
+    /* ISO/IEC 8859-12 does not exist */
+    {
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000
+    },
+    /* ISO/IEC 8859-13 */
+    {
+        0x00a0, 0x201d, 0x00a2, 0x00a3, 0x00a4, 0x201e, 0x00a6, 0x00a7,
+        0x00d8, 0x00a9, 0x0156, 0x00ab, 0x00ac, 0x00ad, 0x00ae, 0x00c6,
+        0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x201c, 0x00b5, 0x00b6, 0x00b7,
+        0x00f8, 0x00b9, 0x0157, 0x00bb, 0x00bc, 0x00bd, 0x00be, 0x00e6,
+        0x0104, 0x012e, 0x0100, 0x0106, 0x00c4, 0x00c5, 0x0118, 0x0112,
+        0x010c, 0x00c9, 0x0179, 0x0116, 0x0122, 0x0136, 0x012a, 0x013b,
+        0x0160, 0x0143, 0x0145, 0x00d3, 0x014c, 0x00d5, 0x00d6, 0x00d7,
+        0x0172, 0x0141, 0x015a, 0x016a, 0x00dc, 0x017b, 0x017d, 0x00df,
+        0x0105, 0x012f, 0x0101, 0x0107, 0x00e4, 0x00e5, 0x0119, 0x0113,
+        0x010d, 0x00e9, 0x017a, 0x0117, 0x0123, 0x0137, 0x012b, 0x013c,
+        0x0161, 0x0144, 0x0146, 0x00f3, 0x014d, 0x00f5, 0x00f6, 0x00f7,
+        0x0173, 0x0142, 0x015b, 0x016b, 0x00fc, 0x017c, 0x017e, 0x2019
+    },
+    /* ISO/IEC 8859-14 */
+    {
+        0x00a0, 0x1e02, 0x1e03, 0x00a3, 0x010a, 0x010b, 0x1e0a, 0x00a7,
+        0x1e80, 0x00a9, 0x1e82, 0x1e0b, 0x1ef2, 0x00ad, 0x00ae, 0x0178,
+        0x1e1e, 0x1e1f, 0x0120, 0x0121, 0x1e40, 0x1e41, 0x00b6, 0x1e56,
+        0x1e81, 0x1e57, 0x1e83, 0x1e60, 0x1ef3, 0x1e84, 0x1e85, 0x1e61,
+        0x00c0, 0x00c1, 0x00c2, 0x00c3, 0x00c4, 0x00c5, 0x00c6, 0x00c7,
+        0x00c8, 0x00c9, 0x00ca, 0x00cb, 0x00cc, 0x00cd, 0x00ce, 0x00cf,
+        0x0174, 0x00d1, 0x00d2, 0x00d3, 0x00d4, 0x00d5, 0x00d6, 0x1e6a,
+        0x00d8, 0x00d9, 0x00da, 0x00db, 0x00dc, 0x00dd, 0x0176, 0x00df,
+        0x00e0, 0x00e1, 0x00e2, 0x00e3, 0x00e4, 0x00e5, 0x00e6, 0x00e7,
+        0x00e8, 0x00e9, 0x00ea, 0x00eb, 0x00ec, 0x00ed, 0x00ee, 0x00ef,
+        0x0175, 0x00f1, 0x00f2, 0x00f3, 0x00f4, 0x00f5, 0x00f6, 0x1e6b,
+        0x00f8, 0x00f9, 0x00fa, 0x00fb, 0x00fc, 0x00fd, 0x0177, 0x00ff
+    },
+    /* ISO/IEC 8859-15 */
+    {
+        0x00a0, 0x00a1, 0x00a2, 0x00a3, 0x20ac, 0x00a5, 0x0160, 0x00a7,
+        0x0161, 0x00a9, 0x00aa, 0x00ab, 0x00ac, 0x00ad, 0x00ae, 0x00af,
+        0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x017d, 0x00b5, 0x00b6, 0x00b7,
+        0x017e, 0x00b9, 0x00ba, 0x00bb, 0x0152, 0x0153, 0x0178, 0x00bf,
+        0x00c0, 0x00c1, 0x00c2, 0x00c3, 0x00c4, 0x00c5, 0x00c6, 0x00c7,
+        0x00c8, 0x00c9, 0x00ca, 0x00cb, 0x00cc, 0x00cd, 0x00ce, 0x00cf,
+        0x00d0, 0x00d1, 0x00d2, 0x00d3, 0x00d4, 0x00d5, 0x00d6, 0x00d7,
+        0x00d8, 0x00d9, 0x00da, 0x00db, 0x00dc, 0x00dd, 0x00de, 0x00df,
+        0x00e0, 0x00e1, 0x00e2, 0x00e3, 0x00e4, 0x00e5, 0x00e6, 0x00e7,
+        0x00e8, 0x00e9, 0x00ea, 0x00eb, 0x00ec, 0x00ed, 0x00ee, 0x00ef,
+        0x00f0, 0x00f1, 0x00f2, 0x00f3, 0x00f4, 0x00f5, 0x00f6, 0x00f7,
+        0x00f8, 0x00f9, 0x00fa, 0x00fb, 0x00fc, 0x00fd, 0x00fe, 0x00ff
+    }
+};
+
+/* the diacritics 0xc1..0xcf composed with the letters 0x41..0x7a, 0 if none */
+static const UChar dvbCompose[15][58]={
+    /* 0xC1 combining grave accent */
+    {
+        0x00c0, 0x0000, 0x0000, 0x0000, 0x00c8, 0x0000, 0x0000, 0x0000,
+        0x00cc, 0x0000, 0x0000, 0x0000, 0x0000, 0x01f8, 0x00d2, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x00d9, 0x0000, 0x1e80, 0x0000,
+        0x1ef2, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x00e0, 0x0000, 0x0000, 0x0000, 0x00e8, 0x0000, 0x0000, 0x0000,
+        0x00ec, 0x0000, 0x0000, 0x0000, 0x0000, 0x01f9, 0x00f2, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x00f9, 0x0000, 0x1e81, 0x0000,
+        0x1ef3, 0x0000
+    },
+    /* 0xC2 combining acute accent */
+    {
+        0x00c1, 0x0000, 0x0106, 0x0000, 0x00c9, 0x0000, 0x01f4, 0x0000,
+        0x00cd, 0x0000, 0x1e30, 0x0139, 0x1e3e, 0x0143, 0x00d3, 0x1e54,
+        0x0000, 0x0154, 0x015a, 0x0000, 0x00da, 0x0000, 0x1e82, 0x0000,
+        0x00dd, 0x0179, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x00e1, 0x0000, 0x0107, 0x0000, 0x00e9, 0x0000, 0x01f5, 0x0000,
+        0x00ed, 0x0000, 0x1e31, 0x013a, 0x1e3f, 0x0144, 0x00f3, 0x1e55,
+        0x0000, 0x0155, 0x015b, 0x0000, 0x00fa, 0x0000, 0x1e83, 0x0000,
+        0x00fd, 0x017a
+    },
+    /* 0xC3 combining circumflex accent */
+    {
+        0x00c2, 0x0000, 0x0108, 0x0000, 0x00ca, 0x0000, 0x011c, 0x0124,
+        0x00ce, 0x0134, 0x0000, 0x0000, 0x0000, 0x0000, 0x00d4, 0x0000,
+        0x0000, 0x0000, 0x015c, 0x0000, 0x00db, 0x0000, 0x0174, 0x0000,
+        0x0176, 0x1e90, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x00e2, 0x0000, 0x0109, 0x0000, 0x00ea, 0x0000, 0x011d, 0x0125,
+        0x00ee, 0x0135, 0x0000, 0x0000, 0x0000, 0x0000, 0x00f4, 0x0000,
+        0x0000, 0x0000, 0x015d, 0x0000, 0x00fb, 0x0000, 0x0175, 0x0000,
+        0x0177, 0x1e91
+    },
+    /* 0xC4 combining tilde */
+    {
+        0x00c3, 0x0000, 0x0000, 0x0000, 0x1ebc, 0x0000, 0x0000, 0x0000,
+        0x0128, 0x0000, 0x0000, 0x0000, 0x0000, 0x00d1, 0x00d5, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0168, 0x1e7c, 0x0000, 0x0000,
+        0x1ef8, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x00e3, 0x0000, 0x0000, 0x0000, 0x1ebd, 0x0000, 0x0000, 0x0000,
+        0x0129, 0x0000, 0x0000, 0x0000, 0x0000, 0x00f1, 0x00f5, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0169, 0x1e7d, 0x0000, 0x0000,
+        0x1ef9, 0x0000
+    },
+    /* 0xC5 combining macron */
+    {
+        0x0100, 0x0000, 0x0000, 0x0000, 0x0112, 0x0000, 0x1e20, 0x0000,
+        0x012a, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x014c, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x016a, 0x0000, 0x0000, 0x0000,
+        0x0232, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0101, 0x0000, 0x0000, 0x0000, 0x0113, 0x0000, 0x1e21, 0x0000,
+        0x012b, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x014d, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x016b, 0x0000, 0x0000, 0x0000,
+        0x0233, 0x0000
+    },
+    /* 0xC6 combining breve */
+    {
+        0x0102, 0x0000, 0x0000, 0x0000, 0x0114, 0x0000, 0x011e, 0x0000,
+        0x012c, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x014e, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x016c, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0103, 0x0000, 0x0000, 0x0000, 0x0115, 0x0000, 0x011f, 0x0000,
+        0x012d, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x014f, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x016d, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000
+    },
+    /* 0xC7 combining dot above */
+    {
+        0x0226, 0x1e02, 0x010a, 0x1e0a, 0x0116, 0x1e1e, 0x0120, 0x1e22,
+        0x0130, 0x0000, 0x0000, 0x0000, 0x1e40, 0x1e44, 0x022e, 0x1e56,
+        0x0000, 0x1e58, 0x1e60, 0x1e6a, 0x0000, 0x0000, 0x1e86, 0x1e8a,
+        0x1e8e, 0x017b, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0227, 0x1e03, 0x010b, 0x1e0b, 0x0117, 0x1e1f, 0x0121, 0x1e23,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x1e41, 0x1e45, 0x022f, 0x1e57,
+        0x0000, 0x1e59, 0x1e61, 0x1e6b, 0x0000, 0x0000, 0x1e87, 0x1e8b,
+        0x1e8f, 0x017c
+    },
+    /* 0xC8 combining diaeresis */
+    {
+        0x00c4, 0x0000, 0x0000, 0x0000, 0x00cb, 0x0000, 0x0000, 0x1e26,
+        0x00cf, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x00d6, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x00dc, 0x0000, 0x1e84, 0x1e8c,
+        0x0178, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x00e4, 0x0000, 0x0000, 0x0000, 0x00eb, 0x0000, 0x0000, 0x1e27,
+        0x00ef, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x00f6, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x1e97, 0x00fc, 0x0000, 0x1e85, 0x1e8d,
+        0x00ff, 0x0000
+    },
+    /* 0xC9 unassigned */
+    {
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000
+    },
+    /* 0xCA combining ring above */
+    {
+        0x00c5, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x016e, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x00e5, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x016f, 0x0000, 0x1e98, 0x0000,
+        0x1e99, 0x0000
+    },
+    /* 0xCB combining cedilla */
+    {
+        0x0000, 0x0000, 0x00c7, 0x1e10, 0x0228, 0x0000, 0x0122, 0x1e28,
+        0x0000, 0x0000, 0x0136, 0x013b, 0x0000, 0x0145, 0x0000, 0x0000,
+        0x0000, 0x0156, 0x015e, 0x0162, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x00e7, 0x1e11, 0x0229, 0x0000, 0x0123, 0x1e29,
+        0x0000, 0x0000, 0x0137, 0x013c, 0x0000, 0x0146, 0x0000, 0x0000,
+        0x0000, 0x0157, 0x015f, 0x0163, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000
+    },
+    /* 0xCC unassigned */
+    {
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000
+    },
+    /* 0xCD combining double acute accent */
+    {
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0150, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0170, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0151, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0171, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000
+    },
+    /* 0xCE combining ogonek */
+    {
+        0x0104, 0x0000, 0x0000, 0x0000, 0x0118, 0x0000, 0x0000, 0x0000,
+        0x012e, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x01ea, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0172, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0105, 0x0000, 0x0000, 0x0000, 0x0119, 0x0000, 0x0000, 0x0000,
+        0x012f, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x01eb, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0173, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000
+    },
+    /* 0xCF combining caron */
+    {
+        0x01cd, 0x0000, 0x010c, 0x010e, 0x011a, 0x0000, 0x01e6, 0x021e,
+        0x01cf, 0x0000, 0x01e8, 0x013d, 0x0000, 0x0147, 0x01d1, 0x0000,
+        0x0000, 0x0158, 0x0160, 0x0164, 0x01d3, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x017d, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x01ce, 0x0000, 0x010d, 0x010f, 0x011b, 0x0000, 0x01e7, 0x021f,
+        0x01d0, 0x01f0, 0x01e9, 0x013e, 0x0000, 0x0148, 0x01d2, 0x0000,
+        0x0000, 0x0159, 0x0161, 0x0165, 0x01d4, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x017e
+    }
+};
+
+/* the diacritics 0xc1..0xcf followed by a space */
+static const UChar dvbSpacing[15]={
+    0x0060, 0x00b4, 0x005e, 0x007e, 0x00af, 0x02d8, 0x02d9, 0x00a8,
+    0x0000, 0x02da, 0x00b8, 0x0000, 0x02dd, 0x02db, 0x02c7
+};
+
+/*
+ * The Unicode code points above U+007F of table 00 in the high 16 bits,
+ * sorted, and the bytes in the low ones: a diacritic and a letter or a space,
+ * or a single byte.
+ */
+static const uint32_t dvbFromU[335]={
+    0x00a000a0, 0x00a100a1, 0x00a200a2, 0x00a300a3, 0x00a400a8, 0x00a500a5,
+    0x00a600d7, 0x00a700a7, 0x00a8c820, 0x00a900d3, 0x00aa00e3, 0x00ab00ab,
+    0x00ac00d6, 0x00ad00ff, 0x00ae00d2, 0x00afc520, 0x00b000b0, 0x00b100b1,
+    0x00b200b2, 0x00b300b3, 0x00b4c220, 0x00b500b5, 0x00b600b6, 0x00b700b7,
+    0x00b8cb20, 0x00b900d1, 0x00ba00eb, 0x00bb00bb, 0x00bc00bc, 0x00bd00bd,
+    0x00be00be, 0x00bf00bf, 0x00c0c141, 0x00c1c241, 0x00c2c341, 0x00c3c441,
+    0x00c4c841, 0x00c5ca41, 0x00c600e1, 0x00c7cb43, 0x00c8c145, 0x00c9c245,
+    0x00cac345, 0x00cbc845, 0x00ccc149, 0x00cdc249, 0x00cec349, 0x00cfc849,
+    0x00d1c44e, 0x00d2c14f, 0x00d3c24f, 0x00d4c34f, 0x00d5c44f, 0x00d6c84f,
+    0x00d700b4, 0x00d800e9, 0x00d9c155, 0x00dac255, 0x00dbc355, 0x00dcc855,
+    0x00ddc259, 0x00de00ec, 0x00df00fb, 0x00e0c161, 0x00e1c261, 0x00e2c361,
+    0x00e3c461, 0x00e4c861, 0x00e5ca61, 0x00e600f1, 0x00e7cb63, 0x00e8c165,
+    0x00e9c265, 0x00eac365, 0x00ebc865, 0x00ecc169, 0x00edc269, 0x00eec369,
+    0x00efc869, 0x00f000f3, 0x00f1c46e, 0x00f2c16f, 0x00f3c26f, 0x00f4c36f,
+    0x00f5c46f, 0x00f6c86f, 0x00f700b8, 0x00f800f9, 0x00f9c175, 0x00fac275,
+    0x00fbc375, 0x00fcc875, 0x00fdc279, 0x00fe00fc, 0x00ffc879, 0x0100c541,
+    0x0101c561, 0x0102c641, 0x0103c661, 0x0104ce41, 0x0105ce61, 0x0106c243,
+    0x0107c263, 0x0108c343, 0x0109c363, 0x010ac743, 0x010bc763, 0x010ccf43,
+    0x010dcf63, 0x010ecf44, 0x010fcf64, 0x011000e2, 0x011100f2, 0x0112c545,
+    0x0113c565, 0x0114c645, 0x0115c665, 0x0116c745, 0x0117c765, 0x0118ce45,
+    0x0119ce65, 0x011acf45, 0x011bcf65, 0x011cc347, 0x011dc367, 0x011ec647,
+    0x011fc667, 0x0120c747, 0x0121c767, 0x0122cb47, 0x0123cb67, 0x0124c348,
+    0x0125c368, 0x012600e4, 0x012700f4, 0x0128c449, 0x0129c469, 0x012ac549,
+    0x012bc569, 0x012cc649, 0x012dc669, 0x012ece49, 0x012fce69, 0x0130c749,
+    0x013100f5, 0x013200e6, 0x013300f6, 0x0134c34a, 0x0135c36a, 0x0136cb4b,
+    0x0137cb6b, 0x013800f0, 0x0139c24c, 0x013ac26c, 0x013bcb4c, 0x013ccb6c,
+    0x013dcf4c, 0x013ecf6c, 0x013f00e7, 0x014000f7, 0x014100e8, 0x014200f8,
+    0x0143c24e, 0x0144c26e, 0x0145cb4e, 0x0146cb6e, 0x0147cf4e, 0x0148cf6e,
+    0x014900ef, 0x014a00ee, 0x014b00fe, 0x014cc54f, 0x014dc56f, 0x014ec64f,
+    0x014fc66f, 0x0150cd4f, 0x0151cd6f, 0x015200ea, 0x015300fa, 0x0154c252,
+    0x0155c272, 0x0156cb52, 0x0157cb72, 0x0158cf52, 0x0159cf72, 0x015ac253,
+    0x015bc273, 0x015cc353, 0x015dc373, 0x015ecb53, 0x015fcb73, 0x0160cf53,
+    0x0161cf73, 0x0162cb54, 0x0163cb74, 0x0164cf54, 0x0165cf74, 0x016600ed,
+    0x016700fd, 0x0168c455, 0x0169c475, 0x016ac555, 0x016bc575, 0x016cc655,
+    0x016dc675, 0x016eca55, 0x016fca75, 0x0170cd55, 0x0171cd75, 0x0172ce55,
+    0x0173ce75, 0x0174c357, 0x0175c377, 0x0176c359, 0x0177c379, 0x0178c859,
+    0x0179c25a, 0x017ac27a, 0x017bc75a, 0x017cc77a, 0x017dcf5a, 0x017ecf7a,
+    0x01cdcf41, 0x01cecf61, 0x01cfcf49, 0x01d0cf69, 0x01d1cf4f, 0x01d2cf6f,
+    0x01d3cf55, 0x01d4cf75, 0x01e6cf47, 0x01e7cf67, 0x01e8cf4b, 0x01e9cf6b,
+    0x01eace4f, 0x01ebce6f, 0x01f0cf6a, 0x01f4c247, 0x01f5c267, 0x01f8c14e,
+    0x01f9c16e, 0x021ecf48, 0x021fcf68, 0x0226c741, 0x0227c761, 0x0228cb45,
+    0x0229cb65, 0x022ec74f, 0x022fc76f, 0x0232c559, 0x0233c579, 0x02c7cf20,
+    0x02d8c620, 0x02d9c720, 0x02daca20, 0x02dbce20, 0x02ddcd20, 0x1e02c742,
+    0x1e03c762, 0x1e0ac744, 0x1e0bc764, 0x1e10cb44, 0x1e11cb64, 0x1e1ec746,
+    0x1e1fc766, 0x1e20c547, 0x1e21c567, 0x1e22c748, 0x1e23c768, 0x1e26c848,
+    0x1e27c868, 0x1e28cb48, 0x1e29cb68, 0x1e30c24b, 0x1e31c26b, 0x1e3ec24d,
+    0x1e3fc26d, 0x1e40c74d, 0x1e41c76d, 0x1e44c74e, 0x1e45c76e, 0x1e54c250,
+    0x1e55c270, 0x1e56c750, 0x1e57c770, 0x1e58c752, 0x1e59c772, 0x1e60c753,
+    0x1e61c773, 0x1e6ac754, 0x1e6bc774, 0x1e7cc456, 0x1e7dc476, 0x1e80c157,
+    0x1e81c177, 0x1e82c257, 0x1e83c277, 0x1e84c857, 0x1e85c877, 0x1e86c757,
+    0x1e87c777, 0x1e8ac758, 0x1e8bc778, 0x1e8cc858, 0x1e8dc878, 0x1e8ec759,
+    0x1e8fc779, 0x1e90c35a, 0x1e91c37a, 0x1e97c874, 0x1e98ca77, 0x1e99ca79,
+    0x1ebcc445, 0x1ebdc465, 0x1ef2c159, 0x1ef3c179, 0x1ef8c459, 0x1ef9c479,
+    0x201500d0, 0x201800a9, 0x201900b9, 0x201c00aa, 0x201d00ba, 0x20ac00a4,
+    0x212200d4, 0x212600e0, 0x215b00dc, 0x215c00dd, 0x215d00de, 0x215e00df,
+    0x219000ac, 0x219100ad, 0x219200ae, 0x219300af, 0x266a00d5
+};
+
+static void
+_DVBOpen(UConverter *cnv, UConverterLoadArgs *pArgs, UErrorCode *pErrorCode) {
+    UConverterDataDVB *myData;
+    UConverterNamePieces stackPieces;
+    UConverterLoadArgs stackArgs={ (int32_t)sizeof(UConverterLoadArgs) };
+    UErrorCode loadErrorCode;
+
+    if(pArgs->onlyTestIsLoadable) {
+        return;
+    }
+    cnv->extraInfo=uprv_malloc(sizeof(UConverterDataDVB));
+    if(cnv->extraInfo==NULL) {
+        *pErrorCode=U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    myData=(UConverterDataDVB *)cnv->extraInfo;
+
+    /* the two-byte tables are optional */
+    loadErrorCode=U_ZERO_ERROR;
+    myData->ksc=ucnv_loadSharedData("EUC-KR", &stackPieces, &stackArgs, &loadErrorCode);
+    if(U_FAILURE(loadErrorCode)) {
+        myData->ksc=NULL;
+    }
+    loadErrorCode=U_ZERO_ERROR;
+    myData->gb=ucnv_loadSharedData("GB2312", &stackPieces, &stackArgs, &loadErrorCode);
+    if(U_FAILURE(loadErrorCode)) {
+        myData->gb=NULL;
+    }
+}
+
+static void
+_DVBClose(UConverter *cnv) {
+    UConverterDataDVB *myData=(UConverterDataDVB *)cnv->extraInfo;
+
+    if(myData!=NULL) {
+        if(myData->ksc!=NULL) {
+            ucnv_unloadSharedDataIfReady(myData->ksc);
+        }
+        if(myData->gb!=NULL) {
+            ucnv_unloadSharedDataIfReady(myData->gb);
+        }
+        if(!cnv->isExtraLocal) {
+            uprv_free(myData);
+        }
+        cnv->extraInfo=NULL;
+    }
+}
+
+struct cloneDVBStruct
+{
+    UConverter cnv;
+    UConverterDataDVB mydata;
+};
+
+static UConverter *
+_DVBSafeClone(const UConverter *cnv,
+              void *stackBuffer,
+              int32_t *pBufferSize,
+              UErrorCode *status) {
+    struct cloneDVBStruct *localClone;
+    UConverterDataDVB *myData;
+
+    if(U_FAILURE(*status)) {
+        return 0;
+    }
+
+    if(*pBufferSize==0) { /* 'preflighting' request - set needed size into *pBufferSize */
+        *pBufferSize=(int32_t)sizeof(struct cloneDVBStruct);
+        return 0;
+    }
+
+    myData=(UConverterDataDVB *)cnv->extraInfo;
+    localClone=(struct cloneDVBStruct *)stackBuffer;
+    /* ucnv.c/ucnv_safeClone() copied the main UConverter already */
+
+    uprv_memcpy(&localClone->mydata, myData, sizeof(UConverterDataDVB));
+    localClone->cnv.extraInfo=&localClone->mydata;
+    localClone->cnv.isExtraLocal=TRUE;
+
+    /* share the two-byte tables */
+    if(myData->ksc!=NULL) {
+        ucnv_incrementRefCount(myData->ksc);
+    }
+    if(myData->gb!=NULL) {
+        ucnv_incrementRefCount(myData->gb);
+    }
+    return &localClone->cnv;
+}
+
+/*
+ * Copies the leading ASCII bytes of source[0..count[ to the target and
+ * returns their number.
+ */
+static int32_t
+dvbCopyASCII(UChar *target, const uint8_t *source, int32_t count) {
+    int32_t i;
+
+    if(count>=USIMD_MIN_RUN) {
+        return usimd_asciiToUChars(target, source, count);
+    }
+    for(i=0; i<count && source[i]<0x80; ++i) {
+        target[i]=source[i];
+    }
+    return i;
+}
+
+/*
+ * Writes c and its offset to the target, or to the overflow buffer when
+ * the target is full. Returns FALSE when it did not fit.
+ */
+static UBool
+dvbWriteUChar(UConverter *cnv,
+              UChar **pTarget, const UChar *targetLimit, int32_t **pOffsets,
+              UChar c, int32_t sourceIndex) {
+    if(*pTarget<targetLimit) {
+        *(*pTarget)++=c;
+        if(*pOffsets!=NULL) {
+            *(*pOffsets)++=sourceIndex;
+        }
+        return TRUE;
+    }
+    cnv->UCharErrorBuffer[cnv->UCharErrorBufferLength++]=c;
+    return FALSE;
+}
+
+/*
+ * Reads the character table selector, which may be split over buffers,
+ * and sets cnv->mode to the table. Returns the number of bytes read.
+ */
+static int32_t
+dvbReadSelector(UConverterToUnicodeArgs *pArgs, UErrorCode *pErrorCode) {
+    UConverter *cnv=pArgs->converter;
+    const uint8_t *source=(const uint8_t *)pArgs->source;
+    const uint8_t *sourceLimit=(const uint8_t *)pArgs->sourceLimit;
+    uint8_t *bytes=cnv->toUBytes;
+    int32_t length=cnv->toULength, needed;
+    uint8_t b;
+
+    if(length==0) {
+        if(source>=sourceLimit) {
+            return 0;
+        }
+        if(*source>=0x20) {
+            /* no selector, table 00 */
+            cnv->mode=DVB_6937;
+            return 0;
+        }
+        bytes[length++]=*source++;
+    }
+
+    b=bytes[0];
+    needed= b==0x10 ? 3 : b==0x1f ? 2 : 1;
+    while(length<needed && source<sourceLimit) {
+        bytes[length++]=*source++;
+    }
+    if(length<needed) {
+        /* the rest is in the next buffer */
+        cnv->toULength=(int8_t)length;
+    } else if(0x01<=b && b<=0x0b && b!=0x08) {
+        cnv->mode=b+4;
+        cnv->toULength=0;
+    } else if(b==0x10 && bytes[1]==0 && 1<=bytes[2] && bytes[2]<=15 && bytes[2]!=12) {
+        cnv->mode=bytes[2];
+        cnv->toULength=0;
+    } else if(b==0x11 || b==0x14) {
+        /* 0x14 is the Big5 subset of the BMP */
+        cnv->mode=DVB_UCS2;
+        cnv->toULength=0;
+    } else if(b==DVB_KSC || b==DVB_GB || b==DVB_UTF8) {
+        cnv->mode=b;
+        cnv->toULength=0;
+    } else {
+        /* reserved, or an encoding_type_id: report it and go on in table 00 */
+        cnv->mode=DVB_6937;
+        cnv->toULength=(int8_t)length;
+        *pErrorCode=U_UNSUPPORTED_ESCAPE_SEQUENCE;
+    }
+
+    length=(int32_t)(source-(const uint8_t *)pArgs->source);
+    pArgs->source=(const char *)source;
+    return length;
+}
+
+/* table 00 and ISO/IEC 8859 */
+static void
+dvbSingleByteToU(UConverterToUnicodeArgs *pArgs, int32_t sourceIndex,
+                 UErrorCode *pErrorCode) {
+    UConverter *cnv=pArgs->converter;
+    const uint8_t *source=(const uint8_t *)pArgs->source;
+    const uint8_t *sourceLimit=(const uint8_t *)pArgs->sourceLimit;
+    UChar *target=pArgs->target;
+    const UChar *targetLimit=pArgs->targetLimit;
+    int32_t *offsets=pArgs->offsets;
+    UBool is6937=(UBool)(cnv->mode==DVB_6937);
+    const UChar *table=dvbHighToU[is6937 ? 0 : cnv->mode];
+    int32_t count, index, diacriticIndex;
+    uint8_t b, diacritic;
+    UChar c;
+
+    /* a diacritic at the end of the previous buffer */
+    diacritic=0;
+    diacriticIndex=-1;
+    if(cnv->toULength>0) {
+        diacritic=cnv->toUBytes[0];
+        cnv->toULength=0;
+    }
+
+    for(;;) {
+        if(diacritic!=0) {
+            /* the letter after it */
+            if(source>=sourceLimit || target>=targetLimit) {
+                cnv->toUBytes[0]=diacritic;
+                cnv->toULength=1;
+                if(source<sourceLimit) {
+                    *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
+                }
+                break;
+            }
+            b=*source;
+            if(b==0x20) {
+                c=dvbSpacing[diacritic-0xc1];
+            } else if((uint8_t)(b-0x41)<=(0x7a-0x41) && (c=dvbCompose[diacritic-0xc1][b-0x41])!=0) {
+                /* precomposed */
+            } else if((uint8_t)(b-0x21)<=(0x7e - 0x21)) {
+                c=0;
+            } else {
+                /* no letter, the byte starts the next character */
+                cnv->toUBytes[0]=diacritic;
+                cnv->toULength=1;
+                *pErrorCode=U_ILLEGAL_CHAR_FOUND;
+                break;
+            }
+            ++source;
+            ++sourceIndex;
+            if(c!=0) {
+                *target++=c;
+                if(offsets!=NULL) {
+                    *offsets++=diacriticIndex;
+                }
+            } else {
+                /* the letter, then the combining mark */
+                *target++=b;
+                if(offsets!=NULL) {
+                    *offsets++=diacriticIndex;
+                }
+                if(!dvbWriteUChar(cnv, &target, targetLimit, &offsets,
+                                  dvbHighToU[0][diacritic-0xa0], diacriticIndex)) {
+                    *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
+                    break;
+                }
+            }
+            diacritic=0;
+        }
+
+        /* ASCII fast path */
+        count=(int32_t)(sourceLimit-source);
+        if(count>(int32_t)(targetLimit-target)) {
+            count=(int32_t)(targetLimit-target);
+        }
+        index=dvbCopyASCII(target, source, count);
+        source+=index;
+        target+=index;
+        if(offsets!=NULL) {
+            while(index>0) {
+                *offsets++=sourceIndex++;
+                --index;
+            }
+        } else {
+            sourceIndex+=index;
+        }
+
+        if(source>=sourceLimit) {
+            break;
+        }
+        if(target>=targetLimit) {
+            *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
+            break;
+        }
+
+        b=*source++;
+        index=sourceIndex++;
+        if(b<0xa0) {
+            /* a control code */
+            if(b!=DVB_CR_LF) {
+                continue;
+            }
+            c=0x0a;
+        } else {
+            c=table[b-0xa0];
+            if(c==0) {
+                cnv->toUBytes[0]=b;
+                cnv->toULength=1;
+                *pErrorCode=U_INVALID_CHAR_FOUND;
+                break;
+            }
+            if(is6937 && (uint8_t)(b-0xc1)<=(0xcf-0xc1)) {
+                diacritic=b;
+                diacriticIndex=index;
+                continue;
+            }
+        }
+        *target++=c;
+        if(offsets!=NULL) {
+            *offsets++=index;
+        }
+    }
+
+    pArgs->source=(const char *)source;
+    pArgs->target=target;
+    pArgs->offsets=offsets;
+}
+
+/* ISO/IEC 10646 BMP */
+static void
+dvbUCS2ToU(UConverterToUnicodeArgs *pArgs, int32_t sourceIndex,
+           UErrorCode *pErrorCode) {
+    UConverter *cnv=pArgs->converter;
+    const uint8_t *source=(const uint8_t *)pArgs->source;
+    const uint8_t *sourceLimit=(const uint8_t *)pArgs->sourceLimit;
+    UChar *target=pArgs->target;
+    const UChar *targetLimit=pArgs->targetLimit;
+    int32_t *offsets=pArgs->offsets;
+    int32_t index;
+    UChar c;
+
+    while(source<sourceLimit) {
+        if(target>=targetLimit) {
+            *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
+            break;
+        }
+        if(cnv->toULength>0) {
+            /* the first byte was in the previous buffer */
+            c=(UChar)((cnv->toUBytes[0]<<8)|*source++);
+            index=-1;
+            ++sourceIndex;
+            cnv->toULength=0;
+        } else if((sourceLimit-source)>=2) {
+            c=(UChar)((source[0]<<8)|source[1]);
+            source+=2;
+            index=sourceIndex;
+            sourceIndex+=2;
+        } else {
+            cnv->toUBytes[0]=*source++;
+            cnv->toULength=1;
+            break;
+        }
+
+        if(DVB_IS_CONTROL(c)) {
+            if(c!=(0xe000|DVB_CR_LF)) {
+                continue;
+            }
+            c=0x0a;
+        } else if(U16_IS_SURROGATE(c)) {
+            cnv->toUBytes[0]=(uint8_t)(c>>8);
+            cnv->toUBytes[1]=(uint8_t)c;
+            cnv->toULength=2;
+            *pErrorCode=U_ILLEGAL_CHAR_FOUND;
+            break;
+        }
+        *target++=c;
+        if(offsets!=NULL) {
+            *offsets++=index;
+        }
+    }
+
+    pArgs->source=(const char *)source;
+    pArgs->target=target;
+    pArgs->offsets=offsets;
+}
+
+/* UTF-8, checked as strictly as ucnv_u8.c does */
+static void
+dvbUTF8ToU(UConverterToUnicodeArgs *pArgs, int32_t sourceIndex,
+           UErrorCode *pErrorCode) {
+    static const UChar32 minLegal[5]={ 0, 0, 0x80, 0x800, 0x10000 };
+    UConverter *cnv=pArgs->converter;
+    const uint8_t *source=(const uint8_t *)pArgs->source;
+    const uint8_t *sourceLimit=(const uint8_t *)pArgs->sourceLimit;
+    UChar *target=pArgs->target;
+    const UChar *targetLimit=pArgs->targetLimit;
+    int32_t *offsets=pArgs->offsets;
+    uint8_t *bytes=cnv->toUBytes;
+    int32_t count, length, needed, index, i;
+    UChar32 c;
+
+    while(source<sourceLimit) {
+        if(target>=targetLimit) {
+            *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
+            break;
+        }
+        length=cnv->toULength;
+        if(length==0) {
+            if(*source<0x80) {
+                /* ASCII fast path */
+                count=(int32_t)(sourceLimit-source);
+                if(count>(int32_t)(targetLimit-target)) {
+                    count=(int32_t)(targetLimit-target);
+                }
+                count=dvbCopyASCII(target, source, count);
+                source+=count;
+                target+=count;
+                if(offsets!=NULL) {
+                    while(count>0) {
+                        *offsets++=sourceIndex++;
+                        --count;
+                    }
+                } else {
+                    sourceIndex+=count;
+                }
+                continue;
+            }
+            index=sourceIndex++;
+            bytes[length++]=*source++;
+            if(bytes[0]<0xc2 || bytes[0]>0xf4) {
+                cnv->toULength=1;
+                *pErrorCode=U_ILLEGAL_CHAR_FOUND;
+                break;
+            }
+        } else {
+            /* the sequence began in the previous buffer */
+            index=-1;
+        }
+
+        needed=1+U8_COUNT_TRAIL_BYTES(bytes[0]);
+        while(length<needed && source<sourceLimit && U8_IS_TRAIL(*source)) {
+            bytes[length++]=*source++;
+            ++sourceIndex;
+        }
+        cnv->toULength=(int8_t)length;
+        if(length<needed) {
+            if(source<sourceLimit) {
+                /* cut short by a byte that is not a trail byte */
+                *pErrorCode=U_ILLEGAL_CHAR_FOUND;
+            }
+            break;
+        }
+
+        c=bytes[0]&(0x7f>>needed);
+        for(i=1; i<length; ++i) {
+            c=(c<<6)|(bytes[i]&0x3f);
+        }
+        if(c<minLegal[needed] || U_IS_SURROGATE(c) || c>0x10ffff) {
+            *pErrorCode=U_ILLEGAL_CHAR_FOUND;
+            break;
+        }
+        cnv->toULength=0;
+
+        if(DVB_IS_CONTROL(c)) {
+            if(c!=(0xe000|DVB_CR_LF)) {
+                continue;
+            }
+            c=0x0a;
+        }
+        if(c<=0xffff) {
+            *target++=(UChar)c;
+            if(offsets!=NULL) {
+                *offsets++=index;
+            }
+        } else {
+            *target++=U16_LEAD(c);
+            if(offsets!=NULL) {
+                *offsets++=index;
+            }
+            if(!dvbWriteUChar(cnv, &target, targetLimit, &offsets, U16_TRAIL(c), index)) {
+                *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
+                break;
+            }
+        }
+    }
+
+    pArgs->source=(const char *)source;
+    pArgs->target=target;
+    pArgs->offsets=offsets;
+}
+
+/* KS X 1001 and GB 2312, with ASCII and the two-byte table in EUC form */
+static void
+dvbDBCSToU(UConverterToUnicodeArgs *pArgs, UConverterSharedData *sharedData,
+           int32_t sourceIndex, UErrorCode *pErrorCode) {
+    UConverter *cnv=pArgs->converter;
+    const uint8_t *source=(const uint8_t *)pArgs->source;
+    const uint8_t *sourceLimit=(const uint8_t *)pArgs->sourceLimit;
+    UChar *target=pArgs->target;
+    const UChar *targetLimit=pArgs->targetLimit;
+    int32_t *offsets=pArgs->offsets;
+    uint8_t *bytes=cnv->toUBytes;
+    int32_t count, index;
+    UChar32 c;
+    uint8_t b;
+
+    while(source<sourceLimit) {
+        if(target>=targetLimit) {
+            *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
+            break;
+        }
+        if(cnv->toULength==0) {
+            if(*source<0x80) {
+                /* ASCII fast path */
+                count=(int32_t)(sourceLimit-source);
+                if(count>(int32_t)(targetLimit-target)) {
+                    count=(int32_t)(targetLimit-target);
+                }
+                count=dvbCopyASCII(target, source, count);
+                source+=count;
+                target+=count;
+                if(offsets!=NULL) {
+                    while(count>0) {
+                        *offsets++=sourceIndex++;
+                        --count;
+                    }
+                } else {
+                    sourceIndex+=count;
+                }
+                continue;
+            }
+            index=sourceIndex++;
+            bytes[0]=*source++;
+            cnv->toULength=1;
+            if(source>=sourceLimit) {
+                /* the trail byte is in the next buffer */
+                break;
+            }
+        } else {
+            index=-1;
+        }
+
+        b=*source;
+        if(b<0x80) {
+            /* the lead byte on its own, the byte starts the next character */
+            *pErrorCode=U_ILLEGAL_CHAR_FOUND;
+            break;
+        }
+        ++source;
+        ++sourceIndex;
+        bytes[1]=b;
+        cnv->toULength=2;
+
+        if(bytes[0]==0xe0 && b<0xa0) {
+            /* a control code */
+            cnv->toULength=0;
+            if(b!=DVB_CR_LF) {
+                continue;
+            }
+            c=0x0a;
+        } else if(sharedData==NULL) {
+            *pErrorCode=U_INVALID_CHAR_FOUND;
+            break;
+        } else {
+            c=ucnv_MBCSSimpleGetNextUChar(sharedData, (const char *)bytes, 2, cnv->useFallback);
+            if(c>=0xfffe) {
+                *pErrorCode= c==0xfffe ? U_INVALID_CHAR_FOUND : U_ILLEGAL_CHAR_FOUND;
+                break;
+            }
+            cnv->toULength=0;
+        }
+
+        if(c<=0xffff) {
+            *target++=(UChar)c;
+            if(offsets!=NULL) {
+                *offsets++=index;
+            }
+        } else {
+            *target++=U16_LEAD(c);
+            if(offsets!=NULL) {
+                *offsets++=index;
+            }
+            if(!dvbWriteUChar(cnv, &target, targetLimit, &offsets, U16_TRAIL(c), index)) {
+                *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
+                break;
+            }
+        }
+    }
+
+    pArgs->source=(const char *)source;
+    pArgs->target=target;
+    pArgs->offsets=offsets;
+}
+
+static void
+_DVBToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
+                         UErrorCode *pErrorCode) {
+    UConverter *cnv=pArgs->converter;
+    UConverterDataDVB *myData=(UConverterDataDVB *)cnv->extraInfo;
+    int32_t sourceIndex=0;
+
+    if(cnv->mode==DVB_SELECTOR) {
+        sourceIndex=dvbReadSelector(pArgs, pErrorCode);
+        if(cnv->mode==DVB_SELECTOR || U_FAILURE(*pErrorCode)) {
+            return;
+        }
+    }
+
+    switch(cnv->mode) {
+    case DVB_UCS2:
+        dvbUCS2ToU(pArgs, sourceIndex, pErrorCode);
+        break;
+    case DVB_UTF8:
+        dvbUTF8ToU(pArgs, sourceIndex, pErrorCode);
+        break;
+    case DVB_KSC:
+        dvbDBCSToU(pArgs, myData->ksc, sourceIndex, pErrorCode);
+        break;
+    case DVB_GB:
+        dvbDBCSToU(pArgs, myData->gb, sourceIndex, pErrorCode);
+        break;
+    default:
+        dvbSingleByteToU(pArgs, sourceIndex, pErrorCode);
+        break;
+    }
+}
+
+/*
+ * Returns the table 00 bytes for c, a diacritic in the high byte if there
+ * is one, or 0.
+ */
+static uint32_t
+dvbFromUBytes(UChar c) {
+    int32_t start=0, limit=LENGTHOF(dvbFromU), mid;
+    UChar u;
+
+    while(start<limit) {
+        mid=(start+limit)/2;
+        u=(UChar)(dvbFromU[mid]>>16);
+        if(c<u) {
+            limit=mid;
+        } else if(c>u) {
+            start=mid+1;
+        } else {
+            return dvbFromU[mid]&0xffff;
+        }
+    }
+    return 0;
+}
+
+static void
+_DVBFromUnicodeWithOffsets(UConverterFromUnicodeArgs *pArgs,
+                           UErrorCode *pErrorCode) {
+    UConverter *cnv=pArgs->converter;
+    const UChar *source=pArgs->source;
+    const UChar *sourceLimit=pArgs->sourceLimit;
+    uint8_t *target=(uint8_t *)pArgs->target;
+    const uint8_t *targetLimit=(const uint8_t *)pArgs->targetLimit;
+    int32_t *offsets=pArgs->offsets;
+    int32_t sourceIndex;
+    uint32_t bytes;
+    UChar32 cp;
+    UChar c;
+
+    /* get the converter state from UConverter */
+    cp=cnv->fromUChar32;
+
+    /* sourceIndex=-1 if the current character began in the previous buffer */
+    sourceIndex= cp==0 ? 0 : -1;
+
+    if(cp!=0 && source<sourceLimit) {
+        goto getTrail;
+    }
+
+    while(source<sourceLimit) {
+        if(target>=targetLimit) {
+            *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
+            break;
+        }
+
+        c=*source;
+        if((uint16_t)(c-0x20)<0x5f) {
+            /* ASCII fast path */
+            do {
+                *target++=(uint8_t)c;
+                ++source;
+                if(offsets!=NULL) {
+                    *offsets++=sourceIndex;
+                }
+                ++sourceIndex;
+            } while(source<sourceLimit && target<targetLimit &&
+                    (uint16_t)((c=*source)-0x20)<0x5f);
+            continue;
+        }
+
+        ++source;
+        if(c==0x0a) {
+            bytes=DVB_CR_LF;
+        } else if(U16_IS_SURROGATE(c)) {
+            cp=c;
+            if(U16_IS_SURROGATE_LEAD(cp)) {
+getTrail:
+                if(source<sourceLimit) {
+                    /* test the following code unit */
+                    UChar trail=*source;
+                    if(U16_IS_TRAIL(trail)) {
+                        ++source;
+                        cp=U16_GET_SUPPLEMENTARY(cp, trail);
+                        /* table 00 has no supplementary code points */
+                        *pErrorCode=U_INVALID_CHAR_FOUND;
+                    } else {
+                        /* this is an unmatched lead code unit (1st surrogate) */
+                        *pErrorCode=U_ILLEGAL_CHAR_FOUND;
+                    }
+                } else {
+                    /* no more input */
+                    cnv->fromUChar32=cp;
+                    break;
+                }
+            } else {
+                /* this is an unmatched trail code unit (2nd surrogate) */
+                *pErrorCode=U_ILLEGAL_CHAR_FOUND;
+            }
+            cnv->fromUChar32=cp;
+            break;
+        } else if(c<0x80 || (bytes=dvbFromUBytes(c))==0) {
+            /*
+             * The C0 controls are unassigned, so that no string begins
+             * with what would be read as a selector.
+             */
+            cnv->fromUChar32=c;
+            *pErrorCode=U_INVALID_CHAR_FOUND;
+            break;
+        }
+
+        if(bytes>0xff) {
+            /* a diacritic and the letter */
+            *target++=(uint8_t)(bytes>>8);
+            if(offsets!=NULL) {
+                *offsets++=sourceIndex;
+            }
+            if(target<targetLimit) {
+                *target++=(uint8_t)bytes;
+                if(offsets!=NULL) {
+                    *offsets++=sourceIndex;
+                }
+            } else {
+                cnv->charErrorBuffer[0]=(uint8_t)bytes;
+                cnv->charErrorBufferLength=1;
+                *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
+                break;
+            }
+        } else {
+            *target++=(uint8_t)bytes;
+            if(offsets!=NULL) {
+                *offsets++=sourceIndex;
+            }
+        }
+        ++sourceIndex;
+    }
+
+    /* write back the updated pointers */
+    pArgs->source=source;
+    pArgs->target=(char *)target;
+    pArgs->offsets=offsets;
+}
+
+static void
+_DVBGetUnicodeSet(const UConverter *cnv,
+                  const USetAdder *sa,
+                  UConverterUnicodeSet which,
+                  UErrorCode *pErrorCode) {
+    int32_t i;
+
+    /* what converts to table 00 */
+    sa->add(sa->set, 0x0a);
+    sa->addRange(sa->set, 0x20, 0x7e);
+    for(i=0; i<LENGTHOF(dvbFromU); ++i) {
+        sa->add(sa->set, (UChar32)(dvbFromU[i]>>16));
+    }
+}
+
+static const UConverterImpl _DVBImpl={
+    UCNV_DVB,
+
+    NULL,
+    NULL,
+
+    _DVBOpen,
+    _DVBClose,
+    NULL,
+
+    _DVBToUnicodeWithOffsets,
+    _DVBToUnicodeWithOffsets,
+    _DVBFromUnicodeWithOffsets,
+    _DVBFromUnicodeWithOffsets,
+    NULL,
+
+    NULL,
+    NULL,
+    NULL,
+    _DVBSafeClone,
+    _DVBGetUnicodeSet
+};
+
+/* the substitution character is '?' as 0x1a at the start would be a selector */
+static const UConverterStaticData _DVBStaticData={
+    sizeof(UConverterStaticData),
+    "DVB",
+    0, UCNV_IBM, UCNV_DVB, 1, 2,
+    { 0x3f, 0, 0, 0 }, 1, FALSE, FALSE,
+    0,
+    0,
+    { 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0 } /* reserved */
+};
+
+const UConverterSharedData _DVBData={
+    sizeof(UConverterSharedData), ~((uint32_t) 0),
+    NULL, NULL, &_DVBStaticData, FALSE, &_DVBImpl,
+    0
+};
+
+#endif
@@ -57,6 +57,7 @@
 #include "cmemory.h"
 #include "cstring.h"
 #include "umutex.h"
+#include "usimd.h"
 
 /* control optimizations according to the platform */
 #define MBCS_UNROLL_SINGLE_TO_BMP 1
@@ -2335,6 +2336,7 @@ ucnv_MBCSToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
     int32_t entry;
     UChar c;
     uint8_t action;
+    UBool asciiRuns;
 
     /* use optimized function if possible */
     cnv=pArgs->converter;
@@ -2392,6 +2394,13 @@ ucnv_MBCSToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
     sourceIndex=byteIndex==0 ? 0 : -1;
     nextSourceIndex=0;
 
+    /*
+     * ASCII bytes can be copied in runs if all of them are mapped directly
+     * to U+0000..U+007F in the initial state, with no state change.
+     */
+    asciiRuns=(UBool)(stateTable==cnv->sharedData->mbcs.stateTable &&
+                      cnv->sharedData->mbcs.asciiRoundtrips==0xffffffff);
+
     /* conversion loop */
     while(source<sourceLimit) {
         /*
@@ -2412,6 +2421,19 @@ ucnv_MBCSToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
             /* optimized loop for 1/2-byte input and BMP output */
             if(offsets==NULL) {
                 do {
+                    if(asciiRuns && state==0 && *source<=0x7f) {
+                        /* copy a run of ASCII at once */
+                        int32_t length=(int32_t)(sourceLimit-source);
+                        if(length>(int32_t)(targetLimit-target)) {
+                            length=(int32_t)(targetLimit-target);
+                        }
+                        length=usimd_asciiToUChars(target, source, length);
+                        source+=length;
+                        target+=length;
+                        if(source>=sourceLimit || target>=targetLimit) {
+                            break;
+                        }
+                    }
                     entry=stateTable[state][*source];
                     if(MBCS_ENTRY_IS_TRANSITION(entry)) {
                         state=(uint8_t)MBCS_ENTRY_TRANSITION_STATE(entry);
@@ -3326,6 +3348,20 @@ ucnv_MBCSDoubleFromUnicodeWithOffsets(UConverterFromUnicodeArgs *pArgs,
             c=*source++;
             ++nextSourceIndex;
             if(c<=0x7f && IS_ASCII_ROUNDTRIP(c, asciiRoundtrips)) {
+                if(asciiRoundtrips==0xffffffff && offsets==NULL) {
+                    /* copy a run of ASCII at once */
+                    int32_t length=(int32_t)(sourceLimit-source)+1;
+                    if(length>targetCapacity) {
+                        length=targetCapacity;
+                    }
+                    length=usimd_asciiFromUChars(target, source-1, length);
+                    source+=length-1;
+                    nextSourceIndex+=length-1;
+                    target+=length;
+                    targetCapacity-=length;
+                    c=0;
+                    continue;
+                }
                 *target++=(uint8_t)c;
                 if(offsets!=NULL) {
                     *offsets++=sourceIndex;
@@ -4055,6 +4091,20 @@ ucnv_MBCSFromUnicodeWithOffsets(UConverterFromUnicodeArgs *pArgs,
             c=*source++;
             ++nextSourceIndex;
             if(c<=0x7f && IS_ASCII_ROUNDTRIP(c, asciiRoundtrips)) {
+                if(asciiRoundtrips==0xffffffff && offsets==NULL) {
+                    /* copy a run of ASCII at once */
+                    int32_t length=(int32_t)(sourceLimit-source)+1;
+                    if(length>targetCapacity) {
+                        length=targetCapacity;
+                    }
+                    length=usimd_asciiFromUChars(target, source-1, length);
+                    source+=length-1;
+                    nextSourceIndex+=length-1;
+                    target+=length;
+                    targetCapacity-=length;
+                    c=0;
+                    continue;
+                }
                 *target++=(uint8_t)c;
                 if(offsets!=NULL) {
                     *offsets++=sourceIndex;
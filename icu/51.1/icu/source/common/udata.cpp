@@ -1,7 +1,7 @@
 /*
 ******************************************************************************
 *
-*   Copyright (C) 1999-2012, International Business Machines
+*   Copyright (C) 1999-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 ******************************************************************************
@@ -66,9 +66,12 @@ might have to #include some other header
 /* If you are excruciatingly bored turn this on .. */
 /* #define UDATA_DEBUG 1 */
 
-#if defined(UDATA_DEBUG)
+#if defined(UDATA_DEBUG) || !UCONFIG_NO_FILE_IO
 #   include <stdio.h>
 #endif
+#if !UCONFIG_NO_FILE_IO
+#   include <stdlib.h>
+#endif
 
 #define LENGTHOF(array) (int32_t)(sizeof(array)/sizeof((array)[0]))
 
@@ -109,11 +112,27 @@ static UHashtable  *gCommonDataCache = NULL;  /* Global hash table of opened ICU
 
 static UDataFileAccess  gDataFileAccess = UDATA_DEFAULT_ACCESS;
 
+/*
+ * The usage log, see udata_setUsageLog().
+ * gUsageLogItems holds the names of the items already written to it.
+ */
+static char        *gUsageLogPath = NULL;
+static UBool        gHaveCheckedUsageLogEnv = FALSE;
+static UHashtable  *gUsageLogItems = NULL;
+
 static UBool U_CALLCONV
 udata_cleanup(void)
 {
     int32_t i;
 
+    if (gUsageLogItems) {
+        uhash_close(gUsageLogItems);
+        gUsageLogItems = NULL;
+    }
+    uprv_free(gUsageLogPath);
+    gUsageLogPath = NULL;
+    gHaveCheckedUsageLogEnv = FALSE;
+
     if (gCommonDataCache) {             /* Delete the cache of user data mappings.  */
         uhash_close(gCommonDataCache);  /*   Table owns the contents, and will delete them. */
         gCommonDataCache = NULL;        /*   Cleanup is not thread safe.                */
@@ -1078,6 +1097,58 @@ static UDataMemory *doLoadFromCommonData(UBool isICUData, const char * /*pkgName
     }
 }
 
+/*
+ * Append the name of an opened ICU data item to the usage log,
+ * the first time the item is opened.
+ */
+static void
+recordDataUsage(const char *itemName) {
+#if !UCONFIG_NO_FILE_IO
+    UBool isRecording;
+    UMTX_CHECK(NULL, (gUsageLogPath != NULL || !gHaveCheckedUsageLogEnv), isRecording);
+    if (!isRecording) {
+        return;
+    }
+
+    umtx_lock(NULL);
+    if (!gHaveCheckedUsageLogEnv) {
+        const char *envPath = getenv("ICU_DATA_USAGE_LOG");
+        gHaveCheckedUsageLogEnv = TRUE;
+        if (envPath != NULL && *envPath != 0) {
+            gUsageLogPath = (char *)uprv_malloc(uprv_strlen(envPath) + 1);
+            if (gUsageLogPath != NULL) {
+                uprv_strcpy(gUsageLogPath, envPath);
+            }
+        }
+        ucln_common_registerCleanup(UCLN_COMMON_UDATA, udata_cleanup);
+    }
+    if (gUsageLogPath != NULL) {
+        UErrorCode errorCode = U_ZERO_ERROR;
+        if (gUsageLogItems == NULL) {
+            gUsageLogItems = uhash_open(uhash_hashChars, uhash_compareChars, NULL, &errorCode);
+            if (U_SUCCESS(errorCode)) {
+                uhash_setKeyDeleter(gUsageLogItems, uprv_free);
+            }
+        }
+        if (U_SUCCESS(errorCode) && uhash_geti(gUsageLogItems, itemName) == 0) {
+            char *key = (char *)uprv_malloc(uprv_strlen(itemName) + 1);
+            if (key != NULL) {
+                uprv_strcpy(key, itemName);
+                uhash_puti(gUsageLogItems, key, 1, &errorCode);
+                FILE *log = fopen(gUsageLogPath, "a");
+                if (log != NULL) {
+                    fprintf(log, "%s\n", itemName);
+                    fclose(log);
+                }
+            }
+        }
+    }
+    umtx_unlock(NULL);
+#else
+    (void)itemName;
+#endif
+}
+
 /*
  *  A note on the ownership of Mapped Memory
  *
@@ -1228,6 +1299,8 @@ doOpenChoice(const char *path, const char *type, const char *name,
         tocEntryPath.append(".", *pErrorCode).append(type, *pErrorCode);
     }
     tocEntryPathSuffix = tocEntryPath.data()+tocEntrySuffixIndex; /* suffix starts here */
+    /* The name of the item relative to the package, as in icupkg lists: 'coll/ar.res' */
+    const char *itemName = tocEntryName.data()+tocEntrySuffixIndex+1;
 
 #ifdef UDATA_DEBUG
     fprintf(stderr, " tocEntryName = %s\n", tocEntryName.data());
@@ -1256,6 +1329,9 @@ doOpenChoice(const char *path, const char *type, const char *name,
                             pkgName.data(), dataPath, tocEntryPathSuffix, tocEntryName.data(),
                             path, type, name, isAcceptable, context, &subErrorCode, pErrorCode);
         if((retVal != NULL) || U_FAILURE(*pErrorCode)) {
+            if(retVal != NULL && isICUData) {
+                recordDataUsage(itemName);
+            }
             return retVal;
         }
     }
@@ -1271,6 +1347,9 @@ doOpenChoice(const char *path, const char *type, const char *name,
             retVal = doLoadFromIndividualFiles(pkgName.data(), dataPath, tocEntryPathSuffix,
                             path, type, name, isAcceptable, context, &subErrorCode, pErrorCode);
             if((retVal != NULL) || U_FAILURE(*pErrorCode)) {
+                if(retVal != NULL && isICUData) {
+                    recordDataUsage(itemName);
+                }
                 return retVal;
             }
         }
@@ -1286,6 +1365,9 @@ doOpenChoice(const char *path, const char *type, const char *name,
                             pkgName.data(), dataPath, tocEntryPathSuffix, tocEntryName.data(),
                             path, type, name, isAcceptable, context, &subErrorCode, pErrorCode);
         if((retVal != NULL) || U_FAILURE(*pErrorCode)) {
+            if(retVal != NULL && isICUData) {
+                recordDataUsage(itemName);
+            }
             return retVal;
         }
     }
@@ -1301,6 +1383,9 @@ doOpenChoice(const char *path, const char *type, const char *name,
                             pkgName.data(), "", tocEntryPathSuffix, tocEntryName.data(),
                             path, type, name, isAcceptable, context, &subErrorCode, pErrorCode);
         if((retVal != NULL) || U_FAILURE(*pErrorCode)) {
+            if(retVal != NULL && isICUData) {
+                recordDataUsage(itemName);
+            }
             return retVal;
         }
     }
@@ -1388,3 +1473,84 @@ U_CAPI void U_EXPORT2 udata_setFileAccess(UDataFileAccess access, UErrorCode * /
 {
     gDataFileAccess = access;
 }
+
+U_CAPI void U_EXPORT2
+udata_setUsageLog(const char *path, UErrorCode *status) {
+    char *newPath = NULL;
+
+    if (U_FAILURE(*status)) {
+        return;
+    }
+    if (path != NULL && *path != 0) {
+        newPath = (char *)uprv_malloc(uprv_strlen(path) + 1);
+        if (newPath == NULL) {
+            *status = U_MEMORY_ALLOCATION_ERROR;
+            return;
+        }
+        uprv_strcpy(newPath, path);
+    }
+
+    umtx_lock(NULL);
+    uprv_free(gUsageLogPath);
+    gUsageLogPath = newPath;
+    gHaveCheckedUsageLogEnv = TRUE;
+    if (gUsageLogItems != NULL) {
+        /* A new log starts over. */
+        uhash_removeAll(gUsageLogItems);
+    }
+    ucln_common_registerCleanup(UCLN_COMMON_UDATA, udata_cleanup);
+    umtx_unlock(NULL);
+}
+
+U_CAPI void U_EXPORT2
+udata_setRandomAccess(UBool randomAccess, UErrorCode *status) {
+    if (U_FAILURE(*status)) {
+        return;
+    }
+    uprv_setMapFileRandomAccess(randomAccess);
+}
+
+U_CAPI void U_EXPORT2
+udata_getResidentSize(int32_t *pMappedSize, int32_t *pResidentSize, UErrorCode *status) {
+    int32_t mappedSize = 0, residentSize = 0;
+    UBool isSupported = TRUE;
+
+    if (U_FAILURE(*status)) {
+        return;
+    }
+    if (pMappedSize == NULL || pResidentSize == NULL) {
+        *status = U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+
+    /*
+     * All packages mapped from files are in the cache,
+     * including the common ICU data if it was loaded from a .dat file.
+     */
+    umtx_lock(NULL);
+    if (gCommonDataCache != NULL) {
+        int32_t pos = -1;
+        const UHashElement *e;
+        while ((e = uhash_nextElement(gCommonDataCache, &pos)) != NULL) {
+            const UDataMemory *item = ((const DataCacheElement *)e->value.pointer)->item;
+            int32_t mapped, resident;
+            if (item->map == NULL) {
+                continue;  /* not a file mapping, e.g. from udata_setAppData() */
+            }
+            if (!uprv_getMappedFileResidentSize(item, &mapped, &resident)) {
+                isSupported = FALSE;
+                break;
+            }
+            mappedSize += mapped;
+            residentSize += resident;
+        }
+    }
+    umtx_unlock(NULL);
+
+    if (!isSupported) {
+        *status = U_UNSUPPORTED_ERROR;
+        return;
+    }
+    *pMappedSize = mappedSize;
+    *pResidentSize = residentSize;
+}
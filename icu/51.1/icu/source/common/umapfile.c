@@ -1,7 +1,7 @@
 /*
 ******************************************************************************
 *
-*   Copyright (C) 1999-2011, International Business Machines
+*   Copyright (C) 1999-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 ******************************************************************************/
@@ -69,6 +69,9 @@
 #   define IS_MAP(map) ((map)!=NULL)
 #endif
 
+/* Set by uprv_setMapFileRandomAccess(). */
+static UBool gRandomAccess = FALSE;
+
 /*----------------------------------------------------------------------------*
  *                                                                            *
  *   Memory Mapped File support.  Platform dependent implementation of        *
@@ -192,6 +195,11 @@
         pData->mapAddr = data;
 #if U_PLATFORM == U_PF_IPHONE
         posix_madvise(data, length, POSIX_MADV_RANDOM);
+#elif defined(POSIX_MADV_RANDOM)
+        /* Page in only what is used, rather than reading ahead. */
+        if(gRandomAccess) {
+            posix_madvise(data, length, POSIX_MADV_RANDOM);
+        }
 #endif
         return TRUE;
     }
@@ -459,3 +467,59 @@
 #else
 #   error MAP_IMPLEMENTATION is set incorrectly
 #endif
+
+/*----------------------------------------------------------------------------*
+ *                                                                            *
+ *   Access pattern and residency of mapped files.                            *
+ *                                                                            *
+ *----------------------------------------------------------------------------*/
+U_CFUNC void
+uprv_setMapFileRandomAccess(UBool randomAccess) {
+    gRandomAccess = randomAccess;
+}
+
+#if MAP_IMPLEMENTATION==MAP_POSIX && \
+    (U_PLATFORM_IS_LINUX_BASED || U_PLATFORM_IS_DARWIN_BASED || U_PLATFORM == U_PF_BSD)
+#   include "cmemory.h"
+
+    U_CFUNC UBool
+    uprv_getMappedFileResidentSize(const UDataMemory *pData, int32_t *pMappedSize, int32_t *pResidentSize) {
+        size_t pageSize, length, pageCount, i;
+        unsigned char *vec;
+        int32_t resident;
+
+        if(pData==NULL || pData->map==NULL || pData->mapAddr==NULL) {
+            return FALSE;
+        }
+        pageSize=(size_t)sysconf(_SC_PAGESIZE);
+        length=(size_t)((const char *)pData->map - (const char *)pData->mapAddr);
+        pageCount=(length+pageSize-1)/pageSize;
+        vec=(unsigned char *)uprv_malloc(pageCount>0 ? pageCount : 1);
+        if(vec==NULL) {
+            return FALSE;
+        }
+        /* The vector is char * on some platforms and unsigned char * on others. */
+        if(mincore((void *)pData->mapAddr, length, (void *)vec)!=0) {
+            uprv_free(vec);
+            return FALSE;
+        }
+        resident=0;
+        for(i=0; i<pageCount; ++i) {
+            if(vec[i]&1) {
+                ++resident;
+            }
+        }
+        uprv_free(vec);
+        *pMappedSize=(int32_t)length;
+        *pResidentSize=(int32_t)((size_t)resident*pageSize > length ? length : (size_t)resident*pageSize);
+        return TRUE;
+    }
+#else
+    U_CFUNC UBool
+    uprv_getMappedFileResidentSize(const UDataMemory *pData, int32_t *pMappedSize, int32_t *pResidentSize) {
+        (void)pData;
+        (void)pMappedSize;
+        (void)pResidentSize;
+        return FALSE;
+    }
+#endif
@@ -1,7 +1,7 @@
 /*
 ******************************************************************************
 *
-*   Copyright (C) 1999-2011, International Business Machines
+*   Copyright (C) 1999-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 ******************************************************************************/
@@ -30,6 +30,16 @@
 U_CFUNC UBool uprv_mapFile(UDataMemory *pdm, const char *path);
 U_CFUNC void  uprv_unmapFile(UDataMemory *pData);
 
+/* Advise the system that files mapped from now on are read randomly. */
+U_CFUNC void  uprv_setMapFileRandomAccess(UBool randomAccess);
+
+/*
+ * Get the length of a mapped file and how much of it is in memory.
+ * Returns FALSE if pData is not a mapped file or if the platform cannot tell.
+ */
+U_CFUNC UBool uprv_getMappedFileResidentSize(const UDataMemory *pData,
+                                             int32_t *pMappedSize, int32_t *pResidentSize);
+
 /* MAP_NONE: no memory mapping, no file access at all */
 #define MAP_NONE        0
 #define MAP_WIN32       1
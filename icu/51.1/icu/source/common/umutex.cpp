@@ -1,7 +1,7 @@
 /*
 ******************************************************************************
 *
-*   Copyright (C) 1997-2012, International Business Machines
+*   Copyright (C) 1997-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 ******************************************************************************
@@ -38,6 +38,7 @@
 
 #if defined(POSIX)
 # include <pthread.h> /* must be first, so that we get the multithread versions of things. */
+# include <sched.h>
 #endif /* POSIX */
 
 #if U_PLATFORM_HAS_WIN32_API
@@ -363,6 +364,72 @@ static void *mutexed_compare_and_swap(void **dest, void *newval, void *oldval) {
 
 
 
+/*-----------------------------------------------------------------
+ *
+ *  One time initialization
+ *     umtx_initImplPreInit
+ *     umtx_initImplPostInit
+ *
+ *  The fast path of umtx_initOnce(), a load-acquire of fState, is inline
+ *  in umutex.h.  These functions are reached only until the initialization
+ *  is complete.  fState values:
+ *     0   initialization has not been started.
+ *     1   initialization is in progress in some thread.
+ *     2   initialization is complete.
+ *
+ *  A thread that finds the initialization in progress polls, releasing
+ *  initMutex while it yields, rather than waiting on a condition variable;
+ *  user supplied mutex functions (u_setMutexFunctions()) provide only
+ *  lock and unlock.
+ *
+ *----------------------------------------------------------------*/
+
+// Guards the fState transitions of all UInitOnce objects.
+// Never held while an initialization function runs.
+static UMutex   initMutex = U_MUTEX_INITIALIZER;
+
+static void initOnceYield() {
+#if U_PLATFORM_HAS_WIN32_API
+    Sleep(0);
+#elif defined(POSIX)
+    sched_yield();
+#endif
+}
+
+U_NAMESPACE_BEGIN
+
+U_COMMON_API UBool U_EXPORT2
+umtx_initImplPreInit(UInitOnce &uio) {
+    umtx_lock(&initMutex);
+    int32_t state = uio.fState;
+    if (state == 0) {
+        umtx_storeRelease(uio.fState, 1);
+        umtx_unlock(&initMutex);
+        return TRUE;   // Caller will next call the init function.
+    }
+    while (state == 1) {
+        // Another thread is running the initialization.
+        umtx_unlock(&initMutex);
+        initOnceYield();
+        umtx_lock(&initMutex);
+        state = uio.fState;
+    }
+    U_ASSERT(state == 2);
+    umtx_unlock(&initMutex);
+    return FALSE;
+}
+
+U_COMMON_API void U_EXPORT2
+umtx_initImplPostInit(UInitOnce &uio) {
+    umtx_lock(&initMutex);
+    umtx_storeRelease(uio.fState, 2);
+    umtx_unlock(&initMutex);
+}
+
+U_NAMESPACE_END
+
+
+
 /*-----------------------------------------------------------------
  *
  *  Atomic Increment and Decrement
@@ -1,6 +1,6 @@
 /*
 **********************************************************************
-*   Copyright (C) 1997-2012, International Business Machines
+*   Copyright (C) 1997-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 **********************************************************************
 *
@@ -225,5 +225,134 @@ U_CAPI void U_EXPORT2 umtx_unlock (UMutex* mutex);
 U_CAPI int32_t U_EXPORT2 umtx_atomic_inc(int32_t *);
 U_CAPI int32_t U_EXPORT2 umtx_atomic_dec(int32_t *);
 
+#ifdef __cplusplus
+
+/*
+ * Atomic load with acquire semantics, and store with release semantics, of an
+ * int32_t.  Memory operations that follow the load can not be moved ahead of it,
+ * and memory operations that precede the store can not be moved after it.
+ * For use with lock-free lazy initialization; see umtx_initOnce() below.
+ */
+#if U_HAVE_GCC_ATOMICS && defined(__ATOMIC_ACQUIRE)
+
+inline int32_t umtx_loadAcquire(volatile int32_t &var) {
+    return __atomic_load_n(&var, __ATOMIC_ACQUIRE);
+}
+
+inline void umtx_storeRelease(volatile int32_t &var, int32_t val) {
+    __atomic_store_n(&var, val, __ATOMIC_RELEASE);
+}
+
+#else
+
+inline int32_t umtx_loadAcquire(volatile int32_t &var) {
+    int32_t val = var;
+    UMTX_ACQUIRE_BARRIER;
+    return val;
+}
+
+inline void umtx_storeRelease(volatile int32_t &var, int32_t val) {
+    UMTX_RELEASE_BARRIER;
+    var = val;
+}
+
+#endif
+
+U_NAMESPACE_BEGIN
+
+/*
+ * UInitOnce - lock-free, one time initialization of static data.
+ *
+ * Replaces the pattern of taking a mutex on every call in order to check
+ * whether some service has been initialized.  Once the initialization
+ * function has run, umtx_initOnce() costs one load with acquire semantics
+ * and a compare; no mutex is touched.
+ *
+ * UInitOnce structs must be static or global, and must be initialized:
+ *     static UInitOnce gFooInitOnce = U_INITONCE_INITIALIZER;
+ *
+ * The initialization function is called with no mutex held.  It may itself
+ * use other UInitOnce objects, or lock other mutexes, but it must not
+ * recursively initialize its own UInitOnce.  A function that takes a UErrorCode
+ * has its error saved; later callers of umtx_initOnce() get the same error.
+ *
+ * The cleanup function for the initialized data should call reset()
+ * (from u_cleanup(), in a single threaded environment), so that ICU can be
+ * re-initialized.
+ */
+struct UInitOnce {
+    volatile int32_t  fState;
+    UErrorCode        fErrCode;
+    void reset() {fState = 0; fErrCode = U_ZERO_ERROR;};
+    UBool isReset() {return umtx_loadAcquire(fState) == 0;};
+};
+
+#define U_INITONCE_INITIALIZER {0, U_ZERO_ERROR}
+
+/*
+ * Slow path of umtx_initOnce().  umtx_initImplPreInit() returns TRUE if the
+ * caller must run the initialization, which it then follows with
+ * umtx_initImplPostInit().  It returns FALSE once another thread has finished
+ * the initialization, waiting for it if the initialization is in progress.
+ */
+U_COMMON_API UBool U_EXPORT2 umtx_initImplPreInit(UInitOnce &);
+U_COMMON_API void  U_EXPORT2 umtx_initImplPostInit(UInitOnce &);
+
+inline void umtx_initOnce(UInitOnce &uio, void (*fp)()) {
+    if (umtx_loadAcquire(uio.fState) == 2) {
+        return;
+    }
+    if (umtx_initImplPreInit(uio)) {
+        (*fp)();
+        umtx_initImplPostInit(uio);
+    }
+}
+
+inline void umtx_initOnce(UInitOnce &uio, void (*fp)(UErrorCode &), UErrorCode &errCode) {
+    if (U_FAILURE(errCode)) {
+        return;
+    }
+    if (umtx_loadAcquire(uio.fState) != 2 && umtx_initImplPreInit(uio)) {
+        // We run the initialization.
+        (*fp)(errCode);
+        uio.fErrCode = errCode;
+        umtx_initImplPostInit(uio);
+    } else {
+        // Someone else already ran the initialization.
+        if (U_FAILURE(uio.fErrCode)) {
+            errCode = uio.fErrCode;
+        }
+    }
+}
+
+template<class T> void umtx_initOnce(UInitOnce &uio, void (*fp)(T), T context) {
+    if (umtx_loadAcquire(uio.fState) == 2) {
+        return;
+    }
+    if (umtx_initImplPreInit(uio)) {
+        (*fp)(context);
+        umtx_initImplPostInit(uio);
+    }
+}
+
+template<class T> void umtx_initOnce(UInitOnce &uio, void (*fp)(T, UErrorCode &), T context, UErrorCode &errCode) {
+    if (U_FAILURE(errCode)) {
+        return;
+    }
+    if (umtx_loadAcquire(uio.fState) != 2 && umtx_initImplPreInit(uio)) {
+        (*fp)(context, errCode);
+        uio.fErrCode = errCode;
+        umtx_initImplPostInit(uio);
+    } else {
+        if (U_FAILURE(uio.fErrCode)) {
+            errCode = uio.fErrCode;
+        }
+    }
+}
+
+U_NAMESPACE_END
+
+#endif  /* __cplusplus */
+
 #endif /*_CMUTEX*/
 /*eof*/
@@ -42,6 +42,7 @@ class  RBBIDataWrapper;
 class  UStack;
 class  LanguageBreakEngine;
 class  UnhandledEngine;
+class  RBBIBoundaryCache;
 struct RBBIStateTable;
 
 
@@ -139,6 +140,13 @@ protected:
      * @internal
      */
     int32_t             fPositionInCache;
+
+    /**
+     * Recently found boundaries and their rule status values, for
+     * answering random access and reverse iteration without rescanning.
+     * @internal
+     */
+    RBBIBoundaryCache   *fBoundaryCache;
     
     /**
      *
@@ -727,6 +735,33 @@ private:
      */
     int32_t handleNext(const RBBIStateTable *statetable);
 
+    /**
+     * The implementations of next(), previous(), following() and preceding(),
+     * without the boundary cache.  Internal iteration, which may start from
+     * positions that are not boundaries, goes through these.
+     * @internal
+     */
+    int32_t computeNext(void);
+    int32_t computePrevious(void);
+    int32_t computeFollowing(int32_t offset);
+    int32_t computePreceding(int32_t offset);
+
+    /**
+     * Set the iteration position to a boundary taken from the boundary cache.
+     * @param pos        The boundary position.
+     * @param statusIdx  Its rule status index, or RBBIBoundaryCache::UNKNOWN_STATUS.
+     * @return           pos
+     * @internal
+     */
+    int32_t setCachedPosition(int32_t pos, int32_t statusIdx);
+
+    /**
+     * @return the rule status index of the current position, for the
+     *         boundary cache, or RBBIBoundaryCache::UNKNOWN_STATUS.
+     * @internal
+     */
+    int32_t getCachedStatusIdx(void) const;
+
 protected:
 
 #ifndef U_HIDE_INTERNAL_API
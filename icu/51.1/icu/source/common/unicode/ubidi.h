@@ -1,7 +1,7 @@
 /*
 ******************************************************************************
 *
-*   Copyright (C) 1999-2012, International Business Machines
+*   Copyright (C) 1999-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 ******************************************************************************
@@ -1218,6 +1218,58 @@ ubidi_setPara(UBiDi *pBiDi, const UChar *text, int32_t length,
               UBiDiLevel paraLevel, UBiDiLevel *embeddingLevels,
               UErrorCode *pErrorCode);
 
+#ifndef U_HIDE_DRAFT_API
+/**
+ * Same as <code>ubidi_setPara(pBiDi, text, length, paraLevel, NULL, pErrorCode)</code>,
+ * except that the result of the previous call is reused if it was
+ * for the same paragraph: the same text contents (not necessarily at the
+ * same address), the same <code>paraLevel</code>, and no change since then to
+ * the reordering mode and options, <code>ubidi_orderParagraphsLTR()</code>,
+ * the context or the class callback of <code>pBiDi</code>.
+ * This is intended for callers that lay out the same paragraphs again
+ * and again, for example on every relayout of a text widget.<p>
+ *
+ * The <code>UBiDi</code> object keeps a copy of the text for comparison.
+ * If it was opened with <code>ubidi_openSized()</code> for a fixed
+ * <code>maxLength</code>, then nothing is cached and every call does the full work.<p>
+ *
+ * Line objects set with <code>ubidi_setLine()</code> on <code>pBiDi</code>
+ * remain valid after a call that reuses the previous result.
+ * Other calls invalidate them as with <code>ubidi_setPara()</code>.
+ * A context set with <code>ubidi_setContext()</code> applies only to the
+ * following call, so that call never reuses a previous result.
+ *
+ * @param pBiDi A <code>UBiDi</code> object allocated with <code>ubidi_open()</code>.
+ * @param text is a pointer to the text; see <code>ubidi_setPara()</code>.
+ * @param length is the length of the text; if <code>length==-1</code> then
+ *        the text must be zero-terminated.
+ * @param paraLevel specifies the default level for the text; see <code>ubidi_setPara()</code>.
+ * @param pErrorCode must be a valid pointer to an error code value.
+ *
+ * @see ubidi_setPara
+ * @see ubidi_getParaCacheCounts
+ * @draft ICU 52
+ */
+U_DRAFT void U_EXPORT2
+ubidi_setParaCached(UBiDi *pBiDi, const UChar *text, int32_t length,
+                    UBiDiLevel paraLevel, UErrorCode *pErrorCode);
+
+/**
+ * Gets the number of calls to <code>ubidi_setParaCached()</code> in this
+ * process that reused the previous result (hits) and that did not (misses).
+ * The hit ratio is <code>hits/(hits+misses)</code>.
+ * The counts include calls from all threads and all <code>UBiDi</code> objects.
+ *
+ * @param pHits receives the number of hits, if not NULL.
+ * @param pMisses receives the number of misses, if not NULL.
+ *
+ * @see ubidi_setParaCached
+ * @draft ICU 52
+ */
+U_DRAFT void U_EXPORT2
+ubidi_getParaCacheCounts(int32_t *pHits, int32_t *pMisses);
+#endif  /* U_HIDE_DRAFT_API */
+
 /**
  * <code>ubidi_setLine()</code> sets a <code>UBiDi</code> to
  * contain the reordering information, especially the resolved levels,
@@ -1,6 +1,6 @@
 /*
 **********************************************************************
-*   Copyright (C) 1999-2012, International Business Machines
+*   Copyright (C) 1999-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 **********************************************************************
  *  ucnv.h:
@@ -161,6 +161,8 @@ typedef enum {
     UCNV_IMAP_MAILBOX,
     /** @stable ICU 4.8 */
     UCNV_COMPOUND_TEXT,
+    /** @draft ICU 52 */
+    UCNV_DVB,
 
     /* Number of converter types for which we have conversion routines. */
     UCNV_NUMBER_OF_SUPPORTED_CONVERTER_TYPES
@@ -581,6 +583,46 @@ U_NAMESPACE_END
 
 #endif
 
+#ifndef U_HIDE_DRAFT_API
+/**
+ * Gets a converter from a small process-wide pool of converters that
+ * were handed back with ucnv_return(), or opens a new one with ucnv_open()
+ * if there is none for this name.
+ * This is faster than ucnv_open() for code that repeatedly opens and closes
+ * the same converters, for example once per document.
+ *
+ * The pool is keyed by canonical converter name (see ucnv_getName());
+ * aliases are resolved to their canonical names.
+ * A borrowed converter is in the same state as a newly opened one.
+ * It must be released with ucnv_return() or ucnv_close().
+ *
+ * @param name converter name, as for ucnv_open()
+ * @param err outgoing error status
+ * @return the converter, or NULL if an error occurred
+ * @see ucnv_return
+ * @see ucnv_open
+ * @draft ICU 52
+ */
+U_DRAFT UConverter * U_EXPORT2
+ucnv_borrow(const char *name, UErrorCode *err);
+
+/**
+ * Hands a converter back to the pool used by ucnv_borrow().
+ * The converter is reset. It is closed instead, as if with ucnv_close(),
+ * if its callbacks, substitution characters or fallback behavior were changed,
+ * if it was created with ucnv_safeClone() into a caller-provided buffer,
+ * or if the pool is full of other converters.
+ * The converter may have been opened with any ucnv_open() variant.
+ * The pool is emptied by ucnv_flushCache().
+ *
+ * @param cnv the converter; may be NULL
+ * @see ucnv_borrow
+ * @draft ICU 52
+ */
+U_DRAFT void U_EXPORT2
+ucnv_return(UConverter *cnv);
+#endif  /* U_HIDE_DRAFT_API */
+
 /**
  * Fills in the output parameter, subChars, with the substitution characters
  * as multiple bytes.
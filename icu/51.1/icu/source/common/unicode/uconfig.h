@@ -409,4 +409,18 @@
 #   define UCONFIG_FORMAT_FASTPATHS_49 1
 #endif
 
+/**
+ * \def UCONFIG_TZNAMES_REGION_ONLY
+ * This switch restricts the time zone names loaded for parsing to those of the
+ * zones of the default time zone's region and of the locale's country, instead
+ * of falling back to all zones when no name of these matches. Parsing the names
+ * of other zones then fails, which saves the memory and the time of loading all
+ * of them on devices that never see them.
+ *
+ * @internal
+ */
+#ifndef UCONFIG_TZNAMES_REGION_ONLY
+#   define UCONFIG_TZNAMES_REGION_ONLY 0
+#endif
+
 #endif
@@ -1,7 +1,7 @@
 /*
 ******************************************************************************
 *
-*   Copyright (C) 1999-2012, International Business Machines
+*   Copyright (C) 1999-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 ******************************************************************************
@@ -411,6 +411,53 @@ typedef enum UDataFileAccess {
 U_STABLE void U_EXPORT2
 udata_setFileAccess(UDataFileAccess access, UErrorCode *status);
 
+#ifndef U_HIDE_DRAFT_API
+/**
+ * Records the ICU data items that are opened from now on.
+ * The name of each item, relative to the ICU data package (for example
+ * "coll/de.res"), is appended to the file at path the first time the item
+ * is opened. The file is an icupkg list file: a package with only the items
+ * used by a run of an application can be built with icupkg --keep.
+ * (icupkg expects list files to have a .txt extension.)
+ *
+ * If this function is not called, the file named by the ICU_DATA_USAGE_LOG
+ * environment variable is used, if it is set.
+ * Like udata_setFileAccess(), this should be called before any ICU data is
+ * loaded, since items that are already open are not recorded again.
+ * @param path the file to append to, or NULL to stop recording
+ * @param status Error code.
+ * @draft ICU 52
+ */
+U_DRAFT void U_EXPORT2
+udata_setUsageLog(const char *path, UErrorCode *status);
+
+/**
+ * Tells ICU that the data packages it maps from now on are read at random.
+ * Where the platform supports it, the system is advised not to read ahead,
+ * so that only the pages of the data items actually used become resident.
+ * This saves memory when only a few locales of a large package are used.
+ * It must be called before any ICU data is loaded; see udata_setFileAccess().
+ * @param randomAccess TRUE for random access, FALSE for the default
+ * @param status Error code.
+ * @see udata_getResidentSize
+ * @draft ICU 52
+ */
+U_DRAFT void U_EXPORT2
+udata_setRandomAccess(UBool randomAccess, UErrorCode *status);
+
+/**
+ * Reports how much of the ICU data packages mapped from files is in memory.
+ * Data linked into the application and individual data files are not counted.
+ * @param pMappedSize receives the total length of the mapped packages
+ * @param pResidentSize receives the number of bytes of those that are resident
+ * @param status Error code. Set to U_UNSUPPORTED_ERROR if the platform
+ *               cannot report residency.
+ * @draft ICU 52
+ */
+U_DRAFT void U_EXPORT2
+udata_getResidentSize(int32_t *pMappedSize, int32_t *pResidentSize, UErrorCode *status);
+#endif  /* U_HIDE_DRAFT_API */
+
 U_CDECL_END
 
 #endif
@@ -1,6 +1,6 @@
 /*
 ***************************************************************************
-* Copyright (C) 1999-2011, International Business Machines Corporation
+* Copyright (C) 1999-2013, International Business Machines Corporation
 * and others. All Rights Reserved.
 ***************************************************************************
 *   Date        Name        Description
@@ -295,7 +295,8 @@ class U_COMMON_API UnicodeSet : public UnicodeFilter {
 
 private:
     enum { // constants
-        kIsBogus = 1       // This set is bogus (i.e. not valid)
+        kIsBogus = 1,      // This set is bogus (i.e. not valid)
+        kIsListAlias = 2   // The list is owned by the caller of createFromFrozen()
     };
     uint8_t fFlags;         // Bit flag (see constants above)
 public:
@@ -1417,6 +1418,57 @@ public:
      */
     int32_t serialize(uint16_t *dest, int32_t destCapacity, UErrorCode& ec) const;
 
+#ifndef U_HIDE_DRAFT_API
+    /**
+     * Serializes this set in its frozen form, for createFromFrozen().
+     * The frozen form contains the inversion list, the strings, and
+     * the lookup tables that freeze() builds for contains() and span()
+     * on BMP code points.  It can be compiled into data or mapped from
+     * a file and turned back into a frozen set without parsing a
+     * pattern or rebuilding the lookup tables.
+     *
+     * The frozen form is an array of 32-bit integers in the byte order
+     * and the format of the ICU version that wrote it. It is not an
+     * interchange format.
+     *
+     * If this set is not frozen, then a frozen clone is serialized.
+     *
+     * @param dest pointer to buffer of destCapacity 32-bit integers.
+     * May be NULL only if destCapacity is zero.
+     * @param destCapacity size of dest, or zero.  Must not be negative.
+     * @param errorCode ICU error code.  Will be set to U_BUFFER_OVERFLOW_ERROR
+     * if the frozen form does not fit into dest, and to
+     * U_ILLEGAL_ARGUMENT_ERROR if this set is bogus.
+     * @return the length of the frozen form in 32-bit integers,
+     * or 0 on error other than U_BUFFER_OVERFLOW_ERROR.
+     * @see createFromFrozen
+     * @draft ICU 52
+     */
+    int32_t serializeFrozen(int32_t *dest, int32_t destCapacity, UErrorCode &errorCode) const;
+
+    /**
+     * Creates a frozen set from the frozen form written by serializeFrozen().
+     * The new set uses the inversion list in the data without copying it,
+     * so the data must remain valid and unchanged for as long as the set
+     * is used.  Clones and thawed clones of the set make their own copies.
+     *
+     * Sets with strings that are relevant for span() rebuild their
+     * string span data.  All other sets are ready for use without
+     * any processing that depends on the size of the set.
+     *
+     * @param data pointer to the frozen form, aligned to 4 bytes.
+     * @param length number of 32-bit integers available at data.
+     * @param errorCode ICU error code.  Will be set to U_INVALID_FORMAT_ERROR
+     * if the data is not a frozen form written by this version of ICU
+     * on a platform with the same byte order.
+     * @return a new frozen set, or NULL on failure.  The caller owns it.
+     * @see serializeFrozen
+     * @draft ICU 52
+     */
+    static UnicodeSet* U_EXPORT2 createFromFrozen(const int32_t *data, int32_t length,
+                                                 UErrorCode &errorCode);
+#endif  /* U_HIDE_DRAFT_API */
+
     /**
      * Reallocate this objects internal structures to take up the least
      * possible space, without changing this object's value.
@@ -3485,6 +3485,7 @@ private:
     kBufferIsReadonly=8,// do not write to this buffer
     kOpenGetBuffer=16,  // getBuffer(minCapacity) was called (is "open"),
                         // and releaseBuffer(newLength) must be called
+    kArenaBuffer=32,    // fArray is from a UnicodeStringArena; it is never shared
 
     // combined values for convenience
     kShortString=kUsingStackBuffer,
@@ -435,6 +435,7 @@
 #define ubidi_getMaxValue U_ICU_ENTRY_POINT_RENAME(ubidi_getMaxValue)
 #define ubidi_getMemory U_ICU_ENTRY_POINT_RENAME(ubidi_getMemory)
 #define ubidi_getMirror U_ICU_ENTRY_POINT_RENAME(ubidi_getMirror)
+#define ubidi_getParaCacheCounts U_ICU_ENTRY_POINT_RENAME(ubidi_getParaCacheCounts)
 #define ubidi_getParaLevel U_ICU_ENTRY_POINT_RENAME(ubidi_getParaLevel)
 #define ubidi_getParagraph U_ICU_ENTRY_POINT_RENAME(ubidi_getParagraph)
 #define ubidi_getParagraphByIndex U_ICU_ENTRY_POINT_RENAME(ubidi_getParagraphByIndex)
@@ -464,6 +465,7 @@
 #define ubidi_setInverse U_ICU_ENTRY_POINT_RENAME(ubidi_setInverse)
 #define ubidi_setLine U_ICU_ENTRY_POINT_RENAME(ubidi_setLine)
 #define ubidi_setPara U_ICU_ENTRY_POINT_RENAME(ubidi_setPara)
+#define ubidi_setParaCached U_ICU_ENTRY_POINT_RENAME(ubidi_setParaCached)
 #define ubidi_setReorderingMode U_ICU_ENTRY_POINT_RENAME(ubidi_setReorderingMode)
 #define ubidi_setReorderingOptions U_ICU_ENTRY_POINT_RENAME(ubidi_setReorderingOptions)
 #define ubidi_writeReordered U_ICU_ENTRY_POINT_RENAME(ubidi_writeReordered)
@@ -585,6 +587,7 @@
 #define ucnv_MBCSToUnicodeWithOffsets U_ICU_ENTRY_POINT_RENAME(ucnv_MBCSToUnicodeWithOffsets)
 #define ucnv_bld_countAvailableConverters U_ICU_ENTRY_POINT_RENAME(ucnv_bld_countAvailableConverters)
 #define ucnv_bld_getAvailableConverter U_ICU_ENTRY_POINT_RENAME(ucnv_bld_getAvailableConverter)
+#define ucnv_borrow U_ICU_ENTRY_POINT_RENAME(ucnv_borrow)
 #define ucnv_canCreateConverter U_ICU_ENTRY_POINT_RENAME(ucnv_canCreateConverter)
 #define ucnv_cbFromUWriteBytes U_ICU_ENTRY_POINT_RENAME(ucnv_cbFromUWriteBytes)
 #define ucnv_cbFromUWriteSub U_ICU_ENTRY_POINT_RENAME(ucnv_cbFromUWriteSub)
@@ -661,6 +664,7 @@
 #define ucnv_reset U_ICU_ENTRY_POINT_RENAME(ucnv_reset)
 #define ucnv_resetFromUnicode U_ICU_ENTRY_POINT_RENAME(ucnv_resetFromUnicode)
 #define ucnv_resetToUnicode U_ICU_ENTRY_POINT_RENAME(ucnv_resetToUnicode)
+#define ucnv_return U_ICU_ENTRY_POINT_RENAME(ucnv_return)
 #define ucnv_safeClone U_ICU_ENTRY_POINT_RENAME(ucnv_safeClone)
 #define ucnv_setDefaultName U_ICU_ENTRY_POINT_RENAME(ucnv_setDefaultName)
 #define ucnv_setFallback U_ICU_ENTRY_POINT_RENAME(ucnv_setFallback)
@@ -731,6 +735,7 @@
 #define ucol_getRulesEx U_ICU_ENTRY_POINT_RENAME(ucol_getRulesEx)
 #define ucol_getShortDefinitionString U_ICU_ENTRY_POINT_RENAME(ucol_getShortDefinitionString)
 #define ucol_getSortKey U_ICU_ENTRY_POINT_RENAME(ucol_getSortKey)
+#define ucol_getSortKeys U_ICU_ENTRY_POINT_RENAME(ucol_getSortKeys)
 #define ucol_getStrength U_ICU_ENTRY_POINT_RENAME(ucol_getStrength)
 #define ucol_getTailoredSet U_ICU_ENTRY_POINT_RENAME(ucol_getTailoredSet)
 #define ucol_getUCAVersion U_ICU_ENTRY_POINT_RENAME(ucol_getUCAVersion)
@@ -780,6 +785,7 @@
 #define ucol_setStrength U_ICU_ENTRY_POINT_RENAME(ucol_setStrength)
 #define ucol_setText U_ICU_ENTRY_POINT_RENAME(ucol_setText)
 #define ucol_setVariableTop U_ICU_ENTRY_POINT_RENAME(ucol_setVariableTop)
+#define ucol_sortBySortKeys U_ICU_ENTRY_POINT_RENAME(ucol_sortBySortKeys)
 #define ucol_strcoll U_ICU_ENTRY_POINT_RENAME(ucol_strcoll)
 #define ucol_strcollIter U_ICU_ENTRY_POINT_RENAME(ucol_strcollIter)
 #define ucol_strcollUTF8 U_ICU_ENTRY_POINT_RENAME(ucol_strcollUTF8)
@@ -794,6 +800,7 @@
 #define ucol_tok_initTokenList U_ICU_ENTRY_POINT_RENAME(ucol_tok_initTokenList)
 #define ucol_tok_parseNextToken U_ICU_ENTRY_POINT_RENAME(ucol_tok_parseNextToken)
 #define ucol_updateInternalState U_ICU_ENTRY_POINT_RENAME(ucol_updateInternalState)
+#define ucsdet_appendText U_ICU_ENTRY_POINT_RENAME(ucsdet_appendText)
 #define ucsdet_close U_ICU_ENTRY_POINT_RENAME(ucsdet_close)
 #define ucsdet_detect U_ICU_ENTRY_POINT_RENAME(ucsdet_detect)
 #define ucsdet_detectAll U_ICU_ENTRY_POINT_RENAME(ucsdet_detectAll)
@@ -805,6 +812,7 @@
 #define ucsdet_getUChars U_ICU_ENTRY_POINT_RENAME(ucsdet_getUChars)
 #define ucsdet_isInputFilterEnabled U_ICU_ENTRY_POINT_RENAME(ucsdet_isInputFilterEnabled)
 #define ucsdet_open U_ICU_ENTRY_POINT_RENAME(ucsdet_open)
+#define ucsdet_setConfidenceThreshold U_ICU_ENTRY_POINT_RENAME(ucsdet_setConfidenceThreshold)
 #define ucsdet_setDeclaredEncoding U_ICU_ENTRY_POINT_RENAME(ucsdet_setDeclaredEncoding)
 #define ucsdet_setText U_ICU_ENTRY_POINT_RENAME(ucsdet_setText)
 #define ucurr_countCurrencies U_ICU_ENTRY_POINT_RENAME(ucurr_countCurrencies)
@@ -858,6 +866,7 @@
 #define udata_getInfoSize U_ICU_ENTRY_POINT_RENAME(udata_getInfoSize)
 #define udata_getLength U_ICU_ENTRY_POINT_RENAME(udata_getLength)
 #define udata_getMemory U_ICU_ENTRY_POINT_RENAME(udata_getMemory)
+#define udata_getResidentSize U_ICU_ENTRY_POINT_RENAME(udata_getResidentSize)
 #define udata_getRawMemory U_ICU_ENTRY_POINT_RENAME(udata_getRawMemory)
 #define udata_open U_ICU_ENTRY_POINT_RENAME(udata_open)
 #define udata_openChoice U_ICU_ENTRY_POINT_RENAME(udata_openChoice)
@@ -869,6 +878,8 @@
 #define udata_setAppData U_ICU_ENTRY_POINT_RENAME(udata_setAppData)
 #define udata_setCommonData U_ICU_ENTRY_POINT_RENAME(udata_setCommonData)
 #define udata_setFileAccess U_ICU_ENTRY_POINT_RENAME(udata_setFileAccess)
+#define udata_setRandomAccess U_ICU_ENTRY_POINT_RENAME(udata_setRandomAccess)
+#define udata_setUsageLog U_ICU_ENTRY_POINT_RENAME(udata_setUsageLog)
 #define udata_swapDataHeader U_ICU_ENTRY_POINT_RENAME(udata_swapDataHeader)
 #define udata_swapInvStringBlock U_ICU_ENTRY_POINT_RENAME(udata_swapInvStringBlock)
 #define udatpg_addPattern U_ICU_ENTRY_POINT_RENAME(udatpg_addPattern)
@@ -1585,6 +1596,9 @@
 #define uset_spanBackUTF8 U_ICU_ENTRY_POINT_RENAME(uset_spanBackUTF8)
 #define uset_spanUTF8 U_ICU_ENTRY_POINT_RENAME(uset_spanUTF8)
 #define uset_toPattern U_ICU_ENTRY_POINT_RENAME(uset_toPattern)
+#define uspoof_addToIndex U_ICU_ENTRY_POINT_RENAME(uspoof_addToIndex)
+#define uspoof_addToIndexUTF8 U_ICU_ENTRY_POINT_RENAME(uspoof_addToIndexUTF8)
+#define uspoof_addToIndexUnicodeString U_ICU_ENTRY_POINT_RENAME(uspoof_addToIndexUnicodeString)
 #define uspoof_areConfusable U_ICU_ENTRY_POINT_RENAME(uspoof_areConfusable)
 #define uspoof_areConfusableUTF8 U_ICU_ENTRY_POINT_RENAME(uspoof_areConfusableUTF8)
 #define uspoof_areConfusableUnicodeString U_ICU_ENTRY_POINT_RENAME(uspoof_areConfusableUnicodeString)
@@ -1593,12 +1607,17 @@
 #define uspoof_checkUnicodeString U_ICU_ENTRY_POINT_RENAME(uspoof_checkUnicodeString)
 #define uspoof_clone U_ICU_ENTRY_POINT_RENAME(uspoof_clone)
 #define uspoof_close U_ICU_ENTRY_POINT_RENAME(uspoof_close)
+#define uspoof_closeIndex U_ICU_ENTRY_POINT_RENAME(uspoof_closeIndex)
+#define uspoof_findConfusables U_ICU_ENTRY_POINT_RENAME(uspoof_findConfusables)
+#define uspoof_findConfusablesUTF8 U_ICU_ENTRY_POINT_RENAME(uspoof_findConfusablesUTF8)
+#define uspoof_findConfusablesUnicodeString U_ICU_ENTRY_POINT_RENAME(uspoof_findConfusablesUnicodeString)
 #define uspoof_getAllowedChars U_ICU_ENTRY_POINT_RENAME(uspoof_getAllowedChars)
 #define uspoof_getAllowedLocales U_ICU_ENTRY_POINT_RENAME(uspoof_getAllowedLocales)
 #define uspoof_getAllowedUnicodeSet U_ICU_ENTRY_POINT_RENAME(uspoof_getAllowedUnicodeSet)
 #define uspoof_getChecks U_ICU_ENTRY_POINT_RENAME(uspoof_getChecks)
 #define uspoof_getInclusionSet U_ICU_ENTRY_POINT_RENAME(uspoof_getInclusionSet)
 #define uspoof_getInclusionUnicodeSet U_ICU_ENTRY_POINT_RENAME(uspoof_getInclusionUnicodeSet)
+#define uspoof_getIndexSize U_ICU_ENTRY_POINT_RENAME(uspoof_getIndexSize)
 #define uspoof_getRecommendedSet U_ICU_ENTRY_POINT_RENAME(uspoof_getRecommendedSet)
 #define uspoof_getRecommendedUnicodeSet U_ICU_ENTRY_POINT_RENAME(uspoof_getRecommendedUnicodeSet)
 #define uspoof_getRestrictionLevel U_ICU_ENTRY_POINT_RENAME(uspoof_getRestrictionLevel)
@@ -1608,6 +1627,7 @@
 #define uspoof_open U_ICU_ENTRY_POINT_RENAME(uspoof_open)
 #define uspoof_openFromSerialized U_ICU_ENTRY_POINT_RENAME(uspoof_openFromSerialized)
 #define uspoof_openFromSource U_ICU_ENTRY_POINT_RENAME(uspoof_openFromSource)
+#define uspoof_openIndex U_ICU_ENTRY_POINT_RENAME(uspoof_openIndex)
 #define uspoof_serialize U_ICU_ENTRY_POINT_RENAME(uspoof_serialize)
 #define uspoof_setAllowedChars U_ICU_ENTRY_POINT_RENAME(uspoof_setAllowedChars)
 #define uspoof_setAllowedLocales U_ICU_ENTRY_POINT_RENAME(uspoof_setAllowedLocales)
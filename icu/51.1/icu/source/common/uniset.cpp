@@ -1,6 +1,6 @@
 /*
 **********************************************************************
-*   Copyright (C) 1999-2012, International Business Machines
+*   Copyright (C) 1999-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 **********************************************************************
 *   Date        Name        Description
@@ -256,7 +256,9 @@ UnicodeSet::UnicodeSet(const UnicodeSet& o, UBool /* asThawed */) :
  */
 UnicodeSet::~UnicodeSet() {
     _dbgdt(this); // first!
-    uprv_free(list);
+    if (!(fFlags & kIsListAlias)) {
+        uprv_free(list);
+    }
     delete bmpSet;
     if (buffer) {
         uprv_free(buffer);
@@ -1549,6 +1551,200 @@ int32_t UnicodeSet::serialize(uint16_t *dest, int32_t destCapacity, UErrorCode&
     return destLength;
 }
 
+//----------------------------------------------------------------
+// Frozen form
+//
+// All values are 32-bit integers in platform byte order:
+//   header[FROZEN_HEADER_LENGTH] (see the FROZEN_IX_... indexes)
+//   list[listLength]
+//   BMPSet bits[BMPSet::SERIALIZED_LENGTH] if FROZEN_HAS_BMP_SET
+//   for each string in sorted order:
+//     length, followed by its UChars packed two per integer
+//----------------------------------------------------------------
+
+enum {
+    FROZEN_SIGNATURE = 0x5553467a,  // "USFz"
+    FROZEN_FORMAT_VERSION = 1,
+
+    FROZEN_IX_SIGNATURE = 0,
+    FROZEN_IX_FORMAT_VERSION,
+    FROZEN_IX_LENGTH,
+    FROZEN_IX_LIST_LENGTH,
+    FROZEN_IX_STRING_COUNT,
+    FROZEN_IX_FLAGS,
+    FROZEN_HEADER_LENGTH,
+
+    FROZEN_HAS_BMP_SET = 1
+};
+
+int32_t UnicodeSet::serializeFrozen(int32_t *dest, int32_t destCapacity,
+                                    UErrorCode &errorCode) const {
+    if (U_FAILURE(errorCode)) {
+        return 0;
+    }
+    if (destCapacity < 0 || (destCapacity > 0 && dest == NULL) || isBogus()) {
+        errorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+    if (!isFrozen()) {
+        UnicodeSet frozen(*this);
+        frozen.freeze();
+        if (frozen.isBogus()) {
+            errorCode = U_MEMORY_ALLOCATION_ERROR;
+            return 0;
+        }
+        return frozen.serializeFrozen(dest, destCapacity, errorCode);
+    }
+
+    int32_t stringCount = strings->size();
+    int32_t length = FROZEN_HEADER_LENGTH + len;
+    if (bmpSet != NULL) {
+        length += BMPSet::SERIALIZED_LENGTH;
+    }
+    int32_t i;
+    for (i = 0; i < stringCount; ++i) {
+        length += 1 + (((const UnicodeString *)strings->elementAt(i))->length() + 1) / 2;
+    }
+    if (length > destCapacity) {
+        errorCode = U_BUFFER_OVERFLOW_ERROR;
+        return length;
+    }
+
+    dest[FROZEN_IX_SIGNATURE] = FROZEN_SIGNATURE;
+    dest[FROZEN_IX_FORMAT_VERSION] = FROZEN_FORMAT_VERSION;
+    dest[FROZEN_IX_LENGTH] = length;
+    dest[FROZEN_IX_LIST_LENGTH] = len;
+    dest[FROZEN_IX_STRING_COUNT] = stringCount;
+    dest[FROZEN_IX_FLAGS] = bmpSet != NULL ? FROZEN_HAS_BMP_SET : 0;
+    int32_t *p = dest + FROZEN_HEADER_LENGTH;
+    uprv_memcpy(p, list, len * sizeof(UChar32));
+    p += len;
+    if (bmpSet != NULL) {
+        bmpSet->serializeBits(p);
+        p += BMPSet::SERIALIZED_LENGTH;
+    }
+    for (i = 0; i < stringCount; ++i) {
+        const UnicodeString &s = *(const UnicodeString *)strings->elementAt(i);
+        int32_t sLength = s.length();
+        *p++ = sLength;
+        UChar *q = (UChar *)p;
+        s.extract(0, sLength, q);
+        if (sLength & 1) {
+            q[sLength] = 0;  // padding
+        }
+        p += (sLength + 1) / 2;
+    }
+    return length;
+}
+
+UnicodeSet* U_EXPORT2 UnicodeSet::createFromFrozen(const int32_t *data, int32_t length,
+                                                   UErrorCode &errorCode) {
+    if (U_FAILURE(errorCode)) {
+        return NULL;
+    }
+    if (data == NULL || length < 0 || (((size_t)data) & 3) != 0) {
+        errorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return NULL;
+    }
+    if (length < FROZEN_HEADER_LENGTH ||
+        data[FROZEN_IX_SIGNATURE] != FROZEN_SIGNATURE ||
+        data[FROZEN_IX_FORMAT_VERSION] != FROZEN_FORMAT_VERSION ||
+        data[FROZEN_IX_LENGTH] < FROZEN_HEADER_LENGTH ||
+        data[FROZEN_IX_LENGTH] > length
+    ) {
+        errorCode = U_INVALID_FORMAT_ERROR;
+        return NULL;
+    }
+    const int32_t *p = data + FROZEN_HEADER_LENGTH;
+    const int32_t *limit = data + data[FROZEN_IX_LENGTH];
+
+    // The list is used as is, so make sure that it is a valid inversion list.
+    int32_t listLength = data[FROZEN_IX_LIST_LENGTH];
+    if (listLength < 1 || listLength > (limit - p) || p[listLength - 1] != UNICODESET_HIGH) {
+        errorCode = U_INVALID_FORMAT_ERROR;
+        return NULL;
+    }
+    const UChar32 *frozenList = p;
+    UChar32 prev = -1;
+    int32_t i;
+    for (i = 0; i < listLength; ++i) {
+        if (frozenList[i] <= prev) {
+            errorCode = U_INVALID_FORMAT_ERROR;
+            return NULL;
+        }
+        prev = frozenList[i];
+    }
+    p += listLength;
+
+    const int32_t *bits = NULL;
+    if (data[FROZEN_IX_FLAGS] & FROZEN_HAS_BMP_SET) {
+        if ((limit - p) < BMPSet::SERIALIZED_LENGTH ||
+            !BMPSet::isValidSerializedBits(p, listLength)
+        ) {
+            errorCode = U_INVALID_FORMAT_ERROR;
+            return NULL;
+        }
+        bits = p;
+        p += BMPSet::SERIALIZED_LENGTH;
+    }
+
+    UnicodeSet *set = new UnicodeSet();
+    if (set == NULL || set->isBogus()) {
+        delete set;
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    int32_t stringCount = data[FROZEN_IX_STRING_COUNT];
+    for (i = 0; i < stringCount && U_SUCCESS(errorCode); ++i) {
+        int32_t sLength = p < limit ? *p++ : -1;
+        if (sLength < 0 || ((sLength + 1) / 2) > (limit - p)) {
+            errorCode = U_INVALID_FORMAT_ERROR;
+            break;
+        }
+        // Read-only aliases of the data, like the list.
+        UnicodeString *s = new UnicodeString(FALSE, (const UChar *)p, sLength);
+        if (s == NULL) {
+            errorCode = U_MEMORY_ALLOCATION_ERROR;
+            break;
+        }
+        if (i > 0 && ((const UnicodeString *)set->strings->lastElement())->compare(*s) >= 0) {
+            delete s;
+            errorCode = U_INVALID_FORMAT_ERROR;
+            break;
+        }
+        set->strings->addElement(s, errorCode);
+        if (U_FAILURE(errorCode)) {
+            delete s;
+        }
+        p += (sLength + 1) / 2;
+    }
+    if (U_SUCCESS(errorCode) && (p != limit || (bits == NULL && stringCount == 0))) {
+        errorCode = U_INVALID_FORMAT_ERROR;
+    }
+    if (U_FAILURE(errorCode)) {
+        delete set;
+        return NULL;
+    }
+
+    uprv_free(set->list);
+    set->list = (UChar32 *)frozenList;
+    set->len = set->capacity = listLength;
+    set->fFlags |= kIsListAlias;
+    if (bits != NULL) {
+        set->bmpSet = new BMPSet(bits, set->list, set->len);
+    } else {
+        // Same as in freeze(): BMP lookup tables are only omitted for sets
+        // with span-relevant strings.
+        set->stringSpan = new UnicodeSetStringSpan(*set, *set->strings, UnicodeSetStringSpan::ALL);
+    }
+    if (!set->isFrozen()) {
+        delete set;
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    return set;
+}
+
 //----------------------------------------------------------------
 // Implementation: Utility methods
 //----------------------------------------------------------------
@@ -1618,7 +1814,7 @@ void UnicodeSet::swapBuffers(void) {
 
 void UnicodeSet::setToBogus() {
     clear(); // Remove everything in the set.
-    fFlags = kIsBogus;
+    fFlags = kIsBogus | (fFlags & kIsListAlias);
 }
 
 //----------------------------------------------------------------
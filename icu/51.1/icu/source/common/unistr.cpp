@@ -31,6 +31,7 @@
 #include "ustr_imp.h"
 #include "umutex.h"
 #include "uassert.h"
+#include "ustrarena.h"
 
 #if 0
 
@@ -139,6 +140,8 @@ void
 UnicodeString::releaseArray() {
   if((fFlags & kRefCounted) && removeRef() == 0) {
     uprv_free((int32_t *)fUnion.fFields.fArray - 1);
+  } else if(fFlags & kArenaBuffer) {
+    UnicodeStringArena::release(fUnion.fFields.fArray);
   }
 }
 
@@ -371,6 +374,17 @@ UnicodeString::allocate(int32_t capacity) {
   if(capacity <= US_STACKBUF_SIZE) {
     fFlags = kShortString;
   } else {
+    // temporaries in the scope of a UnicodeStringArena use its memory
+    // the +1 is for the NUL terminator, as below
+    int32_t arenaCapacity;
+    UChar *scratch = UnicodeStringArena::allocate(this, capacity + 1, arenaCapacity);
+    if(scratch != 0) {
+      fUnion.fFields.fArray = scratch;
+      fUnion.fFields.fCapacity = arenaCapacity;
+      fFlags = kArenaBuffer;
+      return TRUE;
+    }
+
     // count bytes for the refCounter and the string capacity, and
     // round up to a multiple of 16; then divide by 4 and allocate int32_t's
     // to be safely aligned for the refCount
@@ -513,6 +527,9 @@ UnicodeString::copyFrom(const UnicodeString &src, UBool fastCopy) {
     }
     // else if(!fastCopy) fall through to case kWritableAlias
     // -> allocate a new buffer and copy the contents
+  case kArenaBuffer:
+    // src uses a buffer from a UnicodeStringArena, which may go away before we do;
+    // we make a copy of that as well
   case kWritableAlias:
     // src is a writable alias; we make a copy of that instead
     if(allocate(srcLength)) {
@@ -1638,6 +1655,21 @@ UnicodeString::cloneArrayIfNeeded(int32_t newCapacity,
       growCapacity = US_STACKBUF_SIZE;
     }
 
+    // a buffer from a UnicodeStringArena can often grow in place
+    if((fFlags & kArenaBuffer) && !forceClone) {
+      int32_t capacity;
+      if(UnicodeStringArena::extend(fUnion.fFields.fArray, growCapacity + 1, capacity) ||
+         (newCapacity < growCapacity &&
+          UnicodeStringArena::extend(fUnion.fFields.fArray, newCapacity + 1, capacity))
+      ) {
+        fUnion.fFields.fCapacity = capacity;
+        if(!doCopyArray) {
+          fShortLength = 0;
+        }
+        return TRUE;
+      }
+    }
+
     // save old values
     UChar oldStackBuffer[US_STACKBUF_SIZE];
     UChar *oldArray;
@@ -1688,6 +1720,12 @@ UnicodeString::cloneArrayIfNeeded(int32_t newCapacity,
             *pBufferToDelete = pRefCount;
           }
         }
+      } else if(flags & kArenaBuffer) {
+        // the arena buffer stays valid until the arena goes away;
+        // let the arena reuse it unless the caller still reads from it
+        if(pBufferToDelete == 0) {
+          UnicodeStringArena::release(oldArray);
+        }
       }
     } else {
       // not enough memory for growCapacity and not even for the smaller newCapacity
@@ -45,6 +45,31 @@ static UHashtable *cache = NULL;
 
 static UMutex resbMutex = U_MUTEX_INITIALIZER;
 
+/*
+Lock-free cache of the results of entryOpen(), which is what ures_open()
+and its variants spend their time on when the bundles are already loaded.
+Each slot is written at most once, under resbMutex, with a fully initialized
+ResolvedEntry, and is only cleared again by ures_cleanup().  Readers therefore
+need no lock: they either see NULL or a complete, immutable entry.
+The cache holds a reference on each fallback chain it contains, so that
+ures_flushCache() never deletes a UResourceDataEntry that a reader may be
+about to return.
+Because readers take references without the mutex, fCountExisting is always
+updated with atomic operations.
+*/
+typedef struct ResolvedEntry {
+    char *fPath;                             /* NULL for ICU data */
+    char fLocaleID[ULOC_FULLNAME_CAPACITY];
+    char fDefaultLocale[ULOC_FULLNAME_CAPACITY]; /* entryOpen() falls back to the default locale */
+    UResourceDataEntry *fEntry;
+    UErrorCode fStatus;                      /* warning returned together with fEntry */
+} ResolvedEntry;
+
+#define RESOLVED_CACHE_SIZE 64  /* must be a power of 2 */
+#define RESOLVED_CACHE_PROBES 4
+
+static ResolvedEntry *resolvedCache[RESOLVED_CACHE_SIZE];
+
 /* INTERNAL: hashes an entry  */
 static int32_t U_CALLCONV hashEntry(const UHashTok parm) {
     UResourceDataEntry *b = (UResourceDataEntry *)parm.pointer;
@@ -83,17 +108,23 @@ static UBool chopLocale(char *name) {
     return FALSE;
 }
 
+static void entryAddRef(UResourceDataEntry *entry) {
+    umtx_atomic_inc((int32_t *)&entry->fCountExisting);
+}
+
+static void entryRelease(UResourceDataEntry *entry) {
+    umtx_atomic_dec((int32_t *)&entry->fCountExisting);
+}
+
 /**
  *  Internal function
  */
 static void entryIncrease(UResourceDataEntry *entry) {
-    umtx_lock(&resbMutex);
-    entry->fCountExisting++;
+    entryAddRef(entry);
     while(entry->fParent != NULL) {
       entry = entry->fParent;
-      entry->fCountExisting++;
+      entryAddRef(entry);
     }
-    umtx_unlock(&resbMutex);
 }
 
 /**
@@ -151,14 +182,14 @@ free_entry(UResourceDataEntry *entry) {
         uprv_free(entry->fPath);
     }
     if(entry->fPool != NULL) {
-        --entry->fPool->fCountExisting;
+        entryRelease(entry->fPool);
     }
     alias = entry->fAlias;
     if(alias != NULL) {
         while(alias->fAlias != NULL) {
             alias = alias->fAlias;
         }
-        --alias->fCountExisting;
+        entryRelease(alias);
     }
     uprv_free(entry);
 }
@@ -252,8 +283,21 @@ U_CAPI UBool U_EXPORT2 ures_dumpCacheContents(void) {
 
 #endif
 
+static void entryCloseInt(UResourceDataEntry *resB);
+
 static UBool U_CALLCONV ures_cleanup(void)
 {
+    int32_t i;
+    /* Not thread-safe, like all of u_cleanup(): no reader may be active. */
+    for (i = 0; i < RESOLVED_CACHE_SIZE; ++i) {
+        ResolvedEntry *e = resolvedCache[i];
+        if (e != NULL) {
+            entryCloseInt(e->fEntry);
+            uprv_free(e->fPath);
+            uprv_free(e);
+            resolvedCache[i] = NULL;
+        }
+    }
     if (cache != NULL) {
         ures_flushCache();
         if (cache != NULL && uhash_count(cache) == 0) {
@@ -432,7 +476,7 @@ static UResourceDataEntry *init_entry(const char *localeID, const char *path, UE
         while(r->fAlias != NULL) {
             r = r->fAlias;
         }
-        r->fCountExisting++; /* we increase its reference count */
+        entryAddRef(r); /* we increase its reference count */
         /* if the resource has a warning */
         /* we don't want to overwrite a status with no error */
         if(r->fBogus != U_ZERO_ERROR && U_SUCCESS(*status)) {
@@ -475,7 +519,7 @@ static UResourceDataEntry *findFirstExisting(const char* path, char* name, UBool
             /* not to be used - as there might be parent   */
             /* lines in cache from previous openings that  */
             /* are not updated yet. */
-            r->fCountExisting--;
+            entryRelease(r);
             /*entryCloseInt(r);*/
             r = NULL;
             *status = U_USING_FALLBACK_WARNING;
@@ -511,6 +555,97 @@ U_CFUNC void ures_initStackObject(UResourceBundle* resB) {
   ures_setIsStackObject(resB, TRUE);
 }
 
+static int32_t hashResolved(const char *path, const char *localeID) {
+    int32_t hash = 0;
+    if (path != NULL) {
+        while (*path != 0) {
+            hash = hash * 37 + (uint8_t)*path++;
+        }
+    }
+    while (*localeID != 0) {
+        hash = hash * 37 + (uint8_t)*localeID++;
+    }
+    return hash;
+}
+
+static UBool isSamePath(const char *path1, const char *path2) {
+    if (path1 == NULL || path2 == NULL) {
+        return (UBool)(path1 == path2);
+    }
+    return (UBool)(uprv_strcmp(path1, path2) == 0);
+}
+
+/*
+ * Lock-free lookup of a previous entryOpen() result.
+ * On a hit, takes a reference on the fallback chain, as entryOpen() does.
+ */
+static UResourceDataEntry *findResolvedEntry(const char *path, const char *localeID, UErrorCode *status) {
+    const char *defaultLoc = uloc_getDefault();
+    int32_t hash = hashResolved(path, localeID);
+    int32_t i;
+    for (i = 0; i < RESOLVED_CACHE_PROBES; ++i) {
+        ResolvedEntry *e;
+        UMTX_CHECK(&resbMutex, resolvedCache[(hash + i) & (RESOLVED_CACHE_SIZE - 1)], e);
+        if (e == NULL) {
+            break;
+        }
+        if (uprv_strcmp(e->fLocaleID, localeID) == 0 && isSamePath(e->fPath, path) &&
+                uprv_strcmp(e->fDefaultLocale, defaultLoc) == 0) {
+            entryIncrease(e->fEntry);
+            if (e->fStatus != U_ZERO_ERROR) {
+                *status = e->fStatus;
+            }
+            return e->fEntry;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Publish an entryOpen() result.  The cache keeps its own reference on the chain.
+ * If all the probed slots are taken, the result is simply not cached.
+ */
+static void addResolvedEntry(const char *path, const char *localeID, UResourceDataEntry *r, UErrorCode intStatus) {
+    const char *defaultLoc = uloc_getDefault();
+    int32_t hash;
+    int32_t i;
+    if (uprv_strlen(localeID) >= ULOC_FULLNAME_CAPACITY || uprv_strlen(defaultLoc) >= ULOC_FULLNAME_CAPACITY) {
+        return;
+    }
+    hash = hashResolved(path, localeID);
+    umtx_lock(&resbMutex);
+    for (i = 0; i < RESOLVED_CACHE_PROBES; ++i) {
+        ResolvedEntry **slot = &resolvedCache[(hash + i) & (RESOLVED_CACHE_SIZE - 1)];
+        ResolvedEntry *e = *slot;
+        if (e != NULL) {
+            if (uprv_strcmp(e->fLocaleID, localeID) == 0 && isSamePath(e->fPath, path) &&
+                    uprv_strcmp(e->fDefaultLocale, defaultLoc) == 0) {
+                break;  /* another thread was faster */
+            }
+            continue;
+        }
+        e = (ResolvedEntry *)uprv_malloc(sizeof(ResolvedEntry));
+        if (e == NULL) {
+            break;
+        }
+        e->fPath = NULL;
+        if (path != NULL && (e->fPath = uprv_strdup(path)) == NULL) {
+            uprv_free(e);
+            break;
+        }
+        uprv_strcpy(e->fLocaleID, localeID);
+        uprv_strcpy(e->fDefaultLocale, defaultLoc);
+        e->fEntry = r;
+        e->fStatus = intStatus;
+        entryIncrease(r);
+        /* The entry must be complete before other threads can see it. */
+        UMTX_RELEASE_BARRIER;
+        *slot = e;
+        break;
+    }
+    umtx_unlock(&resbMutex);
+}
+
 static UResourceDataEntry *entryOpen(const char* path, const char* localeID, UErrorCode* status) {
     UErrorCode intStatus = U_ZERO_ERROR;
     UErrorCode parentStatus = U_ZERO_ERROR;
@@ -535,6 +670,11 @@ static UResourceDataEntry *entryOpen(const char* path, const char* localeID, UEr
         return NULL;
     }
 
+    r = findResolvedEntry(path, localeID, status);
+    if(r != NULL) {
+        return r;
+    }
+
     uprv_strncpy(name, localeID, sizeof(name) - 1);
     name[sizeof(name) - 1] = 0;
 
@@ -679,7 +819,7 @@ static UResourceDataEntry *entryOpen(const char* path, const char* localeID, UEr
         }
 
         while(r != NULL && !isRoot && t1->fParent != NULL) {
-            t1->fParent->fCountExisting++;
+            entryAddRef(t1->fParent);
             t1 = t1->fParent;
             hasRealData = (UBool)((t1->fBogus == U_ZERO_ERROR) || hasRealData);
         }
@@ -692,6 +832,7 @@ finishUnlock:
             if(intStatus != U_ZERO_ERROR) {
                 *status = intStatus;  
             }
+            addResolvedEntry(path, localeID, r, intStatus);
             return r;
         } else {
             *status = parentStatus;
@@ -713,7 +854,7 @@ static void entryCloseInt(UResourceDataEntry *resB) {
 
     while(resB != NULL) {
         p = resB->fParent;
-        resB->fCountExisting--;
+        entryRelease(resB);
 
         /* Entries are left in the cache. TODO: add ures_flushCache() to force a flush
          of the cache. */
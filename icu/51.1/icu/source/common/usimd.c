@@ -0,0 +1,324 @@
+/*
+******************************************************************************
+*
+*   Copyright (C) 2013, International Business Machines
+*   Corporation and others.  All Rights Reserved.
+*
+******************************************************************************
+*   file name:  usimd.c
+*   encoding:   US-ASCII
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   Vectorized kernels for converting runs of text between UTF-8 and UTF-16,
+*   and for scanning runs of UTF-16 text.
+*   See usimd.h for the contract that all of them share.
+*/
+
+#include "unicode/utypes.h"
+#include "cmemory.h"
+#include "usimd.h"
+
+#if USIMD_NEON
+
+#include <arm_neon.h>
+
+/* Returns TRUE if all bits of v are set: the per-lane comparisons all succeeded. */
+static UBool
+isAllSet(uint8x8_t v) {
+    uint32x2_t w=vreinterpret_u32_u8(v);
+    return (UBool)((vget_lane_u32(w, 0)&vget_lane_u32(w, 1))==0xffffffff);
+}
+
+/* Same for the lanes of a 16-byte comparison result. */
+static UBool
+isAllSetQ(uint8x16_t v) {
+    return isAllSet(vand_u8(vget_low_u8(v), vget_high_u8(v)));
+}
+
+U_CFUNC int32_t
+usimd_asciiToUChars(UChar *dest, const uint8_t *src, int32_t length) {
+    const uint8x16_t asciiLimit=vdupq_n_u8(0x80);
+    int32_t i=0;
+
+    while((length-i)>=16) {
+        uint8x16_t v=vld1q_u8(src+i);
+        if(!isAllSetQ(vcltq_u8(v, asciiLimit))) {
+            break;
+        }
+        vst1q_u16((uint16_t *)dest+i, vmovl_u8(vget_low_u8(v)));
+        vst1q_u16((uint16_t *)dest+i+8, vmovl_u8(vget_high_u8(v)));
+        i+=16;
+    }
+    while(i<length && src[i]<=0x7f) {
+        dest[i]=src[i];
+        ++i;
+    }
+    return i;
+}
+
+U_CFUNC int32_t
+usimd_asciiFromUChars(uint8_t *dest, const UChar *src, int32_t length) {
+    const uint8x8_t asciiLimit=vdup_n_u8(0x80);
+    int32_t i=0;
+
+    while((length-i)>=16) {
+        /* saturate to 8 bits: every UChar above 0x7f ends up with its high bit set */
+        uint8x8_t a=vqmovn_u16(vld1q_u16((const uint16_t *)src+i));
+        uint8x8_t b=vqmovn_u16(vld1q_u16((const uint16_t *)src+i+8));
+        if(!isAllSet(vclt_u8(vorr_u8(a, b), asciiLimit))) {
+            break;
+        }
+        vst1q_u8(dest+i, vcombine_u8(a, b));
+        i+=16;
+    }
+    while(i<length && src[i]<=0x7f) {
+        dest[i]=(uint8_t)src[i];
+        ++i;
+    }
+    return i;
+}
+
+U_CFUNC int32_t
+usimd_utf8TwoByteToUChars(UChar *dest, const uint8_t *src, int32_t count) {
+    int32_t n=0;
+
+    /* lead bytes C2..DF, trail bytes 80..BF */
+    while((count-n)>=16) {
+        uint8x16x2_t v=vld2q_u8(src+2*n);
+        uint8x16_t lead=v.val[0];
+        uint8x16_t trail=vsubq_u8(v.val[1], vdupq_n_u8(0x80));
+        uint8x16_t ok=vandq_u8(vcleq_u8(vsubq_u8(lead, vdupq_n_u8(0xc2)), vdupq_n_u8(0x1d)),
+                               vcleq_u8(trail, vdupq_n_u8(0x3f)));
+        if(!isAllSetQ(ok)) {
+            break;
+        }
+        lead=vandq_u8(lead, vdupq_n_u8(0x1f));
+        vst1q_u16((uint16_t *)dest+n,
+                  vorrq_u16(vshll_n_u8(vget_low_u8(lead), 6), vmovl_u8(vget_low_u8(trail))));
+        vst1q_u16((uint16_t *)dest+n+8,
+                  vorrq_u16(vshll_n_u8(vget_high_u8(lead), 6), vmovl_u8(vget_high_u8(trail))));
+        n+=16;
+    }
+    if((count-n)>=8) {
+        uint8x8x2_t v=vld2_u8(src+2*n);
+        uint8x8_t lead=v.val[0];
+        uint8x8_t trail=vsub_u8(v.val[1], vdup_n_u8(0x80));
+        uint8x8_t ok=vand_u8(vcle_u8(vsub_u8(lead, vdup_n_u8(0xc2)), vdup_n_u8(0x1d)),
+                             vcle_u8(trail, vdup_n_u8(0x3f)));
+        if(isAllSet(ok)) {
+            lead=vand_u8(lead, vdup_n_u8(0x1f));
+            vst1q_u16((uint16_t *)dest+n, vorrq_u16(vshll_n_u8(lead, 6), vmovl_u8(trail)));
+            n+=8;
+        }
+    }
+    return n;
+}
+
+U_CFUNC int32_t
+usimd_utf8ThreeByteToUChars(UChar *dest, const uint8_t *src, int32_t count) {
+    int32_t n=0;
+
+    /* lead bytes E1..EF except ED, trail bytes 80..BF */
+    while((count-n)>=16) {
+        uint8x16x3_t v=vld3q_u8(src+3*n);
+        uint8x16_t lead=v.val[0];
+        uint8x16_t t1=vsubq_u8(v.val[1], vdupq_n_u8(0x80));
+        uint8x16_t t2=vsubq_u8(v.val[2], vdupq_n_u8(0x80));
+        uint8x16_t ok=vandq_u8(vcleq_u8(vsubq_u8(lead, vdupq_n_u8(0xe1)), vdupq_n_u8(0x0e)),
+                               vmvnq_u8(vceqq_u8(lead, vdupq_n_u8(0xed))));
+        ok=vandq_u8(ok, vcleq_u8(vorrq_u8(t1, t2), vdupq_n_u8(0x3f)));
+        if(!isAllSetQ(ok)) {
+            break;
+        }
+        lead=vandq_u8(lead, vdupq_n_u8(0x0f));
+        vst1q_u16((uint16_t *)dest+n,
+                  vorrq_u16(vorrq_u16(vshlq_n_u16(vmovl_u8(vget_low_u8(lead)), 12),
+                                      vshll_n_u8(vget_low_u8(t1), 6)),
+                            vmovl_u8(vget_low_u8(t2))));
+        vst1q_u16((uint16_t *)dest+n+8,
+                  vorrq_u16(vorrq_u16(vshlq_n_u16(vmovl_u8(vget_high_u8(lead)), 12),
+                                      vshll_n_u8(vget_high_u8(t1), 6)),
+                            vmovl_u8(vget_high_u8(t2))));
+        n+=16;
+    }
+    if((count-n)>=8) {
+        uint8x8x3_t v=vld3_u8(src+3*n);
+        uint8x8_t lead=v.val[0];
+        uint8x8_t t1=vsub_u8(v.val[1], vdup_n_u8(0x80));
+        uint8x8_t t2=vsub_u8(v.val[2], vdup_n_u8(0x80));
+        uint8x8_t ok=vand_u8(vcle_u8(vsub_u8(lead, vdup_n_u8(0xe1)), vdup_n_u8(0x0e)),
+                             vmvn_u8(vceq_u8(lead, vdup_n_u8(0xed))));
+        ok=vand_u8(ok, vcle_u8(vorr_u8(t1, t2), vdup_n_u8(0x3f)));
+        if(isAllSet(ok)) {
+            lead=vand_u8(lead, vdup_n_u8(0x0f));
+            vst1q_u16((uint16_t *)dest+n,
+                      vorrq_u16(vorrq_u16(vshlq_n_u16(vmovl_u8(lead), 12), vshll_n_u8(t1, 6)),
+                                vmovl_u8(t2)));
+            n+=8;
+        }
+    }
+    return n;
+}
+
+U_CFUNC int32_t
+usimd_utf8TwoByteFromUChars(uint8_t *dest, const UChar *src, int32_t count) {
+    int32_t n=0;
+
+    while((count-n)>=8) {
+        uint16x8_t v=vld1q_u16((const uint16_t *)src+n);
+        uint8x8x2_t out;
+        if(!isAllSet(vmovn_u16(vcleq_u16(vsubq_u16(v, vdupq_n_u16(0x80)), vdupq_n_u16(0x77f))))) {
+            break;
+        }
+        out.val[0]=vorr_u8(vmovn_u16(vshrq_n_u16(v, 6)), vdup_n_u8(0xc0));
+        out.val[1]=vorr_u8(vand_u8(vmovn_u16(v), vdup_n_u8(0x3f)), vdup_n_u8(0x80));
+        vst2_u8(dest+2*n, out);
+        n+=8;
+    }
+    return n;
+}
+
+U_CFUNC int32_t
+usimd_utf8ThreeByteFromUChars(uint8_t *dest, const UChar *src, int32_t count) {
+    int32_t n=0;
+
+    while((count-n)>=8) {
+        uint16x8_t v=vld1q_u16((const uint16_t *)src+n);
+        uint8x8x3_t out;
+        uint16x8_t ok=vandq_u16(vcleq_u16(vsubq_u16(v, vdupq_n_u16(0x800)), vdupq_n_u16(0xf7ff)),
+                                vcgtq_u16(vsubq_u16(v, vdupq_n_u16(0xd800)), vdupq_n_u16(0x7ff)));
+        if(!isAllSet(vmovn_u16(ok))) {
+            break;
+        }
+        out.val[0]=vorr_u8(vmovn_u16(vshrq_n_u16(v, 12)), vdup_n_u8(0xe0));
+        out.val[1]=vorr_u8(vand_u8(vmovn_u16(vshrq_n_u16(v, 6)), vdup_n_u8(0x3f)), vdup_n_u8(0x80));
+        out.val[2]=vorr_u8(vand_u8(vmovn_u16(v), vdup_n_u8(0x3f)), vdup_n_u8(0x80));
+        vst3_u8(dest+3*n, out);
+        n+=8;
+    }
+    return n;
+}
+
+U_CFUNC int32_t
+usimd_spanUCharsBelow(const UChar *s, int32_t length, UChar32 limit) {
+    uint16x8_t vLimit;
+    int32_t i=0;
+
+    if(limit>0xffff) {
+        return length;
+    }
+    vLimit=vdupq_n_u16((uint16_t)limit);
+    while((length-i)>=16) {
+        uint8x8_t a=vmovn_u16(vcltq_u16(vld1q_u16((const uint16_t *)s+i), vLimit));
+        uint8x8_t b=vmovn_u16(vcltq_u16(vld1q_u16((const uint16_t *)s+i+8), vLimit));
+        if(!isAllSet(vand_u8(a, b))) {
+            break;
+        }
+        i+=16;
+    }
+    while(i<length && s[i]<limit) {
+        ++i;
+    }
+    return i;
+}
+
+#else
+
+/*
+ * Portable versions: the ASCII kernels test a word's worth of units
+ * per branch; the multi-byte ones convert nothing (see USIMD_NEON).
+ */
+
+U_CFUNC int32_t
+usimd_asciiToUChars(UChar *dest, const uint8_t *src, int32_t length) {
+    int32_t i=0, j;
+
+    while((length-i)>=8) {
+        uint32_t w0, w1;
+        uprv_memcpy(&w0, src+i, 4);
+        uprv_memcpy(&w1, src+i+4, 4);
+        if((w0|w1)&0x80808080) {
+            break;
+        }
+        for(j=0; j<8; ++j) {
+            dest[i+j]=src[i+j];
+        }
+        i+=8;
+    }
+    while(i<length && src[i]<=0x7f) {
+        dest[i]=src[i];
+        ++i;
+    }
+    return i;
+}
+
+U_CFUNC int32_t
+usimd_asciiFromUChars(uint8_t *dest, const UChar *src, int32_t length) {
+    int32_t i=0, j;
+
+    while((length-i)>=4) {
+        if((src[i]|src[i+1]|src[i+2]|src[i+3])>0x7f) {
+            break;
+        }
+        for(j=0; j<4; ++j) {
+            dest[i+j]=(uint8_t)src[i+j];
+        }
+        i+=4;
+    }
+    while(i<length && src[i]<=0x7f) {
+        dest[i]=(uint8_t)src[i];
+        ++i;
+    }
+    return i;
+}
+
+U_CFUNC int32_t
+usimd_utf8TwoByteToUChars(UChar *dest, const uint8_t *src, int32_t count) {
+    (void)dest;
+    (void)src;
+    (void)count;
+    return 0;
+}
+
+U_CFUNC int32_t
+usimd_utf8ThreeByteToUChars(UChar *dest, const uint8_t *src, int32_t count) {
+    (void)dest;
+    (void)src;
+    (void)count;
+    return 0;
+}
+
+U_CFUNC int32_t
+usimd_utf8TwoByteFromUChars(uint8_t *dest, const UChar *src, int32_t count) {
+    (void)dest;
+    (void)src;
+    (void)count;
+    return 0;
+}
+
+U_CFUNC int32_t
+usimd_utf8ThreeByteFromUChars(uint8_t *dest, const UChar *src, int32_t count) {
+    (void)dest;
+    (void)src;
+    (void)count;
+    return 0;
+}
+
+U_CFUNC int32_t
+usimd_spanUCharsBelow(const UChar *s, int32_t length, UChar32 limit) {
+    int32_t i=0;
+
+    while((length-i)>=4) {
+        if(s[i]>=limit || s[i+1]>=limit || s[i+2]>=limit || s[i+3]>=limit) {
+            break;
+        }
+        i+=4;
+    }
+    while(i<length && s[i]<limit) {
+        ++i;
+    }
+    return i;
+}
+
+#endif
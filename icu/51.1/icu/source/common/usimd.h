@@ -0,0 +1,115 @@
+/*
+******************************************************************************
+*
+*   Copyright (C) 2013, International Business Machines
+*   Corporation and others.  All Rights Reserved.
+*
+******************************************************************************
+*   file name:  usimd.h
+*   encoding:   US-ASCII
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   Vectorized kernels for converting runs of text between UTF-8 and UTF-16,
+*   and for scanning runs of UTF-16 text.
+*
+*   Each conversion function converts only a prefix of its input that consists entirely of
+*   well-formed characters of one kind (ASCII, 2-byte UTF-8 or 3-byte UTF-8),
+*   and returns the length of that prefix. The callers continue with their
+*   own per-character code at the first unit that was not converted, so that
+*   error handling, substitution and buffer overflow behavior stay the same.
+*
+*   The 2- and 3-byte kernels require ARM NEON and are selected at compile time.
+*   Without NEON they convert nothing and the USIMD_NEON constant lets the
+*   compiler remove their call sites.
+*/
+
+#ifndef __USIMD_H__
+#define __USIMD_H__
+
+#include "unicode/utypes.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#   define USIMD_NEON 1
+#else
+#   define USIMD_NEON 0
+#endif
+
+/**
+ * Callers should not call the kernels for fewer than this many units:
+ * the 2- and 3-byte kernels work on blocks of this many characters.
+ * @internal
+ */
+#define USIMD_MIN_RUN 8
+
+/**
+ * Copies the leading ASCII bytes (<=0x7f) of src[0..length[ to dest, as UChars.
+ * dest must have room for length UChars.
+ * @return the number of bytes copied, 0..length
+ * @internal
+ */
+U_CFUNC int32_t
+usimd_asciiToUChars(UChar *dest, const uint8_t *src, int32_t length);
+
+/**
+ * Copies the leading UChars <=0x7f of src[0..length[ to dest, as bytes.
+ * dest must have room for length bytes.
+ * @return the number of UChars copied, 0..length
+ * @internal
+ */
+U_CFUNC int32_t
+usimd_asciiFromUChars(uint8_t *dest, const UChar *src, int32_t length);
+
+/**
+ * Converts leading well-formed 2-byte UTF-8 sequences (U+0080..U+07FF)
+ * to UChars, in blocks of USIMD_MIN_RUN sequences.
+ * src must have at least 2*count bytes, and dest room for count UChars.
+ * @return the number of UChars written, a multiple of USIMD_MIN_RUN <=count
+ * @internal
+ */
+U_CFUNC int32_t
+usimd_utf8TwoByteToUChars(UChar *dest, const uint8_t *src, int32_t count);
+
+/**
+ * Converts leading well-formed 3-byte UTF-8 sequences with lead bytes
+ * E1..EC and EE..EF (U+1000..U+CFFF and U+E000..U+FFFF) to UChars,
+ * in blocks of USIMD_MIN_RUN sequences.
+ * E0 and ED sequences are left to the caller because of their
+ * restricted first trail bytes.
+ * src must have at least 3*count bytes, and dest room for count UChars.
+ * @return the number of UChars written, a multiple of USIMD_MIN_RUN <=count
+ * @internal
+ */
+U_CFUNC int32_t
+usimd_utf8ThreeByteToUChars(UChar *dest, const uint8_t *src, int32_t count);
+
+/**
+ * Converts leading UChars U+0080..U+07FF to 2-byte UTF-8,
+ * in blocks of USIMD_MIN_RUN UChars.
+ * dest must have room for 2*count bytes.
+ * @return the number of UChars converted, a multiple of USIMD_MIN_RUN <=count
+ * @internal
+ */
+U_CFUNC int32_t
+usimd_utf8TwoByteFromUChars(uint8_t *dest, const UChar *src, int32_t count);
+
+/**
+ * Converts leading UChars U+0800..U+FFFF other than surrogates to 3-byte UTF-8,
+ * in blocks of USIMD_MIN_RUN UChars.
+ * dest must have room for 3*count bytes.
+ * @return the number of UChars converted, a multiple of USIMD_MIN_RUN <=count
+ * @internal
+ */
+U_CFUNC int32_t
+usimd_utf8ThreeByteFromUChars(uint8_t *dest, const UChar *src, int32_t count);
+
+/**
+ * Returns the length of the leading run of s[0..length[ with all UChars
+ * below limit, for skipping text that needs no per-character lookups.
+ * @return the number of UChars <limit at the start of s, 0..length
+ * @internal
+ */
+U_CFUNC int32_t
+usimd_spanUCharsBelow(const UChar *s, int32_t length, UChar32 limit);
+
+#endif
@@ -0,0 +1,186 @@
+/*
+*******************************************************************************
+*   Copyright (C) 2013, International Business Machines
+*   Corporation and others.  All Rights Reserved.
+*******************************************************************************
+*   file name:  ustrarena.cpp
+*   encoding:   US-ASCII
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   created on: 2013may06
+*/
+
+#include "unicode/utypes.h"
+#include "cmemory.h"
+#include "uassert.h"
+#include "ustrarena.h"
+
+#if U_HAVE_STRING_ARENA && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+U_NAMESPACE_BEGIN
+
+/*
+ * Each buffer from an arena starts with a pointer to the arena,
+ * followed by the UChars. Buffer sizes are multiples of
+ * sizeof(void *) so that these pointers are aligned.
+ */
+static const int32_t kArrayHeaderSize=(int32_t)sizeof(UnicodeStringArena *);
+
+static inline int32_t
+getArraySize(int32_t capacity) {
+    return (int32_t)((kArrayHeaderSize+capacity*U_SIZEOF_UCHAR+sizeof(void *)-1)&~(sizeof(void *)-1));
+}
+
+static inline UnicodeStringArena *
+getArena(const char *p) {
+    return *(UnicodeStringArena *const *)p;
+}
+
+struct UnicodeStringArena::Block {
+    Block *next;
+};
+
+#if U_HAVE_STRING_ARENA
+
+#if defined(_MSC_VER)
+static __declspec(thread) UnicodeStringArena *gCurrentArena=NULL;
+#   define USTRARENA_NOINLINE __declspec(noinline)
+#else
+static __thread UnicodeStringArena *gCurrentArena=NULL;
+#   define USTRARENA_NOINLINE __attribute__((noinline))
+#endif
+
+/*
+ * Returns an address in a stack frame of its own.
+ * It is below (deeper than) all of the stack objects of the caller and of its callers,
+ * and above (not as deep as) the objects in functions that the caller calls later.
+ */
+static USTRARENA_NOINLINE const char *
+getStackPosition() {
+#if defined(_MSC_VER)
+    return (const char *)_AddressOfReturnAddress();
+#else
+    return (const char *)__builtin_frame_address(0);
+#endif
+}
+
+#endif
+
+UnicodeStringArena::UnicodeStringArena()
+        : previous(NULL), stackLimit(NULL), heapBlocks(NULL),
+          start(stackBlock.bytes), limit(stackBlock.bytes+kStackBlockSize), lastArray(NULL),
+          nextHeapBlockSize(kMinHeapBlockSize),
+          allocationCount(0), extensionCount(0), heapBlockCount(0) {
+#if U_HAVE_STRING_ARENA
+    stackLimit=getStackPosition();
+    previous=gCurrentArena;
+    gCurrentArena=this;
+#endif
+}
+
+UnicodeStringArena::~UnicodeStringArena() {
+#if U_HAVE_STRING_ARENA
+    U_ASSERT(gCurrentArena==this);
+    gCurrentArena=previous;
+#endif
+    while(heapBlocks!=NULL) {
+        Block *next=heapBlocks->next;
+        uprv_free(heapBlocks);
+        heapBlocks=next;
+    }
+}
+
+UChar *
+UnicodeStringArena::allocate(const void *s, int32_t capacity, int32_t &newCapacity) {
+#if U_HAVE_STRING_ARENA
+    UnicodeStringArena *arena=gCurrentArena;
+    if(arena==NULL || capacity>(kMaxArraySize-kArrayHeaderSize)/U_SIZEOF_UCHAR) {
+        return NULL;
+    }
+    // All of the memory between here and an arena's stack limit is this thread's stack,
+    // in frames that unwind before that arena's scope ends.
+    const char *top=getStackPosition();
+    const char *p=(const char *)s;
+    do {
+        if(top<arena->stackLimit ?
+                (top<p && p<arena->stackLimit) :
+                (arena->stackLimit<p && p<top)) {
+            return arena->allocateArray(capacity, newCapacity);
+        }
+        arena=arena->previous;
+    } while(arena!=NULL);
+#else
+    (void)s;
+    (void)capacity;
+    (void)newCapacity;
+#endif
+    return NULL;
+}
+
+UChar *
+UnicodeStringArena::allocateArray(int32_t capacity, int32_t &newCapacity) {
+    int32_t size=getArraySize(capacity);
+    if(size>(limit-start) && !newBlock(size)) {
+        return NULL;
+    }
+    *(UnicodeStringArena **)start=this;
+    lastArray=start;
+    start+=size;
+    ++allocationCount;
+    newCapacity=(size-kArrayHeaderSize)/U_SIZEOF_UCHAR;
+    return (UChar *)(lastArray+kArrayHeaderSize);
+}
+
+UBool
+UnicodeStringArena::newBlock(int32_t minSize) {
+    int32_t size=nextHeapBlockSize;
+    while((size-(int32_t)sizeof(Block))<minSize) {
+        size*=2;
+    }
+    Block *block=(Block *)uprv_malloc(size);
+    if(block==NULL) {
+        return FALSE;
+    }
+    block->next=heapBlocks;
+    heapBlocks=block;
+    start=(char *)(block+1);
+    limit=(char *)block+size;
+    lastArray=NULL;
+    if(nextHeapBlockSize<kMaxHeapBlockSize) {
+        nextHeapBlockSize*=2;
+    }
+    ++heapBlockCount;
+    return TRUE;
+}
+
+UBool
+UnicodeStringArena::extend(UChar *array, int32_t capacity, int32_t &newCapacity) {
+    char *p=(char *)array-kArrayHeaderSize;
+    UnicodeStringArena *arena=getArena(p);
+    if(p!=arena->lastArray || capacity>(kMaxArraySize-kArrayHeaderSize)/U_SIZEOF_UCHAR) {
+        return FALSE;
+    }
+    int32_t size=getArraySize(capacity);
+    if(size>(arena->limit-p)) {
+        return FALSE;
+    }
+    arena->start=p+size;
+    ++arena->extensionCount;
+    newCapacity=(size-kArrayHeaderSize)/U_SIZEOF_UCHAR;
+    return TRUE;
+}
+
+void
+UnicodeStringArena::release(UChar *array) {
+    char *p=(char *)array-kArrayHeaderSize;
+    UnicodeStringArena *arena=getArena(p);
+    if(p==arena->lastArray) {
+        arena->start=p;
+        arena->lastArray=NULL;
+    }
+}
+
+U_NAMESPACE_END
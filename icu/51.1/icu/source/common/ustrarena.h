@@ -0,0 +1,154 @@
+/*
+*******************************************************************************
+*   Copyright (C) 2013, International Business Machines
+*   Corporation and others.  All Rights Reserved.
+*******************************************************************************
+*   file name:  ustrarena.h
+*   encoding:   US-ASCII
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   created on: 2013may06
+*
+*   Per-thread scratch arena for the buffers of UnicodeString temporaries.
+*/
+
+#ifndef __USTRARENA_H__
+#define __USTRARENA_H__
+
+#include "unicode/utypes.h"
+#include "unicode/uobject.h"
+
+/**
+ * \def U_HAVE_STRING_ARENA
+ * Defined to 1 if UnicodeStringArena can keep its per-thread state,
+ * which needs compiler support for thread-local variables.
+ * Otherwise an arena does nothing, and all string buffers come from uprv_malloc().
+ * @internal
+ */
+#ifdef U_HAVE_STRING_ARENA
+    /* Use the predefined value. */
+#elif defined(_MSC_VER) || \
+        (defined(__GNUC__) && (!U_PLATFORM_IS_DARWIN_BASED || defined(__clang__)))
+#   define U_HAVE_STRING_ARENA 1
+#else
+#   define U_HAVE_STRING_ARENA 0
+#endif
+
+U_NAMESPACE_BEGIN
+
+/**
+ * ICU-internal scratch arena for UnicodeString temporaries.
+ *
+ * While an arena object is alive, the UnicodeString objects that live on the
+ * stack in the functions called from its scope take their buffers from the arena
+ * rather than from uprv_malloc(). Releasing such a buffer costs nothing;
+ * the arena releases all of its memory at once when it goes away.
+ * A buffer that is the arena's most recent allocation grows in place.
+ *
+ * Only strings whose storage is on this thread's stack, below the frame that
+ * declared the arena, use it. Those strings are always destroyed before the
+ * arena is, so its buffers can not be reached after it is gone:
+ * - The declaring function's own strings, all of the strings that were passed
+ *   into it, and all heap and static strings keep using uprv_malloc().
+ *   (So do the locals of callees that the compiler inlines into the declaring function.)
+ * - Copying from a string with an arena buffer always copies the contents,
+ *   rather than sharing the buffer.
+ *
+ * Arenas nest. Each string uses the innermost arena whose scope it is in.
+ * The code must not switch stacks (as with coroutines) inside the arena's scope,
+ * and a string that uses an arena must only be modified on its own thread.
+ *
+ * No heap allocation. Use only on the stack.
+ *   (Declaring these functions private triggers a cascade of problems;
+ *    see the MaybeStackArray class for details.)
+ */
+class U_COMMON_API UnicodeStringArena : public UMemory {
+public:
+    /**
+     * Makes this the current thread's innermost arena.
+     */
+    UnicodeStringArena();
+    /**
+     * Releases all of the arena's memory, and restores the enclosing arena (if any).
+     */
+    ~UnicodeStringArena();
+
+    /**
+     * @return the number of string buffers that came from this arena
+     */
+    int32_t countAllocations() const { return allocationCount; }
+    /**
+     * @return the number of times that a string buffer grew in place
+     */
+    int32_t countExtensions() const { return extensionCount; }
+    /**
+     * @return the number of memory blocks that the arena needed from uprv_malloc()
+     */
+    int32_t countHeapBlocks() const { return heapBlockCount; }
+
+    /**
+     * Returns a buffer for the string object at address s, if s is in the scope of an arena.
+     * Returns NULL if it is not, or if the capacity is larger than an arena provides;
+     * the caller then uses uprv_malloc().
+     * @param s the address of the UnicodeString object
+     * @param capacity the number of UChars needed
+     * @param newCapacity receives the number of UChars that fit into the buffer,
+     *        at least capacity
+     * @internal
+     */
+    static UChar *allocate(const void *s, int32_t capacity, int32_t &newCapacity);
+    /**
+     * Grows a buffer from allocate() in place, if it is its arena's most recent allocation
+     * and the arena has room.
+     * @param array a buffer from allocate()
+     * @param capacity the number of UChars needed
+     * @param newCapacity receives the new capacity, if TRUE is returned
+     * @return TRUE if the buffer now holds at least capacity UChars
+     * @internal
+     */
+    static UBool extend(UChar *array, int32_t capacity, int32_t &newCapacity);
+    /**
+     * Gives a buffer from allocate() back to its arena.
+     * The contents are not used any more; the memory may be reused right away.
+     * @internal
+     */
+    static void release(UChar *array);
+
+private:
+    struct Block;
+
+    UnicodeStringArena(const UnicodeStringArena &other);  // forbid copying of this class
+    UnicodeStringArena &operator=(const UnicodeStringArena &other);  // forbid copying of this class
+
+    UChar *allocateArray(int32_t capacity, int32_t &newCapacity);
+    UBool newBlock(int32_t minSize);
+
+    enum {
+        /** Number of bytes in the arena object itself; this is the first block. */
+        kStackBlockSize=2048,
+        /** Number of bytes in the first heap block. Each further one is twice as large. */
+        kMinHeapBlockSize=4096,
+        kMaxHeapBlockSize=0x10000,
+        /** Larger buffers come from uprv_malloc(). */
+        kMaxArraySize=kMaxHeapBlockSize/4
+    };
+
+    UnicodeStringArena *previous;
+    /** Strings between the stack top and this address are in the arena's scope. */
+    const char *stackLimit;
+    Block *heapBlocks;
+    char *start, *limit;  // free space in the current block
+    char *lastArray;  // start of the most recent allocation
+    int32_t nextHeapBlockSize;
+    int32_t allocationCount, extensionCount, heapBlockCount;
+    union {
+        void *p;
+        double d;
+        char bytes[kStackBlockSize];
+    } stackBlock;
+};
+
+U_NAMESPACE_END
+
+#endif
@@ -1,7 +1,7 @@
 /*
 *******************************************************************************
 *
-*   Copyright (C) 2001-2011, International Business Machines
+*   Copyright (C) 2001-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 *******************************************************************************
@@ -88,6 +88,36 @@ appendResult(UChar *dest, int32_t destIndex, int32_t destCapacity,
     return destIndex;
 }
 
+/*
+ * Maps a run of characters starting at src[srcIndex] that have simple,
+ * context-independent mappings in a table from ucase_getLatin1Mappings().
+ * Stops before the first character that needs the full mapping function.
+ * Increments destIndex once per character, and writes while dest has room.
+ * @return the new srcIndex
+ */
+static inline int32_t
+mapLatin1Run(const UChar *latin1,
+             UChar *dest, int32_t &destIndex, int32_t destCapacity,
+             const UChar *src, int32_t srcIndex, int32_t srcLimit) {
+    UChar c, m;
+    int32_t writeLimit=srcLimit;
+    if(destCapacity-destIndex<srcLimit-srcIndex) {
+        writeLimit= destIndex<destCapacity ? srcIndex+(destCapacity-destIndex) : srcIndex;
+    }
+    while(srcIndex<writeLimit && (c=src[srcIndex])<=0xff && (m=latin1[c])!=0) {
+        dest[destIndex++]=m;
+        ++srcIndex;
+    }
+    if(srcIndex==writeLimit) {
+        /* dest is full: preflight the rest of the run */
+        while(srcIndex<srcLimit && (c=src[srcIndex])<=0xff && latin1[c]!=0) {
+            ++destIndex;
+            ++srcIndex;
+        }
+    }
+    return srcIndex;
+}
+
 static UChar32 U_CALLCONV
 utf16_caseContextIterator(void *context, int8_t dir) {
     UCaseContext *csc=(UCaseContext *)context;
@@ -125,7 +155,7 @@ utf16_caseContextIterator(void *context, int8_t dir) {
  * context [0..srcLength[ into account.
  */
 static int32_t
-_caseMap(const UCaseMap *csm, UCaseMapFull *map,
+_caseMap(const UCaseMap *csm, UCaseMapFull *map, int32_t latin1Which,
          UChar *dest, int32_t destCapacity,
          const UChar *src, UCaseContext *csc,
          int32_t srcStart, int32_t srcLimit,
@@ -134,6 +164,7 @@ _caseMap(const UCaseMap *csm, UCaseMapFull *map,
     UChar32 c, c2 = 0;
     int32_t srcIndex, destIndex;
     int32_t locCache;
+    const UChar *latin1=ucase_getLatin1Mappings(csm->csp, latin1Which);
 
     locCache=csm->locCache;
 
@@ -141,6 +172,12 @@ _caseMap(const UCaseMap *csm, UCaseMapFull *map,
     srcIndex=srcStart;
     destIndex=0;
     while(srcIndex<srcLimit) {
+        if(latin1!=NULL) {
+            srcIndex=mapLatin1Run(latin1, dest, destIndex, destCapacity, src, srcIndex, srcLimit);
+            if(srcIndex==srcLimit) {
+                break;
+            }
+        }
         csc->cpStart=srcIndex;
         U16_NEXT(src, srcIndex, srcLimit, c);
         csc->cpLimit=srcIndex;
@@ -266,7 +303,7 @@ ustrcase_internalToTitle(const UCaseMap *csm,
                         /* Normal operation: Lowercase the rest of the word. */
                         destIndex+=
                             _caseMap(
-                                csm, ucase_toFullLower,
+                                csm, ucase_toFullLower, UCASE_LATIN1_LOWER,
                                 dest+destIndex, destCapacity-destIndex,
                                 src, &csc,
                                 titleLimit, idx,
@@ -305,7 +342,7 @@ ustrcase_internalToLower(const UCaseMap *csm,
     csc.p=(void *)src;
     csc.limit=srcLength;
     return _caseMap(
-        csm, ucase_toFullLower,
+        csm, ucase_toFullLower, UCASE_LATIN1_LOWER,
         dest, destCapacity,
         src, &csc, 0, srcLength,
         pErrorCode);
@@ -320,7 +357,7 @@ ustrcase_internalToUpper(const UCaseMap *csm,
     csc.p=(void *)src;
     csc.limit=srcLength;
     return _caseMap(
-        csm, ucase_toFullUpper,
+        csm, ucase_toFullUpper, UCASE_LATIN1_UPPER,
         dest, destCapacity,
         src, &csc, 0, srcLength,
         pErrorCode);
@@ -336,10 +373,17 @@ ustr_foldCase(const UCaseProps *csp,
 
     const UChar *s;
     UChar32 c, c2 = 0;
+    const UChar *latin1=ucase_getLatin1Mappings(csp, UCASE_LATIN1_FOLD);
 
     /* case mapping loop */
     srcIndex=destIndex=0;
     while(srcIndex<srcLength) {
+        if(latin1!=NULL) {
+            srcIndex=mapLatin1Run(latin1, dest, destIndex, destCapacity, src, srcIndex, srcLength);
+            if(srcIndex==srcLength) {
+                break;
+            }
+        }
         U16_NEXT(src, srcIndex, srcLength, c);
         c=ucase_toFullFolding(csp, c, &s, options);
         if((destIndex<destCapacity) && (c<0 ? (c2=~c)<=0xffff : UCASE_MAX_STRING_LENGTH<c && (c2=c)<=0xffff)) {
@@ -32,6 +32,7 @@
 #include "cstring.h"
 #include "cmemory.h"
 #include "ustr_imp.h"
+#include "usimd.h"
 #include "uassert.h"
 
 U_CAPI UChar* U_EXPORT2 
@@ -561,10 +562,31 @@ u_strFromUTF8WithSub(UChar *dest,
             do {
                 ch = *pSrc;
                 if(ch <= 0x7f){
+                    if(count >= USIMD_MIN_RUN) {
+                        /*
+                         * Copy a run of ASCII at once. Each byte counts as one
+                         * iteration of this loop; the while() accounts for the last one.
+                         */
+                        int32_t n = usimd_asciiToUChars(pDest, pSrc, count);
+                        pDest += n;
+                        pSrc += n;
+                        count -= n - 1;
+                        continue;
+                    }
                     *pDest++=(UChar)ch;
                     ++pSrc;
                 } else {
                     if(ch > 0xe0) {
+                        if(USIMD_NEON && count >= USIMD_MIN_RUN) {
+                            /* convert a run of 3-byte sequences at once */
+                            int32_t n = usimd_utf8ThreeByteToUChars(pDest, pSrc, count);
+                            if(n > 0) {
+                                pDest += n;
+                                pSrc += 3 * n;
+                                count -= n - 1;
+                                continue;
+                            }
+                        }
                         if( /* handle U+1000..U+CFFF inline */
                             ch <= 0xec &&
                             (t1 = (uint8_t)(pSrc[1] - 0x80)) <= 0x3f &&
@@ -576,6 +598,16 @@ u_strFromUTF8WithSub(UChar *dest,
                             continue;
                         }
                     } else if(ch < 0xe0) {
+                        if(USIMD_NEON && count >= USIMD_MIN_RUN) {
+                            /* convert a run of 2-byte sequences at once */
+                            int32_t n = usimd_utf8TwoByteToUChars(pDest, pSrc, count);
+                            if(n > 0) {
+                                pDest += n;
+                                pSrc += 2 * n;
+                                count -= n - 1;
+                                continue;
+                            }
+                        }
                         if( /* handle U+0080..U+07FF inline */
                             ch >= 0xc2 &&
                             (t1 = (uint8_t)(pSrc[1] - 0x80)) <= 0x3f
@@ -1103,6 +1135,31 @@ u_strToUTF8WithSub(char *dest,
             }
             do {
                 ch=*pSrc++;
+                if(count >= USIMD_MIN_RUN) {
+                    /*
+                     * Convert a run of UChars of the same UTF-8 length at once.
+                     * Each UChar counts as one iteration of this loop;
+                     * the while() accounts for the last one.
+                     */
+                    int32_t n;
+                    if(ch <= 0x7f) {
+                        n = usimd_asciiFromUChars(pDest, pSrc - 1, count);
+                        pDest += n;
+                    } else if(!USIMD_NEON) {
+                        n = 0;
+                    } else if(ch <= 0x7ff) {
+                        n = usimd_utf8TwoByteFromUChars(pDest, pSrc - 1, count);
+                        pDest += 2 * n;
+                    } else {
+                        n = usimd_utf8ThreeByteFromUChars(pDest, pSrc - 1, count);
+                        pDest += 3 * n;
+                    }
+                    if(n > 0) {
+                        pSrc += n - 1;
+                        count -= n - 1;
+                        continue;
+                    }
+                }
                 if(ch <= 0x7f) {
                     *pDest++ = (uint8_t)ch;
                 } else if(ch <= 0x7ff) {
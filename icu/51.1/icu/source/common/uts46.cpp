@@ -1,6 +1,6 @@
 /*
 *******************************************************************************
-*   Copyright (C) 2010-2012, International Business Machines
+*   Copyright (C) 2010-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *******************************************************************************
 *   file name:  uts46.cpp
@@ -298,6 +298,38 @@ static const int8_t asciiData[128]={
      0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, -1, -1, -1, -1, -1
 };
 
+// Maps src[mappingStart..] the way uts46Norm2 would if it is all ASCII:
+// Replaces dest with the result if mappingStart==0,
+// otherwise appends the result to dest.
+// Returns FALSE without modifying dest if there is a non-ASCII character.
+static UBool
+mapASCII(const UnicodeString &src, int32_t mappingStart, UnicodeString &dest, UErrorCode &errorCode) {
+    const UChar *srcArray=src.getBuffer();
+    int32_t srcLength=src.length();
+    int32_t i;
+    for(i=mappingStart; i<srcLength; ++i) {
+        if(srcArray[i]>0x7f) {
+            return FALSE;
+        }
+    }
+    int32_t destStart= mappingStart==0 ? 0 : dest.length();
+    int32_t destLength=destStart+(srcLength-mappingStart);
+    UChar *destArray=dest.getBuffer(destLength);
+    if(destArray==NULL) {
+        errorCode=U_MEMORY_ALLOCATION_ERROR;
+        return TRUE;
+    }
+    for(i=mappingStart; i<srcLength; ++i) {
+        UChar c=srcArray[i];
+        if(asciiData[c]>0) {
+            c+=0x20;
+        }
+        destArray[destStart++]=c;
+    }
+    dest.releaseBuffer(destLength);
+    return TRUE;
+}
+
 UnicodeString &
 UTS46::process(const UnicodeString &src,
                UBool isLabel, UBool toASCII,
@@ -537,7 +569,11 @@ UTS46::processUnicode(const UnicodeString &src,
                       UBool isLabel, UBool toASCII,
                       UnicodeString &dest,
                       IDNAInfo &info, UErrorCode &errorCode) const {
-    if(mappingStart==0) {
+    // Most input that gets here is ASCII with a Punycode label,
+    // or longer than the ASCII fastpath buffer; it needs no normalization.
+    if(mapASCII(src, mappingStart, dest, errorCode)) {
+        // done
+    } else if(mappingStart==0) {
         uts46Norm2.normalize(src, dest, errorCode);
     } else {
         uts46Norm2.normalizeSecondAndAppend(dest, src.tempSubString(mappingStart), errorCode);
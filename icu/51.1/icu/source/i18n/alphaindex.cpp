@@ -21,9 +21,14 @@
 #include "unicode/usetiter.h"
 #include "unicode/utf16.h"
 
+#include "charstr.h"
 #include "cmemory.h"
 #include "cstring.h"
+#include "lrucache.h"
+#include "mutex.h"
 #include "uassert.h"
+#include "ucln_in.h"
+#include "umutex.h"
 #include "uvector.h"
 
 //#include <string>
@@ -117,6 +122,27 @@ int32_t binarySearch(const UVector &list, const UnicodeString &s, const Collator
     }
 }
 
+/**
+ * Appends the sort key of s, with its terminating NUL.
+ */
+void appendSortKey(const Collator &coll, const UnicodeString &s, CharString &dest,
+                   UErrorCode &errorCode) {
+    int32_t capacity;
+    char *buffer = dest.getAppendBuffer(32, 64, capacity, errorCode);
+    if (U_FAILURE(errorCode)) { return; }
+    int32_t length = coll.getSortKey(s, (uint8_t *)buffer, capacity);
+    if (length > capacity) {
+        buffer = dest.getAppendBuffer(length, length, capacity, errorCode);
+        if (U_FAILURE(errorCode)) { return; }
+        length = coll.getSortKey(s, (uint8_t *)buffer, capacity);
+    }
+    if (length == 0) {
+        errorCode = U_INTERNAL_PROGRAM_ERROR;
+        return;
+    }
+    dest.append(buffer, length, errorCode);
+}
+
 }  // namespace
 
 // The BucketList is not in the anonymous namespace because only Clang
@@ -125,7 +151,8 @@ int32_t binarySearch(const UVector &list, const UnicodeString &s, const Collator
 class BucketList : public UObject {
 public:
     BucketList(UVector *bucketList, UVector *publicBucketList)
-            : bucketList_(bucketList), immutableVisibleList_(publicBucketList) {
+            : bucketList_(bucketList), immutableVisibleList_(publicBucketList),
+              boundaryKeyStarts_(NULL), refCount_(1) {
         int32_t displayIndex = 0;
         for (int32_t i = 0; i < publicBucketList->size(); ++i) {
             getBucket(*publicBucketList, i)->displayIndex_ = displayIndex++;
@@ -141,32 +168,92 @@ public:
     }
 
     int32_t getBucketIndex(const UnicodeString &name, const Collator &collatorPrimaryOnly,
-                           UErrorCode &errorCode) {
+                           UErrorCode &errorCode) const {
+        return findBucket(name, collatorPrimaryOnly, errorCode)->displayIndex_;
+    }
+
+    /**
+     * Returns the visible bucket for the name.
+     * With the boundary keys, this computes one sort key for the name,
+     * rather than comparing it with the boundaries.
+     */
+    AlphabeticIndex::Bucket *findBucket(const UnicodeString &name,
+                                        const Collator &collatorPrimaryOnly,
+                                        UErrorCode &errorCode) const {
+        CharString nameKey;
+        if (boundaryKeyStarts_ != NULL) {
+            appendSortKey(collatorPrimaryOnly, name, nameKey, errorCode);
+        }
         // binary search
         int32_t start = 0;
         int32_t limit = bucketList_->size();
         while ((start + 1) < limit) {
             int32_t i = (start + limit) / 2;
-            const AlphabeticIndex::Bucket *bucket = getBucket(*bucketList_, i);
-            UCollationResult nameVsBucket =
-                collatorPrimaryOnly.compare(name, bucket->lowerBoundary_, errorCode);
+            int32_t nameVsBucket;
+            if (boundaryKeyStarts_ != NULL) {
+                nameVsBucket = uprv_strcmp(nameKey.data(), getBoundaryKey(i));
+            } else {
+                nameVsBucket = collatorPrimaryOnly.compare(
+                    name, getBucket(*bucketList_, i)->lowerBoundary_, errorCode);
+            }
             if (nameVsBucket < 0) {
                 limit = i;
             } else {
                 start = i;
             }
         }
-        const AlphabeticIndex::Bucket *bucket = getBucket(*bucketList_, start);
+        AlphabeticIndex::Bucket *bucket = getBucket(*bucketList_, start);
         if (bucket->displayBucket_ != NULL) {
             bucket = bucket->displayBucket_;
         }
-        return bucket->displayIndex_;
+        return bucket;
+    }
+
+    /**
+     * Computes the primary sort keys of the bucket boundaries, for findBucket().
+     * Without them, findBucket() compares strings.
+     */
+    void initBoundaryKeys(const Collator &collatorPrimaryOnly, UErrorCode &errorCode);
+
+    /** The sort key of the i-th bucket's lower boundary. */
+    const char *getBoundaryKey(int32_t i) const {
+        return boundaryKeys_.data() + boundaryKeyStarts_[i];
+    }
+
+    /**
+     * Returns a copy with the same labels and boundaries, and no records.
+     */
+    BucketList *cloneWithoutRecords(UErrorCode &errorCode) const;
+
+    /**
+     * A BucketList without records may be shared, by ImmutableIndex objects
+     * and by the label cache. It is deleted when the last reference is removed.
+     */
+    void addRef() {
+        umtx_atomic_inc(&refCount_);
+    }
+
+    void removeRef() {
+        if (umtx_atomic_dec(&refCount_) == 0) {
+            delete this;
+        }
+    }
+
+    UBool isShared() const {
+        return refCount_ > 1;
     }
 
     /** All of the buckets, visible and invisible. */
     UVector *bucketList_;
     /** Just the visible buckets. */
     UVector *immutableVisibleList_;
+
+private:
+    /** The NUL-terminated sort keys of the lower boundaries, one after another. */
+    CharString boundaryKeys_;
+    /** The start of each bucket's key in boundaryKeys_, or NULL. */
+    int32_t *boundaryKeyStarts_;
+    int32_t refCount_;
 };
 
 BucketList::~BucketList() {
@@ -174,10 +261,138 @@ BucketList::~BucketList() {
     if (immutableVisibleList_ != bucketList_) {
         delete immutableVisibleList_;
     }
+    uprv_free(boundaryKeyStarts_);
+}
+
+void BucketList::initBoundaryKeys(const Collator &collatorPrimaryOnly, UErrorCode &errorCode) {
+    if (U_FAILURE(errorCode) || boundaryKeyStarts_ != NULL) {
+        return;
+    }
+    int32_t *starts = (int32_t *)uprv_malloc(bucketList_->size() * sizeof(int32_t));
+    if (starts == NULL) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    boundaryKeys_.clear();
+    for (int32_t i = 0; i < bucketList_->size() && U_SUCCESS(errorCode); ++i) {
+        starts[i] = boundaryKeys_.length();
+        appendSortKey(collatorPrimaryOnly, getBucket(*bucketList_, i)->lowerBoundary_,
+                      boundaryKeys_, errorCode);
+    }
+    if (U_FAILURE(errorCode)) {
+        uprv_free(starts);
+        return;
+    }
+    boundaryKeyStarts_ = starts;
+}
+
+BucketList *BucketList::cloneWithoutRecords(UErrorCode &errorCode) const {
+    if (U_FAILURE(errorCode)) { return NULL; }
+    int32_t size = bucketList_->size();
+    LocalPointer<UVector> bucketList(new UVector(size, errorCode));
+    if (bucketList.isNull()) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    bucketList->setDeleter(uprv_deleteUObject);
+    for (int32_t i = 0; i < size && U_SUCCESS(errorCode); ++i) {
+        const AlphabeticIndex::Bucket *bucket = getBucket(*bucketList_, i);
+        AlphabeticIndex::Bucket *copy = new AlphabeticIndex::Bucket(
+            bucket->label_, bucket->lowerBoundary_, bucket->labelType_);
+        if (copy == NULL) {
+            errorCode = U_MEMORY_ALLOCATION_ERROR;
+            return NULL;
+        }
+        bucketList->addElement(copy, errorCode);
+    }
+    if (U_FAILURE(errorCode)) { return NULL; }
+    for (int32_t i = 0; i < size; ++i) {
+        const AlphabeticIndex::Bucket *bucket = getBucket(*bucketList_, i);
+        if (bucket->displayBucket_ != NULL) {
+            getBucket(*bucketList, i)->displayBucket_ =
+                getBucket(*bucketList, bucketList_->indexOf(bucket->displayBucket_));
+        }
+    }
+    LocalPointer<UVector> publicBucketList;
+    if (immutableVisibleList_ != bucketList_) {
+        publicBucketList.adoptInstead(new UVector(immutableVisibleList_->size(), errorCode));
+        if (publicBucketList.isNull()) {
+            errorCode = U_MEMORY_ALLOCATION_ERROR;
+            return NULL;
+        }
+        // Do not call publicBucketList->setDeleter():
+        // This vector shares its objects with the bucketList.
+        for (int32_t i = 0; i < size; ++i) {
+            AlphabeticIndex::Bucket *bucket = getBucket(*bucketList, i);
+            if (bucket->displayBucket_ == NULL) {
+                publicBucketList->addElement(bucket, errorCode);
+            }
+        }
+        if (U_FAILURE(errorCode)) { return NULL; }
+    }
+    BucketList *bl = new BucketList(bucketList.getAlias(),
+        publicBucketList.isValid() ? publicBucketList.getAlias() : bucketList.getAlias());
+    if (bl == NULL) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    bucketList.orphan();
+    publicBucketList.orphan();
+    if (boundaryKeyStarts_ != NULL) {
+        bl->boundaryKeyStarts_ = (int32_t *)uprv_malloc(size * sizeof(int32_t));
+        if (bl->boundaryKeyStarts_ == NULL) {
+            errorCode = U_MEMORY_ALLOCATION_ERROR;
+            delete bl;
+            return NULL;
+        }
+        uprv_memcpy(bl->boundaryKeyStarts_, boundaryKeyStarts_, size * sizeof(int32_t));
+        bl->boundaryKeys_.copyFrom(boundaryKeys_, errorCode);
+        if (U_FAILURE(errorCode)) {
+            delete bl;
+            return NULL;
+        }
+    }
+    return bl;
+}
+
+// The bucket lists without records of the most recently used locales and
+// label settings, shared with the ImmutableIndex objects built from them.
+#define BUCKET_LIST_CACHE_CAPACITY 8
+
+static LRUCache *gBucketListCache = NULL;
+static UMutex gBucketListCacheLock = U_MUTEX_INITIALIZER;
+static UInitOnce gBucketListCacheInitOnce = U_INITONCE_INITIALIZER;
+
+U_CDECL_BEGIN
+static void U_CALLCONV
+alphaIndex_removeBucketListRef(void *obj) {
+    static_cast<BucketList *>(obj)->removeRef();
+}
+
+static UBool U_CALLCONV alphaIndex_cleanup(void) {
+    delete gBucketListCache;
+    gBucketListCache = NULL;
+    gBucketListCacheInitOnce.reset();
+    return TRUE;
+}
+U_CDECL_END
+
+static void initBucketListCache(UErrorCode &status) {
+    ucln_i18n_registerCleanup(UCLN_I18N_ALPHAINDEX, alphaIndex_cleanup);
+    U_ASSERT(gBucketListCache == NULL);
+    gBucketListCache = new LRUCache(BUCKET_LIST_CACHE_CAPACITY, alphaIndex_removeBucketListRef, status);
+    if (gBucketListCache == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+    } else if (U_FAILURE(status)) {
+        delete gBucketListCache;
+        gBucketListCache = NULL;
+    }
 }
 
 AlphabeticIndex::ImmutableIndex::~ImmutableIndex() {
-    delete buckets_;
+    if (buckets_ != NULL) {
+        buckets_->removeRef();
+    }
     delete collatorPrimaryOnly_;
 }
 
@@ -253,25 +468,24 @@ AlphabeticIndex &AlphabeticIndex::addLabels(const Locale &locale, UErrorCode &st
 
 AlphabeticIndex::ImmutableIndex *AlphabeticIndex::buildImmutableIndex(UErrorCode &errorCode) {
     if (U_FAILURE(errorCode)) { return NULL; }
-    // In C++, the ImmutableIndex must own its copy of the BucketList,
-    // even if it contains no records, for proper memory management.
-    // We could clone the buckets_ if they are not NULL,
-    // but that would be worth it only if this method is called multiple times,
-    // or called after using the old-style bucket iterator API.
-    LocalPointer<BucketList> immutableBucketList(createBucketList(errorCode));
+    // The ImmutableIndex holds a reference to a BucketList without records,
+    // which it may share with other ImmutableIndex objects for the same locale.
+    BucketList *immutableBucketList = getLabelBuckets(errorCode);
+    if (U_FAILURE(errorCode)) { return NULL; }
     LocalPointer<RuleBasedCollator> coll(
         static_cast<RuleBasedCollator *>(collatorPrimaryOnly_->clone()));
-    if (immutableBucketList.isNull() || coll.isNull()) {
+    if (coll.isNull()) {
+        immutableBucketList->removeRef();
         errorCode = U_MEMORY_ALLOCATION_ERROR;
         return NULL;
     }
-    ImmutableIndex *immIndex = new ImmutableIndex(immutableBucketList.getAlias(), coll.getAlias());
+    ImmutableIndex *immIndex = new ImmutableIndex(immutableBucketList, coll.getAlias());
     if (immIndex == NULL) {
+        immutableBucketList->removeRef();
         errorCode = U_MEMORY_ALLOCATION_ERROR;
         return NULL;
     }
     // The ImmutableIndex adopted its parameter objects.
-    immutableBucketList.orphan();
     coll.orphan();
     return immIndex;
 }
@@ -631,6 +845,54 @@ BucketList *AlphabeticIndex::createBucketList(UErrorCode &errorCode) const {
     return bl;
 }
 
+/**
+ * Returns the buckets without records, with their boundary keys,
+ * and with a reference for the caller.
+ * The buckets for the collator and labels of a locale are cached, so that
+ * indexes for the same locale and label settings compute them once.
+ */
+BucketList *AlphabeticIndex::getLabelBuckets(UErrorCode &errorCode) const {
+    if (U_FAILURE(errorCode)) { return NULL; }
+    // The cache key is the locale ID, then everything that changes the labels.
+    UnicodeString key;
+    UErrorCode cacheStatus = U_ZERO_ERROR;
+    if (!localeName_.isBogus()) {
+        umtx_initOnce(gBucketListCacheInitOnce, &initBucketListCache, cacheStatus);
+        UnicodeString pattern;
+        key.append(localeName_).append((UChar)0);
+        key.append((UChar)maxLabelCount_).append((UChar)(maxLabelCount_ >> 16));
+        key.append(inflowLabel_).append((UChar)0);
+        key.append(overflowLabel_).append((UChar)0);
+        key.append(underflowLabel_).append((UChar)0);
+        key.append(initialLabels_->toPattern(pattern, TRUE));
+        if (U_SUCCESS(cacheStatus)) {
+            Mutex lock(&gBucketListCacheLock);
+            BucketList *cached = static_cast<BucketList *>(gBucketListCache->get(key));
+            if (cached != NULL) {
+                cached->addRef();
+                return cached;
+            }
+        }
+    }
+
+    BucketList *bl = createBucketList(errorCode);
+    if (bl != NULL) {
+        bl->initBoundaryKeys(*collatorPrimaryOnly_, errorCode);
+    } else if (U_SUCCESS(errorCode)) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+    }
+    if (U_FAILURE(errorCode)) {
+        delete bl;
+        return NULL;
+    }
+    if (!localeName_.isBogus() && U_SUCCESS(cacheStatus)) {
+        bl->addRef();
+        Mutex lock(&gBucketListCacheLock);
+        gBucketListCache->put(key, bl, cacheStatus);
+    }
+    return bl;
+}
+
 /**
  * Creates an index, and buckets and sorts the list of records into the index.
  */
@@ -638,7 +900,18 @@ void AlphabeticIndex::initBuckets(UErrorCode &errorCode) {
     if (U_FAILURE(errorCode) || buckets_ != NULL) {
         return;
     }
-    buckets_ = createBucketList(errorCode);
+    BucketList *labelBuckets = getLabelBuckets(errorCode);
+    if (U_FAILURE(errorCode)) {
+        return;
+    }
+    // This index adds records to its buckets, so it needs its own copy
+    // of shared ones.
+    if (labelBuckets->isShared()) {
+        buckets_ = labelBuckets->cloneWithoutRecords(errorCode);
+        labelBuckets->removeRef();
+    } else {
+        buckets_ = labelBuckets;
+    }
     if (U_FAILURE(errorCode) || inputList_ == NULL || inputList_->isEmpty()) {
         return;
     }
@@ -650,34 +923,23 @@ void AlphabeticIndex::initBuckets(UErrorCode &errorCode) {
     // Now, we traverse all of the input, which is now sorted.
     // If the item doesn't go in the current bucket, we find the next bucket that contains it.
     // This makes the process order n*log(n), since we just sort the list and then do a linear process.
-    // However, if the user adds an item at a time and then gets the buckets, this isn't efficient, so
-    // we need to improve it for that case.
+    // Records added after this go directly into their buckets, see addRecord().
 
+    // The records are compared with the boundaries by their primary sort keys,
+    // computing one key per record.
     Bucket *currentBucket = getBucket(*buckets_->bucketList_, 0);
     int32_t bucketIndex = 1;
-    Bucket *nextBucket;
-    const UnicodeString *upperBoundary;
-    if (bucketIndex < buckets_->bucketList_->size()) {
-        nextBucket = getBucket(*buckets_->bucketList_, bucketIndex++);
-        upperBoundary = &nextBucket->lowerBoundary_;
-    } else {
-        nextBucket = NULL;
-        upperBoundary = NULL;
-    }
+    int32_t bucketCount = buckets_->bucketList_->size();
+    CharString nameKey;
     for (int32_t i = 0; i < inputList_->size(); ++i) {
         Record *r = getRecord(*inputList_, i);
+        nameKey.clear();
+        appendSortKey(*collatorPrimaryOnly_, r->name_, nameKey, errorCode);
+        if (U_FAILURE(errorCode)) { return; }
         // if the current bucket isn't the right one, find the one that is
-        // We have a special flag for the last bucket so that we don't look any further
-        while (upperBoundary != NULL &&
-                collatorPrimaryOnly_->compare(r->name_, *upperBoundary, errorCode) >= 0) {
-            currentBucket = nextBucket;
-            // now reset the boundary that we compare against
-            if (bucketIndex < buckets_->bucketList_->size()) {
-                nextBucket = getBucket(*buckets_->bucketList_, bucketIndex++);
-                upperBoundary = &nextBucket->lowerBoundary_;
-            } else {
-                upperBoundary = NULL;
-            }
+        while (bucketIndex < bucketCount &&
+                uprv_strcmp(nameKey.data(), buckets_->getBoundaryKey(bucketIndex)) >= 0) {
+            currentBucket = getBucket(*buckets_->bucketList_, bucketIndex++);
         }
         // now put the record into the bucket.
         Bucket *bucket = currentBucket;
@@ -936,6 +1198,12 @@ void AlphabeticIndex::init(const Locale *locale, UErrorCode &status) {
         return;
     }
 
+    if (locale != NULL) {
+        localeName_ = UnicodeString(locale->getName(), -1, US_INV);
+    } else {
+        localeName_.setToBogus();
+    }
+
     initialLabels_         = new UnicodeSet();
     if (initialLabels_ == NULL) {
         status = U_MEMORY_ALLOCATION_ERROR;
@@ -1187,7 +1455,39 @@ AlphabeticIndex & AlphabeticIndex::addRecord(const UnicodeString &name, const vo
         return *this;
     }
     inputList_->addElement(r, status);
-    clearBuckets();
+    if (U_FAILURE(status)) {
+        return *this;
+    }
+    if (buckets_ != NULL) {
+        // Add just this record to the buckets, after the records that collate
+        // equal to it, as the stable sort in initBuckets() would.
+        Bucket *bucket = buckets_->findBucket(name, *collatorPrimaryOnly_, status);
+        if (bucket->records_ == NULL) {
+            bucket->records_ = new UVector(status);
+            if (bucket->records_ == NULL) {
+                status = U_MEMORY_ALLOCATION_ERROR;
+            }
+        }
+        if (U_SUCCESS(status)) {
+            int32_t start = 0;
+            int32_t limit = bucket->records_->size();
+            while (start < limit) {
+                int32_t i = (start + limit) / 2;
+                if (collator_->compare(name, getRecord(*bucket->records_, i)->name_, status) < 0) {
+                    limit = i;
+                } else {
+                    start = i + 1;
+                }
+            }
+            bucket->records_->insertElementAt(r, start, status);
+        }
+        if (U_FAILURE(status)) {
+            clearBuckets();
+            return *this;
+        }
+        // As when the buckets are rebuilt, the iteration starts over.
+        internalResetBucketIterator();
+    }
     //std::string ss;
     //std::string ss2;
     //std::cout << "added record: name = \"" << r->name_.toUTF8String(ss) << "\"" << 
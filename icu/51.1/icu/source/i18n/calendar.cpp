@@ -57,11 +57,58 @@
 #include "ustrenum.h"
 #include "uassert.h"
 #include "olsontz.h"
+#include "umutex.h"
 
 #if !UCONFIG_NO_SERVICE
 static icu::ICULocaleService* gService = NULL;
 #endif
 
+/*
+ * Day cache
+ *
+ * Converting a time to fields takes a zone offset lookup and the Julian day
+ * arithmetic of the date fields, although timestamps mostly fall within a
+ * few local days: an EPG grid formats a week of event times. The cache keeps
+ * the date fields of the last few local days computed by GregorianCalendar,
+ * with the UTC range over which the day and the zone offsets are the same;
+ * the fields of any time in the range then only need the time of day.
+ *
+ * The cache is shared, because DateFormat formats a clone of its calendar
+ * for each date. It is keyed by zone (operator==, i.e. ID and rules), local
+ * day, Gregorian change date and week settings, and only filled for
+ * BasicTimeZones, whose transitions bound the ranges. Finding them and
+ * cloning the zone costs several full computations, so a day is only
+ * cached when it is computed a second time in a row; random dates do not
+ * fill the cache with days that are never hit.
+ */
+#define DAY_CACHE_SIZE 8
+
+typedef struct DayCacheEntry {
+    icu::TimeZone *zone;        // owned; NULL when unused
+    UDate start;                // UTC range of the day with these offsets
+    UDate limit;
+    int32_t rawOffset;
+    int32_t dstOffset;
+    int32_t days;               // local day, from the epoch
+    UBool unambiguous;          // no zone transition within a day of the range
+    UDate gregorianChange;
+    int32_t firstDayOfWeek;
+    int32_t minimalDaysInFirstWeek;
+    int32_t fields[UCAL_FIELD_COUNT];
+    int32_t stamp[UCAL_FIELD_COUNT];
+    UBool isSet[UCAL_FIELD_COUNT];
+    int32_t gregorianYear;
+    int32_t gregorianMonth;
+    int32_t gregorianDayOfYear;
+    int32_t gregorianDayOfMonth;
+} DayCacheEntry;
+
+static DayCacheEntry gDayCache[DAY_CACHE_SIZE];
+static int32_t gDayCacheNext = 0;
+static int32_t gDayCacheLastDays = 0;     // the last day computed and not cached
+static int32_t gDayCacheLastOffset = 0;
+static UMutex gDayCacheLock = U_MUTEX_INITIALIZER;
+
 // INTERNAL - for cleanup
 
 U_CDECL_BEGIN
@@ -72,6 +119,11 @@ static UBool calendar_cleanup(void) {
         gService = NULL;
     }
 #endif
+    for (int32_t i = 0; i < DAY_CACHE_SIZE; ++i) {
+        delete gDayCache[i].zone;
+        gDayCache[i].zone = NULL;
+    }
+    gDayCacheNext = 0;
     return TRUE;
 }
 U_CDECL_END
@@ -1285,59 +1337,67 @@ void Calendar::computeFields(UErrorCode &ec)
     }
     // Compute local wall millis
     double localMillis = internalGetTime();
-    int32_t rawOffset, dstOffset;
-    getTimeZone().getOffset(localMillis, FALSE, rawOffset, dstOffset, ec);
-    localMillis += (rawOffset + dstOffset); 
-
-    // Mark fields as set.  Do this before calling handleComputeFields().
-    uint32_t mask =   //fInternalSetMask;
-        (1 << UCAL_ERA) |
-        (1 << UCAL_YEAR) |
-        (1 << UCAL_MONTH) |
-        (1 << UCAL_DAY_OF_MONTH) | // = UCAL_DATE
-        (1 << UCAL_DAY_OF_YEAR) |
-        (1 << UCAL_EXTENDED_YEAR);  
-
-    for (int32_t i=0; i<UCAL_FIELD_COUNT; ++i) {
-        if ((mask & 1) == 0) {
-            fStamp[i] = kInternallySet;
-            fIsSet[i] = TRUE; // Remove later
-        } else {
-            fStamp[i] = kUnset;
-            fIsSet[i] = FALSE; // Remove later
+    int32_t rawOffset, dstOffset, days;
+    if (getCachedDayFields(localMillis, rawOffset, dstOffset, days)) {
+        localMillis += (rawOffset + dstOffset);
+    } else {
+        getTimeZone().getOffset(localMillis, FALSE, rawOffset, dstOffset, ec);
+        localMillis += (rawOffset + dstOffset); 
+
+        // Mark fields as set.  Do this before calling handleComputeFields().
+        uint32_t mask =   //fInternalSetMask;
+            (1 << UCAL_ERA) |
+            (1 << UCAL_YEAR) |
+            (1 << UCAL_MONTH) |
+            (1 << UCAL_DAY_OF_MONTH) | // = UCAL_DATE
+            (1 << UCAL_DAY_OF_YEAR) |
+            (1 << UCAL_EXTENDED_YEAR);  
+
+        for (int32_t i=0; i<UCAL_FIELD_COUNT; ++i) {
+            if ((mask & 1) == 0) {
+                fStamp[i] = kInternallySet;
+                fIsSet[i] = TRUE; // Remove later
+            } else {
+                fStamp[i] = kUnset;
+                fIsSet[i] = FALSE; // Remove later
+            }
+            mask >>= 1;
         }
-        mask >>= 1;
-    }
 
-    // We used to check for and correct extreme millis values (near
-    // Long.MIN_VALUE or Long.MAX_VALUE) here.  Such values would cause
-    // overflows from positive to negative (or vice versa) and had to
-    // be manually tweaked.  We no longer need to do this because we
-    // have limited the range of supported dates to those that have a
-    // Julian day that fits into an int.  This allows us to implement a
-    // JULIAN_DAY field and also removes some inelegant code. - Liu
-    // 11/6/00
+        // We used to check for and correct extreme millis values (near
+        // Long.MIN_VALUE or Long.MAX_VALUE) here.  Such values would cause
+        // overflows from positive to negative (or vice versa) and had to
+        // be manually tweaked.  We no longer need to do this because we
+        // have limited the range of supported dates to those that have a
+        // Julian day that fits into an int.  This allows us to implement a
+        // JULIAN_DAY field and also removes some inelegant code. - Liu
+        // 11/6/00
 
-    int32_t days =  (int32_t)ClockMath::floorDivide(localMillis, (double)kOneDay);
+        days =  (int32_t)ClockMath::floorDivide(localMillis, (double)kOneDay);
 
-    internalSet(UCAL_JULIAN_DAY,days + kEpochStartAsJulianDay);
+        internalSet(UCAL_JULIAN_DAY,days + kEpochStartAsJulianDay);
 
 #if defined (U_DEBUG_CAL)
-    //fprintf(stderr, "%s:%d- Hmm! Jules @ %d, as per %.0lf millis\n",
-    //__FILE__, __LINE__, fFields[UCAL_JULIAN_DAY], localMillis);
+        //fprintf(stderr, "%s:%d- Hmm! Jules @ %d, as per %.0lf millis\n",
+        //__FILE__, __LINE__, fFields[UCAL_JULIAN_DAY], localMillis);
 #endif  
 
-    computeGregorianAndDOWFields(fFields[UCAL_JULIAN_DAY], ec);
+        computeGregorianAndDOWFields(fFields[UCAL_JULIAN_DAY], ec);
 
-    // Call framework method to have subclass compute its fields.
-    // These must include, at a minimum, MONTH, DAY_OF_MONTH,
-    // EXTENDED_YEAR, YEAR, DAY_OF_YEAR.  This method will call internalSet(),
-    // which will update stamp[].
-    handleComputeFields(fFields[UCAL_JULIAN_DAY], ec);
+        // Call framework method to have subclass compute its fields.
+        // These must include, at a minimum, MONTH, DAY_OF_MONTH,
+        // EXTENDED_YEAR, YEAR, DAY_OF_YEAR.  This method will call internalSet(),
+        // which will update stamp[].
+        handleComputeFields(fFields[UCAL_JULIAN_DAY], ec);
 
-    // Compute week-related fields, based on the subclass-computed
-    // fields computed by handleComputeFields().
-    computeWeekFields(ec);
+        // Compute week-related fields, based on the subclass-computed
+        // fields computed by handleComputeFields().
+        computeWeekFields(ec);
+
+        if (U_SUCCESS(ec)) {
+            cacheDayFields(internalGetTime(), rawOffset, dstOffset, days);
+        }
+    }
 
     // Compute time-related fields.  These are indepent of the date and
     // of the subclass algorithm.  They depend only on the local zone
@@ -1357,6 +1417,132 @@ void Calendar::computeFields(UErrorCode &ec)
     fFields[UCAL_DST_OFFSET] = dstOffset;
 }
 
+UBool Calendar::getCachedDayFields(double utc, int32_t& rawOffset, int32_t& dstOffset, int32_t& days)
+{
+    // Subclasses other than GregorianCalendar may keep state of their own
+    // from handleComputeFields()
+    if (getDynamicClassID() != GregorianCalendar::getStaticClassID()) {
+        return FALSE;
+    }
+    UDate gregorianChange = ((const GregorianCalendar *)this)->getGregorianChange();
+    UBool found = FALSE;
+
+    umtx_lock(&gDayCacheLock);
+    for (int32_t i = 0; i < DAY_CACHE_SIZE; ++i) {
+        const DayCacheEntry &e = gDayCache[i];
+        if (e.zone != NULL && utc >= e.start && utc < e.limit &&
+            e.gregorianChange == gregorianChange &&
+            e.firstDayOfWeek == fFirstDayOfWeek &&
+            e.minimalDaysInFirstWeek == fMinimalDaysInFirstWeek &&
+            *e.zone == *fZone) {
+            uprv_arrayCopy(e.fields, fFields, UCAL_FIELD_COUNT);
+            uprv_arrayCopy(e.stamp, fStamp, UCAL_FIELD_COUNT);
+            uprv_arrayCopy(e.isSet, fIsSet, UCAL_FIELD_COUNT);
+            fGregorianYear = e.gregorianYear;
+            fGregorianMonth = e.gregorianMonth;
+            fGregorianDayOfYear = e.gregorianDayOfYear;
+            fGregorianDayOfMonth = e.gregorianDayOfMonth;
+            rawOffset = e.rawOffset;
+            dstOffset = e.dstOffset;
+            days = e.days;
+            found = TRUE;
+            break;
+        }
+    }
+    umtx_unlock(&gDayCacheLock);
+    return found;
+}
+
+void Calendar::cacheDayFields(double utc, int32_t rawOffset, int32_t dstOffset, int32_t days)
+{
+    if (getDynamicClassID() != GregorianCalendar::getStaticClassID()) {
+        return;
+    }
+    UBool again;
+    umtx_lock(&gDayCacheLock);
+    again = gDayCacheLastDays == days && gDayCacheLastOffset == rawOffset + dstOffset;
+    gDayCacheLastDays = days;
+    gDayCacheLastOffset = rawOffset + dstOffset;
+    umtx_unlock(&gDayCacheLock);
+    if (!again) {
+        return;
+    }
+    BasicTimeZone *btz = getBasicTimeZone();
+    if (btz == NULL) {
+        return;
+    }
+
+    // The local day, cut at the zone transitions around utc
+    UDate start = days * kOneDay - (rawOffset + dstOffset);
+    UDate limit = start + kOneDay;
+    UBool unambiguous = TRUE;
+    TimeZoneTransition transition;
+    if (btz->getPreviousTransition(utc, TRUE, transition)) {
+        UDate t = transition.getTime();
+        if (t > start) {
+            start = t;
+        }
+        // An offset change of up to a day before the range can repeat its
+        // first wall times
+        unambiguous = t <= start - kOneDay;
+    }
+    if (btz->getNextTransition(utc, FALSE, transition)) {
+        UDate t = transition.getTime();
+        if (t < limit) {
+            limit = t;
+        }
+        unambiguous = unambiguous && t >= limit + kOneDay;
+    }
+    TimeZone *zone = fZone->clone();
+    if (zone == NULL) {
+        return;
+    }
+
+    umtx_lock(&gDayCacheLock);
+    DayCacheEntry &e = gDayCache[gDayCacheNext];
+    gDayCacheNext = (gDayCacheNext + 1) % DAY_CACHE_SIZE;
+    delete e.zone;
+    e.zone = zone;
+    e.start = start;
+    e.limit = limit;
+    e.rawOffset = rawOffset;
+    e.dstOffset = dstOffset;
+    e.days = days;
+    e.unambiguous = unambiguous;
+    e.gregorianChange = ((const GregorianCalendar *)this)->getGregorianChange();
+    e.firstDayOfWeek = fFirstDayOfWeek;
+    e.minimalDaysInFirstWeek = fMinimalDaysInFirstWeek;
+    uprv_arrayCopy(fFields, e.fields, UCAL_FIELD_COUNT);
+    uprv_arrayCopy(fStamp, e.stamp, UCAL_FIELD_COUNT);
+    uprv_arrayCopy(fIsSet, e.isSet, UCAL_FIELD_COUNT);
+    e.gregorianYear = fGregorianYear;
+    e.gregorianMonth = fGregorianMonth;
+    e.gregorianDayOfYear = fGregorianDayOfYear;
+    e.gregorianDayOfMonth = fGregorianDayOfMonth;
+    ucln_i18n_registerCleanup(UCLN_I18N_CALENDAR, calendar_cleanup);
+    umtx_unlock(&gDayCacheLock);
+}
+
+UBool Calendar::getCachedZoneOffset(double wall, int32_t& zoneOffset) const
+{
+    UBool found = FALSE;
+
+    umtx_lock(&gDayCacheLock);
+    for (int32_t i = 0; i < DAY_CACHE_SIZE; ++i) {
+        const DayCacheEntry &e = gDayCache[i];
+        if (e.zone != NULL && e.unambiguous) {
+            int32_t offset = e.rawOffset + e.dstOffset;
+            if (wall >= e.start + offset && wall < e.limit + offset && *e.zone == *fZone) {
+                zoneOffset = offset;
+                found = TRUE;
+                break;
+            }
+        }
+    }
+    umtx_unlock(&gDayCacheLock);
+    return found;
+}
+
 uint8_t Calendar::julianDayToDayOfWeek(double julian)
 {
     // If julian is negative, then julian%7 will be negative, so we adjust
@@ -2834,7 +3020,11 @@ void Calendar::computeTime(UErrorCode& status) {
                 }
             }
         } else {
-            t = millis + millisInDay - computeZoneOffset(millis, millisInDay, status);
+            int32_t zoneOffset;
+            if (!getCachedZoneOffset(millis + millisInDay, zoneOffset)) {
+                zoneOffset = computeZoneOffset(millis, millisInDay, status);
+            }
+            t = millis + millisInDay - zoneOffset;
         }
     }
     if (U_SUCCESS(status)) {
@@ -54,7 +54,7 @@ static icu::CalendarAstronomer *gChineseCalendarAstro = NULL;
 static icu::CalendarCache *gChineseCalendarWinterSolsticeCache = NULL;
 static icu::CalendarCache *gChineseCalendarNewYearCache = NULL;
 static icu::TimeZone *gChineseCalendarZoneAstroCalc = NULL;
-static UBool gChineseCalendarZoneAstroCalcInitialized = FALSE;
+static icu::UInitOnce gChineseCalendarZoneAstroCalcInitOnce = U_INITONCE_INITIALIZER;
 
 /**
  * The start year of the Chinese calendar, the 61st year of the reign
@@ -97,7 +97,7 @@ static UBool calendar_chinese_cleanup(void) {
         delete gChineseCalendarZoneAstroCalc;
         gChineseCalendarZoneAstroCalc = NULL;
     }
-    gChineseCalendarZoneAstroCalcInitialized = FALSE;
+    gChineseCalendarZoneAstroCalcInitOnce.reset();
     return TRUE;
 }
 U_CDECL_END
@@ -150,20 +150,13 @@ const char *ChineseCalendar::getType() const {
     return "chinese";
 }
 
+static void initChineseCalZoneAstroCalc() {
+    gChineseCalendarZoneAstroCalc = new SimpleTimeZone(CHINA_OFFSET, UNICODE_STRING_SIMPLE("CHINA_ZONE") );
+    ucln_i18n_registerCleanup(UCLN_I18N_CHINESE_CALENDAR, calendar_chinese_cleanup);
+}
+
 const TimeZone* ChineseCalendar::getChineseCalZoneAstroCalc(void) const {
-    UBool initialized;
-    UMTX_CHECK(&astroLock, gChineseCalendarZoneAstroCalcInitialized, initialized);
-    if (!initialized) {
-        umtx_lock(&astroLock);
-        {
-            if (!gChineseCalendarZoneAstroCalcInitialized) {
-                gChineseCalendarZoneAstroCalc = new SimpleTimeZone(CHINA_OFFSET, UNICODE_STRING_SIMPLE("CHINA_ZONE") );
-                gChineseCalendarZoneAstroCalcInitialized = TRUE;
-                ucln_i18n_registerCleanup(UCLN_I18N_CHINESE_CALENDAR, calendar_chinese_cleanup);
-            }
-        }
-        umtx_unlock(&astroLock);
-    }
+    umtx_initOnce(gChineseCalendarZoneAstroCalcInitOnce, &initChineseCalZoneAstroCalc);
     return gChineseCalendarZoneAstroCalc;
 }
 
@@ -848,6 +841,7 @@ const int32_t   ChineseCalendar::fgSystemDefaultCenturyYear    = -1;
 UDate           ChineseCalendar::fgSystemDefaultCenturyStart       = DBL_MIN;
 int32_t         ChineseCalendar::fgSystemDefaultCenturyStartYear   = -1;
 
+static icu::UInitOnce gSystemDefaultCenturyInitOnce = U_INITONCE_INITIALIZER;
 
 UBool ChineseCalendar::haveDefaultCentury() const
 {
@@ -868,12 +862,7 @@ UDate
 ChineseCalendar::internalGetDefaultCenturyStart() const
 {
     // lazy-evaluate systemDefaultCenturyStart
-    UBool needsUpdate;
-    UMTX_CHECK(NULL, (fgSystemDefaultCenturyStart == fgSystemDefaultCentury), needsUpdate);
-
-    if (needsUpdate) {
-        initializeSystemDefaultCentury();
-    }
+    umtx_initOnce(gSystemDefaultCenturyInitOnce, &initializeSystemDefaultCentury);
 
     // use defaultCenturyStart unless it's the flag value;
     // then use systemDefaultCenturyStart
@@ -885,12 +874,7 @@ int32_t
 ChineseCalendar::internalGetDefaultCenturyStartYear() const
 {
     // lazy-evaluate systemDefaultCenturyStartYear
-    UBool needsUpdate;
-    UMTX_CHECK(NULL, (fgSystemDefaultCenturyStart == fgSystemDefaultCentury), needsUpdate);
-
-    if (needsUpdate) {
-        initializeSystemDefaultCentury();
-    }
+    umtx_initOnce(gSystemDefaultCenturyInitOnce, &initializeSystemDefaultCentury);
 
     // use defaultCenturyStart unless it's the flag value;
     // then use systemDefaultCenturyStartYear
@@ -912,13 +896,8 @@ ChineseCalendar::initializeSystemDefaultCentury()
         calendar.add(UCAL_YEAR, -80, status);
         UDate    newStart =  calendar.getTime(status);
         int32_t  newYear  =  calendar.get(UCAL_YEAR, status);
-        umtx_lock(NULL);
-        if (fgSystemDefaultCenturyStart == fgSystemDefaultCentury)
-        {
-            fgSystemDefaultCenturyStartYear = newYear;
-            fgSystemDefaultCenturyStart = newStart;
-        }
-        umtx_unlock(NULL);
+        fgSystemDefaultCenturyStartYear = newYear;
+        fgSystemDefaultCenturyStart = newStart;
     }
     // We have no recourse upon failure unless we want to propagate the failure
     // out.
@@ -1,6 +1,6 @@
 /*
 *******************************************************************************
-* Copyright (C) 1997-2012, International Business Machines Corporation and    *
+* Copyright (C) 1997-2013, International Business Machines Corporation and    *
 * others. All Rights Reserved.                                                *
 *******************************************************************************
 *
@@ -31,6 +31,7 @@
 // Maps locale name to CDFLocaleData struct.
 static UHashtable* gCompactDecimalData = NULL;
 static UMutex gCompactDecimalMetaLock = U_MUTEX_INITIALIZER;
+static icu::UInitOnce gCompactDecimalInitOnce = U_INITONCE_INITIALIZER;
 
 U_NAMESPACE_BEGIN
 
@@ -128,6 +129,7 @@ static UBool U_CALLCONV cdf_cleanup(void) {
     uhash_close(gCompactDecimalData);
     gCompactDecimalData = NULL;
   }
+  gCompactDecimalInitOnce.reset();
   return TRUE;
 }
 
@@ -392,6 +394,16 @@ static UBool divisors_equal(const double* lhs, const double* rhs) {
 // getCDFLocaleStyleData returns pointer to formatting data for given locale and 
 // style within the global cache. On cache miss, getCDFLocaleStyleData loads
 // the data from CLDR into the global cache before returning the pointer. If a
+static void initCompactDecimalData(UErrorCode& status) {
+  ucln_i18n_registerCleanup(UCLN_I18N_CDFINFO, cdf_cleanup);
+  gCompactDecimalData = uhash_open(uhash_hashChars, uhash_compareChars, NULL, &status);
+  if (U_FAILURE(status)) {
+    return;
+  }
+  uhash_setKeyDeleter(gCompactDecimalData, uprv_free);
+  uhash_setValueDeleter(gCompactDecimalData, deleteCDFLocaleData);
+}
+
 // UNUM_LONG data is requested for a locale, and that locale does not have
 // UNUM_LONG data, getCDFLocaleStyleData will fall back to UNUM_SHORT data for
 // that locale.
@@ -401,19 +413,13 @@ static const CDFLocaleStyleData* getCDFLocaleStyleData(const Locale& inLocale, U
   }
   CDFLocaleData* result = NULL;
   const char* key = inLocale.getName();
+  umtx_initOnce(gCompactDecimalInitOnce, &initCompactDecimalData, status);
+  if (U_FAILURE(status)) {
+    return NULL;
+  }
   {
     Mutex lock(&gCompactDecimalMetaLock);
-    if (gCompactDecimalData == NULL) {
-      gCompactDecimalData = uhash_open(uhash_hashChars, uhash_compareChars, NULL, &status);
-      if (U_FAILURE(status)) {
-        return NULL;
-      }
-      uhash_setKeyDeleter(gCompactDecimalData, uprv_free);
-      uhash_setValueDeleter(gCompactDecimalData, deleteCDFLocaleData);
-      ucln_i18n_registerCleanup(UCLN_I18N_CDFINFO, cdf_cleanup);
-    } else {
-      result = (CDFLocaleData*) uhash_get(gCompactDecimalData, key);
-    }
+    result = (CDFLocaleData*) uhash_get(gCompactDecimalData, key);
   }
   if (result != NULL) {
     return extractDataByStyleEnum(*result, style, status);
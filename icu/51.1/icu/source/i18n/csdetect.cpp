@@ -1,6 +1,6 @@
 /*
  **********************************************************************
- *   Copyright (C) 2005-2012, International Business Machines
+ *   Copyright (C) 2005-2013, International Business Machines
  *   Corporation and others.  All Rights Reserved.
  **********************************************************************
  */
@@ -159,7 +159,8 @@ void CharsetDetector::setRecognizers(UErrorCode &status)
 
 CharsetDetector::CharsetDetector(UErrorCode &status)
   : textIn(new InputText(status)), resultArray(NULL),
-    resultCount(0), fStripTags(FALSE), fFreshTextSet(FALSE)
+    resultCount(0), fStripTags(FALSE), fFreshTextSet(FALSE),
+    fDetectionComplete(FALSE), fConfidenceThreshold(0)
 {
     if (U_FAILURE(status)) {
         return;
@@ -203,6 +204,42 @@ void CharsetDetector::setText(const char *in, int32_t len)
 {
     textIn->setText(in, len);
     fFreshTextSet = TRUE;
+    fDetectionComplete = FALSE;
+}
+
+/*
+ * Streaming input: add the next chunk of the text.
+ * Returns TRUE once more input can no longer change the result, either
+ * because the detector has buffered all the input it will look at, or
+ * because a charset has reached the confidence threshold; later chunks
+ * are then ignored.  Chunks are copied, so the caller may reuse its buffer.
+ */
+UBool CharsetDetector::appendText(const char *in, int32_t len, UErrorCode &status)
+{
+    if (U_FAILURE(status)) {
+        return FALSE;
+    }
+
+    if (!fDetectionComplete) {
+        textIn->appendText(in, len, status);
+        fFreshTextSet = TRUE;
+
+        if (U_FAILURE(status)) {
+            return FALSE;
+        }
+
+        if (textIn->isFull()) {
+            fDetectionComplete = TRUE;
+        } else if (fConfidenceThreshold > 0) {
+            int32_t matchCount = 0;
+
+            detectAll(matchCount, status);
+            fDetectionComplete = (UBool)(matchCount > 0 &&
+                resultArray[0]->getConfidence() >= fConfidenceThreshold);
+        }
+    }
+
+    return fDetectionComplete;
 }
 
 UBool CharsetDetector::setStripTagsFlag(UBool flag)
@@ -223,6 +260,19 @@ void CharsetDetector::setDeclaredEncoding(const char *encoding, int32_t len) con
     textIn->setDeclaredEncoding(encoding,len);
 }
 
+int32_t CharsetDetector::setConfidenceThreshold(int32_t threshold)
+{
+    int32_t temp = fConfidenceThreshold;
+    fConfidenceThreshold = threshold;
+    fFreshTextSet = TRUE;
+    return temp;
+}
+
+int32_t CharsetDetector::getConfidenceThreshold() const
+{
+    return fConfidenceThreshold;
+}
+
 int32_t CharsetDetector::getDetectableCount()
 {
     UErrorCode status = U_ZERO_ERROR;
@@ -259,11 +309,18 @@ const CharsetMatch * const *CharsetDetector::detectAll(int32_t &maxMatchesFound,
 
         // Iterate over all possible charsets, remember all that
         // give a match quality > 0.
+        // With a confidence threshold, stop at the first match that reaches it;
+        // the matches before it are all below the threshold, so it still sorts first.
         resultCount = 0;
         for (i = 0; i < fCSRecognizers_size; i += 1) {
             csr = fCSRecognizers[i];
             if (csr->match(textIn, resultArray[resultCount])) {
                 resultCount++;
+
+                if (fConfidenceThreshold > 0 &&
+                        resultArray[resultCount - 1]->getConfidence() >= fConfidenceThreshold) {
+                    break;
+                }
             }
         }
 
@@ -1,6 +1,6 @@
 /*
  **********************************************************************
- *   Copyright (C) 2005-2006, International Business Machines
+ *   Copyright (C) 2005-2013, International Business Machines
  *   Corporation and others.  All Rights Reserved.
  **********************************************************************
  */
@@ -26,6 +26,8 @@ private:
     int32_t resultCount;
     UBool fStripTags;   // If true, setText() will strip tags from input text.
     UBool fFreshTextSet;
+    UBool fDetectionComplete;     // appendText() has seen enough input.
+    int32_t fConfidenceThreshold; // Stop detection at a match this good; 0 for never.
     static void setRecognizers(UErrorCode &status);
 
 public:
@@ -35,6 +37,8 @@ public:
 
     void setText(const char *in, int32_t len);
 
+    UBool appendText(const char *in, int32_t len, UErrorCode &status);
+
     const CharsetMatch * const *detectAll(int32_t &maxMatchesFound, UErrorCode &status);
 
     const CharsetMatch *detect(UErrorCode& status);
@@ -45,6 +49,10 @@ public:
 
     UBool getStripTagsFlag() const;
 
+    int32_t setConfidenceThreshold(int32_t threshold);
+
+    int32_t getConfidenceThreshold() const;
+
 //    const char *getCharsetName(int32_t index, UErrorCode& status) const;
 
     static int32_t getDetectableCount(); 
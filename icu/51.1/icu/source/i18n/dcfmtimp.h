@@ -1,6 +1,6 @@
 /*
 ********************************************************************************
-*   Copyright (C) 2012, International Business Machines
+*   Copyright (C) 2012-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 ********************************************************************************/
 
@@ -26,12 +26,14 @@ enum EDecimalFormatFastpathStatus {
 struct DecimalFormatInternal {
   uint8_t    fFastFormatStatus;
   uint8_t    fFastParseStatus;
+  uint8_t    fFastFixedStatus;  /* integers and fixed point doubles without DigitList */
   
 #ifdef FMT_DEBUG
   void dump() const {
-    printf("DecimalFormatInternal: fFastFormatStatus=%c, fFastParseStatus=%c\n",
+    printf("DecimalFormatInternal: fFastFormatStatus=%c, fFastParseStatus=%c, fFastFixedStatus=%c\n",
            "NY?"[(int)fFastFormatStatus&3],
-           "NY?"[(int)fFastParseStatus&3]
+           "NY?"[(int)fFastParseStatus&3],
+           "NY?"[(int)fFastFixedStatus&3]
            );
   }
 #endif  
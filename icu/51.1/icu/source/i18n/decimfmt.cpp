@@ -67,6 +67,7 @@
 #include "uassert.h"
 #include "putilimp.h"
 #include <math.h>
+#include <stdio.h>
 #include "hash.h"
 #include "decfmtst.h"
 #include "dcfmtimp.h"
@@ -381,6 +382,7 @@ DecimalFormat::init(UErrorCode &status) {
     DecimalFormatInternal &data = internalData(fReserved);
     data.fFastFormatStatus=kFastpathUNKNOWN; // don't try to calculate the fastpath until later.
     data.fFastParseStatus=kFastpathUNKNOWN; // don't try to calculate the fastpath until later.
+    data.fFastFixedStatus=kFastpathUNKNOWN; // don't try to calculate the fastpath until later.
 #endif
     // only do this once per obj.
     DecimalFormatStaticSets::initSets(&status);
@@ -528,6 +530,7 @@ DecimalFormat::construct(UErrorCode&             status,
     DecimalFormatInternal &data = internalData(fReserved);
     data.fFastFormatStatus = kFastpathNO; // allow it to be calculated
     data.fFastParseStatus = kFastpathNO; // allow it to be calculated
+    data.fFastFixedStatus = kFastpathNO; // allow it to be calculated
     handleChanged();
 #endif
 }
@@ -1029,7 +1032,7 @@ void DecimalFormat::handleChanged() {
     return; // still constructing. Wait.
   }
 
-  data.fFastParseStatus = data.fFastFormatStatus = kFastpathNO;
+  data.fFastParseStatus = data.fFastFormatStatus = data.fFastFixedStatus = kFastpathNO;
 
 #if UCONFIG_HAVE_PARSEALLINPUT
   if(fParseAllInput == UNUM_NO) {
@@ -1084,6 +1087,29 @@ void DecimalFormat::handleChanged() {
     debug("format:kFastpathYES!");
   }
 
+  // The fixed point fastpath handles grouping, minimum and maximum digits,
+  // localized digits and rounding to the maximum fraction digits itself,
+  // which are all read at format time.
+  if(fUseExponentialNotation) {
+    debug("No fixed fastpath: fUseExponentialNotation");
+  } else if(fFormatWidth!=0) {
+    debug("No fixed fastpath: fFormatWidth!=0");
+  } else if(areSignificantDigitsUsed()) {
+    debug("No fixed fastpath: significant digits are used");
+  } else if(fMultiplier!=NULL) {
+    debug("No fixed fastpath: fMultiplier!=NULL");
+  } else if(fScale!=0) {
+    debug("No fixed fastpath: fScale!=0");
+  } else if(fCurrencySignCount > fgCurrencySignCountZero) {
+    debug("No fixed fastpath: fCurrencySignCount > fgCurrencySignCountZero");
+  } else if(fRoundingIncrement!=0) {
+    debug("No fixed fastpath: fRoundingIncrement!=0");
+  } else if(fRoundingMode==kRoundUnnecessary) {
+    debug("No fixed fastpath: fRoundingMode==kRoundUnnecessary");
+  } else {
+    data.fFastFixedStatus = kFastpathYES;
+    debug("fixed:kFastpathYES!");
+  }
 
 }
 #endif
@@ -1203,6 +1229,32 @@ DecimalFormat::_format(int64_t number,
 
     return appendTo;
   } // end fastpath
+
+  if (data.fFastFixedStatus==kFastpathYES) {
+    // An integer needs no rounding; just collect its digits.
+    char digits[MAX_DIGITS+1];
+    int32_t digitIdx = MAX_DIGITS+1;
+    int64_t n = number;
+    if (n < 0) {
+      // Don't negate, -INT64_MIN does not fit.
+      digits[--digitIdx] = (char)(-(n % 10) + 0x30);
+      n /= -10;
+    }
+    while (n > 0) {
+      digits[--digitIdx] = (char)((n % 10) + 0x30);
+      n /= 10;
+    }
+    int32_t decimalAt = MAX_DIGITS+1 - digitIdx;
+    int32_t digitCount = decimalAt;
+    while (digitCount > 0 && digits[digitIdx+digitCount-1] == 0x30) {
+      --digitCount;
+    }
+    if (digitCount == 0) {
+      decimalAt = 0;
+    }
+    return formatFixedDigits(appendTo, handler, digits+digitIdx, digitCount, decimalAt,
+                             number<0, (double)number, status);
+  }
 #endif
 
   // Else the slow way - via DigitList
@@ -1266,6 +1318,12 @@ DecimalFormat::_format( double number,
         return appendTo;
     }
 
+#if UCONFIG_FORMAT_FASTPATHS_49
+    if (_formatFixed(number, appendTo, handler, status)) {
+        return appendTo;
+    }
+#endif
+
     DigitList digits;
     digits.set(number);
     _format(digits, appendTo, handler, status);
@@ -1273,6 +1331,222 @@ DecimalFormat::_format( double number,
     return appendTo;
 }
 
+#if UCONFIG_FORMAT_FASTPATHS_49
+UBool
+DecimalFormat::_formatFixed(double number,
+                            UnicodeString& appendTo,
+                            FieldPositionHandler& handler,
+                            UErrorCode &status) const
+{
+    const DecimalFormatInternal &data = internalData(fReserved);
+    if (data.fFastFixedStatus != kFastpathYES || uprv_isInfinite(number)) {
+        return FALSE;
+    }
+
+    // Get the same digits that DigitList::set(double) would, from a
+    // representation of the form /[+-][0-9].[0-9]+e[+-][0-9]+/
+    char rep[MAX_DIGITS + 8];
+    sprintf(rep, "%+1.*e", MAX_DBL_DIGITS - 1, number);
+
+    // The sign matters for -0.0 as well, see DecimalFormat::_round().
+    UBool isNegative = (rep[0] == '-');
+    char digits[MAX_DBL_DIGITS + 1];
+    int32_t digitCount = 0;
+    const char *p = rep + 1;
+    for (; *p != 0 && *p != 'e'; ++p) {
+        // Skips the decimal separator, which may be ',' in some C locales.
+        if (*p >= '0' && *p <= '9' && digitCount < MAX_DBL_DIGITS) {
+            digits[digitCount++] = *p;
+        }
+    }
+    if (*p != 'e') {
+        return FALSE;
+    }
+    ++p;
+    UBool negativeExponent = (*p == '-');
+    if (*p == '-' || *p == '+') {
+        ++p;
+    }
+    int32_t exponent = 0;
+    for (; *p >= '0' && *p <= '9'; ++p) {
+        exponent = exponent * 10 + (*p - '0');
+    }
+    int32_t decimalAt = (negativeExponent ? -exponent : exponent) + 1;
+
+    while (digitCount > 0 && digits[digitCount-1] == '0') {
+        --digitCount;
+    }
+    if (digitCount == 0) {
+        decimalAt = 0;
+    }
+
+    // Round to the maximum fraction digits, as DigitList::roundFixedPoint()
+    // does.  Every discarded digit past the first is known to be nonzero.
+    int32_t maxFracDig = getMaximumFractionDigits();
+    if (digitCount - decimalAt > maxFracDig) {
+        int32_t keep = decimalAt + maxFracDig;
+        char first = (keep >= 0) ? digits[keep] : '0';
+        UBool more = (keep >= 0) ? (keep + 1 < digitCount) : TRUE;
+        UBool lastIsOdd = (keep > 0) && ((digits[keep-1] - '0') & 1);
+        UBool roundUp;
+        switch (fRoundingMode) {
+        case kRoundCeiling:
+            roundUp = !isNegative;
+            break;
+        case kRoundFloor:
+            roundUp = isNegative;
+            break;
+        case kRoundDown:
+            roundUp = FALSE;
+            break;
+        case kRoundUp:
+            roundUp = TRUE;
+            break;
+        case kRoundHalfDown:
+            roundUp = first > '5' || (first == '5' && more);
+            break;
+        case kRoundHalfUp:
+            roundUp = first >= '5';
+            break;
+        case kRoundHalfEven:
+        default:
+            roundUp = first > '5' || (first == '5' && (more || lastIsOdd));
+            break;
+        }
+
+        if (keep <= 0) {
+            // Nothing is left but what rounding up gives.
+            if (roundUp) {
+                digits[0] = '1';
+                digitCount = 1;
+                decimalAt = 1 - maxFracDig;
+            } else {
+                digitCount = 0;
+                decimalAt = 0;
+            }
+        } else {
+            digitCount = keep;
+            if (roundUp) {
+                while (digitCount > 0 && digits[digitCount-1] == '9') {
+                    --digitCount;
+                }
+                if (digitCount == 0) {
+                    digits[0] = '1';
+                    digitCount = 1;
+                    ++decimalAt;
+                } else {
+                    ++digits[digitCount-1];
+                }
+            }
+            while (digitCount > 0 && digits[digitCount-1] == '0') {
+                --digitCount;
+            }
+            if (digitCount == 0) {
+                decimalAt = 0;
+            }
+        }
+    }
+
+    formatFixedDigits(appendTo, handler, digits, digitCount, decimalAt, isNegative, number, status);
+    return TRUE;
+}
+
+/**
+ * The fixed point part of subformat(), for the patterns handleChanged()
+ * marks with fFastFixedStatus: no exponent, no significant digits, no
+ * currency and no padding.
+ */
+UnicodeString&
+DecimalFormat::formatFixedDigits(UnicodeString& appendTo,
+                                 FieldPositionHandler& handler,
+                                 const char *digits,
+                                 int32_t digitCount,
+                                 int32_t decimalAt,
+                                 UBool isNegative,
+                                 double number,
+                                 UErrorCode& status) const
+{
+    UChar32 localizedDigits[10];
+    localizedDigits[0] = getConstSymbol(DecimalFormatSymbols::kZeroDigitSymbol).char32At(0);
+    for (int32_t d = 1; d < 10; ++d) {
+        localizedDigits[d] = getConstSymbol((DecimalFormatSymbols::ENumberFormatSymbol)
+                                            (DecimalFormatSymbols::kOneDigitSymbol + d - 1)).char32At(0);
+    }
+    const UnicodeString &grouping = getConstSymbol(DecimalFormatSymbols::kGroupingSeparatorSymbol);
+    const UnicodeString &decimal = getConstSymbol(DecimalFormatSymbols::kDecimalSeparatorSymbol);
+    int32_t maxIntDig = getMaximumIntegerDigits();
+    int32_t minIntDig = getMinimumIntegerDigits();
+    int32_t minFracDig = getMinimumFractionDigits();
+    int32_t maxFracDig = getMaximumFractionDigits();
+
+    appendAffix(appendTo, number, handler, isNegative, TRUE);
+
+    int32_t intBegin = appendTo.length();
+
+    int32_t count = minIntDig;
+    if (decimalAt > 0 && count < decimalAt) {
+        count = decimalAt;
+    }
+    int32_t digitIndex = 0;
+    if (count > maxIntDig && maxIntDig >= 0) {
+        count = maxIntDig;
+        digitIndex = decimalAt - count;
+        if(fBoolFlags.contains(UNUM_FORMAT_FAIL_IF_MORE_THAN_MAX_DIGITS)) {
+            status = U_ILLEGAL_ARGUMENT_ERROR;
+        }
+    }
+
+    int32_t i;
+    for (i=count-1; i>=0; --i) {
+        if (i < decimalAt && digitIndex < digitCount) {
+            appendTo += localizedDigits[digits[digitIndex++] - '0'];
+        } else {
+            appendTo += localizedDigits[0];
+        }
+        if (isGroupingPosition(i)) {
+            int32_t groupingBegin = appendTo.length();
+            appendTo.append(grouping);
+            handler.addAttribute(kGroupingSeparatorField, groupingBegin, appendTo.length());
+        }
+    }
+
+    UBool fractionPresent = (digitIndex < digitCount) || (minFracDig > 0);
+    if (!fractionPresent && appendTo.length() == intBegin) {
+        appendTo += localizedDigits[0];
+    }
+
+    int32_t currentLength = appendTo.length();
+    handler.addAttribute(kIntegerField, intBegin, currentLength);
+
+    if (fDecimalSeparatorAlwaysShown || fractionPresent) {
+        appendTo += decimal;
+        handler.addAttribute(kDecimalSeparatorField, currentLength, appendTo.length());
+        currentLength = appendTo.length();
+    }
+
+    int32_t fracBegin = currentLength;
+    for (i=0; i < maxFracDig; ++i) {
+        if (i >= minFracDig && digitIndex >= digitCount) {
+            break;
+        }
+        if (-1-i > (decimalAt-1)) {
+            // Leading fractional zeros.
+            appendTo += localizedDigits[0];
+            continue;
+        }
+        if (digitIndex < digitCount) {
+            appendTo += localizedDigits[digits[digitIndex++] - '0'];
+        } else {
+            appendTo += localizedDigits[0];
+        }
+    }
+    handler.addAttribute(kFractionField, fracBegin, appendTo.length());
+
+    appendAffix(appendTo, number, handler, isNegative, FALSE);
+    return appendTo;
+}
+#endif
+
 //------------------------------------------------------------------------------
 
 
@@ -5555,6 +5829,9 @@ DecimalFormat& DecimalFormat::setAttribute( UNumberFormatAttribute attr,
 
     case UNUM_SCALE:
         fScale = newValue;
+#if UCONFIG_FORMAT_FASTPATHS_49
+        handleChanged();
+#endif
         break;
 
     default:
@@ -1,6 +1,6 @@
 /*
 **********************************************************************
-*   Copyright (c) 2002-2011, International Business Machines Corporation
+*   Copyright (c) 2002-2013, International Business Machines Corporation
 *   and others.  All Rights Reserved.
 **********************************************************************
 *   Date        Name        Description
@@ -45,6 +45,8 @@ class FunctionReplacer : public UnicodeFunctor, public UnicodeReplacer {
      */
     UnicodeFunctor* replacer;
 
+    friend class TransliterationRuleCache;
+
  public:
 
     /**
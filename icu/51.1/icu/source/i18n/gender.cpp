@@ -1,6 +1,6 @@
 /*
 *******************************************************************************
-* Copyright (C) 2008-2012, International Business Machines Corporation and
+* Copyright (C) 2008-2013, International Business Machines Corporation and
 * others. All Rights Reserved.
 *******************************************************************************
 *
@@ -24,12 +24,14 @@
 #include "cmemory.h"
 #include "cstring.h"
 #include "mutex.h"
+#include "uassert.h"
 #include "ucln_in.h"
 #include "umutex.h"
 #include "uhash.h"
 
 static UHashtable* gGenderInfoCache = NULL;
 static UMutex gGenderMetaLock = U_MUTEX_INITIALIZER;
+static icu::UInitOnce gGenderInitOnce = U_INITONCE_INITIALIZER;
 static const char* gNeutralStr = "neutral";
 static const char* gMailTaintsStr = "maleTaints";
 static const char* gMixedNeutralStr = "mixedNeutral";
@@ -50,6 +52,7 @@ static UBool U_CALLCONV gender_cleanup(void) {
     gGenderInfoCache = NULL;
     delete [] gObjs;
   }
+  gGenderInitOnce.reset();
   return TRUE;
 }
 
@@ -57,6 +60,29 @@ U_CDECL_END
 
 U_NAMESPACE_BEGIN
 
+void GenderInfo_initCache(UErrorCode &status) {
+  ucln_i18n_registerCleanup(UCLN_I18N_GENDERINFO, gender_cleanup);
+  U_ASSERT(gGenderInfoCache == NULL);
+  if (U_FAILURE(status)) {
+    return;
+  }
+  gObjs = new GenderInfo[GENDER_STYLE_LENGTH];
+  if (gObjs == NULL) {
+    status = U_MEMORY_ALLOCATION_ERROR;
+    return;
+  }
+  for (int i = 0; i < GENDER_STYLE_LENGTH; i++) {
+    gObjs[i]._style = i;
+  }
+  gGenderInfoCache = uhash_open(uhash_hashChars, uhash_compareChars, NULL, &status);
+  if (U_FAILURE(status)) {
+    delete [] gObjs;
+    gObjs = NULL;
+    return;
+  }
+  uhash_setKeyDeleter(gGenderInfoCache, uprv_free);
+}
+
 GenderInfo::GenderInfo() {
 }
 
@@ -69,27 +95,9 @@ const GenderInfo* GenderInfo::getInstance(const Locale& locale, UErrorCode& stat
   }
 
   // Make sure our cache exists.
-  UBool needed;
-  UMTX_CHECK(&gGenderMetaLock, (gGenderInfoCache == NULL), needed);
-  if (needed) {
-    Mutex lock(&gGenderMetaLock);
-    if (gGenderInfoCache == NULL) {
-      gObjs = new GenderInfo[GENDER_STYLE_LENGTH];
-      if (gObjs == NULL) {
-        status = U_MEMORY_ALLOCATION_ERROR;
-        return NULL;
-      }
-      for (int i = 0; i < GENDER_STYLE_LENGTH; i++) {
-        gObjs[i]._style = i;
-      }
-      gGenderInfoCache = uhash_open(uhash_hashChars, uhash_compareChars, NULL, &status);
-      if (U_FAILURE(status)) {
-        delete [] gObjs;
-        return NULL;
-      }
-      uhash_setKeyDeleter(gGenderInfoCache, uprv_free);
-      ucln_i18n_registerCleanup(UCLN_I18N_GENDERINFO, gender_cleanup);
-    }
+  umtx_initOnce(gGenderInitOnce, &GenderInfo_initCache, status);
+  if (U_FAILURE(status)) {
+    return NULL;
   }
 
   const GenderInfo* result = NULL;
@@ -11,17 +11,16 @@
 #include "unicode/utf16.h"
 
 #include "identifier_info.h"
-#include "mutex.h"
 #include "scriptset.h"
 #include "ucln_in.h"
+#include "umutex.h"
 #include "uvector.h"
 
 U_NAMESPACE_BEGIN
 
 #define LENGTHOF(array) (int32_t)(sizeof(array)/sizeof((array)[0]))
 
-static UMutex gInitMutex = U_MUTEX_INITIALIZER;
-static UBool gStaticsAreInitialized = FALSE;
+static UInitOnce gIdentifierInfoInitOnce = U_INITONCE_INITIALIZER;
 
 UnicodeSet *IdentifierInfo::ASCII;
 ScriptSet *IdentifierInfo::JAPANESE;
@@ -40,7 +39,7 @@ UBool IdentifierInfo::cleanup() {
     KOREAN = NULL;
     delete CONFUSABLE_WITH_LATIN;
     CONFUSABLE_WITH_LATIN = NULL;
-    gStaticsAreInitialized = FALSE;
+    gIdentifierInfoInitOnce.reset();
     return TRUE;
 }
 
@@ -51,6 +50,27 @@ IdentifierInfo_cleanup(void) {
 }
 U_CDECL_END
 
+void IdentifierInfo::initStatics(UErrorCode &status) {
+    ASCII    = new UnicodeSet(0, 0x7f);
+    JAPANESE = new ScriptSet();
+    CHINESE  = new ScriptSet();
+    KOREAN   = new ScriptSet();
+    CONFUSABLE_WITH_LATIN = new ScriptSet();
+    if (ASCII == NULL || JAPANESE == NULL || CHINESE == NULL || KOREAN == NULL 
+            || CONFUSABLE_WITH_LATIN == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    ASCII->freeze();
+    JAPANESE->set(USCRIPT_LATIN, status).set(USCRIPT_HAN, status).set(USCRIPT_HIRAGANA, status)
+             .set(USCRIPT_KATAKANA, status);
+    CHINESE->set(USCRIPT_LATIN, status).set(USCRIPT_HAN, status).set(USCRIPT_BOPOMOFO, status);
+    KOREAN->set(USCRIPT_LATIN, status).set(USCRIPT_HAN, status).set(USCRIPT_HANGUL, status);
+    CONFUSABLE_WITH_LATIN->set(USCRIPT_CYRILLIC, status).set(USCRIPT_GREEK, status)
+              .set(USCRIPT_CHEROKEE, status);
+    ucln_i18n_registerCleanup(UCLN_I18N_IDENTIFIER_INFO, IdentifierInfo_cleanup);
+}
+
 
 IdentifierInfo::IdentifierInfo(UErrorCode &status):
          fIdentifier(NULL), fRequiredScripts(NULL), fScriptSetSet(NULL), 
@@ -58,29 +78,9 @@ IdentifierInfo::IdentifierInfo(UErrorCode &status):
     if (U_FAILURE(status)) {
         return;
     }
-    {
-        Mutex lock(&gInitMutex);
-        if (!gStaticsAreInitialized) {
-            ASCII    = new UnicodeSet(0, 0x7f);
-            JAPANESE = new ScriptSet();
-            CHINESE  = new ScriptSet();
-            KOREAN   = new ScriptSet();
-            CONFUSABLE_WITH_LATIN = new ScriptSet();
-            if (ASCII == NULL || JAPANESE == NULL || CHINESE == NULL || KOREAN == NULL 
-                    || CONFUSABLE_WITH_LATIN == NULL) {
-                status = U_MEMORY_ALLOCATION_ERROR;
-                return;
-            }
-            ASCII->freeze();
-            JAPANESE->set(USCRIPT_LATIN, status).set(USCRIPT_HAN, status).set(USCRIPT_HIRAGANA, status)
-                     .set(USCRIPT_KATAKANA, status);
-            CHINESE->set(USCRIPT_LATIN, status).set(USCRIPT_HAN, status).set(USCRIPT_BOPOMOFO, status);
-            KOREAN->set(USCRIPT_LATIN, status).set(USCRIPT_HAN, status).set(USCRIPT_HANGUL, status);
-            CONFUSABLE_WITH_LATIN->set(USCRIPT_CYRILLIC, status).set(USCRIPT_GREEK, status)
-                      .set(USCRIPT_CHEROKEE, status);
-            ucln_i18n_registerCleanup(UCLN_I18N_IDENTIFIER_INFO, IdentifierInfo_cleanup);
-            gStaticsAreInitialized = TRUE;
-        }
+    umtx_initOnce(gIdentifierInfoInitOnce, &IdentifierInfo::initStatics, status);
+    if (U_FAILURE(status)) {
+        return;
     }
     fIdentifier = new UnicodeString();
     fRequiredScripts = new ScriptSet();
@@ -194,6 +194,8 @@ class U_I18N_API IdentifierInfo : public UMemory {
     static ScriptSet  *KOREAN;
     static ScriptSet  *CONFUSABLE_WITH_LATIN;
 
+    static void       initStatics(UErrorCode &status);
+
 
 
 };
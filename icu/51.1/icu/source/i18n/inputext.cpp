@@ -1,6 +1,6 @@
 /*
  **********************************************************************
- *   Copyright (C) 2005-2009, International Business Machines
+ *   Copyright (C) 2005-2013, International Business Machines
  *   Corporation and others.  All Rights Reserved.
  **********************************************************************
  */
@@ -20,6 +20,10 @@ U_NAMESPACE_BEGIN
 
 #define BUFFER_SIZE 8192
 
+// Detection looks at no more than BUFFER_SIZE bytes after markup stripping.
+// Keep enough of a stream that stripping can still fill the buffer.
+#define STREAM_BUFFER_SIZE (4 * BUFFER_SIZE)
+
 #define ARRAY_SIZE(array) (sizeof array / sizeof array[0])
 
 #define NEW_ARRAY(type,count) (type *) uprv_malloc((count) * sizeof(type))
@@ -32,7 +36,8 @@ InputText::InputText(UErrorCode &status)
                                                  //   Value is percent, not absolute.
       fDeclaredEncoding(0),
       fRawInput(0),
-      fRawLength(0)
+      fRawLength(0),
+      fStreamBytes(0)
 {
     if (fInputBytes == NULL || fByteStats == NULL) {
         status = U_MEMORY_ALLOCATION_ERROR;
@@ -44,6 +49,7 @@ InputText::~InputText()
     DELETE_ARRAY(fDeclaredEncoding);
     DELETE_ARRAY(fByteStats);
     DELETE_ARRAY(fInputBytes);
+    DELETE_ARRAY(fStreamBytes);
 }
 
 void InputText::setText(const char *in, int32_t len)
@@ -68,6 +74,63 @@ void InputText::setDeclaredEncoding(const char* encoding, int32_t len)
     }
 }
 
+/*
+ * Add a chunk of streamed input.  Input beyond STREAM_BUFFER_SIZE bytes
+ * could not change the detection results and is dropped.
+ * If the text was set with setText(), it becomes the start of the stream.
+ */
+void InputText::appendText(const char *in, int32_t len, UErrorCode &status)
+{
+    if (U_FAILURE(status)) {
+        return;
+    }
+
+    if (fStreamBytes == NULL) {
+        fStreamBytes = NEW_ARRAY(uint8_t, STREAM_BUFFER_SIZE);
+
+        if (fStreamBytes == NULL) {
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return;
+        }
+    }
+
+    if (fRawInput != fStreamBytes) {
+        int32_t startLength = fRawInput == NULL ? 0 : fRawLength;
+
+        if (startLength > STREAM_BUFFER_SIZE) {
+            startLength = STREAM_BUFFER_SIZE;
+        }
+
+        if (startLength > 0) {
+            uprv_memmove(fStreamBytes, fRawInput, startLength);
+        }
+
+        fRawInput  = fStreamBytes;
+        fRawLength = startLength;
+    }
+
+    if (len == -1) {
+        len = (int32_t)uprv_strlen(in);
+    }
+
+    if (len > STREAM_BUFFER_SIZE - fRawLength) {
+        len = STREAM_BUFFER_SIZE - fRawLength;
+    }
+
+    if (len > 0) {
+        uprv_memcpy(fStreamBytes + fRawLength, in, len);
+        fRawLength += len;
+    }
+
+    fInputLen = 0;
+    fC1Bytes  = FALSE;
+}
+
+UBool InputText::isFull() const
+{
+    return fRawInput != NULL && fRawInput == fStreamBytes && fRawLength == STREAM_BUFFER_SIZE;
+}
+
 UBool InputText::isSet() const 
 {
     return fRawInput != NULL;
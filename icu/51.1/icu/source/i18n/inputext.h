@@ -1,6 +1,6 @@
 /*
  **********************************************************************
- *   Copyright (C) 2005-2008, International Business Machines
+ *   Copyright (C) 2005-2013, International Business Machines
  *   Corporation and others.  All Rights Reserved.
  **********************************************************************
  */
@@ -32,6 +32,8 @@ public:
     ~InputText();
 
     void setText(const char *in, int32_t len);
+    void appendText(const char *in, int32_t len, UErrorCode &status);
+    UBool isFull() const;
     void setDeclaredEncoding(const char *encoding, int32_t len);
     UBool isSet() const; 
     void MungeInput(UBool fStripTags);
@@ -53,6 +55,10 @@ public:
     //   buffer here.
     int32_t                  fRawLength;    // Length of data in fRawInput array.
 
+    uint8_t                 *fStreamBytes;  // Copy of the input given to appendText(),
+                                            //   allocated on first use.  fRawInput points
+                                            //   here while streaming.
+
 };
 
 U_NAMESPACE_END
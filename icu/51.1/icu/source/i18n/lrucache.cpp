@@ -0,0 +1,177 @@
+/*
+**********************************************************************
+*
+* File LRUCACHE.CPP
+*
+**********************************************************************
+*/
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_FORMATTING
+
+#include "lrucache.h"
+#include "uassert.h"
+
+U_NAMESPACE_BEGIN
+
+struct LRUCacheEntry : public UMemory {
+    UnicodeString    key;
+    void            *value;
+    LRUCacheEntry   *prev;      // more recently used
+    LRUCacheEntry   *next;      // less recently used
+};
+
+LRUCache::LRUCache(int32_t capacity, UObjectDeleter *valueDeleter, UErrorCode &status)
+: fCapacity(capacity), fValueDeleter(valueDeleter), fMap(NULL),
+  fHead(NULL), fTail(NULL), fHits(0), fMisses(0), fRemoved(0) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    if (capacity <= 0) {
+        status = U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+    fMap = uhash_openSize(uhash_hashUnicodeString, uhash_compareUnicodeString, NULL,
+                          capacity + capacity / 2, &status);
+}
+
+LRUCache::~LRUCache() {
+    removeAll();
+    uhash_close(fMap);
+}
+
+void *
+LRUCache::get(const UnicodeString &key) {
+    LRUCacheEntry *entry = fMap != NULL ? (LRUCacheEntry *)uhash_get(fMap, &key) : NULL;
+    if (entry == NULL) {
+        ++fMisses;
+        return NULL;
+    }
+    ++fHits;
+    if (entry != fHead) {
+        unlink(entry);
+        linkFirst(entry);
+    }
+    return entry->value;
+}
+
+void
+LRUCache::put(const UnicodeString &key, void *value, UErrorCode &status) {
+    if (U_FAILURE(status) || fMap == NULL) {
+        if (value != NULL && fValueDeleter != NULL) {
+            fValueDeleter(value);
+        }
+        return;
+    }
+    LRUCacheEntry *entry = (LRUCacheEntry *)uhash_get(fMap, &key);
+    if (entry != NULL) {
+        remove(entry);
+    } else if (uhash_count(fMap) >= fCapacity) {
+        remove(fTail);
+    }
+    // A UHashtable keeps a marker in the slot of each removed key, which
+    // lookups probe past, and only rehashes as the count grows. With a
+    // key replaced on each miss, the markers would fill the table.
+    if (fRemoved > fCapacity) {
+        rebuildMap();
+    }
+
+    entry = new LRUCacheEntry;
+    if (entry == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+        if (value != NULL && fValueDeleter != NULL) {
+            fValueDeleter(value);
+        }
+        return;
+    }
+    entry->key = key;
+    entry->value = value;
+    uhash_put(fMap, &entry->key, entry, &status);
+    if (U_FAILURE(status)) {
+        if (value != NULL && fValueDeleter != NULL) {
+            fValueDeleter(value);
+        }
+        delete entry;
+        return;
+    }
+    linkFirst(entry);
+}
+
+void
+LRUCache::removeAll() {
+    while (fHead != NULL) {
+        remove(fHead);
+    }
+}
+
+int32_t
+LRUCache::count() const {
+    return fMap != NULL ? uhash_count(fMap) : 0;
+}
+
+void
+LRUCache::getStatistics(int32_t &hits, int32_t &misses) const {
+    hits = fHits;
+    misses = fMisses;
+}
+
+void
+LRUCache::rebuildMap() {
+    UErrorCode status = U_ZERO_ERROR;
+    UHashtable *map = uhash_openSize(uhash_hashUnicodeString, uhash_compareUnicodeString, NULL,
+                                     fCapacity + fCapacity / 2, &status);
+    for (LRUCacheEntry *entry = fHead; entry != NULL && U_SUCCESS(status); entry = entry->next) {
+        uhash_put(map, &entry->key, entry, &status);
+    }
+    if (U_FAILURE(status)) {
+        // keep the old map, which still works
+        uhash_close(map);
+        return;
+    }
+    uhash_close(fMap);
+    fMap = map;
+    fRemoved = 0;
+}
+
+void
+LRUCache::unlink(LRUCacheEntry *entry) {
+    if (entry->prev != NULL) {
+        entry->prev->next = entry->next;
+    } else {
+        fHead = entry->next;
+    }
+    if (entry->next != NULL) {
+        entry->next->prev = entry->prev;
+    } else {
+        fTail = entry->prev;
+    }
+}
+
+void
+LRUCache::linkFirst(LRUCacheEntry *entry) {
+    entry->prev = NULL;
+    entry->next = fHead;
+    if (fHead != NULL) {
+        fHead->prev = entry;
+    } else {
+        fTail = entry;
+    }
+    fHead = entry;
+}
+
+void
+LRUCache::remove(LRUCacheEntry *entry) {
+    U_ASSERT(entry != NULL);
+    unlink(entry);
+    uhash_remove(fMap, &entry->key);
+    ++fRemoved;
+    if (entry->value != NULL && fValueDeleter != NULL) {
+        fValueDeleter(entry->value);
+    }
+    delete entry;
+}
+
+U_NAMESPACE_END
+
+#endif /* #if !UCONFIG_NO_FORMATTING */
@@ -0,0 +1,91 @@
+/*
+**********************************************************************
+*
+* File LRUCACHE.H
+*
+**********************************************************************
+*/
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_FORMATTING
+
+#include "unicode/uobject.h"
+#include "unicode/unistr.h"
+#include "uhash.h"
+
+U_NAMESPACE_BEGIN
+
+struct LRUCacheEntry;
+
+/**
+ * A map from string keys to objects that holds at most a fixed number of
+ * them, dropping the least recently used one to make room for a new one.
+ * It counts the hits and misses of get(), for tuning the capacity.
+ *
+ * Used for process-wide caches of compiled formatting data, such as
+ * message patterns and plural rules, which callers copy out of the cache
+ * rather than share.  This class does no locking; such a cache is only
+ * used with the caller's mutex held.
+ */
+class LRUCache : public UMemory {
+public:
+    /**
+     * @param capacity         the most values held
+     * @param valueDeleter     deletes the values that are dropped
+     */
+    LRUCache(int32_t capacity, UObjectDeleter *valueDeleter, UErrorCode &status);
+
+    ~LRUCache();
+
+    /**
+     * Returns the value of the key and makes it the most recently used,
+     * or returns NULL.
+     */
+    void *get(const UnicodeString &key);
+
+    /**
+     * Adopts the value of the key, replacing any earlier value, and drops
+     * the least recently used value if the cache is full.  The value is
+     * deleted on failure.
+     */
+    void put(const UnicodeString &key, void *value, UErrorCode &status);
+
+    /**
+     * Deletes all the values.  The statistics are kept.
+     */
+    void removeAll();
+
+    int32_t count() const;
+
+    /**
+     * The number of get() calls that found a value, and of those that did not.
+     */
+    void getStatistics(int32_t &hits, int32_t &misses) const;
+
+private:
+    int32_t          fCapacity;
+    UObjectDeleter  *fValueDeleter;
+    UHashtable      *fMap;       // key -> LRUCacheEntry, which owns the key
+    LRUCacheEntry   *fHead;      // the most recently used entry
+    LRUCacheEntry   *fTail;      // the least recently used entry
+    int32_t          fHits;
+    int32_t          fMisses;
+    int32_t          fRemoved;   // removals since fMap was rebuilt
+
+    void unlink(LRUCacheEntry *entry);
+    void linkFirst(LRUCacheEntry *entry);
+    void remove(LRUCacheEntry *entry);
+    void rebuildMap();
+
+    LRUCache(const LRUCache &other); // forbid copying of this class
+    LRUCache &operator=(const LRUCache &other); // forbid copying of this class
+};
+
+U_NAMESPACE_END
+
+#endif /* #if !UCONFIG_NO_FORMATTING */
+
+#endif
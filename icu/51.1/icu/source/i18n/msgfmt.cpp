@@ -36,12 +36,16 @@
 #include "unicode/umsg.h"
 #include "unicode/ustring.h"
 #include "cmemory.h"
+#include "lrucache.h"
+#include "mutex.h"
 #include "patternprops.h"
 #include "messageimpl.h"
 #include "msgfmt_impl.h"
 #include "uassert.h"
+#include "ucln_in.h"
 #include "uelement.h"
 #include "uhash.h"
+#include "umutex.h"
 #include "ustrfmt.h"
 #include "util.h"
 #include "uvector.h"
@@ -165,6 +169,52 @@ U_NAMESPACE_BEGIN
 UOBJECT_DEFINE_RTTI_IMPLEMENTATION(MessageFormat)
 UOBJECT_DEFINE_RTTI_IMPLEMENTATION(FormatNameEnumeration)
 
+//--------------------------------------------------------------------
+// Cache of compiled patterns
+
+// How many locale and pattern pairs are kept.  A UI formats many strings
+// for a screen, and formats them again on the way back to it.
+#define MESSAGE_PATTERN_CACHE_CAPACITY 256
+
+// MessageFormat objects holding the explicit formats of a pattern, for
+// applyPattern() to copy, by apostrophe mode, locale and pattern
+static LRUCache *gMessagePatternCache = NULL;
+static UMutex gMessagePatternCacheLock = U_MUTEX_INITIALIZER;
+static UInitOnce gMessagePatternCacheInitOnce = U_INITONCE_INITIALIZER;
+
+U_CDECL_BEGIN
+static UBool U_CALLCONV messageFormat_cleanup(void) {
+    delete gMessagePatternCache;
+    gMessagePatternCache = NULL;
+    gMessagePatternCacheInitOnce.reset();
+    return TRUE;
+}
+U_CDECL_END
+
+// Whether the pattern has arguments with a type, which get explicit formats.
+static UBool hasSimpleArgs(const MessagePattern &msgPattern) {
+    for (int32_t i = 0; i < msgPattern.countParts(); ++i) {
+        const MessagePattern::Part &part = msgPattern.getPart(i);
+        if (part.getType() == UMSGPAT_PART_TYPE_ARG_START &&
+                part.getArgType() == UMSGPAT_ARG_TYPE_SIMPLE) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static void initMessagePatternCache(UErrorCode &status) {
+    ucln_i18n_registerCleanup(UCLN_I18N_MSGFMT, messageFormat_cleanup);
+    U_ASSERT(gMessagePatternCache == NULL);
+    gMessagePatternCache = new LRUCache(MESSAGE_PATTERN_CACHE_CAPACITY, uprv_deleteUObject, status);
+    if (gMessagePatternCache == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+    } else if (U_FAILURE(status)) {
+        delete gMessagePatternCache;
+        gMessagePatternCache = NULL;
+    }
+}
+
 //--------------------------------------------------------------------
 
 /**
@@ -230,7 +280,8 @@ MessageFormat::MessageFormat(const UnicodeString& pattern,
   cachedFormatters(NULL),
   customFormatArgStarts(NULL),
   pluralProvider(&fLocale, UPLURAL_TYPE_CARDINAL),
-  ordinalProvider(&fLocale, UPLURAL_TYPE_ORDINAL)
+  ordinalProvider(&fLocale, UPLURAL_TYPE_ORDINAL),
+  fFrozen(FALSE)
 {
     setLocaleIDs(fLocale.getName(), fLocale.getName());
     applyPattern(pattern, success);
@@ -252,7 +303,8 @@ MessageFormat::MessageFormat(const UnicodeString& pattern,
   cachedFormatters(NULL),
   customFormatArgStarts(NULL),
   pluralProvider(&fLocale, UPLURAL_TYPE_CARDINAL),
-  ordinalProvider(&fLocale, UPLURAL_TYPE_ORDINAL)
+  ordinalProvider(&fLocale, UPLURAL_TYPE_ORDINAL),
+  fFrozen(FALSE)
 {
     setLocaleIDs(fLocale.getName(), fLocale.getName());
     applyPattern(pattern, success);
@@ -275,7 +327,8 @@ MessageFormat::MessageFormat(const UnicodeString& pattern,
   cachedFormatters(NULL),
   customFormatArgStarts(NULL),
   pluralProvider(&fLocale, UPLURAL_TYPE_CARDINAL),
-  ordinalProvider(&fLocale, UPLURAL_TYPE_ORDINAL)
+  ordinalProvider(&fLocale, UPLURAL_TYPE_ORDINAL),
+  fFrozen(FALSE)
 {
     setLocaleIDs(fLocale.getName(), fLocale.getName());
     applyPattern(pattern, parseError, success);
@@ -297,7 +350,8 @@ MessageFormat::MessageFormat(const MessageFormat& that)
   cachedFormatters(NULL),
   customFormatArgStarts(NULL),
   pluralProvider(&fLocale, UPLURAL_TYPE_CARDINAL),
-  ordinalProvider(&fLocale, UPLURAL_TYPE_ORDINAL)
+  ordinalProvider(&fLocale, UPLURAL_TYPE_ORDINAL),
+  fFrozen(FALSE)
 {
     // This will take care of creating the hash tables (since they are NULL).
     UErrorCode ec = U_ZERO_ERROR;
@@ -357,7 +411,7 @@ UBool MessageFormat::allocateArgTypes(int32_t capacity, UErrorCode& status) {
 const MessageFormat&
 MessageFormat::operator=(const MessageFormat& that)
 {
-    if (this != &that) {
+    if (this != &that && !fFrozen) {
         // Calls the super class for assignment first.
         Format::operator=(that);
 
@@ -433,7 +487,7 @@ MessageFormat::clone() const
 void
 MessageFormat::setLocale(const Locale& theLocale)
 {
-    if (fLocale != theLocale) {
+    if (fLocale != theLocale && !fFrozen) {
         delete defaultNumberFormat;
         defaultNumberFormat = NULL;
         delete defaultDateFormat;
@@ -471,17 +525,84 @@ MessageFormat::applyPattern(const UnicodeString& pattern,
                             UParseError& parseError,
                             UErrorCode& ec)
 {
-    if(U_FAILURE(ec)) {
+    if(U_FAILURE(ec) || fFrozen) {
         return;
     }
+
     msgPattern.parse(pattern, &parseError, ec);
+
+    // Copy the explicit formats, such as that of "{0,date,short}", from a
+    // MessageFormat with the same pattern and locale instead of creating
+    // them again.  Parsing the pattern costs no more than copying its parts.
+    UErrorCode cacheStatus = U_ZERO_ERROR;
+    UnicodeString key;
+    if (U_SUCCESS(ec) && hasSimpleArgs(msgPattern)) {
+        umtx_initOnce(gMessagePatternCacheInitOnce, &initMessagePatternCache, cacheStatus);
+    } else {
+        cacheStatus = U_UNSUPPORTED_ERROR;
+    }
+    if (U_SUCCESS(cacheStatus)) {
+        key.append((UChar)(0x30 + msgPattern.getApostropheMode()));
+        key.append(UnicodeString(fLocale.getName(), -1, US_INV)).append((UChar)0).append(pattern);
+
+        Mutex lock(&gMessagePatternCacheLock);
+        const MessageFormat *cached = (const MessageFormat *)gMessagePatternCache->get(key);
+        if (cached != NULL) {
+            hasArgTypeConflicts = cached->hasArgTypeConflicts;
+            copyObjects(*cached, ec);
+            if (U_FAILURE(ec)) {
+                resetPattern();
+            }
+            return;
+        }
+    }
+
     cacheExplicitFormats(ec);
 
     if (U_FAILURE(ec)) {
         resetPattern();
+    } else if (U_SUCCESS(cacheStatus)) {
+        MessageFormat *copy = new MessageFormat(*this);
+        if (copy != NULL) {
+            Mutex lock(&gMessagePatternCacheLock);
+            gMessagePatternCache->put(key, copy, cacheStatus);
+        }
+    }
+}
+
+void U_EXPORT2
+MessageFormat::getPatternCacheStatistics(int32_t& hits, int32_t& misses) {
+    hits = misses = 0;
+    UErrorCode status = U_ZERO_ERROR;
+    umtx_initOnce(gMessagePatternCacheInitOnce, &initMessagePatternCache, status);
+    if (U_SUCCESS(status)) {
+        Mutex lock(&gMessagePatternCacheLock);
+        gMessagePatternCache->getStatistics(hits, misses);
     }
 }
 
+MessageFormat*
+MessageFormat::freeze() {
+    if (!fFrozen) {
+        // Create what format() would otherwise create on first use.
+        UErrorCode status = U_ZERO_ERROR;
+        getDefaultNumberFormat(status);
+        status = U_ZERO_ERROR;
+        getDefaultDateFormat(status);
+        status = U_ZERO_ERROR;
+        pluralProvider.select(0, status);
+        status = U_ZERO_ERROR;
+        ordinalProvider.select(0, status);
+        fFrozen = TRUE;
+    }
+    return this;
+}
+
+UBool
+MessageFormat::isFrozen() const {
+    return fFrozen;
+}
+
 void MessageFormat::resetPattern() {
     msgPattern.clear();
     uhash_close(cachedFormatters);
@@ -497,6 +618,9 @@ MessageFormat::applyPattern(const UnicodeString& pattern,
                             UMessagePatternApostropheMode aposMode,
                             UParseError* parseError,
                             UErrorCode& status) {
+    if (fFrozen) {
+        return;
+    }
     if (aposMode != msgPattern.getApostropheMode()) {
         msgPattern.clearPatternAndSetApostropheMode(aposMode);
     }
@@ -596,6 +720,12 @@ MessageFormat::adoptFormats(Format** newFormats,
     if (newFormats == NULL || count < 0) {
         return;
     }
+    if (fFrozen) {
+        for (int32_t i = 0; i < count; ++i) {
+            delete newFormats[i];
+        }
+        return;
+    }
     // Throw away any cached formatters.
     if (cachedFormatters != NULL) {
         uhash_removeAll(cachedFormatters);
@@ -626,7 +756,7 @@ MessageFormat::adoptFormats(Format** newFormats,
 void
 MessageFormat::setFormats(const Format** newFormats,
                           int32_t count) {
-    if (newFormats == NULL || count < 0) {
+    if (newFormats == NULL || count < 0 || fFrozen) {
         return;
     }
     // Throw away any cached formatters.
@@ -663,7 +793,7 @@ MessageFormat::setFormats(const Format** newFormats,
 void
 MessageFormat::adoptFormat(int32_t n, Format *newFormat) {
     LocalPointer<Format> p(newFormat);
-    if (n >= 0) {
+    if (n >= 0 && !fFrozen) {
         int32_t formatNumber = 0;
         for (int32_t partIndex = 0; (partIndex = nextTopLevelArgStart(partIndex)) >= 0;) {
             if (n == formatNumber) {
@@ -684,7 +814,7 @@ MessageFormat::adoptFormat(const UnicodeString& formatName,
                            Format* formatToAdopt,
                            UErrorCode& status) {
     LocalPointer<Format> p(formatToAdopt);
-    if (U_FAILURE(status)) {
+    if (U_FAILURE(status) || fFrozen) {
         return;
     }
     int32_t argNumber = MessagePattern::validateArgumentName(formatName);
@@ -719,7 +849,7 @@ MessageFormat::adoptFormat(const UnicodeString& formatName,
 void
 MessageFormat::setFormat(int32_t n, const Format& newFormat) {
 
-    if (n >= 0) {
+    if (n >= 0 && !fFrozen) {
         int32_t formatNumber = 0;
         for (int32_t partIndex = 0;
              (partIndex = nextTopLevelArgStart(partIndex)) >= 0;) {
@@ -763,7 +893,7 @@ void
 MessageFormat::setFormat(const UnicodeString& formatName,
                          const Format& newFormat,
                          UErrorCode& status) {
-    if (U_FAILURE(status)) return;
+    if (U_FAILURE(status) || fFrozen) return;
 
     int32_t argNumber = MessagePattern::validateArgumentName(formatName);
     if (argNumber < UMSGPAT_ARG_NAME_NOT_NUMBER) {
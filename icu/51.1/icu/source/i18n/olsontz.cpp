@@ -77,6 +77,10 @@ U_NAMESPACE_BEGIN
 
 #define SECONDS_PER_DAY (24*60*60)
 
+// Transitions within this many years of the time a zone is created
+// are kept in an expanded table.
+#define TRANSITION_WINDOW_YEARS 50
+
 static const int32_t ZEROS[] = {0,0};
 
 UOBJECT_DEFINE_RTTI_IMPLEMENTATION(OlsonTimeZone)
@@ -106,6 +110,12 @@ void OlsonTimeZone::constructEmpty() {
     typeOffsets = ZEROS;
 
     finalZone = NULL;
+
+    uprv_free(windowTimes);
+    windowTimes = NULL;
+    windowStart = windowCount = 0;
+    maxZoneOffset = 0;
+    lastTransIdx = 0;
 }
 
 /**
@@ -119,7 +129,8 @@ OlsonTimeZone::OlsonTimeZone(const UResourceBundle* top,
                              const UResourceBundle* res,
                              const UnicodeString& tzid,
                              UErrorCode& ec) :
-  BasicTimeZone(tzid), finalZone(NULL), transitionRulesInitialized(FALSE)
+  BasicTimeZone(tzid), finalZone(NULL), windowTimes(NULL), windowStart(0), windowCount(0),
+  maxZoneOffset(0), lastTransIdx(0), transitionRulesInitialized(FALSE)
 {
     clearTransitionRules();
     U_DEBUG_TZ_MSG(("OlsonTimeZone(%s)\n", ures_getKey((UResourceBundle*)res)));
@@ -257,14 +268,61 @@ OlsonTimeZone::OlsonTimeZone(const UResourceBundle* top,
 
     if (U_FAILURE(ec)) {
         constructEmpty();
+    } else {
+        initTransitionWindow();
+    }
+}
+
+/**
+ * Set up the expanded table of the transitions around the current
+ * time, and maxZoneOffset.  If the table can not be allocated, lookups
+ * just decode the transition arrays instead.
+ */
+void OlsonTimeZone::initTransitionWindow() {
+    maxZoneOffset = 0;
+    for (int16_t i = 0; i < typeCount; i++) {
+        int32_t offset = typeOffsets[i << 1] + typeOffsets[(i << 1) + 1];
+        if (offset < 0) {
+            offset = -offset;
+        }
+        if (offset > maxZoneOffset) {
+            maxZoneOffset = offset;
+        }
+    }
+
+    uprv_free(windowTimes);
+    windowTimes = NULL;
+    windowStart = windowCount = 0;
+    lastTransIdx = 0;
+
+    int16_t transCount = transitionCount();
+    if (transCount == 0) {
+        return;
+    }
+
+    double now = uprv_floor(uprv_getUTCtime() / U_MILLIS_PER_SECOND);
+    double span = (double)TRANSITION_WINDOW_YEARS * 365.2425 * SECONDS_PER_DAY;
+    int16_t limit = findTransition(now + span) + 1;
+    int16_t start = findTransition(now - span) + 1;
+    if (start >= limit) {
+        return;
+    }
+    windowTimes = (int64_t *)uprv_malloc(sizeof(int64_t) * (limit - start));
+    if (windowTimes == NULL) {
+        return;
+    }
+    for (int16_t i = start; i < limit; i++) {
+        windowTimes[i - start] = transitionTimeInSeconds(i);
     }
+    windowStart = start;
+    windowCount = limit - start;
 }
 
 /**
  * Copy constructor
  */
 OlsonTimeZone::OlsonTimeZone(const OlsonTimeZone& other) :
-    BasicTimeZone(other), finalZone(0) {
+    BasicTimeZone(other), finalZone(0), windowTimes(NULL) {
     *this = other;
 }
 
@@ -293,6 +351,22 @@ OlsonTimeZone& OlsonTimeZone::operator=(const OlsonTimeZone& other) {
     finalStartYear = other.finalStartYear;
     finalStartMillis = other.finalStartMillis;
 
+    if (this != &other) {
+        uprv_free(windowTimes);
+        windowTimes = NULL;
+        windowStart = windowCount = 0;
+        if (other.windowTimes != NULL) {
+            windowTimes = (int64_t *)uprv_malloc(sizeof(int64_t) * other.windowCount);
+            if (windowTimes != NULL) {
+                uprv_memcpy(windowTimes, other.windowTimes, sizeof(int64_t) * other.windowCount);
+                windowStart = other.windowStart;
+                windowCount = other.windowCount;
+            }
+        }
+    }
+    maxZoneOffset = other.maxZoneOffset;
+    lastTransIdx = other.lastTransIdx;
+
     clearTransitionRules();
 
     return *this;
@@ -304,6 +378,7 @@ OlsonTimeZone& OlsonTimeZone::operator=(const OlsonTimeZone& other) {
 OlsonTimeZone::~OlsonTimeZone() {
     deleteTransitionRules();
     delete finalZone;
+    uprv_free(windowTimes);
 }
 
 /**
@@ -445,6 +520,47 @@ void printTime(double ms) {
     }
 #endif
 
+int16_t
+OlsonTimeZone::findTransition(double sec) const {
+    int16_t transCount = transitionCount();
+
+    // Successive lookups are usually for nearby times, so try the
+    // transition found last time first.
+    int16_t hint = lastTransIdx;
+    if (hint >= 0 && hint < transCount
+            && sec >= windowTransitionTime(hint)
+            && (hint + 1 == transCount || sec < windowTransitionTime(hint + 1))) {
+        return hint;
+    }
+
+    // Binary search for the last transition at or before sec.  The result
+    // is in lo..hi; the transition at lo, if any, is at or before sec, and
+    // the one at hi + 1, if any, is after it.  Start with the expanded
+    // window, where most lookups should end.
+    int16_t lo = -1;
+    int16_t hi = transCount - 1;
+    if (windowCount > 0) {
+        if (sec < windowTimes[0]) {
+            hi = windowStart - 1;
+        } else {
+            lo = windowStart;
+            if (sec < windowTimes[windowCount - 1]) {
+                hi = windowStart + windowCount - 2;
+            }
+        }
+    }
+    while (lo < hi) {
+        int16_t mid = (int16_t)((lo + hi + 1) >> 1);
+        if (sec >= windowTransitionTime(mid)) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    lastTransIdx = lo;
+    return lo;
+}
+
 int64_t
 OlsonTimeZone::transitionTimeInSeconds(int16_t transIdx) const {
     U_ASSERT(transIdx >= 0 && transIdx < transitionCount()); 
@@ -482,11 +598,13 @@ OlsonTimeZone::getHistoricalOffset(UDate date, UBool local,
             rawoff = initialRawOffset() * U_MILLIS_PER_SECOND;
             dstoff = initialDstOffset() * U_MILLIS_PER_SECOND;
         } else {
-            // Linear search from the end is the fastest approach, since
-            // most lookups will happen at/near the end.
-            int16_t transIdx;
-            for (transIdx = transCount - 1; transIdx >= 0; transIdx--) {
-                int64_t transition = transitionTimeInSeconds(transIdx);
+            // A local time is never more than maxZoneOffset from the UTC
+            // time, so no transition after the one found for
+            // sec + maxZoneOffset can apply.  Search back from there; the
+            // right transition is at most a step or two away.
+            int16_t transIdx = findTransition(local ? sec + maxZoneOffset : sec);
+            for (; transIdx >= 0; transIdx--) {
+                int64_t transition = windowTransitionTime(transIdx);
 
                 if (local) {
                     int32_t offsetBefore = zoneOffsetAt(transIdx - 1);
@@ -299,6 +299,14 @@ private:
     int64_t transitionTimeInSeconds(int16_t transIdx) const;
     double transitionTime(int16_t transIdx) const;
 
+    /*
+     * Returns the index of the last transition at or before the given
+     * time in seconds, or -1 if there is none.
+     */
+    int16_t findTransition(double sec) const;
+    int64_t windowTransitionTime(int16_t transIdx) const;
+    void initTransitionWindow(void);
+
     /*
      * Following 3 methods return an offset at the given transition time index.
      * When the index is negative, return the initial offset.
@@ -379,6 +387,26 @@ private:
      */
     const UChar *canonicalID;
 
+    /*
+     * Transition times in seconds, expanded to int64_t, for the transitions
+     * windowStart..windowStart+windowCount-1 within a few decades of the
+     * time the zone was created.  NULL if no transitions fall in that range.
+     */
+    int64_t *windowTimes; // owned, may be NULL
+    int16_t windowStart;
+    int16_t windowCount;
+
+    /*
+     * The largest absolute value of any zone offset, in seconds.
+     */
+    int32_t maxZoneOffset;
+
+    /*
+     * Index of the transition found by the last lookup.  It is only a
+     * hint, checked before use, so it may be updated without locking.
+     */
+    mutable int16_t lastTransIdx;
+
     /* BasicTimeZone support */
     void clearTransitionRules(void);
     void deleteTransitionRules(void);
@@ -400,6 +428,15 @@ OlsonTimeZone::transitionCount() const {
     return transitionCountPre32 + transitionCount32 + transitionCountPost32;
 }
 
+inline int64_t
+OlsonTimeZone::windowTransitionTime(int16_t transIdx) const {
+    int16_t windowIdx = transIdx - windowStart;
+    if (windowIdx >= 0 && windowIdx < windowCount) {
+        return windowTimes[windowIdx];
+    }
+    return transitionTimeInSeconds(transIdx);
+}
+
 inline double
 OlsonTimeZone::transitionTime(int16_t transIdx) const {
     return (double)transitionTimeInSeconds(transIdx) * U_MILLIS_PER_SECOND;
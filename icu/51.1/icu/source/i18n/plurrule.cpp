@@ -15,6 +15,7 @@
 #include "cmemory.h"
 #include "cstring.h"
 #include "hash.h"
+#include "lrucache.h"
 #include "mutex.h"
 #include "patternprops.h"
 #include "plurrule_impl.h"
@@ -23,6 +24,7 @@
 #include "ustrfmt.h"
 #include "locutil.h"
 #include "uassert.h"
+#include "umutex.h"
 
 #if !UCONFIG_NO_FORMATTING
 
@@ -31,6 +33,35 @@ U_NAMESPACE_BEGIN
 // shared by all instances when lazy-initializing samples
 static UMutex pluralMutex = U_MUTEX_INITIALIZER;
 
+// The rules of the most recently used locales, parsed, of which
+// forLocale() returns copies.
+#define PLURAL_RULES_CACHE_CAPACITY 16
+
+static LRUCache *gPluralRulesCache = NULL;
+static UMutex gPluralRulesCacheLock = U_MUTEX_INITIALIZER;
+static UInitOnce gPluralRulesCacheInitOnce = U_INITONCE_INITIALIZER;
+
+U_CDECL_BEGIN
+static UBool U_CALLCONV pluralRules_cleanup(void) {
+    delete gPluralRulesCache;
+    gPluralRulesCache = NULL;
+    gPluralRulesCacheInitOnce.reset();
+    return TRUE;
+}
+U_CDECL_END
+
+static void initPluralRulesCache(UErrorCode &status) {
+    ucln_i18n_registerCleanup(UCLN_I18N_PLURAL_RULE, pluralRules_cleanup);
+    U_ASSERT(gPluralRulesCache == NULL);
+    gPluralRulesCache = new LRUCache(PLURAL_RULES_CACHE_CAPACITY, uprv_deleteUObject, status);
+    if (gPluralRulesCache == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+    } else if (U_FAILURE(status)) {
+        delete gPluralRulesCache;
+        gPluralRulesCache = NULL;
+    }
+}
+
 #define ARRAY_SIZE(array) (int32_t)(sizeof array  / sizeof array[0])
 
 static const UChar PLURAL_KEYWORD_OTHER[]={LOW_O,LOW_T,LOW_H,LOW_E,LOW_R,0};
@@ -154,6 +185,24 @@ PluralRules::forLocale(const Locale& locale, UPluralType type, UErrorCode& statu
         status = U_ILLEGAL_ARGUMENT_ERROR;
         return NULL;
     }
+
+    // The cache key is the type, then the locale ID.
+    UErrorCode cacheStatus = U_ZERO_ERROR;
+    umtx_initOnce(gPluralRulesCacheInitOnce, &initPluralRulesCache, cacheStatus);
+    UnicodeString key((UChar)(0x30 + type));
+    key.append(UnicodeString(locale.getName(), -1, US_INV));
+    if (U_SUCCESS(cacheStatus)) {
+        Mutex lock(&gPluralRulesCacheLock);
+        const PluralRules *cached = (const PluralRules *)gPluralRulesCache->get(key);
+        if (cached != NULL) {
+            PluralRules *newObj = cached->clone();
+            if (newObj == NULL) {
+                status = U_MEMORY_ALLOCATION_ERROR;
+            }
+            return newObj;
+        }
+    }
+
     PluralRules *newObj = new PluralRules(status);
     if (newObj==NULL || U_FAILURE(status)) {
         delete newObj;
@@ -174,9 +223,27 @@ PluralRules::forLocale(const Locale& locale, UPluralType type, UErrorCode& statu
         newObj->addRules(rChain);
     }
 
+    if (U_SUCCESS(cacheStatus) && U_SUCCESS(status)) {
+        PluralRules *copy = newObj->clone();
+        if (copy != NULL) {
+            Mutex lock(&gPluralRulesCacheLock);
+            gPluralRulesCache->put(key, copy, cacheStatus);
+        }
+    }
     return newObj;
 }
 
+void U_EXPORT2
+PluralRules::getCacheStatistics(int32_t& hits, int32_t& misses) {
+    hits = misses = 0;
+    UErrorCode status = U_ZERO_ERROR;
+    umtx_initOnce(gPluralRulesCacheInitOnce, &initPluralRulesCache, status);
+    if (U_SUCCESS(status)) {
+        Mutex lock(&gPluralRulesCacheLock);
+        gPluralRulesCache->getStatistics(hits, misses);
+    }
+}
+
 UnicodeString
 PluralRules::select(int32_t number) const {
     if (mRules == NULL) {
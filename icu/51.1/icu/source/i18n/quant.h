@@ -1,6 +1,6 @@
 /*
  **********************************************************************
- * Copyright (C) 2001-2011, International Business Machines Corporation
+ * Copyright (C) 2001-2013, International Business Machines Corporation
  * and others. All Rights Reserved.
  **********************************************************************
  *   Date        Name        Description
@@ -115,6 +115,8 @@ class Quantifier : public UnicodeFunctor, public UnicodeMatcher {
     uint32_t minCount;
 
     uint32_t maxCount;
+
+    friend class TransliterationRuleCache;
 };
 
 U_NAMESPACE_END
@@ -0,0 +1,907 @@
+/*
+**********************************************************************
+* Copyright (C) 2013, International Business Machines Corporation
+* and others. All Rights Reserved.
+**********************************************************************
+*/
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_TRANSLITERATION
+
+#include "unicode/translit.h"
+#include "unicode/uchar.h"
+#include "unicode/udata.h"
+#include "unicode/uniset.h"
+#include "unicode/usetiter.h"
+#include "rbt_cache.h"
+#include "rbt_data.h"
+#include "rbt_pars.h"
+#include "rbt_rule.h"
+#include "strmatch.h"
+#include "strrepl.h"
+#include "quant.h"
+#include "funcrepl.h"
+#include "charstr.h"
+#include "cmemory.h"
+#include "cstring.h"
+#include "ucmndata.h"
+#include "udatamem.h"
+#include "umutex.h"
+#include "ustr_imp.h"
+#include "uvectr32.h"
+
+#if !UCONFIG_NO_FILE_IO
+#include <stdio.h>
+#endif
+
+#define RBT_CACHE_TYPE "rbtc"
+
+/* The data format "RbtC" */
+static const uint8_t RBT_CACHE_FORMAT[4] = { 0x52, 0x62, 0x74, 0x43 };
+
+/* The header written in front of the compiled rules, rounded up to 16 bytes */
+#define RBT_CACHE_HEADER_SIZE 32
+
+static char *gCacheDirectory = NULL;
+
+static UMutex gCacheMutex = U_MUTEX_INITIALIZER;
+
+U_CDECL_BEGIN
+static UBool U_CALLCONV
+isAcceptable(void * /* context */,
+             const char * /* type */, const char * /* name */,
+             const UDataInfo *pInfo) {
+    // Sets in the compiled rules depend on the Unicode properties, and the
+    // layout of the rule data on this ICU version.
+    UVersionInfo unicodeVersion;
+    u_getUnicodeVersion(unicodeVersion);
+    return
+        pInfo->size>=20 &&
+        pInfo->isBigEndian==U_IS_BIG_ENDIAN &&
+        pInfo->charsetFamily==U_CHARSET_FAMILY &&
+        pInfo->sizeofUChar==U_SIZEOF_UCHAR &&
+        uprv_memcmp(pInfo->dataFormat, RBT_CACHE_FORMAT, 4)==0 &&
+        pInfo->formatVersion[0]==1 &&
+        pInfo->formatVersion[1]==U_ICU_VERSION_MAJOR_NUM &&
+        pInfo->formatVersion[2]==U_ICU_VERSION_MINOR_NUM &&
+        uprv_memcmp(pInfo->dataVersion, unicodeVersion, sizeof(UVersionInfo))==0;
+}
+U_CDECL_END
+
+U_NAMESPACE_BEGIN
+
+/**
+ * Functor types in the compiled rules.  These are the types that
+ * TransliteratorParser creates.
+ */
+enum {
+    kNullFunctor = 0,
+    kUnicodeSet,
+    kStringMatcher,
+    kQuantifier,
+    kFunctionReplacer,
+    kStringReplacer
+};
+
+/**
+ * Reads the 32-bit words of the compiled rules.  All reads are bounds
+ * checked, so that a damaged file is rejected rather than trusted.
+ */
+struct RBTCacheReader {
+    const int32_t *p;
+    const int32_t *limit;
+
+    UBool readInt(int32_t &value) {
+        if (p >= limit) {
+            return FALSE;
+        }
+        value = *p++;
+        return TRUE;
+    }
+
+    /**
+     * Reads a count of items that take at least minWords words each.
+     */
+    UBool readCount(int32_t &count, int32_t minWords) {
+        return readInt(count) && count >= 0 &&
+            (minWords == 0 || count <= (limit - p) / minWords);
+    }
+};
+
+//----------------------------------------------------------------------
+// Cache directory and files
+//----------------------------------------------------------------------
+
+void TransliterationRuleCache::setDirectory(const char *path, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    char *newDirectory = NULL;
+    if (path != NULL && *path != 0) {
+        int32_t length = (int32_t)uprv_strlen(path);
+        newDirectory = (char *)uprv_malloc(length + 2);
+        if (newDirectory == NULL) {
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return;
+        }
+        uprv_strcpy(newDirectory, path);
+        // udata_openChoice() looks for individual files only when
+        // the path ends with a separator.
+        if (newDirectory[length - 1] != U_FILE_SEP_CHAR) {
+            newDirectory[length++] = U_FILE_SEP_CHAR;
+            newDirectory[length] = 0;
+        }
+    }
+    umtx_lock(&gCacheMutex);
+    char *oldDirectory = gCacheDirectory;
+    gCacheDirectory = newDirectory;
+    umtx_unlock(&gCacheMutex);
+    uprv_free(oldDirectory);
+}
+
+void TransliterationRuleCache::cleanup() {
+    uprv_free(gCacheDirectory);
+    gCacheDirectory = NULL;
+}
+
+/**
+ * The file name is "rbt", the hash and length of the rules in hex, and
+ * 'f' or 'r' for the direction.  The rules themselves are stored in the
+ * file too, so a hash collision is only a cache miss.
+ */
+void TransliterationRuleCache::getFileName(const UnicodeString &rules,
+                                           UTransDirection direction,
+                                           char *name) {
+    static const char hexDigits[] = "0123456789abcdef";
+    uint32_t hash = (uint32_t)ustr_hashUCharsN(rules.getBuffer(), rules.length());
+    uint32_t length = (uint32_t)rules.length();
+    char *p = name;
+    *p++ = 'r';
+    *p++ = 'b';
+    *p++ = 't';
+    for (int32_t shift = 28; shift >= 0; shift -= 4) {
+        *p++ = hexDigits[(hash >> shift) & 0xf];
+    }
+    *p++ = '_';
+    for (int32_t shift = 28; shift >= 0; shift -= 4) {
+        *p++ = hexDigits[(length >> shift) & 0xf];
+    }
+    *p++ = (direction == UTRANS_FORWARD) ? 'f' : 'r';
+    *p = 0;
+}
+
+static void resetParser(TransliteratorParser &parser) {
+    while (!parser.dataVector.isEmpty()) {
+        delete (TransliterationRuleData*)(parser.dataVector.orphanElementAt(0));
+    }
+    parser.idBlockVector.removeAllElements();
+    delete parser.compoundFilter;
+    parser.compoundFilter = NULL;
+}
+
+UBool TransliterationRuleCache::load(const UnicodeString &rules, UTransDirection direction,
+                                     TransliteratorParser &parser, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return FALSE;
+    }
+    CharString path;
+    UErrorCode localStatus = U_ZERO_ERROR;
+    umtx_lock(&gCacheMutex);
+    if (gCacheDirectory != NULL) {
+        path.append(gCacheDirectory, -1, localStatus);
+    }
+    umtx_unlock(&gCacheMutex);
+    if (path.isEmpty() || U_FAILURE(localStatus)) {
+        return FALSE;
+    }
+
+    char name[32];
+    getFileName(rules, direction, name);
+    UDataMemory *memory = udata_openChoice(path.data(), RBT_CACHE_TYPE, name,
+                                           isAcceptable, NULL, &localStatus);
+    if (U_FAILURE(localStatus)) {
+        return FALSE;
+    }
+
+    // The first word is the number of words that follow.
+    const int32_t *words = (const int32_t *)udata_getMemory(memory);
+    int32_t length = udata_getLength(memory);
+    UBool found = FALSE;
+    if (length < 0 || (length >= 4 && words[0] >= 0 && words[0] <= length / 4 - 1)) {
+        found = deserialize(words + 1, words[0], rules, direction, parser, localStatus);
+    }
+    udata_close(memory);
+
+    // Anything wrong with the file is a cache miss; the caller parses the rules.
+    if (!found || U_FAILURE(localStatus)) {
+        resetParser(parser);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void TransliterationRuleCache::store(const UnicodeString &rules, UTransDirection direction,
+                                     const TransliteratorParser &parser) {
+#if !UCONFIG_NO_FILE_IO
+    UErrorCode status = U_ZERO_ERROR;
+    CharString fileName;
+    umtx_lock(&gCacheMutex);
+    if (gCacheDirectory != NULL) {
+        fileName.append(gCacheDirectory, -1, status);
+    }
+    umtx_unlock(&gCacheMutex);
+    if (fileName.isEmpty() || U_FAILURE(status)) {
+        return;
+    }
+
+    UVector32 words(status);
+    words.addElement(0, status); // the word count, set below
+    serialize(rules, direction, parser, words, status);
+    if (U_FAILURE(status)) {
+        return;
+    }
+    words.setElementAt(words.size() - 1, 0);
+
+    uint8_t header[RBT_CACHE_HEADER_SIZE];
+    uprv_memset(header, 0, sizeof(header));
+    DataHeader *dataHeader = (DataHeader *)header;
+    dataHeader->dataHeader.headerSize = RBT_CACHE_HEADER_SIZE;
+    dataHeader->dataHeader.magic1 = 0xda;
+    dataHeader->dataHeader.magic2 = 0x27;
+    UDataInfo &info = dataHeader->info;
+    info.size = sizeof(UDataInfo);
+    info.isBigEndian = U_IS_BIG_ENDIAN;
+    info.charsetFamily = U_CHARSET_FAMILY;
+    info.sizeofUChar = U_SIZEOF_UCHAR;
+    uprv_memcpy(info.dataFormat, RBT_CACHE_FORMAT, 4);
+    info.formatVersion[0] = 1;
+    info.formatVersion[1] = U_ICU_VERSION_MAJOR_NUM;
+    info.formatVersion[2] = U_ICU_VERSION_MINOR_NUM;
+    u_getUnicodeVersion(info.dataVersion);
+
+    char name[32];
+    getFileName(rules, direction, name);
+    fileName.append(name, -1, status).append('.', status).append(RBT_CACHE_TYPE, -1, status);
+    CharString tempName;
+    tempName.append(fileName, status).append(".tmp", -1, status);
+    if (U_FAILURE(status)) {
+        return;
+    }
+
+    // Write a temporary file and rename it, so that no other process
+    // maps a partly written file.
+    FILE *file = fopen(tempName.data(), "wb");
+    if (file == NULL) {
+        return;
+    }
+    size_t count = (size_t)words.size();
+    UBool ok =
+        fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+        fwrite(words.getBuffer(), sizeof(int32_t), count, file) == count;
+    if (fclose(file) != 0) {
+        ok = FALSE;
+    }
+    if (!ok || rename(tempName.data(), fileName.data()) != 0) {
+        remove(tempName.data());
+    }
+#else
+    (void)rules;
+    (void)direction;
+    (void)parser;
+#endif
+}
+
+//----------------------------------------------------------------------
+// Writing
+//----------------------------------------------------------------------
+
+/**
+ * Serialized layout, in 32-bit words:
+ *
+ *   direction, rules (string)
+ *   ID block count, ID blocks (strings)
+ *   compound filter flag, [compound filter (set)]
+ *   data count, data objects
+ *
+ * A string is its length followed by its UChars, two per word.  A set
+ * is its range count and ranges, followed by its string count and
+ * strings.  See writeData() and writeFunctor() for the rest.
+ */
+void TransliterationRuleCache::serialize(const UnicodeString &rules, UTransDirection direction,
+                                         const TransliteratorParser &parser,
+                                         UVector32 &dest, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    int32_t i;
+    dest.addElement(direction, status);
+    writeString(rules, dest, status);
+
+    dest.addElement(parser.idBlockVector.size(), status);
+    for (i = 0; i < parser.idBlockVector.size(); i++) {
+        writeString(*(const UnicodeString *)parser.idBlockVector.elementAt(i), dest, status);
+    }
+
+    dest.addElement(parser.compoundFilter != NULL, status);
+    if (parser.compoundFilter != NULL) {
+        writeSet(*parser.compoundFilter, dest, status);
+    }
+
+    const TransliterationRuleData *first = NULL;
+    dest.addElement(parser.dataVector.size(), status);
+    for (i = 0; i < parser.dataVector.size() && U_SUCCESS(status); i++) {
+        const TransliterationRuleData *data = (const TransliterationRuleData *)parser.dataVector.elementAt(i);
+        writeData(*data, first, dest, status);
+        if (first == NULL) {
+            first = data;
+        }
+    }
+}
+
+void TransliterationRuleCache::writeString(const UnicodeString &s, UVector32 &dest, UErrorCode &status) {
+    int32_t length = s.length();
+    const UChar *p = s.getBuffer();
+    dest.addElement(length, status);
+    for (int32_t i = 0; i < length; i += 2) {
+        uint32_t word = p[i];
+        if (i + 1 < length) {
+            word |= (uint32_t)p[i + 1] << 16;
+        }
+        dest.addElement((int32_t)word, status);
+    }
+}
+
+void TransliterationRuleCache::writeSet(const UnicodeSet &set, UVector32 &dest, UErrorCode &status) {
+    int32_t rangeCount = set.getRangeCount();
+    dest.addElement(rangeCount, status);
+    for (int32_t i = 0; i < rangeCount; i++) {
+        dest.addElement(set.getRangeStart(i), status);
+        dest.addElement(set.getRangeEnd(i), status);
+    }
+
+    int32_t stringCountIndex = dest.size();
+    int32_t stringCount = 0;
+    dest.addElement(0, status);
+    UnicodeSetIterator it(set);
+    while (it.nextRange()) {
+        if (it.isString()) {
+            writeString(it.getString(), dest, status);
+            ++stringCount;
+        }
+    }
+    if (U_SUCCESS(status)) {
+        dest.setElementAt(stringCount, stringCountIndex);
+    }
+}
+
+/**
+ * UnicodeSet: the set.
+ * StringMatcher: pattern (string), segment number.
+ * Quantifier: minimum and maximum count, matcher (functor).
+ * FunctionReplacer: transliterator ID (string), filter flag,
+ *   [filter (set)], replacer (functor).
+ * StringReplacer: output (string), cursor position, has cursor.
+ */
+void TransliterationRuleCache::writeFunctor(const UnicodeFunctor *f, UVector32 &dest, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    if (f == NULL) {
+        dest.addElement(kNullFunctor, status);
+        return;
+    }
+    UClassID id = f->getDynamicClassID();
+    if (id == UnicodeSet::getStaticClassID()) {
+        dest.addElement(kUnicodeSet, status);
+        writeSet(*(const UnicodeSet *)f, dest, status);
+    } else if (id == StringMatcher::getStaticClassID()) {
+        const StringMatcher *m = (const StringMatcher *)f;
+        dest.addElement(kStringMatcher, status);
+        writeString(m->pattern, dest, status);
+        dest.addElement(m->segmentNumber, status);
+    } else if (id == Quantifier::getStaticClassID()) {
+        const Quantifier *q = (const Quantifier *)f;
+        dest.addElement(kQuantifier, status);
+        dest.addElement((int32_t)q->minCount, status);
+        dest.addElement((int32_t)q->maxCount, status);
+        writeFunctor(q->matcher, dest, status);
+    } else if (id == FunctionReplacer::getStaticClassID()) {
+        const FunctionReplacer *r = (const FunctionReplacer *)f;
+        const UnicodeFilter *filter = r->translit->getFilter();
+        dest.addElement(kFunctionReplacer, status);
+        writeString(r->translit->getID(), dest, status);
+        if (filter == NULL) {
+            dest.addElement(0, status);
+        } else if (filter->getDynamicClassID() == UnicodeSet::getStaticClassID()) {
+            dest.addElement(1, status);
+            writeSet(*(const UnicodeSet *)filter, dest, status);
+        } else {
+            status = U_UNSUPPORTED_ERROR;
+            return;
+        }
+        writeFunctor(r->replacer, dest, status);
+    } else if (id == StringReplacer::getStaticClassID()) {
+        const StringReplacer *r = (const StringReplacer *)f;
+        dest.addElement(kStringReplacer, status);
+        writeString(r->output, dest, status);
+        dest.addElement(r->cursorPos, status);
+        dest.addElement(r->hasCursor, status);
+    } else {
+        status = U_UNSUPPORTED_ERROR;
+    }
+}
+
+/**
+ * Data layout:
+ *
+ *   variables base, variables length, shared flag,
+ *   [variables (functors), unless they are those of the first data object]
+ *   variable name count, names and values (strings)
+ *   rule count, rules in the order they were added:
+ *     pattern (string), ante context length, key length, flags,
+ *     output (string), cursor position,
+ *     segment count, segments (indexes into the variables)
+ *   index[0..256], rule array (indexes into the rules)
+ *   maximum context length
+ */
+void TransliterationRuleCache::writeData(const TransliterationRuleData &data,
+                                         const TransliterationRuleData *first,
+                                         UVector32 &dest, UErrorCode &status) {
+    int32_t i;
+    dest.addElement(data.variablesBase, status);
+    dest.addElement(data.variablesLength, status);
+    // TransliteratorParser gives all data objects the variables of the first one.
+    UBool shared = first != NULL && !data.variablesAreOwned &&
+        first->variablesLength == data.variablesLength;
+    for (i = 0; shared && i < data.variablesLength; i++) {
+        shared = data.variables[i] == first->variables[i];
+    }
+    dest.addElement(shared, status);
+    if (!shared) {
+        if (!data.variablesAreOwned) {
+            status = U_UNSUPPORTED_ERROR;
+            return;
+        }
+        for (i = 0; i < data.variablesLength; i++) {
+            writeFunctor(data.variables[i], dest, status);
+        }
+    }
+
+    dest.addElement(data.variableNames.count(), status);
+    int32_t pos = -1;
+    const UHashElement *e;
+    while ((e = data.variableNames.nextElement(pos)) != NULL) {
+        writeString(*(const UnicodeString *)e->key.pointer, dest, status);
+        writeString(*(const UnicodeString *)e->value.pointer, dest, status);
+    }
+
+    const TransliterationRuleSet &ruleSet = data.ruleSet;
+    int32_t ruleCount = ruleSet.ruleVector->size();
+    dest.addElement(ruleCount, status);
+    for (int32_t r = 0; r < ruleCount && U_SUCCESS(status); r++) {
+        const TransliterationRule *rule = (const TransliterationRule *)ruleSet.ruleVector->elementAt(r);
+        const StringReplacer *output = (const StringReplacer *)rule->output;
+        if (rule->output->getDynamicClassID() != StringReplacer::getStaticClassID() ||
+            !output->hasCursor) {
+            status = U_UNSUPPORTED_ERROR;
+            return;
+        }
+        writeString(rule->pattern, dest, status);
+        dest.addElement(rule->anteContextLength, status);
+        dest.addElement(rule->keyLength, status);
+        dest.addElement(rule->flags, status);
+        writeString(output->output, dest, status);
+        dest.addElement(output->cursorPos, status);
+        dest.addElement(rule->segmentsCount, status);
+        for (int32_t s = 0; s < rule->segmentsCount; s++) {
+            for (i = 0; i < data.variablesLength && data.variables[i] != rule->segments[s]; i++) {}
+            if (i == data.variablesLength) {
+                status = U_UNSUPPORTED_ERROR;
+                return;
+            }
+            dest.addElement(i, status);
+        }
+    }
+
+    for (i = 0; i <= 256; i++) {
+        dest.addElement(ruleSet.index[i], status);
+    }
+    // Each bin holds its rules in the order they were added, so one
+    // pass over the rule vector per bin finds their indexes.
+    for (int32_t bin = 0; bin < 256 && U_SUCCESS(status); bin++) {
+        int32_t r = 0;
+        for (int32_t j = ruleSet.index[bin]; j < ruleSet.index[bin + 1]; j++, r++) {
+            while (r < ruleCount && ruleSet.ruleVector->elementAt(r) != ruleSet.rules[j]) {
+                r++;
+            }
+            if (r == ruleCount) {
+                status = U_UNSUPPORTED_ERROR;
+                return;
+            }
+            dest.addElement(r, status);
+        }
+    }
+    dest.addElement(ruleSet.maxContextLength, status);
+}
+
+//----------------------------------------------------------------------
+// Reading
+//----------------------------------------------------------------------
+
+UBool TransliterationRuleCache::deserialize(const int32_t *words, int32_t length,
+                                            const UnicodeString &rules, UTransDirection direction,
+                                            TransliteratorParser &parser, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return FALSE;
+    }
+    RBTCacheReader in = { words, words + length };
+    int32_t i, value, count;
+    UnicodeString cachedRules;
+    if (!in.readInt(value) || value != direction ||
+        !readString(in, cachedRules) || cachedRules != rules) {
+        return FALSE;
+    }
+
+    resetParser(parser);
+    if (!in.readCount(count, 1)) {
+        status = U_INVALID_FORMAT_ERROR;
+        return FALSE;
+    }
+    for (i = 0; i < count; i++) {
+        UnicodeString *idBlock = new UnicodeString();
+        if (idBlock == NULL) {
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return FALSE;
+        }
+        if (!readString(in, *idBlock)) {
+            delete idBlock;
+            status = U_INVALID_FORMAT_ERROR;
+            return FALSE;
+        }
+        parser.idBlockVector.addElement(idBlock, status);
+        if (U_FAILURE(status)) {
+            delete idBlock;
+            return FALSE;
+        }
+    }
+
+    if (!in.readInt(value)) {
+        status = U_INVALID_FORMAT_ERROR;
+        return FALSE;
+    }
+    if (value != 0) {
+        parser.compoundFilter = readSet(in, status);
+        if (U_FAILURE(status)) {
+            return FALSE;
+        }
+    }
+
+    if (!in.readCount(count, 1)) {
+        status = U_INVALID_FORMAT_ERROR;
+        return FALSE;
+    }
+    const TransliterationRuleData *first = NULL;
+    for (i = 0; i < count; i++) {
+        TransliterationRuleData *data = readData(in, first, status);
+        if (U_FAILURE(status)) {
+            delete data;
+            return FALSE;
+        }
+        parser.dataVector.addElement(data, status);
+        if (U_FAILURE(status)) {
+            delete data;
+            return FALSE;
+        }
+        if (first == NULL) {
+            first = data;
+        }
+    }
+    return in.p == in.limit;
+}
+
+UBool TransliterationRuleCache::readString(RBTCacheReader &in, UnicodeString &s) {
+    int32_t length;
+    if (!in.readInt(length) || length < 0 || (length + 1) / 2 > in.limit - in.p) {
+        return FALSE;
+    }
+    UChar *buffer = s.getBuffer(length);
+    if (buffer == NULL) {
+        return FALSE;
+    }
+    for (int32_t i = 0; i < length; i += 2) {
+        uint32_t word = (uint32_t)*in.p++;
+        buffer[i] = (UChar)word;
+        if (i + 1 < length) {
+            buffer[i + 1] = (UChar)(word >> 16);
+        }
+    }
+    s.releaseBuffer(length);
+    return TRUE;
+}
+
+UnicodeSet *TransliterationRuleCache::readSet(RBTCacheReader &in, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return NULL;
+    }
+    UnicodeSet *set = new UnicodeSet();
+    if (set == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    int32_t count, start, end;
+    UBool ok = in.readCount(count, 2);
+    for (int32_t i = 0; ok && i < count; i++) {
+        ok = in.readInt(start) && in.readInt(end) &&
+            0 <= start && start <= end && end <= 0x10ffff;
+        if (ok) {
+            set->add(start, end);
+        }
+    }
+    ok = ok && in.readCount(count, 1);
+    for (int32_t i = 0; ok && i < count; i++) {
+        UnicodeString s;
+        ok = readString(in, s);
+        if (ok) {
+            set->add(s);
+        }
+    }
+    if (!ok || set->isBogus()) {
+        status = ok ? U_MEMORY_ALLOCATION_ERROR : U_INVALID_FORMAT_ERROR;
+        delete set;
+        return NULL;
+    }
+    return set;
+}
+
+UnicodeFunctor *TransliterationRuleCache::readFunctor(RBTCacheReader &in,
+                                                      const TransliterationRuleData *data,
+                                                      UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return NULL;
+    }
+    int32_t type, value, value2;
+    UnicodeString s;
+    UnicodeFunctor *f = NULL;
+    if (!in.readInt(type)) {
+        status = U_INVALID_FORMAT_ERROR;
+        return NULL;
+    }
+    switch (type) {
+    case kNullFunctor:
+        return NULL;
+    case kUnicodeSet:
+        return readSet(in, status);
+    case kStringMatcher:
+        if (!readString(in, s) || !in.readInt(value)) {
+            status = U_INVALID_FORMAT_ERROR;
+            return NULL;
+        }
+        f = new StringMatcher(s, 0, s.length(), value, *data);
+        break;
+    case kQuantifier:
+        {
+            if (!in.readInt(value) || !in.readInt(value2)) {
+                status = U_INVALID_FORMAT_ERROR;
+                return NULL;
+            }
+            UnicodeFunctor *matcher = readFunctor(in, data, status);
+            if (U_FAILURE(status) || matcher == NULL) {
+                if (U_SUCCESS(status)) {
+                    status = U_INVALID_FORMAT_ERROR;
+                }
+                return NULL;
+            }
+            f = new Quantifier(matcher, (uint32_t)value, (uint32_t)value2);
+            if (f == NULL) {
+                delete matcher;
+            }
+        }
+        break;
+    case kFunctionReplacer:
+        {
+            UnicodeSet *filter = NULL;
+            if (!readString(in, s) || !in.readInt(value)) {
+                status = U_INVALID_FORMAT_ERROR;
+                return NULL;
+            }
+            if (value != 0) {
+                filter = readSet(in, status);
+            }
+            UnicodeFunctor *replacer = readFunctor(in, data, status);
+            if (U_SUCCESS(status) && replacer == NULL) {
+                status = U_INVALID_FORMAT_ERROR;
+            }
+            UParseError pe;
+            Transliterator *t = Transliterator::createInstance(s, UTRANS_FORWARD, pe, status);
+            if (U_SUCCESS(status)) {
+                if (filter != NULL) {
+                    t->adoptFilter(filter);
+                    filter = NULL;
+                }
+                f = new FunctionReplacer(t, replacer);
+                if (f != NULL) {
+                    return f;
+                }
+                status = U_MEMORY_ALLOCATION_ERROR;
+            }
+            delete t;
+            delete replacer;
+            delete filter;
+            return NULL;
+        }
+    case kStringReplacer:
+        if (!readString(in, s) || !in.readInt(value) || !in.readInt(value2)) {
+            status = U_INVALID_FORMAT_ERROR;
+            return NULL;
+        }
+        if (value2 != 0) {
+            f = new StringReplacer(s, value, data);
+        } else {
+            f = new StringReplacer(s, data);
+        }
+        break;
+    default:
+        status = U_INVALID_FORMAT_ERROR;
+        return NULL;
+    }
+    if (f == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+    }
+    return f;
+}
+
+TransliterationRuleData *TransliterationRuleCache::readData(RBTCacheReader &in,
+                                                            const TransliterationRuleData *first,
+                                                            UErrorCode &status) {
+    TransliterationRuleData *data = new TransliterationRuleData(status);
+    if (data == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    if (U_FAILURE(status)) {
+        return data;
+    }
+
+    int32_t i, base, length, shared, count;
+    if (!in.readInt(base) || base < 0 || base > 0xffff ||
+        !in.readCount(length, 0) || !in.readInt(shared) ||
+        (shared && (first == NULL || first->variablesLength != length)) ||
+        (!shared && length > in.limit - in.p)) {
+        status = U_INVALID_FORMAT_ERROR;
+        return data;
+    }
+    data->variablesBase = (UChar)base;
+    if (length > 0) {
+        data->variables = (UnicodeFunctor **)uprv_malloc(length * sizeof(UnicodeFunctor *));
+        if (data->variables == NULL) {
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return data;
+        }
+        if (shared) {
+            uprv_memcpy(data->variables, first->variables, length * sizeof(UnicodeFunctor *));
+            data->variablesAreOwned = FALSE;
+        } else {
+            uprv_memset(data->variables, 0, length * sizeof(UnicodeFunctor *));
+        }
+        data->variablesLength = length;
+        for (i = 0; !shared && i < length && U_SUCCESS(status); i++) {
+            data->variables[i] = readFunctor(in, data, status);
+        }
+        if (U_FAILURE(status)) {
+            return data;
+        }
+    }
+
+    if (!in.readCount(count, 2)) {
+        status = U_INVALID_FORMAT_ERROR;
+        return data;
+    }
+    for (i = 0; i < count; i++) {
+        UnicodeString name;
+        UnicodeString *value = new UnicodeString();
+        if (value == NULL) {
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return data;
+        }
+        if (!readString(in, name) || !readString(in, *value)) {
+            delete value;
+            status = U_INVALID_FORMAT_ERROR;
+            return data;
+        }
+        data->variableNames.put(name, value, status);
+        if (U_FAILURE(status)) {
+            return data;
+        }
+    }
+
+    TransliterationRuleSet &ruleSet = data->ruleSet;
+    int32_t ruleCount;
+    if (!in.readCount(ruleCount, 8)) {
+        status = U_INVALID_FORMAT_ERROR;
+        return data;
+    }
+    for (int32_t r = 0; r < ruleCount; r++) {
+        UnicodeString pattern, output;
+        int32_t anteContextLength, keyLength, flags, cursorPos, segmentsCount;
+        if (!readString(in, pattern) ||
+            !in.readInt(anteContextLength) || !in.readInt(keyLength) || !in.readInt(flags) ||
+            !readString(in, output) || !in.readInt(cursorPos) ||
+            !in.readCount(segmentsCount, 1) ||
+            anteContextLength < 0 || keyLength < 0 ||
+            anteContextLength > pattern.length() - keyLength) {
+            status = U_INVALID_FORMAT_ERROR;
+            return data;
+        }
+        UnicodeFunctor **segments = NULL;
+        if (segmentsCount > 0) {
+            segments = (UnicodeFunctor **)uprv_malloc(segmentsCount * sizeof(UnicodeFunctor *));
+            if (segments == NULL) {
+                status = U_MEMORY_ALLOCATION_ERROR;
+                return data;
+            }
+            for (int32_t s = 0; s < segmentsCount; s++) {
+                int32_t v;
+                if (!in.readInt(v) || v < 0 || v >= data->variablesLength) {
+                    uprv_free(segments);
+                    status = U_INVALID_FORMAT_ERROR;
+                    return data;
+                }
+                segments[s] = data->variables[v];
+            }
+        }
+        // A cursor position of 0 with the offset gives the output the
+        // stored cursor position, which may lie outside of the output.
+        TransliterationRule *rule = new TransliterationRule(
+            pattern, anteContextLength, anteContextLength + keyLength,
+            output, 0, cursorPos, segments, segmentsCount,
+            (flags & TransliterationRule::ANCHOR_START) != 0,
+            (flags & TransliterationRule::ANCHOR_END) != 0,
+            data, status);
+        if (rule == NULL) {
+            uprv_free(segments);
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return data;
+        }
+        ruleSet.addRule(rule, status);
+        if (U_FAILURE(status)) {
+            return data;
+        }
+    }
+
+    // Restore the index built by TransliterationRuleSet::freeze().
+    int32_t *index = ruleSet.index;
+    for (i = 0; i <= 256; i++) {
+        if (!in.readInt(index[i]) || index[i] < (i == 0 ? 0 : index[i - 1])) {
+            status = U_INVALID_FORMAT_ERROR;
+            return data;
+        }
+    }
+    if (index[0] != 0 || index[256] > in.limit - in.p) {
+        status = U_INVALID_FORMAT_ERROR;
+        return data;
+    }
+    if (index[256] > 0) {
+        ruleSet.rules = (TransliterationRule **)uprv_malloc(index[256] * sizeof(TransliterationRule *));
+        if (ruleSet.rules == NULL) {
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return data;
+        }
+        for (i = 0; i < index[256]; i++) {
+            int32_t r;
+            if (!in.readInt(r) || r < 0 || r >= ruleCount) {
+                status = U_INVALID_FORMAT_ERROR;
+                return data;
+            }
+            ruleSet.rules[i] = (TransliterationRule *)ruleSet.ruleVector->elementAt(r);
+        }
+    }
+    if (!in.readInt(ruleSet.maxContextLength)) {
+        status = U_INVALID_FORMAT_ERROR;
+    }
+    return data;
+}
+
+U_NAMESPACE_END
+
+#endif /* #if !UCONFIG_NO_TRANSLITERATION */
@@ -0,0 +1,116 @@
+/*
+**********************************************************************
+* Copyright (C) 2013, International Business Machines Corporation
+* and others. All Rights Reserved.
+**********************************************************************
+*/
+#ifndef RBT_CACHE_H
+#define RBT_CACHE_H
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_TRANSLITERATION
+
+#include "unicode/uobject.h"
+#include "unicode/utrans.h"
+
+U_NAMESPACE_BEGIN
+
+class TransliteratorParser;
+class TransliterationRuleData;
+class UnicodeFunctor;
+class UnicodeSet;
+class UnicodeString;
+class UVector32;
+struct RBTCacheReader;
+
+/**
+ * A cache of compiled transliteration rules, kept as ICU data files.
+ *
+ * The result of parsing a set of rules with TransliteratorParser (the
+ * ID blocks, the compound filter and the TransliterationRuleData
+ * objects) is written to a binary file in the cache directory, named
+ * after a hash of the rules and the direction.  The next time the same
+ * rules are needed, possibly in another process, the file is mapped with
+ * udata_openChoice() and the rule data is rebuilt from it directly,
+ * without running the parser, the UnicodeSet pattern parser or the
+ * masking check of TransliterationRuleSet::freeze().
+ *
+ * The files are ordinary ICU data files with the data format "RbtC", so
+ * they may also be shipped in a data directory set with this class.
+ * Files written by a different ICU or Unicode version, or with
+ * different rules, are ignored and rewritten.
+ *
+ * There is no cache until setDirectory() is called.
+ */
+class TransliterationRuleCache /* not : public UObject because all methods are static */ {
+public:
+    /**
+     * Sets the directory used to load and store compiled rules, or
+     * turns the cache off if path is NULL or empty.
+     */
+    static void setDirectory(const char *path, UErrorCode &status);
+
+    /**
+     * Fills the parser's dataVector, idBlockVector and compoundFilter
+     * from the cache, as parser.parse(rules, direction, ...) would.
+     * @return TRUE if the compiled rules were found in the cache.
+     *         The parser must not be used unless TRUE is returned.
+     */
+    static UBool load(const UnicodeString &rules, UTransDirection direction,
+                      TransliteratorParser &parser, UErrorCode &status);
+
+    /**
+     * Writes the result of parser.parse(rules, direction, ...) to the
+     * cache.  Failures are ignored; the next load() will simply miss.
+     */
+    static void store(const UnicodeString &rules, UTransDirection direction,
+                      const TransliteratorParser &parser);
+
+    /**
+     * Releases the cache directory.  Called by the transliterator cleanup.
+     */
+    static void cleanup();
+
+    /**
+     * Serializes the parse result into 32-bit words.
+     * Fails with U_UNSUPPORTED_ERROR for data that has no binary form.
+     */
+    static void serialize(const UnicodeString &rules, UTransDirection direction,
+                          const TransliteratorParser &parser,
+                          UVector32 &dest, UErrorCode &status);
+
+    /**
+     * Rebuilds a parse result from words written by serialize().
+     * @return TRUE if the words hold the compiled form of these rules.
+     */
+    static UBool deserialize(const int32_t *words, int32_t length,
+                             const UnicodeString &rules, UTransDirection direction,
+                             TransliteratorParser &parser, UErrorCode &status);
+
+private:
+    static void writeString(const UnicodeString &s, UVector32 &dest, UErrorCode &status);
+    static void writeSet(const UnicodeSet &set, UVector32 &dest, UErrorCode &status);
+    static void writeFunctor(const UnicodeFunctor *f, UVector32 &dest, UErrorCode &status);
+    static void writeData(const TransliterationRuleData &data,
+                          const TransliterationRuleData *first,
+                          UVector32 &dest, UErrorCode &status);
+
+    static UBool readString(RBTCacheReader &in, UnicodeString &s);
+    static UnicodeSet *readSet(RBTCacheReader &in, UErrorCode &status);
+    static UnicodeFunctor *readFunctor(RBTCacheReader &in, const TransliterationRuleData *data,
+                                       UErrorCode &status);
+    static TransliterationRuleData *readData(RBTCacheReader &in,
+                                             const TransliterationRuleData *first,
+                                             UErrorCode &status);
+
+    static void getFileName(const UnicodeString &rules, UTransDirection direction, char *name);
+
+    TransliterationRuleCache(); // no instances
+};
+
+U_NAMESPACE_END
+
+#endif /* #if !UCONFIG_NO_TRANSLITERATION */
+
+#endif
@@ -1,5 +1,5 @@
 /*
-* Copyright (C) {1999-2001}, International Business Machines Corporation and others. All Rights Reserved.
+* Copyright (C) {1999-2013}, International Business Machines Corporation and others. All Rights Reserved.
 **********************************************************************
 *   Date        Name        Description
 *   11/17/99    aliu        Creation.
@@ -297,6 +297,7 @@ public:
  private:
 
     friend class StringMatcher;
+    friend class TransliterationRuleCache;
 
     TransliterationRule &operator=(const TransliterationRule &other); // forbid copying of this class
 };
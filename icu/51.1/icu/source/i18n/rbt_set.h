@@ -1,6 +1,6 @@
 /*
 **********************************************************************
-* Copyright (C) 1999-2007, International Business Machines Corporation
+* Copyright (C) 1999-2013, International Business Machines Corporation
 * and others. All Rights Reserved.
 **********************************************************************
 *   Date        Name        Description
@@ -155,6 +155,8 @@ public:
 
 private:
 
+    friend class TransliterationRuleCache;
+
     TransliterationRuleSet &operator=(const TransliterationRuleSet &other); // forbid copying of this class
 };
 
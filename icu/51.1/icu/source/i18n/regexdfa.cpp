@@ -0,0 +1,571 @@
+//
+//  regexdfa.cpp
+//
+//  Copyright (C) 2013, International Business Machines Corporation and others.
+//  All Rights Reserved.
+//
+//  This file contains class RegexDFA, a lazily constructed DFA used to
+//   prefilter the input to RegexMatcher::find().
+//
+//  The automaton is built from the compiled pattern.  Each op that the
+//   backtracking engine would execute becomes an NFA node; the DFA states
+//   are sets of NFA nodes, created as they are reached while scanning the
+//   input, and their transitions on Latin-1 characters are cached.
+//
+//  The DFA only ever answers "can a match end here", for a match beginning
+//   anywhere at or after the scan start.  Because the language it accepts is
+//   the regular language of the pattern, it accepts everything the
+//   backtracking engine could match, and so can safely rule input out.
+//
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_REGULAR_EXPRESSIONS
+
+#include "unicode/regex.h"
+#include "unicode/uniset.h"
+#include "unicode/uchar.h"
+#include "unicode/ustring.h"
+#include "unicode/utf16.h"
+#include "cmemory.h"
+#include "uassert.h"
+#include "uvector.h"
+#include "uvectr64.h"
+#include "regeximp.h"
+#include "regexdfa.h"
+
+U_NAMESPACE_BEGIN
+
+//
+//  The character tests of the NFA nodes.
+//
+enum {
+    TEST_NONE,          // The node consumes no input.
+    TEST_ACCEPT,        // The end of the pattern.  A match.
+    TEST_CHAR,          // value is the char.
+    TEST_CHAR_I,        // value is the case folded char.
+    TEST_SET,           // value is the index of a set from the pattern.
+    TEST_STATIC_SET,    // value is the index of a static set, plus the URX_NEG_SET flag.
+    TEST_DOT,           // value is one of the DOT_ values below.
+    TEST_DIGIT          // value is 0 for \d, 1 for \D
+};
+
+enum {
+    DOT_NORMAL,         // . does not match line endings.
+    DOT_UNIX,           // . does not match \n
+    DOT_ALL             // . matches everything.
+};
+
+struct RegexDFANode {
+    int32_t  test;      // The character test, one of the TEST_ values.
+    int32_t  value;
+    int32_t  next;      // The node after consuming a character that passes the test.
+    int32_t  eps1;      // Nodes reached without consuming input, or -1.
+    int32_t  eps2;
+};
+
+struct RegexDFAState {
+    int32_t  *nodes;         // The consuming and accepting nodes of the state, in order.
+    int32_t   nodeCount;
+    int32_t   hash;
+    UBool     accepting;
+    UChar32   lastWideChar;  // A one entry cache for chars outside of Latin-1.
+    int32_t   lastWideNext;
+    int32_t   next[256];     // Transitions on Latin-1 chars, or -1 if not yet known.
+};
+
+
+RegexDFA::RegexDFA(const RegexPattern *pattern, UErrorCode &status) {
+    fPattern       = pattern;
+    fUsable        = FALSE;
+    fNodes         = NULL;
+    fNodeCount     = 0;
+    fNodeCapacity  = 0;
+    fMarks         = NULL;
+    fGeneration    = 0;
+    fStack         = NULL;
+    fStates        = NULL;
+    fStateCount    = 0;
+    fStateCapacity = 0;
+    fLiteral       = NULL;
+    fLiteralLen    = 0;
+
+    if (U_FAILURE(status)) {
+        return;
+    }
+
+    fUsable = TRUE;
+    buildNodes(status);
+    if (!fUsable || U_FAILURE(status)) {
+        fUsable = FALSE;
+        return;
+    }
+
+    fMarks = (int32_t *)uprv_malloc(sizeof(int32_t) * fNodeCount);
+    fStack = (int32_t *)uprv_malloc(sizeof(int32_t) * fNodeCount);
+    if (fMarks == NULL || fStack == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+        fUsable = FALSE;
+        return;
+    }
+    uprv_memset(fMarks, 0, sizeof(int32_t) * fNodeCount);
+
+    // State 0 is the start state, the closure of the first op of the pattern.
+    //   A pattern that can match the empty string accepts everywhere,
+    //   and there is nothing to gain.
+    fGeneration++;
+    addClosure(0);
+    if (makeState() != 0 || fStates[0].accepting) {
+        fUsable = FALSE;
+        return;
+    }
+
+    // All matches may begin with a known literal, which can be searched for
+    //   directly while the automaton is in its start state.
+    if (fPattern->fStartType == START_STRING) {
+        fLiteral    = fPattern->fLiteralText.getBuffer() + fPattern->fInitialStringIdx;
+        fLiteralLen = fPattern->fInitialStringLen;
+    } else if (fPattern->fStartType == START_CHAR) {
+        U16_APPEND_UNSAFE(fCharBuf, fLiteralLen, fPattern->fInitialChar);
+        fLiteral = fCharBuf;
+    }
+}
+
+
+RegexDFA::~RegexDFA() {
+    for (int32_t i=0; i<fStateCount; i++) {
+        uprv_free(fStates[i].nodes);
+    }
+    uprv_free(fStates);
+    uprv_free(fStack);
+    uprv_free(fMarks);
+    uprv_free(fNodes);
+}
+
+
+UBool RegexDFA::isUsable() const {
+    return fUsable;
+}
+
+
+//
+//  addNode     Append a node, growing the node array as needed.
+//              Returns the index of the new node, or -1 on failure.
+//
+int32_t RegexDFA::addNode(int32_t test, int32_t value, int32_t next, int32_t eps1, int32_t eps2) {
+    if (fNodeCount >= fNodeCapacity) {
+        int32_t newCapacity = fNodeCapacity == 0 ? 64 : fNodeCapacity * 2;
+        if (newCapacity > MAX_NODES) {
+            newCapacity = MAX_NODES;
+        }
+        if (fNodeCount >= newCapacity) {
+            return -1;
+        }
+        RegexDFANode *newNodes = (RegexDFANode *)uprv_realloc(fNodes, sizeof(RegexDFANode) * newCapacity);
+        if (newNodes == NULL) {
+            return -1;
+        }
+        fNodes = newNodes;
+        fNodeCapacity = newCapacity;
+    }
+    RegexDFANode &node = fNodes[fNodeCount];
+    node.test  = test;
+    node.value = value;
+    node.next  = next;
+    node.eps1  = eps1;
+    node.eps2  = eps2;
+    return fNodeCount++;
+}
+
+
+//
+//  buildNodes   Translate the compiled pattern into NFA nodes.  Node n is the
+//               op at pattern index n; literal strings add a chain of nodes,
+//               one per char, after those.
+//               Clears fUsable if the pattern contains anything the automaton
+//               can not represent.
+//
+void RegexDFA::buildNodes(UErrorCode &status) {
+    const UVector64 *compiledPat = fPattern->fCompiledPat;
+    int32_t          patSize     = compiledPat->size();
+    const UChar     *litText     = fPattern->fLiteralText.getBuffer();
+    int32_t          pc;
+
+    if (patSize >= MAX_NODES) {
+        fUsable = FALSE;
+        return;
+    }
+    for (pc=0; pc<patSize; pc++) {
+        if (addNode(TEST_NONE, 0, -1, -1, -1) < 0) {
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return;
+        }
+    }
+
+    for (pc=0; pc<patSize && fUsable; pc++) {
+        int32_t op      = (int32_t)compiledPat->elementAti(pc);
+        int32_t opType  = URX_TYPE(op);
+        int32_t opValue = URX_VAL(op);
+
+        switch (opType) {
+        case URX_NOP:
+        case URX_START_CAPTURE:
+        case URX_END_CAPTURE:
+            fNodes[pc].eps1 = pc+1;
+            break;
+
+        case URX_JMP:
+            fNodes[pc].eps1 = opValue;
+            break;
+
+        case URX_STATE_SAVE:
+        case URX_JMP_SAV:
+            fNodes[pc].eps1 = pc+1;
+            fNodes[pc].eps2 = opValue;
+            break;
+
+        case URX_BACKTRACK:
+        case URX_FAIL:
+            // Never matches.  The node leads nowhere.
+            break;
+
+        case URX_END:
+            fNodes[pc].test = TEST_ACCEPT;
+            break;
+
+        case URX_ONECHAR:
+            fNodes[pc].test  = TEST_CHAR;
+            fNodes[pc].value = opValue;
+            fNodes[pc].next  = pc+1;
+            break;
+
+        case URX_ONECHAR_I:
+            fNodes[pc].test  = TEST_CHAR_I;
+            fNodes[pc].value = opValue;
+            fNodes[pc].next  = pc+1;
+            break;
+
+        case URX_STRING:
+            {
+                // The string length is in the following op, which is skipped.
+                int32_t lenOp = pc+1 < patSize ? (int32_t)compiledPat->elementAti(pc+1) : 0;
+                if (URX_TYPE(lenOp) != URX_STRING_LEN) {
+                    fUsable = FALSE;
+                    break;
+                }
+                const UChar *s      = litText + opValue;
+                int32_t      length = URX_VAL(lenOp);
+                int32_t      i      = 0;
+                int32_t      last   = pc;
+                UChar32      c;
+                U16_NEXT(s, i, length, c);
+                fNodes[pc].test  = TEST_CHAR;
+                fNodes[pc].value = c;
+                while (i < length) {
+                    U16_NEXT(s, i, length, c);
+                    int32_t n = addNode(TEST_CHAR, c, -1, -1, -1);
+                    if (n < 0) {
+                        fUsable = FALSE;
+                        break;
+                    }
+                    fNodes[last].next = n;
+                    last = n;
+                }
+                fNodes[last].next = pc+2;
+                pc++;
+            }
+            break;
+
+        case URX_SETREF:
+            fNodes[pc].test  = TEST_SET;
+            fNodes[pc].value = opValue;
+            fNodes[pc].next  = pc+1;
+            break;
+
+        case URX_STATIC_SETREF:
+            fNodes[pc].test  = TEST_STATIC_SET;
+            fNodes[pc].value = opValue;
+            fNodes[pc].next  = pc+1;
+            break;
+
+        case URX_STAT_SETREF_N:
+            fNodes[pc].test  = TEST_STATIC_SET;
+            fNodes[pc].value = opValue | URX_NEG_SET;
+            fNodes[pc].next  = pc+1;
+            break;
+
+        case URX_DOTANY:
+            fNodes[pc].test  = TEST_DOT;
+            fNodes[pc].value = DOT_NORMAL;
+            fNodes[pc].next  = pc+1;
+            break;
+
+        case URX_DOTANY_UNIX:
+            fNodes[pc].test  = TEST_DOT;
+            fNodes[pc].value = DOT_UNIX;
+            fNodes[pc].next  = pc+1;
+            break;
+
+        case URX_BACKSLASH_D:
+            fNodes[pc].test  = TEST_DIGIT;
+            fNodes[pc].value = opValue;
+            fNodes[pc].next  = pc+1;
+            break;
+
+        case URX_LOOP_SR_I:
+        case URX_LOOP_DOT_I:
+            {
+                // [set]* or .*, with the URX_LOOP_C that must follow.  The node
+                //   loops on itself, and continues after the LOOP_C.
+                int32_t loopcOp = pc+1 < patSize ? (int32_t)compiledPat->elementAti(pc+1) : 0;
+                if (URX_TYPE(loopcOp) != URX_LOOP_C) {
+                    fUsable = FALSE;
+                    break;
+                }
+                if (opType == URX_LOOP_SR_I) {
+                    fNodes[pc].test  = TEST_SET;
+                    fNodes[pc].value = opValue;
+                } else {
+                    fNodes[pc].test  = TEST_DOT;
+                    fNodes[pc].value = (opValue & 1) ? DOT_ALL : ((opValue & 2) ? DOT_UNIX : DOT_NORMAL);
+                }
+                fNodes[pc].next = pc;
+                fNodes[pc].eps1 = pc+2;
+                pc++;
+            }
+            break;
+
+        default:
+            // Anchors, boundaries, back references, look-around, counted loops,
+            //   case insensitive strings and the CR/LF handling of dot-all mode
+            //   all need the backtracking engine.
+            fUsable = FALSE;
+            break;
+        }
+    }
+
+    // Every jump must land within the pattern.
+    for (pc=0; pc<fNodeCount && fUsable; pc++) {
+        const RegexDFANode &node = fNodes[pc];
+        if (node.next >= fNodeCount || node.eps1 >= fNodeCount || node.eps2 >= fNodeCount) {
+            fUsable = FALSE;
+        }
+    }
+}
+
+
+static inline UBool isLineTerminator(UChar32 c) {
+    return ((c<=0x0d && c>=0x0a) || c==0x85 || c==0x2028 || c==0x2029);
+}
+
+
+UBool RegexDFA::testChar(const RegexDFANode &node, UChar32 c) const {
+    switch (node.test) {
+    case TEST_CHAR:
+        return c == node.value;
+
+    case TEST_CHAR_I:
+        return u_foldCase(c, U_FOLD_CASE_DEFAULT) == node.value;
+
+    case TEST_SET:
+        if (c < 256) {
+            return fPattern->fSets8[node.value].contains(c);
+        }
+        return ((const UnicodeSet *)fPattern->fSets->elementAt(node.value))->contains(c);
+
+    case TEST_STATIC_SET:
+        {
+            UBool   negated = (node.value & URX_NEG_SET) == URX_NEG_SET;
+            int32_t setIdx  = node.value & ~URX_NEG_SET;
+            UBool   inSet;
+            if (c < 256) {
+                inSet = fPattern->fStaticSets8[setIdx].contains(c);
+            } else {
+                inSet = fPattern->fStaticSets[setIdx]->contains(c);
+            }
+            return inSet != negated;
+        }
+
+    case TEST_DOT:
+        if (node.value == DOT_ALL) {
+            return TRUE;
+        }
+        if (node.value == DOT_UNIX) {
+            return c != 0x0a;
+        }
+        return !isLineTerminator(c);
+
+    case TEST_DIGIT:
+        return (u_charType(c) == U_DECIMAL_DIGIT_NUMBER) != (node.value != 0);
+
+    default:
+        return FALSE;
+    }
+}
+
+
+//
+//  addClosure   Mark a node, and every node reachable from it without
+//               consuming input, as part of the state being built.
+//
+void RegexDFA::addClosure(int32_t nodeIdx) {
+    if (fMarks[nodeIdx] == fGeneration) {
+        return;
+    }
+    int32_t sp = 0;
+    fMarks[nodeIdx] = fGeneration;
+    fStack[sp++] = nodeIdx;
+    while (sp > 0) {
+        const RegexDFANode &node = fNodes[fStack[--sp]];
+        if (node.eps1 >= 0 && fMarks[node.eps1] != fGeneration) {
+            fMarks[node.eps1] = fGeneration;
+            fStack[sp++] = node.eps1;
+        }
+        if (node.eps2 >= 0 && fMarks[node.eps2] != fGeneration) {
+            fMarks[node.eps2] = fGeneration;
+            fStack[sp++] = node.eps2;
+        }
+    }
+}
+
+
+//
+//  makeState    Find or create the state for the nodes marked with the current
+//               generation.  Returns the state number, or -1 if there are
+//               too many states or memory ran out.
+//
+int32_t RegexDFA::makeState() {
+    int32_t *nodes = (int32_t *)uprv_malloc(sizeof(int32_t) * fNodeCount);
+    if (nodes == NULL) {
+        return -1;
+    }
+    int32_t  count     = 0;
+    int32_t  hash      = 0;
+    UBool    accepting = FALSE;
+    int32_t  i;
+    for (i=0; i<fNodeCount; i++) {
+        if (fMarks[i] == fGeneration && fNodes[i].test != TEST_NONE) {
+            nodes[count++] = i;
+            hash = hash*37 + i;
+            if (fNodes[i].test == TEST_ACCEPT) {
+                accepting = TRUE;
+            }
+        }
+    }
+
+    for (i=0; i<fStateCount; i++) {
+        const RegexDFAState &state = fStates[i];
+        if (state.hash == hash && state.nodeCount == count &&
+            uprv_memcmp(state.nodes, nodes, sizeof(int32_t) * count) == 0) {
+            uprv_free(nodes);
+            return i;
+        }
+    }
+
+    if (fStateCount >= fStateCapacity) {
+        int32_t newCapacity = fStateCapacity == 0 ? 8 : fStateCapacity * 2;
+        RegexDFAState *newStates = NULL;
+        if (newCapacity <= MAX_STATES) {
+            newStates = (RegexDFAState *)uprv_realloc(fStates, sizeof(RegexDFAState) * newCapacity);
+        }
+        if (newStates == NULL) {
+            uprv_free(nodes);
+            return -1;
+        }
+        fStates = newStates;
+        fStateCapacity = newCapacity;
+    }
+    RegexDFAState &state = fStates[fStateCount];
+    state.nodes        = nodes;
+    state.nodeCount    = count;
+    state.hash         = hash;
+    state.accepting    = accepting;
+    state.lastWideChar = U_SENTINEL;
+    state.lastWideNext = -1;
+    for (i=0; i<256; i++) {
+        state.next[i] = -1;
+    }
+    return fStateCount++;
+}
+
+
+//
+//  transition   The state reached from a state on a char.  Every state also holds
+//               the start state's nodes, so that a match may begin at any position.
+//               Returns -1 on failure, after which the automaton is unusable.
+//
+int32_t RegexDFA::transition(int32_t stateIdx, UChar32 c) {
+    RegexDFAState *state = &fStates[stateIdx];
+    if (c < 256) {
+        if (state->next[c] >= 0) {
+            return state->next[c];
+        }
+    } else if (c == state->lastWideChar) {
+        return state->lastWideNext;
+    }
+
+    if (fGeneration == INT32_MAX) {
+        uprv_memset(fMarks, 0, sizeof(int32_t) * fNodeCount);
+        fGeneration = 0;
+    }
+    fGeneration++;
+    for (int32_t i=0; i<state->nodeCount; i++) {
+        const RegexDFANode &node = fNodes[state->nodes[i]];
+        if (node.next >= 0 && testChar(node, c)) {
+            addClosure(node.next);
+        }
+    }
+    addClosure(0);
+
+    int32_t next = makeState();
+    if (next < 0) {
+        fUsable = FALSE;
+        return -1;
+    }
+    state = &fStates[stateIdx];
+    if (c < 256) {
+        state->next[c] = next;
+    } else {
+        state->lastWideChar = c;
+        state->lastWideNext = next;
+    }
+    return next;
+}
+
+
+UBool RegexDFA::scan(const UChar *inputBuf, int32_t startPos, int32_t limit) {
+    if (!fUsable) {
+        return TRUE;
+    }
+
+    // In the start state no partial match is in progress, and only the
+    //   first char of a match can change that.  For patterns whose matches
+    //   all begin with the same literal, skip directly to its next occurrence.
+    int32_t pos   = startPos;
+    int32_t state = 0;
+
+    while (pos < limit) {
+        if (state == 0 && fLiteral != NULL) {
+            const UChar *found = u_strFindFirst(inputBuf+pos, limit-pos, fLiteral, fLiteralLen);
+            if (found == NULL) {
+                return FALSE;
+            }
+            pos = (int32_t)(found - inputBuf);
+        }
+
+        UChar32 c;
+        U16_NEXT(inputBuf, pos, limit, c);
+        state = transition(state, c);
+        if (state < 0) {
+            // Out of states.  The backtracking engine has to decide.
+            return TRUE;
+        }
+        if (fStates[state].accepting) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+U_NAMESPACE_END
+
+#endif  // !UCONFIG_NO_REGULAR_EXPRESSIONS
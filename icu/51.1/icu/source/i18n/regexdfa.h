@@ -0,0 +1,89 @@
+//
+//  regexdfa.h
+//
+//  Copyright (C) 2013, International Business Machines Corporation and others.
+//  All Rights Reserved.
+//
+//  This file contains class RegexDFA
+//
+//  This class is internal to the regular expression implementation.
+//  For the public Regular Expression API, see the file "unicode/regex.h"
+//
+//  RegexDFA is a lazily built deterministic automaton for patterns that
+//   need no backtracking features (no anchors, boundaries, back references,
+//   look-around or counted loops).  It is used by RegexMatcher::find() to
+//   reject input that cannot contain a match before running the
+//   backtracking engine.  It never decides where a match begins or
+//   ends, or what the capture groups hold.
+//
+
+#ifndef REGEXDFA_H
+#define REGEXDFA_H
+
+#include "unicode/utypes.h"
+#include "unicode/uobject.h"
+
+#if !UCONFIG_NO_REGULAR_EXPRESSIONS
+
+U_NAMESPACE_BEGIN
+
+class RegexPattern;
+struct RegexDFANode;
+struct RegexDFAState;
+
+class RegexDFA : public UMemory {
+public:
+    RegexDFA(const RegexPattern *pattern, UErrorCode &status);
+    ~RegexDFA();
+
+    //
+    //  isUsable   FALSE if the pattern uses features the automaton can not
+    //             represent, or if the automaton grew too large.
+    //
+    UBool isUsable() const;
+
+    //
+    //  scan       Look for a match of the pattern in inputBuf[startPos, limit).
+    //             Returns FALSE if there can be no match beginning at or after
+    //             startPos.  A TRUE result does not promise a match; the
+    //             backtracking engine must still be run to find where it begins
+    //             and ends, and what the capture groups hold.
+    //
+    UBool scan(const UChar *inputBuf, int32_t startPos, int32_t limit);
+
+private:
+    enum {
+        MAX_NODES  = 4096,     // Larger patterns are left to the backtracking engine.
+        MAX_STATES = 256       // Give up if the automaton needs more states than this.
+    };
+
+    void     buildNodes(UErrorCode &status);
+    int32_t  addNode(int32_t test, int32_t value, int32_t next, int32_t eps1, int32_t eps2);
+    UBool    testChar(const RegexDFANode &node, UChar32 c) const;
+    void     addClosure(int32_t nodeIdx);
+    int32_t  makeState();
+    int32_t  transition(int32_t state, UChar32 c);
+
+    const RegexPattern *fPattern;
+    UBool               fUsable;
+
+    RegexDFANode       *fNodes;
+    int32_t             fNodeCount;
+    int32_t             fNodeCapacity;
+
+    int32_t            *fMarks;        // Per node, fGeneration if it is in the set being built.
+    int32_t             fGeneration;
+    int32_t            *fStack;        // Work stack for closures, one slot per node.
+
+    RegexDFAState      *fStates;
+    int32_t             fStateCount;
+    int32_t             fStateCapacity;
+
+    const UChar        *fLiteral;      // Every match begins with this literal text,
+    int32_t             fLiteralLen;   //   or NULL if not known.
+    UChar               fCharBuf[2];   // The literal, for patterns that begin with a single char.
+};
+
+U_NAMESPACE_END
+#endif   // !UCONFIG_NO_REGULAR_EXPRESSIONS
+#endif   // REGEXDFA_H
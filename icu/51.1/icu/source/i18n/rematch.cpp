@@ -1,6 +1,6 @@
 /*
 **************************************************************************
-*   Copyright (C) 2002-2012 International Business Machines Corporation  *
+*   Copyright (C) 2002-2013 International Business Machines Corporation  *
 *   and others. All rights reserved.                                     *
 **************************************************************************
 */
@@ -29,6 +29,7 @@
 #include "regeximp.h"
 #include "regexst.h"
 #include "regextxt.h"
+#include "regexdfa.h"
 #include "ucase.h"
 
 // #include <malloc.h>        // Needed for heapcheck testing
@@ -185,6 +186,8 @@ RegexMatcher::~RegexMatcher() {
     #if UCONFIG_NO_BREAK_ITERATION==0
     delete fWordBreakItr;
     #endif
+
+    delete fDFA;
 }
 
 //
@@ -229,6 +232,8 @@ void RegexMatcher::init(UErrorCode &status) {
     fDeferredStatus    = status;
     fData              = fSmallData;
     fWordBreakItr      = NULL;
+    fDFA               = NULL;
+    fDFABuilt          = FALSE;
     
     fStack             = NULL;
     fInputText         = NULL;
@@ -936,6 +941,34 @@ UBool RegexMatcher::findUsingChunk() {
     UChar32  c;
     U_ASSERT(startPos >= 0);
     
+    // For patterns that need no backtracking features, a DFA scan of the input
+    //   can rule out a match far faster than trying the backtracking engine
+    //   at each position.  The scan stops at the first place a match could end.
+    //   Not used when time limits or progress callbacks could observe the difference.
+    if (fTimeLimit == 0 && fFindProgressCallbackFn == NULL) {
+        if (!fDFABuilt) {
+            fDFABuilt = TRUE;
+            fDFA = new RegexDFA(fPattern, fDeferredStatus);
+            if (fDFA == NULL) {
+                fDeferredStatus = U_MEMORY_ALLOCATION_ERROR;
+            }
+            if (U_FAILURE(fDeferredStatus)) {
+                return FALSE;
+            }
+            if (!fDFA->isUsable()) {
+                delete fDFA;
+                fDFA = NULL;
+            }
+        }
+        if (fDFA != NULL) {
+            if (!fDFA->scan(inputBuf, startPos, (int32_t)fActiveLimit)) {
+                fMatch = FALSE;
+                fHitEnd = TRUE;
+                return FALSE;
+            }
+        }
+    }
+    
     switch (fPattern->fStartType) {
     case START_NO_INFO:
         // No optimization was found. 
@@ -1009,7 +1042,20 @@ UBool RegexMatcher::findUsingChunk() {
         // Match starts on exactly one char.
         U_ASSERT(fPattern->fMinMatchLen > 0);
         UChar32 theChar = fPattern->fInitialChar;
+        const UChar *initialString = fPattern->fLiteralText.getBuffer() + fPattern->fInitialStringIdx;
         for (;;) {
+            if (fPattern->fStartType == START_STRING && fFindProgressCallbackFn == NULL) {
+                // Go straight to the next occurrence of the whole literal,
+                //   rather than stopping at each occurrence of its first char.
+                const UChar *found = u_strFindFirst(inputBuf+startPos, (int32_t)fActiveLimit-startPos,
+                                                    initialString, fPattern->fInitialStringLen);
+                if (found == NULL || found-inputBuf > testLen) {
+                    fMatch = FALSE;
+                    fHitEnd = TRUE;
+                    return FALSE;
+                }
+                startPos = (int32_t)(found-inputBuf);
+            }
             int32_t pos = startPos;
             U16_NEXT(inputBuf, startPos, fActiveLimit, c);  // like c = inputBuf[startPos++];
             if (c == theChar) {
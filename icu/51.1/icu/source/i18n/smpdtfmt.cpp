@@ -58,6 +58,7 @@
 #include "uassert.h"
 #include "cmemory.h"
 #include "umutex.h"
+#include "ustrarena.h"
 #include <float.h>
 #include "smpdtfst.h"
 
@@ -246,7 +247,9 @@ SimpleDateFormat::SimpleDateFormat(UErrorCode& status)
       fTimeZoneFormat(NULL),
       fNumberFormatters(NULL),
       fOverrideList(NULL),
-      fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE)
+      fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE),
+    fFastZeroDigit(-1),
+    fFrozen(FALSE)
 {
     construct(kShort, (EStyle) (kShort + kDateOffset), fLocale, status);
     initializeDefaultCentury();
@@ -262,7 +265,9 @@ SimpleDateFormat::SimpleDateFormat(const UnicodeString& pattern,
     fTimeZoneFormat(NULL),
     fNumberFormatters(NULL),
     fOverrideList(NULL),
-    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE)
+    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE),
+    fFastZeroDigit(-1),
+    fFrozen(FALSE)
 {
     fDateOverride.setToBogus();
     fTimeOverride.setToBogus();
@@ -282,7 +287,9 @@ SimpleDateFormat::SimpleDateFormat(const UnicodeString& pattern,
     fTimeZoneFormat(NULL),
     fNumberFormatters(NULL),
     fOverrideList(NULL),
-    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE)
+    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE),
+    fFastZeroDigit(-1),
+    fFrozen(FALSE)
 {
     fDateOverride.setTo(override);
     fTimeOverride.setToBogus();
@@ -304,7 +311,9 @@ SimpleDateFormat::SimpleDateFormat(const UnicodeString& pattern,
     fTimeZoneFormat(NULL),
     fNumberFormatters(NULL),
     fOverrideList(NULL),
-    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE)
+    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE),
+    fFastZeroDigit(-1),
+    fFrozen(FALSE)
 {
 
     fDateOverride.setToBogus();
@@ -326,7 +335,9 @@ SimpleDateFormat::SimpleDateFormat(const UnicodeString& pattern,
     fTimeZoneFormat(NULL),
     fNumberFormatters(NULL),
     fOverrideList(NULL),
-    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE)
+    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE),
+    fFastZeroDigit(-1),
+    fFrozen(FALSE)
 {
 
     fDateOverride.setTo(override);
@@ -351,7 +362,9 @@ SimpleDateFormat::SimpleDateFormat(const UnicodeString& pattern,
     fTimeZoneFormat(NULL),
     fNumberFormatters(NULL),
     fOverrideList(NULL),
-    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE)
+    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE),
+    fFastZeroDigit(-1),
+    fFrozen(FALSE)
 {
 
     fDateOverride.setToBogus();
@@ -373,7 +386,9 @@ SimpleDateFormat::SimpleDateFormat(const UnicodeString& pattern,
     fTimeZoneFormat(NULL),
     fNumberFormatters(NULL),
     fOverrideList(NULL),
-    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE)
+    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE),
+    fFastZeroDigit(-1),
+    fFrozen(FALSE)
 {
 
     fDateOverride.setToBogus();
@@ -396,7 +411,9 @@ SimpleDateFormat::SimpleDateFormat(EStyle timeStyle,
     fTimeZoneFormat(NULL),
     fNumberFormatters(NULL),
     fOverrideList(NULL),
-    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE)
+    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE),
+    fFastZeroDigit(-1),
+    fFrozen(FALSE)
 {
     construct(timeStyle, dateStyle, fLocale, status);
     if(U_SUCCESS(status)) {
@@ -419,7 +436,9 @@ SimpleDateFormat::SimpleDateFormat(const Locale& locale,
     fTimeZoneFormat(NULL),
     fNumberFormatters(NULL),
     fOverrideList(NULL),
-    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE)
+    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE),
+    fFastZeroDigit(-1),
+    fFrozen(FALSE)
 {
     if (U_FAILURE(status)) return;
     initializeSymbols(fLocale, initializeCalendar(NULL, fLocale, status),status);
@@ -454,7 +473,9 @@ SimpleDateFormat::SimpleDateFormat(const SimpleDateFormat& other)
     fTimeZoneFormat(NULL),
     fNumberFormatters(NULL),
     fOverrideList(NULL),
-    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE)
+    fCapitalizationContext(UDISPCTX_CAPITALIZATION_NONE),
+    fFastZeroDigit(-1),
+    fFrozen(FALSE)
 {
     *this = other;
 }
@@ -463,10 +484,11 @@ SimpleDateFormat::SimpleDateFormat(const SimpleDateFormat& other)
 
 SimpleDateFormat& SimpleDateFormat::operator=(const SimpleDateFormat& other)
 {
-    if (this == &other) {
+    if (this == &other || fFrozen) {
         return *this;
     }
     DateFormat::operator=(other);
+    initFastNumberFormat();
 
     delete fSymbols;
     fSymbols = NULL;
@@ -479,6 +501,7 @@ SimpleDateFormat& SimpleDateFormat::operator=(const SimpleDateFormat& other)
     fHaveDefaultCentury          = other.fHaveDefaultCentury;
 
     fPattern = other.fPattern;
+    fCompiledPattern = other.fCompiledPattern;
 
     // TimeZoneFormat in ICU4C only depends on a locale for now
     if (fLocale != other.fLocale) {
@@ -746,6 +769,9 @@ void
 SimpleDateFormat::initialize(const Locale& locale,
                              UErrorCode& status)
 {
+    // fPattern is final by now, even if construction failed.
+    compilePattern();
+
     if (U_FAILURE(status)) return;
 
     // We don't need to check that the row count is >= 1, since all 2d arrays have at
@@ -768,6 +794,7 @@ SimpleDateFormat::initialize(const Locale& locale,
         //fNumberFormat->setLenient(TRUE); // Java uses a custom DateNumberFormat to format/parse
 
         initNumberFormatters(locale,status);
+        initFastNumberFormat();
 
     }
     else if (U_SUCCESS(status))
@@ -843,6 +870,8 @@ SimpleDateFormat::_format(Calendar& cal, UnicodeString& appendTo,
     if ( U_FAILURE(status) ) {
        return appendTo; 
     }
+    // subFormat() and the formatters that it calls create many short-lived strings
+    UnicodeStringArena arena;
     Calendar* workCal = &cal;
     Calendar* calClone = NULL;
     if (&cal != fCalendar && uprv_strcmp(cal.getType(), fCalendar->getType()) != 0) {
@@ -861,26 +890,69 @@ SimpleDateFormat::_format(Calendar& cal, UnicodeString& appendTo,
         }
     }
 
+    const UChar *items = fCompiledPattern.getBuffer();
+    int32_t itemsLength = fCompiledPattern.length();
+    int32_t fieldNum = 0;
+
+    // loop through the fields and literal text of the compiled pattern
+    for (int32_t i = 0; i < itemsLength && U_SUCCESS(status); ) {
+        UChar ch = items[i];
+        int32_t count = ((int32_t)items[i+1] << 16) | items[i+2];
+        i += 3;
+        if (ch == 0) {
+            appendTo.append(items, i, count);
+            i += count;
+        } else {
+            subFormat(appendTo, ch, count, fCapitalizationContext, fieldNum++, handler, *workCal, status);
+        }
+    }
+
+    if (calClone != NULL) {
+        delete calClone;
+    }
+
+    return appendTo;
+}
+
+//----------------------------------------------------------------------
+
+static void
+appendCompiledItem(UnicodeString &compiled, UChar ch, int32_t count) {
+    compiled.append(ch);
+    compiled.append((UChar)(count >> 16));
+    compiled.append((UChar)(count & 0xFFFF));
+}
+
+void
+SimpleDateFormat::compilePattern()
+{
+    UnicodeString literal;
     UBool inQuote = FALSE;
     UChar prevCh = 0;
     int32_t count = 0;
-    int32_t fieldNum = 0;
+
+    fCompiledPattern.remove();
 
     // loop through the pattern string character by character
-    for (int32_t i = 0; i < fPattern.length() && U_SUCCESS(status); ++i) {
+    for (int32_t i = 0; i < fPattern.length(); ++i) {
         UChar ch = fPattern[i];
 
-        // Use subFormat() to format a repeated pattern character
-        // when a different pattern or non-pattern character is seen
+        // A run of a pattern character ends when a different pattern
+        // or non-pattern character is seen
         if (ch != prevCh && count > 0) {
-            subFormat(appendTo, prevCh, count, fCapitalizationContext, fieldNum++, handler, *workCal, status);
+            if (literal.length() > 0) {
+                appendCompiledItem(fCompiledPattern, 0, literal.length());
+                fCompiledPattern.append(literal);
+                literal.remove();
+            }
+            appendCompiledItem(fCompiledPattern, prevCh, count);
             count = 0;
         }
         if (ch == QUOTE) {
             // Consecutive single quotes are a single quote literal,
             // either outside of quotes or between quotes
             if ((i+1) < fPattern.length() && fPattern[i+1] == QUOTE) {
-                appendTo += (UChar)QUOTE;
+                literal += (UChar)QUOTE;
                 ++i;
             } else {
                 inQuote = ! inQuote;
@@ -894,21 +966,19 @@ SimpleDateFormat::_format(Calendar& cal, UnicodeString& appendTo,
             ++count;
         }
         else {
-            // Append quoted characters and unquoted non-pattern characters
-            appendTo += ch;
+            // Quoted characters and unquoted non-pattern characters
+            literal += ch;
         }
     }
 
-    // Format the last item in the pattern, if any
-    if (count > 0) {
-        subFormat(appendTo, prevCh, count, fCapitalizationContext, fieldNum++, handler, *workCal, status);
+    if (literal.length() > 0) {
+        appendCompiledItem(fCompiledPattern, 0, literal.length());
+        fCompiledPattern.append(literal);
     }
-
-    if (calClone != NULL) {
-        delete calClone;
+    // The last item in the pattern, if any
+    if (count > 0) {
+        appendCompiledItem(fCompiledPattern, prevCh, count);
     }
-
-    return appendTo;
 }
 
 //----------------------------------------------------------------------
@@ -1334,18 +1404,14 @@ SimpleDateFormat::subFormat(UnicodeString &appendTo,
     case UDAT_FRACTIONAL_SECOND_FIELD:
         // Fractional seconds left-justify
         {
-            currentNumberFormat->setMinimumIntegerDigits((count > 3) ? 3 : count);
-            currentNumberFormat->setMaximumIntegerDigits(maxIntCount);
             if (count == 1) {
                 value /= 100;
             } else if (count == 2) {
                 value /= 10;
             }
-            FieldPosition p(0);
-            currentNumberFormat->format(value, appendTo, p);
+            zeroPaddingNumber(currentNumberFormat, appendTo, value, (count > 3) ? 3 : count, maxIntCount);
             if (count > 3) {
-                currentNumberFormat->setMinimumIntegerDigits(count - 3);
-                currentNumberFormat->format((int32_t)0, appendTo, p);
+                zeroPaddingNumber(currentNumberFormat, appendTo, 0, count - 3, maxIntCount);
             }
         }
         break;
@@ -1625,13 +1691,113 @@ void
 SimpleDateFormat::zeroPaddingNumber(NumberFormat *currentNumberFormat,UnicodeString &appendTo,
                                     int32_t value, int32_t minDigits, int32_t maxDigits) const
 {
+    if (currentNumberFormat == fNumberFormat && fFastZeroDigit >= 0
+            && value >= 0 && minDigits > 0 && maxDigits > 0) {
+        // Write the digits the way DecimalFormat would: at least minDigits
+        // of them, dropping the high-order digits beyond maxDigits.
+        UChar32 digits[10];
+        int32_t digitCount = 0;
+        do {
+            digits[digitCount++] = fFastZeroDigit + value % 10;
+            value /= 10;
+        } while (value != 0);
+        if (minDigits > maxDigits) {
+            minDigits = maxDigits;
+        }
+        if (digitCount > maxDigits) {
+            digitCount = maxDigits;
+        }
+        for (int32_t i = digitCount; i < minDigits; i++) {
+            appendTo.append(fFastZeroDigit);
+        }
+        while (digitCount > 0) {
+            appendTo.append(digits[--digitCount]);
+        }
+        return;
+    }
     if (currentNumberFormat!=NULL) {
         FieldPosition pos(0);
 
+        // A frozen formatter may be in use by other threads, and this
+        // changes the NumberFormat while it formats.
+        if (fFrozen) {
+            umtx_lock(&LOCK);
+        }
         currentNumberFormat->setMinimumIntegerDigits(minDigits);
         currentNumberFormat->setMaximumIntegerDigits(maxDigits);
         currentNumberFormat->format(value, appendTo, pos);  // 3rd arg is there to speed up processing
+        if (fFrozen) {
+            umtx_unlock(&LOCK);
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+
+void
+SimpleDateFormat::initFastNumberFormat()
+{
+    fFastZeroDigit = -1;
+
+    DecimalFormat *decfmt = dynamic_cast<DecimalFormat *>(fNumberFormat);
+    if (decfmt == NULL) {
+        return;
     }
+    UnicodeString affix;
+    if (decfmt->isGroupingUsed() || decfmt->isScientificNotation() ||
+        decfmt->areSignificantDigitsUsed() || decfmt->getMultiplier() != 1 ||
+        decfmt->getFormatWidth() != 0 || decfmt->getRoundingIncrement() != 0.0 ||
+        decfmt->isDecimalSeparatorAlwaysShown() ||
+        !decfmt->getPositivePrefix(affix).isEmpty() ||
+        !decfmt->getPositiveSuffix(affix).isEmpty()) {
+        return;
+    }
+
+    // The digits must be ten consecutive code points.
+    const DecimalFormatSymbols *symbols = decfmt->getDecimalFormatSymbols();
+    const UnicodeString &zeroDigit = symbols->getConstSymbol(DecimalFormatSymbols::kZeroDigitSymbol);
+    UChar32 zero = zeroDigit.char32At(0);
+    if (zeroDigit.countChar32() != 1) {
+        return;
+    }
+    for (int32_t i = 1; i <= 9; i++) {
+        const UnicodeString &digit = symbols->getConstSymbol(
+            (DecimalFormatSymbols::ENumberFormatSymbol)(DecimalFormatSymbols::kOneDigitSymbol + i - 1));
+        if (digit.countChar32() != 1 || digit.char32At(0) != zero + i) {
+            return;
+        }
+    }
+    fFastZeroDigit = zero;
+}
+
+//----------------------------------------------------------------------
+
+void
+SimpleDateFormat::adoptNumberFormat(NumberFormat* formatToAdopt)
+{
+    if (fFrozen) {
+        delete formatToAdopt;
+        return;
+    }
+    DateFormat::adoptNumberFormat(formatToAdopt);
+    initFastNumberFormat();
+}
+
+//----------------------------------------------------------------------
+
+SimpleDateFormat*
+SimpleDateFormat::freeze()
+{
+    fFrozen = TRUE;
+    return this;
+}
+
+//----------------------------------------------------------------------
+
+UBool
+SimpleDateFormat::isFrozen() const
+{
+    return fFrozen;
 }
 
 //----------------------------------------------------------------------
@@ -2401,6 +2567,9 @@ newBestMatchWithOptionalDot(const UnicodeString &lcaseText,
 void
 SimpleDateFormat::set2DigitYearStart(UDate d, UErrorCode& status)
 {
+    if (fFrozen) {
+        return;
+    }
     parseAmbiguousDatesAsAfter(d, status);
 }
 
@@ -3225,7 +3394,11 @@ SimpleDateFormat::toLocalizedPattern(UnicodeString& result,
 void
 SimpleDateFormat::applyPattern(const UnicodeString& pattern)
 {
+    if (fFrozen) {
+        return;
+    }
     fPattern = pattern;
+    compilePattern();
 }
 
 //----------------------------------------------------------------------
@@ -3234,9 +3407,13 @@ void
 SimpleDateFormat::applyLocalizedPattern(const UnicodeString& pattern,
                                         UErrorCode &status)
 {
+    if (fFrozen) {
+        return;
+    }
     translatePattern(pattern, fPattern,
                      fSymbols->fLocalPatternChars,
                      UnicodeString(DateFormatSymbols::getPatternUChars()), status);
+    compilePattern();
 }
 
 //----------------------------------------------------------------------
@@ -3252,6 +3429,10 @@ SimpleDateFormat::getDateFormatSymbols() const
 void
 SimpleDateFormat::adoptDateFormatSymbols(DateFormatSymbols* newFormatSymbols)
 {
+    if (fFrozen) {
+        delete newFormatSymbols;
+        return;
+    }
     delete fSymbols;
     fSymbols = newFormatSymbols;
 }
@@ -3260,6 +3441,9 @@ SimpleDateFormat::adoptDateFormatSymbols(DateFormatSymbols* newFormatSymbols)
 void
 SimpleDateFormat::setDateFormatSymbols(const DateFormatSymbols& newFormatSymbols)
 {
+    if (fFrozen) {
+        return;
+    }
     delete fSymbols;
     fSymbols = new DateFormatSymbols(newFormatSymbols);
 }
@@ -3274,6 +3458,10 @@ SimpleDateFormat::getTimeZoneFormat(void) const {
 void
 SimpleDateFormat::adoptTimeZoneFormat(TimeZoneFormat* timeZoneFormatToAdopt)
 {
+    if (fFrozen) {
+        delete timeZoneFormatToAdopt;
+        return;
+    }
     delete fTimeZoneFormat;
     fTimeZoneFormat = timeZoneFormatToAdopt;
 }
@@ -3282,6 +3470,9 @@ SimpleDateFormat::adoptTimeZoneFormat(TimeZoneFormat* timeZoneFormatToAdopt)
 void
 SimpleDateFormat::setTimeZoneFormat(const TimeZoneFormat& newTimeZoneFormat)
 {
+    if (fFrozen) {
+        return;
+    }
     delete fTimeZoneFormat;
     fTimeZoneFormat = new TimeZoneFormat(newTimeZoneFormat);
 }
@@ -3291,6 +3482,10 @@ SimpleDateFormat::setTimeZoneFormat(const TimeZoneFormat& newTimeZoneFormat)
 
 void SimpleDateFormat::adoptCalendar(Calendar* calendarToAdopt)
 {
+  if (fFrozen) {
+    delete calendarToAdopt;
+    return;
+  }
   UErrorCode status = U_ZERO_ERROR;
   DateFormat::adoptCalendar(calendarToAdopt);
   delete fSymbols;
@@ -3307,6 +3502,10 @@ void SimpleDateFormat::setContext(UDisplayContext value, UErrorCode& status)
 {
     if (U_FAILURE(status))
         return;
+    if (fFrozen) {
+        status = U_NO_WRITE_PERMISSION;
+        return;
+    }
     if ( (UDisplayContextType)((uint32_t)value >> 8) == UDISPCTX_TYPE_CAPITALIZATION ) {
         fCapitalizationContext = value;
     } else {
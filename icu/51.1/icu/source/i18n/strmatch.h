@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2001-2011, International Business Machines Corporation
+ * Copyright (C) 2001-2013, International Business Machines Corporation
  * and others. All Rights Reserved.
  **********************************************************************
  *   Date        Name        Description
@@ -241,6 +241,7 @@ class StringMatcher : public UnicodeFunctor, public UnicodeMatcher, public Unico
      */
     int32_t matchLimit;
 
+    friend class TransliterationRuleCache;
 };
 
 U_NAMESPACE_END
@@ -1,6 +1,6 @@
 /*
 **********************************************************************
-*   Copyright (c) 2002-2011, International Business Machines Corporation
+*   Copyright (c) 2002-2013, International Business Machines Corporation
 *   and others.  All Rights Reserved.
 **********************************************************************
 *   Date        Name        Description
@@ -67,6 +67,8 @@ class StringReplacer : public UnicodeFunctor, public UnicodeReplacer {
      */
     const TransliterationRuleData* data;
 
+    friend class TransliterationRuleCache;
+
  public:
 
     /**
@@ -1,6 +1,6 @@
 /*
  **********************************************************************
- *   Copyright (C) 1999-2012, International Business Machines
+ *   Copyright (C) 1999-2013, International Business Machines
  *   Corporation and others.  All Rights Reserved.
  **********************************************************************
  *   Date        Name        Description
@@ -29,6 +29,7 @@
 #include "nultrans.h"
 #include "rbt_data.h"
 #include "rbt_pars.h"
+#include "rbt_cache.h"
 #include "rbt.h"
 #include "transreg.h"
 #include "name2uni.h"
@@ -1292,6 +1293,13 @@ void U_EXPORT2 Transliterator::unregister(const UnicodeString& ID) {
     }
 }
 
+void U_EXPORT2 Transliterator::setRuleCacheDirectory(const char *path, UErrorCode &status) {
+    TransliterationRuleCache::setDirectory(path, status);
+    if (U_SUCCESS(status)) {
+        ucln_i18n_registerCleanup(UCLN_I18N_TRANSLITERATOR, utrans_transliterator_cleanup);
+    }
+}
+
 /**
  * == OBSOLETE - remove in ICU 3.4 ==
  * Return the number of IDs currently registered with the system.
@@ -1629,6 +1637,7 @@ U_NAMESPACE_END
 U_CFUNC UBool utrans_transliterator_cleanup(void) {
     U_NAMESPACE_USE
     TransliteratorIDParser::cleanup();
+    TransliterationRuleCache::cleanup();
     if (registry) {
         delete registry;
         registry = NULL;
@@ -1,6 +1,6 @@
 /*
 **********************************************************************
-*   Copyright (c) 2001-2011, International Business Machines
+*   Copyright (c) 2001-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 **********************************************************************
 *   Date        Name        Description
@@ -22,6 +22,7 @@
 #include "transreg.h"
 #include "rbt_data.h"
 #include "rbt_pars.h"
+#include "rbt_cache.h"
 #include "tridpars.h"
 #include "charstr.h"
 #include "uassert.h"
@@ -183,7 +184,14 @@ void TransliteratorAlias::parse(TransliteratorParser& parser,
         return;
     }
 
+    // Rules compiled by an earlier parse may be in the rule cache.
+    if (TransliterationRuleCache::load(aliasesOrRules, direction, parser, ec)) {
+        return;
+    }
     parser.parse(aliasesOrRules, direction, pe, ec);
+    if (U_SUCCESS(ec)) {
+        TransliterationRuleCache::store(aliasesOrRules, direction, parser);
+    }
 }
 
 //----------------------------------------------------------------------
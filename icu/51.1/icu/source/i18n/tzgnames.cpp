@@ -296,13 +296,17 @@ private:
 
     TextTrieMap fGNamesTrie;
     UBool fGNamesTrieFullyLoaded;
+    UBool fGNamesTrieRegionLoaded;
 
     char fTargetRegion[ULOC_COUNTRY_CAPACITY];
+    char fZoneRegion[ULOC_COUNTRY_CAPACITY];
 
     void initialize(const Locale& locale, UErrorCode& status);
     void cleanup();
 
     void loadStrings(const UnicodeString& tzCanonicalID);
+    void loadZoneStrings(const char* region, UErrorCode& status);
+    void loadMoreStrings(UErrorCode& status);
 
     const UChar* getGenericLocationName(const UnicodeString& tzCanonicalID);
 
@@ -339,7 +343,9 @@ TZGNCore::TZGNCore(const Locale& locale, UErrorCode& status)
   fLocaleDisplayNames(NULL),
   fStringPool(status),
   fGNamesTrie(TRUE, deleteGNameInfo),
-  fGNamesTrieFullyLoaded(FALSE) {
+  fGNamesTrieFullyLoaded(FALSE),
+  fGNamesTrieRegionLoaded(FALSE) {
+    fZoneRegion[0] = 0;
     initialize(locale, status);
 }
 
@@ -442,6 +448,13 @@ TZGNCore::initialize(const Locale& locale, UErrorCode& status) {
     const UChar *tzID = ZoneMeta::getCanonicalCLDRID(*tz);
     if (tzID != NULL) {
         loadStrings(UnicodeString(tzID));
+
+        // "001" is the region of the Etc zones, which tells nothing of the device
+        UErrorCode tmpsts = U_ZERO_ERROR;
+        TimeZone::getRegion(UnicodeString(tzID), fZoneRegion, sizeof(fZoneRegion), tmpsts);
+        if (U_FAILURE(tmpsts) || uprv_strcmp(fZoneRegion, "001") == 0) {
+            fZoneRegion[0] = 0;
+        }
     }
     delete tz;
 }
@@ -912,6 +925,57 @@ TZGNCore::loadStrings(const UnicodeString& tzCanonicalID) {
     }
 }
 
+/*
+ * Loads the strings of the canonical zones of the region, or of all
+ * zones if region is NULL.
+ * This method updates the cache and must be called with a lock.
+ */
+void
+TZGNCore::loadZoneStrings(const char* region, UErrorCode& status) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    StringEnumeration *tzIDs = TimeZone::createTimeZoneIDEnumeration(UCAL_ZONE_TYPE_CANONICAL, region, NULL, status);
+    if (U_SUCCESS(status)) {
+        const UnicodeString *tzID;
+        while ((tzID = tzIDs->snext(status))) {
+            if (U_FAILURE(status)) {
+                break;
+            }
+            loadStrings(*tzID);
+        }
+    }
+    if (tzIDs != NULL) {
+        delete tzIDs;
+    }
+}
+
+/*
+ * Loads the strings of the zones of the default zone's region and the
+ * target region the first time, those of all zones the next time.
+ * This method updates the cache and must be called with a lock.
+ */
+void
+TZGNCore::loadMoreStrings(UErrorCode& status) {
+    if (!fGNamesTrieRegionLoaded) {
+        fGNamesTrieRegionLoaded = TRUE;
+        if (fZoneRegion[0] != 0 || fTargetRegion[0] != 0) {
+            if (fZoneRegion[0] != 0) {
+                loadZoneStrings(fZoneRegion, status);
+            }
+            if (fTargetRegion[0] != 0 && uprv_strcmp(fTargetRegion, fZoneRegion) != 0) {
+                loadZoneStrings(fTargetRegion, status);
+            }
+#if UCONFIG_TZNAMES_REGION_ONLY
+            fGNamesTrieFullyLoaded = TRUE;
+#endif
+            return;
+        }
+    }
+    loadZoneStrings(NULL, status);
+    fGNamesTrieFullyLoaded = U_SUCCESS(status);
+}
+
 int32_t
 TZGNCore::findBestMatch(const UnicodeString& text, int32_t start, uint32_t types,
         UnicodeString& tzID, UTimeZoneFormatTimeType& timeType, UErrorCode& status) const {
@@ -1066,46 +1130,42 @@ TZGNCore::findLocal(const UnicodeString& text, int32_t start, uint32_t types, UE
 
     if (results != NULL) {
         delete results;
+        results = NULL;
     }
 
-    // All names are not yet loaded into the local trie.
-    // Load all available names into the trie. This could be very heavy.
-    umtx_lock(&gLock);
-    {
-        if (!fGNamesTrieFullyLoaded) {
-            StringEnumeration *tzIDs = TimeZone::createTimeZoneIDEnumeration(UCAL_ZONE_TYPE_CANONICAL, NULL, NULL, status);
-            if (U_SUCCESS(status)) {
-                const UnicodeString *tzID;
-                while ((tzID = tzIDs->snext(status))) {
-                    if (U_FAILURE(status)) {
-                        break;
-                    }
-                    nonConstThis->loadStrings(*tzID);
-                }
-            }
-            if (tzIDs != NULL) {
-                delete tzIDs;
+    // All names are not yet loaded into the local trie. Load those of the
+    // zones of the device's regions, then all available names, which could
+    // be very heavy, while there is no perfect match.
+    while (!fGNamesTrieFullyLoaded) {
+        umtx_lock(&gLock);
+        {
+            if (!fGNamesTrieFullyLoaded) {
+                nonConstThis->loadMoreStrings(status);
             }
+        }
+        umtx_unlock(&gLock);
 
-            if (U_SUCCESS(status)) {
-                nonConstThis->fGNamesTrieFullyLoaded = TRUE;
-            }
+        if (U_FAILURE(status)) {
+            return NULL;
         }
-    }
-    umtx_unlock(&gLock);
 
-    if (U_FAILURE(status)) {
-        return NULL;
-    }
+        umtx_lock(&gLock);
+        {
+            // now try it again
+            fGNamesTrie.search(text, start, (TextTrieMapSearchResultHandler *)&handler, status);
+        }
+        umtx_unlock(&gLock);
 
-    umtx_lock(&gLock);
-    {
-        // now try it again
-        fGNamesTrie.search(text, start, (TextTrieMapSearchResultHandler *)&handler, status);
+        results = handler.getMatches(maxLen);
+        if (results != NULL && ((maxLen == (text.length() - start)) || fGNamesTrieFullyLoaded)) {
+            break;
+        }
+        if (results != NULL) {
+            delete results;
+            results = NULL;
+        }
     }
-    umtx_unlock(&gLock);
 
-    results = handler.getMatches(maxLen);
     if (results != NULL && maxLen > 0) {
         gmatchInfo = new TimeZoneGenericNameMatchInfo(results);
         if (gmatchInfo == NULL) {
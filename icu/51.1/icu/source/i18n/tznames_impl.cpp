@@ -206,7 +206,9 @@ TextTrieMap::growNodes() {
     if (fNodesCapacity == 0xffff) {
         return FALSE;  // We use 16-bit node indexes.
     }
-    int32_t newCapacity = fNodesCapacity + 1000;
+    // Doubled, not grown by a fixed step, as the nodes are copied each time
+    // and all the names of a locale take tens of thousands of them.
+    int32_t newCapacity = fNodesCapacity * 2;
     if (newCapacity > 0xffff) {
         newCapacity = 0xffff;
     }
@@ -300,6 +302,15 @@ void TextTrieMap::buildTrie(UErrorCode &status) {
         }
         delete fLazyContents;
         fLazyContents = NULL; 
+
+        // Give back the unused capacity, up to half of the nodes.
+        if (fNodesCount < fNodesCapacity) {
+            CharacterNode *nodes = (CharacterNode *)uprv_realloc(fNodes, fNodesCount * sizeof(CharacterNode));
+            if (nodes != NULL) {
+                fNodes = nodes;
+                fNodesCapacity = fNodesCount;
+            }
+        }
     }
     umtx_unlock(&TextTrieMutex);
 }
@@ -873,13 +884,24 @@ U_CDECL_END
 
 static UMutex gLock = U_MUTEX_INITIALIZER;
 
+// Names in the trie searched by find(). Each stage is loaded only when the
+// names of the previous ones do not match the rest of the text.
+enum {
+    NAMES_STAGE_DEFAULT_ZONE,   // the default zone and its metazones, by initialize()
+    NAMES_STAGE_REGION,         // the zones of the default zone's region and the locale's country
+    NAMES_STAGE_META_ZONES,     // all metazones
+    NAMES_STAGE_ALL_ZONES       // all zones, i.e. the exemplar locations of the others
+};
+
 TimeZoneNamesImpl::TimeZoneNamesImpl(const Locale& locale, UErrorCode& status)
 : fLocale(locale),
   fZoneStrings(NULL),
   fTZNamesMap(NULL),
   fMZNamesMap(NULL),
   fNamesTrieFullyLoaded(FALSE),
+  fNamesTrieStage(NAMES_STAGE_DEFAULT_ZONE),
   fNamesTrie(TRUE, deleteZNameInfo) {
+    fRegion[0] = 0;
     initialize(locale, status);
 }
 
@@ -916,6 +938,13 @@ TimeZoneNamesImpl::initialize(const Locale& locale, UErrorCode& status) {
     const UChar *tzID = ZoneMeta::getCanonicalCLDRID(*tz);
     if (tzID != NULL) {
         loadStrings(UnicodeString(tzID));
+
+        // "001" is the region of the Etc zones, which tells nothing of the device
+        UErrorCode tmpsts = U_ZERO_ERROR;
+        TimeZone::getRegion(UnicodeString(tzID), fRegion, sizeof(fRegion), tmpsts);
+        if (U_FAILURE(tmpsts) || uprv_strcmp(fRegion, "001") == 0) {
+            fRegion[0] = 0;
+        }
     }
     delete tz;
 
@@ -944,6 +973,86 @@ TimeZoneNamesImpl::loadStrings(const UnicodeString& tzCanonicalID) {
     }
 }
 
+/*
+ * Loads the strings of the canonical zones of the region, or of all
+ * zones if region is NULL.
+ * This method updates the cache and must be called with a lock.
+ */
+void
+TimeZoneNamesImpl::loadZoneStrings(const char* region, UErrorCode& status) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    StringEnumeration *tzIDs = TimeZone::createTimeZoneIDEnumeration(UCAL_ZONE_TYPE_CANONICAL, region, NULL, status);
+    if (U_SUCCESS(status)) {
+        const UnicodeString *id;
+        while ((id = tzIDs->snext(status))) {
+            if (U_FAILURE(status)) {
+                break;
+            }
+            // loadStrings also load related metazone strings
+            loadStrings(*id);
+        }
+    }
+    if (tzIDs != NULL) {
+        delete tzIDs;
+    }
+}
+
+/*
+ * Loads the strings of all metazones, without those of the zones.
+ * This method updates the cache and must be called with a lock.
+ */
+void
+TimeZoneNamesImpl::loadMetaZoneStrings(UErrorCode& status) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    const UVector* mzIDs = ZoneMeta::getAvailableMetazoneIDs();
+    if (mzIDs == NULL) {
+        return;
+    }
+    for (int32_t i = 0; i < mzIDs->size(); i++) {
+        loadMetaZoneNames(UnicodeString(TRUE, (const UChar *)mzIDs->elementAt(i), -1));
+    }
+}
+
+/*
+ * Loads the strings of the next stage into the trie for find().
+ * This method updates the cache and must be called with a lock.
+ */
+void
+TimeZoneNamesImpl::loadMoreStrings(UErrorCode& status) {
+    const char* country = fLocale.getCountry();
+
+    switch (fNamesTrieStage) {
+    case NAMES_STAGE_DEFAULT_ZONE:
+        if (fRegion[0] != 0 || country[0] != 0) {
+            if (fRegion[0] != 0) {
+                loadZoneStrings(fRegion, status);
+            }
+            if (country[0] != 0 && uprv_strcmp(country, fRegion) != 0) {
+                loadZoneStrings(country, status);
+            }
+            fNamesTrieStage = NAMES_STAGE_REGION;
+#if UCONFIG_TZNAMES_REGION_ONLY
+            fNamesTrieFullyLoaded = TRUE;
+#endif
+            break;
+        }
+        // no region, the region only option does not apply - fall through
+    case NAMES_STAGE_REGION:
+        loadMetaZoneStrings(status);
+        fNamesTrieStage = NAMES_STAGE_META_ZONES;
+        break;
+    default:
+        loadZoneStrings(NULL, status);
+        fNamesTrieStage = NAMES_STAGE_ALL_ZONES;
+        fNamesTrieFullyLoaded = U_SUCCESS(status);
+        break;
+    }
+}
+
 TimeZoneNamesImpl::~TimeZoneNamesImpl() {
     cleanup();
 }
@@ -1280,64 +1389,44 @@ TimeZoneNamesImpl::find(const UnicodeString& text, int32_t start, uint32_t types
 
     TimeZoneNamesImpl *nonConstThis = const_cast<TimeZoneNamesImpl *>(this);
 
-    umtx_lock(&gLock);
-    {
-        fNamesTrie.search(text, start, (TextTrieMapSearchResultHandler *)&handler, status);
-    }
-    umtx_unlock(&gLock);
+    // Parsing mostly sees names of the device's own zones, so more names
+    // are loaded, stage by stage, only while there is no perfect match
+    for (;;) {
+        umtx_lock(&gLock);
+        {
+            fNamesTrie.search(text, start, (TextTrieMapSearchResultHandler *)&handler, status);
+        }
+        umtx_unlock(&gLock);
 
-    if (U_FAILURE(status)) {
-        return NULL;
-    }
+        if (U_FAILURE(status)) {
+            return NULL;
+        }
 
-    int32_t maxLen = 0;
-    TimeZoneNames::MatchInfoCollection* matches = handler.getMatches(maxLen);
-    if (matches != NULL && ((maxLen == (text.length() - start)) || fNamesTrieFullyLoaded)) {
-        // perfect match
-        return matches;
-    }
+        int32_t maxLen = 0;
+        TimeZoneNames::MatchInfoCollection* matches = handler.getMatches(maxLen);
+        if (matches != NULL && ((maxLen == (text.length() - start)) || fNamesTrieFullyLoaded)) {
+            // perfect match, or all the names there are
+            return matches;
+        }
 
-    delete matches;
+        delete matches;
 
-    // All names are not yet loaded into the trie
-    umtx_lock(&gLock);
-    {
-        if (!fNamesTrieFullyLoaded) {
-            const UnicodeString *id;
-
-            // load strings for all zones
-            StringEnumeration *tzIDs = TimeZone::createTimeZoneIDEnumeration(UCAL_ZONE_TYPE_CANONICAL, NULL, NULL, status);
-            if (U_SUCCESS(status)) {
-                while ((id = tzIDs->snext(status))) {
-                    if (U_FAILURE(status)) {
-                        break;
-                    }
-                    // loadStrings also load related metazone strings
-                    nonConstThis->loadStrings(*id);
-                }
-            }
-            if (tzIDs != NULL) {
-                delete tzIDs;
-            }
-            if (U_SUCCESS(status)) {
-                nonConstThis->fNamesTrieFullyLoaded = TRUE;
-            }
+        if (fNamesTrieFullyLoaded) {
+            return NULL;
         }
-    }
-    umtx_unlock(&gLock);
 
-    if (U_FAILURE(status)) {
-        return NULL;
-    }
+        umtx_lock(&gLock);
+        {
+            if (!fNamesTrieFullyLoaded) {
+                nonConstThis->loadMoreStrings(status);
+            }
+        }
+        umtx_unlock(&gLock);
 
-    umtx_lock(&gLock);
-    {
-        // now try it again
-        fNamesTrie.search(text, start, (TextTrieMapSearchResultHandler *)&handler, status);
+        if (U_FAILURE(status)) {
+            return NULL;
+        }
     }
-    umtx_unlock(&gLock);
-
-    return handler.getMatches(maxLen);
 }
 
 static const UChar gEtcPrefix[]         = { 0x45, 0x74, 0x63, 0x2F }; // "Etc/"
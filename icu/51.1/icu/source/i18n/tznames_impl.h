@@ -196,12 +196,18 @@ private:
     UHashtable* fMZNamesMap;
 
     UBool fNamesTrieFullyLoaded;
+    int32_t fNamesTrieStage;
     TextTrieMap fNamesTrie;
 
+    char fRegion[ULOC_COUNTRY_CAPACITY];
+
     void initialize(const Locale& locale, UErrorCode& status);
     void cleanup();
 
     void loadStrings(const UnicodeString& tzCanonicalID);
+    void loadZoneStrings(const char* region, UErrorCode& status);
+    void loadMetaZoneStrings(UErrorCode& status);
+    void loadMoreStrings(UErrorCode& status);
 
     ZNames* loadMetaZoneNames(const UnicodeString& mzId);
     TZNames* loadTimeZoneNames(const UnicodeString& mzId);
@@ -42,11 +42,13 @@ typedef enum ECleanupI18NType {
     UCLN_I18N_ZONEMETA,
     UCLN_I18N_TIMEZONE,
     UCLN_I18N_PLURAL_RULE,
+    UCLN_I18N_MSGFMT,
     UCLN_I18N_CURRENCY,
     UCLN_I18N_DECFMT,
     UCLN_I18N_NUMFMT,
     UCLN_I18N_SMPDTFMT,
     UCLN_I18N_USEARCH,
+    UCLN_I18N_ALPHAINDEX,
     UCLN_I18N_COLLATOR,
     UCLN_I18N_UCOL,
     UCLN_I18N_UCOL_RES,
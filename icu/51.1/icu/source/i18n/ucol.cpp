@@ -39,6 +39,7 @@
 #include "utracimp.h"
 #include "putilimp.h"
 #include "uassert.h"
+#include "uarrsort.h"
 #include "unicode/coll.h"
 
 #ifdef UCOL_DEBUG
@@ -4559,6 +4560,113 @@ ucol_getSortKey(const    UCollator    *coll,
     return keySize;
 }
 
+U_CAPI int32_t U_EXPORT2
+ucol_getSortKeys(const UCollator *coll,
+                 const UChar *const sources[],
+                 const int32_t sourceLengths[],
+                 int32_t count,
+                 int32_t maxKeyLength,
+                 uint8_t *dest,
+                 int32_t destCapacity,
+                 int32_t keyIndexes[],
+                 UErrorCode *status)
+{
+    if(status == NULL || U_FAILURE(*status)) {
+        return 0;
+    }
+    if(coll == NULL || count < 0 || (count > 0 && sources == NULL) || keyIndexes == NULL ||
+        maxKeyLength < 0 || maxKeyLength == 1 ||
+        destCapacity < 0 || (dest == NULL && destCapacity > 0)) {
+        *status = U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+
+    int32_t length = 0;
+    for(int32_t i = 0; i < count; ++i) {
+        const UChar *source = sources[i];
+        int32_t sourceLength = sourceLengths != NULL ? sourceLengths[i] : -1;
+        if(source == NULL && sourceLength != 0) {
+            *status = U_ILLEGAL_ARGUMENT_ERROR;
+            return 0;
+        }
+
+        keyIndexes[i] = length;
+        uint8_t *key = dest != NULL ? dest + length : NULL;
+        int32_t available = destCapacity > length ? destCapacity - length : 0;
+        int32_t keyLength;
+        if(coll->delegate == NULL) {
+            // Write the key straight into the buffer. When truncating, leave room
+            // for the terminating zero byte, which the generator would write last.
+            if(maxKeyLength > 0 && available > maxKeyLength - 1) {
+                available = maxKeyLength - 1;
+            }
+            FixedSortKeyByteSink sink(reinterpret_cast<char *>(key), available);
+            coll->sortKeyGen(coll, source, sourceLength, sink, status);
+            keyLength = sink.NumberOfBytesAppended();
+        } else {
+            CollationKey collationKey;
+            ((const Collator*)coll->delegate)->getCollationKey(source, sourceLength, collationKey, *status);
+            const uint8_t *bytes = collationKey.getByteArray(keyLength);
+            int32_t n = keyLength;
+            if(maxKeyLength > 0 && n > maxKeyLength - 1) {
+                n = maxKeyLength - 1;
+            }
+            if(n > available) {
+                n = available;
+            }
+            if(U_SUCCESS(*status) && n > 0) {
+                uprv_memcpy(key, bytes, n);
+            }
+        }
+        if(U_FAILURE(*status)) {
+            return 0;
+        }
+        if(maxKeyLength > 0 && keyLength > maxKeyLength) {
+            keyLength = maxKeyLength;
+            if(length + keyLength <= destCapacity) {
+                key[keyLength - 1] = 0;
+            }
+        }
+        length += keyLength;
+    }
+    keyIndexes[count] = length;
+    if(length > destCapacity) {
+        *status = U_BUFFER_OVERFLOW_ERROR;
+    }
+    return length;
+}
+
+U_CDECL_BEGIN
+static int32_t U_CALLCONV
+compareSortKeyIndexes(const void *context, const void *left, const void *right) {
+    const uint8_t *keys = (const uint8_t *)((const void **)context)[0];
+    const int32_t *keyIndexes = (const int32_t *)((const void **)context)[1];
+    return uprv_strcmp((const char *)keys + keyIndexes[*(const int32_t *)left],
+                       (const char *)keys + keyIndexes[*(const int32_t *)right]);
+}
+U_CDECL_END
+
+U_CAPI void U_EXPORT2
+ucol_sortBySortKeys(const uint8_t *keys,
+                    const int32_t keyIndexes[],
+                    int32_t count,
+                    int32_t order[],
+                    UErrorCode *status)
+{
+    if(status == NULL || U_FAILURE(*status)) {
+        return;
+    }
+    if(count < 0 || (count > 0 && (keys == NULL || keyIndexes == NULL || order == NULL))) {
+        *status = U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+    for(int32_t i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+    const void *context[2] = { keys, keyIndexes };
+    uprv_sortArray(order, count, (int32_t)sizeof(int32_t), compareSortKeyIndexes, context, TRUE, status);
+}
+
 U_CFUNC int32_t
 ucol_getCollationKey(const UCollator *coll,
                      const UChar *source, int32_t sourceLength,
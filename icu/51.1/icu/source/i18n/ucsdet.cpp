@@ -1,6 +1,6 @@
 /*
  ********************************************************************************
- *   Copyright (C) 2005-2007, International Business Machines
+ *   Copyright (C) 2005-2013, International Business Machines
  *   Corporation and others.  All Rights Reserved.
  ********************************************************************************
  */
@@ -57,6 +57,27 @@ ucsdet_setText(UCharsetDetector *ucsd, const char *textIn, int32_t len, UErrorCo
     ((CharsetDetector *) ucsd)->setText(textIn, len);
 }
 
+U_CAPI UBool U_EXPORT2
+ucsdet_appendText(UCharsetDetector *ucsd, const char *textIn, int32_t len, UErrorCode *status)
+{
+    if(U_FAILURE(*status)) {
+        return FALSE;
+    }
+
+    return ((CharsetDetector *) ucsd)->appendText(textIn, len, *status);
+}
+
+U_CAPI int32_t U_EXPORT2
+ucsdet_setConfidenceThreshold(UCharsetDetector *ucsd, int32_t threshold)
+{
+    // todo: could use an error return...
+    if (ucsd == NULL) {
+        return 0;
+    }
+
+    return ((CharsetDetector *) ucsd)->setConfidenceThreshold(threshold);
+}
+
 U_CAPI const char * U_EXPORT2
 ucsdet_getName(const UCharsetMatch *ucsm, UErrorCode *status)
 {
@@ -692,6 +692,7 @@ private:
      */
     void initLabels(UVector &indexCharacters, UErrorCode &errorCode) const;
     BucketList *createBucketList(UErrorCode &errorCode) const;
+    BucketList *getLabelBuckets(UErrorCode &errorCode) const;
     void initBuckets(UErrorCode &errorCode);
     void clearBuckets();
     void internalResetBucketIterator();
@@ -747,6 +748,9 @@ private:
     // Lazy evaluated: null means that we have not built yet.
     BucketList *buckets_;
 
+    UnicodeString  localeName_;       // The locale of the collator and labels,
+                                      //   bogus if the caller gave the collator.
+
     UnicodeString  inflowLabel_;
     UnicodeString  overflowLabel_;
     UnicodeString  underflowLabel_;
@@ -2280,6 +2280,29 @@ private:
      */
     void computeWeekFields(UErrorCode &ec);
 
+    /**
+     * Set the date fields and the zone offsets of the UTC time
+     * <code>utc</code> from the day cache, if it falls in a local day of
+     * this zone computed lately with the same calendar settings.
+     * @return TRUE if the fields were set
+     */
+    UBool getCachedDayFields(double utc, int32_t& rawOffset, int32_t& dstOffset, int32_t& days);
+
+    /**
+     * Put the date fields just computed for the UTC time <code>utc</code>,
+     * in local day <code>days</code>, into the day cache, with the UTC
+     * range over which they and the zone offsets hold.
+     */
+    void cacheDayFields(double utc, int32_t rawOffset, int32_t dstOffset, int32_t days);
+
+    /**
+     * Get the zone offset for the local wall time <code>wall</code> from
+     * the day cache, if it falls in a local day without any zone transition
+     * near it, so that it is neither skipped nor repeated.
+     * @return TRUE if the offset was found
+     */
+    UBool getCachedZoneOffset(double wall, int32_t& zoneOffset) const;
+
 
     /**
      * Ensure that each field is within its valid range by calling {@link
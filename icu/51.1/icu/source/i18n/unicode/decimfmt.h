@@ -2434,6 +2434,30 @@ protected:
      * Called whenever any state changes. Recomputes whether fastpath is OK to use.
      */
     void handleChanged();
+
+    /**
+     * Fixed point fastpath for double values. Returns FALSE, leaving
+     * appendTo untouched, if the number must go through DigitList.
+     */
+    UBool _formatFixed(double number,
+                       UnicodeString& appendTo,
+                       FieldPositionHandler& handler,
+                       UErrorCode& status) const;
+
+    /**
+     * Formats already rounded digits the way subformat() does for fixed
+     * point patterns, without building a DigitList.
+     * @param digits ASCII digits with no trailing zeros, none for zero.
+     * @param decimalAt the position of the decimal point relative to digits.
+     */
+    UnicodeString& formatFixedDigits(UnicodeString& appendTo,
+                                     FieldPositionHandler& handler,
+                                     const char *digits,
+                                     int32_t digitCount,
+                                     int32_t decimalAt,
+                                     UBool isNegative,
+                                     double number,
+                                     UErrorCode& status) const;
 #endif
 };
 
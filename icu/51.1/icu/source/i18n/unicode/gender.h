@@ -97,6 +97,7 @@ private:
 
     static const GenderInfo* loadInstance(const Locale& locale, UErrorCode& status);
     friend class ::GenderInfoTest;
+    friend void GenderInfo_initCache(UErrorCode &status);
 };
 
 U_NAMESPACE_END
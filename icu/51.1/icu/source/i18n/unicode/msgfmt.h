@@ -834,8 +834,50 @@ public:
      * @internal
      */
     int32_t getArgTypeCount() const;
+
+    /**
+     * This API is for ICU internal use only.
+     * Please do not use it.
+     *
+     * Gets the statistics of the process-wide cache of compiled patterns.
+     * applyPattern() and the constructors look up the locale and a pattern
+     * with typed arguments, such as "{0,date,short}", there, and on a hit
+     * copy the subformats instead of creating them again.
+     *
+     * @param hits    Output param set to the number of patterns found in the cache.
+     * @param misses  Output param set to the number of patterns whose
+     *                subformats were created.
+     * @internal
+     */
+    static void U_EXPORT2 getPatternCacheStatistics(int32_t& hits, int32_t& misses);
 #endif  /* U_HIDE_INTERNAL_API */
 
+#ifndef U_HIDE_DRAFT_API
+    /**
+     * Freeze this formatter, so that it can be shared by several threads
+     * without cloning it.  Formatting with a frozen formatter does not
+     * modify the formatter: the default number and date formats and the
+     * plural rules, otherwise created on first use, are created here.
+     * applyPattern(), setLocale(), the format setters and the assignment
+     * operator do nothing once the formatter is frozen, and the adopt
+     * functions just delete what they are given.
+     *
+     * Parsing with a frozen formatter, getFormats() and getFormat() are
+     * not thread-safe.  A copy or clone of a frozen formatter is not frozen.
+     *
+     * @return this
+     * @draft ICU 52
+     */
+    MessageFormat *freeze();
+
+    /**
+     * Determines whether this formatter is frozen.
+     * @return TRUE if freeze() has been called on this formatter.
+     * @draft ICU 52
+     */
+    UBool isFrozen() const;
+#endif  /* U_HIDE_DRAFT_API */
+
     /**
      * Returns a unique class ID POLYMORPHICALLY.  Pure virtual override.
      * This method is to implement a simple version of RTTI, since not all
@@ -942,6 +984,8 @@ private:
     PluralSelectorProvider pluralProvider;
     PluralSelectorProvider ordinalProvider;
 
+    UBool fFrozen;
+
     /**
      * Method to retrieve default formats (or NULL on failure).
      * These are semantically const, but may modify *this.
@@ -221,6 +221,20 @@ public:
     static PluralRules* U_EXPORT2 forLocale(const Locale& locale, UPluralType type, UErrorCode& status);
 #endif /* U_HIDE_DRAFT_API */
 
+#ifndef U_HIDE_INTERNAL_API
+    /**
+     * Gets the statistics of the process-wide cache of the parsed rules of
+     * recently used locales, from which forLocale() returns copies.
+     *
+     * @param hits    Output param set to the number of forLocale() calls
+     *                that found the rules in the cache.
+     * @param misses  Output param set to the number of forLocale() calls
+     *                that parsed the rules from the resources.
+     * @internal
+     */
+    static void U_EXPORT2 getCacheStatistics(int32_t& hits, int32_t& misses);
+#endif  /* U_HIDE_INTERNAL_API */
+
     /**
      * Given a number, returns the keyword of the first rule that applies to
      * the number.  This function can be used with isKeyword* functions to
@@ -59,6 +59,7 @@ U_NAMESPACE_BEGIN
 
 struct Regex8BitSet;
 class  RegexCImpl;
+class  RegexDFA;
 class  RegexMatcher;
 class  RegexPattern;
 struct REStackFrame;
@@ -608,6 +609,7 @@ private:
     friend class RegexCompile;
     friend class RegexMatcher;
     friend class RegexCImpl;
+    friend class RegexDFA;
 
     //
     //  Implementation Methods
@@ -1845,6 +1847,10 @@ private:
                                            //   reported, or that permanently disables this matcher.
 
     RuleBasedBreakIterator  *fWordBreakItr;
+
+    RegexDFA           *fDFA;              // Prefilter for find(), built on first use.
+                                           //   NULL if the pattern can not use one.
+    UBool               fDFABuilt;         // True once fDFA has been built or ruled out.
 };
 
 U_NAMESPACE_END
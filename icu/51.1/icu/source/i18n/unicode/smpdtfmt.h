@@ -1300,6 +1300,40 @@ public:
      */
     virtual const TimeZoneFormat* getTimeZoneFormat(void) const;
 
+    /* Cannot use #ifndef U_HIDE_DRAFT_API for the following draft method since it is virtual */
+    /**
+     * Set the number formatter.  The caller should not delete the
+     * NumberFormat object after it is adopted by this call.
+     * @param formatToAdopt The NumberFormat object to be adopted.
+     * @draft ICU 52
+     */
+    virtual void adoptNumberFormat(NumberFormat* formatToAdopt);
+
+#ifndef U_HIDE_DRAFT_API
+    /**
+     * Freeze this formatter, so that it can be shared by several threads
+     * without cloning it.  Formatting a date with a frozen formatter does
+     * not modify the formatter.  The SimpleDateFormat setters, such as
+     * applyPattern() and adoptCalendar(), do nothing once the formatter
+     * is frozen; the inherited DateFormat setters, such as setLenient()
+     * and setTimeZone(), must not be called on it.
+     *
+     * Parsing with a frozen formatter is not thread-safe.
+     * A copy or clone of a frozen formatter is not frozen.
+     *
+     * @return this
+     * @draft ICU 52
+     */
+    SimpleDateFormat *freeze();
+
+    /**
+     * Determines whether this formatter is frozen.
+     * @return TRUE if freeze() has been called on this formatter.
+     * @draft ICU 52
+     */
+    UBool isFrozen() const;
+#endif  /* U_HIDE_DRAFT_API */
+
 #ifndef U_HIDE_INTERNAL_API
     /**
      * This is for ICU internal use only. Please do not use.
@@ -1415,6 +1449,19 @@ private:
                            int32_t minDigits,
                            int32_t maxDigits) const;
 
+    /**
+     * Split fPattern into the runs of pattern characters and the literal
+     * text between them, and store the result in fCompiledPattern, so that
+     * format() need not scan the pattern again.
+     */
+    void compilePattern();
+
+    /**
+     * Check whether fNumberFormat is a plain decimal format, which
+     * zeroPaddingNumber() can replace by writing the digits itself.
+     */
+    void initFastNumberFormat();
+
     /**
      * Return true if the given format character, occuring count
      * times, represents a numeric field.
@@ -1649,6 +1696,14 @@ private:
      */
     UnicodeString       fPattern;
 
+    /**
+     * fPattern, split up by compilePattern().  A run of a pattern character
+     * is stored as the character, followed by the repeat count in two
+     * UChars (high and low half); literal text as a zero UChar, followed
+     * by the length in two UChars and then the unquoted text itself.
+     */
+    UnicodeString       fCompiledPattern;
+
     /**
      * The numbering system override for dates.
      */
@@ -1706,6 +1761,15 @@ private:
     UBool fHaveDefaultCentury;
 
     UDisplayContext fCapitalizationContext;
+
+    /**
+     * The digit zero of fNumberFormat, if zeroPaddingNumber() may
+     * format numbers with fNumberFormat by writing the digits itself;
+     * otherwise -1.
+     */
+    UChar32 fFastZeroDigit;
+
+    UBool fFrozen;
 };
 
 inline UDate
@@ -1094,6 +1094,26 @@ public:
      */
     static void U_EXPORT2 unregister(const UnicodeString& ID);
 
+#ifndef U_HIDE_DRAFT_API
+    /**
+     * Sets a directory in which the compiled form of rule-based system
+     * transliterators is cached.  When a system transliterator is
+     * instantiated from rules for the first time, the parsed rules are
+     * written to a file in this directory; later instantiations, also in
+     * other processes, map that file instead of parsing the rules again.
+     * Files written by another version of ICU are ignored.
+     *
+     * The cache is off by default.  Failures to read or write cache files
+     * are not reported; the rules are parsed as usual.
+     *
+     * @param path the directory, which must exist and be writable for the
+     * cache to be filled, or NULL or "" to turn the cache off
+     * @param status input-output error code
+     * @draft ICU 52
+     */
+    static void U_EXPORT2 setRuleCacheDirectory(const char *path, UErrorCode &status);
+#endif  /* U_HIDE_DRAFT_API */
+
 public:
 
     /**
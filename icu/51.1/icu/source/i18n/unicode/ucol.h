@@ -977,6 +977,78 @@ ucol_getSortKey(const    UCollator    *coll,
         uint8_t        *result,
         int32_t        resultLength);
 
+#ifndef U_HIDE_DRAFT_API
+/**
+ * Get the sort keys for an array of strings, written one after the other
+ * into a single buffer. This is faster than calling ucol_getSortKey()
+ * for each string, and the keys need only one allocation.
+ *
+ * Key i starts at dest+keyIndexes[i] and is zero-terminated, like the keys
+ * from ucol_getSortKey(); keyIndexes[count] is the total length of the keys.
+ * If the buffer is too small, then U_BUFFER_OVERFLOW_ERROR is set, the
+ * keyIndexes are still set, and the contents of dest are undefined,
+ * so that the buffer size can be preflighted with dest=NULL, destCapacity=0.
+ *
+ * With a maxKeyLength, each key longer than that is truncated to
+ * maxKeyLength-1 bytes plus the terminating zero byte. Comparing truncated
+ * keys with strcmp() gives the same order as comparing the full keys,
+ * except that keys which compare equal may belong to different strings;
+ * for those, compare the strings with ucol_strcoll().
+ * Short primary-weight prefixes are usually enough to order most strings,
+ * so this can save much of the memory for the keys of large lists.
+ *
+ * @param coll The UCollator containing the collation rules.
+ * @param sources The strings to transform.
+ * @param sourceLengths The lengths of the strings, or NULL if all of them
+ *                      are NUL-terminated. A length of -1 means that
+ *                      the string is NUL-terminated.
+ * @param count The number of strings.
+ * @param maxKeyLength 0 for complete sort keys, otherwise the maximum
+ *                     length of each key including its terminating zero byte.
+ *                     Must be 0 or at least 2.
+ * @param dest A buffer to receive the sort keys.
+ * @param destCapacity The size of dest.
+ * @param keyIndexes An array of count+1 entries to receive the offsets
+ *                   of the keys in dest, and the total length.
+ * @param status A pointer to a UErrorCode to receive any errors.
+ * @return The size needed to store all of the sort keys.
+ * @see ucol_getSortKey
+ * @see ucol_sortBySortKeys
+ * @draft ICU 52
+ */
+U_DRAFT int32_t U_EXPORT2
+ucol_getSortKeys(const UCollator *coll,
+                 const UChar *const sources[],
+                 const int32_t sourceLengths[],
+                 int32_t count,
+                 int32_t maxKeyLength,
+                 uint8_t *dest,
+                 int32_t destCapacity,
+                 int32_t keyIndexes[],
+                 UErrorCode *status);
+
+/**
+ * Sort a parallel array of indexes by the sort keys from ucol_getSortKeys().
+ * On return, order[0..count-1] holds the numbers of the keys, and thus of the
+ * strings they were generated from, in sorted order. The sort is stable:
+ * strings with equal keys stay in their original order.
+ *
+ * @param keys The sort keys, as written by ucol_getSortKeys().
+ * @param keyIndexes The key offsets, as set by ucol_getSortKeys().
+ * @param count The number of keys.
+ * @param order An array of count entries to receive the sorted key numbers.
+ * @param status A pointer to a UErrorCode to receive any errors.
+ * @see ucol_getSortKeys
+ * @draft ICU 52
+ */
+U_DRAFT void U_EXPORT2
+ucol_sortBySortKeys(const uint8_t *keys,
+                    const int32_t keyIndexes[],
+                    int32_t count,
+                    int32_t order[],
+                    UErrorCode *status);
+#endif /* U_HIDE_DRAFT_API */
+
 
 /** Gets the next count bytes of a sort key. Caller needs
  *  to preserve state array between calls and to provide
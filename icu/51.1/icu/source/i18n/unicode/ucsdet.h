@@ -1,6 +1,6 @@
 /*
  **********************************************************************
- *   Copyright (C) 2005-2010, International Business Machines
+ *   Copyright (C) 2005-2013, International Business Machines
  *   Corporation and others.  All Rights Reserved.
  **********************************************************************
  *   file name:  ucsdet.h
@@ -121,6 +121,52 @@ U_NAMESPACE_END
 U_STABLE void U_EXPORT2
 ucsdet_setText(UCharsetDetector *ucsd, const char *textIn, int32_t len, UErrorCode *status);
 
+#ifndef U_HIDE_DRAFT_API
+/**
+  * Add the next chunk of input byte data whose charset is to be detected,
+  * for input that arrives piece by piece.
+  *
+  * The chunk is copied, so the caller may reuse its buffer at once.
+  * Text set with ucsdet_setText() becomes the start of the stream;
+  * calling ucsdet_setText() again starts over.
+  *
+  * The function returns TRUE once further input will not change the
+  * detection result: when the detector has buffered as much input as it
+  * examines, or, if a confidence threshold was set with
+  * ucsdet_setConfidenceThreshold(), as soon as the best match reaches it.
+  * Later chunks are ignored, and the caller can stop feeding data and call
+  * ucsdet_detect() or ucsdet_detectAll(), which then reuse the results.
+  *
+  * @param ucsd   the charset detector to be used.
+  * @param textIn the next chunk of the input text of unknown encoding.
+  * @param len    the length of the chunk, or -1 if it is NUL terminated.
+  * @param status any error conditions are reported back in this variable.
+  * @return       TRUE if detection is complete.
+  *
+  * @draft ICU 52
+  */
+U_DRAFT UBool U_EXPORT2
+ucsdet_appendText(UCharsetDetector *ucsd, const char *textIn, int32_t len, UErrorCode *status);
+
+/**
+  * Set a confidence level at which detection stops early.
+  * The charset recognizers are tried one after the other, and the first
+  * match with at least this confidence ends the detection; it is then the
+  * best match, and recognizers that were not tried are not in the results
+  * of ucsdet_detectAll().
+  * A byte order mark, for example, gives a confidence of 100.
+  *
+  * @param ucsd      the charset detector to be modified.
+  * @param threshold the confidence (1..100) at which to stop,
+  *                  or 0 (the default) to always try all recognizers.
+  * @return          the previous setting.
+  *
+  * @draft ICU 52
+  */
+U_DRAFT int32_t U_EXPORT2
+ucsdet_setConfidenceThreshold(UCharsetDetector *ucsd, int32_t threshold);
+#endif  /* U_HIDE_DRAFT_API */
+
 
 /** Set the declared encoding for charset detection.
  *  The declared encoding of an input text is an encoding obtained
@@ -132,6 +132,10 @@
  *  a set of identifiers, and then quickly test whether a new identifier is
  *  confusable with an identifier already in the set.  The uspoof_getSkeleton()
  *  family of functions will produce the skeleton from an identifier.
+ *  uspoof_openIndex() builds such a dictionary: identifiers are added with
+ *  uspoof_addToIndex(), and uspoof_findConfusables() returns all of those
+ *  that uspoof_areConfusable() would report as confusable with a given one,
+ *  computing the skeletons of each identifier only once.
  *
  *  Note that skeletons are not guaranteed to be stable between versions 
  *  of Unicode or ICU, so an applications should not rely on creating a permanent,
@@ -1026,6 +1030,203 @@ uspoof_getRecommendedUnicodeSet(UErrorCode *status);
 #endif /* U_SHOW_CPLUSPLUS_API */
 #endif /* U_HIDE_DRAFT_API */
 
+#ifndef U_HIDE_DRAFT_API
+
+struct USpoofIndex;
+/**
+  * An index of the skeletons of a set of identifiers, for finding the
+  * identifiers in the set that are confusable with another one.
+  * @draft ICU 52
+  */
+typedef struct USpoofIndex USpoofIndex;
+
+/**
+  * Open an empty index of identifier skeletons.
+  *
+  * The index uses the confusable checks and the data of the spoof checker:
+  * uspoof_findConfusables() reports the identifiers for which
+  * uspoof_areConfusable() with that checker would return a non-zero result.
+  * The checks set on the checker after the index has been opened do
+  * not affect the index.
+  *
+  * The spoof checker must not be closed while the index is in use, and
+  * the checker and the index must not be used concurrently from
+  * multiple threads.
+  *
+  * @param sc      The USpoofChecker.  At least one of the
+  *                USPOOF_SINGLE_SCRIPT_CONFUSABLE, USPOOF_MIXED_SCRIPT_CONFUSABLE
+  *                and USPOOF_WHOLE_SCRIPT_CONFUSABLE checks must be set,
+  *                otherwise U_INVALID_STATE_ERROR is returned.
+  * @param status  The error code, set if the index could not be opened.
+  * @return        The new index, to be closed with uspoof_closeIndex().
+  * @draft ICU 52
+  */
+U_DRAFT USpoofIndex * U_EXPORT2
+uspoof_openIndex(const USpoofChecker *sc, UErrorCode *status);
+
+/**
+  * Close an index of identifier skeletons and free its memory.
+  * @param index   The index, may be NULL.
+  * @draft ICU 52
+  */
+U_DRAFT void U_EXPORT2
+uspoof_closeIndex(USpoofIndex *index);
+
+/**
+  * Compute the skeletons of an identifier and add it to the index.
+  * The identifiers are numbered from 0 in the order in which they are added;
+  * the same identifier may be added more than once.
+  *
+  * @param index   The index.
+  * @param id      The identifier to add.
+  * @param length  The length of the identifier, expressed in
+  *                16 bit UTF-16 code units, or -1 if the string is
+  *                zero terminated.
+  * @param status  The error code, set if an error occurred.
+  * @return        The number of the identifier in the index.
+  * @draft ICU 52
+  */
+U_DRAFT int32_t U_EXPORT2
+uspoof_addToIndex(USpoofIndex *index,
+                  const UChar *id, int32_t length,
+                  UErrorCode *status);
+
+/**
+  * Compute the skeletons of an identifier and add it to the index.
+  * Like uspoof_addToIndex(), but for a UTF-8 identifier.
+  *
+  * @param index   The index.
+  * @param id      The UTF-8 identifier to add.
+  * @param length  The length of the identifier, in bytes,
+  *                or -1 if the string is zero terminated.
+  * @param status  The error code, set if an error occurred.  Possible errors
+  *                include U_INVALID_CHAR_FOUND for invalid UTF-8 sequences.
+  * @return        The number of the identifier in the index.
+  * @draft ICU 52
+  */
+U_DRAFT int32_t U_EXPORT2
+uspoof_addToIndexUTF8(USpoofIndex *index,
+                      const char *id, int32_t length,
+                      UErrorCode *status);
+
+/**
+  * Get the number of identifiers that have been added to the index.
+  * @param index   The index.
+  * @param status  The error code.
+  * @return        The number of identifiers.
+  * @draft ICU 52
+  */
+U_DRAFT int32_t U_EXPORT2
+uspoof_getIndexSize(const USpoofIndex *index, UErrorCode *status);
+
+/**
+  * Find the identifiers in the index that are confusable with another one.
+  * The skeletons of id are computed once and looked up in the index, rather
+  * than compared with each identifier in turn as with uspoof_areConfusable().
+  *
+  * @param index   The index.
+  * @param id      The identifier to look up.
+  * @param length  The length of the identifier, expressed in
+  *                16 bit UTF-16 code units, or -1 if the string is
+  *                zero terminated.
+  * @param dest    Receives the numbers of the confusable identifiers,
+  *                as returned by uspoof_addToIndex(), in ascending order.
+  *                May be NULL if destCapacity is 0.
+  * @param results If not NULL, receives for each number in dest the
+  *                result that uspoof_areConfusable() would return for id
+  *                and that identifier.
+  * @param destCapacity The capacity of dest and of results.
+  * @param status  The error code.  U_BUFFER_OVERFLOW_ERROR is set if
+  *                there are more than destCapacity confusable identifiers.
+  * @return        The number of confusable identifiers, even if it is
+  *                greater than destCapacity.
+  * @draft ICU 52
+  */
+U_DRAFT int32_t U_EXPORT2
+uspoof_findConfusables(const USpoofIndex *index,
+                       const UChar *id, int32_t length,
+                       int32_t *dest, int32_t *results, int32_t destCapacity,
+                       UErrorCode *status);
+
+/**
+  * Find the identifiers in the index that are confusable with another one.
+  * Like uspoof_findConfusables(), but for a UTF-8 identifier.
+  *
+  * @param index   The index.
+  * @param id      The UTF-8 identifier to look up.
+  * @param length  The length of the identifier, in bytes,
+  *                or -1 if the string is zero terminated.
+  * @param dest    Receives the numbers of the confusable identifiers,
+  *                in ascending order.  May be NULL if destCapacity is 0.
+  * @param results If not NULL, receives the uspoof_areConfusable() result
+  *                for each number in dest.
+  * @param destCapacity The capacity of dest and of results.
+  * @param status  The error code.
+  * @return        The number of confusable identifiers.
+  * @draft ICU 52
+  */
+U_DRAFT int32_t U_EXPORT2
+uspoof_findConfusablesUTF8(const USpoofIndex *index,
+                           const char *id, int32_t length,
+                           int32_t *dest, int32_t *results, int32_t destCapacity,
+                           UErrorCode *status);
+
+#if U_SHOW_CPLUSPLUS_API
+
+/**
+  * Compute the skeletons of an identifier and add it to the index.
+  * Like uspoof_addToIndex(), but for a UnicodeString.
+  *
+  * @param index   The index.
+  * @param id      The identifier to add.
+  * @param status  The error code.
+  * @return        The number of the identifier in the index.
+  * @draft ICU 52
+  */
+U_DRAFT int32_t U_EXPORT2
+uspoof_addToIndexUnicodeString(USpoofIndex *index,
+                               const icu::UnicodeString &id,
+                               UErrorCode *status);
+
+/**
+  * Find the identifiers in the index that are confusable with another one.
+  * Like uspoof_findConfusables(), but for a UnicodeString.
+  *
+  * @param index   The index.
+  * @param id      The identifier to look up.
+  * @param dest    Receives the numbers of the confusable identifiers,
+  *                in ascending order.  May be NULL if destCapacity is 0.
+  * @param results If not NULL, receives the uspoof_areConfusable() result
+  *                for each number in dest.
+  * @param destCapacity The capacity of dest and of results.
+  * @param status  The error code.
+  * @return        The number of confusable identifiers.
+  * @draft ICU 52
+  */
+U_DRAFT int32_t U_EXPORT2
+uspoof_findConfusablesUnicodeString(const USpoofIndex *index,
+                                    const icu::UnicodeString &id,
+                                    int32_t *dest, int32_t *results, int32_t destCapacity,
+                                    UErrorCode *status);
+
+U_NAMESPACE_BEGIN
+
+/**
+ * \class LocalUSpoofIndexPointer
+ * "Smart pointer" class, closes a USpoofIndex via uspoof_closeIndex().
+ * For most methods see the LocalPointerBase base class.
+ *
+ * @see LocalPointerBase
+ * @see LocalPointer
+ * @draft ICU 52
+ */
+U_DEFINE_LOCAL_OPEN_POINTER(LocalUSpoofIndexPointer, USpoofIndex, uspoof_closeIndex);
+
+U_NAMESPACE_END
+
+#endif /* U_SHOW_CPLUSPLUS_API */
+#endif /* U_HIDE_DRAFT_API */
+
 /**
  * Serialize the data for a spoof detector into a chunk of memory.
  * The flattened spoof detection tables can later be used to efficiently
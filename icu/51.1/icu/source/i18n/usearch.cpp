@@ -1,6 +1,6 @@
 /*
 **********************************************************************
-*   Copyright (C) 2001-2011 IBM and others. All rights reserved.
+*   Copyright (C) 2001-2013 IBM and others. All rights reserved.
 **********************************************************************
 *   Date        Name        Description
 *  07/02/2001   synwee      Creation.
@@ -355,6 +355,56 @@ inline uint16_t initializePatternCETable(UStringSearch *strsrch,
     return result;
 }
 
+/**
+* Initializes the table of Latin-1 characters that usearch_search() may skip
+* before it starts comparing collation elements.
+* A character is skipped if its first processed collation element is not the
+* first one of the pattern, so that no match can begin with it, and if it can
+* not take part in a contraction or prefix match with its neighbours.
+* Alternate shifted and numeric collation make the collation elements of a
+* character depend on the characters before it; the table is not used then.
+* Internal method, status assumed to be a success.
+* @param strsrch string search data, with the pce table of the pattern
+* @param coleiter collation element iterator to use for the Latin-1 characters
+* @param status output error if any
+*/
+static
+void initializePatternStartSkip(UStringSearch      *strsrch,
+                                UCollationElements *coleiter,
+                                UErrorCode         *status)
+{
+          UPattern  *pattern  = &(strsrch->pattern);
+    const UCollator *collator = strsrch->collator;
+
+    pattern->hasStartSkip = FALSE;
+    if (pattern->PCELength == 0 ||
+        ucol_getAttribute(collator, UCOL_ALTERNATE_HANDLING, status) == UCOL_SHIFTED ||
+        ucol_getAttribute(collator, UCOL_NUMERIC_COLLATION, status) == UCOL_ON ||
+        U_FAILURE(*status)) {
+        return;
+    }
+
+    int64_t firstPCE = pattern->PCE[0];
+    UChar   c;
+    for (int32_t i = 0; i < LENGTHOF(pattern->startSkip); i ++) {
+        c = (UChar)i;
+        uint32_t ce = collator->latinOneMapping[c];
+        if ((ce > UCOL_NOT_FOUND && (isContraction(ce) || isPrefix(ce))) ||
+            ucol_unsafeCP(c, collator)) {
+            pattern->startSkip[i] = FALSE;
+            continue;
+        }
+        ucol_setText(coleiter, &c, 1, status);
+        uprv_init_pce(coleiter);
+        int64_t pce = ucol_nextProcessed(coleiter, NULL, NULL, status);
+        if (U_FAILURE(*status)) {
+            return;
+        }
+        pattern->startSkip[i] = (UBool)(pce != firstPCE);
+    }
+    pattern->hasStartSkip = TRUE;
+}
+
 /**
 * Initializing the pce table for a pattern.
 * Stores non-ignorable collation keys.
@@ -432,6 +482,10 @@ inline uint16_t initializePatternPCETable(UStringSearch *strsrch,
     pattern->PCE       = pcetable;
     pattern->PCELength = offset;
 
+    initializePatternStartSkip(strsrch, coleiter, status);
+    // the skip table used coleiter for single characters
+    ucol_setText(coleiter, pattern->text, patternlength, status);
+
     return result;
 }
 
@@ -2721,6 +2775,7 @@ U_CAPI UStringSearch * U_EXPORT2 usearch_openFromCollator(
         result->pattern.textLength = patternlength;
         result->pattern.CE         = NULL;
         result->pattern.PCE        = NULL;
+        result->pattern.hasStartSkip = FALSE;
 
         result->search->breakIter  = breakiter;
 #if !UCONFIG_NO_BREAK_ITERATION
@@ -3837,6 +3892,26 @@ U_CAPI UBool U_EXPORT2 usearch_search(UStringSearch  *strsrch,
         initializePatternPCETable(strsrch, status);
     }
 
+    // Skip Latin-1 text at which no match can begin without
+    // computing its collation elements.
+    if (strsrch->pattern.hasStartSkip &&
+        strsrch->search->elementComparisonType == 0) {
+        const UChar *text    = strsrch->search->text;
+        int32_t      textLen = strsrch->search->textLength;
+        const UBool *skip    = strsrch->pattern.startSkip;
+        int32_t      i       = startIdx;
+
+        while (i < textLen && text[i] <= 0xFF && skip[text[i]]) {
+            i += 1;
+        }
+
+        // Start at the last skipped character, so that the characters
+        // after it are seen in the same normalization context as before.
+        if (i > startIdx) {
+            startIdx = i - 1;
+        }
+    }
+
     ucol_setOffset(strsrch->textIter, startIdx, status);
     CEBuffer ceb(strsrch, status);
 
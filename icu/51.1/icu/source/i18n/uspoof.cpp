@@ -691,6 +691,141 @@ uspoof_getSkeletonUTF8(const USpoofChecker *sc,
 }
 
 
+U_CAPI USpoofIndex * U_EXPORT2
+uspoof_openIndex(const USpoofChecker *sc, UErrorCode *status) {
+    if (U_FAILURE(*status)) {
+        return NULL;
+    }
+    SpoofIndex *index = new SpoofIndex(sc, *status);
+    if (index == NULL) {
+        *status = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    if (U_FAILURE(*status)) {
+        delete index;
+        return NULL;
+    }
+    return (USpoofIndex *)index;
+}
+
+
+U_CAPI void U_EXPORT2
+uspoof_closeIndex(USpoofIndex *index) {
+    UErrorCode status = U_ZERO_ERROR;
+    SpoofIndex *This = SpoofIndex::validateThis(index, status);
+    delete This;
+}
+
+
+U_CAPI int32_t U_EXPORT2
+uspoof_addToIndexUnicodeString(USpoofIndex *index,
+                               const UnicodeString &id,
+                               UErrorCode *status) {
+    SpoofIndex *This = SpoofIndex::validateThis(index, *status);
+    if (U_FAILURE(*status)) {
+        return -1;
+    }
+    return This->add(id, *status);
+}
+
+
+U_CAPI int32_t U_EXPORT2
+uspoof_addToIndex(USpoofIndex *index,
+                  const UChar *id, int32_t length,
+                  UErrorCode *status) {
+    SpoofIndex::validateThis(index, *status);
+    if (U_FAILURE(*status)) {
+        return -1;
+    }
+    if (length < -1) {
+        *status = U_ILLEGAL_ARGUMENT_ERROR;
+        return -1;
+    }
+    UnicodeString idStr((length==-1), id, length);  // Aliasing constructor
+    return uspoof_addToIndexUnicodeString(index, idStr, status);
+}
+
+
+U_CAPI int32_t U_EXPORT2
+uspoof_addToIndexUTF8(USpoofIndex *index,
+                      const char *id, int32_t length,
+                      UErrorCode *status) {
+    SpoofIndex::validateThis(index, *status);
+    if (U_FAILURE(*status)) {
+        return -1;
+    }
+    if (length < -1) {
+        *status = U_ILLEGAL_ARGUMENT_ERROR;
+        return -1;
+    }
+    UnicodeString idStr = UnicodeString::fromUTF8(StringPiece(id, length>=0 ? length : uprv_strlen(id)));
+    return uspoof_addToIndexUnicodeString(index, idStr, status);
+}
+
+
+U_CAPI int32_t U_EXPORT2
+uspoof_getIndexSize(const USpoofIndex *index, UErrorCode *status) {
+    const SpoofIndex *This = SpoofIndex::validateThis(index, *status);
+    if (U_FAILURE(*status)) {
+        return 0;
+    }
+    return This->size();
+}
+
+
+U_CAPI int32_t U_EXPORT2
+uspoof_findConfusablesUnicodeString(const USpoofIndex *index,
+                                    const UnicodeString &id,
+                                    int32_t *dest, int32_t *results, int32_t destCapacity,
+                                    UErrorCode *status) {
+    const SpoofIndex *This = SpoofIndex::validateThis(index, *status);
+    if (U_FAILURE(*status)) {
+        return 0;
+    }
+    if (destCapacity < 0 || (destCapacity > 0 && dest == NULL)) {
+        *status = U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+    return This->find(id, dest, results, destCapacity, *status);
+}
+
+
+U_CAPI int32_t U_EXPORT2
+uspoof_findConfusables(const USpoofIndex *index,
+                       const UChar *id, int32_t length,
+                       int32_t *dest, int32_t *results, int32_t destCapacity,
+                       UErrorCode *status) {
+    SpoofIndex::validateThis(index, *status);
+    if (U_FAILURE(*status)) {
+        return 0;
+    }
+    if (length < -1) {
+        *status = U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+    UnicodeString idStr((length==-1), id, length);  // Aliasing constructor
+    return uspoof_findConfusablesUnicodeString(index, idStr, dest, results, destCapacity, status);
+}
+
+
+U_CAPI int32_t U_EXPORT2
+uspoof_findConfusablesUTF8(const USpoofIndex *index,
+                           const char *id, int32_t length,
+                           int32_t *dest, int32_t *results, int32_t destCapacity,
+                           UErrorCode *status) {
+    SpoofIndex::validateThis(index, *status);
+    if (U_FAILURE(*status)) {
+        return 0;
+    }
+    if (length < -1) {
+        *status = U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+    UnicodeString idStr = UnicodeString::fromUTF8(StringPiece(id, length>=0 ? length : uprv_strlen(id)));
+    return uspoof_findConfusablesUnicodeString(index, idStr, dest, results, destCapacity, status);
+}
+
+
 U_CAPI int32_t U_EXPORT2
 uspoof_serialize(USpoofChecker *sc,void *buf, int32_t capacity, UErrorCode *status) {
     SpoofImpl *This = SpoofImpl::validateThis(sc, *status);
@@ -19,7 +19,9 @@
 #include "umutex.h"
 #include "udataswp.h"
 #include "uassert.h"
+#include "uhash.h"
 #include "uspoof_impl.h"
+#include "uvectr32.h"
 
 #if !UCONFIG_NO_NORMALIZATION
 
@@ -454,6 +456,236 @@ void SpoofImpl::releaseIdentifierInfo(IdentifierInfo *idInfo) const {
 }
 
 
+//----------------------------------------------------------------------------------------------
+//
+//   class SpoofIndex Implementation
+//
+//----------------------------------------------------------------------------------------------
+
+SpoofIndex::SpoofIndex(const USpoofChecker *sc, UErrorCode &status) :
+        fMagic(USPOOF_INDEX_MAGIC), fSpoofChecker(sc), fChecks(0), fScriptCounts(NULL),
+        fSingleScriptIndex(NULL), fMixedScriptIndex(NULL) {
+    const SpoofImpl *checker = SpoofImpl::validateThis(sc, status);
+    if (U_FAILURE(status)) {
+        return;
+    }
+    // The same checks as uspoof_areConfusable() requires.
+    if ((checker->fChecks & (USPOOF_SINGLE_SCRIPT_CONFUSABLE | USPOOF_MIXED_SCRIPT_CONFUSABLE |
+                             USPOOF_WHOLE_SCRIPT_CONFUSABLE)) == 0) {
+        status = U_INVALID_STATE_ERROR;
+        return;
+    }
+    fChecks = checker->fChecks;
+    fScriptCounts = new UVector32(status);
+    if (fScriptCounts == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    fSingleScriptIndex = uhash_open(uhash_hashUnicodeString, uhash_compareUnicodeString, NULL, &status);
+    fMixedScriptIndex = uhash_open(uhash_hashUnicodeString, uhash_compareUnicodeString, NULL, &status);
+    if (U_FAILURE(status)) {
+        return;
+    }
+    uhash_setKeyDeleter(fSingleScriptIndex, uprv_deleteUObject);
+    uhash_setValueDeleter(fSingleScriptIndex, uprv_deleteUObject);
+    uhash_setKeyDeleter(fMixedScriptIndex, uprv_deleteUObject);
+    uhash_setValueDeleter(fMixedScriptIndex, uprv_deleteUObject);
+}
+
+
+SpoofIndex::~SpoofIndex() {
+    fMagic = 0;                // head off application errors by preventing use of
+                               //    of deleted objects.
+    uhash_close(fSingleScriptIndex);
+    uhash_close(fMixedScriptIndex);
+    delete fScriptCounts;
+}
+
+
+const SpoofIndex *SpoofIndex::validateThis(const USpoofIndex *index, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return NULL;
+    }
+    if (index == NULL) {
+        status = U_ILLEGAL_ARGUMENT_ERROR;
+        return NULL;
+    }
+    const SpoofIndex *This = (const SpoofIndex *)index;
+    if (This->fMagic != USPOOF_INDEX_MAGIC) {
+        status = U_INVALID_FORMAT_ERROR;
+        return NULL;
+    }
+    if (SpoofImpl::validateThis(This->fSpoofChecker, status) == NULL) {
+        return NULL;
+    }
+    return This;
+}
+
+SpoofIndex *SpoofIndex::validateThis(USpoofIndex *index, UErrorCode &status) {
+    return const_cast<SpoofIndex *>
+        (SpoofIndex::validateThis(const_cast<const USpoofIndex *>(index), status));
+}
+
+
+//
+//  getKeys()   Computes what uspoof_areConfusableUnicodeString() computes for one
+//              of its two identifiers.  The single script skeleton is only compared
+//              when both identifiers have at most one script, and the mixed script
+//              skeleton is needed for both the mixed and the whole script checks.
+//
+void SpoofIndex::getKeys(const UnicodeString &id, int32_t &scriptCount,
+                         UnicodeString &singleSkeleton, UnicodeString &mixedSkeleton,
+                         UErrorCode &status) const {
+    singleSkeleton.setToBogus();
+    mixedSkeleton.setToBogus();
+    const SpoofImpl *checker = (const SpoofImpl *)fSpoofChecker;
+    IdentifierInfo *identifierInfo = checker->getIdentifierInfo(status);
+    if (U_FAILURE(status)) {
+        return;
+    }
+    identifierInfo->setIdentifier(id, status);
+    scriptCount = identifierInfo->getScriptCount();
+    checker->releaseIdentifierInfo(identifierInfo);
+
+    int32_t flagsForSkeleton = fChecks & USPOOF_ANY_CASE;
+    if ((fChecks & USPOOF_SINGLE_SCRIPT_CONFUSABLE) && scriptCount <= 1) {
+        uspoof_getSkeletonUnicodeString(fSpoofChecker, flagsForSkeleton | USPOOF_SINGLE_SCRIPT_CONFUSABLE,
+                                        id, singleSkeleton, &status);
+    }
+    if (fChecks & (USPOOF_MIXED_SCRIPT_CONFUSABLE | USPOOF_WHOLE_SCRIPT_CONFUSABLE)) {
+        uspoof_getSkeletonUnicodeString(fSpoofChecker, flagsForSkeleton, id, mixedSkeleton, &status);
+    }
+}
+
+
+// Appends number to the list of identifiers with the skeleton key in index.
+static void addToSkeletonIndex(UHashtable *index, const UnicodeString &key, int32_t number,
+                               UErrorCode &status) {
+    if (U_FAILURE(status) || key.isBogus()) {
+        return;
+    }
+    UVector32 *numbers = (UVector32 *)uhash_get(index, &key);
+    if (numbers == NULL) {
+        LocalPointer<UnicodeString> newKey(new UnicodeString(key));
+        LocalPointer<UVector32> newNumbers(new UVector32(status));
+        if (newKey.isNull() || newNumbers.isNull()) {
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return;
+        }
+        if (U_FAILURE(status)) {
+            return;
+        }
+        numbers = newNumbers.getAlias();
+        uhash_put(index, newKey.orphan(), newNumbers.orphan(), &status);
+        if (U_FAILURE(status)) {
+            return;
+        }
+    }
+    numbers->addElement(number, status);
+}
+
+
+int32_t SpoofIndex::add(const UnicodeString &id, UErrorCode &status) {
+    int32_t scriptCount = 0;
+    UnicodeString singleSkeleton;
+    UnicodeString mixedSkeleton;
+    getKeys(id, scriptCount, singleSkeleton, mixedSkeleton, status);
+    if (U_FAILURE(status)) {
+        return -1;
+    }
+    int32_t number = fScriptCounts->size();
+    fScriptCounts->addElement(scriptCount, status);
+    addToSkeletonIndex(fSingleScriptIndex, singleSkeleton, number, status);
+    addToSkeletonIndex(fMixedScriptIndex, mixedSkeleton, number, status);
+    if (U_FAILURE(status)) {
+        // Leave the index as it was.  Only the last element of a list can be number.
+        fScriptCounts->setSize(number);
+        UHashtable *indexes[2] = { fSingleScriptIndex, fMixedScriptIndex };
+        const UnicodeString *keys[2] = { &singleSkeleton, &mixedSkeleton };
+        for (int32_t i = 0; i < 2; i++) {
+            UVector32 *numbers = keys[i]->isBogus() ? NULL : (UVector32 *)uhash_get(indexes[i], keys[i]);
+            if (numbers != NULL && numbers->size() > 0 && numbers->lastElementi() == number) {
+                numbers->setSize(numbers->size() - 1);
+            }
+        }
+        return -1;
+    }
+    return number;
+}
+
+
+int32_t SpoofIndex::find(const UnicodeString &id,
+                         int32_t *dest, int32_t *results, int32_t destCapacity,
+                         UErrorCode &status) const {
+    int32_t scriptCount = 0;
+    UnicodeString singleSkeleton;
+    UnicodeString mixedSkeleton;
+    getKeys(id, scriptCount, singleSkeleton, mixedSkeleton, status);
+    if (U_FAILURE(status)) {
+        return 0;
+    }
+
+    // Both lists are in ascending order; merge them.
+    // See uspoof_areConfusableUnicodeString() for the rules applied to each pair.
+    const UVector32 *singles = singleSkeleton.isBogus() ? NULL :
+        (const UVector32 *)uhash_get(fSingleScriptIndex, &singleSkeleton);
+    const UVector32 *mixed = NULL;
+    UBool queryMayBeWholeScript = scriptCount <= 1 && (fChecks & USPOOF_WHOLE_SCRIPT_CONFUSABLE);
+    if (!mixedSkeleton.isBogus() && ((fChecks & USPOOF_MIXED_SCRIPT_CONFUSABLE) || queryMayBeWholeScript)) {
+        mixed = (const UVector32 *)uhash_get(fMixedScriptIndex, &mixedSkeleton);
+    }
+    int32_t singlesLength = singles == NULL ? 0 : singles->size();
+    int32_t mixedLength = mixed == NULL ? 0 : mixed->size();
+
+    int32_t count = 0;
+    int32_t si = 0;
+    int32_t mi = 0;
+    while (si < singlesLength || mi < mixedLength) {
+        int32_t number;
+        int32_t result;
+        int32_t singleNumber = si < singlesLength ? singles->elementAti(si) : INT32_MAX;
+        int32_t mixedNumber = mi < mixedLength ? mixed->elementAti(mi) : INT32_MAX;
+        if (singleNumber <= mixedNumber) {
+            // Single script confusables can not also be mixed or whole script confusable.
+            number = singleNumber;
+            result = USPOOF_SINGLE_SCRIPT_CONFUSABLE;
+            ++si;
+            if (mixedNumber == singleNumber) {
+                ++mi;
+            }
+        } else {
+            number = mixedNumber;
+            ++mi;
+            UBool possiblyWholeScriptConfusables =
+                queryMayBeWholeScript && fScriptCounts->elementAti(number) <= 1;
+            if (!(fChecks & USPOOF_MIXED_SCRIPT_CONFUSABLE) && !possiblyWholeScriptConfusables) {
+                continue;
+            }
+            result = USPOOF_MIXED_SCRIPT_CONFUSABLE;
+            if (possiblyWholeScriptConfusables) {
+                result |= USPOOF_WHOLE_SCRIPT_CONFUSABLE;
+            }
+        }
+        if (count < destCapacity) {
+            dest[count] = number;
+            if (results != NULL) {
+                results[count] = result;
+            }
+        }
+        ++count;
+    }
+    if (count > destCapacity) {
+        status = U_BUFFER_OVERFLOW_ERROR;
+    }
+    return count;
+}
+
+
+int32_t SpoofIndex::size() const {
+    return fScriptCounts->size();
+}
+
+
 
 
 //----------------------------------------------------------------------------------------------
@@ -18,6 +18,7 @@
 #include "unicode/uscript.h"
 #include "unicode/udata.h"
 
+#include "uhash.h"
 #include "utrie2.h"
 
 #if !UCONFIG_NO_NORMALIZATION
@@ -37,9 +38,13 @@ U_NAMESPACE_BEGIN
 // Magic number for sanity checking spoof data.
 #define USPOOF_MAGIC 0x3845fdef
 
+// Magic number for sanity checking spoof skeleton indexes.
+#define USPOOF_INDEX_MAGIC 0x3845fdf0
+
 class IdentifierInfo;
 class ScriptSet;
 class SpoofData;
+class UVector32;
 struct SpoofDataHeader;
 struct SpoofStringLengthsElement;
 
@@ -115,6 +120,56 @@ public:
 };
 
 
+/**
+  *  Class SpoofIndex corresponds directly to the plain C API opaque type
+  *  USpoofIndex.  One can be cast to the other.
+  *
+  *  It keeps the skeletons of the identifiers added to it in hash tables,
+  *  from skeleton to the numbers of the identifiers with that skeleton,
+  *  so that the identifiers confusable with another one are found with
+  *  one or two lookups instead of a uspoof_areConfusable() call each.
+  */
+class SpoofIndex : public UMemory {
+public:
+    SpoofIndex(const USpoofChecker *sc, UErrorCode &status);
+    ~SpoofIndex();
+
+    static SpoofIndex *validateThis(USpoofIndex *index, UErrorCode &status);
+    static const SpoofIndex *validateThis(const USpoofIndex *index, UErrorCode &status);
+
+    /** Implementation of uspoof_addToIndex(); returns the identifier's number. */
+    int32_t add(const UnicodeString &id, UErrorCode &status);
+
+    /** Implementation of uspoof_findConfusables(). */
+    int32_t find(const UnicodeString &id,
+                 int32_t *dest, int32_t *results, int32_t destCapacity,
+                 UErrorCode &status) const;
+
+    int32_t size() const;
+
+  private:
+    // The script count and the skeletons that uspoof_areConfusable()
+    // would compare for id, with the checks of this index.
+    // A skeleton that would not be compared is left bogus.
+    void getKeys(const UnicodeString &id, int32_t &scriptCount,
+                 UnicodeString &singleSkeleton, UnicodeString &mixedSkeleton,
+                 UErrorCode &status) const;
+
+  public:
+    //
+    // Data Members
+    //
+
+    int32_t              fMagic;              // Internal sanity check.
+    const USpoofChecker *fSpoofChecker;       // Not owned.
+    int32_t              fChecks;             // The checker's checks when the index was opened.
+
+    UVector32           *fScriptCounts;       // Script count of each identifier, by number.
+    UHashtable          *fSingleScriptIndex;  // Single script skeleton -> UVector32 of numbers.
+    UHashtable          *fMixedScriptIndex;   // Mixed script skeleton -> UVector32 of numbers.
+};
+
+
 
 //
 //  Confusable Mappings Data Structures
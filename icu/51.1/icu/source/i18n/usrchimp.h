@@ -1,6 +1,6 @@
 /*
 **********************************************************************
-*   Copyright (C) 2001-2011 IBM and others. All rights reserved.
+*   Copyright (C) 2001-2013 IBM and others. All rights reserved.
 **********************************************************************
 *   Date        Name        Description
 *  08/13/2001   synwee      Creation.
@@ -55,6 +55,11 @@ struct UPattern {
           int16_t             defaultShiftSize;
           int16_t             shift[MAX_TABLE_SIZE_];
           int16_t             backShift[MAX_TABLE_SIZE_];
+          // TRUE if startSkip[] may be used to skip text before a match.
+          UBool               hasStartSkip;
+          // TRUE for Latin-1 characters at which a match can not begin
+          // and which do not affect the collation elements around them.
+          UBool               startSkip[256];
 };
 
 struct UStringSearch {
@@ -24,6 +24,32 @@ const ArabicShaping::ShapeType ArabicShaping::shapeTypes[] =
     ArabicShaping::ST_TRANSPARENT   // [T]
 };
 
+// The joining types of U+0600..U+06FF from shapingTypeTable, which
+// has to be searched for each character; this is where the text
+// being shaped almost always is.
+static const le_uint8 arabicBlockJoiningTypes[] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // U+0600
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 0, 0, 0, 0, 0, // U+0610
+    0, 0, 4, 4, 4, 4, 2, 4, 2, 4, 2, 2, 2, 2, 2, 4, // U+0620
+    4, 4, 4, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // U+0630
+    1, 2, 2, 2, 2, 2, 2, 2, 4, 2, 2, 5, 5, 5, 5, 5, // U+0640
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 0, // U+0650
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, // U+0660
+    5, 4, 4, 4, 0, 4, 4, 4, 2, 2, 2, 2, 2, 2, 2, 2, // U+0670
+    2, 2, 2, 2, 2, 2, 2, 2, 4, 4, 4, 4, 4, 4, 4, 4, // U+0680
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 2, 2, 2, 2, 2, 2, // U+0690
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // U+06A0
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // U+06B0
+    4, 2, 2, 4, 4, 4, 4, 4, 4, 4, 4, 4, 2, 4, 2, 4, // U+06C0
+    2, 2, 4, 4, 0, 4, 5, 5, 5, 5, 5, 5, 5, 0, 5, 5, // U+06D0
+    5, 5, 5, 5, 5, 0, 0, 5, 5, 0, 5, 5, 5, 5, 4, 4, // U+06E0
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 0, 0, 2  // U+06F0
+};
+
+// The lowest character in shapingTypeTable.
+#define FIRST_SHAPING_CHAR 0x00AD
+
 /*
     shaping array holds types for Arabic chars between 0610 and 0700
     other values are either unshaped, or transparent if a mark or format
@@ -33,6 +59,14 @@ const ArabicShaping::ShapeType ArabicShaping::shapeTypes[] =
 */
 ArabicShaping::ShapeType ArabicShaping::getShapeType(LEUnicode c)
 {
+    if ((c & 0xFF00) == 0x0600) {
+        return ArabicShaping::shapeTypes[arabicBlockJoiningTypes[c & 0xFF]];
+    }
+
+    if (c < FIRST_SHAPING_CHAR) {
+        return ArabicShaping::ST_NOSHAPE_NONE;
+    }
+
     const ClassDefinitionTable *joiningTypes = (const ClassDefinitionTable *) ArabicShaping::shapingTypeTable;
     le_int32 joiningType = joiningTypes->getGlyphClass(c);
 
@@ -19,6 +19,7 @@
 #include "LEGlyphStorage.h"
 
 #include "IndicReordering.h"
+#include "IndicSyllableCache.h"
 
 U_NAMESPACE_BEGIN
 
@@ -26,7 +27,7 @@ UOBJECT_DEFINE_RTTI_IMPLEMENTATION(IndicOpenTypeLayoutEngine)
 
 IndicOpenTypeLayoutEngine::IndicOpenTypeLayoutEngine(const LEFontInstance *fontInstance, le_int32 scriptCode, le_int32 languageCode,
                     le_int32 typoFlags, le_bool version2, const GlyphSubstitutionTableHeader *gsubTable, LEErrorCode &success)
-    : OpenTypeLayoutEngine(fontInstance, scriptCode, languageCode, typoFlags, gsubTable, success), fMPreFixups(NULL)
+    : OpenTypeLayoutEngine(fontInstance, scriptCode, languageCode, typoFlags, gsubTable, success), fMPreFixups(NULL), fSyllableCache(NULL)
 {
 	if ( version2 ) {
 		fFeatureMap = IndicReordering::getv2FeatureMap(fFeatureMapCount);
@@ -36,19 +37,24 @@ IndicOpenTypeLayoutEngine::IndicOpenTypeLayoutEngine(const LEFontInstance *fontI
 	fFeatureOrder = TRUE;
     fVersion2 = version2;
     fFilterZeroWidth = IndicReordering::getFilterZeroWidth(fScriptCode);
+
+    if (!version2) {
+        fSyllableCache = new IndicSyllableCache();
+    }
 }
 
 IndicOpenTypeLayoutEngine::IndicOpenTypeLayoutEngine(const LEFontInstance *fontInstance, le_int32 scriptCode, le_int32 languageCode, le_int32 typoFlags, LEErrorCode &success)
-    : OpenTypeLayoutEngine(fontInstance, scriptCode, languageCode, typoFlags, success), fMPreFixups(NULL)
+    : OpenTypeLayoutEngine(fontInstance, scriptCode, languageCode, typoFlags, success), fMPreFixups(NULL), fSyllableCache(NULL)
 {
     fFeatureMap = IndicReordering::getFeatureMap(fFeatureMapCount);
     fFeatureOrder = TRUE;
 	fVersion2 =  FALSE;
+    fSyllableCache = new IndicSyllableCache();
 }
 
 IndicOpenTypeLayoutEngine::~IndicOpenTypeLayoutEngine()
 {
-    // nothing to do
+    delete fSyllableCache;
 }
 
 // Input: characters, tags
@@ -120,7 +126,7 @@ le_int32 IndicOpenTypeLayoutEngine::characterProcessing(const LEUnicode chars[],
     if (fVersion2) {
         outCharCount = IndicReordering::v2process(&chars[offset], count, fScriptCode, outChars, glyphStorage);
     } else {
-        outCharCount = IndicReordering::reorder(&chars[offset], count, fScriptCode, outChars, glyphStorage, &fMPreFixups, success);
+        outCharCount = IndicReordering::reorder(&chars[offset], count, fScriptCode, outChars, glyphStorage, &fMPreFixups, fSyllableCache, success);
     }
 
     if (LE_FAILURE(success)) {
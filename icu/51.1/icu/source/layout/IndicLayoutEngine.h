@@ -21,6 +21,7 @@
 U_NAMESPACE_BEGIN
 
 class MPreFixups;
+class IndicSyllableCache;
 class LEGlyphStorage;
 
 /**
@@ -160,6 +161,12 @@ private:
 
     MPreFixups *fMPreFixups;
 
+    /**
+     * The syllables reordered for this engine's font, or NULL
+     * when the font is laid out with the version 2 reordering.
+     */
+    IndicSyllableCache *fSyllableCache;
+
 };
 
 U_NAMESPACE_END
@@ -10,6 +10,7 @@
 #include "IndicReordering.h"
 #include "LEGlyphStorage.h"
 #include "MPreFixups.h"
+#include "IndicSyllableCache.h"
 
 U_NAMESPACE_BEGIN
 
@@ -134,6 +135,9 @@ private:
     le_int32    fPBCIndex;
     FeatureMask fPBCFeatures;
 
+    le_int32    fSyllableFixupBase;
+    le_int32    fSyllableFixupMPre;
+
     void saveMatra(LEUnicode matra, le_int32 matraIndex, IndicClassTable::CharClass matraClass)
     {
         // FIXME: check if already set, or if not a matra...
@@ -180,7 +184,8 @@ public:
           fMatraFeatures(0), fMPreOutIndex(-1), fMPreFixups(mpreFixups),
           fVMabove(0), fVMpost(0), fVMIndex(0), fVMFeatures(0),
           fSMabove(0), fSMbelow(0), fSMIndex(0), fSMFeatures(0),
-          fPreBaseConsonant(0), fPreBaseVirama(0), fPBCIndex(0), fPBCFeatures(0)
+          fPreBaseConsonant(0), fPreBaseVirama(0), fPBCIndex(0), fPBCFeatures(0),
+          fSyllableFixupBase(-1), fSyllableFixupMPre(-1)
     {
         // nothing else to do...
     }
@@ -201,6 +206,8 @@ public:
         fSMabove = fSMbelow = 0;
 
         fPreBaseConsonant = fPreBaseVirama = 0;
+
+        fSyllableFixupBase = fSyllableFixupMPre = -1;
     }
 
     void writeChar(LEUnicode ch, le_uint32 charIndex, FeatureMask charFeatures)
@@ -408,6 +415,9 @@ public:
     {
         if (fMPreFixups != NULL && fMPreOutIndex >= 0) {
             fMPreFixups->add(fOutIndex, fMPreOutIndex);
+
+            fSyllableFixupBase = fOutIndex;
+            fSyllableFixupMPre = fMPreOutIndex;
         }
     }
 
@@ -503,6 +513,44 @@ public:
     {
         return fOutIndex;
     }
+
+    // Writes the output of a cached syllable which starts at syllableStart.
+    void writeSyllable(const IndicSyllable *syllable, le_int32 syllableStart)
+    {
+        le_int32 outStart = fOutIndex;
+
+        for (le_int32 i = 0; i < syllable->outCount; i += 1) {
+            writeChar(syllable->outChars[i], syllableStart + syllable->charOffsets[i], syllable->features[i]);
+        }
+
+        if (fMPreFixups != NULL && syllable->fixupBase >= 0) {
+            fMPreFixups->add(outStart + syllable->fixupBase, outStart + syllable->fixupMPre);
+        }
+    }
+
+    // Saves what was written from outStart on for the syllable which starts
+    // at syllableStart, or empties the entry if there was too much of it.
+    void storeSyllable(IndicSyllable *syllable, le_int32 syllableStart, le_int32 outStart, le_bool inWord)
+    {
+        LEErrorCode success = LE_NO_ERROR;
+        le_int32 outCount = fOutIndex - outStart;
+
+        if (outCount > IndicSyllable::MAX_OUTPUT_LENGTH) {
+            syllable->charCount = 0;
+            return;
+        }
+
+        for (le_int32 i = 0; i < outCount; i += 1) {
+            syllable->outChars[i]    = fOutChars[outStart + i];
+            syllable->charOffsets[i] = (le_int8) (fGlyphStorage.getCharIndex(outStart + i, success) - syllableStart);
+            syllable->features[i]    = fGlyphStorage.getAuxData(outStart + i, success) & ~LE_GLYPH_GROUP_MASK;
+        }
+
+        syllable->outCount  = outCount;
+        syllable->fixupBase = fSyllableFixupBase >= 0 ? fSyllableFixupBase - outStart : -1;
+        syllable->fixupMPre = fSyllableFixupMPre >= 0 ? fSyllableFixupMPre - outStart : -1;
+        syllable->inWord    = inWord;
+    }
 };
 
 
@@ -624,7 +672,8 @@ le_int32 IndicReordering::findSyllable(const IndicClassTable *classTable, const
 
 le_int32 IndicReordering::reorder(const LEUnicode *chars, le_int32 charCount, le_int32 scriptCode,
                                   LEUnicode *outChars, LEGlyphStorage &glyphStorage,
-                                  MPreFixups **outMPreFixups, LEErrorCode& success)
+                                  MPreFixups **outMPreFixups, IndicSyllableCache *syllableCache,
+                                  LEErrorCode& success)
 {
     if (LE_FAILURE(success)) {
         return 0;
@@ -648,6 +697,8 @@ le_int32 IndicReordering::reorder(const LEUnicode *chars, le_int32 charCount, le
     while (prev < charCount) {
         le_int32 syllable = findSyllable(classTable, chars, prev, charCount);
         le_int32 matra, markStart = syllable;
+        IndicClassTable::CharClass firstClass = classTable->getCharClass(chars[prev]) & CF_CLASS_MASK;
+        IndicSyllable *entry = NULL;
 
         output.reset();
         
@@ -661,6 +712,24 @@ le_int32 IndicReordering::reorder(const LEUnicode *chars, le_int32 charCount, le
             output.noteVowelModifier(classTable, chars[markStart], markStart, tagArray1);
         }
 
+        // A lone virama, and the matra search below when the syllable
+        // is only marks, look at the characters before the syllable,
+        // so those syllables aren't cached.
+        if (syllableCache != NULL && firstClass != CC_VIRAMA && markStart != prev) {
+            const IndicSyllable *cached = syllableCache->fetch(&chars[prev], syllable - prev, !lastInWord);
+
+            if (cached != NULL) {
+                output.writeSyllable(cached, prev);
+                lastInWord = cached->inWord;
+                prev = syllable;
+                continue;
+            }
+
+            entry = syllableCache->prepare(&chars[prev], syllable - prev, !lastInWord);
+        }
+
+        le_int32 outStart = output.getOutputIndex();
+
         matra = markStart - 1;
 
         while (output.noteMatra(classTable, chars[matra], matra, tagArray1, !lastInWord) && matra != prev) {
@@ -669,7 +738,7 @@ le_int32 IndicReordering::reorder(const LEUnicode *chars, le_int32 charCount, le
 
         lastInWord = TRUE;
 
-        switch (classTable->getCharClass(chars[prev]) & CF_CLASS_MASK) {
+        switch (firstClass) {
         case CC_RESERVED:
             lastInWord = FALSE;
             /* fall through */
@@ -971,6 +1040,10 @@ le_int32 IndicReordering::reorder(const LEUnicode *chars, le_int32 charCount, le
             break;
         }
 
+        if (entry != NULL) {
+            output.storeSyllable(entry, prev, outStart, lastInWord);
+        }
+
         prev = syllable;
     }
 
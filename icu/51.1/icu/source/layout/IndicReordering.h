@@ -76,6 +76,7 @@ U_NAMESPACE_BEGIN
 typedef LEUnicode SplitMatra[SM_MAX_PIECES];
 
 class MPreFixups;
+class IndicSyllableCache;
 class LEGlyphStorage;
 
 // Dynamic Properties ( v2 fonts only )
@@ -151,7 +152,8 @@ public:
 
     static le_int32 reorder(const LEUnicode *theChars, le_int32 charCount, le_int32 scriptCode,
         LEUnicode *outChars, LEGlyphStorage &glyphStorage,
-        MPreFixups **outMPreFixups, LEErrorCode& success);
+        MPreFixups **outMPreFixups, IndicSyllableCache *syllableCache,
+        LEErrorCode& success);
 
     static void adjustMPres(MPreFixups *mpreFixups, LEGlyphStorage &glyphStorage, LEErrorCode& success);
 
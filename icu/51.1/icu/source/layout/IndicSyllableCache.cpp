@@ -0,0 +1,96 @@
+/*
+ *
+ * (C) Copyright IBM Corp. and others 2013 - All Rights Reserved
+ *
+ */
+
+#include "LETypes.h"
+#include "IndicSyllableCache.h"
+
+U_NAMESPACE_BEGIN
+
+IndicSyllableCache::IndicSyllableCache()
+    : fHits(0), fMisses(0)
+{
+    for (le_int32 i = 0; i < CACHE_SIZE; i += 1) {
+        fEntries[i].charCount = 0;
+    }
+
+    for (le_int32 set = 0; set < SET_COUNT; set += 1) {
+        fRecent[set] = 0;
+    }
+}
+
+IndicSyllableCache::~IndicSyllableCache()
+{
+    // nothing to do
+}
+
+le_uint32 IndicSyllableCache::hashSyllable(const LEUnicode chars[], le_int32 charCount, le_bool wordStart)
+{
+    le_uint32 hash = wordStart ? 0x811C9DC5 : 0x050C5D1F;
+
+    for (le_int32 i = 0; i < charCount; i += 1) {
+        hash = (hash ^ chars[i]) * 0x01000193;
+    }
+
+    return (hash ^ (hash >> 16)) & (SET_COUNT - 1);
+}
+
+le_bool IndicSyllableCache::matches(const IndicSyllable *entry, const LEUnicode chars[], le_int32 charCount, le_bool wordStart)
+{
+    if (entry->charCount != charCount || entry->wordStart != wordStart) {
+        return FALSE;
+    }
+
+    for (le_int32 i = 0; i < charCount; i += 1) {
+        if (entry->chars[i] != chars[i]) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+const IndicSyllable *IndicSyllableCache::fetch(const LEUnicode chars[], le_int32 charCount, le_bool wordStart)
+{
+    if (charCount > IndicSyllable::MAX_LENGTH) {
+        return NULL;
+    }
+
+    le_uint32 set = hashSyllable(chars, charCount, wordStart);
+
+    for (le_uint8 way = 0; way < 2; way += 1) {
+        const IndicSyllable *entry = &fEntries[set * 2 + way];
+
+        if (matches(entry, chars, charCount, wordStart)) {
+            fRecent[set] = way;
+            fHits += 1;
+            return entry;
+        }
+    }
+
+    fMisses += 1;
+    return NULL;
+}
+
+IndicSyllable *IndicSyllableCache::prepare(const LEUnicode chars[], le_int32 charCount, le_bool wordStart)
+{
+    if (charCount <= 0 || charCount > IndicSyllable::MAX_LENGTH) {
+        return NULL;
+    }
+
+    le_uint32 set = hashSyllable(chars, charCount, wordStart);
+    le_uint8  way = fRecent[set] ^ 1;
+    IndicSyllable *entry = &fEntries[set * 2 + way];
+
+    fRecent[set] = way;
+
+    entry->charCount = charCount;
+    entry->wordStart = wordStart;
+    LE_ARRAY_COPY(entry->chars, chars, charCount);
+
+    return entry;
+}
+
+U_NAMESPACE_END
@@ -0,0 +1,106 @@
+/*
+ *
+ * (C) Copyright IBM Corp. and others 2013 - All Rights Reserved
+ *
+ */
+
+#ifndef __INDICSYLLABLECACHE_H
+#define __INDICSYLLABLECACHE_H
+
+/**
+ * \file
+ * \internal
+ */
+
+#include "LETypes.h"
+#include "OpenTypeTables.h"
+
+U_NAMESPACE_BEGIN
+
+/**
+ * One syllable and what <code>IndicReordering::reorder</code> wrote for it.
+ * Character indices are relative to the start of the syllable, output
+ * positions to its first output character, and the feature tags do not
+ * include the glyph group bit, which alternates from syllable to syllable.
+ *
+ * @internal
+ */
+struct IndicSyllable
+{
+    enum {
+        /** Longer syllables are not cached. */
+        MAX_LENGTH = 12,
+        /** Syllables which reorder to more characters are not cached. */
+        MAX_OUTPUT_LENGTH = 24
+    };
+
+    le_int32    charCount;      // 0 if the entry is empty
+    le_bool     wordStart;
+    LEUnicode   chars[MAX_LENGTH];
+
+    le_int32    outCount;
+    LEUnicode   outChars[MAX_OUTPUT_LENGTH];
+    le_int8     charOffsets[MAX_OUTPUT_LENGTH];
+    FeatureMask features[MAX_OUTPUT_LENGTH];
+
+    le_int32    fixupBase;      // the MPreFixups entry, or -1
+    le_int32    fixupMPre;
+    le_bool     inWord;         // whether the next syllable is in the same word
+};
+
+/**
+ * A cache of reordered syllables, so that text which repeats the same
+ * syllables, as user interface strings do, goes through the reordering
+ * logic once per distinct syllable. It is two-way set associative, with
+ * the set chosen by a hash of the syllable's characters.
+ *
+ * A cache belongs to a single layout engine, so the script is fixed.
+ *
+ * @internal
+ */
+class IndicSyllableCache : public UMemory
+{
+public:
+    enum {
+        /** The number of entries, a power of 2. */
+        CACHE_SIZE = 64,
+        /** The number of sets of two entries. */
+        SET_COUNT = CACHE_SIZE / 2
+    };
+
+    IndicSyllableCache();
+
+    ~IndicSyllableCache();
+
+    /**
+     * Returns the cached syllable with these characters,
+     * reordered at the start of a word or not, or NULL.
+     */
+    const IndicSyllable *fetch(const LEUnicode chars[], le_int32 charCount, le_bool wordStart);
+
+    /**
+     * Returns the entry to fill in with the output for the syllable,
+     * replacing what it held, or NULL if the syllable is too long.
+     * The entry's characters and word start state are already set.
+     */
+    IndicSyllable *prepare(const LEUnicode chars[], le_int32 charCount, le_bool wordStart);
+
+    /** The number of <code>fetch</code> calls which found their syllable. */
+    le_uint32 getHits() const { return fHits; }
+
+    /** The number of <code>fetch</code> calls which did not find their syllable. */
+    le_uint32 getMisses() const { return fMisses; }
+
+private:
+    static le_uint32 hashSyllable(const LEUnicode chars[], le_int32 charCount, le_bool wordStart);
+
+    static le_bool matches(const IndicSyllable *entry, const LEUnicode chars[], le_int32 charCount, le_bool wordStart);
+
+    IndicSyllable fEntries[CACHE_SIZE];
+    le_uint8      fRecent[SET_COUNT];   // the more recently used entry of each set
+    le_uint32     fHits;
+    le_uint32     fMisses;
+};
+
+U_NAMESPACE_END
+#endif
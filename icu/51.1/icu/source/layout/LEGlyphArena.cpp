@@ -0,0 +1,185 @@
+/*
+ **********************************************************************
+ *   Copyright (C) 2013, International Business Machines
+ *   Corporation and others.  All Rights Reserved.
+ **********************************************************************
+ */
+
+#include "LETypes.h"
+#include "LEGlyphArena.h"
+
+U_NAMESPACE_BEGIN
+
+// Round n up to a multiple of 8, so that any array type is aligned.
+#define ARENA_ALIGN(n) (((n) + 7) & ~((size_t) 7))
+
+// The size of the first block. Enough for a few hundred glyphs.
+#define ARENA_BLOCK_SIZE 8192
+
+struct ArenaBlock
+{
+    ArenaBlock *next;
+    size_t      size;
+    size_t      used;
+};
+
+// Every array starts with one of these, so that growArray and
+// deleteArray can tell arena arrays from heap arrays.
+struct ArrayHeader
+{
+    LEGlyphArena *arena;
+    size_t        size;
+};
+
+#define BLOCK_HEADER_SIZE ARENA_ALIGN(sizeof(ArenaBlock))
+#define ARRAY_HEADER_SIZE ARENA_ALIGN(sizeof(ArrayHeader))
+
+#define HEADER_OF(array) ((ArrayHeader *) ((char *) (array) - ARRAY_HEADER_SIZE))
+#define ARRAY_OF(header) ((void *) ((char *) (header) + ARRAY_HEADER_SIZE))
+
+UOBJECT_DEFINE_RTTI_IMPLEMENTATION(LEGlyphArena)
+
+LEGlyphArena::LEGlyphArena()
+    : fBlocks(NULL), fTotalSize(0), fBlockAllocations(0)
+{
+    // nothing else to do!
+}
+
+LEGlyphArena::~LEGlyphArena()
+{
+    freeBlocks();
+}
+
+void LEGlyphArena::freeBlocks()
+{
+    while (fBlocks != NULL) {
+        ArenaBlock *block = fBlocks;
+
+        fBlocks = block->next;
+        LE_DELETE_ARRAY(block);
+    }
+
+    fTotalSize = 0;
+}
+
+void LEGlyphArena::reset()
+{
+    if (fBlocks == NULL) {
+        return;
+    }
+
+    if (fBlocks->next == NULL) {
+        fBlocks->used = 0;
+        return;
+    }
+
+    // The arena grew during the last layout: replace the
+    // blocks with one which will hold all of that again.
+    size_t totalSize = fTotalSize;
+
+    freeBlocks();
+
+    if (allocate(totalSize) != NULL) {
+        fBlocks->used = 0;
+    }
+}
+
+le_uint32 LEGlyphArena::getBlockAllocationCount() const
+{
+    return fBlockAllocations;
+}
+
+void *LEGlyphArena::allocate(size_t size)
+{
+    size = ARENA_ALIGN(size);
+
+    if (fBlocks == NULL || fBlocks->size - fBlocks->used < size) {
+        size_t blockSize = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        ArenaBlock *block = (ArenaBlock *) LE_NEW_ARRAY(char, BLOCK_HEADER_SIZE + blockSize);
+
+        if (block == NULL) {
+            return NULL;
+        }
+
+        block->next = fBlocks;
+        block->size = blockSize;
+        block->used = 0;
+
+        fBlocks = block;
+        fTotalSize += blockSize;
+        fBlockAllocations += 1;
+    }
+
+    void *result = (char *) fBlocks + BLOCK_HEADER_SIZE + fBlocks->used;
+
+    fBlocks->used += size;
+    return result;
+}
+
+void *LEGlyphArena::allocateArray(LEGlyphArena *arena, size_t size)
+{
+    ArrayHeader *header;
+
+    if (arena != NULL) {
+        header = (ArrayHeader *) arena->allocate(ARRAY_HEADER_SIZE + size);
+    } else {
+        header = (ArrayHeader *) LE_NEW_ARRAY(char, ARRAY_HEADER_SIZE + size);
+    }
+
+    if (header == NULL) {
+        return NULL;
+    }
+
+    header->arena = arena;
+    header->size  = size;
+
+    return ARRAY_OF(header);
+}
+
+void *LEGlyphArena::growArray(void *array, size_t newSize)
+{
+    if (array == NULL) {
+        return NULL;
+    }
+
+    ArrayHeader *header = HEADER_OF(array);
+
+    if (newSize <= header->size) {
+        return array;
+    }
+
+    if (header->arena == NULL) {
+        ArrayHeader *newHeader = (ArrayHeader *) LE_GROW_ARRAY((char *) header, ARRAY_HEADER_SIZE + newSize);
+
+        if (newHeader == NULL) {
+            return NULL;
+        }
+
+        newHeader->size = newSize;
+        return ARRAY_OF(newHeader);
+    }
+
+    void *newArray = allocateArray(header->arena, newSize);
+
+    if (newArray == NULL) {
+        return NULL;
+    }
+
+    LE_ARRAY_COPY((char *) newArray, (char *) array, header->size);
+    return newArray;
+}
+
+void LEGlyphArena::deleteArray(void *array)
+{
+    if (array == NULL) {
+        return;
+    }
+
+    ArrayHeader *header = HEADER_OF(array);
+
+    if (header->arena == NULL) {
+        LE_DELETE_ARRAY(header);
+    }
+}
+
+U_NAMESPACE_END
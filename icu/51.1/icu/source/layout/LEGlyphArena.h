@@ -0,0 +1,130 @@
+/*
+ **********************************************************************
+ *   Copyright (C) 2013, International Business Machines
+ *   Corporation and others.  All Rights Reserved.
+ **********************************************************************
+ */
+
+#ifndef __LEGLYPHARENA_H
+#define __LEGLYPHARENA_H
+
+#include "LETypes.h"
+
+/**
+ * \file
+ * \brief C++ API: An arena for the per-glyph storage used by the ICU LayoutEngine.
+ */
+
+U_NAMESPACE_BEGIN
+
+struct ArenaBlock;
+
+#ifndef U_HIDE_INTERNAL_API
+/**
+ * This class is a simple arena allocator for the arrays held by
+ * <code>LEGlyphStorage</code> and the records of <code>LEInsertionList</code>.
+ * Memory is carved out of large blocks and is not returned until the
+ * arena is reset; after a reset, the blocks are reused, so that laying
+ * out text of a similar size again needs no heap allocations for the
+ * glyph storage.
+ *
+ * Arrays are allocated with <code>allocateArray</code> and released with
+ * <code>deleteArray</code>, which handle both arena and heap arrays, so
+ * arrays can still be adopted between arena and heap backed storage.
+ *
+ * @see LEGlyphStorage
+ *
+ * @internal
+ */
+class U_LAYOUT_API LEGlyphArena : public UObject
+{
+public:
+    /**
+     * Construct an empty arena.
+     *
+     * @internal
+     */
+    LEGlyphArena();
+
+    /**
+     * The destructor. This frees all of the blocks; any memory allocated
+     * from the arena must no longer be in use.
+     *
+     * @internal
+     */
+    ~LEGlyphArena();
+
+    /**
+     * Make all of the memory allocated from the arena available again.
+     * Any memory allocated from the arena must no longer be in use.
+     * If the arena had to grow since the last reset, its blocks are
+     * replaced by a single block large enough to hold all of them.
+     *
+     * @internal
+     */
+    void reset();
+
+    /**
+     * Return the number of blocks the arena has allocated from the heap
+     * since it was constructed.
+     *
+     * @internal
+     */
+    le_uint32 getBlockAllocationCount() const;
+
+    /**
+     * Allocate an array of <code>size</code> bytes, from <code>arena</code>
+     * if it is not <code>NULL</code>, and from the heap otherwise.
+     *
+     * @return the array, or <code>NULL</code> if it could not be allocated.
+     *
+     * @internal
+     */
+    static void *allocateArray(LEGlyphArena *arena, size_t size);
+
+    /**
+     * Grow an array allocated by <code>allocateArray</code> to
+     * <code>newSize</code> bytes, from the same arena or the heap.
+     * The contents are preserved.
+     *
+     * @return the new array, or <code>NULL</code> if it could not be
+     *         allocated, in which case the old array is unchanged.
+     *
+     * @internal
+     */
+    static void *growArray(void *array, size_t newSize);
+
+    /**
+     * Release an array allocated by <code>allocateArray</code>. Heap arrays
+     * are freed; arena arrays are reclaimed when their arena is reset.
+     *
+     * @internal
+     */
+    static void deleteArray(void *array);
+
+    /**
+     * ICU "poor man's RTTI", returns a UClassID for the actual class.
+     *
+     * @internal
+     */
+    virtual UClassID getDynamicClassID() const;
+
+    /**
+     * ICU "poor man's RTTI", returns a UClassID for this class.
+     *
+     * @internal
+     */
+    static UClassID getStaticClassID();
+
+private:
+    void *allocate(size_t size);
+    void  freeBlocks();
+
+    ArenaBlock *fBlocks;
+    size_t      fTotalSize;
+    le_uint32   fBlockAllocations;
+};
+#endif  /* U_HIDE_INTERNAL_API */
+
+U_NAMESPACE_END
+#endif
@@ -1,16 +1,24 @@
 /*
  **********************************************************************
- *   Copyright (C) 1998-2009, International Business Machines
+ *   Copyright (C) 1998-2013, International Business Machines
  *   Corporation and others.  All Rights Reserved.
  **********************************************************************
  */
 
 #include "LETypes.h"
 #include "LEInsertionList.h"
+#include "LEGlyphArena.h"
 #include "LEGlyphStorage.h"
 
 U_NAMESPACE_BEGIN
 
+// The per-glyph arrays come from fArena if it is set, and from the heap
+// otherwise. Either way, they are grown and freed through the arena, since
+// an array may have been adopted from another LEGlyphStorage.
+#define NEW_GLYPH_ARRAY(type, count) (type *) LEGlyphArena::allocateArray(fArena, (count) * sizeof(type))
+#define GROW_GLYPH_ARRAY(array, newSize) LEGlyphArena::growArray((void *) (array), (newSize) * sizeof (array)[0])
+#define DELETE_GLYPH_ARRAY(array) LEGlyphArena::deleteArray((void *) (array))
+
 UOBJECT_DEFINE_RTTI_IMPLEMENTATION(LEGlyphStorage)
 
 LEInsertionCallback::~LEInsertionCallback()
@@ -20,7 +28,14 @@ LEInsertionCallback::~LEInsertionCallback()
 
 LEGlyphStorage::LEGlyphStorage()
     : fGlyphCount(0), fGlyphs(NULL), fCharIndices(NULL), fPositions(NULL),
-      fAuxData(NULL), fInsertionList(NULL), fSrcIndex(0), fDestIndex(0)
+      fAuxData(NULL), fInsertionList(NULL), fSrcIndex(0), fDestIndex(0), fArena(NULL)
+{
+    // nothing else to do!
+}
+
+LEGlyphStorage::LEGlyphStorage(LEGlyphArena *arena)
+    : fGlyphCount(0), fGlyphs(NULL), fCharIndices(NULL), fPositions(NULL),
+      fAuxData(NULL), fInsertionList(NULL), fSrcIndex(0), fDestIndex(0), fArena(arena)
 {
     // nothing else to do!
 }
@@ -35,12 +50,12 @@ void LEGlyphStorage::reset()
     fGlyphCount = 0;
 
     if (fPositions != NULL) {
-        LE_DELETE_ARRAY(fPositions);
+        DELETE_GLYPH_ARRAY(fPositions);
         fPositions = NULL;
     }
 
     if (fAuxData != NULL) {
-        LE_DELETE_ARRAY(fAuxData);
+        DELETE_GLYPH_ARRAY(fAuxData);
         fAuxData = NULL;
     }
 
@@ -50,12 +65,12 @@ void LEGlyphStorage::reset()
     }
 
     if (fCharIndices != NULL) {
-        LE_DELETE_ARRAY(fCharIndices);
+        DELETE_GLYPH_ARRAY(fCharIndices);
         fCharIndices = NULL;
     }
 
     if (fGlyphs != NULL) {
-        LE_DELETE_ARRAY(fGlyphs);
+        DELETE_GLYPH_ARRAY(fGlyphs);
         fGlyphs = NULL;
     }
 }
@@ -75,7 +90,7 @@ void LEGlyphStorage::allocateGlyphArray(le_int32 initialGlyphCount, le_bool righ
 
     if (fGlyphs == NULL) {
         fGlyphCount = initialGlyphCount;
-        fGlyphs = LE_NEW_ARRAY(LEGlyphID, fGlyphCount);
+        fGlyphs = NEW_GLYPH_ARRAY(LEGlyphID, fGlyphCount);
 
         if (fGlyphs == NULL) {
             success = LE_MEMORY_ALLOCATION_ERROR;
@@ -84,10 +99,10 @@ void LEGlyphStorage::allocateGlyphArray(le_int32 initialGlyphCount, le_bool righ
     }
 
     if (fCharIndices == NULL) {
-        fCharIndices = LE_NEW_ARRAY(le_int32, fGlyphCount);
+        fCharIndices = NEW_GLYPH_ARRAY(le_int32, fGlyphCount);
 
         if (fCharIndices == NULL) {
-            LE_DELETE_ARRAY(fGlyphs);
+            DELETE_GLYPH_ARRAY(fGlyphs);
             fGlyphs = NULL;
             success = LE_MEMORY_ALLOCATION_ERROR;
             return;
@@ -108,12 +123,12 @@ void LEGlyphStorage::allocateGlyphArray(le_int32 initialGlyphCount, le_bool righ
 
     if (fInsertionList == NULL) {
         // FIXME: check this for failure?
-        fInsertionList = new LEInsertionList(rightToLeft);
+        fInsertionList = new LEInsertionList(rightToLeft, fArena);
         if (fInsertionList == NULL) { 
-            LE_DELETE_ARRAY(fCharIndices);
+            DELETE_GLYPH_ARRAY(fCharIndices);
             fCharIndices = NULL;
 
-            LE_DELETE_ARRAY(fGlyphs);
+            DELETE_GLYPH_ARRAY(fGlyphs);
             fGlyphs = NULL;
 
             success = LE_MEMORY_ALLOCATION_ERROR;
@@ -134,7 +149,7 @@ le_int32 LEGlyphStorage::allocatePositions(LEErrorCode &success)
         return -1;
     }
 
-    fPositions = LE_NEW_ARRAY(float, 2 * (fGlyphCount + 1));
+    fPositions = NEW_GLYPH_ARRAY(float, 2 * (fGlyphCount + 1));
 
     if (fPositions == NULL) {
         success = LE_MEMORY_ALLOCATION_ERROR;
@@ -156,7 +171,7 @@ le_int32 LEGlyphStorage::allocateAuxData(LEErrorCode &success)
         return -1;
     }
 
-    fAuxData = LE_NEW_ARRAY(le_uint32, fGlyphCount);
+    fAuxData = NEW_GLYPH_ARRAY(le_uint32, fGlyphCount);
 
     if (fAuxData == NULL) {
         success = LE_MEMORY_ALLOCATION_ERROR;
@@ -456,7 +471,7 @@ void LEGlyphStorage::adjustPosition(le_int32 glyphIndex, float xAdjust, float yA
 void LEGlyphStorage::adoptGlyphArray(LEGlyphStorage &from)
 {
     if (fGlyphs != NULL) {
-        LE_DELETE_ARRAY(fGlyphs);
+        DELETE_GLYPH_ARRAY(fGlyphs);
     }
 
     fGlyphs = from.fGlyphs;
@@ -473,7 +488,7 @@ void LEGlyphStorage::adoptGlyphArray(LEGlyphStorage &from)
 void LEGlyphStorage::adoptCharIndicesArray(LEGlyphStorage &from)
 {
     if (fCharIndices != NULL) {
-        LE_DELETE_ARRAY(fCharIndices);
+        DELETE_GLYPH_ARRAY(fCharIndices);
     }
 
     fCharIndices = from.fCharIndices;
@@ -483,7 +498,7 @@ void LEGlyphStorage::adoptCharIndicesArray(LEGlyphStorage &from)
 void LEGlyphStorage::adoptPositionArray(LEGlyphStorage &from)
 {
     if (fPositions != NULL) {
-        LE_DELETE_ARRAY(fPositions);
+        DELETE_GLYPH_ARRAY(fPositions);
     }
 
     fPositions = from.fPositions;
@@ -493,7 +508,7 @@ void LEGlyphStorage::adoptPositionArray(LEGlyphStorage &from)
 void LEGlyphStorage::adoptAuxDataArray(LEGlyphStorage &from)
 {
     if (fAuxData != NULL) {
-        LE_DELETE_ARRAY(fAuxData);
+        DELETE_GLYPH_ARRAY(fAuxData);
     }
 
     fAuxData = from.fAuxData;
@@ -565,14 +580,14 @@ le_int32 LEGlyphStorage::applyInsertions()
 
     le_int32 newGlyphCount = fGlyphCount + growAmount;
 
-    LEGlyphID *newGlyphs = (LEGlyphID *) LE_GROW_ARRAY(fGlyphs, newGlyphCount); 
+    LEGlyphID *newGlyphs = (LEGlyphID *) GROW_GLYPH_ARRAY(fGlyphs, newGlyphCount); 
     if (newGlyphs == NULL) { 
         // Could not grow the glyph array 
         return fGlyphCount; 
     } 
     fGlyphs = newGlyphs; 
 
-    le_int32 *newCharIndices = (le_int32 *) LE_GROW_ARRAY(fCharIndices, newGlyphCount);
+    le_int32 *newCharIndices = (le_int32 *) GROW_GLYPH_ARRAY(fCharIndices, newGlyphCount);
     if (newCharIndices == NULL) { 
         // Could not grow the glyph array 
         return fGlyphCount; 
@@ -580,7 +595,7 @@ le_int32 LEGlyphStorage::applyInsertions()
     fCharIndices = newCharIndices;
 
     if (fAuxData != NULL) {	
-        le_uint32 *newAuxData = (le_uint32 *) LE_GROW_ARRAY(fAuxData, newGlyphCount); 
+        le_uint32 *newAuxData = (le_uint32 *) GROW_GLYPH_ARRAY(fAuxData, newGlyphCount); 
         if (newAuxData == NULL) { 
             // could not grow the aux data array 
             return fGlyphCount; 
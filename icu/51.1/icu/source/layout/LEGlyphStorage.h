@@ -1,6 +1,6 @@
 /*
  **********************************************************************
- *   Copyright (C) 1998-2010, International Business Machines
+ *   Copyright (C) 1998-2013, International Business Machines
  *   Corporation and others.  All Rights Reserved.
  **********************************************************************
  */
@@ -18,6 +18,8 @@
 
 U_NAMESPACE_BEGIN
 
+class LEGlyphArena;
+
 /**
  * This class encapsulates the per-glyph storage used by the ICU LayoutEngine.
  * For each glyph it holds the glyph ID, the index of the backing store character
@@ -91,6 +93,14 @@ private:
      */
     le_int32 fDestIndex;
 
+    /**
+     * The arena from which the data arrays are allocated,
+     * or <code>NULL</code> to allocate them from the heap.
+     *
+     * @internal
+     */
+    LEGlyphArena *fArena;
+
 protected:
     /**
      * This implements <code>LEInsertionCallback</code>. The <code>LEInsertionList</code>
@@ -120,6 +130,21 @@ public:
      */
     LEGlyphStorage();
 
+#ifndef U_HIDE_INTERNAL_API
+    /**
+     * Allocates an empty <code>LEGlyphStorage</code> object whose
+     * arrays will be allocated from <code>arena</code>. The arena
+     * must not be reset while the arrays are in use.
+     *
+     * @param arena the arena, or <code>NULL</code> to use the heap.
+     *
+     * @see LEGlyphArena
+     *
+     * @internal
+     */
+    LEGlyphStorage(LEGlyphArena *arena);
+#endif  /* U_HIDE_INTERNAL_API */
+
     /**
      * The destructor. This will deallocate all of the arrays.
      *
@@ -1,12 +1,13 @@
 /*
  **********************************************************************
- *   Copyright (C) 1998-2008, International Business Machines
+ *   Copyright (C) 1998-2013, International Business Machines
  *   Corporation and others.  All Rights Reserved.
  **********************************************************************
  */
 
 #include "LETypes.h"
 #include "LEInsertionList.h"
+#include "LEGlyphArena.h"
 
 U_NAMESPACE_BEGIN
 
@@ -23,7 +24,13 @@ struct InsertionRecord
 UOBJECT_DEFINE_RTTI_IMPLEMENTATION(LEInsertionList)
 
 LEInsertionList::LEInsertionList(le_bool rightToLeft)
-: head(NULL), tail(NULL), growAmount(0), append(rightToLeft)
+: head(NULL), tail(NULL), growAmount(0), append(rightToLeft), arena(NULL)
+{
+    tail = (InsertionRecord *) &head;
+}
+
+LEInsertionList::LEInsertionList(le_bool rightToLeft, LEGlyphArena *recordArena)
+: head(NULL), tail(NULL), growAmount(0), append(rightToLeft), arena(recordArena)
 {
     tail = (InsertionRecord *) &head;
 }
@@ -39,7 +46,7 @@ void LEInsertionList::reset()
         InsertionRecord *record = head;
 
         head = head->next;
-        LE_DELETE_ARRAY(record);
+        LEGlyphArena::deleteArray(record);
     }
 
     tail = (InsertionRecord *) &head;
@@ -57,7 +64,7 @@ LEGlyphID *LEInsertionList::insert(le_int32 position, le_int32 count, LEErrorCod
         return 0;
     }
 
-    InsertionRecord *insertion = (InsertionRecord *) LE_NEW_ARRAY(char, sizeof(InsertionRecord) + (count - ANY_NUMBER) * sizeof (LEGlyphID));
+    InsertionRecord *insertion = (InsertionRecord *) LEGlyphArena::allocateArray(arena, sizeof(InsertionRecord) + (count - ANY_NUMBER) * sizeof (LEGlyphID));
     if (insertion == NULL) { 
         success = LE_MEMORY_ALLOCATION_ERROR;
         return 0;
@@ -1,6 +1,6 @@
 /*
  **********************************************************************
- *   Copyright (C) 1998-2011, International Business Machines
+ *   Copyright (C) 1998-2013, International Business Machines
  *   Corporation and others.  All Rights Reserved.
  **********************************************************************
  */
@@ -13,6 +13,7 @@
 U_NAMESPACE_BEGIN
 
 struct InsertionRecord;
+class LEGlyphArena;
 
 #ifndef U_HIDE_INTERNAL_API
 /**
@@ -73,6 +74,19 @@ public:
      */
     LEInsertionList(le_bool rightToLeft);
 
+    /**
+     * Construct an empty insertion list which allocates
+     * its entries from an arena.
+     *
+     * @param rightToLeft <code>TRUE</code> if the glyphs are stored
+     *                    in the array in right to left order.
+     * @param arena the arena from which to allocate the entries,
+     *              or <code>NULL</code> to allocate them from the heap.
+     *
+     * @internal
+     */
+    LEInsertionList(le_bool rightToLeft, LEGlyphArena *arena);
+
     /**
      * The destructor.
      */
@@ -169,6 +183,14 @@ private:
      * @internal
      */
     le_bool  append;
+
+    /**
+     * The arena from which the insertion records are
+     * allocated, or <code>NULL</code>.
+     *
+     * @internal
+     */
+    LEGlyphArena *arena;
 };
 #endif  /* U_HIDE_INTERNAL_API */
 
@@ -23,6 +23,7 @@
 #include "CharSubstitutionFilter.h"
 
 #include "LEGlyphStorage.h"
+#include "LEGlyphArena.h"
 
 #include "OpenTypeUtilities.h"
 #include "GlyphSubstitutionTables.h"
@@ -143,7 +144,7 @@ LayoutEngine::LayoutEngine(const LEFontInstance *fontInstance,
                            le_int32 languageCode,
                            le_int32 typoFlags,
                            LEErrorCode &success)
-  : fGlyphStorage(NULL), fFontInstance(fontInstance), fScriptCode(scriptCode), fLanguageCode(languageCode),
+  : fGlyphStorage(NULL), fGlyphArena(NULL), fFontInstance(fontInstance), fScriptCode(scriptCode), fLanguageCode(languageCode),
     fTypoFlags(typoFlags), fFilterZeroWidth(TRUE)
 {
     if (LE_FAILURE(success)) {
@@ -219,7 +220,7 @@ le_int32 LayoutEngine::characterProcessing(const LEUnicode chars[], le_int32 off
 
 		const LEUnicode *inChars = &chars[offset];
 		LEUnicode *reordered = NULL;
-        LEGlyphStorage fakeGlyphStorage;
+        LEGlyphStorage fakeGlyphStorage(fGlyphArena);
 
         fakeGlyphStorage.allocateGlyphArray(count, rightToLeft, success);
 
@@ -496,7 +497,11 @@ le_int32 LayoutEngine::layoutChars(const LEUnicode chars[], le_int32 offset, le_
 
     le_int32 glyphCount;
 
-    if (fGlyphStorage->getGlyphCount() > 0) {
+    if (fGlyphArena != NULL) {
+        // Everything in the arena belongs to the last layout.
+        fGlyphStorage->reset();
+        fGlyphArena->reset();
+    } else if (fGlyphStorage->getGlyphCount() > 0) {
         fGlyphStorage->reset();
     }
 
@@ -510,6 +515,47 @@ le_int32 LayoutEngine::layoutChars(const LEUnicode chars[], le_int32 offset, le_
 void LayoutEngine::reset()
 {
     fGlyphStorage->reset();
+
+    if (fGlyphArena != NULL) {
+        fGlyphArena->reset();
+    }
+}
+
+void LayoutEngine::setArenaAllocation(le_bool useArena, LEErrorCode &success)
+{
+    if (LE_FAILURE(success)) {
+        return;
+    }
+
+    if ((fGlyphArena != NULL) == (useArena != FALSE)) {
+        return;
+    }
+
+    LEGlyphArena *arena = NULL;
+
+    if (useArena) {
+        arena = new LEGlyphArena();
+
+        if (arena == NULL) {
+            success = LE_MEMORY_ALLOCATION_ERROR;
+            return;
+        }
+    }
+
+    LEGlyphStorage *glyphStorage = new LEGlyphStorage(arena);
+
+    if (glyphStorage == NULL) {
+        delete arena;
+        success = LE_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+
+    // The old storage may still hold arrays from the old arena.
+    delete fGlyphStorage;
+    delete fGlyphArena;
+
+    fGlyphStorage = glyphStorage;
+    fGlyphArena   = arena;
 }
 
 LayoutEngine *LayoutEngine::layoutEngineFactory(const LEFontInstance *fontInstance, le_int32 scriptCode, le_int32 languageCode, LEErrorCode &success)
@@ -668,6 +714,7 @@ LayoutEngine *LayoutEngine::layoutEngineFactory(const LEFontInstance *fontInstan
 
 LayoutEngine::~LayoutEngine() {
     delete fGlyphStorage;
+    delete fGlyphArena;
 }
 
 U_NAMESPACE_END
@@ -17,6 +17,7 @@ U_NAMESPACE_BEGIN
 class LEFontInstance;
 class LEGlyphFilter;
 class LEGlyphStorage;
+class LEGlyphArena;
 
 /**
  * This is a virtual base class used to do complex text layout. The text must all
@@ -78,6 +79,16 @@ protected:
      */
     LEGlyphStorage *fGlyphStorage;
 
+    /**
+     * The arena from which the glyph storage is allocated,
+     * or <code>NULL</code> if it is allocated from the heap.
+     *
+     * @see setArenaAllocation
+     *
+     * @internal
+     */
+    LEGlyphArena *fGlyphArena;
+
     /**
      * The font instance for the text font.
      *
@@ -461,6 +472,24 @@ public:
      */
     virtual void reset();
 
+#ifndef U_HIDE_DRAFT_API
+    /**
+     * This method selects where the glyph, character index, position and
+     * auxillary data arrays are allocated. By default they are allocated
+     * from the heap for each call to <code>layoutChars</code>. With arena
+     * allocation, the engine keeps an arena which is reused by every layout,
+     * so that laying out text repeatedly causes far fewer heap allocations.
+     *
+     * Changing the allocation mode discards the results of the last layout.
+     *
+     * @param useArena - <code>TRUE</code> to allocate the arrays from an arena
+     * @param success - set to an error code if the operation fails
+     *
+     * @draft ICU 52
+     */
+    void setArenaAllocation(le_bool useArena, LEErrorCode &success);
+#endif  /* U_HIDE_DRAFT_API */
+
     /**
      * This method returns a LayoutEngine capable of laying out text
      * in the given font, script and langauge. Note that the LayoutEngine
@@ -20,11 +20,13 @@
 #include "GlyphPositioningTables.h"
 
 #include "LEGlyphStorage.h"
+#include "LEGlyphArena.h"
 #include "GlyphPositionAdjustments.h"
 
 #include "GDEFMarkFilter.h"
 
 #include "KernTable.h"
+#include "ShapedRunCache.h"
 
 U_NAMESPACE_BEGIN
 
@@ -198,6 +200,8 @@ OpenTypeLayoutEngine::OpenTypeLayoutEngine(const LEFontInstance *fontInstance, l
 
     setScriptAndLanguageTags();
 
+    fShapedRunCache = new ShapedRunCache();
+
     fGDEFTable = (const GlyphDefinitionTableHeader *) getFontTable(gdefTableTag);
     
 // JK patch, 2008-05-30 - see Sinhala bug report and LKLUG font
@@ -222,6 +226,8 @@ OpenTypeLayoutEngine::OpenTypeLayoutEngine(const LEFontInstance *fontInstance, l
       fGSUBTable(NULL), fGDEFTable(NULL), fGPOSTable(NULL), fSubstitutionFilter(NULL)
 {
     setScriptAndLanguageTags();
+
+    fShapedRunCache = new ShapedRunCache();
 }
 
 OpenTypeLayoutEngine::~OpenTypeLayoutEngine()
@@ -230,9 +236,65 @@ OpenTypeLayoutEngine::~OpenTypeLayoutEngine()
         delete fSubstitutionFilter;
     }
 
+    delete fShapedRunCache;
+
     reset();
 }
 
+le_int32 OpenTypeLayoutEngine::layoutChars(const LEUnicode chars[], le_int32 offset, le_int32 count, le_int32 max, le_bool rightToLeft,
+                                           float x, float y, LEErrorCode &success)
+{
+    if (LE_FAILURE(success)) {
+        return 0;
+    }
+
+    if (chars == NULL || offset < 0 || count < 0 || max < 0 || offset >= max || offset + count > max) {
+        success = LE_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+
+    if (fShapedRunCache == NULL) {
+        return LayoutEngine::layoutChars(chars, offset, count, max, rightToLeft, x, y, success);
+    }
+
+    le_int32 glyphCount;
+
+    fGlyphStorage->reset();
+
+    if (fGlyphArena != NULL) {
+        fGlyphArena->reset();
+    }
+
+    if (fShapedRunCache->fetch(chars, offset, count, max, rightToLeft, x, y, *fGlyphStorage, glyphCount, success)) {
+        return glyphCount;
+    }
+
+    if (LE_FAILURE(success)) {
+        return 0;
+    }
+
+    // A failed fetch may have left partial results behind.
+    fGlyphStorage->reset();
+
+    glyphCount = LayoutEngine::layoutChars(chars, offset, count, max, rightToLeft, x, y, success);
+
+    if (LE_SUCCESS(success)) {
+        fShapedRunCache->store(chars, offset, count, max, rightToLeft, x, y, *fGlyphStorage);
+    }
+
+    return glyphCount;
+}
+
+le_uint32 OpenTypeLayoutEngine::getShapedRunCacheHits() const
+{
+    return fShapedRunCache != NULL ? fShapedRunCache->getHits() : 0;
+}
+
+le_uint32 OpenTypeLayoutEngine::getShapedRunCacheMisses() const
+{
+    return fShapedRunCache != NULL ? fShapedRunCache->getMisses() : 0;
+}
+
 LETag OpenTypeLayoutEngine::getScriptTag(le_int32 scriptCode)
 {
     if (scriptCode < 0 || scriptCode >= scriptCodeCount) {
@@ -397,7 +459,7 @@ le_int32 OpenTypeLayoutEngine::glyphPostProcessing(LEGlyphStorage &tempGlyphStor
 le_int32 OpenTypeLayoutEngine::computeGlyphs(const LEUnicode chars[], le_int32 offset, le_int32 count, le_int32 max, le_bool rightToLeft, LEGlyphStorage &glyphStorage, LEErrorCode &success)
 {
     LEUnicode *outChars = NULL;
-    LEGlyphStorage fakeGlyphStorage;
+    LEGlyphStorage fakeGlyphStorage(fGlyphArena);
     le_int32 outCharCount, outGlyphCount;
 
     if (LE_FAILURE(success)) {
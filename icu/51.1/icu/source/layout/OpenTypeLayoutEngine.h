@@ -1,5 +1,5 @@
 /*
- * (C) Copyright IBM Corp. 1998-2009 - All Rights Reserved
+ * (C) Copyright IBM Corp. 1998-2013 - All Rights Reserved
  *
  */
 
@@ -17,6 +17,8 @@
 
 U_NAMESPACE_BEGIN
 
+class ShapedRunCache;
+
 /**
  * OpenTypeLayoutEngine implements complex text layout for OpenType fonts - that is
  * fonts which have GSUB and GPOS tables associated with them. In order to do this,
@@ -125,6 +127,35 @@ public:
      */
     static LETag getLangSysTag(le_int32 languageCode);
 
+    /**
+     * This method lays out the characters like <code>LayoutEngine::layoutChars</code>,
+     * but reuses the glyphs, character indices and positions of a recently
+     * laid out run with the same character context, range and direction
+     * instead of shaping it again.
+     *
+     * @see LayoutEngine::layoutChars
+     *
+     * @internal
+     */
+    virtual le_int32 layoutChars(const LEUnicode chars[], le_int32 offset, le_int32 count, le_int32 max, le_bool rightToLeft, float x, float y, LEErrorCode &success);
+
+    /**
+     * This method returns the number of calls to <code>layoutChars</code>
+     * which were answered from the shaped run cache.
+     *
+     * @internal
+     */
+    le_uint32 getShapedRunCacheHits() const;
+
+    /**
+     * This method returns the number of calls to <code>layoutChars</code>
+     * which had to shape their run. The cache hit rate is the number
+     * of hits divided by the sum of the hits and the misses.
+     *
+     * @internal
+     */
+    le_uint32 getShapedRunCacheMisses() const;
+
     /**
      * ICU "poor man's RTTI", returns a UClassID for the actual class.
      *
@@ -159,6 +190,11 @@ private:
      */
     static const LETag scriptTags[];
 
+    /**
+     * The recently laid out runs.
+     */
+    ShapedRunCache *fShapedRunCache;
+
 protected:
     /**
      * A set of "default" features. The default characterProcessing method
@@ -0,0 +1,194 @@
+/*
+ *
+ * (C) Copyright IBM Corp. and others 2013 - All Rights Reserved
+ *
+ */
+
+#include "LETypes.h"
+#include "LEGlyphStorage.h"
+#include "ShapedRunCache.h"
+
+U_NAMESPACE_BEGIN
+
+struct ShapedRun
+{
+    le_uint32  hash;
+    le_int32   offset;
+    le_int32   count;
+    le_int32   max;
+    le_bool    rightToLeft;
+    le_int32   glyphCount;
+    le_uint32  lastUsed;
+
+    LEUnicode *chars;       // the character context, max entries
+    LEGlyphID *glyphs;      // glyphCount entries
+    le_int32  *charIndices; // glyphCount entries
+    float     *positions;   // 2 * (glyphCount + 1) entries, relative to the run origin
+};
+
+static void deleteRun(ShapedRun *run)
+{
+    if (run != NULL) {
+        LE_DELETE_ARRAY(run->chars);
+        LE_DELETE_ARRAY(run->glyphs);
+        LE_DELETE_ARRAY(run->charIndices);
+        LE_DELETE_ARRAY(run->positions);
+        LE_DELETE_ARRAY(run);
+    }
+}
+
+ShapedRunCache::ShapedRunCache()
+    : fClock(0), fHits(0), fMisses(0)
+{
+    for (le_int32 i = 0; i < CACHE_SIZE; i += 1) {
+        fRuns[i] = NULL;
+    }
+}
+
+ShapedRunCache::~ShapedRunCache()
+{
+    flush();
+}
+
+void ShapedRunCache::flush()
+{
+    for (le_int32 i = 0; i < CACHE_SIZE; i += 1) {
+        deleteRun(fRuns[i]);
+        fRuns[i] = NULL;
+    }
+}
+
+le_uint32 ShapedRunCache::hashChars(const LEUnicode chars[], le_int32 max)
+{
+    le_uint32 hash = 0x811C9DC5;
+
+    for (le_int32 i = 0; i < max; i += 1) {
+        hash = (hash ^ chars[i]) * 0x01000193;
+    }
+
+    return hash;
+}
+
+le_bool ShapedRunCache::fetch(const LEUnicode chars[], le_int32 offset, le_int32 count, le_int32 max, le_bool rightToLeft,
+                              float x, float y, LEGlyphStorage &glyphStorage, le_int32 &glyphCount, LEErrorCode &success)
+{
+    if (LE_FAILURE(success) || max > MAX_CONTEXT_LENGTH) {
+        return FALSE;
+    }
+
+    le_uint32 hash = hashChars(chars, max);
+
+    for (le_int32 r = 0; r < CACHE_SIZE; r += 1) {
+        ShapedRun *run = fRuns[r];
+
+        if (run == NULL || run->hash != hash || run->offset != offset || run->count != count ||
+            run->max != max || run->rightToLeft != rightToLeft) {
+            continue;
+        }
+
+        le_int32 c;
+
+        for (c = 0; c < max && run->chars[c] == chars[c]; c += 1) {
+            // nothing else to do
+        }
+
+        if (c < max) {
+            continue;
+        }
+
+        le_int32 g;
+
+        glyphStorage.allocateGlyphArray(run->glyphCount, rightToLeft, success);
+        glyphStorage.allocatePositions(success);
+
+        for (g = 0; g < run->glyphCount; g += 1) {
+            glyphStorage.setGlyphID(g, run->glyphs[g], success);
+            glyphStorage.setCharIndex(g, run->charIndices[g], success);
+        }
+
+        for (g = 0; g <= run->glyphCount; g += 1) {
+            glyphStorage.setPosition(g, run->positions[g * 2] + x, run->positions[g * 2 + 1] + y, success);
+        }
+
+        if (LE_FAILURE(success)) {
+            return FALSE;
+        }
+
+        run->lastUsed = ++fClock;
+        glyphCount = run->glyphCount;
+        fHits += 1;
+        return TRUE;
+    }
+
+    fMisses += 1;
+    return FALSE;
+}
+
+void ShapedRunCache::store(const LEUnicode chars[], le_int32 offset, le_int32 count, le_int32 max, le_bool rightToLeft,
+                           float x, float y, const LEGlyphStorage &glyphStorage)
+{
+    le_int32 glyphCount = glyphStorage.getGlyphCount();
+
+    if (max > MAX_CONTEXT_LENGTH || glyphCount <= 0) {
+        return;
+    }
+
+    LEErrorCode success = LE_NO_ERROR;
+    ShapedRun *run = LE_NEW_ARRAY(ShapedRun, 1);
+
+    if (run == NULL) {
+        return;
+    }
+
+    run->chars       = LE_NEW_ARRAY(LEUnicode, max);
+    run->glyphs      = LE_NEW_ARRAY(LEGlyphID, glyphCount);
+    run->charIndices = LE_NEW_ARRAY(le_int32, glyphCount);
+    run->positions   = LE_NEW_ARRAY(float, 2 * (glyphCount + 1));
+
+    if (run->chars == NULL || run->glyphs == NULL || run->charIndices == NULL || run->positions == NULL) {
+        deleteRun(run);
+        return;
+    }
+
+    glyphStorage.getGlyphs(run->glyphs, success);
+    glyphStorage.getCharIndices(run->charIndices, success);
+    glyphStorage.getGlyphPositions(run->positions, success);
+
+    if (LE_FAILURE(success)) {
+        deleteRun(run);
+        return;
+    }
+
+    for (le_int32 g = 0; g <= glyphCount; g += 1) {
+        run->positions[g * 2]     -= x;
+        run->positions[g * 2 + 1] -= y;
+    }
+
+    LE_ARRAY_COPY(run->chars, chars, max);
+    run->hash        = hashChars(chars, max);
+    run->offset      = offset;
+    run->count       = count;
+    run->max         = max;
+    run->rightToLeft = rightToLeft;
+    run->glyphCount  = glyphCount;
+    run->lastUsed    = ++fClock;
+
+    // Use an empty slot if there is one, otherwise replace the least recently used run.
+    le_int32 victim = 0;
+
+    for (le_int32 r = 0; r < CACHE_SIZE; r += 1) {
+        if (fRuns[r] == NULL) {
+            victim = r;
+            break;
+        }
+
+        if (fRuns[r]->lastUsed < fRuns[victim]->lastUsed) {
+            victim = r;
+        }
+    }
+
+    deleteRun(fRuns[victim]);
+    fRuns[victim] = run;
+}
+
+U_NAMESPACE_END
@@ -0,0 +1,82 @@
+/*
+ *
+ * (C) Copyright IBM Corp. and others 2013 - All Rights Reserved
+ *
+ */
+
+#ifndef __SHAPEDRUNCACHE_H
+#define __SHAPEDRUNCACHE_H
+
+#include "LETypes.h"
+
+U_NAMESPACE_BEGIN
+
+class LEGlyphStorage;
+struct ShapedRun;
+
+/**
+ * A small least-recently-used cache of the results of
+ * <code>LayoutEngine::layoutChars</code>: the glyphs, character
+ * indices and glyph positions of recently shaped runs.
+ *
+ * A cache belongs to a single layout engine, so the font instance,
+ * script, language and feature set are fixed; runs are keyed by
+ * the character context, the range within it and the direction.
+ * Positions are stored relative to the starting point of the run,
+ * so a cached run can be reused at any X, Y position.
+ *
+ * @internal
+ */
+class ShapedRunCache : public UMemory
+{
+public:
+    enum {
+        /** The number of runs kept. */
+        CACHE_SIZE = 8,
+        /** Runs with a longer character context are not cached. */
+        MAX_CONTEXT_LENGTH = 256
+    };
+
+    ShapedRunCache();
+
+    ~ShapedRunCache();
+
+    /**
+     * Look for a run and, if it is cached, fill the glyph storage
+     * with its glyphs, character indices and positions, offset
+     * by <code>x</code> and <code>y</code>.
+     *
+     * @return <code>TRUE</code> if the run was found, in which case
+     *         <code>glyphCount</code> is set to the number of glyphs.
+     */
+    le_bool fetch(const LEUnicode chars[], le_int32 offset, le_int32 count, le_int32 max, le_bool rightToLeft,
+                  float x, float y, LEGlyphStorage &glyphStorage, le_int32 &glyphCount, LEErrorCode &success);
+
+    /**
+     * Remember the result of laying out a run which was started
+     * at <code>x</code>, <code>y</code>. The least recently used run
+     * is dropped if the cache is full.
+     */
+    void store(const LEUnicode chars[], le_int32 offset, le_int32 count, le_int32 max, le_bool rightToLeft,
+               float x, float y, const LEGlyphStorage &glyphStorage);
+
+    /** Forget all cached runs. The hit and miss counts are kept. */
+    void flush();
+
+    /** The number of <code>fetch</code> calls which found their run. */
+    le_uint32 getHits() const { return fHits; }
+
+    /** The number of <code>fetch</code> calls which did not find their run. */
+    le_uint32 getMisses() const { return fMisses; }
+
+private:
+    static le_uint32 hashChars(const LEUnicode chars[], le_int32 max);
+
+    ShapedRun *fRuns[CACHE_SIZE];
+    le_uint32  fClock;
+    le_uint32  fHits;
+    le_uint32  fMisses;
+};
+
+U_NAMESPACE_END
+#endif
@@ -36,6 +36,7 @@ static void TestAttribute(void);
 static void TestDefault(void);
 static void TestDefaultKeyword(void);
 static void TestBengaliSortKey(void);
+static void TestGetSortKeys(void);
         int TestBufferSize();    /* defined in "colutil.c" */
 
 
@@ -86,6 +87,7 @@ void addCollAPITest(TestNode** root)
     addTest(root, &TestOpenVsOpenRules, "tscoll/capitst/TestOpenVsOpenRules");
     addTest(root, &TestBengaliSortKey, "tscoll/capitst/TestBengaliSortKey");
     addTest(root, &TestGetKeywordValuesForLocale, "tscoll/capitst/TestGetKeywordValuesForLocale");
+    addTest(root, &TestGetSortKeys, "tscoll/capitst/TestGetSortKeys");
 }
 
 void TestGetSetAttr(void) {
@@ -2409,4 +2411,96 @@ static void TestGetKeywordValuesForLocale(void) {
 }
 
 
+static void TestGetSortKeys(void) {
+    static const char *cases[] = {
+        "abc", "Abc", "ab", "", "abcdefghijklmnopqrstuvwxyz", "abcdefghijklmnopqrstuvwxyZ", "\\u00e4bc", "b"
+    };
+    enum { CASE_COUNT = sizeof(cases)/sizeof(cases[0]) };
+    UErrorCode status = U_ZERO_ERROR;
+    UCollator *coll = ucol_open("root", &status);
+    UChar strings[CASE_COUNT][64];
+    const UChar *sources[CASE_COUNT];
+    int32_t lengths[CASE_COUNT];
+    int32_t keyIndexes[CASE_COUNT+1];
+    int32_t order[CASE_COUNT];
+    uint8_t keys[2048], key[256];
+    int32_t i, length, preflightLength;
+
+    if(U_FAILURE(status)) {
+        log_err_status(status, "ucol_open(root) failed - %s\n", u_errorName(status));
+        return;
+    }
+    for(i = 0; i < CASE_COUNT; ++i) {
+        lengths[i] = u_unescape(cases[i], strings[i], 64);
+        sources[i] = strings[i];
+    }
+
+    /* preflighting */
+    preflightLength = ucol_getSortKeys(coll, sources, lengths, CASE_COUNT, 0, NULL, 0, keyIndexes, &status);
+    if(status != U_BUFFER_OVERFLOW_ERROR || preflightLength <= 0) {
+        log_err("ucol_getSortKeys() preflighting failed - %s\n", u_errorName(status));
+    }
+    status = U_ZERO_ERROR;
+
+    /* every key must be the same as from ucol_getSortKey() */
+    length = ucol_getSortKeys(coll, sources, NULL, CASE_COUNT, 0, keys, sizeof(keys), keyIndexes, &status);
+    if(U_FAILURE(status) || length != preflightLength || keyIndexes[CASE_COUNT] != length) {
+        log_err("ucol_getSortKeys() failed - %s, length %d\n", u_errorName(status), length);
+    } else {
+        for(i = 0; i < CASE_COUNT; ++i) {
+            int32_t keyLength = ucol_getSortKey(coll, sources[i], lengths[i], key, sizeof(key));
+            if(keyLength != keyIndexes[i+1] - keyIndexes[i] ||
+                uprv_memcmp(key, keys + keyIndexes[i], keyLength) != 0) {
+                log_err("ucol_getSortKeys() key %d differs from ucol_getSortKey()\n", i);
+            }
+        }
+        ucol_sortBySortKeys(keys, keyIndexes, CASE_COUNT, order, &status);
+        for(i = 1; U_SUCCESS(status) && i < CASE_COUNT; ++i) {
+            if(ucol_strcoll(coll, sources[order[i-1]], lengths[order[i-1]],
+                                  sources[order[i]], lengths[order[i]]) == UCOL_GREATER) {
+                log_err("ucol_sortBySortKeys() put \"%s\" before \"%s\"\n", cases[order[i-1]], cases[order[i]]);
+            }
+        }
+        if(U_FAILURE(status)) {
+            log_err("ucol_sortBySortKeys() failed - %s\n", u_errorName(status));
+        }
+    }
+
+    /* truncated keys are prefixes of the full keys, and sort the same way except for ties */
+    status = U_ZERO_ERROR;
+    length = ucol_getSortKeys(coll, sources, lengths, CASE_COUNT, 6, keys, sizeof(keys), keyIndexes, &status);
+    if(U_FAILURE(status)) {
+        log_err("ucol_getSortKeys(maxKeyLength=6) failed - %s\n", u_errorName(status));
+    } else {
+        for(i = 0; i < CASE_COUNT; ++i) {
+            int32_t keyLength = keyIndexes[i+1] - keyIndexes[i];
+            int32_t fullLength = ucol_getSortKey(coll, sources[i], lengths[i], key, sizeof(key));
+            if(keyLength > 6 || (keyLength < 6 && keyLength != fullLength) ||
+                keys[keyIndexes[i] + keyLength - 1] != 0 ||
+                uprv_memcmp(key, keys + keyIndexes[i], keyLength - 1) != 0) {
+                log_err("ucol_getSortKeys(maxKeyLength=6) key %d is not a prefix of the full key\n", i);
+            }
+        }
+        ucol_sortBySortKeys(keys, keyIndexes, CASE_COUNT, order, &status);
+        for(i = 1; U_SUCCESS(status) && i < CASE_COUNT; ++i) {
+            if(uprv_strcmp((const char *)keys + keyIndexes[order[i-1]], (const char *)keys + keyIndexes[order[i]]) == 0) {
+                continue;
+            }
+            if(ucol_strcoll(coll, sources[order[i-1]], lengths[order[i-1]],
+                                  sources[order[i]], lengths[order[i]]) == UCOL_GREATER) {
+                log_err("ucol_sortBySortKeys() on truncated keys put \"%s\" before \"%s\"\n",
+                        cases[order[i-1]], cases[order[i]]);
+            }
+        }
+    }
+
+    /* illegal arguments */
+    status = U_ZERO_ERROR;
+    ucol_getSortKeys(coll, sources, lengths, CASE_COUNT, 1, keys, sizeof(keys), keyIndexes, &status);
+    if(status != U_ILLEGAL_ARGUMENT_ERROR) {
+        log_err("ucol_getSortKeys(maxKeyLength=1) did not fail - %s\n", u_errorName(status));
+    }
+    ucol_close(coll);
+}
+
 #endif /* #if !UCONFIG_NO_COLLATION */
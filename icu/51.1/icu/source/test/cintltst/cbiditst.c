@@ -1,6 +1,6 @@
 /********************************************************************
  * COPYRIGHT:
- * Copyright (c) 1997-2012, International Business Machines Corporation and
+ * Copyright (c) 1997-2013, International Business Machines Corporation and
  * others. All Rights Reserved.
  ********************************************************************/
 /*   file name:  cbiditst.cpp
@@ -82,6 +82,8 @@ static void testGetBaseDirection(void);
 
 static void testContext(void);
 
+static void testParaCache(void);
+
 static void doTailTest(void);
 
 /* new BIDI API */
@@ -130,6 +132,7 @@ addComplexTest(TestNode** root) {
     addTest(root, testClassOverride, "complex/bidi/TestClassOverride");
     addTest(root, testGetBaseDirection, "complex/bidi/testGetBaseDirection");
     addTest(root, testContext, "complex/bidi/testContext");
+    addTest(root, testParaCache, "complex/bidi/testParaCache");
 
     addTest(root, doArabicShapingTest, "complex/arabic-shaping/ArabicShapingTest");
     addTest(root, doLamAlefSpecialVLTRArabicShapingTest, "complex/arabic-shaping/lamalef");
@@ -4654,3 +4657,107 @@ testContext(void) {
 
     log_verbose("\nExiting TestContext \n\n");
 }
+
+/* Checks that the logical->visual maps of two UBiDi objects are the same. */
+static UBool
+checkSameVisualMap(const char *name, UBiDi *pCached, UBiDi *pExpected, int32_t length) {
+    int32_t cachedMap[MAXLEN], expectedMap[MAXLEN];
+    UErrorCode rc = U_ZERO_ERROR;
+    ubidi_getLogicalMap(pCached, cachedMap, &rc);
+    ubidi_getLogicalMap(pExpected, expectedMap, &rc);
+    if (!assertSuccessful("ubidi_getLogicalMap", &rc)) {
+        return FALSE;
+    }
+    if (ubidi_getDirection(pCached) != ubidi_getDirection(pExpected) ||
+        ubidi_getParaLevel(pCached) != ubidi_getParaLevel(pExpected) ||
+        memcmp(cachedMap, expectedMap, length * sizeof(int32_t)) != 0) {
+        log_err("%s: ubidi_setParaCached() result differs from ubidi_setPara()\n", name);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+testParaCache(void) {
+    /* "abc ALEF BET 12" and "abc def 12" */
+    static const UChar mixed[] = { 0x61, 0x62, 0x63, 0x20, 0x5d0, 0x5d1, 0x20, 0x31, 0x32 };
+    static const UChar ltr[] = { 0x61, 0x62, 0x63, 0x20, 0x64, 0x65, 0x66, 0x20, 0x31, 0x32 };
+    UChar text[MAXLEN];
+    UBiDi *pBiDi, *pExpected;
+    UErrorCode rc = U_ZERO_ERROR;
+    int32_t hits0, misses0, hits, misses;
+
+    log_verbose("\nEntering TestParaCache\n\n");
+
+    ubidi_setParaCached(NULL, mixed, LENGTHOF(mixed), 0, &rc);
+    assertIllegalArgument("Error when BiDi object is null", &rc);
+
+    pBiDi = getBiDiObject();
+    pExpected = getBiDiObject();
+    if (pBiDi == NULL || pExpected == NULL) {
+        ubidi_close(pBiDi);
+        ubidi_close(pExpected);
+        return;
+    }
+    ubidi_getParaCacheCounts(&hits0, &misses0);
+
+    rc = U_ZERO_ERROR;
+    ubidi_setParaCached(pBiDi, mixed, LENGTHOF(mixed), UBIDI_DEFAULT_LTR, &rc);
+    ubidi_setPara(pExpected, mixed, LENGTHOF(mixed), UBIDI_DEFAULT_LTR, NULL, &rc);
+    assertSuccessful("ubidi_setParaCached", &rc);
+    checkSameVisualMap("mixed", pBiDi, pExpected, LENGTHOF(mixed));
+
+    /* same contents in a different buffer: reuses the result */
+    u_memcpy(text, mixed, LENGTHOF(mixed));
+    ubidi_setParaCached(pBiDi, text, LENGTHOF(mixed), UBIDI_DEFAULT_LTR, &rc);
+    assertSuccessful("ubidi_setParaCached", &rc);
+    if (ubidi_getText(pBiDi) != text) {
+        log_err("ubidi_setParaCached() did not set the new text pointer\n");
+    }
+    checkSameVisualMap("mixed again", pBiDi, pExpected, LENGTHOF(mixed));
+    ubidi_getParaCacheCounts(&hits, &misses);
+    if (hits != hits0 + 1 || misses != misses0 + 1) {
+        log_err("ubidi_getParaCacheCounts() hits=%d misses=%d, expected %d %d\n",
+                hits - hits0, misses - misses0, 1, 1);
+    }
+
+    /* changed text, paraLevel and reordering mode must not reuse the result */
+    text[4] = 0x64;
+    ubidi_setParaCached(pBiDi, text, LENGTHOF(mixed), UBIDI_DEFAULT_LTR, &rc);
+    ubidi_setPara(pExpected, text, LENGTHOF(mixed), UBIDI_DEFAULT_LTR, NULL, &rc);
+    checkSameVisualMap("changed text", pBiDi, pExpected, LENGTHOF(mixed));
+    ubidi_setParaCached(pBiDi, text, LENGTHOF(mixed), 1, &rc);
+    ubidi_setPara(pExpected, text, LENGTHOF(mixed), 1, NULL, &rc);
+    checkSameVisualMap("changed paraLevel", pBiDi, pExpected, LENGTHOF(mixed));
+    ubidi_setReorderingMode(pBiDi, UBIDI_REORDER_NUMBERS_SPECIAL);
+    ubidi_setReorderingMode(pExpected, UBIDI_REORDER_NUMBERS_SPECIAL);
+    ubidi_setParaCached(pBiDi, text, LENGTHOF(mixed), 1, &rc);
+    ubidi_setPara(pExpected, text, LENGTHOF(mixed), 1, NULL, &rc);
+    checkSameVisualMap("changed mode", pBiDi, pExpected, LENGTHOF(mixed));
+    assertSuccessful("ubidi_setParaCached", &rc);
+    ubidi_getParaCacheCounts(&hits, &misses);
+    if (hits != hits0 + 1 || misses != misses0 + 4) {
+        log_err("ubidi_getParaCacheCounts() hits=%d misses=%d, expected %d %d\n",
+                hits - hits0, misses - misses0, 1, 4);
+    }
+
+    /* LTR-only text is resolved without the full algorithm */
+    ubidi_setReorderingMode(pBiDi, UBIDI_REORDER_DEFAULT);
+    ubidi_setParaCached(pBiDi, ltr, LENGTHOF(ltr), UBIDI_DEFAULT_RTL, &rc);
+    assertSuccessful("ubidi_setParaCached", &rc);
+    if (ubidi_getDirection(pBiDi) != UBIDI_LTR || ubidi_getParaLevel(pBiDi) != 0) {
+        log_err("LTR text: direction=%d paraLevel=%d, expected LTR and 0\n",
+                ubidi_getDirection(pBiDi), ubidi_getParaLevel(pBiDi));
+    }
+    ubidi_setParaCached(pBiDi, ltr, LENGTHOF(ltr), 1, &rc);
+    if (ubidi_getDirection(pBiDi) != UBIDI_MIXED || ubidi_getParaLevel(pBiDi) != 1) {
+        log_err("LTR text at paraLevel 1: direction=%d paraLevel=%d, expected MIXED and 1\n",
+                ubidi_getDirection(pBiDi), ubidi_getParaLevel(pBiDi));
+    }
+    assertSuccessful("ubidi_setParaCached", &rc);
+
+    ubidi_close(pBiDi);
+    ubidi_close(pExpected);
+
+    log_verbose("\nExiting TestParaCache\n\n");
+}
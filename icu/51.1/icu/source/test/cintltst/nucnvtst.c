@@ -95,6 +95,7 @@ static void TestEBCDICUS4XML(void);
 static void TestJitterbug915(void);
 #endif
 static void TestISCII(void);
+static void TestDVB(void);
 
 static void TestCoverageMBCS(void);
 static void TestJitterbug2346(void);
@@ -310,6 +311,7 @@ void addTestNewConvert(TestNode** root)
    addTest(root, &TestJitterbug255, "tsconv/nucnvtst/TestJitterbug255");
    addTest(root, &TestEBCDICUS4XML, "tsconv/nucnvtst/TestEBCDICUS4XML");
    addTest(root, &TestISCII, "tsconv/nucnvtst/TestISCII");
+   addTest(root, &TestDVB, "tsconv/nucnvtst/TestDVB");
    addTest(root, &TestJB5275, "tsconv/nucnvtst/TestJB5275");
    addTest(root, &TestJB5275_1, "tsconv/nucnvtst/TestJB5275_1");
 #if !UCONFIG_NO_COLLATION
@@ -3283,6 +3285,85 @@ TestISCII(){
 
 }
 
+static void
+TestDVB(){
+    static const struct {
+        const char *bytes;
+        int32_t length;
+        UChar u[9];
+        int32_t uLength;
+    } strings[]={
+        /* table 00: diacritics, control codes and a diacritic with no precomposed letter */
+        { "Caf\xc2" "e \x86\xc8u\x87\x8a\xc2x", 13, { 0x43, 0x61, 0x66, 0xe9, 0x20, 0xfc, 0x0a, 0x78, 0x301 }, 9 },
+        { "\xc8 \xa4\xe9", 4, { 0xa8, 0x20ac, 0xd8 }, 3 },
+        /* ISO 8859-9, and ISO 8859-2 by its three-byte selector */
+        { "\x05\xfe\xdd", 3, { 0x15f, 0x130 }, 2 },
+        { "\x10\x00\x02\xb1", 4, { 0x105 }, 1 },
+        /* ISO 10646 in two bytes and in UTF-8, with CR/LF */
+        { "\x11\x00\x41\xe0\x8a\x4e\x2d", 7, { 0x41, 0x0a, 0x4e2d }, 3 },
+        { "\x15\x41\xee\x82\x8a\xe4\xb8\xad", 8, { 0x41, 0x0a, 0x4e2d }, 3 },
+        /* a reserved selector is substituted, and the string read as table 00 */
+        { "\x1e" "A\xc2" "e", 4, { 0xfffd, 0x41, 0xe9 }, 3 }
+    };
+    static const int32_t offsets[]={ 0, 1, 2, 3, 5, 7, 10, 11, 11 };
+    static const uint16_t in[]={
+        0x0054, 0x00E9, 0x006C, 0x00E9, 0x006A, 0x006F, 0x0075, 0x0072, 0x006E, 0x0061,
+        0x006C, 0x0020, 0x2015, 0x0020, 0x0053, 0x0070, 0x006F, 0x0072, 0x0074, 0x0073,
+        0x0063, 0x0068, 0x0061, 0x0075, 0x000A, 0x0141, 0x00F3, 0x0064, 0x017A, 0x0020,
+        0x0158, 0x00ED, 0x006A, 0x0065, 0x006E, 0x0020, 0x0150, 0x0171, 0x0020, 0x00C5,
+        0x0073, 0x0020, 0x00DF, 0x0020, 0x20AC, 0x0020, 0x00BD, 0x0020, 0x00B4, 0x02C7
+    };
+    UChar uBuf[16];
+    int32_t offs[16];
+    char cBuf[16];
+    UChar *uTarget;
+    int32_t *myOff;
+    const char *cSource;
+    int32_t i, j, length;
+    UErrorCode errorCode=U_ZERO_ERROR;
+    UConverter *cnv=ucnv_open("DVB", &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_data_err("Unable to open DVB converter: %s\n", u_errorName(errorCode));
+        return;
+    }
+
+    for(i=0; i<LENGTHOF(strings); ++i) {
+        errorCode=U_ZERO_ERROR;
+        length=ucnv_toUChars(cnv, uBuf, LENGTHOF(uBuf), strings[i].bytes, strings[i].length, &errorCode);
+        if(U_FAILURE(errorCode) || length!=strings[i].uLength ||
+           0!=u_memcmp(uBuf, strings[i].u, length)
+        ) {
+            log_err("DVB string %d converted wrong - %s, length %d\n", i, u_errorName(errorCode), length);
+        }
+    }
+
+    /* the offsets of the first string */
+    errorCode=U_ZERO_ERROR;
+    ucnv_reset(cnv);
+    uTarget=uBuf;
+    myOff=offs;
+    cSource=strings[0].bytes;
+    ucnv_toUnicode(cnv, &uTarget, uBuf+LENGTHOF(uBuf), &cSource, cSource+strings[0].length,
+                   myOff, TRUE, &errorCode);
+    for(j=0; U_SUCCESS(errorCode) && j<LENGTHOF(offsets); ++j) {
+        if(offs[j]!=offsets[j]) {
+            log_err("DVB offset %d is %d, expected %d\n", j, offs[j], offsets[j]);
+        }
+    }
+
+    /* table 00 from Unicode */
+    errorCode=U_ZERO_ERROR;
+    length=ucnv_fromUChars(cnv, cBuf, LENGTHOF(cBuf), strings[1].u, strings[1].uLength, &errorCode);
+    if(U_FAILURE(errorCode) || length!=4 || 0!=uprv_memcmp(cBuf, strings[1].bytes, 4)) {
+        log_err("DVB from Unicode failed - %s, length %d\n", u_errorName(errorCode), length);
+    }
+
+    TestSmallTargetBuffer(in,(const UChar*)in + (sizeof(in)/sizeof(in[0])),cnv);
+    TestSmallSourceBuffer(in,(const UChar*)in + (sizeof(in)/sizeof(in[0])),cnv);
+    TestToAndFromUChars(in,(const UChar*)in + (sizeof(in)/sizeof(in[0])),cnv);
+    ucnv_close(cnv);
+}
+
 static void
 TestISO_2022_JP() {
     /* test input */
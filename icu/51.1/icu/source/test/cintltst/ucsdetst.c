@@ -1,6 +1,6 @@
 /*
  ****************************************************************************
- * Copyright (c) 2005-2009, International Business Machines Corporation and *
+ * Copyright (c) 2005-2013, International Business Machines Corporation and *
  * others. All Rights Reserved.                                             *
  ****************************************************************************
  */
@@ -30,6 +30,7 @@ static void TestChaining(void);
 static void TestBufferOverflow(void);
 static void TestIBM424(void);
 static void TestIBM420(void);
+static void TestStreaming(void);
 
 void addUCsdetTest(TestNode** root);
 
@@ -42,6 +43,7 @@ void addUCsdetTest(TestNode** root)
     addTest(root, &TestInputFilter, "ucsdetst/TestInputFilter");
     addTest(root, &TestChaining, "ucsdetst/TestErrorChaining");
     addTest(root, &TestBufferOverflow, "ucsdetst/TestBufferOverflow");
+    addTest(root, &TestStreaming, "ucsdetst/TestStreaming");
 #if !UCONFIG_NO_LEGACY_CONVERSION
     addTest(root, &TestIBM424, "ucsdetst/TestIBM424");
     addTest(root, &TestIBM420, "ucsdetst/TestIBM420");
@@ -220,6 +222,76 @@ bail:
     ucsdet_close(csd);
 }
 
+static void TestStreaming(void)
+{
+    UErrorCode status = U_ZERO_ERROR;
+    static const char ss[] = "This is a string with some non-ascii characters that will "
+               "be converted to UTF-8, then fed to the detector a few bytes at a time.  "
+               "\\u0391\\u0392\\u0393\\u0394\\u0395"
+               "Sure would be nice if our source could contain Unicode directly!";
+    static const UChar bomChars[] = { 0xFEFF, 0x0041, 0x0042, 0x0043, 0x0044 };
+    int32_t byteLength = 0, bomLength = 0, sLength = 0, dLength = 0, i;
+    UChar s[sizeof(ss)];
+    char *bytes, *bomBytes;
+    UCharsetDetector *csd = ucsdet_open(&status);
+    const UCharsetMatch *match;
+    UChar detected[sizeof(ss)];
+    UBool complete = FALSE;
+
+    sLength = u_unescape(ss, s, sizeof(ss));
+    bytes = extractBytes(s, sLength, "UTF-8", &byteLength);
+    bomBytes = extractBytes(bomChars, ARRAY_SIZE(bomChars), "UTF-16BE", &bomLength);
+
+    /* Without a threshold, the detector wants to see all of this short text. */
+    for (i = 0; i < byteLength; i += 7) {
+        complete = ucsdet_appendText(csd, bytes + i, byteLength - i < 7 ? byteLength - i : 7, &status);
+        if (complete) {
+            log_err("ucsdet_appendText() reports complete detection after %d of %d bytes\n", i + 7, byteLength);
+            break;
+        }
+    }
+    if (U_FAILURE(status)) {
+        log_err("ucsdet_appendText() failed - %s\n", u_errorName(status));
+        goto bail;
+    }
+
+    match = ucsdet_detect(csd, &status);
+    if (match == NULL) {
+        log_err("Detection failure for streamed UTF-8: got no matches.\n");
+        goto bail;
+    }
+
+    dLength = ucsdet_getUChars(match, detected, sLength, &status);
+    if (u_strCompare(detected, dLength, s, sLength, FALSE) != 0) {
+        log_err("Round-trip test of streamed text failed!\n");
+    }
+
+    /* A byte order mark settles the question as soon as it is seen. */
+    ucsdet_setText(csd, NULL, 0, &status);
+    ucsdet_setConfidenceThreshold(csd, 100);
+    complete = ucsdet_appendText(csd, bomBytes, 4, &status);
+    if (!complete) {
+        log_err("ucsdet_appendText() does not stop at a UTF-16BE byte order mark\n");
+    }
+    /* ignored */
+    ucsdet_appendText(csd, bytes, byteLength, &status);
+
+    match = ucsdet_detect(csd, &status);
+    if (match == NULL || strcmp(ucsdet_getName(match, &status), "UTF-16BE") != 0 ||
+            ucsdet_getConfidence(match, &status) != 100) {
+        log_err("Streamed detection with threshold 100 did not find UTF-16BE with confidence 100\n");
+    }
+
+    if (ucsdet_setConfidenceThreshold(csd, 0) != 100) {
+        log_err("ucsdet_setConfidenceThreshold() did not return the previous threshold\n");
+    }
+
+bail:
+    freeBytes(bomBytes);
+    freeBytes(bytes);
+    ucsdet_close(csd);
+}
+
 static void TestC1Bytes(void)
 {
 #if !UCONFIG_NO_LEGACY_CONVERSION
@@ -1,5 +1,5 @@
 /********************************************************************
- * Copyright (c) 2001-2011 International Business Machines 
+ * Copyright (c) 2001-2013 International Business Machines 
  * Corporation and others. All Rights Reserved.
  ********************************************************************
  * File usrchtst.c
@@ -2717,6 +2717,35 @@ static const PatternAndOffsets scKoStndPatternsOffsets[] = {
     { NULL,     NULL,          0                           }
 };
 
+/* Latin-1 text that can be skipped ahead of a match, except for the "ch" contraction in es@collation=traditional */
+static const UChar scLatinText[] = {
+/*00*/ 0x0078, 0x0079, 0x007A, 0x0020,
+/*04*/ 0x0063, 0x0068, 0x0061, 0x0020,         /* "ch" is one letter in traditional Spanish */
+/*08*/ 0x0063, 0x0061, 0x0020,
+/*11*/ 0x0068, 0x0061,
+       0
+};
+
+static const UChar scLatinPat0[] = { 0x0063, 0 };
+static const UChar scLatinPat1[] = { 0x0068, 0 };
+
+static const int32_t scLatinRootOff0[] = { 4, 8  };
+static const int32_t scLatinRootOff1[] = { 5, 11 };
+static const int32_t scLatinTradOff0[] = { 8     };
+static const int32_t scLatinTradOff1[] = { 11    };
+
+static const PatternAndOffsets scLatinRootPatternsOffsets[] = {
+    { scLatinPat0, scLatinRootOff0, ARRAY_LENGTH(scLatinRootOff0) },
+    { scLatinPat1, scLatinRootOff1, ARRAY_LENGTH(scLatinRootOff1) },
+    { NULL,        NULL,            0                             }
+};
+
+static const PatternAndOffsets scLatinTradPatternsOffsets[] = {
+    { scLatinPat0, scLatinTradOff0, ARRAY_LENGTH(scLatinTradOff0) },
+    { scLatinPat1, scLatinTradOff1, ARRAY_LENGTH(scLatinTradOff1) },
+    { NULL,        NULL,            0                             }
+};
+
 typedef struct {
     const char *  locale;
     const UChar * text;
@@ -2727,6 +2756,8 @@ static const TUSCItem tuscItems[] = {
     { "root",                  scKoText, scKoStndPatternsOffsets },
     { "root@collation=search", scKoText, scKoSrchPatternsOffsets },
     { "ko@collation=search",   scKoText, scKoSrchPatternsOffsets },
+    { "root",                     scLatinText, scLatinRootPatternsOffsets },
+    { "es@collation=traditional", scLatinText, scLatinTradPatternsOffsets },
     { NULL,                    NULL,     NULL                    }
 };
 
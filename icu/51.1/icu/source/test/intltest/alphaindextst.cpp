@@ -61,6 +61,7 @@ void AlphabeticIndexTest::runIndexedTest( int32_t index, UBool exec, const char*
     TESTCASE_AUTO(TestSchSt);
     TESTCASE_AUTO(TestNoLabels);
     TESTCASE_AUTO(TestChineseZhuyin);
+    TESTCASE_AUTO(TestAddRecordAfterBuckets);
     TESTCASE_AUTO_END;
 }
 
@@ -674,4 +675,61 @@ void AlphabeticIndexTest::TestChineseZhuyin() {
     assertEquals("label 5", UnicodeString((UChar)0x3109), immIndex->getBucket(5)->getLabel());
 }
 
+void AlphabeticIndexTest::TestAddRecordAfterBuckets() {
+    UErrorCode status = U_ZERO_ERROR;
+    static const char *names[] = {
+        "Zebra", "apple", "Mango", "Apple", "banana", "\\u00C4pfel", "Ypsilon", "mango", "Banane"
+    };
+    // One index gets half of the records before its buckets are built,
+    // the other all of them at once.
+    AlphabeticIndex index(Locale::getGerman(), status);
+    AlphabeticIndex reference(Locale::getGerman(), status);
+    TEST_CHECK_STATUS;
+    int32_t i;
+    for (i = 0; i < LENGTHOF(names); ++i) {
+        UnicodeString name = UnicodeString(names[i]).unescape();
+        if (i == LENGTHOF(names) / 2) {
+            assertEquals("getBucketCount()", 28, index.getBucketCount(status));
+        }
+        index.addRecord(name, NULL, status);
+        reference.addRecord(name, NULL, status);
+    }
+    TEST_CHECK_STATUS;
+    assertEquals("getRecordCount()", LENGTHOF(names), index.getRecordCount(status));
+    assertEquals("getBucketIndex(Mango)", index.getBucketIndex("Mango", status),
+                 reference.getBucketIndex("Mango", status));
+    while (reference.nextBucket(status)) {
+        TEST_ASSERT(index.nextBucket(status));
+        assertEquals("bucket label", reference.getBucketLabel(), index.getBucketLabel());
+        assertEquals("bucket record count", reference.getBucketRecordCount(),
+                     index.getBucketRecordCount());
+        while (reference.nextRecord(status)) {
+            TEST_ASSERT(index.nextRecord(status));
+            assertEquals("record name", reference.getRecordName(), index.getRecordName());
+        }
+    }
+    TEST_ASSERT(!index.nextBucket(status));
+    TEST_CHECK_STATUS;
+
+    // Adding a record while iterating starts the iteration over.
+    index.addRecord("Quitte", NULL, status);
+    TEST_ASSERT(index.nextBucket(status));
+    assertEquals("first bucket after addRecord()", U_ALPHAINDEX_UNDERFLOW, index.getBucketLabelType());
+    TEST_CHECK_STATUS;
+
+    // Immutable indexes from either index have the same buckets.
+    LocalPointer<AlphabeticIndex::ImmutableIndex> immIndex(index.buildImmutableIndex(status));
+    LocalPointer<AlphabeticIndex::ImmutableIndex> immReference(reference.buildImmutableIndex(status));
+    TEST_CHECK_STATUS;
+    assertEquals("immutable getBucketCount()", immReference->getBucketCount(), immIndex->getBucketCount());
+    for (i = 0; i < LENGTHOF(names); ++i) {
+        UnicodeString name = UnicodeString(names[i]).unescape();
+        int32_t bucketIndex = immIndex->getBucketIndex(name, status);
+        assertEquals("immutable getBucketIndex()", immReference->getBucketIndex(name, status), bucketIndex);
+        assertEquals("immutable getBucketIndex() vs. mutable",
+                     reference.getBucketIndex(name, status), bucketIndex);
+    }
+    TEST_CHECK_STATUS;
+}
+
 #endif
@@ -45,6 +45,11 @@ public:
      * Test with the Bopomofo-phonetic tailoring.
      */
     void TestChineseZhuyin();
+    /**
+     * Records added after the buckets were built, and indexes for the same
+     * locale that share their labels.
+     */
+    void TestAddRecordAfterBuckets();
 };
 
 #endif
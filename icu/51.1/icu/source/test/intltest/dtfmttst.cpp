@@ -18,6 +18,7 @@
 #include "unicode/simpletz.h"
 #include "unicode/strenum.h"
 #include "unicode/dtfmtsym.h"
+#include "unicode/decimfmt.h"
 #include "cmemory.h"
 #include "cstring.h"
 #include "caltest.h"  // for fieldName
@@ -100,6 +101,7 @@ void DateFormatTest::runIndexedTest( int32_t index, UBool exec, const char* &nam
     TESTCASE_AUTO(TestRelativeOther);
     */
     TESTCASE_AUTO(TestDotAndAtLeniency);
+    TESTCASE_AUTO(TestFreeze);
     TESTCASE_AUTO_END;
 }
 
@@ -4176,6 +4178,67 @@ void DateFormatTest::TestDotAndAtLeniency() {
     }
 }
 
+void DateFormatTest::TestFreeze() {
+    const UDate july022008 = 1215000001979.0;
+    UErrorCode status = U_ZERO_ERROR;
+    UnicodeString pattern("yyyy-MM-dd 'at' HH:mm:ss.SSSS ''yy'' h", -1, US_INV);
+    SimpleDateFormat sdf(pattern, Locale::getUS(), status);
+    if (U_FAILURE(status)) {
+        dataerrln("FAIL: Unable to create SimpleDateFormat - %s", u_errorName(status));
+        return;
+    }
+    sdf.adoptTimeZone(TimeZone::createTimeZone("GMT"));
+
+    // A formatter whose NumberFormat can not take the fast path
+    // must give the same results.
+    SimpleDateFormat slow(sdf);
+    DecimalFormat *decfmt = dynamic_cast<DecimalFormat *>(slow.getNumberFormat()->clone());
+    if (decfmt == NULL) {
+        errln("FAIL: the NumberFormat of SimpleDateFormat is not a DecimalFormat");
+        return;
+    }
+    decfmt->setRoundingIncrement(1.0);
+    slow.adoptNumberFormat(decfmt);
+
+    UnicodeString expected("2008-07-02 at 12:00:01.9790 '08' 12", -1, US_INV);
+    UnicodeString result, slowResult;
+    sdf.format(july022008, result);
+    slow.format(july022008, slowResult);
+    if (result != expected || slowResult != expected) {
+        errln(UnicodeString("FAIL: expected ") + expected + ", got " + result + " and " + slowResult);
+    }
+    for (UDate d = -2000000000000.0; d < 4000000000000.0; d += 98765432123.0) {
+        result.remove();
+        slowResult.remove();
+        if (sdf.format(d, result) != slow.format(d, slowResult)) {
+            errln(UnicodeString("FAIL: format(") + d + ") gives " + result + " but " + slowResult);
+        }
+    }
+
+    if (sdf.isFrozen() || sdf.freeze() != &sdf || !sdf.isFrozen()) {
+        errln("FAIL: freeze() did not freeze the formatter");
+    }
+    sdf.applyPattern(UnicodeString("yyyy", -1, US_INV));
+    UnicodeString frozenPattern;
+    if (sdf.toPattern(frozenPattern) != pattern) {
+        errln("FAIL: applyPattern() changed a frozen formatter");
+    }
+    sdf.setContext(UDISPCTX_CAPITALIZATION_FOR_STANDALONE, status);
+    if (status != U_NO_WRITE_PERMISSION) {
+        errln("FAIL: setContext() on a frozen formatter gave %s", u_errorName(status));
+    }
+    result.remove();
+    if (sdf.format(july022008, result) != expected) {
+        errln(UnicodeString("FAIL: frozen formatter gave ") + result);
+    }
+
+    SimpleDateFormat *copy = (SimpleDateFormat *)sdf.clone();
+    if (copy == NULL || copy->isFrozen()) {
+        errln("FAIL: clone of a frozen formatter is frozen");
+    }
+    delete copy;
+}
+
 UBool DateFormatTest::showParse(DateFormat &format, const UnicodeString &formattedString) {
     ParsePosition parsePosition;
     UDate parsed = format.parse(formattedString, parsePosition);
@@ -186,6 +186,8 @@ public: // package
 
     void TestNonGregoFmtParse(void);
 
+    void TestFreeze(void);
+
 public:
     /**
      * Test host-specific formatting.
@@ -133,6 +133,12 @@ void IntlTestSpoof::runIndexedTest( int32_t index, UBool exec, const char* &name
                 testMixedNumbers();
             }
             break;
+       case 10:
+            name = "testSpoofIndex";
+            if (exec) {
+                testSpoofIndex();
+            }
+            break;
 
 
         default: name=""; break;
@@ -754,4 +760,80 @@ void IntlTestSpoof::testMixedNumbers() {
     }
 }
 
+// The confusables found with a USpoofIndex must be exactly the identifiers
+// for which uspoof_areConfusable() returns a non-zero result, with that result.
+void IntlTestSpoof::testSpoofIndex() {
+    static const char *ids[] = {
+        "paypal",
+        "pa\\u0443pal",                      // Cyrillic u
+        "\\u0440\\u0430\\u0443\\u0440\\u0430l",   // Cyrillic except for the l
+        "\\u0440\\u0430\\u0443\\u0440\\u0430\\u04cf", // All Cyrillic
+        "PayPal",
+        "wi11",
+        "will",
+        "abc",
+        "paypal"
+    };
+    static const int32_t checks[] = {
+        USPOOF_ALL_CHECKS,
+        USPOOF_SINGLE_SCRIPT_CONFUSABLE,
+        USPOOF_MIXED_SCRIPT_CONFUSABLE,
+        USPOOF_WHOLE_SCRIPT_CONFUSABLE,
+        USPOOF_MIXED_SCRIPT_CONFUSABLE | USPOOF_ANY_CASE
+    };
+    for (int32_t c = 0; c < LENGTHOF(checks); c++) {
+        TEST_SETUP
+            uspoof_setChecks(sc, checks[c], &status);
+            LocalUSpoofIndexPointer index(uspoof_openIndex(sc, &status));
+            TEST_ASSERT_SUCCESS(status);
+            int32_t i;
+            for (i = 0; i < LENGTHOF(ids); i++) {
+                UnicodeString id = UnicodeString(ids[i], -1, US_INV).unescape();
+                TEST_ASSERT_EQ(i, uspoof_addToIndexUnicodeString(index.getAlias(), id, &status));
+            }
+            TEST_ASSERT_EQ(LENGTHOF(ids), uspoof_getIndexSize(index.getAlias(), &status));
+            TEST_ASSERT_SUCCESS(status);
+
+            for (i = 0; i < LENGTHOF(ids); i++) {
+                UnicodeString id = UnicodeString(ids[i], -1, US_INV).unescape();
+                int32_t found[LENGTHOF(ids)];
+                int32_t results[LENGTHOF(ids)];
+                int32_t count = uspoof_findConfusablesUnicodeString(index.getAlias(), id,
+                                                                    found, results, LENGTHOF(found), &status);
+                TEST_ASSERT_SUCCESS(status);
+                int32_t f = 0;
+                for (int32_t j = 0; j < LENGTHOF(ids); j++) {
+                    UnicodeString other = UnicodeString(ids[j], -1, US_INV).unescape();
+                    int32_t expected = uspoof_areConfusableUnicodeString(sc, id, other, &status);
+                    if (expected != 0) {
+                        if (f >= count || found[f] != j) {
+                            errln("%s:%d checks %x: \"%s\" and \"%s\" not found as confusable",
+                                  __FILE__, __LINE__, checks[c], ids[i], ids[j]);
+                        } else {
+                            TEST_ASSERT_EQ(expected, results[f]);
+                            ++f;
+                        }
+                    }
+                }
+                TEST_ASSERT_EQ(f, count);
+
+                // Preflighting.
+                UErrorCode preflightStatus = U_ZERO_ERROR;
+                TEST_ASSERT_EQ(count, uspoof_findConfusables(index.getAlias(), id.getBuffer(), id.length(),
+                                                             NULL, NULL, 0, &preflightStatus));
+                TEST_ASSERT(count == 0 ? U_SUCCESS(preflightStatus) : preflightStatus == U_BUFFER_OVERFLOW_ERROR);
+            }
+        TEST_TEARDOWN;
+    }
+
+    // An index needs at least one of the confusable checks.
+    TEST_SETUP
+        uspoof_setChecks(sc, USPOOF_INVISIBLE, &status);
+        UErrorCode indexStatus = U_ZERO_ERROR;
+        USpoofIndex *index = uspoof_openIndex(sc, &indexStatus);
+        TEST_ASSERT(index == NULL);
+        TEST_ASSERT(indexStatus == U_INVALID_STATE_ERROR);
+    TEST_TEARDOWN;
+}
+
 #endif /* !UCONFIG_NO_REGULAR_EXPRESSIONS && !UCONFIG_NO_NORMALIZATION && !UCONFIG_NO_FILE_IO */
@@ -38,6 +38,7 @@ void PluralRulesTest::runIndexedTest( int32_t index, UBool exec, const char* &na
     TESTCASE_AUTO(testWithin);
     TESTCASE_AUTO(testGetAllKeywordValues);
     TESTCASE_AUTO(testOrdinal);
+    TESTCASE_AUTO(testForLocaleCache);
     TESTCASE_AUTO_END;
 }
 
@@ -548,4 +549,26 @@ void PluralRulesTest::testOrdinal() {
     }
 }
 
+void PluralRulesTest::testForLocaleCache() {
+    IcuTestErrorCode errorCode(*this, "testForLocaleCache");
+    int32_t hits, misses, hits2, misses2;
+    LocalPointer<PluralRules> cardinal(PluralRules::forLocale("en", UPLURAL_TYPE_CARDINAL, errorCode));
+    PluralRules::getCacheStatistics(hits, misses);
+    // copies of the cached rules, by type
+    LocalPointer<PluralRules> cardinal2(PluralRules::forLocale("en", UPLURAL_TYPE_CARDINAL, errorCode));
+    LocalPointer<PluralRules> ordinal(PluralRules::forLocale("en", UPLURAL_TYPE_ORDINAL, errorCode));
+    LocalPointer<PluralRules> ordinal2(PluralRules::forLocale("en", UPLURAL_TYPE_ORDINAL, errorCode));
+    PluralRules::getCacheStatistics(hits2, misses2);
+    if (errorCode.logIfFailureAndReset("PluralRules::forLocale(en) failed")) {
+        return;
+    }
+    assertTrue("forLocale() again is a cache hit", hits2 >= hits + 2);
+    assertTrue("forLocale() again returns a new object", cardinal.getAlias() != cardinal2.getAlias());
+    assertTrue("cached cardinal rules == original", *cardinal == *cardinal2);
+    assertTrue("cached ordinal rules == original", *ordinal == *ordinal2);
+    if (ordinal2->select(2.) != UNICODE_STRING("two", 3) || cardinal2->select(2.) != UNICODE_STRING("other", 5)) {
+        dataerrln("cached PluralRules(en).select(2) failed");
+    }
+}
+
 #endif /* #if !UCONFIG_NO_FORMATTING */
@@ -29,6 +29,7 @@ private:
     void testWithin();
     void testGetAllKeywordValues();
     void testOrdinal();
+    void testForLocaleCache();
 
     void assertRuleValue(const UnicodeString& rule, double expected);
     void assertRuleKeyValue(const UnicodeString& rule, const UnicodeString& key,
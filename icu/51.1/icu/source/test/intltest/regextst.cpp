@@ -1,6 +1,6 @@
 /********************************************************************
  * COPYRIGHT:
- * Copyright (c) 2002-2012, International Business Machines Corporation and
+ * Copyright (c) 2002-2013, International Business Machines Corporation and
  * others. All Rights Reserved.
  ********************************************************************/
 
@@ -131,6 +131,9 @@ void RegexTest::runIndexedTest( int32_t index, UBool exec, const char* &name, ch
         case 21: name = "Bug 9283";
             if (exec) Bug9283();
             break;
+        case 22: name = "FindPrefilter";
+            if (exec) FindPrefilter();
+            break;
 
         default: name = "";
             break; //needed to end loop
@@ -5216,6 +5219,76 @@ void RegexTest::Bug9283() {
 }
 
 
+//
+//  FindPrefilter   find() may first scan the input with a DFA, for patterns that
+//                  need no backtracking features.  Check that find() gives
+//                  the same matches and capture groups as the backtracking
+//                  engine alone, which is all that runs when there is a find
+//                  progress callback.
+//
+U_CDECL_BEGIN
+static UBool U_CALLCONV
+continueFindFn(const void * /*context*/, int64_t /*matchIndex*/) {
+    return TRUE;
+}
+U_CDECL_END
+
+void RegexTest::FindPrefilter() {
+    static const char *patterns[] = {
+        "abc", "a[bc]+d", "(ab|cd)*e", "x.*y", "(?s)x.*y", "\\d+z", "[^a]b", "(?i)ab",
+        "(a|b)c?d", "ab|b", "\\w+e", "\\s\\S", "\\u00e9x", "(?i)\\u00e9x", "(a|ab)(c|bcd)(d*)",
+        "ab(c|d)+e", "[ab]*c", "\\U0001F600b"
+    };
+    static const char *inputs[] = {
+        "", "abc", "xabcdabcde", "xyzzy x\\n y xay", "12z 1 2zz", "bb ab cb", "AbaB",
+        "abcd abcbcd acd", "\\u00e9x \\u00c9X \\u00e9\\u00e9x", "b\\U0001F600b\\U0001F600",
+        "abcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcd e"
+    };
+
+    for (int32_t p=0; p<(int32_t)(sizeof(patterns)/sizeof(patterns[0])); p++) {
+        UErrorCode status = U_ZERO_ERROR;
+        UnicodeString pattern = UnicodeString(patterns[p], -1, US_INV).unescape();
+        RegexMatcher matcher(pattern, 0, status);
+        RegexMatcher reference(pattern, 0, status);
+        reference.setFindProgressCallback(continueFindFn, NULL, status);
+        REGEX_CHECK_STATUS;
+
+        for (int32_t i=0; i<(int32_t)(sizeof(inputs)/sizeof(inputs[0])); i++) {
+            UnicodeString input = UnicodeString(inputs[i], -1, US_INV).unescape();
+            matcher.reset(input);
+            reference.reset(input);
+            for (;;) {
+                UBool found = matcher.find();
+                REGEX_ASSERT(found == reference.find());
+                REGEX_ASSERT(matcher.hitEnd() == reference.hitEnd());
+                if (!found) {
+                    break;
+                }
+                for (int32_t group=0; group<=matcher.groupCount(); group++) {
+                    REGEX_ASSERT(matcher.start(group, status) == reference.start(group, status));
+                    REGEX_ASSERT(matcher.end(group, status) == reference.end(group, status));
+                }
+                REGEX_CHECK_STATUS;
+            }
+        }
+    }
+
+    // A long input without a match.  Without the prefilter, this takes time
+    //   proportional to the square of the input length.
+    {
+        UErrorCode status = U_ZERO_ERROR;
+        UnicodeString input;
+        for (int32_t i=0; i<100000; i++) {
+            input.append((UChar)(i&1 ? 0x62 : 0x61));
+        }
+        RegexMatcher matcher(UNICODE_STRING_SIMPLE("(ab)*c"), input, 0, status);
+        REGEX_CHECK_STATUS;
+        REGEX_ASSERT(matcher.find() == FALSE);
+        REGEX_ASSERT(matcher.hitEnd());
+    }
+}
+
+
 void RegexTest::CheckInvBufSize() {
   if(inv_next>=INV_BUFSIZ) {
     errln("%s: increase #define of INV_BUFSIZ ( is %d but needs to be at least %d )\n",
@@ -1,6 +1,6 @@
 /********************************************************************
  * COPYRIGHT:
- * Copyright (c) 2002-2012, International Business Machines Corporation and
+ * Copyright (c) 2002-2013, International Business Machines Corporation and
  * others. All Rights Reserved.
  ********************************************************************/
 
@@ -46,6 +46,7 @@ public:
     virtual void Bug8479();
     virtual void Bug7029();
     virtual void Bug9283();
+    virtual void FindPrefilter();
     virtual void CheckInvBufSize();
     
     // The following functions are internal to the regexp tests.
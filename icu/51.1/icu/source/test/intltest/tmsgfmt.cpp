@@ -67,6 +67,8 @@ TestMessageFormat::runIndexedTest(int32_t index, UBool exec,
     TESTCASE_AUTO(testGetFormatNames);
     TESTCASE_AUTO(TestTrimArgumentName);
     TESTCASE_AUTO(TestSelectOrdinal);
+    TESTCASE_AUTO(TestPatternCache);
+    TESTCASE_AUTO(TestFreeze);
     TESTCASE_AUTO_END;
 }
 
@@ -1892,4 +1894,83 @@ void TestMessageFormat::TestSelectOrdinal() {
     errorCode.logDataIfFailureAndReset("");
 }
 
+void TestMessageFormat::TestPatternCache() {
+    IcuTestErrorCode errorCode(*this, "TestPatternCache");
+    UnicodeString pattern("{0,number,#,##0.00} of {1,number,integer}, {2}");
+    Formattable args[3] = { 1234.5, (int32_t)7, "x" };
+    FieldPosition ignore(0);
+    int32_t hits, misses, hits2, misses2;
+
+    MessageFormat::getPatternCacheStatistics(hits, misses);
+    MessageFormat m1(pattern, Locale::getEnglish(), errorCode);
+    if (errorCode.logDataIfFailureAndReset("Unable to instantiate MessageFormat")) {
+        return;
+    }
+    // A second formatter copies the formats of the first one.
+    MessageFormat m2(pattern, Locale::getEnglish(), errorCode);
+    MessageFormat::getPatternCacheStatistics(hits2, misses2);
+    assertTrue("second MessageFormat is a cache hit", hits2 > hits);
+    assertTrue("cached MessageFormat == original", m1 == m2);
+
+    UnicodeString result;
+    assertEquals("format with cached formats", "1,234.50 of 7, x",
+                 m2.format(args, 3, result, ignore, errorCode), TRUE);
+
+    // Changing one formatter does not change those created later.
+    m2.adoptFormat(0, NumberFormat::createPercentInstance(Locale::getEnglish(), errorCode));
+    MessageFormat m3(pattern, Locale::getEnglish(), errorCode);
+    assertEquals("format after setFormat() on another formatter", "1,234.50 of 7, x",
+                 m3.format(args, 3, result.remove(), ignore, errorCode), TRUE);
+
+    // The formats depend on the locale.
+    MessageFormat m4(pattern, Locale::getGerman(), errorCode);
+    assertEquals("format in another locale", "1.234,50 of 7, x",
+                 m4.format(args, 3, result.remove(), ignore, errorCode), TRUE);
+
+    // Errors are not cached.
+    UErrorCode status = U_ZERO_ERROR;
+    MessageFormat bad1(UnicodeString("{0,number"), Locale::getEnglish(), status);
+    if (status != U_UNMATCHED_BRACES) {
+        errln("unmatched braces, got %s", u_errorName(status));
+    }
+    status = U_ZERO_ERROR;
+    MessageFormat bad2(UnicodeString("{0,number"), Locale::getEnglish(), status);
+    if (status != U_UNMATCHED_BRACES) {
+        errln("unmatched braces again, got %s", u_errorName(status));
+    }
+}
+
+void TestMessageFormat::TestFreeze() {
+    IcuTestErrorCode errorCode(*this, "TestFreeze");
+    MessageFormat m(
+        "{0,plural,one{1 file}other{# files}} on {1,date,short}",
+        Locale::getEnglish(), errorCode);
+    if (errorCode.logDataIfFailureAndReset("Unable to instantiate MessageFormat")) {
+        return;
+    }
+    assertFalse("new MessageFormat is frozen", m.isFrozen());
+    assertTrue("freeze() returns this", m.freeze() == &m);
+    assertTrue("MessageFormat is frozen after freeze()", m.isFrozen());
+
+    UnicodeString pattern;
+    m.applyPattern("{0}", errorCode);
+    m.setLocale(Locale::getGerman());
+    m.adoptFormat(0, NumberFormat::createInstance(Locale::getEnglish(), errorCode));
+    m.toPattern(pattern);
+    assertEquals("pattern after setters on a frozen MessageFormat",
+                 "{0,plural,one{1 file}other{# files}} on {1,date,short}", pattern);
+    assertTrue("locale after setLocale() on a frozen MessageFormat",
+               m.getLocale() == Locale::getEnglish());
+
+    Formattable args[2] = { (int32_t)21, Formattable((UDate)0, Formattable::kIsDate) };
+    FieldPosition ignore(0);
+    UnicodeString result;
+    m.format(args, 2, result, ignore, errorCode);
+    assertTrue("frozen format(21)", result.startsWith(UnicodeString("21 files on ")));
+
+    MessageFormat copy(m);
+    assertFalse("copy of a frozen MessageFormat is frozen", copy.isFrozen());
+    errorCode.logDataIfFailureAndReset("");
+}
+
 #endif /* #if !UCONFIG_NO_FORMATTING */
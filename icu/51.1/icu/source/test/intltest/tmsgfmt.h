@@ -117,6 +117,8 @@ public:
     void testGetFormatNames();
     void TestTrimArgumentName();
     void TestSelectOrdinal();
+    void TestPatternCache();
+    void TestFreeze();
 
 private:
     UnicodeString GetPatternAndSkipSyntax(const MessagePattern& pattern);
@@ -0,0 +1,166 @@
+/*
+ *******************************************************************************
+ *
+ *   Copyright (C) 2013, International Business Machines
+ *   Corporation and others.  All Rights Reserved.
+ *
+ *******************************************************************************
+ *   file name:  leperf.cpp
+ *
+ *   Counts the heap allocations and the time per layoutChars() call,
+ *   with the glyph storage allocated from the heap and from an arena.
+ *
+ *   Usage: leperf [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "unicode/utypes.h"
+#include "unicode/uclean.h"
+#include "unicode/uscript.h"
+
+#include "layout/LETypes.h"
+#include "layout/LEScripts.h"
+#include "layout/LayoutEngine.h"
+
+#include "SimpleFontInstance.h"
+
+U_NAMESPACE_USE
+
+static const LEUnicode arabicText[] = {
+    0x0627, 0x0644, 0x0633, 0x0644, 0x0627, 0x0645, 0x0020, 0x0639, 0x0644, 0x064A,
+    0x0643, 0x0645, 0x0020, 0x0648, 0x0631, 0x062D, 0x0645, 0x0629, 0x0020, 0x0627,
+    0x0644, 0x0644, 0x0647, 0x0020, 0x0648, 0x0628, 0x0631, 0x0643, 0x0627, 0x062A,
+    0x0647
+};
+
+static const LEUnicode devanagariText[] = {
+    0x0915, 0x094D, 0x0937, 0x0924, 0x094D, 0x0930, 0x093F, 0x092F, 0x0020, 0x0939,
+    0x093F, 0x0928, 0x094D, 0x0926, 0x0940, 0x0020, 0x092D, 0x093E, 0x0937, 0x093E,
+    0x0020, 0x0915, 0x0940, 0x0020, 0x0926, 0x0947, 0x0935, 0x0928, 0x093E, 0x0917,
+    0x0930, 0x0940
+};
+
+static const LEUnicode latinText[] = {
+    0x0054, 0x0068, 0x0065, 0x0020, 0x0071, 0x0075, 0x0069, 0x0063, 0x006B, 0x0020,
+    0x0062, 0x0072, 0x006F, 0x0077, 0x006E, 0x0020, 0x0066, 0x006F, 0x0078, 0x0020,
+    0x006A, 0x0075, 0x006D, 0x0070, 0x0073, 0x0020, 0x006F, 0x0076, 0x0065, 0x0072
+};
+
+struct PerfText
+{
+    const char      *name;
+    le_int32         script;
+    le_bool          rightToLeft;
+    const LEUnicode *chars;
+    le_int32         charCount;
+};
+
+static const PerfText perfTexts[] = {
+    {"Arabic",     arabScriptCode, TRUE,  arabicText,     LE_ARRAY_SIZE(arabicText)},
+    {"Devanagari", devaScriptCode, FALSE, devanagariText, LE_ARRAY_SIZE(devanagariText)},
+    {"Latin",      latnScriptCode, FALSE, latinText,      LE_ARRAY_SIZE(latinText)}
+};
+
+/*
+ * Laying out the same run over and over would only measure the shaped
+ * run cache, so cycle through more distinct runs than it holds.
+ */
+#define RUN_COUNT 16
+
+static int32_t allocationCount = 0;
+
+U_CDECL_BEGIN
+static void * U_CALLCONV countingAlloc(const void * /*context*/, size_t size)
+{
+    allocationCount += 1;
+    return malloc(size);
+}
+
+static void * U_CALLCONV countingRealloc(const void * /*context*/, void *mem, size_t size)
+{
+    allocationCount += 1;
+    return realloc(mem, size);
+}
+
+static void U_CALLCONV countingFree(const void * /*context*/, void *mem)
+{
+    free(mem);
+}
+U_CDECL_END
+
+static void layoutText(const LEFontInstance *font, const PerfText *text, le_bool useArena, int32_t iterations)
+{
+    LEErrorCode success = LE_NO_ERROR;
+    LayoutEngine *engine = LayoutEngine::layoutEngineFactory(font, text->script, -1, 3 | LE_CHAR_FILTER_FEATURE_FLAG, success);
+
+    engine->setArenaAllocation(useArena, success);
+
+    if (LE_FAILURE(success)) {
+        fprintf(stderr, "%s: could not create a LayoutEngine.\n", text->name);
+        delete engine;
+        return;
+    }
+
+    // Let the first layouts grow the arena before counting.
+    for (le_int32 run = 0; run < RUN_COUNT; run += 1) {
+        engine->layoutChars(text->chars, run, text->charCount - run, text->charCount, text->rightToLeft, 0, 0, success);
+    }
+
+    int32_t startAllocations = allocationCount;
+    clock_t startTime = clock();
+
+    for (int32_t i = 0; i < iterations; i += 1) {
+        le_int32 run = i % RUN_COUNT;
+
+        engine->layoutChars(text->chars, run, text->charCount - run, text->charCount, text->rightToLeft, 0, 0, success);
+    }
+
+    double seconds = (double) (clock() - startTime) / CLOCKS_PER_SEC;
+    int32_t allocations = allocationCount - startAllocations;
+
+    if (LE_FAILURE(success)) {
+        fprintf(stderr, "%s: layoutChars() failed with error %d.\n", text->name, success);
+    } else {
+        printf("%-12s %-6s %8.2f allocations/layout %10.2f us/layout\n", text->name, useArena ? "arena" : "heap",
+            (double) allocations / iterations, seconds * 1000000.0 / iterations);
+    }
+
+    delete engine;
+}
+
+int main(int argc, char *argv[])
+{
+    UErrorCode status = U_ZERO_ERROR;
+    LEErrorCode success = LE_NO_ERROR;
+    int32_t iterations = 10000;
+
+    if (argc > 1) {
+        iterations = atoi(argv[1]);
+
+        if (iterations <= 0) {
+            fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // This must happen before ICU allocates anything.
+    u_setMemoryFunctions(NULL, countingAlloc, countingRealloc, countingFree, &status);
+
+    if (U_FAILURE(status)) {
+        fprintf(stderr, "u_setMemoryFunctions() failed: %s\n", u_errorName(status));
+        return 1;
+    }
+
+    SimpleFontInstance font(12, success);
+
+    for (int32_t t = 0; t < (int32_t) LE_ARRAY_SIZE(perfTexts); t += 1) {
+        layoutText(&font, &perfTexts[t], FALSE, iterations);
+        layoutText(&font, &perfTexts[t], TRUE, iterations);
+    }
+
+    u_cleanup();
+    return 0;
+}
@@ -1,6 +1,6 @@
 /*
 **********************************************************************
-* Copyright (c) 2002-2011,International Business Machines
+* Copyright (c) 2002-2013,International Business Machines
 * Corporation and others.  All Rights Reserved.
 **********************************************************************
 **********************************************************************
@@ -42,6 +42,10 @@ UPerfFunction* DateFormatPerfTest::runIndexedTest(int32_t index, UBool exec,cons
         TESTCASE(8,NumFmt100000);
         TESTCASE(9,Collation10000);
         TESTCASE(10,Collation100000);
+        TESTCASE(11,DateFmtZone10000);
+        TESTCASE(12,DateFmtZone100000);
+        TESTCASE(13,DateFmtEpg10000);
+        TESTCASE(14,DateFmtEpg100000);
 
         default: 
             name = ""; 
@@ -66,6 +70,28 @@ UPerfFunction* DateFormatPerfTest::DateFmt100000(){
     return func;
 }
 
+// The dates are from before the zone's final rule took effect, so each
+// offset lookup goes through the historic transition table.
+UPerfFunction* DateFormatPerfTest::DateFmtZone10000(){
+    DateFmtFunction* func= new DateFmtFunction(40, locale, "America/New_York");
+    return func;
+}
+
+UPerfFunction* DateFormatPerfTest::DateFmtZone100000(){
+    DateFmtFunction* func= new DateFmtFunction(400, locale, "America/New_York");
+    return func;
+}
+
+UPerfFunction* DateFormatPerfTest::DateFmtEpg10000(){
+    EpgFmtFunction* func= new EpgFmtFunction(1, locale, "Europe/Berlin");
+    return func;
+}
+
+UPerfFunction* DateFormatPerfTest::DateFmtEpg100000(){
+    EpgFmtFunction* func= new EpgFmtFunction(10, locale, "Europe/Berlin");
+    return func;
+}
+
 UPerfFunction* DateFormatPerfTest::BreakItWord250(){
     BreakItFunction* func= new BreakItFunction(250, true);
     return func;
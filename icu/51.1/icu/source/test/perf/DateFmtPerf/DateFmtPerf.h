@@ -1,6 +1,6 @@
 /*
 **********************************************************************
-* Copyright (c) 2002-2011,International Business Machines
+* Copyright (c) 2002-2013,International Business Machines
 * Corporation and others.  All Rights Reserved.
 **********************************************************************
 **********************************************************************
@@ -143,6 +143,7 @@ class DateFmtFunction : public UPerfFunction
 private:
 	int num;
     char locale[25];
+    char zoneID[64];
 public:
 	
 	DateFmtFunction()
@@ -150,10 +151,11 @@ public:
 		num = -1;
 	}
 
-	DateFmtFunction(int a, const char* loc)
+	DateFmtFunction(int a, const char* loc, const char* zone = "GMT")
 	{
 		num = a;
         strcpy(locale, loc);
+        strcpy(zoneID, zone);
 	}
 
 	virtual void call(UErrorCode* status)
@@ -167,7 +169,7 @@ public:
 
 		cal = Calendar::createInstance(status2);
 		check(status2, "Calendar::createInstance");
-		zone = TimeZone::createTimeZone("GMT"); // Create a GMT zone
+		zone = TimeZone::createTimeZone(zoneID); // GMT unless a zone with history was asked for
 		cal->adoptTimeZone(zone);
 		
 		Locale loc(locale);
@@ -231,6 +233,62 @@ public:
 
 };
 
+// Formats the start times of a week of EPG events, half an hour apart on
+// each of EPG_CHANNELS channels, day by day as a grid is drawn: the times
+// mostly fall within a few local days.
+#define EPG_CHANNELS 30
+
+class EpgFmtFunction : public UPerfFunction
+{
+
+private:
+	int num;
+    char locale[25];
+    char zoneID[64];
+public:
+
+	EpgFmtFunction()
+	{
+		num = -1;
+	}
+
+	EpgFmtFunction(int a, const char* loc, const char* zone)
+	{
+		num = a;
+        strcpy(locale, loc);
+        strcpy(zoneID, zone);
+	}
+
+	virtual void call(UErrorCode* status)
+	{
+		UnicodeString str;
+		UDate week = 1400457600000.0; // Mon 19 May 2014 00:00 UTC
+
+		Locale loc(locale);
+		DateFormat *fmt;
+		fmt = DateFormat::createDateTimeInstance(
+								DateFormat::kShort, DateFormat::kShort, loc);
+		fmt->adoptTimeZone(TimeZone::createTimeZone(zoneID));
+
+		for(int j = 0; j < num; j++)
+			for(int day = 0; day < 7; day++)
+				for(int ch = 0; ch < EPG_CHANNELS; ch++)
+					for(int slot = 0; slot < 48; slot++)
+					{
+						str.remove();
+						fmt->format(week + (day * 48 + slot) * 1800000.0 + ch * 300000.0, str);
+					}
+
+		delete fmt;
+	}
+
+	virtual long getOperationsPerIteration()
+	{
+		return 7 * EPG_CHANNELS * 48 * num;
+	}
+
+};
+
 class NumFmtFunction : public UPerfFunction
 {
 
@@ -497,6 +555,10 @@ public:
 	UPerfFunction* DateFmt250();
 	UPerfFunction* DateFmt10000();
 	UPerfFunction* DateFmt100000();
+	UPerfFunction* DateFmtZone10000();
+	UPerfFunction* DateFmtZone100000();
+	UPerfFunction* DateFmtEpg10000();
+	UPerfFunction* DateFmtEpg100000();
 	UPerfFunction* BreakItWord250();
 	UPerfFunction* BreakItWord10000();
 	UPerfFunction* BreakItChar250();
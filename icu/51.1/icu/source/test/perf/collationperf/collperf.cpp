@@ -1,6 +1,6 @@
 /********************************************************************
  * COPYRIGHT:
- * Copyright (C) 2001-2012 IBM, Inc.   All Rights Reserved.
+ * Copyright (C) 2001-2013 IBM, Inc.   All Rights Reserved.
  *
  ********************************************************************/
 /********************************************************************************
@@ -50,6 +50,8 @@ const char gUsageString[] =
     "-keyhist                   Produce a table sort key size vs. string length\n"
     "-binsearch                 Binary Search timing test\n"
     "-keygen                    Sort Key Generation timing test\n"
+    "-batchkeys                 Batch Sort Key Generation and sort timing test (ICU only)\n"
+    "-maxkeylen n               Truncate batch sort keys to n bytes.  Default 0, no truncation\n"
     "-qsort                     Quicksort timing test\n"
     "-iter                      Iteration Performance Test\n"
     "-dump                      Display strings, sort keys and CEs.\n"
@@ -121,6 +123,8 @@ UBool  opt_strcmp     = FALSE;
 UBool  opt_strcmpCPO  = FALSE;
 UBool  opt_norm       = FALSE;
 UBool  opt_keygen     = FALSE;
+UBool  opt_batchkeys  = FALSE;
+int    opt_maxKeyLen  = 0;
 UBool  opt_french     = FALSE;
 UBool  opt_frenchoff  = FALSE;
 UBool  opt_shifted    = FALSE;
@@ -167,6 +171,8 @@ OptSpec opts[] = {
     {"-level",       OptSpec::NUM,    &opt_level},
     {"-keyhist",     OptSpec::FLAG,   &opt_keyhist},
     {"-keygen",      OptSpec::FLAG,   &opt_keygen},
+    {"-batchkeys",   OptSpec::FLAG,   &opt_batchkeys},
+    {"-maxkeylen",   OptSpec::NUM,    &opt_maxKeyLen},
     {"-loop",        OptSpec::NUM,    &opt_loopCount},
     {"-iloop",       OptSpec::NUM,    &opt_iLoopCount},
     {"-terse",       OptSpec::FLAG,   &opt_terse},
@@ -454,6 +460,79 @@ void doKeyGen()
 
 
 
+//---------------------------------------------------------------------------------------
+//
+//   doBatchKeys()     Batch Sort Key Generation and Sort Timing Test.
+//                     Generates the keys for all of the lines, in random order,
+//                     with one ucol_getSortKeys() call into one buffer, then sorts
+//                     them with ucol_sortBySortKeys().
+//
+//---------------------------------------------------------------------------------------
+void doBatchKeys()
+{
+    int  loops = 0;
+    int  line;
+    UErrorCode status = U_ZERO_ERROR;
+
+    const UChar **sources    = new const UChar *[gNumFileLines];
+    int32_t      *lengths    = new int32_t[gNumFileLines];
+    int32_t      *keyIndexes = new int32_t[gNumFileLines+1];
+    int32_t      *order      = new int32_t[gNumFileLines];
+    for (line=0; line < gNumFileLines; line++) {
+        sources[line] = gRandomLines[line]->name;
+        lengths[line] = gRandomLines[line]->len;
+    }
+
+    int32_t keysLength = ucol_getSortKeys(gCol, sources, opt_uselen ? lengths : NULL, gNumFileLines,
+                                          opt_maxKeyLen, NULL, 0, keyIndexes, &status);
+    if (status == U_BUFFER_OVERFLOW_ERROR) {
+        status = U_ZERO_ERROR;
+    }
+    uint8_t *keys = new uint8_t[keysLength];
+
+    // Adjust loop count to compensate for file size.   Should be order n
+    double dLoopCount = double(opt_loopCount) * (1000. /  double(gNumFileLines));
+    int adj_loopCount = int(dLoopCount);
+    if (adj_loopCount < 1) adj_loopCount = 1;
+
+    unsigned long startTime = timeGetTime();
+    for (loops=0; loops<adj_loopCount && U_SUCCESS(status); loops++) {
+        ucol_getSortKeys(gCol, sources, opt_uselen ? lengths : NULL, gNumFileLines,
+                         opt_maxKeyLen, keys, keysLength, keyIndexes, &status);
+    }
+    unsigned long keyTime = timeGetTime() - startTime;
+
+    startTime = timeGetTime();
+    for (loops=0; loops<adj_loopCount && U_SUCCESS(status); loops++) {
+        ucol_sortBySortKeys(keys, keyIndexes, gNumFileLines, order, &status);
+    }
+    unsigned long sortTime = timeGetTime() - startTime;
+
+    if (U_FAILURE(status)) {
+        fprintf(stderr, "Batch sort key test failed: %s\n", u_errorName(status));
+    } else {
+        int keyNs  = (int)(float(1000000) * (float)keyTime / (float)(adj_loopCount*gNumFileLines));
+        int sortNs = (int)(float(1000000) * (float)sortTime / (float)(adj_loopCount*gNumFileLines));
+        if (opt_terse == FALSE) {
+            printf("Batch Sort Key Generation:  total # of keys = %d\n", loops*gNumFileLines);
+            printf("Batch Sort Key Generation:  time per key = %d ns\n", keyNs);
+            printf("Batch Sort Key Generation:  key bytes per line = %f\n", (float)keysLength / (float)gNumFileLines);
+            printf("Sort by keys:  time per line = %d ns\n", sortNs);
+        }
+        else {
+            printf("%d, %f, %d, ", keyNs, (float)keysLength / (float)gNumFileLines, sortNs);
+        }
+    }
+
+    delete [] keys;
+    delete [] order;
+    delete [] keyIndexes;
+    delete [] lengths;
+    delete [] sources;
+}
+
+
+
 //---------------------------------------------------------------------------------------
 //
 //    doBinarySearch()    Binary Search timing test.  Each name from the list
@@ -1753,6 +1832,7 @@ int main(int argc, const char** argv) {
     if (opt_qsort)     doQSort();
     if (opt_binsearch) doBinarySearch();
     if (opt_keygen)    doKeyGen();
+    if (opt_batchkeys && opt_icu) doBatchKeys();
     if (opt_keyhist)   doKeyHist();
     if (opt_itertest)  doIterTest();
 
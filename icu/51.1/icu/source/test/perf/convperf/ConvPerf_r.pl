@@ -60,6 +60,17 @@ my $tests = {
          ####
 	     "ISO2022JP From Unicode",      ["$p1 TestICU_ISO2022JP_FromUnicode", "$p2 TestICU_ISO2022JP_FromUnicode" ],
 	     "ISO2022JP To Unicode",        ["$p1 TestICU_ISO2022JP_ToUnicode"  ,  "$p2 TestICU_ISO2022JP_ToUnicode" ],
+         ####
+	     "GBK mixed From Unicode",      ["$p1 TestICU_GBK_Mixed_FromUnicode",  "$p2 TestICU_GBK_Mixed_FromUnicode" ],
+	     "GBK mixed To Unicode",        ["$p1 TestICU_GBK_Mixed_ToUnicode"  ,  "$p2 TestICU_GBK_Mixed_ToUnicode" ],
+	     "Big5 mixed From Unicode",     ["$p1 TestICU_Big5_Mixed_FromUnicode", "$p2 TestICU_Big5_Mixed_FromUnicode" ],
+	     "Big5 mixed To Unicode",       ["$p1 TestICU_Big5_Mixed_ToUnicode"  , "$p2 TestICU_Big5_Mixed_ToUnicode" ],
+	     "EUC-KR mixed From Unicode",   ["$p1 TestICU_EUCKR_Mixed_FromUnicode","$p2 TestICU_EUCKR_Mixed_FromUnicode" ],
+	     "EUC-KR mixed To Unicode",     ["$p1 TestICU_EUCKR_Mixed_ToUnicode"  ,"$p2 TestICU_EUCKR_Mixed_ToUnicode" ],
+         ####
+	     "DVB From Unicode",            ["$p1 TestICU_DVB_FromUnicode"  ,     "$p2 TestICU_DVB_FromUnicode" ],
+	     "DVB To Unicode",              ["$p1 TestICU_DVB_ToUnicode"    ,     "$p2 TestICU_DVB_ToUnicode" ],
+	     "DVB To Unicode via UTF-8",    ["$p1 TestICU_DVB_TwoStep_ToUnicode", "$p2 TestICU_DVB_TwoStep_ToUnicode" ],
 	    };
 	    
 
@@ -111,6 +111,17 @@ UPerfFunction* ConverterPerformanceTest::runIndexedTest(int32_t index, UBool exe
         TESTCASE(52,TestWinANSI_ISO2022JP_ToUnicode);
         TESTCASE(53,TestWinANSI_ISO2022JP_FromUnicode);
 
+        TESTCASE(54,TestICU_GBK_Mixed_ToUnicode);
+        TESTCASE(55,TestICU_GBK_Mixed_FromUnicode);
+        TESTCASE(56,TestICU_Big5_Mixed_ToUnicode);
+        TESTCASE(57,TestICU_Big5_Mixed_FromUnicode);
+        TESTCASE(58,TestICU_EUCKR_Mixed_ToUnicode);
+        TESTCASE(59,TestICU_EUCKR_Mixed_FromUnicode);
+
+        TESTCASE(60,TestICU_DVB_ToUnicode);
+        TESTCASE(61,TestICU_DVB_TwoStep_ToUnicode);
+        TESTCASE(62,TestICU_DVB_FromUnicode);
+
         default: 
             name = ""; 
             return NULL;
@@ -651,4 +662,85 @@ UPerfFunction*  ConverterPerformanceTest::TestWinANSI_ISO2022JP_ToUnicode(){
         return NULL;
     }
     return pf;
-}
\ No newline at end of file
+}
+
+UPerfFunction* ConverterPerformanceTest::TestICU_GBK_Mixed_FromUnicode(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUFromUnicodePerfFunction("gbk",gbk_mixedUniSource, LENGTHOF(gbk_mixedUniSource), status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction*  ConverterPerformanceTest::TestICU_GBK_Mixed_ToUnicode(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUToUnicodePerfFunction("gbk",(char*)gbk_mixedEncSource, LENGTHOF(gbk_mixedEncSource), status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction* ConverterPerformanceTest::TestICU_Big5_Mixed_FromUnicode(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUFromUnicodePerfFunction("big5",big5_mixedUniSource, LENGTHOF(big5_mixedUniSource), status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction*  ConverterPerformanceTest::TestICU_Big5_Mixed_ToUnicode(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUToUnicodePerfFunction("big5",(char*)big5_mixedEncSource, LENGTHOF(big5_mixedEncSource), status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction* ConverterPerformanceTest::TestICU_EUCKR_Mixed_FromUnicode(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUFromUnicodePerfFunction("euc-kr",euckr_mixedUniSource, LENGTHOF(euckr_mixedUniSource), status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction*  ConverterPerformanceTest::TestICU_EUCKR_Mixed_ToUnicode(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUToUnicodePerfFunction("euc-kr",(char*)euckr_mixedEncSource, LENGTHOF(euckr_mixedEncSource), status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction* ConverterPerformanceTest::TestICU_DVB_FromUnicode(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUFromUnicodePerfFunction("dvb",dvb_uniSource, LENGTHOF(dvb_uniSource), status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction*  ConverterPerformanceTest::TestICU_DVB_ToUnicode(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUToUnicodePerfFunction("dvb",(char*)dvb_encSource, LENGTHOF(dvb_encSource), status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction*  ConverterPerformanceTest::TestICU_DVB_TwoStep_ToUnicode(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new DVBTwoStepToUnicodePerfFunction((char*)dvb_encSource, LENGTHOF(dvb_encSource), status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
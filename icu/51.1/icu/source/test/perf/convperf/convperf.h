@@ -486,6 +486,59 @@ public:
     }
 };
 
+/*
+ * Converts DVB text the way of code that decodes it to UTF-8 and then
+ * calls u_strFromUTF8(), to compare with the direct conversion.
+ */
+class DVBTwoStepToUnicodePerfFunction : public UPerfFunction{
+private:
+    UConverter* conv;
+    const char* src;
+    int32_t srcLen;
+    char* utf8;
+    int32_t utf8Capacity;
+    UChar* target;
+    int32_t targetCapacity;
+
+public:
+    DVBTwoStepToUnicodePerfFunction(const char* source, int32_t sourceLen, UErrorCode& status){
+        conv = ucnv_open("dvb",&status);
+        src = source;
+        srcLen = sourceLen;
+        utf8 = NULL;
+        target = NULL;
+        if(U_FAILURE(status)){
+            conv = NULL;
+            return;
+        }
+        utf8Capacity = ucnv_toAlgorithmic(UCNV_UTF8, conv, NULL, 0, source, srcLen, &status);
+        if(status==U_BUFFER_OVERFLOW_ERROR) {
+            status=U_ZERO_ERROR;
+        }
+        if(U_FAILURE(status)){
+            return;
+        }
+        targetCapacity = utf8Capacity;
+        utf8=(char*)malloc(utf8Capacity+1);
+        target=(UChar*)malloc((targetCapacity+1) * U_SIZEOF_UCHAR);
+        if(utf8 == NULL || target == NULL){
+            status = U_MEMORY_ALLOCATION_ERROR;
+        }
+    }
+    virtual void call(UErrorCode* status){
+        int32_t utf8Length = ucnv_toAlgorithmic(UCNV_UTF8, conv, utf8, utf8Capacity+1, src, srcLen, status);
+        u_strFromUTF8(target, targetCapacity+1, NULL, utf8, utf8Length, status);
+    }
+    virtual long getOperationsPerIteration(void){
+        return srcLen;
+    }
+    ~DVBTwoStepToUnicodePerfFunction(){
+        free(utf8);
+        free(target);
+        ucnv_close(conv);
+    }
+};
+
 class  ConverterPerformanceTest : public UPerfTest{
 
 public:
@@ -562,6 +615,19 @@ public:
     UPerfFunction* TestWinIML2_ISO2022JP_ToUnicode();
     UPerfFunction* TestWinIML2_ISO2022JP_FromUnicode(); 
 
+    // mostly ASCII with CJK islands
+    UPerfFunction* TestICU_GBK_Mixed_ToUnicode();
+    UPerfFunction* TestICU_GBK_Mixed_FromUnicode();
+    UPerfFunction* TestICU_Big5_Mixed_ToUnicode();
+    UPerfFunction* TestICU_Big5_Mixed_FromUnicode();
+    UPerfFunction* TestICU_EUCKR_Mixed_ToUnicode();
+    UPerfFunction* TestICU_EUCKR_Mixed_FromUnicode();
+
+    // DVB text, directly and through UTF-8
+    UPerfFunction* TestICU_DVB_ToUnicode();
+    UPerfFunction* TestICU_DVB_TwoStep_ToUnicode();
+    UPerfFunction* TestICU_DVB_FromUnicode();
+
 };
 
 #endif
@@ -1,6 +1,6 @@
 /*
 **********************************************************************
-* Copyright (c) 2002-2003,International Business Machines
+* Copyright (c) 2002-2013,International Business Machines
 * Corporation and others.  All Rights Reserved.
 **********************************************************************
 **********************************************************************
@@ -2727,5 +2727,196 @@ unsigned char utf8_encSmSource[]={
     0xE3,0x80,0x80,0xE3,0x80,0x81,0xE3,0x80,0x82,0x20,0xEF,0xBC,0x8E,0xE3,0x83,0xBB,
     0xEF,0xBC,0x9A,0xEF,0xBC,0x9B,0x0D,0x0A
 };
+/* mostly ASCII with CJK islands, like DVB EPG event descriptions */
+WCHAR gbk_mixedUniSource[]={
+    0x0032,0x0030,0x003A,0x0030,0x0030,0x0020,0x0043,0x0043,0x0054,0x0056,
+    0x002D,0x0031,0x0020,0x004E,0x0065,0x0077,0x0073,0x0020,0x007C,0x0020,
+    0x0058,0x0069,0x006E,0x0077,0x0065,0x006E,0x0020,0x004C,0x0069,0x0061,
+    0x006E,0x0062,0x006F,0x0020,0x65B0,0x95FB,0x8054,0x64AD,0x0020,0x0028,
+    0x0048,0x0044,0x0029,0x0020,0x0052,0x0061,0x0074,0x0069,0x006E,0x0067,
+    0x003A,0x0020,0x0050,0x0047,0x002E,0x0020,0x004E,0x0065,0x0078,0x0074,
+    0x003A,0x0020,0x0032,0x0031,0x003A,0x0030,0x0030,0x0020,0x0057,0x0065,
+    0x0061,0x0074,0x0068,0x0065,0x0072,0x0020,0x0046,0x006F,0x0072,0x0065,
+    0x0063,0x0061,0x0073,0x0074,0x0020,0x5929,0x6C14,0x9884,0x62A5,0x002C,
+    0x0020,0x0074,0x0068,0x0065,0x006E,0x0020,0x004D,0x006F,0x0076,0x0069,
+    0x0065,0x003A,0x0020,0x0022,0x0054,0x0068,0x0065,0x0020,0x0057,0x0061,
+    0x006E,0x0064,0x0065,0x0072,0x0069,0x006E,0x0067,0x0020,0x0045,0x0061,
+    0x0072,0x0074,0x0068,0x0022,0x0020,0x6D41,0x6D6A,0x5730,0x7403,0x0020,
+    0x0028,0x0032,0x0030,0x0031,0x0039,0x002C,0x0020,0x0031,0x0032,0x0035,
+    0x0020,0x006D,0x0069,0x006E,0x0029,0x002E,0x0020,0x0047,0x0065,0x006E,
+    0x0072,0x0065,0x003A,0x0020,0x0053,0x0063,0x0069,0x002D,0x0046,0x0069,
+    0x002F,0x0044,0x0072,0x0061,0x006D,0x0061,0x002E,0x0020,0x0044,0x0069,
+    0x0072,0x0065,0x0063,0x0074,0x006F,0x0072,0x003A,0x0020,0x0046,0x0072,
+    0x0061,0x006E,0x0074,0x0020,0x0047,0x0077,0x006F,0x002E,0x0020,0x0041,
+    0x0075,0x0064,0x0069,0x006F,0x003A,0x0020,0x004D,0x0061,0x006E,0x0064,
+    0x0061,0x0072,0x0069,0x006E,0x002C,0x0020,0x0044,0x006F,0x006C,0x0062,
+    0x0079,0x0020,0x0044,0x0069,0x0067,0x0069,0x0074,0x0061,0x006C,0x0020,
+    0x0035,0x002E,0x0031,0x003B,0x0020,0x0053,0x0075,0x0062,0x0074,0x0069,
+    0x0074,0x006C,0x0065,0x0073,0x003A,0x0020,0x007A,0x0068,0x002C,0x0020,
+    0x0065,0x006E,0x002E,0x0020,
+};
+unsigned char gbk_mixedEncSource[]={
+    0x32,0x30,0x3A,0x30,0x30,0x20,0x43,0x43,0x54,0x56,0x2D,0x31,0x20,0x4E,0x65,0x77,
+    0x73,0x20,0x7C,0x20,0x58,0x69,0x6E,0x77,0x65,0x6E,0x20,0x4C,0x69,0x61,0x6E,0x62,
+    0x6F,0x20,0xD0,0xC2,0xCE,0xC5,0xC1,0xAA,0xB2,0xA5,0x20,0x28,0x48,0x44,0x29,0x20,
+    0x52,0x61,0x74,0x69,0x6E,0x67,0x3A,0x20,0x50,0x47,0x2E,0x20,0x4E,0x65,0x78,0x74,
+    0x3A,0x20,0x32,0x31,0x3A,0x30,0x30,0x20,0x57,0x65,0x61,0x74,0x68,0x65,0x72,0x20,
+    0x46,0x6F,0x72,0x65,0x63,0x61,0x73,0x74,0x20,0xCC,0xEC,0xC6,0xF8,0xD4,0xA4,0xB1,
+    0xA8,0x2C,0x20,0x74,0x68,0x65,0x6E,0x20,0x4D,0x6F,0x76,0x69,0x65,0x3A,0x20,0x22,
+    0x54,0x68,0x65,0x20,0x57,0x61,0x6E,0x64,0x65,0x72,0x69,0x6E,0x67,0x20,0x45,0x61,
+    0x72,0x74,0x68,0x22,0x20,0xC1,0xF7,0xC0,0xCB,0xB5,0xD8,0xC7,0xF2,0x20,0x28,0x32,
+    0x30,0x31,0x39,0x2C,0x20,0x31,0x32,0x35,0x20,0x6D,0x69,0x6E,0x29,0x2E,0x20,0x47,
+    0x65,0x6E,0x72,0x65,0x3A,0x20,0x53,0x63,0x69,0x2D,0x46,0x69,0x2F,0x44,0x72,0x61,
+    0x6D,0x61,0x2E,0x20,0x44,0x69,0x72,0x65,0x63,0x74,0x6F,0x72,0x3A,0x20,0x46,0x72,
+    0x61,0x6E,0x74,0x20,0x47,0x77,0x6F,0x2E,0x20,0x41,0x75,0x64,0x69,0x6F,0x3A,0x20,
+    0x4D,0x61,0x6E,0x64,0x61,0x72,0x69,0x6E,0x2C,0x20,0x44,0x6F,0x6C,0x62,0x79,0x20,
+    0x44,0x69,0x67,0x69,0x74,0x61,0x6C,0x20,0x35,0x2E,0x31,0x3B,0x20,0x53,0x75,0x62,
+    0x74,0x69,0x74,0x6C,0x65,0x73,0x3A,0x20,0x7A,0x68,0x2C,0x20,0x65,0x6E,0x2E,0x20,
+};
+
+/* mostly ASCII with CJK islands, like DVB EPG event descriptions */
+WCHAR big5_mixedUniSource[]={
+    0x0032,0x0030,0x003A,0x0030,0x0030,0x0020,0x0054,0x0056,0x0042,0x0053,
+    0x0020,0x004E,0x0065,0x0077,0x0073,0x0020,0x007C,0x0020,0x0045,0x0076,
+    0x0065,0x006E,0x0069,0x006E,0x0067,0x0020,0x0052,0x0065,0x0070,0x006F,
+    0x0072,0x0074,0x0020,0x665A,0x9593,0x65B0,0x805E,0x0020,0x0028,0x0048,
+    0x0044,0x0029,0x0020,0x0052,0x0061,0x0074,0x0069,0x006E,0x0067,0x003A,
+    0x0020,0x0050,0x0047,0x002E,0x0020,0x004E,0x0065,0x0078,0x0074,0x003A,
+    0x0020,0x0032,0x0031,0x003A,0x0030,0x0030,0x0020,0x0057,0x0065,0x0061,
+    0x0074,0x0068,0x0065,0x0072,0x0020,0x0046,0x006F,0x0072,0x0065,0x0063,
+    0x0061,0x0073,0x0074,0x0020,0x5929,0x6C23,0x9810,0x5831,0x002C,0x0020,
+    0x0074,0x0068,0x0065,0x006E,0x0020,0x004D,0x006F,0x0076,0x0069,0x0065,
+    0x003A,0x0020,0x0022,0x0041,0x0020,0x0043,0x0069,0x0074,0x0079,0x0020,
+    0x006F,0x0066,0x0020,0x0053,0x0061,0x0064,0x006E,0x0065,0x0073,0x0073,
+    0x0022,0x0020,0x60B2,0x60C5,0x57CE,0x5E02,0x0020,0x0028,0x0031,0x0039,
+    0x0038,0x0039,0x002C,0x0020,0x0031,0x0035,0x0037,0x0020,0x006D,0x0069,
+    0x006E,0x0029,0x002E,0x0020,0x0047,0x0065,0x006E,0x0072,0x0065,0x003A,
+    0x0020,0x0044,0x0072,0x0061,0x006D,0x0061,0x002F,0x0048,0x0069,0x0073,
+    0x0074,0x006F,0x0072,0x0079,0x002E,0x0020,0x0044,0x0069,0x0072,0x0065,
+    0x0063,0x0074,0x006F,0x0072,0x003A,0x0020,0x0048,0x006F,0x0075,0x0020,
+    0x0048,0x0073,0x0069,0x0061,0x006F,0x002D,0x0068,0x0073,0x0069,0x0065,
+    0x006E,0x002E,0x0020,0x0041,0x0075,0x0064,0x0069,0x006F,0x003A,0x0020,
+    0x004D,0x0061,0x006E,0x0064,0x0061,0x0072,0x0069,0x006E,0x002C,0x0020,
+    0x0053,0x0074,0x0065,0x0072,0x0065,0x006F,0x003B,0x0020,0x0053,0x0075,
+    0x0062,0x0074,0x0069,0x0074,0x006C,0x0065,0x0073,0x003A,0x0020,0x007A,
+    0x0068,0x002C,0x0020,0x0065,0x006E,0x002E,0x0020,
+};
+unsigned char big5_mixedEncSource[]={
+    0x32,0x30,0x3A,0x30,0x30,0x20,0x54,0x56,0x42,0x53,0x20,0x4E,0x65,0x77,0x73,0x20,
+    0x7C,0x20,0x45,0x76,0x65,0x6E,0x69,0x6E,0x67,0x20,0x52,0x65,0x70,0x6F,0x72,0x74,
+    0x20,0xB1,0xDF,0xB6,0xA1,0xB7,0x73,0xBB,0x44,0x20,0x28,0x48,0x44,0x29,0x20,0x52,
+    0x61,0x74,0x69,0x6E,0x67,0x3A,0x20,0x50,0x47,0x2E,0x20,0x4E,0x65,0x78,0x74,0x3A,
+    0x20,0x32,0x31,0x3A,0x30,0x30,0x20,0x57,0x65,0x61,0x74,0x68,0x65,0x72,0x20,0x46,
+    0x6F,0x72,0x65,0x63,0x61,0x73,0x74,0x20,0xA4,0xD1,0xAE,0xF0,0xB9,0x77,0xB3,0xF8,
+    0x2C,0x20,0x74,0x68,0x65,0x6E,0x20,0x4D,0x6F,0x76,0x69,0x65,0x3A,0x20,0x22,0x41,
+    0x20,0x43,0x69,0x74,0x79,0x20,0x6F,0x66,0x20,0x53,0x61,0x64,0x6E,0x65,0x73,0x73,
+    0x22,0x20,0xB4,0x64,0xB1,0xA1,0xAB,0xB0,0xA5,0xAB,0x20,0x28,0x31,0x39,0x38,0x39,
+    0x2C,0x20,0x31,0x35,0x37,0x20,0x6D,0x69,0x6E,0x29,0x2E,0x20,0x47,0x65,0x6E,0x72,
+    0x65,0x3A,0x20,0x44,0x72,0x61,0x6D,0x61,0x2F,0x48,0x69,0x73,0x74,0x6F,0x72,0x79,
+    0x2E,0x20,0x44,0x69,0x72,0x65,0x63,0x74,0x6F,0x72,0x3A,0x20,0x48,0x6F,0x75,0x20,
+    0x48,0x73,0x69,0x61,0x6F,0x2D,0x68,0x73,0x69,0x65,0x6E,0x2E,0x20,0x41,0x75,0x64,
+    0x69,0x6F,0x3A,0x20,0x4D,0x61,0x6E,0x64,0x61,0x72,0x69,0x6E,0x2C,0x20,0x53,0x74,
+    0x65,0x72,0x65,0x6F,0x3B,0x20,0x53,0x75,0x62,0x74,0x69,0x74,0x6C,0x65,0x73,0x3A,
+    0x20,0x7A,0x68,0x2C,0x20,0x65,0x6E,0x2E,0x20,
+};
+
+/* mostly ASCII with CJK islands, like DVB EPG event descriptions */
+WCHAR euckr_mixedUniSource[]={
+    0x0032,0x0030,0x003A,0x0030,0x0030,0x0020,0x004B,0x0042,0x0053,0x0031,
+    0x0020,0x004E,0x0065,0x0077,0x0073,0x0020,0x0039,0x0020,0x007C,0x0020,
+    0xB274,0xC2A4,0x0020,0x0039,0x0020,0x0028,0x0048,0x0044,0x0029,0x0020,
+    0x0052,0x0061,0x0074,0x0069,0x006E,0x0067,0x003A,0x0020,0x0031,0x0032,
+    0x002B,0x002E,0x0020,0x004E,0x0065,0x0078,0x0074,0x003A,0x0020,0x0032,
+    0x0031,0x003A,0x0030,0x0030,0x0020,0x0057,0x0065,0x0061,0x0074,0x0068,
+    0x0065,0x0072,0x0020,0x0046,0x006F,0x0072,0x0065,0x0063,0x0061,0x0073,
+    0x0074,0x0020,0xB0A0,0xC528,0x002C,0x0020,0x0074,0x0068,0x0065,0x006E,
+    0x0020,0x004D,0x006F,0x0076,0x0069,0x0065,0x003A,0x0020,0x0022,0x0050,
+    0x0061,0x0072,0x0061,0x0073,0x0069,0x0074,0x0065,0x0022,0x0020,0xAE30,
+    0xC0DD,0xCDA9,0x0020,0x0028,0x0032,0x0030,0x0031,0x0039,0x002C,0x0020,
+    0x0031,0x0033,0x0032,0x0020,0x006D,0x0069,0x006E,0x0029,0x002E,0x0020,
+    0x0047,0x0065,0x006E,0x0072,0x0065,0x003A,0x0020,0x0044,0x0072,0x0061,
+    0x006D,0x0061,0x002F,0x0054,0x0068,0x0072,0x0069,0x006C,0x006C,0x0065,
+    0x0072,0x002E,0x0020,0x0044,0x0069,0x0072,0x0065,0x0063,0x0074,0x006F,
+    0x0072,0x003A,0x0020,0x0042,0x006F,0x006E,0x0067,0x0020,0x004A,0x006F,
+    0x006F,0x006E,0x002D,0x0068,0x006F,0x002E,0x0020,0x0041,0x0075,0x0064,
+    0x0069,0x006F,0x003A,0x0020,0x004B,0x006F,0x0072,0x0065,0x0061,0x006E,
+    0x002C,0x0020,0x0044,0x006F,0x006C,0x0062,0x0079,0x0020,0x0044,0x0069,
+    0x0067,0x0069,0x0074,0x0061,0x006C,0x0020,0x0035,0x002E,0x0031,0x003B,
+    0x0020,0x0053,0x0075,0x0062,0x0074,0x0069,0x0074,0x006C,0x0065,0x0073,
+    0x003A,0x0020,0x006B,0x006F,0x002C,0x0020,0x0065,0x006E,0x002E,0x0020,
+};
+unsigned char euckr_mixedEncSource[]={
+    0x32,0x30,0x3A,0x30,0x30,0x20,0x4B,0x42,0x53,0x31,0x20,0x4E,0x65,0x77,0x73,0x20,
+    0x39,0x20,0x7C,0x20,0xB4,0xBA,0xBD,0xBA,0x20,0x39,0x20,0x28,0x48,0x44,0x29,0x20,
+    0x52,0x61,0x74,0x69,0x6E,0x67,0x3A,0x20,0x31,0x32,0x2B,0x2E,0x20,0x4E,0x65,0x78,
+    0x74,0x3A,0x20,0x32,0x31,0x3A,0x30,0x30,0x20,0x57,0x65,0x61,0x74,0x68,0x65,0x72,
+    0x20,0x46,0x6F,0x72,0x65,0x63,0x61,0x73,0x74,0x20,0xB3,0xAF,0xBE,0xBE,0x2C,0x20,
+    0x74,0x68,0x65,0x6E,0x20,0x4D,0x6F,0x76,0x69,0x65,0x3A,0x20,0x22,0x50,0x61,0x72,
+    0x61,0x73,0x69,0x74,0x65,0x22,0x20,0xB1,0xE2,0xBB,0xFD,0xC3,0xE6,0x20,0x28,0x32,
+    0x30,0x31,0x39,0x2C,0x20,0x31,0x33,0x32,0x20,0x6D,0x69,0x6E,0x29,0x2E,0x20,0x47,
+    0x65,0x6E,0x72,0x65,0x3A,0x20,0x44,0x72,0x61,0x6D,0x61,0x2F,0x54,0x68,0x72,0x69,
+    0x6C,0x6C,0x65,0x72,0x2E,0x20,0x44,0x69,0x72,0x65,0x63,0x74,0x6F,0x72,0x3A,0x20,
+    0x42,0x6F,0x6E,0x67,0x20,0x4A,0x6F,0x6F,0x6E,0x2D,0x68,0x6F,0x2E,0x20,0x41,0x75,
+    0x64,0x69,0x6F,0x3A,0x20,0x4B,0x6F,0x72,0x65,0x61,0x6E,0x2C,0x20,0x44,0x6F,0x6C,
+    0x62,0x79,0x20,0x44,0x69,0x67,0x69,0x74,0x61,0x6C,0x20,0x35,0x2E,0x31,0x3B,0x20,
+    0x53,0x75,0x62,0x74,0x69,0x74,0x6C,0x65,0x73,0x3A,0x20,0x6B,0x6F,0x2C,0x20,0x65,
+    0x6E,0x2E,0x20,
+};
+
+/* ISO 6937 (DVB table 00) with diacritics, like DVB EPG event descriptions */
+WCHAR dvb_uniSource[]={
+    0x0032,0x0030,0x003A,0x0031,0x0035,0x0020,0x0054,0x0061,0x0074,0x006F,
+    0x0072,0x0074,0x003A,0x0020,0x0053,0x0070,0x00E4,0x0074,0x0073,0x0063,
+    0x0068,0x0069,0x0063,0x0068,0x0074,0x0020,0x007C,0x0020,0x004B,0x0072,
+    0x0069,0x006D,0x0069,0x002C,0x0020,0x0044,0x0065,0x0075,0x0074,0x0073,
+    0x0063,0x0068,0x006C,0x0061,0x006E,0x0064,0x0020,0x0032,0x0030,0x0031,
+    0x0033,0x002E,0x0020,0x004B,0x006F,0x006D,0x006D,0x0069,0x0073,0x0073,
+    0x0061,0x0072,0x0069,0x006E,0x0020,0x004C,0x00FC,0x0072,0x0073,0x0065,
+    0x006E,0x0020,0x0065,0x0072,0x006D,0x0069,0x0074,0x0074,0x0065,0x006C,
+    0x0074,0x0020,0x0069,0x006E,0x0020,0x0042,0x0072,0x0065,0x006D,0x0065,
+    0x006E,0x002E,0x0020,0x0032,0x0031,0x003A,0x0034,0x0035,0x0020,0x0054,
+    0x0061,0x0067,0x0065,0x0073,0x0074,0x0068,0x0065,0x006D,0x0065,0x006E,
+    0x0020,0x006D,0x0069,0x0074,0x0020,0x0057,0x0065,0x0074,0x0074,0x0065,
+    0x0072,0x000A,0x0032,0x0032,0x003A,0x0031,0x0035,0x0020,0x004C,0x0065,
+    0x0020,0x004A,0x006F,0x0075,0x0072,0x006E,0x0061,0x006C,0x0020,0x0064,
+    0x0065,0x0020,0x0032,0x0033,0x0020,0x0068,0x0020,0x002D,0x0020,0x004D,
+    0x00E9,0x0074,0x00E9,0x006F,0x002E,0x0020,0x00C9,0x0074,0x00E9,0x0020,
+    0x0063,0x006F,0x006D,0x006D,0x0065,0x0020,0x0068,0x0069,0x0076,0x0065,
+    0x0072,0x002C,0x0020,0x006C,0x0065,0x0073,0x0020,0x00E9,0x006C,0x00E8,
+    0x0076,0x0065,0x0073,0x0020,0x0066,0x0072,0x0061,0x006E,0x00E7,0x0061,
+    0x0069,0x0073,0x0020,0x0064,0x00E9,0x0063,0x006F,0x0075,0x0076,0x0072,
+    0x0065,0x006E,0x0074,0x0020,0x006C,0x0061,0x0020,0x0066,0x006F,0x0072,
+    0x00EA,0x0074,0x002E,0x0020,0x0052,0x00E9,0x0061,0x006C,0x0069,0x0073,
+    0x00E9,0x0020,0x0070,0x0061,0x0072,0x0020,0x0046,0x0072,0x0061,0x006E,
+    0x00E7,0x006F,0x0069,0x0073,0x0020,0x004D,0x00FC,0x006C,0x006C,0x0065,
+    0x0072,0x002E,0x0020,0x0053,0x006F,0x0075,0x0073,0x002D,0x0074,0x0069,
+    0x0074,0x0072,0x0065,0x0073,0x003A,0x0020,0x0066,0x0072,0x002C,0x0020,
+    0x0064,0x0065,0x002E,0x0020,0x0044,0x0075,0x0072,0x00E9,0x0065,0x003A,
+    0x0020,0x0031,0x0020,0x0068,0x0020,0x0033,0x0030,0x002E,0x0020,0x00DC,
+    0x0062,0x0065,0x0072,0x0020,0x00D6,0x006C,0x0020,0x0026,0x0020,0x0053,
+    0x0074,0x0072,0x0061,0x00DF,0x0065,0x006E,0x002E,
+};
+unsigned char dvb_encSource[]={
+    0x32,0x30,0x3A,0x31,0x35,0x20,0x54,0x61,0x74,0x6F,0x72,0x74,0x3A,0x20,0x53,0x70,
+    0xC8,0x61,0x74,0x73,0x63,0x68,0x69,0x63,0x68,0x74,0x20,0x7C,0x20,0x4B,0x72,0x69,
+    0x6D,0x69,0x2C,0x20,0x44,0x65,0x75,0x74,0x73,0x63,0x68,0x6C,0x61,0x6E,0x64,0x20,
+    0x32,0x30,0x31,0x33,0x2E,0x20,0x4B,0x6F,0x6D,0x6D,0x69,0x73,0x73,0x61,0x72,0x69,
+    0x6E,0x20,0x4C,0xC8,0x75,0x72,0x73,0x65,0x6E,0x20,0x65,0x72,0x6D,0x69,0x74,0x74,
+    0x65,0x6C,0x74,0x20,0x69,0x6E,0x20,0x42,0x72,0x65,0x6D,0x65,0x6E,0x2E,0x20,0x32,
+    0x31,0x3A,0x34,0x35,0x20,0x54,0x61,0x67,0x65,0x73,0x74,0x68,0x65,0x6D,0x65,0x6E,
+    0x20,0x6D,0x69,0x74,0x20,0x57,0x65,0x74,0x74,0x65,0x72,0x8A,0x32,0x32,0x3A,0x31,
+    0x35,0x20,0x4C,0x65,0x20,0x4A,0x6F,0x75,0x72,0x6E,0x61,0x6C,0x20,0x64,0x65,0x20,
+    0x32,0x33,0x20,0x68,0x20,0x2D,0x20,0x4D,0xC2,0x65,0x74,0xC2,0x65,0x6F,0x2E,0x20,
+    0xC2,0x45,0x74,0xC2,0x65,0x20,0x63,0x6F,0x6D,0x6D,0x65,0x20,0x68,0x69,0x76,0x65,
+    0x72,0x2C,0x20,0x6C,0x65,0x73,0x20,0xC2,0x65,0x6C,0xC1,0x65,0x76,0x65,0x73,0x20,
+    0x66,0x72,0x61,0x6E,0xCB,0x63,0x61,0x69,0x73,0x20,0x64,0xC2,0x65,0x63,0x6F,0x75,
+    0x76,0x72,0x65,0x6E,0x74,0x20,0x6C,0x61,0x20,0x66,0x6F,0x72,0xC3,0x65,0x74,0x2E,
+    0x20,0x52,0xC2,0x65,0x61,0x6C,0x69,0x73,0xC2,0x65,0x20,0x70,0x61,0x72,0x20,0x46,
+    0x72,0x61,0x6E,0xCB,0x63,0x6F,0x69,0x73,0x20,0x4D,0xC8,0x75,0x6C,0x6C,0x65,0x72,
+    0x2E,0x20,0x53,0x6F,0x75,0x73,0x2D,0x74,0x69,0x74,0x72,0x65,0x73,0x3A,0x20,0x66,
+    0x72,0x2C,0x20,0x64,0x65,0x2E,0x20,0x44,0x75,0x72,0xC2,0x65,0x65,0x3A,0x20,0x31,
+    0x20,0x68,0x20,0x33,0x30,0x2E,0x20,0xC8,0x55,0x62,0x65,0x72,0x20,0xC8,0x4F,0x6C,
+    0x20,0x26,0x20,0x53,0x74,0x72,0x61,0xFB,0x65,0x6E,0x2E,
+};
 #endif
 
@@ -1,6 +1,6 @@
 /*  
  **********************************************************************
- *   Copyright (C) 2010-2012, International Business Machines
+ *   Copyright (C) 2010-2013, International Business Machines
  *   Corporation and others.  All Rights Reserved.
  **********************************************************************
  *  file name:  dicttrieperf.cpp
@@ -20,6 +20,10 @@
  *  ./dicttrieperf --sourcedir <ICU build tree>/data/out/tmp --passes 3 --iterations 1000
  * or
  *  ./dicttrieperf -f <ICU source tree>/source/data/brkitr/thaidict.txt --passes 3 --iterations 250
+ * The dictfileread and dictfilemap tests also need the compiled thaidict.dict
+ * (gendict output) in the --sourcedir, for example
+ *  ./dicttrieperf -f <ICU source tree>/source/data/brkitr/thaidict.txt \
+ *                 --sourcedir <ICU build tree>/data/out/build/icudt51l/brkitr --passes 3 --iterations 1000
  */
 
 #include <stdio.h>
@@ -32,12 +36,21 @@
 #include "unicode/uperf.h"
 #include "unicode/utext.h"
 #include "charstr.h"
+#include "dictionarydata.h"
 #include "package.h"
+#include "putilimp.h"
 #include "toolutil.h"
 #include "ucbuf.h"  // struct ULine
 #include "uoptions.h"
 #include "uvectr32.h"
 
+#if U_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #define LENGTHOF(array) (int32_t)(sizeof(array)/sizeof((array)[0]))
 
 // Test object.
@@ -639,6 +652,118 @@ public:
     }
 };
 
+// Performance test function object.
+// Opens the compiled thaidict.dict from the -s or --sourcedir path
+// and looks up the first dictionary word, as a new process does
+// the first time it segments Thai text.
+class DictFileOpen : public UPerfFunction {
+protected:
+    DictFileOpen(const DictionaryTriePerfTest &perfTest) : perf(perfTest), firstLine(-1) {
+        IcuToolErrorCode errorCode("DictFileOpen()");
+        filename.append(perf.getSourceDir(), errorCode);
+        int32_t filenameLength=filename.length();
+        if(filenameLength>0 && filename[filenameLength-1]!=U_FILE_SEP_CHAR &&
+                               filename[filenameLength-1]!=U_FILE_ALT_SEP_CHAR) {
+            filename.append(U_FILE_SEP_CHAR, errorCode);
+        }
+        filename.append("thaidict.dict", errorCode);
+        const ULine *lines=perf.getCachedLines();
+        int32_t numLines=perf.getNumLines();
+        for(int32_t i=0; i<numLines; ++i) {
+            // Skip comment lines (start with a character below 'A').
+            if(lines[i].name[0]>=0x41) {
+                firstLine=i;
+                break;
+            }
+        }
+    }
+
+public:
+    virtual ~DictFileOpen() {}
+
+    virtual long getOperationsPerIteration() {
+        return 1;
+    }
+
+protected:
+    // Look up the first word in the dictionary file contents.
+    void lookUp(const uint8_t *p) {
+        if(firstLine<0) {
+            return;
+        }
+        p+=*(const uint16_t *)p;  // skip the data header
+        const int32_t *indexes=(const int32_t *)p;
+        BytesTrie trie(p+indexes[DictionaryData::IX_STRING_TRIE_OFFSET]);
+        const ULine &line=perf.getCachedLines()[firstLine];
+        UStringTrieResult result=trie.first(thaiCharToByte(line.name[0]));
+        for(int32_t j=1; j<line.len && USTRINGTRIE_HAS_NEXT(result); ++j) {
+            result=trie.next(thaiCharToByte(line.name[j]));
+        }
+        if(!USTRINGTRIE_HAS_VALUE(result)) {
+            fprintf(stderr, "word %ld (0-based) not found in %s\n", (long)firstLine, filename.data());
+        }
+    }
+
+    // What each process pays for a dictionary on the heap:
+    // read the whole file, then look up.
+    void readAndLookUp() {
+        FILE *f=fopen(filename.data(), "rb");
+        if(f==NULL) {
+            return;
+        }
+        fseek(f, 0, SEEK_END);
+        long length=ftell(f);
+        fseek(f, 0, SEEK_SET);
+        uint8_t *bytes=(uint8_t *)malloc(length);
+        if(bytes!=NULL && fread(bytes, 1, length, f)==(size_t)length) {
+            lookUp(bytes);
+        }
+        free(bytes);
+        fclose(f);
+    }
+
+    const DictionaryTriePerfTest &perf;
+    CharString filename;
+    int32_t firstLine;
+};
+
+class DictFileRead : public DictFileOpen {
+public:
+    DictFileRead(const DictionaryTriePerfTest &perfTest) : DictFileOpen(perfTest) {}
+
+    virtual void call(UErrorCode * /*pErrorCode*/) {
+        readAndLookUp();
+    }
+};
+
+// With a read-only, shared mapping (as with ICU_DICTIONARY_DIR),
+// only the pages visited by the lookup are touched, and they are
+// shared with every other process that maps the same file.
+class DictFileMap : public DictFileOpen {
+public:
+    DictFileMap(const DictionaryTriePerfTest &perfTest) : DictFileOpen(perfTest) {}
+
+    virtual void call(UErrorCode * /*pErrorCode*/) {
+#if U_HAVE_MMAP
+        int fd=open(filename.data(), O_RDONLY);
+        if(fd<0) {
+            return;
+        }
+        struct stat st;
+        if(fstat(fd, &st)==0 && st.st_size>0) {
+            void *data=mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if(data!=MAP_FAILED) {
+                lookUp((const uint8_t *)data);
+                munmap(data, st.st_size);
+            }
+        }
+        close(fd);
+#else
+        readAndLookUp();
+#endif
+    }
+};
+
 UPerfFunction *DictionaryTriePerfTest::runIndexedTest(int32_t index, UBool exec,
                                                       const char *&name, char * /*par*/) {
     if(hasFile()) {
@@ -667,6 +792,18 @@ UPerfFunction *DictionaryTriePerfTest::runIndexedTest(int32_t index, UBool exec,
                 return new BytesTrieDictContains(*this);
             }
             break;
+        case 4:
+            name="dictfileread";
+            if(exec) {
+                return new DictFileRead(*this);
+            }
+            break;
+        case 5:
+            name="dictfilemap";
+            if(exec) {
+                return new DictFileMap(*this);
+            }
+            break;
         default:
             name="";
             break;
@@ -1,6 +1,6 @@
 /*
  **********************************************************************
- * Copyright (c) 2011-2012,International Business Machines
+ * Copyright (c) 2011-2013,International Business Machines
  * Corporation and others.  All Rights Reserved.
  **********************************************************************
  */
@@ -754,6 +754,15 @@ void runTests() {
     DO_NumFmtInt64Test("#","123",123);
     DO_NumFmtInt64Test("#","-2",-2);
     DO_NumFmtInt64Test("+#","+2",2);
+
+    // Grouping and fraction digits take the fixed point fastpath; the
+    // same output with a rounding increment goes through DigitList.
+    DO_NumFmtTest("#,##0.00","1,234,567.89",1234567.891);
+    DO_NumFmtTest("#,##0.01","1,234,567.89",1234567.891);
+    DO_NumFmtTest("#,##0.###","-0.125",-0.125);
+    DO_NumFmtTest("#,##0.001","-0.125",-0.125);
+    DO_NumFmtInt64Test("#,##0","1,234,567",1234567);
+    DO_NumFmtInt64Test("#,##1","1,234,567",1234567);
   }
 
 #ifndef SKIP_NUM_OPEN_TEST
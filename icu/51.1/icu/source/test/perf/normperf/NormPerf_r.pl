@@ -79,7 +79,12 @@ my $tests = {
 	     "IsNormalized_NFC_Orig_Text", ["$p1 TestIsNormalized_NFC_Orig_Text" ,  "$p2 TestIsNormalized_NFC_Orig_Text"],
 	     "IsNormalized_NFD_NFD_Text",  ["$p1 TestIsNormalized_NFD_NFD_Text"  ,  "$p2 TestIsNormalized_NFD_NFD_Text" ],
 	     "IsNormalized_NFD_NFC_Text",  ["$p1 TestIsNormalized_NFD_NFC_Text"  ,  "$p2 TestIsNormalized_NFD_NFC_Text" ],
-	     "IsNormalized_NFD_Orig_Text", ["$p1 TestIsNormalized_NFD_Orig_Text" ,  "$p2 TestIsNormalized_NFD_Orig_Text"]
+	     "IsNormalized_NFD_Orig_Text", ["$p1 TestIsNormalized_NFD_Orig_Text" ,  "$p2 TestIsNormalized_NFD_Orig_Text"],
+	     ##
+	     "Norm2_NFC_NFC_Text",  ["$p1 TestNorm2_NFC_NFC_Text"  ,  "$p2 TestNorm2_NFC_NFC_Text" ],
+	     "Norm2_NFC_Orig_Text", ["$p1 TestNorm2_NFC_Orig_Text" ,  "$p2 TestNorm2_NFC_Orig_Text"],
+	     "Norm2_NFD_NFD_Text",  ["$p1 TestNorm2_NFD_NFD_Text"  ,  "$p2 TestNorm2_NFD_NFD_Text" ],
+	     "Norm2_NFD_Orig_Text", ["$p1 TestNorm2_NFD_Orig_Text" ,  "$p2 TestNorm2_NFD_Orig_Text"]
 	    };
 
 
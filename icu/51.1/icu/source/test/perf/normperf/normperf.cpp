@@ -63,6 +63,11 @@ UPerfFunction* NormalizerPerformanceTest::runIndexedTest(int32_t index, UBool ex
         TESTCASE(31,TestIsNormalized_FCD_NFC_Text);
         TESTCASE(32,TestIsNormalized_FCD_Orig_Text);
 
+        TESTCASE(33,TestNorm2_NFC_NFC_Text);
+        TESTCASE(34,TestNorm2_NFC_Orig_Text);
+        TESTCASE(35,TestNorm2_NFD_NFD_Text);
+        TESTCASE(36,TestNorm2_NFD_Orig_Text);
+
         default: 
             name = ""; 
             return NULL;
@@ -491,6 +496,44 @@ UPerfFunction* NormalizerPerformanceTest::TestIsNormalized_FCD_Orig_Text(){
     }
 }
 
+// Test Normalizer2 Performance
+UPerfFunction* NormalizerPerformanceTest::TestNorm2_NFC_NFC_Text(){
+    if(line_mode){
+        NormPerfFunction* func = new NormPerfFunction(ICUNorm2NFC, options,NFCFileLines,numLines, uselen);
+        return func;
+    }else{
+        NormPerfFunction* func = new NormPerfFunction(ICUNorm2NFC, options,NFCBuffer,NFCBufferLen, uselen);
+        return func;
+    }
+}
+UPerfFunction* NormalizerPerformanceTest::TestNorm2_NFC_Orig_Text(){
+    if(line_mode){
+        NormPerfFunction* func = new NormPerfFunction(ICUNorm2NFC, options,lines,numLines, uselen);
+        return func;
+    }else{
+        NormPerfFunction* func = new NormPerfFunction(ICUNorm2NFC, options,buffer,bufferLen, uselen);
+        return func;
+    }
+}
+UPerfFunction* NormalizerPerformanceTest::TestNorm2_NFD_NFD_Text(){
+    if(line_mode){
+        NormPerfFunction* func = new NormPerfFunction(ICUNorm2NFD, options,NFDFileLines,numLines, uselen);
+        return func;
+    }else{
+        NormPerfFunction* func = new NormPerfFunction(ICUNorm2NFD, options,NFDBuffer,NFDBufferLen, uselen);
+        return func;
+    }
+}
+UPerfFunction* NormalizerPerformanceTest::TestNorm2_NFD_Orig_Text(){
+    if(line_mode){
+        NormPerfFunction* func = new NormPerfFunction(ICUNorm2NFD, options,lines,numLines, uselen);
+        return func;
+    }else{
+        NormPerfFunction* func = new NormPerfFunction(ICUNorm2NFD, options,buffer,bufferLen, uselen);
+        return func;
+    }
+}
+
 int main(int argc, const char* argv[]){
     UErrorCode status = U_ZERO_ERROR;
     NormalizerPerformanceTest test(argc, argv, status);
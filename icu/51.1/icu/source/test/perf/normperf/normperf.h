@@ -8,6 +8,7 @@
 #ifndef _NORMPERF_H
 #define _NORMPERF_H
 
+#include "unicode/normalizer2.h"
 #include "unicode/unorm.h"
 #include "unicode/ustring.h"
 
@@ -245,6 +246,12 @@ public:
     UPerfFunction* TestIsNormalized_FCD_NFC_Text();
     UPerfFunction* TestIsNormalized_FCD_Orig_Text();
 
+    /* Normalizer2 API performance */
+    UPerfFunction* TestNorm2_NFC_NFC_Text();
+    UPerfFunction* TestNorm2_NFC_Orig_Text();
+    UPerfFunction* TestNorm2_NFD_NFD_Text();
+    UPerfFunction* TestNorm2_NFD_Orig_Text();
+
 };
 
 //---------------------------------------------------------------------------------------
@@ -284,6 +291,19 @@ int32_t ICUIsNormalized(const UChar* src,int32_t srcLen, UNormalizationMode mode
     return unorm_isNormalized(src,srcLen,mode,status);
 }
 
+// Normalizer2 UnicodeString API, which returns early when nothing needs to be looked up
+int32_t ICUNorm2NFD(const UChar* src, int32_t srcLen,UChar* dest, int32_t dstLen, int32_t options, UErrorCode* status) {
+    UnicodeString destString;
+    Normalizer2::getNFDInstance(*status)->normalize(UnicodeString(srcLen<0, src, srcLen), destString, *status);
+    return destString.extract(dest, dstLen, *status);
+}
+
+int32_t ICUNorm2NFC(const UChar* src, int32_t srcLen,UChar* dest, int32_t dstLen, int32_t options, UErrorCode* status) {
+    UnicodeString destString;
+    Normalizer2::getNFCInstance(*status)->normalize(UnicodeString(srcLen<0, src, srcLen), destString, *status);
+    return destString.extract(dest, dstLen, *status);
+}
+
 
 #else
 
@@ -313,6 +333,14 @@ int32_t ICUQuickCheck(const UChar* src,int32_t srcLen, UNormalizationMode mode,
 int32_t ICUIsNormalized(const UChar* src,int32_t srcLen, UNormalizationMode mode, int32_t options, UErrorCode* status){
     return 0;
 }
+
+int32_t ICUNorm2NFD(const UChar* src, int32_t srcLen,UChar* dest, int32_t dstLen, int32_t options, UErrorCode* status) {
+    return 0;
+}
+
+int32_t ICUNorm2NFC(const UChar* src, int32_t srcLen,UChar* dest, int32_t dstLen, int32_t options, UErrorCode* status) {
+    return 0;
+}
 #endif
 
 #if U_PLATFORM_HAS_WIN32_API
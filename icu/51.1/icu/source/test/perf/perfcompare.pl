@@ -0,0 +1,80 @@
+#!/usr/bin/perl
+#  ********************************************************************
+#  * COPYRIGHT:
+#  * Copyright (c) 2013, International Business Machines
+#  * Corporation and others. All Rights Reserved.
+#  ********************************************************************
+#
+# Compares two files of performance results written with the --json option
+# of the UPerfTest based tests (see perfrunner.sh), one JSON object per line.
+#
+# Usage: perfcompare.pl [--threshold percent] baseline.json results.json
+#
+# Prints the time per operation and the peak memory use of every test in
+# both files.  With --threshold, exits with 1 if any test got slower by
+# more than that many percent.
+
+use strict;
+use JSON::PP;
+use File::Basename;
+use Getopt::Long;
+
+my $threshold;
+GetOptions("threshold=f" => \$threshold) && @ARGV == 2
+    or die "Usage: $0 [--threshold percent] baseline.json results.json\n";
+
+sub readResults {
+    my ($fileName) = @_;
+    my %results;
+    my @keys;
+    open(my $f, "<", $fileName) or die "Can not open $fileName: $!\n";
+    while (my $line = <$f>) {
+        next if $line =~ /^\s*$/;
+        my $r = decode_json($line);
+        my $key = join(" ", grep { defined && $_ ne "" }
+                       $r->{program}, $r->{test}, $r->{label}, $r->{locale},
+                       defined($r->{file}) ? basename($r->{file}) : undef);
+        push(@keys, $key) unless exists $results{$key};
+        # Keep the fastest of repeated runs.
+        if (!exists $results{$key} || $r->{ns_per_op} < $results{$key}->{ns_per_op}) {
+            $results{$key} = $r;
+        }
+    }
+    close($f);
+    return (\%results, \@keys);
+}
+
+my ($base) = readResults($ARGV[0]);
+my ($new, $keys) = readResults($ARGV[1]);
+
+my $regressions = 0;
+printf("%-60s %12s %12s %8s %10s %10s\n",
+       "test", "base ns/op", "new ns/op", "change", "base KB", "new KB");
+foreach my $key (@$keys) {
+    my $n = $new->{$key};
+    my $b = $base->{$key};
+    if (!defined $b) {
+        printf("%-60s %12s %12.4g %8s %10s %10d\n",
+               $key, "-", $n->{ns_per_op}, "new", "-", $n->{max_rss_kb});
+        next;
+    }
+    my $change = $b->{ns_per_op} > 0 ?
+        100.0 * ($n->{ns_per_op} - $b->{ns_per_op}) / $b->{ns_per_op} : 0;
+    my $mark = "";
+    if (defined $threshold && $change > $threshold) {
+        $mark = " *";
+        $regressions++;
+    }
+    printf("%-60s %12.4g %12.4g %+7.1f%% %10d %10d%s\n",
+           $key, $b->{ns_per_op}, $n->{ns_per_op}, $change,
+           $b->{max_rss_kb}, $n->{max_rss_kb}, $mark);
+}
+foreach my $key (sort keys %$base) {
+    printf("%-60s missing from %s\n", $key, $ARGV[1]) unless exists $new->{$key};
+}
+
+if ($regressions > 0) {
+    print "$regressions test(s) slower by more than $threshold%\n";
+    exit 1;
+}
+exit 0;
@@ -0,0 +1,94 @@
+#!/bin/sh
+# Copyright (C) 2013, International Business Machines Corporation and others.
+# All Rights Reserved.
+#
+# Runs a standard set of the UPerfTest based performance tests on every
+# text file in a corpus directory and appends the results to one file,
+# one JSON object per test and line (see the --json option in
+# tools/ctestfw/uperf.cpp).  Compare two such files with perfcompare.pl.
+#
+# Usage: perfrunner.sh [-b perfdir] [-p passes] [-t seconds] [-o results.json] corpusdir
+#
+#   corpusdir  directory with UTF-8 text files, e.g. one per language;
+#              the file name is recorded with each result
+#   perfdir    built test/perf directory (default: the directory of this script)
+#
+# Every test runs in its own process so that max_rss_kb is per test.
+#
+# The script only needs a POSIX shell, so it can run on the target of a
+# cross build: configure with --host=<triple> --with-cross-build=<native build>,
+# run make and then make -C test/perf, copy test/perf, lib and the data to
+# the target and set LD_LIBRARY_PATH and ICU_DATA there.
+
+PERFDIR=`dirname $0`
+PASSES=3
+TIME=2
+OUT=perfresults.json
+
+while getopts b:p:t:o: opt; do
+  case $opt in
+  b) PERFDIR=$OPTARG ;;
+  p) PASSES=$OPTARG ;;
+  t) TIME=$OPTARG ;;
+  o) OUT=$OPTARG ;;
+  *) echo "Usage: $0 [-b perfdir] [-p passes] [-t seconds] [-o results.json] corpusdir" >&2; exit 1 ;;
+  esac
+done
+shift `expr $OPTIND - 1`
+if [ $# -ne 1 ]; then
+  echo "Usage: $0 [-b perfdir] [-p passes] [-t seconds] [-o results.json] corpusdir" >&2
+  exit 1
+fi
+CORPUS=$1
+
+# program|options|tests
+# The options follow the common UPerfTest options; programs that parse
+# their own options after UPerfTest need them after a "--".
+# The options without dashes are the --json-label, to tell apart runs of
+# the same test.  (An option argument must not begin with a dash.)
+SUITE='
+normperf/normperf|-l|TestICU_NFC_Orig_Text TestICU_NFD_Orig_Text TestICU_FCD_Orig_Text TestQC_NFC_Orig_Text TestIsNormalized_NFC_Orig_Text TestNorm2_NFC_Orig_Text TestNorm2_NFD_Orig_Text
+utfperf/utfperf|--charset UTF-8|Roundtrip FromUnicode FromUTF8 StrFromUTF8 StrToUTF8
+utrie2perf/utrie2perf||CheckFCD ToNFC GetBiDiClass
+ubrkperf/ubrkperf|-- -m char|TestICUForward TestICUIsBound
+ubrkperf/ubrkperf|-- -m word|TestICUForward TestICUIsBound
+ubrkperf/ubrkperf|-- -m line|TestICUForward
+ustrperf/stringperf|-l|TestCtor TestAssign TestGetch TestCatenate TestScan TestToLower TestToUpper TestFoldCase TestTemporaries TestArenaTemporaries
+unisetperf/unisetperf|--pattern [:L:]|Contains SpanUTF16 SpanUTF8
+'
+
+FAILED=0
+OLDIFS=$IFS
+IFS='
+'
+for entry in $SUITE; do
+  IFS='|'
+  set -- $entry
+  IFS=$OLDIFS
+  PROG=$PERFDIR/$1
+  PROGOPTS=$2
+  TESTS=$3
+  LABEL=`echo " $PROGOPTS" | sed -e 's/ --*/ /g' -e 's/  */ /g' -e 's/^ //' -e 's/ $//'`
+  if [ ! -x "$PROG" ]; then
+    echo "perfrunner: $PROG not built, skipped" >&2
+    continue
+  fi
+  for file in "$CORPUS"/*.txt; do
+    for test in $TESTS; do
+      echo "perfrunner: $1 $PROGOPTS $test `basename $file`"
+      # $PROGOPTS is split into words on purpose, but not globbed.
+      set -f
+      if ! "$PROG" -f "$file" -e UTF-8 -p $PASSES -t $TIME \
+             --json "$OUT" --json-label "$LABEL" $PROGOPTS $test > /dev/null; then
+        echo "perfrunner: $1 $test failed on $file" >&2
+        FAILED=1
+      fi
+      set +f
+    done
+  done
+  IFS='
+'
+done
+IFS=$OLDIFS
+
+exit $FAILED
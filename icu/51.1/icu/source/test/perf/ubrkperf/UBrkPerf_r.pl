@@ -79,6 +79,16 @@ my $tests = {
 "TestIsBoundLine",      ["$p1 $m3 TestICUIsBound", "$p2 $m3 TestICUIsBound"],
 "TestIsBoundSentence",  ["$p1 $m4 TestICUIsBound", "$p2 $m4 TestICUIsBound"],
 
+"TestBackwardChar",     ["$p1 $m1 TestICUBackward", "$p2 $m1 TestICUBackward"],
+"TestBackwardWord",     ["$p1 $m2 TestICUBackward", "$p2 $m2 TestICUBackward"],
+"TestBackwardLine",     ["$p1 $m3 TestICUBackward", "$p2 $m3 TestICUBackward"],
+"TestBackwardSentence", ["$p1 $m4 TestICUBackward", "$p2 $m4 TestICUBackward"],
+
+"TestScrollChar",       ["$p1 $m1 TestICUScroll", "$p2 $m1 TestICUScroll"],
+"TestScrollWord",       ["$p1 $m2 TestICUScroll", "$p2 $m2 TestICUScroll"],
+"TestScrollLine",       ["$p1 $m3 TestICUScroll", "$p2 $m3 TestICUScroll"],
+"TestScrollSentence",   ["$p1 $m4 TestICUScroll", "$p2 $m4 TestICUScroll"],
+
 };
 
 runTests($options, $tests, $dataFiles);
@@ -154,6 +154,16 @@ UPerfFunction* BreakIteratorPerformanceTest::TestICUIsBound()
   return new ICUIsBound(locale, m_mode_, m_file_, m_fileLen_);
 }
 
+UPerfFunction* BreakIteratorPerformanceTest::TestICUBackward()
+{
+  return new ICUBackward(locale, m_mode_, m_file_, m_fileLen_);
+}
+
+UPerfFunction* BreakIteratorPerformanceTest::TestICUScroll()
+{
+  return new ICUScroll(locale, m_mode_, m_file_, m_fileLen_);
+}
+
 UPerfFunction* BreakIteratorPerformanceTest::TestDarwinForward()
 {
   return NULL;
@@ -173,6 +183,8 @@ UPerfFunction* BreakIteratorPerformanceTest::runIndexedTest(int32_t index, UBool
 		TESTCASE(1, TestICUIsBound);
 		TESTCASE(2, TestDarwinForward);
 		TESTCASE(3, TestDarwinIsBound);
+		TESTCASE(4, TestICUBackward);
+		TESTCASE(5, TestICUScroll);
         default: 
             name = ""; 
             return NULL;
@@ -103,6 +103,61 @@ public:
   }
 };
 
+class ICUBackward : public ICUBreakFunction {
+public:
+  ICUBackward(const char *locale, const char *mode, const UChar *file, int32_t file_len) :
+      ICUBreakFunction(locale, mode, file, file_len)
+  {
+    m_noBreaks_ = 0;
+    m_brkIt_->setText(UnicodeString(m_file_, m_fileLen_));
+    m_brkIt_->last();
+    while(m_brkIt_->previous() != BreakIterator::DONE) {
+      m_noBreaks_++;
+    }
+  }
+  virtual void call(UErrorCode *status) 
+  {
+    m_noBreaks_ = 0;
+    m_brkIt_->last();
+    while(m_brkIt_->previous() != BreakIterator::DONE) {
+      m_noBreaks_++;
+    }
+  }
+};
+
+// Random access near recently visited text, as when laying out
+// wrapped text that is scrolled back and forth.
+class ICUScroll : public ICUBreakFunction {
+public:
+  ICUScroll(const char *locale, const char *mode, const UChar *file, int32_t file_len) :
+      ICUBreakFunction(locale, mode, file, file_len)
+  {
+    m_brkIt_->setText(UnicodeString(m_file_, m_fileLen_));
+    scroll();
+  }
+  virtual void call(UErrorCode *status) 
+  {
+    scroll();
+  }
+private:
+  void scroll()
+  {
+    m_noBreaks_ = 0;
+    int32_t j = 0;
+    for(j = 0; j < m_fileLen_; j++) {
+      if(m_brkIt_->following(j) != BreakIterator::DONE) {
+        m_noBreaks_++;
+      }
+      if(m_brkIt_->preceding(j) != BreakIterator::DONE) {
+        m_noBreaks_++;
+      }
+      if(m_brkIt_->isBoundary(j)) {
+        m_noBreaks_++;
+      }
+    }
+  }
+};
+
 class DarwinBreakFunction : public UPerfFunction {
 public:
   virtual void call(UErrorCode *status) {};
@@ -123,6 +178,8 @@ public:
 
   UPerfFunction* TestICUForward();
   UPerfFunction* TestICUIsBound();
+  UPerfFunction* TestICUBackward();
+  UPerfFunction* TestICUScroll();
 
   UPerfFunction* TestDarwinForward();
   UPerfFunction* TestDarwinIsBound();
@@ -0,0 +1,156 @@
+/*
+*******************************************************************************
+*
+*   Copyright (C) 2013, International Business Machines
+*   Corporation and others.  All Rights Reserved.
+*
+*******************************************************************************
+*   file name:  ucnvpoolperf.cpp
+*   encoding:   US-ASCII
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   Test performance (time & memory) of ucnv_borrow()/ucnv_return()
+*   compared with ucnv_open()/ucnv_close(), for code that opens a converter
+*   for each small document it converts.
+*
+*   Run with up to two optional command-line arguments:
+*   The path to the ICU data directory, and the number of iterations.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "unicode/utypes.h"
+#include "unicode/putil.h"
+#include "unicode/uclean.h"
+#include "unicode/ucnv.h"
+#include "unicode/utimer.h"
+
+static size_t icuMemUsage = 0;
+static long icuAllocCount = 0;
+
+U_CDECL_BEGIN
+
+void *U_CALLCONV
+my_alloc(const void *context, size_t size) {
+    size_t *p = (size_t *)malloc(size + sizeof(size_t));
+    if (p != NULL) {
+        icuMemUsage += size;
+        ++icuAllocCount;
+        *p = size;
+        return p + 1;
+    } else {
+        return NULL;
+    }
+}
+
+void U_CALLCONV
+my_free(const void *context, void *mem) {
+    if (mem != NULL) {
+        const size_t *p = (const size_t *)mem - 1;
+        icuMemUsage -= *p;
+        free((void *)p);
+    }
+}
+
+// Not used in the common library.
+void *U_CALLCONV
+my_realloc(const void *context, void *mem, size_t size) {
+    my_free(context, mem);
+    return NULL;
+}
+
+U_CDECL_END
+
+// Converter names as an HTTP stack or an XML parser would see them:
+// aliases from Content-Type headers and encoding declarations.
+static const char *const names[] = {
+    "utf-8", "iso-8859-1", "windows-1252", "shift_jis", "utf-16"
+};
+
+static const int32_t namesCount = (int32_t)(sizeof(names) / sizeof(names[0]));
+
+static const char text[] = "<?xml version=\"1.0\"?><doc>Hello, world.</doc>";
+
+static void convertDocument(UConverter *cnv, UErrorCode &errorCode) {
+    UChar dest[100];
+    ucnv_toUChars(cnv, dest, (int32_t)(sizeof(dest) / sizeof(dest[0])),
+                  text, (int32_t)(sizeof(text) - 1), &errorCode);
+}
+
+static double runOpenClose(int32_t iterations, UErrorCode &errorCode) {
+    UTimer start_time;
+    utimer_getTime(&start_time);
+    for (int32_t i = 0; i < iterations && U_SUCCESS(errorCode); ++i) {
+        UConverter *cnv = ucnv_open(names[i % namesCount], &errorCode);
+        convertDocument(cnv, errorCode);
+        ucnv_close(cnv);
+    }
+    return utimer_getElapsedSeconds(&start_time);
+}
+
+static double runBorrowReturn(int32_t iterations, UErrorCode &errorCode) {
+    UTimer start_time;
+    utimer_getTime(&start_time);
+    for (int32_t i = 0; i < iterations && U_SUCCESS(errorCode); ++i) {
+        UConverter *cnv = ucnv_borrow(names[i % namesCount], &errorCode);
+        convertDocument(cnv, errorCode);
+        ucnv_return(cnv);
+    }
+    return utimer_getElapsedSeconds(&start_time);
+}
+
+int main(int argc, const char *argv[]) {
+    UErrorCode errorCode = U_ZERO_ERROR;
+    int32_t iterations = 100000;
+
+    // Hook in our own memory allocation functions so that we can count
+    // the allocations made by each variant.
+    u_setMemoryFunctions(NULL, my_alloc, my_realloc, my_free, &errorCode);
+    if(U_FAILURE(errorCode)) {
+        fprintf(stderr,
+                "u_setMemoryFunctions() failed - %s\n",
+                u_errorName(errorCode));
+        return errorCode;
+    }
+
+    if (argc > 1) {
+        printf("u_setDataDirectory(%s)\n", argv[1]);
+        u_setDataDirectory(argv[1]);
+    }
+    if (argc > 2) {
+        iterations = atoi(argv[2]);
+    }
+
+    // Load the converter tables once, so that neither variant pays for that.
+    for (int32_t i = 0; i < namesCount; ++i) {
+        ucnv_close(ucnv_open(names[i], &errorCode));
+    }
+    if(U_FAILURE(errorCode)) {
+        fprintf(stderr, "unable to open the test converters - %s\n", u_errorName(errorCode));
+        return errorCode;
+    }
+
+    long allocCount = icuAllocCount;
+    double elapsed = runOpenClose(iterations, errorCode);
+    printf("ucnv_open()/ucnv_close():     %d documents in %g seconds, %ld allocations\n",
+           (int)iterations, elapsed, icuAllocCount - allocCount);
+
+    allocCount = icuAllocCount;
+    elapsed = runBorrowReturn(iterations, errorCode);
+    printf("ucnv_borrow()/ucnv_return():  %d documents in %g seconds, %ld allocations\n",
+           (int)iterations, elapsed, icuAllocCount - allocCount);
+    printf("memory usage with pooled converters: %lu\n", (long)icuMemUsage);
+    if(U_FAILURE(errorCode)) {
+        fprintf(stderr, "conversion failed - %s\n", u_errorName(errorCode));
+        return errorCode;
+    }
+
+    ucnv_flushCache();
+    printf("memory usage after ucnv_flushCache(): %lu\n", (long)icuMemUsage);
+
+    u_cleanup();
+    printf("memory usage after u_cleanup(): %lu\n", (long)icuMemUsage);
+
+    return 0;
+}
@@ -1,6 +1,6 @@
 /*  
 **********************************************************************
-*   Copyright (C) 2007, International Business Machines
+*   Copyright (C) 2007-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 **********************************************************************
 *   file name:  unisetperf.cpp
@@ -47,11 +47,25 @@ class UnicodeSetPerformanceTest : public UPerfTest {
 public:
     UnicodeSetPerformanceTest(int32_t argc, const char *argv[], UErrorCode &status)
             : UPerfTest(argc, argv, options, LENGTHOF(options), unisetperf_usage, status),
-              utf8(NULL), utf8Length(0), countInputCodePoints(0), spanCount(0) {
+              utf8(NULL), utf8Length(0), countInputCodePoints(0), spanCount(0),
+              frozen(NULL), frozenLength(0) {
         if (U_SUCCESS(status)) {
-            UnicodeString pattern=UnicodeString(options[SET_PATTERN].value, -1, US_INV).unescape();
+            pattern=UnicodeString(options[SET_PATTERN].value, -1, US_INV).unescape();
             set.applyPattern(pattern, status);
             prefrozen=set;
+
+            // Serialize the frozen form for CreateFromFrozen.
+            frozenLength=prefrozen.serializeFrozen(NULL, 0, status);
+            if(status==U_BUFFER_OVERFLOW_ERROR) {
+                frozen=(int32_t *)malloc(frozenLength*4);
+                if(frozen!=NULL) {
+                    status=U_ZERO_ERROR;
+                    prefrozen.serializeFrozen(frozen, frozenLength, status);
+                } else {
+                    status=U_MEMORY_ALLOCATION_ERROR;
+                }
+            }
+
             if(0==strcmp(options[FAST_TYPE].value, "fast")) {
                 set.freeze();
             }
@@ -86,6 +100,11 @@ public:
         }
     }
 
+    ~UnicodeSetPerformanceTest() {
+        free(utf8);
+        free(frozen);
+    }
+
     virtual UPerfFunction* runIndexedTest(int32_t index, UBool exec, const char* &name, char* par = NULL);
 
     // Count spans of characters that are in the set,
@@ -125,8 +144,13 @@ public:
     int32_t countInputCodePoints;
     int32_t spanCount;
 
+    UnicodeString pattern;
     UnicodeSet set;
     UnicodeSet prefrozen;
+
+    // Frozen form of the set, from serializeFrozen().
+    int32_t *frozen;
+    int32_t frozenLength;
 };
 
 // Performance test function object.
@@ -404,6 +428,52 @@ public:
     }
 };
 
+// Startup cost: Build a frozen set the usual way, from its pattern.
+class CreateFromPattern : public Command {
+protected:
+    CreateFromPattern(const UnicodeSetPerformanceTest &testcase) : Command(testcase) {}
+public:
+    static UPerfFunction* get(const UnicodeSetPerformanceTest &testcase) {
+        return new CreateFromPattern(testcase);
+    }
+    virtual void call(UErrorCode* pErrorCode) {
+        UnicodeSet set(testcase.pattern, *pErrorCode);
+        set.freeze();
+        if(set.isEmpty()!=testcase.set.isEmpty()) {
+            fprintf(stderr, "error: CreateFromPattern() set != original!\n");
+        }
+    }
+    virtual long getOperationsPerIteration() { return 1; }
+    virtual long getEventsPerIteration() { return 1; }
+};
+
+// Startup cost: Load the frozen set from its serialized frozen form.
+class CreateFromFrozen : public Command {
+protected:
+    CreateFromFrozen(const UnicodeSetPerformanceTest &testcase) : Command(testcase) {
+        // Verify that the loaded set is equal to the original.
+        UErrorCode errorCode=U_ZERO_ERROR;
+        UnicodeSet *set=UnicodeSet::createFromFrozen(testcase.frozen, testcase.frozenLength, errorCode);
+        if(set==NULL || *set!=testcase.set) {
+            fprintf(stderr, "error: frozen form != original! (%s)\n", u_errorName(errorCode));
+        }
+        delete set;
+    }
+public:
+    static UPerfFunction* get(const UnicodeSetPerformanceTest &testcase) {
+        return new CreateFromFrozen(testcase);
+    }
+    virtual void call(UErrorCode* pErrorCode) {
+        UnicodeSet *set=UnicodeSet::createFromFrozen(testcase.frozen, testcase.frozenLength, *pErrorCode);
+        if(set==NULL || set->isEmpty()!=testcase.set.isEmpty()) {
+            fprintf(stderr, "error: CreateFromFrozen() set != original!\n");
+        }
+        delete set;
+    }
+    virtual long getOperationsPerIteration() { return 1; }
+    virtual long getEventsPerIteration() { return 1; }
+};
+
 UPerfFunction* UnicodeSetPerformanceTest::runIndexedTest(int32_t index, UBool exec, const char* &name, char* par) {
     switch (index) {
         case 0: name = "Contains";     if (exec) return Contains::get(*this); break;
@@ -411,6 +481,8 @@ UPerfFunction* UnicodeSetPerformanceTest::runIndexedTest(int32_t index, UBool ex
         case 2: name = "SpanBackUTF16";if (exec) return SpanBackUTF16::get(*this); break;
         case 3: name = "SpanUTF8";     if (exec) return SpanUTF8::get(*this); break;
         case 4: name = "SpanBackUTF8"; if (exec) return SpanBackUTF8::get(*this); break;
+        case 5: name = "CreateFromPattern"; if (exec) return CreateFromPattern::get(*this); break;
+        case 6: name = "CreateFromFrozen";  if (exec) return CreateFromFrozen::get(*this); break;
         default: name = ""; break;
     }
     return NULL;
@@ -1,7 +1,7 @@
 #!/usr/bin/perl
 #  ********************************************************************
 #  * COPYRIGHT:
-#  * Copyright (c) 2005-2008, International Business Machines Corporation and
+#  * Copyright (c) 2005-2013, International Business Machines Corporation and
 #  * others. All Rights Reserved.
 #  ********************************************************************
 
@@ -84,3 +84,30 @@ $tests = {
 	    };
 
 runTests($options, $tests, $dataFiles);
+
+# Startup cost of a frozen set: applyPattern()+freeze() vs. createFromFrozen().
+$options = {
+	       "title"=>"UnicodeSet creation of a frozen set",
+	       "headers"=>"Pattern Frozen",
+	       "operationIs"=>"created set",
+	       "passes"=>"3",
+	       "time"=>"2",
+	       #"outputType"=>"HTML",
+	       "dataDir"=>$UDHRDataPath,
+	       "outputDir"=>"../results"
+	      };
+
+$tests = {
+	     "Create",    ["$p CreateFromPattern",
+	                   "$p CreateFromFrozen"
+	                   ]
+	    };
+
+$dataFiles = {
+		 "",
+		 [
+		  "udhr_eng.txt"
+		 ]
+		};
+
+runTests($options, $tests, $dataFiles);
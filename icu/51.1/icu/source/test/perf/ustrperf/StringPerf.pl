@@ -49,6 +49,8 @@ my $tests = {
 "String Scanning(char)",     		      ["$p TestStdLibScan"         , "$p TestScan"         ],
 "String Scanning(string)",       		  ["$p TestStdLibScan1"        , "$p TestScan1"        ],
 "String Scanning(char set)",       	      ["$p TestStdLibScan2"        , "$p TestScan2"        ],
+"Lowercasing",       	                  ["$p TestStdLibToLower"      , "$p TestToLower"      ],
+"Uppercasing",       	                  ["$p TestStdLibToUpper"      , "$p TestToUpper"      ],
 };
 
 my $dataFiles = {
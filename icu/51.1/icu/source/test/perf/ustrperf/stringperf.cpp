@@ -1,6 +1,6 @@
 /********************************************************************
  * COPYRIGHT:
- * Copyright (C) 2002-2006 International Business Machines Corporation
+ * Copyright (C) 2002-2013 International Business Machines Corporation
  * and others. All Rights Reserved.
  *
  ********************************************************************/
@@ -148,6 +148,16 @@ UPerfFunction* StringPerformanceTest::runIndexedTest(int32_t index, UBool exec,
         TESTCASE(22, TestStdLibScan1);
         TESTCASE(23, TestStdLibScan2);
 
+        TESTCASE(24, TestToLower);
+        TESTCASE(25, TestToUpper);
+        TESTCASE(26, TestFoldCase);
+        TESTCASE(27, TestStrFoldCase);
+        TESTCASE(28, TestStdLibToLower);
+        TESTCASE(29, TestStdLibToUpper);
+
+        TESTCASE(30, TestTemporaries);
+        TESTCASE(31, TestArenaTemporaries);
+
         default: 
             name = ""; 
             return NULL;
@@ -265,6 +275,63 @@ UPerfFunction* StringPerformanceTest::TestScan2()
     }
 }
 
+UPerfFunction* StringPerformanceTest::TestToLower()
+{
+    if (line_mode) {
+        return new StringPerfFunction(toLower, filelines_, numLines, uselen);
+    } else {
+        return new StringPerfFunction(toLower, StrBuffer, StrBufferLen, uselen);
+    }
+}
+
+UPerfFunction* StringPerformanceTest::TestToUpper()
+{
+    if (line_mode) {
+        return new StringPerfFunction(toUpper, filelines_, numLines, uselen);
+    } else {
+        return new StringPerfFunction(toUpper, StrBuffer, StrBufferLen, uselen);
+    }
+}
+
+UPerfFunction* StringPerformanceTest::TestTemporaries()
+{
+    if (line_mode) {
+        return new StringPerfFunction(temporaries, filelines_, numLines, uselen);
+    } else {
+        return new StringPerfFunction(temporaries, StrBuffer, StrBufferLen, uselen);
+    }
+}
+
+UPerfFunction* StringPerformanceTest::TestArenaTemporaries()
+{
+    StringPerfFunction* func;
+    if (line_mode) {
+        func = new StringPerfFunction(temporaries, filelines_, numLines, uselen);
+    } else {
+        func = new StringPerfFunction(temporaries, StrBuffer, StrBufferLen, uselen);
+    }
+    func->setUseArena(TRUE);
+    return func;
+}
+
+UPerfFunction* StringPerformanceTest::TestFoldCase()
+{
+    if (line_mode) {
+        return new StringPerfFunction(foldCase, filelines_, numLines, uselen);
+    } else {
+        return new StringPerfFunction(foldCase, StrBuffer, StrBufferLen, uselen);
+    }
+}
+
+UPerfFunction* StringPerformanceTest::TestStrFoldCase()
+{
+    if (line_mode) {
+        return new StringPerfFunction(strFoldCase, filelines_, numLines, uselen);
+    } else {
+        return new StringPerfFunction(strFoldCase, StrBuffer, StrBufferLen, uselen);
+    }
+}
+
 UPerfFunction* StringPerformanceTest::TestStdLibCtor()
 {
     if (line_mode) {
@@ -374,4 +441,21 @@ UPerfFunction* StringPerformanceTest::TestStdLibScan2()
     }
 }
 
+UPerfFunction* StringPerformanceTest::TestStdLibToLower()
+{
+    if (line_mode) {
+        return new StringPerfFunction(StdLibToLower, filelines_, numLines, uselen);
+    } else {
+        return new StringPerfFunction(StdLibToLower, StrBuffer, StrBufferLen, uselen);
+    }
+}
+
+UPerfFunction* StringPerformanceTest::TestStdLibToUpper()
+{
+    if (line_mode) {
+        return new StringPerfFunction(StdLibToUpper, filelines_, numLines, uselen);
+    } else {
+        return new StringPerfFunction(StdLibToUpper, StrBuffer, StrBufferLen, uselen);
+    }
+}
 
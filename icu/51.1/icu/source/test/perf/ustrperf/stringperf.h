@@ -1,6 +1,6 @@
 /*
 **********************************************************************
-* Copyright (c) 2002-2011, International Business Machines
+* Copyright (c) 2002-2013, International Business Machines
 * Corporation and others.  All Rights Reserved.
 **********************************************************************
 */
@@ -9,12 +9,17 @@
 
 #include "unicode/utypes.h"
 #include "unicode/unistr.h"
+#include "unicode/locid.h"
+#include "unicode/uchar.h"
+#include "unicode/ustring.h"
 
 #include "unicode/uperf.h"
+#include "ustrarena.h"
 
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <wctype.h>
 
 typedef std::wstring stlstring;	
 
@@ -91,7 +96,7 @@ public:
             if(uselen_){
                 for(int32_t i = 0; i< numLines_; i++){
                     if (fnType_==Fn_ICU) {
-                        (*fn1_)(lines_[i].name,lines_[i].len,uS0_[i]);
+                        callICU(lines_[i].name,lines_[i].len,uS0_[i]);
                     } else {
                         (*fn2_)(wlines_[i].name,wlines_[i].len,sS0_[i]);
                     }
@@ -99,7 +104,7 @@ public:
             }else{
                 for(int32_t i = 0; i< numLines_; i++){
                     if (fnType_==Fn_ICU) {
-                        (*fn1_)(lines_[i].name,-1,uS0_[i]);
+                        callICU(lines_[i].name,-1,uS0_[i]);
                     } else {
                         (*fn2_)(wlines_[i].name,-1,sS0_[i]);
                     }
@@ -108,13 +113,13 @@ public:
         }else{
             if(uselen_){
                 if (fnType_==Fn_ICU) {
-                    (*fn1_)(src_,srcLen_,*ubulk_);
+                    callICU(src_,srcLen_,*ubulk_);
                 } else {
                     (*fn2_)(wsrc_,wsrcLen_,*sbulk_);
                 }
             }else{
                 if (fnType_==Fn_ICU) {
-                    (*fn1_)(src_,-1,*ubulk_);
+                    callICU(src_,-1,*ubulk_);
                 } else {
                     (*fn2_)(wsrc_,-1,*sbulk_);
                 }
@@ -131,10 +136,17 @@ public:
         }
     }
 
+    // Each call of an ICU function gets its own UnicodeStringArena
+    void setUseArena(UBool useArena)
+    {
+        useArena_ = useArena;
+    }
+
     StringPerfFunction(ICUStringPerfFn func, ULine* srcLines, int32_t srcNumLines, UBool uselen)
     {
 
         fn1_ = func;
+        useArena_ = FALSE;
         lines_=srcLines;
         wlines_=NULL;
         numLines_=srcNumLines;
@@ -182,6 +194,7 @@ public:
     {
 
         fn1_ = func;
+        useArena_ = FALSE;
         lines_=NULL;
         wlines_=NULL;
         numLines_=0;
@@ -236,6 +249,17 @@ public:
     }
 
 private:
+    void callICU(const UChar* src, int32_t srcLen, const UnicodeString& s0)
+    {
+        if (useArena_) {
+            // The strings in fn1_ are below this frame, so they use the arena
+            UnicodeStringArena arena;
+            (*fn1_)(src, srcLen, s0);
+        } else {
+            (*fn1_)(src, srcLen, s0);
+        }
+    }
+
     void prepareLinesForStd(void)
     {
         UErrorCode err=U_ZERO_ERROR;
@@ -319,6 +343,7 @@ private:
 private:
     ICUStringPerfFn fn1_;
     StdStringPerfFn fn2_;
+    UBool useArena_;
 
     ULine* lines_;
     WLine* wlines_;
@@ -360,6 +385,12 @@ public:
     UPerfFunction* TestScan();
     UPerfFunction* TestScan1();
     UPerfFunction* TestScan2();
+    UPerfFunction* TestToLower();
+    UPerfFunction* TestToUpper();
+    UPerfFunction* TestFoldCase();
+    UPerfFunction* TestStrFoldCase();
+    UPerfFunction* TestTemporaries();
+    UPerfFunction* TestArenaTemporaries();
 
     UPerfFunction* TestStdLibCtor();
     UPerfFunction* TestStdLibCtor1();
@@ -373,6 +404,8 @@ public:
     UPerfFunction* TestStdLibScan();
     UPerfFunction* TestStdLibScan1();
     UPerfFunction* TestStdLibScan2();
+    UPerfFunction* TestStdLibToLower();
+    UPerfFunction* TestStdLibToUpper();
 
 private:
     long COUNT_;
@@ -466,6 +499,46 @@ inline void scan2(const UChar* src,int32_t srcLen, UnicodeString s0)
     scan_idx = uScan_STRING.indexOf(c2);
 }
 
+/* Case mapping: s0 is a copy, so each call maps a fresh string. */
+inline void toLower(const UChar* src,int32_t srcLen, UnicodeString s0)
+{
+    s0.toLower(Locale::getRoot());
+}
+
+inline void toUpper(const UChar* src,int32_t srcLen, UnicodeString s0)
+{
+    s0.toUpper(Locale::getRoot());
+}
+
+inline void foldCase(const UChar* src,int32_t srcLen, UnicodeString s0)
+{
+    s0.foldCase();
+}
+
+UnicodeString caseDest;
+
+inline void strFoldCase(const UChar* src,int32_t srcLen, UnicodeString s0)
+{
+    UErrorCode errorCode=U_ZERO_ERROR;
+    if (srcLen==-1) { srcLen=u_strlen(src);}
+    int32_t capacity=3*srcLen+1;  // full case folding expands by at most 3x
+    UChar *dest=caseDest.getBuffer(capacity);
+    int32_t length=u_strFoldCase(dest, caseDest.getCapacity(), src, srcLen, U_FOLD_CASE_DEFAULT, &errorCode);
+    caseDest.releaseBuffer(U_SUCCESS(errorCode) ? length : 0);
+}
+
+// Short-lived strings that are too long for the stack buffer, as in formatting
+inline void temporaries(const UChar* src,int32_t srcLen, UnicodeString s0)
+{
+    UnicodeString a(s0);
+    a.append(uScan_STRING);
+    UnicodeString b(a);
+    b.append(s0).toUpper();
+    UnicodeString c(b, 0, b.length() / 2);
+    c.append(a);
+    scan_idx = c.indexOf((UChar)0x2e);
+}
+
 
 inline void StdLibCtor(const wchar_t* src,int32_t srcLen, stlstring s0)
 {
@@ -547,5 +620,19 @@ inline void StdLibScan2(const wchar_t* src,int32_t srcLen, stlstring s0)
     scan_idx = (int) sScan_STRING.find_first_of(L"sm");
 }
 
+inline void StdLibToLower(const wchar_t* src,int32_t srcLen, stlstring s0)
+{
+    for (stlstring::iterator it=s0.begin(); it!=s0.end(); ++it) {
+        *it=(wchar_t)towlower(*it);
+    }
+}
+
+inline void StdLibToUpper(const wchar_t* src,int32_t srcLen, stlstring s0)
+{
+    for (stlstring::iterator it=s0.begin(); it!=s0.end(); ++it) {
+        *it=(wchar_t)towupper(*it);
+    }
+}
+
 #endif // STRINGPERF_H
 
@@ -41,6 +41,8 @@ my $tests = {
 	     "Roundtrip",      ["$p1 Roundtrip",        "$p2 Roundtrip"],
 	     "FromUnicode",    ["$p1 FromUnicode",      "$p2 FromUnicode"],
 	     "FromUTF8",       ["$p1 FromUTF8",         "$p2 FromUTF8"],
+	     "StrFromUTF8",    ["$p1 StrFromUTF8",      "$p2 StrFromUTF8"],
+	     "StrToUTF8",      ["$p1 StrToUTF8",        "$p2 StrToUTF8"],
 	     #"UTF-8",  ["$p UTF_8"],
 	     #"UTF-8 small buffer",  ["$p UTF_8_SB"],
 	     #"SCSU",  ["$p SCSU"],
@@ -1,6 +1,6 @@
 /*  
  **********************************************************************
- *   Copyright (C) 2002-2007, International Business Machines
+ *   Copyright (C) 2002-2013, International Business Machines
  *   Corporation and others.  All Rights Reserved.
  **********************************************************************
  *   file name:  utfperf.cpp
@@ -18,6 +18,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "unicode/uperf.h"
+#include "unicode/ustring.h"
 #include "uoptions.h"
 
 #define LENGTHOF(array) (int32_t)(sizeof(array)/sizeof((array)[0]))
@@ -116,7 +117,7 @@ fromUCallback(const void *context,
 }
 U_CDECL_END
 
-// Base class for Roundtrip, FromUnicode and FromUTF8 with common setup.
+// Base class for all of the tests, with common setup.
 class Command : public UPerfFunction {
 protected:
     Command(const UtfPerformanceTest &testcase)
@@ -325,11 +326,61 @@ protected:
     int32_t input8Length;
 };
 
+// Test u_strFromUTF8WithSub(), which does not use a converter.
+class StrFromUTF8 : public Command {
+protected:
+    StrFromUTF8(const UtfPerformanceTest &testcase) : Command(testcase) {}
+public:
+    static UPerfFunction* get(const UtfPerformanceTest &testcase) {
+        StrFromUTF8 * t = new StrFromUTF8(testcase);
+        if (U_SUCCESS(t->errorCode)){
+            return t;
+        } else {
+            delete t;
+            return NULL;
+        }
+    }
+    virtual void call(UErrorCode* pErrorCode){
+        u_strFromUTF8WithSub(output, OUTPUT_CAPACITY, &outputLength,
+                             utf8, utf8Length, 0xfffd, NULL, pErrorCode);
+        if(U_SUCCESS(*pErrorCode) && inputLength!=outputLength) {
+            fprintf(stderr, "error: u_strFromUTF8WithSub() returned %d UChars instead of %d\n", outputLength, inputLength);
+            *pErrorCode=U_INTERNAL_PROGRAM_ERROR;
+        }
+    }
+};
+
+// Test u_strToUTF8WithSub(), which does not use a converter.
+class StrToUTF8 : public Command {
+protected:
+    StrToUTF8(const UtfPerformanceTest &testcase) : Command(testcase) {}
+public:
+    static UPerfFunction* get(const UtfPerformanceTest &testcase) {
+        StrToUTF8 * t = new StrToUTF8(testcase);
+        if (U_SUCCESS(t->errorCode)){
+            return t;
+        } else {
+            delete t;
+            return NULL;
+        }
+    }
+    virtual void call(UErrorCode* pErrorCode){
+        u_strToUTF8WithSub(intermediate, OUTPUT_CAPACITY, &encodedLength,
+                           input, inputLength, 0xfffd, NULL, pErrorCode);
+        if(U_SUCCESS(*pErrorCode) && utf8Length!=encodedLength) {
+            fprintf(stderr, "error: u_strToUTF8WithSub() returned %d bytes instead of %d\n", encodedLength, utf8Length);
+            *pErrorCode=U_INTERNAL_PROGRAM_ERROR;
+        }
+    }
+};
+
 UPerfFunction* UtfPerformanceTest::runIndexedTest(int32_t index, UBool exec, const char* &name, char* par) {
     switch (index) {
         case 0: name = "Roundtrip";     if (exec) return Roundtrip::get(*this); break;
         case 1: name = "FromUnicode";   if (exec) return FromUnicode::get(*this); break;
         case 2: name = "FromUTF8";      if (exec) return FromUTF8::get(*this); break;
+        case 3: name = "StrFromUTF8";   if (exec) return StrFromUTF8::get(*this); break;
+        case 4: name = "StrToUTF8";     if (exec) return StrToUTF8::get(*this); break;
         default: name = ""; break;
     }
     return NULL;
@@ -0,0 +1,123 @@
+//
+//********************************************************************
+//   Copyright (C) 2013, International Business Machines
+//   Corporation and others.  All Rights Reserved.
+//********************************************************************
+//
+// File initoncetest.cpp
+//
+//   Compares the steady state cost of lazy initialization done with
+//   umtx_initOnce() against the older pattern of taking a mutex on every
+//   call to check an "initialized" flag.  Each runOnce() performs
+//   LOOKUPS_PER_CYCLE lookups, so the "cycles per minute" reported at the
+//   end of a timed run, e.g.
+//       threadtest -threads 8 -time 20 initonce
+//       threadtest -threads 8 -time 20 initmutex
+//   is the throughput of the two approaches.
+//
+
+#include "threadtest.h"
+#include "unicode/utypes.h"
+#include "umutex.h"
+#include "stdio.h"
+
+U_NAMESPACE_USE
+
+static const int32_t LOOKUPS_PER_CYCLE = 100000;
+
+static int32_t  *gOnceData     = NULL;
+static int32_t   gOnceInitCalls = 0;
+static UInitOnce gOnceInitOnce = U_INITONCE_INITIALIZER;
+
+static int32_t  *gMutexData     = NULL;
+static int32_t   gMutexInitCalls = 0;
+static UBool     gMutexInitialized = FALSE;
+static UMutex    gMutexDataLock = U_MUTEX_INITIALIZER;
+
+static void initOnceData() {
+    umtx_atomic_inc(&gOnceInitCalls);
+    gOnceData = new int32_t(42);
+}
+
+static const int32_t *getOnceData() {
+    umtx_initOnce(gOnceInitOnce, &initOnceData);
+    return gOnceData;
+}
+
+static const int32_t *getMutexData() {
+    umtx_lock(&gMutexDataLock);
+    if (!gMutexInitialized) {
+        umtx_atomic_inc(&gMutexInitCalls);
+        gMutexData = new int32_t(42);
+        gMutexInitialized = TRUE;
+    }
+    umtx_unlock(&gMutexDataLock);
+    return gMutexData;
+}
+
+
+class InitOnceThreadTest: public AbstractThreadTest {
+public:
+                    InitOnceThreadTest(UBool useMutex);
+    virtual        ~InitOnceThreadTest();
+    virtual void    check();
+    virtual void    runOnce();
+
+private:
+    UBool           fUseMutex;
+    int32_t         fErrors;
+};
+
+
+InitOnceThreadTest::InitOnceThreadTest(UBool useMutex) {
+    fUseMutex = useMutex;
+    fErrors   = 0;
+}
+
+
+InitOnceThreadTest::~InitOnceThreadTest() {
+    delete gOnceData;
+    gOnceData = NULL;
+    gOnceInitOnce.reset();
+    delete gMutexData;
+    gMutexData = NULL;
+    gMutexInitialized = FALSE;
+}
+
+
+void InitOnceThreadTest::runOnce() {
+    int32_t sum = 0;
+    int32_t i;
+    if (fUseMutex) {
+        for (i = 0; i < LOOKUPS_PER_CYCLE; i++) {
+            sum += *getMutexData();
+        }
+    } else {
+        for (i = 0; i < LOOKUPS_PER_CYCLE; i++) {
+            sum += *getOnceData();
+        }
+    }
+    if (sum != 42 * LOOKUPS_PER_CYCLE) {
+        umtx_atomic_inc(&fErrors);
+    }
+}
+
+
+void InitOnceThreadTest::check() {
+    int32_t initCalls = fUseMutex ? gMutexInitCalls : gOnceInitCalls;
+    if (initCalls > 1) {
+        fprintf(stderr, "InitOnceThreadTest: initialization ran %d times.\n", (int)initCalls);
+    }
+    if (fErrors != 0) {
+        fprintf(stderr, "InitOnceThreadTest: %d cycles saw uninitialized data.\n", (int)fErrors);
+    }
+}
+
+
+AbstractThreadTest *createInitOnceTest() {
+    return new InitOnceThreadTest(FALSE);
+}
+
+AbstractThreadTest *createInitMutexTest() {
+    return new InitOnceThreadTest(TRUE);
+}
@@ -0,0 +1,77 @@
+//
+//********************************************************************
+//   Copyright (C) 2013, International Business Machines
+//   Corporation and others.  All Rights Reserved.
+//********************************************************************
+//
+// File resbundtest.cpp
+//
+//   Contention test for the resource bundle cache.
+//   Every thread repeatedly opens the bundles that creating a
+//   DateFormat or NumberFormat would open, all of which are already
+//   cached after the first cycle.  The "cycles per minute" result
+//   shows how well ures_open() scales with the number of threads.
+//
+
+#include "threadtest.h"
+#include "unicode/utypes.h"
+#include "unicode/ures.h"
+#include "stdio.h"
+
+static const char *const gLocales[] = {
+    "en_US", "de_DE", "fr_FR", "ja_JP", "zh_Hans_CN", "ar_EG", "ru_RU", "pt_BR", ""
+};
+
+static const int32_t gNumLocales = (int32_t)(sizeof(gLocales)/sizeof(gLocales[0]));
+
+class ResBundleThreadTest: public AbstractThreadTest {
+public:
+                    ResBundleThreadTest();
+    virtual        ~ResBundleThreadTest();
+    virtual void    check();
+    virtual void    runOnce();
+};
+
+
+ResBundleThreadTest::ResBundleThreadTest() {
+    // Load everything once, single threaded.
+    runOnce();
+}
+
+
+ResBundleThreadTest::~ResBundleThreadTest() {
+}
+
+void ResBundleThreadTest::runOnce() {
+    for (int32_t i = 0; i < gNumLocales; i++) {
+        UErrorCode err = U_ZERO_ERROR;
+        UResourceBundle *rb = ures_open(NULL, gLocales[i], &err);
+        UResourceBundle *sub = ures_getByKey(rb, "NumberElements", NULL, &err);
+        ures_close(sub);
+        ures_close(rb);
+        if (U_FAILURE(err)) {
+            fprintf(stderr, "ures_open(\"%s\") failed - %s\n", gLocales[i], u_errorName(err));
+        }
+
+        err = U_ZERO_ERROR;
+        rb = ures_openDirect(NULL, "supplementalData", &err);
+        ures_close(rb);
+        if (U_FAILURE(err)) {
+            fprintf(stderr, "ures_openDirect(\"supplementalData\") failed - %s\n", u_errorName(err));
+        }
+    }
+}
+
+void ResBundleThreadTest::check() {
+    UErrorCode err = U_ZERO_ERROR;
+    UResourceBundle *rb = ures_open(NULL, "en_US", &err);
+    if (U_FAILURE(err) || err == U_USING_DEFAULT_WARNING) {
+        fprintf(stderr, "ResBundleTest::check() - ures_open(\"en_US\") returned %s\n", u_errorName(err));
+    }
+    ures_close(rb);
+}
+
+
+AbstractThreadTest *createResBundleTest() {
+    return new ResBundleThreadTest();
+}
@@ -1,6 +1,6 @@
 //
 //********************************************************************
-//   Copyright (C) 2002-2011, International Business Machines
+//   Copyright (C) 2002-2013, International Business Machines
 //   Corporation and others.  All Rights Reserved.
 //********************************************************************
 //
@@ -25,6 +25,9 @@ AbstractThreadTest::~AbstractThreadTest() {}
 //------------------------------------------------------------------------------
 extern  AbstractThreadTest *createStringTest();
 extern  AbstractThreadTest *createConvertTest();
+extern  AbstractThreadTest *createResBundleTest();
+extern  AbstractThreadTest *createInitOnceTest();
+extern  AbstractThreadTest *createInitMutexTest();
 
 
 
@@ -268,6 +271,18 @@ void parseCommandLine(int argc, char **argv)
             {
                 gRunInfo.fTest = createConvertTest();
             }
+            else if (strcmp(argv[argnum], "resbundle") == 0)
+            {
+                gRunInfo.fTest = createResBundleTest();
+            }
+            else if (strcmp(argv[argnum], "initonce") == 0)
+            {
+                gRunInfo.fTest = createInitOnceTest();
+            }
+            else if (strcmp(argv[argnum], "initmutex") == 0)
+            {
+                gRunInfo.fTest = createInitMutexTest();
+            }
            else  
             {
                 fprintf(stderr, "Unrecognized command line option.  Scanning \"%s\"\n",
@@ -292,7 +307,7 @@ void parseCommandLine(int argc, char **argv)
             "     -threads nnn   Number of threads.  Default is 2. \n"
             "     -time nnn      Total time to run, in seconds.  Default is forever.\n"
             "     -ctime nnn     Time between extra consistency checks, in seconds.  Default 10\n"
-            "     testname       string | convert\n"
+            "     testname       string | convert | resbundle | initonce | initmutex\n"
             );
         exit(1);
     }
@@ -143,6 +143,14 @@ SOURCE=.\converttest.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\initoncetest.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\resbundtest.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\stringtest.cpp
 # End Source File
 # Begin Source File
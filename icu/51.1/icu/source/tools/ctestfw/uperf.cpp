@@ -1,6 +1,6 @@
 /********************************************************************
  * COPYRIGHT:
- * Copyright (c) 2002-2012, International Business Machines Corporation and
+ * Copyright (c) 2002-2013, International Business Machines Corporation and
  * others. All Rights Reserved.
  ********************************************************************/
 
@@ -13,6 +13,10 @@
 #include "cmemory.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#if !U_PLATFORM_USES_ONLY_WIN32_API
+#include <sys/resource.h>
+#endif
 
 #if !UCONFIG_NO_CONVERSION
 
@@ -41,7 +45,9 @@ const char UPerfTest::gUsageString[] =
     "\t-l or --line-mode    The data file should be processed in line mode\n"
     "\t-b or --bulk-mode    The data file should be processed in file based.\n"
     "\t                     Cannot be used with --line-mode\n"
-    "\t-L or --locale       Locale for the test\n";
+    "\t-L or --locale       Locale for the test\n"
+    "\t-j or --json         Append one line of JSON per test to the file followed by path\n"
+    "\t--json-label         Label stored with the JSON results, to tell apart runs with different options\n";
 
 enum
 {
@@ -58,6 +64,8 @@ enum
     LINE_MODE,
     BULK_MODE,
     LOCALE,
+    JSON,
+    JSON_LABEL,
     OPTIONS_COUNT
 };
 
@@ -75,9 +83,94 @@ static UOption options[OPTIONS_COUNT+20]={
     UOPTION_DEF( "time",          't', UOPT_REQUIRES_ARG),
     UOPTION_DEF( "line-mode",     'l', UOPT_NO_ARG),
     UOPTION_DEF( "bulk-mode",     'b', UOPT_NO_ARG),
-    UOPTION_DEF( "locale",        'L', UOPT_REQUIRES_ARG)
+    UOPTION_DEF( "locale",        'L', UOPT_REQUIRES_ARG),
+    UOPTION_DEF( "json",          'j', UOPT_REQUIRES_ARG),
+    UOPTION_DEF( "json-label",    '\x01', UOPT_REQUIRES_ARG)
 };
 
+static const char *jsonFileName = NULL;
+static const char *jsonLabel = NULL;
+
+/**
+ * Peak resident set size of this process in kilobytes, or -1 if not known.
+ */
+static long getMaxRSSKilobytes() {
+#if U_PLATFORM_USES_ONLY_WIN32_API
+    return -1;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#if U_PLATFORM_IS_DARWIN_BASED
+    return (long)(usage.ru_maxrss / 1024);  // bytes on Darwin
+#else
+    return (long)usage.ru_maxrss;
+#endif
+#endif
+}
+
+static void writeJSONString(FILE *f, const char *s) {
+    if (s == NULL) {
+        fputs("null", f);
+        return;
+    }
+    fputc('"', f);
+    for (; *s != 0; ++s) {
+        if (*s == '"' || *s == '\\') {
+            fputc('\\', f);
+            fputc(*s, f);
+        } else if ((unsigned char)*s < 0x20) {
+            fprintf(f, "\\u%04x", (int)(unsigned char)*s);
+        } else {
+            fputc(*s, f);
+        }
+    }
+    fputc('"', f);
+}
+
+/**
+ * Appends the results of one test to the --json file, as one JSON object
+ * on one line, so that the results of several programs can be collected
+ * in the same file and compared with a baseline by test/perf/perfcompare.pl.
+ */
+static void writeJSONResult(const char *program, const char *name,
+                            const char *fileName, const char *locale,
+                            int32_t passes, int32_t loops, long ops, long events,
+                            double min_t, double avg_t) {
+    FILE *f = fopen(jsonFileName, "a");
+    if (f == NULL) {
+        fprintf(stderr, "Could not open the JSON output file %s\n", jsonFileName);
+        return;
+    }
+    const char *base = strrchr(program, '/');
+    if (base == NULL) {
+        base = strrchr(program, '\\');
+    }
+    program = base != NULL ? base + 1 : program;
+
+    double ns_per_op = (min_t*1E9)/((double)loops*ops);
+    fputs("{\"program\":", f);
+    writeJSONString(f, program);
+    fputs(",\"test\":", f);
+    writeJSONString(f, name);
+    fputs(",\"file\":", f);
+    writeJSONString(f, fileName);
+    fputs(",\"locale\":", f);
+    writeJSONString(f, locale);
+    fputs(",\"label\":", f);
+    writeJSONString(f, jsonLabel);
+    fprintf(f, ",\"passes\":%d,\"loops\":%d,\"ops_per_loop\":%ld,\"events_per_loop\":%ld",
+            (int)passes, (int)loops, ops, events);
+    fprintf(f, ",\"min_sec\":%.6g,\"avg_sec\":%.6g,\"ns_per_op\":%.6g,\"ops_per_sec\":%.6g",
+            min_t, avg_t, ns_per_op, ns_per_op > 0 ? 1E9/ns_per_op : 0.0);
+    if (events > 0) {
+        fprintf(f, ",\"ns_per_event\":%.6g", (min_t*1E9)/((double)loops*events));
+    }
+    fprintf(f, ",\"max_rss_kb\":%ld}\n", getMaxRSSKilobytes());
+    fclose(f);
+}
+
 UPerfTest::UPerfTest(int32_t argc, const char* argv[], UErrorCode& status)
         : _argc(argc), _argv(argv), _addUsage(NULL),
           ucharBuf(NULL), encoding(""),
@@ -184,6 +277,14 @@ void UPerfTest::init(UOption addOptions[], int32_t addOptionsCount,
         locale = options[LOCALE].value;
     }
 
+    if(options[JSON].doesOccur) {
+        jsonFileName = options[JSON].value;
+    }
+
+    if(options[JSON_LABEL].doesOccur) {
+        jsonLabel = options[JSON_LABEL].value;
+    }
+
     int32_t len = 0;
     if(fileName!=NULL){
         //pre-flight
@@ -445,6 +546,10 @@ UBool UPerfTest::runTestLoop( char* testname, char* par )
                     }
                 }
             }
+            if(jsonFileName != NULL && U_SUCCESS(status) && loops > 0) {
+                writeJSONResult(_argv[0], name, fileName, locale,
+                                passes, loops, ops, events, min_t, sum_t/passes);
+            }
             if(verbose && U_SUCCESS(status)) {
                 double avg_t = sum_t/passes;
                 if (loops == 0 || ops == 0) {
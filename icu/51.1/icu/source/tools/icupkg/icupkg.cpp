@@ -1,7 +1,7 @@
 /*
 *******************************************************************************
 *
-*   Copyright (C) 2005-2012, International Business Machines
+*   Copyright (C) 2005-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 *******************************************************************************
@@ -57,7 +57,7 @@ printUsage(const char *pname, UBool isHelp) {
 
     fprintf(where,
             "%csage: %s [-h|-?|--help ] [-tl|-tb|-te] [-c] [-C comment]\n"
-            "\t[-a list] [-r list] [-x list] [-l [-o outputListFileName]]\n"
+            "\t[-a list] [-r list] [-k list] [-x list] [-l [-o outputListFileName]]\n"
             "\t[-s path] [-d path] [-w] [-m mode]\n"
             "\tinfilename [outfilename]\n",
             isHelp ? 'U' : 'u', pname);
@@ -67,7 +67,7 @@ printUsage(const char *pname, UBool isHelp) {
             "Read the input ICU .dat package file, modify it according to the options,\n"
             "swap it to the desired platform properties (charset & endianness),\n"
             "and optionally write the resulting ICU .dat package to the output file.\n"
-            "Items are removed, then added, then extracted and listed.\n"
+            "Items are removed, then kept, then added, then extracted and listed.\n"
             "An ICU .dat package is written if items are removed or added,\n"
             "or if the input and output filenames differ,\n"
             "or if the --writepkg (-w) option is set.\n");
@@ -105,10 +105,15 @@ printUsage(const char *pname, UBool isHelp) {
             "\n"
             "\t-a list or --add list      add items to the package\n"
             "\t-r list or --remove list   remove items from the package\n"
+            "\t-k list or --keep list     remove all items except the listed ones\n"
+            "\t                           and the items they depend on\n"
             "\t-x list or --extract list  extract items from the package\n"
             "\tThe list can be a single item's filename,\n"
             "\tor a .txt filename with a list of item filenames,\n"
-            "\tor an ICU .dat package filename.\n");
+            "\tor an ICU .dat package filename.\n"
+            "\tA list of the items that an application uses is written by ICU\n"
+            "\tif the ICU_DATA_USAGE_LOG environment variable names a .txt file;\n"
+            "\tuse it with --keep to build a package with only those items.\n");
         fprintf(where,
             "\n"
             "\t-w or --writepkg  write the output package even if no items are removed\n"
@@ -172,6 +177,7 @@ static UOption options[]={
 
     UOPTION_DEF("add", 'a', UOPT_REQUIRES_ARG),
     UOPTION_DEF("remove", 'r', UOPT_REQUIRES_ARG),
+    UOPTION_DEF("keep", 'k', UOPT_REQUIRES_ARG),
     UOPTION_DEF("extract", 'x', UOPT_REQUIRES_ARG),
 
     UOPTION_DEF("list", 'l', UOPT_NO_ARG),
@@ -196,6 +202,7 @@ enum {
 
     OPT_ADD_LIST,
     OPT_REMOVE_LIST,
+    OPT_KEEP_LIST,
     OPT_EXTRACT_LIST,
 
     OPT_LIST_ITEMS,
@@ -335,6 +342,7 @@ main(int argc, char *argv[]) {
             options[OPT_COPYRIGHT].doesOccur ||
             options[OPT_MATCHMODE].doesOccur ||
             options[OPT_REMOVE_LIST].doesOccur ||
+            options[OPT_KEEP_LIST].doesOccur ||
             options[OPT_ADD_LIST].doesOccur ||
             options[OPT_EXTRACT_LIST].doesOccur ||
             options[OPT_LIST_ITEMS].doesOccur
@@ -386,6 +394,23 @@ main(int argc, char *argv[]) {
         }
     }
 
+    /* keep only the listed items */
+    if(options[OPT_KEEP_LIST].doesOccur) {
+        listPkg=new Package();
+        if(listPkg==NULL) {
+            fprintf(stderr, "icupkg: not enough memory\n");
+            exit(U_MEMORY_ALLOCATION_ERROR);
+        }
+        if(readList(NULL, options[OPT_KEEP_LIST].value, FALSE, listPkg)) {
+            pkg->keepItems(*listPkg);
+            delete listPkg;
+            isModified=TRUE;
+        } else {
+            printUsage(pname, FALSE);
+            return U_ILLEGAL_ARGUMENT_ERROR;
+        }
+    }
+
     /*
      * add items
      * use a separate Package so that its memory and items stay around
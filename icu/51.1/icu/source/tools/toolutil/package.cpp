@@ -1,7 +1,7 @@
 /*
 *******************************************************************************
 *
-*   Copyright (C) 1999-2012, International Business Machines
+*   Copyright (C) 1999-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 *******************************************************************************
@@ -1070,6 +1070,71 @@ Package::removeItems(const Package &listPkg) {
     }
 }
 
+// state for keepItems()
+struct KeepItemsContext {
+    const Package *pkg;
+    UBool *isKept;
+    int32_t *stack;
+    int32_t top;
+};
+
+static void
+keepDependency(void *context, const char * /*itemName*/, const char *targetName) {
+    KeepItemsContext *ctx=(KeepItemsContext *)context;
+    int32_t idx=ctx->pkg->findItem(targetName);
+    if(idx>=0 && !ctx->isKept[idx]) {
+        ctx->isKept[idx]=TRUE;
+        ctx->stack[ctx->top++]=idx;
+    }
+}
+
+void
+Package::keepItems(const Package &listPkg) {
+    KeepItemsContext ctx;
+    const Item *pItem;
+    int32_t i, idx;
+
+    if(itemCount==0) {
+        return;
+    }
+    ctx.pkg=this;
+    ctx.isKept=(UBool *)uprv_malloc(itemCount*sizeof(UBool));
+    ctx.stack=(int32_t *)uprv_malloc(itemCount*sizeof(int32_t));
+    ctx.top=0;
+    if(ctx.isKept==NULL || ctx.stack==NULL) {
+        fprintf(stderr, "icupkg: Out of memory trying to allocate %lu bytes for %d items\n",
+                (unsigned long)(itemCount*(sizeof(UBool)+sizeof(int32_t))), (int)itemCount);
+        exit(U_MEMORY_ALLOCATION_ERROR);
+    }
+    uprv_memset(ctx.isKept, 0, itemCount*sizeof(UBool));
+
+    // mark the listed items
+    for(pItem=listPkg.items, i=0; i<listPkg.itemCount; ++pItem, ++i) {
+        findItems(pItem->name);
+        while((idx=findNextItem())>=0) {
+            if(!ctx.isKept[idx]) {
+                ctx.isKept[idx]=TRUE;
+                ctx.stack[ctx.top++]=idx;
+            }
+        }
+    }
+
+    // mark what they depend on, and what that depends on
+    while(ctx.top>0) {
+        idx=ctx.stack[--ctx.top];
+        enumDependencies(items+idx, &ctx, keepDependency);
+    }
+
+    // remove the others, from the end so that the indexes stay valid
+    for(idx=itemCount-1; idx>=0; --idx) {
+        if(!ctx.isKept[idx]) {
+            removeItem(idx);
+        }
+    }
+    uprv_free(ctx.isKept);
+    uprv_free(ctx.stack);
+}
+
 void
 Package::extractItem(const char *filesPath, const char *outName, int32_t idx, char outType) {
     char filename[1024];
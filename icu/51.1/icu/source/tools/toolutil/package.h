@@ -1,7 +1,7 @@
 /*
 *******************************************************************************
 *
-*   Copyright (C) 2005-2010, International Business Machines
+*   Copyright (C) 2005-2013, International Business Machines
 *   Corporation and others.  All Rights Reserved.
 *
 *******************************************************************************
@@ -100,6 +100,12 @@ public:
     void removeItems(const char *pattern);
     void removeItems(const Package &listPkg);
 
+    /*
+     * Remove all items except those matching the listPkg item names,
+     * and the items that those depend on.
+     */
+    void keepItems(const Package &listPkg);
+
     /* The extractItem() functions accept outputType=0 to mean "don't swap the item". */
     void extractItem(const char *filesPath, int32_t itemIndex, char outType);
     void extractItems(const char *filesPath, const char *pattern, char outType);
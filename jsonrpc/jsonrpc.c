@@ -2,10 +2,102 @@
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
+#include <time.h>
 
 #include "jansson.h"
 #include "jsonrpc.h"
 
+/*
+ * Compiled params_spec: the json_unpack format of a method, parsed once into
+ * its values in prefix order. A container node is followed by the nodes of
+ * its items and knows the size of its subtree.
+ *
+ * As params_spec is used without arguments, object formats cannot name keys;
+ * a spec with anything that has no node here is left to json_unpack_ex.
+ */
+struct jsonrpc_spec_node_t
+{
+	char type;		// s n b i I f F o O [ {
+	char strict;		// '!' closes the container
+	unsigned short count;	// items of an array
+	unsigned short size;	// nodes of the subtree, this one included
+};
+
+struct jsonrpc_spec_t
+{
+	size_t n;
+	struct jsonrpc_spec_node_t nodes[];
+};
+
+struct jsonrpc_method_slot_t
+{
+	const struct jsonrpc_method_entry_t *entry;	// NULL for an empty slot
+	unsigned int hash;
+	struct jsonrpc_spec_t *spec;			// NULL if not compiled
+};
+
+// Hash index of a method table, owned by a dispatcher or a pool
+struct jsonrpc_index_t
+{
+	struct jsonrpc_pool_t *pool;	// runs the calls, if not NULL
+	size_t mask;
+	struct jsonrpc_method_slot_t slots[];
+};
+
+struct jsonrpc_dispatcher_t
+{
+	struct jsonrpc_index_t *index;
+	int owns_index;
+	char *output;
+	size_t output_len;
+	size_t output_size;
+};
+
+// latency buckets by log2 of the call time in us
+#define JSONRPC_LATENCY_BUCKETS 24
+
+struct jsonrpc_counters_t
+{
+	unsigned long calls;
+	unsigned long errors;
+	unsigned long long total_us;
+	unsigned int max_us;
+	unsigned int buckets[JSONRPC_LATENCY_BUCKETS];
+};
+
+// A batch request whose elements are run by the pool threads and its caller
+struct jsonrpc_batch_t
+{
+	struct jsonrpc_batch_t *next;
+	json_t *request;
+	json_t **responses;	// by element, NULL for a notification
+	size_t len;
+	size_t taken;
+	size_t done;
+};
+
+struct jsonrpc_pool_t
+{
+	struct jsonrpc_index_t *index;
+	pthread_mutex_t mutex;
+	pthread_cond_t work;		// a batch was queued, or stop
+	pthread_cond_t done;		// a batch element finished
+	pthread_cond_t slot;		// a method call finished
+	struct jsonrpc_batch_t *batches;	// with elements left to take, oldest first
+	int running;
+	int max_concurrent;
+	int stop;
+	int nthreads;
+	pthread_t *threads;
+	struct jsonrpc_counters_t *counters;	// by index slot
+};
+
+static int pool_call(struct jsonrpc_pool_t *pool, const struct jsonrpc_method_slot_t *slot,
+		json_t *json_params, json_t **json_result);
+static void pool_run_batch(struct jsonrpc_pool_t *pool, json_t *json_request, json_t **responses, size_t len);
+
+
 json_t *jsonrpc_error_object(int code, json_t *data)
 {
 	// reference to data is stolen
@@ -71,7 +163,9 @@ json_t *jsonrpc_error_object(int code, json_t *data)
 		    break;
 	}
 	
-	json_t *json = json_pack("{s:i,s:s}", "code", code, "message", message);
+	json_t *json = json_object();
+	json_object_set_new(json, "code", json_integer(code));
+	json_object_set_new(json, "message", json_string(message));
 	if (data) {
 		json_object_set_new(json, "data", data);
 	}
@@ -91,10 +185,10 @@ json_t *jsonrpc_error_response(json_t *json_id, json_t *json_error)
 	
 	json_error = json_error ? json_error : json_null();
 	
-	json_t *response = json_pack("{s:s,s:o,s:o}",
-		"jsonrpc", "2.0",
-		"id", json_id,
-		"error", json_error);
+	json_t *response = json_object();
+	json_object_set_new(response, "jsonrpc", json_string("2.0"));
+	json_object_set_new(response, "id", json_id);
+	json_object_set_new(response, "error", json_error);
 	return response;
 }
 
@@ -116,18 +210,37 @@ json_t *jsonrpc_result_response(json_t *json_id, json_t *json_result)
 		"id", json_id,
 		"result", json_result);
 #endif		
-    json_t *response = json_pack("{s:o,s:o}",
-		"id", json_id,
-		"result", json_result);
+	json_t *response = json_object();
+	json_object_set_new(response, "id", json_id);
+	json_object_set_new(response, "result", json_result);
 	return response;
 }
 
+static const char *jsonrpc_type_name(const json_t *json)
+{
+	switch (json_typeof(json)) {
+		case JSON_OBJECT: return "object";
+		case JSON_ARRAY: return "array";
+		case JSON_STRING: return "string";
+		case JSON_INTEGER: return "integer";
+		case JSON_REAL: return "real";
+		case JSON_TRUE: return "true";
+		case JSON_FALSE: return "false";
+		case JSON_NULL: return "null";
+	}
+	return "unknown";
+}
+
+// The validation message of json_unpack for a value of the wrong type
+static json_t *json_pack_type_error(const char *expected, const json_t *json)
+{
+	char text[JSON_ERROR_TEXT_LENGTH];
+	snprintf(text, sizeof(text), "Expected %s, got %s", expected, jsonrpc_type_name(json));
+	return json_string(text);
+}
+
 json_t *jsonrpc_validate_request(json_t *json_request, const char **str_method, json_t **json_params, json_t **json_id)
 {
-	size_t flags = 0;
-	json_error_t error;
-	const char *str_version = NULL;
-	int rc;
 	json_t *data = NULL;
 	int valid_id = 0;
 	
@@ -143,16 +256,25 @@ json_t *jsonrpc_validate_request(json_t *json_request, const char **str_method,
 		"id", json_id
 	);
 #endif
-    rc = json_unpack_ex(json_request, &error, flags, "{s:s,s?o,s?o}",
-		"method", str_method,
-		"params", json_params,
-		"id", json_id
-	);
-    
-	if (rc==-1) {
-		data = json_string(error.text);
+	// as json_unpack_ex(json_request, &error, flags, "{s:s,s?o,s?o}", ...) would,
+	// without parsing the format on every request
+	if (!json_is_object(json_request)) {
+		data = json_pack_type_error("object", json_request);
+		goto invalid;
+	}
+	json_t *json_method = json_object_get(json_request, "method");
+	if (!json_method) {
+		data = json_string("Object item not found: method");
 		goto invalid;
 	}
+	if (!json_is_string(json_method)) {
+		data = json_pack_type_error("string", json_method);
+		goto invalid;
+	}
+	*str_method = json_string_value(json_method);
+	*json_params = json_object_get(json_request, "params");
+	*json_id = json_object_get(json_request, "id");
+
 #if 0  /* Ignore this checking. */	
 	if (0!=strcmp(str_version, "2.0")) {
 		data = json_string("\"jsonrpc\" MUST be exactly \"2.0\"");
@@ -213,7 +335,219 @@ json_t *jsonrpc_validate_params(json_t *json_params, const char *params_spec)
 	return data ? jsonrpc_error_object(JSONRPC_INVALID_PARAMS, data) : NULL;
 }
 
-json_t *jsonrpc_handle_request_single(json_t *json_request, struct jsonrpc_method_entry_t method_table[])
+static const char *spec_skip(const char *fmt)
+{
+	// json_unpack ignores whitespace, ',' and ':' between tokens
+	while (*fmt==' ' || *fmt=='\t' || *fmt=='\n' || *fmt==',' || *fmt==':')
+		fmt++;
+	return fmt;
+}
+
+// Appends the nodes of the value at *fmt to spec; returns -1 if it has none
+static int spec_compile_value(const char **fmt, struct jsonrpc_spec_t *spec, size_t max)
+{
+	const char *p = spec_skip(*fmt);
+	size_t idx = spec->n;
+	struct jsonrpc_spec_node_t *node;
+
+	if (idx >= max || !*p)
+		return -1;
+	node = &spec->nodes[spec->n++];
+	memset(node, 0, sizeof(*node));
+	node->type = *p;
+
+	switch (*p++) {
+		case 's': case 'n': case 'b': case 'i': case 'I':
+		case 'f': case 'F': case 'o': case 'O':
+			break;
+		case '[':
+			while (*(p = spec_skip(p)) != ']') {
+				if (*p=='!' || *p=='*') {
+					spec->nodes[idx].strict = *p++=='!';
+					if (*(p = spec_skip(p)) != ']')
+						return -1;
+					break;
+				}
+				if (spec_compile_value(&p, spec, max) != 0)
+					return -1;
+				spec->nodes[idx].count++;
+			}
+			p++;
+			break;
+		case '{':
+			p = spec_skip(p);
+			if (*p=='!' || *p=='*')
+				node->strict = *p++=='!';
+			if (*(p = spec_skip(p)) != '}')
+				return -1;
+			p++;
+			break;
+		default:
+			return -1;
+	}
+	spec->nodes[idx].size = spec->n - idx;
+	*fmt = p;
+	return 0;
+}
+
+// Parses params_spec once, or returns NULL if it is to be left to json_unpack_ex
+static struct jsonrpc_spec_t *spec_compile(const char *params_spec)
+{
+	size_t max = strlen(params_spec);
+	struct jsonrpc_spec_t *spec;
+	const char *fmt = params_spec;
+
+	if (max==0 || max > 0xffff)
+		return NULL;
+	spec = malloc(sizeof(*spec) + max * sizeof(spec->nodes[0]));
+	if (!spec)
+		return NULL;
+	spec->n = 0;
+	if (spec_compile_value(&fmt, spec, max) != 0 || *spec_skip(fmt)) {
+		free(spec);
+		return NULL;
+	}
+	return spec;
+}
+
+// Validates json against the subtree at node, as json_unpack_ex with JSON_VALIDATE_ONLY
+static json_t *spec_validate(const json_t *json, const struct jsonrpc_spec_node_t *node)
+{
+	char text[JSON_ERROR_TEXT_LENGTH];
+	const struct jsonrpc_spec_node_t *item;
+	size_t k;
+
+	switch (node->type) {
+		case 's':
+			return json_is_string(json) ? NULL : json_pack_type_error("string", json);
+		case 'n':
+			return json_is_null(json) ? NULL : json_pack_type_error("null", json);
+		case 'b':
+			return json_is_boolean(json) ? NULL : json_pack_type_error("true or false", json);
+		case 'i': case 'I':
+			return json_is_integer(json) ? NULL : json_pack_type_error("integer", json);
+		case 'f':
+			return json_is_real(json) ? NULL : json_pack_type_error("real", json);
+		case 'F':
+			return json_is_number(json) ? NULL : json_pack_type_error("real or integer", json);
+		case 'o': case 'O':
+			return NULL;
+		case '{':
+			if (!json_is_object(json))
+				return json_pack_type_error("object", json);
+			if (node->strict && json_object_size(json) > 0) {
+				snprintf(text, sizeof(text), "%lu object item(s) left unpacked",
+					(unsigned long)json_object_size(json));
+				return json_string(text);
+			}
+			return NULL;
+		case '[':
+			if (!json_is_array(json))
+				return json_pack_type_error("array", json);
+			item = node + 1;
+			for (k=0; k < node->count; k++) {
+				json_t *value = json_array_get(json, k);
+				json_t *data;
+				if (!value) {
+					snprintf(text, sizeof(text), "Array index %lu out of range", (unsigned long)k);
+					return json_string(text);
+				}
+				data = spec_validate(value, item);
+				if (data)
+					return data;
+				item += item->size;
+			}
+			if (node->strict && json_array_size(json) > node->count) {
+				snprintf(text, sizeof(text), "%lu array item(s) left unpacked",
+					(unsigned long)(json_array_size(json) - node->count));
+				return json_string(text);
+			}
+			return NULL;
+	}
+	return NULL;
+}
+
+// jsonrpc_validate_params with the spec compiled, if it could be
+static json_t *jsonrpc_validate_params_slot(json_t *json_params, const struct jsonrpc_method_slot_t *slot)
+{
+	json_t *data;
+
+	if (!slot->spec || !json_params)
+		return jsonrpc_validate_params(json_params, slot->entry->params_spec);
+	data = spec_validate(json_params, slot->spec->nodes);
+	return data ? jsonrpc_error_object(JSONRPC_INVALID_PARAMS, data) : NULL;
+}
+
+static unsigned int method_hash(const char *name)
+{
+	// FNV-1a
+	unsigned int hash = 2166136261u;
+	while (*name) {
+		hash ^= (unsigned char)*name++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static struct jsonrpc_index_t *index_build(struct jsonrpc_method_entry_t method_table[])
+{
+	struct jsonrpc_method_entry_t *entry;
+	struct jsonrpc_index_t *index;
+	size_t size = 4;
+	size_t n = 0;
+
+	for (entry=method_table; entry->name!=NULL; entry++)
+		n++;
+	while (size < n * 2)
+		size *= 2;
+
+	index = calloc(1, sizeof(*index) + size * sizeof(index->slots[0]));
+	if (!index)
+		return NULL;
+	index->mask = size - 1;
+
+	for (entry=method_table; entry->name!=NULL; entry++) {
+		unsigned int hash = method_hash(entry->name);
+		size_t k = hash & index->mask;
+		// the first entry of a name wins, as with the linear scan
+		while (index->slots[k].entry && 0!=strcmp(index->slots[k].entry->name, entry->name))
+			k = (k + 1) & index->mask;
+		if (index->slots[k].entry)
+			continue;
+		index->slots[k].entry = entry;
+		index->slots[k].hash = hash;
+		if (entry->params_spec)
+			index->slots[k].spec = spec_compile(entry->params_spec);
+	}
+	return index;
+}
+
+static void index_free(struct jsonrpc_index_t *index)
+{
+	size_t k;
+
+	if (!index)
+		return;
+	for (k=0; k <= index->mask; k++)
+		free(index->slots[k].spec);
+	free(index);
+}
+
+static const struct jsonrpc_method_slot_t *index_find(const struct jsonrpc_index_t *index, const char *name)
+{
+	unsigned int hash = method_hash(name);
+	size_t k = hash & index->mask;
+
+	for (; index->slots[k].entry; k = (k + 1) & index->mask) {
+		if (index->slots[k].hash==hash && 0==strcmp(index->slots[k].entry->name, name))
+			return &index->slots[k];
+	}
+	return NULL;
+}
+
+// With index NULL, methods are looked up in method_table as before
+static json_t *handle_request_single(json_t *json_request, const struct jsonrpc_index_t *index,
+		struct jsonrpc_method_entry_t method_table[])
 {
 	int rc;
 	json_t *json_response;
@@ -227,19 +561,28 @@ json_t *jsonrpc_handle_request_single(json_t *json_request, struct jsonrpc_metho
 
 	int is_notification = json_id==NULL;
 	
-	struct jsonrpc_method_entry_t *entry;
-	for (entry=method_table; entry->name!=NULL; entry++) {
-		if (0==strcmp(entry->name, str_method))
-			break;
+	const struct jsonrpc_method_slot_t *slot = NULL;
+	const struct jsonrpc_method_entry_t *entry;
+	if (index) {
+		slot = index_find(index, str_method);
+		entry = slot ? slot->entry : NULL;
+	} else {
+		for (entry=method_table; entry->name!=NULL; entry++) {
+			if (0==strcmp(entry->name, str_method))
+				break;
+		}
+		if (entry->name==NULL)
+			entry = NULL;
 	}
-	if (entry->name==NULL) {
+	if (entry==NULL) {
 		json_response = jsonrpc_error_response(json_id,
 				jsonrpc_error_object(JSONRPC_METHOD_NOT_FOUND, NULL));
 		goto done;
 	}
 	
 	if (entry->params_spec) {
-		json_t *error_obj = jsonrpc_validate_params(json_params, entry->params_spec);
+		json_t *error_obj = slot ? jsonrpc_validate_params_slot(json_params, slot)
+				: jsonrpc_validate_params(json_params, entry->params_spec);
 		if (error_obj) {
 			json_response = jsonrpc_error_response(json_id, error_obj);
 			goto done;
@@ -248,7 +591,10 @@ json_t *jsonrpc_handle_request_single(json_t *json_request, struct jsonrpc_metho
 	
 	json_response = NULL;
 	json_result = NULL;
-	rc = entry->funcptr(json_params, &json_result);
+	if (slot && index->pool)
+		rc = pool_call(index->pool, slot, json_params, &json_result);
+	else
+		rc = entry->funcptr(json_params, &json_result);
 	if (is_notification) {
 		json_decref(json_result);
 		json_result = NULL;
@@ -272,11 +618,16 @@ done:
 	return json_response;
 }
 
-char *jsonrpc_handler(const char *input, size_t input_len, struct jsonrpc_method_entry_t method_table[])
+json_t *jsonrpc_handle_request_single(json_t *json_request, struct jsonrpc_method_entry_t method_table[])
+{
+	return handle_request_single(json_request, NULL, method_table);
+}
+
+static json_t *handle_input(const char *input, size_t input_len, const struct jsonrpc_index_t *index,
+		struct jsonrpc_method_entry_t method_table[])
 {
 	json_t *json_request, *json_response;
 	json_error_t error;
-	char *output = NULL;
 	
 	json_request = json_loadb(input, input_len, 0, &error);
 	if (!json_request) {
@@ -287,12 +638,31 @@ char *jsonrpc_handler(const char *input, size_t input_len, struct jsonrpc_method
 		if (len==0) {
 			json_response = jsonrpc_error_response(NULL,
 					jsonrpc_error_object(JSONRPC_INVALID_REQUEST, NULL));
+		} else if (len > 1 && index && index->pool && index->pool->nthreads > 0) {
+			json_t **responses = calloc(len, sizeof(json_t *));
+			int k;
+			json_response = NULL;
+			if (!responses) {
+				json_response = jsonrpc_error_response(NULL,
+						jsonrpc_error_object(JSONRPC_INTERNAL_ERROR, NULL));
+			} else {
+				// elements run in parallel; their responses keep the request order
+				pool_run_batch(index->pool, json_request, responses, len);
+				for (k=0; k < len; k++) {
+					if (responses[k]) {
+						if (!json_response)
+							json_response = json_array();
+						json_array_append_new(json_response, responses[k]);
+					}
+				}
+				free(responses);
+			}
 		} else {
 			int k;
 			json_response = NULL;
 			for (k=0; k < len; k++) {
 				json_t *req = json_array_get(json_request, k);
-				json_t *rep = jsonrpc_handle_request_single(req, method_table);
+				json_t *rep = handle_request_single(req, index, method_table);
 				if (rep) {
 					if (!json_response)
 						json_response = json_array();
@@ -301,10 +671,294 @@ char *jsonrpc_handler(const char *input, size_t input_len, struct jsonrpc_method
 			}
 		}
 	} else {
-		json_response = jsonrpc_handle_request_single(json_request, method_table);
+		json_response = handle_request_single(json_request, index, method_table);
 	}
 	
-	if (json_response)
+	json_decref(json_request);
+	return json_response;
+}
+
+char *jsonrpc_handler(const char *input, size_t input_len, struct jsonrpc_method_entry_t method_table[])
+{
+	json_t *json_response = handle_input(input, input_len, NULL, method_table);
+	char *output = NULL;
+	
+	if (json_response) {
 		output = json_dumps(json_response, JSON_INDENT(0));
+		json_decref(json_response);
+	}
+	return output;
+}
+
+struct jsonrpc_dispatcher_t *jsonrpc_dispatcher_new(struct jsonrpc_method_entry_t method_table[])
+{
+	struct jsonrpc_dispatcher_t *dispatcher = calloc(1, sizeof(*dispatcher));
+	if (!dispatcher)
+		return NULL;
+	dispatcher->index = index_build(method_table);
+	if (!dispatcher->index) {
+		free(dispatcher);
+		return NULL;
+	}
+	dispatcher->owns_index = 1;
+	return dispatcher;
+}
+
+void jsonrpc_dispatcher_free(struct jsonrpc_dispatcher_t *dispatcher)
+{
+	if (dispatcher) {
+		if (dispatcher->owns_index)
+			index_free(dispatcher->index);
+		free(dispatcher->output);
+		free(dispatcher);
+	}
+}
+
+static int dispatcher_append(const char *buffer, size_t size, void *data)
+{
+	struct jsonrpc_dispatcher_t *dispatcher = data;
+	
+	if (dispatcher->output_len + size + 1 > dispatcher->output_size) {
+		size_t output_size = dispatcher->output_size ? dispatcher->output_size : 256;
+		char *output;
+		while (dispatcher->output_len + size + 1 > output_size)
+			output_size *= 2;
+		output = realloc(dispatcher->output, output_size);
+		if (!output)
+			return -1;
+		dispatcher->output = output;
+		dispatcher->output_size = output_size;
+	}
+	memcpy(dispatcher->output + dispatcher->output_len, buffer, size);
+	dispatcher->output_len += size;
+	return 0;
+}
+
+const char *jsonrpc_dispatch(struct jsonrpc_dispatcher_t *dispatcher, const char *input, size_t input_len, size_t *output_len)
+{
+	json_t *json_response = handle_input(input, input_len, dispatcher->index, NULL);
+	const char *output = NULL;
+	
+	dispatcher->output_len = 0;
+	if (json_response) {
+		if (json_dump_callback(json_response, dispatcher_append, dispatcher, JSON_INDENT(0))==0) {
+			dispatcher->output[dispatcher->output_len] = '\0';
+			output = dispatcher->output;
+		}
+		json_decref(json_response);
+	}
+	if (output_len)
+		*output_len = output ? dispatcher->output_len : 0;
 	return output;
 }
+
+static unsigned int elapsed_us(const struct timespec *t0)
+{
+	struct timespec t1;
+	long long us;
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	us = (t1.tv_sec - t0->tv_sec) * 1000000LL + (t1.tv_nsec - t0->tv_nsec) / 1000;
+	return us > 0 ? (unsigned int)us : 0;
+}
+
+static int pool_call(struct jsonrpc_pool_t *pool, const struct jsonrpc_method_slot_t *slot,
+		json_t *json_params, json_t **json_result)
+{
+	struct jsonrpc_counters_t *counters = &pool->counters[slot - pool->index->slots];
+	struct timespec t0;
+	unsigned int us;
+	int bucket = 0;
+	int rc;
+
+	pthread_mutex_lock(&pool->mutex);
+	while (pool->max_concurrent > 0 && pool->running >= pool->max_concurrent)
+		pthread_cond_wait(&pool->slot, &pool->mutex);
+	pool->running++;
+	pthread_mutex_unlock(&pool->mutex);
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	rc = slot->entry->funcptr(json_params, json_result);
+	us = elapsed_us(&t0);
+	while (bucket < JSONRPC_LATENCY_BUCKETS - 1 && (us + 1) >> (bucket + 1))
+		bucket++;
+
+	pthread_mutex_lock(&pool->mutex);
+	pool->running--;
+	pthread_cond_signal(&pool->slot);
+	counters->calls++;
+	if (rc != 0)
+		counters->errors++;
+	counters->total_us += us;
+	if (us > counters->max_us)
+		counters->max_us = us;
+	counters->buckets[bucket]++;
+	pthread_mutex_unlock(&pool->mutex);
+	return rc;
+}
+
+// Takes the next element of batch and runs it; called and returns with the mutex held
+static void pool_run_element(struct jsonrpc_pool_t *pool, struct jsonrpc_batch_t *batch)
+{
+	size_t k = batch->taken++;
+	json_t *rep;
+
+	if (batch->taken == batch->len) {
+		struct jsonrpc_batch_t **p = &pool->batches;
+		while (*p != batch)
+			p = &(*p)->next;
+		*p = batch->next;
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	rep = handle_request_single(json_array_get(batch->request, k), pool->index, NULL);
+	pthread_mutex_lock(&pool->mutex);
+	batch->responses[k] = rep;
+	if (++batch->done == batch->len)
+		pthread_cond_broadcast(&pool->done);
+}
+
+static void pool_run_batch(struct jsonrpc_pool_t *pool, json_t *json_request, json_t **responses, size_t len)
+{
+	struct jsonrpc_batch_t batch = { NULL, json_request, responses, len, 0, 0 };
+	struct jsonrpc_batch_t **p;
+
+	pthread_mutex_lock(&pool->mutex);
+	for (p = &pool->batches; *p; p = &(*p)->next)
+		;
+	*p = &batch;
+	pthread_cond_broadcast(&pool->work);
+	// the caller takes elements too, so a batch never waits for a free thread
+	while (batch.taken < batch.len)
+		pool_run_element(pool, &batch);
+	while (batch.done < batch.len)
+		pthread_cond_wait(&pool->done, &pool->mutex);
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+static void *pool_thread(void *arg)
+{
+	struct jsonrpc_pool_t *pool = arg;
+
+	pthread_mutex_lock(&pool->mutex);
+	for (;;) {
+		while (!pool->stop && !pool->batches)
+			pthread_cond_wait(&pool->work, &pool->mutex);
+		if (pool->stop)
+			break;
+		pool_run_element(pool, pool->batches);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	return NULL;
+}
+
+struct jsonrpc_pool_t *jsonrpc_pool_new(struct jsonrpc_method_entry_t method_table[], const struct jsonrpc_pool_config_t *config)
+{
+	struct jsonrpc_pool_t *pool = calloc(1, sizeof(*pool));
+	int k;
+
+	if (!pool)
+		return NULL;
+	pool->index = index_build(method_table);
+	if (!pool->index) {
+		free(pool);
+		return NULL;
+	}
+	pool->index->pool = pool;
+	pool->counters = calloc(pool->index->mask + 1, sizeof(pool->counters[0]));
+	pool->threads = calloc(config && config->workers > 0 ? config->workers : 1, sizeof(pthread_t));
+	if (!pool->counters || !pool->threads) {
+		index_free(pool->index);
+		free(pool->counters);
+		free(pool->threads);
+		free(pool);
+		return NULL;
+	}
+	pool->max_concurrent = config ? config->max_concurrent : 0;
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->work, NULL);
+	pthread_cond_init(&pool->done, NULL);
+	pthread_cond_init(&pool->slot, NULL);
+
+	for (k=0; config && k < config->workers; k++) {
+		if (pthread_create(&pool->threads[k], NULL, pool_thread, pool) != 0)
+			break;
+		pool->nthreads++;
+	}
+	return pool;
+}
+
+void jsonrpc_pool_free(struct jsonrpc_pool_t *pool)
+{
+	int k;
+
+	if (!pool)
+		return;
+	pthread_mutex_lock(&pool->mutex);
+	pool->stop = 1;
+	pthread_cond_broadcast(&pool->work);
+	pthread_mutex_unlock(&pool->mutex);
+	for (k=0; k < pool->nthreads; k++)
+		pthread_join(pool->threads[k], NULL);
+
+	pthread_cond_destroy(&pool->slot);
+	pthread_cond_destroy(&pool->done);
+	pthread_cond_destroy(&pool->work);
+	pthread_mutex_destroy(&pool->mutex);
+	index_free(pool->index);
+	free(pool->counters);
+	free(pool->threads);
+	free(pool);
+}
+
+struct jsonrpc_dispatcher_t *jsonrpc_pool_dispatcher_new(struct jsonrpc_pool_t *pool)
+{
+	struct jsonrpc_dispatcher_t *dispatcher = calloc(1, sizeof(*dispatcher));
+	if (!dispatcher)
+		return NULL;
+	dispatcher->index = pool->index;
+	return dispatcher;
+}
+
+// Upper bound of the bucket holding the given fraction (in %) of the calls
+static unsigned int counters_percentile(const struct jsonrpc_counters_t *counters, int percent)
+{
+	unsigned long rank = (counters->calls * percent + 99) / 100;
+	unsigned long seen = 0;
+	int k;
+
+	for (k=0; k < JSONRPC_LATENCY_BUCKETS; k++) {
+		seen += counters->buckets[k];
+		if (seen >= rank)
+			break;
+	}
+	if (k >= JSONRPC_LATENCY_BUCKETS - 1)
+		return counters->max_us;
+	return ((2u << k) - 1) < counters->max_us ? ((2u << k) - 1) : counters->max_us;
+}
+
+int jsonrpc_pool_get_stats(struct jsonrpc_pool_t *pool, struct jsonrpc_method_stats_t stats[], int max, int reset)
+{
+	struct jsonrpc_index_t *index = pool->index;
+	size_t k;
+	int n = 0;
+
+	pthread_mutex_lock(&pool->mutex);
+	for (k=0; k <= index->mask; k++) {
+		struct jsonrpc_counters_t *counters = &pool->counters[k];
+		if (!index->slots[k].entry || counters->calls==0)
+			continue;
+		if (n < max) {
+			stats[n].name = index->slots[k].entry->name;
+			stats[n].calls = counters->calls;
+			stats[n].errors = counters->errors;
+			stats[n].avg_us = (unsigned int)(counters->total_us / counters->calls);
+			stats[n].p50_us = counters_percentile(counters, 50);
+			stats[n].p99_us = counters_percentile(counters, 99);
+			stats[n].max_us = counters->max_us;
+		}
+		n++;
+		if (reset)
+			memset(counters, 0, sizeof(*counters));
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	return n;
+}
@@ -29,4 +29,61 @@ struct jsonrpc_method_entry_t
 };
 char *jsonrpc_handler(const char *input, size_t input_len, struct jsonrpc_method_entry_t method_table[]);
 
+/*
+ * A dispatcher serves requests for one method table like jsonrpc_handler,
+ * but serializes the response into a buffer of its own that is reused from
+ * call to call. Methods are looked up in a hash index, and their params_spec
+ * is parsed only once; both are built by jsonrpc_dispatcher_new, so the
+ * method table must not change while the dispatcher is in use.
+ *
+ * A dispatcher is used by one thread at a time, e.g. one per connection.
+ */
+struct jsonrpc_dispatcher_t;
+
+struct jsonrpc_dispatcher_t *jsonrpc_dispatcher_new(struct jsonrpc_method_entry_t method_table[]);
+void jsonrpc_dispatcher_free(struct jsonrpc_dispatcher_t *dispatcher);
+
+// Returns the NUL terminated response, valid until the next call on dispatcher, and
+// its length in *output_len if not NULL; NULL when there is nothing to send back
+const char *jsonrpc_dispatch(struct jsonrpc_dispatcher_t *dispatcher, const char *input, size_t input_len, size_t *output_len);
+
+/*
+ * A pool runs the method calls of its dispatchers, which may be used from
+ * as many threads at once, e.g. one per connection: the calls of one
+ * dispatcher keep their order, while the elements of a batch request run in
+ * parallel on the pool threads, their responses in request order. Methods
+ * of the table must then be thread safe.
+ *
+ * max_concurrent bounds the method calls running at once over all the
+ * dispatchers of the pool; the others wait for a call to end. Calls are
+ * timed per method, see jsonrpc_pool_get_stats.
+ */
+struct jsonrpc_pool_t;
+
+struct jsonrpc_pool_config_t
+{
+	int workers;		// threads running batch elements besides the caller; 0 runs them in order
+	int max_concurrent;	// 0 for no limit
+};
+
+struct jsonrpc_method_stats_t
+{
+	const char *name;
+	unsigned long calls;
+	unsigned long errors;	// calls that did not return 0
+	unsigned int avg_us;
+	unsigned int p50_us;	// percentiles are rounded up to a power of 2 minus 1
+	unsigned int p99_us;
+	unsigned int max_us;
+};
+
+struct jsonrpc_pool_t *jsonrpc_pool_new(struct jsonrpc_method_entry_t method_table[], const struct jsonrpc_pool_config_t *config);
+// The dispatchers of the pool must be freed first
+void jsonrpc_pool_free(struct jsonrpc_pool_t *pool);
+struct jsonrpc_dispatcher_t *jsonrpc_pool_dispatcher_new(struct jsonrpc_pool_t *pool);
+
+// Fills up to max stats of the methods called since the last reset, and
+// returns how many there are; reset clears the counters
+int jsonrpc_pool_get_stats(struct jsonrpc_pool_t *pool, struct jsonrpc_method_stats_t stats[], int max, int reset);
+
 json_t *jsonrpc_error_object(int code, json_t *data);
@@ -0,0 +1,284 @@
+/*
+ * jsonrpc dispatch benchmark
+ *
+ *   jsonrpc_bench local [N]          jsonrpc_handler() against jsonrpc_dispatch()
+ *                                    in process, over a table of 64 methods
+ *   jsonrpc_bench pool [N]           N batches of 8 slow calls, in order against
+ *                                    a pool, and 4 callers limited to 2 calls
+ *   jsonrpc_bench socket [N] [path]  N requests to a running jsonrpc server
+ */
+#include "jsonrpc.h"
+#include <string.h>
+#include <sys/types.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#define BENCH_METHODS 64
+
+static int method_echo(json_t *json_params, json_t **result)
+{
+	json_incref(json_params);
+	*result = json_params;
+	return 0;
+}
+
+static int method_sum(json_t *json_params, json_t **result)
+{
+	double total = 0;
+	size_t len = json_array_size(json_params);
+	int k;
+	for (k=0; k < len; k++)
+		total += json_number_value(json_array_get(json_params, k));
+	*result = json_real(total);
+	return 0;
+}
+
+static int method_slow(json_t *json_params, json_t **result)
+{
+	usleep(1000);
+	*result = json_null();
+	return 0;
+}
+
+static char method_names[BENCH_METHODS][32];
+static struct jsonrpc_method_entry_t method_table[BENCH_METHODS + 1];
+
+static void init_table(void)
+{
+	int k;
+	for (k=0; k < BENCH_METHODS; k++) {
+		snprintf(method_names[k], sizeof(method_names[k]), "mw.module%02d.method", k);
+		method_table[k].name = method_names[k];
+		method_table[k].funcptr = (k & 1) ? method_sum : method_echo;
+		method_table[k].params_spec = (k & 1) ? "[FFF!]" : "o";
+	}
+	method_table[BENCH_METHODS].name = NULL;
+}
+
+static double now_us(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+static int make_request(char *buf, size_t size, int k)
+{
+	// mostly methods at the end of the table, where the linear scan is slowest
+	int m = BENCH_METHODS - 1 - (k % 8);
+	if (k % 16 == 15)
+		return snprintf(buf, size, "[{\"jsonrpc\":\"2.0\",\"method\":\"%s\",\"params\":[1,2,%d],\"id\":%d},"
+			"{\"jsonrpc\":\"2.0\",\"method\":\"%s\",\"params\":{\"v\":%d},\"id\":%d}]",
+			method_names[BENCH_METHODS - 1], k, k, method_names[BENCH_METHODS - 2], k, k + 1);
+	if (m & 1)
+		return snprintf(buf, size, "{\"jsonrpc\":\"2.0\",\"method\":\"%s\",\"params\":[1.5,2,%d],\"id\":%d}",
+			method_names[m], k, k);
+	return snprintf(buf, size, "{\"jsonrpc\":\"2.0\",\"method\":\"%s\",\"params\":{\"v\":%d},\"id\":%d}",
+		method_names[m], k, k);
+}
+
+static int bench_local(int n)
+{
+	struct jsonrpc_dispatcher_t *dispatcher = jsonrpc_dispatcher_new(method_table);
+	char input[512];
+	double t0, t_handler, t_dispatch;
+	int k, mismatch = 0;
+
+	if (!dispatcher) {
+		fprintf(stderr, "jsonrpc_dispatcher_new failed\n");
+		return 1;
+	}
+
+	// same responses both ways
+	for (k=0; k < 64; k++) {
+		int len = make_request(input, sizeof(input), k);
+		char *a = jsonrpc_handler(input, len, method_table);
+		const char *b = jsonrpc_dispatch(dispatcher, input, len, NULL);
+		if (!a || !b || strcmp(a, b))
+			mismatch++;
+		free(a);
+	}
+
+	t0 = now_us();
+	for (k=0; k < n; k++) {
+		int len = make_request(input, sizeof(input), k);
+		free(jsonrpc_handler(input, len, method_table));
+	}
+	t_handler = now_us() - t0;
+
+	t0 = now_us();
+	for (k=0; k < n; k++) {
+		int len = make_request(input, sizeof(input), k);
+		jsonrpc_dispatch(dispatcher, input, len, NULL);
+	}
+	t_dispatch = now_us() - t0;
+
+	printf("requests: %d, mismatches: %d\n", n, mismatch);
+	printf("jsonrpc_handler:  %8.2f us/request\n", t_handler / n);
+	printf("jsonrpc_dispatch: %8.2f us/request\n", t_dispatch / n);
+	jsonrpc_dispatcher_free(dispatcher);
+	return mismatch ? 1 : 0;
+}
+
+static struct jsonrpc_method_entry_t slow_table[] = {
+	{ "slow", method_slow, "[i]" },
+	{ "sum", method_sum, "[]" },
+	{ NULL },
+};
+
+static int make_slow_batch(char *buf, size_t size, int k)
+{
+	int len = 0, j;
+	for (j=0; j < 8; j++)
+		len += snprintf(buf + len, size - len, "%c{\"jsonrpc\":\"2.0\",\"method\":\"%s\",\"params\":[%d],\"id\":%d}",
+			j ? ',' : '[', j==7 ? "sum" : "slow", k, j);
+	len += snprintf(buf + len, size - len, "]");
+	return len;
+}
+
+static void *slow_caller(void *arg)
+{
+	struct jsonrpc_dispatcher_t *dispatcher = arg;
+	const char *input = "{\"jsonrpc\":\"2.0\",\"method\":\"slow\",\"params\":[0],\"id\":1}";
+	int k;
+	for (k=0; k < 50; k++)
+		jsonrpc_dispatch(dispatcher, input, strlen(input), NULL);
+	return NULL;
+}
+
+static int bench_pool(int n)
+{
+	struct jsonrpc_pool_config_t config = { 8, 0 };
+	struct jsonrpc_dispatcher_t *serial = jsonrpc_dispatcher_new(slow_table);
+	struct jsonrpc_pool_t *pool = jsonrpc_pool_new(slow_table, &config);
+	struct jsonrpc_dispatcher_t *parallel = pool ? jsonrpc_pool_dispatcher_new(pool) : NULL;
+	struct jsonrpc_dispatcher_t *callers[4];
+	struct jsonrpc_method_stats_t stats[4];
+	pthread_t threads[4];
+	char input[1024];
+	double t0, t_serial, t_parallel;
+	int k, m, mismatch = 0;
+
+	if (!serial || !parallel) {
+		fprintf(stderr, "dispatcher setup failed\n");
+		return 1;
+	}
+
+	t0 = now_us();
+	for (k=0; k < n; k++)
+		jsonrpc_dispatch(serial, input, make_slow_batch(input, sizeof(input), k), NULL);
+	t_serial = now_us() - t0;
+
+	t0 = now_us();
+	for (k=0; k < n; k++)
+		jsonrpc_dispatch(parallel, input, make_slow_batch(input, sizeof(input), k), NULL);
+	t_parallel = now_us() - t0;
+
+	// responses in request order, as without the pool
+	for (k=0; k < 8; k++) {
+		int len = make_slow_batch(input, sizeof(input), k);
+		char *expected = jsonrpc_handler(input, len, slow_table);
+		const char *output = jsonrpc_dispatch(parallel, input, len, NULL);
+		if (!expected || !output || strcmp(expected, output))
+			mismatch++;
+		free(expected);
+	}
+
+	printf("batches of 8: %d, mismatches: %d\n", n, mismatch);
+	printf("in order:  %8.0f us/batch\n", t_serial / n);
+	printf("pool of 8: %8.0f us/batch\n", t_parallel / n);
+	jsonrpc_dispatcher_free(parallel);
+	jsonrpc_pool_free(pool);
+
+	// 200 calls of 1 ms, at most 2 at once: about 100 ms
+	config.workers = 0;
+	config.max_concurrent = 2;
+	pool = jsonrpc_pool_new(slow_table, &config);
+	t0 = now_us();
+	for (k=0; k < 4; k++) {
+		callers[k] = jsonrpc_pool_dispatcher_new(pool);
+		pthread_create(&threads[k], NULL, slow_caller, callers[k]);
+	}
+	for (k=0; k < 4; k++) {
+		pthread_join(threads[k], NULL);
+		jsonrpc_dispatcher_free(callers[k]);
+	}
+	printf("4 callers x 50 calls, limit 2: %.0f ms\n", (now_us() - t0) / 1000);
+	m = jsonrpc_pool_get_stats(pool, stats, 4, 0);
+	for (k=0; k < m && k < 4; k++)
+		printf("  %-8s calls %lu errors %lu avg %u us p50 %u us p99 %u us max %u us\n",
+			stats[k].name, stats[k].calls, stats[k].errors,
+			stats[k].avg_us, stats[k].p50_us, stats[k].p99_us, stats[k].max_us);
+	jsonrpc_pool_free(pool);
+	jsonrpc_dispatcher_free(serial);
+	return mismatch ? 1 : 0;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+	return x < y ? -1 : x > y;
+}
+
+static int bench_socket(int n, const char *path)
+{
+	struct sockaddr_un address;
+	char input[1024], output[1024];
+	double *samples = malloc(n * sizeof(double));
+	double total = 0;
+	int k;
+
+	if (!samples)
+		return 1;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+
+	for (k=0; k < n; k++) {
+		// the server answers one request per connection
+		int len = snprintf(input, sizeof(input),
+			"{\"jsonrpc\":\"2.0\",\"method\":\"sum\",\"params\":[1,2,%d],\"id\":%d}", k, k);
+		double t0 = now_us();
+		int sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (connect(sockfd, (struct sockaddr *)&address, sizeof(address)) == -1) {
+			perror("connect");
+			close(sockfd);
+			free(samples);
+			return 1;
+		}
+		write(sockfd, input, len);
+		read(sockfd, output, sizeof(output));
+		close(sockfd);
+		samples[k] = now_us() - t0;
+		total += samples[k];
+	}
+
+	qsort(samples, n, sizeof(double), cmp_double);
+	printf("requests: %d, avg %.1f us, p50 %.1f us, p99 %.1f us\n",
+		n, total / n, samples[n / 2], samples[n * 99 / 100]);
+	free(samples);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int n = argc > 2 ? atoi(argv[2]) : 100000;
+
+	if (n <= 0)
+		n = 1;
+	init_table();
+	if (argc > 1 && 0==strcmp(argv[1], "pool"))
+		return bench_pool(argc > 2 ? n : 100);
+	if (argc > 1 && 0==strcmp(argv[1], "socket"))
+		return bench_socket(n, argc > 3 ? argv[3] : "p_share_socket");
+	if (argc > 1 && 0!=strcmp(argv[1], "local")) {
+		fprintf(stderr, "usage: %s local|pool|socket [N] [path]\n", argv[0]);
+		return 2;
+	}
+	return bench_local(n);
+}
@@ -7,6 +7,10 @@
 #include <sys/un.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <pthread.h>
+
+static struct jsonrpc_pool_t *pool = NULL;
+static int verbose = 1;
 
 static int method_echo(json_t *json_params, json_t **result)
 {
@@ -54,15 +58,133 @@ static int method_sum(json_t *json_params, json_t **result)
 	return 0;
 }
 
+static int method_sleep(json_t *json_params, json_t **result)
+{
+	// stands for a slow query, e.g. a channel scan status
+	usleep( json_integer_value(json_array_get(json_params, 0)) * 1000 );
+	*result = json_null();
+	return 0;
+}
+
+static int method_stats(json_t *json_params, json_t **result)
+{
+	struct jsonrpc_method_stats_t stats[32];
+	int n, k;
+
+	if (!pool) {
+		*result = json_string("stats need the worker pool (-w)");
+		return JSONRPC_MTK_CANT_OPERATE;
+	}
+	n = jsonrpc_pool_get_stats(pool, stats, 32, json_is_true(json_array_get(json_params, 0)));
+	*result = json_array();
+	for (k=0; k < n && k < 32; k++) {
+		json_t *json = json_object();
+		json_object_set_new(json, "method", json_string(stats[k].name));
+		json_object_set_new(json, "calls", json_integer(stats[k].calls));
+		json_object_set_new(json, "errors", json_integer(stats[k].errors));
+		json_object_set_new(json, "avg_us", json_integer(stats[k].avg_us));
+		json_object_set_new(json, "p50_us", json_integer(stats[k].p50_us));
+		json_object_set_new(json, "p99_us", json_integer(stats[k].p99_us));
+		json_object_set_new(json, "max_us", json_integer(stats[k].max_us));
+		json_array_append_new(*result, json);
+	}
+	return 0;
+}
+
 static struct jsonrpc_method_entry_t method_table[] = {
 	{ "echo", method_echo, "o" }, 
 	{ "subtract", method_subtract, "o" }, 
 	{ "sum", method_sum, "[]" }, 
+	{ "sleep", method_sleep, "[i]" }, 
+	{ "stats", method_stats, "[*]" }, 
 	{ NULL },
 };
 
-int main()
+/*
+ * Worker mode (-w): connections are queued to connection threads, each
+ * serving one connection at a time until the client closes it, so that the
+ * requests of a connection are answered in order. Method calls and the
+ * elements of batch requests run on the jsonrpc pool.
+ */
+#define CONN_QUEUE_SIZE 64
+
+static int conn_queue[CONN_QUEUE_SIZE];
+static int conn_head = 0, conn_count = 0;
+static pthread_mutex_t conn_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t conn_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t conn_space = PTHREAD_COND_INITIALIZER;
+
+static void conn_push(int sockfd)
+{
+	pthread_mutex_lock(&conn_mutex);
+	while (conn_count == CONN_QUEUE_SIZE)
+		pthread_cond_wait(&conn_space, &conn_mutex);
+	conn_queue[(conn_head + conn_count++) % CONN_QUEUE_SIZE] = sockfd;
+	pthread_cond_signal(&conn_ready);
+	pthread_mutex_unlock(&conn_mutex);
+}
+
+static int conn_pop(void)
+{
+	int sockfd;
+	pthread_mutex_lock(&conn_mutex);
+	while (conn_count == 0)
+		pthread_cond_wait(&conn_ready, &conn_mutex);
+	sockfd = conn_queue[conn_head];
+	conn_head = (conn_head + 1) % CONN_QUEUE_SIZE;
+	conn_count--;
+	pthread_cond_signal(&conn_space);
+	pthread_mutex_unlock(&conn_mutex);
+	return sockfd;
+}
+
+static void *conn_thread(void *arg)
+{
+	struct jsonrpc_dispatcher_t *dispatcher = jsonrpc_pool_dispatcher_new(pool);
+	char input[1024];
+	size_t output_len;
+
+	while (dispatcher) {
+		int sockfd = conn_pop();
+		ssize_t len;
+		while ((len = read(sockfd, input, sizeof(input) - 1)) > 0) {
+			input[len] = '\0';
+			if (verbose)
+				printf("Input from client=%s\n", input);
+			const char *output = jsonrpc_dispatch(dispatcher, input, len, &output_len);
+			if (verbose)
+				printf("Server generated output=%s\n", output ? output : "");
+			// a notification gets no response
+			if (output && write(sockfd, output, output_len) < 0)
+				break;
+		}
+		close(sockfd);
+	}
+	return NULL;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-w connection_threads] [-b batch_threads] [-c max_concurrent] [-q]\n", name);
+	exit(2);
+}
+
+int main(int argc, char *argv[])
 {
+	struct jsonrpc_pool_config_t config = { 0, 0 };
+	int conn_threads = 0;
+	int opt, k;
+
+	while ((opt = getopt(argc, argv, "w:b:c:q")) != -1) {
+		switch (opt) {
+			case 'w': conn_threads = atoi(optarg); break;
+			case 'b': config.workers = atoi(optarg); break;
+			case 'c': config.max_concurrent = atoi(optarg); break;
+			case 'q': verbose = 0; break;
+			default: usage(argv[0]);
+		}
+	}
+
 #if 0    
 	zctx_t *ctx = zctx_new();
 	void *sock = zsocket_new(ctx, ZMQ_REP);
@@ -92,6 +214,8 @@ int main()
     int server_len = 0, client_len = 0;
     struct sockaddr_un server_address;
     struct sockaddr_un client_address;
+    struct jsonrpc_dispatcher_t *dispatcher = jsonrpc_dispatcher_new( method_table );
+    size_t output_len = 0;
 
     unlink( "p_share_socket" );
     server_sockfd = socket( AF_UNIX, SOCK_STREAM, 0 );
@@ -101,21 +225,50 @@ int main()
     bind( server_sockfd, (struct sockaddr*)&server_address, server_len );
     listen( server_sockfd, 5 );
     
+    if ( conn_threads > 0 )
+    {
+        pool = jsonrpc_pool_new( method_table, &config );
+        if ( !pool )
+        {
+            fprintf( stderr, "jsonrpc_pool_new failed\n" );
+            return 1;
+        }
+        for ( k = 0; k < conn_threads; k++ )
+        {
+            pthread_t thread;
+            pthread_create( &thread, NULL, conn_thread, NULL );
+            pthread_detach( thread );
+        }
+        while(1)
+        {
+            client_len = sizeof( client_address );
+            client_sockfd = accept( server_sockfd, (struct sockaddr*)&client_address, &client_len );
+            if ( client_sockfd >= 0 )
+                conn_push( client_sockfd );
+        }
+    }
+
     while(1)
     {
-        printf( "Photo share server is waiting...\n" );
+        if ( verbose )
+            printf( "Photo share server is waiting...\n" );
         memset( input, 0, 1024 );
 
         client_len = sizeof( client_address );
         client_sockfd = accept( server_sockfd, (struct sockaddr*)&client_address, &client_len );
-        printf( "A Photo share client connects to this server.\n" );
-        read( client_sockfd, input, 1024 );
-        printf( "Input from client=%s\n", input );
-        char *output = jsonrpc_handler( input, strlen(input), method_table );
-        printf( "Server generated output=%s\n", output );
-        write( client_sockfd, output, strlen(output) );
-        free( output );
+        if ( verbose )
+            printf( "A Photo share client connects to this server.\n" );
+        read( client_sockfd, input, 1023 );
+        if ( verbose )
+            printf( "Input from client=%s\n", input );
+        const char *output = jsonrpc_dispatch( dispatcher, input, strlen(input), &output_len );
+        if ( verbose )
+            printf( "Server generated output=%s\n", output ? output : "" );
+        if ( output )
+            write( client_sockfd, output, output_len );
+        close( client_sockfd );
     }
 	
+	jsonrpc_dispatcher_free( dispatcher );
 	return 0;
 }
@@ -22,6 +22,9 @@
 #ifdef CONFIG_ZRAM_LZ4K_COMPRESS
 #include "zcomp_lz4k.h"
 #endif
+#ifdef CONFIG_ZRAM_UFOZIP_COMPRESS
+#include "zcomp_ufozip.h"
+#endif
 
 /*
  * single zcomp_strm backend
@@ -53,6 +56,9 @@ static struct zcomp_backend *backends[] = {
 #endif
 #ifdef CONFIG_ZRAM_LZ4K_COMPRESS
 	&zcomp_lz4k,
+#endif
+#ifdef CONFIG_ZRAM_UFOZIP_COMPRESS
+	&zcomp_ufozip,
 #endif
 	NULL
 };
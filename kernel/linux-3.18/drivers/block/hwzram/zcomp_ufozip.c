@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2014 Sergey Senozhatsky.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ */
+
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/lz4k.h>
+#ifdef CONFIG_ZSM
+#include <linux/jhash.h>
+#endif
+
+#include "../../hw_ufozip_v3/ufozip_zcomp.h"
+#include "zcomp_ufozip.h"
+
+/*
+ * Pages go to the UFOZIP engine, or to lz4k when the engine is busy or
+ * unavailable; the engine statistics are in /sys/kernel/ufozip_zcomp_stats.
+ */
+
+static void *zcomp_ufozip_create(void)
+{
+	/* workspace of the lz4k fallback */
+	return kzalloc(LZ4K_MEM_COMPRESS, GFP_KERNEL);
+}
+
+static void zcomp_ufozip_destroy(void *private)
+{
+	kfree(private);
+}
+#ifdef CONFIG_ZSM
+static int zcomp_ufozip_compress_zram(const unsigned char *src,
+		unsigned char *dst, size_t *dst_len, void *private,
+		int *checksum)
+{
+	u32 hash;
+
+	/*
+	 * same pages must get the same checksum whichever of the engine
+	 * or lz4k compressed them, so it is not the engine hash
+	 */
+	*checksum = jhash2((const u32 *)src, PAGE_SIZE / sizeof(u32), 0);
+	/* return  : Success if return 0 */
+	return ufozip_zcomp_compress(src, dst, dst_len, private, &hash);
+}
+#else
+static int zcomp_ufozip_compress(const unsigned char *src, unsigned char *dst,
+		size_t *dst_len, void *private)
+{
+	u32 hash;
+
+	/* return  : Success if return 0 */
+	return ufozip_zcomp_compress(src, dst, dst_len, private, &hash);
+}
+#endif
+static int zcomp_ufozip_decompress(const unsigned char *src, size_t src_len,
+		unsigned char *dst)
+{
+	/* return  : Success if return 0 */
+	return ufozip_zcomp_decompress(src, src_len, dst);
+}
+#ifdef CONFIG_ZSM
+struct zcomp_backend zcomp_ufozip = {
+	.compress = zcomp_ufozip_compress_zram,
+	.decompress = zcomp_ufozip_decompress,
+	.create = zcomp_ufozip_create,
+	.destroy = zcomp_ufozip_destroy,
+	.name = "ufozip",
+};
+#else
+struct zcomp_backend zcomp_ufozip = {
+	.compress = zcomp_ufozip_compress,
+	.decompress = zcomp_ufozip_decompress,
+	.create = zcomp_ufozip_create,
+	.destroy = zcomp_ufozip_destroy,
+	.name = "ufozip",
+};
+#endif
@@ -32,6 +32,9 @@
 
 #include <linux/kthread.h>
 
+#define CREATE_TRACE_POINTS
+#include <trace/events/cpufreq_hotplug.h>
+
 /* greater than 80% avg load across online CPUs increases frequency */
 #define DEFAULT_UP_FREQ_MIN_LOAD			(80)
 
@@ -47,6 +50,15 @@
 /* default number of sampling periods to average before hotplug-out decision */
 #define DEFAULT_HOTPLUG_OUT_SAMPLING_PERIODS		(20)
 
+/* default number of CPUs kept online while playback or UI hints are set */
+#define DEFAULT_MEDIA_MIN_CPUS				(2)
+
+/* more than 1.5 runnable tasks per online CPU asks for another CPU */
+#define DEFAULT_UP_NR_RUNNING				(150)
+
+/* number of consecutive sampling periods the run queue must stay deep */
+#define HOTPLUG_RQ_SAMPLING_PERIODS			(2)
+
 #define cputime64_sub(__a, __b)         ((__a) - (__b))
 #define DEBUG_CPUFREQ						(1)
 
@@ -64,6 +76,7 @@ typedef enum {
 static cpu_hotplug_work_type_t g_trigger_hp_work;
 static unsigned int g_next_hp_action;
 static struct delayed_work hp_work;
+static unsigned int g_rq_high_periods;
 
 static void do_dbs_timer(struct work_struct *work);
 static int cpufreq_governor_dbs(struct cpufreq_policy *policy,
@@ -117,6 +130,9 @@ static struct dbs_tuners {
 	unsigned int io_is_busy;
 	unsigned int cpu_num_limit;
     unsigned int hotplug_is_enabled;
+	unsigned int media_min_cpus;
+	unsigned int up_nr_running;
+	unsigned int media_hint;
 } dbs_tuners_ins = {
 	.sampling_rate = DEFAULT_SAMPLING_PERIOD,
 	.up_threshold = DEFAULT_UP_FREQ_MIN_LOAD,
@@ -128,8 +144,69 @@ static struct dbs_tuners {
 	.io_is_busy = 0,
 	.cpu_num_limit = NR_CPUS,
     .hotplug_is_enabled = 0,
+	.media_min_cpus = DEFAULT_MEDIA_MIN_CPUS,
+	.up_nr_running = DEFAULT_UP_NR_RUNNING,
+	.media_hint = 0,
 };
 
+/*
+ * Fewest CPUs to keep online. Playback and UI animation keep
+ * media_min_cpus online, so that frames are not late for a CPU that is
+ * still being powered up; standby lets everything but CPU0 go.
+ */
+static unsigned int hp_min_cpu_num(void)
+{
+	unsigned int hint = dbs_tuners_ins.media_hint;
+
+	if ((hint & CPUFREQ_HP_HINT_STANDBY) ||
+	    !(hint & (CPUFREQ_HP_HINT_PLAYBACK | CPUFREQ_HP_HINT_UI)))
+		return 1;
+
+	return clamp(dbs_tuners_ins.media_min_cpus, 1U,
+		     min(dbs_tuners_ins.cpu_num_limit, num_possible_cpus()));
+}
+
+static void hp_queue_work(cpu_hotplug_work_type_t type, unsigned int target,
+			  const char *reason, unsigned int load,
+			  unsigned int rq_load)
+{
+	if (!dbs_tuners_ins.hotplug_is_enabled)
+		return;
+
+	trace_cpufreq_hotplug_decision(reason, num_online_cpus(), target,
+				       load, rq_load,
+				       dbs_tuners_ins.media_hint);
+
+	g_next_hp_action = target;
+	g_trigger_hp_work = type;
+	schedule_delayed_work_on(0, &hp_work, 0);
+}
+
+/*
+ * Hints from the media framework, a mask of CPUFREQ_HP_HINT_*. CPUs are
+ * brought up as soon as a latency sensitive session starts and parked as
+ * soon as the system enters standby, ahead of the load based decisions.
+ */
+void hp_media_hint(unsigned int hint)
+{
+	unsigned int online, min_cpus;
+
+	mutex_lock(&dbs_mutex);
+	trace_cpufreq_hotplug_hint(dbs_tuners_ins.media_hint, hint);
+	dbs_tuners_ins.media_hint = hint;
+
+	online = num_online_cpus();
+	min_cpus = hp_min_cpu_num();
+	if (online < min_cpus)
+		hp_queue_work(CPU_HOTPLUG_WORK_TYPE_UP, min_cpus, "hint",
+			      0, 0);
+	else if ((hint & CPUFREQ_HP_HINT_STANDBY) && online > 1)
+		hp_queue_work(CPU_HOTPLUG_WORK_TYPE_DOWN, 1, "standby", 0, 0);
+	mutex_unlock(&dbs_mutex);
+}
+
+EXPORT_SYMBOL(hp_media_hint);
+
 void hp_limited_cpu_num(unsigned int num)
 {
 	if (num > num_possible_cpus() || num < 1)
@@ -162,6 +239,9 @@ show_one(ignore_nice_load, ignore_nice);
 show_one(io_is_busy, io_is_busy);
 show_one(cpu_num_limit, cpu_num_limit);
 show_one(hotplug_is_enabled, hotplug_is_enabled);
+show_one(media_min_cpus, media_min_cpus);
+show_one(up_nr_running, up_nr_running);
+show_one(media_hint, media_hint);
 
 static ssize_t store_sampling_rate(struct kobject *a, struct attribute *b,
 				   const char *buf, size_t count)
@@ -405,6 +485,55 @@ static ssize_t store_hotplug_is_enabled(struct kobject *a, struct attribute *b,
     return count;
 }
 
+static ssize_t store_media_min_cpus(struct kobject *a, struct attribute *b,
+				    const char *buf, size_t count)
+{
+	unsigned int input;
+	int ret;
+
+	ret = sscanf(buf, "%u", &input);
+	if (ret != 1 || input < 1 || input > num_possible_cpus())
+		return -EINVAL;
+
+	mutex_lock(&dbs_mutex);
+	dbs_tuners_ins.media_min_cpus = input;
+	mutex_unlock(&dbs_mutex);
+
+	return count;
+}
+
+static ssize_t store_up_nr_running(struct kobject *a, struct attribute *b,
+				   const char *buf, size_t count)
+{
+	unsigned int input;
+	int ret;
+
+	ret = sscanf(buf, "%u", &input);
+	if (ret != 1 || input < 100)
+		return -EINVAL;
+
+	mutex_lock(&dbs_mutex);
+	dbs_tuners_ins.up_nr_running = input;
+	mutex_unlock(&dbs_mutex);
+
+	return count;
+}
+
+static ssize_t store_media_hint(struct kobject *a, struct attribute *b,
+				const char *buf, size_t count)
+{
+	unsigned int input;
+	int ret;
+
+	ret = sscanf(buf, "%i", &input);
+	if (ret != 1 || (input & ~CPUFREQ_HP_HINT_MASK))
+		return -EINVAL;
+
+	hp_media_hint(input);
+
+	return count;
+}
+
 define_one_global_rw(sampling_rate);
 define_one_global_rw(up_threshold);
 define_one_global_rw(down_threshold);
@@ -414,6 +543,9 @@ define_one_global_rw(ignore_nice_load);
 define_one_global_rw(io_is_busy);
 define_one_global_rw(cpu_num_limit);
 define_one_global_rw(hotplug_is_enabled);
+define_one_global_rw(media_min_cpus);
+define_one_global_rw(up_nr_running);
+define_one_global_rw(media_hint);
 
 static struct attribute *dbs_attributes[] = {
 	&sampling_rate.attr,
@@ -425,6 +557,9 @@ static struct attribute *dbs_attributes[] = {
 	&io_is_busy.attr,
 	&cpu_num_limit.attr,
     &hotplug_is_enabled.attr,
+	&media_min_cpus.attr,
+	&up_nr_running.attr,
+	&media_hint.attr,
 	NULL
 };
 
@@ -489,6 +624,8 @@ static void dbs_check_cpu(struct cpu_dbs_info_s *this_dbs_info)
 	unsigned int hotplug_out_avg_load = 0;
 	/* number of sampling periods averaged for hotplug decisions */
 	unsigned int periods;
+	/* runnable tasks per 100 online CPUs, and the CPU count floor */
+	unsigned int rq_load, min_cpus;
 
 	struct cpufreq_policy *policy;
 	unsigned int index = 0;
@@ -497,10 +634,9 @@ static void dbs_check_cpu(struct cpu_dbs_info_s *this_dbs_info)
 	policy = this_dbs_info->cur_policy;
 
 	// check if online cpus is over limit cpu
-	if (num_online_cpus() > dbs_tuners_ins.cpu_num_limit) {
-		g_trigger_hp_work = CPU_HOTPLUG_WORK_TYPE_LIMIT;
-		schedule_delayed_work_on(0, &hp_work, 0);
-	}
+	if (num_online_cpus() > dbs_tuners_ins.cpu_num_limit)
+		hp_queue_work(CPU_HOTPLUG_WORK_TYPE_LIMIT,
+			      dbs_tuners_ins.cpu_num_limit, "limit", 0, 0);
 
 	/*
 	 * cpu load accounting
@@ -547,6 +683,8 @@ static void dbs_check_cpu(struct cpu_dbs_info_s *this_dbs_info)
 
 	/* calculate the average load across all related CPUs */
 	avg_load = total_load / num_online_cpus();
+	rq_load = nr_running() * 100 / num_online_cpus();
+	min_cpus = hp_min_cpu_num();
 
 	/*
 	 * hotplug load accounting
@@ -589,6 +727,39 @@ static void dbs_check_cpu(struct cpu_dbs_info_s *this_dbs_info)
 	//printk("avg: %d hotplug_in:%d, hotplug_out:%d\n", avg_load, hotplug_in_avg_load, hotplug_out_avg_load);
 #endif
 
+	/* a CPU went away underneath a latency sensitive session */
+	if (num_online_cpus() < min_cpus) {
+		hp_queue_work(CPU_HOTPLUG_WORK_TYPE_UP, min_cpus, "media",
+			      avg_load, rq_load);
+		goto out;
+	}
+
+	/* in standby park the auxiliary CPUs as soon as the load drops */
+	if ((dbs_tuners_ins.media_hint & CPUFREQ_HP_HINT_STANDBY) &&
+	    num_online_cpus() > 1 && avg_load < dbs_tuners_ins.down_threshold) {
+		hp_queue_work(CPU_HOTPLUG_WORK_TYPE_DOWN, 1, "standby",
+			      avg_load, rq_load);
+		goto out;
+	}
+
+	/*
+	 * runnable tasks waiting behind each other want another CPU even
+	 * when the sampled CPU load does not show it yet
+	 */
+	if (rq_load > dbs_tuners_ins.up_nr_running)
+		g_rq_high_periods++;
+	else
+		g_rq_high_periods = 0;
+
+	if (g_rq_high_periods >= HOTPLUG_RQ_SAMPLING_PERIODS &&
+	    num_online_cpus() < dbs_tuners_ins.cpu_num_limit &&
+	    num_online_cpus() < num_possible_cpus()) {
+		g_rq_high_periods = 0;
+		hp_queue_work(CPU_HOTPLUG_WORK_TYPE_UP, num_online_cpus() + 1,
+			      "rq", avg_load, rq_load);
+		goto out;
+	}
+
 	/* check for frequency increase */
 	if (avg_load > dbs_tuners_ins.up_threshold) {
 		/* should we enable auxillary CPUs? */
@@ -599,8 +770,9 @@ static void dbs_check_cpu(struct cpu_dbs_info_s *this_dbs_info)
 			 * wq is not running here so its safe.
 			 */
 			//mutex_unlock(&this_dbs_info->timer_mutex);
-			g_trigger_hp_work = CPU_HOTPLUG_WORK_TYPE_RUSH;
-			schedule_delayed_work_on(0, &hp_work, 0);
+			hp_queue_work(CPU_HOTPLUG_WORK_TYPE_RUSH,
+				      dbs_tuners_ins.cpu_num_limit, "rush",
+				      avg_load, rq_load);
 			//mutex_lock(&this_dbs_info->timer_mutex);
 			goto out;
 		}
@@ -618,12 +790,14 @@ static void dbs_check_cpu(struct cpu_dbs_info_s *this_dbs_info)
 		/* are we at the minimum frequency already? */
 		if (policy->cur == policy->min) {
 			/* should we disable auxillary CPUs? */
-			if (num_online_cpus() > 1 && hotplug_out_avg_load <
-			    dbs_tuners_ins.down_threshold) {
+			if (num_online_cpus() > min_cpus &&
+			    hotplug_out_avg_load <
+			    dbs_tuners_ins.down_threshold &&
+			    rq_load <= 100) {
 				//mutex_unlock(&this_dbs_info->timer_mutex);
-				g_next_hp_action = num_online_cpus() - 1;
-				g_trigger_hp_work = CPU_HOTPLUG_WORK_TYPE_DOWN;
-				schedule_delayed_work_on(0, &hp_work, 0);
+				hp_queue_work(CPU_HOTPLUG_WORK_TYPE_DOWN,
+					      num_online_cpus() - 1, "idle",
+					      avg_load, rq_load);
 				//mutex_lock(&this_dbs_info->timer_mutex);
 			}
 			goto out;
@@ -126,22 +126,27 @@ static int get_index_all_cpufreq_stat(struct all_cpufreq_stats *all_stat,
 	return -1;
 }
 
-void acct_update_power(struct task_struct *task, cputime_t cputime) {
+u64 acct_update_power(struct task_struct *task, cputime_t cputime) {
 	struct cpufreq_power_stats *powerstats;
 	struct cpufreq_stats *stats;
 	unsigned int cpu_num, curr;
+	u64 power;
 
 	if (!task)
-		return;
+		return 0;
 	cpu_num = task_cpu(task);
 	powerstats = per_cpu(cpufreq_power_stats, cpu_num);
 	stats = per_cpu(cpufreq_stats_table, cpu_num);
 	if (!powerstats || !stats)
-		return;
+		return 0;
 
 	curr = powerstats->curr[stats->last_index];
-	if (task->cpu_power != ULLONG_MAX)
-		task->cpu_power += curr * cputime_to_usecs(cputime);
+	if (task->cpu_power == ULLONG_MAX)
+		return 0;
+
+	power = (u64)curr * cputime_to_usecs(cputime);
+	task->cpu_power += power;
+	return power;
 }
 EXPORT_SYMBOL_GPL(acct_update_power);
 
@@ -0,0 +1,930 @@
+/*
+ * UFOZIP page compression engine for zram
+ *
+ * The register layer (mapping, zram_read_reg() and friends, encoder and
+ * decoder configuration) is the one of the DVT driver; this file owns the
+ * compression descriptor ring and the decompression register sets while
+ * it is active, so the DVT ufo_test trigger must not be used with it.
+ *
+ * Completion is polled: zram compresses under kmap_atomic() and
+ * decompresses under a bit spinlock, so there is nothing to sleep on.
+ */
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/init.h>
+#include <linux/slab.h>
+#include <linux/mm.h>
+#include <linux/io.h>
+#include <linux/dma-mapping.h>
+#include <linux/platform_device.h>
+#include <linux/spinlock.h>
+#include <linux/bitops.h>
+#include <linux/percpu.h>
+#include <linux/ktime.h>
+#include <linux/delay.h>
+#include <linux/math64.h>
+#include <linux/kobject.h>
+#include <linux/sysfs.h>
+#include <linux/lz4k.h>
+
+#include "zram_test_api.h"
+#include "hwzram.h"
+#include "ufozip_zcomp.h"
+
+/* ring size when it is not fixed by the hardware */
+#define UFOZIP_RING_ORDER	5
+/* pages in flight at most */
+#define UFOZIP_SLOTS_ORDER	5
+#define UFOZIP_MAX_DCMD		8
+
+/* the six destination buffers of a slot, carved from one page */
+static const u16 ufozip_buf_off[ZRAM_NUM_OF_FREE_BLOCKS] = {
+	0, 2048, 3072, 3584, 3840, 3968
+};
+
+/* buffer i is 2048 >> i bytes, size code 6 - i */
+#define UFOZIP_BUF_CODE(i)	(ZRAM_NUM_OF_FREE_BLOCKS - (i))
+#define UFOZIP_CODE_BYTES(code)	(32U << (code))
+#define UFOZIP_CODE_OFF(code)	ufozip_buf_off[ZRAM_NUM_OF_FREE_BLOCKS - (code)]
+
+#define DEC_INTF_STAT_TIMEOUT	(1U << 8)
+
+/* status of a decompression register set */
+#define DCMD_STS_OK		1
+#define DCMD_STS_ERROR		4
+#define DCMD_STS_PEND		7
+
+static unsigned int hw_timeout_us = 1000;
+module_param(hw_timeout_us, uint, 0644);
+MODULE_PARM_DESC(hw_timeout_us, "time a page may wait for the engine before lz4k takes it");
+
+static bool use_hw = true;
+module_param(use_hw, bool, 0644);
+MODULE_PARM_DESC(use_hw, "compress with the engine; lz4k only if false");
+
+enum ufozip_slot_state {
+	SLOT_FREE,
+	SLOT_FILLING,		/* reserved, descriptor being written */
+	SLOT_READY,		/* descriptor written, doorbell not rung */
+	SLOT_PEND,		/* owned by the engine */
+	SLOT_DONE,		/* completed, result not consumed yet */
+	SLOT_ABANDONED,		/* its caller timed out; freed on completion */
+};
+
+struct ufozip_slot {
+	void *src;
+	void *bufs;
+	dma_addr_t src_dma;
+	dma_addr_t bufs_dma;
+	int state;
+	/* descriptor result, valid in SLOT_DONE */
+	u8 status;
+	u8 buf_sel;
+	u16 compr_size;
+	u32 hash;
+};
+
+struct ufozip_bounce {
+	void *in;
+	void *out;
+	dma_addr_t in_dma;
+	dma_addr_t out_dma;
+};
+
+struct ufozip_engine {
+	/* protects the ring counters and the slot states */
+	spinlock_t lock;
+	bool ready;
+	struct device *dev;
+	void *ring;
+	dma_addr_t ring_dma;
+	bool ring_fixed;
+	unsigned int desc_type;
+	unsigned int desc_size;
+	unsigned int ring_mask;
+	/* hardware indices carry a wrap bit above the ring index */
+	unsigned int idx_mask;
+	unsigned int slot_mask;
+	unsigned int num_dcmd;
+	/*
+	 * free running descriptor counters:
+	 * tail <= reaped <= rung <= head
+	 */
+	unsigned int head;	/* next to reserve */
+	unsigned int rung;	/* below were handed to the engine */
+	unsigned int reaped;	/* below have completed */
+	unsigned int tail;	/* oldest not yet free */
+	struct ufozip_slot *slots;
+	/* the ring is lent out by ufozip_zcomp_claim() */
+	bool claimed;
+	unsigned long dcmd_busy;
+	/* serializes decoder resets */
+	spinlock_t dec_lock;
+};
+
+static struct ufozip_engine ufozip;
+static struct platform_device *ufozip_pdev;
+static DEFINE_PER_CPU(struct ufozip_bounce, ufozip_bounce);
+static DEFINE_PER_CPU(struct ufozip_zcomp_stats, ufozip_stats);
+
+#define ufozip_stat_inc(field)	this_cpu_inc(ufozip_stats.field)
+
+static void ufozip_account(u64 *total, u64 *max, u64 *bytes, size_t n,
+		ktime_t start)
+{
+	u64 ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	*total += ns;
+	if (ns > *max)
+		*max = ns;
+	if (bytes)
+		*bytes += n;
+}
+
+static inline struct ufozip_slot *ufozip_slot(struct ufozip_engine *e,
+		unsigned int c)
+{
+	return &e->slots[c & e->slot_mask];
+}
+
+static inline volatile u32 *ufozip_desc(struct ufozip_engine *e,
+		unsigned int c)
+{
+	return (volatile u32 *)(e->ring + (c & e->ring_mask) * e->desc_size);
+}
+
+static inline bool ufozip_hw_usable(struct ufozip_engine *e)
+{
+	return e->ready && use_hw;
+}
+
+bool ufozip_zcomp_hw_ready(void)
+{
+	return ufozip.ready;
+}
+EXPORT_SYMBOL(ufozip_zcomp_hw_ready);
+
+static void ufozip_write_desc(struct ufozip_engine *e, unsigned int c,
+		struct ufozip_slot *slot)
+{
+	volatile u32 *d = ufozip_desc(e, c);
+	int i;
+
+	if (e->desc_type) {
+		/* struct compr_desc_1 */
+		for (i = 0; i < ZRAM_NUM_OF_FREE_BLOCKS; i++)
+			d[2 + i] = (u32)(slot->bufs_dma + ufozip_buf_off[i] +
+				(UFOZIP_CODE_BYTES(UFOZIP_BUF_CODE(i)) >> 1)) >> 5;
+		d[0] = 0;
+		wmb();
+		d[1] = (SZ_PEND << 28) | ((u32)slot->src_dma >> 12);
+	} else {
+		/* struct compr_desc_0, as 32-bit words */
+		for (i = 0; i < ZRAM_NUM_OF_FREE_BLOCKS; i++) {
+			d[4 + 2 * i] = (u32)(slot->bufs_dma + ufozip_buf_off[i] +
+				(UFOZIP_CODE_BYTES(UFOZIP_BUF_CODE(i)) >> 1));
+			d[5 + 2 * i] = 0;
+		}
+		d[0] = 0;
+		d[1] = 0;
+		d[3] = 0;
+		wmb();
+		d[2] = (u32)slot->src_dma | (SZ_PEND << 1);
+	}
+}
+
+static void ufozip_read_desc(struct ufozip_engine *e, unsigned int c,
+		struct ufozip_slot *slot)
+{
+	volatile u32 *d = ufozip_desc(e, c);
+	u32 w;
+
+	rmb();
+	if (e->desc_type) {
+		w = d[1];
+		slot->status = (w >> 28) & 7;
+		slot->compr_size = (w >> 12) & 0x1fff;
+		slot->buf_sel = w & 0x3f;
+		slot->hash = d[0];
+	} else {
+		w = d[0];
+		slot->buf_sel = w & 0x3f;
+		slot->compr_size = w >> 16;
+		slot->hash = d[1];
+		slot->status = (d[2] >> 1) & 7;
+	}
+}
+
+/* free the slots at the tail that are no longer used. Lock held. */
+static void ufozip_retire(struct ufozip_engine *e)
+{
+	while (e->tail != e->reaped &&
+	       ufozip_slot(e, e->tail)->state == SLOT_FREE)
+		e->tail++;
+}
+
+/*
+ * Hand every consecutive filled slot to the engine with a single write of
+ * the write index. Lock held.
+ */
+static void ufozip_ring(struct ufozip_engine *e)
+{
+	unsigned int rung = e->rung;
+
+	while (rung != e->head) {
+		struct ufozip_slot *slot = ufozip_slot(e, rung);
+
+		if (slot->state == SLOT_FILLING)
+			break;
+		if (slot->state == SLOT_READY)
+			slot->state = SLOT_PEND;
+		rung++;
+	}
+	if (rung == e->rung)
+		return;
+	e->rung = rung;
+	wmb();
+	zram_write_reg(ZRAM_CDESC_WRIDX, rung & e->idx_mask);
+	ufozip_stat_inc(doorbells);
+}
+
+/* collect every descriptor the engine has completed. Lock held. */
+static void ufozip_reap(struct ufozip_engine *e)
+{
+	u32 ctrl = zram_read_reg(ZRAM_CDESC_CTRL);
+	unsigned int done = ctrl & ZRAM_CDESC_CTRL_COMPLETE_IDX_MASK;
+
+	while (e->reaped != e->rung && (e->reaped & e->idx_mask) != done) {
+		struct ufozip_slot *slot = ufozip_slot(e, e->reaped);
+
+		ufozip_read_desc(e, e->reaped, slot);
+		slot->state = slot->state == SLOT_ABANDONED ?
+			SLOT_FREE : SLOT_DONE;
+		e->reaped++;
+	}
+	ufozip_retire(e);
+
+	if (e->ready && (ctrl & (1U << ZRAM_CDESC_CTRL_COMPRESS_HALTED_SHIFT))) {
+		/* nothing more completes; queued pages time out */
+		e->ready = false;
+		pr_err("ufozip: compression halted, ctrl 0x%x, using lz4k\n",
+		       ctrl);
+	}
+}
+
+/* wait for |slot| to complete. Return 0, or -ETIMEDOUT. */
+static int ufozip_wait(struct ufozip_engine *e, struct ufozip_slot *slot)
+{
+	ktime_t deadline = ktime_add_us(ktime_get(), hw_timeout_us);
+	unsigned long flags;
+
+	for (;;) {
+		spin_lock_irqsave(&e->lock, flags);
+		if (slot->state != SLOT_DONE)
+			ufozip_reap(e);
+		if (slot->state == SLOT_DONE) {
+			spin_unlock_irqrestore(&e->lock, flags);
+			return 0;
+		}
+		if (ktime_compare(ktime_get(), deadline) > 0) {
+			slot->state = SLOT_ABANDONED;
+			spin_unlock_irqrestore(&e->lock, flags);
+			return -ETIMEDOUT;
+		}
+		spin_unlock_irqrestore(&e->lock, flags);
+		cpu_relax();
+	}
+}
+
+static void ufozip_release(struct ufozip_engine *e, struct ufozip_slot *slot)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&e->lock, flags);
+	slot->state = SLOT_FREE;
+	ufozip_retire(e);
+	spin_unlock_irqrestore(&e->lock, flags);
+}
+
+/*
+ * Copy the buffers the engine filled behind a header. Return the stored
+ * length, or 0 if the result does not make sense.
+ */
+static size_t ufozip_gather(struct ufozip_slot *slot, unsigned char *dst)
+{
+	struct ufozip_zhdr *hdr = (struct ufozip_zhdr *)dst;
+	unsigned char *out = dst + sizeof(*hdr);
+	unsigned int sel = slot->buf_sel;
+	unsigned int left = slot->compr_size;
+	int n = 0;
+
+	memset(hdr, 0, sizeof(*hdr));
+	while (left && sel && n < HWZRAM_MAX_BUFFERS_USED) {
+		int i = ffs(sel) - 1;
+		unsigned int len;
+
+		if (i >= ZRAM_NUM_OF_FREE_BLOCKS)
+			return 0;
+		len = min(left, UFOZIP_CODE_BYTES(UFOZIP_BUF_CODE(i)));
+		memcpy(out, slot->bufs + ufozip_buf_off[i], len);
+		hdr->buf_sz[n++] = UFOZIP_BUF_CODE(i);
+		out += len;
+		left -= len;
+		sel &= ~(1U << i);
+	}
+	if (left || !slot->compr_size)
+		return 0;
+	hdr->tag = UFOZIP_ZTAG_HW;
+	hdr->compr_size = slot->compr_size;
+	hdr->hash = slot->hash;
+	return out - dst;
+}
+
+static int ufozip_sw_compress(const unsigned char *src, unsigned char *dst,
+		size_t *dst_len, void *wrkmem)
+{
+	size_t len = 0;
+	int ret;
+
+	dst[0] = UFOZIP_ZTAG_SW;
+	ret = lz4k_compress(src, PAGE_SIZE, dst + 1, &len, wrkmem);
+	if (ret)
+		return ret;
+	*dst_len = len + 1;
+	ufozip_stat_inc(sw_compress);
+	return 0;
+}
+
+int ufozip_zcomp_compress(const unsigned char *src, unsigned char *dst,
+		size_t *dst_len, void *wrkmem, u32 *hash)
+{
+	struct ufozip_engine *e = &ufozip;
+	struct ufozip_zcomp_stats *st;
+	struct ufozip_slot *slot;
+	ktime_t start = ktime_get();
+	unsigned long flags;
+	unsigned int c;
+	size_t len;
+	int ret;
+
+	*hash = 0;
+	if (!ufozip_hw_usable(e))
+		goto sw;
+
+	spin_lock_irqsave(&e->lock, flags);
+	if (e->head - e->tail > e->slot_mask) {
+		spin_unlock_irqrestore(&e->lock, flags);
+		ufozip_stat_inc(queue_full);
+		goto sw;
+	}
+	c = e->head++;
+	slot = ufozip_slot(e, c);
+	slot->state = SLOT_FILLING;
+	spin_unlock_irqrestore(&e->lock, flags);
+
+	memcpy(slot->src, src, PAGE_SIZE);
+	dma_sync_single_for_device(e->dev, slot->src_dma, PAGE_SIZE,
+				   DMA_TO_DEVICE);
+	dma_sync_single_for_device(e->dev, slot->bufs_dma, PAGE_SIZE,
+				   DMA_FROM_DEVICE);
+	ufozip_write_desc(e, c, slot);
+
+	spin_lock_irqsave(&e->lock, flags);
+	slot->state = SLOT_READY;
+	ufozip_ring(e);
+	spin_unlock_irqrestore(&e->lock, flags);
+
+	if (ufozip_wait(e, slot)) {
+		ufozip_stat_inc(hw_timeout);
+		goto sw;
+	}
+
+	switch (slot->status) {
+	case SZ_COMPRESSED:
+		dma_sync_single_for_cpu(e->dev, slot->bufs_dma, PAGE_SIZE,
+					DMA_FROM_DEVICE);
+		len = ufozip_gather(slot, dst);
+		if (!len)
+			break;
+		*hash = slot->hash;
+		*dst_len = len < PAGE_SIZE ? len : PAGE_SIZE;
+		ufozip_release(e, slot);
+		ufozip_stat_inc(hw_compress);
+		goto out;
+	case SZ_COPIED:
+	case SZ_ABORT:
+		/* zram stores the page as it is */
+		ufozip_release(e, slot);
+		*dst_len = PAGE_SIZE;
+		ufozip_stat_inc(incompressible);
+		goto out;
+	default:
+		break;
+	}
+	pr_debug("ufozip: descriptor %u status %u size %u sel 0x%x\n",
+		 c, slot->status, slot->compr_size, slot->buf_sel);
+	ufozip_release(e, slot);
+	ufozip_stat_inc(hw_error);
+
+sw:
+	ret = ufozip_sw_compress(src, dst, dst_len, wrkmem);
+	if (ret)
+		return ret;
+out:
+	st = get_cpu_ptr(&ufozip_stats);
+	st->orig_bytes += PAGE_SIZE;
+	ufozip_account(&st->compress_ns, &st->compress_max_ns,
+		       &st->compr_bytes, *dst_len, start);
+	put_cpu_ptr(&ufozip_stats);
+	return 0;
+}
+EXPORT_SYMBOL(ufozip_zcomp_compress);
+
+static void ufozip_reset_decoder(void)
+{
+	int n = 1000;
+
+	zram_write_reg(ZRAM_GCTRL + DEC_OFFSET, 1);
+	while (zram_read_reg(ZRAM_GCTRL + DEC_OFFSET) && --n)
+		cpu_relax();
+	zram_write_reg(DEC_INT_CLR, 0x02);
+}
+
+/*
+ * Run one decompression on a free register set, from |b->in| to
+ * |b->out|. The decoder is reset after a failure, before the set is
+ * given back. Return the final status of the set.
+ */
+static unsigned int ufozip_dcmd_run(struct ufozip_engine *e,
+		const struct ufozip_zhdr *hdr, struct ufozip_bounce *b)
+{
+	ktime_t deadline;
+	unsigned long flags;
+	unsigned int sts;
+	int n, k;
+
+	for (;;) {
+		n = find_first_zero_bit(&e->dcmd_busy, e->num_dcmd);
+		if (n < e->num_dcmd && !test_and_set_bit(n, &e->dcmd_busy))
+			break;
+		cpu_relax();
+	}
+
+	zram_write_reg64(ZRAM_DCMD_CSIZE(n),
+		((u64)hdr->compr_size << ZRAM_DCMD_CSIZE_SIZE_SHIFT) |
+		((u64)hdr->hash << ZRAM_DCMD_CSIZE_HASH_SHIFT) |
+		ZRAM_DCMD_CSIZE_HASH_ENABLE_MASK);
+	for (k = 0; k < HWZRAM_MAX_BUFFERS_USED; k++) {
+		u64 buf = 0;
+
+		if (hdr->buf_sz[k])
+			buf = ((u64)hdr->buf_sz[k] << ZRAM_DCMD_BUF_SIZE_SHIFT) |
+				(b->in_dma + UFOZIP_CODE_OFF(hdr->buf_sz[k]));
+		zram_write_reg64(ZRAM_DCMD_BUF0(n) + k * 8, buf);
+	}
+	zram_write_reg64(ZRAM_DCMD_RES(n), 0);
+	wmb();
+	/* pending status, no interrupt */
+	zram_write_reg64(ZRAM_DCMD_DEST(n), b->out_dma |
+			 (DCMD_STS_PEND << ZRAM_DCMD_DEST_STATUS_SHIFT));
+
+	deadline = ktime_add_us(ktime_get(), hw_timeout_us);
+	for (;;) {
+		sts = ZRAM_DCMD_DEST_TO_STATUS(zram_read_reg64(ZRAM_DCMD_DEST(n)));
+		if (sts != DCMD_STS_PEND)
+			break;
+		if ((zram_read_reg(DEC_INTF_STAT) & DEC_INTF_STAT_TIMEOUT) ||
+		    ktime_compare(ktime_get(), deadline) > 0) {
+			sts = DCMD_STS_ERROR;
+			break;
+		}
+		cpu_relax();
+	}
+	if (sts != DCMD_STS_OK) {
+		spin_lock_irqsave(&e->dec_lock, flags);
+		ufozip_reset_decoder();
+		spin_unlock_irqrestore(&e->dec_lock, flags);
+	}
+	clear_bit(n, &e->dcmd_busy);
+	return sts;
+}
+
+static int ufozip_hw_decompress(struct ufozip_engine *e,
+		const unsigned char *src, size_t src_len, unsigned char *dst)
+{
+	struct ufozip_zhdr hdr;
+	struct ufozip_bounce *b;
+	const unsigned char *in = src + sizeof(hdr);
+	unsigned int sts, left;
+	int k, tries, ret = 0;
+
+	/* also after a compression halt: the decoder is separate */
+	if (src_len < sizeof(hdr) || !e->dev)
+		return -EINVAL;
+	memcpy(&hdr, src, sizeof(hdr));
+	if (hdr.compr_size + sizeof(hdr) != src_len)
+		return -EINVAL;
+
+	b = get_cpu_ptr(&ufozip_bounce);
+	left = hdr.compr_size;
+	for (k = 0; k < HWZRAM_MAX_BUFFERS_USED && left; k++) {
+		unsigned int code = hdr.buf_sz[k];
+		unsigned int len;
+
+		if (code < 1 || code > ZRAM_NUM_OF_FREE_BLOCKS) {
+			ret = -EINVAL;
+			goto out;
+		}
+		len = min(left, UFOZIP_CODE_BYTES(code));
+		memcpy(b->in + UFOZIP_CODE_OFF(code), in, len);
+		in += len;
+		left -= len;
+	}
+	if (left) {
+		ret = -EINVAL;
+		goto out;
+	}
+	dma_sync_single_for_device(e->dev, b->in_dma, PAGE_SIZE, DMA_TO_DEVICE);
+
+	for (tries = 0; tries < 2; tries++) {
+		dma_sync_single_for_device(e->dev, b->out_dma, PAGE_SIZE,
+					   DMA_FROM_DEVICE);
+		sts = ufozip_dcmd_run(e, &hdr, b);
+		if (sts == DCMD_STS_OK)
+			break;
+	}
+	if (sts != DCMD_STS_OK) {
+		pr_err_ratelimited("ufozip: decompression failed, status %u\n",
+				   sts);
+		ret = -EIO;
+		goto out;
+	}
+	dma_sync_single_for_cpu(e->dev, b->out_dma, PAGE_SIZE, DMA_FROM_DEVICE);
+	memcpy(dst, b->out, PAGE_SIZE);
+out:
+	put_cpu_ptr(&ufozip_bounce);
+	return ret;
+}
+
+int ufozip_zcomp_decompress(const unsigned char *src, size_t src_len,
+		unsigned char *dst)
+{
+	struct ufozip_zcomp_stats *st;
+	ktime_t start = ktime_get();
+	size_t dst_len = PAGE_SIZE;
+	int ret;
+
+	if (!src_len)
+		return -EINVAL;
+	if (src[0] == UFOZIP_ZTAG_SW) {
+		ret = lz4k_decompress_safe(src + 1, src_len - 1, dst, &dst_len);
+		if (!ret)
+			ufozip_stat_inc(sw_decompress);
+	} else if (src[0] == UFOZIP_ZTAG_HW) {
+		ret = ufozip_hw_decompress(&ufozip, src, src_len, dst);
+		if (!ret)
+			ufozip_stat_inc(hw_decompress);
+	} else {
+		ret = -EINVAL;
+	}
+	if (ret) {
+		ufozip_stat_inc(decompress_error);
+		return ret;
+	}
+	st = get_cpu_ptr(&ufozip_stats);
+	ufozip_account(&st->decompress_ns, &st->decompress_max_ns, NULL, 0,
+		       start);
+	put_cpu_ptr(&ufozip_stats);
+	return 0;
+}
+EXPORT_SYMBOL(ufozip_zcomp_decompress);
+
+void ufozip_zcomp_get_stats(struct ufozip_zcomp_stats *stats, bool reset)
+{
+	int cpu;
+
+	memset(stats, 0, sizeof(*stats));
+	for_each_possible_cpu(cpu) {
+		struct ufozip_zcomp_stats *st = per_cpu_ptr(&ufozip_stats, cpu);
+
+		stats->hw_compress += st->hw_compress;
+		stats->sw_compress += st->sw_compress;
+		stats->queue_full += st->queue_full;
+		stats->hw_timeout += st->hw_timeout;
+		stats->hw_error += st->hw_error;
+		stats->incompressible += st->incompressible;
+		stats->doorbells += st->doorbells;
+		stats->hw_decompress += st->hw_decompress;
+		stats->sw_decompress += st->sw_decompress;
+		stats->decompress_error += st->decompress_error;
+		stats->orig_bytes += st->orig_bytes;
+		stats->compr_bytes += st->compr_bytes;
+		stats->compress_ns += st->compress_ns;
+		stats->compress_max_ns = max(stats->compress_max_ns,
+					     st->compress_max_ns);
+		stats->decompress_ns += st->decompress_ns;
+		stats->decompress_max_ns = max(stats->decompress_max_ns,
+					       st->decompress_max_ns);
+		if (reset)
+			memset(st, 0, sizeof(*st));
+	}
+}
+EXPORT_SYMBOL(ufozip_zcomp_get_stats);
+
+/* program our ring and pick up the hardware indices */
+static int ufozip_start_ring(struct ufozip_engine *e)
+{
+	unsigned int wr, done;
+
+	if (!e->ring_fixed)
+		zram_write_reg(ZRAM_CDESC_LOC,
+			       (u32)e->ring_dma | ilog2(e->ring_mask + 1));
+	zram_write_reg(ZRAM_CDESC_CTRL,
+		       1U << ZRAM_CDESC_CTRL_COMPRESS_ENABLE_SHIFT);
+	wr = zram_read_reg(ZRAM_CDESC_WRIDX) & e->idx_mask;
+	done = zram_read_reg(ZRAM_CDESC_CTRL) & e->idx_mask;
+	if (wr != done) {
+		pr_err("ufozip: ring busy, write %u complete %u\n", wr, done);
+		return -EBUSY;
+	}
+	e->head = e->rung = e->reaped = e->tail = wr;
+	return 0;
+}
+
+int ufozip_zcomp_claim(void)
+{
+	struct ufozip_engine *e = &ufozip;
+	unsigned long flags;
+	int n;
+
+	spin_lock_irqsave(&e->lock, flags);
+	if (e->claimed) {
+		spin_unlock_irqrestore(&e->lock, flags);
+		return -EBUSY;
+	}
+	e->claimed = true;
+	e->ready = false;
+	spin_unlock_irqrestore(&e->lock, flags);
+
+	/* pages in flight complete, or are abandoned and then complete */
+	for (n = 0; n < 100; n++) {
+		spin_lock_irqsave(&e->lock, flags);
+		if (e->slots)
+			ufozip_reap(e);
+		if (e->tail == e->head) {
+			spin_unlock_irqrestore(&e->lock, flags);
+			return 0;
+		}
+		spin_unlock_irqrestore(&e->lock, flags);
+		msleep(1);
+	}
+	ufozip_zcomp_release();
+	return -EBUSY;
+}
+EXPORT_SYMBOL(ufozip_zcomp_claim);
+
+void ufozip_zcomp_release(void)
+{
+	struct ufozip_engine *e = &ufozip;
+	unsigned long flags;
+
+	spin_lock_irqsave(&e->lock, flags);
+	if (e->claimed && e->dev)
+		e->ready = !ufozip_start_ring(e);
+	e->claimed = false;
+	spin_unlock_irqrestore(&e->lock, flags);
+}
+EXPORT_SYMBOL(ufozip_zcomp_release);
+
+static ssize_t ufozip_zcomp_stats_show(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	struct ufozip_zcomp_stats s;
+	u64 compressed, decompressed;
+
+	ufozip_zcomp_get_stats(&s, false);
+	compressed = s.hw_compress + s.sw_compress + s.incompressible;
+	decompressed = s.hw_decompress + s.sw_decompress;
+	return scnprintf(buf, PAGE_SIZE,
+		"engine %s\n"
+		"compress hw %llu sw %llu incompressible %llu\n"
+		"fallback queue_full %llu timeout %llu error %llu\n"
+		"doorbells %llu\n"
+		"decompress hw %llu sw %llu error %llu\n"
+		"ratio %llu%% (%llu / %llu bytes)\n"
+		"compress avg %llu ns max %llu ns\n"
+		"decompress avg %llu ns max %llu ns\n",
+		ufozip_hw_usable(&ufozip) ? "on" : "off",
+		s.hw_compress, s.sw_compress, s.incompressible,
+		s.queue_full, s.hw_timeout, s.hw_error,
+		s.doorbells,
+		s.hw_decompress, s.sw_decompress, s.decompress_error,
+		s.orig_bytes ? div64_u64(s.compr_bytes * 100, s.orig_bytes) : 0,
+		s.compr_bytes, s.orig_bytes,
+		compressed ? div64_u64(s.compress_ns, compressed) : 0,
+		s.compress_max_ns,
+		decompressed ? div64_u64(s.decompress_ns, decompressed) : 0,
+		s.decompress_max_ns);
+}
+
+/* any write clears the counters */
+static ssize_t ufozip_zcomp_stats_store(struct kobject *kobj,
+		struct kobj_attribute *attr, const char *buf, size_t count)
+{
+	struct ufozip_zcomp_stats s;
+
+	ufozip_zcomp_get_stats(&s, true);
+	return count;
+}
+
+static struct kobj_attribute ufozip_zcomp_stats_attr =
+	__ATTR(ufozip_zcomp_stats, S_IRUGO | S_IWUSR,
+	       ufozip_zcomp_stats_show, ufozip_zcomp_stats_store);
+
+static void ufozip_free_buffers(struct ufozip_engine *e)
+{
+	unsigned int i;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct ufozip_bounce *b = per_cpu_ptr(&ufozip_bounce, cpu);
+
+		if (b->in) {
+			dma_unmap_single(e->dev, b->in_dma, PAGE_SIZE,
+					 DMA_TO_DEVICE);
+			free_page((unsigned long)b->in);
+		}
+		if (b->out) {
+			dma_unmap_single(e->dev, b->out_dma, PAGE_SIZE,
+					 DMA_FROM_DEVICE);
+			free_page((unsigned long)b->out);
+		}
+		b->in = b->out = NULL;
+	}
+	if (!e->slots)
+		return;
+	for (i = 0; i <= e->slot_mask; i++) {
+		struct ufozip_slot *slot = &e->slots[i];
+
+		if (slot->src) {
+			dma_unmap_single(e->dev, slot->src_dma, PAGE_SIZE,
+					 DMA_TO_DEVICE);
+			free_page((unsigned long)slot->src);
+		}
+		if (slot->bufs) {
+			dma_unmap_single(e->dev, slot->bufs_dma, PAGE_SIZE,
+					 DMA_FROM_DEVICE);
+			free_page((unsigned long)slot->bufs);
+		}
+	}
+	kfree(e->slots);
+	e->slots = NULL;
+}
+
+/* a lowmem page mapped for the engine */
+static void *ufozip_map_page(struct device *dev, dma_addr_t *dma,
+		enum dma_data_direction dir)
+{
+	void *p = (void *)__get_free_page(GFP_KERNEL | __GFP_ZERO);
+
+	if (!p)
+		return NULL;
+	*dma = dma_map_single(dev, p, PAGE_SIZE, dir);
+	if (dma_mapping_error(dev, *dma)) {
+		free_page((unsigned long)p);
+		return NULL;
+	}
+	return p;
+}
+
+static int ufozip_alloc_buffers(struct ufozip_engine *e)
+{
+	unsigned int i;
+	int cpu;
+
+	e->slots = kcalloc(e->slot_mask + 1, sizeof(*e->slots), GFP_KERNEL);
+	if (!e->slots)
+		return -ENOMEM;
+	for (i = 0; i <= e->slot_mask; i++) {
+		struct ufozip_slot *slot = &e->slots[i];
+
+		slot->src = ufozip_map_page(e->dev, &slot->src_dma,
+					    DMA_TO_DEVICE);
+		slot->bufs = ufozip_map_page(e->dev, &slot->bufs_dma,
+					     DMA_FROM_DEVICE);
+		if (!slot->src || !slot->bufs)
+			return -ENOMEM;
+	}
+	for_each_possible_cpu(cpu) {
+		struct ufozip_bounce *b = per_cpu_ptr(&ufozip_bounce, cpu);
+
+		b->in = ufozip_map_page(e->dev, &b->in_dma, DMA_TO_DEVICE);
+		b->out = ufozip_map_page(e->dev, &b->out_dma, DMA_FROM_DEVICE);
+		if (!b->in || !b->out)
+			return -ENOMEM;
+	}
+	return 0;
+}
+
+static int ufozip_setup_ring(struct ufozip_engine *e, u32 features2)
+{
+	unsigned int order;
+
+	e->desc_type = ZRAM_FEATURES2_DESC_TYPE(features2) ? 1 : 0;
+	e->desc_size = e->desc_type ? 32 : 64;
+	e->ring_fixed = ZRAM_FEATURES2_DESC_FIXED(features2);
+	if (e->ring_fixed) {
+		u64 loc = zram_read_reg64(ZRAM_CDESC_LOC);
+
+		order = loc & 0xf;
+		e->ring = (void __force *)ioremap_nocache(
+			loc & ZRAM_CDESC_LOC_BASE_MASK, e->desc_size << order);
+		if (!e->ring)
+			return -ENOMEM;
+	} else {
+		order = UFOZIP_RING_ORDER;
+		e->ring = dma_alloc_coherent(e->dev, e->desc_size << order,
+					     &e->ring_dma, GFP_KERNEL);
+		if (!e->ring)
+			return -ENOMEM;
+		memset(e->ring, 0, e->desc_size << order);
+	}
+	e->ring_mask = (1U << order) - 1;
+	e->idx_mask = (1U << (order + 1)) - 1;
+	e->slot_mask = (1U << min(order, (unsigned int)UFOZIP_SLOTS_ORDER)) - 1;
+	return 0;
+}
+
+static void ufozip_free_ring(struct ufozip_engine *e)
+{
+	if (!e->ring)
+		return;
+	if (e->ring_fixed)
+		iounmap((void __iomem __force *)e->ring);
+	else
+		dma_free_coherent(e->dev, e->desc_size * (e->ring_mask + 1),
+				  e->ring, e->ring_dma);
+	e->ring = NULL;
+}
+
+static int __init ufozip_zcomp_init(void)
+{
+	struct ufozip_engine *e = &ufozip;
+	u32 features2;
+	int ret;
+
+	spin_lock_init(&e->lock);
+	spin_lock_init(&e->dec_lock);
+
+	/* mapped by the DVT module init, which runs before */
+	if (!ufozip_reg_kaddr) {
+		pr_err("ufozip: registers not mapped, lz4k only\n");
+		goto sysfs;
+	}
+
+	ufozip_pdev = platform_device_register_simple("ufozip-zcomp", -1,
+						      NULL, 0);
+	if (IS_ERR(ufozip_pdev)) {
+		ufozip_pdev = NULL;
+		goto sysfs;
+	}
+	e->dev = &ufozip_pdev->dev;
+	e->dev->dma_mask = &e->dev->coherent_dma_mask;
+	if (dma_set_mask_and_coherent(e->dev, DMA_BIT_MASK(32)))
+		goto err_dev;
+
+	ufozip_hwInit();
+	features2 = zram_read_reg(ZRAM_HWFEATURES2);
+	e->num_dcmd = clamp_t(unsigned int, ZRAM_FEATURES2_FIFOS(features2),
+			      1, UFOZIP_MAX_DCMD);
+	ret = ufozip_setup_ring(e, features2);
+	if (ret)
+		goto err_dev;
+	ret = ufozip_alloc_buffers(e);
+	if (ret)
+		goto err_buffers;
+
+	if (ufozip_start_ring(e))
+		goto err_buffers;
+	e->ready = true;
+	pr_info("ufozip: %u descriptors of type %u%s, %u in flight, %u decompressors\n",
+		e->ring_mask + 1, e->desc_type, e->ring_fixed ? " (fixed)" : "",
+		e->slot_mask + 1, e->num_dcmd);
+	goto sysfs;
+
+err_buffers:
+	ufozip_free_buffers(e);
+	ufozip_free_ring(e);
+err_dev:
+	platform_device_unregister(ufozip_pdev);
+	ufozip_pdev = NULL;
+	e->dev = NULL;
+	pr_err("ufozip: engine setup failed, lz4k only\n");
+sysfs:
+	ret = sysfs_create_file(kernel_kobj, &ufozip_zcomp_stats_attr.attr);
+	if (ret)
+		pr_err("ufozip: create sysfs file fail:%d\n", ret);
+	return 0;
+}
+late_initcall(ufozip_zcomp_init);
@@ -0,0 +1,88 @@
+/*
+ * UFOZIP page compression engine for zram
+ *
+ * Pages are queued on the UFOZIP compression descriptor ring without
+ * waiting for each other: every caller reserves a slot, fills it, and the
+ * doorbell (CDESC_WRIDX) is rung once for all the slots made ready since
+ * the last ring. Whoever polls first retires every completed descriptor.
+ * When the ring is full, the engine is not ready or a descriptor does not
+ * complete in time, the page is compressed with lz4k instead.
+ *
+ * Stored pages start with a tag byte, so that both formats can be
+ * decompressed:
+ *   UFOZIP_ZTAG_SW   lz4k stream
+ *   UFOZIP_ZTAG_HW   struct ufozip_zhdr, then the compressed buffers as
+ *                    the engine filled them
+ *
+ * Neither compress nor decompress sleeps; both may be called in atomic
+ * context, as zram does.
+ */
+
+#ifndef _UFOZIP_ZCOMP_H_
+#define _UFOZIP_ZCOMP_H_
+
+#include <linux/types.h>
+
+#define UFOZIP_ZTAG_SW		0x5a
+#define UFOZIP_ZTAG_HW		0xa5
+
+/* header of a page compressed by the engine */
+struct ufozip_zhdr {
+	u8 tag;
+	/* size codes (32 << code bytes) of the buffers used, in order */
+	u8 buf_sz[4];
+	u8 reserved;
+	u16 compr_size;
+	u32 hash;
+} __packed;
+
+struct ufozip_zcomp_stats {
+	u64 hw_compress;	/* pages compressed by the engine */
+	u64 sw_compress;	/* pages compressed by lz4k */
+	u64 queue_full;		/* fallbacks because the ring was full */
+	u64 hw_timeout;		/* fallbacks because a descriptor timed out */
+	u64 hw_error;		/* fallbacks because of a descriptor error */
+	u64 incompressible;	/* pages left uncompressed */
+	u64 doorbells;		/* CDESC_WRIDX writes */
+	u64 hw_decompress;
+	u64 sw_decompress;
+	u64 decompress_error;
+	u64 orig_bytes;		/* of the pages compressed */
+	u64 compr_bytes;	/* stored for them */
+	u64 compress_ns;	/* total and worst time spent in compress */
+	u64 compress_max_ns;
+	u64 decompress_ns;
+	u64 decompress_max_ns;
+};
+
+/*
+ * Compress the page at |src| into |dst|, which must hold 2 * PAGE_SIZE.
+ * |wrkmem| is LZ4K_MEM_COMPRESS bytes for the lz4k fallback. On return
+ * *dst_len is PAGE_SIZE if the page does not compress, and *hash the
+ * engine hash of the page or 0 if lz4k compressed it.
+ * Return 0 or a negative errno.
+ */
+int ufozip_zcomp_compress(const unsigned char *src, unsigned char *dst,
+		size_t *dst_len, void *wrkmem, u32 *hash);
+
+/*
+ * Decompress |src_len| bytes stored by ufozip_zcomp_compress() into the
+ * page at |dst|. Return 0 or a negative errno.
+ */
+int ufozip_zcomp_decompress(const unsigned char *src, size_t src_len,
+		unsigned char *dst);
+
+/* true once the engine is initialized; lz4k only otherwise */
+bool ufozip_zcomp_hw_ready(void);
+
+void ufozip_zcomp_get_stats(struct ufozip_zcomp_stats *stats, bool reset);
+
+/*
+ * Take the compression ring away from the engine, for the DVT tools:
+ * pages go to lz4k until ufozip_zcomp_release(), which programs the ring
+ * again. May sleep. Return 0, or -EBUSY if pages do not drain.
+ */
+int ufozip_zcomp_claim(void);
+void ufozip_zcomp_release(void);
+
+#endif /* _UFOZIP_ZCOMP_H_ */
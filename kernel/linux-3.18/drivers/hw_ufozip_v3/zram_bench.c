@@ -0,0 +1,429 @@
+/*
+ * UFOZIP compression throughput benchmark
+ *
+ *   echo "<pages> [poll|irq|hybrid|all]" > /sys/kernel/ufo_bench
+ *   cat /sys/kernel/ufo_bench
+ *
+ * Compresses <pages> pages of the case_0 data for every batch size
+ * (pages per doorbell) and cut value, and reports MB/s, ratio and how
+ * often the caller slept. A batch is written to the descriptor ring
+ * without per-descriptor cache maintenance: one flush for its source
+ * pages, one invalidate for its destination buffers, one flush for its
+ * descriptors and one CDESC_WRIDX write. Two batches are in flight.
+ *
+ * Completion:
+ *   poll    spin on the complete index
+ *   irq     the last descriptor of a batch interrupts, the caller sleeps
+ *   hybrid  spin for poll_us, then sleep on that interrupt
+ *
+ * The block size is the page: the live set_apb_default_normal() only
+ * varies the cut value, so that is what the sweep changes.
+ */
+
+#include <linux/types.h>
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/init.h>
+#include <linux/slab.h>
+#include <linux/mm.h>
+#include <linux/io.h>
+#include <linux/delay.h>
+#include <linux/ktime.h>
+#include <linux/jiffies.h>
+#include <linux/math64.h>
+#include <linux/mutex.h>
+#include <linux/kobject.h>
+#include <linux/sysfs.h>
+
+#include "zram_test_api.h"
+#include "hwzram.h"
+#include "ufozip_zcomp.h"
+
+#define BENCH_ORDER		6
+#define BENCH_SLOTS		(1 << BENCH_ORDER)
+#define BENCH_TIMEOUT_MS	1000
+
+extern const unsigned char ufozip_raw_tab[653728];
+extern void zram_set_cutval(uint8_t u1Val);
+
+static unsigned int poll_us = 20;
+module_param(poll_us, uint, 0644);
+MODULE_PARM_DESC(poll_us, "hybrid mode: spin this long before sleeping");
+
+enum {
+	BENCH_POLL,
+	BENCH_IRQ,
+	BENCH_HYBRID,
+	BENCH_MODES,
+};
+
+static const char * const bench_mode_name[BENCH_MODES] = {
+	"poll", "irq", "hybrid",
+};
+
+static const unsigned char bench_cut[] = { 2, 8, 32 };
+
+/* destination buffers of a page, as the zram backend uses them */
+static const u16 bench_buf_off[ZRAM_NUM_OF_FREE_BLOCKS] = {
+	0, 2048, 3072, 3584, 3840, 3968
+};
+
+struct ufo_bench {
+	void *ring;
+	bool ring_fixed;
+	unsigned int desc_type;
+	unsigned int desc_size;
+	unsigned int ring_mask;
+	unsigned int idx_mask;
+	/* descriptors in flight at most, a power of two */
+	unsigned int slots;
+	unsigned char *src;
+	unsigned char *dst;
+	/* free running; base is the counter of page 0 of the run */
+	unsigned int wr;
+	unsigned int cpl;
+	unsigned int base;
+	/* results of the run */
+	u64 compr_bytes;
+	unsigned int incompressible;
+	unsigned int errors;
+	unsigned int sleeps;
+};
+
+static DEFINE_MUTEX(bench_mutex);
+static char *bench_report;
+
+static inline volatile u32 *bench_desc(struct ufo_bench *b, unsigned int c)
+{
+	return b->ring + (c & b->ring_mask) * b->desc_size;
+}
+
+static inline unsigned int bench_page(struct ufo_bench *b, unsigned int c)
+{
+	return (c - b->base) & (b->slots - 1);
+}
+
+/* cache maintenance over descriptors [c, c + n), which may wrap */
+static void bench_sync_desc(struct ufo_bench *b, unsigned int c,
+		unsigned int n, bool to_device)
+{
+	unsigned int first = c & b->ring_mask;
+	unsigned int run = min(n, b->ring_mask + 1 - first);
+
+	while (n) {
+		void *p = (void *)bench_desc(b, first);
+
+		if (b->ring_fixed)
+			to_device ? zram_push_descr(p, run * b->desc_size) :
+				zram_pull_descr(p, run * b->desc_size);
+		else
+			to_device ? zram_dflush(p, run * b->desc_size) :
+				zram_dinvld(p, run * b->desc_size);
+		n -= run;
+		first = 0;
+		run = n;
+	}
+}
+
+static void bench_write_desc(struct ufo_bench *b, unsigned int c, bool irq)
+{
+	volatile u32 *d = bench_desc(b, c);
+	uint32_t src = zram_ptr2pa(b->src + bench_page(b, c) * PAGE_SIZE);
+	uint32_t dst = zram_ptr2pa(b->dst + bench_page(b, c) * PAGE_SIZE);
+	int i;
+
+	for (i = 0; i < ZRAM_NUM_OF_FREE_BLOCKS; i++) {
+		/* 2048 >> i bytes, encoded by the bit of half the size */
+		uint32_t buf = dst + bench_buf_off[i] + (1024 >> i);
+
+		if (b->desc_type) {
+			d[2 + i] = buf >> 5;
+		} else {
+			d[4 + 2 * i] = buf;
+			d[5 + 2 * i] = 0;
+		}
+	}
+	if (b->desc_type) {
+		d[0] = 0;
+		d[1] = (SZ_PEND << 28) | ((uint32_t)irq << 27) | (src >> 12);
+	} else {
+		d[0] = 0;
+		d[1] = 0;
+		d[3] = 0;
+		d[2] = src | (SZ_PEND << 1) | irq;
+	}
+}
+
+static void bench_submit(struct ufo_bench *b, unsigned int n, bool irq)
+{
+	unsigned int first = b->wr;
+	unsigned int page = bench_page(b, first);
+	unsigned int k;
+
+	zram_dflush(b->src + page * PAGE_SIZE, n * PAGE_SIZE);
+	zram_dinvld(b->dst + page * PAGE_SIZE, n * PAGE_SIZE);
+	for (k = 0; k < n; k++)
+		bench_write_desc(b, first + k, irq && k == n - 1);
+	bench_sync_desc(b, first, n, true);
+	wmb();
+	b->wr = first + n;
+	zram_write_reg(ZRAM_CDESC_WRIDX, b->wr & b->idx_mask);
+}
+
+/* account every completed descriptor. Return how many there were. */
+static unsigned int bench_reap(struct ufo_bench *b)
+{
+	unsigned int done = zram_read_reg(ZRAM_CDESC_CTRL) &
+		ZRAM_CDESC_CTRL_COMPLETE_IDX_MASK;
+	unsigned int n = (done - b->cpl) & b->idx_mask;
+	unsigned int k;
+
+	if (!n)
+		return 0;
+	bench_sync_desc(b, b->cpl, n, false);
+	for (k = 0; k < n; k++) {
+		volatile u32 *d = bench_desc(b, b->cpl + k);
+		unsigned int status, size;
+
+		if (b->desc_type) {
+			status = (d[1] >> 28) & 7;
+			size = (d[1] >> 12) & 0x1fff;
+		} else {
+			status = (d[2] >> 1) & 7;
+			size = d[0] >> 16;
+		}
+		if (status == SZ_COMPRESSED) {
+			b->compr_bytes += size;
+		} else if (status == SZ_COPIED || status == SZ_ABORT) {
+			b->compr_bytes += PAGE_SIZE;
+			b->incompressible++;
+		} else {
+			b->compr_bytes += PAGE_SIZE;
+			b->errors++;
+		}
+	}
+	b->cpl += n;
+	return n;
+}
+
+/* wait until every descriptor below |target| completed */
+static int bench_wait(struct ufo_bench *b, unsigned int target, int mode)
+{
+	ktime_t start = ktime_get();
+
+	while ((int)(target - b->cpl) > 0) {
+		s64 us;
+
+		if (bench_reap(b))
+			continue;
+		us = ktime_us_delta(ktime_get(), start);
+		if (us > BENCH_TIMEOUT_MS * 1000)
+			return -ETIMEDOUT;
+		if (mode == BENCH_POLL || (mode == BENCH_HYBRID && us < poll_us)) {
+			cpu_relax();
+			continue;
+		}
+		b->sleeps++;
+		/* a stale interrupt only costs another look at the index */
+		wait_comp_done_timeout(msecs_to_jiffies(BENCH_TIMEOUT_MS));
+	}
+	return 0;
+}
+
+static int bench_run(struct ufo_bench *b, unsigned int pages,
+		unsigned int batch, int mode, u64 *ns)
+{
+	ktime_t start;
+	unsigned int left = pages;
+	int ret;
+
+	drain_comp_done();
+	b->base = b->wr;
+	b->compr_bytes = 0;
+	b->incompressible = 0;
+	b->errors = 0;
+	b->sleeps = 0;
+
+	start = ktime_get();
+	while (left) {
+		unsigned int n = min(batch, left);
+
+		if (b->wr + n - b->cpl > b->slots) {
+			ret = bench_wait(b, b->wr + n - b->slots, mode);
+			if (ret)
+				return ret;
+		}
+		bench_submit(b, n, mode != BENCH_POLL);
+		left -= n;
+	}
+	ret = bench_wait(b, b->wr, mode);
+	*ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	return ret;
+}
+
+static void bench_release(struct ufo_bench *b)
+{
+	if (b->ring) {
+		if (b->ring_fixed)
+			iounmap((void __iomem __force *)b->ring);
+		else
+			free_page((unsigned long)b->ring);
+	}
+	if (b->src)
+		free_pages((unsigned long)b->src, BENCH_ORDER);
+	if (b->dst)
+		free_pages((unsigned long)b->dst, BENCH_ORDER);
+	memset(b, 0, sizeof(*b));
+}
+
+static int bench_setup(struct ufo_bench *b)
+{
+	uint32_t hwfeatures2 = zram_read_reg(ZRAM_HWFEATURES2);
+	unsigned int order, k, done;
+
+	memset(b, 0, sizeof(*b));
+	b->desc_type = ZRAM_FEATURES2_DESC_TYPE(hwfeatures2) ? 1 : 0;
+	b->desc_size = b->desc_type ? 32 : 64;
+	b->ring_fixed = ZRAM_FEATURES2_DESC_FIXED(hwfeatures2);
+	if (b->ring_fixed) {
+		uint64_t loc = zram_read_reg64(ZRAM_CDESC_LOC);
+
+		order = loc & 0xf;
+		b->ring = (void __force *)ioremap_nocache(
+			(uint32_t)loc & ~0x3fU, b->desc_size << order);
+	} else {
+		/* a page holds 64 descriptors of either type */
+		order = BENCH_ORDER;
+		b->ring = (void *)get_zeroed_page(GFP_KERNEL);
+	}
+	b->src = (unsigned char *)__get_free_pages(GFP_KERNEL, BENCH_ORDER);
+	b->dst = (unsigned char *)__get_free_pages(GFP_KERNEL, BENCH_ORDER);
+	if (!b->ring || !b->src || !b->dst) {
+		bench_release(b);
+		return -ENOMEM;
+	}
+	b->ring_mask = (1U << order) - 1;
+	b->idx_mask = (1U << (order + 1)) - 1;
+	b->slots = 1U << min(order, (unsigned int)BENCH_ORDER);
+
+	for (k = 0; k < BENCH_SLOTS; k++)
+		memcpy(b->src + k * PAGE_SIZE, ufozip_raw_tab +
+		       (k * PAGE_SIZE) % (sizeof(ufozip_raw_tab) - PAGE_SIZE),
+		       PAGE_SIZE);
+
+	if (!b->ring_fixed) {
+		zram_dflush(b->ring, PAGE_SIZE);
+		zram_write_reg(ZRAM_CDESC_LOC, zram_ptr2pa(b->ring) | order);
+	}
+	zram_write_reg(ZRAM_CDESC_CTRL, 1U << ZRAM_CDESC_CTRL_COMPRESS_ENABLE_SHIFT);
+	b->wr = zram_read_reg(ZRAM_CDESC_WRIDX) & b->idx_mask;
+	done = zram_read_reg(ZRAM_CDESC_CTRL) & ZRAM_CDESC_CTRL_COMPLETE_IDX_MASK;
+	if (b->wr != done) {
+		printf("ufo_bench: ring busy, write %u complete %u\n", b->wr, done);
+		bench_release(b);
+		return -EBUSY;
+	}
+	b->cpl = b->wr;
+	return 0;
+}
+
+static int bench_sweep(unsigned int pages, int only_mode)
+{
+	struct ufo_bench b;
+	size_t len = 0;
+	int c, mode, ret;
+	unsigned int batch;
+
+	ret = ufozip_zcomp_claim();
+	if (ret)
+		return ret;
+	ret = bench_setup(&b);
+	if (ret) {
+		ufozip_zcomp_release();
+		return ret;
+	}
+
+	len += scnprintf(bench_report + len, PAGE_SIZE - len,
+		"pages %u, %u descriptors of type %u%s\n",
+		pages, b.ring_mask + 1, b.desc_type, b.ring_fixed ? " (fixed)" : "");
+	for (c = 0; c < ARRAY_SIZE(bench_cut) && !ret; c++) {
+		zram_set_cutval(bench_cut[c]);
+		for (batch = 1; batch <= b.slots / 2 && !ret; batch <<= 1) {
+			for (mode = 0; mode < BENCH_MODES && !ret; mode++) {
+				u64 ns;
+
+				if (only_mode >= 0 && mode != only_mode)
+					continue;
+				ret = bench_run(&b, pages, batch, mode, &ns);
+				if (ret) {
+					len += scnprintf(bench_report + len, PAGE_SIZE - len,
+						"cut %2u batch %2u %-6s timed out\n",
+						bench_cut[c], batch, bench_mode_name[mode]);
+					break;
+				}
+				len += scnprintf(bench_report + len, PAGE_SIZE - len,
+					"cut %2u batch %2u %-6s %5llu MB/s ratio %3llu%% sleeps %u incompressible %u errors %u\n",
+					bench_cut[c], batch, bench_mode_name[mode],
+					div64_u64((u64)pages * PAGE_SIZE * 1000, ns ? ns : 1),
+					div64_u64(b.compr_bytes * 100, (u64)pages * PAGE_SIZE),
+					b.sleeps, b.incompressible, b.errors);
+			}
+		}
+	}
+
+	bench_release(&b);
+	/* back to the default configuration and the zram ring */
+	ufozip_hwInit();
+	ufozip_zcomp_release();
+	printf("%s", bench_report);
+	return ret;
+}
+
+static ssize_t ufo_bench_show(struct kobject *kobj, struct kobj_attribute *attr,
+		char *buf)
+{
+	ssize_t count;
+
+	mutex_lock(&bench_mutex);
+	count = scnprintf(buf, PAGE_SIZE, "%s", bench_report ? bench_report : "");
+	mutex_unlock(&bench_mutex);
+	return count;
+}
+
+static ssize_t ufo_bench_store(struct kobject *kobj, struct kobj_attribute *attr,
+		const char *buf, size_t count)
+{
+	char mode_name[8] = "all";
+	unsigned int pages;
+	int mode = -1, k, ret;
+
+	if (sscanf(buf, "%u %7s", &pages, mode_name) < 1 || !pages)
+		return -EINVAL;
+	for (k = 0; k < BENCH_MODES; k++)
+		if (!strcmp(mode_name, bench_mode_name[k]))
+			mode = k;
+	if (mode < 0 && strcmp(mode_name, "all"))
+		return -EINVAL;
+	if (!ufozip_reg_kaddr)
+		return -ENODEV;
+
+	mutex_lock(&bench_mutex);
+	if (!bench_report)
+		bench_report = kzalloc(PAGE_SIZE, GFP_KERNEL);
+	ret = bench_report ? bench_sweep(pages, mode) : -ENOMEM;
+	mutex_unlock(&bench_mutex);
+	return ret ? ret : count;
+}
+
+static struct kobj_attribute ufo_bench_attr =
+	__ATTR(ufo_bench, S_IRUSR | S_IWUSR | S_IRGRP, ufo_bench_show, ufo_bench_store);
+
+static int __init ufo_bench_init(void)
+{
+	int r = sysfs_create_file(kernel_kobj, &ufo_bench_attr.attr);
+
+	if (r)
+		printk("create sysfs file fail:%d\n", r);
+	return 0;
+}
+late_initcall(ufo_bench_init);
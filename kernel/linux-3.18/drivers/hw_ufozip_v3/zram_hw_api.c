@@ -839,6 +839,18 @@ void wait_comp_done(void)
 	down(&ufozip_comp_irq_sema);
     printf("wait compress...done\n");
 }
+// Wait for a compress interrupt without the messages above.
+// Returns 0, or -ETIME after |timeout| jiffies.
+int wait_comp_done_timeout(long timeout)
+{
+	return down_timeout(&ufozip_comp_irq_sema, timeout);
+}
+// Forget the compress interrupts nobody waited for
+void drain_comp_done(void)
+{
+	while (!down_trylock(&ufozip_comp_irq_sema))
+		;
+}
 void wait_dcomp_done(void)
 {
     printf("wait decompress...\n");
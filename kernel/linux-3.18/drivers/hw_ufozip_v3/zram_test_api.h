@@ -74,6 +74,16 @@ void zram_pull_descr( void * addr, uintptr_t size);
 
 bool zram_test_lz4k( void *addr, uintptr_t size,int *out_length);
 
+// mapping of the registers, 0 until the DVT module init has run
+extern uint32_t ufozip_reg_kaddr;
+
+// apply the default encoder/decoder configuration
+void ufozip_hwInit(void);
+
+// compress completion interrupts, as counted by ufozip_isr()
+int wait_comp_done_timeout(long timeout);
+void drain_comp_done(void);
+
 //#define UFO_REG_PADDR		0x102a0000
 #define UFO_REG_PADDR		0x100e0000
 
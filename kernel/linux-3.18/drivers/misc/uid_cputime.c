@@ -18,116 +18,167 @@
 #include <linux/hashtable.h>
 #include <linux/init.h>
 #include <linux/kernel.h>
+#include <linux/kernel_stat.h>
 #include <linux/list.h>
+#include <linux/percpu.h>
 #include <linux/proc_fs.h>
 #include <linux/profile.h>
+#include <linux/rculist.h>
 #include <linux/sched.h>
 #include <linux/seq_file.h>
 #include <linux/slab.h>
+#include <linux/spinlock.h>
 #include <linux/uaccess.h>
 
 #define UID_HASH_BITS	10
 DECLARE_HASHTABLE(hash_table, UID_HASH_BITS);
 
-static DEFINE_MUTEX(uid_lock);
+/*
+ * Times are charged to the UID of the running task as they are accounted
+ * by the scheduler, into per-CPU counters. Lookups are RCU protected,
+ * uid_lock only serializes adding and removing entries.
+ */
+static DEFINE_SPINLOCK(uid_lock);
 static struct proc_dir_entry *parent;
 
+struct uid_cputime {
+	u64 utime;
+	u64 stime;
+	u64 power;
+};
+
 struct uid_entry {
 	uid_t uid;
-	cputime_t utime;
-	cputime_t stime;
-	cputime_t active_utime;
-	cputime_t active_stime;
-	unsigned long long active_power;
-	unsigned long long power;
+	struct uid_cputime __percpu *time;
 	struct hlist_node hash;
+	struct rcu_head rcu;
 };
 
 static struct uid_entry *find_uid_entry(uid_t uid)
 {
 	struct uid_entry *uid_entry;
-	hash_for_each_possible(hash_table, uid_entry, hash, uid) {
+	hash_for_each_possible_rcu(hash_table, uid_entry, hash, uid) {
 		if (uid_entry->uid == uid)
 			return uid_entry;
 	}
 	return NULL;
 }
 
+/* Must be called under rcu_read_lock(), from any context */
 static struct uid_entry *find_or_register_uid(uid_t uid)
 {
-	struct uid_entry *uid_entry;
+	struct uid_entry *uid_entry, *new_entry;
+	unsigned long flags;
 
 	uid_entry = find_uid_entry(uid);
 	if (uid_entry)
 		return uid_entry;
 
-	uid_entry = kzalloc(sizeof(struct uid_entry), GFP_ATOMIC);
-	if (!uid_entry)
+	new_entry = kzalloc(sizeof(struct uid_entry), GFP_ATOMIC);
+	if (!new_entry)
 		return NULL;
 
-	uid_entry->uid = uid;
+	new_entry->time = alloc_percpu_gfp(struct uid_cputime, GFP_ATOMIC);
+	if (!new_entry->time) {
+		kfree(new_entry);
+		return NULL;
+	}
+	new_entry->uid = uid;
+
+	spin_lock_irqsave(&uid_lock, flags);
+	/* someone else may have registered it meanwhile */
+	uid_entry = find_uid_entry(uid);
+	if (!uid_entry) {
+		hash_add_rcu(hash_table, &new_entry->hash, uid);
+		uid_entry = new_entry;
+		new_entry = NULL;
+	}
+	spin_unlock_irqrestore(&uid_lock, flags);
 
-	hash_add(hash_table, &uid_entry->hash, uid);
+	if (new_entry) {
+		free_percpu(new_entry->time);
+		kfree(new_entry);
+	}
 
 	return uid_entry;
 }
 
+static void free_uid_entry(struct rcu_head *rcu)
+{
+	struct uid_entry *uid_entry = container_of(rcu, struct uid_entry, rcu);
+
+	free_percpu(uid_entry->time);
+	kfree(uid_entry);
+}
+
+static inline uid_t task_uid_val(struct task_struct *task)
+{
+	return from_kuid_munged(&init_user_ns, task_uid(task));
+}
+
+/*
+ * Called by the scheduler for every slice of user or system time
+ * accounted to @p, with the power estimate for that slice.
+ */
+void uid_cputime_account(struct task_struct *p, cputime_t cputime, bool user,
+			 u64 power)
+{
+	struct uid_entry *uid_entry;
+
+	/* if this task is exiting, we have already accounted for the
+	 * time and power.
+	 */
+	if (p->cpu_power == ULLONG_MAX)
+		return;
+
+	rcu_read_lock();
+	uid_entry = find_or_register_uid(task_uid_val(p));
+	if (uid_entry) {
+		if (user)
+			this_cpu_add(uid_entry->time->utime,
+				     (__force u64)cputime);
+		else
+			this_cpu_add(uid_entry->time->stime,
+				     (__force u64)cputime);
+		this_cpu_add(uid_entry->time->power, power);
+	}
+	rcu_read_unlock();
+}
+
 static int uid_stat_show(struct seq_file *m, void *v)
 {
 	struct uid_entry *uid_entry;
-	struct task_struct *task, *temp;
-	cputime_t utime;
-	cputime_t stime;
 	unsigned long bkt;
+	int cpu;
 
-	mutex_lock(&uid_lock);
+	rcu_read_lock();
+	hash_for_each_rcu(hash_table, bkt, uid_entry, hash) {
+		u64 total_utime = 0, total_stime = 0, total_power = 0;
 
-	hash_for_each(hash_table, bkt, uid_entry, hash) {
-		uid_entry->active_stime = 0;
-		uid_entry->active_utime = 0;
-		uid_entry->active_power = 0;
-	}
+		for_each_possible_cpu(cpu) {
+			struct uid_cputime *time =
+				per_cpu_ptr(uid_entry->time, cpu);
 
-	read_lock(&tasklist_lock);
-	do_each_thread(temp, task) {
-		uid_entry = find_or_register_uid(from_kuid_munged(
-			current_user_ns(), task_uid(task)));
-		if (!uid_entry) {
-			read_unlock(&tasklist_lock);
-			mutex_unlock(&uid_lock);
-			pr_err("%s: failed to find the uid_entry for uid %d\n",
-				__func__, from_kuid_munged(current_user_ns(),
-				task_uid(task)));
-			return -ENOMEM;
+			total_utime += time->utime;
+			total_stime += time->stime;
+			total_power += time->power;
 		}
-		/* if this task is exiting, we have already accounted for the
-		 * time and power.
-		 */
-		if (task->cpu_power == ULLONG_MAX)
-			continue;
-		task_cputime_adjusted(task, &utime, &stime);
-		uid_entry->active_utime += utime;
-		uid_entry->active_stime += stime;
-		uid_entry->active_power += task->cpu_power;
-	} while_each_thread(temp, task);
-	read_unlock(&tasklist_lock);
-
-	hash_for_each(hash_table, bkt, uid_entry, hash) {
-		cputime_t total_utime = uid_entry->utime +
-							uid_entry->active_utime;
-		cputime_t total_stime = uid_entry->stime +
-							uid_entry->active_stime;
-		unsigned long long total_power = uid_entry->power +
-							uid_entry->active_power;
+		/* exit adjustments of tasks that changed their UID */
+		if ((s64)total_utime < 0)
+			total_utime = 0;
+		if ((s64)total_stime < 0)
+			total_stime = 0;
 		seq_printf(m, "%d: %llu %llu %llu\n", uid_entry->uid,
 			(unsigned long long)jiffies_to_msecs(
-				cputime_to_jiffies(total_utime)) * USEC_PER_MSEC,
+				cputime_to_jiffies((__force cputime_t)
+					total_utime)) * USEC_PER_MSEC,
 			(unsigned long long)jiffies_to_msecs(
-				cputime_to_jiffies(total_stime)) * USEC_PER_MSEC,
-			total_power);
+				cputime_to_jiffies((__force cputime_t)
+					total_stime)) * USEC_PER_MSEC,
+			(unsigned long long)total_power);
 	}
+	rcu_read_unlock();
 
-	mutex_unlock(&uid_lock);
 	return 0;
 }
 
@@ -174,19 +225,19 @@ static ssize_t uid_remove_write(struct file *file,
 		kstrtol(end_uid, 10, &uid_end) != 0) {
 		return -EINVAL;
 	}
-	mutex_lock(&uid_lock);
+	spin_lock_irq(&uid_lock);
 
 	for (; uid_start <= uid_end; uid_start++) {
 		hash_for_each_possible_safe(hash_table, uid_entry, tmp,
 							hash, (uid_t)uid_start) {
 			if (uid_start == uid_entry->uid) {
-				hash_del(&uid_entry->hash);
-				kfree(uid_entry);
+				hash_del_rcu(&uid_entry->hash);
+				call_rcu(&uid_entry->rcu, free_uid_entry);
 			}
 		}
 	}
 
-	mutex_unlock(&uid_lock);
+	spin_unlock_irq(&uid_lock);
 	return count;
 }
 
@@ -196,6 +247,11 @@ static const struct file_operations uid_remove_fops = {
 	.write		= uid_remove_write,
 };
 
+/*
+ * The scheduler accounted the raw user and system times of the task. On
+ * exit replace them by the adjusted times, scaled to the precise runtime,
+ * as reported for the task everywhere else.
+ */
 static int process_notifier(struct notifier_block *self,
 			unsigned long cmd, void *v)
 {
@@ -207,22 +263,25 @@ static int process_notifier(struct notifier_block *self,
 	if (!task)
 		return NOTIFY_OK;
 
-	mutex_lock(&uid_lock);
-	uid = from_kuid_munged(current_user_ns(), task_uid(task));
+	task_cputime_adjusted(task, &utime, &stime);
+
+	rcu_read_lock();
+	uid = task_uid_val(task);
 	uid_entry = find_or_register_uid(uid);
 	if (!uid_entry) {
 		pr_err("%s: failed to find uid %d\n", __func__, uid);
 		goto exit;
 	}
 
-	task_cputime_adjusted(task, &utime, &stime);
-	uid_entry->utime += utime;
-	uid_entry->stime += stime;
-	uid_entry->power += task->cpu_power;
+	/* may be negative, the unsigned sums wrap back */
+	this_cpu_add(uid_entry->time->utime,
+		     (__force u64)utime - (__force u64)task->utime);
+	this_cpu_add(uid_entry->time->stime,
+		     (__force u64)stime - (__force u64)task->stime);
 	task->cpu_power = ULLONG_MAX;
 
 exit:
-	mutex_unlock(&uid_lock);
+	rcu_read_unlock();
 	return NOTIFY_OK;
 }
 
@@ -232,8 +291,6 @@ static struct notifier_block process_notifier_block = {
 
 static int __init proc_uid_cputime_init(void)
 {
-	hash_init(hash_table);
-
 	parent = proc_mkdir("uid_cputime", NULL);
 	if (!parent) {
 		pr_err("%s: failed to create proc entry\n", __func__);
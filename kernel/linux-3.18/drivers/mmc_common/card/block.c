@@ -72,6 +72,23 @@ MODULE_ALIAS("mmc:block");
 #define PACKED_CMD_VER	0x01
 #define PACKED_CMD_WR	0x02
 
+/*
+ * Read priority: a run of sequential writes longer than this is streaming
+ * (e.g. a recording) and must not hold up reads. Packed writes of such a
+ * stream are limited to MMC_BLK_RD_PRIO_SECTORS while reads are waiting.
+ */
+#define MMC_BLK_STREAM_SECTORS		(8 * 1024 * 2)	/* 8 MiB */
+#define MMC_BLK_RD_PRIO_SECTORS		(512 * 2)	/* 512 KiB */
+
+/*
+ * Command queue: task slots kept free for reads, ready writes that may be
+ * passed over by ready reads before one is executed, and empty queue
+ * status polls before backing off.
+ */
+#define MMC_BLK_CMDQ_READ_SLOTS		2
+#define MMC_BLK_CMDQ_WRITE_STARVE	8
+#define MMC_BLK_CMDQ_FAST_POLLS		16
+
 static DEFINE_MUTEX(block_mutex);
 
 /*
@@ -135,6 +152,9 @@ enum {
 
 module_param(perdev_minors, int, 0444);
 MODULE_PARM_DESC(perdev_minors, "Minors numbers to allocate per device");
+static bool read_prio = true;
+module_param(read_prio, bool, 0644);
+MODULE_PARM_DESC(read_prio, "Do not let streaming writes delay reads");
 mtk_mmc_deviceinfo_user mtk_mmc_deviceinfo;
 static inline int mmc_blk_part_switch(struct mmc_card *card,
 				      struct mmc_blk_data *md);
@@ -695,6 +715,13 @@ static int mmc_blk_ioctl_cmd(struct block_device *bdev,
 	if (err)
 		goto cmd_rel_host;
 
+	/* Arbitrary commands are not allowed in command queue mode */
+	if (card->ext_csd.cmdq_en) {
+		err = mmc_cmdq_disable(card);
+		if (err)
+			goto cmd_rel_host;
+	}
+
 	if (idata->ic.is_acmd) {
 		err = mmc_app_cmd(card->host, card);
 		if (err)
@@ -1574,6 +1601,28 @@ free:
 	return check;
 }
 
+/*
+ * Adjust the sg list so it is the same size as the
+ * request.
+ */
+static void mmc_blk_trim_sg(struct mmc_blk_request *brq, struct request *req)
+{
+	if (brq->data.blocks != blk_rq_sectors(req)) {
+		int i, data_size = brq->data.blocks << 9;
+		struct scatterlist *sg;
+
+		for_each_sg(brq->data.sg, sg, brq->data.sg_len, i) {
+			data_size -= sg->length;
+			if (data_size <= 0) {
+				sg->length += data_size;
+				i++;
+				break;
+			}
+		}
+		brq->data.sg_len = i;
+	}
+}
+
 static void mmc_blk_rw_rq_prep(struct mmc_queue_req *mqrq,
 			       struct mmc_card *card,
 			       int disable_multi,
@@ -1712,25 +1761,7 @@ static void mmc_blk_rw_rq_prep(struct mmc_queue_req *mqrq,
 
 	brq->data.sg = mqrq->sg;
 	brq->data.sg_len = mmc_queue_map_sg(mq, mqrq);
-
-	/*
-	 * Adjust the sg list so it is the same size as the
-	 * request.
-	 */
-	if (brq->data.blocks != blk_rq_sectors(req)) {
-		int i, data_size = brq->data.blocks << 9;
-		struct scatterlist *sg;
-
-		for_each_sg(brq->data.sg, sg, brq->data.sg_len, i) {
-			data_size -= sg->length;
-			if (data_size <= 0) {
-				sg->length += data_size;
-				i++;
-				break;
-			}
-		}
-		brq->data.sg_len = i;
-	}
+	mmc_blk_trim_sg(brq, req);
 
 	mqrq->mmc_active.mrq = &brq->mrq;
 	mqrq->mmc_active.err_check = mmc_blk_err_check;
@@ -1754,6 +1785,42 @@ static inline u8 mmc_calc_packed_hdr_segs(struct request_queue *q,
 	return nr_segs;
 }
 
+/*
+ * Track runs of sequential writes. Returns true once the run has become
+ * long enough to be a stream whose writes should give way to reads.
+ */
+static bool mmc_blk_write_stream(struct mmc_queue *mq, struct request *req)
+{
+	if (blk_rq_pos(req) == mq->wr_next)
+		mq->wr_run += blk_rq_sectors(req);
+	else
+		mq->wr_run = blk_rq_sectors(req);
+	mq->wr_next = blk_rq_pos(req) + blk_rq_sectors(req);
+
+	return mq->wr_run >= MMC_BLK_STREAM_SECTORS;
+}
+
+/*
+ * Reads (and synchronous writes) are waiting when the queue has more sync
+ * requests allocated than the driver is holding.
+ */
+static bool mmc_blk_reads_waiting(struct mmc_queue *mq, int held_sync)
+{
+	struct request *prev = mq->mqrq_prev->req;
+
+	if (prev && rq_is_sync(prev))
+		held_sync++;
+
+	return mq->queue->nr_rqs[BLK_RW_SYNC] > held_sync;
+}
+
+static inline void mmc_blk_lat_done(struct mmc_card *card, int write,
+				    ktime_t start)
+{
+	mmc_lat_hist_add(card, write,
+			 (unsigned int) ktime_us_delta(ktime_get(), start));
+}
+
 static u8 mmc_blk_prep_packed_list(struct mmc_queue *mq, struct request *req)
 {
 	struct request_queue *q = mq->queue;
@@ -1765,9 +1832,14 @@ static u8 mmc_blk_prep_packed_list(struct mmc_queue *mq, struct request *req)
 	unsigned int req_sectors = 0, phys_segments = 0;
 	unsigned int max_blk_count, max_phys_segs;
 	bool put_back = true;
+	bool stream = false;
+	int held_sync;
 	u8 max_packed_rw = 0;
 	u8 reqs = 0;
 
+	if (rq_data_dir(cur) == WRITE)
+		stream = mmc_blk_write_stream(mq, cur);
+
 	if (!(md->flags & MMC_BLK_PACKED_CMD))
 		goto no_packed;
 
@@ -1801,6 +1873,7 @@ static u8 mmc_blk_prep_packed_list(struct mmc_queue *mq, struct request *req)
 		req_sectors += mmc_large_sector(card) ? 8 : 1;
 		phys_segments += mmc_calc_packed_hdr_segs(q, card);
 	}
+	held_sync = rq_is_sync(cur);
 
 	do {
 		if (reqs >= max_packed_rw - 1) {
@@ -1835,11 +1908,19 @@ static u8 mmc_blk_prep_packed_list(struct mmc_queue *mq, struct request *req)
 		if (req_sectors > max_blk_count)
 			break;
 
+		/* Keep the transfer short if a stream is holding up reads */
+		if (stream && read_prio &&
+		    req_sectors > MMC_BLK_RD_PRIO_SECTORS &&
+		    mmc_blk_reads_waiting(mq, held_sync))
+			break;
+
 		phys_segments +=  next->nr_phys_segments;
 		if (phys_segments > max_phys_segs)
 			break;
 
 		list_add_tail(&next->queuelist, &mqrq->packed->list);
+		held_sync += rq_is_sync(next);
+		stream = mmc_blk_write_stream(mq, next);
 		cur = next;
 		reqs++;
 	} while (1);
@@ -1975,7 +2056,8 @@ static int mmc_blk_cmd_err(struct mmc_blk_data *md, struct mmc_card *card,
 	return ret;
 }
 
-static int mmc_blk_end_packed_req(struct mmc_queue_req *mq_rq)
+static int mmc_blk_end_packed_req(struct mmc_card *card,
+				  struct mmc_queue_req *mq_rq)
 {
 	struct request *prq;
 	struct mmc_packed *packed = mq_rq->packed;
@@ -2000,6 +2082,7 @@ static int mmc_blk_end_packed_req(struct mmc_queue_req *mq_rq)
 		}
 		list_del_init(&prq->queuelist);
 		blk_end_request(prq, 0, blk_rq_bytes(prq));
+		mmc_blk_lat_done(card, 1, mq_rq->start);
 		i++;
 	}
 
@@ -2110,11 +2193,15 @@ static int mmc_blk_issue_rw_rq(struct mmc_queue *mq, struct request *rqc)
 			mmc_blk_reset_success(md, type);
 
 			if (mmc_packed_cmd(mq_rq->cmd_type)) {
-				ret = mmc_blk_end_packed_req(mq_rq);
+				ret = mmc_blk_end_packed_req(card, mq_rq);
 				break;
 			} else {
 				ret = blk_end_request(req, 0,
 						brq->data.bytes_xfered);
+				if (!ret)
+					mmc_blk_lat_done(card,
+							 type == MMC_BLK_WRITE,
+							 mq_rq->start);
 			}
 
 			/*
@@ -2235,6 +2322,336 @@ static int mmc_blk_issue_rw_rq(struct mmc_queue *mq, struct request *rqc)
 	return 0;
 }
 
+/*
+ * Command queue. Requests are queued in the card as tasks with CMD44/CMD45
+ * and executed with CMD46/CMD47 once the card reports them ready in its
+ * Queue Status Register. Only one data transfer is in flight at a time,
+ * but the card is free to reorder, prefetch and program the queued tasks.
+ * On errors the queue is discarded and the requests go back to the block
+ * layer; if a reset does not help, the legacy path takes over.
+ */
+static int mmc_blk_cmdq_cmd(struct mmc_card *card, u32 opcode, u32 arg,
+			    u32 *resp)
+{
+	struct mmc_command cmd = {0};
+	int err;
+
+	cmd.opcode = opcode;
+	cmd.arg = arg;
+	if (opcode == MMC_CMDQ_TASK_MGMT)
+		cmd.flags = MMC_RSP_R1B | MMC_CMD_AC;
+	else
+		cmd.flags = MMC_RSP_R1 | MMC_CMD_AC;
+
+	err = mmc_wait_for_cmd(card->host, &cmd, 0);
+	if (err)
+		return err;
+
+	/* CMD13 with SQS set returns the queue status instead of R1 */
+	if (opcode != MMC_SEND_STATUS && (cmd.resp[0] & CMD_ERRORS))
+		return -EIO;
+
+	if (resp)
+		*resp = cmd.resp[0];
+	return 0;
+}
+
+static int mmc_blk_cmdq_queue_task(struct mmc_queue *mq, struct request *req)
+{
+	struct mmc_blk_data *md = mq->data;
+	struct mmc_card *card = md->queue.card;
+	unsigned int tag, blocks;
+	u32 arg, addr;
+	int err;
+
+	tag = ffz(mq->cmdq_pending);
+	blocks = min_t(unsigned int, blk_rq_sectors(req),
+		       card->host->max_blk_count);
+	blocks = min_t(unsigned int, blocks, card->host->max_req_size >> 9);
+	blocks = min_t(unsigned int, blocks, MMC_CMDQ_MAX_BLOCKS);
+
+	arg = blocks | tag << MMC_CMDQ_TASK_ID_SHIFT;
+	if (rq_data_dir(req) == READ) {
+		arg |= MMC_CMDQ_TASK_READ;
+		if (read_prio)
+			arg |= MMC_CMDQ_TASK_PRIO;
+	} else if (mmc_req_rel_wr(req) && (md->flags & MMC_BLK_REL_WR)) {
+		arg |= MMC_CMDQ_TASK_REL_WR;
+	}
+
+	addr = blk_rq_pos(req);
+	if (!mmc_card_blockaddr(card))
+		addr <<= 9;
+
+	err = mmc_blk_cmdq_cmd(card, MMC_QUE_TASK_PARAMS, arg, NULL);
+	if (!err)
+		err = mmc_blk_cmdq_cmd(card, MMC_QUE_TASK_ADDR, addr, NULL);
+	if (err)
+		return err;
+
+	mq->cmdq_req[tag] = req;
+	mq->cmdq_blocks[tag] = blocks;
+	__set_bit(tag, &mq->cmdq_pending);
+	if (rq_data_dir(req) == READ)
+		__set_bit(tag, &mq->cmdq_reads);
+	/* Read the queue status again, so that the new task is seen */
+	mq->cmdq_ready = 0;
+
+	return tag;
+}
+
+static void mmc_blk_cmdq_off(struct mmc_queue *mq)
+{
+	struct mmc_card *card = mq->card;
+
+	pr_warn("%s: command queue disabled, using legacy commands\n",
+		mmc_hostname(card->host));
+	mmc_cmdq_disable(card);
+	card->ext_csd.cmdq_support = false;
+	mq->cmdq_depth = 0;
+}
+
+/*
+ * Discard the queue in the card, give all queued requests and @req back
+ * to the block layer and reset the card. Stop using the command queue if
+ * the last reset did not help.
+ */
+static void mmc_blk_cmdq_recover(struct mmc_queue *mq, struct request *req,
+				 int type)
+{
+	struct mmc_blk_data *md = mq->data;
+	struct mmc_card *card = md->queue.card;
+	struct request_queue *q = mq->queue;
+	int tag;
+
+	pr_err("%s: command queue error, recovering\n", md->disk->disk_name);
+
+	mmc_blk_cmdq_cmd(card, MMC_CMDQ_TASK_MGMT, MMC_CMDQ_DISCARD_QUEUE,
+			 NULL);
+
+	spin_lock_irq(q->queue_lock);
+	for_each_set_bit(tag, &mq->cmdq_pending, MMC_CMDQ_MAX_DEPTH) {
+		blk_requeue_request(q, mq->cmdq_req[tag]);
+		mq->cmdq_req[tag] = NULL;
+	}
+	if (req)
+		blk_requeue_request(q, req);
+	spin_unlock_irq(q->queue_lock);
+
+	mq->cmdq_pending = 0;
+	mq->cmdq_ready = 0;
+	mq->cmdq_reads = 0;
+
+	if (mmc_blk_reset(md, card->host, type) || !card->ext_csd.cmdq_en)
+		mmc_blk_cmdq_off(mq);
+}
+
+static int mmc_blk_cmdq_exec_task(struct mmc_queue *mq, int tag)
+{
+	struct mmc_blk_data *md = mq->data;
+	struct mmc_card *card = md->queue.card;
+	struct mmc_queue_req *mqrq = mq->mqrq_cur;
+	struct mmc_blk_request *brq = &mqrq->brq;
+	struct request *req = mq->cmdq_req[tag];
+	int write = rq_data_dir(req) == WRITE;
+	int type = write ? MMC_BLK_WRITE : MMC_BLK_READ;
+	ktime_t start = mq->cmdq_start[tag];
+
+	memset(brq, 0, sizeof(struct mmc_blk_request));
+	mqrq->req = req;
+	mqrq->cmd_type = MMC_PACKED_NONE;
+	brq->mrq.cmd = &brq->cmd;
+	brq->mrq.data = &brq->data;
+
+	brq->cmd.opcode = write ? MMC_EXECUTE_WRITE_TASK :
+				  MMC_EXECUTE_READ_TASK;
+	brq->cmd.arg = tag << MMC_CMDQ_TASK_ID_SHIFT;
+	brq->cmd.flags = MMC_RSP_R1 | MMC_CMD_ADTC;
+	brq->data.blksz = 512;
+	brq->data.blocks = mq->cmdq_blocks[tag];
+	brq->data.flags = write ? MMC_DATA_WRITE : MMC_DATA_READ;
+	mmc_set_data_timeout(&brq->data, card);
+
+	brq->data.sg = mqrq->sg;
+	brq->data.sg_len = mmc_queue_map_sg(mq, mqrq);
+	mmc_blk_trim_sg(brq, req);
+
+	mmc_queue_bounce_pre(mqrq);
+	mmc_wait_for_req(card->host, &brq->mrq);
+	mmc_queue_bounce_post(mqrq);
+	mqrq->req = NULL;
+
+	__clear_bit(tag, &mq->cmdq_pending);
+	__clear_bit(tag, &mq->cmdq_ready);
+	__clear_bit(tag, &mq->cmdq_reads);
+	mq->cmdq_req[tag] = NULL;
+
+	if (brq->cmd.error || brq->data.error ||
+	    (brq->cmd.resp[0] & CMD_ERRORS)) {
+		pr_err("%s: task %d failed, cmd %d data %d status %#x\n",
+		       req->rq_disk->disk_name, tag, brq->cmd.error,
+		       brq->data.error, brq->cmd.resp[0]);
+		mmc_blk_cmdq_recover(mq, req, type);
+		return 0;
+	}
+	mmc_blk_reset_success(md, type);
+
+	if (blk_end_request(req, 0, brq->data.bytes_xfered)) {
+		/* Cut short by the block count limit, queue the rest */
+		tag = mmc_blk_cmdq_queue_task(mq, req);
+		if (tag < 0) {
+			mmc_blk_cmdq_recover(mq, req, type);
+			return 0;
+		}
+		mq->cmdq_start[tag] = start;
+		return 1;
+	}
+
+	mmc_blk_lat_done(card, write, start);
+	return 1;
+}
+
+static int mmc_blk_cmdq_run(struct mmc_queue *mq)
+{
+	struct mmc_card *card = mq->card;
+	unsigned long ready, reads;
+	u32 qsr;
+
+	if (!mq->cmdq_ready) {
+		if (mmc_blk_cmdq_cmd(card, MMC_SEND_STATUS,
+				     card->rca << 16 | MMC_SEND_STATUS_SQS,
+				     &qsr)) {
+			mmc_blk_cmdq_recover(mq, NULL, MMC_BLK_READ);
+			return 0;
+		}
+		mq->cmdq_ready = qsr & mq->cmdq_pending;
+	}
+
+	if (!mq->cmdq_ready) {
+		/* Nothing ready, e.g. still programming; back off a bit */
+		if (++mq->cmdq_polls > MMC_BLK_CMDQ_FAST_POLLS)
+			usleep_range(50, 100);
+		return 0;
+	}
+	mq->cmdq_polls = 0;
+
+	/*
+	 * Execute ready reads before ready writes, but do not pass over
+	 * a ready write more than MMC_BLK_CMDQ_WRITE_STARVE times.
+	 */
+	ready = mq->cmdq_ready;
+	reads = ready & mq->cmdq_reads;
+	if (read_prio && reads && reads != ready) {
+		if (mq->cmdq_write_skips++ < MMC_BLK_CMDQ_WRITE_STARVE) {
+			ready = reads;
+		} else {
+			mq->cmdq_write_skips = 0;
+			ready &= ~reads;
+		}
+	}
+
+	return mmc_blk_cmdq_exec_task(mq, __ffs(ready));
+}
+
+static bool mmc_blk_cmdq_may_queue(struct mmc_queue *mq, struct request *req)
+{
+	unsigned int queued = hweight_long(mq->cmdq_pending);
+	unsigned int writes, max_writes;
+
+	if (queued >= mq->cmdq_depth)
+		return false;
+
+	/* Discard and flush use legacy commands, the queue must be empty */
+	if (req->cmd_flags & MMC_REQ_SPECIAL_MASK)
+		return !queued;
+
+	if (rq_data_dir(req) == READ || !read_prio)
+		return true;
+
+	/* Keep slots free for reads that arrive behind the writes */
+	max_writes = mq->cmdq_depth;
+	if (max_writes > 2 * MMC_BLK_CMDQ_READ_SLOTS)
+		max_writes -= MMC_BLK_CMDQ_READ_SLOTS;
+	writes = hweight_long(mq->cmdq_pending & ~mq->cmdq_reads);
+
+	return writes < max_writes;
+}
+
+/*
+ * Queue @req in the card, or execute a ready task when @req is NULL. The
+ * card is claimed as long as tasks are queued in it.
+ */
+static int mmc_blk_cmdq_issue_rq(struct mmc_queue *mq, struct request *req)
+{
+	struct mmc_blk_data *md = mq->data;
+	struct mmc_card *card = md->queue.card;
+	struct request_queue *q = mq->queue;
+	int ret = 0, tag;
+
+	if (!mq->cmdq_pending) {
+		if (!req)
+			return 0;
+#ifdef CONFIG_MMC_BLOCK_DEFERRED_RESUME
+		if (mmc_bus_needs_resume(card->host))
+			mmc_resume_bus(card->host);
+#endif
+		mmc_get_card(card);
+		if (mmc_blk_part_switch(card, md)) {
+			blk_end_request_all(req, -EIO);
+			goto out;
+		}
+	}
+
+	if (!req) {
+		ret = mmc_blk_cmdq_run(mq);
+		goto out;
+	}
+
+	if (req->cmd_flags & MMC_REQ_SPECIAL_MASK) {
+		/* The queue is empty, see mmc_blk_cmdq_may_queue() */
+		if (req->cmd_flags & REQ_DISCARD) {
+			if (req->cmd_flags & REQ_SECURE)
+				ret = mmc_blk_issue_secdiscard_rq(mq, req);
+			else
+				ret = mmc_blk_issue_discard_rq(mq, req);
+		} else {
+			ret = mmc_blk_issue_flush(mq, req);
+		}
+		goto out;
+	}
+
+	/* Left for an ioctl or RPMB access, enter it again */
+	if (!card->ext_csd.cmdq_en && mmc_cmdq_enable(card)) {
+		spin_lock_irq(q->queue_lock);
+		blk_requeue_request(q, req);
+		spin_unlock_irq(q->queue_lock);
+		mmc_blk_cmdq_off(mq);
+		goto out;
+	}
+
+	if (card->ext_csd.data_sector_size == 4096 &&
+	    (blk_rq_sectors(req) & 0x07)) {
+		pr_err("%s: Transfer size is not 4KB sector size aligned\n",
+		       req->rq_disk->disk_name);
+		blk_end_request_all(req, -EIO);
+		goto out;
+	}
+
+	tag = mmc_blk_cmdq_queue_task(mq, req);
+	if (tag < 0) {
+		mmc_blk_cmdq_recover(mq, req, rq_data_dir(req) == READ ?
+				     MMC_BLK_READ : MMC_BLK_WRITE);
+	} else {
+		mq->cmdq_start[tag] = ktime_get();
+		ret = 1;
+	}
+
+ out:
+	if (!mq->cmdq_pending)
+		mmc_put_card(card);
+	return ret;
+}
+
 static int mmc_blk_issue_rq(struct mmc_queue *mq, struct request *req)
 {
 	int ret;
@@ -2262,6 +2679,10 @@ static int mmc_blk_issue_rq(struct mmc_queue *mq, struct request *req)
 		goto out;
 	}
 
+	/* Legacy read/write commands are not allowed in command queue mode */
+	if (card->ext_csd.cmdq_en)
+		mmc_cmdq_disable(card);
+
 	mq->flags &= ~MMC_QUEUE_NEW_REQUEST;
 	if (cmd_flags & REQ_DISCARD) {
 		/* complete ongoing async transfer before issuing discard */
@@ -2464,6 +2885,20 @@ static struct mmc_blk_data *mmc_blk_alloc_req(struct mmc_card *card,
 			md->flags |= MMC_BLK_PACKED_CMD;
 	}
 
+	/*
+	 * Use the command queue for all but RPMB, and only with enhanced
+	 * reliable writes as it has no legacy reliable write restrictions.
+	 */
+	if (mmc_card_mmc(card) && card->ext_csd.cmdq_support &&
+	    !(area_type & MMC_BLK_DATA_AREA_RPMB) &&
+	    (card->ext_csd.rel_param & EXT_CSD_WR_REL_PARAM_EN)) {
+		md->queue.cmdq_issue_fn = mmc_blk_cmdq_issue_rq;
+		md->queue.cmdq_may_queue = mmc_blk_cmdq_may_queue;
+		md->queue.cmdq_depth = min_t(unsigned int,
+					     card->ext_csd.cmdq_depth,
+					     MMC_CMDQ_MAX_DEPTH);
+	}
+
 	return md;
 
  err_putdisk:
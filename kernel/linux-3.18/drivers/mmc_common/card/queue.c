@@ -50,6 +50,48 @@ static int mmc_prep_request(struct request_queue *q, struct request *req)
 	return BLKPREP_OK;
 }
 
+/*
+ * Command queue dispatch: keep fetching requests and queueing them in the
+ * card while it has free task slots, and execute ready tasks otherwise.
+ * Returns 1 when the thread should stop, 0 when the queue has fallen back
+ * to the legacy dispatch.
+ */
+static int mmc_cmdq_thread(struct mmc_queue *mq)
+{
+	struct request_queue *q = mq->queue;
+
+	do {
+		struct request *req;
+
+		spin_lock_irq(q->queue_lock);
+		set_current_state(TASK_INTERRUPTIBLE);
+		req = blk_peek_request(q);
+		if (req && mq->cmdq_may_queue(mq, req))
+			blk_start_request(req);
+		else
+			req = NULL;
+		spin_unlock_irq(q->queue_lock);
+
+		if (req || mq->cmdq_pending) {
+			set_current_state(TASK_RUNNING);
+			mq->cmdq_issue_fn(mq, req);
+			cond_resched();
+		} else {
+			if (!mq->cmdq_depth) {
+				set_current_state(TASK_RUNNING);
+				return 0;
+			}
+			if (kthread_should_stop()) {
+				set_current_state(TASK_RUNNING);
+				return 1;
+			}
+			up(&mq->thread_sem);
+			schedule();
+			down(&mq->thread_sem);
+		}
+	} while (1);
+}
+
 static int mmc_queue_thread(void *d)
 {
 	struct mmc_queue *mq = d;
@@ -68,11 +110,20 @@ static int mmc_queue_thread(void *d)
 		struct mmc_queue_req *tmp;
 		unsigned int cmd_flags = 0;
 
+		/* Switch to command queueing once the legacy pipe is empty */
+		if (mq->cmdq_depth && !mq->mqrq_prev->req) {
+			if (mmc_cmdq_thread(mq))
+				break;
+			continue;
+		}
+
 		spin_lock_irq(q->queue_lock);
 		set_current_state(TASK_INTERRUPTIBLE);
 		req = blk_fetch_request(q);
 		mq->mqrq_cur->req = req;
 		spin_unlock_irq(q->queue_lock);
+		if (req)
+			mq->mqrq_cur->start = ktime_get();
 
 		if (req || mq->mqrq_prev->req) {
 			set_current_state(TASK_RUNNING);
@@ -134,6 +185,11 @@ static void mmc_request_fn(struct request_queue *q)
 		return;
 	}
 
+	if (mq->cmdq_depth) {
+		wake_up_process(mq->thread);
+		return;
+	}
+
 	cntx = &mq->card->host->context_info;
 	if (!mq->mqrq_cur->req && mq->mqrq_prev->req) {
 		/*
@@ -2,6 +2,7 @@
 #define MMC_QUEUE_H
 
 #define MMC_REQ_SPECIAL_MASK	(REQ_DISCARD | REQ_FLUSH)
+#define MMC_CMDQ_MAX_DEPTH	32
 
 struct request;
 struct task_struct;
@@ -41,6 +42,7 @@ struct mmc_queue_req {
 	struct mmc_async_req	mmc_active;
 	enum mmc_packed_type	cmd_type;
 	struct mmc_packed	*packed;
+	ktime_t			start;		/* fetched from the queue */
 };
 
 struct mmc_queue {
@@ -57,6 +59,30 @@ struct mmc_queue {
 	struct mmc_queue_req	mqrq[2];
 	struct mmc_queue_req	*mqrq_cur;
 	struct mmc_queue_req	*mqrq_prev;
+
+	/* Sequential write run, see mmc_blk_write_stream() */
+	sector_t		wr_next;
+	unsigned int		wr_run;
+
+	/*
+	 * eMMC command queue. When cmdq_depth is set, requests are queued
+	 * in the card as tasks with cmdq_issue_fn(mq, req) and executed in
+	 * the order the card makes them ready with cmdq_issue_fn(mq, NULL).
+	 * The bitmaps are indexed by task id.
+	 */
+	unsigned int		cmdq_depth;
+	unsigned long		cmdq_pending;	/* queued in the card */
+	unsigned long		cmdq_ready;	/* ready for execution */
+	unsigned long		cmdq_reads;	/* read tasks */
+	unsigned int		cmdq_polls;	/* empty status polls in a row */
+	unsigned int		cmdq_write_skips;
+	struct request		*cmdq_req[MMC_CMDQ_MAX_DEPTH];
+	unsigned int		cmdq_blocks[MMC_CMDQ_MAX_DEPTH];
+	ktime_t			cmdq_start[MMC_CMDQ_MAX_DEPTH];
+	int			(*cmdq_issue_fn)(struct mmc_queue *,
+						 struct request *);
+	bool			(*cmdq_may_queue)(struct mmc_queue *,
+						  struct request *);
 };
 
 extern int mmc_init_queue(struct mmc_queue *, struct mmc_card *, spinlock_t *,
@@ -15,6 +15,7 @@
 #include <linux/slab.h>
 #include <linux/stat.h>
 #include <linux/fault-inject.h>
+#include <linux/math64.h>
 
 #include <linux/mmc/card.h>
 #include <linux/mmc/host.h>
@@ -348,6 +349,79 @@ static const struct file_operations mmc_dbg_ext_csd_fops = {
 	.llseek		= default_llseek,
 };
 
+/*
+ * Called by the block driver for every completed request, @us is the time
+ * from fetching the request until completing it.
+ */
+void mmc_lat_hist_add(struct mmc_card *card, int write, unsigned int us)
+{
+	struct mmc_lat_hist *hist = &card->lat_hist;
+	int bucket;
+
+	write = !!write;
+	bucket = us < 64 ? 0 : fls(us >> 6);
+	if (bucket >= MMC_LAT_BUCKETS)
+		bucket = MMC_LAT_BUCKETS - 1;
+
+	hist->count[write][bucket]++;
+	hist->total_us[write] += us;
+	if (us > hist->max_us[write])
+		hist->max_us[write] = us;
+}
+EXPORT_SYMBOL(mmc_lat_hist_add);
+
+static int mmc_lat_hist_show(struct seq_file *s, void *data)
+{
+	struct mmc_card *card = s->private;
+	struct mmc_lat_hist *hist = &card->lat_hist;
+	unsigned long n[2] = { 0, 0 };
+	int i, j;
+
+	seq_printf(s, "%-12s %10s %10s\n", "latency", "read", "write");
+	for (i = 0; i < MMC_LAT_BUCKETS; i++) {
+		if (i < MMC_LAT_BUCKETS - 1)
+			seq_printf(s, "<%-8uus", 64U << i);
+		else
+			seq_printf(s, ">=%-7uus", 64U << (i - 1));
+		seq_printf(s, "  %10lu %10lu\n", hist->count[0][i],
+			   hist->count[1][i]);
+		for (j = 0; j < 2; j++)
+			n[j] += hist->count[j][i];
+	}
+	seq_printf(s, "%-12s %10lu %10lu\n", "requests", n[0], n[1]);
+	seq_printf(s, "%-12s %10llu %10llu\n", "avg_us",
+		   n[0] ? div64_u64(hist->total_us[0], n[0]) : 0,
+		   n[1] ? div64_u64(hist->total_us[1], n[1]) : 0);
+	seq_printf(s, "%-12s %10u %10u\n", "max_us",
+		   hist->max_us[0], hist->max_us[1]);
+
+	return 0;
+}
+
+static int mmc_lat_hist_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, mmc_lat_hist_show, inode->i_private);
+}
+
+/* Any write clears the histogram */
+static ssize_t mmc_lat_hist_write(struct file *file, const char __user *ubuf,
+				  size_t cnt, loff_t *ppos)
+{
+	struct mmc_card *card = file_inode(file)->i_private;
+
+	memset(&card->lat_hist, 0, sizeof(card->lat_hist));
+
+	return cnt;
+}
+
+static const struct file_operations mmc_dbg_lat_hist_fops = {
+	.open		= mmc_lat_hist_open,
+	.read		= seq_read,
+	.write		= mmc_lat_hist_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 void mmc_add_card_debugfs(struct mmc_card *card)
 {
 	struct mmc_host	*host = card->host;
@@ -380,6 +454,11 @@ void mmc_add_card_debugfs(struct mmc_card *card)
 					&mmc_dbg_ext_csd_fops))
 			goto err;
 
+	if (mmc_card_mmc(card) || mmc_card_sd(card))
+		if (!debugfs_create_file("latency_hist", S_IRUSR | S_IWUSR,
+					 root, card, &mmc_dbg_lat_hist_fops))
+			goto err;
+
 	return;
 
 err:
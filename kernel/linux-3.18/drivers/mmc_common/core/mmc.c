@@ -632,6 +632,14 @@ static int mmc_read_ext_csd(struct mmc_card *card, u8 *ext_csd)
 		card->ext_csd.data_sector_size = 512;
 	}
 
+	/* eMMC v5.1 or later, only used when the host can do it too */
+	if (card->ext_csd.rev >= 8 && mmc_host_cmdq(card->host)) {
+		card->ext_csd.cmdq_support = ext_csd[EXT_CSD_CMDQ_SUPPORT] &
+			EXT_CSD_CMDQ_SUPPORTED;
+		card->ext_csd.cmdq_depth = (ext_csd[EXT_CSD_CMDQ_DEPTH] &
+					    EXT_CSD_CMDQ_DEPTH_MASK) + 1;
+	}
+
 out:
 	return err;
 }
@@ -1593,6 +1601,28 @@ static int mmc_init_card(struct mmc_host *host, u32 ocr,
 		}
 	}
 
+	/*
+	 * Enable the command queue last, some of the commands above are
+	 * not allowed in command queue mode. A reset or power cycle of the
+	 * card has cleared it.
+	 */
+	card->ext_csd.cmdq_en = false;
+	if (card->ext_csd.cmdq_support) {
+		err = mmc_cmdq_enable(card);
+		if (err && err != -EBADMSG)
+			goto free_card;
+		if (err) {
+			pr_warn("%s: Enabling command queue failed\n",
+				mmc_hostname(card->host));
+			card->ext_csd.cmdq_support = false;
+			err = 0;
+		} else {
+			pr_info("%s: Command queue enabled, depth %u\n",
+				mmc_hostname(card->host),
+				card->ext_csd.cmdq_depth);
+		}
+	}
+
 	if (!oldcard)
 		host->card = card;
 
@@ -1833,6 +1863,12 @@ static int _mmc_suspend(struct mmc_host *host, bool is_suspend)
 	if (err)
 		goto out;
 
+	/* Sleep and power off notification need the legacy mode */
+	err = mmc_cmdq_disable(host->card);
+	if (err && err != -EOPNOTSUPP)
+		goto out;
+	err = 0;
+
 	if (mmc_can_poweroff_notify(host->card) &&
 		((host->caps2 & MMC_CAP2_FULL_PWR_CYCLE) || !is_suspend))
 		err = mmc_poweroff_notify(host->card, notify_type);
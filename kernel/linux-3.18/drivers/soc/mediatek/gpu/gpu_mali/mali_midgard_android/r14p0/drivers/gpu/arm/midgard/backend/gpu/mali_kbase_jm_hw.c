@@ -146,6 +146,7 @@ void kbase_job_hw_submit(struct kbase_device *kbdev,
 				GATOR_MAKE_EVENT(GATOR_JOB_SLOT_START, js),
 				kctx, kbase_jd_atom_id(kctx, katom));
 #endif
+	trace_mali_atom_start(kctx->id, kbase_jd_atom_id(kctx, katom), js);
 	kbase_tlstream_tl_attrib_atom_config(katom, jc_head,
 			katom->affinity, cfg);
 	kbase_tlstream_tl_ret_ctx_lpu(
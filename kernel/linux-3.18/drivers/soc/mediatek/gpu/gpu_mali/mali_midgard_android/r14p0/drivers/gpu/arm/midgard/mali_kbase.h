@@ -69,6 +69,7 @@
 #ifdef CONFIG_GPU_TRACEPOINTS
 #include <trace/events/gpu.h>
 #endif
+#include "mali_linux_atom_trace.h"
 /**
  * @page page_base_kernel_main Kernel-side Base (KBase) APIs
  *
@@ -3283,6 +3283,9 @@ static int kbase_device_debugfs_init(struct kbase_device *kbdev)
 			debugfs_ctx_defaults_directory,
 			&kbdev->mem_pool_max_size_default);
 
+	kbase_mem_pool_debugfs_init(kbdev->mali_debugfs_directory,
+			&kbdev->mem_pool);
+
 	if (kbase_hw_has_feature(kbdev, BASE_HW_FEATURE_PROTECTED_DEBUG_MODE)) {
 		debugfs_create_file("protected_debug_mode", S_IRUGO,
 				kbdev->mali_debugfs_directory, kbdev,
@@ -4088,3 +4091,9 @@ void kbase_trace_mali_total_alloc_pages_change(long long int event)
 #ifdef CONFIG_MALI_SYSTEM_TRACE
 #include "mali_linux_kbase_trace.h"
 #endif
+
+/* The atom life cycle tracepoints do not depend on gator or system trace */
+#ifndef CREATE_TRACE_POINTS
+#define CREATE_TRACE_POINTS
+#endif
+#include "mali_linux_atom_trace.h"
@@ -925,6 +925,18 @@ struct kbase_protected_ops {
  * @next_pool: Pointer to next pool where pages can be allocated when this pool
  *             is empty. Pages will spill over to the next pool when this pool
  *             is full. Can be NULL if there is no next pool.
+ * @stats:     Hit/miss/refill/reclaim counters, protected by @pool_lock
+ * @refill_work:   Delayed work keeping @refill_target zeroed pages in the pool
+ * @refill_max:    Upper bound of @refill_target, 0 disables refilling. Only
+ *                 set for the kbdev pool (no @next_pool)
+ * @refill_target: Number of pages the refill worker currently aims for
+ * @refill_demand: Pages missed since the refill worker last ran
+ * @refill_kicked: The refill worker has been queued to run now
+ * @last_miss:     Time (jiffies) @refill_target was last raised or decayed
+ * @last_reclaim:  Time (jiffies) of the last shrinker scan
+ * @reclaim_seq:   Incremented on every shrinker scan
+ *
+ * All refill state is protected by @pool_lock.
  */
 struct kbase_mem_pool {
 	struct kbase_device *kbdev;
@@ -935,6 +947,22 @@ struct kbase_mem_pool {
 	struct shrinker     reclaim;
 
 	struct kbase_mem_pool *next_pool;
+
+	struct kbase_mem_pool_stats {
+		u64 hits;      /* pages allocated from this pool */
+		u64 misses;    /* pages this pool could not provide */
+		u64 refilled;  /* pages added by the refill worker */
+		u64 reclaimed; /* pages freed by the shrinker */
+	} stats;
+
+	struct delayed_work refill_work;
+	size_t              refill_max;
+	size_t              refill_target;
+	size_t              refill_demand;
+	bool                refill_kicked;
+	unsigned long       last_miss;
+	unsigned long       last_reclaim;
+	u32                 reclaim_seq;
 };
 
 
@@ -812,6 +812,8 @@ bool jd_done_nolock(struct kbase_jd_atom *katom,
 		katom = list_entry(completed_jobs.prev, struct kbase_jd_atom, jd_item);
 		list_del(completed_jobs.prev);
 		KBASE_DEBUG_ASSERT(katom->status == KBASE_JD_ATOM_STATE_COMPLETED);
+		trace_mali_atom_finish(kctx->id, kbase_jd_atom_id(kctx, katom),
+				katom->event_code);
 
 		for (i = 0; i < 2; i++)
 			jd_resolve_dep(&runnable_jobs, katom, i,
@@ -1198,6 +1200,8 @@ bool jd_submit_atom(struct kbase_context *kctx, const struct base_jd_atom_v2 *us
 	trace_gpu_job_enqueue((u32)kctx->id, katom->work_id,
 			kbasep_map_core_reqs_to_string(katom->core_req));
 #endif
+	trace_mali_atom_queue(kctx->id, kbase_jd_atom_id(kctx, katom),
+			katom->core_req, katom->sched_priority);
 
 	if (queued && !IS_GPU_ATOM(katom)) {
 		ret = false;
@@ -1237,6 +1241,9 @@ bool jd_submit_atom(struct kbase_context *kctx, const struct base_jd_atom_v2 *us
 		ret = false;
 	} else if ((katom->core_req & BASE_JD_REQ_ATOM_TYPE) != BASE_JD_REQ_DEP) {
 		katom->status = KBASE_JD_ATOM_STATE_IN_JS;
+#ifdef CONFIG_MALI_MIDGARD_DVFS_JOB_EVENTS
+		kbase_platform_dvfs_job_submitted(kctx->kbdev, katom);
+#endif
 		ret = kbasep_js_add_job(kctx, katom);
 		/* If job was cancelled then resolve immediately */
 		if (katom->event_code == BASE_JD_EVENT_JOB_CANCELLED)
@@ -1250,6 +1257,92 @@ bool jd_submit_atom(struct kbase_context *kctx, const struct base_jd_atom_v2 *us
 	return ret;
 }
 
+/* Number of atoms copied from user space and submitted under one jctx.lock */
+#define KBASE_JD_SUBMIT_BATCH 8
+
+/**
+ * jd_copy_user_atoms - Copy a batch of atoms from user space
+ * @kctx:      Context the atoms are submitted to
+ * @user_addr: User address of the first atom
+ * @stride:    Distance between atoms in user space
+ * @atoms:     Array to fill
+ * @nr:        Number of atoms to copy
+ * @uk6_atom:  Whether the atoms are in the UK6 format
+ *
+ * Return: 0 on success, -EINVAL if the atoms could not be read.
+ */
+#ifdef BASE_LEGACY_UK6_SUPPORT
+static int jd_copy_user_atoms(struct kbase_context *kctx,
+		void __user *user_addr, u32 stride,
+		struct base_jd_atom_v2 *atoms, int nr, int uk6_atom)
+#else
+static int jd_copy_user_atoms(struct kbase_context *kctx,
+		void __user *user_addr, u32 stride,
+		struct base_jd_atom_v2 *atoms, int nr)
+#endif /* BASE_LEGACY_UK6_SUPPORT */
+{
+	int i;
+
+#ifdef BASE_LEGACY_UK6_SUPPORT
+	if (uk6_atom) {
+		for (i = 0; i < nr; i++) {
+			struct base_jd_atom_v2 *user_atom = &atoms[i];
+			struct base_jd_atom_v2_uk6 user_atom_v6;
+			base_jd_dep_type dep_types[2] = {BASE_JD_DEP_TYPE_DATA, BASE_JD_DEP_TYPE_DATA};
+
+			if (copy_from_user(&user_atom_v6, user_addr,
+					sizeof(user_atom_v6)))
+				return -EINVAL;
+
+			/* Convert from UK6 atom format to UK7 format */
+			user_atom->jc = user_atom_v6.jc;
+			user_atom->udata = user_atom_v6.udata;
+			user_atom->extres_list = user_atom_v6.extres_list;
+			user_atom->nr_extres = user_atom_v6.nr_extres;
+			user_atom->core_req = (u32)(user_atom_v6.core_req & 0x7fff);
+
+			/* atom number 0 is used for no dependency atoms */
+			if (!user_atom_v6.pre_dep[0])
+				dep_types[0] = BASE_JD_DEP_TYPE_INVALID;
+
+			base_jd_atom_dep_set(&user_atom->pre_dep[0],
+					user_atom_v6.pre_dep[0],
+					dep_types[0]);
+
+			/* atom number 0 is used for no dependency atoms */
+			if (!user_atom_v6.pre_dep[1])
+				dep_types[1] = BASE_JD_DEP_TYPE_INVALID;
+
+			base_jd_atom_dep_set(&user_atom->pre_dep[1],
+					user_atom_v6.pre_dep[1],
+					dep_types[1]);
+
+			user_atom->atom_number = user_atom_v6.atom_number;
+			user_atom->prio = user_atom_v6.prio;
+			user_atom->device_nr = user_atom_v6.device_nr;
+
+			user_addr = (void __user *)((uintptr_t) user_addr + stride);
+		}
+	} else {
+#endif /* BASE_LEGACY_UK6_SUPPORT */
+	/* The stride has been checked to be the atom size, copy them at once */
+	if (copy_from_user(atoms, user_addr, nr * sizeof(*atoms)) != 0)
+		return -EINVAL;
+#ifdef BASE_LEGACY_UK6_SUPPORT
+	}
+#endif /* BASE_LEGACY_UK6_SUPPORT */
+
+#ifdef BASE_LEGACY_UK10_2_SUPPORT
+	if (KBASE_API_VERSION(10, 3) > kctx->api_version)
+		for (i = 0; i < nr; i++)
+			atoms[i].core_req = (u32)(atoms[i].compat_core_req
+					      & 0x7fff);
+#endif /* BASE_LEGACY_UK10_2_SUPPORT */
+
+	CSTD_UNUSED(i);
+	return 0;
+}
+
 #ifdef BASE_LEGACY_UK6_SUPPORT
 int kbase_jd_submit(struct kbase_context *kctx,
 		const struct kbase_uk_job_submit *submit_data,
@@ -1260,8 +1353,9 @@ int kbase_jd_submit(struct kbase_context *kctx,
 #endif /* BASE_LEGACY_UK6_SUPPORT */
 {
 	struct kbase_jd_context *jctx = &kctx->jctx;
+	struct base_jd_atom_v2 user_atoms[KBASE_JD_SUBMIT_BATCH];
 	int err = 0;
-	int i;
+	int i, j, nr;
 	bool need_to_try_schedule_context = false;
 	struct kbase_device *kbdev;
 	void __user *user_addr;
@@ -1291,6 +1385,22 @@ int kbase_jd_submit(struct kbase_context *kctx,
 		return -EINVAL;
 	}
 
+#ifndef compiletime_assert
+#define compiletime_assert_defined
+#define compiletime_assert(x, msg) do { switch (0) { case 0: case (x):; } } \
+while (false)
+#endif
+	compiletime_assert((1 << (8*sizeof(user_atoms[0].atom_number))) ==
+				BASE_JD_ATOM_COUNT,
+		"BASE_JD_ATOM_COUNT and base_atom_id type out of sync");
+	compiletime_assert(sizeof(user_atoms[0].pre_dep[0].atom_id) ==
+				sizeof(user_atoms[0].atom_number),
+		"BASE_JD_ATOM_COUNT and base_atom_id type out of sync");
+#ifdef compiletime_assert_defined
+#undef compiletime_assert
+#undef compiletime_assert_defined
+#endif
+
 	user_addr = get_compat_pointer(kctx, &submit_data->addr);
 
 	KBASE_TIMELINE_ATOMS_IN_FLIGHT(kctx, atomic_add_return(submit_data->nr_atoms, &kctx->timeline.jd_atoms_in_flight));
@@ -1298,124 +1408,75 @@ int kbase_jd_submit(struct kbase_context *kctx,
 	/* All atoms submitted in this call have the same flush ID */
 	latest_flush = kbase_backend_get_current_flush_id(kbdev);
 
-	for (i = 0; i < submit_data->nr_atoms; i++) {
-		struct base_jd_atom_v2 user_atom;
-		struct kbase_jd_atom *katom;
+	/*
+	 * Atoms are copied from user space a batch at a time, outside of
+	 * jctx.lock, and then submitted with the lock taken once per batch.
+	 */
+	for (i = 0; i < submit_data->nr_atoms; i += nr) {
+		nr = min_t(int, submit_data->nr_atoms - i,
+				KBASE_JD_SUBMIT_BATCH);
 
 #ifdef BASE_LEGACY_UK6_SUPPORT
-		if (uk6_atom) {
-			struct base_jd_atom_v2_uk6 user_atom_v6;
-			base_jd_dep_type dep_types[2] = {BASE_JD_DEP_TYPE_DATA, BASE_JD_DEP_TYPE_DATA};
-
-			if (copy_from_user(&user_atom_v6, user_addr,
-					sizeof(user_atom_v6))) {
-				err = -EINVAL;
-				KBASE_TIMELINE_ATOMS_IN_FLIGHT(kctx,
-					atomic_sub_return(
-					submit_data->nr_atoms - i,
-					&kctx->timeline.jd_atoms_in_flight));
-				break;
-			}
-			/* Convert from UK6 atom format to UK7 format */
-			user_atom.jc = user_atom_v6.jc;
-			user_atom.udata = user_atom_v6.udata;
-			user_atom.extres_list = user_atom_v6.extres_list;
-			user_atom.nr_extres = user_atom_v6.nr_extres;
-			user_atom.core_req = (u32)(user_atom_v6.core_req & 0x7fff);
-
-			/* atom number 0 is used for no dependency atoms */
-			if (!user_atom_v6.pre_dep[0])
-				dep_types[0] = BASE_JD_DEP_TYPE_INVALID;
-
-			base_jd_atom_dep_set(&user_atom.pre_dep[0],
-					user_atom_v6.pre_dep[0],
-					dep_types[0]);
-
-			/* atom number 0 is used for no dependency atoms */
-			if (!user_atom_v6.pre_dep[1])
-				dep_types[1] = BASE_JD_DEP_TYPE_INVALID;
-
-			base_jd_atom_dep_set(&user_atom.pre_dep[1],
-					user_atom_v6.pre_dep[1],
-					dep_types[1]);
-
-			user_atom.atom_number = user_atom_v6.atom_number;
-			user_atom.prio = user_atom_v6.prio;
-			user_atom.device_nr = user_atom_v6.device_nr;
-		} else {
+		if (jd_copy_user_atoms(kctx, user_addr, submit_data->stride,
+					user_atoms, nr, uk6_atom)) {
+#else
+		if (jd_copy_user_atoms(kctx, user_addr, submit_data->stride,
+					user_atoms, nr)) {
 #endif /* BASE_LEGACY_UK6_SUPPORT */
-		if (copy_from_user(&user_atom, user_addr, sizeof(user_atom)) != 0) {
 			err = -EINVAL;
 			KBASE_TIMELINE_ATOMS_IN_FLIGHT(kctx, atomic_sub_return(submit_data->nr_atoms - i, &kctx->timeline.jd_atoms_in_flight));
 			break;
 		}
-#ifdef BASE_LEGACY_UK6_SUPPORT
-		}
-#endif /* BASE_LEGACY_UK6_SUPPORT */
-
-#ifdef BASE_LEGACY_UK10_2_SUPPORT
-		if (KBASE_API_VERSION(10, 3) > kctx->api_version)
-			user_atom.core_req = (u32)(user_atom.compat_core_req
-					      & 0x7fff);
-#endif /* BASE_LEGACY_UK10_2_SUPPORT */
 
-		user_addr = (void __user *)((uintptr_t) user_addr + submit_data->stride);
+		user_addr = (void __user *)((uintptr_t) user_addr +
+				nr * submit_data->stride);
 
 		mutex_lock(&jctx->lock);
-#ifndef compiletime_assert
-#define compiletime_assert_defined
-#define compiletime_assert(x, msg) do { switch (0) { case 0: case (x):; } } \
-while (false)
-#endif
-		compiletime_assert((1 << (8*sizeof(user_atom.atom_number))) ==
-					BASE_JD_ATOM_COUNT,
-			"BASE_JD_ATOM_COUNT and base_atom_id type out of sync");
-		compiletime_assert(sizeof(user_atom.pre_dep[0].atom_id) ==
-					sizeof(user_atom.atom_number),
-			"BASE_JD_ATOM_COUNT and base_atom_id type out of sync");
-#ifdef compiletime_assert_defined
-#undef compiletime_assert
-#undef compiletime_assert_defined
-#endif
-		katom = &jctx->atoms[user_atom.atom_number];
+		for (j = 0; j < nr; j++) {
+			struct base_jd_atom_v2 *user_atom = &user_atoms[j];
+			struct kbase_jd_atom *katom;
 
-		/* Record the flush ID for the cache flush optimisation */
-		katom->flush_id = latest_flush;
+			katom = &jctx->atoms[user_atom->atom_number];
 
-		while (katom->status != KBASE_JD_ATOM_STATE_UNUSED) {
-			/* Atom number is already in use, wait for the atom to
-			 * complete
-			 */
-			mutex_unlock(&jctx->lock);
-
-			/* This thread will wait for the atom to complete. Due
-			 * to thread scheduling we are not sure that the other
-			 * thread that owns the atom will also schedule the
-			 * context, so we force the scheduler to be active and
-			 * hence eventually schedule this context at some point
-			 * later.
-			 */
-			kbase_js_sched_all(kbdev);
-
-			if (wait_event_killable(katom->completed,
-					katom->status ==
-					KBASE_JD_ATOM_STATE_UNUSED) != 0) {
-				/* We're being killed so the result code
-				 * doesn't really matter
+			while (katom->status != KBASE_JD_ATOM_STATE_UNUSED) {
+				/* Atom number is already in use, wait for the
+				 * atom to complete
+				 */
+				mutex_unlock(&jctx->lock);
+
+				/* This thread will wait for the atom to
+				 * complete. Due to thread scheduling we are
+				 * not sure that the other thread that owns the
+				 * atom will also schedule the context, so we
+				 * force the scheduler to be active and hence
+				 * eventually schedule this context at some
+				 * point later.
 				 */
-				return 0;
+				kbase_js_sched_all(kbdev);
+
+				if (wait_event_killable(katom->completed,
+						katom->status ==
+						KBASE_JD_ATOM_STATE_UNUSED) != 0) {
+					/* We're being killed so the result code
+					 * doesn't really matter
+					 */
+					return 0;
+				}
+				mutex_lock(&jctx->lock);
 			}
-			mutex_lock(&jctx->lock);
-		}
 
-		need_to_try_schedule_context |=
-				       jd_submit_atom(kctx, &user_atom, katom);
+			/* Record the flush ID for the cache flush optimisation */
+			katom->flush_id = latest_flush;
 
-		/* Register a completed job as a disjoint event when the GPU is in a disjoint state
-		 * (ie. being reset or replaying jobs).
-		 */
-		kbase_disjoint_event_potential(kbdev);
+			need_to_try_schedule_context |=
+				jd_submit_atom(kctx, user_atom, katom);
 
+			/* Register a completed job as a disjoint event when the
+			 * GPU is in a disjoint state (ie. being reset or
+			 * replaying jobs).
+			 */
+			kbase_disjoint_event_potential(kbdev);
+		}
 		mutex_unlock(&jctx->lock);
 	}
 
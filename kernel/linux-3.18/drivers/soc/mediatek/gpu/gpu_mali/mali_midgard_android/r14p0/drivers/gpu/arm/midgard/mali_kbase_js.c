@@ -2569,6 +2569,11 @@ struct kbase_jd_atom *kbase_js_complete_atom(struct kbase_jd_atom *katom,
 		/* Round up time spent to the minimum timer resolution */
 		if (microseconds_spent < KBASEP_JS_TICK_RESOLUTION_US)
 			microseconds_spent = KBASEP_JS_TICK_RESOLUTION_US;
+
+#ifdef CONFIG_MALI_MIDGARD_DVFS_JOB_EVENTS
+		kbase_platform_dvfs_job_completed(kbdev, katom,
+				microseconds_spent);
+#endif
 	}
 
 	/* Log the result of the job (completion status, and time spent). */
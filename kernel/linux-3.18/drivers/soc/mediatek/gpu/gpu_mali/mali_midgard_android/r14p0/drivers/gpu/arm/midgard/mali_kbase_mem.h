@@ -443,6 +443,12 @@ static inline int kbase_atomic_sub_pages(int num_pages, atomic_t *used_pages)
  */
 #define KBASE_MEM_POOL_MAX_SIZE_KCTX  (SZ_64M >> PAGE_SHIFT)
 
+/*
+ * Default upper bound of the pre-zeroed pages kept in the kbdev memory pool
+ * by the refill worker (in pages)
+ */
+#define KBASE_MEM_POOL_REFILL_MAX_KBDEV (SZ_16M >> PAGE_SHIFT)
+
 /**
  * kbase_mem_pool_init - Create a memory pool for a kbase device
  * @pool:      Memory pool to initialize
@@ -464,6 +470,12 @@ static inline int kbase_atomic_sub_pages(int num_pages, atomic_t *used_pages)
  * A shrinker is registered so that Linux mm can reclaim pages from the pool as
  * needed.
  *
+ * If @next_pool is NULL, a refill worker keeps up to
+ * KBASE_MEM_POOL_REFILL_MAX_KBDEV zeroed pages in @pool, so that allocations
+ * do not have to wait for the kernel to clear pages. The number of pages kept
+ * follows the recent misses of the pool and backs off while the shrinker is
+ * reclaiming from it. See kbase_mem_pool_set_refill_max().
+ *
  * Return: 0 on success, negative -errno on error
  */
 int kbase_mem_pool_init(struct kbase_mem_pool *pool,
@@ -573,6 +585,18 @@ static inline size_t kbase_mem_pool_max_size(struct kbase_mem_pool *pool)
  */
 void kbase_mem_pool_set_max_size(struct kbase_mem_pool *pool, size_t max_size);
 
+/**
+ * kbase_mem_pool_set_refill_max - Set the maximum number of pages refilled
+ * @pool:       Memory pool to configure
+ * @refill_max: Maximum number of zeroed pages the refill worker keeps in
+ *              @pool, 0 to stop refilling
+ *
+ * Pages already in the pool are left alone; the pool is trimmed by the
+ * shrinker or kbase_mem_pool_trim() as before.
+ */
+void kbase_mem_pool_set_refill_max(struct kbase_mem_pool *pool,
+		size_t refill_max);
+
 /**
  * kbase_mem_pool_grow - Grow the pool
  * @pool:       Memory pool to grow
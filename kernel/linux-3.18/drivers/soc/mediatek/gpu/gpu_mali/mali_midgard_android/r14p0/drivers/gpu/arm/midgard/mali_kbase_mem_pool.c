@@ -23,6 +23,8 @@
 #include <linux/shrinker.h>
 #include <linux/atomic.h>
 #include <linux/version.h>
+#include <linux/workqueue.h>
+#include <linux/jiffies.h>
 
 /* This function is only provided for backwards compatibility with kernels
  * which use the old carveout allocator.
@@ -46,6 +48,15 @@ int __init kbase_carveout_mem_reserve(phys_addr_t size)
 #define NOT_DIRTY false
 #define NOT_RECLAIMED false
 
+/* Pages the refill worker keeps at least, while refilling is enabled */
+#define KBASE_MEM_POOL_REFILL_MIN	(SZ_1M >> PAGE_SHIFT)
+/* Pages allocated between two takes of the pool lock when refilling */
+#define KBASE_MEM_POOL_REFILL_BATCH	32
+/* No refilling for this long after the shrinker reclaimed from the pool */
+#define KBASE_MEM_POOL_REFILL_BACKOFF	msecs_to_jiffies(2000)
+/* The refill target halves after this long without misses */
+#define KBASE_MEM_POOL_REFILL_DECAY	msecs_to_jiffies(5000)
+
 static inline void kbase_mem_pool_lock(struct kbase_mem_pool *pool)
 {
 	spin_lock(&pool->pool_lock);
@@ -74,6 +85,30 @@ static bool kbase_mem_pool_is_empty(struct kbase_mem_pool *pool)
 	return kbase_mem_pool_size(pool) == 0;
 }
 
+/*
+ * Account for an allocation of @nr_hit pages from @pool and @nr_missed pages
+ * it could not provide, and queue the refill worker if the pool runs low.
+ */
+static void kbase_mem_pool_account_locked(struct kbase_mem_pool *pool,
+		size_t nr_hit, size_t nr_missed)
+{
+	lockdep_assert_held(&pool->pool_lock);
+
+	pool->stats.hits += nr_hit;
+	pool->stats.misses += nr_missed;
+
+	if (!pool->refill_max)
+		return;
+
+	pool->refill_demand += nr_missed;
+
+	if (!pool->refill_kicked && (nr_missed ||
+			kbase_mem_pool_size(pool) < pool->refill_target / 2)) {
+		pool->refill_kicked = true;
+		mod_delayed_work(system_unbound_wq, &pool->refill_work, 0);
+	}
+}
+
 static void kbase_mem_pool_add_locked(struct kbase_mem_pool *pool,
 		struct page *p)
 {
@@ -139,17 +174,6 @@ static struct page *kbase_mem_pool_remove_locked(struct kbase_mem_pool *pool)
 	return p;
 }
 
-static struct page *kbase_mem_pool_remove(struct kbase_mem_pool *pool)
-{
-	struct page *p;
-
-	kbase_mem_pool_lock(pool);
-	p = kbase_mem_pool_remove_locked(pool);
-	kbase_mem_pool_unlock(pool);
-
-	return p;
-}
-
 static void kbase_mem_pool_sync_page(struct kbase_mem_pool *pool,
 		struct page *p)
 {
@@ -324,7 +348,14 @@ static unsigned long kbase_mem_pool_reclaim_scan_objects(struct shrinker *s,
 
 	pool_dbg(pool, "reclaim scan %ld:\n", sc->nr_to_scan);
 
-	freed = kbase_mem_pool_shrink(pool, sc->nr_to_scan);
+	/* Stop the refill worker from handing the pages straight back */
+	kbase_mem_pool_lock(pool);
+	pool->last_reclaim = jiffies;
+	pool->reclaim_seq++;
+	pool->refill_target /= 2;
+	freed = kbase_mem_pool_shrink_locked(pool, sc->nr_to_scan);
+	pool->stats.reclaimed += freed;
+	kbase_mem_pool_unlock(pool);
 
 	pool_dbg(pool, "reclaim freed %ld pages\n", freed);
 
@@ -342,6 +373,114 @@ static int kbase_mem_pool_reclaim_shrink(struct shrinker *s,
 }
 #endif
 
+static void kbase_mem_pool_refill_worker(struct work_struct *data)
+{
+	struct kbase_mem_pool *pool = container_of(data, struct kbase_mem_pool,
+			refill_work.work);
+	struct page *p, *tmp;
+	LIST_HEAD(page_list);
+	unsigned long delay = 0;
+	size_t target, nr_to_grow, i;
+	u32 reclaim_seq;
+
+	kbase_mem_pool_lock(pool);
+	pool->refill_kicked = false;
+
+	target = pool->refill_target;
+	if (pool->refill_demand) {
+		/* Be ready for twice the pages missed since the last run */
+		target = max(target, 2 * pool->refill_demand);
+		pool->refill_demand = 0;
+		pool->last_miss = jiffies;
+	} else if (time_after_eq(jiffies,
+			pool->last_miss + KBASE_MEM_POOL_REFILL_DECAY)) {
+		target /= 2;
+		pool->last_miss = jiffies;
+	}
+	target = max_t(size_t, target,
+			min_t(size_t, KBASE_MEM_POOL_REFILL_MIN, pool->refill_max));
+	target = min(target, pool->refill_max);
+	target = min(target, kbase_mem_pool_max_size(pool));
+	pool->refill_target = target;
+
+	reclaim_seq = pool->reclaim_seq;
+	if (time_before(jiffies, pool->last_reclaim +
+			KBASE_MEM_POOL_REFILL_BACKOFF))
+		delay = pool->last_reclaim + KBASE_MEM_POOL_REFILL_BACKOFF -
+				jiffies;
+	kbase_mem_pool_unlock(pool);
+
+	if (!target)
+		return;
+
+	if (delay) {
+		pool_dbg(pool, "refill deferred after reclaim\n");
+		goto requeue;
+	}
+
+	while (kbase_mem_pool_size(pool) < target) {
+		nr_to_grow = min_t(size_t, target - kbase_mem_pool_size(pool),
+				KBASE_MEM_POOL_REFILL_BATCH);
+
+		/* Pages come zeroed and clean from kbase_mem_alloc_page() */
+		for (i = 0; i < nr_to_grow; i++) {
+			p = kbase_mem_alloc_page(pool->kbdev);
+			if (!p)
+				break;
+			list_add(&p->lru, &page_list);
+		}
+
+		kbase_mem_pool_lock(pool);
+		if (pool->reclaim_seq != reclaim_seq || !pool->refill_max) {
+			kbase_mem_pool_unlock(pool);
+
+			/* Reclaim started meanwhile, give the pages back */
+			list_for_each_entry_safe(p, tmp, &page_list, lru) {
+				list_del_init(&p->lru);
+				kbase_mem_pool_free_page(pool, p);
+			}
+			break;
+		}
+		kbase_mem_pool_add_list_locked(pool, &page_list, i);
+		pool->stats.refilled += i;
+		if (i < nr_to_grow) {
+			/* Out of memory: back off as if reclaimed */
+			pool->last_reclaim = jiffies;
+			pool->reclaim_seq++;
+		}
+		kbase_mem_pool_unlock(pool);
+		INIT_LIST_HEAD(&page_list);
+
+		if (i < nr_to_grow)
+			break;
+	}
+
+	pool_dbg(pool, "refilled to target %zu\n", target);
+
+	/* Come back to decay the target, or to refill after reclaim */
+	if (target <= KBASE_MEM_POOL_REFILL_MIN)
+		return;
+	delay = KBASE_MEM_POOL_REFILL_DECAY;
+requeue:
+	queue_delayed_work(system_unbound_wq, &pool->refill_work, delay);
+}
+
+void kbase_mem_pool_set_refill_max(struct kbase_mem_pool *pool,
+		size_t refill_max)
+{
+	kbase_mem_pool_lock(pool);
+	pool->refill_max = refill_max;
+	pool->refill_target = min(pool->refill_target, refill_max);
+	if (refill_max) {
+		pool->refill_kicked = true;
+		mod_delayed_work(system_unbound_wq, &pool->refill_work, 0);
+	}
+	kbase_mem_pool_unlock(pool);
+
+	if (!refill_max)
+		cancel_delayed_work_sync(&pool->refill_work);
+}
+
 int kbase_mem_pool_init(struct kbase_mem_pool *pool,
 		size_t max_size,
 		struct kbase_device *kbdev,
@@ -355,6 +494,16 @@ int kbase_mem_pool_init(struct kbase_mem_pool *pool,
 	spin_lock_init(&pool->pool_lock);
 	INIT_LIST_HEAD(&pool->page_list);
 
+	memset(&pool->stats, 0, sizeof(pool->stats));
+	INIT_DELAYED_WORK(&pool->refill_work, kbase_mem_pool_refill_worker);
+	pool->refill_max = 0;
+	pool->refill_target = 0;
+	pool->refill_demand = 0;
+	pool->refill_kicked = false;
+	pool->last_miss = jiffies;
+	pool->last_reclaim = jiffies - KBASE_MEM_POOL_REFILL_BACKOFF;
+	pool->reclaim_seq = 0;
+
 	/* Register shrinker */
 #if LINUX_VERSION_CODE < KERNEL_VERSION(3, 12, 0)
 	pool->reclaim.shrink = kbase_mem_pool_reclaim_shrink;
@@ -370,6 +519,11 @@ int kbase_mem_pool_init(struct kbase_mem_pool *pool,
 #endif
 	register_shrinker(&pool->reclaim);
 
+	/* Only the kbdev pool gets pages from the kernel, keep it warm */
+	if (!next_pool)
+		kbase_mem_pool_set_refill_max(pool,
+				KBASE_MEM_POOL_REFILL_MAX_KBDEV);
+
 	pool_dbg(pool, "initialized\n");
 
 	return 0;
@@ -386,6 +540,7 @@ void kbase_mem_pool_term(struct kbase_mem_pool *pool)
 	pool_dbg(pool, "terminate()\n");
 
 	unregister_shrinker(&pool->reclaim);
+	kbase_mem_pool_set_refill_max(pool, 0);
 
 	kbase_mem_pool_lock(pool);
 	pool->max_size = 0;
@@ -427,7 +582,10 @@ struct page *kbase_mem_pool_alloc(struct kbase_mem_pool *pool)
 
 	do {
 		pool_dbg(pool, "alloc()\n");
-		p = kbase_mem_pool_remove(pool);
+		kbase_mem_pool_lock(pool);
+		p = kbase_mem_pool_remove_locked(pool);
+		kbase_mem_pool_account_locked(pool, p ? 1 : 0, p ? 0 : 1);
+		kbase_mem_pool_unlock(pool);
 
 		if (p)
 			return p;
@@ -477,6 +635,8 @@ int kbase_mem_pool_alloc_pages(struct kbase_mem_pool *pool, size_t nr_pages,
 		p = kbase_mem_pool_remove_locked(pool);
 		pages[i] = page_to_phys(p);
 	}
+	kbase_mem_pool_account_locked(pool, nr_from_pool,
+			nr_pages - nr_from_pool);
 	kbase_mem_pool_unlock(pool);
 
 	if (i != nr_pages && pool->next_pool) {
@@ -68,6 +68,63 @@ DEFINE_SIMPLE_ATTRIBUTE(kbase_mem_pool_debugfs_max_size_fops,
 		kbase_mem_pool_debugfs_max_size_set,
 		"%llu\n");
 
+static int kbase_mem_pool_debugfs_refill_max_get(void *data, u64 *val)
+{
+	struct kbase_mem_pool *pool = (struct kbase_mem_pool *)data;
+
+	*val = ACCESS_ONCE(pool->refill_max);
+
+	return 0;
+}
+
+static int kbase_mem_pool_debugfs_refill_max_set(void *data, u64 val)
+{
+	struct kbase_mem_pool *pool = (struct kbase_mem_pool *)data;
+
+	kbase_mem_pool_set_refill_max(pool, val);
+
+	return 0;
+}
+
+DEFINE_SIMPLE_ATTRIBUTE(kbase_mem_pool_debugfs_refill_max_fops,
+		kbase_mem_pool_debugfs_refill_max_get,
+		kbase_mem_pool_debugfs_refill_max_set,
+		"%llu\n");
+
+static int kbase_mem_pool_debugfs_stats_show(struct seq_file *sfile, void *data)
+{
+	struct kbase_mem_pool *pool = sfile->private;
+	struct kbase_mem_pool_stats stats;
+	size_t refill_target;
+
+	spin_lock(&pool->pool_lock);
+	stats = pool->stats;
+	refill_target = pool->refill_target;
+	spin_unlock(&pool->pool_lock);
+
+	seq_printf(sfile, "hits:          %llu\n", stats.hits);
+	seq_printf(sfile, "misses:        %llu\n", stats.misses);
+	seq_printf(sfile, "refilled:      %llu\n", stats.refilled);
+	seq_printf(sfile, "reclaimed:     %llu\n", stats.reclaimed);
+	seq_printf(sfile, "refill_target: %zu\n", refill_target);
+
+	return 0;
+}
+
+static int kbase_mem_pool_debugfs_stats_open(struct inode *in,
+		struct file *file)
+{
+	return single_open(file, kbase_mem_pool_debugfs_stats_show,
+			in->i_private);
+}
+
+static const struct file_operations kbase_mem_pool_debugfs_stats_fops = {
+	.open = kbase_mem_pool_debugfs_stats_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 void kbase_mem_pool_debugfs_init(struct dentry *parent,
 		struct kbase_mem_pool *pool)
 {
@@ -76,6 +133,15 @@ void kbase_mem_pool_debugfs_init(struct dentry *parent,
 
 	debugfs_create_file("mem_pool_max_size", S_IRUGO | S_IWUSR, parent,
 			pool, &kbase_mem_pool_debugfs_max_size_fops);
+
+	debugfs_create_file("mem_pool_stats", S_IRUGO, parent,
+			pool, &kbase_mem_pool_debugfs_stats_fops);
+
+	/* Only the kbdev pool is refilled */
+	if (!pool->next_pool)
+		debugfs_create_file("mem_pool_refill_max", S_IRUGO | S_IWUSR,
+				parent, pool,
+				&kbase_mem_pool_debugfs_refill_max_fops);
 }
 
 #endif /* CONFIG_DEBUG_FS */
@@ -25,9 +25,11 @@
  * @parent: Parent debugfs dentry
  * @pool:   Memory pool to control
  *
- * Adds two debugfs files under @parent:
+ * Adds debugfs files under @parent:
  * - mem_pool_size: get/set the current size of @pool
  * - mem_pool_max_size: get/set the max size of @pool
+ * - mem_pool_stats: hit/miss/refill/reclaim counters of @pool
+ * - mem_pool_refill_max: get/set the refill limit of @pool, kbdev pool only
  */
 void kbase_mem_pool_debugfs_init(struct dentry *parent,
 		struct kbase_mem_pool *pool);
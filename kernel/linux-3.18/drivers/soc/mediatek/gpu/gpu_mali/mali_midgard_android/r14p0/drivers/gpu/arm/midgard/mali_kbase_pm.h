@@ -168,4 +168,37 @@ void kbase_pm_resume(struct kbase_device *kbdev);
  */
 void kbase_pm_vsync_callback(int buffer_updated, void *data);
 
+#ifdef CONFIG_MALI_MIDGARD_DVFS_JOB_EVENTS
+struct kbase_jd_atom;
+
+/**
+ * kbase_platform_dvfs_job_submitted - Report a job submission to DVFS code
+ *
+ * Function provided by platform specific code when DVFS job events are
+ * enabled, so that it can see frames coming before they reach the GPU.
+ * Called from process context, for every atom going to the job scheduler.
+ *
+ * @kbdev: The kbase device structure for the device (must be a valid
+ *         pointer)
+ * @katom: The atom submitted
+ */
+void kbase_platform_dvfs_job_submitted(struct kbase_device *kbdev,
+		struct kbase_jd_atom *katom);
+
+/**
+ * kbase_platform_dvfs_job_completed - Report a job completion to DVFS code
+ *
+ * Function provided by platform specific code when DVFS job events are
+ * enabled. Called with hwaccess_lock held, for every atom that ran on the
+ * GPU.
+ *
+ * @kbdev:         The kbase device structure for the device (must be a
+ *                 valid pointer)
+ * @katom:         The atom completed
+ * @time_spent_us: Time the atom spent on the GPU
+ */
+void kbase_platform_dvfs_job_completed(struct kbase_device *kbdev,
+		struct kbase_jd_atom *katom, u64 time_spent_us);
+#endif
+
 #endif				/* _KBASE_PM_H_ */
@@ -342,7 +342,13 @@ static void kbasep_soft_event_complete_job(struct work_struct *work)
 		kbase_js_sched_all(kctx->kbdev);
 }
 
-void kbasep_complete_triggered_soft_events(struct kbase_context *kctx, u64 evt)
+/*
+ * Take the atoms waiting for evt off the waiting list. They are added to
+ * completed if the caller can complete them itself (holding jctx.lock and not
+ * within jd_done_nolock()), or else completed from job_done_wq.
+ */
+static void kbasep_soft_event_trigger(struct kbase_context *kctx, u64 evt,
+		struct list_head *completed)
 {
 	int cancel_timer = 1;
 	struct list_head *entry, *tmp;
@@ -359,10 +365,14 @@ void kbasep_complete_triggered_soft_events(struct kbase_context *kctx, u64 evt)
 				list_del(&katom->queue);
 
 				katom->event_code = BASE_JD_EVENT_DONE;
-				INIT_WORK(&katom->work,
-					  kbasep_soft_event_complete_job);
-				queue_work(kctx->jctx.job_done_wq,
-					   &katom->work);
+				if (completed) {
+					list_add_tail(&katom->queue, completed);
+				} else {
+					INIT_WORK(&katom->work,
+						  kbasep_soft_event_complete_job);
+					queue_work(kctx->jctx.job_done_wq,
+						   &katom->work);
+				}
 			} else {
 				/* There are still other waiting jobs, we cannot
 				 * cancel the timer yet.
@@ -386,6 +396,11 @@ void kbasep_complete_triggered_soft_events(struct kbase_context *kctx, u64 evt)
 	spin_unlock_irqrestore(&kctx->waiting_soft_jobs_lock, lflags);
 }
 
+void kbasep_complete_triggered_soft_events(struct kbase_context *kctx, u64 evt)
+{
+	kbasep_soft_event_trigger(kctx, evt, NULL);
+}
+
 #ifdef CONFIG_MALI_FENCE_DEBUG
 static char *kbase_fence_debug_status_string(int status)
 {
@@ -592,6 +607,8 @@ int kbase_soft_event_update(struct kbase_context *kctx,
 			     u64 event,
 			     unsigned char new_status)
 {
+	LIST_HEAD(completed);
+	bool resched = false;
 	int err = 0;
 
 	mutex_lock(&kctx->jctx.lock);
@@ -602,11 +619,23 @@ int kbase_soft_event_update(struct kbase_context *kctx,
 	}
 
 	if (new_status == BASE_JD_SOFT_EVENT_SET)
-		kbasep_complete_triggered_soft_events(kctx, event);
+		kbasep_soft_event_trigger(kctx, event, &completed);
+
+	/* Complete the waiters right away instead of through job_done_wq */
+	while (!list_empty(&completed)) {
+		struct kbase_jd_atom *katom = list_first_entry(&completed,
+				struct kbase_jd_atom, queue);
+
+		list_del(&katom->queue);
+		resched |= jd_done_nolock(katom, NULL);
+	}
 
 out:
 	mutex_unlock(&kctx->jctx.lock);
 
+	if (resched)
+		kbase_js_sched_all(kctx->kbdev);
+
 	return err;
 }
 
@@ -1272,6 +1301,9 @@ static void kbase_ext_res_finish(struct kbase_jd_atom *katom)
 
 int kbase_process_soft_job(struct kbase_jd_atom *katom)
 {
+	trace_mali_atom_start(katom->kctx->id,
+			kbase_jd_atom_id(katom->kctx, katom), -1);
+
 	switch (katom->core_req & BASE_JD_REQ_SOFT_JOB_TYPE) {
 	case BASE_JD_REQ_SOFT_DUMP_CPU_GPU_TIME:
 		return kbase_dump_cpu_gpu_time(katom);
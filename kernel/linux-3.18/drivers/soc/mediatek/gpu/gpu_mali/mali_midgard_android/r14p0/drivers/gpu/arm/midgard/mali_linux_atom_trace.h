@@ -0,0 +1,111 @@
+/*
+ *
+ * This program is free software and is provided to you under the terms of the
+ * GNU General Public License version 2 as published by the Free Software
+ * Foundation, and any use by you of this program is subject to the terms
+ * of such GNU licence.
+ *
+ * A copy of the licence is included with the program, and can also be obtained
+ * from Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ */
+
+
+
+#if !defined(_TRACE_MALI_ATOM_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TRACE_MALI_ATOM_H
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM mali_atom
+
+#include <linux/tracepoint.h>
+
+/**
+ * mali_atom_queue - called from jd_submit_atom()
+ * it reports that an atom has been accepted from user space.
+ * @ctx_id: context id, as in the other kbase tracepoints.
+ * @atom_id: atom number within the context.
+ * @core_req: core requirements of the atom.
+ * @prio: scheduling priority of the atom.
+ */
+TRACE_EVENT(mali_atom_queue,
+	TP_PROTO(u32 ctx_id, int atom_id, u32 core_req, int prio),
+	TP_ARGS(ctx_id, atom_id, core_req, prio),
+	TP_STRUCT__entry(
+		__field(u32, ctx_id)
+		__field(int, atom_id)
+		__field(u32, core_req)
+		__field(int, prio)
+	),
+	TP_fast_assign(
+		__entry->ctx_id = ctx_id;
+		__entry->atom_id = atom_id;
+		__entry->core_req = core_req;
+		__entry->prio = prio;
+	),
+	TP_printk("ctx=%u atom=%d core_req=0x%x prio=%d",
+		__entry->ctx_id, __entry->atom_id, __entry->core_req,
+		__entry->prio)
+);
+
+/**
+ * mali_atom_start - called by kbase_job_hw_submit() and
+ *                   kbase_process_soft_job()
+ * it reports that an atom is written to a job slot, or that a soft job is
+ * being executed.
+ * @ctx_id: context id.
+ * @atom_id: atom number within the context.
+ * @slot: job slot, or -1 for soft jobs.
+ */
+TRACE_EVENT(mali_atom_start,
+	TP_PROTO(u32 ctx_id, int atom_id, int slot),
+	TP_ARGS(ctx_id, atom_id, slot),
+	TP_STRUCT__entry(
+		__field(u32, ctx_id)
+		__field(int, atom_id)
+		__field(int, slot)
+	),
+	TP_fast_assign(
+		__entry->ctx_id = ctx_id;
+		__entry->atom_id = atom_id;
+		__entry->slot = slot;
+	),
+	TP_printk("ctx=%u atom=%d slot=%d",
+		__entry->ctx_id, __entry->atom_id, __entry->slot)
+);
+
+/**
+ * mali_atom_finish - called by jd_done_nolock()
+ * it reports that an atom has completed and its dependencies are resolved.
+ * @ctx_id: context id.
+ * @atom_id: atom number within the context.
+ * @event_code: completion code of the atom.
+ */
+TRACE_EVENT(mali_atom_finish,
+	TP_PROTO(u32 ctx_id, int atom_id, u32 event_code),
+	TP_ARGS(ctx_id, atom_id, event_code),
+	TP_STRUCT__entry(
+		__field(u32, ctx_id)
+		__field(int, atom_id)
+		__field(u32, event_code)
+	),
+	TP_fast_assign(
+		__entry->ctx_id = ctx_id;
+		__entry->atom_id = atom_id;
+		__entry->event_code = event_code;
+	),
+	TP_printk("ctx=%u atom=%d event=0x%x",
+		__entry->ctx_id, __entry->atom_id, __entry->event_code)
+);
+
+#endif /* _TRACE_MALI_ATOM_H */
+
+#undef TRACE_INCLUDE_PATH
+#undef linux
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE mali_linux_atom_trace
+
+/* This part must be outside protection */
+#include <trace/define_trace.h>
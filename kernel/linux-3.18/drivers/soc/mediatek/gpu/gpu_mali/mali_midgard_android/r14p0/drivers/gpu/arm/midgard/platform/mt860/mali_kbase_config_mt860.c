@@ -23,6 +23,9 @@
 #include <mali_kbase_config.h>
 #include "mali_kbase_cpu_mt860.h"
 #include "mali_kbase_config_platform.h"
+#ifdef CONFIG_GPUFREQ_DVFS_MT53xx
+#include "mtk_mali_dvfs.h"
+#endif
 #include <linux/module.h>
 #include <linux/init.h>
 #include <linux/poll.h>
@@ -207,6 +210,13 @@ struct kbase_pm_callback_conf pm_callbacks = {
 	.power_suspend_callback  = pm_callback_suspend_off,
 	.power_resume_callback = pm_callback_resume_on
 };
+
+#ifdef CONFIG_GPUFREQ_DVFS_MT53xx
+struct kbase_platform_funcs_conf platform_funcs = {
+	.platform_init_func = mtk_mali_dvfs_init,
+	.platform_term_func = mtk_mali_dvfs_term
+};
+#endif
 /* Please keep table config_attributes in sync with config_attributes_hw_issue_8408 */
 
 #if 0
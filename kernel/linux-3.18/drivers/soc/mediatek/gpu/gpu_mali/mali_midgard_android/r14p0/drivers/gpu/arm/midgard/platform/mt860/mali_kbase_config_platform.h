@@ -78,7 +78,11 @@
  * Attached value: pointer to @ref kbase_platform_funcs_conf
  * Default value: See @ref kbase_platform_funcs_conf
  */
+#ifdef CONFIG_GPUFREQ_DVFS_MT53xx
+#define PLATFORM_FUNCS (&platform_funcs)
+#else
 #define PLATFORM_FUNCS (NULL)
+#endif
 
 /** Power model for IPA
  *
@@ -94,3 +98,6 @@
 #define SECURE_CALLBACKS (NULL)
 
 extern struct kbase_pm_callback_conf pm_callbacks;
+#ifdef CONFIG_GPUFREQ_DVFS_MT53xx
+extern struct kbase_platform_funcs_conf platform_funcs;
+#endif
@@ -0,0 +1,521 @@
+/*
+* Copyright (C) 2016 MediaTek Inc.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See http://www.gnu.org/licenses/gpl-2.0.html for more details.
+*/
+
+
+#include <linux/kernel.h>
+#include <linux/spinlock.h>
+#include <linux/mutex.h>
+#include <linux/workqueue.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/slab.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <linux/uaccess.h>
+
+#include <mali_kbase.h>
+#include <backend/gpu/mali_kbase_pm_internal.h>
+#include "mtk_gpufreq.h"
+
+#include "mtk_mali_dvfs.h"
+
+
+#define DVFS_LOGD pr_debug
+#define DVFS_LOGE pr_err
+
+#define MTK_DVFS_MAX_OPP	16
+#define MTK_DVFS_TRACE_SIZE	64
+
+enum mtk_dvfs_reason {
+	MTK_DVFS_REASON_FRAME = 0,	/* frame prediction */
+	MTK_DVFS_REASON_UTIL,		/* utilisation above or below thresholds */
+	MTK_DVFS_REASON_IDLE		/* no GPU work at all */
+};
+
+static const char * const reason_str[] = {
+	"frame",
+	"util",
+	"idle"
+};
+
+struct mtk_dvfs_trace {
+	s64 time_us;
+	u32 need_khz;		/* frame prediction, 0 for utilisation */
+	u8 reason;
+	u8 util;
+	u8 from_idx;
+	u8 to_idx;
+};
+
+struct mtk_dvfs_tunables {
+	unsigned int enabled;		/* 0: leave the clock alone */
+	unsigned int vsync_us;		/* frame period to render in */
+	unsigned int target_util;	/* % of vsync_us a frame may take */
+	unsigned int margin;		/* % added to the predicted work */
+	unsigned int frame_gap_us;	/* quiet submission time between frames */
+	unsigned int down_hold;		/* frames/periods wanting less first */
+	unsigned int idle_ms;		/* no frame for this long: utilisation */
+	unsigned int up_threshold;	/* utilisation % to step up */
+	unsigned int down_threshold;	/* utilisation % to step down */
+};
+
+struct mtk_mali_dvfs {
+	/* Everything but mlock is protected by lock, taken from atomic
+	 * context by the metrics timer and job completion.
+	 */
+	spinlock_t lock;
+	struct work_struct work;
+	struct mutex mlock; /* serialises mt_gpufreq_target() */
+
+	struct mtk_dvfs_tunables tune;
+
+	unsigned int opp_khz[MTK_DVFS_MAX_OPP]; /* index 0 is the highest */
+	unsigned int nr_opp;
+	unsigned int cur_idx;	/* as mtk_gpufreq last reported it */
+	unsigned int want_idx;	/* as last requested */
+
+	/* frame model */
+	ktime_t last_submit;
+	ktime_t frame_start;
+	u64 frag_cycles;	/* of the frame in progress, fragment slot */
+	u64 other_cycles;	/* and vertex/tiler/compute */
+	u64 avg_cycles;		/* per frame, 1/4 weight to the last one */
+	u64 peak_cycles;	/* per frame, decays 1/8 per frame */
+	u32 avg_interval_us;
+	u32 nr_frames;
+	unsigned int down_frames;
+	unsigned int low_periods;
+
+	struct mtk_dvfs_trace trace[MTK_DVFS_TRACE_SIZE];
+	unsigned int nr_trace;
+
+	struct proc_dir_entry *proc_dir;
+};
+
+static struct mtk_mali_dvfs mtk_dvfs;
+
+#define LOWER_IDX(dvfs, idx) (((idx) + 1 >= (dvfs)->nr_opp) ? (idx) : ((idx) + 1))
+#define UPPER_IDX(dvfs, idx) (((idx) == 0) ? (idx) : ((idx) - 1))
+
+/* lowest frequency that provides @khz, or the highest */
+static unsigned int mtk_dvfs_idx_for_khz(struct mtk_mali_dvfs *dvfs, u64 khz)
+{
+	unsigned int idx;
+
+	for (idx = dvfs->nr_opp - 1; idx > 0; idx--)
+		if (dvfs->opp_khz[idx] >= khz)
+			break;
+
+	return idx;
+}
+
+static void mtk_dvfs_request_locked(struct mtk_mali_dvfs *dvfs,
+		unsigned int idx, enum mtk_dvfs_reason reason, u32 util,
+		u32 need_khz)
+{
+	struct mtk_dvfs_trace *t;
+
+	lockdep_assert_held(&dvfs->lock);
+
+	if (!dvfs->tune.enabled || idx == dvfs->want_idx)
+		return;
+
+	t = &dvfs->trace[dvfs->nr_trace++ % MTK_DVFS_TRACE_SIZE];
+	t->time_us = ktime_to_us(ktime_get());
+	t->need_khz = need_khz;
+	t->reason = reason;
+	t->util = util;
+	t->from_idx = dvfs->want_idx;
+	t->to_idx = idx;
+
+	dvfs->want_idx = idx;
+	schedule_work(&dvfs->work);
+}
+
+static void mtk_dvfs_frame_start_locked(struct mtk_mali_dvfs *dvfs,
+		ktime_t now)
+{
+	struct mtk_dvfs_tunables *tune = &dvfs->tune;
+	s64 interval_us = ktime_us_delta(now, dvfs->frame_start);
+	u64 work = max(dvfs->frag_cycles, dvfs->other_cycles);
+	u64 predict, need_khz;
+	unsigned int budget_us, idx;
+
+	lockdep_assert_held(&dvfs->lock);
+
+	dvfs->frame_start = now;
+	dvfs->frag_cycles = 0;
+	dvfs->other_cycles = 0;
+
+	/* After idle, the last frame tells nothing: predict from history */
+	if (interval_us < (s64)tune->idle_ms * USEC_PER_MSEC) {
+		dvfs->avg_cycles = dvfs->avg_cycles - (dvfs->avg_cycles >> 2) +
+				(work >> 2);
+		dvfs->peak_cycles = max(work,
+				dvfs->peak_cycles - (dvfs->peak_cycles >> 3));
+		dvfs->avg_interval_us = dvfs->avg_interval_us -
+				(dvfs->avg_interval_us >> 2) +
+				((u32)interval_us >> 2);
+		dvfs->nr_frames++;
+	}
+
+	if (!dvfs->nr_frames)
+		return;
+
+	predict = max(dvfs->avg_cycles, dvfs->peak_cycles);
+	predict += div_u64(predict * tune->margin, 100);
+	budget_us = max(tune->vsync_us * tune->target_util / 100, 1u);
+	need_khz = div_u64(predict * 1000, budget_us);
+	idx = mtk_dvfs_idx_for_khz(dvfs, need_khz);
+
+	if (idx < dvfs->want_idx) {
+		/* Ramp before the frame reaches the GPU */
+		dvfs->down_frames = 0;
+		mtk_dvfs_request_locked(dvfs, idx, MTK_DVFS_REASON_FRAME, 0,
+				(u32)min_t(u64, need_khz, U32_MAX));
+	} else if (idx > dvfs->want_idx) {
+		if (++dvfs->down_frames < tune->down_hold)
+			return;
+		dvfs->down_frames = 0;
+		mtk_dvfs_request_locked(dvfs, LOWER_IDX(dvfs, dvfs->want_idx),
+				MTK_DVFS_REASON_FRAME, 0,
+				(u32)min_t(u64, need_khz, U32_MAX));
+	} else {
+		dvfs->down_frames = 0;
+	}
+}
+
+void kbase_platform_dvfs_job_submitted(struct kbase_device *kbdev,
+		struct kbase_jd_atom *katom)
+{
+	struct mtk_mali_dvfs *dvfs = &mtk_dvfs;
+	ktime_t now = ktime_get();
+	unsigned long flags;
+
+	spin_lock_irqsave(&dvfs->lock, flags);
+	if (dvfs->nr_opp) {
+		if (ktime_us_delta(now, dvfs->last_submit) >=
+				dvfs->tune.frame_gap_us)
+			mtk_dvfs_frame_start_locked(dvfs, now);
+		dvfs->last_submit = now;
+	}
+	spin_unlock_irqrestore(&dvfs->lock, flags);
+}
+
+void kbase_platform_dvfs_job_completed(struct kbase_device *kbdev,
+		struct kbase_jd_atom *katom, u64 time_spent_us)
+{
+	struct mtk_mali_dvfs *dvfs = &mtk_dvfs;
+	unsigned long flags;
+	u64 cycles;
+
+	spin_lock_irqsave(&dvfs->lock, flags);
+	if (dvfs->nr_opp) {
+		/* kHz * us / 1000 */
+		cycles = div_u64(time_spent_us * dvfs->opp_khz[dvfs->cur_idx],
+				1000);
+		if (katom->core_req & BASE_JD_REQ_FS)
+			dvfs->frag_cycles += cycles;
+		else
+			dvfs->other_cycles += cycles;
+	}
+	spin_unlock_irqrestore(&dvfs->lock, flags);
+}
+
+int kbase_platform_dvfs_event(struct kbase_device *kbdev, u32 utilisation,
+	u32 util_gl_share, u32 util_cl_share[2])
+{
+	struct mtk_mali_dvfs *dvfs = &mtk_dvfs;
+	struct mtk_dvfs_tunables *tune = &dvfs->tune;
+	unsigned long flags;
+	bool no_frames;
+
+	spin_lock_irqsave(&dvfs->lock, flags);
+	if (!dvfs->nr_opp)
+		goto out;
+
+	no_frames = ktime_us_delta(ktime_get(), dvfs->frame_start) >=
+			(s64)tune->idle_ms * USEC_PER_MSEC;
+
+	if (utilisation > tune->up_threshold) {
+		/* Behind, whatever the prediction said */
+		dvfs->low_periods = 0;
+		mtk_dvfs_request_locked(dvfs, UPPER_IDX(dvfs, dvfs->want_idx),
+				MTK_DVFS_REASON_UTIL, utilisation, 0);
+	} else if (!no_frames) {
+		/* Frames decide */
+		dvfs->low_periods = 0;
+	} else if (utilisation == 0) {
+		dvfs->low_periods = 0;
+		mtk_dvfs_request_locked(dvfs, dvfs->nr_opp - 1,
+				MTK_DVFS_REASON_IDLE, 0, 0);
+	} else if (utilisation < tune->down_threshold) {
+		if (++dvfs->low_periods >= tune->down_hold) {
+			dvfs->low_periods = 0;
+			mtk_dvfs_request_locked(dvfs,
+					LOWER_IDX(dvfs, dvfs->want_idx),
+					MTK_DVFS_REASON_UTIL, utilisation, 0);
+		}
+	} else {
+		dvfs->low_periods = 0;
+	}
+out:
+	spin_unlock_irqrestore(&dvfs->lock, flags);
+
+	return 1;
+}
+
+static void mtk_dvfs_work(struct work_struct *work)
+{
+	struct mtk_mali_dvfs *dvfs = container_of(work, struct mtk_mali_dvfs,
+			work);
+	unsigned int idx, cur_idx;
+	unsigned long flags;
+
+	mutex_lock(&dvfs->mlock);
+
+	spin_lock_irqsave(&dvfs->lock, flags);
+	idx = dvfs->want_idx;
+	spin_unlock_irqrestore(&dvfs->lock, flags);
+
+	cur_idx = mt_gpufreq_get_cur_freq_index();
+	if (cur_idx != idx) {
+		/* may fail for thermal protecting */
+		mt_gpufreq_target(idx);
+		cur_idx = mt_gpufreq_get_cur_freq_index();
+		DVFS_LOGD("GPU idx %u requested, cur idx is %u\n", idx,
+				cur_idx);
+	}
+
+	spin_lock_irqsave(&dvfs->lock, flags);
+	if (cur_idx < dvfs->nr_opp)
+		dvfs->cur_idx = cur_idx;
+	spin_unlock_irqrestore(&dvfs->lock, flags);
+
+	mutex_unlock(&dvfs->mlock);
+}
+
+#define MTK_DVFS_TUNABLE(_name) \
+	{ #_name, offsetof(struct mtk_dvfs_tunables, _name) }
+
+static const struct {
+	const char *name;
+	size_t offset;
+} mtk_dvfs_tunable_list[] = {
+	MTK_DVFS_TUNABLE(enabled),
+	MTK_DVFS_TUNABLE(vsync_us),
+	MTK_DVFS_TUNABLE(target_util),
+	MTK_DVFS_TUNABLE(margin),
+	MTK_DVFS_TUNABLE(frame_gap_us),
+	MTK_DVFS_TUNABLE(down_hold),
+	MTK_DVFS_TUNABLE(idle_ms),
+	MTK_DVFS_TUNABLE(up_threshold),
+	MTK_DVFS_TUNABLE(down_threshold),
+};
+
+static int mtk_dvfs_tunables_proc_show(struct seq_file *m, void *v)
+{
+	struct mtk_mali_dvfs *dvfs = m->private;
+	struct mtk_dvfs_tunables tune;
+	unsigned long flags;
+	int i;
+
+	spin_lock_irqsave(&dvfs->lock, flags);
+	tune = dvfs->tune;
+	spin_unlock_irqrestore(&dvfs->lock, flags);
+
+	for (i = 0; i < ARRAY_SIZE(mtk_dvfs_tunable_list); i++)
+		seq_printf(m, "%s %u\n", mtk_dvfs_tunable_list[i].name,
+				*(unsigned int *)((char *)&tune +
+					mtk_dvfs_tunable_list[i].offset));
+
+	return 0;
+}
+
+static ssize_t mtk_dvfs_tunables_proc_write(struct file *file,
+		const char __user *buffer, size_t count, loff_t *data)
+{
+	struct mtk_mali_dvfs *dvfs = PDE_DATA(file_inode(file));
+	char desc[64], name[32];
+	unsigned long flags;
+	unsigned int val;
+	int i;
+
+	if (count >= sizeof(desc))
+		return -EINVAL;
+	if (copy_from_user(desc, buffer, count))
+		return -EFAULT;
+	desc[count] = '\0';
+
+	if (sscanf(desc, "%31s %u", name, &val) != 2)
+		return -EINVAL;
+
+	for (i = 0; i < ARRAY_SIZE(mtk_dvfs_tunable_list); i++)
+		if (!strcmp(name, mtk_dvfs_tunable_list[i].name))
+			break;
+	if (i == ARRAY_SIZE(mtk_dvfs_tunable_list))
+		return -EINVAL;
+	if ((!strcmp(name, "vsync_us") || !strcmp(name, "target_util")) &&
+			!val)
+		return -EINVAL;
+
+	spin_lock_irqsave(&dvfs->lock, flags);
+	*(unsigned int *)((char *)&dvfs->tune +
+			mtk_dvfs_tunable_list[i].offset) = val;
+	spin_unlock_irqrestore(&dvfs->lock, flags);
+
+	return count;
+}
+
+static int mtk_dvfs_tunables_proc_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, mtk_dvfs_tunables_proc_show, PDE_DATA(inode));
+}
+
+static const struct file_operations mtk_dvfs_tunables_proc_fops = {
+	.owner = THIS_MODULE,
+	.open = mtk_dvfs_tunables_proc_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+	.write = mtk_dvfs_tunables_proc_write,
+};
+
+static int mtk_dvfs_trace_proc_show(struct seq_file *m, void *v)
+{
+	struct mtk_mali_dvfs *dvfs = m->private;
+	struct mtk_dvfs_trace *trace;
+	unsigned int nr_trace, first, i, cur_idx, want_idx;
+	u64 avg_cycles, peak_cycles;
+	u32 avg_interval_us, nr_frames;
+	unsigned long flags;
+
+	trace = kmalloc(sizeof(dvfs->trace), GFP_KERNEL);
+	if (!trace)
+		return -ENOMEM;
+
+	spin_lock_irqsave(&dvfs->lock, flags);
+	memcpy(trace, dvfs->trace, sizeof(dvfs->trace));
+	nr_trace = dvfs->nr_trace;
+	cur_idx = dvfs->cur_idx;
+	want_idx = dvfs->want_idx;
+	avg_cycles = dvfs->avg_cycles;
+	peak_cycles = dvfs->peak_cycles;
+	avg_interval_us = dvfs->avg_interval_us;
+	nr_frames = dvfs->nr_frames;
+	spin_unlock_irqrestore(&dvfs->lock, flags);
+
+	seq_printf(m, "cur idx %u (%u kHz), requested idx %u (%u kHz)\n",
+			cur_idx, dvfs->opp_khz[cur_idx],
+			want_idx, dvfs->opp_khz[want_idx]);
+	seq_printf(m, "frames %u, interval %u us, cycles avg %llu peak %llu\n",
+			nr_frames, avg_interval_us, avg_cycles, peak_cycles);
+	seq_puts(m, "time_us reason util need_khz from -> to\n");
+
+	first = nr_trace > MTK_DVFS_TRACE_SIZE ?
+			nr_trace - MTK_DVFS_TRACE_SIZE : 0;
+	for (i = first; i < nr_trace; i++) {
+		struct mtk_dvfs_trace *t = &trace[i % MTK_DVFS_TRACE_SIZE];
+
+		seq_printf(m, "%lld %s %u %u %u -> %u\n", t->time_us,
+				reason_str[t->reason], t->util, t->need_khz,
+				t->from_idx, t->to_idx);
+	}
+
+	kfree(trace);
+
+	return 0;
+}
+
+static int mtk_dvfs_trace_proc_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, mtk_dvfs_trace_proc_show, PDE_DATA(inode));
+}
+
+static const struct file_operations mtk_dvfs_trace_proc_fops = {
+	.owner = THIS_MODULE,
+	.open = mtk_dvfs_trace_proc_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+int mtk_mali_dvfs_init(struct kbase_device *kbdev)
+{
+	struct mtk_mali_dvfs *dvfs = &mtk_dvfs;
+	unsigned int nr_opp, idx;
+
+	spin_lock_init(&dvfs->lock);
+	mutex_init(&dvfs->mlock);
+	INIT_WORK(&dvfs->work, mtk_dvfs_work);
+
+	dvfs->tune.enabled = 1;
+	dvfs->tune.vsync_us = 16667;
+	dvfs->tune.target_util = 80;
+	dvfs->tune.margin = 10;
+	dvfs->tune.frame_gap_us = 2000;
+	dvfs->tune.down_hold = 4;
+	dvfs->tune.idle_ms = 100;
+	dvfs->tune.up_threshold = 90;
+	dvfs->tune.down_threshold = 50;
+
+	nr_opp = mt_gpufreq_get_dvfs_table_num();
+	if (nr_opp == 0) {
+		/* hooks stay inactive */
+		DVFS_LOGE("no GPU frequency table, mali dvfs disabled\n");
+		return 0;
+	}
+	nr_opp = min_t(unsigned int, nr_opp, MTK_DVFS_MAX_OPP);
+	for (idx = 0; idx < nr_opp; idx++)
+		dvfs->opp_khz[idx] = mt_gpufreq_get_freq_by_idx(idx);
+
+	dvfs->cur_idx = mt_gpufreq_get_cur_freq_index();
+	if (dvfs->cur_idx >= nr_opp)
+		dvfs->cur_idx = 0;
+	dvfs->want_idx = dvfs->cur_idx;
+	dvfs->last_submit = ktime_set(0, 0);
+	dvfs->frame_start = ktime_set(0, 0);
+
+	dvfs->proc_dir = proc_mkdir("mali_dvfs", NULL);
+	if (dvfs->proc_dir) {
+		proc_create_data("tunables", S_IRUGO | S_IWUSR, dvfs->proc_dir,
+				&mtk_dvfs_tunables_proc_fops, dvfs);
+		proc_create_data("trace", S_IRUGO, dvfs->proc_dir,
+				&mtk_dvfs_trace_proc_fops, dvfs);
+	}
+
+	/* Publish the table last: the hooks test nr_opp under the lock */
+	spin_lock_irq(&dvfs->lock);
+	dvfs->nr_opp = nr_opp;
+	spin_unlock_irq(&dvfs->lock);
+
+	DVFS_LOGD("inited mali dvfs, %u OPPs\n", nr_opp);
+
+	return 0;
+}
+
+void mtk_mali_dvfs_term(struct kbase_device *kbdev)
+{
+	struct mtk_mali_dvfs *dvfs = &mtk_dvfs;
+
+	if (dvfs->proc_dir) {
+		remove_proc_subtree("mali_dvfs", NULL);
+		dvfs->proc_dir = NULL;
+	}
+
+	spin_lock_irq(&dvfs->lock);
+	dvfs->nr_opp = 0;
+	spin_unlock_irq(&dvfs->lock);
+
+	cancel_work_sync(&dvfs->work);
+}
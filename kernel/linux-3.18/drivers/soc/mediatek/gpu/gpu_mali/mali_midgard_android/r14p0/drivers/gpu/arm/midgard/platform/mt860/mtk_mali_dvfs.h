@@ -0,0 +1,36 @@
+/*
+* Copyright (C) 2016 MediaTek Inc.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See http://www.gnu.org/licenses/gpl-2.0.html for more details.
+*/
+
+
+#ifndef _MTK_DVFS_H_
+#define _MTK_DVFS_H_
+
+struct kbase_device;
+
+/*
+ * Frame predictive GPU DVFS governor on top of mtk_gpufreq.
+ *
+ * A frame starts when atoms are submitted after the submission stream has
+ * been quiet for frame_gap_us. At that point the GPU work of the previous
+ * frames (in cycles, the busier of the fragment and vertex/tiler slots)
+ * predicts the work of the new one, and the clock is raised before the
+ * work reaches the GPU if it would not fit in target_util % of vsync_us.
+ * The clock is lowered only after down_hold frames wanting less. Without
+ * frames for idle_ms, the coarse utilisation from the pm metrics decides.
+ *
+ * Tunables and the trace of decisions are in /proc/mali_dvfs.
+ */
+int mtk_mali_dvfs_init(struct kbase_device *kbdev);
+void mtk_mali_dvfs_term(struct kbase_device *kbdev);
+
+#endif
@@ -491,6 +491,15 @@ extern struct cpufreq_governor cpufreq_gov_hotplug;
 #define CPUFREQ_DEFAULT_GOVERNOR    (&cpufreq_gov_hotplug)
 #endif
 
+/* Workload hints for the 'hotplug' governor, see hp_media_hint() */
+#define CPUFREQ_HP_HINT_PLAYBACK	(1 << 0)	/* video/audio playback */
+#define CPUFREQ_HP_HINT_UI		(1 << 1)	/* UI is animating */
+#define CPUFREQ_HP_HINT_STANDBY		(1 << 2)	/* system in standby */
+#define CPUFREQ_HP_HINT_MASK		(0x7)
+
+void hp_limited_cpu_num(unsigned int num);
+void hp_media_hint(unsigned int hint);
+
 /*********************************************************************
  *                     FREQUENCY TABLE HELPERS                       *
  *********************************************************************/
@@ -610,6 +619,6 @@ int cpufreq_generic_init(struct cpufreq_policy *policy,
  *                         CPUFREQ STATS                             *
  *********************************************************************/
 
-void acct_update_power(struct task_struct *p, cputime_t cputime);
+u64 acct_update_power(struct task_struct *p, cputime_t cputime);
 
 #endif /* _LINUX_CPUFREQ_H */
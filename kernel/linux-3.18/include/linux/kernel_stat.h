@@ -95,4 +95,14 @@ extern void account_process_tick(struct task_struct *, int user);
 extern void account_steal_ticks(unsigned long ticks);
 extern void account_idle_ticks(unsigned long ticks);
 
+#ifdef CONFIG_UID_CPUTIME
+extern void uid_cputime_account(struct task_struct *, cputime_t, bool user,
+				u64 power);
+#else
+static inline void uid_cputime_account(struct task_struct *p,
+				       cputime_t cputime, bool user, u64 power)
+{
+}
+#endif
+
 #endif /* _LINUX_KERNEL_STAT_H */
@@ -89,6 +89,9 @@ struct mmc_ext_csd {
 	u8			max_packed_writes;
 	u8			max_packed_reads;
 	u8			packed_event_en;
+	bool			cmdq_support;	/* command queue can be used */
+	bool			cmdq_en;	/* command queue mode enabled */
+	u8			cmdq_depth;	/* number of queue slots */
 	unsigned int		part_time;		/* Units: ms */
 	unsigned int		sa_timeout;		/* Units: 100ns */
 	unsigned int		generic_cmd6_time;	/* Units: 10ms */
@@ -272,6 +275,19 @@ struct mmc_part {
 #define MMC_BLK_DATA_AREA_RPMB	(1<<3)
 };
 
+/*
+ * Per-card request latency histogram, from the fetch of a request by the
+ * block driver until its completion. Bucket n counts latencies below
+ * 64us << n, the last bucket is open ended.
+ */
+#define MMC_LAT_BUCKETS		16
+
+struct mmc_lat_hist {
+	unsigned long		count[2][MMC_LAT_BUCKETS];	/* read, write */
+	unsigned long long	total_us[2];
+	unsigned int		max_us[2];
+};
+
 /*
  * MMC device
  */
@@ -338,6 +354,7 @@ struct mmc_card {
 	unsigned int		mmc_avail_type;	/* supported device type by both host and card */
 
 	struct dentry		*debugfs_root;
+	struct mmc_lat_hist	lat_hist;	/* request latency */
 	struct mmc_part	part[MMC_NUM_PHY_PARTITION]; /* physical partitions */
 	unsigned int    nr_parts;
 };
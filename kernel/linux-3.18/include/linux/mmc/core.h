@@ -194,6 +194,18 @@ extern void mmc_get_card(struct mmc_card *card);
 extern void mmc_put_card(struct mmc_card *card);
 
 extern int mmc_flush_cache(struct mmc_card *);
+extern int mmc_cmdq_enable(struct mmc_card *);
+extern int mmc_cmdq_disable(struct mmc_card *);
+
+#ifdef CONFIG_DEBUG_FS
+extern void mmc_lat_hist_add(struct mmc_card *card, int write,
+			     unsigned int us);
+#else
+static inline void mmc_lat_hist_add(struct mmc_card *card, int write,
+				    unsigned int us)
+{
+}
+#endif
 
 extern int mmc_detect_card_removed(struct mmc_host *host);
 
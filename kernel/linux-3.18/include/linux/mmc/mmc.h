@@ -85,6 +85,13 @@ extern const u8 tuning_blk_pattern_8bit[MMC_TUNING_BLK_PATTERN_8BIT_SIZE];
   /* class 7 */
 #define MMC_LOCK_UNLOCK          42   /* adtc                    R1b */
 
+  /* class 11 */
+#define MMC_QUE_TASK_PARAMS      44   /* ac   [20:16] task id    R1  */
+#define MMC_QUE_TASK_ADDR        45   /* ac   [31:0] data addr   R1  */
+#define MMC_EXECUTE_READ_TASK    46   /* adtc [20:16] task id    R1  */
+#define MMC_EXECUTE_WRITE_TASK   47   /* adtc [20:16] task id    R1  */
+#define MMC_CMDQ_TASK_MGMT       48   /* ac   [20:16] task id    R1b */
+
   /* class 8 */
 #define MMC_APP_CMD              55   /* ac   [31:16] RCA        R1  */
 #define MMC_GEN_CMD              56   /* adtc [0] RD/WR          R1  */
@@ -277,6 +284,7 @@ struct _mmc_csd {
  * EXT_CSD fields
  */
 
+#define EXT_CSD_CMDQ_MODE_EN		15	/* R/W */
 #define EXT_CSD_FLUSH_CACHE		32      /* W */
 #define EXT_CSD_CACHE_CTRL		33      /* R/W */
 #define EXT_CSD_POWER_OFF_NOTIFICATION	34	/* R/W */
@@ -332,6 +340,8 @@ struct _mmc_csd {
 #define EXT_CSD_GENERIC_CMD6_TIME	248	/* RO */
 #define EXT_CSD_CACHE_SIZE		249	/* RO, 4 bytes */
 #define EXT_CSD_PWR_CL_DDR_200_360	253	/* RO */
+#define EXT_CSD_CMDQ_DEPTH		307	/* RO */
+#define EXT_CSD_CMDQ_SUPPORT		308	/* RO */
 #define EXT_CSD_TAG_UNIT_SIZE		498	/* RO */
 #define EXT_CSD_DATA_TAG_SUPPORT	499	/* RO */
 #define EXT_CSD_MAX_PACKED_WRITES	500	/* RO */
@@ -429,6 +439,23 @@ struct _mmc_csd {
  */
 #define EXT_CSD_BKOPS_LEVEL_2		0x2
 
+/*
+ * Command Queue (eMMC 5.1)
+ */
+#define EXT_CSD_CMDQ_SUPPORTED		BIT(0)
+#define EXT_CSD_CMDQ_DEPTH_MASK		0x1F	/* depth is this plus one */
+
+#define MMC_CMDQ_TASK_REL_WR		BIT(31)	/* CMD44: reliable write */
+#define MMC_CMDQ_TASK_READ		BIT(30)	/* CMD44: data direction */
+#define MMC_CMDQ_TASK_PRIO		BIT(23)	/* CMD44: high priority */
+#define MMC_CMDQ_TASK_ID_SHIFT		16	/* CMD44/46/47/48 task id */
+#define MMC_CMDQ_MAX_BLOCKS		0xFFFF	/* CMD44 block count */
+
+#define MMC_SEND_STATUS_SQS		BIT(15)	/* CMD13: Queue Status Reg */
+
+#define MMC_CMDQ_DISCARD_QUEUE		0x1	/* CMD48 TM op-codes */
+#define MMC_CMDQ_DISCARD_TASK		0x2
+
 /*
  * MMC_SWITCH access modes
  */
@@ -0,0 +1,58 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM cpufreq_hotplug
+
+#if !defined(_TRACE_CPUFREQ_HOTPLUG_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TRACE_CPUFREQ_HOTPLUG_H
+
+#include <linux/tracepoint.h>
+
+TRACE_EVENT(cpufreq_hotplug_decision,
+	    TP_PROTO(const char *reason, unsigned int online,
+		     unsigned int target, unsigned int load,
+		     unsigned int rq_load, unsigned int hint),
+	    TP_ARGS(reason, online, target, load, rq_load, hint),
+
+	    TP_STRUCT__entry(
+		    __string(reason, reason)
+		    __field(unsigned int, online)
+		    __field(unsigned int, target)
+		    __field(unsigned int, load)
+		    __field(unsigned int, rq_load)
+		    __field(unsigned int, hint)
+	    ),
+
+	    TP_fast_assign(
+		    __assign_str(reason, reason);
+		    __entry->online = online;
+		    __entry->target = target;
+		    __entry->load = load;
+		    __entry->rq_load = rq_load;
+		    __entry->hint = hint;
+	    ),
+
+	    TP_printk("%s online=%u target=%u load=%u rq_load=%u hint=%#x",
+		      __get_str(reason), __entry->online, __entry->target,
+		      __entry->load, __entry->rq_load, __entry->hint)
+);
+
+TRACE_EVENT(cpufreq_hotplug_hint,
+	    TP_PROTO(unsigned int old_hint, unsigned int new_hint),
+	    TP_ARGS(old_hint, new_hint),
+
+	    TP_STRUCT__entry(
+		    __field(unsigned int, old_hint)
+		    __field(unsigned int, new_hint)
+	    ),
+
+	    TP_fast_assign(
+		    __entry->old_hint = old_hint;
+		    __entry->new_hint = new_hint;
+	    ),
+
+	    TP_printk("old=%#x new=%#x", __entry->old_hint, __entry->new_hint)
+);
+
+#endif /* _TRACE_CPUFREQ_HOTPLUG_H */
+
+/* This part must be outside protection */
+#include <trace/define_trace.h>
@@ -2401,6 +2401,7 @@ unsigned long nr_running(void)
 
 	return sum;
 }
+EXPORT_SYMBOL_GPL(nr_running);
 
 /*
  * Check if only the current task is running on the cpu.
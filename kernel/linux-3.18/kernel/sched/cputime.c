@@ -136,6 +136,7 @@ static inline void task_group_account_field(struct task_struct *p, int index,
 void account_user_time(struct task_struct *p, cputime_t cputime,
 		       cputime_t cputime_scaled)
 {
+	u64 power = 0;
 	int index;
 
 	/* Add user time to process. */
@@ -153,8 +154,11 @@ void account_user_time(struct task_struct *p, cputime_t cputime,
 
 #ifdef CONFIG_CPU_FREQ_STAT
 	/* Account power usage for user time */
-	acct_update_power(p, cputime);
+	power = acct_update_power(p, cputime);
 #endif
+
+	/* Account user time and power used to the UID */
+	uid_cputime_account(p, cputime, true, power);
 }
 
 /*
@@ -173,6 +177,7 @@ static void account_guest_time(struct task_struct *p, cputime_t cputime,
 	p->utimescaled += cputime_scaled;
 	account_group_user_time(p, cputime);
 	p->gtime += cputime;
+	uid_cputime_account(p, cputime, true, 0);
 
 	/* Add guest time to cpustat. */
 	if (task_nice(p) > 0) {
@@ -195,6 +200,8 @@ static inline
 void __account_system_time(struct task_struct *p, cputime_t cputime,
 			cputime_t cputime_scaled, int index)
 {
+	u64 power = 0;
+
 	/* Add system time to process. */
 	p->stime += cputime;
 	p->stimescaled += cputime_scaled;
@@ -208,8 +215,11 @@ void __account_system_time(struct task_struct *p, cputime_t cputime,
 
 #ifdef CONFIG_CPU_FREQ_STAT
 	/* Account power usage for system time */
-	acct_update_power(p, cputime);
+	power = acct_update_power(p, cputime);
 #endif
+
+	/* Account system time and power used to the UID */
+	uid_cputime_account(p, cputime, false, power);
 }
 
 /*
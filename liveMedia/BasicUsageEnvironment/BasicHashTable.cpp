@@ -0,0 +1,234 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// Basic Hash Table implementation
+// Implementation
+
+#include "BasicHashTable.hh"
+#include "strDup.hh"
+
+#if defined(__WIN32__) || defined(_WIN32)
+#else
+#include <stddef.h>
+#endif
+#include <string.h>
+
+// The number of slots in a new table.  (This is always a power of 2.)
+#define INITIAL_NUM_SLOTS 8
+#define EMPTY_SLOT 0
+#define DELETED_SLOT 1
+
+////////// BasicHashTable //////////
+
+BasicHashTable::BasicHashTable(int keyType)
+  : fSlots(NULL), fNumSlots(0), fNumEntries(0), fNumDeletedSlots(0),
+    fKeyType(keyType) {
+  rebuild(INITIAL_NUM_SLOTS);
+}
+
+BasicHashTable::~BasicHashTable() {
+  for (unsigned i = 0; i < fNumSlots; ++i) {
+    if (fSlots[i].hash > DELETED_SLOT) deleteKey(fSlots[i].key);
+  }
+  delete[] fSlots;
+}
+
+void* BasicHashTable::Add(char const* key, void* value) {
+  unsigned const hash = hashFor(key);
+
+  TableEntry* entry = lookupEntry(key, hash);
+  if (entry != NULL) {
+    // There's already an item with this key; replace its value:
+    void* oldValue = entry->value;
+    entry->value = value;
+    return oldValue;
+  }
+
+  // Make sure that - after this insertion - at least 1/4 of the slots stay empty,
+  // so that probe sequences stay short (and are guaranteed to end):
+  if (4*(fNumEntries + fNumDeletedSlots + 1) > 3*fNumSlots) {
+    rebuild(4*(fNumEntries + 1) > fNumSlots ? 2*fNumSlots : fNumSlots);
+  }
+
+  // Use the first empty or deleted slot in this key's probe sequence:
+  unsigned const mask = fNumSlots - 1;
+  unsigned i = hash&mask;
+  while (fSlots[i].hash > DELETED_SLOT) i = (i+1)&mask;
+  if (fSlots[i].hash == DELETED_SLOT) --fNumDeletedSlots;
+
+  fSlots[i].hash = hash;
+  fSlots[i].key = copyKey(key);
+  fSlots[i].value = value;
+  ++fNumEntries;
+
+  return 0;
+}
+
+Boolean BasicHashTable::Remove(char const* key) {
+  TableEntry* entry = lookupEntry(key, hashFor(key));
+  if (entry == NULL) return False; // no such entry
+
+  // Mark the slot as deleted (rather than empty), so that the probe sequences of
+  // other keys - and any iteration that's in progress - aren't broken:
+  deleteKey(entry->key);
+  entry->hash = DELETED_SLOT;
+  entry->key = NULL;
+  entry->value = NULL;
+  --fNumEntries;
+  ++fNumDeletedSlots;
+
+  return True;
+}
+
+void* BasicHashTable::Lookup(char const* key) const {
+  TableEntry* entry = lookupEntry(key, hashFor(key));
+  if (entry == NULL) return NULL; // no such entry
+
+  return entry->value;
+}
+
+unsigned BasicHashTable::numEntries() const {
+  return fNumEntries;
+}
+
+BasicHashTable::TableEntry* BasicHashTable
+::lookupEntry(char const* key, unsigned hash) const {
+  unsigned const mask = fNumSlots - 1;
+  for (unsigned i = hash&mask; fSlots[i].hash != EMPTY_SLOT; i = (i+1)&mask) {
+    // Compare the (precomputed) hashes first, to avoid most key comparisons:
+    if (fSlots[i].hash == hash && keyMatches(fSlots[i].key, key)) return &fSlots[i];
+  }
+
+  return NULL;
+}
+
+void BasicHashTable::rebuild(unsigned newNumSlots) {
+  TableEntry* oldSlots = fSlots;
+  unsigned oldNumSlots = fNumSlots;
+
+  fSlots = new TableEntry[newNumSlots];
+  for (unsigned i = 0; i < newNumSlots; ++i) {
+    fSlots[i].hash = EMPTY_SLOT;
+    fSlots[i].key = NULL;
+    fSlots[i].value = NULL;
+  }
+  fNumSlots = newNumSlots;
+  fNumDeletedSlots = 0;
+
+  // Move each existing entry into the new array.  (Its key, and hash, are reused as is.)
+  unsigned const mask = fNumSlots - 1;
+  for (unsigned j = 0; j < oldNumSlots; ++j) {
+    if (oldSlots[j].hash <= DELETED_SLOT) continue;
+
+    unsigned i = oldSlots[j].hash&mask;
+    while (fSlots[i].hash != EMPTY_SLOT) i = (i+1)&mask;
+    fSlots[i] = oldSlots[j];
+  }
+
+  delete[] oldSlots;
+}
+
+unsigned BasicHashTable::hashFor(char const* key) const {
+  unsigned result;
+
+  if (fKeyType == STRING_HASH_KEYS) {
+    // FNV-1a:
+    result = 2166136261U;
+    for (unsigned char const* p = (unsigned char const*)key; *p != '\0'; ++p) {
+      result = (result^*p)*16777619U;
+    }
+  } else if (fKeyType == ONE_WORD_HASH_KEYS) {
+    ptrdiff_t word = (ptrdiff_t)key;
+    result = (unsigned)word;
+    if (sizeof word > sizeof result) result ^= (unsigned)(((unsigned long long)word)>>32);
+  } else {
+    unsigned const* k = (unsigned const*)key;
+    result = 0;
+    for (int i = 0; i < fKeyType; ++i) {
+      result = result*1103515245 + k[i];
+    }
+  }
+
+  // Mix all of the bits into the low-order ones (which are the ones used to index slots):
+  result ^= result>>16; result *= 0x85EBCA6BU;
+  result ^= result>>13; result *= 0xC2B2AE35U;
+  result ^= result>>16;
+
+  // Don't collide with the special "hash" values used to mark unused slots:
+  if (result <= DELETED_SLOT) result += 2;
+  return result;
+}
+
+Boolean BasicHashTable::keyMatches(char const* key1, char const* key2) const {
+  // The way we check the keys for a match depends upon their type:
+  if (fKeyType == STRING_HASH_KEYS) {
+    return (strcmp(key1, key2) == 0);
+  } else if (fKeyType == ONE_WORD_HASH_KEYS) {
+    return (key1 == key2);
+  } else {
+    return memcmp(key1, key2, fKeyType*sizeof (unsigned)) == 0;
+  }
+}
+
+char const* BasicHashTable::copyKey(char const* key) const {
+  if (fKeyType == STRING_HASH_KEYS) {
+    return strDup(key);
+  } else if (fKeyType == ONE_WORD_HASH_KEYS) {
+    return key; // the key is the word itself; there's nothing to copy
+  } else {
+    unsigned* keyTo = new unsigned[fKeyType];
+    memmove(keyTo, key, fKeyType*sizeof (unsigned));
+    return (char const*)keyTo;
+  }
+}
+
+void BasicHashTable::deleteKey(char const* key) const {
+  if (fKeyType == STRING_HASH_KEYS) {
+    delete[] (char*)key;
+  } else if (fKeyType != ONE_WORD_HASH_KEYS) {
+    delete[] (unsigned*)key;
+  }
+}
+
+////////// BasicHashTable::Iterator //////////
+
+BasicHashTable::Iterator::Iterator(BasicHashTable const& table)
+  : fTable(table), fNextIndex(0) {
+}
+
+void* BasicHashTable::Iterator::next(char const*& key) {
+  while (fNextIndex < fTable.fNumSlots) {
+    TableEntry const& entry = fTable.fSlots[fNextIndex++];
+    if (entry.hash > DELETED_SLOT) {
+      key = entry.key;
+      return entry.value;
+    }
+  }
+
+  key = NULL;
+  return NULL;
+}
+
+////////// Implementation of HashTable creation functions //////////
+
+HashTable* HashTable::create(int keyType) {
+  return new BasicHashTable(keyType);
+}
+
+HashTable::Iterator* HashTable::Iterator::create(HashTable& hashTable) {
+  // "hashTable" is assumed to be a BasicHashTable
+  return new BasicHashTable::Iterator((BasicHashTable&)hashTable);
+}
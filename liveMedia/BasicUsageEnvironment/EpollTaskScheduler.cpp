@@ -0,0 +1,453 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// Basic Usage Environment: for a simple, non-scripted, console application
+// An "epoll()"-based task scheduler (Linux only)
+// Implementation
+
+#include "EpollTaskScheduler.hh"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <time.h>
+
+////////// Helpers //////////
+
+#define NO_HEAP_INDEX (~0U)
+#define NO_FREE_SLOT (~0U)
+
+// Delayed task tokens are "(generation << TOKEN_SLOT_BITS) | (slot + 1)":
+#define TOKEN_SLOT_BITS 20
+#define TOKEN_SLOT_MASK ((1U<<TOKEN_SLOT_BITS) - 1)
+#define TOKEN_GENERATION_MASK ((~0U) >> TOKEN_SLOT_BITS)
+
+#define MAX_EPOLL_WAIT_MILLISECONDS (1000*1000) // ~16 minutes
+
+static int64_t monotonicMicroseconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+}
+
+template <class T>
+static Boolean growArray(T*& array, unsigned& size, unsigned minSize) {
+  unsigned newSize = size == 0 ? 16 : size;
+  while (newSize < minSize) newSize *= 2;
+  if (newSize == size) return True;
+
+  T* newArray = new T[newSize];
+  if (newArray == NULL) return False;
+  for (unsigned i = 0; i < size; ++i) newArray[i] = array[i];
+  delete[] array;
+  array = newArray; size = newSize;
+  return True;
+}
+
+////////// EpollTaskScheduler //////////
+
+EpollTaskScheduler* EpollTaskScheduler::createNew(Boolean edgeTriggered,
+						  unsigned maxEventsPerPoll) {
+  int epollFd = epoll_create(256); // the size is only a hint
+  if (epollFd < 0) return NULL;
+  fcntl(epollFd, F_SETFD, FD_CLOEXEC);
+
+  int wakeupFd = eventfd(0, 0);
+  if (wakeupFd < 0) {
+    ::close(epollFd);
+    return NULL;
+  }
+  fcntl(wakeupFd, F_SETFL, fcntl(wakeupFd, F_GETFL) | O_NONBLOCK);
+  fcntl(wakeupFd, F_SETFD, FD_CLOEXEC);
+
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof ev);
+  ev.events = EPOLLIN;
+  ev.data.fd = wakeupFd;
+  if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupFd, &ev) != 0) {
+    ::close(wakeupFd); ::close(epollFd);
+    return NULL;
+  }
+
+  if (maxEventsPerPoll == 0) maxEventsPerPoll = 1;
+  return new EpollTaskScheduler(epollFd, wakeupFd, edgeTriggered, maxEventsPerPoll);
+}
+
+EpollTaskScheduler::EpollTaskScheduler(int epollFd, int wakeupFd, Boolean edgeTriggered,
+				       unsigned maxEventsPerPoll)
+  : fEpollFd(epollFd), fWakeupFd(wakeupFd), fEdgeTriggered(edgeTriggered),
+    fMaxEventsPerPoll(maxEventsPerPoll),
+    fHandlers(NULL), fHandlersSize(0), fNumHandlers(0),
+    fTasks(NULL), fTasksSize(0), fFirstFreeTask(NO_FREE_SLOT),
+    fHeap(NULL), fHeapSize(0),
+    fEventTriggersAwaitingHandling(0), fLastUsedTriggerMask(1) {
+  fReadyEvents = new struct epoll_event[fMaxEventsPerPoll];
+  for (unsigned i = 0; i < EPOLL_MAX_NUM_EVENT_TRIGGERS; ++i) {
+    fTriggeredEventHandlers[i] = NULL;
+    fTriggeredEventClientDatas[i] = NULL;
+  }
+}
+
+EpollTaskScheduler::~EpollTaskScheduler() {
+  ::close(fWakeupFd);
+  ::close(fEpollFd);
+  delete[] fReadyEvents;
+  delete[] fHandlers;
+  delete[] fTasks;
+  delete[] fHeap;
+}
+
+void EpollTaskScheduler::doEventLoop(char* watchVariable) {
+  // Repeatedly loop, handling readble sockets and timed events:
+  while (1) {
+    if (watchVariable != NULL && *watchVariable != 0) break;
+    SingleStep();
+  }
+}
+
+void EpollTaskScheduler::SingleStep(unsigned maxDelayTime) {
+  // Block until the earliest delayed task is due (or "maxDelayTime" elapses):
+  int timeoutMs = -1;
+  if (fHeapSize > 0) {
+    int64_t delay = fTasks[fHeap[0]].dueTime - monotonicMicroseconds();
+    if (delay < 0) delay = 0;
+    int64_t ms = (delay + 999)/1000; // round up, so that we don't wake early
+    timeoutMs = ms > MAX_EPOLL_WAIT_MILLISECONDS ? MAX_EPOLL_WAIT_MILLISECONDS : (int)ms;
+  }
+  if (maxDelayTime > 0) {
+    int maxMs = (int)((maxDelayTime + 999)/1000);
+    if (timeoutMs < 0 || maxMs < timeoutMs) timeoutMs = maxMs;
+  }
+
+  int numReady = epoll_wait(fEpollFd, fReadyEvents, (int)fMaxEventsPerPoll, timeoutMs);
+  if (numReady < 0) {
+    if (errno != EINTR) {
+      internalError();
+    }
+    numReady = 0;
+  }
+
+  for (int i = 0; i < numReady; ++i) {
+    int sock = fReadyEvents[i].data.fd;
+    if (sock == fWakeupFd) {
+      u_int64_t counter;
+      while (::read(fWakeupFd, &counter, sizeof counter) > 0) {}
+      continue;
+    }
+
+    // Look up the handler again for each event, because an earlier handler
+    // (in this same batch) may have changed or removed it:
+    if (sock < 0 || (unsigned)sock >= fHandlersSize) continue;
+    SocketHandler& handler = fHandlers[sock];
+    if (handler.conditionSet == 0 || handler.handlerProc == NULL) continue;
+
+    u_int32_t events = fReadyEvents[i].events;
+    int resultConditionSet = 0;
+    if (events & (EPOLLIN|EPOLLHUP|EPOLLERR)) resultConditionSet |= SOCKET_READABLE;
+    if (events & EPOLLOUT) resultConditionSet |= SOCKET_WRITABLE;
+    if (events & (EPOLLPRI|EPOLLERR)) resultConditionSet |= SOCKET_EXCEPTION;
+    resultConditionSet &= handler.conditionSet;
+    if (resultConditionSet == 0) continue;
+
+    (*handler.handlerProc)(handler.clientData, resultConditionSet);
+  }
+
+  handleTriggeredEvents();
+  handleDueTasks();
+}
+
+////////// Socket handling //////////
+
+Boolean EpollTaskScheduler::ensureHandlerSlot(int socketNum) {
+  unsigned oldSize = fHandlersSize;
+  if ((unsigned)socketNum < oldSize) return True;
+  if (!growArray(fHandlers, fHandlersSize, (unsigned)socketNum + 1)) return False;
+
+  for (unsigned i = oldSize; i < fHandlersSize; ++i) {
+    fHandlers[i].conditionSet = 0;
+    fHandlers[i].handlerProc = NULL;
+    fHandlers[i].clientData = NULL;
+  }
+  return True;
+}
+
+Boolean EpollTaskScheduler
+::updateEpollRegistration(int socketNum, int oldConditionSet, int newConditionSet) {
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof ev);
+  ev.data.fd = socketNum;
+  if (newConditionSet&SOCKET_READABLE) ev.events |= EPOLLIN;
+  if (newConditionSet&SOCKET_WRITABLE) ev.events |= EPOLLOUT;
+  if (newConditionSet&SOCKET_EXCEPTION) ev.events |= EPOLLPRI;
+  if (fEdgeTriggered) ev.events |= EPOLLET;
+
+  int op;
+  if (newConditionSet == 0) {
+    if (oldConditionSet == 0) return True;
+    op = EPOLL_CTL_DEL;
+  } else {
+    op = oldConditionSet == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+  }
+
+  if (epoll_ctl(fEpollFd, op, socketNum, &ev) == 0) return True;
+
+  // Recover from a registration that got out of step with ours (e.g., because the
+  // socket was closed - and its number reused - without our being told):
+  if (op == EPOLL_CTL_ADD && errno == EEXIST) {
+    return epoll_ctl(fEpollFd, EPOLL_CTL_MOD, socketNum, &ev) == 0;
+  } else if (op == EPOLL_CTL_MOD && errno == ENOENT) {
+    return epoll_ctl(fEpollFd, EPOLL_CTL_ADD, socketNum, &ev) == 0;
+  }
+  return op == EPOLL_CTL_DEL; // a closed socket has already been removed
+}
+
+void EpollTaskScheduler
+::setBackgroundHandling(int socketNum, int conditionSet,
+			BackgroundHandlerProc* handlerProc, void* clientData) {
+  if (socketNum < 0) return;
+  if (handlerProc == NULL) conditionSet = 0;
+  if (conditionSet == 0 && (unsigned)socketNum >= fHandlersSize) return;
+  if (!ensureHandlerSlot(socketNum)) return;
+
+  SocketHandler& handler = fHandlers[socketNum];
+  if (!updateEpollRegistration(socketNum, handler.conditionSet, conditionSet)) {
+    internalError();
+    return;
+  }
+
+  if (handler.conditionSet == 0 && conditionSet != 0) ++fNumHandlers;
+  else if (handler.conditionSet != 0 && conditionSet == 0) --fNumHandlers;
+
+  handler.conditionSet = conditionSet;
+  handler.handlerProc = conditionSet == 0 ? NULL : handlerProc;
+  handler.clientData = conditionSet == 0 ? NULL : clientData;
+}
+
+void EpollTaskScheduler::moveSocketHandling(int oldSocketNum, int newSocketNum) {
+  if (oldSocketNum < 0 || newSocketNum < 0 || oldSocketNum == newSocketNum) return;
+  if ((unsigned)oldSocketNum >= fHandlersSize) return;
+
+  SocketHandler handler = fHandlers[oldSocketNum];
+  if (handler.conditionSet == 0) return;
+
+  setBackgroundHandling(oldSocketNum, 0, NULL, NULL);
+  setBackgroundHandling(newSocketNum, handler.conditionSet,
+			handler.handlerProc, handler.clientData);
+}
+
+////////// Delayed tasks //////////
+
+unsigned EpollTaskScheduler::allocTaskSlot() {
+  if (fFirstFreeTask == NO_FREE_SLOT) {
+    unsigned oldSize = fTasksSize;
+    if (oldSize >= TOKEN_SLOT_MASK) return NO_FREE_SLOT;
+    if (!growArray(fTasks, fTasksSize, oldSize + 1)) return NO_FREE_SLOT;
+
+    unsigned heapCapacity = oldSize;
+    if (!growArray(fHeap, heapCapacity, fTasksSize)) return NO_FREE_SLOT;
+
+    // Thread the new slots onto the free list, lowest index first:
+    for (unsigned i = fTasksSize; i > oldSize; --i) {
+      DelayedTask& task = fTasks[i-1];
+      task.heapIndex = NO_HEAP_INDEX;
+      task.generation = 0;
+      task.nextFree = fFirstFreeTask;
+      fFirstFreeTask = i-1;
+    }
+  }
+
+  unsigned slot = fFirstFreeTask;
+  fFirstFreeTask = fTasks[slot].nextFree;
+  return slot;
+}
+
+void EpollTaskScheduler::freeTaskSlot(unsigned slot) {
+  DelayedTask& task = fTasks[slot];
+  task.heapIndex = NO_HEAP_INDEX;
+  ++task.generation; // invalidates any outstanding token for this slot
+  task.nextFree = fFirstFreeTask;
+  fFirstFreeTask = slot;
+}
+
+void EpollTaskScheduler::heapSwap(unsigned i, unsigned j) {
+  unsigned tmp = fHeap[i]; fHeap[i] = fHeap[j]; fHeap[j] = tmp;
+  fTasks[fHeap[i]].heapIndex = i;
+  fTasks[fHeap[j]].heapIndex = j;
+}
+
+void EpollTaskScheduler::siftUp(unsigned i) {
+  while (i > 0) {
+    unsigned parent = (i-1)/2;
+    if (fTasks[fHeap[parent]].dueTime <= fTasks[fHeap[i]].dueTime) break;
+    heapSwap(i, parent);
+    i = parent;
+  }
+}
+
+void EpollTaskScheduler::siftDown(unsigned i) {
+  while (1) {
+    unsigned smallest = i;
+    unsigned left = 2*i + 1, right = left + 1;
+    if (left < fHeapSize && fTasks[fHeap[left]].dueTime < fTasks[fHeap[smallest]].dueTime) smallest = left;
+    if (right < fHeapSize && fTasks[fHeap[right]].dueTime < fTasks[fHeap[smallest]].dueTime) smallest = right;
+    if (smallest == i) break;
+    heapSwap(i, smallest);
+    i = smallest;
+  }
+}
+
+void EpollTaskScheduler::heapRemove(unsigned i) {
+  unsigned last = --fHeapSize;
+  if (i != last) {
+    heapSwap(i, last);
+    siftDown(i);
+    siftUp(i);
+  }
+}
+
+TaskToken EpollTaskScheduler::scheduleDelayedTask(int64_t microseconds,
+						  TaskFunc* proc,
+						  void* clientData) {
+  if (microseconds < 0) microseconds = 0;
+
+  unsigned slot = allocTaskSlot();
+  if (slot == NO_FREE_SLOT) {
+    internalError();
+    return NULL;
+  }
+
+  DelayedTask& task = fTasks[slot];
+  task.dueTime = monotonicMicroseconds() + microseconds;
+  task.proc = proc;
+  task.clientData = clientData;
+  task.heapIndex = fHeapSize;
+  fHeap[fHeapSize++] = slot;
+  siftUp(task.heapIndex);
+
+  uintptr_t token = ((uintptr_t)(task.generation&TOKEN_GENERATION_MASK) << TOKEN_SLOT_BITS)
+    | (slot + 1);
+  return (TaskToken)token;
+}
+
+void EpollTaskScheduler::unscheduleDelayedTask(TaskToken& prevTask) {
+  uintptr_t token = (uintptr_t)prevTask;
+  prevTask = NULL;
+  if (token == 0) return;
+
+  unsigned slot = (unsigned)(token&TOKEN_SLOT_MASK) - 1;
+  unsigned generation = (unsigned)(token >> TOKEN_SLOT_BITS);
+  if (slot >= fTasksSize) return;
+
+  DelayedTask& task = fTasks[slot];
+  if (task.heapIndex == NO_HEAP_INDEX
+      || (task.generation&TOKEN_GENERATION_MASK) != generation) {
+    return; // the task has already run (or been unscheduled)
+  }
+
+  heapRemove(task.heapIndex);
+  freeTaskSlot(slot);
+}
+
+void EpollTaskScheduler::handleDueTasks() {
+  // Run only those tasks that are due now; tasks that get scheduled (with zero
+  // delay) by these handlers are left until the next step, so that sockets
+  // cannot be starved:
+  int64_t now = monotonicMicroseconds();
+  unsigned numToRun = fHeapSize;
+  while (fHeapSize > 0 && numToRun-- > 0) {
+    unsigned slot = fHeap[0];
+    DelayedTask& task = fTasks[slot];
+    if (task.dueTime > now) break;
+
+    TaskFunc* proc = task.proc;
+    void* clientData = task.clientData;
+    heapRemove(0);
+    freeTaskSlot(slot);
+
+    if (proc != NULL) (*proc)(clientData);
+  }
+}
+
+////////// Event triggers //////////
+
+EventTriggerId EpollTaskScheduler::createEventTrigger(TaskFunc* eventHandlerProc) {
+  unsigned i = 0;
+  u_int32_t mask = 1;
+
+  // Look for an available event trigger ID:
+  for (; i < EPOLL_MAX_NUM_EVENT_TRIGGERS; ++i, mask <<= 1) {
+    if (fTriggeredEventHandlers[i] == NULL) {
+      fTriggeredEventHandlers[i] = eventHandlerProc;
+      fTriggeredEventClientDatas[i] = NULL;
+      return mask;
+    }
+  }
+
+  return 0; // all trigger IDs are in use
+}
+
+void EpollTaskScheduler::deleteEventTrigger(EventTriggerId eventTriggerId) {
+  __sync_fetch_and_and(&fEventTriggersAwaitingHandling, ~eventTriggerId);
+
+  u_int32_t mask = 1;
+  for (unsigned i = 0; i < EPOLL_MAX_NUM_EVENT_TRIGGERS; ++i, mask <<= 1) {
+    if ((eventTriggerId&mask) != 0) {
+      fTriggeredEventHandlers[i] = NULL;
+      fTriggeredEventClientDatas[i] = NULL;
+    }
+  }
+}
+
+void EpollTaskScheduler::triggerEvent(EventTriggerId eventTriggerId, void* clientData) {
+  // This may be called from an external thread, so only touch state atomically,
+  // and then wake up "epoll_wait()":
+  u_int32_t mask = 1;
+  for (unsigned i = 0; i < EPOLL_MAX_NUM_EVENT_TRIGGERS; ++i, mask <<= 1) {
+    if ((eventTriggerId&mask) != 0) {
+      fTriggeredEventClientDatas[i] = clientData;
+    }
+  }
+  u_int32_t alreadyAwaiting = __sync_fetch_and_or(&fEventTriggersAwaitingHandling, eventTriggerId);
+
+  // If these events were already awaiting handling, then the event loop has already been
+  // woken up for them (and - because it reads "fWakeupFd" before it looks at
+  // "fEventTriggersAwaitingHandling" - will still see them), so we needn't wake it again:
+  if ((alreadyAwaiting&eventTriggerId) == eventTriggerId) return;
+
+  u_int64_t one = 1;
+  (void)::write(fWakeupFd, &one, sizeof one);
+}
+
+void EpollTaskScheduler::handleTriggeredEvents() {
+  u_int32_t pending = __sync_fetch_and_and(&fEventTriggersAwaitingHandling, 0);
+  if (pending == 0) return;
+
+  // Start after the trigger that we handled first last time, so that
+  // frequently-triggered events can't starve the others:
+  u_int32_t mask = fLastUsedTriggerMask;
+  unsigned i = 0;
+  while (mask != 1 && i < EPOLL_MAX_NUM_EVENT_TRIGGERS) { mask >>= 1; ++i; }
+
+  Boolean first = True;
+  for (unsigned n = 0; n < EPOLL_MAX_NUM_EVENT_TRIGGERS; ++n) {
+    if (++i == EPOLL_MAX_NUM_EVENT_TRIGGERS) i = 0;
+    u_int32_t bit = (u_int32_t)1 << i;
+    if ((pending&bit) == 0) continue;
+
+    if (first) { fLastUsedTriggerMask = bit; first = False; }
+    TaskFunc* handler = fTriggeredEventHandlers[i];
+    if (handler != NULL) (*handler)(fTriggeredEventClientDatas[i]);
+  }
+}
@@ -0,0 +1,85 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// Basic Hash Table implementation
+// C++ header
+
+#ifndef _BASIC_HASH_TABLE_HH
+#define _BASIC_HASH_TABLE_HH
+
+#ifndef _HASH_TABLE_HH
+#include "HashTable.hh"
+#endif
+
+// An open-addressing (linear probing) hash table.  Entries - each holding its
+// precomputed hash - are kept in a single array, so that a lookup usually touches
+// just one or two cache lines.  "ONE_WORD_HASH_KEYS" keys are stored as is;
+// string (and multi-word) keys are copied.
+
+class BasicHashTable: public HashTable {
+private:
+	class TableEntry; // forward
+
+public:
+  BasicHashTable(int keyType);
+  virtual ~BasicHashTable();
+
+  // Used to iterate through the members of the table:
+  class Iterator; friend class Iterator; // to make Sun's C++ compiler happy
+  class Iterator: public HashTable::Iterator {
+  public:
+    Iterator(BasicHashTable const& table);
+
+  private: // implementation of inherited pure virtual functions
+    void* next(char const*& key); // returns 0 if none
+
+  private:
+    BasicHashTable const& fTable;
+    unsigned fNextIndex; // index of the next slot to be examined
+  };
+
+private: // implementation of inherited pure virtual functions
+  virtual void* Add(char const* key, void* value);
+  // Returns the old value if different, otherwise 0
+  virtual Boolean Remove(char const* key);
+  virtual void* Lookup(char const* key) const;
+  // Returns 0 if not found
+  virtual unsigned numEntries() const;
+
+private:
+  class TableEntry {
+  public:
+    unsigned hash; // 0 => empty slot; 1 => deleted slot; otherwise, "hashFor(key)"
+    char const* key;
+    void* value;
+  };
+
+  unsigned hashFor(char const* key) const;
+  Boolean keyMatches(char const* key1, char const* key2) const;
+  TableEntry* lookupEntry(char const* key, unsigned hash) const;
+  char const* copyKey(char const* key) const;
+  void deleteKey(char const* key) const;
+  void rebuild(unsigned newNumSlots); // rehashes each entry into a new array
+
+private:
+  TableEntry* fSlots;
+  unsigned fNumSlots; // always a power of 2
+  unsigned fNumEntries;
+  unsigned fNumDeletedSlots;
+  int fKeyType;
+};
+
+#endif
@@ -0,0 +1,123 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// Basic Usage Environment: for a simple, non-scripted, console application
+// An "epoll()"-based task scheduler (Linux only), with a binary min-heap
+// of delayed tasks.  Per-iteration cost does not depend on the number of
+// sockets being handled.
+// C++ header
+
+#ifndef _EPOLL_TASK_SCHEDULER_HH
+#define _EPOLL_TASK_SCHEDULER_HH
+
+#ifndef _USAGE_ENVIRONMENT_HH
+#include "UsageEnvironment.hh"
+#endif
+
+#define EPOLL_MAX_NUM_EVENT_TRIGGERS 32
+
+struct epoll_event; // forward
+
+class EpollTaskScheduler: public TaskScheduler {
+public:
+  static EpollTaskScheduler* createNew(Boolean edgeTriggered = False,
+				       unsigned maxEventsPerPoll = 64);
+      // If "edgeTriggered" is True, sockets are registered with EPOLLET.
+      // This saves one "epoll_wait()" wakeup per readiness change, but
+      // requires that each handler drain its socket (until EAGAIN) when called.
+      // Returns NULL if "epoll_create()" fails.
+  virtual ~EpollTaskScheduler();
+
+  void SingleStep(unsigned maxDelayTime = 0);
+      // Waits for (and handles) the next batch of ready sockets, triggered
+      // events and due delayed tasks.  "maxDelayTime" (in microseconds),
+      // if non-zero, bounds how long we block.
+
+  unsigned numHandledSockets() const { return fNumHandlers; }
+  unsigned numPendingDelayedTasks() const { return fHeapSize; }
+
+protected:
+  EpollTaskScheduler(int epollFd, int wakeupFd, Boolean edgeTriggered,
+		     unsigned maxEventsPerPoll);
+      // called only by "createNew()"
+
+private: // redefined virtual functions:
+  virtual TaskToken scheduleDelayedTask(int64_t microseconds, TaskFunc* proc,
+					void* clientData);
+  virtual void unscheduleDelayedTask(TaskToken& prevTask);
+  virtual void setBackgroundHandling(int socketNum, int conditionSet,
+				     BackgroundHandlerProc* handlerProc, void* clientData);
+  virtual void moveSocketHandling(int oldSocketNum, int newSocketNum);
+  virtual void doEventLoop(char* watchVariable);
+  virtual EventTriggerId createEventTrigger(TaskFunc* eventHandlerProc);
+  virtual void deleteEventTrigger(EventTriggerId eventTriggerId);
+  virtual void triggerEvent(EventTriggerId eventTriggerId, void* clientData = NULL);
+
+private:
+  // Socket handlers are kept in an array indexed by socket number:
+  struct SocketHandler {
+    int conditionSet; // 0 iff the slot is unused
+    BackgroundHandlerProc* handlerProc;
+    void* clientData;
+  };
+  Boolean ensureHandlerSlot(int socketNum);
+  Boolean updateEpollRegistration(int socketNum, int oldConditionSet, int newConditionSet);
+
+  // Delayed tasks are kept in a binary min-heap, ordered by due time.
+  // Each task lives in a (recycled) slot; its token encodes the slot index
+  // plus a generation count, so that stale tokens are detected in O(1):
+  struct DelayedTask {
+    int64_t dueTime; // in microseconds, on the monotonic clock
+    TaskFunc* proc;
+    void* clientData;
+    unsigned heapIndex; // ~0 iff the slot is free
+    unsigned generation;
+    unsigned nextFree;
+  };
+  unsigned allocTaskSlot();
+  void freeTaskSlot(unsigned slot);
+  void heapSwap(unsigned i, unsigned j);
+  void siftUp(unsigned i);
+  void siftDown(unsigned i);
+  void heapRemove(unsigned i);
+  void handleDueTasks();
+
+  void handleTriggeredEvents();
+
+private:
+  int fEpollFd;
+  int fWakeupFd; // an "eventfd()", written by "triggerEvent()"
+  Boolean fEdgeTriggered;
+  unsigned fMaxEventsPerPoll;
+  struct epoll_event* fReadyEvents;
+
+  SocketHandler* fHandlers;
+  unsigned fHandlersSize;
+  unsigned fNumHandlers;
+
+  DelayedTask* fTasks;
+  unsigned fTasksSize;
+  unsigned fFirstFreeTask;
+  unsigned* fHeap; // indices into "fTasks"
+  unsigned fHeapSize;
+
+  TaskFunc* fTriggeredEventHandlers[EPOLL_MAX_NUM_EVENT_TRIGGERS];
+  void* fTriggeredEventClientDatas[EPOLL_MAX_NUM_EVENT_TRIGGERS];
+  u_int32_t fEventTriggersAwaitingHandling; // modified atomically
+  u_int32_t fLastUsedTriggerMask;
+};
+
+#endif
@@ -21,6 +21,9 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "GroupsockHelper.hh"
 //##### Eventually fix the following #include; we shouldn't know about tunnels
 #include "TunnelEncaps.hh"
+#if !defined(__WIN32__) && !defined(_WIN32)
+#include <sys/uio.h>
+#endif
 
 #ifndef NO_SSTREAM
 #include <sstream>
@@ -31,12 +34,12 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 
 OutputSocket::OutputSocket(UsageEnvironment& env)
   : Socket(env, 0 /* let kernel choose port */),
-    fSourcePort(0), fLastSentTTL(0) {
+    fSourcePort(0), fLastSentTTL(0), fUseUDPGSO(False) {
 }
 
 OutputSocket::OutputSocket(UsageEnvironment& env, Port port)
   : Socket(env, port),
-    fSourcePort(0), fLastSentTTL(0) {
+    fSourcePort(0), fLastSentTTL(0), fUseUDPGSO(False) {
 }
 
 OutputSocket::~OutputSocket() {
@@ -70,6 +73,62 @@ Boolean OutputSocket::write(netAddressBits address, Port port, u_int8_t ttl,
   return True;
 }
 
+Boolean OutputSocket::writev(netAddressBits address, Port port, u_int8_t ttl,
+			     struct iovec const* iov, unsigned iovcnt) {
+  if (ttl == fLastSentTTL) {
+    // Optimization: So we don't do a 'set TTL' system call again
+    ttl = 0;
+  } else {
+    fLastSentTTL = ttl;
+  }
+  struct in_addr destAddr; destAddr.s_addr = address;
+  if (!writeSocketv(env(), socketNum(), destAddr, port, ttl, iov, iovcnt))
+    return False;
+
+  if (sourcePortNum() == 0) {
+    // Now that we've sent a packet, we can find out what the
+    // kernel chose as our ephemeral source port number:
+    if (!getSourcePort(env(), socketNum(), fSourcePort)) {
+      if (DebugLevel >= 1)
+	env() << *this
+	     << ": failed to get source port: "
+	     << env().getResultMsg() << "\n";
+      return False;
+    }
+  }
+
+  return True;
+}
+
+int OutputSocket::writeBatch(netAddressBits address, Port port, u_int8_t ttl,
+			    unsigned char* const* buffers, unsigned const* bufferSizes,
+			    unsigned numBuffers) {
+  if (ttl == fLastSentTTL) {
+    // Optimization: So we don't do a 'set TTL' system call again
+    ttl = 0;
+  } else {
+    fLastSentTTL = ttl;
+  }
+  struct in_addr destAddr; destAddr.s_addr = address;
+  int numSent = writeSocketBatch(env(), socketNum(), destAddr, port, ttl,
+				 buffers, bufferSizes, numBuffers, fUseUDPGSO);
+  if (numSent < 0) return -1;
+
+  if (sourcePortNum() == 0) {
+    // Now that we've sent a packet, we can find out what the
+    // kernel chose as our ephemeral source port number:
+    if (!getSourcePort(env(), socketNum(), fSourcePort)) {
+      if (DebugLevel >= 1)
+	env() << *this
+	     << ": failed to get source port: "
+	     << env().getResultMsg() << "\n";
+      return -1;
+    }
+  }
+
+  return numSent;
+}
+
 // By default, we don't do reads:
 Boolean OutputSocket
 ::handleRead(unsigned char* /*buffer*/, unsigned /*bufferMaxSize*/,
@@ -103,7 +162,8 @@ Groupsock::Groupsock(UsageEnvironment& env, struct in_addr const& groupAddr,
 		     Port port, u_int8_t ttl)
   : OutputSocket(env, port),
     deleteIfNoMembers(False), isSlave(False),
-    fIncomingGroupEId(groupAddr, port.num(), ttl), fDests(NULL), fTTL(ttl) {
+    fIncomingGroupEId(groupAddr, port.num(), ttl), fDests(NULL), fTTL(ttl),
+    fHaveEnabledReceptionTimestamps(False) {
   addDestination(groupAddr, port);
 
   if (!socketJoinGroup(env, socketNum(), groupAddr.s_addr)) {
@@ -131,7 +191,7 @@ Groupsock::Groupsock(UsageEnvironment& env, struct in_addr const& groupAddr,
   : OutputSocket(env, port),
     deleteIfNoMembers(False), isSlave(False),
     fIncomingGroupEId(groupAddr, sourceFilterAddr, port.num()),
-    fDests(NULL), fTTL(255) {
+    fDests(NULL), fTTL(255), fHaveEnabledReceptionTimestamps(False) {
   addDestination(groupAddr, port);
 
   // First try a SSM join.  If that fails, try a regular join:
@@ -291,6 +351,82 @@ Boolean Groupsock::output(UsageEnvironment& env, u_int8_t ttlToSend,
   return False;
 }
 
+Boolean Groupsock::outputv(UsageEnvironment& env, u_int8_t ttlToSend,
+			   struct iovec const* iov, unsigned iovcnt) {
+  unsigned totSize = 0;
+  for (unsigned i = 0; i < iovcnt; ++i) totSize += iov[i].iov_len;
+
+  if (!members().IsEmpty()) {
+    // Relaying to tunnel members needs a contiguous packet (plus trailer), so assemble one:
+    unsigned char* buffer = new unsigned char[totSize + TunnelEncapsulationTrailerMaxSize];
+    unsigned offset = 0;
+    for (unsigned i = 0; i < iovcnt; ++i) {
+      memmove(&buffer[offset], iov[i].iov_base, iov[i].iov_len);
+      offset += iov[i].iov_len;
+    }
+    Boolean result = output(env, ttlToSend, buffer, totSize);
+    delete[] buffer;
+    return result;
+  }
+
+  for (destRecord* dests = fDests; dests != NULL; dests = dests->fNext) {
+    if (!writev(dests->fGroupEId.groupAddress().s_addr, dests->fPort, ttlToSend,
+		iov, iovcnt)) {
+      if (DebugLevel >= 0) { // this is a fatal error
+	env.setResultMsg("Groupsock write failed: ", env.getResultMsg());
+      }
+      return False;
+    }
+  }
+  statsOutgoing.countPacket(totSize);
+  statsGroupOutgoing.countPacket(totSize);
+
+  if (DebugLevel >= 3) {
+    env << *this << ": wrote " << totSize << " bytes (gathered), ttl "
+	<< (unsigned)ttlToSend << "\n";
+  }
+  return True;
+}
+
+Boolean Groupsock::outputBatch(UsageEnvironment& env, u_int8_t ttlToSend,
+			       unsigned char* const* buffers, unsigned const* bufferSizes,
+			       unsigned numBuffers) {
+  if (!members().IsEmpty()) {
+    // Relaying to tunnel members needs a per-packet trailer, so don't batch:
+    for (unsigned i = 0; i < numBuffers; ++i) {
+      if (!output(env, ttlToSend, buffers[i], bufferSizes[i])) return False;
+    }
+    return True;
+  }
+
+  do {
+    Boolean writeSuccess = True;
+    for (destRecord* dests = fDests; dests != NULL; dests = dests->fNext) {
+      if (writeBatch(dests->fGroupEId.groupAddress().s_addr, dests->fPort, ttlToSend,
+		     buffers, bufferSizes, numBuffers) != (int)numBuffers) {
+	writeSuccess = False;
+	break;
+      }
+    }
+    if (!writeSuccess) break;
+    for (unsigned i = 0; i < numBuffers; ++i) {
+      statsOutgoing.countPacket(bufferSizes[i]);
+      statsGroupOutgoing.countPacket(bufferSizes[i]);
+    }
+
+    if (DebugLevel >= 3) {
+      env << *this << ": wrote a batch of " << numBuffers << " packets, ttl "
+	  << (unsigned)ttlToSend << "\n";
+    }
+    return True;
+  } while (0);
+
+  if (DebugLevel >= 0) { // this is a fatal error
+    env.setResultMsg("Groupsock write failed: ", env.getResultMsg());
+  }
+  return False;
+}
+
 Boolean Groupsock::handleRead(unsigned char* buffer, unsigned bufferMaxSize,
 			      unsigned& bytesRead,
 			      struct sockaddr_in& fromAddress) {
@@ -310,16 +446,54 @@ Boolean Groupsock::handleRead(unsigned char* buffer, unsigned bufferMaxSize,
     return False;
   }
 
+  bytesRead = handleIncomingData(buffer, numBytes, fromAddress);
+  return True;
+}
+
+int Groupsock::handleReadBatch(unsigned char* const* buffers, unsigned const* bufferMaxSizes,
+			       unsigned numBuffers, unsigned* bytesRead,
+			       struct sockaddr_in* fromAddresses,
+			       struct timeval* receptionTimes) {
+  if (!fHaveEnabledReceptionTimestamps) {
+    enableReceptionTimestamps(env(), socketNum());
+    fHaveEnabledReceptionTimestamps = True; // whether or not this succeeded
+  }
+
+  // Leave room (in each buffer) for a tunnel encapsulation trailer, as in "handleRead()":
+  unsigned maxBytesToRead[MAX_DATAGRAMS_PER_READ_BATCH];
+  if (numBuffers > MAX_DATAGRAMS_PER_READ_BATCH) numBuffers = MAX_DATAGRAMS_PER_READ_BATCH;
+  for (unsigned i = 0; i < numBuffers; ++i) {
+    maxBytesToRead[i] = bufferMaxSizes[i] - TunnelEncapsulationTrailerMaxSize;
+  }
+
+  int numRead = readSocketBatch(env(), socketNum(), buffers, maxBytesToRead, numBuffers,
+				bytesRead, fromAddresses, receptionTimes);
+  if (numRead < 0) {
+    if (DebugLevel >= 0) { // this is a fatal error
+      env().setResultMsg("Groupsock read failed: ",
+			 env().getResultMsg());
+    }
+    return -1;
+  }
+
+  for (int i = 0; i < numRead; ++i) {
+    bytesRead[i] = handleIncomingData(buffers[i], bytesRead[i], fromAddresses[i]);
+  }
+  return numRead;
+}
+
+unsigned Groupsock::handleIncomingData(unsigned char* buffer, unsigned numBytes,
+				       struct sockaddr_in& fromAddress) {
   // If we're a SSM group, make sure the source address matches:
   if (isSSM()
       && fromAddress.sin_addr.s_addr != sourceFilterAddress().s_addr) {
-    return True;
+    return 0;
   }
 
   // We'll handle this data.
   // Also write it (with the encapsulation trailer) to each member,
   // unless the packet was originally sent by us to begin with.
-  bytesRead = numBytes;
+  unsigned bytesRead = numBytes;
 
   int numMembers = 0;
   if (!wasLoopedBackFromUs(env(), fromAddress)) {
@@ -343,7 +517,7 @@ Boolean Groupsock::handleRead(unsigned char* buffer, unsigned bufferMaxSize,
     env() << "\n";
   }
 
-  return True;
+  return bytesRead;
 }
 
 Boolean Groupsock::wasLoopedBackFromUs(UsageEnvironment& env,
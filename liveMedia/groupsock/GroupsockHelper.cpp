@@ -155,7 +155,7 @@ Boolean makeSocketBlocking(int sock) {
 }
 
 int setupStreamSocket(UsageEnvironment& env,
-                      Port port, Boolean makeNonBlocking) {
+                      Port port, Boolean makeNonBlocking, Boolean reusePort) {
   if (!initializeWinsockIfNecessary()) {
     socketErr(env, "Failed to initialize 'winsock': ");
     return -1;
@@ -192,6 +192,22 @@ int setupStreamSocket(UsageEnvironment& env,
 #endif
 #endif
 
+  if (reusePort) {
+#if defined(SO_REUSEPORT) && !defined(__WIN32__) && !defined(_WIN32)
+    int const reusePortFlag = 1;
+    if (setsockopt(newSocket, SOL_SOCKET, SO_REUSEPORT,
+		   (const char*)&reusePortFlag, sizeof reusePortFlag) < 0) {
+      socketErr(env, "setsockopt(SO_REUSEPORT) error: ");
+      closeSocket(newSocket);
+      return -1;
+    }
+#else
+    env.setResultMsg("SO_REUSEPORT is not supported on this platform");
+    closeSocket(newSocket);
+    return -1;
+#endif
+  }
+
   // Note: Windoze requires binding, even if the port number is 0
 #if defined(__WIN32__) || defined(_WIN32)
 #else
@@ -291,6 +307,310 @@ Boolean writeSocket(UsageEnvironment& env,
 	return False;
 }
 
+#if defined(__linux__) && !defined(__WIN32__) && !defined(_WIN32)
+#include <sys/syscall.h>
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103 // from <linux/udp.h> (Linux 4.18 and later)
+#endif
+#if defined(__NR_sendmmsg) || defined(__NR_recvmmsg)
+// Not all of our C libraries declare "sendmmsg()" or "recvmmsg()", so we call them directly:
+struct our_mmsghdr {
+  struct msghdr msg_hdr;
+  unsigned msg_len;
+};
+#endif
+#ifdef __NR_sendmmsg
+#define HAVE_SENDMMSG 1
+#endif
+#ifdef __NR_recvmmsg
+#define HAVE_RECVMMSG 1
+#endif
+#define MAX_DATAGRAMS_PER_SEND_CALL 64
+#define MAX_DATAGRAMS_PER_RECEIVE_CALL 64
+#ifndef SO_TIMESTAMPNS
+#define SO_TIMESTAMPNS 35 // from <asm/socket.h>
+#endif
+#ifndef SCM_TIMESTAMPNS
+#define SCM_TIMESTAMPNS SO_TIMESTAMPNS
+#endif
+#endif
+
+#if !defined(__WIN32__) && !defined(_WIN32)
+#include <sys/uio.h>
+#endif
+
+Boolean writeSocketv(UsageEnvironment& env,
+		     int socket, struct in_addr address, Port port,
+		     u_int8_t ttlArg,
+		     struct iovec const* iov, unsigned iovcnt) {
+#if defined(__linux__) && !defined(__WIN32__) && !defined(_WIN32)
+  if (ttlArg != 0) {
+    // Before sending, set the socket's TTL:
+    u_int8_t ttl = ttlArg;
+    if (setsockopt(socket, IPPROTO_IP, IP_MULTICAST_TTL,
+		   (const char*)&ttl, sizeof ttl) < 0) {
+      socketErr(env, "setsockopt(IP_MULTICAST_TTL) error: ");
+      return False;
+    }
+  }
+
+  MAKE_SOCKADDR_IN(dest, address.s_addr, port.num());
+  struct msghdr msg;
+  memset(&msg, 0, sizeof msg);
+  msg.msg_name = &dest;
+  msg.msg_namelen = sizeof dest;
+  msg.msg_iov = (struct iovec*)iov;
+  msg.msg_iovlen = iovcnt;
+
+  unsigned totSize = 0;
+  for (unsigned i = 0; i < iovcnt; ++i) totSize += iov[i].iov_len;
+  int bytesSent = sendmsg(socket, &msg, 0);
+  if (bytesSent != (int)totSize) {
+    char tmpBuf[100];
+    sprintf(tmpBuf, "writeSocketv(%d), sendmsg() error: wrote %d bytes instead of %u: ", socket, bytesSent, totSize);
+    socketErr(env, tmpBuf);
+    return False;
+  }
+  return True;
+#else
+  // Assemble the datagram, then send it normally:
+  unsigned totSize = 0;
+  for (unsigned i = 0; i < iovcnt; ++i) totSize += iov[i].iov_len;
+  unsigned char* buffer = new unsigned char[totSize];
+  unsigned offset = 0;
+  for (unsigned i = 0; i < iovcnt; ++i) {
+    memmove(&buffer[offset], iov[i].iov_base, iov[i].iov_len);
+    offset += iov[i].iov_len;
+  }
+  Boolean result = writeSocket(env, socket, address, port, ttlArg, buffer, totSize);
+  delete[] buffer;
+  return result;
+#endif
+}
+
+int writeSocketBatch(UsageEnvironment& env,
+		     int socket, struct in_addr address, Port port,
+		     u_int8_t ttlArg,
+		     unsigned char* const* buffers, unsigned const* bufferSizes,
+		     unsigned numBuffers, Boolean& useUDPGSO) {
+  if (numBuffers == 0) return 0;
+  if (numBuffers == 1) {
+    // No point in batching:
+    return writeSocket(env, socket, address, port, ttlArg, buffers[0], bufferSizes[0]) ? 1 : -1;
+  }
+
+#if defined(__linux__) && !defined(__WIN32__) && !defined(_WIN32)
+  if (ttlArg != 0) {
+    // Before sending, set the socket's TTL:
+    u_int8_t ttl = ttlArg;
+    if (setsockopt(socket, IPPROTO_IP, IP_MULTICAST_TTL,
+		   (const char*)&ttl, sizeof ttl) < 0) {
+      socketErr(env, "setsockopt(IP_MULTICAST_TTL) error: ");
+      return -1;
+    }
+  }
+  MAKE_SOCKADDR_IN(dest, address.s_addr, port.num());
+
+  unsigned numSent = 0;
+  while (numSent < numBuffers) {
+    unsigned numThisCall = numBuffers - numSent;
+    if (numThisCall > MAX_DATAGRAMS_PER_SEND_CALL) numThisCall = MAX_DATAGRAMS_PER_SEND_CALL;
+
+    struct iovec iov[MAX_DATAGRAMS_PER_SEND_CALL];
+    for (unsigned i = 0; i < numThisCall; ++i) {
+      iov[i].iov_base = buffers[numSent+i];
+      iov[i].iov_len = bufferSizes[numSent+i];
+    }
+
+    if (useUDPGSO) {
+      // GSO needs every datagram (except perhaps the last, which may be shorter)
+      // to have the same size.  Send the longest such run as one "sendmsg()":
+      unsigned segmentSize = bufferSizes[numSent];
+      unsigned numSegments = 1;
+      while (numSegments < numThisCall && bufferSizes[numSent+numSegments] == segmentSize) ++numSegments;
+      if (numSegments < numThisCall && bufferSizes[numSent+numSegments] < segmentSize) ++numSegments;
+
+      if (numSegments > 1) {
+	union {
+	  char buf[CMSG_SPACE(sizeof (u_int16_t))];
+	  struct cmsghdr align;
+	} control;
+	struct msghdr msg;
+	memset(&msg, 0, sizeof msg);
+	msg.msg_name = &dest;
+	msg.msg_namelen = sizeof dest;
+	msg.msg_iov = iov;
+	msg.msg_iovlen = numSegments;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof control.buf;
+	struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+	cm->cmsg_level = SOL_UDP;
+	cm->cmsg_type = UDP_SEGMENT;
+	cm->cmsg_len = CMSG_LEN(sizeof (u_int16_t));
+	*(u_int16_t*)CMSG_DATA(cm) = (u_int16_t)segmentSize;
+
+	if (sendmsg(socket, &msg, 0) >= 0) {
+	  numSent += numSegments;
+	  continue;
+	}
+	if (errno != EINVAL && errno != ENOPROTOOPT && errno != EIO) break;
+	useUDPGSO = False; // not supported by this kernel (or NIC); don't try again
+      }
+    }
+
+#ifdef HAVE_SENDMMSG
+    struct our_mmsghdr msgs[MAX_DATAGRAMS_PER_SEND_CALL];
+    memset(msgs, 0, numThisCall*sizeof msgs[0]);
+    for (unsigned i = 0; i < numThisCall; ++i) {
+      msgs[i].msg_hdr.msg_name = &dest;
+      msgs[i].msg_hdr.msg_namelen = sizeof dest;
+      msgs[i].msg_hdr.msg_iov = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int result = syscall(__NR_sendmmsg, socket, msgs, numThisCall, 0);
+    if (result > 0) {
+      numSent += result;
+      continue;
+    }
+    if (result < 0 && errno != ENOSYS) break;
+    // Otherwise, the kernel doesn't have "sendmmsg()"; fall through:
+#endif
+    if (!writeSocket(env, socket, address, port, 0, buffers[numSent], bufferSizes[numSent])) break;
+    ++numSent;
+  }
+
+  if (numSent < numBuffers) {
+    char tmpBuf[100];
+    sprintf(tmpBuf, "writeSocketBatch(%d): sent %u datagrams instead of %u: ", socket, numSent, numBuffers);
+    socketErr(env, tmpBuf);
+  }
+  return numSent == 0 ? -1 : (int)numSent;
+#else
+  useUDPGSO = False;
+  unsigned numSent = 0;
+  for (; numSent < numBuffers; ++numSent) {
+    if (!writeSocket(env, socket, address, port, numSent == 0 ? ttlArg : 0,
+		     buffers[numSent], bufferSizes[numSent])) break;
+  }
+  return numSent == 0 ? -1 : (int)numSent;
+#endif
+}
+
+Boolean enableReceptionTimestamps(UsageEnvironment& env, int socket) {
+#if defined(__linux__) && !defined(__WIN32__) && !defined(_WIN32)
+  int enable = 1;
+  if (setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPNS,
+		 (const char*)&enable, sizeof enable) < 0) {
+    socketErr(env, "setsockopt(SO_TIMESTAMPNS) error: ");
+    return False;
+  }
+  return True;
+#else
+  return False;
+#endif
+}
+
+#if defined(__linux__) && !defined(SO_MAX_PACING_RATE)
+#define SO_MAX_PACING_RATE 47
+#endif
+
+Boolean setSocketMaxPacingRate(UsageEnvironment& env, int socket, unsigned bytesPerSecond) {
+#if defined(__linux__) && !defined(__WIN32__) && !defined(_WIN32)
+  if (setsockopt(socket, SOL_SOCKET, SO_MAX_PACING_RATE,
+		 (const char*)&bytesPerSecond, sizeof bytesPerSecond) < 0) {
+    socketErr(env, "setsockopt(SO_MAX_PACING_RATE) error: ");
+    return False;
+  }
+  return True;
+#else
+  return False;
+#endif
+}
+
+int readSocketBatch(UsageEnvironment& env,
+		    int socket, unsigned char* const* buffers, unsigned const* bufferSizes,
+		    unsigned numBuffers, unsigned* bytesRead,
+		    struct sockaddr_in* fromAddresses, struct timeval* receptionTimes) {
+  if (numBuffers == 0) return 0;
+
+#ifdef HAVE_RECVMMSG
+  if (numBuffers > 1) {
+    if (numBuffers > MAX_DATAGRAMS_PER_RECEIVE_CALL) numBuffers = MAX_DATAGRAMS_PER_RECEIVE_CALL;
+
+    struct iovec iov[MAX_DATAGRAMS_PER_RECEIVE_CALL];
+    struct our_mmsghdr msgs[MAX_DATAGRAMS_PER_RECEIVE_CALL];
+    union {
+      char buf[CMSG_SPACE(sizeof (struct timespec))];
+      struct cmsghdr align;
+    } control[MAX_DATAGRAMS_PER_RECEIVE_CALL];
+    memset(msgs, 0, numBuffers*sizeof msgs[0]);
+    for (unsigned i = 0; i < numBuffers; ++i) {
+      iov[i].iov_base = buffers[i];
+      iov[i].iov_len = bufferSizes[i];
+      msgs[i].msg_hdr.msg_name = &fromAddresses[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof fromAddresses[i];
+      msgs[i].msg_hdr.msg_iov = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      msgs[i].msg_hdr.msg_control = control[i].buf;
+      msgs[i].msg_hdr.msg_controllen = sizeof control[i].buf;
+    }
+
+    int result = syscall(__NR_recvmmsg, socket, msgs, numBuffers, MSG_DONTWAIT, NULL);
+    if (result >= 0 || errno != ENOSYS) {
+      if (result < 0) {
+	int err = env.getErrno();
+	if (err == EAGAIN || err == 111 /*ECONNREFUSED (Linux)*/ || err == 113 /*EHOSTUNREACH (Linux)*/) {
+	  return 0; // as in "readSocket()"
+	}
+	socketErr(env, "recvmmsg() error: ");
+	return -1;
+      }
+
+      struct timeval timeNow;
+      Boolean haveTimeNow = False;
+      for (int i = 0; i < result; ++i) {
+	bytesRead[i] = msgs[i].msg_len;
+
+	// Use the kernel's reception timestamp, if there is one; otherwise, the current time:
+	Boolean haveTimestamp = False;
+	for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cm != NULL;
+	     cm = CMSG_NXTHDR(&msgs[i].msg_hdr, cm)) {
+	  if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPNS) {
+	    struct timespec ts;
+	    memmove(&ts, CMSG_DATA(cm), sizeof ts);
+	    receptionTimes[i].tv_sec = ts.tv_sec;
+	    receptionTimes[i].tv_usec = ts.tv_nsec/1000;
+	    haveTimestamp = True;
+	    break;
+	  }
+	}
+	if (!haveTimestamp) {
+	  if (!haveTimeNow) {
+	    gettimeofday(&timeNow, NULL);
+	    haveTimeNow = True;
+	  }
+	  receptionTimes[i] = timeNow;
+	}
+      }
+      return result;
+    }
+    // Otherwise, the kernel doesn't have "recvmmsg()"; fall through:
+  }
+#endif
+
+  // Read just one datagram:
+  int numBytes = readSocket(env, socket, buffers[0], bufferSizes[0], fromAddresses[0]);
+  if (numBytes < 0) return -1;
+  if (numBytes == 0 && fromAddresses[0].sin_addr.s_addr == 0) return 0; // nothing was waiting
+
+  bytesRead[0] = numBytes;
+  gettimeofday(&receptionTimes[0], NULL);
+  return 1;
+}
+
 static unsigned getBufferSize(UsageEnvironment& env, int bufOptName,
 			      int socket) {
   unsigned curSize;
@@ -36,6 +36,8 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 // An "OutputSocket" is (by default) used only to send packets.
 // No packets are received on it (unless a subclass arranges this)
 
+struct iovec; // forward
+
 class OutputSocket: public Socket {
 public:
   OutputSocket(UsageEnvironment& env);
@@ -43,6 +45,16 @@ public:
 
   Boolean write(netAddressBits address, Port port, u_int8_t ttl,
 		unsigned char* buffer, unsigned bufferSize);
+  Boolean writev(netAddressBits address, Port port, u_int8_t ttl,
+		 struct iovec const* iov, unsigned iovcnt);
+  int writeBatch(netAddressBits address, Port port, u_int8_t ttl,
+		 unsigned char* const* buffers, unsigned const* bufferSizes,
+		 unsigned numBuffers);
+      // returns the number of datagrams sent, or -1 on failure
+
+  void setUseUDPGSO(Boolean useUDPGSO) { fUseUDPGSO = useUDPGSO; }
+  Boolean useUDPGSO() const { return fUseUDPGSO; }
+      // try UDP segmentation offload in "writeBatch()" (by default: False)
 
 protected:
   OutputSocket(UsageEnvironment& env, Port port);
@@ -57,6 +69,7 @@ private: // redefined virtual function
 private:
   Port fSourcePort;
   u_int8_t fLastSentTTL;
+  Boolean fUseUDPGSO;
 };
 
 class destRecord {
@@ -71,6 +84,8 @@ public:
   Port fPort;
 };
 
+#define MAX_DATAGRAMS_PER_READ_BATCH 64 // see "Groupsock::handleReadBatch()"
+
 // A "Groupsock" is used to both send and receive packets.
 // As the name suggests, it was originally designed to send/receive
 // multicast, but it can send/receive unicast as well.
@@ -119,6 +134,16 @@ public:
   Boolean output(UsageEnvironment& env, u_int8_t ttl,
 		 unsigned char* buffer, unsigned bufferSize,
 		 DirectedNetInterface* interfaceNotToFwdBackTo = NULL);
+  Boolean outputv(UsageEnvironment& env, u_int8_t ttl,
+		  struct iovec const* iov, unsigned iovcnt);
+      // Like "output()", except that the packet is gathered from "iov" (so that
+      // e.g. a header and a payload needn't be copied into one buffer first)
+  Boolean outputBatch(UsageEnvironment& env, u_int8_t ttl,
+		      unsigned char* const* buffers, unsigned const* bufferSizes,
+		      unsigned numBuffers);
+      // Like calling "output()" once per buffer, but sends to each destination
+      // using as few system calls as possible.  (Note that each buffer must - as
+      // with "output()" - have room for a tunnel encapsulation trailer.)
 
   DirectedNetInterfaceSet& members() { return fMembers; }
 
@@ -142,7 +167,22 @@ public: // redefined virtual functions
 			     unsigned& bytesRead,
 			     struct sockaddr_in& fromAddress);
 
+public:
+  int handleReadBatch(unsigned char* const* buffers, unsigned const* bufferMaxSizes,
+		      unsigned numBuffers, unsigned* bytesRead,
+		      struct sockaddr_in* fromAddresses,
+		      struct timeval* receptionTimes);
+      // Like "handleRead()" - but reads (without blocking) up to "numBuffers"
+      // (<= MAX_DATAGRAMS_PER_READ_BATCH) waiting datagrams at once, along with
+      // the (kernel, if possible) time at which each was received.  Datagrams that
+      // we don't handle (e.g., from the wrong SSM source) get a "bytesRead" of 0.
+      // Returns the number of datagrams read, or -1 on failure.
+
 private:
+  unsigned handleIncomingData(unsigned char* buffer, unsigned numBytes,
+			      struct sockaddr_in& fromAddress);
+      // filters, counts, and relays newly-read data; returns the # of bytes to handle
+
   int outputToAllMembersExcept(DirectedNetInterface* exceptInterface,
 			       u_int8_t ttlToFwd,
 			       unsigned char* data, unsigned size,
@@ -153,6 +193,7 @@ private:
   destRecord* fDests;
   u_int8_t fTTL;
   DirectedNetInterfaceSet fMembers;
+  Boolean fHaveEnabledReceptionTimestamps;
 };
 
 UsageEnvironment& operator<<(UsageEnvironment& s, const Groupsock& g);
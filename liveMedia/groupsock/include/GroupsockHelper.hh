@@ -27,7 +27,10 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 
 int setupDatagramSocket(UsageEnvironment& env, Port port);
 int setupStreamSocket(UsageEnvironment& env,
-		      Port port, Boolean makeNonBlocking = True);
+		      Port port, Boolean makeNonBlocking = True,
+		      Boolean reusePort = False);
+    // If "reusePort" is True, the socket is given "SO_REUSEPORT" (before binding),
+    // so that several (listening) sockets - e.g., one per thread - can share "port".
 
 int readSocket(UsageEnvironment& env,
 	       int socket, unsigned char* buffer, unsigned bufferSize,
@@ -38,6 +41,44 @@ Boolean writeSocket(UsageEnvironment& env,
 		    u_int8_t ttlArg,
 		    unsigned char* buffer, unsigned bufferSize);
 
+struct iovec; // forward
+Boolean writeSocketv(UsageEnvironment& env,
+		     int socket, struct in_addr address, Port port,
+		     u_int8_t ttlArg,
+		     struct iovec const* iov, unsigned iovcnt);
+    // Like "writeSocket()", except that the datagram is gathered from "iov"
+
+int writeSocketBatch(UsageEnvironment& env,
+		     int socket, struct in_addr address, Port port,
+		     u_int8_t ttlArg,
+		     unsigned char* const* buffers, unsigned const* bufferSizes,
+		     unsigned numBuffers, Boolean& useUDPGSO);
+    // Sends each of "buffers" as a separate datagram, using as few system calls as
+    // possible ("sendmmsg()" where available; otherwise one "sendto()" per datagram).
+    // If "useUDPGSO" is True, and the datagrams allow it, UDP segmentation offload
+    // is tried first; "useUDPGSO" is set to False if the kernel does not support it.
+    // Returns the number of datagrams sent, or -1 if none could be sent.
+
+int readSocketBatch(UsageEnvironment& env,
+		    int socket, unsigned char* const* buffers, unsigned const* bufferSizes,
+		    unsigned numBuffers, unsigned* bytesRead,
+		    struct sockaddr_in* fromAddresses, struct timeval* receptionTimes);
+    // Reads (without blocking) up to "numBuffers" waiting datagrams - one into each of
+    // "buffers" - using as few system calls as possible ("recvmmsg()" where available;
+    // otherwise, just one datagram is read).  "receptionTimes[i]" is the kernel's
+    // reception timestamp (if "enableReceptionTimestamps()" was called on the socket),
+    // or else the current time.
+    // Returns the number of datagrams read (0 if none were waiting), or -1 on error.
+
+Boolean enableReceptionTimestamps(UsageEnvironment& env, int socket);
+    // Asks the kernel to timestamp each datagram received on "socket" ("SO_TIMESTAMPNS").
+    // Returns False if this isn't supported.
+
+Boolean setSocketMaxPacingRate(UsageEnvironment& env, int socket, unsigned bytesPerSecond);
+    // Asks the kernel to pace output from "socket" at (no more than) "bytesPerSecond"
+    // ("SO_MAX_PACING_RATE"; this needs the "fq" queueing discipline on the outgoing interface).
+    // Returns False if this isn't supported.
+
 unsigned getSendBufferSize(UsageEnvironment& env, int socket);
 unsigned getReceiveBufferSize(UsageEnvironment& env, int socket);
 unsigned setSendBufferTo(UsageEnvironment& env,
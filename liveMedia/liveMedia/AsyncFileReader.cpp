@@ -0,0 +1,263 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A 'read-ahead' input file: A separate thread reads the file sequentially into
+// large (page-aligned) buffers, ahead of our need for the data, so that a slow
+// disk doesn't stall our event loop.
+// Implementation
+
+#include "AsyncFileReader.hh"
+#include "InputFile.hh" // for "TellFile64()" and "SeekFile64()"
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(__WIN32__) || defined(_WIN32)
+#define USE_SYNCHRONOUS_READS 1 // we don't use threads on Windows
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#endif
+
+#define BUFFER_ALIGNMENT 4096
+
+////////// AsyncFileReaderThread //////////
+
+class AsyncFileReaderThread {
+public:
+#ifndef USE_SYNCHRONOUS_READS
+  pthread_mutex_t fLock;
+  pthread_cond_t fCondition; // signalled whenever a buffer becomes free, or we seek or stop
+  pthread_t fThread;
+
+  static void* threadMain(void* reader) {
+    ((AsyncFileReader*)reader)->readerThreadMain();
+    return NULL;
+  }
+#endif
+};
+
+////////// AsyncFileReader //////////
+
+AsyncFileReader::AsyncFileReader(UsageEnvironment& env, FILE* fid,
+				 unsigned bufferSize, unsigned numBuffers)
+  : fEnv(env), fFid(fid), fFileDescriptor(-1),
+    fBufferSize(bufferSize < BUFFER_ALIGNMENT ? BUFFER_ALIGNMENT : bufferSize),
+    fNumBuffers(numBuffers < 2 ? 2 : numBuffers), fBuffers(NULL), fBufferBytes(NULL),
+    fReadIndex(0), fReadOffset(0), fDataHandler(NULL), fDataHandlerClientData(NULL),
+    fDataAvailableTrigger(0),
+    fThreadIsRunning(False), fThread(NULL), fFillIndex(0), fNumFullBuffers(0),
+    fSeekGeneration(0), fReachedEnd(False), fConsumerIsWaiting(False), fStopping(False) {
+  fPosition = TellFile64(fFid);
+  if (fPosition < 0) fPosition = 0;
+  fFillPosition = fPosition;
+
+#ifndef USE_SYNCHRONOUS_READS
+  fFileDescriptor = fileno(fFid);
+#ifdef POSIX_FADV_SEQUENTIAL
+  // Have the kernel's own read-ahead (for the data beyond our buffers) be as large as possible:
+  posix_fadvise(fFileDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+  fDataAvailableTrigger = fEnv.taskScheduler().createEventTrigger(dataAvailableHandler);
+  if (fDataAvailableTrigger == 0) return; // no event triggers are free, so we'll read synchronously
+
+  fBuffers = new unsigned char*[fNumBuffers];
+  fBufferBytes = new unsigned[fNumBuffers];
+  for (unsigned i = 0; i < fNumBuffers; ++i) {
+    void* buffer;
+    fBuffers[i] = posix_memalign(&buffer, BUFFER_ALIGNMENT, fBufferSize) == 0
+      ? (unsigned char*)buffer : (unsigned char*)malloc(fBufferSize);
+    fBufferBytes[i] = 0;
+  }
+
+  fThread = new AsyncFileReaderThread;
+  if (pthread_mutex_init(&fThread->fLock, NULL) == 0) {
+    if (pthread_cond_init(&fThread->fCondition, NULL) == 0) {
+      if (pthread_create(&fThread->fThread, NULL, AsyncFileReaderThread::threadMain, this) == 0) {
+	fThreadIsRunning = True;
+      } else {
+	pthread_cond_destroy(&fThread->fCondition);
+	pthread_mutex_destroy(&fThread->fLock);
+      }
+    } else {
+      pthread_mutex_destroy(&fThread->fLock);
+    }
+  }
+  if (!fThreadIsRunning) {
+    // We'll read synchronously instead:
+    delete fThread; fThread = NULL;
+    for (unsigned i = 0; i < fNumBuffers; ++i) free(fBuffers[i]);
+    delete[] fBuffers; fBuffers = NULL;
+    delete[] fBufferBytes; fBufferBytes = NULL;
+    fEnv.taskScheduler().deleteEventTrigger(fDataAvailableTrigger);
+    fDataAvailableTrigger = 0;
+  }
+#endif
+  if (!fThreadIsRunning) SeekFile64(fFid, fPosition, SEEK_SET);
+}
+
+AsyncFileReader::~AsyncFileReader() {
+#ifndef USE_SYNCHRONOUS_READS
+  if (fThreadIsRunning) {
+    pthread_mutex_lock(&fThread->fLock);
+    fStopping = True;
+    pthread_cond_broadcast(&fThread->fCondition);
+    pthread_mutex_unlock(&fThread->fLock);
+    pthread_join(fThread->fThread, NULL);
+
+    pthread_cond_destroy(&fThread->fCondition);
+    pthread_mutex_destroy(&fThread->fLock);
+    delete fThread;
+
+    // (This also discards any pending call to "dataAvailableHandler()".)
+    fEnv.taskScheduler().deleteEventTrigger(fDataAvailableTrigger);
+
+    for (unsigned i = 0; i < fNumBuffers; ++i) free(fBuffers[i]);
+    delete[] fBuffers;
+    delete[] fBufferBytes;
+  }
+#endif
+}
+
+void AsyncFileReader::setDataHandler(TaskFunc* handler, void* clientData) {
+  fDataHandler = handler;
+  fDataHandlerClientData = clientData;
+}
+
+int AsyncFileReader::read(unsigned char* to, unsigned maxSize) {
+  if (!fThreadIsRunning) return readSynchronously(to, maxSize);
+
+#ifndef USE_SYNCHRONOUS_READS
+  pthread_mutex_lock(&fThread->fLock);
+  if (fNumFullBuffers == 0) {
+    int result;
+    if (fReachedEnd) {
+      result = -1;
+    } else {
+      fConsumerIsWaiting = True; // our reading thread will trigger an event when there's data
+      result = 0;
+    }
+    pthread_mutex_unlock(&fThread->fLock);
+    return result;
+  }
+  pthread_mutex_unlock(&fThread->fLock);
+
+  // Our reading thread doesn't touch full buffers, so we can copy from this one unlocked:
+  unsigned const bufferBytes = fBufferBytes[fReadIndex];
+  unsigned numBytes = bufferBytes - fReadOffset;
+  if (numBytes > maxSize) numBytes = maxSize;
+  memmove(to, &fBuffers[fReadIndex][fReadOffset], numBytes);
+  fReadOffset += numBytes;
+  fPosition += numBytes;
+
+  if (fReadOffset == bufferBytes) {
+    // We've used up this buffer, so give it back to our reading thread:
+    pthread_mutex_lock(&fThread->fLock);
+    fReadIndex = (fReadIndex+1)%fNumBuffers;
+    fReadOffset = 0;
+    --fNumFullBuffers;
+    pthread_cond_broadcast(&fThread->fCondition);
+    pthread_mutex_unlock(&fThread->fLock);
+  }
+
+  return (int)numBytes;
+#else
+  return -1; // not reached
+#endif
+}
+
+void AsyncFileReader::seek(int64_t filePosn) {
+  if (filePosn < 0) filePosn = 0;
+  fPosition = filePosn;
+
+  if (!fThreadIsRunning) {
+    SeekFile64(fFid, filePosn, SEEK_SET);
+    return;
+  }
+
+#ifndef USE_SYNCHRONOUS_READS
+  pthread_mutex_lock(&fThread->fLock);
+  ++fSeekGeneration; // so that any read already in progress gets ignored
+  fNumFullBuffers = 0;
+  fFillIndex = fReadIndex;
+  fReadOffset = 0;
+  fFillPosition = filePosn;
+  fReachedEnd = False;
+  pthread_cond_broadcast(&fThread->fCondition);
+  pthread_mutex_unlock(&fThread->fLock);
+#endif
+}
+
+void AsyncFileReader::dataAvailableHandler(void* clientData) {
+  AsyncFileReader* reader = (AsyncFileReader*)clientData;
+  if (reader->fDataHandler != NULL) (*reader->fDataHandler)(reader->fDataHandlerClientData);
+}
+
+int AsyncFileReader::readSynchronously(unsigned char* to, unsigned maxSize) {
+  unsigned numBytes = fread(to, 1, maxSize, fFid);
+  if (numBytes == 0) return -1;
+
+  fPosition += numBytes;
+  return (int)numBytes;
+}
+
+void AsyncFileReader::readerThreadMain() {
+#ifndef USE_SYNCHRONOUS_READS
+  pthread_mutex_lock(&fThread->fLock);
+  while (1) {
+    while (!fStopping && (fReachedEnd || fNumFullBuffers == fNumBuffers)) {
+      pthread_cond_wait(&fThread->fCondition, &fThread->fLock);
+    }
+    if (fStopping) break;
+
+    unsigned const fillIndex = fFillIndex;
+    int64_t const fillPosition = fFillPosition;
+    unsigned const seekGeneration = fSeekGeneration;
+    pthread_mutex_unlock(&fThread->fLock);
+
+#ifdef POSIX_FADV_WILLNEED
+    // Also ask the kernel to start reading the data that we'll want next:
+    posix_fadvise(fFileDescriptor, (off_t)(fillPosition + fBufferSize), fBufferSize,
+		  POSIX_FADV_WILLNEED);
+#endif
+    ssize_t numRead;
+    do {
+      numRead = pread(fFileDescriptor, fBuffers[fillIndex], fBufferSize, (off_t)fillPosition);
+    } while (numRead < 0 && errno == EINTR);
+
+    pthread_mutex_lock(&fThread->fLock);
+    if (seekGeneration != fSeekGeneration) continue; // we've seeked since; discard this data
+
+    if (numRead <= 0) {
+      fReachedEnd = True; // end of file, or error
+    } else {
+      fBufferBytes[fillIndex] = (unsigned)numRead;
+      fFillIndex = (fillIndex+1)%fNumBuffers;
+      ++fNumFullBuffers;
+      fFillPosition += numRead;
+    }
+
+    if (fConsumerIsWaiting) {
+      fConsumerIsWaiting = False;
+      fEnv.taskScheduler().triggerEvent(fDataAvailableTrigger, this);
+    }
+  }
+  pthread_mutex_unlock(&fThread->fLock);
+#endif
+}
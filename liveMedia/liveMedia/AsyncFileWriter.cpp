@@ -0,0 +1,383 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A 'write-behind' output file: Data is collected in large (page-aligned)
+// buffers, each of which - once full - is written to the file by a separate
+// thread, so that a slow disk doesn't stall our event loop.
+// Implementation
+
+#include "AsyncFileWriter.hh"
+#include "InputFile.hh" // for "TellFile64()" and "SeekFile64()"
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(__WIN32__) || defined(_WIN32)
+#define USE_SYNCHRONOUS_WRITES 1 // we don't use threads on Windows
+#else
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#endif
+
+#define BUFFER_ALIGNMENT 4096
+
+#ifndef USE_SYNCHRONOUS_WRITES
+static u_int64_t timeNow() { // in microseconds
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (u_int64_t)tv.tv_sec*1000000 + tv.tv_usec;
+}
+#endif
+
+////////// AsyncFileWriterThread //////////
+
+class AsyncFileWriterThread {
+public:
+#ifndef USE_SYNCHRONOUS_WRITES
+  pthread_mutex_t fLock;
+  pthread_cond_t fCondition; // signalled whenever a buffer becomes full, or empty
+  pthread_t fThread;
+
+  static void* threadMain(void* writer) {
+    ((AsyncFileWriter*)writer)->writerThreadMain();
+    return NULL;
+  }
+#endif
+};
+
+////////// AsyncFileWriter //////////
+
+AsyncFileWriter::AsyncFileWriter(FILE* fid, unsigned bufferSize, unsigned numBuffers,
+				 unsigned preallocationSize, unsigned syncInterval)
+  : fFid(fid), fFileDescriptor(-1),
+    fBufferSize(bufferSize < BUFFER_ALIGNMENT ? BUFFER_ALIGNMENT : bufferSize),
+    fNumBuffers(numBuffers < 2 ? 2 : numBuffers),
+    fFillIndex(0), fCurBufferBytes(0), fHadError(False),
+    fThreadIsRunning(False), fThread(NULL), fWriteIndex(0), fNumFullBuffers(0),
+    fStopping(False), fPeakNumFullBuffers(0), fNumStalls(0), fMaxStallTime(0),
+    fNumBufferWrites(0), fMaxWriteTime(0), fTotalWriteTime(0),
+    fPreallocationSize(preallocationSize), fSyncInterval(syncInterval) {
+  fflush(fFid);
+  fCurBufferPosition = TellFile64(fFid);
+  if (fCurBufferPosition < 0) fCurBufferPosition = 0; // e.g., we're writing to a pipe
+  fWritePosition = fPreallocatedPosition = fSyncedPosition = fPrevSyncedPosition
+    = fCurBufferPosition;
+
+  fBuffers = new unsigned char*[fNumBuffers];
+  fBufferBytes = new unsigned[fNumBuffers];
+  for (unsigned i = 0; i < fNumBuffers; ++i) {
+#ifndef USE_SYNCHRONOUS_WRITES
+    void* buffer;
+    fBuffers[i] = posix_memalign(&buffer, BUFFER_ALIGNMENT, fBufferSize) == 0
+      ? (unsigned char*)buffer : (unsigned char*)malloc(fBufferSize);
+#else
+    fBuffers[i] = (unsigned char*)malloc(fBufferSize);
+#endif
+    fBufferBytes[i] = 0;
+  }
+  fCurBuffer = fBuffers[0];
+
+#ifndef USE_SYNCHRONOUS_WRITES
+  fFileDescriptor = fileno(fFid);
+  fThread = new AsyncFileWriterThread;
+  if (pthread_mutex_init(&fThread->fLock, NULL) == 0) {
+    if (pthread_cond_init(&fThread->fCondition, NULL) == 0) {
+      if (pthread_create(&fThread->fThread, NULL, AsyncFileWriterThread::threadMain, this) == 0) {
+	fThreadIsRunning = True;
+      } else {
+	pthread_cond_destroy(&fThread->fCondition);
+	pthread_mutex_destroy(&fThread->fLock);
+      }
+    } else {
+      pthread_mutex_destroy(&fThread->fLock);
+    }
+  }
+  if (!fThreadIsRunning) {
+    // We'll write synchronously instead:
+    delete fThread; fThread = NULL;
+  }
+#endif
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+  flush();
+
+#ifndef USE_SYNCHRONOUS_WRITES
+  if (fPreallocatedPosition > fWritePosition) {
+    // Give back the space that we reserved, but didn't use.  (Truncating a file to
+    // its current size frees any blocks beyond its end.)
+    struct stat sb;
+    if (fstat(fFileDescriptor, &sb) == 0) ftruncate(fFileDescriptor, sb.st_size);
+  }
+
+  if (fThreadIsRunning) {
+    pthread_mutex_lock(&fThread->fLock);
+    fStopping = True;
+    pthread_cond_broadcast(&fThread->fCondition);
+    pthread_mutex_unlock(&fThread->fLock);
+    pthread_join(fThread->fThread, NULL);
+
+    pthread_cond_destroy(&fThread->fCondition);
+    pthread_mutex_destroy(&fThread->fLock);
+    delete fThread;
+  }
+#endif
+
+  for (unsigned i = 0; i < fNumBuffers; ++i) free(fBuffers[i]);
+  delete[] fBuffers;
+  delete[] fBufferBytes;
+}
+
+void AsyncFileWriter::write(unsigned char const* data, unsigned dataSize) {
+  while (dataSize > 0) {
+    if (fCurBufferBytes == fBufferSize) handOffCurBuffer();
+
+    unsigned numBytesToCopy = fBufferSize - fCurBufferBytes;
+    if (numBytesToCopy > dataSize) numBytesToCopy = dataSize;
+    memmove(&fCurBuffer[fCurBufferBytes], data, numBytesToCopy);
+    fCurBufferBytes += numBytesToCopy;
+    data += numBytesToCopy;
+    dataSize -= numBytesToCopy;
+  }
+}
+
+void AsyncFileWriter::reserve(unsigned numBytes) {
+  if (numBytes <= fBufferSize && fCurBufferBytes + numBytes > fBufferSize) {
+    // Start a new buffer now (leaving the current one partly unused):
+    handOffCurBuffer();
+  }
+}
+
+Boolean AsyncFileWriter
+::overwrite(int64_t filePosn, unsigned char const* data, unsigned dataSize) {
+  if (filePosn < 0 || filePosn + dataSize > position()) return False; // not yet written
+
+  if (filePosn >= fCurBufferPosition) {
+    // Common case: The data is still in our current buffer:
+    memmove(&fCurBuffer[filePosn - fCurBufferPosition], data, dataSize);
+    return True;
+  }
+
+  // Otherwise, wait until everything is in the file, then overwrite it there:
+  flush();
+  if (fHadError) return False;
+#ifndef USE_SYNCHRONOUS_WRITES
+  while (dataSize > 0) {
+    ssize_t numWritten = pwrite(fFileDescriptor, data, dataSize, (off_t)filePosn);
+    if (numWritten < 0 && errno == EINTR) continue;
+    if (numWritten <= 0) return False; // e.g., we're writing to a pipe
+    data += numWritten; dataSize -= numWritten; filePosn += numWritten;
+  }
+  return True;
+#else
+  if (SeekFile64(fFid, filePosn, SEEK_SET) < 0) return False;
+  Boolean result = fwrite(data, 1, dataSize, fFid) == dataSize;
+  fflush(fFid);
+  SeekFile64(fFid, 0, SEEK_END);
+  return result;
+#endif
+}
+
+void AsyncFileWriter::flush() {
+  if (fCurBufferBytes > 0) handOffCurBuffer();
+
+#ifndef USE_SYNCHRONOUS_WRITES
+  if (fThreadIsRunning) {
+    pthread_mutex_lock(&fThread->fLock);
+    while (fNumFullBuffers > 0) pthread_cond_wait(&fThread->fCondition, &fThread->fLock);
+    pthread_mutex_unlock(&fThread->fLock);
+  }
+#endif
+}
+
+void AsyncFileWriter::handOffCurBuffer() {
+  unsigned const numBytes = fCurBufferBytes;
+  fCurBufferPosition += numBytes;
+  fCurBufferBytes = 0;
+
+  if (!fThreadIsRunning) {
+    // Write the buffer now, then reuse it:
+    writeBuffer(fCurBuffer, numBytes);
+    return;
+  }
+
+#ifndef USE_SYNCHRONOUS_WRITES
+  pthread_mutex_lock(&fThread->fLock);
+  fBufferBytes[fFillIndex] = numBytes;
+  ++fNumFullBuffers;
+  if (fNumFullBuffers > fPeakNumFullBuffers) fPeakNumFullBuffers = fNumFullBuffers;
+  pthread_cond_broadcast(&fThread->fCondition);
+
+  // Wait until the next buffer is free.  (If all of our buffers are full, then the
+  // disk isn't keeping up with us, and we have no choice but to wait.)
+  if (fNumFullBuffers == fNumBuffers) {
+    u_int64_t stallStart = timeNow();
+    while (fNumFullBuffers == fNumBuffers) pthread_cond_wait(&fThread->fCondition, &fThread->fLock);
+    unsigned stallTime = (unsigned)(timeNow() - stallStart);
+    ++fNumStalls;
+    if (stallTime > fMaxStallTime) fMaxStallTime = stallTime;
+  }
+  pthread_mutex_unlock(&fThread->fLock);
+
+  fFillIndex = (fFillIndex+1)%fNumBuffers;
+  fCurBuffer = fBuffers[fFillIndex];
+#endif
+}
+
+void AsyncFileWriter::writeBuffer(unsigned char const* data, unsigned dataSize) {
+#ifndef USE_SYNCHRONOUS_WRITES
+  u_int64_t writeStart = timeNow();
+  preallocate(dataSize);
+  while (dataSize > 0) {
+    ssize_t numWritten = ::write(fFileDescriptor, data, dataSize);
+    if (numWritten < 0 && errno == EINTR) continue;
+    if (numWritten <= 0) {
+      fHadError = True;
+      return;
+    }
+    data += numWritten; dataSize -= numWritten;
+    fWritePosition += numWritten;
+  }
+  syncWrittenData();
+  unsigned writeTime = (unsigned)(timeNow() - writeStart);
+
+  lock();
+  ++fNumBufferWrites;
+  fTotalWriteTime += writeTime;
+  if (writeTime > fMaxWriteTime) fMaxWriteTime = writeTime;
+  unlock();
+#else
+  if (fwrite(data, 1, dataSize, fFid) != dataSize) fHadError = True;
+#endif
+}
+
+void AsyncFileWriter::preallocate(unsigned numBytes) {
+#if !defined(USE_SYNCHRONOUS_WRITES) && defined(FALLOC_FL_KEEP_SIZE)
+  if (fPreallocationSize == 0 || fWritePosition + numBytes <= fPreallocatedPosition) return;
+
+  // Reserve the next chunk of the file, so that it's laid out contiguously, and a full
+  // disk shows up now - rather than when the page cache gets written back.  (The file
+  // size doesn't change, so a recording that's cut short looks no different.)
+  unsigned chunkSize = fPreallocationSize < numBytes ? numBytes : fPreallocationSize;
+  if (fallocate(fFileDescriptor, FALLOC_FL_KEEP_SIZE,
+		(off_t)fPreallocatedPosition, (off_t)chunkSize) == 0) {
+    fPreallocatedPosition += chunkSize;
+  } else {
+    fPreallocationSize = 0; // e.g., a pipe, or a file system (such as FAT) that can't do this
+  }
+#endif
+}
+
+void AsyncFileWriter::syncWrittenData() {
+#if !defined(USE_SYNCHRONOUS_WRITES) && defined(SYNC_FILE_RANGE_WRITE)
+  if (fSyncInterval == 0 || fWritePosition - fSyncedPosition < fSyncInterval) return;
+
+  // Start writing the new data to the disk, then wait for the data of the previous
+  // sync to get there.  This way, the page cache never holds more than two
+  // "syncInterval"s of our data, so the kernel never has to write back a huge backlog
+  // at once (which would stall everyone's writes).  Once on the disk, we won't read
+  // the data again, so we drop it from the page cache as well:
+  if (sync_file_range(fFileDescriptor, (off_t)fSyncedPosition,
+		      (off_t)(fWritePosition - fSyncedPosition), SYNC_FILE_RANGE_WRITE) != 0) {
+    fSyncInterval = 0; // e.g., a pipe
+    return;
+  }
+  if (fSyncedPosition > fPrevSyncedPosition) {
+    off_t const offset = (off_t)fPrevSyncedPosition;
+    off_t const length = (off_t)(fSyncedPosition - fPrevSyncedPosition);
+    sync_file_range(fFileDescriptor, offset, length,
+		    SYNC_FILE_RANGE_WAIT_BEFORE|SYNC_FILE_RANGE_WRITE|SYNC_FILE_RANGE_WAIT_AFTER);
+    posix_fadvise(fFileDescriptor, offset, length, POSIX_FADV_DONTNEED);
+  }
+  fPrevSyncedPosition = fSyncedPosition;
+  fSyncedPosition = fWritePosition;
+#endif
+}
+
+void AsyncFileWriter::lock() const {
+#ifndef USE_SYNCHRONOUS_WRITES
+  if (fThreadIsRunning) pthread_mutex_lock(&fThread->fLock);
+#endif
+}
+
+void AsyncFileWriter::unlock() const {
+#ifndef USE_SYNCHRONOUS_WRITES
+  if (fThreadIsRunning) pthread_mutex_unlock(&fThread->fLock);
+#endif
+}
+
+unsigned AsyncFileWriter::numPendingBuffers() const {
+  lock(); unsigned result = fNumFullBuffers; unlock();
+  return result;
+}
+
+unsigned AsyncFileWriter::peakNumPendingBuffers() const {
+  lock(); unsigned result = fPeakNumFullBuffers; unlock();
+  return result;
+}
+
+unsigned AsyncFileWriter::numStalls() const {
+  lock(); unsigned result = fNumStalls; unlock();
+  return result;
+}
+
+unsigned AsyncFileWriter::maxStallTime() const {
+  lock(); unsigned result = fMaxStallTime; unlock();
+  return result;
+}
+
+unsigned AsyncFileWriter::numBufferWrites() const {
+  lock(); unsigned result = fNumBufferWrites; unlock();
+  return result;
+}
+
+unsigned AsyncFileWriter::averageWriteTime() const {
+  lock();
+  unsigned result = fNumBufferWrites == 0 ? 0 : (unsigned)(fTotalWriteTime/fNumBufferWrites);
+  unlock();
+  return result;
+}
+
+unsigned AsyncFileWriter::maxWriteTime() const {
+  lock(); unsigned result = fMaxWriteTime; unlock();
+  return result;
+}
+
+void AsyncFileWriter::writerThreadMain() {
+#ifndef USE_SYNCHRONOUS_WRITES
+  pthread_mutex_lock(&fThread->fLock);
+  while (1) {
+    while (fNumFullBuffers == 0 && !fStopping) pthread_cond_wait(&fThread->fCondition, &fThread->fLock);
+    if (fNumFullBuffers == 0) break; // we're stopping, and have nothing left to write
+
+    unsigned char const* buffer = fBuffers[fWriteIndex];
+    unsigned numBytes = fBufferBytes[fWriteIndex];
+    pthread_mutex_unlock(&fThread->fLock);
+
+    writeBuffer(buffer, numBytes);
+
+    pthread_mutex_lock(&fThread->fLock);
+    fWriteIndex = (fWriteIndex+1)%fNumBuffers;
+    --fNumFullBuffers;
+    pthread_cond_broadcast(&fThread->fCondition);
+  }
+  pthread_mutex_unlock(&fThread->fLock);
+#endif
+}
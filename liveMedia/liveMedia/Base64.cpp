@@ -19,95 +19,240 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 // implementation
 
 #include "Base64.hh"
-#include <strDup.hh>
 #include <string.h>
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define USE_NEON_BASE64 1
+#endif
 
-static char base64DecodeTable[256];
+// Each character's 6-bit value, or 0x40 for '=' (padding), or 0x80 if it's invalid.
+// (This is a constant - rather than lazily-initialized - table, so that decoding
+// needn't check whether it's been set up.)
+static unsigned char const base64DecodeTable[256] = {
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x3E, 0x80, 0x80, 0x80, 0x3F,
+  0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x80, 0x80, 0x80, 0x40, 0x80, 0x80,
+  0x80, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+  0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x80, 0x80, 0x80, 0x80, 0x80,
+  0x80, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+  0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x80, 0x80, 0x80, 0x80, 0x80,
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+  0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80
+};
 
-static void initBase64DecodeTable() {
-  int i;
-  for (i = 0; i < 256; ++i) base64DecodeTable[i] = (char)0x80;
-      // default value: invalid
+// Decodes a quad that contains padding and/or invalid characters:
+static unsigned decodeUnusualQuad(unsigned char* to, unsigned char const* from) {
+  // Note: "to" may be the same as "from", so read all of the input before writing:
+  unsigned char v[4];
+  for (unsigned i = 0; i < 4; ++i) {
+    v[i] = base64DecodeTable[from[i]];
+    if ((v[i]&0xC0) != 0) v[i] = 0; // pretend the input was 'A'
+  }
+  unsigned const numBytes = from[2] == '=' ? 1 : from[3] == '=' ? 2 : 3;
+
+  to[0] = (v[0]<<2) | (v[1]>>4);
+  if (numBytes > 1) to[1] = (v[1]<<4) | (v[2]>>2);
+  if (numBytes > 2) to[2] = (v[2]<<6) | v[3];
+  return numBytes;
+}
+
+static unsigned decodeQuads(unsigned char* to, unsigned char const* from, unsigned numQuads) {
+  unsigned char* const toStart = to;
+  for (; numQuads > 0; --numQuads, from += 4) {
+    unsigned char const a = base64DecodeTable[from[0]];
+    unsigned char const b = base64DecodeTable[from[1]];
+    unsigned char const c = base64DecodeTable[from[2]];
+    unsigned char const d = base64DecodeTable[from[3]];
+    if (((a|b|c|d)&0xC0) == 0) {
+      // Normal case: 4 valid characters => 3 bytes
+      to[0] = (a<<2) | (b>>4);
+      to[1] = (b<<4) | (c>>2);
+      to[2] = (c<<6) | d;
+      to += 3;
+    } else {
+      to += decodeUnusualQuad(to, from);
+    }
+  }
+  return to - toStart;
+}
 
-  for (i = 'A'; i <= 'Z'; ++i) base64DecodeTable[i] = 0 + (i - 'A');
-  for (i = 'a'; i <= 'z'; ++i) base64DecodeTable[i] = 26 + (i - 'a');
-  for (i = '0'; i <= '9'; ++i) base64DecodeTable[i] = 52 + (i - '0');
-  base64DecodeTable[(unsigned char)'+'] = 62;
-  base64DecodeTable[(unsigned char)'/'] = 63;
-  base64DecodeTable[(unsigned char)'='] = 0;
+#if defined(USE_NEON_BASE64)
+// Maps 16 Base64 characters to their 6-bit values, setting (in "bad") the lanes that
+// contain anything else (including '='):
+static inline uint8x16_t neonDecodeChars(uint8x16_t c, uint8x16_t& bad) {
+  uint8x16_t const upper = vcltq_u8(vsubq_u8(c, vdupq_n_u8('A')), vdupq_n_u8(26));
+  uint8x16_t const lower = vcltq_u8(vsubq_u8(c, vdupq_n_u8('a')), vdupq_n_u8(26));
+  uint8x16_t const digit = vcltq_u8(vsubq_u8(c, vdupq_n_u8('0')), vdupq_n_u8(10));
+  uint8x16_t const plus = vceqq_u8(c, vdupq_n_u8('+'));
+  uint8x16_t const slash = vceqq_u8(c, vdupq_n_u8('/'));
+  bad = vorrq_u8(bad, vmvnq_u8(vorrq_u8(vorrq_u8(upper, lower),
+					 vorrq_u8(digit, vorrq_u8(plus, slash)))));
+
+  // The (modulo 256) amount to add to each kind of character:
+  uint8x16_t offset = vandq_u8(upper, vdupq_n_u8((unsigned char)(0-'A')));
+  offset = vorrq_u8(offset, vandq_u8(lower, vdupq_n_u8((unsigned char)(26-'a'))));
+  offset = vorrq_u8(offset, vandq_u8(digit, vdupq_n_u8((unsigned char)(52-'0'))));
+  offset = vorrq_u8(offset, vandq_u8(plus, vdupq_n_u8((unsigned char)(62-'+'))));
+  offset = vorrq_u8(offset, vandq_u8(slash, vdupq_n_u8((unsigned char)(63-'/'))));
+  return vaddq_u8(c, offset);
+}
+#endif
+
+unsigned base64DecodeBlock(unsigned char* to, char const* fromSigned, unsigned fromSize) {
+  unsigned char const* from = (unsigned char const*)fromSigned;
+  unsigned char* const toStart = to;
+  unsigned numQuads = fromSize/4;
+
+#if defined(USE_NEON_BASE64)
+  // Decode 16 quads (64 characters => 48 bytes) at a time.  (This is safe to do in
+  // place, because all 64 characters are loaded before any output is stored.)
+  while (numQuads >= 16) {
+    uint8x16x4_t const in = vld4q_u8(from); // lane i of "in.val[j]" is character j of quad i
+    uint8x16_t bad = vdupq_n_u8(0);
+    uint8x16_t const a = neonDecodeChars(in.val[0], bad);
+    uint8x16_t const b = neonDecodeChars(in.val[1], bad);
+    uint8x16_t const c = neonDecodeChars(in.val[2], bad);
+    uint8x16_t const d = neonDecodeChars(in.val[3], bad);
+    uint64x2_t const bad64 = vreinterpretq_u64_u8(bad);
+    if ((vgetq_lane_u64(bad64, 0)|vgetq_lane_u64(bad64, 1)) != 0) {
+      // There's padding (or something invalid) in here, so decode these quads the slow way:
+      to += decodeQuads(to, from, 16);
+    } else {
+      uint8x16x3_t out;
+      out.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+      out.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+      out.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+      vst3q_u8(to, out);
+      to += 48;
+    }
+    from += 64;
+    numQuads -= 16;
+  }
+#endif
+
+  to += decodeQuads(to, from, numQuads);
+  return to - toStart;
 }
 
 unsigned char* base64Decode(char* in, unsigned& resultSize,
 			    Boolean trimTrailingZeros) {
-  static Boolean haveInitedBase64DecodeTable = False;
-  if (!haveInitedBase64DecodeTable) {
-    initBase64DecodeTable();
-    haveInitedBase64DecodeTable = True;
+  unsigned const inSize = strlen(in);
+  unsigned char* result = new unsigned char[3*(inSize/4) + 1];
+  unsigned k = base64DecodeBlock(result, in, inSize);
+      // (Any partial quad at the end of "in" - which shouldn't happen - is ignored.)
+
+  if (trimTrailingZeros) {
+    while (k > 0 && result[k-1] == '\0') --k;
   }
+  resultSize = k;
+  return result;
+}
+
+unsigned Base64Decoder::decode(unsigned char* to, char const* from, unsigned fromSize) {
+  unsigned numBytesWritten = 0;
 
-  unsigned char* out = (unsigned char*)strDupSize(in); // ensures we have enough space
-  int k = 0;
-  int const jMax = strlen(in) - 3;
-     // in case "in" is not a multiple of 4 bytes (although it should be)
-  for (int j = 0; j < jMax; j += 4) {
-    char inTmp[4], outTmp[4];
-    for (int i = 0; i < 4; ++i) {
-      inTmp[i] = in[i+j];
-      outTmp[i] = base64DecodeTable[(unsigned char)inTmp[i]];
-      if ((outTmp[i]&0x80) != 0) outTmp[i] = 0; // pretend the input was 'A'
+  if (fNumPendingChars > 0) {
+    // First, try to complete our pending quad:
+    while (fNumPendingChars < 4 && fromSize > 0) {
+      fPendingChars[fNumPendingChars++] = *from++;
+      --fromSize;
     }
+    if (fNumPendingChars < 4) return 0;
 
-    out[k++] = (outTmp[0]<<2) | (outTmp[1]>>4);
-    out[k++] = (outTmp[1]<<4) | (outTmp[2]>>2);
-    out[k++] = (outTmp[2]<<6) | outTmp[3];
+    numBytesWritten = decodeQuads(to, (unsigned char const*)fPendingChars, 1);
+    fNumPendingChars = 0;
   }
 
-  if (trimTrailingZeros) {
-    while (k > 0 && out[k-1] == '\0') --k;
+  // Then decode all of the complete quads in the new data:
+  unsigned const numRemainingChars = fromSize%4;
+  numBytesWritten += base64DecodeBlock(&to[numBytesWritten], from, fromSize - numRemainingChars);
+
+  // And keep any remaining characters for next time:
+  for (unsigned i = 0; i < numRemainingChars; ++i) {
+    fPendingChars[i] = from[fromSize - numRemainingChars + i];
   }
-  resultSize = k;
-  unsigned char* result = new unsigned char[resultSize];
-  memmove(result, out, resultSize);
-  delete[] out;
+  fNumPendingChars = numRemainingChars;
 
-  return result;
+  return numBytesWritten;
 }
 
 static const char base64Char[] =
 "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-char* base64Encode(char const* origSigned, unsigned origLength) {
-  unsigned char const* orig = (unsigned char const*)origSigned; // in case any input bytes have the MSB set
-  if (orig == NULL) return NULL;
+#if defined(USE_NEON_BASE64)
+// Maps 16 6-bit values to their Base64 characters:
+static inline uint8x16_t neonEncodeChars(uint8x16_t v) {
+  uint8x16_t offset = vdupq_n_u8('A');
+  offset = vbslq_u8(vcgeq_u8(v, vdupq_n_u8(26)), vdupq_n_u8((unsigned char)('a'-26)), offset);
+  offset = vbslq_u8(vcgeq_u8(v, vdupq_n_u8(52)), vdupq_n_u8((unsigned char)('0'-52)), offset);
+  offset = vbslq_u8(vceqq_u8(v, vdupq_n_u8(62)), vdupq_n_u8((unsigned char)('+'-62)), offset);
+  offset = vbslq_u8(vceqq_u8(v, vdupq_n_u8(63)), vdupq_n_u8((unsigned char)('/'-63)), offset);
+  return vaddq_u8(v, offset);
+}
+#endif
+
+unsigned base64EncodeBlock(char* to, unsigned char const* orig, unsigned origLength) {
+  char* const toStart = to;
+  unsigned numOrig24BitValues = origLength/3;
+  Boolean const havePadding = origLength > numOrig24BitValues*3;
+  Boolean const havePadding2 = origLength == numOrig24BitValues*3 + 2;
 
-  unsigned const numOrig24BitValues = origLength/3;
-  Boolean havePadding = origLength > numOrig24BitValues*3;
-  Boolean havePadding2 = origLength == numOrig24BitValues*3 + 2;
-  unsigned const numResultBytes = 4*(numOrig24BitValues + havePadding);
-  char* result = new char[numResultBytes+1]; // allow for trailing '\0'
+#if defined(USE_NEON_BASE64)
+  // Encode 48 bytes (=> 64 characters) at a time:
+  while (numOrig24BitValues >= 16) {
+    uint8x16x3_t const in = vld3q_u8(orig);
+    uint8x16_t const x = in.val[0], y = in.val[1], z = in.val[2];
+    uint8x16x4_t out;
+    out.val[0] = neonEncodeChars(vshrq_n_u8(x, 2));
+    out.val[1] = neonEncodeChars(vorrq_u8(vshlq_n_u8(vandq_u8(x, vdupq_n_u8(0x03)), 4),
+					  vshrq_n_u8(y, 4)));
+    out.val[2] = neonEncodeChars(vorrq_u8(vshlq_n_u8(vandq_u8(y, vdupq_n_u8(0x0F)), 2),
+					  vshrq_n_u8(z, 6)));
+    out.val[3] = neonEncodeChars(vandq_u8(z, vdupq_n_u8(0x3F)));
+    vst4q_u8((unsigned char*)to, out);
+    orig += 48; to += 64;
+    numOrig24BitValues -= 16;
+  }
+#endif
 
   // Map each full group of 3 input bytes into 4 output base-64 characters:
-  unsigned i;
-  for (i = 0; i < numOrig24BitValues; ++i) {
-    result[4*i+0] = base64Char[(orig[3*i]>>2)&0x3F];
-    result[4*i+1] = base64Char[(((orig[3*i]&0x3)<<4) | (orig[3*i+1]>>4))&0x3F];
-    result[4*i+2] = base64Char[((orig[3*i+1]<<2) | (orig[3*i+2]>>6))&0x3F];
-    result[4*i+3] = base64Char[orig[3*i+2]&0x3F];
+  for (; numOrig24BitValues > 0; --numOrig24BitValues, orig += 3, to += 4) {
+    to[0] = base64Char[(orig[0]>>2)&0x3F];
+    to[1] = base64Char[(((orig[0]&0x3)<<4) | (orig[1]>>4))&0x3F];
+    to[2] = base64Char[((orig[1]<<2) | (orig[2]>>6))&0x3F];
+    to[3] = base64Char[orig[2]&0x3F];
   }
 
-  // Now, take padding into account.  (Note: i == numOrig24BitValues)
+  // Now, take padding into account:
   if (havePadding) {
-    result[4*i+0] = base64Char[(orig[3*i]>>2)&0x3F];
+    to[0] = base64Char[(orig[0]>>2)&0x3F];
     if (havePadding2) {
-      result[4*i+1] = base64Char[(((orig[3*i]&0x3)<<4) | (orig[3*i+1]>>4))&0x3F];
-      result[4*i+2] = base64Char[(orig[3*i+1]<<2)&0x3F];
+      to[1] = base64Char[(((orig[0]&0x3)<<4) | (orig[1]>>4))&0x3F];
+      to[2] = base64Char[(orig[1]<<2)&0x3F];
     } else {
-      result[4*i+1] = base64Char[((orig[3*i]&0x3)<<4)&0x3F];
-      result[4*i+2] = '=';
+      to[1] = base64Char[((orig[0]&0x3)<<4)&0x3F];
+      to[2] = '=';
     }
-    result[4*i+3] = '=';
+    to[3] = '=';
+    to += 4;
   }
 
+  return to - toStart;
+}
+
+char* base64Encode(char const* origSigned, unsigned origLength) {
+  unsigned char const* orig = (unsigned char const*)origSigned; // in case any input bytes have the MSB set
+  if (orig == NULL) return NULL;
+
+  char* result = new char[4*((origLength+2)/3) + 1]; // allow for trailing '\0'
+  unsigned const numResultBytes = base64EncodeBlock(result, orig, origLength);
   result[numResultBytes] = '\0';
   return result;
 }
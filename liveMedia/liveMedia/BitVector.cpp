@@ -19,6 +19,7 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 // Implementation
 
 #include "BitVector.hh"
+#include "NetCommon.h" // for "u_int64_t"
 
 BitVector::BitVector(unsigned char* baseBytePtr,
 		     unsigned baseBitOffset,
@@ -81,28 +82,42 @@ void BitVector::put1Bit(unsigned bit) {
 }
 
 unsigned BitVector::getBits(unsigned numBits) {
-  if (numBits == 0) return 0;
+  if (numBits > MAX_LENGTH) {
+    numBits = MAX_LENGTH;
+  }
 
-  unsigned char tmpBuf[4];
-  unsigned overflowingBits = 0;
+  unsigned result = peekBits(numBits);
+  skipBits(numBits);
+  return result;
+}
+
+unsigned BitVector::peekBits(unsigned numBits) const {
+  if (numBits == 0) return 0;
 
   if (numBits > MAX_LENGTH) {
     numBits = MAX_LENGTH;
   }
 
-  if (numBits > fTotNumBits - fCurBitIndex) {
-    overflowingBits = numBits - (fTotNumBits - fCurBitIndex);
+  unsigned numValidBits = fTotNumBits - fCurBitIndex;
+  if (numValidBits == 0) return 0;
+  if (numValidBits > numBits) numValidBits = numBits;
+
+  // Rather than copying the bits one at a time, load the (at most 5) bytes that
+  // contain them into a 64-bit word, left-justified, and then shift them out from there:
+  unsigned totBitOffset = fBaseBitOffset + fCurBitIndex;
+  unsigned char const* fromBytePtr = &fBaseBytePtr[totBitOffset/8];
+  unsigned const fromBitRem = totBitOffset%8;
+  unsigned const numBytes = (fromBitRem + numValidBits + 7)/8;
+
+  u_int64_t word = 0;
+  for (unsigned i = 0; i < numBytes; ++i) word = (word<<8) | fromBytePtr[i];
+  word <<= 8*(8-numBytes) + fromBitRem;
+
+  unsigned result = (unsigned)(word>>(64-numBits));
+  if (numValidBits < numBits) {
+    // Any bits beyond the end of the vector are 0:
+    result &= (0xFFFFFFFF << (numBits-numValidBits));
   }
-
-  shiftBits(tmpBuf, 0, /* to */
-	    fBaseBytePtr, fBaseBitOffset + fCurBitIndex, /* from */
-	    numBits - overflowingBits /* num bits */);
-  fCurBitIndex += numBits - overflowingBits;
-
-  unsigned result
-    = (tmpBuf[0]<<24) | (tmpBuf[1]<<16) | (tmpBuf[2]<<8) | tmpBuf[3];
-  result >>= (MAX_LENGTH - numBits); // move into low-order part of word
-  result &= (0xFFFFFFFF << overflowingBits); // so any overflow bits are 0
   return result;
 }
 
@@ -36,6 +36,9 @@ public:
 
   unsigned getBits(unsigned numBits); // "numBits" <= 32
   unsigned get1Bit();
+  unsigned peekBits(unsigned numBits) const; // "numBits" <= 32
+      // Like "getBits()", but doesn't advance the current bit index.
+      // (Any bits beyond the end of the vector are returned as 0.)
 
   void skipBits(unsigned numBits);
 
@@ -34,10 +34,15 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 
 #include "ByteStreamFileSource.hh"
 #include "InputFile.hh"
+#include "AsyncFileReader.hh"
 #include "GroupsockHelper.hh"
+#include <sys/stat.h>
 
 ////////// ByteStreamFileSource //////////
 
+unsigned ByteStreamFileSource::readAheadBufferSize = ASYNC_FILE_READER_BUFFER_SIZE;
+unsigned ByteStreamFileSource::readAheadNumBuffers = ASYNC_FILE_READER_NUM_BUFFERS;
+
 ByteStreamFileSource*
 ByteStreamFileSource::createNew(UsageEnvironment& env, char const* fileName,
 				unsigned preferredFrameSize,
@@ -50,6 +55,7 @@ ByteStreamFileSource::createNew(UsageEnvironment& env, char const* fileName,
     = new ByteStreamFileSource(env, fid, deleteFidOnClose,
 			       preferredFrameSize, playTimePerFrame);
   newSource->fFileSize = GetFileSize(fileName, fid);
+  newSource->initReadAhead();
 
   return newSource;
 }
@@ -65,19 +71,28 @@ ByteStreamFileSource::createNew(UsageEnvironment& env, FILE* fid,
     = new ByteStreamFileSource(env, fid, deleteFidOnClose,
 			       preferredFrameSize, playTimePerFrame);
   newSource->fFileSize = GetFileSize(NULL, fid);
+  newSource->initReadAhead();
 
   return newSource;
 }
 
 void ByteStreamFileSource::seekToByteAbsolute(u_int64_t byteNumber, u_int64_t numBytesToStream) {
-  SeekFile64(fFid, (int64_t)byteNumber, SEEK_SET);
+  if (fReadAhead != NULL) {
+    fReadAhead->seek((int64_t)byteNumber);
+  } else {
+    SeekFile64(fFid, (int64_t)byteNumber, SEEK_SET);
+  }
 
   fNumBytesToStream = numBytesToStream;
   fLimitNumBytesToStream = fNumBytesToStream > 0;
 }
 
 void ByteStreamFileSource::seekToByteRelative(int64_t offset) {
-  SeekFile64(fFid, offset, SEEK_CUR);
+  if (fReadAhead != NULL) {
+    fReadAhead->seek(fReadAhead->position() + offset);
+  } else {
+    SeekFile64(fFid, offset, SEEK_CUR);
+  }
 }
 
 ByteStreamFileSource::ByteStreamFileSource(UsageEnvironment& env, FILE* fid,
@@ -87,7 +102,7 @@ ByteStreamFileSource::ByteStreamFileSource(UsageEnvironment& env, FILE* fid,
   : FramedFileSource(env, fid), fPreferredFrameSize(preferredFrameSize),
     fPlayTimePerFrame(playTimePerFrame), fLastPlayTime(0), fFileSize(0),
     fDeleteFidOnClose(deleteFidOnClose), fHaveStartedReading(False),
-    fLimitNumBytesToStream(False), fNumBytesToStream(0) {
+    fLimitNumBytesToStream(False), fNumBytesToStream(0), fReadAhead(NULL) {
 #ifndef READ_FROM_FILES_SYNCHRONOUSLY
   makeSocketNonBlocking(fileno(fFid));
 #endif
@@ -96,6 +111,11 @@ ByteStreamFileSource::ByteStreamFileSource(UsageEnvironment& env, FILE* fid,
 ByteStreamFileSource::~ByteStreamFileSource() {
   if (fFid == NULL) return;
 
+  if (fReadAhead != NULL) {
+    envir().taskScheduler().unscheduleDelayedTask(nextTask());
+    delete fReadAhead;
+  }
+
 #ifndef READ_FROM_FILES_SYNCHRONOUSLY
   envir().taskScheduler().turnOffBackgroundReadHandling(fileno(fFid));
 #endif
@@ -103,7 +123,34 @@ ByteStreamFileSource::~ByteStreamFileSource() {
   if (fDeleteFidOnClose) fclose(fFid);
 }
 
+void ByteStreamFileSource::initReadAhead() {
+  // We read ahead only from regular files.  (Pipes and devices are read - without
+  // blocking - when they become readable, as before.)
+  struct stat sb;
+  if (readAheadNumBuffers == 0 || fFid == stdin
+      || fstat(fileno(fFid), &sb) != 0 || !S_ISREG(sb.st_mode)) return;
+
+  fReadAhead = new AsyncFileReader(envir(), fFid, readAheadBufferSize, readAheadNumBuffers);
+  if (!fReadAhead->isAsynchronous()) {
+    // We couldn't create a reading thread, so just read the file directly:
+    delete fReadAhead; fReadAhead = NULL;
+    return;
+  }
+  fReadAhead->setDataHandler(readAheadDataHandler, this);
+}
+
 void ByteStreamFileSource::doGetNextFrame() {
+  if (fReadAhead != NULL) {
+    if (fLimitNumBytesToStream && fNumBytesToStream == 0) {
+      handleClosure(this);
+      return;
+    }
+
+    // Read from the event loop (so that we can deliver the data directly, without recursion):
+    nextTask() = envir().taskScheduler().scheduleDelayedTask(0, readAheadDataHandler, this);
+    return;
+  }
+
   if (feof(fFid) || ferror(fFid) || (fLimitNumBytesToStream && fNumBytesToStream == 0)) {
     handleClosure(this);
     return;
@@ -122,6 +169,10 @@ void ByteStreamFileSource::doGetNextFrame() {
 }
 
 void ByteStreamFileSource::doStopGettingFrames() {
+  if (fReadAhead != NULL) {
+    envir().taskScheduler().unscheduleDelayedTask(nextTask());
+    return;
+  }
 #ifndef READ_FROM_FILES_SYNCHRONOUSLY
   envir().taskScheduler().turnOffBackgroundReadHandling(fileno(fFid));
   fHaveStartedReading = False;
@@ -136,6 +187,14 @@ void ByteStreamFileSource::fileReadableHandler(ByteStreamFileSource* source, int
   source->doReadFromFile();
 }
 
+void ByteStreamFileSource::readAheadDataHandler(void* clientData) {
+  ByteStreamFileSource* source = (ByteStreamFileSource*)clientData;
+  // (We may be called either as a delayed task, or by our reader's event trigger.)
+  source->envir().taskScheduler().unscheduleDelayedTask(source->nextTask());
+  if (!source->isCurrentlyAwaitingData()) return; // e.g., a stale event, after we were stopped
+  source->doReadFromFile();
+}
+
 void ByteStreamFileSource::doReadFromFile() {
   // Try to read as many bytes as will fit in the buffer provided (or "fPreferredFrameSize" if less)
   if (fLimitNumBytesToStream && fNumBytesToStream < (u_int64_t)fMaxSize) {
@@ -144,11 +203,17 @@ void ByteStreamFileSource::doReadFromFile() {
   if (fPreferredFrameSize > 0 && fPreferredFrameSize < fMaxSize) {
     fMaxSize = fPreferredFrameSize;
   }
+  if (fReadAhead != NULL) {
+    int numBytesRead = fReadAhead->read(fTo, fMaxSize);
+    if (numBytesRead == 0) return; // "readAheadDataHandler()" will be called when there's data
+    fFrameSize = numBytesRead < 0 ? 0 : (unsigned)numBytesRead;
+  } else {
 #ifdef READ_FROM_FILES_SYNCHRONOUSLY
-  fFrameSize = fread(fTo, 1, fMaxSize, fFid);
+    fFrameSize = fread(fTo, 1, fMaxSize, fFid);
 #else
-  fFrameSize = read(fileno(fFid), fTo, fMaxSize);
+    fFrameSize = read(fileno(fFid), fTo, fMaxSize);
 #endif
+  }
   if (fFrameSize == 0) {
     handleClosure(this);
     return;
@@ -177,6 +242,11 @@ void ByteStreamFileSource::doReadFromFile() {
   }
 
   // Inform the reader that he has data:
+  if (fReadAhead != NULL) {
+    // We were called from the event loop (by "readAheadDataHandler()"), so we can do this directly:
+    FramedSource::afterGetting(this);
+    return;
+  }
 #ifdef READ_FROM_FILES_SYNCHRONOUSLY
   // To avoid possible infinite recursion, we need to return to the event loop to do this:
   nextTask() = envir().taskScheduler().scheduleDelayedTask(0,
@@ -0,0 +1,161 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A bounded, lock-free queue of frames, handed from (any number of) other threads -
+// e.g., a hardware encoder's - to the event loop, using an 'event trigger'.
+// Implementation
+
+#include "DeviceFrameQueue.hh"
+#include <GroupsockHelper.hh> // for "gettimeofday()"
+
+// The queue is a ring of slots, each with a sequence number that says whose turn it
+// is to use it.  A producer claims the slot at "fEnqueuePosition" (by advancing it with
+// a compare-and-swap) only when the slot's sequence number equals that position - i.e.,
+// the consumer has finished with the slot's previous frame.  Once it has filled the slot,
+// it sets the sequence number to position+1, to hand the frame to the consumer; the
+// consumer, in turn, sets it to position+(number of slots), for the producers' next
+// lap.  Positions are compared modulo 2^32, so they may wrap around.
+
+static u_int64_t timeNow() { // in microseconds
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (u_int64_t)tv.tv_sec*1000000 + tv.tv_usec;
+}
+
+DeviceFrameQueue* DeviceFrameQueue
+::createNew(UsageEnvironment& env, TaskFunc* frameHandler, void* frameHandlerClientData,
+	    DeviceFrameReleaseFunc* releaseFunc, void* releaseClientData, unsigned queueSize) {
+  EventTriggerId triggerId = env.taskScheduler().createEventTrigger(eventHandler);
+  if (triggerId == 0) {
+    env.setResultMsg("No more event triggers are available");
+    return NULL;
+  }
+
+  return new DeviceFrameQueue(env, triggerId, frameHandler, frameHandlerClientData,
+			      releaseFunc, releaseClientData, queueSize);
+}
+
+DeviceFrameQueue
+::DeviceFrameQueue(UsageEnvironment& env, EventTriggerId triggerId,
+		   TaskFunc* frameHandler, void* frameHandlerClientData,
+		   DeviceFrameReleaseFunc* releaseFunc, void* releaseClientData,
+		   unsigned queueSize)
+  : fEnv(env), fTriggerId(triggerId),
+    fFrameHandler(frameHandler), fFrameHandlerClientData(frameHandlerClientData),
+    fReleaseFunc(releaseFunc), fReleaseClientData(releaseClientData),
+    fEnqueuePosition(0), fWakeupIsPending(0), fNumEnqueued(0), fNumDropped(0), fNumWakeups(0),
+    fDequeuePosition(0), fPeakDepth(0), fNumDequeued(0), fMaxLatency(0), fTotalLatency(0) {
+  unsigned numSlots = 2;
+  while (numSlots < queueSize) numSlots <<= 1;
+  fMask = numSlots - 1;
+
+  fSlots = new Slot[numSlots];
+  for (unsigned i = 0; i < numSlots; ++i) fSlots[i].sequence = i;
+}
+
+DeviceFrameQueue::~DeviceFrameQueue() {
+  // (The producers must have stopped calling "enqueue()" by now.)
+  fEnv.taskScheduler().deleteEventTrigger(fTriggerId);
+
+  DeviceFrame frame;
+  while (dequeue(frame)) release(frame);
+  delete[] fSlots;
+}
+
+Boolean DeviceFrameQueue::enqueue(DeviceFrame const& frame) {
+  unsigned position = fEnqueuePosition;
+  Slot* slot;
+  while (1) {
+    slot = &fSlots[position&fMask];
+    unsigned sequence = slot->sequence;
+    int diff = (int)(sequence - position);
+    if (diff == 0) {
+      // The slot is free; try to claim it:
+      unsigned oldPosition = __sync_val_compare_and_swap(&fEnqueuePosition, position, position+1);
+      if (oldPosition == position) break;
+      position = oldPosition; // another producer got there first
+    } else if (diff < 0) {
+      // The slot still holds a frame from the previous lap, so the queue is full:
+      __sync_fetch_and_add(&fNumDropped, 1);
+      if (fReleaseFunc != NULL) (*fReleaseFunc)(fReleaseClientData, frame.data, frame.bufferId);
+      return False;
+    } else {
+      position = fEnqueuePosition; // another producer has claimed this slot; try again
+    }
+  }
+
+  slot->frame = frame;
+  slot->enqueueTime = timeNow();
+  if (frame.presentationTime.tv_sec == 0 && frame.presentationTime.tv_usec == 0) {
+    slot->frame.presentationTime.tv_sec = (long)(slot->enqueueTime/1000000);
+    slot->frame.presentationTime.tv_usec = (long)(slot->enqueueTime%1000000);
+  }
+  __sync_synchronize(); // so that the consumer sees the frame before the new sequence number
+  slot->sequence = position+1;
+  __sync_fetch_and_add(&fNumEnqueued, 1);
+
+  // Wake up the event loop, unless it has already been woken - but hasn't yet handled
+  // the wakeup (in which case it'll see this frame anyway):
+  if (__sync_lock_test_and_set(&fWakeupIsPending, 1) == 0) {
+    __sync_fetch_and_add(&fNumWakeups, 1);
+    fEnv.taskScheduler().triggerEvent(fTriggerId, this);
+  }
+
+  return True;
+}
+
+Boolean DeviceFrameQueue::dequeue(DeviceFrame& frame) {
+  Slot& slot = fSlots[fDequeuePosition&fMask];
+  if ((int)(slot.sequence - (fDequeuePosition+1)) < 0) return False; // empty
+  __sync_synchronize(); // so that we see the frame that was stored before the sequence number
+
+  frame = slot.frame;
+  unsigned latency = (unsigned)(timeNow() - slot.enqueueTime);
+  ++fNumDequeued;
+  fTotalLatency += latency;
+  if (latency > fMaxLatency) fMaxLatency = latency;
+  unsigned depth = fEnqueuePosition - fDequeuePosition;
+  if (depth > fPeakDepth) fPeakDepth = depth;
+
+  __sync_synchronize(); // so that we've copied the frame before a producer reuses the slot
+  slot.sequence = fDequeuePosition + fMask + 1;
+  ++fDequeuePosition;
+  return True;
+}
+
+void DeviceFrameQueue::release(DeviceFrame const& frame) {
+  if (fReleaseFunc != NULL) (*fReleaseFunc)(fReleaseClientData, frame.data, frame.bufferId);
+}
+
+Boolean DeviceFrameQueue::isEmpty() const {
+  return (int)(fSlots[fDequeuePosition&fMask].sequence - (fDequeuePosition+1)) < 0;
+}
+
+unsigned DeviceFrameQueue::averageQueueLatency() const {
+  return fNumDequeued == 0 ? 0 : (unsigned)(fTotalLatency/fNumDequeued);
+}
+
+void DeviceFrameQueue::eventHandler(void* clientData) {
+  DeviceFrameQueue* queue = (DeviceFrameQueue*)clientData;
+
+  // Allow the next "enqueue()" to trigger another event, before we look at the queue
+  // (so that a frame enqueued from now on can't be missed):
+  __sync_lock_release(&queue->fWakeupIsPending);
+  __sync_synchronize();
+
+  (*queue->fFrameHandler)(queue->fFrameHandlerClientData);
+}
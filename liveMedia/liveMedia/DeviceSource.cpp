@@ -30,13 +30,11 @@ DeviceSource::createNew(UsageEnvironment& env,
   return new DeviceSource(env, params);
 }
 
-EventTriggerId DeviceSource::eventTriggerId = 0;
-
 unsigned DeviceSource::referenceCount = 0;
 
 DeviceSource::DeviceSource(UsageEnvironment& env,
 			   DeviceParameters params)
-  : FramedSource(env), fParams(params) {
+  : FramedSource(env), fParams(params), fFrameQueue(NULL) {
   if (referenceCount == 0) {
     // Any global initialization of the device would be done here:
     //%%% TO BE WRITTEN %%%
@@ -53,25 +51,25 @@ DeviceSource::DeviceSource(UsageEnvironment& env,
   //     envir().taskScheduler().turnOnBackgroundReadHandling( ... )
   // (See examples of this call in the "liveMedia" directory.)
   //
-  // If, however, the device *cannot* be accessed as a readable socket, then instead we can implement it using 'event triggers':
-  // Create an 'event trigger' for this device (if it hasn't already been done):
-  if (eventTriggerId == 0) {
-    eventTriggerId = envir().taskScheduler().createEventTrigger(deliverFrame0);
-  }
+  // If, however, the device *cannot* be accessed as a readable socket, then instead we can hand its frames
+  // to the event loop through a 'frame queue' (which uses an 'event trigger').  The device's thread
+  // "enqueue()"s each frame - in a buffer of its own, which we give back (by calling "releaseFrame()")
+  // once we've delivered it:
+  fFrameQueue = DeviceFrameQueue::createNew(env, deliverFrame0, this, releaseFrame, this);
+  // (If this fails - because no more event triggers are available - then we can't get any frames.)
 }
 
 DeviceSource::~DeviceSource() {
   // Any instance-specific 'destruction' (i.e., resetting) of the device would be done here:
+  // (This must stop the device's thread from calling "frameQueue()->enqueue()".)
   //%%% TO BE WRITTEN %%%
 
+  delete fFrameQueue; // this also gives back any frames that we haven't delivered
+
   --referenceCount;
   if (referenceCount == 0) {
     // Any global 'destruction' (i.e., resetting) of the device would be done here:
     //%%% TO BE WRITTEN %%%
-
-    // Reclaim our 'event trigger'
-    envir().taskScheduler().deleteEventTrigger(eventTriggerId);
-    eventTriggerId = 0;
   }
 }
 
@@ -85,12 +83,12 @@ void DeviceSource::doGetNextFrame() {
   }
 
   // If a new frame of data is immediately available to be delivered, then do this now:
-  if (0 /* a new frame of data is immediately available to be delivered*/ /*%%% TO BE WRITTEN %%%*/) {
+  if (fFrameQueue != NULL && !fFrameQueue->isEmpty()) {
     deliverFrame();
   }
 
   // No new data is immediately available to be delivered.  We don't do anything more here.
-  // Instead, our event trigger must be called (e.g., from a separate thread) when new data becomes available.
+  // Instead, "deliverFrame()" will be called (via our frame queue's event trigger) when new data becomes available.
 }
 
 void DeviceSource::deliverFrame0(void* clientData) {
@@ -121,33 +119,50 @@ void DeviceSource::deliverFrame() {
   // Note the code below.
 
   if (!isCurrentlyAwaitingData()) return; // we're not ready for the data yet
+  // (Any frames that we don't deliver now stay queued, until "doGetNextFrame()" is next called.)
 
-  u_int8_t* newFrameDataStart = (u_int8_t*)0xDEADBEEF; //%%% TO BE WRITTEN %%%
-  unsigned newFrameSize = 0; //%%% TO BE WRITTEN %%%
+  DeviceFrame frame;
+  if (!fFrameQueue->dequeue(frame)) return; // no frame is available yet
 
   // Deliver the data here:
-  if (newFrameSize > fMaxSize) {
+  if (frame.size > fMaxSize) {
     fFrameSize = fMaxSize;
-    fNumTruncatedBytes = newFrameSize - fMaxSize;
+    fNumTruncatedBytes = frame.size - fMaxSize;
   } else {
-    fFrameSize = newFrameSize;
+    fFrameSize = frame.size;
   }
-  gettimeofday(&fPresentationTime, NULL); // If you have a more accurate time - e.g., from an encoder - then use that instead.
-  // If the device is *not* a 'live source' (e.g., it comes instead from a file or buffer), then set "fDurationInMicroseconds" here.
-  memmove(fTo, newFrameDataStart, fFrameSize);
+  fPresentationTime = frame.presentationTime; // the encoder's time, if it gave one; otherwise, the time when it was queued
+  // If the device is *not* a 'live source' (e.g., it comes instead from a file or buffer), then the
+  // producer should set "durationInMicroseconds" in each frame:
+  fDurationInMicroseconds = frame.durationInMicroseconds;
+  memmove(fTo, frame.data, fFrameSize);
+  fFrameQueue->release(frame); // the device can now reuse its buffer
 
   // After delivering the data, inform the reader that it is now available:
   FramedSource::afterGetting(this);
 }
 
+void DeviceSource::releaseFrame(void* /*clientData*/, unsigned char* /*data*/, void* /*bufferId*/) {
+  // This function is called when we've finished with a frame's buffer (or if the frame had to
+  // be dropped, because the event loop isn't keeping up).  Give the buffer back to the device here.
+  // (If the frame was dropped, then this is called from the device's thread.)
+  //%%% TO BE WRITTEN %%%
+}
+
 
 // The following code would be called to signal that a new frame of data has become available.
 // This (unlike other "LIVE555 Streaming Media" library code) may be called from a separate thread.
 void signalNewFrameData() {
-  TaskScheduler* ourScheduler = NULL; //%%% TO BE WRITTEN %%%
-  DeviceSource* ourDevice  = NULL; //%%% TO BE WRITTEN %%%
+  DeviceSource* ourDevice = NULL; //%%% TO BE WRITTEN %%%
+
+  DeviceFrame frame;
+  frame.data = NULL; //%%% TO BE WRITTEN %%%
+  frame.size = 0; //%%% TO BE WRITTEN %%%
+  frame.presentationTime.tv_sec = frame.presentationTime.tv_usec = 0; // If you have a more accurate time - e.g., from an encoder - then use that instead.
+  frame.durationInMicroseconds = 0;
+  frame.bufferId = NULL; //%%% TO BE WRITTEN %%%
 
-  if (ourScheduler != NULL) { // sanity check
-    ourScheduler->triggerEvent(DeviceSource::eventTriggerId, ourDevice);
+  if (ourDevice != NULL && ourDevice->frameQueue() != NULL) { // sanity check
+    ourDevice->frameQueue()->enqueue(frame); // (if this returns False, the frame was dropped)
   }
 }
@@ -98,14 +98,24 @@ char const* Authenticator::computeDigestResponse(char const* cmd,
     strncpy(ha1Buf, password(), 32);
     ha1Buf[32] = '\0'; // just in case
   } else {
-    unsigned const ha1DataLen = strlen(username()) + 1
-      + strlen(realm()) + 1 + strlen(password());
-    unsigned char* ha1Data = new unsigned char[ha1DataLen+1];
-    sprintf((char*)ha1Data, "%s:%s:%s", username(), realm(), password());
-    our_MD5Data(ha1Data, ha1DataLen, ha1Buf);
-    delete[] ha1Data;
+    computeHA1(username(), realm(), password(), ha1Buf);
   }
 
+  return computeDigestResponse(ha1Buf, nonce(), cmd, url);
+}
+
+void Authenticator::computeHA1(char const* username, char const* realm,
+			       char const* password, char* resultBuf) {
+  unsigned const ha1DataLen = strlen(username) + 1
+    + strlen(realm) + 1 + strlen(password);
+  unsigned char* ha1Data = new unsigned char[ha1DataLen+1];
+  sprintf((char*)ha1Data, "%s:%s:%s", username, realm, password);
+  our_MD5Data(ha1Data, ha1DataLen, resultBuf);
+  delete[] ha1Data;
+}
+
+char const* Authenticator::computeDigestResponse(char const* ha1, char const* nonce,
+						 char const* cmd, char const* url) {
   unsigned const ha2DataLen = strlen(cmd) + 1 + strlen(url);
   unsigned char* ha2Data = new unsigned char[ha2DataLen+1];
   sprintf((char*)ha2Data, "%s:%s", cmd, url);
@@ -114,10 +124,10 @@ char const* Authenticator::computeDigestResponse(char const* cmd,
   delete[] ha2Data;
 
   unsigned const digestDataLen
-    = 32 + 1 + strlen(nonce()) + 1 + 32;
+    = 32 + 1 + strlen(nonce) + 1 + 32;
   unsigned char* digestData = new unsigned char[digestDataLen+1];
-  sprintf((char*)digestData, "%s:%s:%s",
-          ha1Buf, nonce(), ha2Buf);
+  sprintf((char*)digestData, "%.32s:%s:%s",
+          ha1, nonce, ha2Buf);
   char const* result = our_MD5Data(digestData, digestDataLen, NULL);
   delete[] digestData;
   return result;
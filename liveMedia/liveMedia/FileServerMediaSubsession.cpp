@@ -32,3 +32,7 @@ FileServerMediaSubsession
 FileServerMediaSubsession::~FileServerMediaSubsession() {
   delete[] (char*)fFileName;
 }
+
+char const* FileServerMediaSubsession::sdpCacheFileName() const {
+  return fFileName;
+}
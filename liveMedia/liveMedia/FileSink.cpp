@@ -25,12 +25,22 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "FileSink.hh"
 #include "GroupsockHelper.hh"
 #include "OutputFile.hh"
+#include "AsyncFileWriter.hh"
+#if !defined(__WIN32__) && !defined(_WIN32)
+#include <sys/stat.h>
+#endif
 
 ////////// FileSink //////////
 
+// Enough to ride out a disk that stops responding for a couple of seconds while we're
+// recording a high bit-rate video stream, while not leaving a low bit-rate (e.g., audio)
+// stream's data in memory for long:
+unsigned FileSink::writeBehindBufferSize = 256*1024;
+unsigned FileSink::writeBehindNumBuffers = 16;
+
 FileSink::FileSink(UsageEnvironment& env, FILE* fid, unsigned bufferSize,
 		   char const* perFrameFileNamePrefix)
-  : MediaSink(env), fOutFid(fid), fBufferSize(bufferSize) {
+  : MediaSink(env), fOutFid(fid), fOutput(NULL), fBufferSize(bufferSize) {
   fBuffer = new unsigned char[bufferSize];
   if (perFrameFileNamePrefix != NULL) {
     fPerFrameFileNamePrefix = strDup(perFrameFileNamePrefix);
@@ -39,9 +49,20 @@ FileSink::FileSink(UsageEnvironment& env, FILE* fid, unsigned bufferSize,
     fPerFrameFileNamePrefix = NULL;
     fPerFrameFileNameBuffer = NULL;
   }
+
+#if !defined(__WIN32__) && !defined(_WIN32)
+  // Don't write behind to a pipe (e.g., "stdout"), whose reader would want each frame
+  // as soon as we have it:
+  struct stat sb;
+  if (fOutFid != NULL && writeBehindNumBuffers > 0
+      && fstat(fileno(fOutFid), &sb) == 0 && S_ISREG(sb.st_mode)) {
+    fOutput = new AsyncFileWriter(fOutFid, writeBehindBufferSize, writeBehindNumBuffers);
+  }
+#endif
 }
 
 FileSink::~FileSink() {
+  delete fOutput; // first, so that all of our data gets written
   delete[] fPerFrameFileNameBuffer;
   delete[] fPerFrameFileNamePrefix;
   delete[] fBuffer;
@@ -108,7 +129,9 @@ void FileSink::addData(unsigned char const* data, unsigned dataSize,
 
   if (!packetIsLost)
 #endif
-  if (fOutFid != NULL && data != NULL) {
+  if (fOutput != NULL && data != NULL) {
+    fOutput->write(data, dataSize);
+  } else if (fOutFid != NULL && data != NULL) {
     fwrite(data, 1, dataSize, fOutFid);
   }
 }
@@ -117,7 +140,8 @@ void FileSink::afterGettingFrame1(unsigned frameSize,
 				  struct timeval presentationTime) {
   addData(fBuffer, frameSize, presentationTime);
 
-  if (fOutFid == NULL || fflush(fOutFid) == EOF) {
+  // (If we're writing behind, we'll learn of a write error only some time later.)
+  if (fOutFid == NULL || (fOutput != NULL ? fOutput->hadError() : fflush(fOutFid) == EOF)) {
     // The output file has closed.  Handle this the same way as if the
     // input source had closed:
     onSourceClosure(this);
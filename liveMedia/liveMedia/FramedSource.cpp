@@ -44,7 +44,7 @@ static void print_trace()
 ////////// FramedSource //////////
 
 FramedSource::FramedSource(UsageEnvironment& env)
-  : MediaSource(env),
+  : MediaSource(env), fFrameReference(NULL),
     fAfterGettingFunc(NULL), fAfterGettingClientData(NULL),
     fOnCloseFunc(NULL), fOnCloseClientData(NULL),
     fIsCurrentlyAwaitingData(False) {
@@ -90,6 +90,7 @@ void FramedSource::getNextFrame(unsigned char* to, unsigned maxSize,
   fMaxSize = maxSize;
   fNumTruncatedBytes = 0; // by default; could be changed by doGetNextFrame()
   fDurationInMicroseconds = 0; // by default; could be changed by doGetNextFrame()
+  fFrameReference = to; // by default; could be changed by doGetNextFrame()
   fAfterGettingFunc = afterGettingFunc;
   fAfterGettingClientData = afterGettingClientData;
   fOnCloseFunc = onCloseFunc;
@@ -138,3 +139,8 @@ unsigned FramedSource::maxFrameSize() const {
   // By default, this source has no maximum frame size.
   return 0;
 }
+
+Boolean FramedSource::canDeliverFrameReferences() const {
+  // By default, this source always copies each frame into the reader's buffer.
+  return False;
+}
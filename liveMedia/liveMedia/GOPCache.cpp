@@ -0,0 +1,80 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A cache of the RTP packets that a (shared) "RTPSink" has most recently sent,
+// going back to the last 'random access point'.
+// Implementation
+
+#include "GOPCache.hh"
+#include <string.h>
+
+// Packets are usually near the maximum size, but allow for small ones (e.g., a H.264
+// SPS or PPS, or a Transport Stream packet that's sent on its own) as well:
+#define MIN_AVERAGE_PACKET_SIZE 64
+
+GOPCache::GOPCache(unsigned maxCacheSize)
+  : fBufferSize(maxCacheSize), fBytesUsed(0), fNumPackets(0), fIsValid(False) {
+  fBuffer = new unsigned char[fBufferSize];
+  fMaxNumPackets = fBufferSize/MIN_AVERAGE_PACKET_SIZE + 1;
+  fPackets = new unsigned char*[fMaxNumPackets];
+  fPacketSizes = new unsigned[fMaxNumPackets];
+}
+
+GOPCache::~GOPCache() {
+  delete[] fPacketSizes;
+  delete[] fPackets;
+  delete[] fBuffer;
+}
+
+void GOPCache::reset() {
+  fBytesUsed = fNumPackets = 0;
+  fIsValid = False;
+}
+
+void GOPCache::addPacket(unsigned char const* packet, unsigned packetSize,
+			 Boolean isRandomAccessPoint) {
+  if (isRandomAccessPoint) {
+    // Start a new group of packets:
+    fBytesUsed = fNumPackets = 0;
+    fIsValid = True;
+  } else if (!fIsValid) {
+    return; // there's no point in holding packets that can't be decoded on their own
+  }
+
+  if (fBytesUsed + packetSize > fBufferSize || fNumPackets >= fMaxNumPackets) {
+    // This group of packets is too big for us.  Give up on it:
+    reset();
+    return;
+  }
+
+  fPackets[fNumPackets] = &fBuffer[fBytesUsed];
+  fPacketSizes[fNumPackets] = packetSize;
+  memmove(fPackets[fNumPackets], packet, packetSize);
+  fBytesUsed += packetSize;
+  ++fNumPackets;
+}
+
+unsigned short GOPCache::firstSeqNo() const {
+  if (fNumPackets == 0 || fPacketSizes[0] < 12) return 0;
+  return (fPackets[0][2]<<8)|fPackets[0][3];
+}
+
+u_int32_t GOPCache::firstTimestamp() const {
+  if (fNumPackets == 0 || fPacketSizes[0] < 12) return 0;
+  unsigned char const* p = fPackets[0];
+  return (p[4]<<24)|(p[5]<<16)|(p[6]<<8)|p[7];
+}
@@ -28,7 +28,8 @@ H264VideoRTPSink
 ::H264VideoRTPSink(UsageEnvironment& env, Groupsock* RTPgs,
 		   unsigned char rtpPayloadFormat)
   : VideoRTPSink(env, RTPgs, rtpPayloadFormat, 90000, "H264"),
-    fOurFragmenter(NULL), fFmtpSDPLine(NULL) {
+    fOurFragmenter(NULL), fFmtpSDPLine(NULL),
+    fNextFragmentStartsAccessUnit(True), fCurAccessUnitIsRandomAccessPoint(False) {
 }
 
 H264VideoRTPSink::~H264VideoRTPSink() {
@@ -69,6 +70,7 @@ void H264VideoRTPSink::stopPlaying() {
   // Then, close our 'fragmenter' object:
   Medium::close(fOurFragmenter); fOurFragmenter = NULL;
   fSource = NULL;
+  fNextFragmentStartsAccessUnit = True;
 }
 
 void H264VideoRTPSink::doSpecialFrameHandling(unsigned /*fragmentationOffset*/,
@@ -77,17 +79,12 @@ void H264VideoRTPSink::doSpecialFrameHandling(unsigned /*fragmentationOffset*/,
 					      struct timeval frameTimestamp,
 					      unsigned /*numRemainingBytes*/) {
   // Set the RTP 'M' (marker) bit iff
-  // 1/ The most recently delivered fragment was the end of (or the only fragment of) an NAL unit, and
+  // 1/ The most recently delivered fragment was the end of (or the only fragment of) an NAL unit
+  //    (or the end of a STAP-A), and
   // 2/ This NAL unit was the last NAL unit of an 'access unit' (i.e. video frame).
-  if (fOurFragmenter != NULL) {
-    H264VideoStreamFramer* framerSource
-      = (H264VideoStreamFramer*)(fOurFragmenter->inputSource());
-    // This relies on our fragmenter's source being a "H264VideoStreamFramer".
-    if (fOurFragmenter->lastFragmentCompletedNALUnit()
-	&& framerSource != NULL && framerSource->pictureEndMarker()) {
-      setMarkerBit();
-      framerSource->pictureEndMarker() = False;
-    }
+  // (Our fragmenter keeps track of this, using our "H264VideoStreamFramer" source.)
+  if (fOurFragmenter != NULL && fOurFragmenter->lastFragmentCompletedAccessUnit()) {
+    setMarkerBit();
   }
 
   setTimestamp(frameTimestamp);
@@ -99,6 +96,39 @@ Boolean H264VideoRTPSink
   return False;
 }
 
+static Boolean isRandomAccessNALUnitType(u_int8_t nal_unit_type) {
+  return nal_unit_type == 5 /*IDR slice*/ || nal_unit_type == 7 /*SPS*/ || nal_unit_type == 8 /*PPS*/;
+}
+
+Boolean H264VideoRTPSink::frameIsRandomAccessPoint(unsigned char const* frameStart,
+						   unsigned numBytesInFrame) {
+  // Our 'frames' are the packet payloads that our fragmenter delivers: a single NAL unit,
+  // a STAP-A (of several NAL units), or a FU-A (fragment of a NAL unit).  The first of
+  // these to carry a SPS, PPS or IDR slice within an access unit is a random access point:
+  if (fNextFragmentStartsAccessUnit) fCurAccessUnitIsRandomAccessPoint = False;
+  fNextFragmentStartsAccessUnit
+    = fOurFragmenter != NULL && fOurFragmenter->lastFragmentCompletedAccessUnit();
+  if (fCurAccessUnitIsRandomAccessPoint || numBytesInFrame < 1) return False;
+
+  Boolean isRandomAccess = False;
+  u_int8_t const nal_unit_type = frameStart[0]&0x1F;
+  if (nal_unit_type == 24) { // STAP-A: each NAL unit is preceded by a 2-byte size
+    for (unsigned i = 1; i + 2 < numBytesInFrame; ) {
+      unsigned nalUnitSize = (frameStart[i]<<8)|frameStart[i+1];
+      if (isRandomAccessNALUnitType(frameStart[i+2]&0x1F)) { isRandomAccess = True; break; }
+      i += 2 + nalUnitSize;
+    }
+  } else if (nal_unit_type == 28) { // FU-A: only the first fragment counts
+    isRandomAccess = numBytesInFrame >= 2 && (frameStart[1]&0x80) != 0
+      && isRandomAccessNALUnitType(frameStart[1]&0x1F);
+  } else {
+    isRandomAccess = isRandomAccessNALUnitType(nal_unit_type);
+  }
+
+  if (isRandomAccess) fCurAccessUnitIsRandomAccessPoint = True;
+  return isRandomAccess;
+}
+
 char const* H264VideoRTPSink::auxSDPLine() {
   // Generate a new "a=fmtp:" line each time, using parameters from
   // our framer source (in case they've changed since the last time that
@@ -145,15 +175,31 @@ char const* H264VideoRTPSink::auxSDPLine() {
 
 ////////// H264FUAFragmenter implementation //////////
 
+// Room in front of each group of NAL units, for a STAP-A NAL header and a
+// 2-byte NAL unit size field:
+#define NAL_UNIT_HEADROOM 3
+#define STAP_A_NAL_TYPE 24
+#define FU_A_NAL_TYPE 28
+
 H264FUAFragmenter::H264FUAFragmenter(UsageEnvironment& env,
 				     FramedSource* inputSource,
 				     unsigned inputBufferMax,
 				     unsigned maxOutputPacketSize)
   : FramedFilter(env, inputSource),
-    fInputBufferSize(inputBufferMax+1), fMaxOutputPacketSize(maxOutputPacketSize),
-    fNumValidDataBytes(1), fCurDataOffset(1), fSaveNumTruncatedBytes(0),
-    fLastFragmentCompletedNALUnit(True) {
+    // Our buffer must also be able to hold a (packet-sized) group of small NAL units,
+    // in front of a maximum-sized one:
+    fInputBufferSize(NAL_UNIT_HEADROOM + maxOutputPacketSize + 2 + inputBufferMax),
+    fMaxOutputPacketSize(maxOutputPacketSize),
+    fNumValidDataBytes(NAL_UNIT_HEADROOM), fReadOffset(NAL_UNIT_HEADROOM),
+    fNumNALUnits(0), fCurNALUnitOffset(NAL_UNIT_HEADROOM), fCurNALUnitSize(0),
+    fCurDataOffset(NAL_UNIT_HEADROOM), fAggregatedSize(0),
+    fSaveNumTruncatedBytes(0), fSaveDurationInMicroseconds(0), fGroupEndsAccessUnit(False),
+    fHavePendingNALUnit(False), fPendingNALUnitOffset(0), fPendingNALUnitSize(0),
+    fPendingDurationInMicroseconds(0), fPendingNumTruncatedBytes(0),
+    fPendingEndsAccessUnit(False),
+    fLastFragmentCompletedNALUnit(True), fLastFragmentCompletedAccessUnit(False) {
   fInputBuffer = new unsigned char[fInputBufferSize];
+  fPendingPresentationTime.tv_sec = fPendingPresentationTime.tv_usec = 0;
 }
 
 H264FUAFragmenter::~H264FUAFragmenter() {
@@ -162,77 +208,25 @@ H264FUAFragmenter::~H264FUAFragmenter() {
 }
 
 void H264FUAFragmenter::doGetNextFrame() {
-  if (fNumValidDataBytes == 1) {
-    // We have no NAL unit data currently in the buffer.  Read a new one:
-    fInputSource->getNextFrame(&fInputBuffer[1], fInputBufferSize - 1,
-			       afterGettingFrame, this,
-			       FramedSource::handleClosure, this);
-  } else {
-    // We have NAL unit data in the buffer.  There are three cases to consider:
-    // 1. There is a new NAL unit in the buffer, and it's small enough to deliver
-    //    to the RTP sink (as is).
-    // 2. There is a new NAL unit in the buffer, but it's too large to deliver to
-    //    the RTP sink in its entirety.  Deliver the first fragment of this data,
-    //    as a FU-A packet, with one extra preceding header byte.
-    // 3. There is a NAL unit in the buffer, and we've already delivered some
-    //    fragment(s) of this.  Deliver the next fragment of this data,
-    //    as a FU-A packet, with two extra preceding header bytes.
-
-    if (fMaxSize < fMaxOutputPacketSize) { // shouldn't happen
-      envir() << "H264FUAFragmenter::doGetNextFrame(): fMaxSize ("
-	      << fMaxSize << ") is smaller than expected\n";
+  if (fNumNALUnits == 0) {
+    // We have no NAL unit data left to deliver.  Use the NAL unit that we read
+    // last time (but couldn't aggregate), if any; otherwise, read a new one:
+    if (fHavePendingNALUnit) {
+      takePendingNALUnit();
     } else {
-      fMaxSize = fMaxOutputPacketSize;
-    }
-
-    fLastFragmentCompletedNALUnit = True; // by default
-    if (fCurDataOffset == 1) { // case 1 or 2
-      if (fNumValidDataBytes - 1 <= fMaxSize) { // case 1
-	memmove(fTo, &fInputBuffer[1], fNumValidDataBytes - 1);
-	fFrameSize = fNumValidDataBytes - 1;
-	fCurDataOffset = fNumValidDataBytes;
-      } else { // case 2
-	// We need to send the NAL unit data as FU-A packets.  Deliver the first
-	// packet now.  Note that we add FU indicator and FU header bytes to the front
-	// of the packet (reusing the existing NAL header byte for the FU header).
-	fInputBuffer[0] = (fInputBuffer[1] & 0xE0) | 28; // FU indicator
-	fInputBuffer[1] = 0x80 | (fInputBuffer[1] & 0x1F); // FU header (with S bit)
-	memmove(fTo, fInputBuffer, fMaxSize);
-	fFrameSize = fMaxSize;
-	fCurDataOffset += fMaxSize - 1;
-	fLastFragmentCompletedNALUnit = False;
-      }
-    } else { // case 3
-      // We are sending this NAL unit data as FU-A packets.  We've already sent the
-      // first packet (fragment).  Now, send the next fragment.  Note that we add
-      // FU indicator and FU header bytes to the front.  (We reuse these bytes that
-      // we already sent for the first fragment, but clear the S bit, and add the E
-      // bit if this is the last fragment.)
-      fInputBuffer[fCurDataOffset-2] = fInputBuffer[0]; // FU indicator
-      fInputBuffer[fCurDataOffset-1] = fInputBuffer[1]&~0x80; // FU header (no S bit)
-      unsigned numBytesToSend = 2 + fNumValidDataBytes - fCurDataOffset;
-      if (numBytesToSend > fMaxSize) {
-	// We can't send all of the remaining data this time:
-	numBytesToSend = fMaxSize;
-	fLastFragmentCompletedNALUnit = False;
-      } else {
-	// This is the last fragment:
-	fInputBuffer[fCurDataOffset-1] |= 0x40; // set the E bit in the FU header
-	fNumTruncatedBytes = fSaveNumTruncatedBytes;
-      }
-      memmove(fTo, &fInputBuffer[fCurDataOffset-2], numBytesToSend);
-      fFrameSize = numBytesToSend;
-      fCurDataOffset += numBytesToSend - 2;
-    }
-
-    if (fCurDataOffset >= fNumValidDataBytes) {
-      // We're done with this data.  Reset the pointers for receiving new data:
-      fNumValidDataBytes = fCurDataOffset = 1;
+      readNALUnit(NAL_UNIT_HEADROOM);
+      return;
     }
+  }
 
-    // Complete delivery to the client:
-    FramedSource::afterGetting(this);
+  // If the next NAL unit might fit into the same (STAP-A) packet as the one(s) that
+  // we already have, then read it first:
+  if (canAggregateAnotherNALUnit()) {
+    readNALUnit(fNumValidDataBytes + 2);
+    return;
   }
+
+  deliverPacket();
 }
 
 void H264FUAFragmenter::afterGettingFrame(void* clientData, unsigned frameSize,
@@ -248,11 +242,192 @@ void H264FUAFragmenter::afterGettingFrame1(unsigned frameSize,
 					   unsigned numTruncatedBytes,
 					   struct timeval presentationTime,
 					   unsigned durationInMicroseconds) {
-  fNumValidDataBytes += frameSize;
-  fSaveNumTruncatedBytes = numTruncatedBytes;
-  fPresentationTime = presentationTime;
-  fDurationInMicroseconds = durationInMicroseconds;
+  // Note whether this NAL unit ends an 'access unit' (so that its last packet gets the
+  // RTP 'M' bit).  Our source (a "H264VideoStreamFramer") tells us this:
+  Boolean endsAccessUnit = False;
+  if (fInputSource != NULL && fInputSource->isH264VideoStreamFramer()) {
+    H264VideoStreamFramer* framerSource = (H264VideoStreamFramer*)fInputSource;
+    endsAccessUnit = framerSource->pictureEndMarker();
+    framerSource->pictureEndMarker() = False;
+  }
+
+  // Record the NAL unit's size in front of it (as it would appear in a STAP-A):
+  fInputBuffer[fReadOffset-2] = (unsigned char)(frameSize>>8);
+  fInputBuffer[fReadOffset-1] = (unsigned char)frameSize;
+
+  if (fNumNALUnits == 0) {
+    // This NAL unit starts a new group:
+    fNumNALUnits = 1;
+    fCurNALUnitOffset = fCurDataOffset = fReadOffset;
+    fCurNALUnitSize = frameSize;
+    fNumValidDataBytes = fReadOffset + frameSize;
+    fAggregatedSize = 1 + 2 + frameSize;
+    fSaveNumTruncatedBytes = numTruncatedBytes;
+    fSaveDurationInMicroseconds = durationInMicroseconds;
+    fGroupEndsAccessUnit = endsAccessUnit;
+    fPresentationTime = presentationTime;
+  } else if (numTruncatedBytes == 0
+	     && presentationTime.tv_sec == fPresentationTime.tv_sec
+	     && presentationTime.tv_usec == fPresentationTime.tv_usec
+	     && fAggregatedSize + 2 + frameSize <= fMaxOutputPacketSize) {
+    // This NAL unit fits into the same STAP-A as the one(s) before it:
+    ++fNumNALUnits;
+    fNumValidDataBytes = fReadOffset + frameSize;
+    fAggregatedSize += 2 + frameSize;
+    fSaveDurationInMicroseconds += durationInMicroseconds;
+    fGroupEndsAccessUnit = endsAccessUnit;
+  } else {
+    // This NAL unit can't be aggregated with the current group, so deliver it later:
+    fHavePendingNALUnit = True;
+    fPendingNALUnitOffset = fReadOffset;
+    fPendingNALUnitSize = frameSize;
+    fPendingPresentationTime = presentationTime;
+    fPendingDurationInMicroseconds = durationInMicroseconds;
+    fPendingNumTruncatedBytes = numTruncatedBytes;
+    fPendingEndsAccessUnit = endsAccessUnit;
+  }
 
   // Deliver data to the client:
   doGetNextFrame();
 }
+
+void H264FUAFragmenter::handleInputClosure(void* clientData) {
+  H264FUAFragmenter* fragmenter = (H264FUAFragmenter*)clientData;
+  fragmenter->handleInputClosure1();
+}
+
+void H264FUAFragmenter::handleInputClosure1() {
+  if (fNumNALUnits == 0) {
+    // We have nothing left to deliver:
+    handleClosure(this);
+    return;
+  }
+
+  // Our source closed while we were waiting for a NAL unit to aggregate.
+  // Deliver what we already have.  (We'll notice the closure again next time.)
+  fGroupEndsAccessUnit = True; // stops any further aggregation
+  deliverPacket();
+}
+
+void H264FUAFragmenter::readNALUnit(unsigned offset) {
+  fReadOffset = offset;
+  fInputSource->getNextFrame(&fInputBuffer[offset], fInputBufferSize - offset,
+			     afterGettingFrame, this,
+			     handleInputClosure, this);
+}
+
+Boolean H264FUAFragmenter::canAggregateAnotherNALUnit() const {
+  return fNumNALUnits > 0 && !fHavePendingNALUnit && !fGroupEndsAccessUnit
+    && fSaveNumTruncatedBytes == 0
+    && fCurDataOffset == fCurNALUnitOffset // we haven't started sending FU-As
+    && fAggregatedSize + 2 + 1 <= fMaxOutputPacketSize // there's room for a 1-byte NAL unit
+    // and a maximum-sized NAL unit would still fit into our buffer:
+    && fNumValidDataBytes <= NAL_UNIT_HEADROOM + fMaxOutputPacketSize;
+}
+
+void H264FUAFragmenter::takePendingNALUnit() {
+  unsigned offset = fPendingNALUnitOffset;
+  if (fPendingNALUnitSize <= fMaxOutputPacketSize && offset != NAL_UNIT_HEADROOM) {
+    // Move this (small) NAL unit - and its size field - to the front of our buffer,
+    // so that we can aggregate further NAL units after it:
+    memmove(&fInputBuffer[NAL_UNIT_HEADROOM-2], &fInputBuffer[offset-2], 2 + fPendingNALUnitSize);
+    offset = NAL_UNIT_HEADROOM;
+  }
+  // (A large NAL unit is sent - as FU-As - from where it is.)
+  fHavePendingNALUnit = False;
+
+  fNumNALUnits = 1;
+  fCurNALUnitOffset = fCurDataOffset = offset;
+  fCurNALUnitSize = fPendingNALUnitSize;
+  fNumValidDataBytes = offset + fPendingNALUnitSize;
+  fAggregatedSize = 1 + 2 + fPendingNALUnitSize;
+  fSaveNumTruncatedBytes = fPendingNumTruncatedBytes;
+  fSaveDurationInMicroseconds = fPendingDurationInMicroseconds;
+  fGroupEndsAccessUnit = fPendingEndsAccessUnit;
+  fPresentationTime = fPendingPresentationTime;
+}
+
+void H264FUAFragmenter::deliverPacket() {
+  // There are three kinds of packet that we can deliver:
+  // 1. A STAP-A, containing all of the NAL units in the current group (if there's
+  //    more than one, and they all fit).
+  // 2. A single NAL unit - the first one in the group - that fits in the packet (as is).
+  // 3. A FU-A, containing the next fragment of a NAL unit that's too large to fit.
+  // In each case, we copy the data directly from our buffer into the sink's packet.
+
+  if (fMaxSize < fMaxOutputPacketSize) { // shouldn't happen
+    envir() << "H264FUAFragmenter::doGetNextFrame(): fMaxSize ("
+	    << fMaxSize << ") is smaller than expected\n";
+  } else {
+    fMaxSize = fMaxOutputPacketSize;
+  }
+
+  fLastFragmentCompletedNALUnit = True; // by default
+  if (fNumNALUnits > 1 && fCurDataOffset == fCurNALUnitOffset && fAggregatedSize <= fMaxSize) { // case 1
+    // The STAP-A's NAL header has the highest 'NRI', and the OR of the 'F' bits,
+    // of the aggregated NAL units:
+    u_int8_t nalHeader = 0;
+    unsigned offset = fCurNALUnitOffset;
+    unsigned size = fCurNALUnitSize;
+    for (unsigned i = 0; i < fNumNALUnits; ++i) {
+      u_int8_t const h = fInputBuffer[offset];
+      nalHeader |= h&0x80;
+      if ((h&0x60) > (nalHeader&0x60)) nalHeader = (nalHeader&~0x60)|(h&0x60);
+      offset += size + 2;
+      if (i+1 < fNumNALUnits) size = nalUnitSize(offset);
+    }
+    fInputBuffer[fCurNALUnitOffset-3] = nalHeader|STAP_A_NAL_TYPE;
+
+    memmove(fTo, &fInputBuffer[fCurNALUnitOffset-3], fAggregatedSize);
+    fFrameSize = fAggregatedSize;
+    fNumNALUnits = 0;
+  } else {
+    unsigned const nalUnitEnd = fCurNALUnitOffset + fCurNALUnitSize;
+    if (fCurDataOffset == fCurNALUnitOffset && fCurNALUnitSize <= fMaxSize) { // case 2
+      memmove(fTo, &fInputBuffer[fCurNALUnitOffset], fCurNALUnitSize);
+      fFrameSize = fCurNALUnitSize;
+      fCurDataOffset = nalUnitEnd;
+    } else { // case 3
+      // Each FU-A begins with a FU indicator and a FU header, both derived from the
+      // NAL unit's header byte (which is not itself sent):
+      u_int8_t const nalHeader = fInputBuffer[fCurNALUnitOffset];
+      fTo[0] = (nalHeader&0xE0)|FU_A_NAL_TYPE; // FU indicator
+      fTo[1] = nalHeader&0x1F; // FU header
+      if (fCurDataOffset == fCurNALUnitOffset) {
+	// This is the first fragment:
+	fTo[1] |= 0x80; // set the S bit in the FU header
+	++fCurDataOffset;
+      }
+
+      unsigned numBytesToSend = nalUnitEnd - fCurDataOffset;
+      if (2 + numBytesToSend > fMaxSize) {
+	// We can't send all of the remaining data this time:
+	numBytesToSend = fMaxSize - 2;
+	fLastFragmentCompletedNALUnit = False;
+      } else {
+	// This is the last fragment:
+	fTo[1] |= 0x40; // set the E bit in the FU header
+      }
+      memmove(&fTo[2], &fInputBuffer[fCurDataOffset], numBytesToSend);
+      fFrameSize = 2 + numBytesToSend;
+      fCurDataOffset += numBytesToSend;
+    }
+
+    if (fLastFragmentCompletedNALUnit && --fNumNALUnits > 0) {
+      // Move on to the next NAL unit in the group.  (We get here only if a STAP-A
+      // wouldn't fit in this packet, which shouldn't happen.)
+      fAggregatedSize -= 2 + fCurNALUnitSize;
+      fCurNALUnitOffset = fCurDataOffset = nalUnitEnd + 2;
+      fCurNALUnitSize = nalUnitSize(fCurNALUnitOffset);
+    }
+  }
+
+  // The group's truncation count, duration and 'M' bit go with its last packet:
+  Boolean const groupIsComplete = fNumNALUnits == 0;
+  fNumTruncatedBytes = groupIsComplete ? fSaveNumTruncatedBytes : 0;
+  fDurationInMicroseconds = groupIsComplete ? fSaveDurationInMicroseconds : 0;
+  fLastFragmentCompletedAccessUnit = groupIsComplete && fGroupEndsAccessUnit;
+
+  // Complete delivery to the client:
+  FramedSource::afterGetting(this);
+}
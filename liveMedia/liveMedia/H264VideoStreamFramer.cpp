@@ -571,19 +571,13 @@ unsigned H264VideoStreamParser::parse() {
     u_int8_t firstByte = next4Bytes>>24;
     u_int8_t nal_ref_idc = (firstByte&0x60)>>5;
     u_int8_t nal_unit_type = firstByte&0x1F;
-    while (next4Bytes != 0x00000001 && (next4Bytes&0xFFFFFF00) != 0x00000100) {
-      // We save at least some of "next4Bytes".
-      if ((unsigned)(next4Bytes&0xFF) > 1) {
-        // Common case: 0x00000001 or 0x000001 definitely doesn't begin anywhere in "next4Bytes", so we save all of it:
-        save4Bytes(next4Bytes);
-	skipBytes(4);
-      } else {
-        // Save the first byte, and continue testing the rest:
-        saveByte(next4Bytes>>24);
-	skipBytes(1);
-      }
-      next4Bytes = test4Bytes();
+    unsigned numBytesInNALUnit = numBytesToNextStartCode();
+    if (numBytesInNALUnit > 0 && testByteAt(numBytesInNALUnit-1) == 0) {
+      // The start code is really 0x00000001, so its first 0 byte isn't part of this NAL unit:
+      --numBytesInNALUnit;
     }
+    saveBytes(numBytesInNALUnit);
+    next4Bytes = test4Bytes();
     // Assert: next4Bytes starts with 0x00000001 or 0x000001, and we've saved all previous bytes (forming a complete NAL unit).
     // Skip over these remaining bytes, up until the start of the next NAL unit:
     if (next4Bytes == 0x00000001) {
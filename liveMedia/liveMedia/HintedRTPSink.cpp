@@ -0,0 +1,155 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A RTP sink that sends the pre-packetized RTP packets of a hint track.
+// Implementation
+
+#include "HintedRTPSink.hh"
+#include "GOPCache.hh"
+#include "GroupsockHelper.hh"
+#include "TunnelEncaps.hh"
+
+static unsigned const rtpHeaderSize = 12;
+
+HintedRTPSink* HintedRTPSink::createNew(UsageEnvironment& env, Groupsock* RTPgs,
+					RTPHintTrackSource const& hintTrackSource) {
+  return new HintedRTPSink(env, RTPgs, hintTrackSource);
+}
+
+HintedRTPSink::HintedRTPSink(UsageEnvironment& env, Groupsock* RTPgs,
+			     RTPHintTrackSource const& hintTrackSource)
+  : RTPSink(env, RTPgs, hintTrackSource.rtpPayloadType(),
+	    hintTrackSource.rtpTimestampFrequency(), "hinted", 1),
+    fPacketSize(0), fIsFirstPacket(True), fRecordedTimestampBase(0), fTimestampBase(0) {
+  // Leave room for a tunnel encapsulation trailer, as "Groupsock::output()" requires:
+  fPacketBufferSize = hintTrackSource.maxPacketSize() + TunnelEncapsulationTrailerMaxSize;
+  fPacket = new unsigned char[fPacketBufferSize];
+}
+
+HintedRTPSink::~HintedRTPSink() {
+  delete[] fPacket;
+}
+
+Boolean HintedRTPSink::continuePlaying() {
+  fIsFirstPacket = True;
+  getNextPacket();
+  return True;
+}
+
+void HintedRTPSink::stopPlaying() {
+  envir().taskScheduler().unscheduleDelayedTask(nextTask());
+  MediaSink::stopPlaying();
+}
+
+void HintedRTPSink::getNextPacket() {
+  if (fSource == NULL) return;
+
+  fSource->getNextFrame(fPacket, fPacketBufferSize - TunnelEncapsulationTrailerMaxSize,
+			afterGettingPacket, this, ourHandleClosure, this);
+}
+
+void HintedRTPSink::afterGettingPacket(void* clientData, unsigned packetSize,
+				       unsigned /*numTruncatedBytes*/,
+				       struct timeval dueTime,
+				       unsigned /*durationInMicroseconds*/) {
+  HintedRTPSink* sink = (HintedRTPSink*)clientData;
+  sink->afterGettingPacket1(packetSize, dueTime);
+}
+
+void HintedRTPSink::afterGettingPacket1(unsigned packetSize, struct timeval dueTime) {
+  struct timeval timeNow;
+  gettimeofday(&timeNow, NULL);
+
+  fPacketSize = packetSize;
+  if (fPacketSize < rtpHeaderSize) {
+    fPacketSize = 0; // we can't use this packet
+  } else {
+    u_int32_t const recordedTimestamp
+      = (fPacket[4]<<24) | (fPacket[5]<<16) | (fPacket[6]<<8) | fPacket[7];
+    if (fIsFirstPacket) {
+      // Record the fact that we're starting (or resuming) to play now.  Our timestamps
+      // begin with the one that corresponds to this time (or with the one that was
+      // previously preset), and keep the recorded spacing after that:
+      fStartTime = timeNow;
+      fStartDueTime = dueTime;
+      fRecordedTimestampBase = recordedTimestamp;
+      fTimestampBase = convertToRTPTimestamp(timeNow);
+      fIsFirstPacket = False;
+    }
+    fCurrentTimestamp = fTimestampBase + (recordedTimestamp - fRecordedTimestampBase);
+
+    // Rewrite the RTP header's sequence number, timestamp and SSRC to be our own:
+    fPacket[2] = fSeqNo>>8; fPacket[3] = (unsigned char)fSeqNo;
+    fPacket[4] = fCurrentTimestamp>>24; fPacket[5] = fCurrentTimestamp>>16;
+    fPacket[6] = fCurrentTimestamp>>8; fPacket[7] = (unsigned char)fCurrentTimestamp;
+    u_int32_t const ssrc = SSRC();
+    fPacket[8] = ssrc>>24; fPacket[9] = ssrc>>16; fPacket[10] = ssrc>>8; fPacket[11] = (unsigned char)ssrc;
+  }
+  addProcessingTimeSince(timeNow);
+
+  // Send the packet at the time that it's due (relative to when we started):
+  int64_t uSecondsToGo
+    = (fStartTime.tv_sec - timeNow.tv_sec + dueTime.tv_sec - fStartDueTime.tv_sec)*(int64_t)1000000
+    + (fStartTime.tv_usec - timeNow.tv_usec + dueTime.tv_usec - fStartDueTime.tv_usec);
+  if (uSecondsToGo < 0) uSecondsToGo = 0;
+
+  nextTask() = envir().taskScheduler().scheduleDelayedTask(uSecondsToGo, (TaskFunc*)sendNext, this);
+}
+
+// The following is called after each delay between packet sends:
+#define TCP_BACKLOG_RETRY_USECS 5000
+
+void HintedRTPSink::sendNext(void* clientData) {
+  HintedRTPSink* sink = (HintedRTPSink*)clientData;
+  if (sink->fRTPInterface.tcpOutputIsBacklogged()) {
+    // A RTP-over-TCP client isn't keeping up, so wait (rather than queue more output for it):
+    ++sink->fNumTCPBacklogWaits;
+    sink->nextTask() = sink->envir().taskScheduler()
+      .scheduleDelayedTask(TCP_BACKLOG_RETRY_USECS, (TaskFunc*)sendNext, sink);
+    return;
+  }
+  sink->nextTask() = NULL;
+  sink->sendPacket();
+  sink->getNextPacket();
+}
+
+void HintedRTPSink::sendPacket() {
+  if (fPacketSize == 0) return;
+
+  struct timeval startTime;
+  gettimeofday(&startTime, NULL);
+
+  fRTPInterface.sendPacket(fPacket, fPacketSize);
+  noteSendLatency(fCurrentTimestamp, startTime);
+  if (fGOPCache != NULL) {
+    fGOPCache->addPacket(fPacket, fPacketSize,
+			 ((RTPHintTrackSource*)fSource)->lastPacketWasRandomAccessPoint());
+  }
+  ++fPacketCount;
+  fTotalOctetCount += fPacketSize;
+  fNumBytesSent += fPacketSize;
+  fOctetCount += fPacketSize - rtpHeaderSize;
+  ++fSeqNo; // for next time
+  fPacketSize = 0;
+
+  addProcessingTimeSince(startTime);
+}
+
+void HintedRTPSink::ourHandleClosure(void* clientData) {
+  HintedRTPSink* sink = (HintedRTPSink*)clientData;
+  onSourceClosure(sink);
+}
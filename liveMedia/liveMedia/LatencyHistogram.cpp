@@ -0,0 +1,91 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A fixed-size histogram of latencies (in microseconds), from which percentiles
+// can be read.
+// Implementation
+
+#include "LatencyHistogram.hh"
+
+// Values below 16 each have their own bucket.  Above that, each power-of-2 range
+// [2^e, 2^(e+1)) is split into 8 equal-sized buckets:
+static unsigned const numExactBuckets = 16;
+static unsigned const subBucketBits = 3;
+
+LatencyHistogram::LatencyHistogram() {
+  reset();
+}
+
+void LatencyHistogram::reset() {
+  fNumSamples = fNumNegativeSamples = 0;
+  fMinUSecs = fMaxUSecs = 0;
+  fTotalUSecs = 0.0;
+  for (unsigned i = 0; i < numBuckets; ++i) fBuckets[i] = 0;
+}
+
+unsigned LatencyHistogram::bucketFor(unsigned uSeconds) {
+  if (uSeconds < numExactBuckets) return uSeconds;
+
+  unsigned e = 0; // the index of the highest 1 bit
+  for (unsigned v = uSeconds; v > 1; v >>= 1) ++e;
+  unsigned subBucket = (uSeconds>>(e-subBucketBits))&((1<<subBucketBits)-1);
+  return numExactBuckets + ((e-4)<<subBucketBits) + subBucket;
+}
+
+unsigned LatencyHistogram::bucketLowerBoundUSecs(unsigned bucket) {
+  if (bucket < numExactBuckets) return bucket;
+
+  bucket -= numExactBuckets;
+  unsigned e = (bucket>>subBucketBits) + 4;
+  unsigned subBucket = bucket&((1<<subBucketBits)-1);
+  return ((1<<subBucketBits) + subBucket)<<(e-subBucketBits);
+}
+
+void LatencyHistogram::record(int uSeconds) {
+  if (fNumSamples == 0 || uSeconds < fMinUSecs) fMinUSecs = uSeconds;
+  if (fNumSamples == 0 || uSeconds > fMaxUSecs) fMaxUSecs = uSeconds;
+  ++fNumSamples;
+  fTotalUSecs += uSeconds;
+
+  if (uSeconds < 0) {
+    ++fNumNegativeSamples;
+    uSeconds = 0;
+  }
+  ++fBuckets[bucketFor((unsigned)uSeconds)];
+}
+
+int LatencyHistogram::percentileUSecs(double percent) const {
+  if (fNumSamples == 0) return 0;
+  if (percent <= 0.0) return fMinUSecs;
+  if (percent >= 100.0) return fMaxUSecs;
+
+  // Find the bucket that holds the sample of this rank:
+  double rank = (percent/100.0)*fNumSamples;
+  unsigned count = 0;
+  unsigned i;
+  for (i = 0; i < numBuckets-1; ++i) {
+    count += fBuckets[i];
+    if (count >= rank && count > 0) break;
+  }
+
+  // Use the top of this bucket, but no more than the largest sample that we've seen
+  // (nor less than the smallest):
+  int result = i == numBuckets-1 ? fMaxUSecs : (int)(bucketLowerBoundUSecs(i+1) - 1);
+  if (result > fMaxUSecs) result = fMaxUSecs;
+  if (result < fMinUSecs) result = fMinUSecs;
+  return result;
+}
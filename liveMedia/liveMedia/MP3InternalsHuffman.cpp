@@ -417,6 +417,121 @@ static int read_decoder_table(unsigned char* fi) {
   return n;
 }
 
+// To decode Huffman codes quickly, we also build - from each decoder tree - a
+// multi-bit lookup table, indexed by the next HUFF_LOOKUP_BITS bits of input.
+// Codes longer than this are decoded using a second-level 'subtable', indexed by
+// the bits that follow.  (The original, bit-by-bit tree decoder is still used for
+// codes that aren't in the table - i.e., errors - and, if
+// "VERIFY_FAST_HUFFMAN_DECODING" is defined, to check the table-driven decoder.)
+#define HUFF_LOOKUP_BITS 8
+#define MAX_HUFF_CODE_LENGTH 24 // much longer than any code in the MPEG audio tables
+
+struct huffLookupEntry {
+  unsigned value; // the decoded value ((x<<4)|y), or, for a subtable, its index
+  unsigned char length; // the number of code bits used at this level; 0 => not a valid code
+  unsigned char subtableBits; // if non-zero, "value" is the index of a subtable
+                              // that's indexed by this many more bits
+};
+
+static huffLookupEntry* rsf_lookup[HTN]; // the lookup table for each code table (or NULL)
+
+struct huffCode {
+  unsigned code, length, value;
+};
+
+// Follow one branch of a decoder tree, exactly as "rsf_huffman_decoder()" does:
+static unsigned nextTreePoint(struct huffcodetab const* h, unsigned point, unsigned bit) {
+  while (point < h->treelen && h->val[point][bit] >= MXOFF) point += h->val[point][bit];
+  if (point < h->treelen) point += h->val[point][bit];
+  return point;
+}
+
+// List all of the codes in a decoder tree (returning False if the tree looks invalid):
+static Boolean enumerateHuffmanCodes(struct huffcodetab const* h,
+				     unsigned point, unsigned code, unsigned length,
+				     huffCode* codes, unsigned& numCodes) {
+  if (point >= h->treelen || length > MAX_HUFF_CODE_LENGTH) return False;
+
+  if (h->val[point][0] == 0) { /* end of tree */
+    if (length == 0 || numCodes == h->treelen) return False;
+    codes[numCodes].code = code;
+    codes[numCodes].length = length;
+    codes[numCodes].value = h->val[point][1];
+    ++numCodes;
+    return True;
+  }
+
+  return enumerateHuffmanCodes(h, nextTreePoint(h, point, 0), code<<1, length+1, codes, numCodes)
+    && enumerateHuffmanCodes(h, nextTreePoint(h, point, 1), (code<<1)|1, length+1, codes, numCodes);
+}
+
+static huffLookupEntry* buildLookupTable(struct huffcodetab const* h) {
+  if (h->val == NULL || h->treelen == 0) return NULL; // no table needed
+
+  huffCode* codes = new huffCode[h->treelen];
+  unsigned numCodes = 0;
+  if (!enumerateHuffmanCodes(h, 0, 0, 0, codes, numCodes)) {
+    // We'll use only the tree decoder for this table:
+    delete[] codes;
+    return NULL;
+  }
+
+  // Figure out how big each subtable needs to be (to hold its longest code):
+  unsigned const firstLevelSize = 1<<HUFF_LOOKUP_BITS;
+  unsigned char subtableBits[firstLevelSize];
+  unsigned i, j;
+  for (i = 0; i < firstLevelSize; ++i) subtableBits[i] = 0;
+  for (j = 0; j < numCodes; ++j) {
+    unsigned const length = codes[j].length;
+    if (length <= HUFF_LOOKUP_BITS) continue;
+
+    unsigned const prefix = codes[j].code>>(length-HUFF_LOOKUP_BITS);
+    if (length-HUFF_LOOKUP_BITS > subtableBits[prefix]) subtableBits[prefix] = length-HUFF_LOOKUP_BITS;
+  }
+  unsigned tableSize = firstLevelSize;
+  for (i = 0; i < firstLevelSize; ++i) {
+    if (subtableBits[i] > 0) tableSize += 1<<subtableBits[i];
+  }
+
+  huffLookupEntry* table = new huffLookupEntry[tableSize];
+  for (i = 0; i < tableSize; ++i) {
+    table[i].value = 0; table[i].length = 0; table[i].subtableBits = 0;
+  }
+  unsigned nextSubtableIndex = firstLevelSize;
+  for (i = 0; i < firstLevelSize; ++i) {
+    if (subtableBits[i] == 0) continue;
+
+    table[i].value = nextSubtableIndex;
+    table[i].length = HUFF_LOOKUP_BITS;
+    table[i].subtableBits = subtableBits[i];
+    nextSubtableIndex += 1<<subtableBits[i];
+  }
+
+  // Then fill in each code's entries: all of those whose index begins with the code:
+  for (j = 0; j < numCodes; ++j) {
+    unsigned const length = codes[j].length;
+    unsigned firstIndex, numEntries, entryLength;
+    if (length <= HUFF_LOOKUP_BITS) {
+      firstIndex = codes[j].code<<(HUFF_LOOKUP_BITS-length);
+      numEntries = 1<<(HUFF_LOOKUP_BITS-length);
+      entryLength = length;
+    } else {
+      entryLength = length-HUFF_LOOKUP_BITS;
+      huffLookupEntry const& subtable = table[codes[j].code>>entryLength];
+      unsigned const restOfCode = codes[j].code&((1<<entryLength)-1);
+      firstIndex = subtable.value + (restOfCode<<(subtable.subtableBits-entryLength));
+      numEntries = 1<<(subtable.subtableBits-entryLength);
+    }
+    for (i = 0; i < numEntries; ++i) {
+      table[firstIndex+i].value = codes[j].value;
+      table[firstIndex+i].length = entryLength;
+    }
+  }
+
+  delete[] codes;
+  return table;
+}
+
 static void initialize_huffman() {
   static Boolean huffman_initialized = False;
 
@@ -428,6 +543,12 @@ static void initialize_huffman() {
 #endif
       abort();
       }
+
+   for (unsigned n = 0; n < HTN; ++n) {
+     int const ref = rsf_ht[n].ref;
+     rsf_lookup[n] = ref >= 0 && (unsigned)ref < n ? rsf_lookup[ref] // it shares this tree
+       : buildLookupTable(&rsf_ht[n]);
+   }
    huffman_initialized = True;
 }
 
@@ -534,9 +655,9 @@ static unsigned getScaleFactorsLength(MP3SideInfo::gr_info_s_t* gr,
                  : rsf_get_scale_factors_1(gr);
 }
 
-static int rsf_huffman_decoder(BitVector& bv,
-			       struct huffcodetab const* h,
-			       int* x, int* y, int* v, int* w); // forward
+static int fast_huffman_decoder(BitVector& bv,
+				struct huffcodetab const* h,
+				int* x, int* y, int* v, int* w); // forward
 
 void MP3HuffmanDecode(MP3SideInfo::gr_info_s_t* gr, int isMPEG2,
 		      unsigned char const* fromBasePtr,
@@ -579,7 +700,7 @@ void MP3HuffmanDecode(MP3SideInfo::gr_info_s_t* gr, int isMPEG2,
      }
 
      hei.allBitOffsets[i] = bv.curBitIndex();
-     rsf_huffman_decoder(bv, h, &x, &y, &v, &w);
+     fast_huffman_decoder(bv, h, &x, &y, &v, &w);
      if (hei.decodedValues != NULL) {
        // Record the decoded values:
        unsigned* ptr = &hei.decodedValues[4*i];
@@ -592,7 +713,7 @@ void MP3HuffmanDecode(MP3SideInfo::gr_info_s_t* gr, int isMPEG2,
    h = &rsf_ht[gr->count1table_select+32];
    while (bv.curBitIndex() < bv.totNumBits() &&  i < SSLIMIT*SBLIMIT) {
      hei.allBitOffsets[i] = bv.curBitIndex();
-     rsf_huffman_decoder(bv, h, &x, &y, &v, &w);
+     fast_huffman_decoder(bv, h, &x, &y, &v, &w);
      if (hei.decodedValues != NULL) {
        // Record the decoded values:
        unsigned* ptr = &hei.decodedValues[4*i];
@@ -608,6 +729,9 @@ void MP3HuffmanDecode(MP3SideInfo::gr_info_s_t* gr, int isMPEG2,
 HUFFBITS dmask = 1 << (SIZEOF_HUFFBITS*8-1);
 unsigned int hs = SIZEOF_HUFFBITS*8;
 
+static void rsf_huffman_signs(BitVector& bv, struct huffcodetab const* h,
+			      int* x, int* y, int* v, int* w); // forward
+
 /* do the huffman-decoding 						*/
 static int rsf_huffman_decoder(BitVector& bv,
 		struct huffcodetab const* h, // ptr to huffman code record
@@ -654,6 +778,13 @@ static int rsf_huffman_decoder(BitVector& bv,
     *y = ((h->ylen-1) << 1);
   }
 
+  rsf_huffman_signs(bv, h, x, y, v, w);
+  return error;
+}
+
+/* process the sign (and escape) bits that follow a decoded Huffman code */
+static void rsf_huffman_signs(BitVector& bv, struct huffcodetab const* h,
+			      int* x, int* y, int* v, int* w) {
   /* Process sign encodings for quadruples tables. */
 
   if (h->tablename[0] == '3'
@@ -687,7 +818,50 @@ static int rsf_huffman_decoder(BitVector& bv,
      if (*y)
         if (bv.get1Bit() == 1) *y = -*y;
   }
+}
+
+/* do the huffman-decoding, using our lookup table (if any) */
+static int fast_huffman_decoder(BitVector& bv,
+				struct huffcodetab const* h,
+				int* x, int* y, int* v, int* w) {
+#ifdef VERIFY_FAST_HUFFMAN_DECODING
+  BitVector bvCopy = bv;
+  int x1, y1, v1, w1;
+  int error1 = rsf_huffman_decoder(bvCopy, h, &x1, &y1, &v1, &w1);
+#endif
+  int error;
+  huffLookupEntry const* table = rsf_lookup[h - rsf_ht];
+  huffLookupEntry const* entry = NULL;
+  if (table != NULL) {
+    entry = &table[bv.peekBits(HUFF_LOOKUP_BITS)];
+    if (entry->subtableBits != 0) {
+      unsigned const subtableIndex
+	= bv.peekBits(HUFF_LOOKUP_BITS + entry->subtableBits)&((1<<entry->subtableBits)-1);
+      huffLookupEntry const* subtableEntry = &table[entry->value + subtableIndex];
+      entry = subtableEntry->length == 0 ? NULL : subtableEntry;
+      if (entry != NULL) bv.skipBits(HUFF_LOOKUP_BITS);
+    }
+    if (entry != NULL && entry->length == 0) entry = NULL;
+  }
 
+  if (entry == NULL) {
+    // There's no lookup table, or the data isn't a valid code; use the tree decoder:
+    error = rsf_huffman_decoder(bv, h, x, y, v, w);
+  } else {
+    bv.skipBits(entry->length);
+    *x = entry->value >> 4;
+    *y = entry->value & 0xf;
+    *v = *w = 0;
+    rsf_huffman_signs(bv, h, x, y, v, w);
+    error = 0;
+  }
+
+#ifdef VERIFY_FAST_HUFFMAN_DECODING
+  if (error != error1 || *x != x1 || *y != y1 || *v != v1 || *w != w1
+      || bv.curBitIndex() != bvCopy.curBitIndex()) {
+    fprintf(stderr, "fast_huffman_decoder(): mismatch with table %s\n", h->tablename);
+  }
+#endif
   return error;
 }
 
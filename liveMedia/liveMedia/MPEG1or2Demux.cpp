@@ -22,6 +22,7 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "MPEG1or2DemuxedElementaryStream.hh"
 #include "StreamParser.hh"
 #include <stdlib.h>
+#include <string.h>
 
 ////////// MPEGProgramStreamParser definition //////////
 
@@ -76,19 +77,116 @@ public:
 };
 
 
+////////// MPEG1or2Demux::OutputDescriptor::FrameRing definition/implementation //////////
+
+// A bounded ring buffer of PES payloads, each stored contiguously behind a
+// 4-byte size.  A payload that does not fit before the end of the buffer
+// goes at its start; the bytes left at the end are skipped by the reader
+// (and begin with a WRAP_MARKER, if there are at least 4 of them).
+
+#define WRAP_MARKER 0xFFFFFFFF
+
+class MPEG1or2Demux::OutputDescriptor::FrameRing {
+public:
+  FrameRing(unsigned size)
+    : fBuf(new unsigned char[size]), fSize(size),
+      fHead(0), fTail(0), fNumFrames(0), fNumBytes(0) {
+  }
+  virtual ~FrameRing() {
+    delete[] fBuf;
+  }
+
+  unsigned char* reserve(unsigned frameSize) {
+    // Returns where to put a payload of "frameSize" bytes, or NULL if it
+    // doesn't fit now.  Follow with "commit()".
+    unsigned needed = 4 + frameSize;
+    if (fNumFrames == 0) {
+      fHead = fTail = 0;
+      fReserved = needed <= fSize ? 0 : NO_ROOM;
+    } else if (fTail > fHead) {
+      if (fSize - fTail >= needed) fReserved = fTail;
+      else if (fHead >= needed) fReserved = 0;
+      else fReserved = NO_ROOM;
+    } else {
+      fReserved = fHead - fTail >= needed ? fTail : NO_ROOM;
+    }
+    return fReserved == NO_ROOM ? NULL : &fBuf[fReserved + 4];
+  }
+
+  void commit(unsigned frameSize) {
+    if (fReserved != fTail && fSize - fTail >= 4) putSize(fTail, WRAP_MARKER);
+    putSize(fReserved, frameSize);
+    fTail = fReserved + 4 + frameSize;
+    ++fNumFrames;
+    fNumBytes += frameSize;
+  }
+
+  Boolean isEmpty() const { return fNumFrames == 0; }
+  unsigned numBytes() const { return fNumBytes; }
+
+  unsigned char const* front(unsigned& frameSize) const {
+    frameSize = getSize(fHead);
+    return &fBuf[fHead + 4];
+  }
+
+  void pop() {
+    unsigned frameSize = getSize(fHead);
+    fHead += 4 + frameSize;
+    fNumBytes -= frameSize;
+    if (--fNumFrames == 0) {
+      fHead = fTail = 0;
+    } else if (fSize - fHead < 4 || getSize(fHead) == WRAP_MARKER) {
+      fHead = 0;
+    }
+  }
+
+  void reset() {
+    fHead = fTail = fNumFrames = fNumBytes = 0;
+  }
+
+private:
+  enum { NO_ROOM = 0xFFFFFFFF };
+
+  void putSize(unsigned offset, unsigned size) {
+    memcpy(&fBuf[offset], &size, 4);
+  }
+  unsigned getSize(unsigned offset) const {
+    unsigned size;
+    memcpy(&size, &fBuf[offset], 4);
+    return size;
+  }
+
+private:
+  unsigned char* fBuf;
+  unsigned fSize;
+  unsigned fHead; // offset of the oldest payload's size
+  unsigned fTail; // offset just past the newest payload
+  unsigned fReserved; // offset given by the last "reserve()"
+  unsigned fNumFrames, fNumBytes;
+};
+
+
 ////////// MPEG1or2Demux implementation //////////
 
 MPEG1or2Demux
 ::MPEG1or2Demux(UsageEnvironment& env,
-		FramedSource* inputSource, Boolean reclaimWhenLastESDies)
+		FramedSource* inputSource, Boolean reclaimWhenLastESDies,
+		unsigned streamBufferSize)
   : Medium(env),
     fInputSource(inputSource), fMPEGversion(0),
     fNextAudioStreamNumber(0), fNextVideoStreamNumber(0),
     fReclaimWhenLastESDies(reclaimWhenLastESDies), fNumOutstandingESs(0),
+    fStreamBufferSize(streamBufferSize),
     fNumPendingReads(0), fHaveUndeliveredData(False) {
+  // A ring buffer must hold at least one PES packet (and its size):
+  if (fStreamBufferSize > 0 && fStreamBufferSize < 4+6+65535) {
+    fStreamBufferSize = 4+6+65535;
+  }
+
   fParser = new MPEGProgramStreamParser(this, inputSource);
   for (unsigned i = 0; i < 256; ++i) {
     fOutput[i].savedDataHead = fOutput[i].savedDataTail = NULL;
+    fOutput[i].frameRing = NULL;
     fOutput[i].isPotentiallyReadable = False;
     fOutput[i].isCurrentlyActive = False;
     fOutput[i].isCurrentlyAwaitingData = False;
@@ -97,22 +195,42 @@ MPEG1or2Demux
 
 MPEG1or2Demux::~MPEG1or2Demux() {
   delete fParser;
-  for (unsigned i = 0; i < 256; ++i) delete fOutput[i].savedDataHead;
+  for (unsigned i = 0; i < 256; ++i) {
+    delete fOutput[i].savedDataHead;
+    delete fOutput[i].frameRing;
+  }
   Medium::close(fInputSource);
 }
 
 MPEG1or2Demux* MPEG1or2Demux
 ::createNew(UsageEnvironment& env,
-	    FramedSource* inputSource, Boolean reclaimWhenLastESDies) {
+	    FramedSource* inputSource, Boolean reclaimWhenLastESDies,
+	    unsigned streamBufferSize) {
   // Need to add source type checking here???  #####
 
-  return new MPEG1or2Demux(env, inputSource, reclaimWhenLastESDies);
+  return new MPEG1or2Demux(env, inputSource, reclaimWhenLastESDies,
+			   streamBufferSize);
 }
 
 MPEG1or2Demux::SCR::SCR()
   : highBit(0), remainingBits(0), extension(0), isValid(False) {
 }
 
+MPEG1or2Demux::StreamBufferStats::StreamBufferStats()
+  : numFramesBuffered(0), numFramesDropped(0),
+    numBytesBuffered(0), maxBytesBuffered(0), numParserStalls(0) {
+}
+
+Boolean MPEG1or2Demux
+::getStreamBufferStats(u_int8_t streamIdTag, StreamBufferStats& stats) const {
+  OutputDescriptor const& out = fOutput[streamIdTag];
+  if (out.frameRing == NULL) return False;
+
+  stats = out.bufferStats;
+  stats.numBytesBuffered = out.frameRing->numBytes();
+  return True;
+}
+
 void MPEG1or2Demux
 ::noteElementaryStreamDeletion(MPEG1or2DemuxedElementaryStream* /*es*/) {
   if (--fNumOutstandingESs == 0 && fReclaimWhenLastESDies) {
@@ -122,12 +240,21 @@ void MPEG1or2Demux
 
 void MPEG1or2Demux::flushInput() {
   fParser->flushInput();
+
+  // Buffered frames were parsed ahead, from before the 'seek':
+  for (unsigned i = 0; i < 256; ++i) {
+    if (fOutput[i].frameRing != NULL) fOutput[i].frameRing->reset();
+  }
 }
 
 MPEG1or2DemuxedElementaryStream*
 MPEG1or2Demux::newElementaryStream(u_int8_t streamIdTag) {
   ++fNumOutstandingESs;
   fOutput[streamIdTag].isPotentiallyReadable = True;
+  if (fStreamBufferSize > 0 && fOutput[streamIdTag].frameRing == NULL) {
+    fOutput[streamIdTag].frameRing
+      = new OutputDescriptor::FrameRing(fStreamBufferSize);
+  }
   return new MPEG1or2DemuxedElementaryStream(envir(), streamIdTag, *this);
 }
 
@@ -215,6 +342,41 @@ Boolean MPEG1or2Demux::useSavedData(u_int8_t streamIdTag,
   return True;
 }
 
+Boolean MPEG1or2Demux::useBufferedFrame(u_int8_t streamIdTag,
+					unsigned char* to, unsigned maxSize,
+					FramedSource::afterGettingFunc* afterGettingFunc,
+					void* afterGettingClientData) {
+  struct OutputDescriptor& out = fOutput[streamIdTag];
+  if (out.frameRing == NULL || out.frameRing->isEmpty()) return False;
+
+  unsigned frameSize;
+  unsigned char const* from = out.frameRing->front(frameSize);
+  unsigned numTruncatedBytes = 0;
+  if (frameSize > maxSize) {
+    numTruncatedBytes = frameSize - maxSize;
+    frameSize = maxSize;
+  }
+  memmove(to, from, frameSize);
+  out.frameRing->pop();
+  out.isCurrentlyActive = True;
+
+  // If the parser stopped because a ring buffer was full, there may now be
+  // room for it to go on, for the streams that are waiting for data:
+  if (fHaveUndeliveredData && fNumPendingReads > 0) {
+    fHaveUndeliveredData = False;
+    continueReadProcessing();
+  }
+
+  if (afterGettingFunc != NULL) {
+    struct timeval presentationTime;
+    presentationTime.tv_sec = 0; presentationTime.tv_usec = 0; // should fix #####
+    (*afterGettingFunc)(afterGettingClientData, frameSize,
+			numTruncatedBytes, presentationTime,
+			0 /* durationInMicroseconds ?????#####*/);
+  }
+  return True;
+}
+
 void MPEG1or2Demux
 ::continueReadProcessing(void* clientData,
 			 unsigned char* /*ptr*/, unsigned /*size*/,
@@ -261,9 +423,11 @@ void MPEG1or2Demux::getNextFrame(u_int8_t streamIdTag,
 				 void* afterGettingClientData,
 				 FramedSource::onCloseFunc* onCloseFunc,
 				 void* onCloseClientData) {
-  // First, check whether we have saved data for this stream id:
+  // First, check whether we have saved or buffered data for this stream id:
   if (useSavedData(streamIdTag, to, maxSize,
-		   afterGettingFunc, afterGettingClientData)) {
+		   afterGettingFunc, afterGettingClientData) ||
+      useBufferedFrame(streamIdTag, to, maxSize,
+		       afterGettingFunc, afterGettingClientData)) {
     return;
   }
 
@@ -309,6 +473,9 @@ void MPEG1or2Demux::handleClosure(void* clientData) {
     }
     delete out.savedDataHead; out.savedDataHead = out.savedDataTail = NULL;
     out.savedDataTotalSize = 0;
+    // (Any frames still in "frameRing" are kept, so that this stream's
+    // reader can go on to read them.  A reader that's awaiting data has
+    // already emptied its ring.)
     out.isPotentiallyReadable = out.isCurrentlyActive = out.isCurrentlyAwaitingData
       = False;
   }
@@ -717,6 +884,28 @@ unsigned char MPEGProgramStreamParser::parsePESPacket() {
       // set out.presentationTime later #####
       acquiredStreamIdTag = stream_id;
       PES_packet_length -= numBytesToCopy;
+    } else if (out.frameRing != NULL && out.isPotentiallyReadable) {
+      // Someone is (or will be) reading this stream, but isn't right now.
+      // Parse the frame into the stream's ring buffer, if there's room, so
+      // that we can go on parsing for the other streams:
+      unsigned char* to = out.frameRing->reserve(PES_packet_length);
+      if (to != NULL) {
+	getBytes(to, PES_packet_length);
+	out.frameRing->commit(PES_packet_length);
+	++out.bufferStats.numFramesBuffered;
+	if (out.frameRing->numBytes() > out.bufferStats.maxBytesBuffered) {
+	  out.bufferStats.maxBytesBuffered = out.frameRing->numBytes();
+	}
+	PES_packet_length = 0;
+      } else if (out.isCurrentlyActive) {
+	// The reader is this far behind; wait until it catches up:
+	++out.bufferStats.numParserStalls;
+	restoreSavedParserState(); // so we read from the beginning next time
+	fUsingSource->fHaveUndeliveredData = True;
+	throw READER_NOT_READY;
+      } else {
+	++out.bufferStats.numFramesDropped;
+      }
     } else if (out.isCurrentlyActive) {
       // Someone has been reading this stream, but isn't right now.
       // We can't deliver this frame until he asks for it, so punt for now.
@@ -92,9 +92,12 @@ MPEG1or2FileServerDemux::newElementaryStream(unsigned clientSessionId,
 	= ByteStreamFileSource::createNew(envir(), fFileName);
       if (fileSource == NULL) return NULL;
 
-      fLastCreatedDemux = MPEG1or2Demux::createNew(envir(), fileSource, True);
+      fLastCreatedDemux
+	= MPEG1or2Demux::createNew(envir(), fileSource, True,
+				   MPEG1or2Demux::DEFAULT_STREAM_BUFFER_SIZE);
       // Note: We tell the demux to delete itself when its last
-      // elementary stream is deleted.
+      // elementary stream is deleted.  Its audio and video streams are
+      // read by separate sinks, so each gets a ring buffer.
       fLastClientSessionId = clientSessionId;
       // Note: This code relies upon the fact that the creation of streams for
       // different client sessions do not overlap - so one "MPEG1or2Demux" is used
@@ -128,6 +128,15 @@ MPEG2IFrameIndexFromTransportStream::~MPEG2IFrameIndexFromTransportStream() {
   delete[] fParseBuffer;
 }
 
+void MPEG2IFrameIndexFromTransportStream
+::setStartingPoint(unsigned long firstTransportPacketNumber,
+		   float firstPCR, float lastPCR) {
+  fInputTransportPacketCounter = firstTransportPacketNumber - 1;
+  fFirstPCR = firstPCR;
+  fLastPCR = lastPCR;
+  fHaveSeenFirstPCR = True;
+}
+
 void MPEG2IFrameIndexFromTransportStream::doGetNextFrame() {
   // Begin by trying to deliver an index record (for an already-parsed frame)
   // to the client:
@@ -353,9 +362,9 @@ Boolean MPEG2IFrameIndexFromTransportStream::deliverIndexRecord() {
   }
 
   if (head->recordType() == RECORD_JUNK) {
-    // Don't actually deliver the data to the client:
+    // Don't actually deliver the data to the client; try the next record instead:
     delete head;
-    return True;
+    return deliverIndexRecord();
   }
 
   // Deliver data from the head record:
@@ -403,7 +412,6 @@ Boolean MPEG2IFrameIndexFromTransportStream::parseFrame() {
 
   // Inspect the frame's initial 4-byte code, to make sure it starts with a system code:
   if (fParseBufferDataEnd-fParseBufferFrameStart < 4) return False; // not enough data
-  unsigned numInitialBadBytes = 0;
   unsigned char const* p = &fParseBuffer[fParseBufferFrameStart];
   if (!(p[0] == 0 && p[1] == 0 && p[2] == 1)) {
     // There's no system code at the beginning.  Parse until we find one:
@@ -414,8 +422,12 @@ Boolean MPEG2IFrameIndexFromTransportStream::parseFrame() {
     unsigned char nextCode;
     if (!parseToNextCode(nextCode)) return False;
 
-    numInitialBadBytes = fParseBufferParseEnd - fParseBufferFrameStart;
+    // Tag the data before the code as junk now.  (If we instead counted it as part of this
+    // frame, it would be lost - leaving our records misaligned with the data - whenever the
+    // rest of the frame doesn't arrive until a later call.)
+    unsigned numInitialBadBytes = fParseBufferParseEnd - fParseBufferFrameStart;
     //fprintf(stderr, "#####numInitialBadBytes: 0x%x\n", numInitialBadBytes);
+    if (!tagIndexRecords(numInitialBadBytes, RECORD_JUNK)) return False;
     fParseBufferFrameStart = fParseBufferParseEnd;
     fParseBufferParseEnd += 4; // skip over the code that we just saw
     p = &fParseBuffer[fParseBufferFrameStart];
@@ -503,19 +515,35 @@ Boolean MPEG2IFrameIndexFromTransportStream::parseFrame() {
 
   // There is now a parsed 'frame', from "fParseBufferFrameStart"
   // to "fParseBufferParseEnd". Tag the corresponding index records to note this:
-  unsigned frameSize = fParseBufferParseEnd - fParseBufferFrameStart + numInitialBadBytes;
+  unsigned frameSize = fParseBufferParseEnd - fParseBufferFrameStart;
 #ifdef DEBUG
   envir() << "parsed " << recordTypeStr[curRecordType] << "; length "
 	  << frameSize << "\n";
 #endif
-  for (IndexRecord* r = fHeadIndexRecord; ; r = r->next()) {
-    if (numInitialBadBytes >= r->size()) {
-      r->recordType() = RECORD_JUNK;
-      numInitialBadBytes -= r->size();
-    } else {
-      r->recordType() = curRecordType;
-    }
-    if (r == fHeadIndexRecord) r->setFirstFlag();
+  if (!tagIndexRecords(frameSize, curRecordType)) return False;
+
+  // Finally, update our parse state (to skip over the now-parsed data):
+  fParseBufferFrameStart = fParseBufferParseEnd;
+  fParseBufferParseEnd += 4; // to skip over the next code (that we found)
+
+  return True;
+}
+
+Boolean MPEG2IFrameIndexFromTransportStream
+::tagIndexRecords(unsigned frameSize, u_int8_t recordType) {
+  // Begin with the first index record that hasn't already been tagged:
+  IndexRecord* first = fHeadIndexRecord;
+  while (first != NULL && first->recordType() != RECORD_UNPARSED) {
+    first = first == fTailIndexRecord ? NULL : first->next();
+  }
+  if (first == NULL) { // this shouldn't happen
+    envir() << "!!!!!Internal consistency error!!!!!\n";
+    return False;
+  }
+
+  for (IndexRecord* r = first; ; r = r->next()) {
+    r->recordType() = (RecordType)recordType;
+    if (r == first) r->setFirstFlag();
     // indicates that this is the first record for this frame
 
     if (r->size() > frameSize) {
@@ -549,10 +577,6 @@ Boolean MPEG2IFrameIndexFromTransportStream::parseFrame() {
     }
   }
 
-  // Finally, update our parse state (to skip over the now-parsed data):
-  fParseBufferFrameStart = fParseBufferParseEnd;
-  fParseBufferParseEnd += 4; // to skip over the next code (that we found)
-
   return True;
 }
 
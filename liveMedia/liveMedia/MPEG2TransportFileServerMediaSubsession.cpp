@@ -22,6 +22,8 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "MPEG2TransportFileServerMediaSubsession.hh"
 #include "SimpleRTPSink.hh"
 #include "ByteStreamFileSource.hh"
+#include "MappedByteStreamFileSource.hh"
+#include "ZeroCopyRTPSink.hh"
 #include "MPEG2TransportStreamTrickModeFilter.hh"
 #include "MPEG2TransportStreamFromESSource.hh"
 #include "MPEG2TransportStreamFramer.hh"
@@ -67,7 +69,8 @@ MPEG2TransportFileServerMediaSubsession*
 MPEG2TransportFileServerMediaSubsession::createNew(UsageEnvironment& env,
 						   char const* fileName,
 						   char const* indexFileName,
-						   Boolean reuseFirstSource) {
+						   Boolean reuseFirstSource,
+						   Boolean useZeroCopyStreaming) {
   MPEG2TransportStreamIndexFile* indexFile;
   if (indexFileName != NULL && reuseFirstSource) {
     // It makes no sense to support trick play if all clients use the same source.  Fix this:
@@ -77,16 +80,18 @@ MPEG2TransportFileServerMediaSubsession::createNew(UsageEnvironment& env,
     indexFile = MPEG2TransportStreamIndexFile::createNew(env, indexFileName);
   }
   return new MPEG2TransportFileServerMediaSubsession(env, fileName, indexFile,
-						     reuseFirstSource);
+						     reuseFirstSource, useZeroCopyStreaming);
 }
 
 MPEG2TransportFileServerMediaSubsession
 ::MPEG2TransportFileServerMediaSubsession(UsageEnvironment& env,
 					  char const* fileName,
 					  MPEG2TransportStreamIndexFile* indexFile,
-					  Boolean reuseFirstSource)
+					  Boolean reuseFirstSource,
+					  Boolean useZeroCopyStreaming)
   : FileServerMediaSubsession(env, fileName, reuseFirstSource),
-    fIndexFile(indexFile), fDuration(0.0), fClientSessionHashTable(NULL) {
+    fIndexFile(indexFile), fDuration(0.0), fClientSessionHashTable(NULL),
+    fUseZeroCopyStreaming(useZeroCopyStreaming) {
   if (fIndexFile != NULL) { // we support 'trick play'
     fDuration = fIndexFile->getPlayingDuration();
     fClientSessionHashTable = HashTable::create(ONE_WORD_HASH_KEYS);
@@ -195,13 +200,19 @@ FramedSource* MPEG2TransportFileServerMediaSubsession
   // Create the video source:
   unsigned const inputDataChunkSize
     = TRANSPORT_PACKETS_PER_NETWORK_PACKET*TRANSPORT_PACKET_SIZE;
-  ByteStreamFileSource* fileSource
-    = ByteStreamFileSource::createNew(envir(), fFileName, inputDataChunkSize);
+  ByteStreamFileSource* fileSource = NULL;
+  if (fUseZeroCopyStreaming) {
+    fileSource = MappedByteStreamFileSource::createNew(envir(), fFileName, inputDataChunkSize,
+						       0, TRANSPORT_PACKET_SIZE);
+  }
+  if (fileSource == NULL) { // normal case, or the file couldn't be mapped
+    fileSource = ByteStreamFileSource::createNew(envir(), fFileName, inputDataChunkSize);
+  }
   if (fileSource == NULL) return NULL;
   fFileSize = fileSource->fileSize();
 
   // Use the file size and the duration to estimate the stream's bitrate:
-  if (fFileSize > 0 && fDuration > 0.0) {
+  if (fFileSize > 0 && duration() > 0.0) {
     estBitrate = (unsigned)((int64_t)fFileSize/(125*fDuration) + 0.5); // kbps, rounded
   } else {
     estBitrate = 5000; // kbps, estimate
@@ -229,13 +240,18 @@ RTPSink* MPEG2TransportFileServerMediaSubsession
 ::createNewRTPSink(Groupsock* rtpGroupsock,
 		   unsigned char /*rtpPayloadTypeIfDynamic*/,
 		   FramedSource* /*inputSource*/) {
+  if (fUseZeroCopyStreaming) {
+    // Each (7-TS-packet) chunk from the framer becomes one RTP packet's payload:
+    return ZeroCopyRTPSink::createNew(envir(), rtpGroupsock, 33, 90000, "video", "MP2T",
+				      TRANSPORT_PACKETS_PER_NETWORK_PACKET*TRANSPORT_PACKET_SIZE);
+  }
   return SimpleRTPSink::createNew(envir(), rtpGroupsock,
 				  33, 90000, "video", "MP2T",
 				  1, True, False /*no 'M' bit*/);
 }
 
 void MPEG2TransportFileServerMediaSubsession::testScaleFactor(float& scale) {
-  if (fIndexFile != NULL && fDuration > 0.0) {
+  if (fIndexFile != NULL && duration() > 0.0) {
     // We support any integral scale, other than 0
     int iScale = scale < 0.0 ? (int)(scale - 0.5f) : (int)(scale + 0.5f); // round
     if (iScale == 0) iScale = 1;
@@ -246,6 +262,12 @@ void MPEG2TransportFileServerMediaSubsession::testScaleFactor(float& scale) {
 }
 
 float MPEG2TransportFileServerMediaSubsession::duration() const {
+  // If the index file is still growing (because the file is still being recorded), then
+  // our duration keeps up with it:
+  if (fIndexFile != NULL) {
+    float currentDuration = fIndexFile->getPlayingDuration();
+    if (currentDuration > fDuration) fDuration = currentDuration;
+  }
   return fDuration;
 }
 
@@ -56,6 +56,19 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #define PCR_PERIOD_VARIATION_RATIO 0.5
 #endif
 
+#if !defined(MAX_PACING_DELAY)
+#define MAX_PACING_DELAY 0.5 // (seconds)
+// We never hold back a chunk for longer than this (in case our rate estimate is bad)
+#endif
+
+#if !defined(PACING_SOCKET_RATE_HEADROOM)
+#define PACING_SOCKET_RATE_HEADROOM 1.25
+// How far above our own rate to set a socket's "SO_MAX_PACING_RATE" (to allow for
+// RTP/UDP/IP overhead, and for catching up after a delay)
+#endif
+
+#define BURST_GAP 0.001 // (seconds) deliveries closer together than this are one 'burst'
+
 ////////// PIDStatus //////////
 
 class PIDStatus
@@ -85,13 +98,17 @@ MPEG2TransportStreamFramer
 ::MPEG2TransportStreamFramer(UsageEnvironment& env, FramedSource* inputSource, Boolean is_wfd)
     : FramedFilter(env, inputSource),
       fTSPacketCount(0), fTSPacketDurationEstimate(0.0), fTSPCRCount(0),
-	fLimitNumTSPacketsToStream(False), fNumTSPacketsToStream(0), is_for_wfd(is_wfd), fTransport(0), fUDPSource(inputSource)
+	fLimitNumTSPacketsToStream(False), fNumTSPacketsToStream(0), is_for_wfd(is_wfd), fTransport(0), fUDPSource(inputSource),
+      fPacingIsEnabled(False), fPacingBucketSize(0), fPacingTokens(0.0), fLastTokenUpdateTime(0.0),
+      fPacingSocketNum(-1), fSocketPacingRate(0), fLastDeliveryTime(0.0), fCurBurstSize(0)
 {
     fPIDStatusTable = HashTable::create(ONE_WORD_HASH_KEYS);
+    resetBurstSizeHistogram();
 }
 
 MPEG2TransportStreamFramer::~MPEG2TransportStreamFramer()
 {
+    envir().taskScheduler().unscheduleDelayedTask(nextTask());
     clearPIDStatusTable();
     delete fPIDStatusTable;
 }
@@ -111,6 +128,37 @@ void MPEG2TransportStreamFramer::setNumTSPacketsToStream(unsigned long numTSReco
     fLimitNumTSPacketsToStream = numTSRecordsToStream > 0;
 }
 
+void MPEG2TransportStreamFramer::enablePacing(unsigned bucketSize)
+{
+    fPacingIsEnabled = True;
+    fPacingBucketSize = bucketSize < TRANSPORT_PACKET_SIZE ? TRANSPORT_PACKET_SIZE : bucketSize;
+    fPacingTokens = fPacingBucketSize;
+    fLastTokenUpdateTime = 0.0;
+}
+
+void MPEG2TransportStreamFramer::disablePacing()
+{
+    fPacingIsEnabled = False;
+}
+
+void MPEG2TransportStreamFramer::setPacingSocket(int socketNum)
+{
+    fPacingSocketNum = socketNum;
+    fSocketPacingRate = 0;
+}
+
+unsigned MPEG2TransportStreamFramer::pacingRate() const
+{
+    if (fTSPacketDurationEstimate <= 0.0) return 0;
+    return (unsigned)(TRANSPORT_PACKET_SIZE/fTSPacketDurationEstimate);
+}
+
+void MPEG2TransportStreamFramer::resetBurstSizeHistogram()
+{
+    for (unsigned i = 0; i < numBurstSizeBuckets; ++i) fBurstSizeHistogram[i] = 0;
+    fCurBurstSize = 0;
+}
+
 Boolean MPEG2TransportStreamFramer::switchTransport(int port, int fTCP)
 {
 	if (fTransport == fTCP)
@@ -157,8 +205,15 @@ void MPEG2TransportStreamFramer::doGetNextFrame()
                                FramedSource::handleClosure, this);
 }
 
+Boolean MPEG2TransportStreamFramer::canDeliverFrameReferences() const
+{
+    // We pass our input data through unchanged, so we can hand out references iff our source can:
+    return fInputSource->canDeliverFrameReferences();
+}
+
 void MPEG2TransportStreamFramer::doStopGettingFrames()
 {
+    envir().taskScheduler().unscheduleDelayedTask(nextTask());
     FramedFilter::doStopGettingFrames();
     fTSPacketCount = 0;
     fTSPCRCount = 0;
@@ -207,6 +262,7 @@ void MPEG2TransportStreamFramer::afterGettingFrame1(unsigned frameSize,
     }
 #endif
     fFrameSize += frameSize;
+    if (fTo == NULL) fFrameReference = fInputSource->frameReference();
 #if 0
     unsigned const numTSPackets = fFrameSize/TRANSPORT_PACKET_SIZE;
     fNumTSPacketsToStream -= numTSPackets;
@@ -301,10 +357,105 @@ void MPEG2TransportStreamFramer::afterGettingFrame1(unsigned frameSize,
     fDurationInMicroseconds
     = numTSPackets * (unsigned)(fTSPacketDurationEstimate*1000000);
 #endif
+    if (fPacingIsEnabled)
+    {
+        deliverPaced();
+        return;
+    }
+
     // Complete the delivery to our client:
     afterGetting(this);
 }
 
+void MPEG2TransportStreamFramer::deliverPaced()
+{
+    struct timeval tvNow;
+    gettimeofday(&tvNow, NULL);
+    double timeNow = tvNow.tv_sec + tvNow.tv_usec/1000000.0;
+
+    // Update our rate estimate from the PCRs in this chunk:
+    unsigned char const* data = fTo != NULL ? fTo : fFrameReference;
+    unsigned const numTSPackets = fFrameSize/TRANSPORT_PACKET_SIZE;
+    for (unsigned i = 0; i < numTSPackets; ++i)
+    {
+        updateTSPacketDurationEstimate((unsigned char*)&data[i*TRANSPORT_PACKET_SIZE], timeNow);
+    }
+    fDurationInMicroseconds = 0; // because we do the pacing ourselves
+
+    unsigned const rate = pacingRate();
+    if (rate == 0)
+    {
+        // We don't yet know the stream's rate, so deliver this chunk right away:
+        noteDelivery(timeNow);
+        afterGetting(this);
+        return;
+    }
+
+    if (fPacingSocketNum >= 0)
+    {
+        // Keep the socket's pacing rate close to (but above) ours:
+        unsigned socketRate = (unsigned)(rate*PACING_SOCKET_RATE_HEADROOM);
+        if (socketRate > fSocketPacingRate + fSocketPacingRate/8
+            || socketRate < fSocketPacingRate - fSocketPacingRate/8)
+        {
+            if (!setSocketMaxPacingRate(envir(), fPacingSocketNum, socketRate))
+            {
+                fPacingSocketNum = -1; // not supported here; stop trying
+            }
+            fSocketPacingRate = socketRate;
+        }
+    }
+
+    // Refill our token bucket, then take this chunk's tokens from it:
+    fPacingTokens += (timeNow - fLastTokenUpdateTime)*rate;
+    if (fPacingTokens > fPacingBucketSize) fPacingTokens = fPacingBucketSize;
+    fLastTokenUpdateTime = timeNow;
+    fPacingTokens -= fFrameSize;
+
+    if (fPacingTokens >= 0.0)
+    {
+        noteDelivery(timeNow);
+        afterGetting(this);
+        return;
+    }
+
+    // We're ahead of our rate, so wait until the bucket has refilled:
+    double delay = -fPacingTokens/rate;
+    if (delay > MAX_PACING_DELAY)
+    {
+        delay = MAX_PACING_DELAY;
+        fPacingTokens = -delay*rate;
+    }
+    nextTask() = envir().taskScheduler().scheduleDelayedTask((int64_t)(delay*1000000),
+                 deliverPacedFrame, this);
+}
+
+void MPEG2TransportStreamFramer::deliverPacedFrame(void* clientData)
+{
+    MPEG2TransportStreamFramer* framer = (MPEG2TransportStreamFramer*)clientData;
+    framer->nextTask() = NULL;
+
+    struct timeval tvNow;
+    gettimeofday(&tvNow, NULL);
+    framer->noteDelivery(tvNow.tv_sec + tvNow.tv_usec/1000000.0);
+    framer->afterGetting(framer);
+}
+
+void MPEG2TransportStreamFramer::noteDelivery(double timeNow)
+{
+    unsigned const numTSPackets = fFrameSize/TRANSPORT_PACKET_SIZE;
+    if (timeNow - fLastDeliveryTime >= BURST_GAP && fCurBurstSize > 0)
+    {
+        // The previous burst has ended; count it:
+        unsigned bucket = 0;
+        while ((fCurBurstSize>>(bucket+1)) != 0 && bucket+1 < numBurstSizeBuckets) ++bucket;
+        ++fBurstSizeHistogram[bucket];
+        fCurBurstSize = 0;
+    }
+    fCurBurstSize += numTSPackets;
+    fLastDeliveryTime = timeNow;
+}
+
 void MPEG2TransportStreamFramer
 ::updateTSPacketDurationEstimate(unsigned char* pkt, double timeNow)
 {
@@ -32,7 +32,7 @@ class InputESSourceRecord {
 public:
   InputESSourceRecord(MPEG2TransportStreamFromESSource& parent,
 		      FramedSource* inputSource,
-		      u_int8_t streamId, int mpegVersion,
+		      u_int8_t streamId, int mpegVersion, unsigned programIndex,
 		      InputESSourceRecord* next);
   virtual ~InputESSourceRecord();
 
@@ -64,6 +64,7 @@ private:
   FramedSource* fInputSource;
   u_int8_t fStreamId;
   int fMPEGVersion;
+  unsigned fProgramIndex;
   unsigned char* fInputBuffer;
   unsigned fInputBufferBytesAvailable;
   Boolean fInputBufferInUse;
@@ -74,32 +75,43 @@ private:
 ////////// MPEG2TransportStreamFromESSource implementation //////////
 
 MPEG2TransportStreamFromESSource* MPEG2TransportStreamFromESSource
-::createNew(UsageEnvironment& env) {
-  return new MPEG2TransportStreamFromESSource(env);
+::createNew(UsageEnvironment& env, unsigned numPrograms) {
+  return new MPEG2TransportStreamFromESSource(env, numPrograms);
 }
 
 void MPEG2TransportStreamFromESSource
-::addNewVideoSource(FramedSource* inputSource, int mpegVersion) {
-  u_int8_t streamId = 0xE0 | (fVideoSourceCounter++&0x0F);
-  addNewInputSource(inputSource, streamId, mpegVersion);
+::addNewVideoSource(FramedSource* inputSource, int mpegVersion, unsigned programIndex) {
+  if (programIndex >= numPrograms()) return;
+  u_int8_t streamId = 0xE0 | (fVideoSourceCounter[programIndex]++&0x0F);
+  addNewInputSource(inputSource, streamId, mpegVersion, programIndex);
   fHaveVideoStreams = True;
+  setHaveVideoStreams(programIndex, True);
 }
 
 void MPEG2TransportStreamFromESSource
-::addNewAudioSource(FramedSource* inputSource, int mpegVersion) {
-  u_int8_t streamId = 0xC0 | (fAudioSourceCounter++&0x0F);
-  addNewInputSource(inputSource, streamId, mpegVersion);
+::addNewAudioSource(FramedSource* inputSource, int mpegVersion, unsigned programIndex) {
+  if (programIndex >= numPrograms()) return;
+  u_int8_t streamId = 0xC0 | (fAudioSourceCounter[programIndex]++&0x0F);
+  addNewInputSource(inputSource, streamId, mpegVersion, programIndex);
 }
 
 MPEG2TransportStreamFromESSource
-::MPEG2TransportStreamFromESSource(UsageEnvironment& env)
-  : MPEG2TransportStreamMultiplexor(env),
-    fInputSources(NULL), fVideoSourceCounter(0), fAudioSourceCounter(0) {
+::MPEG2TransportStreamFromESSource(UsageEnvironment& env, unsigned numPrograms)
+  : MPEG2TransportStreamMultiplexor(env, numPrograms),
+    fInputSources(NULL) {
   fHaveVideoStreams = False; // unless we add a video source
+  fVideoSourceCounter = new unsigned[this->numPrograms()];
+  fAudioSourceCounter = new unsigned[this->numPrograms()];
+  for (unsigned p = 0; p < this->numPrograms(); ++p) {
+    fVideoSourceCounter[p] = fAudioSourceCounter[p] = 0;
+    setHaveVideoStreams(p, False); // unless we add a video source to it
+  }
 }
 
 MPEG2TransportStreamFromESSource::~MPEG2TransportStreamFromESSource() {
   delete fInputSources;
+  delete[] fVideoSourceCounter;
+  delete[] fAudioSourceCounter;
 }
 
 void MPEG2TransportStreamFromESSource::doStopGettingFrames() {
@@ -142,10 +154,10 @@ void MPEG2TransportStreamFromESSource
 
 void MPEG2TransportStreamFromESSource
 ::addNewInputSource(FramedSource* inputSource,
-		    u_int8_t streamId, int mpegVersion) {
+		    u_int8_t streamId, int mpegVersion, unsigned programIndex) {
   if (inputSource == NULL) return;
   fInputSources = new InputESSourceRecord(*this, inputSource, streamId,
-					  mpegVersion, fInputSources);
+					  mpegVersion, programIndex, fInputSources);
 }
 
 
@@ -154,10 +166,10 @@ void MPEG2TransportStreamFromESSource
 InputESSourceRecord
 ::InputESSourceRecord(MPEG2TransportStreamFromESSource& parent,
 		      FramedSource* inputSource,
-		      u_int8_t streamId, int mpegVersion,
+		      u_int8_t streamId, int mpegVersion, unsigned programIndex,
 		      InputESSourceRecord* next)
   : fNext(next), fParent(parent), fInputSource(inputSource),
-    fStreamId(streamId), fMPEGVersion(mpegVersion) {
+    fStreamId(streamId), fMPEGVersion(mpegVersion), fProgramIndex(programIndex) {
   fInputBuffer = new unsigned char[INPUT_BUFFER_SIZE];
   reset();
 }
@@ -215,7 +227,7 @@ Boolean InputESSourceRecord::deliverBufferToClient() {
 
   // Do the delivery:
   fParent.handleNewBuffer(fInputBuffer, fInputBufferBytesAvailable,
-			 fMPEGVersion, fSCR);
+			 fMPEGVersion, fSCR, fProgramIndex);
 
   return True;
 }
@@ -23,12 +23,26 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 
 #include "MPEG2TransportStreamIndexFile.hh"
 #include "InputFile.hh"
+#if defined(__WIN32__) || defined(_WIN32)
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// When we memory-map the index file, we round the mapping's size up to a multiple of this.
+// If the file is growing, this lets us avoid remapping it each time a few records are added.
+// (We never access the mapping beyond the end of the last complete record.)
+#define INDEX_MAPPING_GRANULARITY (1024*1024)
 
 MPEG2TransportStreamIndexFile
 ::MPEG2TransportStreamIndexFile(UsageEnvironment& env, char const* indexFileName)
   : Medium(env),
     fFileName(strDup(indexFileName)), fFid(NULL), fMPEGVersion(0), fCurrentIndexRecordNum(0),
-    fCachedPCR(0.0f), fCachedTSPacketNumber(0), fNumIndexRecords(0) {
+    fCachedPCR(0.0f), fCachedTSPacketNumber(0), fNumIndexRecords(0),
+    fMappedRecords(NULL), fMappedSize(0), fMappedFileDescriptor(-1), fMappingFailed(False),
+    fBuf(fReadBuf) {
   // Get the file size, to determine how many index records it contains:
   u_int64_t indexFileSize = GetFileSize(indexFileName, NULL);
   if (indexFileSize % INDEX_RECORD_SIZE != 0) {
@@ -56,6 +70,11 @@ MPEG2TransportStreamIndexFile* MPEG2TransportStreamIndexFile
 }
 
 MPEG2TransportStreamIndexFile::~MPEG2TransportStreamIndexFile() {
+  unmapFile();
+#if defined(__WIN32__) || defined(_WIN32)
+#else
+  if (fMappedFileDescriptor >= 0) ::close(fMappedFileDescriptor);
+#endif
   closeFid();
   delete[] fFileName;
 }
@@ -63,6 +82,7 @@ MPEG2TransportStreamIndexFile::~MPEG2TransportStreamIndexFile() {
 void MPEG2TransportStreamIndexFile
 ::lookupTSPacketNumFromNPT(float& npt, unsigned long& tsPacketNumber,
 			   unsigned long& indexRecordNumber) {
+  updateNumIndexRecords();
   if (npt <= 0.0 || fNumIndexRecords == 0) { // Fast-track a common case:
     npt = 0.0f;
     tsPacketNumber = indexRecordNumber = 0;
@@ -128,6 +148,7 @@ void MPEG2TransportStreamIndexFile
 void MPEG2TransportStreamIndexFile
 ::lookupPCRFromTSPacketNum(unsigned long& tsPacketNumber, Boolean reverseToPreviousCleanPoint,
 			   float& pcr, unsigned long& indexRecordNumber) {
+  updateNumIndexRecords();
   if (tsPacketNumber == 0 || fNumIndexRecords == 0) { // Fast-track a common case:
     pcr = 0.0f;
     indexRecordNumber = 0;
@@ -210,6 +231,7 @@ Boolean MPEG2TransportStreamIndexFile
 }
 
 float MPEG2TransportStreamIndexFile::getPlayingDuration() {
+  updateNumIndexRecords();
   if (fNumIndexRecords == 0 || !readOneIndexRecord(fNumIndexRecords-1)) return 0.0f;
 
   return pcrFromBuf();
@@ -225,6 +247,65 @@ int MPEG2TransportStreamIndexFile::mpegVersion() {
   return fMPEGVersion;
 }
 
+void MPEG2TransportStreamIndexFile::updateNumIndexRecords() {
+  u_int64_t indexFileSize = 0;
+#if defined(__WIN32__) || defined(_WIN32)
+#else
+  struct stat sb;
+  if (fMappedFileDescriptor >= 0 && fstat(fMappedFileDescriptor, &sb) == 0) {
+    indexFileSize = sb.st_size;
+  } else
+#endif
+  indexFileSize = GetFileSize(fFileName, NULL);
+
+  // Note: If a record is still being written, then we ignore it (for now):
+  unsigned long numIndexRecords = (unsigned long)(indexFileSize/INDEX_RECORD_SIZE);
+  if (numIndexRecords > fNumIndexRecords) fNumIndexRecords = numIndexRecords;
+}
+
+Boolean MPEG2TransportStreamIndexFile::mapFile() {
+  size_t const neededSize = fNumIndexRecords*INDEX_RECORD_SIZE;
+  if (fMappedRecords != NULL && neededSize <= fMappedSize) return True;
+  if (fMappingFailed || neededSize == 0 || fFileName == NULL) return False;
+
+#if defined(__WIN32__) || defined(_WIN32)
+  fMappingFailed = True;
+  return False;
+#else
+  if (fMappedFileDescriptor < 0 && (fMappedFileDescriptor = ::open(fFileName, O_RDONLY)) < 0) {
+    fMappingFailed = True;
+    return False;
+  }
+
+  // (Re)map the file - now that it's larger than our current mapping (if any):
+  unmapFile();
+  size_t mappedSize
+    = ((neededSize + INDEX_MAPPING_GRANULARITY - 1)/INDEX_MAPPING_GRANULARITY)*INDEX_MAPPING_GRANULARITY;
+  void* mapping = mmap(NULL, mappedSize, PROT_READ, MAP_SHARED, fMappedFileDescriptor, 0);
+  if (mapping == MAP_FAILED) {
+    // e.g., not enough address space; use "fFid" instead:
+    fMappingFailed = True;
+    return False;
+  }
+
+  fMappedRecords = (unsigned char*)mapping;
+  fMappedSize = mappedSize;
+  return True;
+#endif
+}
+
+void MPEG2TransportStreamIndexFile::unmapFile() {
+  if (fMappedRecords != NULL) {
+#if defined(__WIN32__) || defined(_WIN32)
+#else
+    munmap(fMappedRecords, fMappedSize);
+#endif
+    fMappedRecords = NULL;
+    fMappedSize = 0;
+  }
+  fBuf = fReadBuf;
+}
+
 Boolean MPEG2TransportStreamIndexFile::openFid() {
   if (fFid == NULL && fFileName != NULL) {
     if ((fFid = OpenInputFile(envir(), fFileName)) != NULL) {
@@ -246,9 +327,18 @@ Boolean MPEG2TransportStreamIndexFile::seekToIndexRecord(unsigned long indexReco
 }
 
 Boolean MPEG2TransportStreamIndexFile::readIndexRecord(unsigned long indexRecordNum) {
+  // Index lookups jump around the file, so - if we can - we memory-map the whole of it,
+  // rather than doing a seek and a read for each record:
+  if (indexRecordNum >= fNumIndexRecords) updateNumIndexRecords(); // the file may have grown
+  if (indexRecordNum < fNumIndexRecords && mapFile()) {
+    fBuf = &fMappedRecords[indexRecordNum*INDEX_RECORD_SIZE];
+    return True;
+  }
+
   do {
     if (!seekToIndexRecord(indexRecordNum)) break;
-    if (fread(fBuf, INDEX_RECORD_SIZE, 1, fFid) != 1) break;
+    if (fread(fReadBuf, INDEX_RECORD_SIZE, 1, fFid) != 1) break;
+    fBuf = fReadBuf;
     ++fCurrentIndexRecordNum;
 
     return True;
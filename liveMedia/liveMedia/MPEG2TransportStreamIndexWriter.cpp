@@ -0,0 +1,209 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A filter that passes a Transport Stream through unchanged (e.g., to a "FileSink"
+// that's recording it), while also appending - as each Transport Stream packet
+// arrives - index records for it to an index file.
+// Implementation
+
+#include "MPEG2TransportStreamIndexWriter.hh"
+#include "OutputFile.hh"
+#include "GroupsockHelper.hh"
+
+////////// IndexerPacketSource //////////
+
+// A source that hands the Transport Stream data that we've just received - one packet at
+// a time - to the indexer.  The data is delivered only from "deliverPackets()"; a request
+// for data at any other time just waits for the next call.
+
+class IndexerPacketSource: public FramedSource {
+public:
+  IndexerPacketSource(UsageEnvironment& env);
+  virtual ~IndexerPacketSource();
+
+  void deliverPackets(unsigned char const* data, unsigned dataSize);
+      // Any incomplete packet at the end of "data" is kept, to be completed next time
+  void signalClosure();
+
+private:
+  // redefined virtual functions:
+  virtual void doGetNextFrame();
+
+private:
+  unsigned char fPartialPacket[TRANSPORT_PACKET_SIZE];
+  unsigned fPartialPacketSize;
+  Boolean fHasClosed;
+};
+
+IndexerPacketSource::IndexerPacketSource(UsageEnvironment& env)
+  : FramedSource(env), fPartialPacketSize(0), fHasClosed(False) {
+}
+
+IndexerPacketSource::~IndexerPacketSource() {
+}
+
+void IndexerPacketSource::deliverPackets(unsigned char const* data, unsigned dataSize) {
+  // Note that our reader usually asks for the next packet from within "afterGetting()",
+  // so we deliver each packet from this loop, rather than recursively:
+  while (dataSize > 0 && isCurrentlyAwaitingData()) {
+    unsigned char const* packet;
+    if (fPartialPacketSize > 0 || dataSize < TRANSPORT_PACKET_SIZE) {
+      unsigned numBytesToCopy = TRANSPORT_PACKET_SIZE - fPartialPacketSize;
+      if (numBytesToCopy > dataSize) numBytesToCopy = dataSize;
+      memmove(&fPartialPacket[fPartialPacketSize], data, numBytesToCopy);
+      fPartialPacketSize += numBytesToCopy;
+      data += numBytesToCopy; dataSize -= numBytesToCopy;
+      if (fPartialPacketSize < TRANSPORT_PACKET_SIZE) break; // still incomplete
+
+      packet = fPartialPacket;
+      fPartialPacketSize = 0;
+    } else {
+      packet = data;
+      data += TRANSPORT_PACKET_SIZE; dataSize -= TRANSPORT_PACKET_SIZE;
+    }
+
+    if (fMaxSize < TRANSPORT_PACKET_SIZE) {
+      fFrameSize = fMaxSize;
+      fNumTruncatedBytes = TRANSPORT_PACKET_SIZE - fMaxSize;
+    } else {
+      fFrameSize = TRANSPORT_PACKET_SIZE;
+      fNumTruncatedBytes = 0;
+    }
+    memmove(fTo, packet, fFrameSize);
+    gettimeofday(&fPresentationTime, NULL);
+    fDurationInMicroseconds = 0;
+    FramedSource::afterGetting(this);
+  }
+}
+
+void IndexerPacketSource::signalClosure() {
+  fHasClosed = True;
+  if (isCurrentlyAwaitingData()) handleClosure(this);
+}
+
+void IndexerPacketSource::doGetNextFrame() {
+  if (fHasClosed) handleClosure(this);
+}
+
+////////// MPEG2TransportStreamIndexWriter //////////
+
+MPEG2TransportStreamIndexWriter*
+MPEG2TransportStreamIndexWriter::createNew(UsageEnvironment& env, FramedSource* inputSource,
+					   char const* indexFileName) {
+  FILE* indexFid = OpenOutputFile(env, indexFileName);
+  if (indexFid == NULL) return NULL;
+
+  return new MPEG2TransportStreamIndexWriter(env, inputSource, indexFid);
+}
+
+MPEG2TransportStreamIndexWriter
+::MPEG2TransportStreamIndexWriter(UsageEnvironment& env, FramedSource* inputSource,
+				  FILE* indexFid)
+  : FramedFilter(env, inputSource),
+    fIndexFid(indexFid), fIsRequestingIndexRecords(False), fIndexerHasClosed(False) {
+  fPacketSource = new IndexerPacketSource(env);
+  fIndexer = MPEG2IFrameIndexFromTransportStream::createNew(env, fPacketSource);
+
+  // Start asking for index records now, so that the indexer is ready for our first data:
+  requestIndexRecords();
+}
+
+MPEG2TransportStreamIndexWriter::~MPEG2TransportStreamIndexWriter() {
+  Medium::close(fIndexer); // also closes "fPacketSource"
+  CloseOutputFile(fIndexFid);
+}
+
+void MPEG2TransportStreamIndexWriter::doGetNextFrame() {
+  fInputSource->getNextFrame(fTo, fMaxSize,
+			     afterGettingFrame, this,
+			     handleInputClosure, this);
+}
+
+void MPEG2TransportStreamIndexWriter
+::afterGettingFrame(void* clientData, unsigned frameSize,
+		    unsigned numTruncatedBytes,
+		    struct timeval presentationTime,
+		    unsigned durationInMicroseconds) {
+  MPEG2TransportStreamIndexWriter* writer = (MPEG2TransportStreamIndexWriter*)clientData;
+  writer->afterGettingFrame1(frameSize, numTruncatedBytes,
+			     presentationTime, durationInMicroseconds);
+}
+
+void MPEG2TransportStreamIndexWriter
+::afterGettingFrame1(unsigned frameSize,
+		     unsigned numTruncatedBytes,
+		     struct timeval presentationTime,
+		     unsigned durationInMicroseconds) {
+  // Index the new data (which also writes any resulting index records), then make the new
+  // records visible to readers of the index file straight away:
+  fPacketSource->deliverPackets(fTo, frameSize);
+  fflush(fIndexFid);
+
+  // Then pass the data - unchanged - to our reader:
+  fFrameSize = frameSize;
+  fNumTruncatedBytes = numTruncatedBytes;
+  fPresentationTime = presentationTime;
+  fDurationInMicroseconds = durationInMicroseconds;
+  afterGetting(this);
+}
+
+void MPEG2TransportStreamIndexWriter::handleInputClosure(void* clientData) {
+  MPEG2TransportStreamIndexWriter* writer = (MPEG2TransportStreamIndexWriter*)clientData;
+  writer->handleInputClosure1();
+}
+
+void MPEG2TransportStreamIndexWriter::handleInputClosure1() {
+  // Let the indexer finish (writing records for any data that it hasn't yet parsed):
+  fPacketSource->signalClosure();
+  fflush(fIndexFid);
+
+  handleClosure(this);
+}
+
+void MPEG2TransportStreamIndexWriter::requestIndexRecords() {
+  // Ask for index records until the indexer needs more Transport Stream data.  (The
+  // indexer usually delivers each record from within "getNextFrame()", so we do this
+  // from a loop, rather than recursively from "afterGettingIndexRecord()".)
+  if (fIsRequestingIndexRecords) return;
+  fIsRequestingIndexRecords = True;
+
+  while (!fIndexerHasClosed && !fIndexer->isCurrentlyAwaitingData()) {
+    fIndexer->getNextFrame(fIndexRecord, sizeof fIndexRecord,
+			   afterGettingIndexRecord, this,
+			   handleIndexerClosure, this);
+  }
+
+  fIsRequestingIndexRecords = False;
+}
+
+void MPEG2TransportStreamIndexWriter
+::afterGettingIndexRecord(void* clientData, unsigned frameSize,
+			  unsigned /*numTruncatedBytes*/,
+			  struct timeval /*presentationTime*/,
+			  unsigned /*durationInMicroseconds*/) {
+  MPEG2TransportStreamIndexWriter* writer = (MPEG2TransportStreamIndexWriter*)clientData;
+  if (frameSize == INDEX_RECORD_SIZE) {
+    fwrite(writer->fIndexRecord, INDEX_RECORD_SIZE, 1, writer->fIndexFid);
+  }
+
+  writer->requestIndexRecords();
+}
+
+void MPEG2TransportStreamIndexWriter::handleIndexerClosure(void* clientData) {
+  MPEG2TransportStreamIndexWriter* writer = (MPEG2TransportStreamIndexWriter*)clientData;
+  writer->fIndexerHasClosed = True;
+}
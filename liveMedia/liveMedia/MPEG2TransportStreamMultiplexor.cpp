@@ -22,28 +22,94 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "MPEG2TransportStreamMultiplexor.hh"
 
 #define TRANSPORT_PACKET_SIZE 188
+#define PSI_PAYLOAD_SIZE (TRANSPORT_PACKET_SIZE - 4) // allow for the 4-byte header
 
 #define PAT_FREQUENCY 100 // # of packets between Program Association Tables
-#define PMT_FREQUENCY 500 // # of packets between Program Map Tables
+#define PMT_FREQUENCY 500 // # of packets between (each program's) Program Map Tables
 
-#define PID_TABLE_SIZE 256
+// The most Transport packets that we deliver in one frame - enough to fill a typical
+// network packet, so that a frame can still be sent whole in a RTP packet:
+#ifndef MAX_TRANSPORT_PACKETS_PER_FRAME
+#define MAX_TRANSPORT_PACKETS_PER_FRAME 7
+#endif
+
+#define PAT_PID 0
+#define OUR_PROGRAM_NUMBER 1 // for program index 0
+#define OUR_PROGRAM_MAP_PID 0x10 // for program index 0; subsequent programs use 0x11, 0x12, etc.
+
+class MPEG2TransportStreamPIDState {
+public:
+  unsigned counter;
+  u_int8_t streamType; // for use in Program Maps
+};
+
+class MPEG2TransportStreamProgramState {
+public:
+  u_int16_t programNumber;
+  u_int16_t pcrPID; // 0 until chosen
+  MPEG1or2Demux::SCR pcr;
+  Boolean haveVideoStreams;
+  unsigned programMapVersion;
+  u_int8_t previousInputProgramMapVersion, currentInputProgramMapVersion;
+      // These two fields are used if we see "program_stream_map"s in the input.
+  unsigned char pmtPayload[PSI_PAYLOAD_SIZE]; // our PMT (already built), unless "pmtIsStale"
+  Boolean pmtIsStale;
+};
 
 MPEG2TransportStreamMultiplexor
-::MPEG2TransportStreamMultiplexor(UsageEnvironment& env)
+::MPEG2TransportStreamMultiplexor(UsageEnvironment& env, unsigned numPrograms)
   : FramedSource(env),
     fHaveVideoStreams(True/*by default*/),
-    fOutgoingPacketCounter(0), fProgramMapVersion(0),
-    fPreviousInputProgramMapVersion(0xFF), fCurrentInputProgramMapVersion(0xFF),
-    fPCR_PID(0), fCurrentPID(0),
+    fNumPrograms(numPrograms == 0 ? 1
+		 : numPrograms > MAX_NUM_TRANSPORT_STREAM_PROGRAMS ? MAX_NUM_TRANSPORT_STREAM_PROGRAMS
+		 : numPrograms),
+    fOutgoingPacketCounter(0), fNextPMTProgram(0), fCurrentPID(0), fCurrentProgram(0),
     fInputBuffer(NULL), fInputBufferSize(0), fInputBufferBytesUsed(0),
-    fIsFirstAdaptationField(True) {
-  for (unsigned i = 0; i < PID_TABLE_SIZE; ++i) {
+    fIsFirstAdaptationField(True),
+    fPATIsStale(True), fPATVersion(1) {
+  // Send each program's PMT (in turn) as often as we used to send our only one:
+  fPMTInterval = PMT_FREQUENCY/fNumPrograms;
+
+  fPrograms = new MPEG2TransportStreamProgramState[fNumPrograms];
+  for (unsigned p = 0; p < fNumPrograms; ++p) {
+    MPEG2TransportStreamProgramState& program = fPrograms[p];
+    program.programNumber = OUR_PROGRAM_NUMBER + p;
+    program.pcrPID = 0;
+    program.haveVideoStreams = True; // by default
+    program.programMapVersion = 0;
+    program.previousInputProgramMapVersion = program.currentInputProgramMapVersion = 0xFF;
+    program.pmtIsStale = True;
+  }
+
+  unsigned const numPIDs = fNumPrograms*256;
+  fPIDState = new MPEG2TransportStreamPIDState[numPIDs];
+  for (unsigned i = 0; i < numPIDs; ++i) {
     fPIDState[i].counter = 0;
     fPIDState[i].streamType = 0;
   }
+
+  fPATPayload = new unsigned char[PSI_PAYLOAD_SIZE];
 }
 
 MPEG2TransportStreamMultiplexor::~MPEG2TransportStreamMultiplexor() {
+  delete[] fPATPayload;
+  delete[] fPIDState;
+  delete[] fPrograms;
+}
+
+void MPEG2TransportStreamMultiplexor
+::setProgramNumber(unsigned programIndex, u_int16_t programNumber) {
+  if (programIndex >= fNumPrograms) return;
+
+  fPrograms[programIndex].programNumber = programNumber;
+  fPrograms[programIndex].pmtIsStale = True;
+  fPATIsStale = True;
+  ++fPATVersion;
+}
+
+void MPEG2TransportStreamMultiplexor
+::setHaveVideoStreams(unsigned programIndex, Boolean haveVideoStreams) {
+  if (programIndex < fNumPrograms) fPrograms[programIndex].haveVideoStreams = haveVideoStreams;
 }
 
 void MPEG2TransportStreamMultiplexor::doGetNextFrame() {
@@ -54,6 +120,26 @@ void MPEG2TransportStreamMultiplexor::doGetNextFrame() {
     return;
   }
 
+  // Build as many Transport packets - directly in the client's buffer - as will fit, and
+  // deliver them together (rather than making a separate delivery for each 188 bytes):
+  fFrameSize = 0;
+  fNumTruncatedBytes = 0;
+  if (fMaxSize < TRANSPORT_PACKET_SIZE) {
+    fNumTruncatedBytes = TRANSPORT_PACKET_SIZE; // the client hasn't given us enough space; deliver nothing
+  } else {
+    for (unsigned i = 0; i < MAX_TRANSPORT_PACKETS_PER_FRAME; ++i) {
+      if (fFrameSize + TRANSPORT_PACKET_SIZE > fMaxSize) break; // no more room
+      if (fInputBufferBytesUsed >= fInputBufferSize) break; // we've used up the input buffer
+      deliverNextPacket();
+    }
+  }
+
+  // NEED TO SET fPresentationTime, durationInMicroseconds #####
+  // Complete the delivery to the client:
+  afterGetting(this);
+}
+
+void MPEG2TransportStreamMultiplexor::deliverNextPacket() {
   do {
     // Periodically return a Program Association Table packet instead:
     if (fOutgoingPacketCounter++ % PAT_FREQUENCY == 0) {
@@ -61,15 +147,22 @@ void MPEG2TransportStreamMultiplexor::doGetNextFrame() {
       break;
     }
 
-    // Periodically (or when we see a new PID) return a Program Map Table instead:
+    // When we see a new PID (or a new input program map), return our Program Map Table instead:
+    MPEG2TransportStreamProgramState& program = fPrograms[fCurrentProgram]; // alias
     Boolean programMapHasChanged = fPIDState[fCurrentPID].counter == 0
-      || fCurrentInputProgramMapVersion != fPreviousInputProgramMapVersion;
-    if (fOutgoingPacketCounter % PMT_FREQUENCY == 0 || programMapHasChanged) {
-      if (programMapHasChanged) { // reset values for next time:
-	fPIDState[fCurrentPID].counter = 1;
-	fPreviousInputProgramMapVersion = fCurrentInputProgramMapVersion;
-      }
-      deliverPMTPacket(programMapHasChanged);
+      || program.currentInputProgramMapVersion != program.previousInputProgramMapVersion;
+    if (programMapHasChanged) {
+      // reset values for next time:
+      fPIDState[fCurrentPID].counter = 1;
+      program.previousInputProgramMapVersion = program.currentInputProgramMapVersion;
+      deliverPMTPacket(fCurrentProgram, True);
+      break;
+    }
+
+    // Also, periodically return each program's Program Map Table (in turn):
+    if (fOutgoingPacketCounter % fPMTInterval == 0) {
+      deliverPMTPacket(fNextPMTProgram, False);
+      fNextPMTProgram = (fNextPMTProgram+1)%fNumPrograms;
       break;
     }
 
@@ -77,30 +170,31 @@ void MPEG2TransportStreamMultiplexor::doGetNextFrame() {
     deliverDataToClient(fCurrentPID, fInputBuffer, fInputBufferSize,
 			fInputBufferBytesUsed);
   } while (0);
-
-  // NEED TO SET fPresentationTime, durationInMicroseconds #####
-  // Complete the delivery to the client:
-  afterGetting(this);
 }
 
 void MPEG2TransportStreamMultiplexor
 ::handleNewBuffer(unsigned char* buffer, unsigned bufferSize,
-		  int mpegVersion, MPEG1or2Demux::SCR scr) {
+		  int mpegVersion, MPEG1or2Demux::SCR scr, unsigned programIndex) {
   if (bufferSize < 4) return;
   fInputBuffer = buffer;
   fInputBufferSize = bufferSize;
   fInputBufferBytesUsed = 0;
 
   u_int8_t stream_id = fInputBuffer[3];
-  // Use "stream_id" directly as our PID.
+  // Use "stream_id" - within this program's range of PIDs - as our PID.
   // Also, figure out the Program Map 'stream type' from this.
-  if (stream_id == 0xBE) { // padding_stream; ignore
+  if (programIndex >= fNumPrograms) { // we don't know this program; ignore
+    fInputBufferSize = 0;
+  } else if (stream_id == 0xBE) { // padding_stream; ignore
     fInputBufferSize = 0;
   } else if (stream_id == 0xBC) { // program_stream_map
+    fCurrentProgram = programIndex;
     setProgramStreamMap(fInputBufferSize);
     fInputBufferSize = 0; // then, ignore the buffer
   } else {
-    fCurrentPID = stream_id;
+    fCurrentProgram = programIndex;
+    fCurrentPID = (programIndex<<8)|stream_id;
+    MPEG2TransportStreamProgramState& program = fPrograms[programIndex]; // alias
 
     // Set the stream's type:
     u_int8_t& streamType = fPIDState[fCurrentPID].streamType; // alias
@@ -119,15 +213,16 @@ void MPEG2TransportStreamMultiplexor
       }
     }
 
-    if (fPCR_PID == 0) { // set it to this stream, if it's appropriate:
-      if ((!fHaveVideoStreams && (streamType == 3 || streamType == 4 || streamType == 0xF))/* audio stream */ ||
+    if (program.pcrPID == 0) { // set it to this stream, if it's appropriate:
+      Boolean haveVideoStreams = fNumPrograms == 1 ? fHaveVideoStreams : program.haveVideoStreams;
+      if ((!haveVideoStreams && (streamType == 3 || streamType == 4 || streamType == 0xF))/* audio stream */ ||
 	  (streamType == 1 || streamType == 2 || streamType == 0x10 || streamType == 0x1B)/* video stream */) {
-	fPCR_PID = fCurrentPID; // use this stream's SCR for PCR
+	program.pcrPID = fCurrentPID; // use this stream's SCR for PCR
       }
     }
-    if (fCurrentPID == fPCR_PID) {
+    if (fCurrentPID == program.pcrPID) {
       // Record the input's current SCR timestamp, for use as our PCR:
-      fPCR = scr;
+      program.pcr = scr;
     }
   }
 
@@ -136,164 +231,172 @@ void MPEG2TransportStreamMultiplexor
 }
 
 void MPEG2TransportStreamMultiplexor
-::deliverDataToClient(u_int8_t pid, unsigned char* buffer, unsigned bufferSize,
+::deliverDataToClient(u_int16_t pid, unsigned char* buffer, unsigned bufferSize,
 		      unsigned& startPositionInBuffer) {
-  // Construct a new Transport packet, and deliver it to the client:
-  if (fMaxSize < TRANSPORT_PACKET_SIZE) {
-    fFrameSize = 0; // the client hasn't given us enough space; deliver nothing
-    fNumTruncatedBytes = TRANSPORT_PACKET_SIZE;
-  } else {
-    fFrameSize = TRANSPORT_PACKET_SIZE;
-    Boolean willAddPCR = pid == fPCR_PID && startPositionInBuffer == 0
-      && !(fPCR.highBit == 0 && fPCR.remainingBits == 0 && fPCR.extension == 0);
-    unsigned const numBytesAvailable = bufferSize - startPositionInBuffer;
-    unsigned numHeaderBytes = 4; // by default
-    unsigned numPCRBytes = 0; // by default
-    unsigned numPaddingBytes = 0; // by default
-    unsigned numDataBytes;
-    u_int8_t adaptation_field_control;
-    if (willAddPCR) {
-      adaptation_field_control = 0x30;
-      numHeaderBytes += 2; // for the "adaptation_field_length" and flags
-      numPCRBytes = 6;
-      if (numBytesAvailable >= TRANSPORT_PACKET_SIZE - numHeaderBytes - numPCRBytes) {
-	numDataBytes = TRANSPORT_PACKET_SIZE - numHeaderBytes - numPCRBytes;
-      } else {
-	numDataBytes = numBytesAvailable;
-	numPaddingBytes
-	  = TRANSPORT_PACKET_SIZE - numHeaderBytes - numPCRBytes - numDataBytes;
-      }
-    } else if (numBytesAvailable >= TRANSPORT_PACKET_SIZE - numHeaderBytes) {
-      // This is the common case
-      adaptation_field_control = 0x10;
-      numDataBytes = TRANSPORT_PACKET_SIZE - numHeaderBytes;
+  // Construct a new Transport packet, and append it to the data for the client:
+  // (Our caller has checked that there's room for it.)
+  MPEG1or2Demux::SCR const& pcr = fPrograms[fCurrentProgram].pcr; // alias
+  Boolean willAddPCR = pid == fPrograms[fCurrentProgram].pcrPID && pid != 0
+    && startPositionInBuffer == 0
+    && !(pcr.highBit == 0 && pcr.remainingBits == 0 && pcr.extension == 0);
+  unsigned const numBytesAvailable = bufferSize - startPositionInBuffer;
+  unsigned numHeaderBytes = 4; // by default
+  unsigned numPCRBytes = 0; // by default
+  unsigned numPaddingBytes = 0; // by default
+  unsigned numDataBytes;
+  u_int8_t adaptation_field_control;
+  if (willAddPCR) {
+    adaptation_field_control = 0x30;
+    numHeaderBytes += 2; // for the "adaptation_field_length" and flags
+    numPCRBytes = 6;
+    if (numBytesAvailable >= TRANSPORT_PACKET_SIZE - numHeaderBytes - numPCRBytes) {
+      numDataBytes = TRANSPORT_PACKET_SIZE - numHeaderBytes - numPCRBytes;
     } else {
-      adaptation_field_control = 0x30;
-      ++numHeaderBytes; // for the "adaptation_field_length"
-      // ASSERT: numBytesAvailable <= TRANSPORT_PACKET_SIZE - numHeaderBytes
       numDataBytes = numBytesAvailable;
-      if (numDataBytes < TRANSPORT_PACKET_SIZE - numHeaderBytes) {
-	++numHeaderBytes; // for the adaptation field flags
-	numPaddingBytes = TRANSPORT_PACKET_SIZE - numHeaderBytes - numDataBytes;
-      }
+      numPaddingBytes
+	= TRANSPORT_PACKET_SIZE - numHeaderBytes - numPCRBytes - numDataBytes;
+    }
+  } else if (numBytesAvailable >= TRANSPORT_PACKET_SIZE - numHeaderBytes) {
+    // This is the common case
+    adaptation_field_control = 0x10;
+    numDataBytes = TRANSPORT_PACKET_SIZE - numHeaderBytes;
+  } else {
+    adaptation_field_control = 0x30;
+    ++numHeaderBytes; // for the "adaptation_field_length"
+    // ASSERT: numBytesAvailable <= TRANSPORT_PACKET_SIZE - numHeaderBytes
+    numDataBytes = numBytesAvailable;
+    if (numDataBytes < TRANSPORT_PACKET_SIZE - numHeaderBytes) {
+      ++numHeaderBytes; // for the adaptation field flags
+      numPaddingBytes = TRANSPORT_PACKET_SIZE - numHeaderBytes - numDataBytes;
     }
-    // ASSERT: numHeaderBytes+numPCRBytes+numPaddingBytes+numDataBytes
-    //         == TRANSPORT_PACKET_SIZE
-
-    // Fill in the header of the Transport Stream packet:
-    unsigned char* header = fTo;
-    *header++ = 0x47; // sync_byte
-    *header++ = (startPositionInBuffer == 0) ? 0x40 : 0x00;
-      // transport_error_indicator, payload_unit_start_indicator, transport_priority,
-      // first 5 bits of PID
-    *header++ = pid;
-      // last 8 bits of PID
-    unsigned& continuity_counter = fPIDState[pid].counter; // alias
-    *header++ = adaptation_field_control|(continuity_counter&0x0F);
-      // transport_scrambling_control, adaptation_field_control, continuity_counter
-    ++continuity_counter;
-    if (adaptation_field_control == 0x30) {
-      // Add an adaptation field:
-      u_int8_t adaptation_field_length
-	= (numHeaderBytes == 5) ? 0 : 1 + numPCRBytes + numPaddingBytes;
-      *header++ = adaptation_field_length;
-      if (numHeaderBytes > 5) {
-	u_int8_t flags = willAddPCR ? 0x10 : 0x00;
-	if (fIsFirstAdaptationField) {
-	  flags |= 0x80; // discontinuity_indicator
-	  fIsFirstAdaptationField = False;
-	}
-	*header++ = flags;
-	if (willAddPCR) {
-	  u_int32_t pcrHigh32Bits = (fPCR.highBit<<31) | (fPCR.remainingBits>>1);
-	  u_int8_t pcrLowBit = fPCR.remainingBits&1;
-	  u_int8_t extHighBit = (fPCR.extension&0x100)>>8;
-	  *header++ = pcrHigh32Bits>>24;
-	  *header++ = pcrHigh32Bits>>16;
-	  *header++ = pcrHigh32Bits>>8;
-	  *header++ = pcrHigh32Bits;
-	  *header++ = (pcrLowBit<<7)|0x7E|extHighBit;
-	  *header++ = (u_int8_t)fPCR.extension; // low 8 bits of extension
-	}
+  }
+  // ASSERT: numHeaderBytes+numPCRBytes+numPaddingBytes+numDataBytes
+  //         == TRANSPORT_PACKET_SIZE
+
+  // Fill in the header of the Transport Stream packet:
+  unsigned char* header = &fTo[fFrameSize];
+  fFrameSize += TRANSPORT_PACKET_SIZE;
+  *header++ = 0x47; // sync_byte
+  *header++ = ((startPositionInBuffer == 0) ? 0x40 : 0x00)|(pid>>8);
+    // transport_error_indicator, payload_unit_start_indicator, transport_priority,
+    // first 5 bits of PID
+  *header++ = (u_int8_t)pid;
+    // last 8 bits of PID
+  unsigned& continuity_counter = fPIDState[pid].counter; // alias
+  *header++ = adaptation_field_control|(continuity_counter&0x0F);
+    // transport_scrambling_control, adaptation_field_control, continuity_counter
+  ++continuity_counter;
+  if (adaptation_field_control == 0x30) {
+    // Add an adaptation field:
+    u_int8_t adaptation_field_length
+      = (numHeaderBytes == 5) ? 0 : 1 + numPCRBytes + numPaddingBytes;
+    *header++ = adaptation_field_length;
+    if (numHeaderBytes > 5) {
+      u_int8_t flags = willAddPCR ? 0x10 : 0x00;
+      if (fIsFirstAdaptationField) {
+	flags |= 0x80; // discontinuity_indicator
+	fIsFirstAdaptationField = False;
+      }
+      *header++ = flags;
+      if (willAddPCR) {
+	u_int32_t pcrHigh32Bits = (pcr.highBit<<31) | (pcr.remainingBits>>1);
+	u_int8_t pcrLowBit = pcr.remainingBits&1;
+	u_int8_t extHighBit = (pcr.extension&0x100)>>8;
+	*header++ = pcrHigh32Bits>>24;
+	*header++ = pcrHigh32Bits>>16;
+	*header++ = pcrHigh32Bits>>8;
+	*header++ = pcrHigh32Bits;
+	*header++ = (pcrLowBit<<7)|0x7E|extHighBit;
+	*header++ = (u_int8_t)pcr.extension; // low 8 bits of extension
       }
     }
+  }
 
-    // Add any padding bytes:
-    for (unsigned i = 0; i < numPaddingBytes; ++i) *header++ = 0xFF;
+  // Add any padding bytes:
+  for (unsigned i = 0; i < numPaddingBytes; ++i) *header++ = 0xFF;
 
-    // Finally, add the data bytes:
-    memmove(header, &buffer[startPositionInBuffer], numDataBytes);
-    startPositionInBuffer += numDataBytes;
-  }
+  // Finally, add the data bytes:
+  memmove(header, &buffer[startPositionInBuffer], numDataBytes);
+  startPositionInBuffer += numDataBytes;
 }
 
-static u_int32_t calculateCRC(u_int8_t* data, unsigned dataLength); // forward
-
-#define PAT_PID 0
-#define OUR_PROGRAM_NUMBER 1
-#define OUR_PROGRAM_MAP_PID 0x10
+static u_int32_t calculateCRC(u_int8_t const* data, unsigned dataLength); // forward
 
 void MPEG2TransportStreamMultiplexor::deliverPATPacket() {
-  // First, create a new buffer for the PAT packet:
-  unsigned const patSize = TRANSPORT_PACKET_SIZE - 4; // allow for the 4-byte header
-  unsigned char* patBuffer = new unsigned char[patSize];
+  if (fPATIsStale) buildPAT();
+
+  // Deliver the packet:
+  unsigned startPosition = 0;
+  deliverDataToClient(PAT_PID, fPATPayload, PSI_PAYLOAD_SIZE, startPosition);
+}
+
+void MPEG2TransportStreamMultiplexor::deliverPMTPacket(unsigned programIndex, Boolean hasChanged) {
+  MPEG2TransportStreamProgramState& program = fPrograms[programIndex]; // alias
+  if (hasChanged) {
+    ++program.programMapVersion;
+    program.pmtIsStale = True;
+  }
+  if (program.pmtIsStale) buildPMT(programIndex);
+
+  // Deliver the packet:
+  unsigned startPosition = 0;
+  deliverDataToClient(OUR_PROGRAM_MAP_PID + programIndex, program.pmtPayload, PSI_PAYLOAD_SIZE,
+		      startPosition);
+}
 
-  // and fill it in:
-  unsigned char* pat = patBuffer;
+void MPEG2TransportStreamMultiplexor::buildPAT() {
+  unsigned char* pat = fPATPayload;
   *pat++ = 0; // pointer_field
   *pat++ = 0; // table_id
-  *pat++ = 0xB0; // section_syntax_indicator; 0; reserved, section_length (high)
-  *pat++ = 13; // section_length (low)
+  unsigned const section_length = 5 + 4*fNumPrograms + 4 /*for CRC*/;
+  *pat++ = 0xB0|(section_length>>8); // section_syntax_indicator; 0; reserved, section_length (high)
+  *pat++ = section_length; // section_length (low)
   *pat++ = 0; *pat++ = 1; // transport_stream_id
-  *pat++ = 0xC3; // reserved; version_number; current_next_indicator
+  *pat++ = 0xC1|((fPATVersion&0x1F)<<1); // reserved; version_number; current_next_indicator
   *pat++ = 0; // section_number
   *pat++ = 0; // last_section_number
-  *pat++ = OUR_PROGRAM_NUMBER>>8; *pat++ = OUR_PROGRAM_NUMBER; // program_number
-  *pat++ = 0xE0|(OUR_PROGRAM_MAP_PID>>8); // reserved; program_map_PID (high)
-  *pat++ = OUR_PROGRAM_MAP_PID; // program_map_PID (low)
+  for (unsigned p = 0; p < fNumPrograms; ++p) {
+    u_int16_t const programNumber = fPrograms[p].programNumber;
+    u_int16_t const programMapPID = OUR_PROGRAM_MAP_PID + p;
+    *pat++ = programNumber>>8; *pat++ = programNumber; // program_number
+    *pat++ = 0xE0|(programMapPID>>8); // reserved; program_map_PID (high)
+    *pat++ = programMapPID; // program_map_PID (low)
+  }
 
   // Compute the CRC from the bytes we currently have (not including "pointer_field"):
-  u_int32_t crc = calculateCRC(patBuffer+1, pat - (patBuffer+1));
+  u_int32_t crc = calculateCRC(fPATPayload+1, pat - (fPATPayload+1));
   *pat++ = crc>>24; *pat++ = crc>>16; *pat++ = crc>>8; *pat++ = crc;
 
   // Fill in the rest of the packet with padding bytes:
-  while (pat < &patBuffer[patSize]) *pat++ = 0xFF;
+  while (pat < &fPATPayload[PSI_PAYLOAD_SIZE]) *pat++ = 0xFF;
 
-  // Deliver the packet:
-  unsigned startPosition = 0;
-  deliverDataToClient(PAT_PID, patBuffer, patSize, startPosition);
-
-  // Finally, remove the new buffer:
-  delete[] patBuffer;
+  fPATIsStale = False;
 }
 
-void MPEG2TransportStreamMultiplexor::deliverPMTPacket(Boolean hasChanged) {
-  if (hasChanged) ++fProgramMapVersion;
-
-  // First, create a new buffer for the PMT packet:
-  unsigned const pmtSize = TRANSPORT_PACKET_SIZE - 4; // allow for the 4-byte header
-  unsigned char* pmtBuffer = new unsigned char[pmtSize];
-
-  // and fill it in:
+void MPEG2TransportStreamMultiplexor::buildPMT(unsigned programIndex) {
+  MPEG2TransportStreamProgramState& program = fPrograms[programIndex]; // alias
+  unsigned char* pmtBuffer = program.pmtPayload;
   unsigned char* pmt = pmtBuffer;
   *pmt++ = 0; // pointer_field
   *pmt++ = 2; // table_id
   *pmt++ = 0xB0; // section_syntax_indicator; 0; reserved, section_length (high)
   unsigned char* section_lengthPtr = pmt; // save for later
   *pmt++ = 0; // section_length (low) (fill in later)
-  *pmt++ = OUR_PROGRAM_NUMBER>>8; *pmt++ = OUR_PROGRAM_NUMBER; // program_number
-  *pmt++ = 0xC1|((fProgramMapVersion&0x1F)<<1); // reserved; version_number; current_next_indicator
+  *pmt++ = program.programNumber>>8; *pmt++ = program.programNumber; // program_number
+  *pmt++ = 0xC1|((program.programMapVersion&0x1F)<<1); // reserved; version_number; current_next_indicator
   *pmt++ = 0; // section_number
   *pmt++ = 0; // last_section_number
-  *pmt++ = 0xE0; // reserved; PCR_PID (high)
-  *pmt++ = fPCR_PID; // PCR_PID (low)
+  *pmt++ = 0xE0|(program.pcrPID>>8); // reserved; PCR_PID (high)
+  *pmt++ = program.pcrPID; // PCR_PID (low)
   *pmt++ = 0xF0; // reserved; program_info_length (high)
   *pmt++ = 0; // program_info_length (low)
-  for (int pid = 0; pid < PID_TABLE_SIZE; ++pid) {
+  unsigned const firstPID = programIndex<<8;
+  for (unsigned pid = firstPID; pid < firstPID + 256; ++pid) {
     if (fPIDState[pid].streamType != 0) {
-      // This PID gets recorded in the table
+      // This PID gets recorded in the table (if there's room for it, and the CRC):
+      if (pmt + 5 + 4 > &pmtBuffer[PSI_PAYLOAD_SIZE]) break;
       *pmt++ = fPIDState[pid].streamType;
-      *pmt++ = 0xE0; // reserved; elementary_pid (high)
+      *pmt++ = 0xE0|(pid>>8); // reserved; elementary_pid (high)
       *pmt++ = pid; // elementary_pid (low)
       *pmt++ = 0xF0; // reserved; ES_info_length (high)
       *pmt++ = 0; // ES_info_length (low)
@@ -307,14 +410,9 @@ void MPEG2TransportStreamMultiplexor::deliverPMTPacket(Boolean hasChanged) {
   *pmt++ = crc>>24; *pmt++ = crc>>16; *pmt++ = crc>>8; *pmt++ = crc;
 
   // Fill in the rest of the packet with padding bytes:
-  while (pmt < &pmtBuffer[pmtSize]) *pmt++ = 0xFF;
+  while (pmt < &pmtBuffer[PSI_PAYLOAD_SIZE]) *pmt++ = 0xFF;
 
-  // Deliver the packet:
-  unsigned startPosition = 0;
-  deliverDataToClient(OUR_PROGRAM_MAP_PID, pmtBuffer, pmtSize, startPosition);
-
-  // Finally, remove the new buffer:
-  delete[] pmtBuffer;
+  program.pmtIsStale = False;
 }
 
 void MPEG2TransportStreamMultiplexor::setProgramStreamMap(unsigned frameSize) {
@@ -328,7 +426,7 @@ void MPEG2TransportStreamMultiplexor::setProgramStreamMap(unsigned frameSize) {
 
   u_int8_t versionByte = fInputBuffer[6];
   if ((versionByte&0x80) == 0) return; // "current_next_indicator" is not set
-  fCurrentInputProgramMapVersion = versionByte&0x1F;
+  fPrograms[fCurrentProgram].currentInputProgramMapVersion = versionByte&0x1F;
 
   u_int16_t program_stream_info_length = (fInputBuffer[8]<<8) | fInputBuffer[9];
   unsigned offset = 10 + program_stream_info_length; // skip over 'descriptors'
@@ -345,7 +443,7 @@ void MPEG2TransportStreamMultiplexor::setProgramStreamMap(unsigned frameSize) {
     u_int8_t stream_type = fInputBuffer[offset];
     u_int8_t elementary_stream_id = fInputBuffer[offset+1];
 
-    fPIDState[elementary_stream_id].streamType = stream_type;
+    fPIDState[(fCurrentProgram<<8)|elementary_stream_id].streamType = stream_type;
 
     u_int16_t elementary_stream_info_length
       = (fInputBuffer[offset+2]<<8) | fInputBuffer[offset+3];
@@ -420,9 +518,38 @@ static u_int32_t CRC32[256] = {
   0xbcb4666d, 0xb8757bda, 0xb5365d03, 0xb1f740b4
 };
 
-static u_int32_t calculateCRC(u_int8_t* data, unsigned dataLength) {
+// For "slice-by-8" CRC computation: "CRC32_8[k][i]" is the CRC contribution of byte "i"
+// followed by "k" zero bytes.  ("CRC32_8[0]" is the same as "CRC32".)
+static u_int32_t CRC32_8[8][256];
+static Boolean haveInitializedCRC32_8 = False;
+
+static void initCRC32_8() {
+  for (unsigned i = 0; i < 256; ++i) CRC32_8[0][i] = CRC32[i];
+  for (unsigned k = 1; k < 8; ++k) {
+    for (unsigned i = 0; i < 256; ++i) {
+      u_int32_t const prev = CRC32_8[k-1][i];
+      CRC32_8[k][i] = (prev<<8) ^ CRC32[prev>>24];
+    }
+  }
+  haveInitializedCRC32_8 = True;
+}
+
+static u_int32_t calculateCRC(u_int8_t const* data, unsigned dataLength) {
+  if (!haveInitializedCRC32_8) initCRC32_8();
   u_int32_t crc = 0xFFFFFFFF;
 
+  // Handle 8 bytes at a time:
+  while (dataLength >= 8) {
+    crc ^= (data[0]<<24)|(data[1]<<16)|(data[2]<<8)|data[3];
+    crc = CRC32_8[7][crc>>24] ^ CRC32_8[6][(crc>>16)&0xFF]
+      ^ CRC32_8[5][(crc>>8)&0xFF] ^ CRC32_8[4][crc&0xFF]
+      ^ CRC32_8[3][data[4]] ^ CRC32_8[2][data[5]]
+      ^ CRC32_8[1][data[6]] ^ CRC32_8[0][data[7]];
+    data += 8;
+    dataLength -= 8;
+  }
+
+  // Then, any remaining bytes, one at a time:
   while (dataLength-- > 0) {
     crc = (crc<<8) ^ CRC32[(crc>>24) ^ (u_int32_t)(*data++)];
   }
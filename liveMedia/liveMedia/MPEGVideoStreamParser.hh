@@ -66,37 +66,45 @@ protected:
     *fTo++ = word>>24; *fTo++ = word>>16; *fTo++ = word>>8; *fTo++ = word;
   }
 
+  // Record the next "numBytes" input bytes in the current output frame:
+  void saveBytes(unsigned numBytes) {
+    unsigned numBytesToCopy = numBytes;
+    if (fTo + numBytesToCopy > fLimit) { // there's not enough space left
+      numBytesToCopy = fLimit - fTo;
+      fNumTruncatedBytes += numBytes - numBytesToCopy;
+    }
+
+    testBytes(fTo, numBytesToCopy);
+    fTo += numBytesToCopy;
+    skipBytes(numBytes);
+  }
+
   // Save data until we see a sync word (0x000001xx):
   void saveToNextCode(u_int32_t& curWord) {
     saveByte(curWord>>24);
-    curWord = (curWord<<8)|get1Byte();
-    while ((curWord&0xFFFFFF00) != 0x00000100) {
-      if ((unsigned)(curWord&0xFF) > 1) {
-	// a sync word definitely doesn't begin anywhere in "curWord"
-	save4Bytes(curWord);
-	curWord = get4Bytes();
-      } else {
-	// a sync word might begin in "curWord", although not at its start
-	saveByte(curWord>>24);
-	unsigned char newByte = get1Byte();
-	curWord = (curWord<<8)|newByte;
-      }
+    // First, check - one byte at a time - for a sync word that begins in the rest of "curWord":
+    for (unsigned i = 0; i < 3; ++i) {
+      curWord = (curWord<<8)|get1Byte();
+      if ((curWord&0xFFFFFF00) == 0x00000100) return;
+      saveByte(curWord>>24);
     }
+
+    // Then scan for one, starting with the 3 (unsaved) bytes that we just read:
+    ungetBytes(3);
+    saveBytes(numBytesToNextStartCode());
+    curWord = get4Bytes();
   }
 
   // Skip data until we see a sync word (0x000001xx):
   void skipToNextCode(u_int32_t& curWord) {
-    curWord = (curWord<<8)|get1Byte();
-    while ((curWord&0xFFFFFF00) != 0x00000100) {
-      if ((unsigned)(curWord&0xFF) > 1) {
-	// a sync word definitely doesn't begin anywhere in "curWord"
-	curWord = get4Bytes();
-      } else {
-	// a sync word might begin in "curWord", although not at its start
-	unsigned char newByte = get1Byte();
-	curWord = (curWord<<8)|newByte;
-      }
+    for (unsigned i = 0; i < 3; ++i) {
+      curWord = (curWord<<8)|get1Byte();
+      if ((curWord&0xFFFFFF00) == 0x00000100) return;
     }
+
+    ungetBytes(3);
+    skipBytes(numBytesToNextStartCode());
+    curWord = get4Bytes();
   }
 
 protected:
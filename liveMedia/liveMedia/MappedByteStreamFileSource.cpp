@@ -0,0 +1,208 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A file source that is a plain byte stream (rather than frames), read
+// through a (sliding) memory-mapped window of the file.
+// Implementation
+
+#include "MappedByteStreamFileSource.hh"
+#include "InputFile.hh"
+#include "GroupsockHelper.hh"
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// We map the file a window at a time, so that very large recordings don't use up
+// our (32-bit) address space.  (This must be a multiple of the page size.)
+#ifndef MAPPED_FILE_WINDOW_SIZE
+#define MAPPED_FILE_WINDOW_SIZE (4*1024*1024)
+#endif
+
+////////// MappedByteStreamFileSource //////////
+
+MappedByteStreamFileSource*
+MappedByteStreamFileSource::createNew(UsageEnvironment& env, char const* fileName,
+				      unsigned preferredFrameSize,
+				      unsigned playTimePerFrame,
+				      unsigned frameGranularity) {
+  FILE* fid = OpenInputFile(env, fileName);
+  if (fid == NULL) return NULL;
+
+  struct stat sb;
+  if (fid == stdin || fstat(fileno(fid), &sb) != 0 || !S_ISREG(sb.st_mode)) {
+    env.setResultMsg("\"", fileName, "\" is not a regular file, so cannot be memory-mapped");
+    if (fid != stdin) CloseInputFile(fid);
+    return NULL;
+  }
+
+  MappedByteStreamFileSource* newSource
+    = new MappedByteStreamFileSource(env, fid, preferredFrameSize,
+				     playTimePerFrame, frameGranularity);
+  newSource->fFileSize = (u_int64_t)sb.st_size;
+
+  return newSource;
+}
+
+MappedByteStreamFileSource
+::MappedByteStreamFileSource(UsageEnvironment& env, FILE* fid,
+			     unsigned preferredFrameSize,
+			     unsigned playTimePerFrame,
+			     unsigned frameGranularity)
+  : ByteStreamFileSource(env, fid, True, preferredFrameSize, playTimePerFrame),
+    fFrameGranularity(frameGranularity == 0 ? 1 : frameGranularity),
+    fCurOffset(0), fWindow(NULL), fWindowOffset(0), fWindowSize(0) {
+}
+
+MappedByteStreamFileSource::~MappedByteStreamFileSource() {
+  envir().taskScheduler().unscheduleDelayedTask(nextTask());
+  unmapWindow();
+}
+
+void MappedByteStreamFileSource
+::seekToByteAbsolute(u_int64_t byteNumber, u_int64_t numBytesToStream) {
+  fCurOffset = byteNumber;
+  fNumBytesToStream = numBytesToStream;
+  fLimitNumBytesToStream = fNumBytesToStream > 0;
+}
+
+void MappedByteStreamFileSource::seekToByteRelative(int64_t offset) {
+  if (offset < 0 && (u_int64_t)(-offset) > fCurOffset) {
+    fCurOffset = 0;
+  } else {
+    fCurOffset += offset;
+  }
+}
+
+Boolean MappedByteStreamFileSource::canDeliverFrameReferences() const {
+  return True;
+}
+
+void MappedByteStreamFileSource::unmapWindow() {
+  if (fWindow != NULL) {
+    munmap(fWindow, fWindowSize);
+    fWindow = NULL;
+    fWindowSize = 0;
+  }
+}
+
+Boolean MappedByteStreamFileSource::mapWindowFor(u_int64_t offset, unsigned size) {
+  if (fWindow != NULL && offset >= fWindowOffset
+      && offset + size <= fWindowOffset + fWindowSize) {
+    return True; // already mapped
+  }
+  unmapWindow();
+
+  static u_int64_t const pageMask = (u_int64_t)sysconf(_SC_PAGESIZE) - 1;
+  u_int64_t windowOffset = offset&~pageMask;
+  u_int64_t windowEnd = windowOffset + MAPPED_FILE_WINDOW_SIZE;
+  if (windowEnd < offset + size) windowEnd = (offset + size + pageMask)&~pageMask;
+  if (windowEnd > fFileSize) windowEnd = fFileSize;
+  if (windowEnd <= windowOffset) return False;
+
+  unsigned windowSize = (unsigned)(windowEnd - windowOffset);
+  void* window = mmap(NULL, windowSize, PROT_READ, MAP_SHARED, fileno(fFid), (off_t)windowOffset);
+  if (window == MAP_FAILED) {
+    envir().setResultErrMsg("MappedByteStreamFileSource: mmap() failed: ");
+    return False;
+  }
+#ifdef MADV_SEQUENTIAL
+  madvise(window, windowSize, MADV_SEQUENTIAL);
+#endif
+
+  fWindow = (unsigned char*)window;
+  fWindowOffset = windowOffset;
+  fWindowSize = windowSize;
+  return True;
+}
+
+void MappedByteStreamFileSource::doGetNextFrame() {
+  if (fCurOffset >= fFileSize) {
+    // The file may still be growing (e.g., if it's being recorded); check again:
+    struct stat sb;
+    if (fstat(fileno(fFid), &sb) == 0) fFileSize = (u_int64_t)sb.st_size;
+  }
+  if (fCurOffset >= fFileSize || (fLimitNumBytesToStream && fNumBytesToStream == 0)) {
+    handleClosure(this);
+    return;
+  }
+
+  // Figure out how many bytes to deliver:
+  unsigned maxSize = fMaxSize;
+  if (fTo == NULL && (maxSize == 0 || maxSize > MAPPED_FILE_WINDOW_SIZE)) maxSize = MAPPED_FILE_WINDOW_SIZE;
+  if (fLimitNumBytesToStream && fNumBytesToStream < (u_int64_t)maxSize) {
+    maxSize = (unsigned)fNumBytesToStream;
+  }
+  if (fPreferredFrameSize > 0 && fPreferredFrameSize < maxSize) {
+    maxSize = fPreferredFrameSize;
+  }
+  u_int64_t const bytesLeftInFile = fFileSize - fCurOffset;
+  if (bytesLeftInFile < (u_int64_t)maxSize) {
+    maxSize = (unsigned)bytesLeftInFile;
+  } else if (maxSize > fFrameGranularity) {
+    maxSize -= maxSize%fFrameGranularity;
+  }
+
+  if (!mapWindowFor(fCurOffset, maxSize)) {
+    handleClosure(this);
+    return;
+  }
+  unsigned char const* data = &fWindow[fCurOffset - fWindowOffset];
+
+  if (fTo == NULL) {
+    fFrameReference = data; // zero-copy delivery
+  } else {
+    memmove(fTo, data, maxSize);
+  }
+  fFrameSize = maxSize;
+  fCurOffset += maxSize;
+  fNumBytesToStream -= fFrameSize;
+
+  // Set the 'presentation time':
+  if (fPlayTimePerFrame > 0 && fPreferredFrameSize > 0) {
+    if (fPresentationTime.tv_sec == 0 && fPresentationTime.tv_usec == 0) {
+      // This is the first frame, so use the current time:
+      gettimeofday(&fPresentationTime, NULL);
+    } else {
+      // Increment by the play time of the previous data:
+      unsigned uSeconds	= fPresentationTime.tv_usec + fLastPlayTime;
+      fPresentationTime.tv_sec += uSeconds/1000000;
+      fPresentationTime.tv_usec = uSeconds%1000000;
+    }
+
+    // Remember the play time of this data:
+    fLastPlayTime = (fPlayTimePerFrame*fFrameSize)/fPreferredFrameSize;
+    fDurationInMicroseconds = fLastPlayTime;
+  } else {
+    // We don't know a specific play time duration for this data,
+    // so just record the current time as being the 'presentation time':
+    gettimeofday(&fPresentationTime, NULL);
+  }
+
+  // To avoid possible infinite recursion, we need to return to the event loop to
+  // deliver the data.  (Note that - as with synchronous reads - touching a page that
+  // isn't yet in the page cache can block; "MADV_SEQUENTIAL" makes this unlikely.)
+  nextTask() = envir().taskScheduler().scheduleDelayedTask(0, deliverFrame, this);
+}
+
+void MappedByteStreamFileSource::deliverFrame(void* clientData) {
+  MappedByteStreamFileSource* source = (MappedByteStreamFileSource*)clientData;
+  source->nextTask() = NULL;
+  FramedSource::afterGetting(source);
+}
+
+void MappedByteStreamFileSource::doStopGettingFrames() {
+  envir().taskScheduler().unscheduleDelayedTask(nextTask());
+}
@@ -95,26 +95,58 @@ Boolean MediaSession::isMediaSession() const {
 Boolean MediaSession::initializeWithSDP(char const* sdpDescription) {
   if (sdpDescription == NULL) return False;
 
+  // We parse a single copy of the SDP description, in which each line gets
+  // '\0'-terminated in place.  Each line can then be parsed without copying it:
+  char* sdpLines = strDup(sdpDescription);
+  Boolean result = initializeWithSDPLines(sdpLines, sdpDescription);
+  delete[] sdpLines;
+
+  return result;
+}
+
+// Returns True iff "sdpLine" is a "a=<attributeName>:..." line:
+static Boolean isSDPAttribute(char const* sdpLine, char const* attributeName) {
+  if (sdpLine[0] != 'a') return False;
+
+  unsigned const attributeNameLength = strlen(attributeName);
+  return strncmp(&sdpLine[2], attributeName, attributeNameLength) == 0
+    && sdpLine[2+attributeNameLength] == ':';
+}
+
+static char* strDupSubstring(char const* str, unsigned length) {
+  char* result = new char[length+1];
+  memmove(result, str, length);
+  result[length] = '\0';
+
+  return result;
+}
+
+Boolean MediaSession::initializeWithSDPLines(char* sdpLines, char const* sdpDescription) {
   // Begin by processing all SDP lines until we see the first "m="
-  char const* sdpLine = sdpDescription;
-  char const* nextSDPLine;
-  while (1) {
+  char* sdpLine = sdpLines;
+  char* nextSDPLine;
+  while (sdpLine != NULL) {
     if (!parseSDPLine(sdpLine, nextSDPLine)) return False;
     //##### We should really check for:
     // - "a=control:" attributes (to set the URL for aggregate control)
     // - the correct SDP version (v=0)
     if (sdpLine[0] == 'm') break;
-    sdpLine = nextSDPLine;
-    if (sdpLine == NULL) break; // there are no m= lines at all
-
-    // Check for various special SDP lines that we understand:
-    if (parseSDPLine_s(sdpLine)) continue;
-    if (parseSDPLine_i(sdpLine)) continue;
-    if (parseSDPLine_c(sdpLine)) continue;
-    if (parseSDPAttribute_control(sdpLine)) continue;
-    if (parseSDPAttribute_range(sdpLine)) continue;
-    if (parseSDPAttribute_type(sdpLine)) continue;
-    if (parseSDPAttribute_source_filter(sdpLine)) continue;
+
+    // Check for various special SDP lines that we understand.  (We look at each
+    // line's type - and attribute name - just once, to choose which parser to try.)
+    switch (sdpLine[0]) {
+      case 's': parseSDPLine_s(sdpLine); break;
+      case 'i': parseSDPLine_i(sdpLine); break;
+      case 'c': parseSDPLine_c(sdpLine); break;
+      case 'a': {
+	if (isSDPAttribute(sdpLine, "control")) parseSDPAttribute_control(sdpLine);
+	else if (isSDPAttribute(sdpLine, "range")) parseSDPAttribute_range(sdpLine);
+	else if (isSDPAttribute(sdpLine, "type")) parseSDPAttribute_type(sdpLine);
+	else if (isSDPAttribute(sdpLine, "source-filter")) parseSDPAttribute_source_filter(sdpLine);
+	break;
+      }
+    }
+    sdpLine = nextSDPLine; // if NULL, there are no m= lines at all
   }
 
   while (sdpLine != NULL) {
@@ -155,15 +187,7 @@ Boolean MediaSession::initializeWithSDP(char const* sdpDescription) {
       protocolName = "UDP";
     } else {
       // This "m=" line is bad; output an error message saying so:
-      char* sdpLineStr;
-      if (nextSDPLine == NULL) {
-	sdpLineStr = (char*)sdpLine;
-      } else {
-	sdpLineStr = strDup(sdpLine);
-	sdpLineStr[nextSDPLine-sdpLine] = '\0';
-      }
-      envir() << "Bad SDP \"m=\" line: " <<  sdpLineStr << "\n";
-      if (sdpLineStr != (char*)sdpLine) delete[] sdpLineStr;
+      envir() << "Bad SDP \"m=\" line: " <<  sdpLine << "\n";
 
       delete[] mediumName;
       delete subsession;
@@ -189,8 +213,8 @@ Boolean MediaSession::initializeWithSDP(char const* sdpDescription) {
 
     subsession->serverPortNum = subsession->fClientPortNum; // by default
 
-    char const* mStart = sdpLine;
-    subsession->fSavedSDPLines = strDup(mStart);
+    // (Our copy of the SDP lines has been modified, so we save them from the original:)
+    char const* mStart = &sdpDescription[sdpLine - sdpLines];
 
     subsession->fMediumName = strDup(mediumName);
     delete[] mediumName;
@@ -206,19 +230,26 @@ Boolean MediaSession::initializeWithSDP(char const* sdpDescription) {
       if (sdpLine[0] == 'm') break; // we've reached the next subsession
 
       // Check for various special SDP lines that we understand:
-      if (subsession->parseSDPLine_c(sdpLine)) continue;
-      if (subsession->parseSDPLine_b(sdpLine)) continue;
-      if (subsession->parseSDPAttribute_rtpmap(sdpLine)) continue;
-      if (subsession->parseSDPAttribute_control(sdpLine)) continue;
-      if (subsession->parseSDPAttribute_range(sdpLine)) continue;
-      if (subsession->parseSDPAttribute_fmtp(sdpLine)) continue;
-      if (subsession->parseSDPAttribute_source_filter(sdpLine)) continue;
-      if (subsession->parseSDPAttribute_x_dimensions(sdpLine)) continue;
-      if (subsession->parseSDPAttribute_framerate(sdpLine)) continue;
+      switch (sdpLine[0]) {
+        case 'c': subsession->parseSDPLine_c(sdpLine); break;
+        case 'b': subsession->parseSDPLine_b(sdpLine); break;
+        case 'a': {
+	  if (isSDPAttribute(sdpLine, "rtpmap")) subsession->parseSDPAttribute_rtpmap(sdpLine);
+	  else if (isSDPAttribute(sdpLine, "control")) subsession->parseSDPAttribute_control(sdpLine);
+	  else if (isSDPAttribute(sdpLine, "range")) subsession->parseSDPAttribute_range(sdpLine);
+	  else if (isSDPAttribute(sdpLine, "fmtp")) subsession->parseSDPAttribute_fmtp(sdpLine);
+	  else if (isSDPAttribute(sdpLine, "source-filter")) subsession->parseSDPAttribute_source_filter(sdpLine);
+	  else if (isSDPAttribute(sdpLine, "x-dimensions")) subsession->parseSDPAttribute_x_dimensions(sdpLine);
+	  else if (isSDPAttribute(sdpLine, "framerate")
+		   || isSDPAttribute(sdpLine, "x-framerate")) subsession->parseSDPAttribute_framerate(sdpLine);
+	  break;
+	}
+      }
 
       // (Later, check for malformed lines, and other valid SDP lines#####)
     }
-    if (sdpLine != NULL) subsession->fSavedSDPLines[sdpLine-mStart] = '\0';
+    char const* mEnd = sdpLine != NULL ? &sdpDescription[sdpLine - sdpLines] : mStart + strlen(mStart);
+    subsession->fSavedSDPLines = strDupSubstring(mStart, mEnd - mStart);
 
     // If we don't yet know the codec name, try looking it up from the
     // list of static payload types:
@@ -250,14 +281,14 @@ Boolean MediaSession::initializeWithSDP(char const* sdpDescription) {
   return True;
 }
 
-Boolean MediaSession::parseSDPLine(char const* inputLine,
-				   char const*& nextLine){
-  // Begin by finding the start of the next line (if any):
+Boolean MediaSession::parseSDPLine(char* inputLine, char*& nextLine) {
+  // Begin by finding the start of the next line (if any), and '\0'-terminating this one:
+  Boolean const isBlankLine = inputLine[0] == '\r' || inputLine[0] == '\n';
   nextLine = NULL;
-  for (char const* ptr = inputLine; *ptr != '\0'; ++ptr) {
+  for (char* ptr = inputLine; *ptr != '\0'; ++ptr) {
     if (*ptr == '\r' || *ptr == '\n') {
       // We found the end of the line
-      ++ptr;
+      *ptr++ = '\0';
       while (*ptr == '\r' || *ptr == '\n') ++ptr;
       nextLine = ptr;
       if (nextLine[0] == '\0') nextLine = NULL; // special case for end
@@ -267,9 +298,8 @@ Boolean MediaSession::parseSDPLine(char const* inputLine,
 
   // Then, check that this line is a SDP line of the form <char>=<etc>
   // (However, we also accept blank lines in the input.)
-  if (inputLine[0] == '\r' || inputLine[0] == '\n') return True;
-  if (strlen(inputLine) < 2 || inputLine[1] != '='
-      || inputLine[0] < 'a' || inputLine[0] > 'z') {
+  if (isBlankLine) return True;
+  if (inputLine[0] < 'a' || inputLine[0] > 'z' || inputLine[1] != '=') {
     envir().setResultMsg("Invalid SDP line: ", inputLine);
     return False;
   }
@@ -291,30 +321,19 @@ static char* parseCLine(char const* sdpLine) {
 
 Boolean MediaSession::parseSDPLine_s(char const* sdpLine) {
   // Check for "s=<session name>" line
-  char* buffer = strDupSize(sdpLine);
-  Boolean parseSuccess = False;
-
-  if (sscanf(sdpLine, "s=%[^\r\n]", buffer) == 1) {
-    delete[] fSessionName; fSessionName = strDup(buffer);
-    parseSuccess = True;
-  }
-  delete[] buffer;
+  // (Note that - as with all of these functions - "sdpLine" is a single, '\0'-terminated line.)
+  if (strncmp(sdpLine, "s=", 2) != 0 || sdpLine[2] == '\0') return False;
 
-  return parseSuccess;
+  delete[] fSessionName; fSessionName = strDup(&sdpLine[2]);
+  return True;
 }
 
 Boolean MediaSession::parseSDPLine_i(char const* sdpLine) {
   // Check for "i=<session description>" line
-  char* buffer = strDupSize(sdpLine);
-  Boolean parseSuccess = False;
-
-  if (sscanf(sdpLine, "i=%[^\r\n]", buffer) == 1) {
-    delete[] fSessionDescription; fSessionDescription = strDup(buffer);
-    parseSuccess = True;
-  }
-  delete[] buffer;
+  if (strncmp(sdpLine, "i=", 2) != 0 || sdpLine[2] == '\0') return False;
 
-  return parseSuccess;
+  delete[] fSessionDescription; fSessionDescription = strDup(&sdpLine[2]);
+  return True;
 }
 
 Boolean MediaSession::parseSDPLine_c(char const* sdpLine) {
@@ -350,18 +369,27 @@ static Boolean parseRangeAttribute(char const* sdpLine, double& startTime, doubl
   return sscanf(sdpLine, "a=range: npt = %lg - %lg", &startTime, &endTime) == 2;
 }
 
-Boolean MediaSession::parseSDPAttribute_control(char const* sdpLine) {
+static char* parseControlAttribute(char const* sdpLine) {
   // Check for a "a=control:<control-path>" line:
-  Boolean parseSuccess = False;
+  if (strncmp(sdpLine, "a=control:", 10) != 0) return NULL;
 
-  char* controlPath = strDupSize(sdpLine); // ensures we have enough space
-  if (sscanf(sdpLine, "a=control: %s", controlPath) == 1) {
-    parseSuccess = True;
-    delete[] fControlPath; fControlPath = strDup(controlPath);
+  char const* controlPath = &sdpLine[10];
+  while (isspace(*controlPath)) ++controlPath;
+  unsigned controlPathLength = 0;
+  while (controlPath[controlPathLength] != '\0' && !isspace(controlPath[controlPathLength])) {
+    ++controlPathLength;
   }
-  delete[] controlPath;
+  if (controlPathLength == 0) return NULL;
 
-  return parseSuccess;
+  return strDupSubstring(controlPath, controlPathLength);
+}
+
+Boolean MediaSession::parseSDPAttribute_control(char const* sdpLine) {
+  char* controlPath = parseControlAttribute(sdpLine);
+  if (controlPath == NULL) return False;
+
+  delete[] fControlPath; fControlPath = controlPath;
+  return True;
 }
 
 Boolean MediaSession::parseSDPAttribute_range(char const* sdpLine) {
@@ -1071,17 +1099,11 @@ Boolean MediaSubsession::parseSDPAttribute_rtpmap(char const* sdpLine) {
 }
 
 Boolean MediaSubsession::parseSDPAttribute_control(char const* sdpLine) {
-  // Check for a "a=control:<control-path>" line:
-  Boolean parseSuccess = False;
+  char* controlPath = parseControlAttribute(sdpLine);
+  if (controlPath == NULL) return False;
 
-  char* controlPath = strDupSize(sdpLine); // ensures we have enough space
-  if (sscanf(sdpLine, "a=control: %s", controlPath) == 1) {
-    parseSuccess = True;
-    delete[] fControlPath; fControlPath = strDup(controlPath);
-  }
-  delete[] controlPath;
-
-  return parseSuccess;
+  delete[] fControlPath; fControlPath = controlPath;
+  return True;
 }
 
 Boolean MediaSubsession::parseSDPAttribute_range(char const* sdpLine) {
@@ -1110,114 +1132,135 @@ Boolean MediaSubsession::parseSDPAttribute_range(char const* sdpLine) {
   return parseSuccess;
 }
 
+// Returns True iff the "nameLength"-character "name" is "paramName" (ignoring case):
+static Boolean fmtpNameIs(char const* name, unsigned nameLength, char const* paramName) {
+  return strlen(paramName) == nameLength && _strncasecmp(name, paramName, nameLength) == 0;
+}
+
+static Boolean fmtpUnsignedValue(char const* value, int base, unsigned& result) {
+  if (value == NULL) return False;
+
+  char* end;
+  unsigned long u = strtoul(value, &end, base);
+  if (end == value) return False; // no digits
+
+  result = (unsigned)u;
+  return True;
+}
+
+static char* fmtpStringValue(char const* value, unsigned valueLength, Boolean makeLowerCase) {
+  char* result = strDupSubstring(value, valueLength);
+  if (makeLowerCase) {
+    for (char* c = result; *c != '\0'; ++c) if (*c >= 'A' && *c <= 'Z') *c += 'a' - 'A';
+  }
+
+  return result;
+}
+
 Boolean MediaSubsession::parseSDPAttribute_fmtp(char const* sdpLine) {
   // Check for a "a=fmtp:" line:
   // TEMP: We check only for a handful of expected parameter names #####
   // Later: (i) check that payload format number matches; #####
   //        (ii) look for other parameters also (generalize?) #####
-  do {
-    if (strncmp(sdpLine, "a=fmtp:", 7) != 0) break; sdpLine += 7;
-    while (isdigit(*sdpLine)) ++sdpLine;
-
-    // The remaining "sdpLine" should be a sequence of
-    //     <name>=<value>;
-    // parameter assignments.  Look at each of these.
-    // First, convert the line to lower-case, to ease comparison:
-    char* const lineCopy = strDup(sdpLine); char* line = lineCopy;
-    {
-      Locale l("POSIX");
-      for (char* c = line; *c != '\0'; ++c) *c = tolower(*c);
+  if (strncmp(sdpLine, "a=fmtp:", 7) != 0) return False;
+  char const* param = &sdpLine[7];
+  while (isdigit(*param)) ++param;
+
+  // The remainder of the line should be a sequence of
+  //     <name>=<value>;
+  // parameter assignments (some of whose "=<value>" may be omitted).
+  // Split each of these - in a single pass - into its name and value:
+  while (*param != '\0') {
+    while (*param == ' ' || *param == '\t') ++param;
+    char const* name = param;
+    while (*param != '\0' && *param != ';' && *param != '='
+	   && *param != ' ' && *param != '\t') ++param;
+    unsigned const nameLength = param - name;
+
+    char const* value = NULL; // if there's no "=<value>"
+    unsigned valueLength = 0;
+    while (*param == ' ' || *param == '\t') ++param;
+    if (*param == '=') {
+      ++param;
+      while (*param == ' ' || *param == '\t') ++param;
+      value = param;
+      while (*param != '\0' && *param != ';' && *param != ' ' && *param != '\t') ++param;
+      valueLength = param - value;
     }
-    while (*line != '\0' && *line != '\r' && *line != '\n') {
-      unsigned u;
-      char* valueStr = strDupSize(line);
-      if (sscanf(line, " auxiliarydatasizelength = %u", &u) == 1) {
-	fAuxiliarydatasizelength = u;
-      } else if (sscanf(line, " constantduration = %u", &u) == 1) {
-	fConstantduration = u;
-      } else if (sscanf(line, " constantsize; = %u", &u) == 1) {
-	fConstantsize = u;
-      } else if (sscanf(line, " crc = %u", &u) == 1) {
-	fCRC = u;
-      } else if (sscanf(line, " ctsdeltalength = %u", &u) == 1) {
-	fCtsdeltalength = u;
-      } else if (sscanf(line, " de-interleavebuffersize = %u", &u) == 1) {
-	fDe_interleavebuffersize = u;
-      } else if (sscanf(line, " dtsdeltalength = %u", &u) == 1) {
-	fDtsdeltalength = u;
-      } else if (sscanf(line, " indexdeltalength = %u", &u) == 1) {
-	fIndexdeltalength = u;
-      } else if (sscanf(line, " indexlength = %u", &u) == 1) {
-	fIndexlength = u;
-      } else if (sscanf(line, " interleaving = %u", &u) == 1) {
-	fInterleaving = u;
-      } else if (sscanf(line, " maxdisplacement = %u", &u) == 1) {
-	fMaxdisplacement = u;
-      } else if (sscanf(line, " objecttype = %u", &u) == 1) {
-	fObjecttype = u;
-      } else if (sscanf(line, " octet-align = %u", &u) == 1) {
-	fOctetalign = u;
-      } else if (sscanf(line, " profile-level-id = %x", &u) == 1) {
-	// Note that the "profile-level-id" parameter is assumed to be hexadecimal
-	fProfile_level_id = u;
-      } else if (sscanf(line, " robust-sorting = %u", &u) == 1) {
-	fRobustsorting = u;
-      } else if (sscanf(line, " sizelength = %u", &u) == 1) {
-	fSizelength = u;
-      } else if (sscanf(line, " streamstateindication = %u", &u) == 1) {
-	fStreamstateindication = u;
-      } else if (sscanf(line, " streamtype = %u", &u) == 1) {
-	fStreamtype = u;
-      } else if (sscanf(line, " cpresent = %u", &u) == 1) {
-	fCpresent = u != 0;
-      } else if (sscanf(line, " randomaccessindication = %u", &u) == 1) {
-	fRandomaccessindication = u != 0;
-      } else if (sscanf(line, " config = %[^; \t\r\n]", valueStr) == 1) {
-	delete[] fConfig; fConfig = strDup(valueStr);
-      } else if (sscanf(line, " mode = %[^; \t\r\n]", valueStr) == 1) {
-	delete[] fMode; fMode = strDup(valueStr);
-      } else if (sscanf(sdpLine, " sprop-parameter-sets = %[^; \t\r\n]", valueStr) == 1) {
-	// Note: We used "sdpLine" here, because the value is case-sensitive.
-	delete[] fSpropParameterSets; fSpropParameterSets = strDup(valueStr);
-      } else if (sscanf(line, " emphasis = %[^; \t\r\n]", valueStr) == 1) {
-	delete[] fEmphasis; fEmphasis = strDup(valueStr);
-      } else if (sscanf(sdpLine, " channel-order = %[^; \t\r\n]", valueStr) == 1) {
-	// Note: We used "sdpLine" here, because the value is case-sensitive.
-	delete[] fChannelOrder; fChannelOrder = strDup(valueStr);
-      } else {
-	// Some of the above parameters are Boolean.  Check whether the parameter
-	// names appear alone, without a "= 1" at the end:
-	if (sscanf(line, " %[^; \t\r\n]", valueStr) == 1) {
-	  if (strcmp(valueStr, "octet-align") == 0) {
-	    fOctetalign = 1;
-	  } else if (strcmp(valueStr, "cpresent") == 0) {
-            fCpresent = True;
-	  } else if (strcmp(valueStr, "crc") == 0) {
-	    fCRC = 1;
-	  } else if (strcmp(valueStr, "robust-sorting") == 0) {
-	    fRobustsorting = 1;
-	  } else if (strcmp(valueStr, "randomaccessindication") == 0) {
-	    fRandomaccessindication = True;
-	  }
-	}
-      }
-      delete[] valueStr;
+    if (nameLength > 0) setFmtpParameter(name, nameLength, value, valueLength);
 
-      // Move to the next parameter assignment string:
-      while (*line != '\0' && *line != '\r' && *line != '\n'
-	     && *line != ';') ++line;
-      while (*line == ';') ++line;
+    // Move to the next parameter assignment string:
+    while (*param != '\0' && *param != ';') ++param;
+    while (*param == ';') ++param;
+  }
 
-      // Do the same with sdpLine; needed for finding case sensitive values:
-      while (*sdpLine != '\0' && *sdpLine != '\r' && *sdpLine != '\n'
-	     && *sdpLine != ';') ++sdpLine;
-      while (*sdpLine == ';') ++sdpLine;
-    }
-    delete[] lineCopy;
-    return True;
-  } while (0);
+  return True;
+}
 
-  return False;
+void MediaSubsession::setFmtpParameter(char const* name, unsigned nameLength,
+				       char const* value, unsigned valueLength) {
+  unsigned u;
+  if (fmtpNameIs(name, nameLength, "auxiliarydatasizelength")) {
+    if (fmtpUnsignedValue(value, 10, u)) fAuxiliarydatasizelength = u;
+  } else if (fmtpNameIs(name, nameLength, "constantduration")) {
+    if (fmtpUnsignedValue(value, 10, u)) fConstantduration = u;
+  } else if (fmtpNameIs(name, nameLength, "constantsize")) {
+    if (fmtpUnsignedValue(value, 10, u)) fConstantsize = u;
+  } else if (fmtpNameIs(name, nameLength, "crc")) {
+    if (value == NULL) fCRC = 1;
+    else if (fmtpUnsignedValue(value, 10, u)) fCRC = u;
+  } else if (fmtpNameIs(name, nameLength, "ctsdeltalength")) {
+    if (fmtpUnsignedValue(value, 10, u)) fCtsdeltalength = u;
+  } else if (fmtpNameIs(name, nameLength, "de-interleavebuffersize")) {
+    if (fmtpUnsignedValue(value, 10, u)) fDe_interleavebuffersize = u;
+  } else if (fmtpNameIs(name, nameLength, "dtsdeltalength")) {
+    if (fmtpUnsignedValue(value, 10, u)) fDtsdeltalength = u;
+  } else if (fmtpNameIs(name, nameLength, "indexdeltalength")) {
+    if (fmtpUnsignedValue(value, 10, u)) fIndexdeltalength = u;
+  } else if (fmtpNameIs(name, nameLength, "indexlength")) {
+    if (fmtpUnsignedValue(value, 10, u)) fIndexlength = u;
+  } else if (fmtpNameIs(name, nameLength, "interleaving")) {
+    if (fmtpUnsignedValue(value, 10, u)) fInterleaving = u;
+  } else if (fmtpNameIs(name, nameLength, "maxdisplacement")) {
+    if (fmtpUnsignedValue(value, 10, u)) fMaxdisplacement = u;
+  } else if (fmtpNameIs(name, nameLength, "objecttype")) {
+    if (fmtpUnsignedValue(value, 10, u)) fObjecttype = u;
+  } else if (fmtpNameIs(name, nameLength, "octet-align")) {
+    if (value == NULL) fOctetalign = 1;
+    else if (fmtpUnsignedValue(value, 10, u)) fOctetalign = u;
+  } else if (fmtpNameIs(name, nameLength, "profile-level-id")) {
+    // Note that the "profile-level-id" parameter is assumed to be hexadecimal
+    if (fmtpUnsignedValue(value, 16, u)) fProfile_level_id = u;
+  } else if (fmtpNameIs(name, nameLength, "robust-sorting")) {
+    if (value == NULL) fRobustsorting = 1;
+    else if (fmtpUnsignedValue(value, 10, u)) fRobustsorting = u;
+  } else if (fmtpNameIs(name, nameLength, "sizelength")) {
+    if (fmtpUnsignedValue(value, 10, u)) fSizelength = u;
+  } else if (fmtpNameIs(name, nameLength, "streamstateindication")) {
+    if (fmtpUnsignedValue(value, 10, u)) fStreamstateindication = u;
+  } else if (fmtpNameIs(name, nameLength, "streamtype")) {
+    if (fmtpUnsignedValue(value, 10, u)) fStreamtype = u;
+  } else if (fmtpNameIs(name, nameLength, "cpresent")) {
+    if (value == NULL) fCpresent = True;
+    else if (fmtpUnsignedValue(value, 10, u)) fCpresent = u != 0;
+  } else if (fmtpNameIs(name, nameLength, "randomaccessindication")) {
+    if (value == NULL) fRandomaccessindication = True;
+    else if (fmtpUnsignedValue(value, 10, u)) fRandomaccessindication = u != 0;
+  } else if (valueLength == 0) {
+    // The remaining parameters all need a (non-empty) value:
+  } else if (fmtpNameIs(name, nameLength, "config")) {
+    delete[] fConfig; fConfig = fmtpStringValue(value, valueLength, True);
+  } else if (fmtpNameIs(name, nameLength, "mode")) {
+    delete[] fMode; fMode = fmtpStringValue(value, valueLength, True);
+  } else if (fmtpNameIs(name, nameLength, "sprop-parameter-sets")) {
+    // Note: This value is case-sensitive:
+    delete[] fSpropParameterSets; fSpropParameterSets = fmtpStringValue(value, valueLength, False);
+  } else if (fmtpNameIs(name, nameLength, "emphasis")) {
+    delete[] fEmphasis; fEmphasis = fmtpStringValue(value, valueLength, True);
+  } else if (fmtpNameIs(name, nameLength, "channel-order")) {
+    // Note: This value is case-sensitive:
+    delete[] fChannelOrder; fChannelOrder = fmtpStringValue(value, valueLength, False);
+  }
 }
 
 Boolean MediaSubsession
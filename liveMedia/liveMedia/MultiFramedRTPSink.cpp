@@ -20,7 +20,10 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 // Implementation
 
 #include "MultiFramedRTPSink.hh"
+#include "GOPCache.hh"
+#include "RTPHintCache.hh"
 #include "GroupsockHelper.hh"
+#include "TunnelEncaps.hh"
 
 ////////// MultiFramedRTPSink //////////
 
@@ -32,6 +35,62 @@ void MultiFramedRTPSink::setPacketSizes(unsigned preferredPacketSize,
   delete fOutBuf;
   fOutBuf = new OutPacketBuffer(preferredPacketSize, maxPacketSize);
   fOurMaxPacketSize = maxPacketSize; // save value, in case subclasses need it
+
+  if (fMaxPacketsPerBatch > 1) {
+    // Resize our batch slots to match:
+    setPacketBatching(fMaxPacketsPerBatch, fBatchWindowUSecs, fRTPInterface.gs()->useUDPGSO());
+  }
+}
+
+void MultiFramedRTPSink::setPacketBatching(unsigned maxPacketsPerBatch,
+					   unsigned batchWindowUSecs,
+					   Boolean useUDPGSO) {
+  flushPacketBatch();
+  delete[] fBatchBuffer; fBatchBuffer = NULL;
+  delete[] fBatchPackets; fBatchPackets = NULL;
+  delete[] fBatchPacketSizes; fBatchPacketSizes = NULL;
+  delete[] fBatchPacketIsRandomAccessPoint; fBatchPacketIsRandomAccessPoint = NULL;
+
+  fMaxPacketsPerBatch = maxPacketsPerBatch;
+  fBatchWindowUSecs = batchWindowUSecs;
+  fRTPInterface.gs()->setUseUDPGSO(useUDPGSO);
+  if (fMaxPacketsPerBatch <= 1) return;
+
+  // Each slot leaves room for a tunnel encapsulation trailer, as "Groupsock::output()" requires:
+  fBatchSlotSize = fOurMaxPacketSize + TunnelEncapsulationTrailerMaxSize;
+  fBatchBuffer = new unsigned char[fMaxPacketsPerBatch*fBatchSlotSize];
+  fBatchPackets = new unsigned char*[fMaxPacketsPerBatch];
+  fBatchPacketSizes = new unsigned[fMaxPacketsPerBatch];
+  fBatchPacketIsRandomAccessPoint = new Boolean[fMaxPacketsPerBatch];
+}
+
+void MultiFramedRTPSink::flushPacketBatch() {
+  if (fNumPacketsInBatch == 0) return;
+
+  fRTPInterface.sendPackets(fBatchPackets, fBatchPacketSizes, fNumPacketsInBatch);
+  struct timeval timeNow;
+  gettimeofday(&timeNow, NULL);
+  for (unsigned i = 0; i < fNumPacketsInBatch; ++i) {
+    unsigned char const* p = fBatchPackets[i];
+    noteSendLatency((p[4]<<24)|(p[5]<<16)|(p[6]<<8)|p[7], timeNow);
+  }
+  if (fGOPCache != NULL) {
+    // Note: We record packets in our "GOPCache" only once they've actually been sent,
+    // so that a client that's brought up to date from it doesn't get any packet twice:
+    for (unsigned i = 0; i < fNumPacketsInBatch; ++i) {
+      fGOPCache->addPacket(fBatchPackets[i], fBatchPacketSizes[i],
+			   fBatchPacketIsRandomAccessPoint[i]);
+    }
+  }
+
+  ++fNumBatchFlushes;
+  fNumBatchedPackets += fNumPacketsInBatch;
+  if (fNumPacketsInBatch > fMaxPacketsInABatch) fMaxPacketsInABatch = fNumPacketsInBatch;
+  unsigned bucket = 0;
+  for (unsigned n = fNumPacketsInBatch; n > 1 && bucket < RTP_BATCH_HISTOGRAM_SIZE-1; n >>= 1) ++bucket;
+  ++fBatchSizeHistogram[bucket];
+
+  fNumPacketsInBatch = 0;
 }
 
 MultiFramedRTPSink::MultiFramedRTPSink(UsageEnvironment& env,
@@ -42,7 +101,12 @@ MultiFramedRTPSink::MultiFramedRTPSink(UsageEnvironment& env,
 				       unsigned numChannels)
   : RTPSink(env, rtpGS, rtpPayloadType, rtpTimestampFrequency,
 	    rtpPayloadFormatName, numChannels),
-  fOutBuf(NULL), fCurFragmentationOffset(0), fPreviousFrameEndedFragmentation(False) {
+  fOutBuf(NULL), fCurFragmentationOffset(0), fPreviousFrameEndedFragmentation(False),
+  fMaxPacketsPerBatch(0), fBatchWindowUSecs(0), fBatchSlotSize(0),
+  fBatchBuffer(NULL), fBatchPackets(NULL), fBatchPacketSizes(NULL),
+  fBatchPacketIsRandomAccessPoint(NULL), fNumPacketsInBatch(0),
+  fNumBatchFlushes(0), fNumBatchedPackets(0), fMaxPacketsInABatch(0) {
+  for (unsigned i = 0; i < RTP_BATCH_HISTOGRAM_SIZE; ++i) fBatchSizeHistogram[i] = 0;
   setPacketSizes(1000, 1448);
       // Default max packet size (1500, minus allowance for IP, UDP, UMTP headers)
       // (Also, make it a multiple of 4 bytes, just in case that matters.)
@@ -50,6 +114,10 @@ MultiFramedRTPSink::MultiFramedRTPSink(UsageEnvironment& env,
 
 MultiFramedRTPSink::~MultiFramedRTPSink() {
   delete fOutBuf;
+  delete[] fBatchBuffer;
+  delete[] fBatchPackets;
+  delete[] fBatchPacketSizes;
+  delete[] fBatchPacketIsRandomAccessPoint;
 }
 
 void MultiFramedRTPSink
@@ -79,6 +147,12 @@ Boolean MultiFramedRTPSink
   return True; // by default
 }
 
+Boolean MultiFramedRTPSink
+::frameIsRandomAccessPoint(unsigned char const* /*frameStart*/,
+			   unsigned /*numBytesInFrame*/) {
+  return True; // by default (e.g., for audio)
+}
+
 unsigned MultiFramedRTPSink::specialHeaderSize() const {
   // default implementation: Assume no special header:
   return 0;
@@ -153,6 +227,7 @@ Boolean MultiFramedRTPSink::continuePlaying() {
 }
 
 void MultiFramedRTPSink::stopPlaying() {
+  flushPacketBatch();
   fOutBuf->resetPacketStart();
   fOutBuf->resetOffset();
   fOutBuf->resetOverflowData();
@@ -187,6 +262,8 @@ void MultiFramedRTPSink::buildAndSendPacket(Boolean isFirstPacket) {
   fTotalFrameSpecificHeaderSizes = 0;
   fNoFramesLeft = False;
   fNumFramesUsedSoFar = 0;
+  fCurPacketIsRandomAccessPoint = False;
+  fCurPacketDueTime = fNextSendTime;
   packFrame();
 }
 
@@ -230,9 +307,14 @@ void MultiFramedRTPSink
 ::afterGettingFrame1(unsigned frameSize, unsigned numTruncatedBytes,
 		     struct timeval presentationTime,
 		     unsigned durationInMicroseconds) {
+  // We count the time that we spend here as 'processing time' - but only up until
+  // we call "sendPacketIfNecessary()" (which counts its own) or "packFrame()":
+  struct timeval startTime;
+  gettimeofday(&startTime, NULL);
+
   if (fIsFirstPacket) {
     // Record the fact that we're starting to play now:
-    gettimeofday(&fNextSendTime, NULL);
+    fNextSendTime = fStartTime = fCurPacketDueTime = startTime;
   }
 
   if (numTruncatedBytes > 0) {
@@ -293,6 +375,7 @@ void MultiFramedRTPSink
 
   if (numFrameBytesToUse == 0) {
     // Send our packet now, because we have filled it up:
+    addProcessingTimeSince(startTime);
     sendPacketIfNecessary();
   } else {
     // Use this frame in our outgoing packet:
@@ -300,6 +383,11 @@ void MultiFramedRTPSink
     fOutBuf->increment(numFrameBytesToUse);
         // do this now, in case "doSpecialFrameHandling()" calls "setFramePadding()" to append padding bytes
 
+    if ((fGOPCache != NULL || fHintTrackRecorder != NULL) && curFragmentationOffset == 0
+	&& frameIsRandomAccessPoint(frameStart, numFrameBytesToUse)) {
+      fCurPacketIsRandomAccessPoint = True;
+    }
+
     // Here's where any payload format specific processing gets done:
     doSpecialFrameHandling(curFragmentationOffset, frameStart,
 			   numFrameBytesToUse, presentationTime,
@@ -330,9 +418,11 @@ void MultiFramedRTPSink
         || !frameCanAppearAfterPacketStart(fOutBuf->curPtr() - frameSize,
 					   frameSize) ) {
       // The packet is ready to be sent now
+      addProcessingTimeSince(startTime);
       sendPacketIfNecessary();
     } else {
       // There's room for more frames; try getting another:
+      addProcessingTimeSince(startTime);
       packFrame();
     }
   }
@@ -349,14 +439,40 @@ Boolean MultiFramedRTPSink::isTooBigForAPacket(unsigned numBytes) const {
 }
 
 void MultiFramedRTPSink::sendPacketIfNecessary() {
+  struct timeval startTime;
+  gettimeofday(&startTime, NULL);
+
   if (fNumFramesUsedSoFar > 0) {
     // Send the packet:
 #ifdef TEST_LOSS
     if ((our_random()%10) != 0) // simulate 10% packet loss #####
 #endif
-    fRTPInterface.sendPacket(fOutBuf->packet(), fOutBuf->curPacketSize());
+    if (fMaxPacketsPerBatch > 1) {
+      // Save a copy of the packet, to be sent (below) with the rest of its batch:
+      if (fNumPacketsInBatch == 0) gettimeofday(&fBatchStartTime, NULL);
+      unsigned char* slot = &fBatchBuffer[fNumPacketsInBatch*fBatchSlotSize];
+      memmove(slot, fOutBuf->packet(), fOutBuf->curPacketSize());
+      fBatchPackets[fNumPacketsInBatch] = slot;
+      fBatchPacketSizes[fNumPacketsInBatch] = fOutBuf->curPacketSize();
+      fBatchPacketIsRandomAccessPoint[fNumPacketsInBatch] = fCurPacketIsRandomAccessPoint;
+      ++fNumPacketsInBatch;
+    } else {
+      fRTPInterface.sendPacket(fOutBuf->packet(), fOutBuf->curPacketSize());
+      noteSendLatency(fCurrentTimestamp, startTime);
+      if (fGOPCache != NULL) {
+	fGOPCache->addPacket(fOutBuf->packet(), fOutBuf->curPacketSize(),
+			     fCurPacketIsRandomAccessPoint);
+      }
+    }
+    if (fHintTrackRecorder != NULL) {
+      int64_t dueUSecs = (fCurPacketDueTime.tv_sec - fStartTime.tv_sec)*(int64_t)1000000
+	+ (fCurPacketDueTime.tv_usec - fStartTime.tv_usec);
+      fHintTrackRecorder->addPacket(fOutBuf->packet(), fOutBuf->curPacketSize(),
+				    dueUSecs, fCurPacketIsRandomAccessPoint);
+    }
     ++fPacketCount;
     fTotalOctetCount += fOutBuf->curPacketSize();
+    fNumBytesSent += fOutBuf->curPacketSize();
     fOctetCount += fOutBuf->curPacketSize()
       - rtpHeaderSize - fSpecialHeaderSize - fTotalFrameSpecificHeaderSizes;
 
@@ -381,6 +497,8 @@ void MultiFramedRTPSink::sendPacketIfNecessary() {
 
   if (fNoFramesLeft) {
     // We're done:
+    flushPacketBatch();
+    addProcessingTimeSince(startTime);
     onSourceClosure(this);
   } else {
     // We have more frames left to send.  Figure out when the next frame
@@ -394,14 +512,39 @@ void MultiFramedRTPSink::sendPacketIfNecessary() {
       uSecondsToGo = 0;
     }
 
+    if (fNumPacketsInBatch > 0) {
+      // Keep batching (by building the next packet right away) if the next packet is due
+      // within our batch window; otherwise, send the batch now:
+      int64_t uSecondsSinceBatchStart
+	= (fNextSendTime.tv_sec - fBatchStartTime.tv_sec)*(int64_t)1000000
+	+ (fNextSendTime.tv_usec - fBatchStartTime.tv_usec);
+      if (fNumPacketsInBatch < fMaxPacketsPerBatch
+	  && uSecondsSinceBatchStart <= (int64_t)fBatchWindowUSecs) {
+	uSecondsToGo = 0;
+      } else {
+	flushPacketBatch();
+      }
+    }
+
+    addProcessingTimeSince(startTime);
+
     // Delay this amount of time:
     nextTask() = envir().taskScheduler().scheduleDelayedTask(uSecondsToGo, (TaskFunc*)sendNext, this);
   }
 }
 
 // The following is called after each delay between packet sends:
+#define TCP_BACKLOG_RETRY_USECS 5000
+
 void MultiFramedRTPSink::sendNext(void* firstArg) {
   MultiFramedRTPSink* sink = (MultiFramedRTPSink*)firstArg;
+  if (sink->fRTPInterface.tcpOutputIsBacklogged()) {
+    // A RTP-over-TCP client isn't keeping up, so wait (rather than queue more output for it):
+    ++sink->fNumTCPBacklogWaits;
+    sink->nextTask() = sink->envir().taskScheduler()
+      .scheduleDelayedTask(TCP_BACKLOG_RETRY_USECS, (TaskFunc*)sendNext, sink);
+    return;
+  }
   sink->buildAndSendPacket(False);
 }
 
@@ -32,29 +32,49 @@ public:
   void reset();
 
   BufferedPacket* getFreePacket(MultiFramedRTPSource* ourSource);
+  Boolean haveFreePacket() const { return fFreePackets != NULL; }
   Boolean storePacket(BufferedPacket* bPacket);
   BufferedPacket* getNextCompletedPacket(Boolean& packetLossPreceded);
   void releaseUsedPacket(BufferedPacket* packet);
-  void freePacket(BufferedPacket* packet) {
-    if (packet != fSavedPacket) {
-      delete packet;
-    } else {
-      fSavedPacketFree = True;
-    }
-  }
+  void freePacket(BufferedPacket* packet);
   Boolean isEmpty() const { return fHeadPacket == NULL; }
 
-  void setThresholdTime(unsigned uSeconds) { fThresholdTime = uSeconds; }
+  void setThresholdTime(unsigned uSeconds);
+  void setAdaptiveThresholdTime(unsigned minUSeconds, unsigned maxUSeconds);
+  Boolean thresholdTimeIsAdaptive() const { return fThresholdTimeIsAdaptive; }
+  void noteJitter(unsigned jitterUSeconds); // adapts the threshold time, if it's adaptive
+
+  unsigned numPoolHits() const { return fNumPoolHits; }
+  unsigned numPoolMisses() const { return fNumPoolMisses; }
+  unsigned peakNumPacketsInUse() const { return fPeakNumPacketsInUse; }
+  unsigned thresholdTime() const { return fThresholdTime; }
+  unsigned numQueuedPackets() const { return fNumQueuedPackets; }
+  unsigned numLatePacketsDropped() const { return fNumLatePacketsDropped; }
+  unsigned numConcealmentEvents() const { return fNumConcealmentEvents; }
+
+private:
+  void trimPool();
 
 private:
   BufferedPacketFactory* fPacketFactory;
   unsigned fThresholdTime; // uSeconds
+  Boolean fThresholdTimeIsAdaptive;
+  unsigned fMinThresholdTime, fMaxThresholdTime; // uSeconds; used if adaptive
   Boolean fHaveSeenFirstPacket; // used to set initial "fNextExpectedSeqNo"
   unsigned short fNextExpectedSeqNo;
   BufferedPacket* fHeadPacket;
-  BufferedPacket* fSavedPacket;
-      // to avoid calling new/free in the common case
-  Boolean fSavedPacketFree;
+  unsigned fNumQueuedPackets;
+  unsigned fNumLatePacketsDropped, fNumConcealmentEvents;
+
+  // A bounded pool of free packets (linked using "nextPacket()"), to avoid
+  // calling new/delete for each incoming packet.  It's filled the first time
+  // that we're asked for a packet, and sized from "fThresholdTime":
+  BufferedPacket* fFreePackets;
+  unsigned fNumFreePackets;
+  unsigned fMaxNumFreePackets;
+  Boolean fHaveFilledPool;
+  unsigned fNumPacketsInUse;
+  unsigned fNumPoolHits, fNumPoolMisses, fPeakNumPacketsInUse;
 };
 
 
@@ -213,6 +233,39 @@ void MultiFramedRTPSource
   fReorderingBuffer->setThresholdTime(uSeconds);
 }
 
+void MultiFramedRTPSource
+::useAdaptiveJitterBuffer(unsigned minDelayUSeconds, unsigned maxDelayUSeconds) {
+  fReorderingBuffer->setAdaptiveThresholdTime(minDelayUSeconds, maxDelayUSeconds);
+}
+
+unsigned MultiFramedRTPSource::jitterBufferDelay() const {
+  return fReorderingBuffer->thresholdTime();
+}
+
+unsigned MultiFramedRTPSource::jitterBufferDepth() const {
+  return fReorderingBuffer->numQueuedPackets();
+}
+
+unsigned MultiFramedRTPSource::numLatePacketsDropped() const {
+  return fReorderingBuffer->numLatePacketsDropped();
+}
+
+unsigned MultiFramedRTPSource::numConcealmentEvents() const {
+  return fReorderingBuffer->numConcealmentEvents();
+}
+
+unsigned MultiFramedRTPSource::numPacketPoolHits() const {
+  return fReorderingBuffer->numPoolHits();
+}
+
+unsigned MultiFramedRTPSource::numPacketPoolMisses() const {
+  return fReorderingBuffer->numPoolMisses();
+}
+
+unsigned MultiFramedRTPSource::peakNumBufferedPackets() const {
+  return fReorderingBuffer->peakNumPacketsInUse();
+}
+
 #define ADVANCE(n) do { bPacket->skip(n); } while (0)
 
 void MultiFramedRTPSource::networkReadHandler(MultiFramedRTPSource* source, int /*mask*/) {
@@ -220,6 +273,13 @@ void MultiFramedRTPSource::networkReadHandler(MultiFramedRTPSource* source, int
 }
 
 void MultiFramedRTPSource::networkReadHandler1() {
+  if (fPacketReadInProgress == NULL && fRTPInterface.nextTCPReadStreamSocketNum() < 0) {
+    // Common case: We're reading datagrams, so read as many as are waiting at once:
+    readPacketBatch();
+    doGetNextFrame1();
+    return;
+  }
+
   BufferedPacket* bPacket = fPacketReadInProgress;
   if (bPacket == NULL) {
     // Normal case: Get a free BufferedPacket descriptor to hold the new network packet:
@@ -238,73 +298,10 @@ void MultiFramedRTPSource::networkReadHandler1() {
     } else {
       fPacketReadInProgress = NULL;
     }
-#ifdef TEST_LOSS
-    setPacketReorderingThresholdTime(0);
-       // don't wait for 'lost' packets to arrive out-of-order later
-    if ((our_random()%10) == 0) break; // simulate 10% packet loss
-#endif
-
-    // Check for the 12-byte RTP header:
-    if (bPacket->dataSize() < 12) break;
-    unsigned rtpHdr = ntohl(*(u_int32_t*)(bPacket->data())); ADVANCE(4);
-    Boolean rtpMarkerBit = (rtpHdr&0x00800000) >> 23;
-    unsigned rtpTimestamp = ntohl(*(u_int32_t*)(bPacket->data()));ADVANCE(4);
-    unsigned rtpSSRC = ntohl(*(u_int32_t*)(bPacket->data())); ADVANCE(4);
-
-    // Check the RTP version number (it should be 2):
-    if ((rtpHdr&0xC0000000) != 0x80000000) break;
-
-    // Skip over any CSRC identifiers in the header:
-    unsigned cc = (rtpHdr>>24)&0xF;
-    if (bPacket->dataSize() < cc) break;
-    ADVANCE(cc*4);
-
-    // Check for (& ignore) any RTP header extension
-    if (rtpHdr&0x10000000) {
-      if (bPacket->dataSize() < 4) break;
-      unsigned extHdr = ntohl(*(u_int32_t*)(bPacket->data())); ADVANCE(4);
-      unsigned remExtSize = 4*(extHdr&0xFFFF);
-      if (bPacket->dataSize() < remExtSize) break;
-      ADVANCE(remExtSize);
-    }
-
-    // Discard any padding bytes:
-    if (rtpHdr&0x20000000) {
-      if (bPacket->dataSize() == 0) break;
-      unsigned numPaddingBytes
-	= (unsigned)(bPacket->data())[bPacket->dataSize()-1];
-      if (bPacket->dataSize() < numPaddingBytes) break;
-      bPacket->removePadding(numPaddingBytes);
-    }
-    // Check the Payload Type.
-    if ((unsigned char)((rtpHdr&0x007F0000)>>16)
-	!= rtpPayloadFormat()) {
-      break;
-    }
 
-    // The rest of the packet is the usable data.  Record and save it:
-    fLastReceivedSSRC = rtpSSRC;
-    unsigned short rtpSeqNo = (unsigned short)(rtpHdr&0xFFFF);
-    Boolean usableInJitterCalculation
-      = packetIsUsableInJitterCalculation((bPacket->data()),
-						  bPacket->dataSize());
-    struct timeval presentationTime; // computed by:
-    Boolean hasBeenSyncedUsingRTCP; // computed by:
-    receptionStatsDB()
-      .noteIncomingPacket(rtpSSRC, rtpSeqNo, rtpTimestamp,
-			  timestampFrequency(),
-			  usableInJitterCalculation, presentationTime,
-			  hasBeenSyncedUsingRTCP, bPacket->dataSize());
-
-    // Fill in the rest of the packet descriptor, and store it:
     struct timeval timeNow;
     gettimeofday(&timeNow, NULL);
-    bPacket->assignMiscParams(rtpSeqNo, rtpTimestamp, presentationTime,
-			      hasBeenSyncedUsingRTCP, rtpMarkerBit,
-			      timeNow);
-    if (!fReorderingBuffer->storePacket(bPacket)) break;
-
-    readSuccess = True;
+    readSuccess = processIncomingPacket(bPacket, timeNow);
   } while (0);
   if (!readSuccess) fReorderingBuffer->freePacket(bPacket);
 
@@ -312,6 +309,115 @@ void MultiFramedRTPSource::networkReadHandler1() {
   // If we didn't get proper data this time, we'll get another chance
 }
 
+// The most datagrams that we read (with as few system calls as possible) each time
+// that our socket becomes readable:
+#define MAX_PACKETS_PER_READ_BATCH 32
+
+void MultiFramedRTPSource::readPacketBatch() {
+  // Get free packet descriptors to read into.  (After the first, we use only packets
+  // that are already in our pool, rather than allocating new ones.)
+  BufferedPacket* packets[MAX_PACKETS_PER_READ_BATCH];
+  unsigned char* buffers[MAX_PACKETS_PER_READ_BATCH];
+  unsigned bufferMaxSizes[MAX_PACKETS_PER_READ_BATCH];
+  unsigned numPackets = 0;
+  do {
+    packets[numPackets] = fReorderingBuffer->getFreePacket(this);
+    buffers[numPackets] = packets[numPackets]->prepareForRead(bufferMaxSizes[numPackets]);
+    ++numPackets;
+  } while (numPackets < MAX_PACKETS_PER_READ_BATCH && fReorderingBuffer->haveFreePacket());
+
+  unsigned bytesRead[MAX_PACKETS_PER_READ_BATCH];
+  struct sockaddr_in fromAddresses[MAX_PACKETS_PER_READ_BATCH];
+  struct timeval receptionTimes[MAX_PACKETS_PER_READ_BATCH];
+  int numRead = fRTPInterface.handleReadBatch(buffers, bufferMaxSizes, numPackets, bytesRead,
+					      fromAddresses, receptionTimes);
+
+  for (unsigned i = 0; i < numPackets; ++i) {
+    Boolean readSuccess = False;
+    if ((int)i < numRead && bytesRead[i] > 0) {
+      packets[i]->noteBytesRead(bytesRead[i]);
+      readSuccess = processIncomingPacket(packets[i], receptionTimes[i]);
+    }
+    if (!readSuccess) fReorderingBuffer->freePacket(packets[i]);
+  }
+}
+
+Boolean MultiFramedRTPSource
+::processIncomingPacket(BufferedPacket* bPacket, struct timeval const& timeReceived) {
+  // Perform sanity checks on the RTP header, then record and store the packet:
+#ifdef TEST_LOSS
+  setPacketReorderingThresholdTime(0);
+     // don't wait for 'lost' packets to arrive out-of-order later
+  if ((our_random()%10) == 0) return False; // simulate 10% packet loss
+#endif
+
+  // Check for the 12-byte RTP header:
+  if (bPacket->dataSize() < 12) return False;
+  unsigned rtpHdr = ntohl(*(u_int32_t*)(bPacket->data())); ADVANCE(4);
+  Boolean rtpMarkerBit = (rtpHdr&0x00800000) >> 23;
+  unsigned rtpTimestamp = ntohl(*(u_int32_t*)(bPacket->data()));ADVANCE(4);
+  unsigned rtpSSRC = ntohl(*(u_int32_t*)(bPacket->data())); ADVANCE(4);
+
+  // Check the RTP version number (it should be 2):
+  if ((rtpHdr&0xC0000000) != 0x80000000) return False;
+
+  // Skip over any CSRC identifiers in the header:
+  unsigned cc = (rtpHdr>>24)&0xF;
+  if (bPacket->dataSize() < cc) return False;
+  ADVANCE(cc*4);
+
+  // Check for (& ignore) any RTP header extension
+  if (rtpHdr&0x10000000) {
+    if (bPacket->dataSize() < 4) return False;
+    unsigned extHdr = ntohl(*(u_int32_t*)(bPacket->data())); ADVANCE(4);
+    unsigned remExtSize = 4*(extHdr&0xFFFF);
+    if (bPacket->dataSize() < remExtSize) return False;
+    ADVANCE(remExtSize);
+  }
+
+  // Discard any padding bytes:
+  if (rtpHdr&0x20000000) {
+    if (bPacket->dataSize() == 0) return False;
+    unsigned numPaddingBytes
+      = (unsigned)(bPacket->data())[bPacket->dataSize()-1];
+    if (bPacket->dataSize() < numPaddingBytes) return False;
+    bPacket->removePadding(numPaddingBytes);
+  }
+  // Check the Payload Type.
+  if ((unsigned char)((rtpHdr&0x007F0000)>>16)
+      != rtpPayloadFormat()) {
+    return False;
+  }
+
+  // The rest of the packet is the usable data.  Record and save it:
+  fLastReceivedSSRC = rtpSSRC;
+  unsigned short rtpSeqNo = (unsigned short)(rtpHdr&0xFFFF);
+  Boolean usableInJitterCalculation
+    = packetIsUsableInJitterCalculation((bPacket->data()),
+					bPacket->dataSize());
+  struct timeval presentationTime; // computed by:
+  Boolean hasBeenSyncedUsingRTCP; // computed by:
+  receptionStatsDB()
+    .noteIncomingPacket(rtpSSRC, rtpSeqNo, rtpTimestamp,
+			timestampFrequency(),
+			usableInJitterCalculation, presentationTime,
+			hasBeenSyncedUsingRTCP, bPacket->dataSize(), &timeReceived);
+  if (fReorderingBuffer->thresholdTimeIsAdaptive() && timestampFrequency() > 0) {
+    // Let the reordering buffer adapt to the current interarrival jitter (converted
+    // from RTP timestamp units to microseconds):
+    RTPReceptionStats* stats = receptionStatsDB().lookup(rtpSSRC);
+    if (stats != NULL) {
+      fReorderingBuffer->noteJitter((unsigned)((stats->jitter()*1000000.0)/timestampFrequency()));
+    }
+  }
+
+  // Fill in the rest of the packet descriptor, and store it:
+  bPacket->assignMiscParams(rtpSeqNo, rtpTimestamp, presentationTime,
+			    hasBeenSyncedUsingRTCP, rtpMarkerBit,
+			    timeReceived);
+  return fReorderingBuffer->storePacket(bPacket);
+}
+
 
 ////////// BufferedPacket and BufferedPacketFactory implementation /////
 
@@ -370,6 +476,12 @@ Boolean BufferedPacket::fillInData(RTPInterface& rtpInterface, Boolean& packetRe
   return True;
 }
 
+unsigned char* BufferedPacket::prepareForRead(unsigned& maxSize) {
+  reset();
+  maxSize = fPacketSize;
+  return fBuf;
+}
+
 void BufferedPacket
 ::assignMiscParams(unsigned short rtpSeqNo, unsigned rtpTimestamp,
 		   struct timeval presentationTime,
@@ -450,39 +562,135 @@ BufferedPacket* BufferedPacketFactory
 
 ////////// ReorderingPacketBuffer implementation //////////
 
+// The number of free packets that we keep in our pool is enough to hold
+// the packets that arrive (at a high video rate) within the reordering threshold:
+#define PACKET_POOL_MIN_SIZE 2
+#define PACKET_POOL_MAX_SIZE 64
+#define PACKET_POOL_USECS_PER_PACKET 4000
+
+static unsigned packetPoolSizeFor(unsigned thresholdTime) {
+  unsigned poolSize = PACKET_POOL_MIN_SIZE + thresholdTime/PACKET_POOL_USECS_PER_PACKET;
+  return poolSize > PACKET_POOL_MAX_SIZE ? PACKET_POOL_MAX_SIZE : poolSize;
+}
+
 ReorderingPacketBuffer
 ::ReorderingPacketBuffer(BufferedPacketFactory* packetFactory)
   : fThresholdTime(100000) /* default reordering threshold: 100 ms */,
-    fHaveSeenFirstPacket(False), fHeadPacket(NULL), fSavedPacket(NULL), fSavedPacketFree(True) {
+    fThresholdTimeIsAdaptive(False), fMinThresholdTime(0), fMaxThresholdTime(0),
+    fHaveSeenFirstPacket(False), fHeadPacket(NULL), fNumQueuedPackets(0),
+    fNumLatePacketsDropped(0), fNumConcealmentEvents(0),
+    fFreePackets(NULL), fNumFreePackets(0), fHaveFilledPool(False), fNumPacketsInUse(0),
+    fNumPoolHits(0), fNumPoolMisses(0), fPeakNumPacketsInUse(0) {
   fPacketFactory = (packetFactory == NULL)
     ? (new BufferedPacketFactory)
     : packetFactory;
+  fMaxNumFreePackets = packetPoolSizeFor(fThresholdTime);
 }
 
 ReorderingPacketBuffer::~ReorderingPacketBuffer() {
   reset();
+  delete fFreePackets; // will also delete the rest of the pool
   delete fPacketFactory;
 }
 
 void ReorderingPacketBuffer::reset() {
-  if (fSavedPacketFree) delete fSavedPacket; // because fSavedPacket is not in the list
-  delete fHeadPacket; // will also delete fSavedPacket if it's in the list
+  // Return any queued packets to our pool:
+  while (fHeadPacket != NULL) {
+    BufferedPacket* packet = fHeadPacket;
+    fHeadPacket = packet->nextPacket();
+    packet->nextPacket() = NULL;
+    freePacket(packet);
+  }
+  fNumQueuedPackets = 0;
   fHaveSeenFirstPacket = False;
-  fHeadPacket = NULL;
-  fSavedPacket = NULL;
+}
+
+void ReorderingPacketBuffer::setThresholdTime(unsigned uSeconds) {
+  fThresholdTime = uSeconds;
+  fThresholdTimeIsAdaptive = False;
+  fMaxNumFreePackets = packetPoolSizeFor(fThresholdTime);
+  trimPool();
+}
+
+// When adaptive, the threshold time is kept at this multiple of the interarrival jitter.
+// It grows immediately when the jitter grows, but shrinks only gradually:
+#define ADAPTIVE_THRESHOLD_JITTER_MULTIPLE 4
+#define ADAPTIVE_THRESHOLD_SHRINK_SHIFT 8 // shrink by 1/256 of the difference per packet
+
+void ReorderingPacketBuffer
+::setAdaptiveThresholdTime(unsigned minUSeconds, unsigned maxUSeconds) {
+  if (maxUSeconds < minUSeconds) maxUSeconds = minUSeconds;
+  fThresholdTimeIsAdaptive = True;
+  fMinThresholdTime = minUSeconds;
+  fMaxThresholdTime = maxUSeconds;
+  if (fThresholdTime < fMinThresholdTime) fThresholdTime = fMinThresholdTime;
+  if (fThresholdTime > fMaxThresholdTime) fThresholdTime = fMaxThresholdTime;
+
+  // Size our pool for the largest threshold that we might use:
+  fMaxNumFreePackets = packetPoolSizeFor(fMaxThresholdTime);
+  trimPool();
+}
+
+void ReorderingPacketBuffer::noteJitter(unsigned jitterUSeconds) {
+  if (!fThresholdTimeIsAdaptive) return;
+
+  unsigned targetThresholdTime = ADAPTIVE_THRESHOLD_JITTER_MULTIPLE*jitterUSeconds;
+  if (targetThresholdTime < fMinThresholdTime) targetThresholdTime = fMinThresholdTime;
+  if (targetThresholdTime > fMaxThresholdTime) targetThresholdTime = fMaxThresholdTime;
+
+  if (targetThresholdTime > fThresholdTime) {
+    fThresholdTime = targetThresholdTime;
+  } else {
+    fThresholdTime -= (fThresholdTime - targetThresholdTime)>>ADAPTIVE_THRESHOLD_SHRINK_SHIFT;
+  }
+}
+
+void ReorderingPacketBuffer::trimPool() {
+  // Trim our pool, if it's now too large:
+  while (fNumFreePackets > fMaxNumFreePackets) {
+    BufferedPacket* packet = fFreePackets;
+    fFreePackets = packet->nextPacket();
+    packet->nextPacket() = NULL;
+    delete packet;
+    --fNumFreePackets;
+  }
 }
 
 BufferedPacket* ReorderingPacketBuffer::getFreePacket(MultiFramedRTPSource* ourSource) {
-  if (fSavedPacket == NULL) { // we're being called for the first time
-    fSavedPacket = fPacketFactory->createNewPacket(ourSource);
-    fSavedPacketFree = True;
+  if (!fHaveFilledPool) { // we're being called for the first time
+    while (fNumFreePackets < fMaxNumFreePackets) {
+      BufferedPacket* packet = fPacketFactory->createNewPacket(ourSource);
+      packet->nextPacket() = fFreePackets;
+      fFreePackets = packet;
+      ++fNumFreePackets;
+    }
+    fHaveFilledPool = True;
+  }
+
+  BufferedPacket* packet;
+  if (fFreePackets != NULL) {
+    packet = fFreePackets;
+    fFreePackets = packet->nextPacket();
+    packet->nextPacket() = NULL;
+    --fNumFreePackets;
+    ++fNumPoolHits;
+  } else {
+    packet = fPacketFactory->createNewPacket(ourSource);
+    ++fNumPoolMisses;
   }
 
-  if (fSavedPacketFree == True) {
-    fSavedPacketFree = False;
-    return fSavedPacket;
+  if (++fNumPacketsInUse > fPeakNumPacketsInUse) fPeakNumPacketsInUse = fNumPacketsInUse;
+  return packet;
+}
+
+void ReorderingPacketBuffer::freePacket(BufferedPacket* packet) {
+  --fNumPacketsInUse;
+  if (fNumFreePackets < fMaxNumFreePackets) {
+    packet->nextPacket() = fFreePackets;
+    fFreePackets = packet;
+    ++fNumFreePackets;
   } else {
-    return fPacketFactory->createNewPacket(ourSource);
+    delete packet;
   }
 }
 
@@ -497,7 +705,15 @@ Boolean ReorderingPacketBuffer::storePacket(BufferedPacket* bPacket) {
 
   // Ignore this packet if its sequence number is less than the one
   // that we're looking for (in this case, it's been excessively delayed).
-  if (seqNumLT(rtpSeqNo, fNextExpectedSeqNo)) return False;
+  if (seqNumLT(rtpSeqNo, fNextExpectedSeqNo)) {
+    ++fNumLatePacketsDropped;
+    if (fThresholdTimeIsAdaptive) {
+      // We gave up on this packet too soon, so wait longer from now on:
+      fThresholdTime += fThresholdTime/2;
+      if (fThresholdTime > fMaxThresholdTime) fThresholdTime = fMaxThresholdTime;
+    }
+    return False;
+  }
 
   // Figure out where the new packet will be stored in the queue:
   BufferedPacket* beforePtr = NULL;
@@ -520,6 +736,7 @@ Boolean ReorderingPacketBuffer::storePacket(BufferedPacket* bPacket) {
   } else {
     beforePtr->nextPacket() = bPacket;
   }
+  ++fNumQueuedPackets;
 
   return True;
 }
@@ -531,6 +748,7 @@ void ReorderingPacketBuffer::releaseUsedPacket(BufferedPacket* packet) {
 
   fHeadPacket = fHeadPacket->nextPacket();
   packet->nextPacket() = NULL;
+  --fNumQueuedPackets;
 
   freePacket(packet);
 }
@@ -560,6 +778,7 @@ BufferedPacket* ReorderingPacketBuffer
     fNextExpectedSeqNo = fHeadPacket->rtpSeqNo();
         // we've given up on earlier packets now
     packetLossPreceded = True;
+    ++fNumConcealmentEvents;
     return fHeadPacket;
   }
 
@@ -20,8 +20,12 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 // Implementation
 
 #include "OnDemandServerMediaSubsession.hh"
+#include "SDPCache.hh"
 #include "RTCP.hh"
 #include "BasicUDPSink.hh"
+#include "GOPCache.hh"
+#include "RTPHintCache.hh"
+#include "HintedRTPSink.hh"
 #include <GroupsockHelper.hh>
 
 OnDemandServerMediaSubsession
@@ -29,12 +33,16 @@ OnDemandServerMediaSubsession
 				Boolean reuseFirstSource,
 				portNumBits initialPortNum)
   : ServerMediaSubsession(env),
-    fSDPLines(NULL), fReuseFirstSource(reuseFirstSource), fInitialPortNum(initialPortNum), fLastStreamToken(NULL) {
+    fSDPLines(NULL), fReuseFirstSource(reuseFirstSource), fGOPCacheSize(0), fInitialPortNum(initialPortNum), fLastStreamToken(NULL) {
   fDestinationsHashTable = HashTable::create(ONE_WORD_HASH_KEYS);
   gethostname(fCNAME, sizeof fCNAME);
   fCNAME[sizeof fCNAME-1] = '\0'; // just in case
 }
 
+void OnDemandServerMediaSubsession::enableGOPCache(unsigned maxCacheSize) {
+  fGOPCacheSize = maxCacheSize;
+}
+
 class Destinations {
 public:
   Destinations(struct in_addr const& destAddr,
@@ -102,17 +110,24 @@ public:
               Port const& serverRTPPort, Port const& serverRTCPPort,
 	      RTPSink* rtpSink, BasicUDPSink* udpSink,
 	      unsigned totalBW, FramedSource* mediaSource,
+	      RTPHintTrackSource* hintTrackSource,
 	      Groupsock* rtpGS, Groupsock* rtcpGS);
   virtual ~StreamState();
 
-  void startPlaying(Destinations* destinations,
-		    TaskFunc* rtcpRRHandler, void* rtcpRRHandlerClientData,
-		    ServerRequestAlternativeByteHandler* serverRequestAlternativeByteHandler,
-                    void* serverRequestAlternativeByteHandlerClientData);
+  Boolean startPlaying(Destinations* destinations,
+		       TaskFunc* rtcpRRHandler, void* rtcpRRHandlerClientData,
+		       ServerRequestAlternativeByteHandler* serverRequestAlternativeByteHandler,
+		       void* serverRequestAlternativeByteHandlerClientData);
+      // Returns True iff the new destinations were first sent the contents of our
+      // "GOPCache" (beginning with the packet given by "gopCache()->firstSeqNo()")
   void pause();
   void endPlaying(Destinations* destinations);
   void reclaim();
 
+  void seekHintTrack(double seekNPT, double streamDuration);
+  void stopHintTrackRecording(); // because the stream won't be played in full, at normal speed
+  void finishHintTrackRecording(); // because the stream has ended
+
   unsigned& referenceCount() { return fReferenceCount; }
 
   Port const& serverRTPPort() const { return fServerRTPPort; }
@@ -123,6 +138,15 @@ public:
   float streamDuration() const { return fStreamDuration; }
 
   FramedSource* mediaSource() const { return fMediaSource; }
+  RTPHintTrackSource* hintTrackSource() const { return fHintTrackSource; }
+      // non-NULL iff we're sending (from "mediaSource()") a previously-recorded hint track
+
+  Boolean areCurrentlyPlaying() const { return fAreCurrentlyPlaying; }
+
+  GOPCache* gopCache() const { return fGOPCache; }
+
+private:
+  Boolean sendGOPCache(Destinations* dests);
 
 private:
   OnDemandServerMediaSubsession& fMaster;
@@ -140,6 +164,12 @@ private:
   FramedSource* fMediaSource;
 
   Groupsock* fRTPgs; Groupsock* fRTCPgs;
+
+  GOPCache* fGOPCache; // if the stream is shared, and this is enabled
+
+  RTPHintTrackSource* fHintTrackSource;
+  Boolean fMayRecordHintTrack; // True until we first start playing
+  RTPHintTrackRecorder* fHintTrackRecorder; // while we record our stream, if our session has a hint cache
 };
 
 void OnDemandServerMediaSubsession
@@ -168,10 +198,20 @@ void OnDemandServerMediaSubsession
     ++((StreamState*)fLastStreamToken)->referenceCount();
     streamToken = fLastStreamToken;
   } else {
-    // Normal case: Create a new media source:
+    // Normal case: Create a new media source.  (If this track has been streamed
+    // in full before, and its packets were kept in our session's hint cache, then
+    // the source just delivers those packets again.)
     unsigned streamBitrate;
-    FramedSource* mediaSource
-      = createNewStreamSource(clientSessionId, streamBitrate);
+    FramedSource* mediaSource;
+    char const* hintFileName = clientRTCPPort.num() == 0 ? NULL : hintCacheFileName();
+    RTPHintTrackSource* hintTrackSource = hintFileName == NULL ? NULL
+      : fParentSession->hintCache()->lookup(envir(), hintFileName, trackId());
+    if (hintTrackSource != NULL) {
+      mediaSource = hintTrackSource;
+      streamBitrate = hintTrackSource->estBitrate();
+    } else {
+      mediaSource = createNewStreamSource(clientSessionId, streamBitrate);
+    }
 
     // Create 'groupsock' and 'sink' objects for the destination,
     // using previously unused server port numbers:
@@ -220,7 +260,11 @@ void OnDemandServerMediaSubsession
       }
 
       unsigned char rtpPayloadType = 96 + trackNumber()-1; // if dynamic
-      rtpSink = createNewRTPSink(rtpGroupsock, rtpPayloadType, mediaSource);
+      if (hintTrackSource != NULL) {
+	rtpSink = HintedRTPSink::createNew(envir(), rtpGroupsock, *hintTrackSource);
+      } else {
+	rtpSink = createNewRTPSink(rtpGroupsock, rtpPayloadType, mediaSource);
+      }
       udpSink = NULL;
     }
 
@@ -240,7 +284,7 @@ void OnDemandServerMediaSubsession
     // Set up the state of the stream.  The stream will get started later:
     streamToken = fLastStreamToken
       = new StreamState(*this, serverRTPPort, serverRTCPPort, rtpSink, udpSink,
-			streamBitrate, mediaSource,
+			streamBitrate, mediaSource, hintTrackSource,
 			rtpGroupsock, rtcpGroupsock);
   }
 
@@ -266,10 +310,17 @@ void OnDemandServerMediaSubsession::startStream(unsigned clientSessionId,
   Destinations* destinations
     = (Destinations*)(fDestinationsHashTable->Lookup((char const*)clientSessionId));
   if (streamState != NULL) {
-    streamState->startPlaying(destinations,
-			      rtcpRRHandler, rtcpRRHandlerClientData,
-			      serverRequestAlternativeByteHandler, serverRequestAlternativeByteHandlerClientData);
-    if (streamState->rtpSink() != NULL) {
+    Boolean gopCacheWasSent
+      = streamState->startPlaying(destinations,
+				  rtcpRRHandler, rtcpRRHandlerClientData,
+				  serverRequestAlternativeByteHandler, serverRequestAlternativeByteHandlerClientData);
+    if (gopCacheWasSent) {
+      // The client's stream begins with the first of the (already-sent) cached packets.
+      // (Note that we don't preset the next timestamp, because that would make the
+      // packets that follow inconsistent with them.)
+      rtpSeqNum = streamState->gopCache()->firstSeqNo();
+      rtpTimestamp = streamState->gopCache()->firstTimestamp();
+    } else if (streamState->rtpSink() != NULL) {
       rtpSeqNum = streamState->rtpSink()->currentSeqNo();
       rtpTimestamp = streamState->rtpSink()->presetNextTimestamp();
     }
@@ -294,7 +345,14 @@ void OnDemandServerMediaSubsession::seekStream(unsigned /*clientSessionId*/,
 
   StreamState* streamState = (StreamState*)streamToken;
   if (streamState != NULL && streamState->mediaSource() != NULL) {
-    seekStreamSource(streamState->mediaSource(), seekNPT, streamDuration);
+    if (seekNPT != 0.0 || streamDuration > 0.0 || streamState->areCurrentlyPlaying()) {
+      streamState->stopHintTrackRecording();
+    }
+    if (streamState->hintTrackSource() != NULL) {
+      streamState->seekHintTrack(seekNPT, streamDuration);
+    } else {
+      seekStreamSource(streamState->mediaSource(), seekNPT, streamDuration);
+    }
   }
 }
 
@@ -306,7 +364,11 @@ void OnDemandServerMediaSubsession::setStreamScale(unsigned /*clientSessionId*/,
 
   StreamState* streamState = (StreamState*)streamToken;
   if (streamState != NULL && streamState->mediaSource() != NULL) {
-    setStreamSourceScale(streamState->mediaSource(), scale);
+    if (scale != 1.0f) streamState->stopHintTrackRecording();
+    // (A hint track can be sent only at normal speed.)
+    if (streamState->hintTrackSource() == NULL) {
+      setStreamSourceScale(streamState->mediaSource(), scale);
+    }
   }
 }
 
@@ -337,6 +399,11 @@ void OnDemandServerMediaSubsession::deleteStream(unsigned clientSessionId,
   delete destinations;
 }
 
+RTPSink* OnDemandServerMediaSubsession::rtpSinkForStream(void* streamToken) {
+  StreamState* streamState = (StreamState*)streamToken;
+  return streamState == NULL ? NULL : streamState->rtpSink();
+}
+
 char const* OnDemandServerMediaSubsession
 ::getAuxSDPLine(RTPSink* rtpSink, FramedSource* /*inputSource*/) {
   // Default implementation:
@@ -357,6 +424,30 @@ void OnDemandServerMediaSubsession::closeStreamSource(FramedSource *inputSource)
   Medium::close(inputSource);
 }
 
+char const* OnDemandServerMediaSubsession::sdpCacheFileName() const {
+  // Default implementation: Our SDP lines aren't cached
+  return NULL;
+}
+
+char const* OnDemandServerMediaSubsession::hintCacheFileName() {
+  if (fParentSession == NULL || fParentSession->hintCache() == NULL) return NULL;
+
+  // A hint track can't be sent at any other speed, so don't use one if we support 'trick play':
+  float scale = 2.0f;
+  testScaleFactor(scale);
+  return scale == 1.0f ? sdpCacheFileName() : NULL;
+}
+
+RTPHintTrackRecorder* OnDemandServerMediaSubsession
+::newHintTrackRecorder(RTPSink* rtpSink, unsigned estBitrate) {
+  char const* fileName = hintCacheFileName();
+  if (fileName == NULL) return NULL;
+
+  return fParentSession->hintCache()->newRecorder(fileName, trackId(),
+						  rtpSink->rtpPayloadType(),
+						  rtpSink->rtpTimestampFrequency(), estBitrate);
+}
+
 void OnDemandServerMediaSubsession
 ::setSDPLinesFromRTPSink(RTPSink* rtpSink, FramedSource* inputSource, unsigned estBitrate) {
   if (rtpSink == NULL) return;
@@ -367,7 +458,15 @@ void OnDemandServerMediaSubsession
   char* const ipAddressStr = strDup(our_inet_ntoa(serverAddrForSDP));
   char* rtpmapLine = rtpSink->rtpmapLine();
   char const* rangeLine = rangeSDPLine();
-  char const* auxSDPLine = getAuxSDPLine(rtpSink, inputSource);
+  // Computing the 'aux' SDP line may require reading the source (e.g., for H.264
+  // 'config' information), so reuse a previously-cached one, if we can:
+  SDPCache* sdpCache = fParentSession == NULL ? NULL : fParentSession->sdpCache();
+  char const* cacheFileName = sdpCache == NULL ? NULL : sdpCacheFileName();
+  char const* auxSDPLine = cacheFileName == NULL ? NULL : sdpCache->lookup(cacheFileName, trackId());
+  if (auxSDPLine == NULL) {
+    auxSDPLine = getAuxSDPLine(rtpSink, inputSource);
+    if (cacheFileName != NULL) sdpCache->add(cacheFileName, trackId(), auxSDPLine);
+  }
   if (auxSDPLine == NULL) auxSDPLine = "";
 
   char const* const sdpFmt =
@@ -408,6 +507,7 @@ void OnDemandServerMediaSubsession
 
 static void afterPlayingStreamState(void* clientData) {
   StreamState* streamState = (StreamState*)clientData;
+  streamState->finishHintTrackRecording();
   if (streamState->streamDuration() == 0.0) {
     // When the input stream ends, tear it down.  This will cause a RTCP "BYE"
     // to be sent to each client, teling it that the stream has ended.
@@ -424,24 +524,31 @@ StreamState::StreamState(OnDemandServerMediaSubsession& master,
                          Port const& serverRTPPort, Port const& serverRTCPPort,
 			 RTPSink* rtpSink, BasicUDPSink* udpSink,
 			 unsigned totalBW, FramedSource* mediaSource,
+			 RTPHintTrackSource* hintTrackSource,
 			 Groupsock* rtpGS, Groupsock* rtcpGS)
   : fMaster(master), fAreCurrentlyPlaying(False), fReferenceCount(1),
     fServerRTPPort(serverRTPPort), fServerRTCPPort(serverRTCPPort),
     fRTPSink(rtpSink), fUDPSink(udpSink), fStreamDuration(master.duration()),
     fTotalBW(totalBW), fRTCPInstance(NULL) /* created later */,
-    fMediaSource(mediaSource), fRTPgs(rtpGS), fRTCPgs(rtcpGS) {
+    fMediaSource(mediaSource), fRTPgs(rtpGS), fRTCPgs(rtcpGS), fGOPCache(NULL),
+    fHintTrackSource(hintTrackSource),
+    fMayRecordHintTrack(hintTrackSource == NULL && rtpSink != NULL), fHintTrackRecorder(NULL) {
+  if (master.fReuseFirstSource && master.fGOPCacheSize > 0 && fRTPSink != NULL) {
+    fGOPCache = new GOPCache(master.fGOPCacheSize);
+    fRTPSink->setGOPCache(fGOPCache);
+  }
 }
 
 StreamState::~StreamState() {
   reclaim();
 }
 
-void StreamState
+Boolean StreamState
 ::startPlaying(Destinations* dests,
 	       TaskFunc* rtcpRRHandler, void* rtcpRRHandlerClientData,
 	       ServerRequestAlternativeByteHandler* serverRequestAlternativeByteHandler,
 	       void* serverRequestAlternativeByteHandlerClientData) {
-  if (dests == NULL) return;
+  if (dests == NULL) return False;
 
   if (fRTCPInstance == NULL && fRTPSink != NULL) {
     // Create (and start) a 'RTCP instance' for this RTP sink:
@@ -474,7 +581,20 @@ void StreamState
     }
   }
 
+  // If we're joining a stream that's already playing, first bring the new destinations
+  // up to date from our "GOPCache" (if any).  (Because we're adding them to the stream
+  // at the same time, they won't miss - or get a duplicate of - any packet.)
+  Boolean gopCacheWasSent = fAreCurrentlyPlaying && sendGOPCache(dests);
+
   if (!fAreCurrentlyPlaying && fMediaSource != NULL) {
+    if (fGOPCache != NULL) fGOPCache->reset();
+    if (fMayRecordHintTrack) {
+      // This is our first play, from the start, so record the packets that we send
+      // (in case our stream is played in full):
+      fHintTrackRecorder = fMaster.newHintTrackRecorder(fRTPSink, fTotalBW);
+      fRTPSink->setHintTrackRecorder(fHintTrackRecorder);
+      fMayRecordHintTrack = False;
+    }
     if (fRTPSink != NULL) {
       fRTPSink->startPlaying(*fMediaSource, afterPlayingStreamState, this);
       fAreCurrentlyPlaying = True;
@@ -483,9 +603,31 @@ void StreamState
       fAreCurrentlyPlaying = True;
     }
   }
+
+  return gopCacheWasSent;
+}
+
+Boolean StreamState::sendGOPCache(Destinations* dests) {
+  if (fGOPCache == NULL || !fGOPCache->isUsable()) return False;
+
+  if (dests->isTCP) {
+    fRTPSink->sendPacketsToStreamSocket(dests->tcpSocketNum, dests->rtpChannelId,
+					fGOPCache->packets(), fGOPCache->packetSizes(),
+					fGOPCache->numPackets());
+  } else {
+    if (fRTPgs == NULL) return False;
+    if (fRTPgs->writeBatch(dests->addr.s_addr, dests->rtpPort, fRTPgs->ttl(),
+			   fGOPCache->packets(), fGOPCache->packetSizes(),
+			   fGOPCache->numPackets()) <= 0) {
+      return False;
+    }
+  }
+
+  return True;
 }
 
 void StreamState::pause() {
+  stopHintTrackRecording();
   if (fRTPSink != NULL) fRTPSink->stopPlaying();
   if (fUDPSink != NULL) fUDPSink->stopPlaying();
   fAreCurrentlyPlaying = False;
@@ -514,13 +656,46 @@ void StreamState::endPlaying(Destinations* dests) {
 
 void StreamState::reclaim() {
   // Delete allocated media objects
+  stopHintTrackRecording();
   Medium::close(fRTCPInstance) /* will send a RTCP BYE */; fRTCPInstance = NULL;
   Medium::close(fRTPSink); fRTPSink = NULL;
   Medium::close(fUDPSink); fUDPSink = NULL;
+  delete fGOPCache; fGOPCache = NULL;
 
-  fMaster.closeStreamSource(fMediaSource); fMediaSource = NULL;
+  if (fHintTrackSource != NULL) {
+    // Our source wasn't created by our master:
+    Medium::close(fHintTrackSource); fHintTrackSource = NULL;
+  } else {
+    fMaster.closeStreamSource(fMediaSource);
+  }
+  fMediaSource = NULL;
   if (fMaster.fLastStreamToken == this) fMaster.fLastStreamToken = NULL;
 
   delete fRTPgs; fRTPgs = NULL;
   delete fRTCPgs; fRTCPgs = NULL;
 }
+
+void StreamState::seekHintTrack(double seekNPT, double streamDuration) {
+  // Stop sending (if we are), so that we restart - at the new position - with the
+  // timing and timestamps of the first packet that we then send:
+  if (fRTPSink != NULL) fRTPSink->stopPlaying();
+  fAreCurrentlyPlaying = False;
+
+  fHintTrackSource->seekToTime(seekNPT, streamDuration);
+}
+
+void StreamState::stopHintTrackRecording() {
+  fMayRecordHintTrack = False;
+  if (fHintTrackRecorder == NULL) return;
+
+  if (fRTPSink != NULL) fRTPSink->setHintTrackRecorder(NULL);
+  delete fHintTrackRecorder; fHintTrackRecorder = NULL; // discards the recording
+}
+
+void StreamState::finishHintTrackRecording() {
+  if (fHintTrackRecorder == NULL) return;
+
+  if (fRTPSink != NULL) fRTPSink->setHintTrackRecorder(NULL);
+  fHintTrackRecorder->finish();
+  delete fHintTrackRecorder; fHintTrackRecorder = NULL;
+}
@@ -150,6 +150,11 @@ void PassiveServerMediaSubsession::startStream(unsigned /*clientSessionId*/,
   increaseSendBufferTo(envir(), fRTPSink.groupsockBeingUsed().socketNum(), rtpBufSize);
 }
 
+RTPSink* PassiveServerMediaSubsession::rtpSinkForStream(void* /*streamToken*/) {
+  // All of our clients share the same "RTPSink":
+  return &fRTPSink;
+}
+
 PassiveServerMediaSubsession::~PassiveServerMediaSubsession() {
   delete[] fSDPLines;
 }
@@ -37,20 +37,10 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 ////////// SubsessionIOState, ChunkDescriptor ///////////
 // A structure used to represent the I/O state of each input 'subsession':
 
+// Each track's chunks are kept in a single (growable) array, rather than
+// in a linked list, to avoid a heap allocation for each new chunk:
 class ChunkDescriptor {
 public:
-  ChunkDescriptor(int64_t offsetInFile, unsigned size,
-		  unsigned frameSize, unsigned frameDuration,
-		  struct timeval presentationTime);
-  virtual ~ChunkDescriptor();
-
-  ChunkDescriptor* extendChunk(int64_t newOffsetInFile, unsigned newSize,
-			       unsigned newFrameSize,
-			       unsigned newFrameDuration,
-			       struct timeval newPresentationTime);
-      // this may end up allocating a new chunk instead
-public:
-  ChunkDescriptor* fNextChunk;
   int64_t fOffsetInFile;
   unsigned fNumFrames;
   unsigned fFrameSize;
@@ -86,16 +76,6 @@ private:
   unsigned fBytesInUse;
 };
 
-class SyncFrame {
-public:
-  SyncFrame(unsigned frameNum);
-  virtual ~SyncFrame();
-
-public:
-  class SyncFrame *nextSyncFrame;
-  unsigned sfFrameNum;  
-};
-
 // A 64-bit counter, used below:
 class Count64 {
 public:
@@ -120,6 +100,13 @@ public:
 			 struct timeval presentationTime);
   void onSourceClosure();
 
+  int64_t outputPosition() const;
+      // where our next frame data will go: a file position, or (if we're writing
+      // a fragmented MP4 file) an offset within our current fragment's data
+  void writeFrameData(unsigned char const* data, unsigned dataSize);
+  unsigned numFragmentDataBytes() const; // the data described by our chunks
+  void resetFragment(); // after our current fragment's data has been output
+
   Boolean syncOK(struct timeval presentationTime);
       // returns true iff data is usable despite a sync check
 
@@ -167,9 +154,17 @@ public:
   unsigned fQTInitialOffsetDuration;
       // if there's a pause at the beginning
 
-  ChunkDescriptor *fHeadChunk, *fTailChunk;
-  unsigned fNumChunks;
-  SyncFrame *fHeadSyncFrame, *fTailSyncFrame;
+  ChunkDescriptor* fChunks;
+  unsigned fNumChunks, fMaxNumChunks;
+  unsigned* fSyncFrameNums; // sample numbers of sync (H.264 IDR) frames, in order
+  unsigned fNumSyncFrames, fMaxNumSyncFrames;
+
+  // Used only when writing a fragmented MP4 file:
+  unsigned char* fFragmentData;
+  unsigned fFragmentDataSize, fFragmentDataMaxSize;
+  unsigned fFragmentFirstSampleNumber;
+  u_int64_t fFragmentDecodeTime; // the total duration of our previous fragments
+  int64_t fTRUNDataOffsetPosn; // position of the 'data_offset' in our 'trun' atom
 
   // Counters to be used in the hint track's 'udta'/'hinf' atom;
   struct hinf {
@@ -228,8 +223,9 @@ QuickTimeFileSink::QuickTimeFileSink(UsageEnvironment& env,
 				     Boolean packetLossCompensate,
 				     Boolean syncStreams,
 				     Boolean generateHintTracks,
-				     Boolean generateMP4Format)
-  : Medium(env), fInputSession(inputSession),
+				     Boolean generateMP4Format,
+				     unsigned fragmentDuration)
+  : Medium(env), fInputSession(inputSession), fOutput(NULL),
     fBufferSize(bufferSize), fPacketLossCompensate(packetLossCompensate),
     fSyncStreams(syncStreams), fGenerateMP4Format(generateMP4Format),
     fAreCurrentlyBeingPlayed(False),
@@ -237,9 +233,21 @@ QuickTimeFileSink::QuickTimeFileSink(UsageEnvironment& env,
     fNumSubsessions(0), fNumSyncedSubsessions(0),
     fHaveCompletedOutputFile(False),
     fMovieWidth(movieWidth), fMovieHeight(movieHeight),
-    fMovieFPS(movieFPS), fMaxTrackDurationM(0) {
+    fMovieFPS(movieFPS), fMaxTrackDurationM(0),
+    fFragmentDuration(fragmentDuration), fFragmentTriggerTrack(NULL),
+    fHaveWrittenInitSegment(False), fHaveFragmentStartTime(False),
+    fFragmentSequenceNumber(0) {
   fOutFid = OpenOutputFile(env, outputFileName);
   if (fOutFid == NULL) return;
+  fOutput = new AsyncFileWriter(fOutFid);
+
+  if (fFragmentDuration > 0) {
+    fGenerateMP4Format = True; // fragmented files are always MP4
+    if (generateHintTracks) {
+      env << "QuickTimeFileSink: Warning: Hint tracks can't be generated for a fragmented MP4 file\n";
+      generateHintTracks = False;
+    }
+  }
 
   fNewestSyncTime.tv_sec = fNewestSyncTime.tv_usec = 0;
   fFirstDataTime.tv_sec = fFirstDataTime.tv_usec = (unsigned)(~0);
@@ -296,6 +304,15 @@ QuickTimeFileSink::QuickTimeFileSink(UsageEnvironment& env,
     }
 
     ++fNumSubsessions;
+
+    // When writing a fragmented file, the first video track (if any) decides
+    // when each fragment ends:
+    if (fFragmentDuration > 0
+	&& (fFragmentTriggerTrack == NULL
+	    || (fFragmentTriggerTrack->fQTcomponentSubtype != fourChar('v','i','d','e')
+		&& ioState->fQTcomponentSubtype == fourChar('v','i','d','e')))) {
+      fFragmentTriggerTrack = ioState;
+    }
   }
 
   // Use the current time as the file's creation and modification
@@ -304,10 +321,13 @@ QuickTimeFileSink::QuickTimeFileSink(UsageEnvironment& env,
   gettimeofday(&fStartTime, NULL);
   fAppleCreationTime = fStartTime.tv_sec - 0x83dac000;
 
+  // A fragmented file has no initial "mdat" atom; instead, each fragment gets its own:
+  if (fFragmentDuration > 0) return;
+
   // Begin by writing a "mdat" atom at the start of the file.
   // (Later, when we've finished copying data to the file, we'll come
   // back and fill in its size.)
-  fMDATposition = TellFile64(fOutFid);
+  fMDATposition = fOutput->position();
   addAtomHeader64("mdat");
   // add 64Bit offset
   fMDATposition += 8;
@@ -328,7 +348,8 @@ QuickTimeFileSink::~QuickTimeFileSink() {
     delete ioState;
   }
 
-  // Finally, close our output file:
+  // Finally, close our output file (after all of our buffered output has been written):
+  delete fOutput;
   CloseOutputFile(fOutFid);
 }
 
@@ -343,10 +364,12 @@ QuickTimeFileSink::createNew(UsageEnvironment& env,
 			     Boolean packetLossCompensate,
 			     Boolean syncStreams,
 			     Boolean generateHintTracks,
-			     Boolean generateMP4Format) {
+			     Boolean generateMP4Format,
+			     unsigned fragmentDuration) {
   QuickTimeFileSink* newSink = 
     new QuickTimeFileSink(env, inputSession, outputFileName, bufferSize, movieWidth, movieHeight, movieFPS,
-			  packetLossCompensate, syncStreams, generateHintTracks, generateMP4Format);
+			  packetLossCompensate, syncStreams, generateHintTracks, generateMP4Format,
+			  fragmentDuration);
   if (newSink == NULL || newSink->fOutFid == NULL) {
     Medium::close(newSink);
     return NULL;
@@ -470,9 +493,106 @@ static Boolean timevalGE(struct timeval const& tv1,
 void QuickTimeFileSink::completeOutputFile() {
   if (fHaveCompletedOutputFile || fOutFid == NULL) return;
 
+  if (fFragmentDuration > 0) {
+    // Output our final fragment (or, if there was no data, just the "moov"):
+    completeFragment();
+  } else {
+    completeNonFragmentedOutputFile();
+  }
+
+  if (fOutput->hadError()) {
+    envir() << "QuickTimeFileSink: Warning: Failed to write some of the output file\n";
+  }
+
+  // We're done:
+  fHaveCompletedOutputFile = True;
+}
+
+void QuickTimeFileSink
+::startNewFragmentIfNeeded(SubsessionIOState& ioState,
+			   struct timeval const& presentationTime,
+			   unsigned char const* frameData) {
+  if (fFragmentDuration == 0 || &ioState != fFragmentTriggerTrack) return;
+
+  if (!fHaveFragmentStartTime) {
+    fFragmentStartTime = presentationTime;
+    fHaveFragmentStartTime = True;
+    return;
+  }
+
+  int msSinceFragmentStart
+    = (presentationTime.tv_sec - fFragmentStartTime.tv_sec)*1000
+    + (presentationTime.tv_usec - fFragmentStartTime.tv_usec)/1000;
+  if (msSinceFragmentStart < (int)fFragmentDuration) return;
+
+  // For H.264 video, each fragment must begin with an IDR frame:
+  if (ioState.fQTMediaDataAtomCreator == &QuickTimeFileSink::addAtom_avc1
+      && *frameData != H264_IDR_FRAME) return;
+
+  completeFragment();
+  fFragmentStartTime = presentationTime;
+}
+
+void QuickTimeFileSink::completeFragment() {
+  if (!fHaveWrittenInitSegment) {
+    // Begin the file with a "ftyp" atom, and a "moov" atom that describes
+    // our tracks (but none of their samples):
+    addAtom_ftyp();
+    addAtom_moov();
+    fHaveWrittenInitSegment = True;
+  }
+
+  // Check how much data we have for this fragment:
+  unsigned numSamples = 0, mdatDataSize = 0;
+  MediaSubsessionIterator iter(fInputSession);
+  MediaSubsession* subsession;
+  while ((subsession = iter.next()) != NULL) {
+    SubsessionIOState* ioState = (SubsessionIOState*)(subsession->miscPtr);
+    if (ioState == NULL) continue;
+
+    for (unsigned c = 0; c < ioState->fNumChunks; ++c) {
+      numSamples += ioState->fChunks[c].fNumFrames*ioState->fQTSamplesPerFrame;
+    }
+    mdatDataSize += ioState->numFragmentDataBytes();
+  }
+  if (numSamples == 0) return; // there's nothing to output
+
+  // Output a "moof" atom that describes the data.  (Make sure that all of it goes into
+  // a single output buffer, so that its "data_offset" fields can be filled in cheaply.):
+  ++fFragmentSequenceNumber;
+  fOutput->reserve(100 + 100*fNumSubsessions + 12*numSamples);
+  int64_t const moofPosition = fOutput->position();
+  addAtom_moof();
+
+  // Then, output a "mdat" atom containing each track's data (in the same order
+  // as its "traf" atom).  Now that we know where each track's data will be, begin
+  // by filling in the "data_offset"s (while the "moof" is still in our current buffer):
+  addWord(8 + mdatDataSize);
+  add4ByteString("mdat");
+  unsigned dataOffset = (unsigned)(fOutput->position() - moofPosition);
+  iter.reset();
+  while ((subsession = iter.next()) != NULL) {
+    SubsessionIOState* ioState = (SubsessionIOState*)(subsession->miscPtr);
+    if (ioState == NULL || ioState->fNumChunks == 0) continue;
+
+    setWord(ioState->fTRUNDataOffsetPosn, dataOffset + (unsigned)ioState->fChunks[0].fOffsetInFile);
+    dataOffset += ioState->numFragmentDataBytes();
+  }
+
+  iter.reset();
+  while ((subsession = iter.next()) != NULL) {
+    SubsessionIOState* ioState = (SubsessionIOState*)(subsession->miscPtr);
+    if (ioState == NULL) continue;
+
+    fOutput->write(ioState->fFragmentData, ioState->numFragmentDataBytes());
+    ioState->resetFragment();
+  }
+}
+
+void QuickTimeFileSink::completeNonFragmentedOutputFile() {
   // Begin by filling in the initial "mdat" atom with the current
   // file size:
-  int64_t curFileSize = TellFile64(fOutFid);
+  int64_t curFileSize = fOutput->position();
   setWord64(fMDATposition, (u_int64_t)curFileSize);
 
   // Then, note the time of the first received data:
@@ -483,10 +603,9 @@ void QuickTimeFileSink::completeOutputFile() {
       = (SubsessionIOState*)(subsession->miscPtr);
     if (ioState == NULL) continue;
 
-    ChunkDescriptor* const headChunk = ioState->fHeadChunk;
-    if (headChunk != NULL
-	&& timevalGE(fFirstDataTime, headChunk->fPresentationTime)) {
-      fFirstDataTime = headChunk->fPresentationTime;
+    if (ioState->fNumChunks > 0
+	&& timevalGE(fFirstDataTime, ioState->fChunks[0].fPresentationTime)) {
+      fFirstDataTime = ioState->fChunks[0].fPresentationTime;
     }
   }
 
@@ -511,9 +630,6 @@ void QuickTimeFileSink::completeOutputFile() {
 
   // Then, add a "moov" atom for the file metadata:
   addAtom_moov();
-
-  // We're done:
-  fHaveCompletedOutputFile = True;
 }
 
 
@@ -526,8 +642,11 @@ SubsessionIOState::SubsessionIOState(QuickTimeFileSink& sink,
   : fHintTrackForUs(NULL), fTrackHintedByUs(NULL),
     fOurSink(sink), fOurSubsession(subsession),
     fLastPacketRTPSeqNum(0), fHaveBeenSynced(False), fQTTotNumSamples(0), 
-    fHeadChunk(NULL), fTailChunk(NULL), fNumChunks(0),
-    fHeadSyncFrame(NULL), fTailSyncFrame(NULL) {
+    fQTDurationM(0), fQTDurationT(0),
+    fChunks(NULL), fNumChunks(0), fMaxNumChunks(0),
+    fSyncFrameNums(NULL), fNumSyncFrames(0), fMaxNumSyncFrames(0),
+    fFragmentData(NULL), fFragmentDataSize(0), fFragmentDataMaxSize(0),
+    fFragmentFirstSampleNumber(1), fFragmentDecodeTime(0), fTRUNDataOffsetPosn(-1) {
   fTrackID = ++fCurrentTrackNumber;
 
   fBuffer = new SubsessionBuffer(fOurSink.fBufferSize);
@@ -544,7 +663,8 @@ SubsessionIOState::SubsessionIOState(QuickTimeFileSink& sink,
 
 SubsessionIOState::~SubsessionIOState() {
   delete fBuffer; delete fPrevBuffer;
-  delete fHeadChunk; delete fHeadSyncFrame;
+  delete[] fChunks; delete[] fSyncFrameNums;
+  delete[] fFragmentData;
 }
 
 Boolean SubsessionIOState::setQTstate() {
@@ -663,13 +783,8 @@ void SubsessionIOState::setFinalQTstate() {
   // Compute derived parameters, by running through the list of chunks:
   fQTDurationT = 0;
 
-  ChunkDescriptor* chunk = fHeadChunk;
-  while (chunk != NULL) {
-    unsigned const numFrames = chunk->fNumFrames;
-    unsigned const dur = numFrames*chunk->fFrameDuration;
-    fQTDurationT += dur;
-
-    chunk = chunk->fNextChunk;
+  for (unsigned i = 0; i < fNumChunks; ++i) {
+    fQTDurationT += fChunks[i].fNumFrames*fChunks[i].fFrameDuration;
   }
 
   // Convert this duration from track to movie time scale:
@@ -768,7 +883,6 @@ void SubsessionIOState::useFrame(SubsessionBuffer& buffer) {
   unsigned char* const frameSource = buffer.dataStart();
   unsigned const frameSize = buffer.bytesInUse();
   struct timeval const& presentationTime = buffer.presentationTime();
-  int64_t const destFileOffset = TellFile64(fOurSink.fOutFid);
   unsigned sampleNumberOfFrameStart = fQTTotNumSamples + 1;
   Boolean avcHack = fQTMediaDataAtomCreator == &QuickTimeFileSink::addAtom_avc1;
 
@@ -776,6 +890,9 @@ void SubsessionIOState::useFrame(SubsessionBuffer& buffer) {
   // just give this frame a fixed duration:
   if (!fOurSink.fSyncStreams
       || fQTcomponentSubtype != fourChar('v','i','d','e')) {
+    fOurSink.startNewFragmentIfNeeded(*this, presentationTime, frameSource);
+    int64_t const destFileOffset = outputPosition();
+
     unsigned const frameDuration = fQTTimeUnitsPerSample*fQTSamplesPerFrame;
     unsigned frameSizeToUse = frameSize;
     if (avcHack) frameSizeToUse += 4; // H.264/AVC gets the frame size prefix
@@ -802,14 +919,19 @@ void SubsessionIOState::useFrame(SubsessionBuffer& buffer) {
       sampleNumberOfFrameStart = fQTTotNumSamples + 1;
     }
 
+    // (This must be done only after the previous frame has been recorded, because
+    // that frame belongs to the current fragment.)
+    fOurSink.startNewFragmentIfNeeded(*this, presentationTime, frameSource);
+    int64_t const destFileOffset = outputPosition();
+
     if (avcHack && (*frameSource == H264_IDR_FRAME)) {
-      SyncFrame* newSyncFrame = new SyncFrame(fQTTotNumSamples + 1);
-      if (fTailSyncFrame == NULL) {
-        fHeadSyncFrame = newSyncFrame;
-      } else {
-        fTailSyncFrame->nextSyncFrame = newSyncFrame;
+      if (fNumSyncFrames == fMaxNumSyncFrames) {
+	fMaxNumSyncFrames = fMaxNumSyncFrames == 0 ? 64 : 2*fMaxNumSyncFrames;
+	unsigned* newSyncFrameNums = new unsigned[fMaxNumSyncFrames];
+	if (fNumSyncFrames > 0) memmove(newSyncFrameNums, fSyncFrameNums, fNumSyncFrames*sizeof (unsigned));
+	delete[] fSyncFrameNums; fSyncFrameNums = newSyncFrameNums;
       }
-      fTailSyncFrame = newSyncFrame;
+      fSyncFrameNums[fNumSyncFrames++] = fQTTotNumSamples + 1;
     }
 
     // Remember the current frame for next time:
@@ -818,10 +940,16 @@ void SubsessionIOState::useFrame(SubsessionBuffer& buffer) {
     fPrevFrameState.destFileOffset = destFileOffset;
   }
 
-  if (avcHack) fOurSink.addWord(frameSize);
+  if (avcHack) {
+    // Prefix the frame with its (big-endian) size:
+    unsigned char sizePrefix[4];
+    sizePrefix[0] = frameSize>>24; sizePrefix[1] = frameSize>>16;
+    sizePrefix[2] = frameSize>>8; sizePrefix[3] = frameSize;
+    writeFrameData(sizePrefix, 4);
+  }
 
   // Write the data into the file:
-  fwrite(frameSource, 1, frameSize, fOurSink.fOutFid);
+  writeFrameData(frameSource, frameSize);
 
   // If we have a hint track, then write to it also:
   if (hasHintTrack()) {
@@ -882,7 +1010,7 @@ void SubsessionIOState::useFrameForHinting(unsigned frameSize,
       }
     }
 
-    int64_t const hintSampleDestFileOffset = TellFile64(fOurSink.fOutFid);
+    int64_t const hintSampleDestFileOffset = fOurSink.fOutput->position();
 
     unsigned const maxPacketSize = 1450;
     unsigned short numPTEntries
@@ -1047,26 +1175,82 @@ unsigned SubsessionIOState::useFrame1(unsigned sourceDataSize,
   unsigned const numFrames = sourceDataSize/frameSize;
   unsigned const numSamples = numFrames*fQTSamplesPerFrame;
 
-  // Record the information about which 'chunk' this data belongs to:
-  ChunkDescriptor* newTailChunk;
-  if (fTailChunk == NULL) {
-    newTailChunk = fHeadChunk
-      = new ChunkDescriptor(destFileOffset, sourceDataSize,
-			    frameSize, frameDuration, presentationTime);
-  } else {
-    newTailChunk = fTailChunk->extendChunk(destFileOffset, sourceDataSize,
-					   frameSize, frameDuration,
-					   presentationTime);
+  // Record the information about which 'chunk' this data belongs to.
+  // First, check whether the data just extends our last chunk.  (It does if it's
+  // just after it, and if the frame size and frame duration have not changed.):
+  if (fNumChunks > 0) {
+    ChunkDescriptor& tailChunk = fChunks[fNumChunks-1];
+    if (destFileOffset == tailChunk.fOffsetInFile + tailChunk.fNumFrames*tailChunk.fFrameSize
+	&& frameSize == tailChunk.fFrameSize && frameDuration == tailChunk.fFrameDuration) {
+      tailChunk.fNumFrames += numFrames;
+      return numSamples;
+    }
   }
-  if (newTailChunk != fTailChunk) {
-   // This data created a new chunk, rather than extending the old one
-    ++fNumChunks;
-    fTailChunk = newTailChunk;
+
+  // Otherwise, this data begins a new chunk:
+  if (fNumChunks == fMaxNumChunks) {
+    fMaxNumChunks = fMaxNumChunks == 0 ? 256 : 2*fMaxNumChunks;
+    ChunkDescriptor* newChunks = new ChunkDescriptor[fMaxNumChunks];
+    if (fNumChunks > 0) memmove(newChunks, fChunks, fNumChunks*sizeof (ChunkDescriptor));
+    delete[] fChunks; fChunks = newChunks;
   }
+  ChunkDescriptor& newChunk = fChunks[fNumChunks++];
+  newChunk.fOffsetInFile = destFileOffset;
+  newChunk.fNumFrames = numFrames;
+  newChunk.fFrameSize = frameSize;
+  newChunk.fFrameDuration = frameDuration;
+  newChunk.fPresentationTime = presentationTime;
 
   return numSamples;
 }
 
+int64_t SubsessionIOState::outputPosition() const {
+  return fOurSink.fFragmentDuration > 0 ? (int64_t)fFragmentDataSize : fOurSink.fOutput->position();
+}
+
+void SubsessionIOState::writeFrameData(unsigned char const* data, unsigned dataSize) {
+  if (fOurSink.fFragmentDuration == 0) {
+    fOurSink.fOutput->write(data, dataSize);
+    return;
+  }
+
+  // We're writing a fragmented file, so keep the data until our current fragment ends:
+  if (fFragmentDataSize + dataSize > fFragmentDataMaxSize) {
+    unsigned newMaxSize = fFragmentDataMaxSize == 0 ? 64*1024 : 2*fFragmentDataMaxSize;
+    while (newMaxSize < fFragmentDataSize + dataSize) newMaxSize *= 2;
+    unsigned char* newFragmentData = new unsigned char[newMaxSize];
+    if (fFragmentDataSize > 0) memmove(newFragmentData, fFragmentData, fFragmentDataSize);
+    delete[] fFragmentData; fFragmentData = newFragmentData;
+    fFragmentDataMaxSize = newMaxSize;
+  }
+  memmove(&fFragmentData[fFragmentDataSize], data, dataSize);
+  fFragmentDataSize += dataSize;
+}
+
+unsigned SubsessionIOState::numFragmentDataBytes() const {
+  if (fNumChunks == 0) return 0;
+
+  ChunkDescriptor const& tailChunk = fChunks[fNumChunks-1];
+  return (unsigned)tailChunk.fOffsetInFile + tailChunk.fNumFrames*tailChunk.fFrameSize;
+}
+
+void SubsessionIOState::resetFragment() {
+  for (unsigned i = 0; i < fNumChunks; ++i) {
+    fFragmentDecodeTime += fChunks[i].fNumFrames*fChunks[i].fFrameDuration;
+  }
+
+  // Keep any data that's not yet described by a chunk (i.e., a synced video frame
+  // whose duration isn't yet known); it will belong to the next fragment:
+  unsigned const numBytesUsed = numFragmentDataBytes();
+  fFragmentDataSize -= numBytesUsed;
+  if (fFragmentDataSize > 0) memmove(fFragmentData, &fFragmentData[numBytesUsed], fFragmentDataSize);
+  fPrevFrameState.destFileOffset -= numBytesUsed;
+
+  fNumChunks = 0;
+  fNumSyncFrames = 0;
+  fFragmentFirstSampleNumber = fQTTotNumSamples + 1;
+}
+
 void SubsessionIOState::onSourceClosure() {
   fOurSourceIsActive = False;
   fOurSink.onSourceClosure1();
@@ -1116,14 +1300,6 @@ void SubsessionIOState::setHintTrack(SubsessionIOState* hintedTrack,
   if (hintTrack != NULL) hintTrack->fTrackHintedByUs = hintedTrack;
 }
 
-SyncFrame::SyncFrame(unsigned frameNum)
-  : nextSyncFrame(NULL), sfFrameNum(frameNum) {
-}  
-
-SyncFrame::~SyncFrame() {
-  delete nextSyncFrame;
-}
-
 void Count64::operator+=(unsigned arg) {
   unsigned newLo = lo + arg;
   if (newLo < lo) { // lo has overflowed
@@ -1132,46 +1308,6 @@ void Count64::operator+=(unsigned arg) {
   lo = newLo;
 }
 
-ChunkDescriptor
-::ChunkDescriptor(int64_t offsetInFile, unsigned size,
-		  unsigned frameSize, unsigned frameDuration,
-		  struct timeval presentationTime)
-  : fNextChunk(NULL), fOffsetInFile(offsetInFile),
-    fNumFrames(size/frameSize),
-    fFrameSize(frameSize), fFrameDuration(frameDuration),
-    fPresentationTime(presentationTime) {
-}
-
-ChunkDescriptor::~ChunkDescriptor() {
-  delete fNextChunk;
-}
-
-ChunkDescriptor* ChunkDescriptor
-::extendChunk(int64_t newOffsetInFile, unsigned newSize,
-	      unsigned newFrameSize, unsigned newFrameDuration,
-	      struct timeval newPresentationTime) {
-  // First, check whether the new space is just at the end of this
-  // existing chunk:
-  if (newOffsetInFile == fOffsetInFile + fNumFrames*fFrameSize) {
-    // We can extend this existing chunk, provided that the frame size
-    // and frame duration have not changed:
-    if (newFrameSize == fFrameSize && newFrameDuration == fFrameDuration) {
-      fNumFrames += newSize/fFrameSize;
-      return this;
-    }
-  }
-
-  // We'll allocate a new ChunkDescriptor, and link it to the end of us:
-  ChunkDescriptor* newDescriptor
-    = new ChunkDescriptor(newOffsetInFile, newSize,
-			  newFrameSize, newFrameDuration,
-			  newPresentationTime);
-
-  fNextChunk = newDescriptor;
-
-  return newDescriptor;
-}
-
 
 ////////// QuickTime-specific implementation //////////
 
@@ -1255,30 +1391,22 @@ unsigned QuickTimeFileSink::addAtomHeader64(char const* atomName) {
 }
 
 void QuickTimeFileSink::setWord(int64_t filePosn, unsigned size) {
-  do {
-    if (SeekFile64(fOutFid, filePosn, SEEK_SET) < 0) break;
-    addWord(size);
-    if (SeekFile64(fOutFid, 0, SEEK_END) < 0) break; // go back to where we were
-
-    return;
-  } while (0);
+  unsigned char bytes[4];
+  bytes[0] = size>>24; bytes[1] = size>>16; bytes[2] = size>>8; bytes[3] = size;
+  if (fOutput->overwrite(filePosn, bytes, 4)) return;
 
-  // One of the fseek()s failed, probable because we're not a seekable file
-  envir() << "QuickTimeFileSink::setWord(): fseek failed (err "
+  // This failed, probably because we're not a seekable file
+  envir() << "QuickTimeFileSink::setWord(): failed to overwrite the output (err "
 	  << envir().getErrno() << ")\n";
 }
 
 void QuickTimeFileSink::setWord64(int64_t filePosn, u_int64_t size) {
-  do {
-    if (SeekFile64(fOutFid, filePosn, SEEK_SET) < 0) break;
-    addWord64(size);
-    if (SeekFile64(fOutFid, 0, SEEK_END) < 0) break; // go back to where we were
+  unsigned char bytes[8];
+  for (unsigned i = 0; i < 8; ++i) bytes[i] = (unsigned char)(size>>(56-8*i));
+  if (fOutput->overwrite(filePosn, bytes, 8)) return;
 
-    return;
-  } while (0);
-
-  // One of the fseek()s failed, probable because we're not a seekable file
-  envir() << "QuickTimeFileSink::setWord(): fseek failed (err "
+  // This failed, probably because we're not a seekable file
+  envir() << "QuickTimeFileSink::setWord64(): failed to overwrite the output (err "
 	  << envir().getErrno() << ")\n";
 }
 
@@ -1286,7 +1414,7 @@ void QuickTimeFileSink::setWord64(int64_t filePosn, u_int64_t size) {
 
 #define addAtom(name) \
     unsigned QuickTimeFileSink::addAtom_##name() { \
-    int64_t initFilePosn = TellFile64(fOutFid); \
+    int64_t initFilePosn = fOutput->position(); \
     unsigned size = addAtomHeader("" #name "")
 
 #define addAtomEnd \
@@ -1299,6 +1427,7 @@ addAtom(ftyp);
   size += addWord(0x00000000);
   size += add4ByteString("mp42");
   size += add4ByteString("isom");
+  if (fFragmentDuration > 0) size += add4ByteString("iso5"); // for "tfdt"
 addAtomEnd;
 
 addAtom(moov);
@@ -1341,6 +1470,11 @@ addAtom(moov);
       size += addAtom_trak();
     }
   }
+
+  if (fFragmentDuration > 0) {
+    // The samples will be described by (subsequent) "moof" atoms:
+    size += addAtom_mvex();
+  }
 addAtomEnd;
 
 addAtom(mvhd);
@@ -1353,7 +1487,7 @@ addAtom(mvhd);
   size += addWord(movieTimeScale()); // Time scale
 
   unsigned const duration = fMaxTrackDurationM;
-  fMVHD_durationPosn = TellFile64(fOutFid);
+  fMVHD_durationPosn = fOutput->position();
   size += addWord(duration); // Duration
 
   size += addWord(0x00010000); // Preferred rate
@@ -1380,7 +1514,8 @@ addAtom(trak);
 
   // If we're synchronizing the media streams (or are a hint track),
   // add an edit list that helps do this:
-  if (fCurrentIOState->fHeadChunk != NULL
+  // (A fragmented file's "moov" describes no samples, so has no edits.)
+  if (fCurrentIOState->fNumChunks > 0 && fFragmentDuration == 0
       && (fSyncStreams || fCurrentIOState->isHintTrack())) {
     size += addAtom_edts();
   }
@@ -1407,7 +1542,7 @@ addAtom(tkhd);
   size += addWord(0x00000000); // Reserved
 
   unsigned const duration = fCurrentIOState->fQTDurationM; // movie units
-  fCurrentIOState->fTKHD_durationPosn = TellFile64(fOutFid);
+  fCurrentIOState->fTKHD_durationPosn = fOutput->position();
   size += addWord(duration); // Duration
   size += addZeroWords(3); // Reserved+Layer+Alternate grp
   size += addWord(0x01000000); // Volume + Reserved
@@ -1446,7 +1581,7 @@ addAtom(elst);
 
   // Add a dummy "Number of entries" field
   // (and remember its position).  We'll fill this field in later:
-  int64_t numEntriesPosition = TellFile64(fOutFid);
+  int64_t numEntriesPosition = fOutput->position();
   size += addWord(0); // dummy for "Number of entries"
   unsigned numEdits = 0;
   unsigned totalDurationOfEdits = 0; // in movie time units
@@ -1464,8 +1599,8 @@ addAtom(elst);
   double trackDurationOfEdit = 0.0;
   unsigned chunkDuration = 0;
 
-  ChunkDescriptor* chunk = fCurrentIOState->fHeadChunk;
-  while (chunk != NULL) {
+  for (unsigned i = 0; i < fCurrentIOState->fNumChunks; ++i) {
+    ChunkDescriptor const* chunk = &fCurrentIOState->fChunks[i];
     struct timeval const& chunkStartTime = chunk->fPresentationTime;
     double movieDurationOfEdit
       = (chunkStartTime.tv_sec - editStartTime.tv_sec)
@@ -1497,8 +1632,6 @@ addAtom(elst);
     unsigned numChannels = fCurrentIOState->fOurSubsession.numChannels();
     chunkDuration = chunk->fNumFrames*chunk->fFrameDuration/numChannels;
     currentTrackPosition += chunkDuration;
-
-    chunk = chunk->fNextChunk;
   }
 
   // Write out the final edit
@@ -1605,7 +1738,7 @@ addAtom(gmin);
 addAtomEnd;
 
 unsigned QuickTimeFileSink::addAtom_hdlr2() {
-  int64_t initFilePosn = TellFile64(fOutFid);
+  int64_t initFilePosn = fOutput->position();
   unsigned size = addAtomHeader("hdlr");
   size += addWord(0x00000000); // Version + Flags
   size += add4ByteString("dhlr"); // Component type
@@ -1631,13 +1764,21 @@ addAtomEnd;
 
 addAtom(stbl);
   size += addAtom_stsd();
-  size += addAtom_stts();
-  if (fCurrentIOState->fQTcomponentSubtype == fourChar('v','i','d','e')) {
-    size += addAtom_stss(); // only for video streams
+  if (fFragmentDuration > 0) {
+    // A fragmented file's "moov" describes no samples, so its tables are empty:
+    size += addAtom_emptyTable("stts", 1);
+    size += addAtom_emptyTable("stsc", 1);
+    size += addAtom_emptyTable("stsz", 2);
+    size += addAtom_emptyTable("co64", 1);
+  } else {
+    size += addAtom_stts();
+    if (fCurrentIOState->fQTcomponentSubtype == fourChar('v','i','d','e')) {
+      size += addAtom_stss(); // only for video streams
+    }
+    size += addAtom_stsc();
+    size += addAtom_stsz();
+    size += addAtom_co64();
   }
-  size += addAtom_stsc();
-  size += addAtom_stsz();
-  size += addAtom_co64();
 addAtomEnd;
 
 addAtom(stsd);
@@ -1649,7 +1790,7 @@ addAtom(stsd);
 addAtomEnd;
 
 unsigned QuickTimeFileSink::addAtom_genericMedia() {
-  int64_t initFilePosn = TellFile64(fOutFid);
+  int64_t initFilePosn = fOutput->position();
 
   // Our source is assumed to be a "QuickTimeGenericRTPSource"
   // Use its "sdAtom" state for our contents:
@@ -1662,7 +1803,7 @@ unsigned QuickTimeFileSink::addAtom_genericMedia() {
 addAtomEnd;
 
 unsigned QuickTimeFileSink::addAtom_soundMediaGeneral() {
-  int64_t initFilePosn = TellFile64(fOutFid);
+  int64_t initFilePosn = fOutput->position();
   unsigned size = addAtomHeader(fCurrentIOState->fQTAudioDataType);
 
 // General sample description fields:
@@ -1686,7 +1827,7 @@ addAtomEnd;
 unsigned QuickTimeFileSink::addAtom_Qclp() {
   // The beginning of this atom looks just like a general Sound Media atom,
   // except with a version field of 1:
-  int64_t initFilePosn = TellFile64(fOutFid);
+  int64_t initFilePosn = fOutput->position();
   fCurrentIOState->fQTAudioDataType = "Qclp";
   fCurrentIOState->fQTSoundSampleVersion = 1;
   unsigned size = addAtom_soundMediaGeneral();
@@ -1742,7 +1883,7 @@ unsigned QuickTimeFileSink::addAtom_mp4a() {
   unsigned size = 0;
   // The beginning of this atom looks just like a general Sound Media atom,
   // except with a version field of 1:
-  int64_t initFilePosn = TellFile64(fOutFid);
+  int64_t initFilePosn = fOutput->position();
   fCurrentIOState->fQTAudioDataType = "mp4a";
 
   if (fGenerateMP4Format) {
@@ -1930,7 +2071,7 @@ addAtom(mp4v);
 addAtomEnd;
 
 unsigned QuickTimeFileSink::addAtom_rtp() {
-  int64_t initFilePosn = TellFile64(fOutFid);
+  int64_t initFilePosn = fOutput->position();
   unsigned size = addAtomHeader("rtp ");
 
   size += addWord(0x00000000); // Reserved (1st 4 bytes)
@@ -1950,7 +2091,7 @@ addAtom(stts); // Time-to-Sample
 
   // First, add a dummy "Number of entries" field
   // (and remember its position).  We'll fill this field in later:
-  int64_t numEntriesPosition = TellFile64(fOutFid);
+  int64_t numEntriesPosition = fOutput->position();
   size += addWord(0); // dummy for "Number of entries"
 
   // Then, run through the chunk descriptors, and enter the entries
@@ -1958,13 +2099,13 @@ addAtom(stts); // Time-to-Sample
   unsigned numEntries = 0, numSamplesSoFar = 0;
   unsigned prevSampleDuration = 0;
   unsigned const samplesPerFrame = fCurrentIOState->fQTSamplesPerFrame;
-  ChunkDescriptor* chunk = fCurrentIOState->fHeadChunk;
-  while (chunk != NULL) {
+  for (unsigned c = 0; c < fCurrentIOState->fNumChunks; ++c) {
+    ChunkDescriptor const* chunk = &fCurrentIOState->fChunks[c];
     unsigned const sampleDuration = chunk->fFrameDuration/samplesPerFrame;
     if (sampleDuration != prevSampleDuration) {
       // This chunk will start a new table entry,
       // so write out the old one (if any):
-      if (chunk != fCurrentIOState->fHeadChunk) {
+      if (c > 0) {
 	++numEntries;
 	size += addWord(numSamplesSoFar); // Sample count
 	size += addWord(prevSampleDuration); // Sample duration
@@ -1975,7 +2116,6 @@ addAtom(stts); // Time-to-Sample
     unsigned const numSamples = chunk->fNumFrames*samplesPerFrame;
     numSamplesSoFar += numSamples;
     prevSampleDuration = sampleDuration;
-    chunk = chunk->fNextChunk;
   }
 
   // Then, write out the last entry:
@@ -1992,25 +2132,22 @@ addAtom(stss); // Sync-Sample
 
   // First, add a dummy "Number of entries" field
   // (and remember its position).  We'll fill this field in later:
-  int64_t numEntriesPosition = TellFile64(fOutFid);
+  int64_t numEntriesPosition = fOutput->position();
   size += addWord(0); // dummy for "Number of entries"
 
   unsigned numEntries = 0, numSamplesSoFar = 0;
-  if (fCurrentIOState->fHeadSyncFrame != NULL) {
-    SyncFrame* currentSyncFrame = fCurrentIOState->fHeadSyncFrame;
-    while(currentSyncFrame != NULL) {
+  if (fCurrentIOState->fNumSyncFrames > 0) {
+    for (unsigned s = 0; s < fCurrentIOState->fNumSyncFrames; ++s) {
       ++numEntries;
-      size += addWord(currentSyncFrame->sfFrameNum);
-      currentSyncFrame = currentSyncFrame->nextSyncFrame;
+      size += addWord(fCurrentIOState->fSyncFrameNums[s]);
     }
   } else {
     // Then, run through the chunk descriptors, counting up the total nuber of samples:
     unsigned const samplesPerFrame = fCurrentIOState->fQTSamplesPerFrame;
-    ChunkDescriptor* chunk = fCurrentIOState->fHeadChunk;
-    while (chunk != NULL) {
+    for (unsigned c = 0; c < fCurrentIOState->fNumChunks; ++c) {
+      ChunkDescriptor const* chunk = &fCurrentIOState->fChunks[c];
       unsigned const numSamples = chunk->fNumFrames*samplesPerFrame;
       numSamplesSoFar += numSamples;
-      chunk = chunk->fNextChunk;
     }
   
     // Then, write out the sample numbers that we deem correspond to 'sync samples':
@@ -2038,7 +2175,7 @@ addAtom(stsc); // Sample-to-Chunk
 
   // First, add a dummy "Number of entries" field
   // (and remember its position).  We'll fill this field in later:
-  int64_t numEntriesPosition = TellFile64(fOutFid);
+  int64_t numEntriesPosition = fOutput->position();
   size += addWord(0); // dummy for "Number of entries"
 
   // Then, run through the chunk descriptors, and enter the entries
@@ -2046,8 +2183,8 @@ addAtom(stsc); // Sample-to-Chunk
   unsigned numEntries = 0, chunkNumber = 0;
   unsigned prevSamplesPerChunk = ~0;
   unsigned const samplesPerFrame = fCurrentIOState->fQTSamplesPerFrame;
-  ChunkDescriptor* chunk = fCurrentIOState->fHeadChunk;
-  while (chunk != NULL) {
+  for (unsigned c = 0; c < fCurrentIOState->fNumChunks; ++c) {
+    ChunkDescriptor const* chunk = &fCurrentIOState->fChunks[c];
     ++chunkNumber;
     unsigned const samplesPerChunk = chunk->fNumFrames*samplesPerFrame;
     if (samplesPerChunk != prevSamplesPerChunk) {
@@ -2059,7 +2196,6 @@ addAtom(stsc); // Sample-to-Chunk
 
       prevSamplesPerChunk = samplesPerChunk;
     }
-    chunk = chunk->fNextChunk;
   }
 
   // Now go back and fill in the "Number of entries" field:
@@ -2074,8 +2210,8 @@ addAtom(stsz); // Sample Size
   // has just a single entry, or multiple entries.
   Boolean haveSingleEntryTable = True;
   double firstBPS = 0.0;
-  ChunkDescriptor* chunk = fCurrentIOState->fHeadChunk;
-  while (chunk != NULL) {
+  for (unsigned c = 0; c < fCurrentIOState->fNumChunks; ++c) {
+    ChunkDescriptor const* chunk = &fCurrentIOState->fChunks[c];
     double bps
       = (double)(chunk->fFrameSize)/(fCurrentIOState->fQTSamplesPerFrame);
     if (bps < 1.0) {
@@ -2090,15 +2226,13 @@ addAtom(stsz); // Sample Size
       haveSingleEntryTable = False;
       break;
     }
-
-    chunk = chunk->fNextChunk;
   }
 
   unsigned sampleSize;
   if (haveSingleEntryTable) {
     if (fCurrentIOState->isHintTrack()
-	&& fCurrentIOState->fHeadChunk != NULL) {
-      sampleSize = fCurrentIOState->fHeadChunk->fFrameSize
+	&& fCurrentIOState->fNumChunks > 0) {
+      sampleSize = fCurrentIOState->fChunks[0].fFrameSize
 	              / fCurrentIOState->fQTSamplesPerFrame;
     } else {
       // The following doesn't seem right, but seems to do the right thing:
@@ -2114,8 +2248,8 @@ addAtom(stsz); // Sample Size
   if (!haveSingleEntryTable) {
     // Multiple-entry table:
     // Run through the chunk descriptors, entering the sample sizes:
-    ChunkDescriptor* chunk = fCurrentIOState->fHeadChunk;
-    while (chunk != NULL) {
+    for (unsigned c = 0; c < fCurrentIOState->fNumChunks; ++c) {
+      ChunkDescriptor const* chunk = &fCurrentIOState->fChunks[c];
       unsigned numSamples
 	= chunk->fNumFrames*(fCurrentIOState->fQTSamplesPerFrame);
       unsigned sampleSize
@@ -2123,8 +2257,6 @@ addAtom(stsz); // Sample Size
       for (unsigned i = 0; i < numSamples; ++i) {
 	size += addWord(sampleSize);
       }
-
-      chunk = chunk->fNextChunk;
     }
   }
 addAtomEnd;
@@ -2134,14 +2266,19 @@ addAtom(co64); // Chunk Offset
   size += addWord(fCurrentIOState->fNumChunks); // Number of entries
 
   // Run through the chunk descriptors, entering the file offsets:
-  ChunkDescriptor* chunk = fCurrentIOState->fHeadChunk;
-  while (chunk != NULL) {
+  for (unsigned c = 0; c < fCurrentIOState->fNumChunks; ++c) {
+    ChunkDescriptor const* chunk = &fCurrentIOState->fChunks[c];
     size += addWord64(chunk->fOffsetInFile);
-
-    chunk = chunk->fNextChunk;
   }
 addAtomEnd;
 
+unsigned QuickTimeFileSink::addAtom_emptyTable(char const* atomName, unsigned numZeroWords) {
+  int64_t initFilePosn = fOutput->position();
+  unsigned size = addAtomHeader(atomName);
+  size += addWord(0x00000000); // Version+flags
+  size += addZeroWords(numZeroWords); // (e.g., "Number of entries")
+addAtomEnd;
+
 addAtom(udta);
   size += addAtom_name();
   size += addAtom_hnti();
@@ -2160,7 +2297,7 @@ addAtom(hnti);
 addAtomEnd;
 
 unsigned QuickTimeFileSink::addAtom_sdp() {
-  int64_t initFilePosn = TellFile64(fOutFid);
+  int64_t initFilePosn = fOutput->position();
   unsigned size = addAtomHeader("sdp ");
 
   // Add this subsession's SDP lines:
@@ -2300,6 +2437,133 @@ addAtomEnd;
 
 // A dummy atom (with name "????"):
 unsigned QuickTimeFileSink::addAtom_dummy() {
-    int64_t initFilePosn = TellFile64(fOutFid);
+    int64_t initFilePosn = fOutput->position();
     unsigned size = addAtomHeader("????");
 addAtomEnd;
+
+// Atoms used only in fragmented MP4 files:
+
+addAtom(mvex);
+  MediaSubsessionIterator iter(fInputSession);
+  MediaSubsession* subsession;
+  while ((subsession = iter.next()) != NULL) {
+    fCurrentIOState = (SubsessionIOState*)(subsession->miscPtr);
+    if (fCurrentIOState == NULL) continue;
+
+    size += addAtom_trex();
+  }
+addAtomEnd;
+
+addAtom(trex);
+  size += addWord(0x00000000); // Version+flags
+  size += addWord(fCurrentIOState->fTrackID); // Track ID
+  size += addWord(0x00000001); // Default sample description index
+  size += addZeroWords(3); // Default sample duration, size, flags (we set these in each "tfhd")
+addAtomEnd;
+
+addAtom(moof);
+  size += addAtom_mfhd();
+
+  MediaSubsessionIterator iter(fInputSession);
+  MediaSubsession* subsession;
+  while ((subsession = iter.next()) != NULL) {
+    fCurrentIOState = (SubsessionIOState*)(subsession->miscPtr);
+    if (fCurrentIOState == NULL || fCurrentIOState->fNumChunks == 0) continue;
+
+    size += addAtom_traf();
+  }
+addAtomEnd;
+
+addAtom(mfhd);
+  size += addWord(0x00000000); // Version+flags
+  size += addWord(fFragmentSequenceNumber); // Sequence number
+addAtomEnd;
+
+addAtom(traf);
+  size += addAtom_tfhd();
+  size += addAtom_tfdt();
+  size += addAtom_trun();
+addAtomEnd;
+
+// Sample flags (in "tfhd" and "trun"):
+#define SAMPLE_IS_SYNC 0x02000000 // 'depends on no other sample'
+#define SAMPLE_IS_NOT_SYNC 0x01010000 // 'depends on others' + 'is non-sync sample'
+
+// Returns True iff all of the current track's samples (in this fragment)
+// have the same duration (and, if "checkSize" is True, also the same size):
+static Boolean haveUniformSamples(ChunkDescriptor const* chunks, unsigned numChunks,
+				  unsigned samplesPerFrame, Boolean checkSize) {
+  for (unsigned c = 1; c < numChunks; ++c) {
+    if (chunks[c].fFrameDuration/samplesPerFrame != chunks[0].fFrameDuration/samplesPerFrame) return False;
+    if (checkSize && chunks[c].fFrameSize/samplesPerFrame != chunks[0].fFrameSize/samplesPerFrame) return False;
+  }
+  return True;
+}
+
+// Returns True iff we know which of the current track's samples are sync samples:
+#define haveSyncSampleInfo(ioState) \
+  ((ioState)->fQTMediaDataAtomCreator == &QuickTimeFileSink::addAtom_avc1)
+
+addAtom(tfhd);
+  unsigned const samplesPerFrame = fCurrentIOState->fQTSamplesPerFrame;
+  ChunkDescriptor const* chunks = fCurrentIOState->fChunks;
+  Boolean const uniformSizes
+    = haveUniformSamples(chunks, fCurrentIOState->fNumChunks, samplesPerFrame, True);
+
+  // Flags: 'default-base-is-moof', 'default-sample-flags-present',
+  // 'default-sample-duration-present' (and, if uniform, 'default-sample-size-present'):
+  size += addWord(0x00020028 | (uniformSizes ? 0x10 : 0)); // Version+flags
+  size += addWord(fCurrentIOState->fTrackID); // Track ID
+  size += addWord(chunks[0].fFrameDuration/samplesPerFrame); // Default sample duration
+  if (uniformSizes) size += addWord(chunks[0].fFrameSize/samplesPerFrame); // Default sample size
+  size += addWord(haveSyncSampleInfo(fCurrentIOState) ? SAMPLE_IS_NOT_SYNC : SAMPLE_IS_SYNC);
+      // Default sample flags
+addAtomEnd;
+
+addAtom(tfdt);
+  size += addWord(0x01000000); // Version (1: 64-bit time) + flags
+  size += addWord64(fCurrentIOState->fFragmentDecodeTime); // Base media decode time
+addAtomEnd;
+
+addAtom(trun);
+  unsigned const samplesPerFrame = fCurrentIOState->fQTSamplesPerFrame;
+  ChunkDescriptor const* chunks = fCurrentIOState->fChunks;
+  unsigned const numChunks = fCurrentIOState->fNumChunks;
+  Boolean const perSampleDurations
+    = !haveUniformSamples(chunks, numChunks, samplesPerFrame, False);
+  Boolean const perSampleSizes
+    = !haveUniformSamples(chunks, numChunks, samplesPerFrame, True);
+  Boolean const perSampleFlags = haveSyncSampleInfo(fCurrentIOState);
+
+  unsigned numSamples = 0;
+  for (unsigned c = 0; c < numChunks; ++c) numSamples += chunks[c].fNumFrames*samplesPerFrame;
+
+  // Flags: 'data-offset-present', plus whichever per-sample fields we need:
+  size += addWord(0x00000001 | (perSampleDurations ? 0x100 : 0)
+		  | (perSampleSizes ? 0x200 : 0) | (perSampleFlags ? 0x400 : 0)); // Version+flags
+  size += addWord(numSamples); // Sample count
+  // Add a dummy "Data offset" field (and remember its position).  We'll fill this field in
+  // once we know where our data will be in the "mdat" atom.  (Note that our chunks' data
+  // is contiguous, so a single offset suffices.):
+  fCurrentIOState->fTRUNDataOffsetPosn = fOutput->position();
+  size += addWord(0); // dummy for "Data offset"
+
+  if (perSampleDurations || perSampleSizes || perSampleFlags) {
+    unsigned sampleNumber = fCurrentIOState->fFragmentFirstSampleNumber;
+    unsigned const* syncFrameNums = fCurrentIOState->fSyncFrameNums;
+    unsigned const* syncFrameNumsEnd = &syncFrameNums[fCurrentIOState->fNumSyncFrames];
+    for (unsigned c = 0; c < numChunks; ++c) {
+      unsigned const numChunkSamples = chunks[c].fNumFrames*samplesPerFrame;
+      for (unsigned i = 0; i < numChunkSamples; ++i, ++sampleNumber) {
+	if (perSampleDurations) size += addWord(chunks[c].fFrameDuration/samplesPerFrame); // Sample duration
+	if (perSampleSizes) size += addWord(chunks[c].fFrameSize/samplesPerFrame); // Sample size
+	if (perSampleFlags) {
+	  // (Our sync sample numbers are in increasing order.)
+	  while (syncFrameNums < syncFrameNumsEnd && *syncFrameNums < sampleNumber) ++syncFrameNums;
+	  Boolean const isSync = syncFrameNums < syncFrameNumsEnd && *syncFrameNums == sampleNumber;
+	  size += addWord(isSync ? SAMPLE_IS_SYNC : SAMPLE_IS_NOT_SYNC); // Sample flags
+	}
+      }
+    }
+  }
+addAtomEnd;
@@ -132,7 +132,10 @@ RTCPInstance::RTCPInstance(UsageEnvironment& env, Groupsock* RTCPgs,
     fByeHandlerTask(NULL), fByeHandlerClientData(NULL),
     fSRHandlerTask(NULL), fSRHandlerClientData(NULL),
     fRRHandlerTask(NULL), fRRHandlerClientData(NULL),
-    fSpecificRRHandlerTable(NULL) {
+    fSpecificRRHandlerTable(NULL),
+    fBandwidthFraction(0.05), fUseReducedSizeRTCP(False),
+    fFullReportPeriod(1), fNumReportsUntilFullReport(0),
+    fSuppressReceiverReports(False) {
 #ifdef DEBUG
   fprintf(stderr, "RTCPInstance[%p]::RTCPInstance()\n", this);
 #endif
@@ -281,6 +284,24 @@ void RTCPInstance
   }
 }
 
+void RTCPInstance::setBandwidthFraction(double fraction) {
+  if (fraction <= 0.0 || fraction > 1.0) {
+    envir() << "RTCPInstance::setBandwidthFraction(): bad fraction " << fraction << " (ignored)\n";
+    return;
+  }
+  fBandwidthFraction = fraction;
+}
+
+void RTCPInstance::setReducedSizeRTCP(Boolean useReducedSize, unsigned fullReportPeriod) {
+  fUseReducedSizeRTCP = useReducedSize;
+  fFullReportPeriod = fullReportPeriod == 0 ? 1 : fullReportPeriod;
+  if (fNumReportsUntilFullReport >= fFullReportPeriod) fNumReportsUntilFullReport = fFullReportPeriod - 1;
+}
+
+void RTCPInstance::setReceiverReportSuppression(Boolean suppress) {
+  fSuppressReceiverReports = suppress;
+}
+
 void RTCPInstance::setStreamSocket(int sockNum,
 				   unsigned char streamChannelId) {
   // Turn off background read handling:
@@ -390,10 +411,15 @@ void RTCPInstance::incomingReportHandler1() {
     // Check the RTCP packet for validity:
     // It must at least contain a header (4 bytes), and this header
     // must be version=2, with no padding bit, and a payload type of
-    // SR (200) or RR (201):
+    // SR (200) or RR (201).  (However, if we're accepting reduced-size
+    // RTCP (RFC 5506), then the first payload type may be any of SR (200)
+    // through APP (204).)
     if (packetSize < 4) break;
     unsigned rtcpHdr = ntohl(*(u_int32_t*)pkt);
-    if ((rtcpHdr & 0xE0FE0000) != (0x80000000 | (RTCP_PT_SR<<16))) {
+    unsigned firstPT = (rtcpHdr>>16)&0xFF;
+    if (fUseReducedSizeRTCP
+	? ((rtcpHdr & 0xE0000000) != 0x80000000 || firstPT < RTCP_PT_SR || firstPT > RTCP_PT_APP)
+	: (rtcpHdr & 0xE0FE0000) != (0x80000000 | (RTCP_PT_SR<<16))) {
 #ifdef DEBUG
       fprintf(stderr, "rejected bad RTCP packet: header 0x%08x\n", rtcpHdr);
 #endif
@@ -610,17 +636,30 @@ void RTCPInstance::sendReport() {
   // used for that outgoing packet. (David Bertrand, 2006.07.18)
   if (fSink != NULL && fSink->nextTimestampHasBeenPreset()) return;
 
+  if (fSuppressReceiverReports && fSink == NULL) {
+    // We're a receive-only client that has been asked not to send "RR"s.
+    // (We still age our membership database, though.)
 #ifdef DEBUG
-  fprintf(stderr, "sending REPORT\n");
+    fprintf(stderr, "suppressing REPORT\n");
 #endif
-  // Begin by including a SR and/or RR report:
-  addReport();
+  } else {
+#ifdef DEBUG
+    fprintf(stderr, "sending REPORT\n");
+#endif
+    // Begin by including a SR and/or RR report:
+    addReport();
 
-  // Then, include a SDES:
-  addSDES();
+    // Then, include a SDES - unless this can be a reduced-size (RFC 5506) report:
+    if (!fUseReducedSizeRTCP || fNumReportsUntilFullReport == 0) {
+      addSDES();
+      fNumReportsUntilFullReport = fFullReportPeriod - 1;
+    } else {
+      --fNumReportsUntilFullReport;
+    }
 
-  // Send the report:
-  sendBuiltPacket();
+    // Send the report:
+    sendBuiltPacket();
+  }
 
   // Periodically clean out old members from our SSRC membership database:
   const unsigned membershipReapPeriod = 5;
@@ -680,6 +719,7 @@ void RTCPInstance::removeSSRC(u_int32_t ssrc, Boolean alsoRemoveStats) {
 }
 
 void RTCPInstance::onExpire(RTCPInstance* instance) {
+  instance->nextTask() = NULL; // because our report timer has now fired
   instance->onExpire1();
 }
 
@@ -888,14 +928,23 @@ void RTCPInstance::schedule(double nextTime) {
 				(TaskFunc*)RTCPInstance::onExpire, this);
 }
 
+// Don't bother rescheduling our report timer if it would move by less than this:
+#define RTCP_RESCHEDULE_TOLERANCE 0.01 /* seconds */
+
 void RTCPInstance::reschedule(double nextTime) {
+  double change = nextTime - fNextReportTime;
+  if (nextTask() != NULL
+      && change < RTCP_RESCHEDULE_TOLERANCE && change > -RTCP_RESCHEDULE_TOLERANCE) {
+    return;
+  }
+
   envir().taskScheduler().unscheduleDelayedTask(nextTask());
   schedule(nextTime);
 }
 
 void RTCPInstance::onExpire1() {
   // Note: fTotSessionBW is kbits per second
-  double rtcpBW = 0.05*fTotSessionBW*1024/8; // -> bytes per second
+  double rtcpBW = fBandwidthFraction*fTotSessionBW*1024/8; // -> bytes per second
 
   OnExpire(this, // event
 	   numMembers(), // members
@@ -0,0 +1,340 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A cache of 'hint tracks' (pre-packetized RTP streams) of file-based
+// server media subsessions.
+// Implementation
+
+#include "RTPHintCache.hh"
+#include "InputFile.hh"
+#include <GroupsockHelper.hh>
+#include <strDup.hh>
+#include <string.h>
+#include <sys/stat.h>
+
+// Each hint track file begins with a header:
+//     "L555HINT" (8 bytes), version (1 byte), RTP payload type (1 byte), key length (2 bytes),
+//     RTP timestamp frequency (4 bytes), estimated bitrate in kbps (4 bytes),
+//     number of packets (4 bytes), largest packet size (4 bytes),
+//     modification time (8 bytes) and size (8 bytes) of the original file,
+//     the key ("<trackId> <fileName>"), to guard against file name collisions.
+// Then, each packet is stored as:
+//     due time, in microseconds since the start of the track (8 bytes),
+//     packet size (2 bytes), flags (1 byte), reserved (1 byte), the complete RTP packet.
+// All numbers are in network (big-endian) byte order.
+#define HINT_FILE_MAGIC "L555HINT"
+#define HINT_FILE_VERSION 1
+#define HINT_FILE_HEADER_SIZE 44
+#define HINT_FILE_NUM_PACKETS_OFFSET 20
+#define HINT_RECORD_HEADER_SIZE 12
+#define HINT_FLAG_RANDOM_ACCESS_POINT 0x01
+
+static void putWord(unsigned char* p, u_int64_t value, unsigned numBytes) {
+  while (numBytes-- > 0) {
+    p[numBytes] = (unsigned char)value;
+    value >>= 8;
+  }
+}
+
+static u_int64_t getWord(unsigned char const* p, unsigned numBytes) {
+  u_int64_t value = 0;
+  for (unsigned i = 0; i < numBytes; ++i) value = (value<<8) | p[i];
+  return value;
+}
+
+////////// RTPHintCache //////////
+
+RTPHintCache::RTPHintCache(char const* cacheDirName, u_int64_t maxTrackSize)
+  : fCacheDirName(strDup(cacheDirName)), fMaxTrackSize(maxTrackSize), fNumRecorders(0),
+    fNumHits(0), fNumMisses(0), fNumTracksRecorded(0) {
+}
+
+RTPHintCache::~RTPHintCache() {
+  delete[] fCacheDirName;
+}
+
+RTPHintTrackSource* RTPHintCache
+::lookup(UsageEnvironment& env, char const* fileName, char const* trackId) {
+  char* key = makeKey(fileName, trackId);
+  char* hintFile = hintFileName(key);
+  unsigned const keyLength = strlen(key);
+
+  RTPHintTrackSource* result = NULL;
+  FILE* fid = fopen(hintFile, "rb");
+  if (fid != NULL) {
+    unsigned char header[HINT_FILE_HEADER_SIZE];
+    unsigned char* storedKey = new unsigned char[keyLength];
+    long modificationTime; u_int64_t fileSize;
+    if (fread(header, 1, sizeof header, fid) == sizeof header
+	&& memcmp(header, HINT_FILE_MAGIC, 8) == 0 && header[8] == HINT_FILE_VERSION
+	&& getWord(&header[10], 2) == keyLength
+	&& fread(storedKey, 1, keyLength, fid) == keyLength
+	&& memcmp(storedKey, key, keyLength) == 0) {
+      if (getFileStamp(fileName, modificationTime, fileSize)
+	  && (long)getWord(&header[28], 8) == modificationTime && getWord(&header[36], 8) == fileSize) {
+	result = new RTPHintTrackSource(env, fid, header[9],
+					(unsigned)getWord(&header[12], 4),
+					(unsigned)getWord(&header[16], 4),
+					(unsigned)getWord(&header[24], 4));
+	fid = NULL; // it's now owned by "result"
+      } else {
+	// The file has changed (or gone away) since this track was recorded:
+	fclose(fid); fid = NULL;
+	remove(hintFile);
+      }
+    }
+    delete[] storedKey;
+    if (fid != NULL) fclose(fid);
+  }
+  delete[] hintFile; delete[] key;
+
+  if (result == NULL) {
+    ++fNumMisses;
+  } else {
+    ++fNumHits;
+  }
+  return result;
+}
+
+RTPHintTrackRecorder* RTPHintCache
+::newRecorder(char const* fileName, char const* trackId,
+	      unsigned char rtpPayloadType, unsigned rtpTimestampFrequency, unsigned estBitrate) {
+  long modificationTime; u_int64_t fileSize;
+  if (!getFileStamp(fileName, modificationTime, fileSize)) return NULL;
+
+  char* key = makeKey(fileName, trackId);
+  unsigned const keyLength = strlen(key);
+  if (keyLength > 0xFFFF) {
+    delete[] key;
+    return NULL;
+  }
+  char* hintFile = hintFileName(key);
+
+  // Record into a temporary file, so that the track becomes visible (to "lookup()") only
+  // once it's complete.  (Several streams of the same track may be recorded at once.)
+  char* tempFileName = new char[strlen(hintFile) + 30];
+  sprintf(tempFileName, "%s.%u-%08x.tmp", hintFile, ++fNumRecorders, our_random32());
+  FILE* fid = fopen(tempFileName, "wb");
+
+  unsigned char header[HINT_FILE_HEADER_SIZE];
+  memmove(header, HINT_FILE_MAGIC, 8);
+  header[8] = HINT_FILE_VERSION;
+  header[9] = rtpPayloadType;
+  putWord(&header[10], keyLength, 2);
+  putWord(&header[12], rtpTimestampFrequency, 4);
+  putWord(&header[16], estBitrate, 4);
+  putWord(&header[HINT_FILE_NUM_PACKETS_OFFSET], 0, 8); // filled in by "finish()"
+  putWord(&header[28], (u_int64_t)modificationTime, 8);
+  putWord(&header[36], fileSize, 8);
+  if (fid != NULL
+      && (fwrite(header, 1, sizeof header, fid) != sizeof header
+	  || fwrite(key, 1, keyLength, fid) != keyLength)) {
+    fclose(fid); fid = NULL;
+    remove(tempFileName);
+  }
+  delete[] key;
+
+  if (fid == NULL) {
+    delete[] tempFileName; delete[] hintFile;
+    return NULL;
+  }
+  return new RTPHintTrackRecorder(*this, fid, tempFileName, hintFile);
+}
+
+Boolean RTPHintCache
+::getFileStamp(char const* fileName, long& modificationTime, u_int64_t& fileSize) {
+  struct stat sb;
+  if (stat(fileName, &sb) != 0) return False;
+
+  modificationTime = (long)sb.st_mtime;
+  fileSize = (u_int64_t)sb.st_size;
+  return True;
+}
+
+char* RTPHintCache::makeKey(char const* fileName, char const* trackId) {
+  char* key = new char[strlen(trackId) + 1 + strlen(fileName) + 1];
+  sprintf(key, "%s %s", trackId, fileName);
+  return key;
+}
+
+char* RTPHintCache::hintFileName(char const* key) const {
+  // Name the file after a (64-bit FNV-1a) hash of the key.  (Because the key is also
+  // stored in the file, a collision just means that one of the tracks isn't cached.)
+  u_int64_t hash = ((u_int64_t)0xCBF29CE4 << 32) | 0x84222325;
+  for (char const* p = key; *p != '\0'; ++p) {
+    hash ^= (unsigned char)*p;
+    hash *= ((u_int64_t)0x00000100 << 32) | 0x000001B3;
+  }
+
+  char* result = new char[strlen(fCacheDirName) + 1 + 16 + 5 + 1];
+  sprintf(result, "%s/%08x%08x.hint", fCacheDirName,
+	  (unsigned)(hash>>32), (unsigned)(hash&0xFFFFFFFF));
+  return result;
+}
+
+
+////////// RTPHintTrackRecorder //////////
+
+RTPHintTrackRecorder::RTPHintTrackRecorder(RTPHintCache& cache, FILE* fid,
+					   char* tempFileName, char* hintFileName)
+  : fCache(cache), fFid(fid), fTempFileName(tempFileName), fHintFileName(hintFileName),
+    fNumBytes(0), fNumPackets(0), fMaxPacketSize(0), fHaveFailed(False) {
+}
+
+RTPHintTrackRecorder::~RTPHintTrackRecorder() {
+  if (fFid != NULL) {
+    // We weren't finished, so discard the recording:
+    fclose(fFid);
+    remove(fTempFileName);
+  }
+  delete[] fTempFileName; delete[] fHintFileName;
+}
+
+void RTPHintTrackRecorder::addPacket(unsigned char const* packet, unsigned packetSize,
+				     u_int64_t dueUSecs, Boolean isRandomAccessPoint) {
+  addPacket(packet, packetSize, NULL, 0, dueUSecs, isRandomAccessPoint);
+}
+
+void RTPHintTrackRecorder::addPacket(unsigned char const* header, unsigned headerSize,
+				     unsigned char const* payload, unsigned payloadSize,
+				     u_int64_t dueUSecs, Boolean isRandomAccessPoint) {
+  if (fHaveFailed) return;
+
+  unsigned const packetSize = headerSize + payloadSize;
+  fNumBytes += HINT_RECORD_HEADER_SIZE + packetSize;
+  if (packetSize > 0xFFFF
+      || (fCache.fMaxTrackSize > 0 && fNumBytes > fCache.fMaxTrackSize)) {
+    fHaveFailed = True;
+    return;
+  }
+
+  unsigned char recordHeader[HINT_RECORD_HEADER_SIZE];
+  putWord(&recordHeader[0], dueUSecs, 8);
+  putWord(&recordHeader[8], packetSize, 2);
+  recordHeader[10] = isRandomAccessPoint ? HINT_FLAG_RANDOM_ACCESS_POINT : 0;
+  recordHeader[11] = 0;
+  if (fwrite(recordHeader, 1, sizeof recordHeader, fFid) != sizeof recordHeader
+      || fwrite(header, 1, headerSize, fFid) != headerSize
+      || (payloadSize > 0 && fwrite(payload, 1, payloadSize, fFid) != payloadSize)) {
+    fHaveFailed = True;
+    return;
+  }
+
+  ++fNumPackets;
+  if (packetSize > fMaxPacketSize) fMaxPacketSize = packetSize;
+}
+
+Boolean RTPHintTrackRecorder::finish() {
+  if (fFid == NULL) return False;
+
+  Boolean success = !fHaveFailed && fNumPackets > 0;
+  if (success) {
+    unsigned char counts[8];
+    putWord(&counts[0], fNumPackets, 4);
+    putWord(&counts[4], fMaxPacketSize, 4);
+    success = SeekFile64(fFid, HINT_FILE_NUM_PACKETS_OFFSET, SEEK_SET) >= 0
+      && fwrite(counts, 1, sizeof counts, fFid) == sizeof counts;
+  }
+  if (fclose(fFid) != 0) success = False;
+  fFid = NULL;
+
+  if (success && rename(fTempFileName, fHintFileName) != 0) {
+    // (Some platforms won't rename over an existing file.)
+    remove(fHintFileName);
+    success = rename(fTempFileName, fHintFileName) == 0;
+  }
+  if (!success) {
+    remove(fTempFileName);
+    return False;
+  }
+
+  ++fCache.fNumTracksRecorded;
+  return True;
+}
+
+
+////////// RTPHintTrackSource //////////
+
+RTPHintTrackSource::RTPHintTrackSource(UsageEnvironment& env, FILE* fid,
+				       unsigned char rtpPayloadType,
+				       unsigned rtpTimestampFrequency,
+				       unsigned estBitrate, unsigned maxPacketSize)
+  : FramedSource(env), fFid(fid),
+    fRTPPayloadType(rtpPayloadType), fRTPTimestampFrequency(rtpTimestampFrequency),
+    fEstBitrate(estBitrate), fMaxPacketSize(maxPacketSize),
+    fEndUSecs(0), fLastPacketWasRandomAccessPoint(False) {
+  fFirstPacketOffset = TellFile64(fFid);
+}
+
+RTPHintTrackSource::~RTPHintTrackSource() {
+  fclose(fFid);
+}
+
+void RTPHintTrackSource::seekToTime(double seekNPT, double streamDuration) {
+  fEndUSecs = streamDuration > 0.0 ? (u_int64_t)((seekNPT + streamDuration)*1000000) : 0;
+  SeekFile64(fFid, fFirstPacketOffset, SEEK_SET);
+  if (seekNPT <= 0.0) return;
+
+  u_int64_t const seekUSecs = (u_int64_t)(seekNPT*1000000);
+  unsigned char recordHeader[HINT_RECORD_HEADER_SIZE];
+  while (fread(recordHeader, 1, sizeof recordHeader, fFid) == sizeof recordHeader) {
+    if (getWord(&recordHeader[0], 8) >= seekUSecs
+	&& (recordHeader[10]&HINT_FLAG_RANDOM_ACCESS_POINT) != 0) {
+      // Deliver this packet next:
+      SeekFile64(fFid, -HINT_RECORD_HEADER_SIZE, SEEK_CUR);
+      return;
+    }
+    SeekFile64(fFid, getWord(&recordHeader[8], 2), SEEK_CUR);
+  }
+  // We seeked past the last random access point; there's nothing left to deliver.
+}
+
+void RTPHintTrackSource::doGetNextFrame() {
+  unsigned char recordHeader[HINT_RECORD_HEADER_SIZE];
+  if (fread(recordHeader, 1, sizeof recordHeader, fFid) != sizeof recordHeader) {
+    handleClosure(this);
+    return;
+  }
+  u_int64_t const dueUSecs = getWord(&recordHeader[0], 8);
+  unsigned const packetSize = (unsigned)getWord(&recordHeader[8], 2);
+  if (fEndUSecs > 0 && dueUSecs > fEndUSecs) {
+    SeekFile64(fFid, -HINT_RECORD_HEADER_SIZE, SEEK_CUR); // in case we're seeked again
+    handleClosure(this);
+    return;
+  }
+
+  if (packetSize > fMaxSize) {
+    fFrameSize = fMaxSize;
+    fNumTruncatedBytes = packetSize - fMaxSize;
+  } else {
+    fFrameSize = packetSize;
+    fNumTruncatedBytes = 0;
+  }
+  if (fread(fTo, 1, fFrameSize, fFid) != fFrameSize) {
+    handleClosure(this);
+    return;
+  }
+  if (fNumTruncatedBytes > 0) SeekFile64(fFid, fNumTruncatedBytes, SEEK_CUR);
+
+  fLastPacketWasRandomAccessPoint = (recordHeader[10]&HINT_FLAG_RANDOM_ACCESS_POINT) != 0;
+  fPresentationTime.tv_sec = (long)(dueUSecs/1000000);
+  fPresentationTime.tv_usec = (long)(dueUSecs%1000000);
+  fDurationInMicroseconds = 0;
+
+  // Because we read synchronously, we can call our "afterGetting()" function directly:
+  afterGetting(this);
+}
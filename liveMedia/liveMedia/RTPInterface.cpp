@@ -23,19 +23,21 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "RTPInterface.hh"
 #include <GroupsockHelper.hh>
 #include <stdio.h>
+#if !defined(__WIN32__) && !defined(_WIN32)
+#include <sys/uio.h>
+#endif
 
 ////////// Helper Functions - Definition //////////
 
 // Helper routines and data structures, used to implement
 // sending/receiving RTP/RTCP over a TCP socket:
 
-static void sendRTPOverTCP(unsigned char* packet, unsigned packetSize,
-			   int socketNum, unsigned char streamChannelId);
-
 // Reading RTP-over-TCP is implemented using two levels of hash tables.
 // The top-level hash table maps TCP socket numbers to a
 // "SocketDescriptor" that contains a hash table for each of the
 // sub-channels that are reading from this socket.
+// Each "SocketDescriptor" also queues the RTP/RTCP-over-TCP output to its socket
+// that couldn't be written immediately (because the socket would block).
 
 static HashTable* socketHashTable(UsageEnvironment& env, Boolean createIfNotPresent = True) {
   _Tables* ourTables = _Tables::getOurTables(env, createIfNotPresent);
@@ -63,10 +65,29 @@ public:
     fServerRequestAlternativeByteHandlerClientData = clientData;
   }
 
+  void registerOutputUser() { ++fNumOutputUsers; }
+  void deregisterOutputUser(); // Note: This may delete "this"
+
+  void sendRTPOverTCP(unsigned char streamChannelId,
+		      unsigned char const* header, unsigned headerSize,
+		      unsigned char const* payload, unsigned payloadSize,
+		      Boolean moreToCome);
+      // If "moreToCome" is True, the packet is queued - to be written (along with the
+      // packets that follow it) when "moreToCome" is next False.
+  void sendData(unsigned char const* data, unsigned dataSize); // not RTP/RTCP
+  unsigned numQueuedOutputBytes() const { return fOutputQueueTail - fOutputQueueHead; }
+  unsigned numPacketsDropped() const { return fNumPacketsDropped; }
+
 private:
   static void tcpReadHandler(SocketDescriptor*, int mask);
   void tcpReadHandler1(int mask);
 
+  void deleteIfUnused();
+  void sendOrQueue(struct iovec const* parts, unsigned numParts, Boolean moreToCome);
+  void queueOutput(unsigned char const* data, unsigned dataSize);
+  void flushOutputQueue();
+  static void retryOutput(void* clientData);
+
 private:
   UsageEnvironment& fEnv;
   int fOurSocketNum;
@@ -75,6 +96,14 @@ private:
   void* fServerRequestAlternativeByteHandlerClientData;
   u_int8_t fStreamChannelId, fSizeByte1;
   enum { AWAITING_DOLLAR, AWAITING_STREAM_CHANNEL_ID, AWAITING_SIZE1, AWAITING_SIZE2, AWAITING_PACKET_DATA } fTCPReadingState;
+
+  // Output that's waiting to be written to our socket:
+  unsigned fNumOutputUsers; // the "RTPInterface"s that send on our socket
+  unsigned char* fOutputQueue;
+  unsigned fOutputQueueSize, fOutputQueueHead, fOutputQueueTail;
+  TaskToken fOutputRetryTask;
+  Boolean fOutputFailed;
+  unsigned fNumPacketsDropped;
 };
 
 static SocketDescriptor* lookupSocketDescriptor(UsageEnvironment& env, int sockNum, Boolean createIfNotFound = True) {
@@ -113,7 +142,8 @@ RTPInterface::RTPInterface(Medium* owner, Groupsock* gs)
     fTCPStreams(NULL),
     fNextTCPReadSize(0), fNextTCPReadStreamSocketNum(-1),
     fNextTCPReadStreamChannelId(0xFF), fReadHandlerProc(NULL),
-    fAuxReadHandlerFunc(NULL), fAuxReadHandlerClientData(NULL) {
+    fAuxReadHandlerFunc(NULL), fAuxReadHandlerClientData(NULL),
+    fNumUDPSendErrors(0) {
   // Make the socket non-blocking, even though it will be read from only asynchronously, when packets arrive.
   // The reason for this is that, in some OSs, reads on a blocking socket can (allegedly) sometimes block,
   // even if the socket was previously reported (e.g., by "select()") as having data available.
@@ -123,6 +153,10 @@ RTPInterface::RTPInterface(Medium* owner, Groupsock* gs)
 }
 
 RTPInterface::~RTPInterface() {
+  for (tcpStreamRecord* streams = fTCPStreams; streams != NULL;
+       streams = streams->fNext) {
+    streams->fSocketDescriptor->deregisterOutputUser();
+  }
   delete fTCPStreams;
 }
 
@@ -145,6 +179,10 @@ void RTPInterface::addStreamSocket(int sockNum,
   }
 
   fTCPStreams = new tcpStreamRecord(sockNum, streamChannelId, fTCPStreams);
+
+  // Our output to this socket gets queued by its "SocketDescriptor":
+  fTCPStreams->fSocketDescriptor = lookupSocketDescriptor(envir(), sockNum);
+  fTCPStreams->fSocketDescriptor->registerOutputUser();
 }
 
 static void deregisterSocket(UsageEnvironment& env, int sockNum, unsigned char streamChannelId) {
@@ -163,6 +201,7 @@ void RTPInterface::removeStreamSocket(int sockNum,
     if ((*streamsPtr)->fStreamSocketNum == sockNum
 	&& (*streamsPtr)->fStreamChannelId == streamChannelId) {
       deregisterSocket(envir(), sockNum, streamChannelId);
+      (*streamsPtr)->fSocketDescriptor->deregisterOutputUser();
 
       // Then remove the record pointed to by *streamsPtr :
       tcpStreamRecord* next = (*streamsPtr)->fNext;
@@ -184,13 +223,112 @@ void RTPInterface
 
 void RTPInterface::sendPacket(unsigned char* packet, unsigned packetSize) {
   // Normal case: Send as a UDP packet:
-  fGS->output(envir(), fGS->ttl(), packet, packetSize);
+  if (!fGS->output(envir(), fGS->ttl(), packet, packetSize)) ++fNumUDPSendErrors;
+
+  // Also, send over each of our TCP sockets:
+  for (tcpStreamRecord* streams = fTCPStreams; streams != NULL;
+       streams = streams->fNext) {
+    streams->fSocketDescriptor->sendRTPOverTCP(streams->fStreamChannelId,
+					       packet, packetSize, NULL, 0, False);
+  }
+}
+
+void RTPInterface::sendPacketv(unsigned char const* header, unsigned headerSize,
+			       unsigned char const* payload, unsigned payloadSize) {
+  // Normal case: Send as a UDP packet, gathered from both parts:
+  struct iovec iov[2];
+  iov[0].iov_base = (void*)header; iov[0].iov_len = headerSize;
+  iov[1].iov_base = (void*)payload; iov[1].iov_len = payloadSize;
+  if (!fGS->outputv(envir(), fGS->ttl(), iov, 2)) ++fNumUDPSendErrors;
 
   // Also, send over each of our TCP sockets:
   for (tcpStreamRecord* streams = fTCPStreams; streams != NULL;
        streams = streams->fNext) {
-    sendRTPOverTCP(packet, packetSize,
-		   streams->fStreamSocketNum, streams->fStreamChannelId);
+    streams->fSocketDescriptor->sendRTPOverTCP(streams->fStreamChannelId,
+					       header, headerSize, payload, payloadSize, False);
+  }
+}
+
+void RTPInterface::sendPackets(unsigned char* const* packets, unsigned const* packetSizes,
+			       unsigned numPackets) {
+  // Normal case: Send as UDP packets:
+  if (!fGS->outputBatch(envir(), fGS->ttl(), packets, packetSizes, numPackets)) ++fNumUDPSendErrors;
+
+  // Also, send over each of our TCP sockets:
+  for (tcpStreamRecord* streams = fTCPStreams; streams != NULL;
+       streams = streams->fNext) {
+    for (unsigned i = 0; i < numPackets; ++i) {
+      streams->fSocketDescriptor->sendRTPOverTCP(streams->fStreamChannelId,
+						 packets[i], packetSizes[i], NULL, 0,
+						 i+1 < numPackets);
+    }
+  }
+}
+
+void RTPInterface
+::sendPacketsToStreamSocket(int sockNum, unsigned char streamChannelId,
+			    unsigned char* const* packets, unsigned const* packetSizes,
+			    unsigned numPackets) {
+  for (tcpStreamRecord* streams = fTCPStreams; streams != NULL;
+       streams = streams->fNext) {
+    if (streams->fStreamSocketNum != sockNum
+	|| streams->fStreamChannelId != streamChannelId) continue;
+
+    for (unsigned i = 0; i < numPackets; ++i) {
+      streams->fSocketDescriptor->sendRTPOverTCP(streamChannelId,
+						 packets[i], packetSizes[i], NULL, 0,
+						 i+1 < numPackets);
+    }
+    break;
+  }
+}
+
+// If a TCP stream has more than this much output queued, then we ask our caller to wait
+// (rather than send more); beyond the larger limit, we drop (whole) packets instead:
+#define TCP_OUTPUT_BACKLOG_THRESHOLD (256*1024)
+#define MAX_TCP_OUTPUT_QUEUE_SIZE (4*1024*1024)
+
+unsigned RTPInterface::numBytesQueuedForTCPOutput() const {
+  unsigned result = 0;
+  for (tcpStreamRecord* streams = fTCPStreams; streams != NULL;
+       streams = streams->fNext) {
+    result += streams->fSocketDescriptor->numQueuedOutputBytes();
+  }
+  return result;
+}
+
+unsigned RTPInterface::numTCPPacketsDropped() const {
+  unsigned result = 0;
+  for (tcpStreamRecord* streams = fTCPStreams; streams != NULL;
+       streams = streams->fNext) {
+    result += streams->fSocketDescriptor->numPacketsDropped();
+  }
+  return result;
+}
+
+Boolean RTPInterface::tcpOutputIsBacklogged() const {
+  for (tcpStreamRecord* streams = fTCPStreams; streams != NULL;
+       streams = streams->fNext) {
+    if (streams->fSocketDescriptor->numQueuedOutputBytes() > TCP_OUTPUT_BACKLOG_THRESHOLD) {
+      return True;
+    }
+  }
+  return False;
+}
+
+unsigned RTPInterface::tcpOutputQueueSize(UsageEnvironment& env, int socketNum) {
+  SocketDescriptor* socketDescriptor = lookupSocketDescriptor(env, socketNum, False);
+  return socketDescriptor == NULL ? 0 : socketDescriptor->numQueuedOutputBytes();
+}
+
+void RTPInterface::sendDataOverTCP(UsageEnvironment& env, int socketNum,
+				   unsigned char const* data, unsigned dataSize) {
+  SocketDescriptor* socketDescriptor = lookupSocketDescriptor(env, socketNum, False);
+  if (socketDescriptor == NULL) {
+    // This socket isn't carrying RTP/RTCP, so just send the data directly:
+    send(socketNum, (char const*)data, dataSize, 0);
+  } else {
+    socketDescriptor->sendData(data, dataSize);
   }
 }
 
@@ -253,6 +391,24 @@ Boolean RTPInterface::handleRead(unsigned char* buffer, unsigned bufferMaxSize,
   return readSuccess;
 }
 
+int RTPInterface::handleReadBatch(unsigned char* const* buffers, unsigned const* bufferMaxSizes,
+				  unsigned numBuffers, unsigned* bytesRead,
+				  struct sockaddr_in* fromAddresses,
+				  struct timeval* receptionTimes) {
+  int numRead = fGS->handleReadBatch(buffers, bufferMaxSizes, numBuffers,
+				     bytesRead, fromAddresses, receptionTimes);
+
+  if (fAuxReadHandlerFunc != NULL) {
+    // Also pass each newly-read packet to our auxilliary handler:
+    for (int i = 0; i < numRead; ++i) {
+      if (bytesRead[i] > 0) {
+	(*fAuxReadHandlerFunc)(fAuxReadHandlerClientData, buffers[i], bytesRead[i]);
+      }
+    }
+  }
+  return numRead;
+}
+
 void RTPInterface::stopNetworkReading() {
   // Normal case
   envir().taskScheduler().turnOffBackgroundReadHandling(fGS->socketNum());
@@ -267,46 +423,19 @@ void RTPInterface::stopNetworkReading() {
 
 ////////// Helper Functions - Implementation /////////
 
-void sendRTPOverTCP(unsigned char* packet, unsigned packetSize,
-                    int socketNum, unsigned char streamChannelId) {
-#ifdef DEBUG
-  fprintf(stderr, "sendRTPOverTCP: %d bytes over channel %d (socket %d)\n",
-	  packetSize, streamChannelId, socketNum); fflush(stderr);
-#endif
-  // Send RTP over TCP, using the encoding defined in
-  // RFC 2326, section 10.12:
-  do {
-    char const dollar = '$';
-    if (send(socketNum, &dollar, 1, 0) != 1) break;
-    if (send(socketNum, (char*)&streamChannelId, 1, 0) != 1) break;
-
-    char netPacketSize[2];
-    netPacketSize[0] = (char) ((packetSize&0xFF00)>>8);
-    netPacketSize[1] = (char) (packetSize&0xFF);
-    if (send(socketNum, netPacketSize, 2, 0) != 2) break;
-
-    if (send(socketNum, (char*)packet, packetSize, 0) != (int)packetSize) break;
-
-#ifdef DEBUG
-    fprintf(stderr, "sendRTPOverTCP: completed\n"); fflush(stderr);
-#endif
-
-    return;
-  } while (0);
-
-#ifdef DEBUG
-  fprintf(stderr, "sendRTPOverTCP: failed!\n"); fflush(stderr);
-#endif
-}
-
 SocketDescriptor::SocketDescriptor(UsageEnvironment& env, int socketNum)
   :fEnv(env), fOurSocketNum(socketNum),
     fSubChannelHashTable(HashTable::create(ONE_WORD_HASH_KEYS)),
    fServerRequestAlternativeByteHandler(NULL), fServerRequestAlternativeByteHandlerClientData(NULL),
-   fTCPReadingState(AWAITING_DOLLAR) {
+   fTCPReadingState(AWAITING_DOLLAR),
+   fNumOutputUsers(0), fOutputQueue(NULL), fOutputQueueSize(0),
+   fOutputQueueHead(0), fOutputQueueTail(0), fOutputRetryTask(NULL),
+   fOutputFailed(False), fNumPacketsDropped(0) {
 }
 
 SocketDescriptor::~SocketDescriptor() {
+  fEnv.taskScheduler().unscheduleDelayedTask(fOutputRetryTask);
+  delete[] fOutputQueue;
   delete fSubChannelHashTable;
 }
 
@@ -336,13 +465,183 @@ void SocketDescriptor
   fSubChannelHashTable->Remove((char const*)(long)streamChannelId);
 
   if (fSubChannelHashTable->IsEmpty()) {
-    // No more interfaces are using us, so it's curtains for us now
+    // No more interfaces are reading from us:
     fEnv.taskScheduler().turnOffBackgroundReadHandling(fOurSocketNum);
+    deleteIfUnused();
+  }
+}
+
+void SocketDescriptor::deregisterOutputUser() {
+  if (fNumOutputUsers > 0) --fNumOutputUsers;
+  deleteIfUnused();
+}
+
+void SocketDescriptor::deleteIfUnused() {
+  if (fSubChannelHashTable->IsEmpty() && fNumOutputUsers == 0) {
+    // No more interfaces are using us, so it's curtains for us now
     removeSocketDescription(fEnv, fOurSocketNum);
     delete this;
   }
 }
 
+void SocketDescriptor::sendRTPOverTCP(unsigned char streamChannelId,
+				      unsigned char const* header, unsigned headerSize,
+				      unsigned char const* payload, unsigned payloadSize,
+				      Boolean moreToCome) {
+  unsigned packetSize = headerSize + payloadSize;
+#ifdef DEBUG
+  fprintf(stderr, "sendRTPOverTCP: %d bytes over channel %d (socket %d)\n",
+	  packetSize, streamChannelId, fOurSocketNum); fflush(stderr);
+#endif
+  if (numQueuedOutputBytes() + 4 + packetSize > MAX_TCP_OUTPUT_QUEUE_SIZE) {
+    // Our client is far behind.  Drop this (whole) packet, so that the stream's framing stays intact:
+    ++fNumPacketsDropped;
+    return;
+  }
+
+  // Send RTP over TCP, using the encoding defined in
+  // RFC 2326, section 10.12:
+  unsigned char framing[4];
+  framing[0] = '$';
+  framing[1] = streamChannelId;
+  framing[2] = (unsigned char)((packetSize&0xFF00)>>8);
+  framing[3] = (unsigned char)(packetSize&0xFF);
+
+  struct iovec parts[3];
+  parts[0].iov_base = (void*)framing; parts[0].iov_len = 4;
+  parts[1].iov_base = (void*)header; parts[1].iov_len = headerSize;
+  parts[2].iov_base = (void*)payload; parts[2].iov_len = payloadSize;
+  sendOrQueue(parts, payloadSize > 0 ? 3 : 2, moreToCome);
+}
+
+void SocketDescriptor::sendData(unsigned char const* data, unsigned dataSize) {
+  struct iovec part;
+  part.iov_base = (void*)data; part.iov_len = dataSize;
+  sendOrQueue(&part, 1, False);
+}
+
+// Writes "parts" to "socketNum" (in one system call, if we can).  Returns the number of
+// bytes written (0 if the socket would block), or -1 on error:
+static int writeParts(UsageEnvironment& env, int socketNum,
+		      struct iovec const* parts, unsigned numParts) {
+#if !defined(__WIN32__) && !defined(_WIN32)
+  int result = writev(socketNum, parts, numParts);
+#else
+  int result = 0;
+  for (unsigned i = 0; i < numParts; ++i) {
+    int numSent = send(socketNum, (char const*)parts[i].iov_base, parts[i].iov_len, 0);
+    if (numSent < 0) {
+      if (result == 0) result = -1;
+      break;
+    }
+    result += numSent;
+    if ((unsigned)numSent < parts[i].iov_len) break;
+  }
+#endif
+  if (result < 0) {
+    int err = env.getErrno();
+    if (err == EAGAIN || err == EWOULDBLOCK || err == EINTR) return 0;
+  }
+  return result;
+}
+
+#define TCP_OUTPUT_RETRY_USECS 5000
+
+void SocketDescriptor::sendOrQueue(struct iovec const* parts, unsigned numParts,
+				   Boolean moreToCome) {
+  if (fOutputFailed) return;
+
+  unsigned numPartsQueued = 0;
+  if (numQueuedOutputBytes() == 0 && !moreToCome) {
+    // Common case: Nothing else is waiting, so try to write all of this right away:
+    int numSent = writeParts(fEnv, fOurSocketNum, parts, numParts);
+    if (numSent < 0) {
+      fOutputFailed = True; // e.g., the connection was closed
+      return;
+    }
+
+    // Queue whatever wasn't written:
+    unsigned numBytesToSkip = (unsigned)numSent;
+    for (; numPartsQueued < numParts; ++numPartsQueued) {
+      unsigned partSize = parts[numPartsQueued].iov_len;
+      if (numBytesToSkip < partSize) {
+	queueOutput((unsigned char const*)parts[numPartsQueued].iov_base + numBytesToSkip,
+		    partSize - numBytesToSkip);
+	numBytesToSkip = 0;
+      } else {
+	numBytesToSkip -= partSize;
+      }
+    }
+  } else {
+    // Add this to the end of the queue - then (unless more is coming) write the queue, all at once:
+    for (unsigned i = 0; i < numParts; ++i) {
+      queueOutput((unsigned char const*)parts[i].iov_base, parts[i].iov_len);
+    }
+    if (!moreToCome) flushOutputQueue();
+  }
+
+  if (numQueuedOutputBytes() > 0 && !moreToCome && fOutputRetryTask == NULL) {
+    // The socket would have blocked, so try again later:
+    fOutputRetryTask = fEnv.taskScheduler().scheduleDelayedTask(TCP_OUTPUT_RETRY_USECS,
+								(TaskFunc*)retryOutput, this);
+  }
+}
+
+void SocketDescriptor::queueOutput(unsigned char const* data, unsigned dataSize) {
+  if (dataSize == 0) return;
+
+  if (fOutputQueueTail + dataSize > fOutputQueueSize) {
+    // First, move the queued data to the start of the queue:
+    unsigned numQueued = numQueuedOutputBytes();
+    memmove(fOutputQueue, &fOutputQueue[fOutputQueueHead], numQueued);
+    fOutputQueueHead = 0;
+    fOutputQueueTail = numQueued;
+
+    if (numQueued + dataSize > fOutputQueueSize) {
+      // The queue needs to be bigger:
+      unsigned newSize = fOutputQueueSize == 0 ? 64*1024 : fOutputQueueSize;
+      while (newSize < numQueued + dataSize) newSize *= 2;
+      unsigned char* newQueue = new unsigned char[newSize];
+      memmove(newQueue, fOutputQueue, numQueued);
+      delete[] fOutputQueue;
+      fOutputQueue = newQueue;
+      fOutputQueueSize = newSize;
+    }
+  }
+
+  memmove(&fOutputQueue[fOutputQueueTail], data, dataSize);
+  fOutputQueueTail += dataSize;
+}
+
+void SocketDescriptor::flushOutputQueue() {
+  unsigned numQueued = numQueuedOutputBytes();
+  if (numQueued == 0) return;
+
+  struct iovec part;
+  part.iov_base = (void*)&fOutputQueue[fOutputQueueHead]; part.iov_len = numQueued;
+  int numSent = writeParts(fEnv, fOurSocketNum, &part, 1);
+  if (numSent < 0) {
+    // Discard everything; we won't be able to send any more:
+    fOutputFailed = True;
+    numSent = numQueued;
+  }
+
+  fOutputQueueHead += numSent;
+  if (fOutputQueueHead == fOutputQueueTail) fOutputQueueHead = fOutputQueueTail = 0;
+}
+
+void SocketDescriptor::retryOutput(void* clientData) {
+  SocketDescriptor* socketDescriptor = (SocketDescriptor*)clientData;
+  socketDescriptor->fOutputRetryTask = NULL;
+
+  socketDescriptor->flushOutputQueue();
+  if (socketDescriptor->numQueuedOutputBytes() > 0) {
+    socketDescriptor->fOutputRetryTask
+      = socketDescriptor->fEnv.taskScheduler().scheduleDelayedTask(TCP_OUTPUT_RETRY_USECS,
+								   (TaskFunc*)retryOutput, socketDescriptor);
+  }
+}
+
 void SocketDescriptor::tcpReadHandler(SocketDescriptor* socketDescriptor, int mask) {
   socketDescriptor->tcpReadHandler1(mask);
 }
@@ -434,7 +733,8 @@ tcpStreamRecord
 ::tcpStreamRecord(int streamSocketNum, unsigned char streamChannelId,
 		  tcpStreamRecord* next)
   : fNext(next),
-    fStreamSocketNum(streamSocketNum), fStreamChannelId(streamChannelId) {
+    fStreamSocketNum(streamSocketNum), fStreamChannelId(streamChannelId),
+    fSocketDescriptor(NULL) {
 }
 
 tcpStreamRecord::~tcpStreamRecord() {
@@ -51,8 +51,10 @@ RTPSink::RTPSink(UsageEnvironment& env,
   : MediaSink(env), fRTPInterface(this, rtpGS),
     fRTPPayloadType(rtpPayloadType),
     fPacketCount(0), fOctetCount(0), fTotalOctetCount(0),
+    fNumBytesSent(0), fNumTCPBacklogWaits(0), fProcessingTimeUSecs(0), fGOPCache(NULL), fHintTrackRecorder(NULL),
     fTimestampFrequency(rtpTimestampFrequency), fNextTimestampHasBeenPreset(True),
-    fNumChannels(numChannels) {
+    fNumChannels(numChannels),
+    fHaveCurFrameSendLatency(False), fCurFrameTimestamp(0), fCurFrameSendLatencyUSecs(0) {
   fRTPPayloadFormatName
     = strDup(rtpPayloadFormatName == NULL ? "???" : rtpPayloadFormatName);
   gettimeofday(&fCreationTime, NULL);
@@ -70,6 +72,32 @@ RTPSink::~RTPSink() {
   delete[] (char*)fRTPPayloadFormatName;
 }
 
+void RTPSink::addProcessingTimeSince(struct timeval const& startTime) {
+  struct timeval timeNow;
+  gettimeofday(&timeNow, NULL);
+  int64_t uSecs = (timeNow.tv_sec - startTime.tv_sec)*(int64_t)1000000
+    + (timeNow.tv_usec - startTime.tv_usec);
+  if (uSecs > 0) fProcessingTimeUSecs += uSecs; // (the clock might have been set back)
+}
+
+void RTPSink::noteSendLatency(u_int32_t rtpTimestamp, struct timeval const& timeSent) {
+  // Until our first timestamp has been generated, we can't convert times to timestamps
+  // (without changing our timestamp base):
+  if (fNextTimestampHasBeenPreset || fTimestampFrequency == 0) return;
+
+  if (fHaveCurFrameSendLatency && rtpTimestamp != fCurFrameTimestamp) {
+    // A new frame has begun, so we have sent all of the previous one:
+    fSendLatencyHistogram.record(fCurFrameSendLatencyUSecs);
+  }
+  fHaveCurFrameSendLatency = True;
+  fCurFrameTimestamp = rtpTimestamp;
+
+  // Compare the timestamp with the one that corresponds to the time sent:
+  int latencyInTimestampUnits = (int)(convertToRTPTimestamp(timeSent) - rtpTimestamp);
+      // Note: This works even if the timestamp wraps around
+  fCurFrameSendLatencyUSecs = (int)((latencyInTimestampUnits*1000000.0)/fTimestampFrequency);
+}
+
 u_int32_t RTPSink::convertToRTPTimestamp(struct timeval tv) {
   // Begin by converting from "struct timeval" units to RTP timestamp units:
   u_int32_t timestampIncrement = (fTimestampFrequency*tv.tv_sec);
@@ -275,6 +303,9 @@ void RTPTransmissionStats
   unsigned rtd = roundTripDelay();
   fprintf(stderr, "=> round-trip delay: 0x%04x (== %f seconds)\n", rtd, rtd/65536.0);
 #endif
+  if (fLastSRTime != 0) { // the receiver has heard one of our SRs
+    fRoundTripDelayHistogram.record((int)((roundTripDelay()*15625.0)/1024)); // 10^6/2^16
+  }
 
   // Update our counts of the total number of octets and packets sent towards
   // this receiver:
@@ -103,7 +103,8 @@ void RTPReceptionStatsDB
 		     Boolean useForJitterCalculation,
 		     struct timeval& resultPresentationTime,
 		     Boolean& resultHasBeenSyncedUsingRTCP,
-		     unsigned packetSize) {
+		     unsigned packetSize,
+		     struct timeval const* timeReceived) {
   ++fTotNumPacketsReceived;
   RTPReceptionStats* stats = lookup(SSRC);
   if (stats == NULL) {
@@ -121,7 +122,7 @@ void RTPReceptionStatsDB
   stats->noteIncomingPacket(seqNum, rtpTimestamp, timestampFrequency,
 			    useForJitterCalculation,
 			    resultPresentationTime,
-			    resultHasBeenSyncedUsingRTCP, packetSize);
+			    resultHasBeenSyncedUsingRTCP, packetSize, timeReceived);
 }
 
 void RTPReceptionStatsDB
@@ -213,6 +214,10 @@ void RTPReceptionStats::init(u_int32_t SSRC) {
   fTotalInterPacketGaps.tv_sec = fTotalInterPacketGaps.tv_usec = 0;
   fHasBeenSynchronized = False;
   fSyncTime.tv_sec = fSyncTime.tv_usec = 0;
+  fLastSRTransitUSecs = fMinSRTransitUSecs = 0;
+  fHaveCurFrameLatency = False;
+  fCurFrameRTPTimestamp = 0;
+  fCurFrameLatencyUSecs = 0;
   reset();
 }
 
@@ -226,13 +231,23 @@ void RTPReceptionStats::initSeqNum(u_int16_t initialSeqNum) {
 #define MILLION 1000000
 #endif
 
+static int uSecondsBetween(struct timeval const& from, struct timeval const& to) {
+  // Note: The two times may come from different clocks, so the result is limited to
+  // the range of an "int", rather than overflowing:
+  int64_t result = (to.tv_sec - from.tv_sec)*(int64_t)MILLION + (to.tv_usec - from.tv_usec);
+  if (result > 0x7FFFFFFF) return 0x7FFFFFFF;
+  if (result < -0x7FFFFFFF) return -0x7FFFFFFF;
+  return (int)result;
+}
+
 void RTPReceptionStats
 ::noteIncomingPacket(u_int16_t seqNum, u_int32_t rtpTimestamp,
 		     unsigned timestampFrequency,
 		     Boolean useForJitterCalculation,
 		     struct timeval& resultPresentationTime,
 		     Boolean& resultHasBeenSyncedUsingRTCP,
-		     unsigned packetSize) {
+		     unsigned packetSize,
+		     struct timeval const* timeReceived) {
   if (!fHaveSeenInitialSequenceNumber) initSeqNum(seqNum);
 
   ++fNumPacketsReceivedSinceLastReset;
@@ -248,8 +263,10 @@ void RTPReceptionStats
   unsigned seqNumCycle = (fHighestExtSeqNumReceived&0xFFFF0000);
   unsigned seqNumDifference = (unsigned)((int)seqNum-(int)oldSeqNum);
   unsigned newSeqNum = 0;
+  Boolean packetIsInOrder = fTotNumPacketsReceived == 1;
   if (seqNumLT((u_int16_t)oldSeqNum, seqNum)) {
     // This packet was not an old packet received out of order, so check it:
+    packetIsInOrder = True;
     
     if (seqNumDifference >= 0x8000) {
       // The sequence number wrapped around, so start a new cycle:
@@ -276,7 +293,11 @@ void RTPReceptionStats
 
   // Record the inter-packet delay
   struct timeval timeNow;
-  gettimeofday(&timeNow, NULL);
+  if (timeReceived != NULL) {
+    timeNow = *timeReceived;
+  } else {
+    gettimeofday(&timeNow, NULL);
+  }
   if (fLastPacketReceptionTime.tv_sec != 0
       || fLastPacketReceptionTime.tv_usec != 0) {
     unsigned gap
@@ -357,6 +378,18 @@ void RTPReceptionStats
   resultPresentationTime.tv_usec = uSeconds;
   resultHasBeenSyncedUsingRTCP = fHasBeenSynchronized;
 
+  if (fHasBeenSynchronized && packetIsInOrder) {
+    // "resultPresentationTime" is now the sender's 'wall clock' time for this packet's
+    // RTP timestamp, so measure the frame's latency against it:
+    if (fHaveCurFrameLatency && rtpTimestamp != fCurFrameRTPTimestamp) {
+      // A new frame has begun, so we have received all of the previous one:
+      fFrameLatencyHistogram.record(fCurFrameLatencyUSecs);
+    }
+    fHaveCurFrameLatency = True;
+    fCurFrameRTPTimestamp = rtpTimestamp;
+    fCurFrameLatencyUSecs = uSecondsBetween(resultPresentationTime, timeNow);
+  }
+
   // Save these as the new synchronization timestamp & time:
   fSyncTimestamp = rtpTimestamp;
   fSyncTime = resultPresentationTime;
@@ -377,6 +410,12 @@ void RTPReceptionStats::noteIncomingSR(u_int32_t ntpTimestampMSW,
   fSyncTime.tv_sec = ntpTimestampMSW - 0x83AA7E80; // 1/1/1900 -> 1/1/1970
   double microseconds = (ntpTimestampLSW*15625.0)/0x04000000; // 10^6/2^32
   fSyncTime.tv_usec = (unsigned)(microseconds+0.5);
+
+  // Note how long (by our clock) this SR took to get here:
+  fLastSRTransitUSecs = uSecondsBetween(fSyncTime, fLastReceivedSR_time);
+  if (!fHasBeenSynchronized || fLastSRTransitUSecs < fMinSRTransitUSecs) {
+    fMinSRTransitUSecs = fLastSRTransitUSecs;
+  }
   fHasBeenSynchronized = True;
 }
 
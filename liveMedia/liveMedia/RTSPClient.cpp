@@ -72,6 +72,53 @@ unsigned RTSPClient::sendSetupCommand(MediaSubsession& subsession, responseHandl
     return sendRequest(new RequestRecord(++fCSeq, "SETUP", responseHandler, NULL, &subsession, booleanFlags));
 }
 
+unsigned RTSPClient::sendSetupCommands(MediaSession& session, responseHandler* responseHandler,
+                                       Boolean streamOutgoing, Boolean streamUsingTCP, Boolean forceMulticastOnUnspecified,
+                                       Authenticator* authenticator)
+{
+    if (fSetupCommandsSession != NULL)
+    {
+        envir().setResultMsg("A \"sendSetupCommands()\" operation is already in progress");
+        if (responseHandler != NULL) (*responseHandler)(this, -EBUSY, strDup(envir().getResultMsg()));
+        return 0;
+    }
+    if (authenticator != NULL) fCurrentAuthenticator = *authenticator;
+
+    fSetupCommandsSession = &session;
+    fSetupCommandsHandler = responseHandler;
+    fSetupCommandsStreamOutgoing = streamOutgoing;
+    fSetupCommandsStreamUsingTCP = streamUsingTCP;
+    fSetupCommandsForceMulticast = forceMulticastOnUnspecified;
+    fFirstSetupSubsession = NULL;
+    fNumSetupResponsesPending = 0;
+    fSetupCommandsResultCode = 0;
+    fSetupCommandsResultString = NULL;
+
+    if (fLastSessionId != NULL)
+    {
+        // We already have a session id, so we can send all of the "SETUP"s now:
+        return sendRemainingSetupCommands(NULL);
+    }
+
+    // Otherwise, send the first "SETUP" alone.  The server's response to it will give us the session id that we'll use
+    // in the remaining "SETUP"s (so that they all belong to the same session):
+    MediaSubsessionIterator iter(session);
+    MediaSubsession* subsession;
+    while ((subsession = iter.next()) != NULL)
+    {
+        if (subsession->readSource() == NULL) continue; // this subsession wasn't initiated
+
+        fFirstSetupSubsession = subsession;
+        ++fNumSetupResponsesPending;
+        return sendSetupCommand(*subsession, responseHandlerForSetupCommands,
+                                streamOutgoing, streamUsingTCP, forceMulticastOnUnspecified);
+    }
+
+    // There were no subsessions to set up:
+    completeSetupCommands();
+    return 0;
+}
+
 unsigned RTSPClient::sendPlayCommand(MediaSession& session, responseHandler* responseHandler,
                                      double start, double end, float scale,
                                      Authenticator* authenticator)
@@ -175,6 +222,47 @@ Boolean RTSPClient::changeResponseHandler(unsigned cseq, responseHandler* newRes
     return False;
 }
 
+Boolean RTSPClient::changeURL(char const* rtspURL)
+{
+    Boolean keepConnection = False;
+    if (fInputSocketNum >= 0 && fTunnelOverHTTPPortNum == 0
+            && fRequestsAwaitingConnection.isEmpty() && fRequestsAwaitingHTTPTunneling.isEmpty()
+            && fRequestsAwaitingResponse.isEmpty() && fSetupCommandsSession == NULL)
+    {
+        char* username;
+        char* password;
+        NetAddress destAddress;
+        portNumBits urlPortNum;
+        if (parseRTSPURL(envir(), rtspURL, username, password, destAddress, urlPortNum))
+        {
+            keepConnection = *(unsigned*)(destAddress.data()) == fServerAddress && urlPortNum == fServerPortNum;
+            if (keepConnection && (username != NULL || password != NULL))
+            {
+                fCurrentAuthenticator.setUsernameAndPassword(username, password);
+            }
+            delete[] username;
+            delete[] password;
+        }
+    }
+
+    if (keepConnection)
+    {
+        // Forget the state of the previous session, but keep our connection:
+        resetResponseBuffer();
+        fTCPStreamIdCount = 0;
+        delete[] fLastSessionId;
+        fLastSessionId = NULL;
+        fSessionTimeoutParameter = 0;
+    }
+    else
+    {
+        reset(); // (We'll connect to the new URL's server when we next send a command.)
+    }
+    setBaseURL(rtspURL);
+
+    return keepConnection;
+}
+
 Boolean RTSPClient::lookupByName(UsageEnvironment& env,
                                  char const* instanceName,
                                  RTSPClient*& resultClient)
@@ -326,8 +414,11 @@ RTSPClient::RTSPClient(UsageEnvironment& env, char const* rtspURL,
                        portNumBits tunnelOverHTTPPortNum)
     : Medium(env),
       fVerbosityLevel(verbosityLevel), fTunnelOverHTTPPortNum(tunnelOverHTTPPortNum),
-      fUserAgentHeaderStr(NULL), fUserAgentHeaderStrLen(0), fInputSocketNum(-1), fOutputSocketNum(-1), fServerAddress(0), fCSeq(1),
+      fUserAgentHeaderStr(NULL), fUserAgentHeaderStrLen(0), fInputSocketNum(-1), fOutputSocketNum(-1), fServerAddress(0), fServerPortNum(0), fCSeq(1),
       fBaseURL(NULL), fTCPStreamIdCount(0), fLastSessionId(NULL), fSessionTimeoutParameter(0),
+      fSetupCommandsSession(NULL), fSetupCommandsHandler(NULL),
+      fSetupCommandsStreamOutgoing(False), fSetupCommandsStreamUsingTCP(False), fSetupCommandsForceMulticast(False),
+      fFirstSetupSubsession(NULL), fNumSetupResponsesPending(0), fSetupCommandsResultCode(0), fSetupCommandsResultString(NULL),
       fSessionCookieCounter(0), fHTTPTunnelingConnectionIsPending(False)
 {
     setBaseURL(rtspURL);
@@ -367,6 +458,7 @@ RTSPClient::~RTSPClient()
 {
     reset();
 
+    delete[] fSetupCommandsResultString;
     delete[] fResponseBuffer;
     delete[] fUserAgentHeaderStr;
 }
@@ -444,6 +536,7 @@ int RTSPClient::openConnection()
         
         // Connect to the remote endpoint:
         fServerAddress = *(unsigned*)(destAddress.data());
+        fServerPortNum = urlPortNum;
         int connectResult = connectToServer(fInputSocketNum, destPortNum);
         if (connectResult < 0) break;
         else if (connectResult > 0)
@@ -1607,6 +1700,82 @@ static Boolean isAbsoluteURL(char const* url)
     return False;
 }
 
+unsigned RTSPClient::sendRemainingSetupCommands(MediaSubsession* subsessionAlreadySetUp)
+{
+    // Send each "SETUP" without waiting for a response.  (The extra count here stops us from completing the operation - if a
+    // "SETUP" fails immediately - before we've sent them all.)
+    ++fNumSetupResponsesPending;
+    unsigned firstCSeq = 0;
+    MediaSubsessionIterator iter(*fSetupCommandsSession);
+    MediaSubsession* subsession;
+    while ((subsession = iter.next()) != NULL)
+    {
+        if (subsession->readSource() == NULL || subsession == subsessionAlreadySetUp) continue;
+
+        ++fNumSetupResponsesPending;
+        unsigned cseq = sendSetupCommand(*subsession, responseHandlerForSetupCommands,
+                                         fSetupCommandsStreamOutgoing, fSetupCommandsStreamUsingTCP, fSetupCommandsForceMulticast);
+        if (firstCSeq == 0) firstCSeq = cseq;
+    }
+
+    if (--fNumSetupResponsesPending == 0) completeSetupCommands();
+    return firstCSeq;
+}
+
+void RTSPClient::responseHandlerForSetupCommands(RTSPClient* rtspClient, int responseCode, char* responseString)
+{
+    if (rtspClient != NULL) rtspClient->responseHandlerForSetupCommands1(responseCode, responseString);
+}
+
+void RTSPClient::responseHandlerForSetupCommands1(int responseCode, char* responseString)
+{
+    // Remember the result of the first "SETUP" that failed:
+    if (responseCode != 0 && fSetupCommandsResultCode == 0)
+    {
+        fSetupCommandsResultCode = responseCode;
+        fSetupCommandsResultString = responseString;
+    }
+    else
+    {
+        delete[] responseString;
+    }
+    --fNumSetupResponsesPending;
+
+    if (fFirstSetupSubsession != NULL)
+    {
+        // This was the response to our first "SETUP".  If it succeeded, we now have a session id, so send the rest:
+        MediaSubsession* firstSubsession = fFirstSetupSubsession;
+        fFirstSetupSubsession = NULL;
+        if (responseCode == 0)
+        {
+            sendRemainingSetupCommands(firstSubsession);
+            return;
+        }
+    }
+
+    if (fNumSetupResponsesPending == 0) completeSetupCommands();
+}
+
+void RTSPClient::completeSetupCommands()
+{
+    responseHandler* handler = fSetupCommandsHandler;
+    int resultCode = fSetupCommandsResultCode;
+    char* resultString = fSetupCommandsResultString;
+
+    fSetupCommandsSession = NULL;
+    fSetupCommandsHandler = NULL;
+    fSetupCommandsResultString = NULL;
+
+    if (handler != NULL)
+    {
+        (*handler)(this, resultCode, resultString);
+    }
+    else
+    {
+        delete[] resultString;
+    }
+}
+
 void RTSPClient::constructSubsessionURL(MediaSubsession const& subsession,
                                         char const*& prefix,
                                         char const*& separator,
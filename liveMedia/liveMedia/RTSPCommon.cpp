@@ -158,6 +158,53 @@ Boolean parseRangeParam(char const* paramStr, double& rangeStart, double& rangeE
   return True;
 }
 
+char const* findHeaderByScanning(char const* buf, char const* headerName) {
+  unsigned const nameLength = strlen(headerName);
+  while (1) {
+    if (*buf == '\0') return NULL; // not found
+    if (_strncasecmp(buf, headerName, nameLength) == 0 && buf[nameLength] == ':') break;
+    ++buf;
+  }
+
+  char const* value = buf + nameLength + 1;
+  while (*value == ' ' || *value == '\t') ++value;
+  return value;
+}
+
+void RTSPHeaderIndex::noteLine(char const* message, unsigned lineStart, unsigned lineEnd) {
+  // Look for the ':' that ends the header name.  (A line without one - e.g., the request line - isn't a header.)
+  unsigned colon = lineStart;
+  while (colon < lineEnd && message[colon] != ':') ++colon;
+  if (colon == lineStart || colon == lineEnd) return;
+
+  unsigned nameEnd = colon;
+  while (nameEnd > lineStart && (message[nameEnd-1] == ' ' || message[nameEnd-1] == '\t')) --nameEnd;
+  unsigned valueStart = colon + 1;
+  while (valueStart < lineEnd && (message[valueStart] == ' ' || message[valueStart] == '\t')) ++valueStart;
+
+  if (fNumHeaders == RTSP_MAX_INDEXED_HEADERS || nameEnd - lineStart > 0xFF || valueStart > 0xFFFF) {
+    fOverflowed = True;
+    return;
+  }
+  HeaderLocation& header = fHeaders[fNumHeaders++];
+  header.nameOffset = (unsigned short)lineStart;
+  header.nameLength = (unsigned char)(nameEnd - lineStart);
+  header.valueOffset = (unsigned short)valueStart;
+}
+
+char const* RTSPHeaderIndex::lookup(char const* message, char const* headerName) const {
+  unsigned const nameLength = strlen(headerName);
+  for (unsigned i = 0; i < fNumHeaders; ++i) {
+    HeaderLocation const& header = fHeaders[i];
+    if (header.nameLength == nameLength
+	&& _strncasecmp(&message[header.nameOffset], headerName, nameLength) == 0) {
+      return &message[header.valueOffset];
+    }
+  }
+
+  return NULL;
+}
+
 Boolean parseRangeHeader(char const* buf, double& rangeStart, double& rangeEnd) {
   // First, find "Range:"
   while (1) {
@@ -21,6 +21,8 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "RTSPServer.hh"
 #include "RTSPCommon.hh"
 #include "Base64.hh"
+#include "RTPSink.hh" // for statistics
+#include "our_md5.h"
 #include <GroupsockHelper.hh>
 
 #if defined(__WIN32__) || defined(_WIN32) || defined(_QNX4)
@@ -29,6 +31,7 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #define USE_SIGNALS 1
 #endif
 #include <time.h> // for "strftime()" and "gmtime()"
+#include <stdarg.h> // for "StatisticsReportBuffer::append()"
 
 ////////// RTSPServer implementation //////////
 
@@ -140,6 +143,43 @@ UserAuthenticationDatabase* RTSPServer::setAuthenticationDatabase(UserAuthentica
   return oldDB;
 }
 
+#ifndef AUTH_NONCE_LIFETIME_SECONDS
+#define AUTH_NONCE_LIFETIME_SECONDS 300
+#endif
+
+char const* RTSPServer::currentNonce() {
+  struct timeval timeNow;
+  gettimeofday(&timeNow, NULL);
+  long period = timeNow.tv_sec/AUTH_NONCE_LIFETIME_SECONDS;
+  if (period != fNoncePeriod) {
+    // Start a new nonce period.  The nonce is md5(<period>, <our secret>):
+    if (period == fNoncePeriod + 1) {
+      memmove(fPreviousNonce, fCurrentNonce, sizeof fCurrentNonce);
+    } else {
+      fPreviousNonce[0] = '\0';
+    }
+
+    struct {
+      long period;
+      u_int32_t secret[4];
+    } seedData;
+    memset(&seedData, 0, sizeof seedData);
+    seedData.period = period;
+    memmove(seedData.secret, fNonceSecret, sizeof fNonceSecret);
+    our_MD5Data((unsigned char*)(&seedData), sizeof seedData, fCurrentNonce);
+
+    fNoncePeriod = period;
+  }
+
+  return fCurrentNonce;
+}
+
+Boolean RTSPServer::nonceIsValid(char const* nonce) {
+  // A nonce is valid if it's our current nonce, or the one from the previous period:
+  return strcmp(nonce, currentNonce()) == 0
+    || (fPreviousNonce[0] != '\0' && strcmp(nonce, fPreviousNonce) == 0);
+}
+
 Boolean RTSPServer::setUpTunnelingOverHTTP(Port httpPort) {
   fHTTPServerSocket = setUpOurSocket(envir(), httpPort);
   if (fHTTPServerSocket >= 0) {
@@ -156,15 +196,187 @@ portNumBits RTSPServer::httpServerPortNum() const {
   return ntohs(fHTTPServerPort.num());
 }
 
+////////// Statistics //////////
+
+#define LOOP_LATENCY_PROBE_INTERVAL_USECS 100000
+
+void RTSPServer::enableStatistics(char const* urlSuffix, Boolean onlyForLocalClients) {
+  delete[] fStatisticsURLSuffix;
+  fStatisticsURLSuffix = strDup(urlSuffix == NULL ? "stats" : urlSuffix);
+  fStatisticsOnlyForLocalClients = onlyForLocalClients;
+  if (fLoopLatencyProbeTask != NULL) return; // we were already enabled
+
+  gettimeofday(&fStatisticsStartTime, NULL);
+  fNextLoopLatencyProbeTime = fStatisticsStartTime;
+  fNextLoopLatencyProbeTime.tv_usec += LOOP_LATENCY_PROBE_INTERVAL_USECS;
+  fNextLoopLatencyProbeTime.tv_sec += fNextLoopLatencyProbeTime.tv_usec/1000000;
+  fNextLoopLatencyProbeTime.tv_usec %= 1000000;
+  fLoopLatencyProbeTask = envir().taskScheduler()
+    .scheduleDelayedTask(LOOP_LATENCY_PROBE_INTERVAL_USECS, (TaskFunc*)loopLatencyProbe, this);
+}
+
+void RTSPServer::loopLatencyProbe(void* instance) {
+  ((RTSPServer*)instance)->loopLatencyProbe1();
+}
+
+void RTSPServer::loopLatencyProbe1() {
+  // The time by which this (delayed) task ran late is a measure of how long each
+  // iteration of the event loop is taking - i.e., how long other handlers have to wait:
+  struct timeval timeNow;
+  gettimeofday(&timeNow, NULL);
+  int64_t latency = (timeNow.tv_sec - fNextLoopLatencyProbeTime.tv_sec)*(int64_t)1000000
+    + (timeNow.tv_usec - fNextLoopLatencyProbeTime.tv_usec);
+  if (latency < 0) latency = 0;
+
+  fLastLoopLatencyUSecs = (unsigned)latency;
+  if (fLastLoopLatencyUSecs > fMaxLoopLatencyUSecs) fMaxLoopLatencyUSecs = fLastLoopLatencyUSecs;
+  fTotalLoopLatencyUSecs += fLastLoopLatencyUSecs;
+  ++fNumLoopLatencySamples;
+
+  fNextLoopLatencyProbeTime = timeNow;
+  fNextLoopLatencyProbeTime.tv_usec += LOOP_LATENCY_PROBE_INTERVAL_USECS;
+  fNextLoopLatencyProbeTime.tv_sec += fNextLoopLatencyProbeTime.tv_usec/1000000;
+  fNextLoopLatencyProbeTime.tv_usec %= 1000000;
+  fLoopLatencyProbeTask = envir().taskScheduler()
+    .scheduleDelayedTask(LOOP_LATENCY_PROBE_INTERVAL_USECS, (TaskFunc*)loopLatencyProbe, this);
+}
+
+unsigned RTSPServer::numClientSessions() const {
+  return fClientSessions->numEntries();
+}
+
+// A string that grows as needed, used to build our statistics report:
+class StatisticsReportBuffer {
+public:
+  StatisticsReportBuffer()
+    : fBuffer(new char[1000]), fBufferSize(1000), fLength(0) {
+    fBuffer[0] = '\0';
+  }
+  ~StatisticsReportBuffer() { delete[] fBuffer; }
+
+  void append(char const* format, ...) {
+    while (1) {
+      va_list args;
+      va_start(args, format);
+      int n = vsnprintf(&fBuffer[fLength], fBufferSize - fLength, format, args);
+      va_end(args);
+      if (n < 0) return; // shouldn't happen
+      if (fLength + n < fBufferSize) {
+	fLength += n;
+	return;
+      }
+
+      // There wasn't enough room; enlarge our buffer, and try again:
+      unsigned newBufferSize = 2*(fLength + n + 1);
+      char* newBuffer = new char[newBufferSize];
+      memmove(newBuffer, fBuffer, fLength + 1);
+      delete[] fBuffer;
+      fBuffer = newBuffer; fBufferSize = newBufferSize;
+    }
+  }
+
+  void appendJSONString(char const* str) {
+    append("\"");
+    for (char const* p = str == NULL ? "" : str; *p != '\0'; ++p) {
+      unsigned char c = (unsigned char)*p;
+      if (c == '"' || c == '\\') append("\\%c", c);
+      else if (c < 0x20) append("\\u%04x", c);
+      else append("%c", c);
+    }
+    append("\"");
+  }
+
+  char* takeResult() { char* result = fBuffer; fBuffer = NULL; return result; }
+
+private:
+  char* fBuffer;
+  unsigned fBufferSize, fLength;
+};
+
+char* RTSPServer::statisticsReport() {
+  StatisticsReportBuffer report;
+  struct timeval timeNow;
+  gettimeofday(&timeNow, NULL);
+
+  report.append("{\n  \"clientSessions\": %u,\n  \"clientSessionsCreated\": %u,\n",
+		numClientSessions(), fNumClientSessionsCreated);
+  if (fStatisticsURLSuffix != NULL) {
+    report.append("  \"statisticsUptimeSeconds\": %ld,\n",
+		  (long)(timeNow.tv_sec - fStatisticsStartTime.tv_sec));
+    report.append("  \"eventLoopLatencyUSecs\": { \"last\": %u, \"average\": %u, \"max\": %u, \"samples\": %u },\n",
+		  fLastLoopLatencyUSecs,
+		  fNumLoopLatencySamples == 0 ? 0 : (unsigned)(fTotalLoopLatencyUSecs/fNumLoopLatencySamples),
+		  fMaxLoopLatencyUSecs, fNumLoopLatencySamples);
+  }
+
+  // Each stream that we're serving, and how many clients are using it:
+  report.append("  \"streams\": [");
+  Boolean isFirst = True;
+  ServerMediaSessionIterator iter(*this);
+  ServerMediaSession* serverMediaSession;
+  while ((serverMediaSession = iter.next()) != NULL) {
+    report.append("%s\n    { \"name\": ", isFirst ? "" : ",");
+    report.appendJSONString(serverMediaSession->streamName());
+    report.append(", \"clients\": %u }", serverMediaSession->referenceCount());
+    isFirst = False;
+  }
+  report.append("\n  ],\n");
+
+  // Each client session, and the statistics for each of its subsessions' streams:
+  report.append("  \"sessions\": [");
+  isFirst = True;
+  HashTable::Iterator* sessionIter = HashTable::Iterator::create(*fClientSessions);
+  RTSPClientSession* clientSession;
+  char const* key;
+  while ((clientSession = (RTSPClientSession*)sessionIter->next(key)) != NULL) {
+    if (clientSession->fOurServerMediaSession == NULL) continue; // it's not (yet) streaming
+
+    report.append("%s\n    { \"id\": \"%08X\", \"client\": \"%s\", \"stream\": ",
+		  isFirst ? "" : ",", clientSession->fOurSessionId,
+		  our_inet_ntoa(clientSession->fClientAddr.sin_addr));
+    report.appendJSONString(clientSession->fOurServerMediaSession->streamName());
+    report.append(", \"subsessions\": [");
+    Boolean isFirstSubsession = True;
+    for (unsigned i = 0; i < clientSession->fNumStreamStates; ++i) {
+      ServerMediaSubsession* subsession = clientSession->fStreamStates[i].subsession;
+      void* streamToken = clientSession->fStreamStates[i].streamToken;
+      if (subsession == NULL || streamToken == NULL) continue; // it hasn't been "SETUP"
+
+      report.append("%s\n        { \"track\": ", isFirstSubsession ? "" : ",");
+      report.appendJSONString(subsession->trackId());
+      RTPSink* rtpSink = subsession->rtpSinkForStream(streamToken);
+      if (rtpSink != NULL) {
+	report.append(", \"packetsSent\": %u, \"bytesSent\": %llu, \"sendErrors\": %u"
+		      ", \"tcpPacketsDropped\": %u, \"tcpBacklogWaits\": %u, \"processingTimeUSecs\": %llu",
+		      rtpSink->packetCount(), (unsigned long long)rtpSink->numBytesSent(),
+		      rtpSink->numSendErrors(), rtpSink->numTCPPacketsDropped(),
+		      rtpSink->numTCPBacklogWaits(), (unsigned long long)rtpSink->processingTimeUSecs());
+      }
+      report.append(" }");
+      isFirstSubsession = False;
+    }
+    report.append("%s] }", isFirstSubsession ? "" : "\n      ");
+    isFirst = False;
+  }
+  delete sessionIter;
+  report.append("\n  ]\n}\n");
+
+  return report.takeResult();
+}
+
 #define LISTEN_BACKLOG_SIZE 20
 
-int RTSPServer::setUpOurSocket(UsageEnvironment& env, Port& ourPort) {
+int RTSPServer::setUpOurSocket(UsageEnvironment& env, Port& ourPort, Boolean reusePort) {
   int ourSocket = -1;
 
   do {
-    NoReuse dummy; // Don't use this socket if there's already a local server using it
+    if (reusePort) {
+      ourSocket = setupStreamSocket(env, ourPort, True, True);
+    } else {
+      NoReuse dummy; // Don't use this socket if there's already a local server using it
 
-    ourSocket = setupStreamSocket(env, ourPort);
+      ourSocket = setupStreamSocket(env, ourPort);
+    }
     if (ourSocket < 0) break;
 
     // Make sure we have a big send buffer:
@@ -202,7 +414,21 @@ RTSPServer::RTSPServer(UsageEnvironment& env,
     fRTSPServerSocket(ourSocket), fRTSPServerPort(ourPort),
     fHTTPServerSocket(-1), fHTTPServerPort(0), fClientSessionsForHTTPTunneling(NULL),
     fAuthDB(authDatabase), fReclamationTestSeconds(reclamationTestSeconds),
-    fServerMediaSessions(HashTable::create(STRING_HASH_KEYS)) {
+    fServerMediaSessions(HashTable::create(STRING_HASH_KEYS)),
+    fNoncePeriod(-1),
+    fClientSessions(HashTable::create(ONE_WORD_HASH_KEYS)), fNumClientSessionsCreated(0),
+    fStatisticsURLSuffix(NULL), fStatisticsOnlyForLocalClients(True), fLoopLatencyProbeTask(NULL),
+    fNumLoopLatencySamples(0), fLastLoopLatencyUSecs(0), fMaxLoopLatencyUSecs(0),
+    fTotalLoopLatencyUSecs(0) {
+  // Our nonces are derived from a per-server secret, so that they can't be predicted:
+  struct timeval timeNow;
+  gettimeofday(&timeNow, NULL);
+  fNonceSecret[0] = our_random32()^(u_int32_t)timeNow.tv_sec;
+  fNonceSecret[1] = our_random32()^(u_int32_t)timeNow.tv_usec;
+  fNonceSecret[2] = our_random32();
+  fNonceSecret[3] = our_random32();
+  fCurrentNonce[0] = fPreviousNonce[0] = '\0';
+
 #ifdef USE_SIGNALS
   // Ignore the SIGPIPE signal, so that clients on the same host that are killed
   // don't also kill us:
@@ -222,6 +448,16 @@ RTSPServer::~RTSPServer() {
   envir().taskScheduler().turnOffBackgroundReadHandling(fHTTPServerSocket);
   ::closeSocket(fHTTPServerSocket);
 
+  envir().taskScheduler().unscheduleDelayedTask(fLoopLatencyProbeTask);
+  delete[] fStatisticsURLSuffix;
+
+  // Delete any remaining client sessions (each removes itself from "fClientSessions"):
+  RTSPClientSession* clientSession;
+  while ((clientSession = (RTSPClientSession*)fClientSessions->RemoveNext()) != NULL) {
+    delete clientSession;
+  }
+  delete fClientSessions;
+
   delete fClientSessionsForHTTPTunneling;
 
   // Remove all server media sessions (they'll get deleted when they're finished):
@@ -292,6 +528,9 @@ RTSPServer::RTSPClientSession
     fSessionCookie(NULL), fLivenessCheckTask(NULL),
     fIsMulticast(False), fSessionIsActive(True), fStreamAfterSETUP(False),
     fTCPStreamIdCount(0), fNumStreamStates(0), fStreamStates(NULL) {
+  fOurServer.fClientSessions->Add((char const*)this, this);
+  ++fOurServer.fNumClientSessionsCreated;
+
   // Arrange to handle incoming requests:
   resetRequestBuffer();
   envir().taskScheduler().turnOnBackgroundReadHandling(fClientInputSocket,
@@ -300,6 +539,8 @@ RTSPServer::RTSPClientSession
 }
 
 RTSPServer::RTSPClientSession::~RTSPClientSession() {
+  fOurServer.fClientSessions->Remove((char const*)this);
+
   // Turn off any liveness checking:
   envir().taskScheduler().unscheduleDelayedTask(fLivenessCheckTask);
 
@@ -341,7 +582,19 @@ void RTSPServer::RTSPClientSession::resetRequestBuffer() {
   fRequestBytesAlreadySeen = 0;
   fRequestBufferBytesLeft = sizeof fRequestBuffer;
   fLastCRLF = &fRequestBuffer[-3]; // hack
-  fBase64RemainderCount = 0;
+  fRequestHeaders.reset();
+  // Note: We don't reset "fBase64Decoder", because a Base64-encoded quad (if we're tunneling)
+  // might span two requests.
+}
+
+char const* RTSPServer::RTSPClientSession
+::lookupHeader(char const* fullRequestStr, char const* headerName) const {
+  if (fullRequestStr == (char const*)fRequestBuffer && fRequestHeaders.isComplete()) {
+    // This is the request that we've just received (and indexed):
+    return fRequestHeaders.lookup(fullRequestStr, headerName);
+  }
+
+  return findHeaderByScanning(fullRequestStr, headerName);
 }
 
 void RTSPServer::RTSPClientSession::incomingRequestHandler(void* instance, int /*mask*/) {
@@ -352,6 +605,15 @@ void RTSPServer::RTSPClientSession::incomingRequestHandler(void* instance, int /
 void RTSPServer::RTSPClientSession::incomingRequestHandler1() {
   struct sockaddr_in dummy; // 'from' address, meaningless in this case
 
+  if (fClientOutputSocket != fClientInputSocket) {
+    // We're doing RTSP-over-HTTP tunneling.  Read the (Base64-encoded) data into a separate buffer,
+    // from which it gets decoded into our request buffer:
+    char encodedBytes[RTSP_BUFFER_SIZE];
+    int bytesRead = readSocket(envir(), fClientInputSocket, (unsigned char*)encodedBytes, fRequestBufferBytesLeft, dummy);
+    handleTunneledRequestBytes(encodedBytes, bytesRead);
+    return;
+  }
+
   int bytesRead = readSocket(envir(), fClientInputSocket, &fRequestBuffer[fRequestBytesAlreadySeen], fRequestBufferBytesLeft, dummy);
   handleRequestBytes(bytesRead);
 }
@@ -364,10 +626,42 @@ void RTSPServer::RTSPClientSession::handleAlternativeRequestByte(void* instance,
 void RTSPServer::RTSPClientSession::handleAlternativeRequestByte1(u_int8_t requestByte) {
   // Add this character to our buffer; then try to handle the data that we have buffered so far:
   if (fRequestBufferBytesLeft == 0|| fRequestBytesAlreadySeen >= RTSP_BUFFER_SIZE) return;
+  if (fClientOutputSocket != fClientInputSocket) {
+    handleTunneledRequestBytes((char const*)&requestByte, 1);
+    return;
+  }
   fRequestBuffer[fRequestBytesAlreadySeen] = requestByte;
   handleRequestBytes(1);
 }
 
+void RTSPServer::RTSPClientSession
+::handleTunneledRequestBytes(char const* encodedBytes, int numEncodedBytes) {
+  if (numEncodedBytes <= 0) {
+    handleRequestBytes(numEncodedBytes); // the client socket has died
+    return;
+  }
+
+  unsigned const maxDecodedSize = 3*((fBase64Decoder.numPendingChars() + numEncodedBytes)/4);
+  if (maxDecodedSize >= fRequestBufferBytesLeft) {
+    handleRequestBytes(maxDecodedSize); // the request is too big for us
+    return;
+  }
+
+  // Decode as much of the new data as we can (i.e., up to a multiple of 4 bytes, including any
+  // that were left over from before).  Any remainder is kept by "fBase64Decoder":
+  unsigned decodedSize
+    = fBase64Decoder.decode(&fRequestBuffer[fRequestBytesAlreadySeen], encodedBytes, numEncodedBytes);
+#ifdef DEBUG
+  fprintf(stderr, "Base64-decoded %d input bytes into %d new bytes\n", numEncodedBytes, decodedSize);
+#endif
+  if (decodedSize == 0) { // we need more input bytes to complete a quad
+    noteLiveness();
+    return;
+  }
+
+  handleRequestBytes(decodedSize);
+}
+
 void RTSPServer::RTSPClientSession::handleRequestBytes(int newBytesRead) {
   noteLiveness();
 
@@ -388,35 +682,7 @@ void RTSPServer::RTSPClientSession::handleRequestBytes(int newBytesRead) {
   fprintf(stderr, "RTSPClientSession[%p]::handleRequestBytes() read %d new bytes:%s\n", this, newBytesRead, ptr);
 #endif
 
-  if (fClientOutputSocket != fClientInputSocket) {
-    // We're doing RTSP-over-HTTP tunneling, and input commands are assumed to have been Base64-encoded.
-    // We therefore Base64-decode as much of this new data as we can (i.e., up to a multiple of 4 bytes):
-    unsigned numBytesToDecode = fBase64RemainderCount + newBytesRead;
-    unsigned newBase64RemainderCount = numBytesToDecode%4;
-    numBytesToDecode -= newBase64RemainderCount;
-    if (numBytesToDecode > 0) {
-      ptr[newBytesRead] = '\0';
-      unsigned decodedSize;
-      unsigned char* decodedBytes = base64Decode((char*)(ptr-fBase64RemainderCount), decodedSize);
-#ifdef DEBUG
-      fprintf(stderr, "Base64-decided %d input bytes into %d new bytes:", numBytesToDecode, decodedSize);
-      for (unsigned k = 0; k < decodedSize; ++k) fprintf(stderr, "%c", decodedBytes[k]);
-      fprintf(stderr, "\n");
-#endif
-
-      // Copy the new decoded bytes in place of the old ones (we can do this because there are fewer decoded bytes than original):
-      unsigned char* to = ptr-fBase64RemainderCount;
-      for (unsigned i = 0; i < decodedSize; ++i) *to++ = decodedBytes[i];
-      
-      // Then copy any remaining (undecoded) bytes to the end:
-      for (unsigned j = 0; j < newBase64RemainderCount; ++j) *to++ = (ptr-fBase64RemainderCount+numBytesToDecode)[j];
-
-      newBytesRead = decodedSize + newBase64RemainderCount; // adjust to allow for the size of the new decoded data (+ remainder)
-      delete[] decodedBytes;
-    }
-    fBase64RemainderCount = newBase64RemainderCount;
-    if (fBase64RemainderCount > 0) return; // because we know that we have more input bytes still to receive
-  }
+  // (If we're doing RTSP-over-HTTP tunneling, then the new data has already been Base64-decoded.)
 
   // Look for the end of the message: <CR><LF><CR><LF>
   unsigned char *tmpPtr = ptr;
@@ -428,6 +694,9 @@ void RTSPServer::RTSPClientSession::handleRequestBytes(int newBytesRead) {
 	endOfMsg = True;
 	break;
       }
+      // Index this (now complete) line, so that its header needn't be searched for later:
+      unsigned lineStart = fLastCRLF < fRequestBuffer ? 0 : (fLastCRLF+2) - fRequestBuffer;
+      fRequestHeaders.noteLine((char const*)fRequestBuffer, lineStart, tmpPtr - fRequestBuffer);
       fLastCRLF = tmpPtr;
     }
     ++tmpPtr;
@@ -489,6 +758,9 @@ void RTSPServer::RTSPClientSession::handleRequestBytes(int newBytesRead) {
 	// then this is a bad tunneling request.  Otherwise, assume that it's an attempt to access the stream via HTTP.
 	if (strcmp(acceptStr, "application/x-rtsp-tunnelled") == 0) {
 	  isValidHTTPCmd = False;
+	} else if (fOurServer.fStatisticsURLSuffix != NULL && strcmp(cmdName, "GET") == 0
+		   && strcmp(urlSuffix, fOurServer.fStatisticsURLSuffix) == 0) {
+	  handleHTTPCmd_Statistics();
 	} else {
 	  handleHTTPCmd_StreamingGET(urlSuffix, (char const*)fRequestBuffer);
 	}
@@ -521,7 +793,10 @@ void RTSPServer::RTSPClientSession::handleRequestBytes(int newBytesRead) {
 #ifdef DEBUG
   fprintf(stderr, "sending response: %s", fResponseBuffer);
 #endif
-  send(fClientOutputSocket, (char const*)fResponseBuffer, strlen((char*)fResponseBuffer), 0);
+  // (If this socket is also carrying RTP/RTCP-over-TCP, then the response gets queued
+  // behind any packet data that's waiting to be written, rather than being interleaved with it.)
+  RTPInterface::sendDataOverTCP(envir(), fClientOutputSocket,
+				fResponseBuffer, strlen((char*)fResponseBuffer));
 
   if (strcmp(cmdName, "SETUP") == 0 && fStreamAfterSETUP) {
     // The client has asked for streaming to commence now, rather than after a
@@ -538,14 +813,21 @@ void RTSPServer::RTSPClientSession::handleRequestBytes(int newBytesRead) {
 
 // Generate a "Date:" header for use in a RTSP response:
 static char const* dateHeader() {
+#if defined(__GNUC__) && defined(__linux__)
+  // Several servers may be running in separate threads, so use per-thread state:
+  static __thread char buf[200];
+  time_t tt = time(NULL);
+  struct tm tmBuf;
+  strftime(buf, sizeof buf, "Date: %a, %b %d %Y %H:%M:%S GMT\r\n", gmtime_r(&tt, &tmBuf));
+#elif !defined(_WIN32_WCE)
   static char buf[200];
-#if !defined(_WIN32_WCE)
   time_t tt = time(NULL);
   strftime(buf, sizeof buf, "Date: %a, %b %d %Y %H:%M:%S GMT\r\n", gmtime(&tt));
 #else
   // WinCE apparently doesn't have "time()", "strftime()", or "gmtime()",
   // so generate the "Date:" header a different, WinCE-specific way.
   // (Thanks to Pierre l'Hussiez for this code)
+  static char buf[200];
   SYSTEMTIME SystemTime;
   GetSystemTime(&SystemTime);
   WCHAR dateFormat[] = L"ddd, MMM dd yyyy";
@@ -664,7 +946,7 @@ typedef enum StreamingMode {
   RAW_UDP
 } StreamingMode;
 
-static void parseTransportHeader(char const* buf,
+static void parseTransportHeader(char const* fields, // the "Transport:" header's value, or NULL
 				 StreamingMode& streamingMode,
 				 char*& streamingModeString,
 				 char*& destinationAddressStr,
@@ -686,15 +968,9 @@ static void parseTransportHeader(char const* buf,
   portNumBits p1, p2;
   unsigned ttl, rtpCid, rtcpCid;
 
-  // First, find "Transport:"
-  while (1) {
-    if (*buf == '\0') return; // not found
-    if (_strncasecmp(buf, "Transport: ", 11) == 0) break;
-    ++buf;
-  }
+  if (fields == NULL) return; // there was no "Transport:" header
 
-  // Then, run through each of the fields, looking for ones we handle:
-  char const* fields = buf + 11;
+  // Run through each of the fields, looking for ones we handle:
   char* field = strDupSize(fields);
   while (sscanf(fields, "%[^;]", field) == 1) {
     if (strcmp(field, "RTP/AVP/TCP") == 0) {
@@ -726,17 +1002,6 @@ static void parseTransportHeader(char const* buf,
   delete[] field;
 }
 
-static Boolean parsePlayNowHeader(char const* buf) {
-  // Find "x-playNow:" header, if present
-  while (1) {
-    if (*buf == '\0') return False; // not found
-    if (_strncasecmp(buf, "x-playNow:", 10) == 0) break;
-    ++buf;
-  }
-
-  return True;
-}
-
 void RTSPServer::RTSPClientSession
 ::handleCmd_SETUP(char const* cseq,
 		  char const* urlPreSuffix, char const* urlSuffix,
@@ -818,7 +1083,7 @@ void RTSPServer::RTSPClientSession
   u_int8_t clientsDestinationTTL;
   portNumBits clientRTPPortNum, clientRTCPPortNum;
   unsigned char rtpChannelId, rtcpChannelId;
-  parseTransportHeader(fullRequestStr, streamingMode, streamingModeString,
+  parseTransportHeader(lookupHeader(fullRequestStr, "Transport"), streamingMode, streamingModeString,
 		       clientsDestinationAddressStr, clientsDestinationTTL,
 		       clientRTPPortNum, clientRTCPPortNum,
 		       rtpChannelId, rtcpChannelId);
@@ -839,8 +1104,9 @@ void RTSPServer::RTSPClientSession
   // Next, check whether a "Range:" header is present in the request.
   // This isn't legal, but some clients do this to combine "SETUP" and "PLAY":
   double rangeStart = 0.0, rangeEnd = 0.0;
-  fStreamAfterSETUP = parseRangeHeader(fullRequestStr, rangeStart, rangeEnd) ||
-                      parsePlayNowHeader(fullRequestStr);
+  char const* rangeValue = lookupHeader(fullRequestStr, "Range");
+  fStreamAfterSETUP = (rangeValue != NULL && parseRangeParam(rangeValue, rangeStart, rangeEnd)) ||
+                      lookupHeader(fullRequestStr, "x-playNow") != NULL;
 
   // Then, get server parameters from the 'subsession':
   int tcpSocketNum = streamingMode == RTP_TCP ? fClientOutputSocket : -1;
@@ -1026,20 +1292,12 @@ void RTSPServer::RTSPClientSession
   fSessionIsActive = False; // triggers deletion of ourself after responding
 }
 
-static Boolean parseScaleHeader(char const* buf, float& scale) {
+static Boolean parseScaleHeader(char const* fields, // the "Scale:" header's value, or NULL
+				float& scale) {
   // Initialize the result parameter to a default value:
   scale = 1.0;
+  if (fields == NULL) return False; // there was no "Scale:" header
 
-  // First, find "Scale:"
-  while (1) {
-    if (*buf == '\0') return False; // not found
-    if (_strncasecmp(buf, "Scale: ", 7) == 0) break;
-    ++buf;
-  }
-
-  // Then, run through each of the fields, looking for ones we handle:
-  char const* fields = buf + 7;
-  while (*fields == ' ') ++fields;
   float sc;
   if (sscanf(fields, "%f", &sc) == 1) {
     scale = sc;
@@ -1058,7 +1316,7 @@ void RTSPServer::RTSPClientSession
 
   // Parse the client's "Scale:" header, if any:
   float scale;
-  Boolean sawScaleHeader = parseScaleHeader(fullRequestStr, scale);
+  Boolean sawScaleHeader = parseScaleHeader(lookupHeader(fullRequestStr, "Scale"), scale);
 
   // Try to set the stream's scale factor to this value:
   if (subsession == NULL /*aggregate op*/) {
@@ -1078,7 +1336,8 @@ void RTSPServer::RTSPClientSession
 
   // Parse the client's "Range:" header, if any:
   double rangeStart = 0.0, rangeEnd = 0.0;
-  Boolean sawRangeHeader = parseRangeHeader(fullRequestStr, rangeStart, rangeEnd);
+  char const* rangeValue = lookupHeader(fullRequestStr, "Range");
+  Boolean sawRangeHeader = rangeValue != NULL && parseRangeParam(rangeValue, rangeStart, rangeEnd);
 
   // Use this information, plus the stream's duration (if known), to create
   // our own "Range:" header, for the response:
@@ -1379,7 +1638,40 @@ void RTSPServer::RTSPClientSession::handleHTTPCmd_StreamingGET(char const* /*url
   handleHTTPCmd_notSupported();
 }
 
-static Boolean parseAuthorizationHeader(char const* buf,
+void RTSPServer::RTSPClientSession::handleHTTPCmd_Statistics() {
+  if (fOurServer.fStatisticsOnlyForLocalClients
+      && (ntohl(fClientAddr.sin_addr.s_addr)>>24) != 127) {
+    snprintf((char*)fResponseBuffer, sizeof fResponseBuffer,
+	     "HTTP/1.0 403 Forbidden\r\n%s\r\n\r\n",
+	     dateHeader());
+    return;
+  }
+
+  // The report can be larger than "fResponseBuffer", so we send it ourself:
+  char* report = fOurServer.statisticsReport();
+  unsigned const reportSize = strlen(report);
+  char header[200];
+  snprintf(header, sizeof header,
+	   "HTTP/1.0 200 OK\r\n"
+	   "%s"
+	   "Cache-Control: no-cache\r\n"
+	   "Content-Type: application/json\r\n"
+	   "Content-Length: %u\r\n"
+	   "\r\n",
+	   dateHeader(), reportSize);
+
+  // We close the connection after this response, so block (rather than lose data)
+  // if the report doesn't all fit in the socket's buffer:
+  makeSocketBlocking(fClientOutputSocket);
+  send(fClientOutputSocket, header, strlen(header), 0);
+  send(fClientOutputSocket, report, reportSize, 0);
+  delete[] report;
+
+  fResponseBuffer[0] = '\0'; // we've already responded
+  fSessionIsActive = False; // triggers deletion of ourself (after we return)
+}
+
+static Boolean parseAuthorizationHeader(char const* fields, // the "Authorization:" header's value, or NULL
 					char const*& username,
 					char const*& realm,
 					char const*& nonce, char const*& uri,
@@ -1387,15 +1679,11 @@ static Boolean parseAuthorizationHeader(char const* buf,
   // Initialize the result parameters to default values:
   username = realm = nonce = uri = response = NULL;
 
-  // First, find "Authorization:"
-  while (1) {
-    if (*buf == '\0') return False; // not found
-    if (_strncasecmp(buf, "Authorization: Digest ", 22) == 0) break;
-    ++buf;
-  }
+  // We handle only "Digest" authorization:
+  if (fields == NULL || _strncasecmp(fields, "Digest ", 7) != 0) return False;
 
-  // Then, run through each of the fields, looking for ones we handle:
-  char const* fields = buf + 22;
+  // Run through each of the fields, looking for ones we handle:
+  fields += 7;
   while (*fields == ' ') ++fields;
   char* parameter = strDupSize(fields);
   char* value = strDupSize(fields);
@@ -1448,38 +1736,29 @@ Boolean RTSPServer::RTSPClientSession
   Boolean success = False;
 
   do {
-    // To authenticate, we first need to have a nonce set up
-    // from a previous attempt:
-    if (fCurrentAuthenticator.nonce() == NULL) break;
-
-    // Next, the request needs to contain an "Authorization:" header,
-    // containing a username, (our) realm, (our) nonce, uri,
-    // and response string:
-    if (!parseAuthorizationHeader(fullRequestStr,
+    // The request needs to contain an "Authorization:" header, containing a
+    // username, (our) realm, (a recent) nonce, uri, and response string.
+    // (Because our nonces aren't specific to a connection, a client that has
+    // reconnected can reuse the nonce that it was given before.)
+    if (!parseAuthorizationHeader(lookupHeader(fullRequestStr, "Authorization"),
 				  username, realm, nonce, uri, response)
 	|| username == NULL
-	|| realm == NULL || strcmp(realm, fCurrentAuthenticator.realm()) != 0
-	|| nonce == NULL || strcmp(nonce, fCurrentAuthenticator.nonce()) != 0
+	|| realm == NULL || strcmp(realm, fOurServer.fAuthDB->realm()) != 0
+	|| nonce == NULL || !fOurServer.nonceIsValid(nonce)
 	|| uri == NULL || response == NULL) {
       break;
     }
 
     // Next, the username has to be known to us:
-    char const* password = fOurServer.fAuthDB->lookupPassword(username);
-#ifdef DEBUG
-    fprintf(stderr, "lookupPassword(%s) returned password %s\n", username, password);
-#endif
-    if (password == NULL) break;
-    fCurrentAuthenticator.
-      setUsernameAndPassword(username, password,
-			     fOurServer.fAuthDB->passwordsAreMD5());
+    char const* ha1 = fOurServer.fAuthDB->lookupHA1(username);
+    if (ha1 == NULL) break;
 
     // Finally, compute a digest response from the information that we have,
     // and compare it to the one that we were given:
     char const* ourResponse
-      = fCurrentAuthenticator.computeDigestResponse(cmdName, uri);
+      = Authenticator::computeDigestResponse(ha1, nonce, cmdName, uri);
     success = (strcmp(ourResponse, response) == 0);
-    fCurrentAuthenticator.reclaimDigestResponse(ourResponse);
+    free((char*)ourResponse); // see "Authenticator::reclaimDigestResponse()"
   } while (0);
 
   delete[] (char*)username; delete[] (char*)realm; delete[] (char*)nonce;
@@ -1487,8 +1766,7 @@ Boolean RTSPServer::RTSPClientSession
   if (success) return True;
 
   // If we get here, there was some kind of authentication failure.
-  // Send back a "401 Unauthorized" response, with a new random nonce:
-  fCurrentAuthenticator.setRealmAndRandomNonce(fOurServer.fAuthDB->realm());
+  // Send back a "401 Unauthorized" response, with our current nonce:
   snprintf((char*)fResponseBuffer, sizeof fResponseBuffer,
 	   "RTSP/1.0 401 Unauthorized\r\n"
 	   "CSeq: %s\r\n"
@@ -1496,7 +1774,7 @@ Boolean RTSPServer::RTSPClientSession
 	   "WWW-Authenticate: Digest realm=\"%s\", nonce=\"%s\"\r\n\r\n",
 	   cseq,
 	   dateHeader(),
-	   fCurrentAuthenticator.realm(), fCurrentAuthenticator.nonce());
+	   fOurServer.fAuthDB->realm(), fOurServer.currentNonce());
   return False;
 }
 
@@ -1539,13 +1817,10 @@ void RTSPServer::RTSPClientSession
   envir().taskScheduler().turnOnBackgroundReadHandling(fClientInputSocket,
      (TaskScheduler::BackgroundHandlerProc*)&incomingRequestHandler, this);
 
-  // Also write any extra data to our buffer, and handle it:
-  if (extraDataSize > 0 && extraDataSize <= fRequestBufferBytesLeft/*sanity check; should always be true*/) {
-    unsigned char* ptr = &fRequestBuffer[fRequestBytesAlreadySeen];
-    for (unsigned i = 0; i < extraDataSize; ++i) {
-      ptr[i] = extraData[i];
-    }
-    handleRequestBytes(extraDataSize);
+  // Also decode any extra data into our buffer, and handle it.  (We're now tunneling, so this data
+  // is Base64-encoded.)
+  if (extraDataSize > 0) {
+    handleTunneledRequestBytes((char const*)extraData, extraDataSize);
   }
 }
 
@@ -1575,26 +1850,67 @@ ServerMediaSession* RTSPServer::ServerMediaSessionIterator::next() {
 UserAuthenticationDatabase::UserAuthenticationDatabase(char const* realm,
 						       Boolean passwordsAreMD5)
   : fTable(HashTable::create(STRING_HASH_KEYS)),
+    fHA1Table(HashTable::create(STRING_HASH_KEYS)),
     fRealm(strDup(realm == NULL ? "LIVE555 Streaming Media" : realm)),
     fPasswordsAreMD5(passwordsAreMD5) {
 }
 
+// A cached "lookupHA1()" result, along with the password that it was computed from:
+class HA1Record {
+public:
+  HA1Record(char const* password) : fPassword(strDup(password)) {}
+  ~HA1Record() { delete[] fPassword; }
+
+  char* fPassword;
+  char fHA1[33];
+};
+
 UserAuthenticationDatabase::~UserAuthenticationDatabase() {
   delete[] fRealm;
   delete fTable;
+
+  HA1Record* ha1Record;
+  while ((ha1Record = (HA1Record*)fHA1Table->RemoveNext()) != NULL) {
+    delete ha1Record;
+  }
+  delete fHA1Table;
 }
 
 void UserAuthenticationDatabase::addUserRecord(char const* username,
 					       char const* password) {
   fTable->Add(username, (void*)(strDup(password)));
+      // (Any cached HA1 for this user gets recomputed, because the password no longer matches.)
 }
 
 void UserAuthenticationDatabase::removeUserRecord(char const* username) {
   char* password = (char*)(fTable->Lookup(username));
   fTable->Remove(username);
   delete[] password;
+
+  HA1Record* ha1Record = (HA1Record*)(fHA1Table->Lookup(username));
+  fHA1Table->Remove(username);
+  delete ha1Record;
 }
 
 char const* UserAuthenticationDatabase::lookupPassword(char const* username) {
   return (char const*)(fTable->Lookup(username));
 }
+
+char const* UserAuthenticationDatabase::lookupHA1(char const* username) {
+  char const* password = lookupPassword(username);
+  if (password == NULL) return NULL;
+  if (fPasswordsAreMD5) return password; // it's already md5(<username>:<realm>:<actual-password>)
+
+  HA1Record* ha1Record = (HA1Record*)(fHA1Table->Lookup(username));
+  if (ha1Record != NULL && strcmp(ha1Record->fPassword, password) == 0) {
+    return ha1Record->fHA1; // common case
+  }
+
+  // Compute (and cache) a new HA1 for this user:
+  delete ha1Record;
+  ha1Record = new HA1Record(password);
+  Authenticator::computeHA1(username, fRealm, password, ha1Record->fHA1);
+  fHA1Table->Add(username, ha1Record);
+
+  return ha1Record->fHA1;
+}
@@ -0,0 +1,309 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// Probes many "rtsp://" URLs (using "DESCRIBE") concurrently, with a bounded number of
+// probes in flight, reusing each server's TCP connection for later URLs on that server.
+// Implementation
+
+#include "RTSPURLProber.hh"
+#include <GroupsockHelper.hh> // for "ETIMEDOUT" etc.
+
+////////// ProbeRecord //////////
+
+class ProbeRecord {
+public:
+  ProbeRecord(char const* rtspURL, RTSPURLProber::completionFunc* func, void* clientData)
+    : fNext(NULL), fURL(strDup(rtspURL)), fFunc(func), fClientData(clientData),
+      fHasBeenRetried(False) {
+  }
+  virtual ~ProbeRecord() { delete[] fURL; }
+
+  ProbeRecord* fNext;
+  char* fURL;
+  RTSPURLProber::completionFunc* fFunc;
+  void* fClientData;
+  Boolean fHasBeenRetried;
+};
+
+////////// ProbingRTSPClient //////////
+
+class ProbingRTSPClient: public RTSPClient {
+public:
+  ProbingRTSPClient(RTSPURLProber& prober, char const* rtspURL,
+		    unsigned serverAddress, portNumBits serverPortNum)
+    : RTSPClient(prober.envir(), rtspURL, prober.fVerbosityLevel, prober.fApplicationName, 0),
+      fProber(prober), fNext(NULL), fProbe(NULL), fTimeoutTask(NULL),
+      fProbeServerAddress(serverAddress), fProbeServerPortNum(serverPortNum),
+      fDescribeCSeq(0), fConnectionWasReused(False) {
+  }
+  virtual ~ProbingRTSPClient() {
+    envir().taskScheduler().unscheduleDelayedTask(fTimeoutTask);
+    delete fProbe;
+  }
+
+  void startProbe(ProbeRecord* probe, Boolean isNewClient) {
+    fProbe = probe;
+    fConnectionWasReused = !isNewClient && changeURL(probe->fURL);
+    if (fProber.fTimeoutSeconds > 0) {
+      fTimeoutTask = envir().taskScheduler()
+	.scheduleDelayedTask(fProber.fTimeoutSeconds*1000000, timeoutHandler, this);
+    }
+    fDescribeCSeq = sendDescribeCommand(describeResponseHandler);
+  }
+
+  ProbeRecord* takeProbe() {
+    envir().taskScheduler().unscheduleDelayedTask(fTimeoutTask);
+    ProbeRecord* probe = fProbe;
+    fProbe = NULL;
+    return probe;
+  }
+
+private:
+  static void describeResponseHandler(RTSPClient* rtspClient, int resultCode, char* resultString) {
+    ProbingRTSPClient* client = (ProbingRTSPClient*)rtspClient;
+    client->fProber.probeCompleted(client, resultCode, resultString);
+  }
+
+  static void timeoutHandler(void* clientData) {
+    ProbingRTSPClient* client = (ProbingRTSPClient*)clientData;
+    client->fTimeoutTask = NULL;
+    client->changeResponseHandler(client->fDescribeCSeq, NULL); // in case the response arrives before we close the client
+    client->envir().setResultMsg("RTSP probe timed out");
+    client->fProber.probeCompleted(client, -ETIMEDOUT, strDup(client->envir().getResultMsg()));
+  }
+
+public:
+  RTSPURLProber& fProber;
+  ProbingRTSPClient* fNext;
+  ProbeRecord* fProbe;
+  TaskToken fTimeoutTask;
+  unsigned fProbeServerAddress;
+  portNumBits fProbeServerPortNum;
+  unsigned fDescribeCSeq;
+  Boolean fConnectionWasReused;
+};
+
+////////// RTSPURLProber //////////
+
+RTSPURLProber* RTSPURLProber::createNew(UsageEnvironment& env,
+					unsigned maxNumProbesInFlight,
+					unsigned timeoutSeconds,
+					int verbosityLevel,
+					char const* applicationName) {
+  return new RTSPURLProber(env, maxNumProbesInFlight, timeoutSeconds,
+			   verbosityLevel, applicationName);
+}
+
+RTSPURLProber::RTSPURLProber(UsageEnvironment& env, unsigned maxNumProbesInFlight,
+			     unsigned timeoutSeconds, int verbosityLevel,
+			     char const* applicationName)
+  : Medium(env),
+    fMaxNumProbesInFlight(maxNumProbesInFlight == 0 ? 1 : maxNumProbesInFlight),
+    fTimeoutSeconds(timeoutSeconds), fVerbosityLevel(verbosityLevel),
+    fApplicationName(strDup(applicationName)),
+    fQueueHead(NULL), fQueueTail(NULL), fNumProbesQueued(0),
+    fActiveClients(NULL), fNumProbesInFlight(0),
+    fIdleClients(NULL), fNumIdleClients(0), fClientsToClose(NULL), fStartTask(NULL) {
+}
+
+RTSPURLProber::~RTSPURLProber() {
+  cancelAllProbes();
+  envir().taskScheduler().unscheduleDelayedTask(fStartTask);
+  closeFailedClients();
+
+  while (fIdleClients != NULL) {
+    ProbingRTSPClient* client = fIdleClients;
+    fIdleClients = client->fNext;
+    Medium::close(client);
+  }
+
+  delete[] fApplicationName;
+}
+
+void RTSPURLProber::probeURL(char const* rtspURL, completionFunc* func, void* clientData) {
+  ProbeRecord* probe = new ProbeRecord(rtspURL, func, clientData);
+  if (fQueueTail == NULL) {
+    fQueueHead = fQueueTail = probe;
+  } else {
+    fQueueTail->fNext = probe;
+    fQueueTail = probe;
+  }
+  ++fNumProbesQueued;
+
+  scheduleQueuedProbes();
+}
+
+void RTSPURLProber::cancelAllProbes() {
+  envir().taskScheduler().unscheduleDelayedTask(fStartTask);
+
+  while (fQueueHead != NULL) {
+    ProbeRecord* probe = fQueueHead;
+    fQueueHead = probe->fNext;
+    delete probe;
+  }
+  fQueueTail = NULL;
+  fNumProbesQueued = 0;
+
+  // We don't know what state the connections of any probes in flight are in, so close them:
+  while (fActiveClients != NULL) {
+    ProbingRTSPClient* client = fActiveClients;
+    fActiveClients = client->fNext;
+    Medium::close(client);
+  }
+  fNumProbesInFlight = 0;
+
+  scheduleQueuedProbes(); // if we still have failed clients to close
+}
+
+void RTSPURLProber::scheduleQueuedProbes() {
+  if (fStartTask == NULL && (fNumProbesQueued > 0 || fClientsToClose != NULL)) {
+    fStartTask = envir().taskScheduler().scheduleDelayedTask(0, startQueuedProbes, this);
+  }
+}
+
+void RTSPURLProber::startQueuedProbes(void* clientData) {
+  RTSPURLProber* prober = (RTSPURLProber*)clientData;
+  prober->fStartTask = NULL;
+  prober->startQueuedProbes1();
+}
+
+void RTSPURLProber::startQueuedProbes1() {
+  closeFailedClients();
+
+  while (fQueueHead != NULL && fNumProbesInFlight < fMaxNumProbesInFlight) {
+    ProbeRecord* probe = fQueueHead;
+    fQueueHead = probe->fNext;
+    if (fQueueHead == NULL) fQueueTail = NULL;
+    probe->fNext = NULL;
+    --fNumProbesQueued;
+
+    startProbe(probe);
+  }
+}
+
+void RTSPURLProber::startProbe(ProbeRecord* probe) {
+  char* username;
+  char* password;
+  NetAddress destAddress;
+  portNumBits urlPortNum;
+  if (!RTSPClient::parseRTSPURL(envir(), probe->fURL, username, password, destAddress, urlPortNum)) {
+    if (probe->fFunc != NULL) {
+      (*probe->fFunc)(probe->fClientData, probe->fURL, -EINVAL, strDup(envir().getResultMsg()));
+    }
+    delete probe;
+    return;
+  }
+  delete[] username; delete[] password; // the client will parse them again
+  unsigned const serverAddress = *(unsigned*)(destAddress.data());
+
+  // Use an idle client - with a connection to the same server - if we have one:
+  ProbingRTSPClient* client = takeIdleClient(serverAddress, urlPortNum);
+  Boolean const isNewClient = client == NULL;
+  if (isNewClient) client = new ProbingRTSPClient(*this, probe->fURL, serverAddress, urlPortNum);
+
+  client->fNext = fActiveClients;
+  fActiveClients = client;
+  ++fNumProbesInFlight;
+
+  client->startProbe(probe, isNewClient); // note: this might complete the probe immediately
+}
+
+void RTSPURLProber::probeCompleted(ProbingRTSPClient* client, int resultCode, char* resultString) {
+  removeActiveClient(client);
+  ProbeRecord* probe = client->takeProbe();
+
+  if (resultCode < 0) {
+    // A network error (or timeout); the client's connection is no longer usable.  Close the client
+    // later (from the event loop), because we may be being called from within it:
+    client->fNext = fClientsToClose;
+    fClientsToClose = client;
+
+    if (client->fConnectionWasReused && resultCode != -ETIMEDOUT && !probe->fHasBeenRetried) {
+      // The server probably closed the (idle) connection that we reused.  Try once more, using a new connection:
+      delete[] resultString;
+      probe->fHasBeenRetried = True;
+      probe->fNext = fQueueHead;
+      fQueueHead = probe;
+      if (fQueueTail == NULL) fQueueTail = probe;
+      ++fNumProbesQueued;
+      scheduleQueuedProbes();
+      return;
+    }
+  } else {
+    makeIdle(client);
+  }
+  scheduleQueuedProbes();
+
+  if (probe->fFunc != NULL) {
+    (*probe->fFunc)(probe->fClientData, probe->fURL, resultCode, resultString);
+  } else {
+    delete[] resultString;
+  }
+  delete probe;
+}
+
+void RTSPURLProber::removeActiveClient(ProbingRTSPClient* client) {
+  for (ProbingRTSPClient** ptr = &fActiveClients; *ptr != NULL; ptr = &((*ptr)->fNext)) {
+    if (*ptr == client) {
+      *ptr = client->fNext;
+      client->fNext = NULL;
+      --fNumProbesInFlight;
+      return;
+    }
+  }
+}
+
+void RTSPURLProber::makeIdle(ProbingRTSPClient* client) {
+  client->fNext = fIdleClients;
+  fIdleClients = client;
+  ++fNumIdleClients;
+
+  // Don't keep more idle connections than the number of probes that we allow in flight;
+  // close the least recently used one(s):
+  if (fNumIdleClients > fMaxNumProbesInFlight) {
+    ProbingRTSPClient** ptr = &fIdleClients;
+    for (unsigned i = 0; i < fMaxNumProbesInFlight; ++i) ptr = &((*ptr)->fNext);
+    while (*ptr != NULL) {
+      ProbingRTSPClient* oldClient = *ptr;
+      *ptr = oldClient->fNext;
+      Medium::close(oldClient);
+      --fNumIdleClients;
+    }
+  }
+}
+
+void RTSPURLProber::closeFailedClients() {
+  while (fClientsToClose != NULL) {
+    ProbingRTSPClient* client = fClientsToClose;
+    fClientsToClose = client->fNext;
+    Medium::close(client);
+  }
+}
+
+ProbingRTSPClient* RTSPURLProber::takeIdleClient(unsigned serverAddress, portNumBits serverPortNum) {
+  for (ProbingRTSPClient** ptr = &fIdleClients; *ptr != NULL; ptr = &((*ptr)->fNext)) {
+    ProbingRTSPClient* client = *ptr;
+    if (client->fProbeServerAddress == serverAddress && client->fProbeServerPortNum == serverPortNum) {
+      *ptr = client->fNext;
+      client->fNext = NULL;
+      --fNumIdleClients;
+      return client;
+    }
+  }
+
+  return NULL;
+}
@@ -0,0 +1,173 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A cache of the (expensive to compute) 'aux' SDP lines of file-based
+// server media subsessions.
+// Implementation
+
+#include "SDPCache.hh"
+#include "HashTable.hh"
+#include "Base64.hh"
+#include <strDup.hh>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// Each line of the cache file has the form
+//     <modification-time> <file-size> <track-id> <Base64-encoded aux SDP line, or "-"> <file-name>
+// (The file name comes last, because it may contain spaces.)  Later lines override earlier ones.
+#define SDP_CACHE_MAX_LINE_SIZE 4096
+
+class SDPCache::SDPCacheEntry {
+public:
+  SDPCacheEntry(long modificationTime, u_int64_t fileSize, char const* auxSDPLine)
+    : fModificationTime(modificationTime), fFileSize(fileSize), fAuxSDPLine(strDup(auxSDPLine)) {
+  }
+  virtual ~SDPCacheEntry() { delete[] fAuxSDPLine; }
+
+  long fModificationTime;
+  u_int64_t fFileSize;
+  char* fAuxSDPLine;
+};
+
+SDPCache::SDPCache(char const* cacheFileName)
+  : fTable(HashTable::create(STRING_HASH_KEYS)), fCacheFileName(strDup(cacheFileName)),
+    fNumHits(0), fNumMisses(0) {
+  loadFromFile();
+}
+
+SDPCache::~SDPCache() {
+  SDPCacheEntry* entry;
+  while ((entry = (SDPCacheEntry*)fTable->RemoveNext()) != NULL) {
+    delete entry;
+  }
+  delete fTable;
+  delete[] fCacheFileName;
+}
+
+char const* SDPCache::lookup(char const* fileName, char const* trackId) {
+  char* key = makeKey(fileName, trackId);
+  SDPCacheEntry* entry = (SDPCacheEntry*)fTable->Lookup(key);
+
+  long modificationTime; u_int64_t fileSize;
+  if (entry != NULL
+      && (!getFileStamp(fileName, modificationTime, fileSize)
+	  || modificationTime != entry->fModificationTime || fileSize != entry->fFileSize)) {
+    // The file has changed (or gone away) since we cached its SDP line:
+    fTable->Remove(key);
+    delete entry; entry = NULL;
+  }
+  delete[] key;
+
+  if (entry == NULL) {
+    ++fNumMisses;
+    return NULL;
+  }
+  ++fNumHits;
+  return entry->fAuxSDPLine;
+}
+
+void SDPCache::add(char const* fileName, char const* trackId, char const* auxSDPLine) {
+  if (auxSDPLine == NULL) auxSDPLine = "";
+
+  long modificationTime; u_int64_t fileSize;
+  if (!getFileStamp(fileName, modificationTime, fileSize)) return;
+
+  char* key = makeKey(fileName, trackId);
+  addEntry(key, modificationTime, fileSize, auxSDPLine);
+  delete[] key;
+
+  appendToFile(fileName, trackId, modificationTime, fileSize, auxSDPLine);
+}
+
+Boolean SDPCache::getFileStamp(char const* fileName, long& modificationTime, u_int64_t& fileSize) {
+  struct stat sb;
+  if (stat(fileName, &sb) != 0) return False;
+
+  modificationTime = (long)sb.st_mtime;
+  fileSize = (u_int64_t)sb.st_size;
+  return True;
+}
+
+char* SDPCache::makeKey(char const* fileName, char const* trackId) {
+  char* key = new char[strlen(trackId) + 1 + strlen(fileName) + 1];
+  sprintf(key, "%s %s", trackId, fileName);
+  return key;
+}
+
+void SDPCache::addEntry(char const* key, long modificationTime, u_int64_t fileSize,
+			char const* auxSDPLine) {
+  SDPCacheEntry* oldEntry
+    = (SDPCacheEntry*)fTable->Add(key, new SDPCacheEntry(modificationTime, fileSize, auxSDPLine));
+  delete oldEntry;
+}
+
+void SDPCache::loadFromFile() {
+  if (fCacheFileName == NULL) return;
+  FILE* fid = fopen(fCacheFileName, "r");
+  if (fid == NULL) return; // there's no cache yet
+
+  char* line = new char[SDP_CACHE_MAX_LINE_SIZE];
+  char* trackId = new char[SDP_CACHE_MAX_LINE_SIZE];
+  char* encodedAuxSDPLine = new char[SDP_CACHE_MAX_LINE_SIZE];
+  while (fgets(line, SDP_CACHE_MAX_LINE_SIZE, fid) != NULL) {
+    long modificationTime;
+    unsigned long long fileSize;
+    int fileNameOffset = 0;
+    if (sscanf(line, "%ld %llu %s %s %n", &modificationTime, &fileSize,
+	       trackId, encodedAuxSDPLine, &fileNameOffset) != 4 || fileNameOffset == 0) {
+      continue; // ignore malformed lines
+    }
+    char* fileName = &line[fileNameOffset];
+    unsigned fileNameLength = strlen(fileName);
+    while (fileNameLength > 0 && (fileName[fileNameLength-1] == '\n' || fileName[fileNameLength-1] == '\r')) {
+      fileName[--fileNameLength] = '\0';
+    }
+    if (fileNameLength == 0) continue;
+
+    char* auxSDPLine;
+    if (strcmp(encodedAuxSDPLine, "-") == 0) {
+      auxSDPLine = strDup("");
+    } else {
+      unsigned auxSDPLineSize;
+      unsigned char* decoded = base64Decode(encodedAuxSDPLine, auxSDPLineSize);
+      auxSDPLine = new char[auxSDPLineSize + 1];
+      memmove(auxSDPLine, decoded, auxSDPLineSize);
+      auxSDPLine[auxSDPLineSize] = '\0';
+      delete[] decoded;
+    }
+
+    char* key = makeKey(fileName, trackId);
+    addEntry(key, modificationTime, (u_int64_t)fileSize, auxSDPLine);
+    delete[] key; delete[] auxSDPLine;
+  }
+  delete[] encodedAuxSDPLine; delete[] trackId; delete[] line;
+  fclose(fid);
+}
+
+void SDPCache::appendToFile(char const* fileName, char const* trackId,
+			    long modificationTime, u_int64_t fileSize, char const* auxSDPLine) {
+  if (fCacheFileName == NULL) return;
+  FILE* fid = fopen(fCacheFileName, "a");
+  if (fid == NULL) return; // we can't persist this entry, but it's still cached in memory
+
+  char* encodedAuxSDPLine = auxSDPLine[0] == '\0' ? strDup("-") : base64Encode(auxSDPLine, strlen(auxSDPLine));
+  fprintf(fid, "%ld %llu %s %s %s\n", modificationTime, (unsigned long long)fileSize,
+	  trackId, encodedAuxSDPLine, fileName);
+  delete[] encodedAuxSDPLine;
+  fclose(fid);
+}
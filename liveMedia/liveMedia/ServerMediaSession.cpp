@@ -62,7 +62,7 @@ ServerMediaSession::ServerMediaSession(UsageEnvironment& env,
 				       Boolean isSSM, char const* miscSDPLines)
   : Medium(env), fIsSSM(isSSM), fSubsessionsHead(NULL),
     fSubsessionsTail(NULL), fSubsessionCounter(0),
-    fReferenceCount(0), fDeleteWhenUnreferenced(False) {
+    fReferenceCount(0), fDeleteWhenUnreferenced(False), fSDPCache(NULL), fHintCache(NULL) {
   fStreamName = strDup(streamName == NULL ? "" : streamName);
   fInfoSDPString = strDup(info == NULL ? libNameStr : info);
   fDescriptionSDPString
@@ -351,6 +351,11 @@ void ServerMediaSubsession::deleteStream(unsigned /*clientSessionId*/,
   // default implementation: do nothing
 }
 
+RTPSink* ServerMediaSubsession::rtpSinkForStream(void* /*streamToken*/) {
+  // default implementation: we don't know
+  return NULL;
+}
+
 void ServerMediaSubsession::testScaleFactor(float& scale) {
   // default implementation: Support scale = 1 only
   scale = 1;
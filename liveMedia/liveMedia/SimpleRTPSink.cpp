@@ -37,6 +37,8 @@ SimpleRTPSink::SimpleRTPSink(UsageEnvironment& env, Groupsock* RTPgs,
     = strDup(sdpMediaTypeString == NULL ? "unknown" : sdpMediaTypeString);
   fSetMBitOnLastFrames
     = strcmp(fSDPMediaTypeString, "video") == 0 && doNormalMBitRule;
+  fIsTransportStream
+    = rtpPayloadFormatName != NULL && strcmp(rtpPayloadFormatName, "MP2T") == 0;
 }
 
 SimpleRTPSink::~SimpleRTPSink() {
@@ -85,6 +87,29 @@ frameCanAppearAfterPacketStart(unsigned char const* /*frameStart*/,
   return fAllowMultipleFramesPerPacket;
 }
 
+#define TRANSPORT_PACKET_SIZE 188
+#define TRANSPORT_SYNC_BYTE 0x47
+
+Boolean SimpleRTPSink::frameIsRandomAccessPoint(unsigned char const* frameStart,
+						unsigned numBytesInFrame) {
+  if (!fIsTransportStream) {
+    return MultiFramedRTPSink::frameIsRandomAccessPoint(frameStart, numBytesInFrame);
+  }
+
+  // A Transport Stream 'frame' is one or more Transport Stream packets.  It's a random
+  // access point if any of these packets has its "random_access_indicator" set:
+  for (unsigned i = 0; i + TRANSPORT_PACKET_SIZE <= numBytesInFrame; i += TRANSPORT_PACKET_SIZE) {
+    unsigned char const* pkt = &frameStart[i];
+    if (pkt[0] != TRANSPORT_SYNC_BYTE) break; // we've lost sync; give up
+    u_int8_t const adaptation_field_control = (pkt[3]&0x30)>>4;
+    if ((adaptation_field_control&0x2) != 0 && pkt[4] > 0 // an adaptation field is present
+	&& (pkt[5]&0x40) != 0) { // random_access_indicator
+      return True;
+    }
+  }
+  return False;
+}
+
 char const* SimpleRTPSink::sdpMediaType() const {
   return fSDPMediaTypeString;
 }
@@ -22,8 +22,66 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 
 #include <string.h>
 #include <stdlib.h>
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define USE_NEON_START_CODE_SCAN 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_SSE2_START_CODE_SCAN 1
+#endif
 
-#define BANK_SIZE 150000
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(MREMAP_FIXED)
+#define USE_MIRRORED_PARSER_BUFFER 1
+#endif
+#endif
+
+// The initial size of our input buffer, and (by default) the largest size that it can grow to:
+#ifndef STREAM_PARSER_INITIAL_BUFFER_SIZE
+#define STREAM_PARSER_INITIAL_BUFFER_SIZE 150000
+#endif
+#ifndef STREAM_PARSER_DEFAULT_MAX_BUFFER_SIZE
+#define STREAM_PARSER_DEFAULT_MAX_BUFFER_SIZE (16*1024*1024)
+#endif
+
+// Allocates a (ring) buffer of (at least) "size" bytes.  If we can, we map the same memory
+// twice - back to back - so that the ring's contents are always contiguous:
+static unsigned char* allocateBuffer(unsigned& size, Boolean& isMirrored) {
+#ifdef USE_MIRRORED_PARSER_BUFFER
+  unsigned const pageMask = (unsigned)sysconf(_SC_PAGESIZE) - 1;
+  unsigned const mirroredSize = (size + pageMask)&~pageMask;
+
+  // First, reserve enough address space for both copies, then map shared memory into the
+  // first half, and (using "mremap()" with an 'old size' of 0) map it again into the second:
+  void* base = mmap(NULL, 2*mirroredSize, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+  if (base != MAP_FAILED) {
+    unsigned char* mirror = (unsigned char*)base + mirroredSize;
+    if (mmap(base, mirroredSize, PROT_READ|PROT_WRITE,
+	     MAP_SHARED|MAP_ANONYMOUS|MAP_FIXED, -1, 0) == base
+	&& mremap(base, 0, mirroredSize, MREMAP_MAYMOVE|MREMAP_FIXED, mirror) == mirror) {
+      size = mirroredSize;
+      isMirrored = True;
+      return (unsigned char*)base;
+    }
+    munmap(base, 2*mirroredSize);
+  }
+#endif
+
+  isMirrored = False;
+  return new unsigned char[size];
+}
+
+static void freeBuffer(unsigned char* buffer, unsigned size, Boolean isMirrored) {
+#ifdef USE_MIRRORED_PARSER_BUFFER
+  if (isMirrored) {
+    munmap(buffer, 2*size);
+    return;
+  }
+#endif
+  delete[] buffer;
+}
 
 StreamParser::StreamParser(FramedSource* inputSource,
 			   FramedSource::onCloseFunc* onInputCloseFunc,
@@ -34,17 +92,20 @@ StreamParser::StreamParser(FramedSource* inputSource,
     fOnInputCloseClientData(onInputCloseClientData),
     fClientContinueFunc(clientContinueFunc),
     fClientContinueClientData(clientContinueClientData),
+    fBufferSize(STREAM_PARSER_INITIAL_BUFFER_SIZE),
+    fMaxBufferSize(STREAM_PARSER_DEFAULT_MAX_BUFFER_SIZE),
     fSavedParserIndex(0), fSavedRemainingUnparsedBits(0),
     fCurParserIndex(0), fRemainingUnparsedBits(0),
     fTotNumValidBytes(0) {
-  fBank[0] = new unsigned char[BANK_SIZE];
-  fBank[1] = new unsigned char[BANK_SIZE];
-  fCurBankNum = 0;
-  fCurBank = fBank[fCurBankNum];
+  fBuffer = allocateBuffer(fBufferSize, fBufferIsMirrored);
 }
 
 StreamParser::~StreamParser() {
-  delete[] fBank[0]; delete[] fBank[1];
+  freeBuffer(fBuffer, fBufferSize, fBufferIsMirrored);
+}
+
+void StreamParser::setMaxBufferSize(unsigned maxBufferSize) {
+  fMaxBufferSize = maxBufferSize;
 }
 
 #define NO_MORE_BUFFERED_INPUT 1
@@ -55,35 +116,30 @@ void StreamParser::ensureValidBytes1(unsigned numBytesNeeded) {
   unsigned maxInputFrameSize = fInputSource->maxFrameSize();
   if (maxInputFrameSize > numBytesNeeded) numBytesNeeded = maxInputFrameSize;
 
-  // First, check whether these new bytes would overflow the current
-  // bank.  If so, start using a new bank now.
-  if (fCurParserIndex + numBytesNeeded > BANK_SIZE) {
-    // Swap banks, but save any still-needed bytes from the old bank:
-    unsigned numBytesToSave = fTotNumValidBytes - fSavedParserIndex;
-    unsigned char const* from = &curBank()[fSavedParserIndex];
-
-    fCurBankNum = (fCurBankNum + 1)%2;
-    fCurBank = fBank[fCurBankNum];
-    memmove(curBank(), from, numBytesToSave);
-    fCurParserIndex = fCurParserIndex - fSavedParserIndex;
-    fSavedParserIndex = 0;
-    fTotNumValidBytes = numBytesToSave;
-  }
-
-  // ASSERT: fCurParserIndex + numBytesNeeded > fTotNumValidBytes
-  //      && fCurParserIndex + numBytesNeeded <= BANK_SIZE
-  if (fCurParserIndex + numBytesNeeded > BANK_SIZE) {
-    // If this happens, it means that we have too much saved parser state.
-    // To fix this, increase BANK_SIZE as appropriate.
-    fInputSource->envir() << "StreamParser internal error ("
-			  << fCurParserIndex << "+ "
-			  << numBytesNeeded << " > "
-			  << BANK_SIZE << ")\n";
-    fInputSource->envir().internalError();
+  // Then, make sure that there'll be room for these new bytes (along with the bytes
+  // that we still need):
+  unsigned const firstNeeded = firstNeededIndex();
+  if (fCurParserIndex + numBytesNeeded - firstNeeded > fBufferSize) {
+    // The buffer is too small, even if we discard all of the bytes that we no longer need:
+    growBuffer(fCurParserIndex + numBytesNeeded - firstNeeded);
+  } else if (fBufferIsMirrored) {
+    if (firstNeeded >= fBufferSize) {
+      // Our indices have moved into the second copy of the ring.  Move them back into the
+      // first copy.  (This refers to exactly the same bytes, so no data needs to be moved.)
+      fSavedParserIndex -= fBufferSize;
+      fCurParserIndex -= fBufferSize;
+      fTotNumValidBytes -= fBufferSize;
+    }
+  } else if (fCurParserIndex + numBytesNeeded > fBufferSize) {
+    // Move the bytes that we still need to the start of the buffer:
+    memmove(curBank(), &curBank()[firstNeeded], fTotNumValidBytes - firstNeeded);
+    fSavedParserIndex -= firstNeeded;
+    fCurParserIndex -= firstNeeded;
+    fTotNumValidBytes -= firstNeeded;
   }
 
-  // Try to read as many new bytes as will fit in the current bank:
-  unsigned maxNumBytesToRead = BANK_SIZE - fTotNumValidBytes;
+  // Try to read as many new bytes as will fit:
+  unsigned maxNumBytesToRead = validBytesLimit() - fTotNumValidBytes;
   fInputSource->getNextFrame(&curBank()[fTotNumValidBytes],
 			     maxNumBytesToRead,
 			     afterGettingBytes, this,
@@ -92,6 +148,99 @@ void StreamParser::ensureValidBytes1(unsigned numBytesNeeded) {
   throw NO_MORE_BUFFERED_INPUT;
 }
 
+void StreamParser::growBuffer(unsigned minBufferSize) {
+  unsigned newBufferSize = fBufferSize;
+  while (newBufferSize < minBufferSize && newBufferSize < fMaxBufferSize) newBufferSize *= 2;
+  if (newBufferSize > fMaxBufferSize) newBufferSize = fMaxBufferSize;
+
+  if (newBufferSize < minBufferSize) {
+    // If this happens, it means that we have too much saved parser state.
+    // To fix this, increase the maximum buffer size (using "setMaxBufferSize()").
+    fInputSource->envir() << "StreamParser internal error ("
+			  << minBufferSize << " > "
+			  << fMaxBufferSize << ")\n";
+    fInputSource->envir().internalError();
+  }
+
+  // Copy the bytes that we still need to the start of a new buffer.  (Because the buffer
+  // grows geometrically, this happens only rarely.)
+  Boolean newBufferIsMirrored;
+  unsigned char* newBuffer = allocateBuffer(newBufferSize, newBufferIsMirrored);
+  unsigned const firstNeeded = firstNeededIndex();
+  memmove(newBuffer, &curBank()[firstNeeded], fTotNumValidBytes - firstNeeded);
+  freeBuffer(fBuffer, fBufferSize, fBufferIsMirrored);
+
+  fBuffer = newBuffer;
+  fBufferSize = newBufferSize;
+  fBufferIsMirrored = newBufferIsMirrored;
+  fSavedParserIndex -= firstNeeded;
+  fCurParserIndex -= firstNeeded;
+  fTotNumValidBytes -= firstNeeded;
+}
+
+// Returns a pointer to the first 0x000001 start code that lies completely within
+// [from,end), or NULL if there is none:
+static unsigned char const* findStartCode(unsigned char const* from,
+					  unsigned char const* end) {
+  unsigned char const* p = from;
+
+  // First, use vector instructions (if we can) to test 16 possible start code positions at a
+  // time - i.e., check "p[i] == 0 && p[i+1] == 0 && p[i+2] == 1" - until one of them matches:
+#if defined(USE_NEON_START_CODE_SCAN)
+  uint8x16_t const zero = vdupq_n_u8(0);
+  uint8x16_t const one = vdupq_n_u8(1);
+  while (p + 16+2 <= end) {
+    uint8x16_t match = vandq_u8(vandq_u8(vceqq_u8(vld1q_u8(p), zero),
+					 vceqq_u8(vld1q_u8(p+1), zero)),
+				vceqq_u8(vld1q_u8(p+2), one));
+    uint64x2_t match64 = vreinterpretq_u64_u8(match);
+    if ((vgetq_lane_u64(match64, 0)|vgetq_lane_u64(match64, 1)) != 0) break;
+    p += 16;
+  }
+#elif defined(USE_SSE2_START_CODE_SCAN)
+  __m128i const zero = _mm_setzero_si128();
+  __m128i const one = _mm_set1_epi8(1);
+  while (p + 16+2 <= end) {
+    __m128i match
+      = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)p), zero),
+				    _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)(p+1)), zero)),
+		      _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)(p+2)), one));
+    if (_mm_movemask_epi8(match) != 0) break;
+    p += 16;
+  }
+#endif
+
+  // Then, find the exact position (or handle the remaining bytes) one byte at a time.
+  // Note that we can usually skip 3 bytes at once, by looking at "p[2]" first:
+  while (p + 3 <= end) {
+    if (p[2] > 1) {
+      p += 3; // a start code can't begin at p, p+1, or p+2
+    } else if (p[2] == 0) {
+      ++p; // a start code can't begin at p, but might begin at p+1
+    } else if (p[0] == 0 && p[1] == 0) {
+      return p;
+    } else {
+      p += 3;
+    }
+  }
+
+  return NULL;
+}
+
+unsigned StreamParser::numBytesToNextStartCode() {
+  ensureValidBytes(3);
+
+  unsigned char const* from = nextToParse();
+  unsigned char const* startCode = findStartCode(from, &curBank()[fTotNumValidBytes]);
+  if (startCode == NULL) {
+    // There's no start code in the data that we've buffered so far, so read more.
+    // (We'll be called again - and rescan from the saved parse position - once it arrives.)
+    ensureValidBytes(fTotNumValidBytes - fCurParserIndex + 1);
+  }
+
+  return startCode - from;
+}
+
 void StreamParser::afterGettingBytes(void* clientData,
 				     unsigned numBytesRead,
 				     unsigned /*numTruncatedBytes*/,
@@ -99,12 +248,12 @@ void StreamParser::afterGettingBytes(void* clientData,
 				     unsigned /*durationInMicroseconds*/){
   StreamParser* buffer = (StreamParser*)clientData;
 
-  // Sanity check: Make sure we didn't get too many bytes for our bank:
-  if (buffer->fTotNumValidBytes + numBytesRead > BANK_SIZE) {
+  // Sanity check: Make sure we didn't get too many bytes for our buffer:
+  if (buffer->fTotNumValidBytes + numBytesRead > buffer->validBytesLimit()) {
     buffer->fInputSource->envir()
       << "StreamParser::afterGettingBytes() warning: read "
       << numBytesRead << " bytes; expected no more than "
-      << BANK_SIZE - buffer->fTotNumValidBytes << "\n";
+      << buffer->validBytesLimit() - buffer->fTotNumValidBytes << "\n";
   }
 
   unsigned char* ptr = &buffer->curBank()[buffer->fTotNumValidBytes];
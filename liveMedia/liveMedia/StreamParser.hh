@@ -29,6 +29,10 @@ class StreamParser {
 public:
   virtual void flushInput();
 
+  void setMaxBufferSize(unsigned maxBufferSize);
+      // Sets the size that our input buffer may grow to.  This limits how large a single
+      // unit of input (e.g., a NAL unit, or a MPEG picture) may be.
+
 protected: // we're a virtual base class
   typedef void (clientContinueFunc)(void* clientData,
 				    unsigned char* ptr, unsigned size,
@@ -89,6 +93,20 @@ protected: // we're a virtual base class
     fCurParserIndex += numBytes;
   }
 
+  void ungetBytes(unsigned numBytes) { // these must have been parsed since the last "saveParserState()"
+    fCurParserIndex -= numBytes;
+    fRemainingUnparsedBits = 0;
+  }
+  u_int8_t testByteAt(unsigned offset) { // doesn't advance ptr
+    ensureValidBytes(offset+1);
+    return nextToParse()[offset];
+  }
+
+  unsigned numBytesToNextStartCode();
+      // Returns the number of bytes (starting at the current parse position) that precede
+      // the next 0x000001 start code.  Doesn't advance ptr.  (As with the functions above,
+      // if our buffered data doesn't yet contain a start code, then more input is read.)
+
   void skipBits(unsigned numBits);
   unsigned getBits(unsigned numBits);
       // numBits <= 32; returns data into low-order bits of result
@@ -98,7 +116,7 @@ protected: // we're a virtual base class
   unsigned& totNumValidBytes() { return fTotNumValidBytes; }
 
 private:
-  unsigned char* curBank() { return fCurBank; }
+  unsigned char* curBank() { return fBuffer; }
   unsigned char* nextToParse() { return &curBank()[fCurParserIndex]; }
   unsigned char* lastParsed() { return &curBank()[fCurParserIndex-1]; }
 
@@ -110,6 +128,17 @@ private:
     ensureValidBytes1(numBytesNeeded);
   }
   void ensureValidBytes1(unsigned numBytesNeeded);
+  void growBuffer(unsigned minBufferSize);
+
+  // The bytes that we still need (to be able to restart from the saved parse position)
+  // begin here.  (We keep the byte before the saved position, in case it's partly parsed.)
+  unsigned firstNeededIndex() const {
+    return fSavedParserIndex > 0 ? fSavedParserIndex - 1 : 0;
+  }
+  // New input can be read up to (but not including) here:
+  unsigned validBytesLimit() const {
+    return fBufferIsMirrored ? firstNeededIndex() + fBufferSize : fBufferSize;
+  }
 
   static void afterGettingBytes(void* clientData, unsigned numBytesRead,
 				unsigned numTruncatedBytes,
@@ -123,21 +152,25 @@ private:
   clientContinueFunc* fClientContinueFunc;
   void* fClientContinueClientData;
 
-  // Use a pair of 'banks', and swap between them as they fill up:
-  unsigned char* fBank[2];
-  unsigned char fCurBankNum;
-  unsigned char* fCurBank;
+  // Input is buffered in a ring, which grows (up to "fMaxBufferSize") if a single unit
+  // of input doesn't fit.  If possible, the ring's memory is mapped twice - back to back -
+  // so that buffered data is always contiguous (even if it wraps around), and so never
+  // needs to be moved.  Otherwise, we move the still-needed data to the start instead:
+  unsigned char* fBuffer;
+  unsigned fBufferSize;
+  unsigned fMaxBufferSize;
+  Boolean fBufferIsMirrored; // if True, "fBuffer[i]" and "fBuffer[i+fBufferSize]" are the same byte
 
   // The most recent 'saved' parse position:
   unsigned fSavedParserIndex; // <= fCurParserIndex
   unsigned char fSavedRemainingUnparsedBits;
 
-  // The current position of the parser within the current bank:
+  // The current position of the parser (as an index into "fBuffer"):
   unsigned fCurParserIndex; // <= fTotNumValidBytes
   unsigned char fRemainingUnparsedBits; // in previous byte: [0,7]
 
-  // The total number of valid bytes stored in the current bank:
-  unsigned fTotNumValidBytes; // <= BANK_SIZE
+  // The index (into "fBuffer") just past the last valid byte:
+  unsigned fTotNumValidBytes; // <= validBytesLimit()
 };
 
 #endif
@@ -0,0 +1,185 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A relay that receives UDP packets (e.g., from a multicast group) just once,
+// and retransmits each of them - without copying - to any number of
+// (unicast or multicast) subscribers, which may come and go at any time.
+// Implementation
+
+#include "UDPFanOutRelay.hh"
+#include "TunnelEncaps.hh"
+#include <GroupsockHelper.hh>
+
+// The maximum number of batches that we read (and send) each time our input
+// socket becomes readable, so that a busy input can't starve other event handlers:
+#define MAX_BATCHES_PER_READ_EVENT 4
+
+////////// UDPFanOutSubscriber //////////
+
+class UDPFanOutSubscriber {
+public:
+  UDPFanOutSubscriber(struct in_addr const& address, Port const& port,
+		      UDPFanOutSubscriber* next)
+    : fNext(next), fAddress(address), fPort(port) {
+  }
+
+  UDPFanOutSubscriber* fNext;
+  struct in_addr fAddress;
+  Port fPort;
+};
+
+////////// UDPFanOutRelay //////////
+
+UDPFanOutRelay* UDPFanOutRelay
+::createNew(UsageEnvironment& env, Groupsock* inputGS, u_int8_t outputTTL,
+	    unsigned maxPacketSize, unsigned maxBatchSize) {
+  return new UDPFanOutRelay(env, inputGS, outputTTL, maxPacketSize, maxBatchSize);
+}
+
+UDPFanOutRelay
+::UDPFanOutRelay(UsageEnvironment& env, Groupsock* inputGS, u_int8_t outputTTL,
+		 unsigned maxPacketSize, unsigned maxBatchSize)
+  : Medium(env), fInputGS(inputGS), fOutputTTL(outputTTL),
+    fMaxBatchSize(maxBatchSize), fSubscribers(NULL), fNumSubscribers(0),
+    fIsRelaying(False),
+    fNumPacketsReceived(0), fNumPacketsSent(0), fNumPacketsDropped(0) {
+  if (fMaxBatchSize == 0) fMaxBatchSize = 1;
+  else if (fMaxBatchSize > UDP_FAN_OUT_RELAY_MAX_BATCH) fMaxBatchSize = UDP_FAN_OUT_RELAY_MAX_BATCH;
+
+  // Each packet is read into one of these buffers, and then sent - from the same
+  // buffer - to every subscriber.  (We leave room for a tunnel encapsulation
+  // trailer, as "Groupsock::handleReadBatch()" requires.)
+  fBufferMaxSize = maxPacketSize + TunnelEncapsulationTrailerMaxSize;
+  fBufferPool = new unsigned char[fMaxBatchSize*fBufferMaxSize];
+  for (unsigned i = 0; i < fMaxBatchSize; ++i) fBuffers[i] = &fBufferPool[i*fBufferMaxSize];
+
+  // All output is sent from a single (unbound, unicast) socket.  Its own
+  // default destination is removed; the subscribers are its only destinations:
+  struct in_addr dummyAddr; dummyAddr.s_addr = 0;
+  fOutputGS = new Groupsock(env, dummyAddr, 0, fOutputTTL);
+  fOutputGS->removeAllDestinations();
+  increaseSendBufferTo(env, fOutputGS->socketNum(), 256*1024);
+  makeSocketNonBlocking(fOutputGS->socketNum()); // so that a full send buffer drops, not stalls
+
+  increaseReceiveBufferTo(env, fInputGS->socketNum(), 256*1024);
+  makeSocketNonBlocking(fInputGS->socketNum());
+}
+
+UDPFanOutRelay::~UDPFanOutRelay() {
+  stopRelaying();
+  removeAllSubscribers();
+  delete fOutputGS;
+  delete[] fBufferPool;
+}
+
+Boolean UDPFanOutRelay::addSubscriber(struct in_addr const& address, Port const& port) {
+  for (UDPFanOutSubscriber* s = fSubscribers; s != NULL; s = s->fNext) {
+    if (s->fAddress.s_addr == address.s_addr && s->fPort.num() == port.num()) return False;
+  }
+
+  fSubscribers = new UDPFanOutSubscriber(address, port, fSubscribers);
+  ++fNumSubscribers;
+  return True;
+}
+
+Boolean UDPFanOutRelay::removeSubscriber(struct in_addr const& address, Port const& port) {
+  for (UDPFanOutSubscriber** sPtr = &fSubscribers; *sPtr != NULL; sPtr = &((*sPtr)->fNext)) {
+    UDPFanOutSubscriber* s = *sPtr;
+    if (s->fAddress.s_addr == address.s_addr && s->fPort.num() == port.num()) {
+      *sPtr = s->fNext;
+      delete s;
+      --fNumSubscribers;
+      return True;
+    }
+  }
+
+  return False;
+}
+
+void UDPFanOutRelay::removeAllSubscribers() {
+  while (fSubscribers != NULL) {
+    UDPFanOutSubscriber* next = fSubscribers->fNext;
+    delete fSubscribers;
+    fSubscribers = next;
+  }
+  fNumSubscribers = 0;
+}
+
+void UDPFanOutRelay::startRelaying() {
+  if (fIsRelaying) return;
+
+  envir().taskScheduler().turnOnBackgroundReadHandling(fInputGS->socketNum(),
+	(TaskScheduler::BackgroundHandlerProc*)&incomingPacketHandler, this);
+  fIsRelaying = True;
+}
+
+void UDPFanOutRelay::stopRelaying() {
+  if (!fIsRelaying) return;
+
+  envir().taskScheduler().turnOffBackgroundReadHandling(fInputGS->socketNum());
+  fIsRelaying = False;
+}
+
+void UDPFanOutRelay::incomingPacketHandler(UDPFanOutRelay* relay, int /*mask*/) {
+  relay->incomingPacketHandler1();
+}
+
+void UDPFanOutRelay::incomingPacketHandler1() {
+  unsigned bufferMaxSizes[UDP_FAN_OUT_RELAY_MAX_BATCH];
+  for (unsigned i = 0; i < fMaxBatchSize; ++i) bufferMaxSizes[i] = fBufferMaxSize;
+
+  unsigned bytesRead[UDP_FAN_OUT_RELAY_MAX_BATCH];
+  struct sockaddr_in fromAddresses[UDP_FAN_OUT_RELAY_MAX_BATCH];
+  struct timeval receptionTimes[UDP_FAN_OUT_RELAY_MAX_BATCH];
+
+  for (unsigned batchNum = 0; batchNum < MAX_BATCHES_PER_READ_EVENT; ++batchNum) {
+    int numRead = fInputGS->handleReadBatch(fBuffers, bufferMaxSizes, fMaxBatchSize,
+					    bytesRead, fromAddresses, receptionTimes);
+    if (numRead <= 0) break; // nothing (more) is waiting, or an error occurred
+
+    // Datagrams that the input socket filtered out (e.g., from the wrong SSM source)
+    // have a "bytesRead" of 0.  Squeeze them out - by reordering buffers, not data -
+    // so that the remaining packets can be sent as one batch:
+    unsigned numPackets = 0;
+    for (int i = 0; i < numRead; ++i) {
+      if (bytesRead[i] == 0) continue;
+      if ((int)numPackets != i) {
+	unsigned char* tmp = fBuffers[numPackets];
+	fBuffers[numPackets] = fBuffers[i]; fBuffers[i] = tmp;
+	bytesRead[numPackets] = bytesRead[i];
+      }
+      ++numPackets;
+    }
+    fNumPacketsReceived += numPackets;
+    if (numPackets > 0) sendBatch(bytesRead, numPackets);
+
+    if ((unsigned)numRead < fMaxBatchSize) break; // we've drained the socket
+  }
+}
+
+void UDPFanOutRelay::sendBatch(unsigned const* packetSizes, unsigned numPackets) {
+  // Every subscriber is sent the same buffers.  A subscriber that we can't send to
+  // (e.g., because our socket's send buffer is full) just loses those packets;
+  // it doesn't hold up the others:
+  for (UDPFanOutSubscriber* s = fSubscribers; s != NULL; s = s->fNext) {
+    int numSent = fOutputGS->writeBatch(s->fAddress.s_addr, s->fPort, fOutputTTL,
+					fBuffers, packetSizes, numPackets);
+    if (numSent < 0) numSent = 0;
+    fNumPacketsSent += numSent;
+    fNumPacketsDropped += numPackets - numSent;
+  }
+}
@@ -0,0 +1,164 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A RTP sink that sends each input frame as the complete payload of one RTP
+// packet, without copying it (if the source allows this).
+// Implementation
+
+#include "ZeroCopyRTPSink.hh"
+#include "RTPHintCache.hh"
+#include "GroupsockHelper.hh"
+
+static unsigned const rtpHeaderSize = 12;
+
+ZeroCopyRTPSink*
+ZeroCopyRTPSink::createNew(UsageEnvironment& env, Groupsock* RTPgs,
+			   unsigned char rtpPayloadFormat,
+			   unsigned rtpTimestampFrequency,
+			   char const* sdpMediaTypeString,
+			   char const* rtpPayloadFormatName,
+			   unsigned maxPayloadSize,
+			   unsigned numChannels) {
+  return new ZeroCopyRTPSink(env, RTPgs, rtpPayloadFormat, rtpTimestampFrequency,
+			     sdpMediaTypeString, rtpPayloadFormatName,
+			     maxPayloadSize, numChannels);
+}
+
+ZeroCopyRTPSink::ZeroCopyRTPSink(UsageEnvironment& env, Groupsock* RTPgs,
+				 unsigned char rtpPayloadFormat,
+				 unsigned rtpTimestampFrequency,
+				 char const* sdpMediaTypeString,
+				 char const* rtpPayloadFormatName,
+				 unsigned maxPayloadSize,
+				 unsigned numChannels)
+  : RTPSink(env, RTPgs, rtpPayloadFormat, rtpTimestampFrequency,
+	    rtpPayloadFormatName, numChannels),
+    fMaxPayloadSize(maxPayloadSize), fCopyBuffer(NULL),
+    fIsFirstFrame(True), fNumCopiedFrames(0) {
+  fSDPMediaTypeString
+    = strDup(sdpMediaTypeString == NULL ? "unknown" : sdpMediaTypeString);
+}
+
+ZeroCopyRTPSink::~ZeroCopyRTPSink() {
+  delete[] fCopyBuffer;
+  delete[] (char*)fSDPMediaTypeString;
+}
+
+char const* ZeroCopyRTPSink::sdpMediaType() const {
+  return fSDPMediaTypeString;
+}
+
+Boolean ZeroCopyRTPSink::continuePlaying() {
+  fIsFirstFrame = True;
+  getNextFrame();
+  return True;
+}
+
+void ZeroCopyRTPSink::stopPlaying() {
+  envir().taskScheduler().unscheduleDelayedTask(nextTask());
+  MediaSink::stopPlaying();
+}
+
+void ZeroCopyRTPSink::getNextFrame() {
+  if (fSource == NULL) return;
+
+  unsigned char* to = NULL; // ask for a reference
+  if (!fSource->canDeliverFrameReferences()) {
+    if (fCopyBuffer == NULL) fCopyBuffer = new unsigned char[fMaxPayloadSize];
+    to = fCopyBuffer;
+  }
+  fSource->getNextFrame(to, fMaxPayloadSize,
+			afterGettingFrame, this, ourHandleClosure, this);
+}
+
+void ZeroCopyRTPSink::afterGettingFrame(void* clientData, unsigned frameSize,
+					unsigned /*numTruncatedBytes*/,
+					struct timeval presentationTime,
+					unsigned durationInMicroseconds) {
+  ZeroCopyRTPSink* sink = (ZeroCopyRTPSink*)clientData;
+  sink->afterGettingFrame1(frameSize, presentationTime, durationInMicroseconds);
+}
+
+void ZeroCopyRTPSink::afterGettingFrame1(unsigned frameSize,
+					 struct timeval presentationTime,
+					 unsigned durationInMicroseconds) {
+  if (fIsFirstFrame) {
+    // Record the fact that we're starting to play now:
+    gettimeofday(&fNextSendTime, NULL);
+    fStartTime = fNextSendTime;
+    fIsFirstFrame = False;
+  }
+
+  unsigned char const* payload = fSource->frameReference();
+  if (payload != NULL && frameSize > 0) {
+    struct timeval startTime;
+    gettimeofday(&startTime, NULL);
+    if (payload == fCopyBuffer) ++fNumCopiedFrames;
+    if (frameSize > fMaxPayloadSize) frameSize = fMaxPayloadSize;
+
+    // Build the RTP header:
+    fCurrentTimestamp = convertToRTPTimestamp(presentationTime);
+    u_int32_t header[3];
+    header[0] = htonl(0x80000000 | (rtpPayloadType()<<16) | fSeqNo);
+    header[1] = htonl(fCurrentTimestamp);
+    header[2] = htonl(SSRC());
+
+    fRTPInterface.sendPacketv((unsigned char const*)header, rtpHeaderSize, payload, frameSize);
+    noteSendLatency(fCurrentTimestamp, startTime);
+    if (fHintTrackRecorder != NULL) {
+      // (We don't know where a receiver can start decoding, so any packet will do.)
+      int64_t dueUSecs = (fNextSendTime.tv_sec - fStartTime.tv_sec)*(int64_t)1000000
+	+ (fNextSendTime.tv_usec - fStartTime.tv_usec);
+      fHintTrackRecorder->addPacket((unsigned char const*)header, rtpHeaderSize,
+				    payload, frameSize, dueUSecs, True);
+    }
+    ++fPacketCount;
+    fTotalOctetCount += rtpHeaderSize + frameSize;
+    fNumBytesSent += rtpHeaderSize + frameSize;
+    fOctetCount += frameSize;
+    ++fSeqNo; // for next time
+    addProcessingTimeSince(startTime);
+  }
+
+  // Figure out when the next frame is due to be sent, and wait until then:
+  fNextSendTime.tv_usec += durationInMicroseconds;
+  fNextSendTime.tv_sec += fNextSendTime.tv_usec/1000000;
+  fNextSendTime.tv_usec %= 1000000;
+
+  struct timeval timeNow;
+  gettimeofday(&timeNow, NULL);
+  int secsDiff = fNextSendTime.tv_sec - timeNow.tv_sec;
+  int64_t uSecondsToGo = secsDiff*1000000 + (fNextSendTime.tv_usec - timeNow.tv_usec);
+  if (uSecondsToGo < 0 || secsDiff < 0) { // sanity check: Make sure that the time-to-delay is non-negative:
+    uSecondsToGo = 0;
+  }
+
+  // (Note that we always return to the event loop before reading again, because a
+  // frame reference remains valid only until the next read.)
+  nextTask() = envir().taskScheduler().scheduleDelayedTask(uSecondsToGo, (TaskFunc*)sendNext, this);
+}
+
+void ZeroCopyRTPSink::sendNext(void* clientData) {
+  ZeroCopyRTPSink* sink = (ZeroCopyRTPSink*)clientData;
+  sink->nextTask() = NULL;
+  sink->getNextFrame();
+}
+
+void ZeroCopyRTPSink::ourHandleClosure(void* clientData) {
+  ZeroCopyRTPSink* sink = (ZeroCopyRTPSink*)clientData;
+  onSourceClosure(sink);
+}
@@ -0,0 +1,96 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A 'read-ahead' input file: A separate thread reads the file sequentially into
+// large (page-aligned) buffers, ahead of our need for the data, so that a slow
+// disk doesn't stall our event loop.
+// C++ header
+
+#ifndef _ASYNC_FILE_READER_HH
+#define _ASYNC_FILE_READER_HH
+
+#ifndef _USAGE_ENVIRONMENT_HH
+#include "UsageEnvironment.hh"
+#endif
+#include <stdio.h>
+
+#ifndef ASYNC_FILE_READER_BUFFER_SIZE
+#define ASYNC_FILE_READER_BUFFER_SIZE (256*1024)
+#endif
+#ifndef ASYNC_FILE_READER_NUM_BUFFERS
+#define ASYNC_FILE_READER_NUM_BUFFERS 4
+#endif
+
+class AsyncFileReader {
+public:
+  AsyncFileReader(UsageEnvironment& env, FILE* fid,
+		  unsigned bufferSize = ASYNC_FILE_READER_BUFFER_SIZE,
+		  unsigned numBuffers = ASYNC_FILE_READER_NUM_BUFFERS);
+      // "fid" should be a regular (seekable) file.  From now on, all input from it
+      // must be done through us.  Reading starts at the file's current position.
+      // (If we can't create our reading thread, we read synchronously instead.)
+  virtual ~AsyncFileReader(); // (doesn't close "fid")
+
+  void setDataHandler(TaskFunc* handler, void* clientData);
+      // "handler" is called (from the event loop) when data becomes available
+      // after a call to "read()" returned 0.
+
+  int read(unsigned char* to, unsigned maxSize);
+      // Returns the number of bytes copied to "to" (>0), or
+      //   0 if no data is available yet (the data handler will be called once it is), or
+      //   -1 at the end of the file (or after a read error).
+
+  void seek(int64_t filePosn);
+      // Discards any data that we've already read ahead
+  int64_t position() const { return fPosition; }
+      // the file position of the next byte returned by "read()"
+
+  Boolean isAsynchronous() const { return fThreadIsRunning; }
+
+private:
+  static void dataAvailableHandler(void* clientData);
+  int readSynchronously(unsigned char* to, unsigned maxSize);
+  friend class AsyncFileReaderThread;
+  void readerThreadMain();
+
+private:
+  UsageEnvironment& fEnv;
+  FILE* fFid;
+  int fFileDescriptor;
+  unsigned fBufferSize, fNumBuffers;
+  unsigned char** fBuffers;
+  unsigned* fBufferBytes; // the amount of data in each full buffer
+  unsigned fReadIndex; // the full buffer that we're currently returning data from
+  unsigned fReadOffset; // the position within it of the next byte to be returned
+  int64_t fPosition;
+  TaskFunc* fDataHandler;
+  void* fDataHandlerClientData;
+  EventTriggerId fDataAvailableTrigger;
+
+  // State shared with our reading thread (protected by its lock):
+  Boolean fThreadIsRunning;
+  class AsyncFileReaderThread* fThread; // (defined in "AsyncFileReader.cpp")
+  unsigned fFillIndex; // the next buffer to be filled from the file
+  unsigned fNumFullBuffers; // not including the one being filled
+  int64_t fFillPosition; // the file position of the next buffer to be filled
+  unsigned fSeekGeneration; // incremented by "seek()", to discard a read in progress
+  Boolean fReachedEnd; // the file has no more data (or a read failed)
+  Boolean fConsumerIsWaiting; // "read()" returned 0; trigger an event when data arrives
+  Boolean fStopping;
+};
+
+#endif
@@ -0,0 +1,135 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A 'write-behind' output file: Data is collected in large (page-aligned)
+// buffers, each of which - once full - is written to the file by a separate
+// thread, so that a slow disk doesn't stall our event loop.
+// C++ header
+
+#ifndef _ASYNC_FILE_WRITER_HH
+#define _ASYNC_FILE_WRITER_HH
+
+#ifndef _BOOLEAN_HH
+#include "Boolean.hh"
+#endif
+#ifndef _NET_COMMON_H
+#include "NetCommon.h"
+#endif
+#include <stdio.h>
+
+#ifndef ASYNC_FILE_WRITER_BUFFER_SIZE
+#define ASYNC_FILE_WRITER_BUFFER_SIZE (1024*1024)
+#endif
+#ifndef ASYNC_FILE_WRITER_NUM_BUFFERS
+#define ASYNC_FILE_WRITER_NUM_BUFFERS 4
+#endif
+#ifndef ASYNC_FILE_WRITER_PREALLOCATION_SIZE
+#define ASYNC_FILE_WRITER_PREALLOCATION_SIZE (16*1024*1024)
+#endif
+#ifndef ASYNC_FILE_WRITER_SYNC_INTERVAL
+#define ASYNC_FILE_WRITER_SYNC_INTERVAL (4*1024*1024)
+#endif
+
+class AsyncFileWriter {
+public:
+  AsyncFileWriter(FILE* fid,
+		  unsigned bufferSize = ASYNC_FILE_WRITER_BUFFER_SIZE,
+		  unsigned numBuffers = ASYNC_FILE_WRITER_NUM_BUFFERS,
+		  unsigned preallocationSize = ASYNC_FILE_WRITER_PREALLOCATION_SIZE,
+		  unsigned syncInterval = ASYNC_FILE_WRITER_SYNC_INTERVAL);
+      // Note: From now on, all output to "fid" must be done through us.
+      // (If we can't create our writing thread, we write synchronously instead.)
+      // On Linux, file space is reserved (with "fallocate()") "preallocationSize" bytes
+      // at a time, and - after each "syncInterval" bytes - the data is handed to the disk
+      // (with "sync_file_range()"), rather than being left to pile up in the page cache.
+      // (Either can be 0, for 'don't'; both are skipped if the file system doesn't support them.)
+  virtual ~AsyncFileWriter();
+      // waits until all of our data has been written (but doesn't close "fid")
+
+  void write(unsigned char const* data, unsigned dataSize);
+  void putByte(unsigned char byte) {
+    if (fCurBufferBytes == fBufferSize) handOffCurBuffer();
+    fCurBuffer[fCurBufferBytes++] = byte;
+  }
+
+  int64_t position() const { return fCurBufferPosition + fCurBufferBytes; }
+      // the file position of the next byte to be written
+
+  void reserve(unsigned numBytes);
+      // Makes sure that (if possible) the next "numBytes" bytes of output all go into the
+      // same buffer - so that they can later be overwritten cheaply (even if our output is a pipe).
+
+  Boolean overwrite(int64_t filePosn, unsigned char const* data, unsigned dataSize);
+      // Replaces previously-written data (e.g., to fill in a size field).
+      // This is cheap if the data is still in our current buffer; otherwise we first
+      // wait for all pending output to be written.
+
+  void flush(); // waits until all data so far has been written to the file
+
+  Boolean hadError() const { return fHadError; }
+  Boolean isAsynchronous() const { return fThreadIsRunning; }
+
+  // Statistics, counted since we were created:
+  unsigned numPendingBuffers() const; // full buffers not yet written to the file
+  unsigned peakNumPendingBuffers() const;
+  unsigned numStalls() const; // # of times that all buffers were full, so that we had to wait
+  unsigned maxStallTime() const; // the longest such wait (in microseconds)
+  unsigned numBufferWrites() const;
+  unsigned averageWriteTime() const; // per buffer (in microseconds)
+  unsigned maxWriteTime() const;
+
+private:
+  void handOffCurBuffer();
+  void writeBuffer(unsigned char const* data, unsigned dataSize); // to the file
+  void preallocate(unsigned numBytes);
+  void syncWrittenData();
+  void lock() const;
+  void unlock() const;
+  friend class AsyncFileWriterThread;
+  void writerThreadMain();
+
+private:
+  FILE* fFid;
+  int fFileDescriptor;
+  unsigned fBufferSize, fNumBuffers;
+  unsigned char** fBuffers;
+  unsigned* fBufferBytes; // the amount of data in each full buffer
+  unsigned fFillIndex; // the buffer that we're currently filling
+  unsigned char* fCurBuffer; // == fBuffers[fFillIndex]
+  unsigned fCurBufferBytes;
+  int64_t fCurBufferPosition; // the file position of "fCurBuffer[0]"
+  Boolean fHadError;
+
+  // State shared with our writing thread (protected by its lock):
+  Boolean fThreadIsRunning;
+  class AsyncFileWriterThread* fThread; // (defined in "AsyncFileWriter.cpp")
+  unsigned fWriteIndex; // the next full buffer to be written
+  unsigned fNumFullBuffers; // including the one being written
+  Boolean fStopping;
+  unsigned fPeakNumFullBuffers, fNumStalls, fMaxStallTime;
+  unsigned fNumBufferWrites, fMaxWriteTime;
+  u_int64_t fTotalWriteTime;
+
+  // State used only by whoever writes the buffers to the file:
+  unsigned fPreallocationSize, fSyncInterval;
+  int64_t fWritePosition; // the file position of the next buffer to be written
+  int64_t fPreallocatedPosition; // the end of the space reserved so far
+  int64_t fSyncedPosition; // the end of the data handed to the disk so far
+  int64_t fPrevSyncedPosition; // ... as of the previous sync
+};
+
+#endif
@@ -34,4 +34,33 @@ char* base64Encode(char const* orig, unsigned origLength);
     // returns a 0-terminated string that
     // the caller is responsible for delete[]ing.
 
+// Block-oriented versions of the above, which work on caller-supplied buffers
+// (and which use NEON instructions, if available):
+unsigned base64DecodeBlock(unsigned char* to, char const* from, unsigned fromSize);
+    // Decodes the first 4*(fromSize/4) characters of "from" into "to" (which may be
+    // the same as "from"), and returns the number of bytes that were written (at most
+    // 3*(fromSize/4)).  A quad with '=' padding decodes to just 1 or 2 bytes; invalid
+    // characters are decoded as if they were 'A'.
+unsigned base64EncodeBlock(char* to, unsigned char const* from, unsigned fromSize);
+    // Encodes "fromSize" bytes into "to" (which must have room for 4*((fromSize+2)/3)
+    // characters, and mustn't overlap "from"), with '=' padding, but no trailing '\0'.
+    // Returns the number of characters that were written.
+
+// A decoder for Base64 data that arrives in arbitrary pieces (e.g., from a socket).
+// A partial quad at the end of one piece is kept, and completed by the next:
+class Base64Decoder {
+public:
+  Base64Decoder() { reset(); }
+  void reset() { fNumPendingChars = 0; }
+
+  unsigned decode(unsigned char* to, char const* from, unsigned fromSize);
+      // Returns the number of bytes written to "to", which must have room for
+      // 3*((numPendingChars() + fromSize)/4) bytes, and mustn't overlap "from".
+  unsigned numPendingChars() const { return fNumPendingChars; } // 0..3
+
+private:
+  char fPendingChars[4];
+  unsigned fNumPendingChars;
+};
+
 #endif
@@ -25,6 +25,8 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "FramedFileSource.hh"
 #endif
 
+class AsyncFileReader; // forward
+
 class ByteStreamFileSource: public FramedFileSource {
 public:
   static ByteStreamFileSource* createNew(UsageEnvironment& env,
@@ -45,9 +47,15 @@ public:
   u_int64_t fileSize() const { return fFileSize; }
       // 0 means zero-length, unbounded, or unknown
 
-  void seekToByteAbsolute(u_int64_t byteNumber, u_int64_t numBytesToStream = 0);
+  virtual void seekToByteAbsolute(u_int64_t byteNumber, u_int64_t numBytesToStream = 0);
     // if "numBytesToStream" is >0, then we limit the stream to that number of bytes, before treating it as EOF
-  void seekToByteRelative(int64_t offset);
+  virtual void seekToByteRelative(int64_t offset);
+
+  // Regular files are read ahead - in a separate thread - into this many buffers of this
+  // size, so that a slow disk (e.g., a USB stick) doesn't stall the event loop.
+  // (A "readAheadNumBuffers" of 0 means: read directly from the file, from the event loop.)
+  static unsigned readAheadBufferSize;
+  static unsigned readAheadNumBuffers;
 
 protected:
   ByteStreamFileSource(UsageEnvironment& env,
@@ -61,12 +69,16 @@ protected:
   static void fileReadableHandler(ByteStreamFileSource* source, int mask);
   void doReadFromFile();
 
+private:
+  void initReadAhead();
+  static void readAheadDataHandler(void* clientData);
+
 private:
   // redefined virtual functions:
   virtual void doGetNextFrame();
   virtual void doStopGettingFrames();
 
-private:
+protected:
   unsigned fPreferredFrameSize;
   unsigned fPlayTimePerFrame;
   unsigned fLastPlayTime;
@@ -75,6 +87,9 @@ private:
   Boolean fHaveStartedReading;
   Boolean fLimitNumBytesToStream;
   u_int64_t fNumBytesToStream; // used iff "fLimitNumBytesToStream" is True
+
+private:
+  AsyncFileReader* fReadAhead; // non-NULL iff we're reading ahead
 };
 
 #endif
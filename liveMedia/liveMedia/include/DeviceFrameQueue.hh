@@ -0,0 +1,117 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A bounded, lock-free queue of frames, handed from (any number of) other threads -
+// e.g., a hardware encoder's - to the event loop, using an 'event trigger'.
+// C++ header
+
+#ifndef _DEVICE_FRAME_QUEUE_HH
+#define _DEVICE_FRAME_QUEUE_HH
+
+#ifndef _USAGE_ENVIRONMENT_HH
+#include "UsageEnvironment.hh"
+#endif
+#ifndef _NET_COMMON_H
+#include "NetCommon.h"
+#endif
+
+#ifndef DEVICE_FRAME_QUEUE_SIZE
+#define DEVICE_FRAME_QUEUE_SIZE 32
+#endif
+
+// A frame is passed by reference: The queue takes over the producer's buffer (rather
+// than copying its data), and gives it back - using the 'release' function - once the
+// consumer has finished with it.  (If the frame had to be dropped, then the 'release'
+// function is called at once, from the producer's thread.)
+typedef void DeviceFrameReleaseFunc(void* clientData, unsigned char* data, void* bufferId);
+
+struct DeviceFrame {
+  unsigned char* data;
+  unsigned size;
+  struct timeval presentationTime; // if 0, the time at which the frame was enqueued is used
+  unsigned durationInMicroseconds;
+  void* bufferId; // identifies the producer's buffer, for the 'release' function
+};
+
+class DeviceFrameQueue {
+public:
+  static DeviceFrameQueue* createNew(UsageEnvironment& env,
+				     TaskFunc* frameHandler, void* frameHandlerClientData,
+				     DeviceFrameReleaseFunc* releaseFunc = NULL,
+				     void* releaseClientData = NULL,
+				     unsigned queueSize = DEVICE_FRAME_QUEUE_SIZE);
+      // "frameHandler" is called (from the event loop) after frames have been enqueued.
+      // Each call may be for several frames, so it should "dequeue()" until it returns False.
+      // (Returns NULL if no more event triggers can be created.)
+  virtual ~DeviceFrameQueue(); // releases any frames still queued
+
+  // Called by the producer thread(s):
+  Boolean enqueue(DeviceFrame const& frame);
+      // Returns False - after releasing the frame - iff the queue was full (i.e., the
+      // event loop isn't keeping up).  Only the first frame enqueued after the event loop
+      // last emptied the queue triggers an event; the rest share that 'wakeup'.
+
+  // Called from the event loop:
+  Boolean dequeue(DeviceFrame& frame);
+      // Returns False iff the queue is empty.  The frame is now ours, to "release()" later.
+  void release(DeviceFrame const& frame);
+  Boolean isEmpty() const;
+
+  // Statistics, counted since we were created:
+  unsigned numFramesEnqueued() const { return fNumEnqueued; }
+  unsigned numFramesDropped() const { return fNumDropped; } // because the queue was full
+  unsigned numWakeups() const { return fNumWakeups; } // # of events triggered
+  unsigned peakQueueDepth() const { return fPeakDepth; }
+  unsigned averageQueueLatency() const; // from "enqueue()" to "dequeue()" (in microseconds)
+  unsigned maxQueueLatency() const { return fMaxLatency; }
+
+private:
+  DeviceFrameQueue(UsageEnvironment& env, EventTriggerId triggerId,
+		   TaskFunc* frameHandler, void* frameHandlerClientData,
+		   DeviceFrameReleaseFunc* releaseFunc, void* releaseClientData,
+		   unsigned queueSize);
+  static void eventHandler(void* clientData);
+
+private:
+  struct Slot {
+    unsigned volatile sequence; // (see "DeviceFrameQueue.cpp")
+    DeviceFrame frame;
+    u_int64_t enqueueTime;
+  };
+
+  UsageEnvironment& fEnv;
+  EventTriggerId fTriggerId;
+  TaskFunc* fFrameHandler;
+  void* fFrameHandlerClientData;
+  DeviceFrameReleaseFunc* fReleaseFunc;
+  void* fReleaseClientData;
+  Slot* fSlots;
+  unsigned fMask; // the number of slots (a power of 2) - 1
+
+  // Modified atomically, by any thread:
+  unsigned volatile fEnqueuePosition;
+  unsigned volatile fWakeupIsPending;
+  unsigned volatile fNumEnqueued, fNumDropped, fNumWakeups;
+
+  // Used only from the event loop:
+  unsigned fDequeuePosition;
+  unsigned fPeakDepth;
+  unsigned fNumDequeued, fMaxLatency;
+  u_int64_t fTotalLatency;
+};
+
+#endif
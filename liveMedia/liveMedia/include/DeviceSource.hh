@@ -27,6 +27,9 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #ifndef _FRAMED_SOURCE_HH
 #include "FramedSource.hh"
 #endif
+#ifndef _DEVICE_FRAME_QUEUE_HH
+#include "DeviceFrameQueue.hh"
+#endif
 
 // The following class can be used to define specific encoder parameters
 class DeviceParameters {
@@ -38,8 +41,11 @@ public:
   static DeviceSource* createNew(UsageEnvironment& env,
 				 DeviceParameters params);
 
-public:
-  static EventTriggerId eventTriggerId;
+  DeviceFrameQueue* frameQueue() const { return fFrameQueue; }
+      // The device's thread hands each new frame to us by calling "frameQueue()->enqueue()".
+      // (This - unlike other "LIVE555 Streaming Media" library code - may be called from a
+      //  separate thread.)  The queue's statistics count this source's dropped frames, and
+      // the frames' latency.
 
 protected:
   DeviceSource(UsageEnvironment& env, DeviceParameters params);
@@ -53,10 +59,12 @@ private:
 private:
   static void deliverFrame0(void* clientData);
   void deliverFrame();
+  static void releaseFrame(void* clientData, unsigned char* data, void* bufferId);
 
 private:
   static unsigned referenceCount; // used to count how many instances of this class currently exist
   DeviceParameters fParams;
+  DeviceFrameQueue* fFrameQueue; // (each source has its own queue, and event trigger)
 };
 
 #endif
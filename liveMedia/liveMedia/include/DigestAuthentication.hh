@@ -56,6 +56,15 @@ public:
   char const* computeDigestResponse(char const* cmd, char const* url) const;
   void reclaimDigestResponse(char const* responseStr) const;
 
+  static void computeHA1(char const* username, char const* realm, char const* password,
+			 char* resultBuf);
+      // Sets "resultBuf" (which must be at least 33 bytes long) to
+      // md5(<username>:<realm>:<password>), as a '\0'-terminated string of hex digits
+  static char const* computeDigestResponse(char const* ha1, char const* nonce,
+					   char const* cmd, char const* url);
+      // Like the "computeDigestResponse()" member function, except given a precomputed
+      // HA1 (see above).  The result must be reclaimed with "reclaimDigestResponse()".
+
 private:
   void resetRealmAndNonce();
   void resetUsernameAndPassword();
@@ -25,6 +25,8 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "MediaSink.hh"
 #endif
 
+class AsyncFileWriter; // forward
+
 class FileSink: public MediaSink {
 public:
   static FileSink* createNew(UsageEnvironment& env, char const* fileName,
@@ -41,6 +43,17 @@ public:
 	       struct timeval presentationTime);
   // (Available in case a client wants to add extra data to the output file)
 
+  // Output to a regular file goes through a write-behind buffer pool of this many buffers
+  // of this size, written to the file by a separate thread, so that a slow disk (e.g., a
+  // USB disk) doesn't stall the event loop.  Set these before calling "createNew()".
+  // (A "writeBehindNumBuffers" of 0 means: write directly to the file, from the event loop.)
+  static unsigned writeBehindBufferSize;
+  static unsigned writeBehindNumBuffers;
+
+  AsyncFileWriter const* writeBehindBuffer() const { return fOutput; }
+      // NULL if we're not using one; otherwise, for its statistics
+
+
 protected:
   FileSink(UsageEnvironment& env, FILE* fid, unsigned bufferSize,
 	   char const* perFrameFileNamePrefix);
@@ -56,6 +69,7 @@ protected:
 				  struct timeval presentationTime);
 
   FILE* fOutFid;
+  AsyncFileWriter* fOutput; // if non-NULL, all of our output to "fOutFid" goes through this
   unsigned char* fBuffer;
   unsigned fBufferSize;
   char* fPerFrameFileNamePrefix; // used if "oneFilePerFrame" is True
@@ -54,6 +54,13 @@ public:
       // size of the largest possible frame that we may serve, or 0
       // if no such maximum is known (default)
 
+  virtual Boolean canDeliverFrameReferences() const;
+      // If True, "getNextFrame()" may be called with "to" == NULL.  In this case,
+      // the frame is not copied; instead, "frameReference()" points to our own copy
+      // of the frame data, which remains valid until the next "getNextFrame()" call.
+      // (default: False)
+  unsigned char const* frameReference() const { return fFrameReference; }
+
   virtual void doGetNextFrame() = 0;
       // called by getNextFrame()
 
@@ -81,6 +88,7 @@ protected:
   unsigned fNumTruncatedBytes; // out
   struct timeval fPresentationTime; // out
   unsigned fDurationInMicroseconds; // out
+  unsigned char const* fFrameReference; // out (iff "fTo" == NULL)
 
 private:
   // redefined virtual functions:
@@ -0,0 +1,69 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A cache of the RTP packets that a (shared) "RTPSink" has most recently sent,
+// going back to the last 'random access point' (e.g., the start of a H.264 IDR
+// access unit, or a Transport Stream packet with its "random_access_indicator" set).
+// A client that joins an ongoing stream can be sent these packets at once, so that
+// it can start decoding right away, rather than waiting for the next such point.
+// C++ header
+
+#ifndef _GOP_CACHE_HH
+#define _GOP_CACHE_HH
+
+#ifndef _BOOLEAN_HH
+#include "Boolean.hh"
+#endif
+#ifndef _NET_COMMON_H
+#include "NetCommon.h"
+#endif
+
+class GOPCache {
+public:
+  GOPCache(unsigned maxCacheSize);
+      // "maxCacheSize" is the maximum number of bytes of packet data that we hold.
+      // If the packets since the last random access point don't fit, then the cache
+      // becomes unusable until the next random access point.
+  virtual ~GOPCache();
+
+  void reset(); // e.g., when the stream (re)starts
+  void addPacket(unsigned char const* packet, unsigned packetSize,
+		 Boolean isRandomAccessPoint);
+      // If "isRandomAccessPoint", the previously cached packets are discarded first
+
+  Boolean isUsable() const { return fIsValid && fNumPackets > 0; }
+      // True iff our first packet is a random access point,
+      // and we've held every packet sent since then
+  unsigned numPackets() const { return fNumPackets; }
+  unsigned numBytes() const { return fBytesUsed; }
+  unsigned char* const* packets() const { return fPackets; }
+  unsigned const* packetSizes() const { return fPacketSizes; }
+
+  // The RTP sequence number and timestamp of our first packet (valid only if "isUsable()"):
+  unsigned short firstSeqNo() const;
+  u_int32_t firstTimestamp() const;
+
+private:
+  unsigned char* fBuffer;
+  unsigned fBufferSize, fBytesUsed;
+  unsigned char** fPackets; // pointers into "fBuffer"
+  unsigned* fPacketSizes;
+  unsigned fMaxNumPackets, fNumPackets;
+  Boolean fIsValid;
+};
+
+#endif
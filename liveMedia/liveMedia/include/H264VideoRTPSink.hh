@@ -57,12 +57,15 @@ private: // redefined virtual functions:
                                       unsigned numRemainingBytes);
   virtual Boolean frameCanAppearAfterPacketStart(unsigned char const* frameStart,
 						 unsigned numBytesInFrame) const;
+  virtual Boolean frameIsRandomAccessPoint(unsigned char const* frameStart,
+					   unsigned numBytesInFrame);
 
 protected:
   H264FUAFragmenter* fOurFragmenter;
 
 private:
   char* fFmtpSDPLine;
+  Boolean fNextFragmentStartsAccessUnit, fCurAccessUnitIsRandomAccessPoint;
 };
 
 
@@ -73,6 +76,11 @@ private:
 // to the "H264VideoRTPSink", only fragments that will fit within an outgoing
 // RTP packet.  I.e., we implement fragmentation in this separate "H264FUAFragmenter"
 // class, rather than in "H264VideoRTPSink".
+// Consecutive small NAL units (e.g., SPS, PPS, SEI) from the same 'access unit'
+// are aggregated into a single STAP-A packet.  Each NAL unit is read (by our
+// input source) only once, into our buffer; every outgoing packet - STAP-A,
+// single NAL unit, or FU-A - is then copied from there directly into the sink's
+// packet buffer.
 // (Note: This class should be used only by "H264VideoRTPSink", or a subclass.)
 
 class H264FUAFragmenter: public FramedFilter {
@@ -82,6 +90,8 @@ public:
   virtual ~H264FUAFragmenter();
 
   Boolean lastFragmentCompletedNALUnit() const { return fLastFragmentCompletedNALUnit; }
+  Boolean lastFragmentCompletedAccessUnit() const { return fLastFragmentCompletedAccessUnit; }
+      // i.e., the most recently delivered packet should have its RTP 'M' bit set
 
 private: // redefined virtual functions:
   virtual void doGetNextFrame();
@@ -95,15 +105,46 @@ private:
                           unsigned numTruncatedBytes,
                           struct timeval presentationTime,
                           unsigned durationInMicroseconds);
+  static void handleInputClosure(void* clientData);
+  void handleInputClosure1();
+  void readNALUnit(unsigned offset);
+  Boolean canAggregateAnotherNALUnit() const;
+  void takePendingNALUnit();
+  unsigned nalUnitSize(unsigned offset) const {
+    return (fInputBuffer[offset-2]<<8)|fInputBuffer[offset-1];
+  }
+  void deliverPacket();
 
 private:
   unsigned fInputBufferSize;
   unsigned fMaxOutputPacketSize;
   unsigned char* fInputBuffer;
-  unsigned fNumValidDataBytes;
-  unsigned fCurDataOffset;
+      // Each NAL unit is stored with a 2-byte size field in front of it (as in a STAP-A),
+      // and the first one also has room for a STAP-A NAL header in front of that.
+  unsigned fNumValidDataBytes; // the offset just past the most recently read NAL unit
+  unsigned fReadOffset; // where the NAL unit that we're currently reading goes
+
+  // The group of (one or more) NAL units - with the same presentation time - that
+  // we're currently delivering:
+  unsigned fNumNALUnits;
+  unsigned fCurNALUnitOffset; // of the first undelivered NAL unit in the group
+  unsigned fCurNALUnitSize;
+  unsigned fCurDataOffset; // the next byte (of this NAL unit) to be sent, if we're sending FU-As
+  unsigned fAggregatedSize; // the size of the group's NAL units, if sent as a STAP-A
   unsigned fSaveNumTruncatedBytes;
+  unsigned fSaveDurationInMicroseconds;
+  Boolean fGroupEndsAccessUnit;
+
+  // A NAL unit that we've read, but that couldn't be added to the current group:
+  Boolean fHavePendingNALUnit;
+  unsigned fPendingNALUnitOffset, fPendingNALUnitSize;
+  struct timeval fPendingPresentationTime;
+  unsigned fPendingDurationInMicroseconds;
+  unsigned fPendingNumTruncatedBytes;
+  Boolean fPendingEndsAccessUnit;
+
   Boolean fLastFragmentCompletedNALUnit;
+  Boolean fLastFragmentCompletedAccessUnit;
 };
 
 
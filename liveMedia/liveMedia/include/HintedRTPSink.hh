@@ -0,0 +1,72 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A RTP sink that sends the pre-packetized RTP packets of a hint track (from a
+// "RTPHintTrackSource"), each at the time that it was originally due to be sent.
+// Only each packet's SSRC, sequence number and timestamp are rewritten.
+// C++ header
+
+#ifndef _HINTED_RTP_SINK_HH
+#define _HINTED_RTP_SINK_HH
+
+#ifndef _RTP_SINK_HH
+#include "RTPSink.hh"
+#endif
+#ifndef _RTP_HINT_CACHE_HH
+#include "RTPHintCache.hh"
+#endif
+
+class HintedRTPSink: public RTPSink {
+public:
+  static HintedRTPSink* createNew(UsageEnvironment& env, Groupsock* RTPgs,
+				  RTPHintTrackSource const& hintTrackSource);
+      // We take our RTP payload type and timestamp frequency from "hintTrackSource"
+      // (which must also be the source that we're played from).
+
+protected:
+  HintedRTPSink(UsageEnvironment& env, Groupsock* RTPgs,
+		RTPHintTrackSource const& hintTrackSource);
+	// called only by createNew()
+
+  virtual ~HintedRTPSink();
+
+protected: // redefined virtual functions
+  virtual Boolean continuePlaying();
+
+public:
+  virtual void stopPlaying();
+
+private:
+  void getNextPacket();
+  static void afterGettingPacket(void* clientData, unsigned packetSize,
+				 unsigned numTruncatedBytes,
+				 struct timeval dueTime,
+				 unsigned durationInMicroseconds);
+  void afterGettingPacket1(unsigned packetSize, struct timeval dueTime);
+  static void sendNext(void* clientData);
+  void sendPacket();
+  static void ourHandleClosure(void* clientData);
+
+private:
+  unsigned char* fPacket;
+  unsigned fPacketBufferSize, fPacketSize;
+  Boolean fIsFirstPacket;
+  struct timeval fStartTime, fStartDueTime; // when (and at which due time) we (re)started
+  u_int32_t fRecordedTimestampBase, fTimestampBase;
+};
+
+#endif
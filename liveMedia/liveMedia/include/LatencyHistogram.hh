@@ -0,0 +1,67 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A fixed-size histogram of latencies (in microseconds), from which percentiles
+// can be read.  Used for the round-trip delays, and per-frame latencies, that
+// "RTPSink"s and "RTPSource"s measure.
+// C++ header
+
+#ifndef _LATENCY_HISTOGRAM_HH
+#define _LATENCY_HISTOGRAM_HH
+
+#ifndef _BOOLEAN_HH
+#include "Boolean.hh"
+#endif
+
+class LatencyHistogram {
+public:
+  LatencyHistogram();
+
+  void record(int uSeconds);
+      // A negative latency (which can be measured if two clocks disagree) is
+      // counted in the lowest bucket, but keeps its value in "minUSecs()" and "meanUSecs()".
+  void reset();
+
+  unsigned numSamples() const { return fNumSamples; }
+  unsigned numNegativeSamples() const { return fNumNegativeSamples; }
+  int minUSecs() const { return fNumSamples == 0 ? 0 : fMinUSecs; }
+  int maxUSecs() const { return fNumSamples == 0 ? 0 : fMaxUSecs; }
+  double meanUSecs() const { return fNumSamples == 0 ? 0.0 : fTotalUSecs/fNumSamples; }
+
+  int percentileUSecs(double percent) const;
+      // The latency that "percent"% of the samples are no larger than (e.g., 50.0 for the median,
+      // 99.0 for the 99th percentile).  This is accurate to within 1/8 (12.5%) of the value.
+      // Returns 0 if there have been no samples.
+
+  // Bucket #i counts samples of at least "bucketLowerBoundUSecs(i)":
+  static unsigned const numBuckets = 240;
+  unsigned bucketCount(unsigned bucket) const {
+    return bucket < numBuckets ? fBuckets[bucket] : 0;
+  }
+  static unsigned bucketLowerBoundUSecs(unsigned bucket);
+
+private:
+  static unsigned bucketFor(unsigned uSeconds);
+
+private:
+  unsigned fNumSamples, fNumNegativeSamples;
+  int fMinUSecs, fMaxUSecs;
+  double fTotalUSecs;
+  unsigned fBuckets[numBuckets];
+};
+
+#endif
@@ -31,9 +31,19 @@ class MPEG1or2Demux: public Medium {
 public:
   static MPEG1or2Demux* createNew(UsageEnvironment& env,
 				  FramedSource* inputSource,
-				  Boolean reclaimWhenLastESDies = False);
+				  Boolean reclaimWhenLastESDies = False,
+				  unsigned streamBufferSize = 0);
   // If "reclaimWhenLastESDies" is True, the the demux is deleted when
   // all "MPEG1or2DemuxedElementaryStream"s that we created get deleted.
+  // If "streamBufferSize" is non-zero, each elementary stream gets a ring
+  // buffer of (at least) that many bytes, and PES packets for a stream
+  // whose reader is not ready are parsed into it, rather than stopping
+  // the parser until that reader asks for data.  The parser then stops
+  // only when a ring buffer is full.  This lets streams that are read
+  // out of step (e.g., the audio and video of a program stream) each be
+  // read at their own pace.
+
+  enum { DEFAULT_STREAM_BUFFER_SIZE = 1000000 };
 
   MPEG1or2DemuxedElementaryStream* newElementaryStream(u_int8_t streamIdTag);
 
@@ -79,9 +89,24 @@ public:
 
   void flushInput(); // should be called before any 'seek' on the underlying source
 
+  // Backpressure statistics of one stream, when "streamBufferSize" is non-zero:
+  class StreamBufferStats {
+  public:
+    StreamBufferStats();
+
+    unsigned numFramesBuffered; // PES payloads parsed into the ring buffer
+    unsigned numFramesDropped;  // ... or dropped, because it was full before reading began
+    unsigned numBytesBuffered;  // bytes in the ring buffer now
+    unsigned maxBytesBuffered;  // high-water mark of the above
+    unsigned numParserStalls;   // times the parser stopped, because the ring buffer was full
+  };
+  Boolean getStreamBufferStats(u_int8_t streamIdTag, StreamBufferStats& stats) const;
+      // returns False if the stream has no ring buffer
+
 private:
   MPEG1or2Demux(UsageEnvironment& env,
-		FramedSource* inputSource, Boolean reclaimWhenLastESDies);
+		FramedSource* inputSource, Boolean reclaimWhenLastESDies,
+		unsigned streamBufferSize);
       // called only by createNew()
   virtual ~MPEG1or2Demux();
 
@@ -96,6 +121,10 @@ private:
 		       unsigned char* to, unsigned maxSize,
 		       FramedSource::afterGettingFunc* afterGettingFunc,
 		       void* afterGettingClientData);
+  Boolean useBufferedFrame(u_int8_t streamIdTag,
+			   unsigned char* to, unsigned maxSize,
+			   FramedSource::afterGettingFunc* afterGettingFunc,
+			   void* afterGettingClientData);
 
   static void continueReadProcessing(void* clientData,
 				     unsigned char* ptr, unsigned size,
@@ -115,6 +144,7 @@ private:
   unsigned char fNextVideoStreamNumber;
   Boolean fReclaimWhenLastESDies;
   unsigned fNumOutstandingESs;
+  unsigned fStreamBufferSize;
 
   // A descriptor for each possible stream id tag:
   typedef struct OutputDescriptor {
@@ -131,6 +161,9 @@ private:
     SavedData* savedDataHead;
     SavedData* savedDataTail;
     unsigned savedDataTotalSize;
+    class FrameRing; // forward
+    FrameRing* frameRing; // used instead of the above if "fStreamBufferSize" is non-zero
+    StreamBufferStats bufferStats;
 
     // status parameters
     Boolean isPotentiallyReadable;
@@ -40,6 +40,14 @@ public:
   static MPEG2IFrameIndexFromTransportStream*
   createNew(UsageEnvironment& env, FramedSource* inputSource);
 
+  void setStartingPoint(unsigned long firstTransportPacketNumber,
+			float firstPCR, float lastPCR);
+      // Used when "inputSource" delivers only part of a Transport Stream file, beginning
+      // with packet number "firstTransportPacketNumber" (which should be a PAT).
+      // "firstPCR" is the first PCR in the file, and "lastPCR" is the last PCR before
+      // the starting point, so that our index records have the same packet numbers
+      // and PCRs as if the whole file had been indexed.
+
 protected:
   MPEG2IFrameIndexFromTransportStream(UsageEnvironment& env,
 				      FramedSource* inputSource);
@@ -68,6 +76,7 @@ private:
 
   Boolean deliverIndexRecord();
   Boolean parseFrame();
+  Boolean tagIndexRecords(unsigned frameSize, u_int8_t recordType);
   Boolean parseToNextCode(unsigned char& nextCode);
   void compactParseBuffer();
   void addToTail(IndexRecord* newIndexRecord);
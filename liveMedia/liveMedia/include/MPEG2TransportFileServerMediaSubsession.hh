@@ -36,13 +36,16 @@ public:
   static MPEG2TransportFileServerMediaSubsession*
   createNew(UsageEnvironment& env,
 	    char const* dataFileName, char const* indexFileName,
-	    Boolean reuseFirstSource);
+	    Boolean reuseFirstSource, Boolean useZeroCopyStreaming = False);
+      // If "useZeroCopyStreaming" is True, the file is memory-mapped, and RTP packets
+      // are sent directly from the mapping (with no copying of the payload data).
 
 protected:
   MPEG2TransportFileServerMediaSubsession(UsageEnvironment& env,
 					  char const* fileName,
 					  MPEG2TransportStreamIndexFile* indexFile,
-					  Boolean reuseFirstSource);
+					  Boolean reuseFirstSource,
+					  Boolean useZeroCopyStreaming = False);
       // called only by createNew();
   virtual ~MPEG2TransportFileServerMediaSubsession();
 
@@ -78,8 +81,9 @@ private:
 
 private:
   MPEG2TransportStreamIndexFile* fIndexFile;
-  float fDuration;
+  mutable float fDuration; // updated by "duration()", if the index file grows
   HashTable* fClientSessionHashTable; // indexed by client session id
+  Boolean fUseZeroCopyStreaming;
 };
 
 #endif
@@ -43,6 +43,28 @@ public:
   void clearPIDStatusTable();
   void setNumTSPacketsToStream(unsigned long numTSRecordsToStream);
   Boolean switchTransport(int port, int fTCP = 0);
+
+  // Pacing: If enabled, we deliver our output at a steady rate - the rate implied by the
+  // stream's PCRs - using a token bucket of "bucketSize" bytes (i.e., we never deliver
+  // more than "bucketSize" bytes at once, beyond that rate).  Our downstream sink then
+  // sends everything as soon as it gets it (we return "fDurationInMicroseconds" as 0).
+  void enablePacing(unsigned bucketSize = 7*188);
+  void disablePacing();
+  void setPacingSocket(int socketNum);
+      // Optional: Also keeps the kernel's "SO_MAX_PACING_RATE" for "socketNum" (e.g., our
+      // "RTPSink"'s socket) slightly above our current rate, so that the NIC smooths out
+      // any bursts that scheduling jitter still produces.
+  unsigned pacingRate() const; // bytes/second; 0 if not yet known
+
+  // A histogram of the sizes of our output "bursts" (deliveries made within 1 ms of each other):
+  // "burstSizeCount(i)" is the number of bursts of between 2^i and 2^(i+1)-1 TS packets.
+  // (The last bucket counts all larger bursts.)
+  static unsigned const numBurstSizeBuckets = 10;
+  unsigned burstSizeCount(unsigned bucket) const {
+    return bucket < numBurstSizeBuckets ? fBurstSizeHistogram[bucket] : 0;
+  }
+  void resetBurstSizeHistogram();
+
 protected:
   MPEG2TransportStreamFramer(UsageEnvironment& env, FramedSource* inputSource,Boolean is_wfd);
       // called only by createNew()
@@ -52,6 +74,7 @@ private:
   // Redefined virtual functions:
   virtual void doGetNextFrame();
   virtual void doStopGettingFrames();
+  virtual Boolean canDeliverFrameReferences() const;
 
 private:
   static void afterGettingFrame(void* clientData, unsigned frameSize,
@@ -63,6 +86,10 @@ private:
 
   void updateTSPacketDurationEstimate(unsigned char* pkt, double timeNow);
 
+  void deliverPaced();
+  static void deliverPacedFrame(void* clientData);
+  void noteDelivery(double timeNow);
+
 private:
   unsigned long fTSPacketCount;
   double fTSPacketDurationEstimate;
@@ -73,6 +100,16 @@ private:
   int fTransport; //0:UDP, 1:TCP
   FramedSource* fUDPSource;
   Boolean is_for_wfd;
+
+  Boolean fPacingIsEnabled;
+  unsigned fPacingBucketSize;
+  double fPacingTokens; // bytes; negative if we've delivered ahead of our rate
+  double fLastTokenUpdateTime;
+  int fPacingSocketNum;
+  unsigned fSocketPacingRate; // the "SO_MAX_PACING_RATE" that we last set
+  double fLastDeliveryTime;
+  unsigned fCurBurstSize; // TS packets
+  unsigned fBurstSizeHistogram[numBurstSizeBuckets];
 };
 
 #endif
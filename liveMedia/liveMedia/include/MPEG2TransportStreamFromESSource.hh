@@ -28,14 +28,18 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 
 class MPEG2TransportStreamFromESSource: public MPEG2TransportStreamMultiplexor {
 public:
-  static MPEG2TransportStreamFromESSource* createNew(UsageEnvironment& env);
+  static MPEG2TransportStreamFromESSource* createNew(UsageEnvironment& env,
+						     unsigned numPrograms = 1);
+      // If "numPrograms" > 1, we generate a multi-program Transport Stream.
 
-  void addNewVideoSource(FramedSource* inputSource, int mpegVersion);
+  void addNewVideoSource(FramedSource* inputSource, int mpegVersion,
+			 unsigned programIndex = 0);
       // Note: For MPEG-4 video, set "mpegVersion" to 4; for H.264 video, set "mpegVersion"to 5.
-  void addNewAudioSource(FramedSource* inputSource, int mpegVersion);
+  void addNewAudioSource(FramedSource* inputSource, int mpegVersion,
+			 unsigned programIndex = 0);
 
 protected:
-  MPEG2TransportStreamFromESSource(UsageEnvironment& env);
+  MPEG2TransportStreamFromESSource(UsageEnvironment& env, unsigned numPrograms);
       // called only by createNew()
   virtual ~MPEG2TransportStreamFromESSource();
 
@@ -46,13 +50,14 @@ private:
 
 private:
   void addNewInputSource(FramedSource* inputSource,
-			 u_int8_t streamId, int mpegVersion);
+			 u_int8_t streamId, int mpegVersion, unsigned programIndex);
   // used to implement addNew*Source() above
 
 private:
   friend class InputESSourceRecord;
   class InputESSourceRecord* fInputSources;
-  unsigned fVideoSourceCounter, fAudioSourceCounter;
+  unsigned* fVideoSourceCounter; // indexed by program
+  unsigned* fAudioSourceCounter; // indexed by program
 };
 
 #endif
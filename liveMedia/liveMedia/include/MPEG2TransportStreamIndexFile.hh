@@ -57,6 +57,8 @@ public:
 				unsigned long& transportPacketNum, u_int8_t& offset,
 				u_int8_t& size, float& pcr, u_int8_t& recordType);
   float getPlayingDuration();
+      // Note: The index file may still be growing (if it's for a recording that's still in
+      // progress).  If so, this returns the duration up to the current 'live edge'.
   void stopReading() { closeFid(); }
 
   int mpegVersion();
@@ -66,9 +68,12 @@ public:
 private:
   MPEG2TransportStreamIndexFile(UsageEnvironment& env, char const* indexFileName);
 
+  void updateNumIndexRecords(); // in case the file has grown
+  Boolean mapFile();
+  void unmapFile();
   Boolean openFid();
   Boolean seekToIndexRecord(unsigned long indexRecordNumber);
-  Boolean readIndexRecord(unsigned long indexRecordNum); // into "fBuf"
+  Boolean readIndexRecord(unsigned long indexRecordNum); // sets "fBuf"
   Boolean readOneIndexRecord(unsigned long indexRecordNum); // closes "fFid" at end
   void closeFid();
 
@@ -90,7 +95,12 @@ private:
   float fCachedPCR;
   unsigned long fCachedTSPacketNumber, fCachedIndexRecordNumber;
   unsigned long fNumIndexRecords;
-  unsigned char fBuf[INDEX_RECORD_SIZE]; // used for reading index records from file
+  unsigned char* fMappedRecords; // the whole index file, memory-mapped (if possible)
+  size_t fMappedSize;
+  int fMappedFileDescriptor; // kept open, so that we can see the file grow
+  Boolean fMappingFailed;
+  unsigned char const* fBuf; // the most recently read index record
+  unsigned char fReadBuf[INDEX_RECORD_SIZE]; // used for reading index records from "fFid"
 };
 
 #endif
@@ -0,0 +1,83 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A filter that passes a Transport Stream through unchanged (e.g., to a "FileSink"
+// that's recording it), while also appending - as each Transport Stream packet
+// arrives - index records for it to an index file.  The index file can be used
+// (by "MPEG2TransportStreamIndexFile") for 'trick play' on the recording, even
+// while it is still in progress.
+// C++ header
+
+#ifndef _MPEG2_TRANSPORT_STREAM_INDEX_WRITER_HH
+#define _MPEG2_TRANSPORT_STREAM_INDEX_WRITER_HH
+
+#ifndef _MPEG2_IFRAME_INDEX_FROM_TRANSPORT_STREAM_HH
+#include "MPEG2IndexFromTransportStream.hh"
+#endif
+#ifndef _MPEG2_TRANSPORT_STREAM_INDEX_FILE_HH
+#include "MPEG2TransportStreamIndexFile.hh"
+#endif
+
+class IndexerPacketSource; // forward
+
+class MPEG2TransportStreamIndexWriter: public FramedFilter {
+public:
+  static MPEG2TransportStreamIndexWriter*
+  createNew(UsageEnvironment& env, FramedSource* inputSource,
+	    char const* indexFileName);
+      // Note: The Transport Stream data must be written (by our reader) to the start of a
+      // new file, so that our index records' Transport Stream packet numbers are correct.
+
+protected:
+  MPEG2TransportStreamIndexWriter(UsageEnvironment& env, FramedSource* inputSource,
+				  FILE* indexFid);
+      // called only by createNew()
+  virtual ~MPEG2TransportStreamIndexWriter();
+
+private:
+  // Redefined virtual functions:
+  virtual void doGetNextFrame();
+
+private:
+  static void afterGettingFrame(void* clientData, unsigned frameSize,
+				unsigned numTruncatedBytes,
+				struct timeval presentationTime,
+				unsigned durationInMicroseconds);
+  void afterGettingFrame1(unsigned frameSize,
+			  unsigned numTruncatedBytes,
+			  struct timeval presentationTime,
+			  unsigned durationInMicroseconds);
+
+  static void handleInputClosure(void* clientData);
+  void handleInputClosure1();
+
+  void requestIndexRecords();
+  static void afterGettingIndexRecord(void* clientData, unsigned frameSize,
+				      unsigned numTruncatedBytes,
+				      struct timeval presentationTime,
+				      unsigned durationInMicroseconds);
+  static void handleIndexerClosure(void* clientData);
+
+private:
+  FILE* fIndexFid;
+  IndexerPacketSource* fPacketSource; // feeds our input data to "fIndexer"
+  MPEG2IFrameIndexFromTransportStream* fIndexer;
+  Boolean fIsRequestingIndexRecords, fIndexerHasClosed;
+  unsigned char fIndexRecord[INDEX_RECORD_SIZE];
+};
+
+#endif
@@ -29,31 +29,48 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "MPEG1or2Demux.hh" // for SCR
 #endif
 
-#define PID_TABLE_SIZE 256
+#define MAX_NUM_TRANSPORT_STREAM_PROGRAMS 15
 
 class MPEG2TransportStreamMultiplexor: public FramedSource {
+public:
+  void setProgramNumber(unsigned programIndex, u_int16_t programNumber);
+      // By default, program "programIndex" (0 <= programIndex < "numPrograms") has
+      // program_number "programIndex"+1.
+
 protected:
-  MPEG2TransportStreamMultiplexor(UsageEnvironment& env);
+  MPEG2TransportStreamMultiplexor(UsageEnvironment& env, unsigned numPrograms = 1);
+      // "numPrograms" (at most MAX_NUM_TRANSPORT_STREAM_PROGRAMS) is the number of
+      // programs that will be carried in the output Transport Stream.
   virtual ~MPEG2TransportStreamMultiplexor();
 
   virtual void awaitNewBuffer(unsigned char* oldBuffer) = 0;
       // implemented by subclasses
 
   void handleNewBuffer(unsigned char* buffer, unsigned bufferSize,
-		       int mpegVersion, MPEG1or2Demux::SCR scr);
+		       int mpegVersion, MPEG1or2Demux::SCR scr,
+		       unsigned programIndex = 0);
   // called by "awaitNewBuffer()"
   // Note: For MPEG-4 video, set "mpegVersion" to 4; for H.264 video, set "mpegVersion" to 5. 
+  // Each program's PES "stream_id"s map to their own PIDs: (programIndex<<8)|stream_id
+
+  void setHaveVideoStreams(unsigned programIndex, Boolean haveVideoStreams);
+      // Used (instead of "fHaveVideoStreams") if there is more than one program
+
+  unsigned numPrograms() const { return fNumPrograms; }
 
 private:
   // Redefined virtual functions:
   virtual void doGetNextFrame();
 
 private:
-  void deliverDataToClient(u_int8_t pid, unsigned char* buffer, unsigned bufferSize,
+  void deliverNextPacket();
+  void deliverDataToClient(u_int16_t pid, unsigned char* buffer, unsigned bufferSize,
 			   unsigned& startPositionInBuffer);
 
   void deliverPATPacket();
-  void deliverPMTPacket(Boolean hasChanged);
+  void deliverPMTPacket(unsigned programIndex, Boolean hasChanged);
+  void buildPAT();
+  void buildPMT(unsigned programIndex);
 
   void setProgramStreamMap(unsigned frameSize);
 
@@ -61,20 +78,23 @@ protected:
   Boolean fHaveVideoStreams;
 
 private:
+  unsigned fNumPrograms;
   unsigned fOutgoingPacketCounter;
-  unsigned fProgramMapVersion;
-  u_int8_t fPreviousInputProgramMapVersion, fCurrentInputProgramMapVersion;
-      // These two fields are used if we see "program_stream_map"s in the input.
-  struct {
-    unsigned counter;
-    u_int8_t streamType; // for use in Program Maps
-  } fPIDState[PID_TABLE_SIZE];
-  u_int8_t fPCR_PID, fCurrentPID;
-      // Note: We map 8-bit stream_ids directly to PIDs
-  MPEG1or2Demux::SCR fPCR;
+  unsigned fPMTInterval; // # of packets between consecutive (any program's) PMTs
+  unsigned fNextPMTProgram; // the program whose PMT will be sent next (periodically)
+  class MPEG2TransportStreamProgramState* fPrograms; // an array, indexed by program index
+  class MPEG2TransportStreamPIDState* fPIDState;
+      // an array, indexed by PID (up to "fNumPrograms"*256)
+  u_int16_t fCurrentPID;
+  unsigned fCurrentProgram;
   unsigned char* fInputBuffer;
   unsigned fInputBufferSize, fInputBufferBytesUsed;
   Boolean fIsFirstAdaptationField;
+
+  // Our PAT is kept - already built - until it changes:
+  unsigned char* fPATPayload;
+  Boolean fPATIsStale;
+  unsigned fPATVersion;
 };
 
 #endif
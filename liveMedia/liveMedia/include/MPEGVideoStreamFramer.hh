@@ -42,6 +42,9 @@ public:
 
   void flushInput(); // called if there is a discontinuity (seeking) in the input
 
+  void setMaxParserBufferSize(unsigned maxBufferSize);
+      // limits how large a single picture (or NAL unit) in the input may be
+
 protected:
   MPEGVideoStreamFramer(UsageEnvironment& env, FramedSource* inputSource);
       // we're an abstract base class
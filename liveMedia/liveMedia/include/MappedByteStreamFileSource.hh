@@ -0,0 +1,74 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A file source that is a plain byte stream (rather than frames), read
+// through a (sliding) memory-mapped window of the file.  Readers that pass
+// a NULL buffer to "getNextFrame()" get a reference into the mapping,
+// rather than a copy.
+// C++ header
+
+#ifndef _MAPPED_BYTE_STREAM_FILE_SOURCE_HH
+#define _MAPPED_BYTE_STREAM_FILE_SOURCE_HH
+
+#ifndef _BYTE_STREAM_FILE_SOURCE_HH
+#include "ByteStreamFileSource.hh"
+#endif
+
+class MappedByteStreamFileSource: public ByteStreamFileSource {
+public:
+  static MappedByteStreamFileSource* createNew(UsageEnvironment& env,
+					       char const* fileName,
+					       unsigned preferredFrameSize = 0,
+					       unsigned playTimePerFrame = 0,
+					       unsigned frameGranularity = 1);
+      // "frameGranularity" (e.g., 188 for a Transport Stream) is a unit that each
+      // delivered frame (other than the last one in the file) is a multiple of.
+      // Returns NULL (and a "ByteStreamFileSource" should be used instead) if
+      // the file cannot be memory-mapped (e.g., because it is a pipe).
+
+  virtual void seekToByteAbsolute(u_int64_t byteNumber, u_int64_t numBytesToStream = 0);
+  virtual void seekToByteRelative(int64_t offset);
+
+protected:
+  MappedByteStreamFileSource(UsageEnvironment& env, FILE* fid,
+			     unsigned preferredFrameSize,
+			     unsigned playTimePerFrame,
+			     unsigned frameGranularity);
+      // called only by createNew()
+
+  virtual ~MappedByteStreamFileSource();
+
+private:
+  Boolean mapWindowFor(u_int64_t offset, unsigned size);
+  void unmapWindow();
+  static void deliverFrame(void* clientData);
+
+private:
+  // redefined virtual functions:
+  virtual void doGetNextFrame();
+  virtual void doStopGettingFrames();
+  virtual Boolean canDeliverFrameReferences() const;
+
+private:
+  unsigned fFrameGranularity;
+  u_int64_t fCurOffset;
+  unsigned char* fWindow;
+  u_int64_t fWindowOffset; // file offset of "fWindow[0]"
+  unsigned fWindowSize;
+};
+
+#endif
@@ -65,7 +65,8 @@ protected:
   virtual ~MediaSession();
 
   Boolean initializeWithSDP(char const* sdpDescription);
-  Boolean parseSDPLine(char const* input, char const*& nextLine);
+  Boolean initializeWithSDPLines(char* sdpLines, char const* sdpDescription);
+  Boolean parseSDPLine(char* input, char*& nextLine);
   Boolean parseSDPLine_s(char const* sdpLine);
   Boolean parseSDPLine_i(char const* sdpLine);
   Boolean parseSDPLine_c(char const* sdpLine);
@@ -237,6 +238,8 @@ protected:
   Boolean parseSDPAttribute_control(char const* sdpLine);
   Boolean parseSDPAttribute_range(char const* sdpLine);
   Boolean parseSDPAttribute_fmtp(char const* sdpLine);
+  void setFmtpParameter(char const* name, unsigned nameLength,
+			char const* value, unsigned valueLength);
   Boolean parseSDPAttribute_source_filter(char const* sdpLine);
   Boolean parseSDPAttribute_x_dimensions(char const* sdpLine);
   Boolean parseSDPAttribute_framerate(char const* sdpLine);
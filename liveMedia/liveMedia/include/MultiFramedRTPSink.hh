@@ -26,10 +26,32 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "RTPSink.hh"
 #endif
 
+#define RTP_BATCH_HISTOGRAM_SIZE 8
+
 class MultiFramedRTPSink: public RTPSink {
 public:
   void setPacketSizes(unsigned preferredPacketSize, unsigned maxPacketSize);
 
+  void setPacketBatching(unsigned maxPacketsPerBatch, unsigned batchWindowUSecs = 0,
+			 Boolean useUDPGSO = False);
+      // If "maxPacketsPerBatch" > 1, packets that are due to be sent within
+      // "batchWindowUSecs" of the first packet in the batch are collected, and then
+      // sent together (using "sendmmsg()", and - optionally - UDP segmentation
+      // offload).  A batch is flushed as soon as the next packet is due later than
+      // this, when it's full, or when the stream ends.  (Note that packets within
+      // a batch may be sent up to "batchWindowUSecs" early.)
+      // (By default, no batching is done.)
+
+  // Batching statistics:
+  unsigned numBatchFlushes() const { return fNumBatchFlushes; }
+  unsigned numBatchedPackets() const { return fNumBatchedPackets; }
+  unsigned maxPacketsInABatch() const { return fMaxPacketsInABatch; }
+  unsigned batchSizeHistogram(unsigned bucket) const {
+    return bucket < RTP_BATCH_HISTOGRAM_SIZE ? fBatchSizeHistogram[bucket] : 0;
+  }
+      // bucket #i counts flushes that carried between 2^i and 2^(i+1)-1 packets
+      // (with the last bucket also counting all larger flushes)
+
 protected:
   MultiFramedRTPSink(UsageEnvironment& env,
 		     Groupsock* rtpgs, unsigned char rtpPayloadType,
@@ -65,6 +87,12 @@ protected:
       // frame of size "newFrameSize" to the current RTP packet.
       // (By default, this just calls "numOverflowBytes()", but subclasses can redefine
       // this to (e.g.) impose a granularity upon RTP payload fragments.)
+  virtual Boolean frameIsRandomAccessPoint(unsigned char const* frameStart,
+					   unsigned numBytesInFrame);
+      // whether a receiver can start decoding at this frame (by default: True).
+      // Called - only if we have a "GOPCache" or a hint track recorder - for the
+      // start of each frame (or fragment) that we pack; a packet that contains such
+      // a frame is recorded (in each) as a random access point.
 
   // Functions that might be called by doSpecialFrameHandling(), or other subclass virtual functions:
   Boolean isFirstPacket() const { return fIsFirstPacket; }
@@ -94,6 +122,7 @@ private:
   void buildAndSendPacket(Boolean isFirstPacket);
   void packFrame();
   void sendPacketIfNecessary();
+  void flushPacketBatch();
   static void sendNext(void* firstArg);
   friend void sendNext(void*);
 
@@ -125,6 +154,21 @@ private:
   unsigned fCurFrameSpecificHeaderSize; // size in bytes of cur frame-specific header
   unsigned fTotalFrameSpecificHeaderSizes; // size of all frame-specific hdrs in pkt
   unsigned fOurMaxPacketSize;
+  Boolean fCurPacketIsRandomAccessPoint;
+  struct timeval fStartTime, fCurPacketDueTime; // for our hint track recorder, if any
+
+  // Packet batching (if enabled):
+  unsigned fMaxPacketsPerBatch;
+  unsigned fBatchWindowUSecs;
+  struct timeval fBatchStartTime;
+  unsigned fBatchSlotSize;
+  unsigned char* fBatchBuffer;
+  unsigned char** fBatchPackets;
+  unsigned* fBatchPacketSizes;
+  Boolean* fBatchPacketIsRandomAccessPoint; // for our "GOPCache", if any
+  unsigned fNumPacketsInBatch;
+  unsigned fNumBatchFlushes, fNumBatchedPackets, fMaxPacketsInABatch;
+  unsigned fBatchSizeHistogram[RTP_BATCH_HISTOGRAM_SIZE];
 };
 
 #endif
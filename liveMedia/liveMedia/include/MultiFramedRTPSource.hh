@@ -47,6 +47,25 @@ protected:
 						    unsigned packetSize);
       // The default implementation returns True, but this can be redefined
 
+public:
+  void useAdaptiveJitterBuffer(unsigned minDelayUSeconds = 20000,
+			       unsigned maxDelayUSeconds = 1000000);
+      // Instead of waiting a fixed time ("setPacketReorderingThresholdTime()") for a
+      // missing packet to arrive, wait for a time that follows the measured interarrival
+      // jitter - and late packet arrivals - within the given bounds.
+      // (Calling "setPacketReorderingThresholdTime()" reverts to a fixed time.)
+
+  // Statistics about our jitter (packet reordering) buffer:
+  unsigned jitterBufferDelay() const; // the current reordering threshold (in microseconds)
+  unsigned jitterBufferDepth() const; // # of packets currently queued
+  unsigned numLatePacketsDropped() const; // # that arrived after we'd given up on them
+  unsigned numConcealmentEvents() const; // # of times we gave up waiting for missing packets
+
+  // Statistics about our pool of "BufferedPacket"s:
+  unsigned numPacketPoolHits() const;
+  unsigned numPacketPoolMisses() const; // # of packets that had to be allocated anew
+  unsigned peakNumBufferedPackets() const; // the most packets in use at once
+
 protected:
   Boolean fCurrentPacketBeginsFrame;
   Boolean fCurrentPacketCompletesFrame;
@@ -66,6 +85,8 @@ private:
 
   static void networkReadHandler(MultiFramedRTPSource* source, int /*mask*/);
   void networkReadHandler1();
+  void readPacketBatch();
+  Boolean processIncomingPacket(BufferedPacket* bPacket, struct timeval const& timeReceived);
 
   Boolean fAreDoingNetworkReads;
   BufferedPacket* fPacketReadInProgress;
@@ -92,6 +113,10 @@ public:
   unsigned useCount() const { return fUseCount; }
 
   Boolean fillInData(RTPInterface& rtpInterface, Boolean& packetReadWasIncomplete);
+  unsigned char* prepareForRead(unsigned& maxSize); // resets the packet
+  void noteBytesRead(unsigned numBytesRead) { fTail += numBytesRead; }
+      // the two functions above are used instead of "fillInData()" when packets are read
+      // in batches (into the buffer returned by "prepareForRead()")
   void assignMiscParams(unsigned short rtpSeqNo, unsigned rtpTimestamp,
 			struct timeval presentationTime,
 			Boolean hasBeenSyncedUsingRTCP,
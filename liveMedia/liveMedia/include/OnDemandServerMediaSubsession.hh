@@ -29,7 +29,19 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "RTPSink.hh"
 #endif
 
+#ifndef DEFAULT_GOP_CACHE_SIZE
+#define DEFAULT_GOP_CACHE_SIZE (2*1024*1024)
+#endif
+
 class OnDemandServerMediaSubsession: public ServerMediaSubsession {
+public:
+  void enableGOPCache(unsigned maxCacheSize = DEFAULT_GOP_CACHE_SIZE);
+      // Meaningful only if "reuseFirstSource" is True.  The (shared) stream's most recent
+      // packets - back to its last random access point - are then kept, and sent at once
+      // to each client that joins the stream, so that it can start decoding right away
+      // (without another read of the input source).  Note that "maxCacheSize" also
+      // bounds the burst of data that's sent to a joining client.
+
 protected: // we're a virtual base class
   OnDemandServerMediaSubsession(UsageEnvironment& env, Boolean reuseFirstSource,
 				portNumBits initialPortNum = 6970);
@@ -62,6 +74,7 @@ public://#####@@@@@
   virtual void seekStream(unsigned clientSessionId, void* streamToken, double seekNPT, double streamDuration);
   virtual void setStreamScale(unsigned clientSessionId, void* streamToken, float scale);
   virtual void deleteStream(unsigned clientSessionId, void*& streamToken);
+  virtual RTPSink* rtpSinkForStream(void* streamToken);
 
 protected: // new virtual functions, possibly redefined by subclasses
   virtual char const* getAuxSDPLine(RTPSink* rtpSink,
@@ -70,6 +83,9 @@ protected: // new virtual functions, possibly redefined by subclasses
     // "streamDuration", if >0.0, specifies how much data to stream, past "seekNPT".  (If <=0.0, all remaining data is streamed.)
   virtual void setStreamSourceScale(FramedSource* inputSource, float scale);
   virtual void closeStreamSource(FramedSource *inputSource);
+  virtual char const* sdpCacheFileName() const;
+      // The file whose SDP lines may be cached (in our session's "SDPCache", if any).
+      // The default implementation returns NULL, meaning: don't cache.
 
 protected: // new virtual functions, defined by all subclasses
   virtual FramedSource* createNewStreamSource(unsigned clientSessionId,
@@ -83,12 +99,17 @@ private:
   void setSDPLinesFromRTPSink(RTPSink* rtpSink, FramedSource* inputSource,
 			      unsigned estBitrate);
       // used to implement "sdpLines()"
+  char const* hintCacheFileName();
+      // The file whose RTP packets may be kept in our session's "RTPHintCache" (if any),
+      // or NULL.  (Only subsessions that stream at normal speed only are hinted.)
+  RTPHintTrackRecorder* newHintTrackRecorder(RTPSink* rtpSink, unsigned estBitrate);
 
 protected:
   char* fSDPLines;
 
 private:
   Boolean fReuseFirstSource;
+  unsigned fGOPCacheSize; // 0 means: no GOP cache
   portNumBits fInitialPortNum;
   HashTable* fDestinationsHashTable; // indexed by client session id
   void* fLastStreamToken;
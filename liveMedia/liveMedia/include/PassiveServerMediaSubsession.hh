@@ -65,6 +65,7 @@ protected: // redefined virtual functions
                            unsigned& rtpTimestamp,
 			   ServerRequestAlternativeByteHandler* serverRequestAlternativeByteHandler,
                            void* serverRequestAlternativeByteHandlerClientData);
+  virtual RTPSink* rtpSinkForStream(void* streamToken);
 
 protected:
   char* fSDPLines;
@@ -24,6 +24,9 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #ifndef _MEDIA_SESSION_HH
 #include "MediaSession.hh"
 #endif
+#ifndef _ASYNC_FILE_WRITER_HH
+#include "AsyncFileWriter.hh"
+#endif
 
 class QuickTimeFileSink: public Medium {
 public:
@@ -37,7 +40,13 @@ public:
 				      Boolean packetLossCompensate = False,
 				      Boolean syncStreams = False,
 				      Boolean generateHintTracks = False,
-				      Boolean generateMP4Format = False);
+				      Boolean generateMP4Format = False,
+				      unsigned fragmentDuration = 0);
+      // If "fragmentDuration" (in milliseconds) is non-zero, then we write a fragmented
+      // MP4 file instead: A "moov" atom (with empty sample tables), followed by a
+      // "moof"+"mdat" pair for each fragment of (about) this duration.  (For H.264
+      // video, each fragment begins at an IDR frame.)  The memory that we use then stays
+      // constant, however long the recording.  (Hint tracks aren't supported in this mode.)
 
   typedef void (afterPlayingFunc)(void* clientData);
   Boolean startPlaying(afterPlayingFunc* afterFunc,
@@ -51,7 +60,7 @@ private:
 		    unsigned short movieWidth, unsigned short movieHeight,
 		    unsigned movieFPS, Boolean packetLossCompensate,
 		    Boolean syncStreams, Boolean generateHintTracks,
-		    Boolean generateMP4Format);
+		    Boolean generateMP4Format, unsigned fragmentDuration);
       // called only by createNew()
   virtual ~QuickTimeFileSink();
 
@@ -64,11 +73,17 @@ private:
   void onSourceClosure1();
   static void onRTCPBye(void* clientData);
   void completeOutputFile();
+  void completeNonFragmentedOutputFile();
+  void startNewFragmentIfNeeded(class SubsessionIOState& ioState,
+				struct timeval const& presentationTime,
+				unsigned char const* frameData);
+  void completeFragment();
 
 private:
   friend class SubsessionIOState;
   MediaSession& fInputSession;
   FILE* fOutFid;
+  AsyncFileWriter* fOutput; // all of our output to "fOutFid" goes through this
   unsigned fBufferSize;
   Boolean fPacketLossCompensate;
   Boolean fSyncStreams, fGenerateMP4Format;
@@ -89,7 +104,7 @@ private:
   unsigned addWord(unsigned word);
   unsigned addHalfWord(unsigned short halfWord);
   unsigned addByte(unsigned char byte) {
-    putc(byte, fOutFid);
+    fOutput->putByte(byte);
     return 1;
   }
   unsigned addZeroWords(unsigned numWords);
@@ -155,6 +170,7 @@ private:
                       _atom(stsc);
                       _atom(stsz);
                       _atom(co64);
+                      unsigned addAtom_emptyTable(char const* atomName, unsigned numZeroWords);
           _atom(udta);
               _atom(name);
               _atom(hnti);
@@ -175,6 +191,14 @@ private:
                   _atom(dmax);
                   _atom(payt);
   unsigned addAtom_dummy();
+  _atom(mvex); // for fragmented MP4 files
+      _atom(trex);
+  _atom(moof); // ditto
+      _atom(mfhd);
+      _atom(traf);
+          _atom(tfhd);
+          _atom(tfdt);
+          _atom(trun);
 
 private:
   unsigned short fMovieWidth, fMovieHeight;
@@ -183,6 +207,14 @@ private:
   int64_t fMVHD_durationPosn;
   unsigned fMaxTrackDurationM; // in movie time units
   class SubsessionIOState* fCurrentIOState;
+
+  // State used when writing a fragmented MP4 file:
+  unsigned fFragmentDuration; // ms; 0 if we're not writing a fragmented file
+  class SubsessionIOState* fFragmentTriggerTrack; // whose frames decide when a fragment ends
+  Boolean fHaveWrittenInitSegment; // i.e., our "ftyp" and "moov"
+  Boolean fHaveFragmentStartTime;
+  struct timeval fFragmentStartTime;
+  unsigned fFragmentSequenceNumber;
 };
 
 #endif
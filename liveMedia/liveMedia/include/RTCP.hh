@@ -80,6 +80,20 @@ public:
       // a specific source address and port.  (Note that if both a specific
       // and a general "RR" handler function is set, then both will be called.)
 
+  void setBandwidthFraction(double fraction);
+      // Sets the fraction of "totSessionBW" that RTCP (from all participants) may use.
+      // The default (from RFC 3550) is 0.05.  A smaller fraction means less-frequent reports.
+  void setReducedSizeRTCP(Boolean useReducedSize, unsigned fullReportPeriod = 5);
+      // If "useReducedSize" is True, then - as allowed by RFC 5506 - we also accept
+      // incoming non-compound RTCP packets, and send most of our own reports as just a
+      // SR or RR (without a SDES).  Our first report, and every "fullReportPeriod"th report
+      // after that, is still a full compound packet (so that receivers learn our CNAME).
+      // (Use this only if the session's SDP included "a=rtcp-rsize".)
+  void setReceiverReportSuppression(Boolean suppress);
+      // If "suppress" is True, and we're only a receiver (i.e., we have no "RTPSink"), then we
+      // don't send periodic "RR"s (but still send a "BYE" when we go away).  This is intended
+      // for receive-only clients in a large multicast group, where the sender doesn't use "RR"s.
+
   Groupsock* RTCPgs() const { return fRTCPInterface.gs(); }
 
   void setStreamSocket(int sockNum, unsigned char streamChannelId);
@@ -166,6 +180,11 @@ private:
   void* fRRHandlerClientData;
   AddressPortLookupTable* fSpecificRRHandlerTable;
 
+  double fBandwidthFraction;
+  Boolean fUseReducedSizeRTCP;
+  unsigned fFullReportPeriod, fNumReportsUntilFullReport;
+  Boolean fSuppressReceiverReports;
+
 public: // because this stuff is used by an external "C" function
   void schedule(double nextTime);
   void reschedule(double nextTime);
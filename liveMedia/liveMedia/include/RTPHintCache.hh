@@ -0,0 +1,140 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A cache of 'hint tracks': the RTP packets - and the times at which they were
+// due to be sent - that were produced the first time that a track of a
+// file-based server media subsession was streamed in full.  Later streams of the
+// same track can be sent from the cache (by a "HintedRTPSink"), with no framing
+// or packetization.  Each track is stored as a file in the cache's directory, and
+// is valid only while the original file's modification time and size stay the same.
+// C++ header
+
+#ifndef _RTP_HINT_CACHE_HH
+#define _RTP_HINT_CACHE_HH
+
+#ifndef _FRAMED_SOURCE_HH
+#include "FramedSource.hh"
+#endif
+#include <stdio.h>
+
+class RTPHintTrackSource; // forward
+class RTPHintTrackRecorder; // forward
+
+class RTPHintCache {
+public:
+  RTPHintCache(char const* cacheDirName, u_int64_t maxTrackSize = 0);
+      // "cacheDirName" is an (existing) directory, in which each hint track is kept
+      // as a file.  If "maxTrackSize" is non-zero, tracks whose packets would take
+      // more than this many bytes aren't cached.
+  virtual ~RTPHintCache();
+
+  RTPHintTrackSource* lookup(UsageEnvironment& env, char const* fileName, char const* trackId);
+      // Returns a new source that delivers the cached packets for this track of
+      // "fileName", or NULL if there are none, or if the file has changed since they
+      // were recorded.
+  RTPHintTrackRecorder* newRecorder(char const* fileName, char const* trackId,
+				    unsigned char rtpPayloadType,
+				    unsigned rtpTimestampFrequency, unsigned estBitrate);
+      // Returns NULL if this track can't be recorded (e.g., if "fileName" can't be found)
+
+  unsigned numHits() const { return fNumHits; }
+  unsigned numMisses() const { return fNumMisses; }
+  unsigned numTracksRecorded() const { return fNumTracksRecorded; }
+
+private:
+  friend class RTPHintTrackRecorder;
+  static Boolean getFileStamp(char const* fileName, long& modificationTime, u_int64_t& fileSize);
+  static char* makeKey(char const* fileName, char const* trackId);
+  char* hintFileName(char const* key) const;
+
+private:
+  char* fCacheDirName;
+  u_int64_t fMaxTrackSize;
+  unsigned fNumRecorders; // used to give each recording its own temporary file
+  unsigned fNumHits, fNumMisses, fNumTracksRecorded;
+};
+
+// Records one hint track.  (Created only by "RTPHintCache::newRecorder()".)
+class RTPHintTrackRecorder {
+public:
+  virtual ~RTPHintTrackRecorder();
+      // discards the recording, unless "finish()" was called first
+
+  void addPacket(unsigned char const* packet, unsigned packetSize,
+		 u_int64_t dueUSecs, Boolean isRandomAccessPoint);
+  void addPacket(unsigned char const* header, unsigned headerSize,
+		 unsigned char const* payload, unsigned payloadSize,
+		 u_int64_t dueUSecs, Boolean isRandomAccessPoint);
+      // "dueUSecs" is the time - since the start of the track - at which the packet was
+      // due to be sent.  If "isRandomAccessPoint", a receiver can start decoding at
+      // this packet (so a later stream of the track can be started, or seeked, from it).
+
+  Boolean finish();
+      // Makes the track (which must have been recorded from its start, to its end, at
+      // normal speed) available to later lookups.  Returns False iff it couldn't be saved.
+
+private:
+  friend class RTPHintCache;
+  RTPHintTrackRecorder(RTPHintCache& cache, FILE* fid,
+		       char* tempFileName, char* hintFileName);
+
+private:
+  RTPHintCache& fCache;
+  FILE* fFid;
+  char* fTempFileName;
+  char* fHintFileName;
+  u_int64_t fNumBytes;
+  unsigned fNumPackets, fMaxPacketSize;
+  Boolean fHaveFailed;
+};
+
+// Delivers - as 'frames' - the packets of a hint track.  (Created only by
+// "RTPHintCache::lookup()".)  Each packet's 'presentation time' is the time -
+// since the start of the track - at which it's due to be sent.
+class RTPHintTrackSource: public FramedSource {
+public:
+  unsigned char rtpPayloadType() const { return fRTPPayloadType; }
+  unsigned rtpTimestampFrequency() const { return fRTPTimestampFrequency; }
+  unsigned estBitrate() const { return fEstBitrate; } // in kbps
+  unsigned maxPacketSize() const { return fMaxPacketSize; }
+
+  void seekToTime(double seekNPT, double streamDuration);
+      // Makes the next packet the first random access point at or after "seekNPT".
+      // "streamDuration", if >0.0, specifies how much data to deliver, past "seekNPT".
+  Boolean lastPacketWasRandomAccessPoint() const { return fLastPacketWasRandomAccessPoint; }
+
+private:
+  friend class RTPHintCache;
+  RTPHintTrackSource(UsageEnvironment& env, FILE* fid,
+		     unsigned char rtpPayloadType, unsigned rtpTimestampFrequency,
+		     unsigned estBitrate, unsigned maxPacketSize);
+      // called only by "RTPHintCache::lookup()"
+  virtual ~RTPHintTrackSource();
+
+private: // redefined virtual functions:
+  virtual void doGetNextFrame();
+
+private:
+  FILE* fFid;
+  int64_t fFirstPacketOffset;
+  unsigned char fRTPPayloadType;
+  unsigned fRTPTimestampFrequency, fEstBitrate, fMaxPacketSize;
+  u_int64_t fEndUSecs; // 0 means: deliver until the end of the track
+  Boolean fLastPacketWasRandomAccessPoint;
+};
+
+#endif
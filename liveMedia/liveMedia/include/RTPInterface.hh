@@ -50,6 +50,7 @@ public:
   tcpStreamRecord* fNext;
   int fStreamSocketNum;
   unsigned char fStreamChannelId;
+  class SocketDescriptor* fSocketDescriptor; // queues our output to "fStreamSocketNum"
 };
 
 class RTPInterface {
@@ -65,10 +66,28 @@ public:
   void setServerRequestAlternativeByteHandler(int socketNum, ServerRequestAlternativeByteHandler* handler, void* clientData);
 
   void sendPacket(unsigned char* packet, unsigned packetSize);
+  void sendPacketv(unsigned char const* header, unsigned headerSize,
+		   unsigned char const* payload, unsigned payloadSize);
+      // like "sendPacket()", but with the packet in two parts, neither of which is copied
+      // (except for RTP-over-TCP)
+  void sendPackets(unsigned char* const* packets, unsigned const* packetSizes,
+		   unsigned numPackets);
+      // like calling "sendPacket()" for each packet, but with batched UDP sends
+      // (and, for RTP-over-TCP, with all of the packets coalesced into one write)
+  void sendPacketsToStreamSocket(int sockNum, unsigned char streamChannelId,
+				 unsigned char* const* packets, unsigned const* packetSizes,
+				 unsigned numPackets);
+      // like "sendPackets()", but only to one of our TCP streams
+      // (e.g., to bring a newly-added client up to date)
   void startNetworkReading(TaskScheduler::BackgroundHandlerProc*
                            handlerProc);
   Boolean handleRead(unsigned char* buffer, unsigned bufferMaxSize,
 		     unsigned& bytesRead, struct sockaddr_in& fromAddress, Boolean& packetReadWasIncomplete);
+  int handleReadBatch(unsigned char* const* buffers, unsigned const* bufferMaxSizes,
+		      unsigned numBuffers, unsigned* bytesRead,
+		      struct sockaddr_in* fromAddresses, struct timeval* receptionTimes);
+      // reads several waiting datagrams at once (see "Groupsock::handleReadBatch()");
+      // used only when "nextTCPReadStreamSocketNum()" < 0
   void stopNetworkReading();
 
   UsageEnvironment& envir() const { return fOwner->envir(); }
@@ -79,6 +98,21 @@ public:
     fAuxReadHandlerClientData = handlerClientData;
   }
 
+  // Output over TCP is queued (per socket) if the socket would block:
+  unsigned numBytesQueuedForTCPOutput() const; // summed over our TCP streams
+  unsigned numTCPPacketsDropped() const; // because a TCP output queue overflowed
+  unsigned numUDPSendErrors() const { return fNumUDPSendErrors; }
+      // the number of (batches of) UDP packets that could not be sent (e.g., because the socket's buffer was full)
+  Boolean tcpOutputIsBacklogged() const;
+      // True iff one of our TCP streams has so much queued output that our caller
+      // should wait (for it to drain) before sending more
+  static unsigned tcpOutputQueueSize(UsageEnvironment& env, int socketNum);
+      // the number of bytes queued for output to (e.g., a RTSP client's) TCP socket
+  static void sendDataOverTCP(UsageEnvironment& env, int socketNum,
+			      unsigned char const* data, unsigned dataSize);
+      // Sends other data (e.g., a RTSP response) on a TCP socket that may also be
+      // carrying RTP/RTCP - after any RTP/RTCP data that's already queued for it.
+
   // A hack for supporting handlers for RTCP packets arriving interleaved over TCP:
   int nextTCPReadStreamSocketNum() const { return fNextTCPReadStreamSocketNum; }
   unsigned char nextTCPReadStreamChannelId() const { return fNextTCPReadStreamChannelId; }
@@ -97,6 +131,8 @@ private:
 
   AuxHandlerFunc* fAuxReadHandlerFunc;
   void* fAuxReadHandlerClientData;
+
+  unsigned fNumUDPSendErrors;
 };
 
 #endif
@@ -27,8 +27,13 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #ifndef _RTP_INTERFACE_HH
 #include "RTPInterface.hh"
 #endif
+#ifndef _LATENCY_HISTOGRAM_HH
+#include "LatencyHistogram.hh"
+#endif
 
 class RTPTransmissionStatsDB; // forward
+class GOPCache; // forward
+class RTPHintTrackRecorder; // forward
 
 class RTPSink: public MediaSink {
 public:
@@ -84,11 +89,39 @@ public:
     fRTPInterface.setServerRequestAlternativeByteHandler(socketNum, handler, clientData);
   }
     // hacks to allow sending RTP over TCP (RFC 2236, section 10.12)
+  void sendPacketsToStreamSocket(int sockNum, unsigned char streamChannelId,
+				 unsigned char* const* packets, unsigned const* packetSizes,
+				 unsigned numPackets) {
+    fRTPInterface.sendPacketsToStreamSocket(sockNum, streamChannelId,
+					    packets, packetSizes, numPackets);
+  }
+
+  void setGOPCache(GOPCache* gopCache) { fGOPCache = gopCache; }
+  GOPCache* gopCache() const { return fGOPCache; }
+      // If set, each packet that we send is also recorded in "gopCache" (which we don't own)
+
+  void setHintTrackRecorder(RTPHintTrackRecorder* recorder) { fHintTrackRecorder = recorder; }
+  RTPHintTrackRecorder* hintTrackRecorder() const { return fHintTrackRecorder; }
+      // If set, each packet that we send is also recorded - with the time, since we
+      // started playing, at which it was due to be sent - in "recorder" (which we don't own)
 
   void getTotalBitrate(unsigned& outNumBytes, double& outElapsedTime);
       // returns the number of bytes sent since the last time that we
       // were called, and resets the counter.
 
+  // Statistics (e.g., for monitoring a server), counted since we were created:
+  u_int64_t numBytesSent() const { return fNumBytesSent; } // including RTP headers
+  unsigned numSendErrors() const { return fRTPInterface.numUDPSendErrors(); }
+  unsigned numTCPPacketsDropped() const { return fRTPInterface.numTCPPacketsDropped(); }
+  unsigned numTCPBacklogWaits() const { return fNumTCPBacklogWaits; }
+      // the number of times that we paused, because a RTP-over-TCP client wasn't keeping up
+  u_int64_t processingTimeUSecs() const { return fProcessingTimeUSecs; }
+      // the time spent packing frames into packets, and sending them
+  LatencyHistogram const& sendLatencyHistogram() const { return fSendLatencyHistogram; }
+  void resetSendLatencyHistogram() { fSendLatencyHistogram.reset(); }
+      // For each frame: the time at which its last packet was sent, minus the
+      // presentation time (e.g., the capture time) that its RTP timestamp represents
+
 protected:
   RTPSink(UsageEnvironment& env,
 	  Groupsock* rtpGS, unsigned char rtpPayloadType,
@@ -99,9 +132,18 @@ protected:
 
   virtual ~RTPSink();
 
+  void addProcessingTimeSince(struct timeval const& startTime);
+      // adds the time since "startTime" to "fProcessingTimeUSecs"
+  void noteSendLatency(u_int32_t rtpTimestamp, struct timeval const& timeSent);
+      // called each time that a packet with RTP timestamp "rtpTimestamp" is sent
+
   RTPInterface fRTPInterface;
   unsigned char fRTPPayloadType;
   unsigned fPacketCount, fOctetCount, fTotalOctetCount /*incl RTP hdr*/;
+  u_int64_t fNumBytesSent; unsigned fNumTCPBacklogWaits;
+  u_int64_t fProcessingTimeUSecs;
+  GOPCache* fGOPCache;
+  RTPHintTrackRecorder* fHintTrackRecorder;
   struct timeval fTotalOctetCountStartTime;
   u_int32_t fCurrentTimestamp;
   u_int16_t fSeqNo;
@@ -117,6 +159,10 @@ private:
   char const* fRTPPayloadFormatName;
   unsigned fNumChannels;
   struct timeval fCreationTime;
+  LatencyHistogram fSendLatencyHistogram;
+  Boolean fHaveCurFrameSendLatency;
+  u_int32_t fCurFrameTimestamp; // of the frame whose latency we're measuring
+  int fCurFrameSendLatencyUSecs;
 
   RTPTransmissionStatsDB* fTransmissionStatsDB;
 };
@@ -178,6 +224,10 @@ public:
   unsigned roundTripDelay() const;
       // The round-trip delay (in units of 1/65536 seconds) computed from
       // the most recently-received RTCP RR packet.
+  LatencyHistogram const& roundTripDelayHistogram() const { return fRoundTripDelayHistogram; }
+  void resetRoundTripDelayHistogram() { fRoundTripDelayHistogram.reset(); }
+      // The round-trip delays (in microseconds) from each RTCP RR packet that
+      // reported on one of our RTCP SRs
   struct timeval timeCreated() const {return fTimeCreated;}
   struct timeval lastTimeReceived() const {return fTimeReceived;}
   void getTotalOctetCount(u_int32_t& hi, u_int32_t& lo);
@@ -219,6 +269,7 @@ private:
   unsigned fFirstPacketNumReported;
   u_int32_t fLastOctetCount, fTotalOctetCount_hi, fTotalOctetCount_lo;
   u_int32_t fLastPacketCount, fTotalPacketCount_hi, fTotalPacketCount_lo;
+  LatencyHistogram fRoundTripDelayHistogram;
 };
 
 #endif
@@ -27,6 +27,9 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #ifndef _RTP_INTERFACE_HH
 #include "RTPInterface.hh"
 #endif
+#ifndef _LATENCY_HISTOGRAM_HH
+#include "LatencyHistogram.hh"
+#endif
 
 class RTPReceptionStatsDB; // forward
 
@@ -139,7 +142,9 @@ public:
 			  Boolean useForJitterCalculation,
 			  struct timeval& resultPresentationTime,
 			  Boolean& resultHasBeenSyncedUsingRTCP,
-			  unsigned packetSize /* payload only */);
+			  unsigned packetSize /* payload only */,
+			  struct timeval const* timeReceived = NULL);
+      // If "timeReceived" is NULL, the packet is assumed to have been received just now
 
   // The following is called whenever a RTCP SR packet is received:
   void noteIncomingSR(u_int32_t SSRC,
@@ -203,6 +208,26 @@ public:
     return fTotalInterPacketGaps;
   }
 
+  // Latency statistics.  These compare times from our clock with times from the sender's
+  // clock, so they include any offset between the two clocks (and are end-to-end
+  // latencies only if both are synchronized - e.g., using NTP):
+  LatencyHistogram const& frameLatencyHistogram() const { return fFrameLatencyHistogram; }
+  void resetFrameLatencyHistogram() { fFrameLatencyHistogram.reset(); }
+      // For each frame (i.e., each run of in-order packets with the same RTP timestamp)
+      // received after the first RTCP SR: the time at which its last packet arrived,
+      // minus the sender's 'wall clock' time for its RTP timestamp (e.g., its capture time).
+  int lastSRTransitUSecs() const { return fLastSRTransitUSecs; }
+  int minSRTransitUSecs() const { return fMinSRTransitUSecs; }
+      // The time at which a RTCP SR arrived, minus the sender's NTP timestamp in it
+      // (for the most recent SR, and the smallest seen so far).  This is the SR's network
+      // delay, plus the amount by which our clock is ahead of the sender's.  (0 if no SR yet)
+  int estimatedClockOffsetUSecs(unsigned roundTripDelayUSecs) const {
+    return fMinSRTransitUSecs - (int)(roundTripDelayUSecs/2);
+  }
+      // How much our clock is ahead of the sender's, given the round-trip delay (e.g., as
+      // measured by the sender, from our RTCP RRs).  This assumes that the network delay
+      // is symmetric.
+
 protected:
   // called only by RTPReceptionStatsDB:
   friend class RTPReceptionStatsDB;
@@ -216,7 +241,8 @@ private:
 			  Boolean useForJitterCalculation,
 			  struct timeval& resultPresentationTime,
 			  Boolean& resultHasBeenSyncedUsingRTCP,
-			  unsigned packetSize /* payload only */);
+			  unsigned packetSize /* payload only */,
+			  struct timeval const* timeReceived);
   void noteIncomingSR(u_int32_t ntpTimestampMSW, u_int32_t ntpTimestampLSW,
 		      u_int32_t rtpTimestamp);
   void init(u_int32_t SSRC);
@@ -244,12 +270,19 @@ protected:
   struct timeval fLastPacketReceptionTime;
   unsigned fMinInterPacketGapUS, fMaxInterPacketGapUS;
   struct timeval fTotalInterPacketGaps;
+  LatencyHistogram fFrameLatencyHistogram;
+  int fLastSRTransitUSecs, fMinSRTransitUSecs;
 
 private:
   // Used to convert from RTP timestamp to 'wall clock' time:
   Boolean fHasBeenSynchronized;
   u_int32_t fSyncTimestamp;
   struct timeval fSyncTime;
+
+  // The frame whose latency we're measuring (recorded once a later frame begins):
+  Boolean fHaveCurFrameLatency;
+  u_int32_t fCurFrameRTPTimestamp;
+  int fCurFrameLatencyUSecs;
 };
 
 
@@ -90,6 +90,19 @@ public:
       // Issues a RTSP "SETUP" command, then returns the "CSeq" sequence number that was used in the command.
       // (The "responseHandler" and "authenticator" parameters are as described for "sendDescribeCommand".)
 
+  unsigned sendSetupCommands(MediaSession& session, responseHandler* responseHandler,
+			     Boolean streamOutgoing = False,
+			     Boolean streamUsingTCP = False,
+			     Boolean forceMulticastOnUnspecified = False,
+			     Authenticator* authenticator = NULL);
+      // Issues RTSP "SETUP" commands for each subsession of "session" that has been initiated (i.e., has a "readSource()"),
+      //     without waiting for each response before sending the next command.  (If we don't yet have a session id, then the
+      //     first "SETUP" is sent alone, and the rest are sent - using the session id - as soon as its response arrives.)
+      // Returns the "CSeq" sequence number that was used in the first command.
+      // "responseHandler" is called once, after all of the responses have arrived.  "resultCode" is 0 iff each
+      //     "SETUP" succeeded; otherwise it (and "resultString") come from the first one that failed.
+      // (Only one such operation can be in progress at a time.)
+
   unsigned sendPlayCommand(MediaSession& session, responseHandler* responseHandler,
 			   double start = 0.0f, double end = -1.0f, float scale = 1.0f,
 			   Authenticator* authenticator = NULL);
@@ -141,6 +154,13 @@ public:
       //  of an implementation of a 'timeout handler' on the command, for example.)
       // This function returns True iff "cseq" was for a valid previously-performed command (whose response is still unhandled).
 
+  Boolean changeURL(char const* rtspURL);
+      // Makes subsequent commands apply to "rtspURL" instead.  If this names the same server (and port) as before, and
+      //     no commands are outstanding, then our existing TCP connection is kept, and reused for these commands.
+      //     Otherwise, we close it, and (later) connect to the new server.  Returns True iff the connection was kept.
+      // (Any previous session should first be "TEARDOWN"d; its session id is forgotten.)
+  char const* url() const { return fBaseURL; }
+
   int socketNum() const { return fInputSocketNum; }
 
     // move by wen.tang: from private func -> public func  (for WFD TCP connection)
@@ -257,6 +277,12 @@ protected:
 			      char const*& separator,
 			      char const*& suffix);
 
+  // Support for "sendSetupCommands()":
+  unsigned sendRemainingSetupCommands(MediaSubsession* subsessionAlreadySetUp);
+  static void responseHandlerForSetupCommands(RTSPClient* rtspClient, int responseCode, char* responseString);
+  void responseHandlerForSetupCommands1(int responseCode, char* responseString);
+  void completeSetupCommands();
+
   // Support for tunneling RTSP-over-HTTP:
   Boolean setupHTTPTunneling1(); // send the HTTP "GET"
   static void responseHandlerForHTTP_GET(RTSPClient* rtspClient, int responseCode, char* responseString);
@@ -279,6 +305,7 @@ protected:
   unsigned fUserAgentHeaderStrLen;
   int fInputSocketNum, fOutputSocketNum;
   unsigned fServerAddress;
+  portNumBits fServerPortNum; // (from the URL; not any HTTP tunneling port)
   unsigned fCSeq; // sequence number, used in consecutive requests
   char* fBaseURL;
   Authenticator fCurrentAuthenticator;
@@ -289,6 +316,15 @@ protected:
   unsigned fResponseBytesAlreadySeen, fResponseBufferBytesLeft;
   RequestQueue fRequestsAwaitingConnection, fRequestsAwaitingHTTPTunneling, fRequestsAwaitingResponse;
 
+  // Support for "sendSetupCommands()":
+  MediaSession* fSetupCommandsSession; // non-NULL iff an operation is in progress
+  responseHandler* fSetupCommandsHandler;
+  Boolean fSetupCommandsStreamOutgoing, fSetupCommandsStreamUsingTCP, fSetupCommandsForceMulticast;
+  MediaSubsession* fFirstSetupSubsession; // non-NULL while we wait for the response to a first (lone) "SETUP"
+  unsigned fNumSetupResponsesPending;
+  int fSetupCommandsResultCode;
+  char* fSetupCommandsResultString;
+
   // Support for tunneling RTSP-over-HTTP:
   char fSessionCookie[33];
   unsigned fSessionCookieCounter;
@@ -47,4 +47,34 @@ Boolean parseRTSPRequestString(char const *reqStr, unsigned reqStrSize,
 Boolean parseRangeParam(char const* paramStr, double& rangeStart, double& rangeEnd);
 Boolean parseRangeHeader(char const* buf, double& rangeStart, double& rangeEnd);
 
+char const* findHeaderByScanning(char const* buf, char const* headerName);
+    // Returns a pointer to the value (after any white space) of the first "<headerName>:"
+    // (compared case-insensitively) in "buf", or NULL if there is none.
+
+// An index of the header lines of a RTSP (or HTTP) message.  It is built - a line at a
+// time - while the message is being received, so that once the message is complete,
+// each header can be found without rescanning the message.
+#define RTSP_MAX_INDEXED_HEADERS 32
+
+class RTSPHeaderIndex {
+public:
+  RTSPHeaderIndex() { reset(); }
+  void reset() { fNumHeaders = 0; fOverflowed = False; }
+
+  void noteLine(char const* message, unsigned lineStart, unsigned lineEnd);
+      // Called for each complete line "message[lineStart..lineEnd-1]" (excluding its <CR><LF>)
+  Boolean isComplete() const { return !fOverflowed; }
+      // False if the message had too many headers for us to index
+  char const* lookup(char const* message, char const* headerName) const;
+      // Like "findHeaderByScanning()", but uses the index
+
+private:
+  struct HeaderLocation {
+    unsigned short nameOffset, valueOffset;
+    unsigned char nameLength;
+  } fHeaders[RTSP_MAX_INDEXED_HEADERS];
+  unsigned fNumHeaders;
+  Boolean fOverflowed;
+};
+
 #endif
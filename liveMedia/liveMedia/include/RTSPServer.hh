@@ -30,6 +30,12 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #ifndef _DIGEST_AUTHENTICATION_HH
 #include "DigestAuthentication.hh"
 #endif
+#ifndef _BASE64_HH
+#include "Base64.hh"
+#endif
+#ifndef _RTSP_COMMON_HH
+#include "RTSPCommon.hh"
+#endif
 
 // A data structure used for optional user/password authentication:
 
@@ -48,11 +54,17 @@ public:
   virtual char const* lookupPassword(char const* username);
       // returns NULL if the user name was not present
 
+  char const* lookupHA1(char const* username);
+      // returns md5(<username>:<realm>:<password>) - as a string of hex digits - or
+      // NULL if the user name was not present.  This is computed just once per user
+      // (unless "lookupPassword()" later returns a different password for them).
+
   char const* realm() { return fRealm; }
   Boolean passwordsAreMD5() { return fPasswordsAreMD5; }
 
 protected:
   HashTable* fTable;
+  HashTable* fHA1Table; // caches the results of "lookupHA1()"
   char* fRealm;
   Boolean fPasswordsAreMD5;
 };
@@ -101,6 +113,19 @@ public:
       // Note: RTSP-over-HTTP tunneling is described in http://developer.apple.com/quicktime/icefloe/dispatch028.html
   portNumBits httpServerPortNum() const; // in host byte order.  (Returns 0 if not present.)
 
+  int rtspServerSocketNum() const { return fRTSPServerSocket; } // our listening socket
+
+  void enableStatistics(char const* urlSuffix = "stats", Boolean onlyForLocalClients = True);
+      // Starts measuring our event loop's latency, and makes a (JSON) report of our
+      // statistics - client sessions, and the packets, bytes, send errors, output queue
+      // overflows and processing time of each of their streams - available via HTTP,
+      // as "http://<our-address>:<port>/<urlSuffix>" (where <port> is our RTSP-over-HTTP
+      // tunneling port, or our RTSP port).  If "onlyForLocalClients" is True, then the
+      // report is given only to clients on this host.
+  char* statisticsReport();
+      // returns the same report, as a string to be delete[]d
+  unsigned numClientSessions() const;
+
 protected:
   RTSPServer(UsageEnvironment& env,
 	     int ourSocket, Port ourPort,
@@ -109,7 +134,9 @@ protected:
       // called only by createNew();
   virtual ~RTSPServer();
 
-  static int setUpOurSocket(UsageEnvironment& env, Port& ourPort);
+  static int setUpOurSocket(UsageEnvironment& env, Port& ourPort, Boolean reusePort = False);
+      // If "reusePort" is True, other servers (e.g., in other threads) may listen on
+      // the same port; the kernel then spreads incoming connections among them.
   virtual Boolean specialClientAccessCheck(int clientSocket, struct sockaddr_in& clientAddr,
 					   char const* urlSuffix);
       // a hook that allows subclassed servers to do server-specific access checking
@@ -161,10 +188,14 @@ protected:
     virtual void handleHTTPCmd_TunnelingGET(char const* sessionCookie);
     virtual Boolean handleHTTPCmd_TunnelingPOST(char const* sessionCookie, unsigned char const* extraData, unsigned extraDataSize);
     virtual void handleHTTPCmd_StreamingGET(char const* urlSuffix, char const* fullRequestStr);
+    virtual void handleHTTPCmd_Statistics();
   protected:
+    friend class RTSPServer; // for "statisticsReport()"
     UsageEnvironment& envir() { return fOurServer.envir(); }
     void reclaimStreamStates();
     void resetRequestBuffer();
+    char const* lookupHeader(char const* fullRequestStr, char const* headerName) const;
+        // Returns the value of a request header (or NULL), using "fRequestHeaders" if possible
     Boolean authenticationOK(char const* cmdName, char const* cseq,
                              char const* urlSuffix,
                              char const* fullRequestStr);
@@ -174,6 +205,8 @@ protected:
     static void handleAlternativeRequestByte(void*, u_int8_t requestByte);
     void handleAlternativeRequestByte1(u_int8_t requestByte);
     void handleRequestBytes(int newBytesRead);
+    void handleTunneledRequestBytes(char const* encodedBytes, int numEncodedBytes);
+        // Base64-decodes RTSP-over-HTTP data into our request buffer, then handles it
     void noteLiveness();
     static void noteClientLiveness(RTSPClientSession* clientSession);
     static void livenessTimeoutTask(RTSPClientSession* clientSession);
@@ -189,10 +222,10 @@ protected:
     unsigned char fRequestBuffer[RTSP_BUFFER_SIZE];
     unsigned fRequestBytesAlreadySeen, fRequestBufferBytesLeft;
     unsigned char* fLastCRLF;
-    unsigned fBase64RemainderCount; // used for optional RTSP-over-HTTP tunneling (possible values: 0,1,2,3)
+    RTSPHeaderIndex fRequestHeaders; // built as each line of the request arrives
+    Base64Decoder fBase64Decoder; // used for optional RTSP-over-HTTP tunneling
     unsigned char fResponseBuffer[RTSP_BUFFER_SIZE];
     Boolean fIsMulticast, fSessionIsActive, fStreamAfterSETUP;
-    Authenticator fCurrentAuthenticator; // used if access control is needed
     unsigned char fTCPStreamIdCount; // used for (optional) RTP/TCP
     unsigned fNumStreamStates;
     struct streamState {
@@ -226,6 +259,9 @@ private:
 
   void incomingConnectionHandler(int serverSocket);
 
+  static void loopLatencyProbe(void* instance);
+  void loopLatencyProbe1();
+
 private:
   friend class RTSPClientSession;
   friend class ServerMediaSessionIterator;
@@ -237,6 +273,23 @@ private:
   UserAuthenticationDatabase* fAuthDB;
   unsigned fReclamationTestSeconds;
   HashTable* fServerMediaSessions;
+  // Digest authentication uses a server-wide nonce that changes every
+  // "AUTH_NONCE_LIFETIME_SECONDS"; the previous one is also still accepted:
+  char const* currentNonce();
+  Boolean nonceIsValid(char const* nonce);
+  u_int32_t fNonceSecret[4];
+  long fNoncePeriod;
+  char fCurrentNonce[33], fPreviousNonce[33];
+  // Statistics:
+  HashTable* fClientSessions; // all of our current "RTSPClientSession"s
+  unsigned fNumClientSessionsCreated;
+  char* fStatisticsURLSuffix; // non-NULL iff statistics are enabled
+  Boolean fStatisticsOnlyForLocalClients;
+  struct timeval fStatisticsStartTime;
+  TaskToken fLoopLatencyProbeTask;
+  struct timeval fNextLoopLatencyProbeTime;
+  unsigned fNumLoopLatencySamples, fLastLoopLatencyUSecs, fMaxLoopLatencyUSecs;
+  u_int64_t fTotalLoopLatencyUSecs;
 };
 
 #endif
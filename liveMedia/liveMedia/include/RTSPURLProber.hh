@@ -0,0 +1,86 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// Probes many "rtsp://" URLs (using "DESCRIBE") concurrently, with a bounded number of
+// probes in flight, reusing each server's TCP connection for later URLs on that server.
+// C++ header
+
+#ifndef _RTSP_URL_PROBER_HH
+#define _RTSP_URL_PROBER_HH
+
+#ifndef _RTSP_CLIENT_HH
+#include "RTSPClient.hh"
+#endif
+
+class RTSPURLProber: public Medium {
+public:
+  static RTSPURLProber* createNew(UsageEnvironment& env,
+				  unsigned maxNumProbesInFlight = 16,
+				  unsigned timeoutSeconds = 10,
+				  int verbosityLevel = 0,
+				  char const* applicationName = NULL);
+
+  typedef void (completionFunc)(void* clientData, char const* rtspURL,
+				int resultCode, char* resultString);
+      // Called when the probe of "rtspURL" completes.  "resultCode" and "resultString" are as
+      // for the response handler of "RTSPClient::sendDescribeCommand()".  (I.e., on success,
+      // "resultString" is the stream's SDP description, which the function must delete[].)
+      // If the server doesn't respond within "timeoutSeconds", "resultCode" is -ETIMEDOUT.
+      // (This function may queue more probes, or cancel them, but must not close the prober.)
+
+  void probeURL(char const* rtspURL, completionFunc* func, void* clientData);
+      // Queues "rtspURL" to be probed.  (The completion function is never called from within
+      // this call; probes are started from the event loop.)
+  void cancelAllProbes(); // (no completion functions are called for them)
+
+  unsigned numProbesPending() const { return fNumProbesQueued + fNumProbesInFlight; }
+      // queued, or in flight
+
+protected:
+  RTSPURLProber(UsageEnvironment& env, unsigned maxNumProbesInFlight,
+		unsigned timeoutSeconds, int verbosityLevel, char const* applicationName);
+      // called only by createNew();
+  virtual ~RTSPURLProber();
+
+private:
+  friend class ProbingRTSPClient;
+  static void startQueuedProbes(void* clientData);
+  void startQueuedProbes1();
+  void scheduleQueuedProbes();
+  void startProbe(class ProbeRecord* probe);
+  void probeCompleted(class ProbingRTSPClient* client, int resultCode, char* resultString);
+  void removeActiveClient(ProbingRTSPClient* client);
+  void makeIdle(ProbingRTSPClient* client);
+  ProbingRTSPClient* takeIdleClient(unsigned serverAddress, portNumBits serverPortNum);
+  void closeFailedClients();
+
+private:
+  unsigned fMaxNumProbesInFlight, fTimeoutSeconds;
+  int fVerbosityLevel;
+  char* fApplicationName;
+  ProbeRecord* fQueueHead;
+  ProbeRecord* fQueueTail;
+  unsigned fNumProbesQueued;
+  ProbingRTSPClient* fActiveClients; // each has a probe in flight
+  unsigned fNumProbesInFlight;
+  ProbingRTSPClient* fIdleClients; // each has a connection that can be reused (most recently used first)
+  unsigned fNumIdleClients;
+  ProbingRTSPClient* fClientsToClose; // after a network error
+  TaskToken fStartTask;
+};
+
+#endif
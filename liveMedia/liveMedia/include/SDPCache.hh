@@ -0,0 +1,66 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A cache of the (expensive to compute) 'aux' SDP lines - e.g., H.264
+// "sprop-parameter-sets" - of file-based server media subsessions.
+// Each entry is keyed by file name and track id, and is valid only while the
+// file's modification time and size stay the same.
+// C++ header
+
+#ifndef _SDP_CACHE_HH
+#define _SDP_CACHE_HH
+
+#ifndef _BOOLEAN_HH
+#include "Boolean.hh"
+#endif
+#ifndef _NET_COMMON_H
+#include "NetCommon.h"
+#endif
+
+class HashTable; // forward
+
+class SDPCache {
+public:
+  SDPCache(char const* cacheFileName = NULL);
+      // If "cacheFileName" is non-NULL, existing entries are loaded from this file, and
+      // new entries are appended to it, so that the cache survives a server restart.
+  virtual ~SDPCache();
+
+  char const* lookup(char const* fileName, char const* trackId);
+      // Returns the cached 'aux' SDP line (possibly "") for this track of "fileName",
+      // or NULL if there is none, or if the file has changed since it was cached.
+  void add(char const* fileName, char const* trackId, char const* auxSDPLine);
+
+  unsigned numHits() const { return fNumHits; }
+  unsigned numMisses() const { return fNumMisses; }
+
+private:
+  class SDPCacheEntry; // forward
+  static Boolean getFileStamp(char const* fileName, long& modificationTime, u_int64_t& fileSize);
+  static char* makeKey(char const* fileName, char const* trackId);
+  void addEntry(char const* key, long modificationTime, u_int64_t fileSize, char const* auxSDPLine);
+  void loadFromFile();
+  void appendToFile(char const* fileName, char const* trackId,
+		    long modificationTime, u_int64_t fileSize, char const* auxSDPLine);
+
+private:
+  HashTable* fTable; // maps "<trackId> <fileName>" to "SDPCacheEntry"s
+  char* fCacheFileName;
+  unsigned fNumHits, fNumMisses;
+};
+
+#endif
@@ -35,6 +35,9 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #endif
 
 class ServerMediaSubsession; // forward
+class SDPCache; // forward
+class RTPHintCache; // forward
+class RTPSink; // forward
 
 class ServerMediaSession: public Medium {
 public:
@@ -69,6 +72,17 @@ public:
   void decrementReferenceCount() { if (fReferenceCount > 0) --fReferenceCount; }
   Boolean& deleteWhenUnreferenced() { return fDeleteWhenUnreferenced; }
 
+  void setSDPCache(SDPCache* sdpCache) { fSDPCache = sdpCache; }
+      // (Optional) lets our subsessions reuse previously-computed SDP lines.
+      // The caller is responsible for reclaiming "sdpCache".
+  SDPCache* sdpCache() const { return fSDPCache; }
+
+  void setHintCache(RTPHintCache* hintCache) { fHintCache = hintCache; }
+      // (Optional) lets our (file-based) subsessions record each track's RTP packets the
+      // first time that it's streamed in full, and send later streams from this record.
+      // The caller is responsible for reclaiming "hintCache".
+  RTPHintCache* hintCache() const { return fHintCache; }
+
 protected:
   ServerMediaSession(UsageEnvironment& env, char const* streamName,
 		     char const* info, char const* description,
@@ -94,6 +108,8 @@ private:
   struct timeval fCreationTime;
   unsigned fReferenceCount;
   Boolean fDeleteWhenUnreferenced;
+  SDPCache* fSDPCache;
+  RTPHintCache* fHintCache;
 };
 
 
@@ -144,6 +160,9 @@ public:
      // "streamDuration", if >0.0, specifies how much data to stream, past "seekNPT".  (If <=0.0, all remaining data is streamed.)
   virtual void setStreamScale(unsigned clientSessionId, void* streamToken, float scale);
   virtual void deleteStream(unsigned clientSessionId, void*& streamToken);
+  virtual RTPSink* rtpSinkForStream(void* streamToken);
+      // returns the "RTPSink" (if any) that delivers the stream - e.g., so that its
+      // statistics can be reported.  (The default implementation returns NULL.)
 
   virtual void testScaleFactor(float& scale); // sets "scale" to the actual supported scale
   virtual float duration() const;
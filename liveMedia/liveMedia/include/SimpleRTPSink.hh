@@ -62,12 +62,15 @@ protected: // redefined virtual functions
   virtual
   Boolean frameCanAppearAfterPacketStart(unsigned char const* frameStart,
 					 unsigned numBytesInFrame) const;
+  virtual Boolean frameIsRandomAccessPoint(unsigned char const* frameStart,
+					   unsigned numBytesInFrame);
   virtual char const* sdpMediaType() const;
 
 private:
   char const* fSDPMediaTypeString;
   Boolean fAllowMultipleFramesPerPacket;
   Boolean fSetMBitOnLastFrames;
+  Boolean fIsTransportStream; // i.e., "MP2T"
 };
 
 #endif
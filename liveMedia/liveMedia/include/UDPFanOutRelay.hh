@@ -0,0 +1,92 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A relay that receives UDP packets (e.g., from a multicast group) just once,
+// and retransmits each of them - without copying - to any number of
+// (unicast or multicast) subscribers, which may come and go at any time.
+// C++ header
+
+#ifndef _UDP_FAN_OUT_RELAY_HH
+#define _UDP_FAN_OUT_RELAY_HH
+
+#ifndef _MEDIA_HH
+#include "Media.hh"
+#endif
+#ifndef _GROUPSOCK_HH
+#include <Groupsock.hh>
+#endif
+
+#ifndef UDP_FAN_OUT_RELAY_MAX_BATCH
+#define UDP_FAN_OUT_RELAY_MAX_BATCH 32 // packets read (and then sent) at once
+#endif
+
+class UDPFanOutRelay: public Medium {
+public:
+  static UDPFanOutRelay* createNew(UsageEnvironment& env, Groupsock* inputGS,
+				   u_int8_t outputTTL = 255,
+				   unsigned maxPacketSize = 2048,
+				   unsigned maxBatchSize = UDP_FAN_OUT_RELAY_MAX_BATCH);
+      // Note: "inputGS" is not deleted by us.  Nothing is relayed until
+      // "startRelaying()" is called.
+
+  Boolean addSubscriber(struct in_addr const& address, Port const& port);
+      // Returns False if this subscriber had already been added
+  Boolean removeSubscriber(struct in_addr const& address, Port const& port);
+      // Returns False if there was no such subscriber
+  void removeAllSubscribers();
+  unsigned numSubscribers() const { return fNumSubscribers; }
+      // Subscribers can be added or removed while we're relaying; the change
+      // takes effect from the next packet onwards.
+
+  void startRelaying();
+  void stopRelaying();
+
+  Groupsock* inputGS() const { return fInputGS; }
+  Groupsock* outputGS() const { return fOutputGS; } // the socket that we send from
+
+  // Statistics:
+  unsigned numPacketsReceived() const { return fNumPacketsReceived; }
+  unsigned numPacketsSent() const { return fNumPacketsSent; } // summed over all subscribers
+  unsigned numPacketsDropped() const { return fNumPacketsDropped; } // ditto
+
+protected:
+  UDPFanOutRelay(UsageEnvironment& env, Groupsock* inputGS, u_int8_t outputTTL,
+		 unsigned maxPacketSize, unsigned maxBatchSize);
+      // called only by createNew()
+  virtual ~UDPFanOutRelay();
+
+private:
+  static void incomingPacketHandler(UDPFanOutRelay* relay, int mask);
+  void incomingPacketHandler1();
+
+  void sendBatch(unsigned const* packetSizes, unsigned numPackets);
+
+private:
+  Groupsock* fInputGS;
+  Groupsock* fOutputGS;
+  u_int8_t fOutputTTL;
+  unsigned fMaxBatchSize;
+  unsigned char* fBufferPool; // one contiguous allocation, shared by all subscribers
+  unsigned char* fBuffers[UDP_FAN_OUT_RELAY_MAX_BATCH];
+  unsigned fBufferMaxSize;
+  class UDPFanOutSubscriber* fSubscribers; // (defined in "UDPFanOutRelay.cpp")
+  unsigned fNumSubscribers;
+  Boolean fIsRelaying;
+  unsigned fNumPacketsReceived, fNumPacketsSent, fNumPacketsDropped;
+};
+
+#endif
@@ -0,0 +1,88 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// "liveMedia"
+// Copyright (c) 1996-2011 Live Networks, Inc.  All rights reserved.
+// A RTP sink that sends each input frame as the complete payload of one RTP
+// packet.  If the source can deliver frame references, the payload is sent
+// directly from the source's data (with the RTP header as a separate iovec),
+// and is never copied.  (Used e.g. for Transport Stream files, where each
+// 'frame' is a chunk of 188-byte TS packets.)
+// C++ header
+
+#ifndef _ZERO_COPY_RTP_SINK_HH
+#define _ZERO_COPY_RTP_SINK_HH
+
+#ifndef _RTP_SINK_HH
+#include "RTPSink.hh"
+#endif
+
+class ZeroCopyRTPSink: public RTPSink {
+public:
+  static ZeroCopyRTPSink*
+  createNew(UsageEnvironment& env, Groupsock* RTPgs,
+	    unsigned char rtpPayloadFormat,
+	    unsigned rtpTimestampFrequency,
+	    char const* sdpMediaTypeString,
+	    char const* rtpPayloadFormatName,
+	    unsigned maxPayloadSize,
+	    unsigned numChannels = 1);
+  // "maxPayloadSize" is the largest frame that we'll read; larger frames are truncated.
+
+  unsigned numCopiedFrames() const { return fNumCopiedFrames; }
+      // the number of frames that had to be copied, because our source could not
+      // deliver a reference (e.g., while in 'trick play' mode)
+
+protected:
+  ZeroCopyRTPSink(UsageEnvironment& env, Groupsock* RTPgs,
+		  unsigned char rtpPayloadFormat,
+		  unsigned rtpTimestampFrequency,
+		  char const* sdpMediaTypeString,
+		  char const* rtpPayloadFormatName,
+		  unsigned maxPayloadSize,
+		  unsigned numChannels);
+	// called only by createNew()
+
+  virtual ~ZeroCopyRTPSink();
+
+protected: // redefined virtual functions
+  virtual Boolean continuePlaying();
+  virtual char const* sdpMediaType() const;
+
+public:
+  virtual void stopPlaying();
+
+private:
+  void getNextFrame();
+  static void afterGettingFrame(void* clientData, unsigned frameSize,
+				unsigned numTruncatedBytes,
+				struct timeval presentationTime,
+				unsigned durationInMicroseconds);
+  void afterGettingFrame1(unsigned frameSize,
+			  struct timeval presentationTime,
+			  unsigned durationInMicroseconds);
+  static void sendNext(void* clientData);
+  static void ourHandleClosure(void* clientData);
+
+private:
+  char const* fSDPMediaTypeString;
+  unsigned fMaxPayloadSize;
+  unsigned char* fCopyBuffer; // used only if our source can't deliver references
+  Boolean fIsFirstFrame;
+  struct timeval fStartTime, fNextSendTime;
+  unsigned fNumCopiedFrames;
+};
+
+#endif
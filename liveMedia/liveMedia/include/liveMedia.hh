@@ -31,6 +31,7 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "AMRAudioFileSink.hh"
 #include "H264VideoFileSink.hh"
 #include "BasicUDPSink.hh"
+#include "UDPFanOutRelay.hh"
 #include "MPEG1or2VideoHTTPSink.hh"
 #include "GSMAudioRTPSink.hh"
 #include "H263plusVideoRTPSink.hh"
@@ -41,10 +42,14 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "H264VideoStreamDiscreteFramer.hh"
 #include "JPEGVideoRTPSink.hh"
 #include "SimpleRTPSink.hh"
+#include "ZeroCopyRTPSink.hh"
+#include "HintedRTPSink.hh"
 #include "uLawAudioFilter.hh"
 #include "MPEG2IndexFromTransportStream.hh"
 #include "MPEG2TransportStreamTrickModeFilter.hh"
+#include "MPEG2TransportStreamIndexWriter.hh"
 #include "ByteStreamMultiFileSource.hh"
+#include "MappedByteStreamFileSource.hh"
 #include "BasicUDPSource.hh"
 #include "SimpleRTPSource.hh"
 #include "MPEG1or2AudioRTPSource.hh"
@@ -83,11 +88,16 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "WAVAudioFileSource.hh"
 #include "RTSPServer.hh"
 #include "RTSPClient.hh"
+#include "RTSPURLProber.hh"
 #include "SIPClient.hh"
 #include "QuickTimeFileSink.hh"
 #include "QuickTimeGenericRTPSource.hh"
 #include "AVIFileSink.hh"
 #include "PassiveServerMediaSubsession.hh"
+#include "SDPCache.hh"
+#include "GOPCache.hh"
+#include "LatencyHistogram.hh"
+#include "RTPHintCache.hh"
 #include "MPEG4VideoFileServerMediaSubsession.hh"
 #include "H264VideoFileServerMediaSubsession.hh"
 #include "WAVAudioFileServerMediaSubsession.hh"
@@ -21,15 +21,21 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "DynamicRTSPServer.hh"
 #include <liveMedia.hh>
 #include <string.h>
+#include <dirent.h>
+
+// The file (in the current directory) in which the SDP lines of our files are cached,
+// so that they needn't be recomputed after a restart:
+#define SDP_CACHE_FILE_NAME ".live555SDPCache"
 
 DynamicRTSPServer*
 DynamicRTSPServer::createNew(UsageEnvironment& env, Port ourPort,
 			     UserAuthenticationDatabase* authDatabase,
-			     unsigned reclamationTestSeconds) {
+			     unsigned reclamationTestSeconds,
+			     Boolean reusePort) {
   int ourSocket = -1;
 
   do {
-    int ourSocket = setUpOurSocket(env, ourPort);
+    int ourSocket = setUpOurSocket(env, ourPort, reusePort);
     if (ourSocket == -1) break;
 
     return new DynamicRTSPServer(env, ourSocket, ourPort, authDatabase, reclamationTestSeconds);
@@ -39,13 +45,60 @@ DynamicRTSPServer::createNew(UsageEnvironment& env, Port ourPort,
   return NULL;
 }
 
+DynamicRTSPServer*
+DynamicRTSPServer::createNewSharingSocket(UsageEnvironment& env, int listeningSocket,
+					  Port ourPort,
+					  UserAuthenticationDatabase* authDatabase,
+					  unsigned reclamationTestSeconds) {
+  int ourSocket = dup(listeningSocket);
+  if (ourSocket < 0) {
+    env.setResultErrMsg("dup() failed: ");
+    return NULL;
+  }
+
+  return new DynamicRTSPServer(env, ourSocket, ourPort, authDatabase, reclamationTestSeconds);
+}
+
 DynamicRTSPServer::DynamicRTSPServer(UsageEnvironment& env, int ourSocket,
 				     Port ourPort,
 				     UserAuthenticationDatabase* authDatabase, unsigned reclamationTestSeconds)
-  : RTSPServer(env, ourSocket, ourPort, authDatabase, reclamationTestSeconds) {
+  : RTSPServer(env, ourSocket, ourPort, authDatabase, reclamationTestSeconds),
+    fSDPCache(new SDPCache(SDP_CACHE_FILE_NAME)), fHintCache(NULL) {
 }
 
 DynamicRTSPServer::~DynamicRTSPServer() {
+  // Note: Our "ServerMediaSession"s' SDP descriptions are generated only when we handle "DESCRIBE"s,
+  // so it's OK to delete the cache even if some of them outlive us:
+  delete fSDPCache;
+  // (A track that's still being recorded when we're deleted is just discarded - without
+  //  using the cache - when its client session is deleted.)
+  delete fHintCache;
+}
+
+void DynamicRTSPServer::enableHintCache(char const* cacheDirName) {
+  delete fHintCache;
+  fHintCache = new RTPHintCache(cacheDirName);
+}
+
+void DynamicRTSPServer::warmSDPCache() {
+  DIR* dir = opendir(".");
+  if (dir == NULL) return;
+
+  unsigned numSessions = 0;
+  struct dirent* dirEntry;
+  while ((dirEntry = readdir(dir)) != NULL) {
+    if (dirEntry->d_name[0] == '.') continue; // includes our cache file
+
+    ServerMediaSession* sms = lookupServerMediaSession(dirEntry->d_name);
+    if (sms == NULL) continue; // not a file type that we stream
+
+    delete[] sms->generateSDPDescription();
+    ++numSessions;
+  }
+  closedir(dir);
+
+  envir() << "(Prepared SDP descriptions for " << numSessions << " files: "
+	  << fSDPCache->numHits() << " were already cached.)\n";
 }
 
 static ServerMediaSession* createNewSMS(UsageEnvironment& env,
@@ -72,6 +125,10 @@ DynamicRTSPServer::lookupServerMediaSession(char const* streamName) {
     if (!smsExists) {
       // Create a new "ServerMediaSession" object for streaming from the named file.
       sms = createNewSMS(envir(), streamName, fid);
+      if (sms != NULL) {
+	sms->setSDPCache(fSDPCache);
+	sms->setHintCache(fHintCache);
+      }
       addServerMediaSession(sms);
     }
     fclose(fid);
@@ -145,7 +202,8 @@ static ServerMediaSession* createNewSMS(UsageEnvironment& env,
     char* indexFileName = new char[indexFileNameLen];
     sprintf(indexFileName, "%sx", fileName);
     NEW_SMS("MPEG Transport Stream");
-    sms->addSubsession(MPEG2TransportFileServerMediaSubsession::createNew(env, fileName, indexFileName, reuseSource));
+    sms->addSubsession(MPEG2TransportFileServerMediaSubsession::createNew(env, fileName, indexFileName, reuseSource,
+									  True/*useZeroCopyStreaming*/));
     delete[] indexFileName;
   } else if (strcmp(extension, ".wav") == 0) {
     // Assumed to be a WAV Audio file:
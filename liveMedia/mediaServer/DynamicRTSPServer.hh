@@ -29,7 +29,24 @@ class DynamicRTSPServer: public RTSPServer {
 public:
   static DynamicRTSPServer* createNew(UsageEnvironment& env, Port ourPort,
 				      UserAuthenticationDatabase* authDatabase,
-				      unsigned reclamationTestSeconds = 65);
+				      unsigned reclamationTestSeconds = 65,
+				      Boolean reusePort = False);
+      // If "reusePort" is True, several servers (each in its own thread) can listen on
+      // "ourPort" at once.
+  static DynamicRTSPServer* createNewSharingSocket(UsageEnvironment& env,
+						   int listeningSocket, Port ourPort,
+						   UserAuthenticationDatabase* authDatabase,
+						   unsigned reclamationTestSeconds = 65);
+      // Creates a server that accepts connections from (a duplicate of) another server's
+      // "listeningSocket".  (Used when "SO_REUSEPORT" is not available.)
+
+  void warmSDPCache();
+      // Creates a "ServerMediaSession" for each (streamable) file in the current directory,
+      // and generates its SDP description, so that the first clients don't wait for this.
+
+  void enableHintCache(char const* cacheDirName);
+      // Records the RTP packets of each file track that's streamed in full (as a file in the
+      // existing directory "cacheDirName"), so that later streams of it are just sent again.
 
 private:
   DynamicRTSPServer(UsageEnvironment& env, int ourSocket, Port ourPort,
@@ -39,6 +56,10 @@ private:
 
 private: // redefined virtual functions
   virtual ServerMediaSession* lookupServerMediaSession(char const* streamName);
+
+private:
+  SDPCache* fSDPCache; // shared by all of our "ServerMediaSession"s
+  RTPHintCache* fHintCache; // likewise (if enabled)
 };
 
 #endif
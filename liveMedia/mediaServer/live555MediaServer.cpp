@@ -20,8 +20,48 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include <BasicUsageEnvironment.hh>
 #include "DynamicRTSPServer.hh"
 #include "version.hh"
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(__WIN32__) && !defined(_WIN32)
+// We can optionally run several RTSP servers - each with its own event loop, in its own
+// thread - on the same port, to make use of more than one CPU core:
+#define MULTI_THREADED_SERVER 1
+#include <pthread.h>
+
+#define MAX_NUM_SERVER_THREADS 16
+
+static void* serverThreadMain(void* clientData) {
+  UsageEnvironment* env = (UsageEnvironment*)clientData;
+  env->taskScheduler().doEventLoop(); // does not return
+  return NULL;
+}
+#endif
+
+static void usage(char const* progName) {
+  fprintf(stderr, "usage: %s [-t <number-of-server-threads>] [-h <hint-cache-directory>]\n", progName);
+  exit(1);
+}
 
 int main(int argc, char** argv) {
+  unsigned numServerThreads = 1;
+  char const* hintCacheDirName = NULL;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-t") == 0 && i+1 < argc) {
+      numServerThreads = (unsigned)atoi(argv[++i]);
+      if (numServerThreads == 0) usage(argv[0]);
+    } else if (strcmp(argv[i], "-h") == 0 && i+1 < argc) {
+      hintCacheDirName = argv[++i];
+    } else {
+      usage(argv[0]);
+    }
+  }
+#ifdef MULTI_THREADED_SERVER
+  if (numServerThreads > MAX_NUM_SERVER_THREADS) numServerThreads = MAX_NUM_SERVER_THREADS;
+#else
+  numServerThreads = 1;
+#endif
+
   // Begin by setting up our usage environment:
   TaskScheduler* scheduler = BasicTaskScheduler::createNew();
   UsageEnvironment* env = BasicUsageEnvironment::createNew(*scheduler);
@@ -37,12 +77,25 @@ int main(int argc, char** argv) {
 
   // Create the RTSP server.  Try first with the default port number (554),
   // and then with the alternative port number (8554):
-  RTSPServer* rtspServer;
+  // (If we're using more than one thread, we first try to share the port using "SO_REUSEPORT".)
+  DynamicRTSPServer* rtspServer;
   portNumBits rtspServerPortNum = 554;
-  rtspServer = DynamicRTSPServer::createNew(*env, rtspServerPortNum, authDB);
+  Boolean reusePort = numServerThreads > 1;
+  rtspServer = DynamicRTSPServer::createNew(*env, rtspServerPortNum, authDB, 65, reusePort);
   if (rtspServer == NULL) {
     rtspServerPortNum = 8554;
+    rtspServer = DynamicRTSPServer::createNew(*env, rtspServerPortNum, authDB, 65, reusePort);
+  }
+  if (rtspServer == NULL && reusePort) {
+    // "SO_REUSEPORT" is probably not supported by our kernel.  Instead, our other threads
+    // will accept connections from (duplicates of) a single listening socket:
+    reusePort = False;
+    rtspServerPortNum = 554;
     rtspServer = DynamicRTSPServer::createNew(*env, rtspServerPortNum, authDB);
+    if (rtspServer == NULL) {
+      rtspServerPortNum = 8554;
+      rtspServer = DynamicRTSPServer::createNew(*env, rtspServerPortNum, authDB);
+    }
   }
   if (rtspServer == NULL) {
     *env << "Failed to create RTSP server: " << env->getResultMsg() << "\n";
@@ -73,6 +126,8 @@ int main(int argc, char** argv) {
   // Also, attempt to create a HTTP server for RTSP-over-HTTP tunneling.
   // Try first with the default HTTP port (80), and then with the alternative HTTP
   // port numbers (8000 and 8080).
+  // (Note that only this - the main - thread's server does this, because the "GET" and "POST"
+  // connections of each tunneled session must be handled by the same server.)
 
   if (rtspServer->setUpTunnelingOverHTTP(80) || rtspServer->setUpTunnelingOverHTTP(8000) || rtspServer->setUpTunnelingOverHTTP(8080)) {
     *env << "(We use port " << rtspServer->httpServerPortNum() << " for optional RTSP-over-HTTP tunneling.)\n";
@@ -80,6 +135,44 @@ int main(int argc, char** argv) {
     *env << "(RTSP-over-HTTP tunneling is not available.)\n";
   }
 
+  // Prepare the SDP description of each file now (reusing any that were cached by a previous run),
+  // rather than when the first client asks for it:
+  rtspServer->warmSDPCache();
+
+  if (hintCacheDirName != NULL) {
+    rtspServer->enableHintCache(hintCacheDirName);
+    *env << "(Files that are streamed in full are cached - pre-packetized - in \"" << hintCacheDirName << "\".)\n";
+  }
+
+#ifdef MULTI_THREADED_SERVER
+  // Create each additional server (and its environment) here, before starting any threads,
+  // so that the library's (shared, non thread-safe) set-up code is run from one thread only.
+  // Each client session then stays in the thread whose server accepted its connection.
+  // (Each server creates its own "ServerMediaSession"s - on demand - because these can be used
+  // only within the environment that created them.)
+  for (unsigned i = 1; i < numServerThreads; ++i) {
+    TaskScheduler* threadScheduler = BasicTaskScheduler::createNew();
+    UsageEnvironment* threadEnv = BasicUsageEnvironment::createNew(*threadScheduler);
+
+    DynamicRTSPServer* threadServer = reusePort
+      ? DynamicRTSPServer::createNew(*threadEnv, rtspServerPortNum, authDB, 65, True)
+      : DynamicRTSPServer::createNewSharingSocket(*threadEnv, rtspServer->rtspServerSocketNum(),
+						  rtspServerPortNum, authDB);
+    if (threadServer != NULL && hintCacheDirName != NULL) threadServer->enableHintCache(hintCacheDirName);
+    pthread_t thread;
+    if (threadServer == NULL
+	|| pthread_create(&thread, NULL, serverThreadMain, threadEnv) != 0) {
+      *env << "Failed to create server thread " << i << ": " << threadEnv->getResultMsg() << "\n";
+      break;
+    }
+    pthread_detach(thread);
+  }
+  if (numServerThreads > 1) {
+    *env << "(Using " << numServerThreads << " server threads, "
+	 << (reusePort ? "each with its own listening socket" : "sharing one listening socket") << ".)\n";
+  }
+#endif
+
   env->taskScheduler().doEventLoop(); // does not return
 
   return 0; // only to prevent compiler warning
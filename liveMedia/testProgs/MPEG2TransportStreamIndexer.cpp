@@ -22,6 +22,18 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 
 #include <liveMedia.hh>
 #include <BasicUsageEnvironment.hh>
+#include <InputFile.hh>
+#include <OutputFile.hh>
+
+#if !defined(__WIN32__) && !defined(_WIN32)
+// We can index several parts ('chunks') of the file at once - each in its own thread,
+// with its own event loop - and then merge the resulting index records:
+#define PARALLEL_INDEXING 1
+#include <pthread.h>
+#include <unistd.h>
+
+#define MAX_NUM_INDEXER_THREADS 16
+#endif
 
 void afterPlaying(void* clientData); // forward
 
@@ -29,11 +41,16 @@ UsageEnvironment* env;
 char const* programName;
 
 void usage() {
-  *env << "usage: " << programName << " <transport-stream-file-name>\n";
+  *env << "usage: " << programName << " [-j <number-of-threads>] <transport-stream-file-name>\n";
   *env << "\twhere <transport-stream-file-name> ends with \".ts\"\n";
   exit(1);
 }
 
+#ifdef PARALLEL_INDEXING
+Boolean indexInParallel(char const* inputFileName, char const* outputFileName,
+			unsigned numThreads); // forward
+#endif
+
 int main(int argc, char const** argv) {
   // Begin by setting up our usage environment:
   TaskScheduler* scheduler = BasicTaskScheduler::createNew();
@@ -41,6 +58,18 @@ int main(int argc, char const** argv) {
 
   // Parse the command line:
   programName = argv[0];
+  unsigned numThreads = 1;
+#ifdef PARALLEL_INDEXING
+  long numCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+  if (numCPUs > 1) numThreads = (unsigned)numCPUs;
+#endif
+  while (argc > 2) {
+    if (strcmp(argv[1], "-j") != 0) usage();
+    int n = atoi(argv[2]);
+    if (n <= 0) usage();
+    numThreads = (unsigned)n;
+    argc -= 2; argv += 2;
+  }
   if (argc != 2) usage();
 
   char const* inputFileName = argv[1];
@@ -52,6 +81,20 @@ int main(int argc, char const** argv) {
     usage();
   }
 
+  // The output file name is the same as the input file name, except with suffix ".tsx":
+  char* outputFileName = new char[len+2]; // allow for trailing x\0
+  sprintf(outputFileName, "%sx", inputFileName);
+
+#ifdef PARALLEL_INDEXING
+  if (numThreads > MAX_NUM_INDEXER_THREADS) numThreads = MAX_NUM_INDEXER_THREADS;
+  if (numThreads > 1) {
+    *env << "Writing index file \"" << outputFileName << "\"...";
+    if (indexInParallel(inputFileName, outputFileName, numThreads)) afterPlaying(NULL);
+    // Otherwise, the file can't be split up (e.g., because it's small), so index it in one go:
+    *env << "(using 1 thread)...";
+  }
+#endif
+
   // Open the input file (as a 'byte stream file source'):
   FramedSource* input
     = ByteStreamFileSource::createNew(*env, inputFileName, TRANSPORT_PACKET_SIZE);
@@ -64,10 +107,6 @@ int main(int argc, char const** argv) {
   FramedSource* indexer
     = MPEG2IFrameIndexFromTransportStream::createNew(*env, input);
 
-  // The output file name is the same as the input file name, except with suffix ".tsx":
-  char* outputFileName = new char[len+2]; // allow for trailing x\0
-  sprintf(outputFileName, "%sx", inputFileName);
-
   // Open the output file (for writing), as a 'file sink':
   MediaSink* output = FileSink::createNew(*env, outputFileName);
   if (output == NULL) {
@@ -76,7 +115,7 @@ int main(int argc, char const** argv) {
   }
 
   // Start playing, to generate the output index file:
-  *env << "Writing index file \"" << outputFileName << "\"...";
+  if (numThreads <= 1) *env << "Writing index file \"" << outputFileName << "\"...";
   output->startPlaying(*indexer, afterPlaying, NULL);
 
   env->taskScheduler().doEventLoop(); // does not return
@@ -88,3 +127,300 @@ void afterPlaying(void* /*clientData*/) {
   *env << "...done\n";
   exit(0);
 }
+
+#ifdef PARALLEL_INDEXING
+////////// Parallel indexing //////////
+
+// Each chunk begins at a PAT (so that its indexer learns the video PID - from the PMT that
+// follows - straight away).  Also, each chunk (except the last) is indexed for this many
+// Transport Stream packets beyond its end, so that its indexer gets past the first (at least
+// two) complete frames of the next chunk - whose own indexer will have started in the middle
+// of a frame.  The two chunks' index records then agree from the second frame on:
+#define CHUNK_OVERLAP_PACKETS 20000
+#define MIN_PACKETS_PER_CHUNK (4*CHUNK_OVERLAP_PACKETS)
+
+#define TRANSPORT_SYNC_BYTE 0x47
+#define PAT_PID 0
+#define SCAN_BLOCK_PACKETS 256 // the number of packets that we read at once when scanning
+
+class IndexerChunk {
+public:
+  unsigned long startPacketNum;
+  float lastPCR; // the last PCR before "startPacketNum"
+  char* recordFileName; // where this chunk's index records get written
+  UsageEnvironment* chunkEnv;
+  FramedSource* indexer;
+  MediaSink* sink;
+  char watchVariable;
+};
+
+static unsigned readPackets(FILE* fid, unsigned long firstPacketNum, unsigned numPackets,
+			    unsigned char* buf) {
+  if (SeekFile64(fid, (int64_t)firstPacketNum*TRANSPORT_PACKET_SIZE, SEEK_SET) != 0) return 0;
+  return fread(buf, TRANSPORT_PACKET_SIZE, numPackets, fid);
+}
+
+static Boolean getPCR(unsigned char const* pkt, float& pcr) {
+  // This must compute the PCR in exactly the same way as "MPEG2IFrameIndexFromTransportStream":
+  u_int8_t adaptation_field_control = (pkt[3]&0x30)>>4;
+  if (adaptation_field_control == 1 || pkt[4] == 0 || (pkt[5]&0x10) == 0) return False;
+
+  u_int32_t pcrBaseHigh = (pkt[6]<<24)|(pkt[7]<<16)|(pkt[8]<<8)|pkt[9];
+  pcr = pcrBaseHigh/45000.0f;
+  if ((pkt[10]&0x80) != 0) pcr += 1/90000.0f; // add in low-bit (if set)
+  unsigned short pcrExt = ((pkt[10]&0x01)<<8) | pkt[11];
+  pcr += pcrExt/27000000.0f;
+  return True;
+}
+
+static Boolean isPATStart(unsigned char const* pkt) {
+  u_int16_t PID = ((pkt[1]&0x1F)<<8) | pkt[2];
+  Boolean payload_unit_start_indicator = (pkt[1]&0x40) != 0;
+  return PID == PAT_PID && payload_unit_start_indicator;
+}
+
+static Boolean findFirstPCR(FILE* fid, unsigned long numPackets, float& firstPCR) {
+  unsigned char buf[SCAN_BLOCK_PACKETS*TRANSPORT_PACKET_SIZE];
+  for (unsigned long packetNum = 0; packetNum < numPackets; packetNum += SCAN_BLOCK_PACKETS) {
+    unsigned numRead = readPackets(fid, packetNum, SCAN_BLOCK_PACKETS, buf);
+    for (unsigned i = 0; i < numRead; ++i) {
+      unsigned char const* pkt = &buf[i*TRANSPORT_PACKET_SIZE];
+      if (pkt[0] != TRANSPORT_SYNC_BYTE) return False;
+      if (getPCR(pkt, firstPCR)) return True;
+    }
+    if (numRead < SCAN_BLOCK_PACKETS) break;
+  }
+  return False;
+}
+
+// Looks for a chunk starting point (a PAT) in [fromPacketNum, toPacketNum), and also
+// finds the last PCR before it (which must be no earlier than "minPacketNum"):
+static Boolean findChunkStart(FILE* fid, unsigned long fromPacketNum, unsigned long toPacketNum,
+			      unsigned long minPacketNum, IndexerChunk& chunk) {
+  unsigned char buf[SCAN_BLOCK_PACKETS*TRANSPORT_PACKET_SIZE];
+  Boolean foundPAT = False;
+  for (unsigned long packetNum = fromPacketNum; packetNum < toPacketNum && !foundPAT;
+       packetNum += SCAN_BLOCK_PACKETS) {
+    unsigned numRead = readPackets(fid, packetNum, SCAN_BLOCK_PACKETS, buf);
+    for (unsigned i = 0; i < numRead && packetNum + i < toPacketNum; ++i) {
+      unsigned char const* pkt = &buf[i*TRANSPORT_PACKET_SIZE];
+      if (pkt[0] != TRANSPORT_SYNC_BYTE) return False;
+      if (isPATStart(pkt)) {
+	chunk.startPacketNum = packetNum + i;
+	foundPAT = True;
+	break;
+      }
+    }
+    if (numRead < SCAN_BLOCK_PACKETS) break;
+  }
+  if (!foundPAT) return False;
+
+  // Then scan backwards for the preceding PCR:
+  unsigned long endPacketNum = chunk.startPacketNum;
+  while (endPacketNum > minPacketNum) {
+    unsigned long packetNum
+      = endPacketNum - minPacketNum > SCAN_BLOCK_PACKETS ? endPacketNum - SCAN_BLOCK_PACKETS : minPacketNum;
+    unsigned numRead = readPackets(fid, packetNum, endPacketNum - packetNum, buf);
+    if (numRead < endPacketNum - packetNum) return False;
+    for (unsigned i = numRead; i > 0; --i) {
+      if (getPCR(&buf[(i-1)*TRANSPORT_PACKET_SIZE], chunk.lastPCR)) return True;
+    }
+    endPacketNum = packetNum;
+  }
+  return False;
+}
+
+static void afterPlayingChunk(void* clientData) {
+  IndexerChunk* chunk = (IndexerChunk*)clientData;
+  chunk->watchVariable = ~0;
+}
+
+static void* indexerThreadMain(void* clientData) {
+  IndexerChunk* chunk = (IndexerChunk*)clientData;
+  chunk->chunkEnv->taskScheduler().doEventLoop(&chunk->watchVariable);
+  return NULL;
+}
+
+static unsigned long keyTSPacketNum(unsigned char const* record) {
+  return (record[10]<<24) | (record[9]<<16) | (record[8]<<8) | record[7];
+}
+
+static Boolean recordPrecedes(unsigned char const* record1, unsigned char const* record2) {
+  // Compares the positions (in the Transport Stream file) of two index records:
+  unsigned long tsPacketNum1 = keyTSPacketNum(record1), tsPacketNum2 = keyTSPacketNum(record2);
+  return tsPacketNum1 < tsPacketNum2 || (tsPacketNum1 == tsPacketNum2 && record1[1] < record2[1]);
+}
+
+// Copies (up to) "numRecords" index records from "fid" to "outFid":
+static void copyRecords(FILE* fid, FILE* outFid, unsigned long numRecords) {
+  unsigned char record[INDEX_RECORD_SIZE];
+  while (numRecords-- > 0 && fread(record, INDEX_RECORD_SIZE, 1, fid) == 1) {
+    fwrite(record, INDEX_RECORD_SIZE, 1, outFid);
+  }
+}
+
+static Boolean mergeChunkRecords(IndexerChunk* chunks, unsigned numChunks,
+				 char const* outputFileName) {
+  FILE* outFid = OpenOutputFile(*env, outputFileName);
+  if (outFid == NULL) return False;
+
+  unsigned long numToSkip = 0; // records at the start of the current chunk that the previous one covered
+  for (unsigned i = 0; i < numChunks; ++i) {
+    FILE* fid = OpenInputFile(*env, chunks[i].recordFileName);
+    if (fid == NULL) { CloseOutputFile(outFid); return False; }
+    SeekFile64(fid, (int64_t)numToSkip*INDEX_RECORD_SIZE, SEEK_SET);
+
+    if (i == numChunks-1) {
+      copyRecords(fid, outFid, ~0UL); // the rest of the last chunk
+      CloseInputFile(fid);
+      break;
+    }
+
+    // Find the first record ("first") of the next chunk, and the start of its second frame ("join"):
+    unsigned char first[INDEX_RECORD_SIZE], join[INDEX_RECORD_SIZE];
+    unsigned long joinIndex = 0; // the index of "join" within the next chunk's records
+    Boolean haveFirst = False, haveJoin = False;
+    FILE* nextFid = OpenInputFile(*env, chunks[i+1].recordFileName);
+    if (nextFid != NULL) {
+      haveFirst = fread(first, INDEX_RECORD_SIZE, 1, nextFid) == 1;
+      if (haveFirst) {
+	for (joinIndex = 1; fread(join, INDEX_RECORD_SIZE, 1, nextFid) == 1; ++joinIndex) {
+	  if ((join[0]&0x80) != 0) { haveJoin = True; break; }
+	}
+      }
+      CloseInputFile(nextFid);
+    }
+
+    // Look for "join" among this chunk's own records:
+    int64_t startPos = TellFile64(fid);
+    unsigned long numToCopy = 0;
+    Boolean foundJoin = False;
+    unsigned char record[INDEX_RECORD_SIZE];
+    while (fread(record, INDEX_RECORD_SIZE, 1, fid) == 1) {
+      if (haveJoin && memcmp(record, join, INDEX_RECORD_SIZE) == 0) { foundJoin = True; break; }
+      if (haveFirst && !haveJoin && !recordPrecedes(record, first)) break;
+      ++numToCopy;
+    }
+    if (haveJoin && !foundJoin) {
+      // This chunk's overlap didn't reach "join", so join at the next chunk's first record instead.
+      // (That record may include some of the previous frame's data.)
+      SeekFile64(fid, startPos, SEEK_SET);
+      for (numToCopy = 0; fread(record, INDEX_RECORD_SIZE, 1, fid) == 1; ++numToCopy) {
+	if (!recordPrecedes(record, first)) break;
+      }
+    }
+
+    SeekFile64(fid, startPos, SEEK_SET);
+    copyRecords(fid, outFid, numToCopy);
+    CloseInputFile(fid);
+    numToSkip = foundJoin ? joinIndex : 0;
+  }
+
+  CloseOutputFile(outFid);
+  return True;
+}
+
+Boolean indexInParallel(char const* inputFileName, char const* outputFileName,
+			unsigned numThreads) {
+  FILE* fid = OpenInputFile(*env, inputFileName);
+  if (fid == NULL) {
+    *env << "Failed to open input file \"" << inputFileName << "\" (does it exist?)\n";
+    exit(1);
+  }
+  unsigned long const numPackets
+    = (unsigned long)(GetFileSize(inputFileName, fid)/TRANSPORT_PACKET_SIZE);
+  if (numPackets/MIN_PACKETS_PER_CHUNK < numThreads) numThreads = numPackets/MIN_PACKETS_PER_CHUNK;
+
+  // Choose the chunks' starting points.  We need the file's first PCR, and - for each chunk after
+  // the first - the last PCR before it, so that each chunk's index records match those that
+  // indexing the whole file would produce:
+  float firstPCR = 0.0f;
+  IndexerChunk* chunks = new IndexerChunk[numThreads > 0 ? numThreads : 1];
+  unsigned numChunks = 0;
+  if (numThreads > 1 && findFirstPCR(fid, numPackets, firstPCR)) {
+    chunks[numChunks++].startPacketNum = 0;
+    for (unsigned i = 1; i < numThreads; ++i) {
+      unsigned long from = (unsigned long)(((u_int64_t)numPackets*i)/numThreads);
+      unsigned long to = (unsigned long)(((u_int64_t)numPackets*(i+1))/numThreads);
+      unsigned long prevStart = chunks[numChunks-1].startPacketNum;
+      if (from < prevStart + MIN_PACKETS_PER_CHUNK) from = prevStart + MIN_PACKETS_PER_CHUNK;
+      if (from >= to) continue;
+      if (findChunkStart(fid, from, to, prevStart, chunks[numChunks])) ++numChunks;
+    }
+  }
+  CloseInputFile(fid);
+  if (numChunks <= 1) {
+    delete[] chunks;
+    return False;
+  }
+
+  // Set up each chunk's indexer - each in its own environment - before starting any threads:
+  unsigned i;
+  for (i = 0; i < numChunks; ++i) {
+    IndexerChunk& chunk = chunks[i];
+    TaskScheduler* chunkScheduler = BasicTaskScheduler::createNew();
+    chunk.chunkEnv = BasicUsageEnvironment::createNew(*chunkScheduler);
+    chunk.watchVariable = 0;
+    chunk.recordFileName = new char[strlen(outputFileName) + 20];
+    sprintf(chunk.recordFileName, "%s.%u", outputFileName, i);
+
+    ByteStreamFileSource* input
+      = ByteStreamFileSource::createNew(*chunk.chunkEnv, inputFileName, TRANSPORT_PACKET_SIZE);
+    if (input == NULL) {
+      *env << "Failed to open input file \"" << inputFileName << "\" (does it exist?)\n";
+      exit(1);
+    }
+    unsigned long endPacketNum
+      = i == numChunks-1 ? numPackets : chunks[i+1].startPacketNum + CHUNK_OVERLAP_PACKETS;
+    input->seekToByteAbsolute((u_int64_t)chunk.startPacketNum*TRANSPORT_PACKET_SIZE,
+			      (u_int64_t)(endPacketNum - chunk.startPacketNum)*TRANSPORT_PACKET_SIZE);
+
+    MPEG2IFrameIndexFromTransportStream* indexer
+      = MPEG2IFrameIndexFromTransportStream::createNew(*chunk.chunkEnv, input);
+    if (i > 0) indexer->setStartingPoint(chunk.startPacketNum, firstPCR, chunk.lastPCR);
+    chunk.indexer = indexer;
+
+    chunk.sink = FileSink::createNew(*chunk.chunkEnv, chunk.recordFileName);
+    if (chunk.sink == NULL) {
+      *env << "Failed to open output file \"" << chunk.recordFileName << "\"\n";
+      exit(1);
+    }
+    chunk.sink->startPlaying(*chunk.indexer, afterPlayingChunk, &chunk);
+  }
+
+  *env << "(using " << numChunks << " threads)...";
+  pthread_t* threads = new pthread_t[numChunks];
+  for (i = 0; i < numChunks; ++i) {
+    if (pthread_create(&threads[i], NULL, indexerThreadMain, &chunks[i]) != 0) {
+      indexerThreadMain(&chunks[i]); // just do it here instead
+      threads[i] = pthread_self();
+    }
+  }
+  for (i = 0; i < numChunks; ++i) {
+    if (!pthread_equal(threads[i], pthread_self())) pthread_join(threads[i], NULL);
+  }
+  delete[] threads;
+
+  for (i = 0; i < numChunks; ++i) {
+    IndexerChunk& chunk = chunks[i];
+    Medium::close(chunk.sink); // also flushes its file
+    Medium::close(chunk.indexer); // also closes its input source
+    TaskScheduler* chunkScheduler = &chunk.chunkEnv->taskScheduler();
+    chunk.chunkEnv->reclaim();
+    delete chunkScheduler;
+  }
+
+  Boolean result = mergeChunkRecords(chunks, numChunks, outputFileName);
+  if (!result) {
+    *env << "Failed to write the index file \"" << outputFileName << "\"\n";
+    exit(1);
+  }
+
+  for (i = 0; i < numChunks; ++i) {
+    remove(chunks[i].recordFileName);
+    delete[] chunks[i].recordFileName;
+  }
+  delete[] chunks;
+  return True;
+}
+#endif
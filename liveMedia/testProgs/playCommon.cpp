@@ -1108,6 +1108,26 @@ void printQOSData(int exitCode) {
 	  *env << "inter_packet_gap_ms_ave\t"
 	       << (totNumPacketsReceived == 0 ? 0.0 : totalGapsMS/totNumPacketsReceived) << "\n";
 	  *env << "inter_packet_gap_ms_max\t" << stats->maxInterPacketGapUS()/1000.0 << "\n";
+
+	  // (These latencies are relative to the sender's clock, so are only meaningful if it's
+	  // synchronized with ours.)
+	  LatencyHistogram const& frameLatency = stats->frameLatencyHistogram();
+	  if (frameLatency.numSamples() == 0) {
+	    // special case: we haven't yet received a RTCP SR:
+	    *env <<
+	      "frame_latency_ms_min\tunavailable\n"
+	      "frame_latency_ms_p50\tunavailable\n"
+	      "frame_latency_ms_p95\tunavailable\n"
+	      "frame_latency_ms_p99\tunavailable\n"
+	      "frame_latency_ms_max\tunavailable\n";
+	  } else {
+	    *env << "frame_latency_ms_min\t" << frameLatency.minUSecs()/1000.0 << "\n";
+	    *env << "frame_latency_ms_p50\t" << frameLatency.percentileUSecs(50.0)/1000.0 << "\n";
+	    *env << "frame_latency_ms_p95\t" << frameLatency.percentileUSecs(95.0)/1000.0 << "\n";
+	    *env << "frame_latency_ms_p99\t" << frameLatency.percentileUSecs(99.0)/1000.0 << "\n";
+	    *env << "frame_latency_ms_max\t" << frameLatency.maxUSecs()/1000.0 << "\n";
+	    *env << "sr_transit_ms_min\t" << stats->minSRTransitUSecs()/1000.0 << "\n";
+	  }
 	}
 	
 	curQOSRecord = curQOSRecord->fNext;
@@ -261,6 +261,9 @@ int main(int argc, char** argv) {
     *env << "\n(RTSP-over-HTTP tunneling is not available.)\n";
   }
 
+  // Also make our statistics available (to clients on this host) as "http://localhost:<port>/stats":
+  rtspServer->enableStatistics();
+
   env->taskScheduler().doEventLoop(); // does not return
 
   return 0; // only to prevent compiler warning
@@ -15,7 +15,7 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 **********/
 // Copyright (c) 1996-2011, Live Networks, Inc.  All rights reserved
 // A test program that receives a UDP multicast stream
-// and retransmits it to another (multicast or unicast) address & port
+// and retransmits it to one or more other (multicast or unicast) addresses & ports
 // main program
 
 #include <liveMedia.hh>
@@ -56,11 +56,15 @@ int main(int argc, char** argv) {
   Groupsock inputGroupsock(*env, inputAddress, inputPort, inputTTL);
 #endif
 
-  // Then create a liveMedia 'source' object, encapsulating this groupsock:
-  FramedSource* source = BasicUDPSource::createNew(*env, &inputGroupsock);
-
+  // Then create a relay that reads from this groupsock.  Each incoming packet
+  // is read just once, and then sent (from the same buffer) to every subscriber:
+  unsigned char const outputTTL = 255;
+  unsigned const maxPacketSize = 65536; // allow for large UDP packets
+  UDPFanOutRelay* relay
+    = UDPFanOutRelay::createNew(*env, &inputGroupsock, outputTTL, maxPacketSize, 8);
 
-  // Create a 'groupsock' for the destination address and port:
+  // Add each destination address and port as a subscriber.  By default, we have
+  // just one, but more can be given on the command line, as "<address> <port>" pairs:
   char const* outputAddressStr = "239.255.43.43"; // this could also be unicast
     // Note: You may change "outputAddressStr" to use a different multicast
     // (or unicast address), but do *not* change it to use the same multicast
@@ -69,17 +73,21 @@ int main(int argc, char** argv) {
   outputAddress.s_addr = our_inet_addr(outputAddressStr);
 
   Port const outputPort(4444);
-  unsigned char const outputTTL = 255;
-
-  Groupsock outputGroupsock(*env, outputAddress, outputPort, outputTTL);
-
-  // Then create a liveMedia 'sink' object, encapsulating this groupsock:
-  unsigned const maxPacketSize = 65536; // allow for large UDP packets
-  MediaSink* sink = BasicUDPSink::createNew(*env, &outputGroupsock, maxPacketSize);
-
-
-  // Now, start playing, feeding the sink object from the source:
-  sink->startPlaying(*source, NULL, NULL);
+  if (argc < 3) relay->addSubscriber(outputAddress, outputPort);
+
+  for (int i = 1; i+1 < argc; i += 2) {
+    outputAddress.s_addr = our_inet_addr(argv[i]);
+    int portNum = atoi(argv[i+1]);
+    if (portNum <= 0 || portNum > 65535) {
+      *env << "Bad port number: \"" << argv[i+1] << "\"\n";
+      exit(1);
+    }
+    relay->addSubscriber(outputAddress, Port((portNumBits)portNum));
+  }
+  // (Subscribers can also be added - or removed - later, while we're relaying.)
+
+  // Now, start relaying:
+  relay->startRelaying();
 
   env->taskScheduler().doEventLoop(); // does not return
 
@@ -0,0 +1,545 @@
+/**********
+This library is free software; you can redistribute it and/or modify it under
+the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation; either version 2.1 of the License, or (at your
+option) any later version. (See <http://www.gnu.org/copyleft/lesser.html>.)
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+**********/
+// Copyright (c) 1996-2011, Live Networks, Inc.  All rights reserved
+// A benchmark (and soak test) for the streaming pipeline: A built-in RTSP server
+// streams synthetic data to N RTSP clients - all in this process, over loopback.
+// We measure throughput, CPU usage, per-packet latency, event-loop lag, and
+// memory use per session, and output the results as JSON (one object per line).
+// main program
+
+#include "liveMedia.hh"
+#include "BasicUsageEnvironment.hh"
+#if defined(__linux__)
+#include "EpollTaskScheduler.hh"
+#endif
+#include "GroupsockHelper.hh"
+
+#include <stdlib.h>
+#include <string.h>
+#if !defined(__WIN32__) && !defined(_WIN32)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+UsageEnvironment* env;
+
+// Parameters (which can be changed using command-line options):
+unsigned numClients = 10;
+unsigned durationSecs = 10; // 0 means 'run forever' (a soak test)
+unsigned reportIntervalSecs = 0; // if non-zero, also output interim results this often
+unsigned framesPerSecond = 100; // for each stream
+unsigned frameSize = 1000; // bytes; small enough to fit in a single RTP packet
+portNumBits rtspPortNum = 0; // 0 means 'choose a free port'
+Boolean streamUsingTCP = False;
+Boolean useEpollScheduler = False;
+
+#define LOOP_LAG_CHECK_INTERVAL 10000 // microseconds
+#define TIMESTAMP_SIZE 8 // each synthetic frame begins with its delivery time
+
+////////// Measurements //////////
+
+int64_t timeNow() { // in microseconds
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec*1000000 + tv.tv_usec;
+}
+
+class Stats {
+public:
+  Stats() { reset(); }
+  void reset() {
+    numFramesSent = numFramesReceived = numBytesReceived = 0;
+    latencySum = latencyMax = 0; latencyCount = 0;
+    loopLagSum = loopLagMax = 0; loopLagCount = 0;
+    for (unsigned i = 0; i < NUM_LATENCY_BUCKETS; ++i) latencyHistogram[i] = 0;
+  }
+
+  void noteLatency(int64_t usecs) {
+    if (usecs < 0) usecs = 0;
+    latencySum += usecs; ++latencyCount;
+    if (usecs > latencyMax) latencyMax = usecs;
+
+    // Buckets are powers of 2 microseconds (so that we can estimate percentiles):
+    unsigned bucket = 0;
+    while (bucket < NUM_LATENCY_BUCKETS-1 && (1<<(bucket+1)) <= usecs) ++bucket;
+    ++latencyHistogram[bucket];
+  }
+  int64_t latencyPercentile(double fraction) const {
+    u_int64_t target = (u_int64_t)(fraction*latencyCount);
+    u_int64_t soFar = 0;
+    for (unsigned i = 0; i < NUM_LATENCY_BUCKETS; ++i) {
+      soFar += latencyHistogram[i];
+      if (soFar > target) return (int64_t)1<<(i+1); // upper bound of this bucket
+    }
+    return latencyMax;
+  }
+
+  void noteLoopLag(int64_t usecs) {
+    if (usecs < 0) usecs = 0;
+    loopLagSum += usecs; ++loopLagCount;
+    if (usecs > loopLagMax) loopLagMax = usecs;
+  }
+
+public:
+  enum { NUM_LATENCY_BUCKETS = 24 };
+  u_int64_t numFramesSent, numFramesReceived, numBytesReceived;
+  int64_t latencySum, latencyMax; u_int64_t latencyCount;
+  int64_t loopLagSum, loopLagMax; u_int64_t loopLagCount;
+  u_int64_t latencyHistogram[NUM_LATENCY_BUCKETS];
+};
+
+Stats intervalStats, totalStats; // since the last report, and since we started
+unsigned numClientsPlaying = 0, numClientsFailed = 0;
+int64_t benchmarkStartTime, lastReportTime;
+double startCPUSecs = 0.0, lastReportCPUSecs = 0.0;
+long rssKBBeforeClients = 0, rssKBAfterSetup = 0;
+
+double cpuSecondsUsed() {
+#if !defined(__WIN32__) && !defined(_WIN32)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec/1000000.0
+    + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec/1000000.0;
+#else
+  return 0.0;
+#endif
+}
+
+long residentSetSizeKB() {
+  // This works on Linux only; elsewhere we report 0:
+  long result = 0;
+#if !defined(__WIN32__) && !defined(_WIN32)
+  FILE* fid = fopen("/proc/self/statm", "r");
+  if (fid != NULL) {
+    long totalPages, residentPages;
+    if (fscanf(fid, "%ld %ld", &totalPages, &residentPages) == 2) {
+      result = residentPages*(sysconf(_SC_PAGESIZE)/1024);
+    }
+    fclose(fid);
+  }
+#endif
+  return result;
+}
+
+////////// A source of synthetic frames, delivered at a fixed rate //////////
+
+class SyntheticFrameSource: public FramedSource {
+public:
+  static SyntheticFrameSource* createNew(UsageEnvironment& env) {
+    return new SyntheticFrameSource(env);
+  }
+
+protected:
+  SyntheticFrameSource(UsageEnvironment& env)
+    : FramedSource(env), fNextFrameTime(timeNow()) {
+  }
+  virtual ~SyntheticFrameSource() {
+    envir().taskScheduler().unscheduleDelayedTask(nextTask());
+  }
+
+private: // redefined virtual functions
+  virtual void doGetNextFrame() {
+    int64_t delay = fNextFrameTime - timeNow();
+    fNextFrameTime += 1000000/framesPerSecond;
+    nextTask() = envir().taskScheduler().scheduleDelayedTask(delay < 0 ? 0 : delay,
+							     (TaskFunc*)deliverFrame, this);
+  }
+  virtual void doStopGettingFrames() {
+    envir().taskScheduler().unscheduleDelayedTask(nextTask());
+  }
+
+private:
+  static void deliverFrame(SyntheticFrameSource* source) {
+    source->nextTask() = NULL;
+    source->deliverFrame1();
+  }
+  void deliverFrame1() {
+    fFrameSize = frameSize < fMaxSize ? frameSize : fMaxSize;
+    fNumTruncatedBytes = frameSize - fFrameSize;
+    gettimeofday(&fPresentationTime, NULL);
+    fDurationInMicroseconds = 1000000/framesPerSecond;
+
+    // Begin the frame with its delivery time, so that the receiver can measure latency:
+    memset(fTo, 0xAB, fFrameSize);
+    if (fFrameSize >= TIMESTAMP_SIZE) {
+      u_int32_t secs = htonl(fPresentationTime.tv_sec);
+      u_int32_t usecs = htonl(fPresentationTime.tv_usec);
+      memmove(fTo, &secs, 4);
+      memmove(&fTo[4], &usecs, 4);
+    }
+    ++intervalStats.numFramesSent; ++totalStats.numFramesSent;
+
+    FramedSource::afterGetting(this);
+  }
+
+private:
+  int64_t fNextFrameTime;
+};
+
+class SyntheticServerMediaSubsession: public OnDemandServerMediaSubsession {
+public:
+  static SyntheticServerMediaSubsession* createNew(UsageEnvironment& env) {
+    return new SyntheticServerMediaSubsession(env);
+  }
+
+protected:
+  SyntheticServerMediaSubsession(UsageEnvironment& env)
+    : OnDemandServerMediaSubsession(env, False/*each client gets its own source*/) {
+  }
+
+private: // redefined virtual functions
+  virtual FramedSource* createNewStreamSource(unsigned /*clientSessionId*/,
+					      unsigned& estBitrate) {
+    estBitrate = (framesPerSecond*frameSize*8)/1000; // kbps
+    return SyntheticFrameSource::createNew(envir());
+  }
+  virtual RTPSink* createNewRTPSink(Groupsock* rtpGroupsock,
+				    unsigned char rtpPayloadTypeIfDynamic,
+				    FramedSource* /*inputSource*/) {
+    return SimpleRTPSink::createNew(envir(), rtpGroupsock, rtpPayloadTypeIfDynamic,
+				    90000, "video", "X-BENCHMARK", 1,
+				    False/*one frame per packet*/);
+  }
+};
+
+////////// A sink that measures each frame that it receives //////////
+
+class MeasuringSink: public MediaSink {
+public:
+  static MeasuringSink* createNew(UsageEnvironment& env) {
+    return new MeasuringSink(env);
+  }
+
+protected:
+  MeasuringSink(UsageEnvironment& env)
+    : MediaSink(env) {
+    fBuffer = new unsigned char[frameSize + 100];
+  }
+  virtual ~MeasuringSink() { delete[] fBuffer; }
+
+private: // redefined virtual functions
+  virtual Boolean continuePlaying() {
+    if (fSource == NULL) return False;
+
+    fSource->getNextFrame(fBuffer, frameSize + 100,
+			  afterGettingFrame, this, onSourceClosure, this);
+    return True;
+  }
+
+private:
+  static void afterGettingFrame(void* clientData, unsigned frameSize,
+				unsigned /*numTruncatedBytes*/,
+				struct timeval /*presentationTime*/,
+				unsigned /*durationInMicroseconds*/) {
+    MeasuringSink* sink = (MeasuringSink*)clientData;
+
+    ++intervalStats.numFramesReceived; ++totalStats.numFramesReceived;
+    intervalStats.numBytesReceived += frameSize; totalStats.numBytesReceived += frameSize;
+    if (frameSize >= TIMESTAMP_SIZE) {
+      u_int32_t secs, usecs;
+      memmove(&secs, sink->fBuffer, 4);
+      memmove(&usecs, &sink->fBuffer[4], 4);
+      int64_t sendTime = (int64_t)ntohl(secs)*1000000 + ntohl(usecs);
+      int64_t latency = timeNow() - sendTime;
+      intervalStats.noteLatency(latency); totalStats.noteLatency(latency);
+    }
+
+    sink->continuePlaying();
+  }
+
+private:
+  unsigned char* fBuffer;
+};
+
+////////// Each synthetic RTSP client //////////
+
+class BenchmarkClient: public RTSPClient {
+public:
+  static BenchmarkClient* createNew(UsageEnvironment& env, char const* rtspURL,
+				    unsigned clientNum) {
+    return new BenchmarkClient(env, rtspURL, clientNum);
+  }
+
+protected:
+  BenchmarkClient(UsageEnvironment& env, char const* rtspURL, unsigned clientNum)
+    : RTSPClient(env, rtspURL, 0, "testStreamingBenchmark", 0),
+      fClientNum(clientNum), fSession(NULL), fSubsession(NULL) {
+  }
+  virtual ~BenchmarkClient() {
+    if (fSubsession != NULL) Medium::close(fSubsession->sink);
+    Medium::close(fSession);
+  }
+
+public:
+  void start() { sendDescribeCommand(continueAfterDESCRIBE); }
+  void shutdown();
+
+private:
+  static void continueAfterDESCRIBE(RTSPClient* rtspClient, int resultCode, char* resultString);
+  static void continueAfterSETUP(RTSPClient* rtspClient, int resultCode, char* resultString);
+  static void continueAfterPLAY(RTSPClient* rtspClient, int resultCode, char* resultString);
+  void noteFailure(char const* step, char const* reason);
+
+private:
+  unsigned fClientNum;
+  MediaSession* fSession;
+  MediaSubsession* fSubsession;
+};
+
+void BenchmarkClient::noteFailure(char const* step, char const* reason) {
+  envir() << "Client " << fClientNum << ": " << step << " failed: " << reason << "\n";
+  ++numClientsFailed;
+}
+
+void BenchmarkClient::continueAfterDESCRIBE(RTSPClient* rtspClient, int resultCode, char* resultString) {
+  BenchmarkClient* client = (BenchmarkClient*)rtspClient;
+  do {
+    if (resultCode != 0) {
+      client->noteFailure("DESCRIBE", resultString == NULL ? "no response" : resultString);
+      break;
+    }
+
+    client->fSession = MediaSession::createNew(client->envir(), resultString);
+    if (client->fSession == NULL) {
+      client->noteFailure("DESCRIBE", client->envir().getResultMsg());
+      break;
+    }
+
+    MediaSubsessionIterator iter(*client->fSession);
+    client->fSubsession = iter.next();
+    if (client->fSubsession == NULL || !client->fSubsession->initiate(0)) {
+      // ("initiate(0)" receives our (unknown) payload format using a "SimpleRTPSource")
+      client->noteFailure("initiate", client->envir().getResultMsg());
+      client->fSubsession = NULL;
+      break;
+    }
+    if (client->fSubsession->rtpSource() != NULL) {
+      // Make the socket's receive buffer large enough for bursts:
+      increaseReceiveBufferTo(client->envir(),
+			      client->fSubsession->rtpSource()->RTPgs()->socketNum(), 256*1024);
+    }
+
+    client->sendSetupCommand(*client->fSubsession, continueAfterSETUP, False, streamUsingTCP);
+  } while (0);
+
+  delete[] resultString;
+}
+
+void BenchmarkClient::continueAfterSETUP(RTSPClient* rtspClient, int resultCode, char* resultString) {
+  BenchmarkClient* client = (BenchmarkClient*)rtspClient;
+  if (resultCode != 0) {
+    client->noteFailure("SETUP", resultString == NULL ? "no response" : resultString);
+  } else {
+    client->fSubsession->sink = MeasuringSink::createNew(client->envir());
+    client->fSubsession->sink->startPlaying(*client->fSubsession->readSource(), NULL, NULL);
+    client->sendPlayCommand(*client->fSession, continueAfterPLAY);
+  }
+
+  delete[] resultString;
+}
+
+void BenchmarkClient::continueAfterPLAY(RTSPClient* rtspClient, int resultCode, char* resultString) {
+  BenchmarkClient* client = (BenchmarkClient*)rtspClient;
+  if (resultCode != 0) {
+    client->noteFailure("PLAY", resultString == NULL ? "no response" : resultString);
+  } else if (++numClientsPlaying == numClients) {
+    rssKBAfterSetup = residentSetSizeKB();
+  }
+
+  delete[] resultString;
+}
+
+void BenchmarkClient::shutdown() {
+  if (fSession != NULL) sendTeardownCommand(*fSession, NULL);
+}
+
+////////// Reporting //////////
+
+void reportResults(char const* kind, Stats& stats, int64_t sinceTime, double sinceCPUSecs) {
+  int64_t const now = timeNow();
+  double const intervalSecs = (now - sinceTime)/1000000.0;
+  double const cpuSecs = cpuSecondsUsed();
+  double const intervalCPUSecs = cpuSecs - sinceCPUSecs;
+  unsigned const numStreams = numClientsPlaying > 0 ? numClientsPlaying : 1;
+  long const sessionKB = numClientsPlaying > 0 && rssKBAfterSetup > 0
+    ? (rssKBAfterSetup - rssKBBeforeClients)/(long)numClientsPlaying : 0;
+
+  fprintf(stdout, "{\"type\":\"%s\",\"elapsed_s\":%.3f,\"interval_s\":%.3f"
+	  ",\"clients\":%u,\"clients_playing\":%u,\"clients_failed\":%u,\"transport\":\"%s\""
+	  ",\"frames_sent\":%llu,\"frames_received\":%llu,\"packets_per_s\":%.1f,\"mbits_per_s\":%.3f"
+	  ",\"cpu_percent\":%.2f,\"cpu_percent_per_stream\":%.4f"
+	  ",\"latency_avg_us\":%.1f,\"latency_p50_us\":%lld,\"latency_p99_us\":%lld,\"latency_max_us\":%lld"
+	  ",\"loop_lag_avg_us\":%.1f,\"loop_lag_max_us\":%lld"
+	  ",\"rss_kb\":%ld,\"rss_kb_per_session\":%ld}\n",
+	  kind, (now - benchmarkStartTime)/1000000.0, intervalSecs,
+	  numClients, numClientsPlaying, numClientsFailed, streamUsingTCP ? "tcp" : "udp",
+	  (unsigned long long)stats.numFramesSent, (unsigned long long)stats.numFramesReceived,
+	  intervalSecs > 0.0 ? stats.numFramesReceived/intervalSecs : 0.0,
+	  intervalSecs > 0.0 ? (stats.numBytesReceived*8)/(intervalSecs*1000000.0) : 0.0,
+	  intervalSecs > 0.0 ? 100.0*intervalCPUSecs/intervalSecs : 0.0,
+	  intervalSecs > 0.0 ? 100.0*intervalCPUSecs/intervalSecs/numStreams : 0.0,
+	  stats.latencyCount > 0 ? (double)stats.latencySum/stats.latencyCount : 0.0,
+	  (long long)stats.latencyPercentile(0.50), (long long)stats.latencyPercentile(0.99),
+	  (long long)stats.latencyMax,
+	  stats.loopLagCount > 0 ? (double)stats.loopLagSum/stats.loopLagCount : 0.0,
+	  (long long)stats.loopLagMax,
+	  residentSetSizeKB(), sessionKB);
+  fflush(stdout);
+}
+
+////////// Periodic tasks //////////
+
+char stopEventLoop = 0;
+int64_t expectedLoopCheckTime;
+
+void checkLoopLag(void* /*clientData*/) {
+  // Measure how late we were called - i.e., how long the event loop was busy:
+  int64_t now = timeNow();
+  intervalStats.noteLoopLag(now - expectedLoopCheckTime);
+  totalStats.noteLoopLag(now - expectedLoopCheckTime);
+
+  expectedLoopCheckTime = now + LOOP_LAG_CHECK_INTERVAL;
+  env->taskScheduler().scheduleDelayedTask(LOOP_LAG_CHECK_INTERVAL, checkLoopLag, NULL);
+}
+
+void periodicReport(void* /*clientData*/) {
+  reportResults("interim", intervalStats, lastReportTime, lastReportCPUSecs);
+  intervalStats.reset();
+  lastReportTime = timeNow();
+  lastReportCPUSecs = cpuSecondsUsed();
+  env->taskScheduler().scheduleDelayedTask(reportIntervalSecs*1000000, periodicReport, NULL);
+}
+
+void endBenchmark(void* /*clientData*/) {
+  stopEventLoop = 1;
+}
+
+void usage(char const* progName) {
+  *env << "Usage: " << progName
+       << " [-n <num-clients>] [-d <duration-secs> (0 => forever)] [-i <report-interval-secs>]"
+       << " [-r <frames-per-sec>] [-s <frame-size>] [-p <rtsp-port>] [-t (RTP-over-TCP)]"
+#if defined(__linux__)
+       << " [-e (use the epoll() scheduler)]"
+#endif
+       << "\n";
+  exit(1);
+}
+
+int main(int argc, char** argv) {
+  // Parse the command line first, because it may choose our scheduler:
+  char const* progName = argv[0];
+  Boolean badArgs = False;
+  while (argc > 1 && !badArgs) {
+    char const* opt = argv[1];
+    if (opt[0] != '-' || opt[1] == '\0' || opt[2] != '\0') {
+      badArgs = True;
+      break;
+    }
+
+    switch (opt[1]) {
+    case 't': streamUsingTCP = True; break;
+    case 'e': useEpollScheduler = True; break;
+    default: {
+      // The remaining options take a numeric argument:
+      int value;
+      if (argc < 3 || sscanf(argv[2], "%d", &value) != 1 || value < 0) {
+	badArgs = True;
+	break;
+      }
+      ++argv; --argc;
+
+      switch (opt[1]) {
+      case 'n': numClients = value; break;
+      case 'd': durationSecs = value; break;
+      case 'i': reportIntervalSecs = value; break;
+      case 'r': framesPerSecond = value; break;
+      case 's': frameSize = value; break;
+      case 'p': rtspPortNum = (portNumBits)value; break;
+      default: badArgs = True; break;
+      }
+    }
+    }
+    ++argv; --argc;
+  }
+
+  // Set up our usage environment:
+  TaskScheduler* scheduler = NULL;
+#if defined(__linux__)
+  if (useEpollScheduler) scheduler = EpollTaskScheduler::createNew();
+#endif
+  if (scheduler == NULL) scheduler = BasicTaskScheduler::createNew();
+  env = BasicUsageEnvironment::createNew(*scheduler);
+
+  if (badArgs || numClients == 0 || framesPerSecond == 0
+      || framesPerSecond > 1000000 || frameSize < TIMESTAMP_SIZE) {
+    usage(progName);
+  }
+
+  // Create the RTSP server, with a single (synthetic) stream:
+  RTSPServer* rtspServer = RTSPServer::createNew(*env, rtspPortNum, NULL);
+  if (rtspServer == NULL) {
+    *env << "Failed to create RTSP server: " << env->getResultMsg() << "\n";
+    exit(1);
+  }
+  ServerMediaSession* sms
+    = ServerMediaSession::createNew(*env, "benchmark", "benchmark",
+				    "Session streamed by \"testStreamingBenchmark\"");
+  sms->addSubsession(SyntheticServerMediaSubsession::createNew(*env));
+  rtspServer->addServerMediaSession(sms);
+
+  // Our clients connect via loopback:
+  char* serverURL = rtspServer->rtspURL(sms);
+  char const* hostStart = strstr(serverURL, "://");
+  char const* portStart = hostStart == NULL ? NULL : strchr(hostStart + 3, ':');
+  char* clientURL = new char[strlen(serverURL) + 20];
+  sprintf(clientURL, "rtsp://127.0.0.1%s", portStart == NULL ? "/benchmark" : portStart);
+  delete[] serverURL;
+
+  // Create the clients:
+  rssKBBeforeClients = residentSetSizeKB();
+  BenchmarkClient** clients = new BenchmarkClient*[numClients];
+  for (unsigned i = 0; i < numClients; ++i) {
+    clients[i] = BenchmarkClient::createNew(*env, clientURL, i);
+    clients[i]->start();
+  }
+
+  // Start measuring:
+  benchmarkStartTime = lastReportTime = timeNow();
+  lastReportCPUSecs = startCPUSecs = cpuSecondsUsed();
+  expectedLoopCheckTime = benchmarkStartTime + LOOP_LAG_CHECK_INTERVAL;
+  env->taskScheduler().scheduleDelayedTask(LOOP_LAG_CHECK_INTERVAL, checkLoopLag, NULL);
+  if (reportIntervalSecs > 0) {
+    env->taskScheduler().scheduleDelayedTask(reportIntervalSecs*1000000, periodicReport, NULL);
+  }
+  if (durationSecs > 0) {
+    env->taskScheduler().scheduleDelayedTask(durationSecs*(int64_t)1000000, endBenchmark, NULL);
+  }
+
+  env->taskScheduler().doEventLoop(&stopEventLoop);
+
+  reportResults("final", totalStats, benchmarkStartTime, startCPUSecs);
+
+  // Shut down cleanly (which also exercises session teardown):
+  for (unsigned i = 0; i < numClients; ++i) {
+    clients[i]->shutdown();
+    Medium::close(clients[i]);
+  }
+  delete[] clients;
+  delete[] clientURL;
+  Medium::close(rtspServer);
+
+  return numClientsFailed == 0 ? 0 : 1;
+}
@@ -273,7 +273,9 @@ void play() {
 
   // We must demultiplex Audio and Video Elementary Streams
   // from the input source:
-  mpegDemux = MPEG1or2Demux::createNew(*env, fileSource);
+  mpegDemux = MPEG1or2Demux::createNew(*env, fileSource, False,
+				       MPEG1or2Demux::DEFAULT_STREAM_BUFFER_SIZE);
+      // (so that the audio and video sinks can each read at their own pace)
   if (mediaToStream&VOB_AUDIO) {
     FramedSource* audioES = mpegDemux->newElementaryStream(0xBD);
       // Because, in a VOB file, the AC3 audio has stream id 0xBD
@@ -38,6 +38,14 @@ static int _has_scanned = 0;
 static int _vgs_locked = 0;
 static int _vg_global_lock_held = 0;	/* Global lock held when cache wiped? */
 
+/*
+ * Labels are read in batches whose first sectors are all read at once.
+ * The prefetch covers the label and the first metadata area header,
+ * and a batch holds one file descriptor per device.
+ */
+#define LABEL_PREFETCH_SIZE	(16 << SECTOR_SHIFT)
+#define LABEL_PREFETCH_BATCH	64
+
 int lvmcache_init(void)
 {
 	/*
@@ -572,11 +580,26 @@ static int _scan_invalid(void)
 	return 1;
 }
 
-int lvmcache_label_scan(struct cmd_context *cmd, int full_scan)
+static void _label_read_batch(struct device **devs, unsigned count)
 {
 	struct label *label;
+	unsigned i;
+
+	if (!dev_prefetch(devs, count, LABEL_PREFETCH_SIZE))
+		stack;
+
+	for (i = 0; i < count; i++) {
+		label_read(devs[i], &label, UINT64_C(0));
+		dev_prefetch_release(devs[i]);
+	}
+}
+
+int lvmcache_label_scan(struct cmd_context *cmd, int full_scan)
+{
 	struct dev_iter *iter;
 	struct device *dev;
+	struct device *batch[LABEL_PREFETCH_BATCH];
+	unsigned count = 0;
 	struct format_type *fmt;
 
 	int r = 0;
@@ -607,8 +630,15 @@ int lvmcache_label_scan(struct cmd_context *cmd, int full_scan)
 		goto out;
 	}
 
-	while ((dev = dev_iter_get(iter)))
-		label_read(dev, &label, UINT64_C(0));
+	while ((dev = dev_iter_get(iter))) {
+		batch[count++] = dev;
+		if (count == LABEL_PREFETCH_BATCH) {
+			_label_read_batch(batch, count);
+			count = 0;
+		}
+	}
+
+	_label_read_batch(batch, count);
 
 	dev_iter_destroy(iter);
 
@@ -699,11 +699,39 @@ static int _init_dev_cache(struct cmd_context *cmd)
 
 #define MAX_FILTERS 4
 
+/*
+ * The compiled regex filter is kept beside the persistent device cache.
+ */
+static const char *_regex_cache_file(struct cmd_context *cmd, char *buf,
+				     size_t size)
+{
+	const char *cache_dir, *cache_file_prefix;
+
+	if (!*cmd->system_dir ||
+	    !find_config_tree_int(cmd, "devices/write_cache_state", 1))
+		return NULL;
+
+	cache_dir = find_config_tree_str(cmd, "devices/cache_dir", NULL);
+	cache_file_prefix = find_config_tree_str(cmd, "devices/cache_file_prefix", NULL);
+
+	if (dm_snprintf(buf, size, "%s%s%s/%s.regex",
+			cache_dir ? "" : cmd->system_dir,
+			cache_dir ? "" : "/",
+			cache_dir ? : DEFAULT_CACHE_SUBDIR,
+			cache_file_prefix ? : DEFAULT_CACHE_FILE_PREFIX) < 0) {
+		log_verbose("Regex cache filename too long.");
+		return NULL;
+	}
+
+	return buf;
+}
+
 static struct dev_filter *_init_filter_components(struct cmd_context *cmd)
 {
 	unsigned nr_filt = 0;
 	const struct config_node *cn;
 	struct dev_filter *filters[MAX_FILTERS];
+	char regex_cache[PATH_MAX];
 
 	memset(filters, 0, sizeof(filters));
 
@@ -729,7 +757,8 @@ static struct dev_filter *_init_filter_components(struct cmd_context *cmd)
 		log_very_verbose("devices/filter not found in config file: "
 				 "no regex filter installed");
 
-	else if (!(filters[nr_filt++] = regex_filter_create(cn->v))) {
+	else if (!(filters[nr_filt++] = regex_filter_create(cn->v,
+				_regex_cache_file(cmd, regex_cache, sizeof(regex_cache))))) {
 		log_error("Failed to create regex device filter");
 		goto err;
 	}
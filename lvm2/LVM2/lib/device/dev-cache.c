@@ -110,6 +110,8 @@ struct device *dev_create_file(const char *filename, struct device *dev,
 	dev->read_ahead = -1;
 	memset(dev->pvid, 0, sizeof(dev->pvid));
 	dm_list_init(&dev->open_list);
+	dev->prefetch_buf = dev->prefetched = NULL;
+	dev->prefetched_size = 0;
 
 	return dev;
 }
@@ -133,6 +135,8 @@ static struct device *_dev_create(dev_t d)
 	dev->end = UINT64_C(0);
 	memset(dev->pvid, 0, sizeof(dev->pvid));
 	dm_list_init(&dev->open_list);
+	dev->prefetch_buf = dev->prefetched = NULL;
+	dev->prefetched_size = 0;
 
 	return dev;
 }
@@ -642,6 +646,41 @@ void dev_cache_scan(int do_scan)
 		_full_scan(1);
 }
 
+static int _dir_changed_since(const char *dir, time_t t)
+{
+	struct stat info;
+
+	/* Nothing can have been added to a directory that doesn't exist */
+	if (stat(dir, &info)) {
+		if (errno == ENOENT)
+			return 0;
+		log_sys_very_verbose("stat", dir);
+		return 1;
+	}
+
+	if (info.st_mtime >= t) {
+		log_very_verbose("%s: Changed since last scan", dir);
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Have device nodes been added to or removed from the scanned
+ * directories since time t?
+ */
+int dev_cache_dirs_changed_since(time_t t)
+{
+	struct dir_list *dl;
+
+	dm_list_iterate_items(dl, &_cache.dirs)
+		if (_dir_changed_since(dl->dir, t))
+			return 1;
+
+	return _dir_changed_since(dm_dir(), t);
+}
+
 static int _init_preferred_names(struct cmd_context *cmd)
 {
 	const struct config_node *cn;
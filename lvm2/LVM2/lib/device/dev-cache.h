@@ -39,6 +39,7 @@ void dev_cache_exit(void);
 /* Trigger(1) or avoid(0) a scan */
 void dev_cache_scan(int do_scan);
 int dev_cache_has_scanned(void);
+int dev_cache_dirs_changed_since(time_t t);
 
 int dev_cache_add_dir(const char *path);
 int dev_cache_add_loopfile(const char *path);
@@ -27,6 +27,10 @@
 #include <unistd.h>
 #include <sys/ioctl.h>
 
+#ifdef HAVE_REALTIME
+#  include <aio.h>
+#endif
+
 #ifdef linux
 #  define u64 uint64_t		/* Missing without __KERNEL__ */
 #  undef WNOHANG		/* Avoid redefinition */
@@ -577,8 +581,17 @@ int dev_test_excl(struct device *dev)
 	return r;
 }
 
+static void _drop_prefetched(struct device *dev)
+{
+	dm_free(dev->prefetch_buf);
+	dev->prefetch_buf = dev->prefetched = NULL;
+	dev->prefetched_size = 0;
+}
+
 static void _close(struct device *dev)
 {
+	_drop_prefetched(dev);
+
 	if (close(dev->fd))
 		log_sys_error("close", dev_name(dev));
 	dev->fd = -1;
@@ -675,6 +688,11 @@ int dev_read(struct device *dev, uint64_t offset, size_t len, void *buffer)
 	if (!_dev_is_valid(dev))
 		return 0;
 
+	if (dev->prefetched && offset + len <= dev->prefetched_size) {
+		memcpy(buffer, dev->prefetched + offset, len);
+		return 1;
+	}
+
 	where.dev = dev;
 	where.start = offset;
 	where.size = len;
@@ -752,6 +770,7 @@ int dev_write(struct device *dev, uint64_t offset, size_t len, void *buffer)
 	where.size = len;
 
 	dev->flags |= DEV_ACCESSED_W;
+	_drop_prefetched(dev);
 
 	ret = _aligned_io(&where, buffer, 1);
 	if (!ret)
@@ -796,3 +815,126 @@ int dev_set(struct device *dev, uint64_t offset, size_t len, int value)
 
 	return (len == 0);
 }
+
+#ifdef HAVE_REALTIME
+/*
+ * Queue the read of a device opened for prefetching.
+ */
+static int _queue_prefetch(struct device *dev, size_t len, struct aiocb *cb)
+{
+	unsigned int block_size;
+	uintptr_t mask = lvm_getpagesize() - 1;
+
+	if (!_get_block_size(dev, &block_size))
+		return_0;
+
+	/* O_DIRECT needs the size and the buffer aligned */
+	len = (len + block_size - 1) & ~((size_t) block_size - 1);
+
+	if (!(dev->prefetch_buf = dm_malloc(len + mask))) {
+		log_error("Prefetch buffer malloc failed");
+		return 0;
+	}
+
+	memset(cb, 0, sizeof(*cb));
+	cb->aio_fildes = dev_fd(dev);
+	cb->aio_buf = (char *) ((((uintptr_t) dev->prefetch_buf) + mask) & ~mask);
+	cb->aio_nbytes = len;
+	cb->aio_offset = 0;
+	cb->aio_lio_opcode = LIO_READ;
+	cb->aio_sigevent.sigev_notify = SIGEV_NONE;
+
+	return 1;
+}
+
+static void _finish_prefetch(struct device *dev, struct aiocb *cb)
+{
+	const struct aiocb *list[1] = { cb };
+	ssize_t n;
+	int r;
+
+	while ((r = aio_error(cb)) == EINPROGRESS)
+		aio_suspend(list, 1, NULL);
+
+	if (r || (n = aio_return(cb)) <= 0) {
+		log_debug("%s: Prefetch failed: %s", dev_name(dev),
+			  strerror(r ? r : EIO));
+		_drop_prefetched(dev);
+		return;
+	}
+
+	dev->prefetched = (char *) cb->aio_buf;
+	dev->prefetched_size = (uint64_t) n;
+}
+
+int dev_prefetch(struct device **devs, unsigned count, size_t len)
+{
+	struct aiocb *cbs, **list;
+	struct device **queued;
+	unsigned i, n = 0;
+
+	if (!count)
+		return 1;
+
+	if (!(cbs = dm_malloc(count * (sizeof(*cbs) + sizeof(*list) +
+				       sizeof(*queued))))) {
+		log_error("Prefetch control block allocation failed");
+		return 0;
+	}
+	list = (struct aiocb **) (cbs + count);
+	queued = (struct device **) (list + count);
+
+	for (i = 0; i < count; i++) {
+		/* Regular files are few and gain nothing from this */
+		if ((devs[i]->flags & (DEV_REGULAR | DEV_PREFETCHED)) ||
+		    devs[i]->prefetch_buf || !_dev_is_valid(devs[i]))
+			continue;
+
+		if (!dev_open_readonly_quiet(devs[i]))
+			continue;
+
+		devs[i]->flags |= DEV_PREFETCHED;
+
+		if (!_queue_prefetch(devs[i], len, &cbs[n]))
+			continue;
+
+		list[n] = &cbs[n];
+		queued[n++] = devs[i];
+	}
+
+	/*
+	 * Failures are reported per request, and any request
+	 * that did fail is simply read again when it is needed.
+	 */
+	if (n && lio_listio(LIO_WAIT, list, (int) n, NULL))
+		log_debug("Prefetching %u devices: %s", n, strerror(errno));
+
+	for (i = 0; i < n; i++)
+		_finish_prefetch(queued[i], &cbs[i]);
+
+	dm_free(cbs);
+
+	return 1;
+}
+
+#else	/* HAVE_REALTIME */
+
+int dev_prefetch(struct device **devs, unsigned count, size_t len)
+{
+	return 1;
+}
+
+#endif	/* HAVE_REALTIME */
+
+void dev_prefetch_release(struct device *dev)
+{
+	_drop_prefetched(dev);
+
+	if (!(dev->flags & DEV_PREFETCHED))
+		return;
+
+	dev->flags &= ~DEV_PREFETCHED;
+
+	if (!dev_close(dev))
+		stack;
+}
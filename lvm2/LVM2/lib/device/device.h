@@ -27,6 +27,7 @@
 #define DEV_OPENED_EXCL		0x00000010	/* Opened EXCL */
 #define DEV_O_DIRECT		0x00000020	/* Use O_DIRECT */
 #define DEV_O_DIRECT_TESTED	0x00000040	/* DEV_O_DIRECT is reliable */
+#define DEV_PREFETCHED		0x00000080	/* Opened by dev_prefetch */
 
 /*
  * All devices in LVM will be represented by one of these.
@@ -47,6 +48,10 @@ struct device {
 	uint64_t end;
 	struct dm_list open_list;
 
+	char *prefetch_buf;	/* Holds the data read by dev_prefetch */
+	char *prefetched;	/* Aligned start of the data */
+	uint64_t prefetched_size;
+
 	char pvid[ID_LEN + 1];
 	char _padding[7];
 };
@@ -93,6 +98,13 @@ int dev_append(struct device *dev, size_t len, char *buffer);
 int dev_set(struct device *dev, uint64_t offset, size_t len, int value);
 void dev_flush(struct device *dev);
 
+/*
+ * Read the first 'len' bytes of several devices concurrently.  Until
+ * dev_prefetch_release, dev_read is answered from that data.
+ */
+int dev_prefetch(struct device **devs, unsigned count, size_t len);
+void dev_prefetch_release(struct device *dev);
+
 struct device *dev_create_file(const char *filename, struct device *dev,
 			       struct str_list *alias, int use_malloc);
 
@@ -31,6 +31,8 @@ struct pfilter {
 	struct dm_hash_table *devices;
 	struct dev_filter *real;
 	time_t ctime;
+	uint64_t seqnum;	/* Udev event sequence number */
+	int has_seqnum;
 };
 
 /*
@@ -58,6 +60,9 @@ int persistent_filter_wipe(struct dev_filter *f)
 	log_verbose("Wiping cache of LVM-capable devices");
 	dm_hash_wipe(pf->devices);
 
+	/* The rescan reflects the devices as they are now */
+	pf->has_seqnum = udev_get_settled_seqnum(&pf->seqnum);
+
 	/* Trigger complete device scan */
 	dev_cache_scan(1);
 
@@ -96,6 +101,32 @@ static int _read_array(struct pfilter *pf, struct config_tree *cft,
 	return 1;
 }
 
+/*
+ * The cache is only valid while the same devices are present.  Any
+ * uevent processed since it was written, or any change to the scanned
+ * directories, may have added or removed devices.
+ */
+static int _cache_is_stale(struct pfilter *pf, struct config_tree *cft,
+			   time_t mtime)
+{
+	uint64_t seqnum;
+
+	if (dev_cache_dirs_changed_since(mtime))
+		return 1;
+
+	if (!pf->has_seqnum)
+		return 0;
+
+	if (!get_config_uint64(cft->root, "persistent_filter_cache/udev_seqnum",
+			       &seqnum) || seqnum != pf->seqnum) {
+		log_very_verbose("%s: Devices changed since cache was written",
+				 pf->file);
+		return 1;
+	}
+
+	return 0;
+}
+
 int persistent_filter_load(struct dev_filter *f, struct config_tree **cft_out)
 {
 	struct pfilter *pf = (struct pfilter *) f->private;
@@ -103,7 +134,8 @@ int persistent_filter_load(struct dev_filter *f, struct config_tree **cft_out)
 	struct stat info;
 	int r = 0;
 
-	if (obtain_device_list_from_udev()) {
+	/* Without udev state the udev device list can't be cached */
+	if (obtain_device_list_from_udev() && !pf->has_seqnum) {
 		if (!stat(pf->file, &info)) {
 			log_very_verbose("Obtaining device list from "
 					 "udev. Removing obolete %s.",
@@ -128,6 +160,9 @@ int persistent_filter_load(struct dev_filter *f, struct config_tree **cft_out)
 	if (!read_config_file(cft))
 		goto_out;
 
+	if (_cache_is_stale(pf, cft, info.st_mtime))
+		goto out;
+
 	_read_array(pf, cft, "persistent_filter_cache/valid_devices",
 		    PF_GOOD_DEVICE);
 	/* We don't gain anything by holding invalid devices */
@@ -191,13 +226,13 @@ int persistent_filter_dump(struct dev_filter *f, int merge_existing)
 	int lockfd;
 	int r = 0;
 
-	if (obtain_device_list_from_udev())
-		return 1;
-
 	if (!f)
 		return_0;
 	pf = (struct pfilter *) f->private;
 
+	if (obtain_device_list_from_udev() && !pf->has_seqnum)
+		return 1;
+
 	if (!dm_hash_get_num_entries(pf->devices)) {
 		log_very_verbose("Internal persistent device cache empty "
 				 "- not writing to %s", pf->file);
@@ -253,6 +288,9 @@ int persistent_filter_dump(struct dev_filter *f, int merge_existing)
 	fprintf(fp, "# This file is automatically maintained by lvm.\n\n");
 	fprintf(fp, "persistent_filter_cache {\n");
 
+	if (pf->has_seqnum)
+		fprintf(fp, "\tudev_seqnum = %" PRIu64 "\n", pf->seqnum);
+
 	_write_array(pf, fp, "valid_devices", PF_GOOD_DEVICE);
 	/* We don't gain anything by remembering invalid devices */
 	/* _write_array(pf, fp, "invalid_devices", PF_BAD_DEVICE); */
@@ -358,6 +396,9 @@ struct dev_filter *persistent_filter_create(struct dev_filter *real,
 	if (!stat(pf->file, &info))
 		pf->ctime = info.st_ctime;
 
+	/* Taken before scanning so later events invalidate what we dump */
+	pf->has_seqnum = udev_get_settled_seqnum(&pf->seqnum);
+
 	f->passes_filter = _lookup_p;
 	f->destroy = _persistent_destroy;
 	f->use_count = 0;
@@ -87,7 +87,8 @@ static int _extract_pattern(struct dm_pool *mem, const char *pat,
 	return 1;
 }
 
-static int _build_matcher(struct rfilter *rf, const struct config_value *val)
+static int _build_matcher(struct rfilter *rf, const struct config_value *val,
+			  const char *cache_file)
 {
 	struct dm_pool *scratch;
 	const struct config_value *v;
@@ -135,8 +136,14 @@ static int _build_matcher(struct rfilter *rf, const struct config_value *val)
 	/*
 	 * build the matcher.
 	 */
-	if (!(rf->engine = dm_regex_create(rf->mem, (const char * const*) regex,
-					   count)))
+	if (cache_file)
+		rf->engine = dm_regex_create_cached(rf->mem,
+						    (const char * const*) regex,
+						    count, cache_file);
+	else
+		rf->engine = dm_regex_create(rf->mem, (const char * const*) regex,
+					     count);
+	if (!rf->engine)
 		goto_out;
 	r = 1;
 
@@ -188,7 +195,8 @@ static void _regex_destroy(struct dev_filter *f)
 	dm_pool_destroy(rf->mem);
 }
 
-struct dev_filter *regex_filter_create(const struct config_value *patterns)
+struct dev_filter *regex_filter_create(const struct config_value *patterns,
+				       const char *cache_file)
 {
 	struct dm_pool *mem = dm_pool_create("filter regex", 10 * 1024);
 	struct rfilter *rf;
@@ -202,7 +210,7 @@ struct dev_filter *regex_filter_create(const struct config_value *patterns)
 
 	rf->mem = mem;
 
-	if (!_build_matcher(rf, patterns))
+	if (!_build_matcher(rf, patterns, cache_file))
 		goto_bad;
 
 	if (!(f = dm_pool_zalloc(mem, sizeof(*f))))
@@ -27,6 +27,10 @@
  * r|.*|             - reject everything else
  */
 
-struct dev_filter *regex_filter_create(const struct config_value *patterns);
+/*
+ * If cache_file is set, the compiled patterns are kept there.
+ */
+struct dev_filter *regex_filter_create(const struct config_value *patterns,
+				       const char *cache_file);
 
 #endif
@@ -653,7 +653,8 @@ static int _read_sections(struct format_instance *fid,
 
 static struct volume_group *_read_vg(struct format_instance *fid,
 				     const struct config_tree *cft,
-				     unsigned use_cached_pvs)
+				     unsigned use_cached_pvs,
+				     size_t metadata_size)
 {
 	const struct config_node *vgn, *cn;
 	struct volume_group *vg;
@@ -669,7 +670,8 @@ static struct volume_group *_read_vg(struct format_instance *fid,
 		return NULL;
 	}
 
-	if (!(vg = alloc_vg("read_vg", fid->fmt->cmd, vgn->key)))
+	if (!(vg = alloc_vg_sized("read_vg", fid->fmt->cmd, vgn->key,
+				  metadata_size)))
 		return_NULL;
 
 	if (!(vg->system_id = dm_pool_zalloc(vg->vgmem, NAME_LEN + 1)))
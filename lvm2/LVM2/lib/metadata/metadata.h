@@ -35,6 +35,7 @@
 //#define MAX_RESTRICTED_LVS 255	/* Used by FMT_RESTRICTED_LVIDS */
 #define MIRROR_LOG_OFFSET	2	/* sectors */
 #define VG_MEMPOOL_CHUNK	10240	/* in bytes, hint only */
+#define VG_MEMPOOL_MAX_CHUNK	(1024 * 1024)	/* when sized from metadata */
 #define PV_PE_START_CALC	((uint64_t) -1) /* Calculate pe_start value */
 
 /*
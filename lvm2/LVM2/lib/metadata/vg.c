@@ -20,13 +20,23 @@
 #include "toolcontext.h"
 #include "lvmcache.h"
 
-struct volume_group *alloc_vg(const char *pool_name, struct cmd_context *cmd,
-			      const char *vg_name)
+struct volume_group *alloc_vg_sized(const char *pool_name,
+				    struct cmd_context *cmd,
+				    const char *vg_name, size_t metadata_size)
 {
 	struct dm_pool *vgmem;
 	struct volume_group *vg;
+	size_t chunk_hint = VG_MEMPOOL_CHUNK;
+
+	/*
+	 * The parsed VG takes about as much memory as its metadata text,
+	 * so a pool sized from it is allocated in one or two chunks.
+	 */
+	if (metadata_size > chunk_hint)
+		chunk_hint = (metadata_size < VG_MEMPOOL_MAX_CHUNK) ?
+			      metadata_size : VG_MEMPOOL_MAX_CHUNK;
 
-	if (!(vgmem = dm_pool_create(pool_name, VG_MEMPOOL_CHUNK)) ||
+	if (!(vgmem = dm_pool_create(pool_name, chunk_hint)) ||
 	    !(vg = dm_pool_zalloc(vgmem, sizeof(*vg)))) {
 		log_error("Failed to allocate volume group structure");
 		if (vgmem)
@@ -55,8 +65,16 @@ struct volume_group *alloc_vg(const char *pool_name, struct cmd_context *cmd,
 	return vg;
 }
 
+struct volume_group *alloc_vg(const char *pool_name, struct cmd_context *cmd,
+			      const char *vg_name)
+{
+	return alloc_vg_sized(pool_name, cmd, vg_name, 0);
+}
+
 static void _free_vg(struct volume_group *vg)
 {
+	struct dm_pool_stats stats;
+
 	vg_set_fid(vg, NULL);
 
 	if (vg->cmd && vg->vgmem == vg->cmd->mem) {
@@ -67,6 +85,11 @@ static void _free_vg(struct volume_group *vg)
 
 	log_debug("Freeing VG %s at %p.", vg->name, vg);
 
+	dm_pool_get_stats(vg->vgmem, &stats);
+	log_debug("VG %s used %" PRIu64 " bytes in %u chunks, %" PRIu64
+		  " of them wasted.", vg->name, stats.peak_bytes,
+		  stats.chunks, stats.waste);
+
 	dm_pool_destroy(vg->vgmem);
 }
 
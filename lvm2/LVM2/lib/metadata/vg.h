@@ -111,6 +111,10 @@ struct volume_group {
 
 struct volume_group *alloc_vg(const char *pool_name, struct cmd_context *cmd,
 			      const char *vg_name);
+/* Size the VG's memory pool for metadata of the given size, if known */
+struct volume_group *alloc_vg_sized(const char *pool_name,
+				    struct cmd_context *cmd,
+				    const char *vg_name, size_t metadata_size);
 
 /*
  * release_vg() must be called on every struct volume_group allocated
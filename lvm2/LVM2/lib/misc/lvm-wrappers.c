@@ -75,6 +75,36 @@ const char *udev_get_dev_dir(void)
 	return udev_get_dev_path(_udev);
 }
 
+/*
+ * Get the sequence number of the last uevent, but only once udev has
+ * finished processing every event up to it.
+ */
+int udev_get_settled_seqnum(uint64_t *seqnum)
+{
+	struct udev_queue *udev_queue;
+	int r = 0;
+
+	if (!_udev) {
+		log_debug(_no_context_msg);
+		return 0;
+	}
+
+	if (!(udev_queue = udev_queue_new(_udev))) {
+		log_debug("Could not get udev state.");
+		return 0;
+	}
+
+	if (udev_queue_get_queue_is_empty(udev_queue)) {
+		*seqnum = (uint64_t) udev_queue_get_kernel_seqnum(udev_queue);
+		r = 1;
+	} else
+		log_debug("Udev is still processing events.");
+
+	udev_queue_unref(udev_queue);
+
+	return r;
+}
+
 struct udev* udev_get_library_context(void)
 {
 	return _udev;
@@ -100,6 +130,11 @@ const char *udev_get_dev_dir(void)
 {
 	return NULL;
 }
+
+int udev_get_settled_seqnum(uint64_t *seqnum)
+{
+	return 0;
+}
 #endif
 
 int lvm_getpagesize(void)
@@ -25,6 +25,7 @@ int udev_init_library_context(void);
 void udev_fin_library_context(void);
 int udev_is_running(void);
 const char *udev_get_dev_dir(void);
+int udev_get_settled_seqnum(uint64_t *seqnum);
 
 int lvm_getpagesize(void);
 
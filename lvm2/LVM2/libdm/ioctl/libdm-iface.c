@@ -1816,6 +1816,7 @@ void dm_lib_release(void)
 }
 
 void dm_pools_check_leaks(void);
+void dm_pools_release_recycled(void);
 
 void dm_lib_exit(void)
 {
@@ -1834,6 +1835,7 @@ void dm_lib_exit(void)
 		dm_bitset_destroy(_dm_bitset);
 	_dm_bitset = NULL;
 	dm_pools_check_leaks();
+	dm_pools_release_recycled();
 	dm_dump_memory();
 	_version_ok = 1;
 	_version_checked = 0;
@@ -618,6 +618,19 @@ void *dm_pool_alloc_aligned(struct dm_pool *p, size_t s, unsigned alignment);
 void dm_pool_empty(struct dm_pool *p);
 void dm_pool_free(struct dm_pool *p, void *ptr);
 
+/*
+ * Memory held by a pool.  Waste counts the bytes left unused at the
+ * end of every chunk but the one currently being allocated from.
+ */
+struct dm_pool_stats {
+	uint64_t bytes;		/* Held now */
+	uint64_t peak_bytes;	/* Held at most */
+	uint64_t waste;
+	unsigned chunks;
+};
+
+void dm_pool_get_stats(const struct dm_pool *p, struct dm_pool_stats *stats);
+
 /*
  * To aid debugging, a pool can be locked. Any modifications made
  * to the content of the pool while it is locked can be detected.
@@ -1069,6 +1082,17 @@ struct dm_regex;
 struct dm_regex *dm_regex_create(struct dm_pool *mem, const char * const *patterns,
 				 unsigned num_patterns);
 
+/*
+ * Like dm_regex_create, but loads the complete matcher from cache_file
+ * if it was saved there for the same patterns, and otherwise tries to
+ * save it there for next time.  Matchers too big to be worth saving
+ * are still built as they are needed.
+ */
+struct dm_regex *dm_regex_create_cached(struct dm_pool *mem,
+					const char * const *patterns,
+					unsigned num_patterns,
+					const char *cache_file);
+
 /*
  * Match string s against the patterns.
  * Returns the index of the highest pattern in the array that matches,
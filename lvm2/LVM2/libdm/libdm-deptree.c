@@ -20,6 +20,7 @@
 
 #include <stdarg.h>
 #include <sys/param.h>
+#include <sys/time.h>
 #include <sys/utsname.h>
 
 #define MAX_TARGET_PARAMSIZE 500000
@@ -940,6 +941,28 @@ static int _info_by_dev(uint32_t major, uint32_t minor, int with_open_count,
 	return r;
 }
 
+/*
+ * Run a task that changes the state of a node, reporting how long
+ * the kernel took over it.
+ */
+static int _run_node_task(struct dm_task *dmt, const char *op, const char *name)
+{
+	struct timeval start, end;
+	long usecs;
+	int r;
+
+	gettimeofday(&start, NULL);
+	r = dm_task_run(dmt);
+	gettimeofday(&end, NULL);
+
+	usecs = (end.tv_sec - start.tv_sec) * 1000000L +
+		(end.tv_usec - start.tv_usec);
+	log_debug("%s %s took %ld.%06lds%s", op, name, usecs / 1000000L,
+		  usecs % 1000000L, r ? "" : " and failed");
+
+	return r;
+}
+
 /* Check if all parent nodes of given node have open_count == 0 */
 static int _node_has_closed_parents(struct dm_tree_node *node,
 				    const char *uuid_prefix,
@@ -1005,7 +1028,7 @@ static int _deactivate_node(const char *name, uint32_t major, uint32_t minor,
 	if (!dm_task_set_cookie(dmt, cookie, udev_flags))
 		goto out;
 
-	r = dm_task_run(dmt);
+	r = _run_node_task(dmt, "Removing", name);
 
 	/* FIXME Until kernel returns actual name so dm-iface.c can handle it */
 	rm_dev_node(name, dmt->cookie_set && !(udev_flags & DM_UDEV_DISABLE_DM_RULES_FLAG),
@@ -1090,7 +1113,7 @@ static int _resume_node(const char *name, uint32_t major, uint32_t minor,
 	if (!dm_task_set_cookie(dmt, cookie, udev_flags))
 		goto out;
 
-	if ((r = dm_task_run(dmt))) {
+	if ((r = _run_node_task(dmt, "Resuming", name))) {
 		if (already_suspended)
 			dec_suspended();
 		r = dm_task_get_info(dmt, newinfo);
@@ -1133,7 +1156,7 @@ static int _suspend_node(const char *name, uint32_t major, uint32_t minor,
 	if (no_flush && !dm_task_no_flush(dmt))
 		log_error("Failed to set no_flush flag.");
 
-	if ((r = dm_task_run(dmt))) {
+	if ((r = _run_node_task(dmt, "Suspending", name))) {
 		inc_suspended();
 		r = dm_task_get_info(dmt, newinfo);
 	}
@@ -1277,6 +1300,13 @@ int dm_tree_suspend_children(struct dm_tree_node *dnode,
 		if (!_children_suspended(child, 1, uuid_prefix, uuid_prefix_len))
 			continue;
 
+		/*
+		 * Nodes used by several parents are reached once for each,
+		 * but once we suspended them there is no need to ask again.
+		 */
+		if (dinfo->suspended)
+			continue;
+
 		if (!_info_by_dev(dinfo->major, dinfo->minor, 0, &info) ||
 		    !info.exists || info.suspended)
 			continue;
@@ -1437,7 +1467,7 @@ static int _create_node(struct dm_tree_node *dnode)
 	if (!dm_task_no_open_count(dmt))
 		log_error("Failed to disable open_count");
 
-	if ((r = dm_task_run(dmt)))
+	if ((r = _run_node_task(dmt, "Creating", dnode->name)))
 		r = dm_task_get_info(dmt, &dnode->info);
 
 out:
@@ -1959,7 +1989,7 @@ static int _load_node(struct dm_tree_node *dnode)
 	if (!dm_task_suppress_identical_reload(dmt))
 		log_error("Failed to suppress reload of identical tables.");
 
-	if ((r = dm_task_run(dmt))) {
+	if ((r = _run_node_task(dmt, "Loading table of", dnode->name))) {
 		r = dm_task_get_info(dmt, &dnode->info);
 		if (r && !dnode->info.inactive_table)
 			log_verbose("Suppressed %s identical table reload.",
@@ -275,6 +275,19 @@ void dm_pool_abandon_object(struct dm_pool *p)
 	p->object = NULL;
 }
 
+/* Blocks are freed as soon as they are, so nothing is recycled */
+void dm_pools_release_recycled(void)
+{
+}
+
+void dm_pool_get_stats(const struct dm_pool *p, struct dm_pool_stats *stats)
+{
+	stats->bytes = p->stats.bytes;
+	stats->peak_bytes = p->stats.maxbytes;
+	stats->chunks = p->stats.blocks_allocated;
+	stats->waste = 0;
+}
+
 static long _pool_crc(const struct dm_pool *p)
 {
 #ifndef DEBUG_ENFORCE_POOL_LOCKING
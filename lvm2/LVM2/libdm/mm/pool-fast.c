@@ -35,11 +35,25 @@ struct dm_pool {
 	unsigned object_alignment;
 	int locked;
 	long crc;
+
+	size_t bytes, peak_bytes;	/* Held in chunks, spare included */
+	unsigned chunks;
 };
 
+/*
+ * Chunks of destroyed pools are kept for the pools created after
+ * them, so that short-lived pools don't go back to malloc each time.
+ * FIXME: thread unsafe, like the list of pools.
+ */
+#define RECYCLE_MAX_CHUNKS	16
+#define RECYCLE_MAX_CHUNK_SIZE	(256 * 1024)
+
+static struct chunk *_recycled_chunks = NULL;
+static unsigned _recycled_count = 0;
+
 static void _align_chunk(struct chunk *c, unsigned alignment);
 static struct chunk *_new_chunk(struct dm_pool *p, size_t s);
-static void _free_chunk(struct chunk *c);
+static void _free_chunk(struct dm_pool *p, struct chunk *c);
 
 /* by default things come out aligned for doubles */
 #define DEFAULT_ALIGNMENT __alignof__ (double)
@@ -68,11 +82,11 @@ struct dm_pool *dm_pool_create(const char *name, size_t chunk_hint)
 void dm_pool_destroy(struct dm_pool *p)
 {
 	struct chunk *c, *pr;
-	_free_chunk(p->spare_chunk);
+	_free_chunk(p, p->spare_chunk);
 	c = p->chunk;
 	while (c) {
 		pr = c->prev;
-		_free_chunk(c);
+		_free_chunk(p, c);
 		c = pr;
 	}
 
@@ -143,7 +157,7 @@ void dm_pool_free(struct dm_pool *p, void *ptr)
 		}
 
 		if (p->spare_chunk)
-			_free_chunk(p->spare_chunk);
+			_free_chunk(p, p->spare_chunk);
 
 		c->begin = (char *) (c + 1);
 #ifdef VALGRIND_POOL
@@ -253,6 +267,32 @@ static void _align_chunk(struct chunk *c, unsigned alignment)
 	c->begin += alignment - ((unsigned long) c->begin & (alignment - 1));
 }
 
+#define _chunk_size(c) ((size_t) ((c)->end - (char *) (c)))
+
+/*
+ * Take the smallest recycled chunk that holds s bytes.
+ */
+static struct chunk *_get_recycled_chunk(size_t s)
+{
+	struct chunk **cp, **best = NULL, *c;
+
+	for (cp = &_recycled_chunks; *cp; cp = &(*cp)->prev)
+		if (_chunk_size(*cp) >= s &&
+		    (!best || _chunk_size(*cp) < _chunk_size(*best)))
+			best = cp;
+
+	if (!best)
+		return NULL;
+
+	c = *best;
+	*best = c->prev;
+	_recycled_count--;
+
+	c->begin = (char *) (c + 1);
+
+	return c;
+}
+
 static struct chunk *_new_chunk(struct dm_pool *p, size_t s)
 {
 	struct chunk *c;
@@ -262,6 +302,9 @@ static struct chunk *_new_chunk(struct dm_pool *p, size_t s)
 		/* reuse old chunk */
 		c = p->spare_chunk;
 		p->spare_chunk = 0;
+	} else if ((c = _get_recycled_chunk(s))) {
+		p->bytes += _chunk_size(c);
+		p->chunks++;
 	} else {
 #ifdef DEBUG_ENFORCE_POOL_LOCKING
 		if (!pagesize) {
@@ -291,18 +334,71 @@ static struct chunk *_new_chunk(struct dm_pool *p, size_t s)
 #ifdef VALGRIND_POOL
 		VALGRIND_MAKE_MEM_NOACCESS(c->begin, c->end - c->begin);
 #endif
+		p->bytes += s;
+		p->chunks++;
 	}
 
+	if (p->bytes > p->peak_bytes)
+		p->peak_bytes = p->bytes;
+
 	c->prev = p->chunk;
 	p->chunk = c;
 	return c;
 }
 
-static void _free_chunk(struct chunk *c)
+static void _free_chunk(struct dm_pool *p, struct chunk *c)
 {
+	if (!c)
+		return;
+
+	p->bytes -= _chunk_size(c);
+	p->chunks--;
+
+	/* Chunks which could have been mprotect()ed are never recycled */
+#ifndef DEBUG_ENFORCE_POOL_LOCKING
+	if (_recycled_count < RECYCLE_MAX_CHUNKS &&
+	    _chunk_size(c) <= RECYCLE_MAX_CHUNK_SIZE) {
+#ifdef VALGRIND_POOL
+		VALGRIND_MAKE_MEM_NOACCESS(c + 1, c->end - (char *) (c + 1));
+#endif
+		c->prev = _recycled_chunks;
+		_recycled_chunks = c;
+		_recycled_count++;
+		return;
+	}
+#endif
+
 	dm_free(c);
 }
 
+void dm_pools_release_recycled(void)
+{
+	struct chunk *c;
+
+	while ((c = _recycled_chunks)) {
+		_recycled_chunks = c->prev;
+		dm_free(c);
+	}
+
+	_recycled_count = 0;
+}
+
+void dm_pool_get_stats(const struct dm_pool *p, struct dm_pool_stats *stats)
+{
+	const struct chunk *c;
+
+	stats->bytes = p->bytes;
+	stats->peak_bytes = p->peak_bytes;
+	stats->chunks = p->chunks;
+	stats->waste = 0;
+
+	/* The current chunk can still be used; the earlier ones can't */
+	if (p->chunk)
+		for (c = p->chunk->prev; c; c = c->prev)
+			if (c->end > c->begin)
+				stats->waste += c->end - c->begin;
+}
+
 
 /**
  * Calc crc/hash from pool's memory chunks with internal pointers
@@ -19,6 +19,7 @@
 /* FIXME: thread unsafe */
 static DM_LIST_INIT(_dm_pools);
 void dm_pools_check_leaks(void);
+void dm_pools_release_recycled(void);
 
 #ifdef DEBUG_ENFORCE_POOL_LOCKING
 #ifdef DEBUG_POOL
@@ -21,6 +21,7 @@
 struct dfa_state {
 	struct dfa_state *next;
 	int final;
+	unsigned id;
 	dm_bitset_t bits;
 	struct dfa_state *lookup[256];
 };
@@ -41,6 +42,10 @@ struct dm_regex {		/* Instance variables for the lexer */
         struct ttree *tt;
         dm_bitset_t bs;
         struct dfa_state *h, *t;
+
+	unsigned num_states;
+	uint32_t hash;		/* Of the patterns */
+	int complete;		/* Every state is known, e.g. loaded from a file */
 };
 
 static int _count_nodes(struct rx_node *rx)
@@ -197,9 +202,14 @@ static void _calc_functions(struct dm_regex *m)
 	}
 }
 
-static struct dfa_state *_create_dfa_state(struct dm_pool *mem)
+static struct dfa_state *_create_dfa_state(struct dm_regex *m)
 {
-	return dm_pool_zalloc(mem, sizeof(struct dfa_state));
+	struct dfa_state *dfa = dm_pool_zalloc(m->mem, sizeof(struct dfa_state));
+
+	if (dfa)
+		dfa->id = m->num_states++;
+
+	return dfa;
 }
 
 static struct dfa_state *_create_state_queue(struct dm_pool *mem,
@@ -233,7 +243,7 @@ static void _calc_state(struct dm_regex *m, struct dfa_state *dfa, int a)
                 struct dfa_state *ldfa = ttree_lookup(m->tt, m->bs + 1);
                 if (!ldfa) {
                         /* push */
-                        ldfa = _create_dfa_state(m->mem);
+                        ldfa = _create_dfa_state(m);
                         ttree_insert(m->tt, m->bs + 1, ldfa);
                         tmp = _create_state_queue(m->scratch, ldfa, m->bs);
                         if (!m->h)
@@ -280,7 +290,7 @@ static int _calc_states(struct dm_regex *m, struct rx_node *rx)
         }
 
 	/* create first state */
-	dfa = _create_dfa_state(m->mem);
+	dfa = _create_dfa_state(m);
 	m->start = dfa;
 	ttree_insert(m->tt, rx->firstpos + 1, dfa);
 
@@ -293,14 +303,19 @@ static int _calc_states(struct dm_regex *m, struct rx_node *rx)
 /*
  * Forces all the dfa states to be calculated up front, ie. what
  * _calc_states() used to do before we switched to calculating on demand.
+ * Gives up, leaving the rest to be calculated on demand, once there are
+ * more than max_states states.  Returns 1 if the dfa is complete.
  */
-static void _force_states(struct dm_regex *m)
+static int _force_states(struct dm_regex *m, unsigned max_states)
 {
         int a;
 
         /* keep processing until there's nothing in the queue */
         struct dfa_state *s;
         while ((s = m->h)) {
+		if (m->num_states > max_states)
+			return 0;
+
                 /* pop state off front of the queue */
                 m->h = m->h->next;
 
@@ -309,6 +324,28 @@ static void _force_states(struct dm_regex *m)
                 for (a = 0; a < 256; a++)
                         _calc_state(m, s, a);
         }
+
+	return 1;
+}
+
+#define FNV_PRIME 16777619U
+#define FNV_OFFSET 2166136261U
+
+static uint32_t _hash_patterns(const char * const *patterns,
+			       unsigned num_patterns)
+{
+	uint32_t h = FNV_OFFSET;
+	const char *p;
+	unsigned i;
+
+	for (i = 0; i < num_patterns; i++)
+		for (p = patterns[i]; ; p++) {
+			h = (h ^ (unsigned char) *p) * FNV_PRIME;
+			if (!*p)
+				break;
+		}
+
+	return (h ^ num_patterns) * FNV_PRIME;
 }
 
 struct dm_regex *dm_regex_create(struct dm_pool *mem, const char * const *patterns,
@@ -324,6 +361,8 @@ struct dm_regex *dm_regex_create(struct dm_pool *mem, const char * const *patter
 	if (!(m = dm_pool_zalloc(mem, sizeof(*m))))
 		return_NULL;
 
+	m->hash = _hash_patterns(patterns, num_patterns);
+
 	/* join the regexps together, delimiting with zero */
 	for (i = 0; i < num_patterns; i++)
 		len += strlen(patterns[i]) + 8;
@@ -374,13 +413,16 @@ static struct dfa_state *_step_matcher(struct dm_regex *m, int c, struct dfa_sta
         struct dfa_state *ns;
 
 	if (!(ns = cs->lookup[(unsigned char) c])) {
+		if (m->complete)
+			return NULL;
+
 		_calc_state(m, cs, (unsigned char) c);
 		if (!(ns = cs->lookup[(unsigned char) c]))
 			return NULL;
 	}
 
         // yuck, we have to special case the target trans
-        if (ns->final == -1)
+        if (ns->final == -1 && !m->complete)
                 _calc_state(m, ns, TARGET_TRANS);
 
 	if (ns->final && (ns->final > *r))
@@ -394,7 +436,8 @@ int dm_regex_match(struct dm_regex *regex, const char *s)
 	struct dfa_state *cs = regex->start;
 	int r = 0;
 
-        dm_bit_clear_all(regex->bs);
+	if (regex->bs)
+		dm_bit_clear_all(regex->bs);
 	if (!(cs = _step_matcher(regex, HAT_CHAR, cs, &r)))
 		goto out;
 
@@ -409,6 +452,196 @@ int dm_regex_match(struct dm_regex *regex, const char *s)
 	return r - 1;
 }
 
+/*
+ * A complete dfa can be saved to a file and loaded instead of compiling
+ * the same patterns again.  The file holds a header followed by every
+ * state: its final value and its transitions, stored as the index of
+ * the target state plus one, or zero for none.  Everything is in host
+ * byte order, which the version field also checks.
+ */
+#define DFA_CACHE_MAGIC "DMRX"
+#define DFA_CACHE_VERSION 1
+#define DFA_CACHE_MAX_STATES 1024
+
+struct dfa_cache_header {
+	char magic[4];
+	uint32_t version;
+	uint32_t hash;
+	uint32_t num_states;
+	uint32_t start;
+};
+
+struct dfa_cache_state {
+	int32_t final;
+	uint32_t lookup[256];
+};
+
+static void _index_states(struct dfa_state *dfa, struct dfa_state **states)
+{
+	int c;
+
+	if (states[dfa->id])
+		return;
+
+	states[dfa->id] = dfa;
+
+	for (c = 0; c < 256; c++)
+		if (dfa->lookup[c])
+			_index_states(dfa->lookup[c], states);
+}
+
+static int _save_dfa(struct dm_regex *m, const char *file)
+{
+	struct dfa_cache_header hdr;
+	struct dfa_cache_state cs;
+	struct dfa_state **states;
+	char *tmp_file;
+	FILE *fp;
+	unsigned i;
+	int c, r = 0;
+
+	if (!_force_states(m, DFA_CACHE_MAX_STATES)) {
+		log_debug("Not caching regex with more than %u dfa states.",
+			  DFA_CACHE_MAX_STATES);
+		return 0;
+	}
+
+	if (!(states = dm_pool_zalloc(m->scratch, sizeof(*states) * m->num_states)))
+		return_0;
+
+	_index_states(m->start, states);
+
+	if (!(tmp_file = dm_pool_alloc(m->scratch, strlen(file) + 5)))
+		return_0;
+	sprintf(tmp_file, "%s.tmp", file);
+
+	if (!(fp = fopen(tmp_file, "w"))) {
+		/* The cache directory may be read-only */
+		log_sys_debug("fopen", tmp_file);
+		return 0;
+	}
+
+	memcpy(hdr.magic, DFA_CACHE_MAGIC, sizeof(hdr.magic));
+	hdr.version = DFA_CACHE_VERSION;
+	hdr.hash = m->hash;
+	hdr.num_states = m->num_states;
+	hdr.start = m->start->id;
+
+	if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1)
+		goto_out;
+
+	for (i = 0; i < m->num_states; i++) {
+		cs.final = states[i]->final;
+		for (c = 0; c < 256; c++)
+			cs.lookup[c] = states[i]->lookup[c] ?
+				       states[i]->lookup[c]->id + 1 : 0;
+
+		if (fwrite(&cs, sizeof(cs), 1, fp) != 1)
+			goto_out;
+	}
+
+	r = 1;
+
+out:
+	if (fclose(fp)) {
+		log_sys_debug("fclose", tmp_file);
+		r = 0;
+	}
+
+	if (r && rename(tmp_file, file)) {
+		log_sys_debug("rename", file);
+		r = 0;
+	}
+
+	if (!r && unlink(tmp_file))
+		log_sys_debug("unlink", tmp_file);
+
+	return r;
+}
+
+static struct dm_regex *_load_dfa(struct dm_pool *mem, uint32_t hash,
+				  const char *file)
+{
+	struct dfa_cache_header hdr;
+	struct dfa_cache_state cs;
+	struct dfa_state *states = NULL;
+	struct dm_regex *m = NULL;
+	unsigned i;
+	int c;
+	FILE *fp;
+
+	if (!(fp = fopen(file, "r")))
+		return NULL;
+
+	if (fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+	    memcmp(hdr.magic, DFA_CACHE_MAGIC, sizeof(hdr.magic)) ||
+	    hdr.version != DFA_CACHE_VERSION || hdr.hash != hash ||
+	    !hdr.num_states || hdr.num_states > DFA_CACHE_MAX_STATES ||
+	    hdr.start >= hdr.num_states) {
+		log_debug("Ignoring out of date regex cache %s.", file);
+		goto out;
+	}
+
+	if (!(m = dm_pool_zalloc(mem, sizeof(*m))) ||
+	    !(states = dm_pool_zalloc(mem, sizeof(*states) * hdr.num_states)))
+		goto_bad;
+
+	for (i = 0; i < hdr.num_states; i++) {
+		if (fread(&cs, sizeof(cs), 1, fp) != 1)
+			goto_bad;
+
+		states[i].id = i;
+		states[i].final = cs.final;
+		for (c = 0; c < 256; c++) {
+			if (cs.lookup[c] > hdr.num_states)
+				goto_bad;
+			states[i].lookup[c] = cs.lookup[c] ?
+					      &states[cs.lookup[c] - 1] : NULL;
+		}
+	}
+
+	m->mem = m->scratch = mem;
+	m->start = &states[hdr.start];
+	m->num_states = hdr.num_states;
+	m->hash = hash;
+	m->complete = 1;
+
+	log_debug("Loaded %u regex dfa states from %s.", m->num_states, file);
+	goto out;
+
+bad:
+	log_debug("Ignoring damaged regex cache %s.", file);
+	if (m)
+		dm_pool_free(mem, m);
+	m = NULL;
+out:
+	if (fclose(fp))
+		log_sys_debug("fclose", file);
+
+	return m;
+}
+
+struct dm_regex *dm_regex_create_cached(struct dm_pool *mem,
+					const char * const *patterns,
+					unsigned num_patterns,
+					const char *cache_file)
+{
+	struct dm_regex *m;
+
+	if ((m = _load_dfa(mem, _hash_patterns(patterns, num_patterns),
+			   cache_file)))
+		return m;
+
+	if (!(m = dm_regex_create(mem, patterns, num_patterns)))
+		return_NULL;
+
+	if (_save_dfa(m, cache_file))
+		log_debug("Saved %u regex dfa states to %s.", m->num_states,
+			  cache_file);
+
+	return m;
+}
+
 /*
  * The next block of code concerns calculating a fingerprint for the dfa.
  *
@@ -520,7 +753,7 @@ uint32_t dm_regex_fingerprint(struct dm_regex *regex)
         struct printer p;
         struct dm_pool *mem = dm_pool_create("regex fingerprint", 1024);
 
-        _force_states(regex);
+        _force_states(regex, UINT_MAX);
 
         assert(mem);
         p.mem = mem;
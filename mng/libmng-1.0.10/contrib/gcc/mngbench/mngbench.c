@@ -0,0 +1,314 @@
+/* ************************************************************************** */
+/* *                                                                        * */
+/* * For conditions of distribution and use, see copyright notice in       * */
+/* * libmng.h                                                               * */
+/* *                                                                        * */
+/* ************************************************************************** */
+/* *                                                                        * */
+/* * project   : mngbench                                                   * */
+/* * file      : mngbench.c                                                 * */
+/* * version   : 1.0.10                                                     * */
+/* *                                                                        * */
+/* * purpose   : main project file                                          * */
+/* *                                                                        * */
+/* * comment   : mngbench plays the supplied xNG-file into an in-memory     * */
+/* *             canvas as fast as it can, without waiting for the frame    * */
+/* *             delays, and reports the CPU time taken per frame           * */
+/* *                                                                        * */
+/* ************************************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../../libmng.h"
+
+/* ************************************************************************** */
+
+typedef struct user_struct {
+
+          FILE        *hFile;          /* file handle */
+          mng_uint8p  pCanvas;         /* RGBA8 or BGRA8 canvas */
+          mng_uint32  iWidth;
+          mng_uint32  iHeight;
+          mng_uint8   iCanvasalpha;    /* the canvas starts out with this alpha */
+          mng_uint32  iTicks;          /* the time as seen by libmng */
+          mng_uint32  iFrames;         /* frames displayed */
+          mng_uint32  iRefreshed;      /* pixels refreshed */
+          int         bChecksum;       /* print a checksum of each frame ? */
+
+        } userdata;
+
+typedef userdata * userdatap;
+
+/* ************************************************************************** */
+
+mng_ptr myalloc (mng_size_t iSize)
+{
+  return (mng_ptr)calloc (1, (size_t)iSize);
+}
+
+/* ************************************************************************** */
+
+void myfree (mng_ptr pPtr, mng_size_t iSize)
+{
+  free (pPtr);
+  return;
+}
+
+/* ************************************************************************** */
+
+mng_bool myopenstream (mng_handle hMNG)
+{
+  return MNG_TRUE;                     /* already opened in main function */
+}
+
+/* ************************************************************************** */
+
+mng_bool myclosestream (mng_handle hMNG)
+{
+  return MNG_TRUE;                     /* gets closed in main function */
+}
+
+/* ************************************************************************** */
+
+mng_bool myreaddata (mng_handle hMNG,
+                     mng_ptr    pBuf,
+                     mng_uint32 iSize,
+                     mng_uint32 *iRead)
+{
+  userdatap pMydata = (userdatap)mng_get_userdata (hMNG);
+
+  *iRead = fread (pBuf, 1, iSize, pMydata->hFile);
+
+  return MNG_TRUE;
+}
+
+/* ************************************************************************** */
+
+mng_bool myprocessheader (mng_handle hMNG,
+                          mng_uint32 iWidth,
+                          mng_uint32 iHeight)
+{
+  userdatap  pMydata = (userdatap)mng_get_userdata (hMNG);
+  mng_uint32 iX;
+
+  free (pMydata->pCanvas);
+  pMydata->pCanvas = (mng_uint8p)malloc (iWidth * iHeight * 4);
+
+  if (!pMydata->pCanvas)
+    return MNG_FALSE;
+
+  pMydata->iWidth  = iWidth;
+  pMydata->iHeight = iHeight;
+                                       /* black, opaque or transparent */
+  memset (pMydata->pCanvas, 0, iWidth * iHeight * 4);
+
+  for (iX = 0; iX < iWidth * iHeight; iX++)
+    pMydata->pCanvas [iX * 4 + 3] = pMydata->iCanvasalpha;
+
+  return MNG_TRUE;
+}
+
+/* ************************************************************************** */
+
+mng_ptr mygetcanvasline (mng_handle hMNG,
+                         mng_uint32 iLinenr)
+{
+  userdatap pMydata = (userdatap)mng_get_userdata (hMNG);
+
+  return (mng_ptr)(pMydata->pCanvas + iLinenr * pMydata->iWidth * 4);
+}
+
+/* ************************************************************************** */
+
+mng_bool myrefresh (mng_handle hMNG,
+                    mng_uint32 iX,
+                    mng_uint32 iY,
+                    mng_uint32 iWidth,
+                    mng_uint32 iHeight)
+{
+  userdatap pMydata = (userdatap)mng_get_userdata (hMNG);
+
+  pMydata->iRefreshed += iWidth * iHeight;
+
+  return MNG_TRUE;
+}
+
+/* ************************************************************************** */
+
+mng_uint32 mygettickcount (mng_handle hMNG)
+{
+  userdatap pMydata = (userdatap)mng_get_userdata (hMNG);
+
+  return pMydata->iTicks;
+}
+
+/* ************************************************************************** */
+
+mng_bool mysettimer (mng_handle hMNG,
+                     mng_uint32 iMsecs)
+{                                      /* a frame is done; pretend the delay passed */
+  userdatap  pMydata = (userdatap)mng_get_userdata (hMNG);
+  mng_uint32 iSum = 0;
+  mng_uint32 iX;
+
+  pMydata->iTicks += iMsecs;
+  pMydata->iFrames++;
+
+  if (pMydata->bChecksum)
+  {
+    for (iX = 0; iX < pMydata->iWidth * pMydata->iHeight * 4; iX++)
+      iSum = iSum * 31 + pMydata->pCanvas [iX];
+
+    printf ("frame %u: %08x\n", (unsigned)pMydata->iFrames, (unsigned)iSum);
+  }
+
+  return MNG_TRUE;
+}
+
+/* ************************************************************************** */
+
+int bench (char * zFilename, mng_uint32 iCanvasstyle, mng_uint8 iCanvasalpha,
+           mng_uint32 iMaxframes, int bChecksum, mng_bool bDirtyrefresh,
+           mng_uint32 iCachelimit)
+{
+  userdatap   pMydata;
+  mng_handle  hMNG;
+  mng_retcode iRC;
+  clock_t     iStart, iTime;
+
+  pMydata = (userdatap)calloc (1, sizeof (userdata));
+
+  if (pMydata == NULL)
+  {
+    fprintf (stderr, "Cannot allocate a data buffer.\n");
+    return 1;
+  }
+
+  if ((pMydata->hFile = fopen (zFilename, "rb")) == NULL)
+  {
+    fprintf (stderr, "Cannot open input file %s.\n", zFilename);
+    free (pMydata);
+    return 1;
+  }
+
+  pMydata->iCanvasalpha = iCanvasalpha;
+  pMydata->bChecksum    = bChecksum;
+
+  hMNG = mng_initialize ((mng_ptr)pMydata, myalloc, myfree, MNG_NULL);
+
+  if (!hMNG)
+  {
+    fprintf (stderr, "Cannot initialize libmng.\n");
+    iRC = 1;
+  }
+  else
+  {
+    if ( ((iRC = mng_setcb_openstream    (hMNG, myopenstream   )) != 0) ||
+         ((iRC = mng_setcb_closestream   (hMNG, myclosestream  )) != 0) ||
+         ((iRC = mng_setcb_readdata      (hMNG, myreaddata     )) != 0) ||
+         ((iRC = mng_setcb_processheader (hMNG, myprocessheader)) != 0) ||
+         ((iRC = mng_setcb_getcanvasline (hMNG, mygetcanvasline)) != 0) ||
+         ((iRC = mng_setcb_refresh       (hMNG, myrefresh      )) != 0) ||
+         ((iRC = mng_setcb_gettickcount  (hMNG, mygettickcount )) != 0) ||
+         ((iRC = mng_setcb_settimer      (hMNG, mysettimer     )) != 0) ||
+         ((iRC = mng_set_canvasstyle     (hMNG, iCanvasstyle   )) != 0) ||
+         ((iRC = mng_set_dirtyrefresh    (hMNG, bDirtyrefresh  )) != 0) ||
+         ((iRC = mng_set_cachelimit      (hMNG, iCachelimit    )) != 0)    )
+      fprintf (stderr, "Cannot set callbacks for libmng.\n");
+    else
+    {                                  /* read it all first; time the display only */
+      if ((iRC = mng_read (hMNG)) != 0)
+        fprintf (stderr, "Cannot read the file.\n");
+      else
+      {
+        iStart = clock ();
+        iRC    = mng_display (hMNG);
+                                       /* loops may go on forever */
+        while ((iRC == MNG_NEEDTIMERWAIT) && (pMydata->iFrames < iMaxframes))
+          iRC = mng_display_resume (hMNG);
+
+        iTime = clock () - iStart;
+
+        if ((iRC == MNG_NEEDTIMERWAIT) || (iRC == MNG_NOERROR))
+        {
+          iRC = 0;
+
+          printf ("%s: %ux%u, %u frames, %.3f ms CPU/frame, %.1f%% refreshed, "
+                  "%u KB cached\n",
+                  zFilename, (unsigned)pMydata->iWidth, (unsigned)pMydata->iHeight,
+                  (unsigned)pMydata->iFrames,
+                  pMydata->iFrames ? 1000.0 * iTime / CLOCKS_PER_SEC / pMydata->iFrames : 0.0,
+                  pMydata->iFrames && pMydata->iWidth && pMydata->iHeight ?
+                    100.0 * pMydata->iRefreshed / pMydata->iFrames /
+                    pMydata->iWidth / pMydata->iHeight : 0.0,
+                  (unsigned)(mng_get_cachesize (hMNG) >> 10));
+        }
+        else
+          fprintf (stderr, "Cannot display the file (%d).\n", (int)iRC);
+      }
+    }
+
+    mng_cleanup (&hMNG);
+  }
+
+  fclose (pMydata->hFile);
+  free (pMydata->pCanvas);
+  free (pMydata);
+
+  return iRC;
+}
+
+/* ************************************************************************** */
+
+int main(int argc, char *argv[])
+{
+  mng_uint32 iCanvasstyle = MNG_CANVAS_RGBA8;
+  mng_uint8  iCanvasalpha = 0xFF;
+  mng_uint32 iMaxframes   = 1000;
+  int        bChecksum    = 0;
+  mng_bool   bDirty       = MNG_FALSE;
+  mng_uint32 iCachelimit  = 0;
+  int        iArg;
+
+  for (iArg = 1; (iArg < argc) && (argv[iArg][0] == '-'); iArg++)
+  {
+    if ((!strcmp (argv[iArg], "-n")) && (iArg + 1 < argc))
+      iMaxframes = (mng_uint32)atol (argv[++iArg]);
+    else
+    if (!strcmp (argv[iArg], "-b"))
+      iCanvasstyle = MNG_CANVAS_BGRA8;
+    else
+    if (!strcmp (argv[iArg], "-t"))
+      iCanvasalpha = 0;
+    else
+    if (!strcmp (argv[iArg], "-c"))
+      bChecksum = 1;
+    else
+    if (!strcmp (argv[iArg], "-d"))
+      bDirty = MNG_TRUE;
+    else
+    if ((!strcmp (argv[iArg], "-m")) && (iArg + 1 < argc))
+      iCachelimit = (mng_uint32)atol (argv[++iArg]) << 10;
+    else
+      break;
+  }
+
+  if (iArg + 1 == argc)
+    return bench (argv[iArg], iCanvasstyle, iCanvasalpha, iMaxframes, bChecksum,
+                  bDirty, iCachelimit);
+
+  printf ("\nUsage: mngbench [-n frames] [-b] [-t] [-c] [-d] [-m KB] <file.mng>\n\n"
+          "  -n  stop after this many frames (default 1000)\n"
+          "  -b  use a BGRA8 canvas instead of RGBA8\n"
+          "  -t  start with a transparent canvas instead of an opaque one\n"
+          "  -c  print a checksum of the canvas after each frame\n"
+          "  -d  refresh only the pixels that changed\n"
+          "  -m  limit the playback cache to this many KB\n\n");
+
+  return 1;
+}
+
+/* ************************************************************************** */
@@ -294,6 +294,9 @@
 /* *             1.0.10 - 04/12/2007 - G.Juyn                               * */
 /* *             - added support for ANG proposal                           * */
 /* *                                                                        * */
+/* *             1.0.10 - 10/14/2026                                        * */
+/* *             - added cachelimit & dirtyrefresh properties               * */
+/* *                                                                        * */
 /* ************************************************************************** */
 
 #if defined(__BORLANDC__) && defined(MNG_STRICT_ANSI)
@@ -935,6 +938,27 @@ MNG_EXT mng_retcode MNG_DECL mng_set_cacheplayback   (mng_handle        hHandle,
 MNG_EXT mng_retcode MNG_DECL mng_set_doprogressive   (mng_handle        hHandle,
                                                       mng_bool          bDoProgressive);
 
+/* Limits the memory used by the playback cache (0 = no limit; default) */
+/* the cache holds a decoded copy of every image in the stream so that loops
+   can be replayed without decoding them again; images that would take the
+   cache past this limit are kept deflated and are inflated again each time
+   they are shown. so this trades processing time for memory; the limit
+   counts the sample data only (see mng_get_cachesize) */
+MNG_EXT mng_retcode MNG_DECL mng_set_cachelimit      (mng_handle        hHandle,
+                                                      mng_uint32        iCachelimit);
+
+/* Indicates refreshes of only the changed pixels (OFF by default!) */
+/* normally the refresh() callback receives the area covered by the images
+   displayed since the previous refresh; with this turned on, each canvas row
+   is compared before and after it is composed and only the pixels that have
+   actually changed are included. this costs a copy and a compare of every
+   row, so it pays off when refreshing the screen is expensive and successive
+   frames differ little, as with most looping animations;
+   the RGB8_A8, BGR565_A8, RGBA565 and BGRA565 canvas styles always refresh
+   the whole area */
+MNG_EXT mng_retcode MNG_DECL mng_set_dirtyrefresh    (mng_handle        hHandle,
+                                                      mng_bool          bDirtyrefresh);
+
 /* Indicates existence and required checking of the CRC in input streams,
    and generation in output streams */
 /* !!!! Use this ONLY if you know what you are doing !!!! */
@@ -1210,6 +1234,15 @@ MNG_EXT mng_bool    MNG_DECL mng_get_cacheplayback   (mng_handle        hHandle)
 /* see _set_ */
 MNG_EXT mng_bool    MNG_DECL mng_get_doprogressive   (mng_handle        hHandle);
 
+/* see _set_ */
+MNG_EXT mng_uint32  MNG_DECL mng_get_cachelimit      (mng_handle        hHandle);
+
+/* the amount of sample data currently held in the playback cache */
+MNG_EXT mng_uint32  MNG_DECL mng_get_cachesize       (mng_handle        hHandle);
+
+/* see _set_ */
+MNG_EXT mng_bool    MNG_DECL mng_get_dirtyrefresh    (mng_handle        hHandle);
+
 /* see _set_ */
 MNG_EXT mng_uint32  MNG_DECL mng_get_crcmode         (mng_handle        hHandle);
 
@@ -230,6 +230,17 @@
 /* #define MNG_BIGENDIAN_SUPPORTED */
 /* #define MNG_LITTLEENDIAN_SUPPORTED */
 
+/* ************************************************************************** */
+
+/* enable ARM NEON optimizations */
+/* use this to have the row-unfiltering and the composing onto RGBA8 canvases
+   use NEON instructions; this is automatic if the compiler targets NEON
+   (eg. -mfpu=neon); define MNG_NO_NEON to use the plain C routines */
+
+#if defined(__ARM_NEON__) && !defined(MNG_NO_NEON) && !defined(MNG_USE_NEON)
+#define MNG_USE_NEON
+#endif
+
 /* ************************************************************************** */
 /* enable 'version' functions */
 #if !defined(MNG_VERSION_QUERY_SUPPORT) && \
@@ -153,6 +153,9 @@
 /* *             1.0.10 - 04/12/2007 - G.Juyn                               * */
 /* *             - added support for ANG proposal                           * */
 /* *                                                                        * */
+/* *             1.0.10 - 10/14/2026                                        * */
+/* *             - added playback-cache limit & dirty-region refresh        * */
+/* *                                                                        * */
 /* ************************************************************************** */
 
 #if defined(__BORLANDC__) && defined(MNG_STRICT_ANSI)
@@ -324,6 +327,9 @@ typedef struct mng_data_struct {
            mng_bool          bSectionbreaks;     /* indicate NEEDSECTIONWAIT breaks */
            mng_bool          bCacheplayback;     /* switch to cache playback info */
            mng_bool          bDoProgressive;     /* progressive refresh for large images */
+           mng_bool          bDirtyrefresh;      /* refresh only changed canvas pixels */
+           mng_uint32        iCachelimit;        /* playback-cache budget (0 = none) */
+           mng_uint32        iCachesize;         /* sample-data held in the cache */
            mng_uint32        iCrcmode;           /* CRC existence & checking flags */
 
            mng_speedtype     iSpeed;             /* speed-modifier for animations */
@@ -538,6 +544,10 @@ typedef struct mng_data_struct {
            mng_uint32        iUpdatetop;
            mng_uint32        iUpdatebottom;
 
+           mng_uint8p        pDirtyrow;          /* canvas row before display; */
+           mng_uint32        iDirtyrowsize;      /* for the dirty-region refresh */
+           mng_uint32        iDirtypixelsize;
+
            mng_int8          iPass;              /* current interlacing pass;
                                                     negative value means no interlace */
            mng_int32         iRow;               /* current row counter */
@@ -589,6 +599,8 @@ typedef struct mng_data_struct {
            mng_fptr          fDisplayrow;        /* internal callback to display an
                                                     uncompressed/unfiltered/
                                                     color-corrected row */
+           mng_fptr          fDirtyrow;          /* display routine wrapped by the
+                                                    dirty-region refresh */
            mng_fptr          fRestbkgdrow;       /* internal callback for restore-
                                                     background processing of a row */
            mng_fptr          fCorrectrow;        /* internal callback to color-correct an
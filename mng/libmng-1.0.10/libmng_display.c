@@ -235,6 +235,9 @@
 /* *             1.0.10 - 04/12/2007 - G.Juyn                               * */
 /* *             - added support for ANG proposal                           * */
 /* *                                                                        * */
+/* *             1.0.10 - 10/14/2026                                        * */
+/* *             - added dirty-region refresh                               * */
+/* *                                                                        * */
 /* ************************************************************************** */
 
 #include "libmng.h"
@@ -553,6 +556,38 @@ MNG_LOCAL void set_display_routine (mng_datap pData)
 /*      case MNG_CANVAS_DX15    : { pData->fDisplayrow = (mng_fptr)mng_display_dx15;     break; } */
 /*      case MNG_CANVAS_DX16    : { pData->fDisplayrow = (mng_fptr)mng_display_dx16;     break; } */
     }
+
+    if (pData->bDirtyrefresh)            /* only refresh changed pixels ? */
+    {
+      switch (pData->iCanvasstyle)       /* how many bytes per pixel ? */
+      {
+        case MNG_CANVAS_RGBA8    :
+        case MNG_CANVAS_RGBA8_PM :
+        case MNG_CANVAS_ARGB8    :
+        case MNG_CANVAS_ARGB8_PM :
+        case MNG_CANVAS_BGRX8    :
+        case MNG_CANVAS_BGRA8    :
+        case MNG_CANVAS_BGRA8_PM :
+        case MNG_CANVAS_ABGR8    :
+        case MNG_CANVAS_ABGR8_PM : { pData->iDirtypixelsize = 4; break; }
+        case MNG_CANVAS_RGB8     :
+        case MNG_CANVAS_BGR8     : { pData->iDirtypixelsize = 3; break; }
+        case MNG_CANVAS_RGB565   :
+        case MNG_CANVAS_BGR565   :
+        case MNG_CANVAS_RGB555   :
+        case MNG_CANVAS_BGR555   : { pData->iDirtypixelsize = 2; break; }
+                                         /* separate alpha-plane, or the iCol
+                                            offset differs from the pixel-size */
+        default                  : { pData->iDirtypixelsize = 0; }
+      }
+                                         /* then put the tracker in front */
+      if ((pData->iDirtypixelsize) && (pData->fDisplayrow) &&
+          (pData->fDisplayrow != (mng_fptr)mng_display_dirty))
+      {
+        pData->fDirtyrow   = pData->fDisplayrow;
+        pData->fDisplayrow = (mng_fptr)mng_display_dirty;
+      }
+    }
   }
 
   return;
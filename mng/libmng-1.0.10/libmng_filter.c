@@ -35,6 +35,9 @@
 /* *             1.0.9 - 12/20/2004 - G.Juyn                                * */
 /* *             - cleaned up macro-invocations (thanks to D. Airlie)       * */
 /* *                                                                        * */
+/* *             1.0.10 - 10/14/2026                                        * */
+/* *             - added NEON unfiltering for 8-bit RGB & RGBA rows         * */
+/* *                                                                        * */
 /* ************************************************************************** */
 
 #include "libmng.h"
@@ -56,6 +59,168 @@
 
 /* ************************************************************************** */
 
+#ifdef MNG_USE_NEON
+#include <arm_neon.h>
+
+/* Sub, Average & Paeth depend on the pixel to the left, so they are done
+   four pixels at a time: a 16-byte load is split into one vector per pixel,
+   the pixels are unfiltered in turn, and a table lookup puts them back in
+   place; this is only done for 3- and 4-byte pixels (8-bit RGB & RGBA).
+   Each routine returns the number of bytes it did. */
+
+                                       /* vtbl indices; 0xFF keeps the byte */
+MNG_LOCAL mng_uint8 const neon_gather3 [16] = {  0,  1,  2,  8,  9, 10, 16, 17,
+                                                18, 24, 25, 26,
+                                                0xFF, 0xFF, 0xFF, 0xFF };
+MNG_LOCAL mng_uint8 const neon_gather4 [16] = {  0,  1,  2,  3,  8,  9, 10, 11,
+                                                16, 17, 18, 19, 24, 25, 26, 27 };
+
+MNG_LOCAL uint8x8x4_t neon_split (uint8x16_t vQ,
+                                  mng_int32  iBpp)
+{
+  uint8x8x4_t vP;
+  uint8x8_t   vLo = vget_low_u8  (vQ);
+  uint8x8_t   vHi = vget_high_u8 (vQ);
+
+  vP.val[0] = vLo;
+
+  if (iBpp == 3)
+  {
+    vP.val[1] = vext_u8 (vLo, vHi, 3);
+    vP.val[2] = vext_u8 (vLo, vHi, 6);
+    vP.val[3] = vext_u8 (vHi, vHi, 1);
+  }
+  else
+  {
+    vP.val[1] = vext_u8 (vLo, vLo, 4);
+    vP.val[2] = vHi;
+    vP.val[3] = vext_u8 (vHi, vHi, 4);
+  }
+
+  return vP;
+}
+
+/* ************************************************************************** */
+
+MNG_LOCAL uint8x16_t neon_gather (uint8x8x4_t vD,
+                                  uint8x16_t  vQ,
+                                  mng_int32   iBpp)
+{                                      /* bytes beyond the pixels stay as in vQ */
+  mng_uint8 const *pGather = (iBpp == 3) ? neon_gather3 : neon_gather4;
+
+  return vcombine_u8 (vtbl4_u8 (vD, vld1_u8 (pGather)),
+                      vtbx4_u8 (vget_high_u8 (vQ), vD, vld1_u8 (pGather + 8)));
+}
+
+/* ************************************************************************** */
+
+MNG_LOCAL uint8x8_t neon_paeth_predictor (uint8x8_t vA,
+                                          uint8x8_t vB,
+                                          uint8x8_t vC)
+{                                      /* pa = |b-c|, pb = |a-c|, pc = |a+b-2c| */
+  uint16x8_t vPa = vabdl_u8 (vB, vC);
+  uint16x8_t vPb = vabdl_u8 (vA, vC);
+  uint16x8_t vPc = vabdq_u16 (vaddl_u8 (vA, vB), vaddl_u8 (vC, vC));
+  uint8x8_t  vUseA = vmovn_u16 (vandq_u16 (vcleq_u16 (vPa, vPb),
+                                           vcleq_u16 (vPa, vPc)));
+  uint8x8_t  vUseB = vmovn_u16 (vcleq_u16 (vPb, vPc));
+
+  return vbsl_u8 (vUseA, vA, vbsl_u8 (vUseB, vB, vC));
+}
+
+/* ************************************************************************** */
+
+MNG_LOCAL mng_int32 neon_sub (mng_uint8p pRawx,
+                              mng_int32  iBpp,
+                              mng_int32  iRowsize)
+{
+  uint8x16_t  vQ;
+  uint8x8x4_t vX, vD;
+  uint8x8_t   vA = vdup_n_u8 (0);
+  mng_int32   iX;
+
+  for (iX = 0; iX + 16 <= iRowsize; iX += iBpp << 2)
+  {
+    vQ = vld1q_u8 (pRawx + iX);
+    vX = neon_split (vQ, iBpp);
+
+    vD.val[0] = vadd_u8 (vX.val[0], vA);
+    vD.val[1] = vadd_u8 (vX.val[1], vD.val[0]);
+    vD.val[2] = vadd_u8 (vX.val[2], vD.val[1]);
+    vD.val[3] = vadd_u8 (vX.val[3], vD.val[2]);
+    vA        = vD.val[3];
+
+    vst1q_u8 (pRawx + iX, neon_gather (vD, vQ, iBpp));
+  }
+
+  return iX;
+}
+
+/* ************************************************************************** */
+
+MNG_LOCAL mng_int32 neon_average (mng_uint8p pRawx,
+                                  mng_uint8p pPriorx,
+                                  mng_int32  iBpp,
+                                  mng_int32  iRowsize)
+{
+  uint8x16_t  vQ;
+  uint8x8x4_t vX, vB, vD;
+  uint8x8_t   vA = vdup_n_u8 (0);
+  mng_int32   iX;
+
+  for (iX = 0; iX + 16 <= iRowsize; iX += iBpp << 2)
+  {
+    vQ = vld1q_u8 (pRawx + iX);
+    vX = neon_split (vQ, iBpp);
+    vB = neon_split (vld1q_u8 (pPriorx + iX), iBpp);
+
+    vD.val[0] = vadd_u8 (vX.val[0], vhadd_u8 (vA,        vB.val[0]));
+    vD.val[1] = vadd_u8 (vX.val[1], vhadd_u8 (vD.val[0], vB.val[1]));
+    vD.val[2] = vadd_u8 (vX.val[2], vhadd_u8 (vD.val[1], vB.val[2]));
+    vD.val[3] = vadd_u8 (vX.val[3], vhadd_u8 (vD.val[2], vB.val[3]));
+    vA        = vD.val[3];
+
+    vst1q_u8 (pRawx + iX, neon_gather (vD, vQ, iBpp));
+  }
+
+  return iX;
+}
+
+/* ************************************************************************** */
+
+MNG_LOCAL mng_int32 neon_paeth (mng_uint8p pRawx,
+                                mng_uint8p pPriorx,
+                                mng_int32  iBpp,
+                                mng_int32  iRowsize)
+{
+  uint8x16_t  vQ;
+  uint8x8x4_t vX, vB, vD;
+  uint8x8_t   vA = vdup_n_u8 (0);
+  uint8x8_t   vC = vdup_n_u8 (0);
+  mng_int32   iX;
+
+  for (iX = 0; iX + 16 <= iRowsize; iX += iBpp << 2)
+  {
+    vQ = vld1q_u8 (pRawx + iX);
+    vX = neon_split (vQ, iBpp);
+    vB = neon_split (vld1q_u8 (pPriorx + iX), iBpp);
+
+    vD.val[0] = vadd_u8 (vX.val[0], neon_paeth_predictor (vA,        vB.val[0], vC       ));
+    vD.val[1] = vadd_u8 (vX.val[1], neon_paeth_predictor (vD.val[0], vB.val[1], vB.val[0]));
+    vD.val[2] = vadd_u8 (vX.val[2], neon_paeth_predictor (vD.val[1], vB.val[2], vB.val[1]));
+    vD.val[3] = vadd_u8 (vX.val[3], neon_paeth_predictor (vD.val[2], vB.val[3], vB.val[2]));
+    vA        = vD.val[3];
+    vC        = vB.val[3];
+
+    vst1q_u8 (pRawx + iX, neon_gather (vD, vQ, iBpp));
+  }
+
+  return iX;
+}
+#endif /* MNG_USE_NEON */
+
+/* ************************************************************************** */
+
 MNG_LOCAL mng_retcode filter_sub (mng_datap pData)
 {
   mng_uint32 iBpp;
@@ -68,10 +233,22 @@ MNG_LOCAL mng_retcode filter_sub (mng_datap pData)
 #endif
 
   iBpp       = pData->iFilterbpp;
-  pRawx      = pData->pWorkrow + pData->iPixelofs + iBpp;
-  pRawx_prev = pData->pWorkrow + pData->iPixelofs;
+  iX         = iBpp;
+
+#ifdef MNG_USE_NEON
+  if ((iBpp == 3) || (iBpp == 4))
+  {
+    iX = neon_sub (pData->pWorkrow + pData->iPixelofs, iBpp, pData->iRowsize);
+
+    if (iX < (mng_int32)iBpp)
+      iX = iBpp;
+  }
+#endif
+
+  pRawx      = pData->pWorkrow + pData->iPixelofs + iX;
+  pRawx_prev = pRawx - iBpp;
 
-  for (iX = iBpp; iX < pData->iRowsize; iX++)
+  for (; iX < pData->iRowsize; iX++)
   {
     *pRawx = (mng_uint8)(*pRawx + *pRawx_prev);
     pRawx++;
@@ -92,6 +269,7 @@ MNG_LOCAL mng_retcode filter_up (mng_datap pData)
   mng_uint8p pRawx;
   mng_uint8p pPriorx;
   mng_int32  iX;
+  mng_int32  iStart;
 
 #ifdef MNG_SUPPORT_TRACE
   MNG_TRACE (pData, MNG_FN_FILTER_UP, MNG_LC_START);
@@ -99,11 +277,21 @@ MNG_LOCAL mng_retcode filter_up (mng_datap pData)
 
   pRawx   = pData->pWorkrow + pData->iPixelofs;
   pPriorx = pData->pPrevrow + pData->iPixelofs;
+  iStart  = 0;
+
+#ifdef MNG_USE_NEON                    /* this one has no serial dependency */
+  for (; iStart + 16 <= pData->iRowsize; iStart += 16)
+  {
+    vst1q_u8 (pRawx, vaddq_u8 (vld1q_u8 (pRawx), vld1q_u8 (pPriorx)));
+    pRawx   += 16;
+    pPriorx += 16;
+  }
+#endif
 
 #ifdef MNG_DECREMENT_LOOPS
-  for (iX = pData->iRowsize - 1; iX >= 0; iX--)
+  for (iX = pData->iRowsize - iStart - 1; iX >= 0; iX--)
 #else
-  for (iX = 0; iX < pData->iRowsize; iX++)
+  for (iX = iStart; iX < pData->iRowsize; iX++)
 #endif
   {
     *pRawx = (mng_uint8)(*pRawx + *pPriorx);
@@ -127,6 +315,7 @@ MNG_LOCAL mng_retcode filter_average (mng_datap pData)
   mng_uint8p pRawx_prev;
   mng_uint8p pPriorx;
   mng_int32  iX;
+  mng_int32  iStart;
 
 #ifdef MNG_SUPPORT_TRACE
   MNG_TRACE (pData, MNG_FN_FILTER_AVERAGE, MNG_LC_START);
@@ -136,19 +325,36 @@ MNG_LOCAL mng_retcode filter_average (mng_datap pData)
   pRawx      = pData->pWorkrow + pData->iPixelofs;
   pPriorx    = pData->pPrevrow + pData->iPixelofs;
   pRawx_prev = pData->pWorkrow + pData->iPixelofs;
+  iStart     = 0;
 
+#ifdef MNG_USE_NEON
+  if ((iBpp == 3) || (iBpp == 4))
+    iStart = neon_average (pRawx, pPriorx, iBpp, pData->iRowsize);
+#endif
+
+  if (iStart < iBpp)
+  {
 #ifdef MNG_DECREMENT_LOOPS
-  for (iX = iBpp - 1; iX >= 0; iX--)
+    for (iX = iBpp - 1; iX >= 0; iX--)
 #else
-  for (iX = 0; iX < iBpp; iX++)
+    for (iX = 0; iX < iBpp; iX++)
 #endif
-  {
-    *pRawx = (mng_uint8)(*pRawx + ((*pPriorx) >> 1));
-    pRawx++;
-    pPriorx++;
+    {
+      *pRawx = (mng_uint8)(*pRawx + ((*pPriorx) >> 1));
+      pRawx++;
+      pPriorx++;
+    }
+
+    iStart = iBpp;
+  }
+  else
+  {                                    /* continue where NEON stopped */
+    pRawx      += iStart;
+    pPriorx    += iStart;
+    pRawx_prev += iStart - iBpp;
   }
 
-  for (iX = iBpp; iX < pData->iRowsize; iX++)
+  for (iX = iStart; iX < pData->iRowsize; iX++)
   {
     *pRawx = (mng_uint8)(*pRawx + ((*pRawx_prev + *pPriorx) >> 1));
     pRawx++;
@@ -173,6 +379,7 @@ MNG_LOCAL mng_retcode filter_paeth (mng_datap pData)
   mng_uint8p pPriorx;
   mng_uint8p pPriorx_prev;
   mng_int32  iX;
+  mng_int32  iStart;
   mng_uint32 iA, iB, iC;
   mng_uint32 iP;
   mng_uint32 iPa, iPb, iPc;
@@ -186,20 +393,38 @@ MNG_LOCAL mng_retcode filter_paeth (mng_datap pData)
   pPriorx      = pData->pPrevrow + pData->iPixelofs;
   pRawx_prev   = pData->pWorkrow + pData->iPixelofs;
   pPriorx_prev = pData->pPrevrow + pData->iPixelofs;
+  iStart       = 0;
 
+#ifdef MNG_USE_NEON
+  if ((iBpp == 3) || (iBpp == 4))
+    iStart = neon_paeth (pRawx, pPriorx, iBpp, pData->iRowsize);
+#endif
+
+  if (iStart < iBpp)
+  {
 #ifdef MNG_DECREMENT_LOOPS
-  for (iX = iBpp - 1; iX >= 0; iX--)
+    for (iX = iBpp - 1; iX >= 0; iX--)
 #else
-  for (iX = 0; iX < iBpp; iX++)
+    for (iX = 0; iX < iBpp; iX++)
 #endif
-  {
-    *pRawx = (mng_uint8)(*pRawx + *pPriorx);
+    {
+      *pRawx = (mng_uint8)(*pRawx + *pPriorx);
 
-    pRawx++;
-    pPriorx++;
+      pRawx++;
+      pPriorx++;
+    }
+
+    iStart = iBpp;
+  }
+  else
+  {                                    /* continue where NEON stopped */
+    pRawx        += iStart;
+    pPriorx      += iStart;
+    pRawx_prev   += iStart - iBpp;
+    pPriorx_prev += iStart - iBpp;
   }
 
-  for (iX = iBpp; iX < pData->iRowsize; iX++)
+  for (iX = iStart; iX < pData->iRowsize; iX++)
   {
     iA  = (mng_uint32)*pRawx_prev;
     iB  = (mng_uint32)*pPriorx;
@@ -196,6 +196,9 @@
 /* *             - added support for ANG proposal                           * */
 /* *             1.0.10 - 07/06/2007 - G.R-P bugfix by Lucas Quintana       * */
 /* *                                                                        * */
+/* *             1.0.10 - 10/14/2026                                        * */
+/* *             - added cachelimit & dirtyrefresh properties               * */
+/* *                                                                        * */
 /* ************************************************************************** */
 
 #include "libmng.h"
@@ -679,7 +682,9 @@ MNG_LOCAL mng_func_entry const func_table [] =
     {"mng_get_bgcolor",            1, 0, 0},
     {"mng_get_bitdepth",           1, 0, 0},
     {"mng_get_bkgdstyle",          1, 0, 0},
+    {"mng_get_cachelimit",         1, 0, 10},
     {"mng_get_cacheplayback",      1, 0, 2},
+    {"mng_get_cachesize",          1, 0, 10},
     {"mng_get_canvasstyle",        1, 0, 0},
     {"mng_get_colortype",          1, 0, 0},
     {"mng_get_compression",        1, 0, 0},
@@ -693,6 +698,7 @@ MNG_LOCAL mng_func_entry const func_table [] =
     {"mng_get_dfltimggamma",       1, 0, 0},
     {"mng_get_dfltimggammaint",    1, 0, 0},
 #endif
+    {"mng_get_dirtyrefresh",       1, 0, 10},
     {"mng_get_displaygamma",       1, 0, 0},
     {"mng_get_displaygammaint",    1, 0, 0},
     {"mng_get_doprogressive",      1, 0, 2},
@@ -1052,12 +1058,14 @@ MNG_LOCAL mng_func_entry const func_table [] =
     {"mng_readdisplay",            1, 0, 0},
     {"mng_set_bgcolor",            1, 0, 0},
     {"mng_set_bkgdstyle",          1, 0, 0},
+    {"mng_set_cachelimit",         1, 0, 10},
     {"mng_set_cacheplayback",      1, 0, 2},
     {"mng_set_canvasstyle",        1, 0, 0},
     {"mng_set_dfltimggamma",       1, 0, 0},
 #ifndef MNG_NO_DFLT_INFO
     {"mng_set_dfltimggammaint",    1, 0, 0},
 #endif
+    {"mng_set_dirtyrefresh",       1, 0, 10},
     {"mng_set_displaygamma",       1, 0, 0},
     {"mng_set_displaygammaint",    1, 0, 0},
     {"mng_set_doprogressive",      1, 0, 2},
@@ -1273,6 +1281,10 @@ mng_handle MNG_DECL mng_initialize (mng_ptr       pUserdata,
   pData->bCacheplayback        = MNG_TRUE;
                                        /* progressive refresh for large images */
   pData->bDoProgressive        = MNG_TRUE;
+                                       /* refresh the whole update-region */
+  pData->bDirtyrefresh         = MNG_FALSE;
+                                       /* no limit on the playback cache */
+  pData->iCachelimit           = 0;
                                        /* crc exists; should check; error for
                                           critical chunks; warning for ancillery;
                                           generate crc for output */
@@ -1453,6 +1465,9 @@ mng_retcode MNG_DECL mng_reset (mng_handle hHandle)
 
 #ifdef MNG_SUPPORT_DISPLAY
   mng_drop_objects (pData, MNG_TRUE);  /* drop stored objects (if any) */
+                                       /* drop the dirty-region row (if any) */
+  MNG_FREE (pData, pData->pDirtyrow, pData->iDirtyrowsize);
+  pData->iDirtyrowsize = 0;
 
 #ifndef MNG_SKIPCHUNK_iCCP
   if (pData->iGlobalProfilesize)       /* drop global profile (if any) */
@@ -1634,6 +1649,11 @@ mng_retcode MNG_DECL mng_reset (mng_handle hHandle)
   pData->iUpdatetop            = 0;
   pData->iUpdatebottom         = 0;
 
+  pData->pDirtyrow             = MNG_NULL;
+  pData->iDirtyrowsize         = 0;
+  pData->iDirtypixelsize       = 0;
+  pData->iCachesize            = 0;
+
   pData->iPass                 = -1;   /* interlacing stuff and temp buffers */
   pData->iRow                  = 0;
   pData->iRowinc               = 1;
@@ -1677,6 +1697,7 @@ mng_retcode MNG_DECL mng_reset (mng_handle hHandle)
 #endif
                                        /* no processing callbacks */
   pData->fDisplayrow           = MNG_NULL;
+  pData->fDirtyrow             = MNG_NULL;
   pData->fRestbkgdrow          = MNG_NULL;
   pData->fCorrectrow           = MNG_NULL;
   pData->fRetrieverow          = MNG_NULL;
@@ -147,6 +147,9 @@
 /* *             1.0.10 - 04/12/2007 - G.Juyn                               * */
 /* *             - added support for ANG proposal                           * */
 /* *                                                                        * */
+/* *             1.0.10 - 10/14/2026                                        * */
+/* *             - added playback-cache limit (packed ani images)           * */
+/* *                                                                        * */
 /* ************************************************************************** */
 
 #include "libmng.h"
@@ -163,6 +166,7 @@
 #include "libmng_pixels.h"
 #include "libmng_object_prc.h"
 #include "libmng_cms.h"
+#include "libmng_zlib.h"
 
 #if defined(__BORLANDC__) && defined(MNG_STRICT_ANSI)
 #pragma option -A                      /* force ANSI-C */
@@ -2407,6 +2411,37 @@ mng_retcode mng_create_ani_image (mng_datap pData)
     pImage->sHeader.fProcess = mng_process_ani_image;
 
     mng_add_ani_object (pData, (mng_object_headerp)pImage);
+
+#ifdef MNG_INCLUDE_ZLIB                /* over the cache-limit ? */
+    if ((pData->iCachelimit) &&
+#ifndef MNG_NO_DELTA_PNG               /* delta-images are used as is */
+        (!pData->bHasDHDR) &&
+#endif
+        (pData->iCachesize + pImage->pImgbuf->iImgdatasize > pData->iCachelimit))
+    {
+      mng_imagedatap pBuf = pImage->pImgbuf;
+      mng_uint8p     pPacked;
+      mng_uint32     iPackedsize;
+                                       /* then try to keep it deflated */
+      iRetcode = mngzlib_packbuffer (pData, pBuf->pImgdata, pBuf->iImgdatasize,
+                                     &pPacked, &iPackedsize);
+
+      if (iRetcode)                    /* on error bail out */
+        return iRetcode;
+
+      if (pPacked)                     /* replace the samples if it did shrink */
+      {
+        MNG_FREEX (pData, pBuf->pImgdata, pBuf->iImgdatasize);
+        pBuf->pImgdata    = pPacked;
+        pBuf->iPackedsize = iPackedsize;
+      }
+    }
+#endif
+
+    if (pImage->pImgbuf->iPackedsize)  /* account for it */
+      pData->iCachesize += pImage->pImgbuf->iPackedsize;
+    else
+      pData->iCachesize += pImage->pImgbuf->iImgdatasize;
   }
 
 #ifdef MNG_SUPPORT_TRACE
@@ -2428,6 +2463,17 @@ mng_retcode mng_free_ani_image (mng_datap   pData,
 #ifdef MNG_SUPPORT_TRACE
   MNG_TRACE (pData, MNG_FN_FREE_ANI_IMAGE, MNG_LC_START);
 #endif
+
+  if (pImgbuf->iPackedsize)            /* packed samples ? */
+  {
+    pData->iCachesize -= pImgbuf->iPackedsize;
+                                       /* then they're not iImgdatasize long */
+    MNG_FREEX (pData, pImgbuf->pImgdata, pImgbuf->iPackedsize);
+    pImgbuf->pImgdata     = MNG_NULL;
+    pImgbuf->iImgdatasize = 0;
+  }
+  else
+    pData->iCachesize -= pImgbuf->iImgdatasize;
                                        /* unlink the image-data buffer */
   iRetcode = mng_free_imagedataobject (pData, pImgbuf);
                                        /* drop its own buffer */
@@ -2442,6 +2488,27 @@ mng_retcode mng_free_ani_image (mng_datap   pData,
 
 /* ************************************************************************** */
 
+MNG_LOCAL mng_retcode copy_ani_imgdata (mng_datap      pData,
+                                        mng_imagedatap pBuf,
+                                        mng_imagedatap pAnibuf)
+{
+  pBuf->iPackedsize = 0;               /* the copy is never packed */
+
+  MNG_ALLOC (pData, pBuf->pImgdata, pBuf->iImgdatasize);
+
+#ifdef MNG_INCLUDE_ZLIB
+  if (pAnibuf->iPackedsize)            /* kept deflated in the cache ? */
+    return mngzlib_unpackbuffer (pData, pAnibuf->pImgdata, pAnibuf->iPackedsize,
+                                 pBuf->pImgdata, pBuf->iImgdatasize);
+#endif
+
+  MNG_COPY (pBuf->pImgdata, pAnibuf->pImgdata, pBuf->iImgdatasize);
+
+  return MNG_NOERROR;
+}
+
+/* ************************************************************************** */
+
 mng_retcode mng_process_ani_image (mng_datap   pData,
                                    mng_objectp pObject)
 {
@@ -2499,8 +2566,10 @@ mng_retcode mng_process_ani_image (mng_datap   pData,
 
       if (pBuf->iImgdatasize)          /* sample buffer present ? */
       {                                /* then make a copy */
-        MNG_ALLOC (pData, pBuf->pImgdata, pBuf->iImgdatasize);
-        MNG_COPY (pBuf->pImgdata, pImage->pImgbuf->pImgdata, pBuf->iImgdatasize);
+        iRetcode = copy_ani_imgdata (pData, pBuf, pImage->pImgbuf);
+
+        if (iRetcode)                  /* on error bail out */
+          return iRetcode;
       }
 
 #ifndef MNG_SKIPCHUNK_iCCP
@@ -2538,8 +2607,10 @@ mng_retcode mng_process_ani_image (mng_datap   pData,
 
       if (pBuf->iImgdatasize)          /* sample buffer present ? */
       {                                /* then make a copy */
-        MNG_ALLOC (pData, pBuf->pImgdata, pBuf->iImgdatasize);
-        MNG_COPY (pBuf->pImgdata, pImage->pImgbuf->pImgdata, pBuf->iImgdatasize);
+        iRetcode = copy_ani_imgdata (pData, pBuf, pImage->pImgbuf);
+
+        if (iRetcode)                  /* on error bail out */
+          return iRetcode;
       }
 
 #ifndef MNG_SKIPCHUNK_iCCP
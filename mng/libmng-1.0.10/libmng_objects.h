@@ -73,6 +73,9 @@
 /* *             1.0.10 - 04/12/2007 - G.Juyn                               * */
 /* *             - added support for ANG proposal                           * */
 /* *                                                                        * */
+/* *             1.0.10 - 10/14/2026                                        * */
+/* *             - added packed sample data for the playback cache          * */
+/* *                                                                        * */
 /* ************************************************************************** */
 
 #if defined(__BORLANDC__) && defined(MNG_STRICT_ANSI)
@@ -180,6 +183,8 @@ typedef struct {                                 /* MNG specification "object-bu
            mng_uint32        iRowsize;           /* size of a row of samples */
            mng_uint32        iImgdatasize;       /* size of the sample data buffer */
            mng_uint8p        pImgdata;           /* actual sample data buffer */
+           mng_uint32        iPackedsize;        /* size of pImgdata when it is kept
+                                                    deflated in the playback cache */
 
          } mng_imagedata;
 typedef mng_imagedata * mng_imagedatap;
@@ -190,6 +190,10 @@
 /* *             - optimized footprint of 16bit support                     * */
 /* *             1.0.10 - 03/07/2006 - (thanks to W. Manthey)               * */
 /* *             - added CANVAS_RGB555 and CANVAS_BGR555                    * */
+/* *             1.0.10 - 10/14/2026                                        * */
+/* *             - added NEON composing onto RGBA8 canvases                 * */
+/* *             - copy opaque rows onto RGBA8 canvases at once             * */
+/* *             - added dirty-region refresh (mng_display_dirty)           * */
 /* *                                                                        * */
 /* ************************************************************************** */
 
@@ -313,6 +317,77 @@ MNG_LOCAL mng_uint32 const interlace_divider  [7] = { 3, 3, 2, 2, 1, 1, 0 };
 #define DIV255B8(x) (mng_uint8)(((x) + 127) / 255)
 #define DIV255B16(x) (mng_uint16)(((x) + 32767) / 65535)
 
+/* ************************************************************************** */
+/* *                                                                        * */
+/* * NEON composing - does 8 RGBA8 pixels at a time for the two usual       * */
+/* * cases: an opaque canvas (MNG_COMPOSE8; a zero alpha gives the canvas   * */
+/* * and a full alpha the image, just as the plain C code) and a fully      * */
+/* * transparent one (copy any pixel that has some opacity); stops at the   * */
+/* * first group of mixed canvas pixels & returns the number of pixels done * */
+/* *                                                                        * */
+/* ************************************************************************** */
+
+#ifdef MNG_USE_NEON
+#include <arm_neon.h>
+
+MNG_LOCAL mng_int32 neon_compose_rgba8 (mng_uint8p pScanline,
+                                        mng_uint8p pDataline,
+                                        mng_int32  iCount,
+                                        mng_bool   bBGR)
+{
+  uint8x8x4_t vFG, vBG;
+  uint8x8_t   vIA, vT, vMask;
+  uint16x8_t  vH;
+  uint16x8_t  vRound = vdupq_n_u16 (128);
+  uint64_t    iBGa;
+  mng_int32   iX, iC;
+
+  for (iX = 0; iX + 8 <= iCount; iX += 8)
+  {
+    vBG  = vld4_u8 (pScanline);
+    vFG  = vld4_u8 (pDataline);
+    iBGa = vget_lane_u64 (vreinterpret_u64_u8 (vBG.val[3]), 0);
+
+    if (bBGR)                          /* canvas order for the image too */
+    {
+      vT         = vFG.val[0];
+      vFG.val[0] = vFG.val[2];
+      vFG.val[2] = vT;
+    }
+
+    if (iBGa == ~(uint64_t)0)          /* canvas fully opaque ? */
+    {
+      vIA = vmvn_u8 (vFG.val[3]);      /* 255 - alpha */
+
+      for (iC = 0; iC < 3; iC++)
+      {
+        vH = vmull_u8 (vFG.val[iC], vFG.val[3]);
+        vH = vmlal_u8 (vH, vBG.val[iC], vIA);
+        vH = vaddq_u16 (vH, vRound);
+        vBG.val[iC] = vshrn_n_u16 (vsraq_n_u16 (vH, vH, 8), 8);
+      }
+    }                                  /* alpha remains fully opaque !!! */
+    else
+    {
+      if (iBGa)                        /* mixed canvas pixels ? */
+        break;
+                                       /* take the pixels with any opacity */
+      vMask = vtst_u8 (vFG.val[3], vFG.val[3]);
+
+      for (iC = 0; iC < 4; iC++)
+        vBG.val[iC] = vbsl_u8 (vMask, vFG.val[iC], vBG.val[iC]);
+    }
+
+    vst4_u8 (pScanline, vBG);
+
+    pScanline += 32;
+    pDataline += 32;
+  }
+
+  return iX;
+}
+#endif /* MNG_USE_NEON */
+
 /* ************************************************************************** */
 /* *                                                                        * */
 /* * Progressive display check - checks to see if progressive display is    * */
@@ -371,6 +446,94 @@ MNG_LOCAL void check_update_region (mng_datap pData)
 
 /* ************************************************************************** */
 
+mng_retcode mng_display_dirty (mng_datap pData)
+{
+  mng_uint8p  pScanline;
+  mng_uint8p  pSaved;
+  mng_int32   iRow;
+  mng_uint32  iSize;
+  mng_uint32  iFirst, iLast;
+  mng_int32   iLeft, iRight;
+  mng_uint32  iUpdateleft, iUpdateright, iUpdatetop, iUpdatebottom;
+  mng_retcode iRetcode;
+
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACE (pData, MNG_FN_DISPLAY_DIRTY, MNG_LC_START);
+#endif
+                                       /* not viewable ? */
+  if ((pData->iRow < pData->iSourcet) || (pData->iRow >= pData->iSourceb) ||
+      (pData->iDestl >= pData->iDestr))
+    return ((mng_displayrow)pData->fDirtyrow) (pData);
+                                       /* address destination row */
+  iRow      = pData->iRow + pData->iDestt - pData->iSourcet;
+  pScanline = (mng_uint8p)pData->fGetcanvasline (((mng_handle)pData), iRow);
+  pScanline = pScanline + (pData->iDestl * pData->iDirtypixelsize);
+  iSize     = (pData->iDestr - pData->iDestl) * pData->iDirtypixelsize;
+
+  if (iSize > pData->iDirtyrowsize)    /* need a larger copy ? */
+  {
+    MNG_FREE (pData, pData->pDirtyrow, pData->iDirtyrowsize);
+    pData->iDirtyrowsize = 0;
+    MNG_ALLOC (pData, pData->pDirtyrow, iSize);
+    pData->iDirtyrowsize = iSize;
+  }
+                                       /* remember what's there now */
+  MNG_COPY (pData->pDirtyrow, pScanline, iSize);
+
+  iUpdateleft   = pData->iUpdateleft;  /* the display routine will claim */
+  iUpdateright  = pData->iUpdateright; /* the whole row */
+  iUpdatetop    = pData->iUpdatetop;
+  iUpdatebottom = pData->iUpdatebottom;
+                                       /* now display it */
+  iRetcode = ((mng_displayrow)pData->fDirtyrow) (pData);
+
+  pData->iUpdateleft   = iUpdateleft;
+  pData->iUpdateright  = iUpdateright;
+  pData->iUpdatetop    = iUpdatetop;
+  pData->iUpdatebottom = iUpdatebottom;
+
+  if (iRetcode)                        /* on error bail out */
+    return iRetcode;
+                                       /* find the first & last changed byte */
+  pSaved = pData->pDirtyrow;
+  iFirst = 0;
+
+  while ((iFirst < iSize) && (*(pScanline+iFirst) == *(pSaved+iFirst)))
+    iFirst++;
+
+  if (iFirst < iSize)                  /* anything changed at all ? */
+  {
+    iLast = iSize;
+
+    while (*(pScanline+iLast-1) == *(pSaved+iLast-1))
+      iLast--;
+                                       /* the pixels that cover them */
+    iLeft  = pData->iDestl + (mng_int32)(iFirst / pData->iDirtypixelsize);
+    iRight = pData->iDestl + (mng_int32)((iLast + pData->iDirtypixelsize - 1) /
+                                        pData->iDirtypixelsize);
+                                       /* check for change in update-region */
+    if ((iLeft < (mng_int32)pData->iUpdateleft) || (pData->iUpdateright == 0))
+      pData->iUpdateleft   = iLeft;
+
+    if (iRight > (mng_int32)pData->iUpdateright)
+      pData->iUpdateright  = iRight;
+
+    if ((iRow < (mng_int32)pData->iUpdatetop) || (pData->iUpdatebottom == 0))
+      pData->iUpdatetop    = iRow;
+
+    if (iRow+1 > (mng_int32)pData->iUpdatebottom)
+      pData->iUpdatebottom = iRow+1;
+  }
+
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACE (pData, MNG_FN_DISPLAY_DIRTY, MNG_LC_END);
+#endif
+
+  return MNG_NOERROR;
+}
+
+/* ************************************************************************** */
+
 #ifndef MNG_SKIPCANVAS_RGB8
 #ifndef MNG_NO_16BIT_SUPPORT
 #ifndef MNG_OPTIMIZE_FOOTPRINT_COMPOSE
@@ -735,6 +898,9 @@ mng_retcode mng_display_rgba8 (mng_datap pData)
   mng_uint8p pScanline;
   mng_uint8p pDataline;
   mng_int32  iX;
+#ifdef MNG_USE_NEON
+  mng_int32  iN, iNext;
+#endif
   mng_uint8  iFGa8, iBGa8, iCa8;
   mng_uint16 iFGa16, iBGa16, iCa16;
   mng_uint16 iFGr16, iFGg16, iFGb16;
@@ -778,16 +944,24 @@ mng_retcode mng_display_rgba8 (mng_datap pData)
       }
       else
       {
-        for (iX = pData->iSourcel + pData->iCol; iX < pData->iSourcer;
-             iX += pData->iColinc)
-        {                              /* copy the values */
-          *pScanline     = *pDataline;
-          *(pScanline+1) = *(pDataline+1);
-          *(pScanline+2) = *(pDataline+2);
-          *(pScanline+3) = *(pDataline+3);
+        iX = pData->iSourcel + pData->iCol;
 
-          pScanline += (pData->iColinc << 2);
-          pDataline += 4;
+        if ((pData->iColinc == 1) && (iX < pData->iSourcer))
+        {                              /* adjacent pixels; copy them at once */
+          MNG_COPY (pScanline, pDataline, (pData->iSourcer - iX) << 2);
+        }
+        else
+        {
+          for (; iX < pData->iSourcer; iX += pData->iColinc)
+          {                            /* copy the values */
+            *pScanline     = *pDataline;
+            *(pScanline+1) = *(pDataline+1);
+            *(pScanline+2) = *(pDataline+2);
+            *(pScanline+3) = *(pDataline+3);
+
+            pScanline += (pData->iColinc << 2);
+            pDataline += 4;
+          }
         }
       }
     }
@@ -864,9 +1038,27 @@ mng_retcode mng_display_rgba8 (mng_datap pData)
       }
       else
       {
-        for (iX = pData->iSourcel + pData->iCol; iX < pData->iSourcer;
-             iX += pData->iColinc)
+        iX = pData->iSourcel + pData->iCol;
+#ifdef MNG_USE_NEON
+        iNext = iX;
+#endif
+
+        for (; iX < pData->iSourcer; iX += pData->iColinc)
         {
+#ifdef MNG_USE_NEON
+          if ((pData->iColinc == 1) && (iX >= iNext))
+          {                            /* as much as possible 8 pixels at a time */
+            iN         = neon_compose_rgba8 (pScanline, pDataline,
+                                             pData->iSourcer - iX, MNG_FALSE);
+            pScanline += iN << 2;
+            pDataline += iN << 2;
+            iX        += iN;
+            iNext      = iX + 8;       /* mixed canvas pixels or the last few */
+
+            if (iX >= pData->iSourcer)
+              break;
+          }
+#endif
           iFGa8 = *(pDataline+3);      /* get alpha values */
           iBGa8 = *(pScanline+3);
 
@@ -1092,6 +1284,9 @@ mng_retcode mng_display_rgba8 (mng_datap pData)
   mng_uint8p pScanline;
   mng_uint8p pDataline;
   mng_int32  iX;
+#ifdef MNG_USE_NEON
+  mng_int32  iN, iNext;
+#endif
   mng_uint8  iFGa8, iBGa8, iCa8;
   mng_uint8  iCr8, iCg8, iCb8;
 
@@ -1113,25 +1308,51 @@ mng_retcode mng_display_rgba8 (mng_datap pData)
     if (pData->bIsOpaque)              /* forget about transparency ? */
     {
       {
-        for (iX = pData->iSourcel + pData->iCol; iX < pData->iSourcer;
-             iX += pData->iColinc)
-        {                              /* copy the values */
-          *pScanline     = *pDataline;
-          *(pScanline+1) = *(pDataline+1);
-          *(pScanline+2) = *(pDataline+2);
-          *(pScanline+3) = *(pDataline+3);
+        iX = pData->iSourcel + pData->iCol;
 
-          pScanline += (pData->iColinc << 2);
-          pDataline += 4;
+        if ((pData->iColinc == 1) && (iX < pData->iSourcer))
+        {                              /* adjacent pixels; copy them at once */
+          MNG_COPY (pScanline, pDataline, (pData->iSourcer - iX) << 2);
+        }
+        else
+        {
+          for (; iX < pData->iSourcer; iX += pData->iColinc)
+          {                            /* copy the values */
+            *pScanline     = *pDataline;
+            *(pScanline+1) = *(pDataline+1);
+            *(pScanline+2) = *(pDataline+2);
+            *(pScanline+3) = *(pDataline+3);
+
+            pScanline += (pData->iColinc << 2);
+            pDataline += 4;
+          }
         }
       }
     }
     else
     {
       {
-        for (iX = pData->iSourcel + pData->iCol; iX < pData->iSourcer;
-             iX += pData->iColinc)
+        iX = pData->iSourcel + pData->iCol;
+#ifdef MNG_USE_NEON
+        iNext = iX;
+#endif
+
+        for (; iX < pData->iSourcer; iX += pData->iColinc)
         {
+#ifdef MNG_USE_NEON
+          if ((pData->iColinc == 1) && (iX >= iNext))
+          {                            /* as much as possible 8 pixels at a time */
+            iN         = neon_compose_rgba8 (pScanline, pDataline,
+                                             pData->iSourcer - iX, MNG_FALSE);
+            pScanline += iN << 2;
+            pDataline += iN << 2;
+            iX        += iN;
+            iNext      = iX + 8;       /* mixed canvas pixels or the last few */
+
+            if (iX >= pData->iSourcer)
+              break;
+          }
+#endif
           iFGa8 = *(pDataline+3);      /* get alpha values */
           iBGa8 = *(pScanline+3);
 
@@ -3937,6 +4158,9 @@ mng_retcode mng_display_bgra8 (mng_datap pData)
   mng_uint8p pScanline;
   mng_uint8p pDataline;
   mng_int32  iX;
+#ifdef MNG_USE_NEON
+  mng_int32  iN, iNext;
+#endif
   mng_uint8  iFGa8, iBGa8, iCa8;
   mng_uint16 iFGa16, iBGa16, iCa16;
   mng_uint16 iFGr16, iFGg16, iFGb16;
@@ -4066,9 +4290,27 @@ mng_retcode mng_display_bgra8 (mng_datap pData)
       }
       else
       {
-        for (iX = pData->iSourcel + pData->iCol; iX < pData->iSourcer;
-             iX += pData->iColinc)
+        iX = pData->iSourcel + pData->iCol;
+#ifdef MNG_USE_NEON
+        iNext = iX;
+#endif
+
+        for (; iX < pData->iSourcer; iX += pData->iColinc)
         {
+#ifdef MNG_USE_NEON
+          if ((pData->iColinc == 1) && (iX >= iNext))
+          {                            /* as much as possible 8 pixels at a time */
+            iN         = neon_compose_rgba8 (pScanline, pDataline,
+                                             pData->iSourcer - iX, MNG_TRUE);
+            pScanline += iN << 2;
+            pDataline += iN << 2;
+            iX        += iN;
+            iNext      = iX + 8;       /* mixed canvas pixels or the last few */
+
+            if (iX >= pData->iSourcer)
+              break;
+          }
+#endif
           iFGa8 = *(pDataline+3);      /* get alpha values */
           iBGa8 = *(pScanline+3);
 
@@ -4294,6 +4536,9 @@ mng_retcode mng_display_bgra8 (mng_datap pData)
   mng_uint8p pScanline;
   mng_uint8p pDataline;
   mng_int32  iX;
+#ifdef MNG_USE_NEON
+  mng_int32  iN, iNext;
+#endif
   mng_uint8  iFGa8, iBGa8, iCa8;
   mng_uint8  iCr8, iCg8, iCb8;
 
@@ -4331,9 +4576,27 @@ mng_retcode mng_display_bgra8 (mng_datap pData)
     else
     {
       {
-        for (iX = pData->iSourcel + pData->iCol; iX < pData->iSourcer;
-             iX += pData->iColinc)
+        iX = pData->iSourcel + pData->iCol;
+#ifdef MNG_USE_NEON
+        iNext = iX;
+#endif
+
+        for (; iX < pData->iSourcer; iX += pData->iColinc)
         {
+#ifdef MNG_USE_NEON
+          if ((pData->iColinc == 1) && (iX >= iNext))
+          {                            /* as much as possible 8 pixels at a time */
+            iN         = neon_compose_rgba8 (pScanline, pDataline,
+                                             pData->iSourcer - iX, MNG_TRUE);
+            pScanline += iN << 2;
+            pDataline += iN << 2;
+            iX        += iN;
+            iNext      = iX + 8;       /* mixed canvas pixels or the last few */
+
+            if (iX >= pData->iSourcer)
+              break;
+          }
+#endif
           iFGa8 = *(pDataline+3);      /* get alpha values */
           iBGa8 = *(pScanline+3);
 
@@ -87,6 +87,9 @@
 /* *             1.0.10 - 03/07/2006 - (thanks to W. Manthey)               * */
 /* *             - added CANVAS_RGB555 and CANVAS_BGR555                    * */
 /* *                                                                        * */
+/* *             1.0.10 - 10/14/2026                                        * */
+/* *             - added dirty-region refresh                               * */
+/* *                                                                        * */
 /* ************************************************************************** */
 
 #if defined(__BORLANDC__) && defined(MNG_STRICT_ANSI)
@@ -177,6 +180,8 @@ mng_retcode mng_display_rgb555         (mng_datap  pData);
 mng_retcode mng_display_bgr555         (mng_datap  pData);
 #endif
 
+mng_retcode mng_display_dirty          (mng_datap  pData);
+
 /* ************************************************************************** */
 /* *                                                                        * */
 /* * Background restore routines - restore the background with info from    * */
@@ -114,6 +114,9 @@
 /* *             1.0.10 - 03/07/2006 - (thanks to W. Manthey)               * */
 /* *             - added CANVAS_RGB555 and CANVAS_BGR555                    * */
 /* *                                                                        * */
+/* *             1.0.10 - 10/14/2026                                        * */
+/* *             - added cachelimit & dirtyrefresh properties               * */
+/* *                                                                        * */
 /* ************************************************************************** */
 
 #include "libmng.h"
@@ -426,6 +429,46 @@ mng_retcode MNG_DECL mng_set_doprogressive (mng_handle hHandle,
 
 /* ************************************************************************** */
 
+mng_retcode MNG_DECL mng_set_cachelimit (mng_handle hHandle,
+                                         mng_uint32 iCachelimit)
+{
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACE (((mng_datap)hHandle), MNG_FN_SET_CACHELIMIT, MNG_LC_START);
+#endif
+
+  MNG_VALIDHANDLE (hHandle)
+
+  ((mng_datap)hHandle)->iCachelimit = iCachelimit;
+
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACE (((mng_datap)hHandle), MNG_FN_SET_CACHELIMIT, MNG_LC_END);
+#endif
+
+  return MNG_NOERROR;
+}
+
+/* ************************************************************************** */
+
+mng_retcode MNG_DECL mng_set_dirtyrefresh (mng_handle hHandle,
+                                           mng_bool   bDirtyrefresh)
+{
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACE (((mng_datap)hHandle), MNG_FN_SET_DIRTYREFRESH, MNG_LC_START);
+#endif
+
+  MNG_VALIDHANDLE (hHandle)
+
+  ((mng_datap)hHandle)->bDirtyrefresh = bDirtyrefresh;
+
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACE (((mng_datap)hHandle), MNG_FN_SET_DIRTYREFRESH, MNG_LC_END);
+#endif
+
+  return MNG_NOERROR;
+}
+
+/* ************************************************************************** */
+
 mng_retcode MNG_DECL mng_set_crcmode (mng_handle hHandle,
                                       mng_uint32 iCrcmode)
 {
@@ -1824,6 +1867,57 @@ mng_bool MNG_DECL mng_get_doprogressive (mng_handle hHandle)
 
 /* ************************************************************************** */
 
+mng_uint32 MNG_DECL mng_get_cachelimit (mng_handle hHandle)
+{
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACEX (((mng_datap)hHandle), MNG_FN_GET_CACHELIMIT, MNG_LC_START);
+#endif
+
+  MNG_VALIDHANDLEX (hHandle)
+
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACEX (((mng_datap)hHandle), MNG_FN_GET_CACHELIMIT, MNG_LC_END);
+#endif
+
+  return ((mng_datap)hHandle)->iCachelimit;
+}
+
+/* ************************************************************************** */
+
+mng_uint32 MNG_DECL mng_get_cachesize (mng_handle hHandle)
+{
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACEX (((mng_datap)hHandle), MNG_FN_GET_CACHESIZE, MNG_LC_START);
+#endif
+
+  MNG_VALIDHANDLEX (hHandle)
+
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACEX (((mng_datap)hHandle), MNG_FN_GET_CACHESIZE, MNG_LC_END);
+#endif
+
+  return ((mng_datap)hHandle)->iCachesize;
+}
+
+/* ************************************************************************** */
+
+mng_bool MNG_DECL mng_get_dirtyrefresh (mng_handle hHandle)
+{
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACEB (((mng_datap)hHandle), MNG_FN_GET_DIRTYREFRESH, MNG_LC_START);
+#endif
+
+  MNG_VALIDHANDLEX (hHandle)
+
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACEB (((mng_datap)hHandle), MNG_FN_GET_DIRTYREFRESH, MNG_LC_END);
+#endif
+
+  return ((mng_datap)hHandle)->bDirtyrefresh;
+}
+
+/* ************************************************************************** */
+
 mng_uint32 MNG_DECL mng_get_crcmode (mng_handle hHandle)
 {
 #ifdef MNG_SUPPORT_TRACE
@@ -152,6 +152,9 @@
 /* *             - added support for mPNG proposal                          * */
 /* *             1.0.10 - 07/06/2007 - G.R-P bugfix by Lucas Quintana       * */
 /* *                                                                        * */
+/* *             1.0.10 - 10/14/2026                                        * */
+/* *             - added cachelimit, dirtyrefresh & cache packing           * */
+/* *                                                                        * */
 /* ************************************************************************** */
 
 #include "libmng.h"
@@ -307,6 +310,8 @@ MNG_LOCAL mng_trace_entry const trace_table [] =
     {MNG_FN_SET_CACHEPLAYBACK,         "set_cacheplayback"},
     {MNG_FN_SET_DOPROGRESSIVE,         "set_doprogressive"},
     {MNG_FN_SET_CRCMODE,               "set_crcmode"},
+    {MNG_FN_SET_CACHELIMIT,            "set_cachelimit"},
+    {MNG_FN_SET_DIRTYREFRESH,          "set_dirtyrefresh"},
 
     {MNG_FN_GET_USERDATA,              "get_userdata"},
     {MNG_FN_GET_SIGTYPE,               "get_sigtype"},
@@ -384,6 +389,9 @@ MNG_LOCAL mng_trace_entry const trace_table [] =
 #endif
     {MNG_FN_GET_CRCMODE,               "get_crcmode"},
     {MNG_FN_GET_CURRFRAMDELAY,         "get_currframdelay"},
+    {MNG_FN_GET_CACHELIMIT,            "get_cachelimit"},
+    {MNG_FN_GET_CACHESIZE,             "get_cachesize"},
+    {MNG_FN_GET_DIRTYREFRESH,          "get_dirtyrefresh"},
 
     {MNG_FN_STATUS_ERROR,              "status_error"},
     {MNG_FN_STATUS_READING,            "status_reading"},
@@ -747,6 +755,7 @@ MNG_LOCAL mng_trace_entry const trace_table [] =
     {MNG_FN_DISPLAY_ARGB8_PM,          "display_argb8_pm"},
     {MNG_FN_DISPLAY_ABGR8_PM,          "display_abgr8_pm"},
     {MNG_FN_DISPLAY_BGR565_A8,         "display_bgr565_a8"},
+    {MNG_FN_DISPLAY_DIRTY,             "display_dirty"},
 
     {MNG_FN_INIT_FULL_CMS,             "init_full_cms"},
     {MNG_FN_CORRECT_FULL_CMS,          "correct_full_cms"},
@@ -1354,6 +1363,8 @@ MNG_LOCAL mng_trace_entry const trace_table [] =
     {MNG_FN_ZLIB_DEFLATEROWS,          "zlib_deflaterows"},
     {MNG_FN_ZLIB_DEFLATEDATA,          "zlib_deflatedata"},
     {MNG_FN_ZLIB_DEFLATEFREE,          "zlib_deflatefree"},
+    {MNG_FN_ZLIB_PACKBUFFER,           "zlib_packbuffer"},
+    {MNG_FN_ZLIB_UNPACKBUFFER,         "zlib_unpackbuffer"},
 
     {MNG_FN_PROCESS_DISPLAY_IHDR,      "process_display_ihdr"},
     {MNG_FN_PROCESS_DISPLAY_PLTE,      "process_display_plte"},
@@ -155,6 +155,9 @@
 /* *             - added support for mPNG proposal                          * */
 /* *             1.0.10 - 07/06/2007 - G.R-P bugfix by Lucas Quintana       * */
 /* *                                                                        * */
+/* *             1.0.10 - 10/14/2026                                        * */
+/* *             - added cachelimit, dirtyrefresh & cache packing           * */
+/* *                                                                        * */
 /* ************************************************************************** */
 
 #if defined(__BORLANDC__) && defined(MNG_STRICT_ANSI)
@@ -327,6 +330,8 @@ mng_retcode mng_trace (mng_datap  pData,
 #define MNG_FN_SET_CACHEPLAYBACK      335
 #define MNG_FN_SET_DOPROGRESSIVE      336
 #define MNG_FN_SET_CRCMODE            337
+#define MNG_FN_SET_CACHELIMIT         338
+#define MNG_FN_SET_DIRTYREFRESH       339
 
 #define MNG_FN_GET_USERDATA           401
 #define MNG_FN_GET_SIGTYPE            402
@@ -390,6 +395,9 @@ mng_retcode mng_trace (mng_datap  pData,
 #define MNG_FN_GET_TOTALPLAYTIME      460
 #define MNG_FN_GET_CRCMODE            461
 #define MNG_FN_GET_CURRFRAMDELAY      462
+#define MNG_FN_GET_CACHELIMIT         463
+#define MNG_FN_GET_CACHESIZE          464
+#define MNG_FN_GET_DIRTYREFRESH       465
 
 #define MNG_FN_STATUS_ERROR           481
 #define MNG_FN_STATUS_READING         482
@@ -619,6 +627,7 @@ mng_retcode mng_trace (mng_datap  pData,
 #define MNG_FN_DISPLAY_BGR565_A8     1134
 #define MNG_FN_DISPLAY_RGB555        1135
 #define MNG_FN_DISPLAY_BGR555        1136
+#define MNG_FN_DISPLAY_DIRTY         1137
 
 /* ************************************************************************** */
 
@@ -1187,6 +1196,8 @@ mng_retcode mng_trace (mng_datap  pData,
 #define MNG_FN_ZLIB_DEFLATEROWS      3008
 #define MNG_FN_ZLIB_DEFLATEDATA      3009
 #define MNG_FN_ZLIB_DEFLATEFREE      3010
+#define MNG_FN_ZLIB_PACKBUFFER       3011
+#define MNG_FN_ZLIB_UNPACKBUFFER     3012
 
 /* ************************************************************************** */
 
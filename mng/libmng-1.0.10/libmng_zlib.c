@@ -50,6 +50,9 @@
 /* *             1.0.9 - 10/09/2004 - G.R-P                                 * */
 /* *             - added MNG_NO_1_2_4BIT_SUPPORT support                    * */
 /* *                                                                        * */
+/* *             1.0.10 - 10/14/2026                                        * */
+/* *             - added buffer (un)packing for the playback cache          * */
+/* *                                                                        * */
 /* ************************************************************************** */
 
 #include "libmng.h"
@@ -599,6 +602,124 @@ mng_retcode mngzlib_deflatefree (mng_datap pData)
 
 /* ************************************************************************** */
 
+#ifdef MNG_SUPPORT_DISPLAY
+mng_retcode mngzlib_packbuffer (mng_datap   pData,
+                                mng_uint8p  pInbuf,
+                                mng_uint32  iInlen,
+                                mng_uint8p  *ppOutbuf,
+                                mng_uint32  *pOutlen)
+{
+  z_stream   sZlib;                    /* don't disturb the IDAT stream */
+  mng_uint8p pTemp;
+  mng_uint32 iTemplen;
+  int        iZrslt;
+
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACE (pData, MNG_FN_ZLIB_PACKBUFFER, MNG_LC_START);
+#endif
+
+  *ppOutbuf = MNG_NULL;                /* assume it won't get any smaller */
+  *pOutlen  = 0;
+
+  sZlib.zalloc = pData->sZlib.zalloc;  /* same memory management */
+  sZlib.zfree  = pData->sZlib.zfree;
+  sZlib.opaque = pData->sZlib.opaque;
+                                       /* speed matters more than size here */
+  iZrslt = deflateInit (&sZlib, Z_BEST_SPEED);
+
+  if (iZrslt != Z_OK)                  /* on error bail out */
+    MNG_ERRORZ (pData, (mng_uint32)iZrslt);
+                                       /* only worth it if it shrinks */
+  iTemplen = (mng_uint32)deflateBound (&sZlib, (uLong)iInlen);
+  if (iTemplen > iInlen)
+    iTemplen = iInlen;
+
+  MNG_ALLOCX (pData, pTemp, iTemplen);
+
+  if (!pTemp)                          /* no room; leave it unpacked */
+  {
+    deflateEnd (&sZlib);
+    return MNG_NOERROR;
+  }
+
+  sZlib.next_in   = pInbuf;
+  sZlib.avail_in  = (uInt)iInlen;
+  sZlib.next_out  = pTemp;
+  sZlib.avail_out = (uInt)iTemplen;
+                                       /* deflate it in one go! */
+  iZrslt = deflate (&sZlib, Z_FINISH);
+  deflateEnd (&sZlib);
+
+  if (iZrslt == Z_STREAM_END)          /* did it fit ? */
+  {                                    /* then keep just what's needed */
+    *pOutlen = (mng_uint32)sZlib.total_out;
+    MNG_ALLOCX (pData, *ppOutbuf, *pOutlen);
+
+    if (*ppOutbuf)
+    {
+      MNG_COPY (*ppOutbuf, pTemp, *pOutlen);
+    }
+    else
+      *pOutlen = 0;
+  }
+
+  MNG_FREEX (pData, pTemp, iTemplen);
+
+  if ((iZrslt != Z_STREAM_END) && (iZrslt != Z_OK) && (iZrslt != Z_BUF_ERROR))
+    MNG_ERRORZ (pData, (mng_uint32)iZrslt);
+
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACE (pData, MNG_FN_ZLIB_PACKBUFFER, MNG_LC_END);
+#endif
+
+  return MNG_NOERROR;
+}
+
+/* ************************************************************************** */
+
+mng_retcode mngzlib_unpackbuffer (mng_datap  pData,
+                                  mng_uint8p pInbuf,
+                                  mng_uint32 iInlen,
+                                  mng_uint8p pOutbuf,
+                                  mng_uint32 iOutlen)
+{
+  z_stream sZlib;                      /* don't disturb the IDAT stream */
+  int      iZrslt;
+
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACE (pData, MNG_FN_ZLIB_UNPACKBUFFER, MNG_LC_START);
+#endif
+
+  sZlib.zalloc   = pData->sZlib.zalloc;
+  sZlib.zfree    = pData->sZlib.zfree;
+  sZlib.opaque   = pData->sZlib.opaque;
+  sZlib.next_in  = pInbuf;
+  sZlib.avail_in = (uInt)iInlen;
+
+  iZrslt = inflateInit (&sZlib);
+
+  if (iZrslt != Z_OK)                  /* on error bail out */
+    MNG_ERRORZ (pData, (mng_uint32)iZrslt);
+
+  sZlib.next_out  = pOutbuf;
+  sZlib.avail_out = (uInt)iOutlen;
+                                       /* inflate it in one go! */
+  iZrslt = inflate (&sZlib, Z_FINISH);
+  inflateEnd (&sZlib);
+                                       /* it must come out exactly as it went in */
+  if ((iZrslt != Z_STREAM_END) || (sZlib.total_out != (uLong)iOutlen))
+    MNG_ERRORZ (pData, (mng_uint32)iZrslt);
+
+#ifdef MNG_SUPPORT_TRACE
+  MNG_TRACE (pData, MNG_FN_ZLIB_UNPACKBUFFER, MNG_LC_END);
+#endif
+
+  return MNG_NOERROR;
+}
+#endif /* MNG_SUPPORT_DISPLAY */
+
+/* ************************************************************************** */
+
 #endif /* MNG_INCLUDE_ZLIB */
 
 /* ************************************************************************** */
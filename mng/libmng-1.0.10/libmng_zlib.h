@@ -19,6 +19,9 @@
 /* *             0.9.2 - 08/05/2000 - G.Juyn                                * */
 /* *             - changed file-prefixes                                    * */
 /* *                                                                        * */
+/* *             1.0.10 - 10/14/2026                                        * */
+/* *             - added buffer (un)packing for the playback cache          * */
+/* *                                                                        * */
 /* ************************************************************************** */
 
 #if defined(__BORLANDC__) && defined(MNG_STRICT_ANSI)
@@ -51,6 +54,17 @@ mng_retcode mngzlib_deflatedata (mng_datap  pData,
                                  mng_uint8p pIndata);
 mng_retcode mngzlib_deflatefree (mng_datap pData);
 
+mng_retcode mngzlib_packbuffer   (mng_datap   pData,
+                                  mng_uint8p  pInbuf,
+                                  mng_uint32  iInlen,
+                                  mng_uint8p  *ppOutbuf,
+                                  mng_uint32  *pOutlen);
+mng_retcode mngzlib_unpackbuffer (mng_datap   pData,
+                                  mng_uint8p  pInbuf,
+                                  mng_uint32  iInlen,
+                                  mng_uint8p  pOutbuf,
+                                  mng_uint32  iOutlen);
+
 /* ************************************************************************** */
 
 #endif /* _libmng_zlib_h_ */
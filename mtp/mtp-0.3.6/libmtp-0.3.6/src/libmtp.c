@@ -52,6 +52,8 @@
 #include <fcntl.h>
 #include <time.h>
 #include <errno.h>
+#include <limits.h>
+#include <pthread.h>
 #ifdef _MSC_VER // For MSVC++
 #define USE_WINDOWS_IO_H
 #include <io.h>
@@ -60,6 +62,16 @@
 /* To enable PTP level debug prints (all ptp_debug(...)), switch on this */
 //#define ENABLE_PTP_DEBUG
 
+/* Piece size for pipelined transfers of large objects */
+#ifndef LIBMTP_PIPELINE_CHUNK_SIZE
+#define LIBMTP_PIPELINE_CHUNK_SIZE (1024 * 1024)
+#endif
+
+/* Where the object metadata of each device storage is cached */
+#ifndef LIBMTP_CACHE_DIR
+#define LIBMTP_CACHE_DIR "/tmp/libmtp"
+#endif
+
 /*
  * This is a mapping between libmtp internal MTP filetypes and
  * the libgphoto2/PTP equivalent defines. We need this because
@@ -96,6 +108,14 @@ static void get_handles_recursively(LIBMTP_mtpdevice_t *device,
 				    PTPObjectHandles *handles, 
 				    uint32_t storageid,
 				    uint32_t parent);
+static void save_storage_cache(LIBMTP_mtpdevice_t *device,
+			       LIBMTP_devicestorage_t *storage,
+			       int with_props);
+static int load_storage_cache(LIBMTP_mtpdevice_t *device,
+			      LIBMTP_devicestorage_t *storage,
+			      MTPProperties **props, int *nrofprops);
+static int load_metadata_cache(LIBMTP_mtpdevice_t *device);
+static void drop_metadata_cache(LIBMTP_mtpdevice_t *device);
 static void free_storage_list(LIBMTP_mtpdevice_t *device);
 static int sort_storage_by(LIBMTP_mtpdevice_t *device, int const sortby);
 static uint32_t get_writeable_storageid(LIBMTP_mtpdevice_t *device, uint64_t fitsize);
@@ -2558,6 +2578,465 @@ static void get_handles_recursively(LIBMTP_mtpdevice_t *device,
   free(currentHandles.Handler);
 }
 
+/*
+ * The object metadata of each storage is kept on disk between
+ * sessions, so that a phone with tens of thousands of objects can
+ * be browsed as soon as it is plugged in again. A cache file is
+ * keyed by the device serial number and the storage ID, and it is
+ * trusted only when the free space and the object count of the
+ * storage are still those recorded in it.
+ */
+#define METADATA_CACHE_MAGIC   0x4350544dU /* "MTPC" */
+#define METADATA_CACHE_VERSION 1
+#define METADATA_CACHE_MAX_STRING 0x10000
+
+/**
+ * Build the name of the metadata cache file of a storage.
+ * @return 0 on success, -1 if the device cannot be identified.
+ */
+static int metadata_cache_name(LIBMTP_mtpdevice_t *device,
+			       uint32_t storage_id,
+			       char *buf, size_t size)
+{
+  PTPParams *params = (PTPParams *) device->params;
+  char serial[64];
+  char const *s = params->deviceinfo.SerialNumber;
+  int i;
+
+  if (s == NULL || *s == '\0')
+    return -1;
+  // Keep the serial number safe to use as a file name
+  for (i = 0; s[i] != '\0' && i < sizeof(serial) - 1; i++) {
+    if ((s[i] >= '0' && s[i] <= '9') || (s[i] >= 'a' && s[i] <= 'z') ||
+	(s[i] >= 'A' && s[i] <= 'Z') || s[i] == '-')
+      serial[i] = s[i];
+    else
+      serial[i] = '_';
+  }
+  serial[i] = '\0';
+  if (snprintf(buf, size, "%s/%s-%08x.cache", LIBMTP_CACHE_DIR,
+	       serial, storage_id) >= size)
+    return -1;
+  return 0;
+}
+
+/**
+ * Count the objects of a storage the way the cache records them.
+ * @return the count, or 0xffffffff if the device cannot tell.
+ */
+static uint32_t count_storage_objects(LIBMTP_mtpdevice_t *device,
+				      uint32_t storage_id)
+{
+  PTPParams *params = (PTPParams *) device->params;
+  uint32_t n;
+
+  if (!ptp_operation_issupported(params, PTP_OC_GetNumObjects) ||
+      ptp_getnumobjects(params, storage_id, PTP_GOH_ALL_FORMATS,
+			PTP_GOH_ALL_ASSOCS, &n) != PTP_RC_OK)
+    return 0xffffffffU;
+  return n;
+}
+
+static int cache_write(FILE *f, void const *buf, size_t len)
+{
+  return fwrite(buf, len, 1, f) == 1 ? 0 : -1;
+}
+
+static int cache_read(FILE *f, void *buf, size_t len)
+{
+  return fread(buf, len, 1, f) == 1 ? 0 : -1;
+}
+
+static int cache_write_string(FILE *f, char const *str)
+{
+  uint32_t len = str != NULL ? strlen(str) + 1 : 0;
+
+  if (cache_write(f, &len, sizeof(len)) != 0)
+    return -1;
+  return len ? cache_write(f, str, len) : 0;
+}
+
+static int cache_read_string(FILE *f, char **str)
+{
+  uint32_t len;
+
+  *str = NULL;
+  if (cache_read(f, &len, sizeof(len)) != 0 ||
+      len > METADATA_CACHE_MAX_STRING)
+    return -1;
+  if (len == 0)
+    return 0;
+  *str = (char *) malloc(len);
+  if (*str == NULL || cache_read(f, *str, len) != 0) {
+    free(*str);
+    *str = NULL;
+    return -1;
+  }
+  (*str)[len - 1] = '\0';
+  return 0;
+}
+
+/*
+ * Size of a property value in the cache; strings are variable,
+ * arrays and 128-bit values are not cached.
+ */
+static int cache_propval_size(uint16_t datatype)
+{
+  switch (datatype) {
+  case PTP_DTC_INT8:
+  case PTP_DTC_UINT8:
+    return 1;
+  case PTP_DTC_INT16:
+  case PTP_DTC_UINT16:
+    return 2;
+  case PTP_DTC_INT32:
+  case PTP_DTC_UINT32:
+    return 4;
+  case PTP_DTC_INT64:
+  case PTP_DTC_UINT64:
+    return 8;
+  case PTP_DTC_STR:
+    return 0;
+  default:
+    return -1;
+  }
+}
+
+static int cache_write_objectinfo(FILE *f, PTPObjectInfo const *oi)
+{
+  if (cache_write(f, &oi->StorageID, sizeof(oi->StorageID)) ||
+      cache_write(f, &oi->ObjectFormat, sizeof(oi->ObjectFormat)) ||
+      cache_write(f, &oi->ProtectionStatus, sizeof(oi->ProtectionStatus)) ||
+      cache_write(f, &oi->ObjectCompressedSize, sizeof(oi->ObjectCompressedSize)) ||
+      cache_write(f, &oi->ThumbFormat, sizeof(oi->ThumbFormat)) ||
+      cache_write(f, &oi->ThumbCompressedSize, sizeof(oi->ThumbCompressedSize)) ||
+      cache_write(f, &oi->ThumbPixWidth, sizeof(oi->ThumbPixWidth)) ||
+      cache_write(f, &oi->ThumbPixHeight, sizeof(oi->ThumbPixHeight)) ||
+      cache_write(f, &oi->ImagePixWidth, sizeof(oi->ImagePixWidth)) ||
+      cache_write(f, &oi->ImagePixHeight, sizeof(oi->ImagePixHeight)) ||
+      cache_write(f, &oi->ImageBitDepth, sizeof(oi->ImageBitDepth)) ||
+      cache_write(f, &oi->ParentObject, sizeof(oi->ParentObject)) ||
+      cache_write(f, &oi->AssociationType, sizeof(oi->AssociationType)) ||
+      cache_write(f, &oi->AssociationDesc, sizeof(oi->AssociationDesc)) ||
+      cache_write(f, &oi->SequenceNumber, sizeof(oi->SequenceNumber)) ||
+      cache_write(f, &oi->CaptureDate, sizeof(oi->CaptureDate)) ||
+      cache_write(f, &oi->ModificationDate, sizeof(oi->ModificationDate)) ||
+      cache_write_string(f, oi->Filename) ||
+      cache_write_string(f, oi->Keywords))
+    return -1;
+  return 0;
+}
+
+static int cache_read_objectinfo(FILE *f, PTPObjectInfo *oi)
+{
+  if (cache_read(f, &oi->StorageID, sizeof(oi->StorageID)) ||
+      cache_read(f, &oi->ObjectFormat, sizeof(oi->ObjectFormat)) ||
+      cache_read(f, &oi->ProtectionStatus, sizeof(oi->ProtectionStatus)) ||
+      cache_read(f, &oi->ObjectCompressedSize, sizeof(oi->ObjectCompressedSize)) ||
+      cache_read(f, &oi->ThumbFormat, sizeof(oi->ThumbFormat)) ||
+      cache_read(f, &oi->ThumbCompressedSize, sizeof(oi->ThumbCompressedSize)) ||
+      cache_read(f, &oi->ThumbPixWidth, sizeof(oi->ThumbPixWidth)) ||
+      cache_read(f, &oi->ThumbPixHeight, sizeof(oi->ThumbPixHeight)) ||
+      cache_read(f, &oi->ImagePixWidth, sizeof(oi->ImagePixWidth)) ||
+      cache_read(f, &oi->ImagePixHeight, sizeof(oi->ImagePixHeight)) ||
+      cache_read(f, &oi->ImageBitDepth, sizeof(oi->ImageBitDepth)) ||
+      cache_read(f, &oi->ParentObject, sizeof(oi->ParentObject)) ||
+      cache_read(f, &oi->AssociationType, sizeof(oi->AssociationType)) ||
+      cache_read(f, &oi->AssociationDesc, sizeof(oi->AssociationDesc)) ||
+      cache_read(f, &oi->SequenceNumber, sizeof(oi->SequenceNumber)) ||
+      cache_read(f, &oi->CaptureDate, sizeof(oi->CaptureDate)) ||
+      cache_read(f, &oi->ModificationDate, sizeof(oi->ModificationDate)) ||
+      cache_read_string(f, &oi->Filename) ||
+      cache_read_string(f, &oi->Keywords))
+    return -1;
+  return 0;
+}
+
+/**
+ * Find the run of cached properties of an object. The properties
+ * of an object are contiguous and mostly in handle order, so the
+ * search starts where the previous one ended.
+ * @param cursor index to start at, updated past the run.
+ * @return the number of properties in the run.
+ */
+static int find_object_props(PTPParams *params, uint32_t handle,
+			     int *cursor, MTPProperties **first)
+{
+  int pass, i, n;
+
+  for (pass = 0; pass < 2; pass++) {
+    for (i = (pass == 0) ? *cursor : 0; i < params->nrofprops; i++) {
+      if (params->props[i].ObjectHandle == handle) {
+	*first = &params->props[i];
+	for (n = 0; i < params->nrofprops &&
+	       params->props[i].ObjectHandle == handle; i++, n++)
+	  /*empty*/;
+	*cursor = i;
+	return n;
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ * Write the metadata of all objects of a storage to its cache file.
+ * @param with_props also write the cached property list.
+ */
+static void save_storage_cache(LIBMTP_mtpdevice_t *device,
+			       LIBMTP_devicestorage_t *storage,
+			       int with_props)
+{
+  PTPParams *params = (PTPParams *) device->params;
+  char name[PATH_MAX];
+  char tmpname[PATH_MAX];
+  uint32_t header[4];
+  uint32_t numobjects;
+  uint32_t count = 0;
+  uint32_t i;
+  int cursor = 0;
+  FILE *f;
+
+  if (storage->FreeSpaceInBytes == (uint64_t) -1 ||
+      metadata_cache_name(device, storage->id, name, sizeof(name)) != 0)
+    return;
+  numobjects = count_storage_objects(device, storage->id);
+  if (numobjects == 0xffffffffU)
+    return;
+  for (i = 0; i < params->handles.n; i++)
+    if (params->objectinfo[i].StorageID == storage->id)
+      count++;
+
+  if (snprintf(tmpname, sizeof(tmpname), "%s.tmp", name) >= sizeof(tmpname))
+    return;
+  mkdir(LIBMTP_CACHE_DIR, 0700);
+  f = fopen(tmpname, "wb");
+  if (f == NULL)
+    return;
+
+  header[0] = METADATA_CACHE_MAGIC;
+  header[1] = METADATA_CACHE_VERSION;
+  header[2] = storage->id;
+  header[3] = numobjects;
+  if (cache_write(f, header, sizeof(header)) ||
+      cache_write(f, &storage->FreeSpaceInBytes, sizeof(storage->FreeSpaceInBytes)) ||
+      cache_write(f, &with_props, sizeof(with_props)) ||
+      cache_write(f, &count, sizeof(count)))
+    goto error;
+
+  for (i = 0; i < params->handles.n; i++) {
+    PTPObjectInfo *oi = &params->objectinfo[i];
+    MTPProperties *prop = NULL;
+    uint32_t nprops = 0;
+    int j, n = 0;
+
+    if (oi->StorageID != storage->id)
+      continue;
+    if (cache_write(f, &params->handles.Handler[i], sizeof(uint32_t)) ||
+	cache_write_objectinfo(f, oi))
+      goto error;
+    if (!with_props)
+      continue;
+
+    n = find_object_props(params, params->handles.Handler[i], &cursor, &prop);
+    for (j = 0; j < n; j++)
+      if (cache_propval_size(prop[j].datatype) >= 0)
+	nprops++;
+    if (cache_write(f, &nprops, sizeof(nprops)))
+      goto error;
+    for (j = 0; j < n; j++, prop++) {
+      int size = cache_propval_size(prop->datatype);
+
+      if (size < 0)
+	continue;
+      if (cache_write(f, &prop->property, sizeof(prop->property)) ||
+	  cache_write(f, &prop->datatype, sizeof(prop->datatype)))
+	goto error;
+      if (size == 0) {
+	if (cache_write_string(f, prop->propval.str))
+	  goto error;
+      } else if (cache_write(f, &prop->propval, size)) {
+	goto error;
+      }
+    }
+  }
+
+  if (fclose(f) == 0 && rename(tmpname, name) == 0)
+    return;
+  unlink(tmpname);
+  return;
+
+ error:
+  fclose(f);
+  unlink(tmpname);
+}
+
+/**
+ * Append the cached metadata of a storage to the handle list, and
+ * its properties to *props, if the cache file is still valid.
+ * @param props the property list to extend, or NULL to skip
+ *        them. A cache written without properties is then invalid.
+ * @return 0 on success, -1 if the cache cannot be used.
+ */
+static int load_storage_cache(LIBMTP_mtpdevice_t *device,
+			      LIBMTP_devicestorage_t *storage,
+			      MTPProperties **props, int *nrofprops)
+{
+  PTPParams *params = (PTPParams *) device->params;
+  char name[PATH_MAX];
+  uint32_t header[4];
+  uint64_t freespace;
+  int with_props;
+  uint32_t count;
+  uint32_t old_handles = params->handles.n;
+  int old_props = nrofprops != NULL ? *nrofprops : 0;
+  uint32_t i, j;
+  FILE *f;
+
+  if (storage->FreeSpaceInBytes == (uint64_t) -1 ||
+      metadata_cache_name(device, storage->id, name, sizeof(name)) != 0)
+    return -1;
+  f = fopen(name, "rb");
+  if (f == NULL)
+    return -1;
+
+  if (cache_read(f, header, sizeof(header)) ||
+      cache_read(f, &freespace, sizeof(freespace)) ||
+      cache_read(f, &with_props, sizeof(with_props)) ||
+      cache_read(f, &count, sizeof(count)) ||
+      header[0] != METADATA_CACHE_MAGIC ||
+      header[1] != METADATA_CACHE_VERSION ||
+      header[2] != storage->id ||
+      freespace != storage->FreeSpaceInBytes ||
+      (props != NULL && !with_props) ||
+      count > 0x1000000U)
+    goto invalid;
+  // The only round trip: has anything been added or removed?
+  if (header[3] != count_storage_objects(device, storage->id))
+    goto invalid;
+
+  params->handles.Handler = (uint32_t *) realloc(params->handles.Handler,
+		      (old_handles + count) * sizeof(uint32_t));
+  params->objectinfo = (PTPObjectInfo *) realloc(params->objectinfo,
+		      (old_handles + count) * sizeof(PTPObjectInfo));
+  if (params->handles.Handler == NULL || params->objectinfo == NULL)
+    goto invalid;
+  memset(&params->objectinfo[old_handles], 0, count * sizeof(PTPObjectInfo));
+
+  for (i = 0; i < count; i++) {
+    PTPObjectInfo *oi = &params->objectinfo[old_handles + i];
+    uint32_t nprops;
+
+    if (cache_read(f, &params->handles.Handler[old_handles + i], sizeof(uint32_t)))
+      goto invalid;
+    params->handles.n = old_handles + i + 1;
+    if (cache_read_objectinfo(f, oi))
+      goto invalid;
+    if (!with_props)
+      continue;
+
+    if (cache_read(f, &nprops, sizeof(nprops)) || nprops > 0x10000U)
+      goto invalid;
+    if (props != NULL) {
+      MTPProperties *newprops;
+
+      newprops = (MTPProperties *) realloc(*props,
+		      (*nrofprops + nprops) * sizeof(MTPProperties));
+      if (newprops == NULL && nprops != 0)
+	goto invalid;
+      *props = newprops;
+    }
+    for (j = 0; j < nprops; j++) {
+      MTPProperties prop;
+      int size;
+
+      memset(&prop, 0, sizeof(prop));
+      prop.ObjectHandle = params->handles.Handler[old_handles + i];
+      if (cache_read(f, &prop.property, sizeof(prop.property)) ||
+	  cache_read(f, &prop.datatype, sizeof(prop.datatype)))
+	goto invalid;
+      size = cache_propval_size(prop.datatype);
+      if (size < 0)
+	goto invalid;
+      if (size == 0) {
+	if (cache_read_string(f, &prop.propval.str))
+	  goto invalid;
+      } else if (cache_read(f, &prop.propval, size)) {
+	goto invalid;
+      }
+      if (props != NULL)
+	(*props)[(*nrofprops)++] = prop;
+      else if (size == 0)
+	free(prop.propval.str);
+    }
+  }
+  fclose(f);
+  return 0;
+
+ invalid:
+  fclose(f);
+  // Drop whatever was appended from this file
+  for (i = old_handles; i < params->handles.n; i++)
+    ptp_free_objectinfo(&params->objectinfo[i]);
+  params->handles.n = old_handles;
+  if (props != NULL) {
+    for (i = old_props; i < *nrofprops; i++)
+      if ((*props)[i].datatype == PTP_DTC_STR)
+	free((*props)[i].propval.str);
+    *nrofprops = old_props;
+  }
+  return -1;
+}
+
+/**
+ * Fill in the handle list and the property list of all storages from
+ * their cache files. All of them must be valid, since on devices
+ * that can list all metadata at once, one request refreshes
+ * them all anyway.
+ * @return 0 on success, -1 if the device has to be asked.
+ */
+static int load_metadata_cache(LIBMTP_mtpdevice_t *device)
+{
+  PTPParams *params = (PTPParams *) device->params;
+  LIBMTP_devicestorage_t *storage;
+  MTPProperties *props = NULL;
+  int nrofprops = 0;
+  uint32_t i;
+
+  if (device->storage == NULL)
+    return -1;
+  for (storage = device->storage; storage != NULL; storage = storage->next) {
+    if (load_storage_cache(device, storage, &props, &nrofprops) != 0) {
+      for (i = 0; i < params->handles.n; i++)
+	ptp_free_objectinfo(&params->objectinfo[i]);
+      params->handles.n = 0;
+      if (props != NULL)
+	ptp_destroy_object_prop_list(props, nrofprops);
+      return -1;
+    }
+  }
+  if (props == NULL)
+    return params->handles.n ? 0 : -1;
+  params->props = props;
+  params->nrofprops = nrofprops;
+  return 0;
+}
+
+/**
+ * Forget the cached metadata of a device, after it has been
+ * changed through us in a way that may leave the free space and
+ * object count alone (e.g. renaming).
+ */
+static void drop_metadata_cache(LIBMTP_mtpdevice_t *device)
+{
+  LIBMTP_devicestorage_t *storage;
+  char name[PATH_MAX];
+
+  for (storage = device->storage; storage != NULL; storage = storage->next)
+    if (metadata_cache_name(device, storage->id, name, sizeof(name)) == 0)
+      unlink(name);
+}
+
 /**
  * This function refresh the internal handle list whenever
  * the items stored inside the device is altered. On operations
@@ -2570,6 +3049,7 @@ static void flush_handles(LIBMTP_mtpdevice_t *device)
   PTPParams *params = (PTPParams *) device->params;
   PTP_USB *ptp_usb = (PTP_USB*) device->usbinfo;
   int ret;
+  int cached = 0;
   uint32_t i;
 
   if (params->handles.Handler != NULL) {
@@ -2593,12 +3073,22 @@ static void flush_handles(LIBMTP_mtpdevice_t *device)
   if (ptp_operation_issupported(params,PTP_OC_MTP_GetObjPropList)
       && !FLAG_BROKEN_MTPGETOBJPROPLIST(ptp_usb)
       && !FLAG_BROKEN_MTPGETOBJPROPLIST_ALL(ptp_usb)) {
-    // Use the fast method. Ignore return value for now.
-    ret = get_all_metadata_fast(device, PTP_GOH_ALL_STORAGE);
+    if (load_metadata_cache(device) == 0) {
+      cached = 1;
+    } else {
+      // Use the fast method. Ignore return value for now.
+      ret = get_all_metadata_fast(device, PTP_GOH_ALL_STORAGE);
+      if (params->props != NULL) {
+	LIBMTP_devicestorage_t *storage;
+
+	for (storage = device->storage; storage != NULL; storage = storage->next)
+	  save_storage_cache(device, storage, 1);
+      }
+    }
   }
   // If the previous failed or returned no objects, use classic
   // methods instead.
-  if (params->props == NULL) {
+  if (params->props == NULL && !cached) {
     // Get all the handles using just standard commands.
     if (device->storage == NULL) {
       get_handles_recursively(device, params,
@@ -2606,13 +3096,21 @@ static void flush_handles(LIBMTP_mtpdevice_t *device)
 			      PTP_GOH_ALL_STORAGE,
 			      PTP_GOH_ROOT_PARENT);
     } else {
-      // Get handles for each storage in turn.
+      // Get handles for each storage in turn, unless it is unchanged
+      // since it was last cached.
       LIBMTP_devicestorage_t *storage = device->storage;
       while(storage != NULL) {
-	get_handles_recursively(device, params,
-				&params->handles,
-				storage->id,
-				PTP_GOH_ROOT_PARENT);
+	if (load_storage_cache(device, storage, NULL, NULL) != 0) {
+	  uint32_t old_handles = params->handles.n;
+
+	  get_handles_recursively(device, params,
+				  &params->handles,
+				  storage->id,
+				  PTP_GOH_ROOT_PARENT);
+	  // An empty storage is as quick to list again
+	  if (params->handles.n > old_handles)
+	    save_storage_cache(device, storage, 0);
+	}
 	storage = storage->next;
       }
     }
@@ -5087,6 +5585,147 @@ int LIBMTP_Get_File_To_File(LIBMTP_mtpdevice_t *device, uint32_t const id,
   return ret;
 }
 
+/*
+ * Large objects are read with GetPartialObject, one chunk at a time,
+ * while another thread writes the previous chunk to the file
+ * descriptor, so that USB transfers overlap with a slow sink such
+ * as a pipe to a player.
+ */
+typedef struct {
+  int fd;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  unsigned char *chunk; /**< Next chunk to write, NULL once taken */
+  uint32_t len; /**< Length of that chunk */
+  int done; /**< Set when no more chunks will come */
+  int error; /**< Set when a write failed */
+} chunk_writer_t;
+
+static void *chunk_writer_thread(void *arg)
+{
+  chunk_writer_t *w = (chunk_writer_t *) arg;
+  unsigned char *chunk;
+  uint32_t len, written;
+  ssize_t n;
+
+  pthread_mutex_lock(&w->lock);
+  for (;;) {
+    while (w->chunk == NULL && !w->done)
+      pthread_cond_wait(&w->cond, &w->lock);
+    if (w->chunk == NULL)
+      break;
+    chunk = w->chunk;
+    len = w->len;
+    w->chunk = NULL;
+    pthread_cond_signal(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+
+    // After an error, chunks are only drained
+    for (written = 0; !w->error && written < len; written += n) {
+      n = write(w->fd, chunk + written, len - written);
+      if (n < 0 && errno == EINTR) {
+	n = 0;
+      } else if (n <= 0) {
+	pthread_mutex_lock(&w->lock);
+	w->error = 1;
+	pthread_mutex_unlock(&w->lock);
+	break;
+      }
+    }
+    free(chunk);
+    pthread_mutex_lock(&w->lock);
+  }
+  pthread_mutex_unlock(&w->lock);
+  return NULL;
+}
+
+/**
+ * Get an object to a file descriptor in LIBMTP_PIPELINE_CHUNK_SIZE
+ * pieces, writing each piece while the next one is transferred.
+ * @return 0 on success, -1 on failure, 1 if the transfer could not
+ *         be started this way.
+ */
+static int get_object_pipelined(LIBMTP_mtpdevice_t *device,
+				uint32_t const id, uint32_t const size,
+				int const fd,
+				LIBMTP_progressfunc_t const callback,
+				void const * const data)
+{
+  PTPParams *params = (PTPParams *) device->params;
+  chunk_writer_t w;
+  pthread_t writer;
+  uint32_t offset = 0;
+  uint16_t ret = PTP_RC_OK;
+  int cancelled = 0;
+  int error = 0;
+
+  memset(&w, 0, sizeof(w));
+  w.fd = fd;
+  pthread_mutex_init(&w.lock, NULL);
+  pthread_cond_init(&w.cond, NULL);
+  if (pthread_create(&writer, NULL, chunk_writer_thread, &w) != 0) {
+    pthread_cond_destroy(&w.cond);
+    pthread_mutex_destroy(&w.lock);
+    return 1;
+  }
+
+  while (offset < size) {
+    unsigned char *chunk = NULL;
+    uint32_t len = 0;
+    uint32_t want = size - offset;
+
+    if (want > LIBMTP_PIPELINE_CHUNK_SIZE)
+      want = LIBMTP_PIPELINE_CHUNK_SIZE;
+    ret = ptp_getpartialobject(params, id, offset, want, &chunk, &len);
+    if (ret == PTP_RC_OK && len == 0)
+      ret = PTP_RC_GeneralError; // would never finish
+    if (ret != PTP_RC_OK) {
+      free(chunk);
+      break;
+    }
+
+    pthread_mutex_lock(&w.lock);
+    while (w.chunk != NULL)
+      pthread_cond_wait(&w.cond, &w.lock);
+    w.chunk = chunk;
+    w.len = len;
+    error = w.error;
+    pthread_cond_signal(&w.cond);
+    pthread_mutex_unlock(&w.lock);
+
+    offset += len;
+    if (error)
+      break;
+    if (callback != NULL && callback(offset, size, data) != 0) {
+      cancelled = 1;
+      break;
+    }
+  }
+
+  pthread_mutex_lock(&w.lock);
+  w.done = 1;
+  pthread_cond_signal(&w.cond);
+  pthread_mutex_unlock(&w.lock);
+  pthread_join(writer, NULL);
+  error = w.error;
+  pthread_cond_destroy(&w.cond);
+  pthread_mutex_destroy(&w.lock);
+
+  if (cancelled) {
+    add_error_to_errorstack(device, LIBMTP_ERROR_CANCELLED, "LIBMTP_Get_File_To_File_Descriptor(): Cancelled transfer.");
+    return -1;
+  }
+  if (ret != PTP_RC_OK) {
+    add_ptp_error_to_errorstack(device, ret, "LIBMTP_Get_File_To_File_Descriptor(): Could not get part of file from device.");
+    return -1;
+  }
+  if (error) {
+    add_error_to_errorstack(device, LIBMTP_ERROR_GENERAL, "LIBMTP_Get_File_To_File_Descriptor(): Could not write file.");
+    return -1;
+  }
+  return 0;
+}
+
 /**
  * This gets a file off the device to a file identified
  * by a file descriptor.
@@ -5094,6 +5733,8 @@ int LIBMTP_Get_File_To_File(LIBMTP_mtpdevice_t *device, uint32_t const id,
  * This function can potentially be used for streaming
  * files off the device for playback or broadcast for example,
  * by downloading the file into a stream sink e.g. a socket.
+ * Objects larger than <code>LIBMTP_PIPELINE_CHUNK_SIZE</code> are
+ * transferred in pieces, each written out while the next one is read.
  *
  * @param device a pointer to the device to get the file from.
  * @param id the file ID of the file to retrieve.
@@ -5116,6 +5757,7 @@ int LIBMTP_Get_File_To_File_Descriptor(LIBMTP_mtpdevice_t *device,
   PTPObjectInfo *oi;
   uint32_t i;
   uint16_t ret;
+  uint64_t size;
   PTPParams *params = (PTPParams *) device->params;
   PTP_USB *ptp_usb = (PTP_USB*) device->usbinfo;
   
@@ -5143,6 +5785,18 @@ int LIBMTP_Get_File_To_File_Descriptor(LIBMTP_mtpdevice_t *device,
     return -1;
   }
 
+  // Partial offsets are 32 bits, and so is the object info size
+  size = oi->ObjectCompressedSize;
+  if (device->object_bitsize == 64)
+    size = get_u64_from_object(device, id, PTP_OPC_ObjectSize, size);
+  if (size > LIBMTP_PIPELINE_CHUNK_SIZE && size < 0xffffffffU &&
+      ptp_operation_issupported(params, PTP_OC_GetPartialObject)) {
+    int pret = get_object_pipelined(device, id, (uint32_t) size,
+				    fd, callback, data);
+    if (pret <= 0)
+      return pret;
+  }
+
   // Callbacks
   ptp_usb->callback_active = 1;
   ptp_usb->current_transfer_total = oi->ObjectCompressedSize+
@@ -8526,6 +9180,7 @@ static void add_object_to_cache(LIBMTP_mtpdevice_t *device, uint32_t object_id)
   if (ret != PTP_RC_OK) {
     add_ptp_error_to_errorstack(device, ret, "add_object_to_cache(): couldn't add object to cache");
   }
+  drop_metadata_cache(device);
 }
 
 
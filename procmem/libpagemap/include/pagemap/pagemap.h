@@ -61,6 +61,9 @@ struct pm_process {
     int num_maps;
 
     int pagemap_fd;
+
+    /* Reused by the map usage functions, see PM_PAGEMAP_BATCH */
+    uint64_t *pagemap_buf;
 };
 
 /* pm_map_t holds the state necessary to access information about a particular
@@ -171,6 +174,9 @@ int pm_process_maps(pm_process_t *proc, pm_map_t ***maps_out, size_t *len);
 /* Destroy a pm_process_t. */
 int pm_process_destroy(pm_process_t *proc);
 
+/* Pages of pagemap read at once by the map usage functions */
+#define PM_PAGEMAP_BATCH 4096
+
 /* Get the name, flags, start/end address, or offset of a map. */
 #define pm_map_name(map)   ((map)->name)
 #define pm_map_flags(map)  ((map)->flags)
@@ -113,36 +113,28 @@ int pm_kernel_pids(pm_kernel_t *ker, pid_t **pids_out, size_t *len) {
     return 0;
 }
 
-int pm_kernel_count(pm_kernel_t *ker, uint64_t pfn, uint64_t *count_out) {
-    off64_t off;
+static int kpage_read(int fd, uint64_t pfn, uint64_t *entry_out) {
+    ssize_t ret;
+
+    ret = pread64(fd, entry_out, sizeof(uint64_t), pfn * sizeof(uint64_t));
+    if (ret < (ssize_t)sizeof(uint64_t))
+        return (ret < 0) ? errno : -1;
+
+    return 0;
+}
 
+int pm_kernel_count(pm_kernel_t *ker, uint64_t pfn, uint64_t *count_out) {
     if (!ker || !count_out)
         return -1;
 
-    off = lseek64(ker->kpagecount_fd, pfn * sizeof(uint64_t), SEEK_SET);
-    if (off == (off_t)-1)
-        return errno;
-    if (read(ker->kpagecount_fd, count_out, sizeof(uint64_t)) <
-        (ssize_t)sizeof(uint64_t))
-        return errno;
-
-    return 0;
+    return kpage_read(ker->kpagecount_fd, pfn, count_out);
 }
 
 int pm_kernel_flags(pm_kernel_t *ker, uint64_t pfn, uint64_t *flags_out) {
-    off64_t off;
-
     if (!ker || !flags_out)
         return -1;
 
-    off = lseek64(ker->kpageflags_fd, pfn * sizeof(uint64_t), SEEK_SET);
-    if (off == (off_t)-1)
-        return errno;
-    if (read(ker->kpageflags_fd, flags_out, sizeof(uint64_t)) <
-        (ssize_t)sizeof(uint64_t))
-        return errno;
-
-    return 0;
+    return kpage_read(ker->kpageflags_fd, pfn, flags_out);
 }
 
 int pm_kernel_destroy(pm_kernel_t *ker) {
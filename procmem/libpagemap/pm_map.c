@@ -19,6 +19,8 @@
 
 #include <pagemap/pagemap.h>
 
+#include "pm_map.h"
+
 int pm_map_pagemap(pm_map_t *map, uint64_t **pagemap_out, size_t *len) {
     if (!map)
         return -1;
@@ -30,6 +32,7 @@ int pm_map_pagemap(pm_map_t *map, uint64_t **pagemap_out, size_t *len) {
 int pm_map_usage_flags(pm_map_t *map, pm_memusage_t *usage_out,
                         uint64_t flags_mask, uint64_t required_flags) {
     uint64_t *pagemap;
+    uint64_t addr, numpages;
     size_t len, i;
     uint64_t count;
     pm_memusage_t usage;
@@ -38,48 +41,57 @@ int pm_map_usage_flags(pm_map_t *map, pm_memusage_t *usage_out,
     if (!map || !usage_out)
         return -1;
 
-    error = pm_map_pagemap(map, &pagemap, &len);
-    if (error) return error;
-
     pm_memusage_zero(&usage);
 
-    for (i = 0; i < len; i++) {
-        usage.vss += map->proc->ker->pagesize;
-
-        if (!PM_PAGEMAP_PRESENT(pagemap[i]))
-            continue;
-
-        if (!PM_PAGEMAP_SWAPPED(pagemap[i])) {
-            if (flags_mask) {
-                uint64_t flags;
-                error = pm_kernel_flags(map->proc->ker, PM_PAGEMAP_PFN(pagemap[i]),
-                                        &flags);
-                if (error) goto out;
-
-                if ((flags & flags_mask) != required_flags)
-                    continue;
+    /* The pagemap is read in batches into a buffer of the process, rather
+     * than all at once into a new one for each map. */
+    for (addr = map->start; addr < map->end;
+         addr += numpages * map->proc->ker->pagesize) {
+        numpages = (map->end - addr) / map->proc->ker->pagesize;
+        if (numpages > PM_PAGEMAP_BATCH)
+            numpages = PM_PAGEMAP_BATCH;
+        if (!numpages)
+            break;
+
+        error = pm_process_pagemap_batch(map->proc, addr, numpages,
+                                         &pagemap, &len);
+        if (error) return error;
+        if (!len)
+            break;
+
+        for (i = 0; i < len; i++) {
+            usage.vss += map->proc->ker->pagesize;
+
+            if (!PM_PAGEMAP_PRESENT(pagemap[i]))
+                continue;
+
+            if (!PM_PAGEMAP_SWAPPED(pagemap[i])) {
+                if (flags_mask) {
+                    uint64_t flags;
+                    error = pm_kernel_flags(map->proc->ker,
+                                            PM_PAGEMAP_PFN(pagemap[i]), &flags);
+                    if (error) return error;
+
+                    if ((flags & flags_mask) != required_flags)
+                        continue;
+                }
+
+                error = pm_kernel_count(map->proc->ker,
+                                        PM_PAGEMAP_PFN(pagemap[i]), &count);
+                if (error) return error;
+
+                usage.rss += (count >= 1) ? map->proc->ker->pagesize : (0);
+                usage.pss += (count >= 1) ? (map->proc->ker->pagesize / count) : (0);
+                usage.uss += (count == 1) ? (map->proc->ker->pagesize) : (0);
+            } else {
+                usage.swap += map->proc->ker->pagesize;
             }
-
-            error = pm_kernel_count(map->proc->ker, PM_PAGEMAP_PFN(pagemap[i]),
-                                    &count);
-            if (error) goto out;
-
-            usage.rss += (count >= 1) ? map->proc->ker->pagesize : (0);
-            usage.pss += (count >= 1) ? (map->proc->ker->pagesize / count) : (0);
-            usage.uss += (count == 1) ? (map->proc->ker->pagesize) : (0);
-        } else {
-            usage.swap += map->proc->ker->pagesize;
         }
     }
 
     memcpy(usage_out, &usage, sizeof(usage));
 
-    error = 0;
-
-out:    
-    free(pagemap);
-
-    return error;
+    return 0;
 }
 
 int pm_map_usage(pm_map_t *map, pm_memusage_t *usage_out) {
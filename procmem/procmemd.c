@@ -0,0 +1,647 @@
+/*
+ * Copyright (C) 2008 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * procmemd samples the PSS, USS and swap of every process at an interval
+ * and keeps the last samples of each in a ring, so that the memory trend of
+ * a process is still there after the memory ran out. The rings are read
+ * over a unix socket, one text command per connection:
+ *
+ *   list          pid alive samples pss uss swap name, one per process
+ *   dump [pid]    pid time pss uss swap, oldest sample first
+ *   stats         state of the daemon
+ *
+ * Sizes are in kB, times in seconds since the daemon started.
+ *
+ * /proc/<pid>/smaps_rollup is used where the kernel has it. Otherwise the
+ * pagemap of the process is walked with libpagemap, except while its
+ * /proc/<pid>/statm does not change. The interval is stretched whenever
+ * sampling would take more than CPU_BUDGET_PERMILLE of the CPU.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libpagemap/include/pagemap/pagemap.h"
+
+#define DEFAULT_SOCKET      "/tmp/procmemd.sock"
+#define DEFAULT_INTERVAL_MS 10000
+#define DEFAULT_SAMPLES     360
+#define DEFAULT_PROCESSES   256
+
+/* Own CPU time allowed, in per mille of the wall clock time */
+#define CPU_BUDGET_PERMILLE 10
+/* The interval is not stretched beyond this many times the configured one */
+#define MAX_STRETCH 8
+/* Walk the pagemap at least every this many samples, even if statm did not
+ * change, as the sharing of the pages may have */
+#define MAX_SKIPPED 10
+
+#define NAME_LEN 16
+#define STATM_LEN 96
+#define MAX_FILENAME 64
+#define MAX_COMMAND 64
+
+/* One sample of one process, in kB */
+struct sample {
+    uint32_t time;
+    uint32_t pss;
+    uint32_t uss;
+    uint32_t swap;
+};
+
+/* The samples of one process */
+struct series {
+    pid_t pid;
+    /* Tells apart the processes that have had the same pid */
+    unsigned long long starttime;
+    char name[NAME_LEN];
+    int alive;
+    uint32_t last_seen;
+
+    /* statm when the pagemap was last walked */
+    char statm[STATM_LEN];
+    int skipped;
+
+    struct sample *ring;
+    size_t head;
+    size_t count;
+};
+
+static pm_kernel_t *ker;
+
+static struct series *series;
+static size_t num_series;
+static size_t max_series;
+static size_t ring_len;
+
+static int interval_ms;
+static int cur_interval_ms;
+static int have_rollup = 1;
+
+static struct timespec start_time;
+static time_t start_realtime;
+static uint64_t samples_taken;
+static uint64_t pagemap_walks;
+static uint64_t samples_dropped;
+static uint64_t cpu_us_total;
+
+static volatile sig_atomic_t stop;
+
+static void usage(const char *cmd);
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static uint32_t uptime(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec - start_time.tv_sec;
+}
+
+static uint64_t cpu_us(void) {
+    struct rusage ru;
+
+    getrusage(RUSAGE_SELF, &ru);
+    return (uint64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000 +
+           ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+static int read_file(const char *filename, char *buf, size_t len) {
+    ssize_t ret;
+    int fd;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    ret = read(fd, buf, len - 1);
+    close(fd);
+    if (ret < 0)
+        return -1;
+    buf[ret] = '\0';
+
+    return 0;
+}
+
+/* Get the name and start time of a process from /proc/<pid>/stat. */
+static int read_stat(pid_t pid, char *name, unsigned long long *starttime) {
+    char filename[MAX_FILENAME];
+    char buf[512];
+    char *open_paren, *close_paren;
+    size_t len;
+
+    snprintf(filename, MAX_FILENAME, "/proc/%d/stat", pid);
+    if (read_file(filename, buf, sizeof(buf)))
+        return -1;
+
+    open_paren = strchr(buf, '(');
+    close_paren = strrchr(buf, ')');
+    if (!open_paren || !close_paren || close_paren < open_paren)
+        return -1;
+
+    len = close_paren - open_paren - 1;
+    if (len >= NAME_LEN)
+        len = NAME_LEN - 1;
+    memcpy(name, open_paren + 1, len);
+    name[len] = '\0';
+
+    /* starttime is the 22nd field, the 20th after the name */
+    if (sscanf(close_paren + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u "
+               "%*u %*u %*d %*d %*d %*d %*d %*d %llu", starttime) != 1)
+        return -1;
+
+    return 0;
+}
+
+/*
+ * Get the usage of a process from /proc/<pid>/smaps_rollup. Return ENOENT if
+ * the kernel does not have it.
+ */
+static int read_rollup(pid_t pid, struct sample *s) {
+    char filename[MAX_FILENAME];
+    char line[128], field[32];
+    unsigned long kb;
+    FILE *f;
+
+    snprintf(filename, MAX_FILENAME, "/proc/%d/smaps_rollup", pid);
+    f = fopen(filename, "r");
+    if (!f)
+        return errno;
+
+    s->pss = s->uss = s->swap = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "%31s %lu", field, &kb) != 2)
+            continue;
+        if (!strcmp(field, "Pss:"))
+            s->pss = kb;
+        else if (!strcmp(field, "Private_Clean:") ||
+                 !strcmp(field, "Private_Dirty:"))
+            s->uss += kb;
+        else if (!strcmp(field, "Swap:"))
+            s->swap = kb;
+    }
+    fclose(f);
+
+    return 0;
+}
+
+static int read_pagemap(pid_t pid, struct sample *s) {
+    pm_process_t *proc;
+    pm_memusage_t usage;
+    int error;
+
+    error = pm_process_create(ker, pid, &proc);
+    if (error)
+        return error;
+
+    error = pm_process_usage(proc, &usage);
+    pm_process_destroy(proc);
+    if (error)
+        return error;
+
+    s->pss = usage.pss / 1024;
+    s->uss = usage.uss / 1024;
+    s->swap = usage.swap / 1024;
+    pagemap_walks++;
+
+    return 0;
+}
+
+static struct sample *last_sample(struct series *ser) {
+    if (!ser->count)
+        return NULL;
+
+    return &ser->ring[(ser->head + ring_len - 1) % ring_len];
+}
+
+static void add_sample(struct series *ser, const struct sample *s) {
+    ser->ring[ser->head] = *s;
+    ser->head = (ser->head + 1) % ring_len;
+    if (ser->count < ring_len)
+        ser->count++;
+}
+
+static struct series *find_series(pid_t pid, unsigned long long starttime) {
+    size_t i;
+
+    for (i = 0; i < num_series; i++) {
+        if (series[i].pid == pid && series[i].starttime == starttime)
+            return &series[i];
+    }
+
+    return NULL;
+}
+
+/*
+ * Find room for a new process whose first sample is s: a free entry, else
+ * the entry of the process that exited first, else that of the smallest
+ * process if it is smaller than the new one.
+ */
+static struct series *new_series(const struct sample *s) {
+    struct series *victim = NULL;
+    struct sample *last;
+    size_t i;
+
+    if (num_series < max_series) {
+        victim = &series[num_series++];
+    } else {
+        for (i = 0; i < num_series; i++) {
+            if (!series[i].alive &&
+                (!victim || series[i].last_seen < victim->last_seen))
+                victim = &series[i];
+        }
+        if (!victim) {
+            for (i = 0; i < num_series; i++) {
+                last = last_sample(&series[i]);
+                if (last && last->pss < s->pss &&
+                    (!victim || last->pss < last_sample(victim)->pss))
+                    victim = &series[i];
+            }
+        }
+        if (!victim)
+            return NULL;
+    }
+
+    victim->statm[0] = '\0';
+    victim->skipped = 0;
+    victim->head = 0;
+    victim->count = 0;
+
+    return victim;
+}
+
+static void sample_process(pid_t pid, uint32_t now) {
+    char filename[MAX_FILENAME];
+    char name[NAME_LEN], statm[STATM_LEN];
+    unsigned long long starttime;
+    struct series *ser;
+    struct sample s, *last;
+    int error;
+
+    if (read_stat(pid, name, &starttime))
+        return;
+
+    ser = find_series(pid, starttime);
+    s.time = now;
+
+    if (have_rollup) {
+        error = read_rollup(pid, &s);
+        if (error == ENOENT) {
+            syslog(LOG_INFO, "no smaps_rollup, walking the pagemaps");
+            have_rollup = 0;
+        } else if (error) {
+            return;
+        }
+    }
+
+    if (!have_rollup) {
+        snprintf(filename, MAX_FILENAME, "/proc/%d/statm", pid);
+        if (read_file(filename, statm, sizeof(statm)))
+            return;
+
+        last = ser ? last_sample(ser) : NULL;
+        if (last && ser->skipped < MAX_SKIPPED && !strcmp(statm, ser->statm)) {
+            s.pss = last->pss;
+            s.uss = last->uss;
+            s.swap = last->swap;
+            ser->skipped++;
+        } else {
+            /* The process may have exited meanwhile */
+            if (read_pagemap(pid, &s))
+                return;
+            if (ser) {
+                strcpy(ser->statm, statm);
+                ser->skipped = 0;
+            }
+        }
+    }
+
+    if (!ser) {
+        /* Nothing to track in a kernel thread */
+        if (!s.pss && !s.swap)
+            return;
+
+        ser = new_series(&s);
+        if (!ser) {
+            samples_dropped++;
+            return;
+        }
+        ser->pid = pid;
+        ser->starttime = starttime;
+        if (!have_rollup)
+            strcpy(ser->statm, statm);
+    }
+
+    /* The name changes at exec */
+    strcpy(ser->name, name);
+    ser->alive = 1;
+    ser->last_seen = now;
+    add_sample(ser, &s);
+    samples_taken++;
+}
+
+static void sample_all(void) {
+    pid_t *pids;
+    size_t num_pids, i;
+    uint32_t now;
+
+    if (pm_kernel_pids(ker, &pids, &num_pids)) {
+        syslog(LOG_ERR, "error listing processes");
+        return;
+    }
+
+    now = uptime();
+    for (i = 0; i < num_series; i++)
+        series[i].alive = 0;
+    for (i = 0; i < num_pids; i++)
+        sample_process(pids[i], now);
+
+    free(pids);
+}
+
+/*
+ * Sample, then set the next interval from the CPU time it took, so that
+ * sampling uses at most CPU_BUDGET_PERMILLE of the CPU.
+ */
+static void tick(void) {
+    uint64_t before, cost_us;
+    uint64_t wanted_ms;
+
+    before = cpu_us();
+    sample_all();
+    cost_us = cpu_us() - before;
+    cpu_us_total += cost_us;
+
+    wanted_ms = cost_us / CPU_BUDGET_PERMILLE;
+    if (wanted_ms < (uint64_t)interval_ms)
+        wanted_ms = interval_ms;
+    if (wanted_ms > (uint64_t)interval_ms * MAX_STRETCH)
+        wanted_ms = (uint64_t)interval_ms * MAX_STRETCH;
+    if ((int)wanted_ms != cur_interval_ms)
+        syslog(LOG_INFO, "sampling every %" PRIu64 " ms", wanted_ms);
+    cur_interval_ms = wanted_ms;
+}
+
+static void dump_series(FILE *out, const struct series *ser) {
+    const struct sample *s;
+    size_t i;
+
+    for (i = 0; i < ser->count; i++) {
+        s = &ser->ring[(ser->head + ring_len - ser->count + i) % ring_len];
+        fprintf(out, "%d %" PRIu32 " %" PRIu32 " %" PRIu32 " %" PRIu32 "\n",
+                ser->pid, s->time, s->pss, s->uss, s->swap);
+    }
+}
+
+static void run_command(FILE *out, char *cmd) {
+    struct sample *last;
+    uint64_t cpu, wall;
+    char *arg;
+    pid_t pid = 0;
+    size_t i;
+
+    cmd[strcspn(cmd, "\r\n")] = '\0';
+    arg = strchr(cmd, ' ');
+    if (arg) {
+        *arg++ = '\0';
+        pid = atoi(arg);
+    }
+
+    if (!strcmp(cmd, "list")) {
+        for (i = 0; i < num_series; i++) {
+            last = last_sample(&series[i]);
+            fprintf(out, "%d %d %zu %" PRIu32 " %" PRIu32 " %" PRIu32 " %s\n",
+                    series[i].pid, series[i].alive, series[i].count,
+                    last->pss, last->uss, last->swap, series[i].name);
+        }
+    } else if (!strcmp(cmd, "dump")) {
+        for (i = 0; i < num_series; i++) {
+            if (!pid || series[i].pid == pid)
+                dump_series(out, &series[i]);
+        }
+    } else if (!strcmp(cmd, "stats")) {
+        cpu = cpu_us();
+        wall = (uint64_t)uptime() * 1000000;
+        fprintf(out, "started %lld\n", (long long)start_realtime);
+        fprintf(out, "uptime %" PRIu32 "\n", uptime());
+        fprintf(out, "interval_ms %d\n", interval_ms);
+        fprintf(out, "current_interval_ms %d\n", cur_interval_ms);
+        fprintf(out, "smaps_rollup %d\n", have_rollup);
+        fprintf(out, "processes %zu/%zu\n", num_series, max_series);
+        fprintf(out, "ring %zu\n", ring_len);
+        fprintf(out, "samples %" PRIu64 "\n", samples_taken);
+        fprintf(out, "pagemap_walks %" PRIu64 "\n", pagemap_walks);
+        fprintf(out, "dropped %" PRIu64 "\n", samples_dropped);
+        fprintf(out, "sampling_cpu_ms %" PRIu64 "\n", cpu_us_total / 1000);
+        fprintf(out, "cpu_permille %" PRIu64 "\n",
+                wall ? cpu * 1000 / wall : 0);
+    } else {
+        fprintf(out, "error: unknown command \"%s\"\n", cmd);
+    }
+}
+
+static void serve_client(int listen_fd) {
+    struct timeval tv = { 1, 0 };
+    char cmd[MAX_COMMAND];
+    ssize_t ret;
+    size_t len = 0;
+    FILE *out;
+    int fd;
+
+    fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0)
+        return;
+
+    /* A stuck client must not stop the sampling for long */
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    while (len < sizeof(cmd) - 1) {
+        ret = read(fd, cmd + len, sizeof(cmd) - 1 - len);
+        if (ret <= 0)
+            break;
+        len += ret;
+        if (memchr(cmd, '\n', len))
+            break;
+    }
+    cmd[len] = '\0';
+
+    out = fdopen(fd, "w");
+    if (!out) {
+        close(fd);
+        return;
+    }
+    run_command(out, cmd);
+    fclose(out);
+}
+
+static int open_socket(const char *path) {
+    struct sockaddr_un addr;
+    int fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        chmod(path, 0660) < 0 || listen(fd, 4) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void handle_signal(int sig) {
+    stop = 1;
+}
+
+int main(int argc, char *argv[]) {
+    const char *socket_path = DEFAULT_SOCKET;
+    int foreground = 0;
+    struct sigaction sa;
+    struct pollfd pfd;
+    uint64_t next, now;
+    struct sample *rings;
+    int listen_fd;
+    int opt;
+    size_t i;
+
+    interval_ms = DEFAULT_INTERVAL_MS;
+    ring_len = DEFAULT_SAMPLES;
+    max_series = DEFAULT_PROCESSES;
+
+    while ((opt = getopt(argc, argv, "i:n:p:s:fh")) != -1) {
+        switch (opt) {
+        case 'i': interval_ms = atoi(optarg); break;
+        case 'n': ring_len = atoi(optarg); break;
+        case 'p': max_series = atoi(optarg); break;
+        case 's': socket_path = optarg; break;
+        case 'f': foreground = 1; break;
+        case 'h': usage(argv[0]); exit(EXIT_SUCCESS);
+        default: usage(argv[0]); exit(EXIT_FAILURE);
+        }
+    }
+    if (interval_ms < 100 || !ring_len || !max_series || optind < argc) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    cur_interval_ms = interval_ms;
+
+    if (pm_kernel_create(&ker)) {
+        fprintf(stderr, "error creating kernel interface -- "
+                        "does this kernel have pagemap?\n");
+        exit(EXIT_FAILURE);
+    }
+
+    series = calloc(max_series, sizeof(*series));
+    rings = calloc(max_series * ring_len, sizeof(*rings));
+    if (!series || !rings) {
+        fprintf(stderr, "error allocating %zu samples: %s\n",
+                max_series * ring_len, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < max_series; i++)
+        series[i].ring = rings + i * ring_len;
+
+    listen_fd = open_socket(socket_path);
+    if (listen_fd < 0) {
+        fprintf(stderr, "error opening %s: %s\n", socket_path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    if (!foreground && daemon(0, 0) < 0) {
+        fprintf(stderr, "error daemonizing: %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    openlog("procmemd", foreground ? LOG_PERROR : 0, LOG_DAEMON);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &sa, NULL);
+    sa.sa_handler = handle_signal;
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+
+    /* Sampling must not take the CPU from what is measured */
+    setpriority(PRIO_PROCESS, 0, 19);
+
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    start_realtime = time(NULL);
+
+    pfd.fd = listen_fd;
+    pfd.events = POLLIN;
+    next = now_ms();
+    while (!stop) {
+        now = now_ms();
+        if (now >= next) {
+            tick();
+            next = now + cur_interval_ms;
+            continue;
+        }
+
+        if (poll(&pfd, 1, next - now) > 0 && (pfd.revents & POLLIN))
+            serve_client(listen_fd);
+    }
+
+    close(listen_fd);
+    unlink(socket_path);
+    pm_kernel_destroy(ker);
+
+    return 0;
+}
+
+static void usage(const char *cmd) {
+    fprintf(stderr, "Usage: %s [ -i ms ] [ -n samples ] [ -p processes ] [ -s socket ] [ -f ]\n"
+                    "    -i  Sample every this many ms (default %d).\n"
+                    "    -n  Keep this many samples of each process (default %d).\n"
+                    "    -p  Keep samples of this many processes (default %d).\n"
+                    "    -s  Listen on this unix socket (default %s).\n"
+                    "    -f  Stay in the foreground.\n"
+                    "    -h  Display this help screen.\n",
+            cmd, DEFAULT_INTERVAL_MS, DEFAULT_SAMPLES, DEFAULT_PROCESSES,
+            DEFAULT_SOCKET);
+}
@@ -22,7 +22,8 @@ LOCAL_SRC_FILES := \
 	pm_kernel.c \
 	pm_process.c \
 	pm_map.c \
-	pm_memusage.c
+	pm_memusage.c \
+	pm_sampler.c
 
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/include
 
@@ -41,6 +41,8 @@ typedef struct pm_kernel   pm_kernel_t;
 typedef struct pm_process  pm_process_t;
 typedef struct pm_map      pm_map_t;
 
+struct pm_kpage_cache;
+
 /* pm_kernel_t holds the state necessary to interface to the kernel's pagemap
  * system on a global level. */
 struct pm_kernel {
@@ -48,6 +50,10 @@ struct pm_kernel {
     int kpageflags_fd;
 
     int pagesize;
+
+    /* NULL unless enabled by pm_kernel_set_cache() */
+    struct pm_kpage_cache *count_cache;
+    struct pm_kpage_cache *flags_cache;
 };
 
 /* pm_process_t holds the state necessary to interface to a particular process'
@@ -61,6 +67,9 @@ struct pm_process {
     int num_maps;
 
     int pagemap_fd;
+
+    /* Reused by the map usage functions, see PM_PAGEMAP_BATCH */
+    uint64_t *pagemap_buf;
 };
 
 /* pm_map_t holds the state necessary to access information about a particular
@@ -94,6 +103,18 @@ int pm_kernel_count(pm_kernel_t *ker, uint64_t pfn, uint64_t *count_out);
  * The count is returned through *flags_out. */
 int pm_kernel_flags(pm_kernel_t *ker, uint64_t pfn, uint64_t *flags_out);
 
+/* Cache /proc/kpagecount and /proc/kpageflags in blocks of PM_KPAGE_BLOCK
+ * frames (if enable != 0), so that frames shared by many processes are read
+ * once. Counts and flags are then a snapshot taken when first read, until
+ * pm_kernel_flush_cache(). pm_kernel_count() and pm_kernel_flags() are thread
+ * safe either way. */
+int pm_kernel_set_cache(pm_kernel_t *ker, int enable);
+
+/* Forget the cached counts and flags, to sample them again. */
+void pm_kernel_flush_cache(pm_kernel_t *ker);
+
+#define PM_KPAGE_BLOCK 512
+
 #define PM_PAGE_LOCKED     (1 <<  0)
 #define PM_PAGE_ERROR      (1 <<  1)
 #define PM_PAGE_REFERENCED (1 <<  2)
@@ -171,6 +192,9 @@ int pm_process_maps(pm_process_t *proc, pm_map_t ***maps_out, size_t *len);
 /* Destroy a pm_process_t. */
 int pm_process_destroy(pm_process_t *proc);
 
+/* Pages of pagemap read at once by the map usage functions */
+#define PM_PAGEMAP_BATCH 4096
+
 /* Get the name, flags, start/end address, or offset of a map. */
 #define pm_map_name(map)   ((map)->name)
 #define pm_map_flags(map)  ((map)->flags)
@@ -198,4 +222,37 @@ int pm_map_usage_flags(pm_map_t *map, pm_memusage_t *usage_out,
 /* Get the working set of this map alone. */
 int pm_map_workingset(pm_map_t *map, pm_memusage_t *ws_out);
 
+typedef struct pm_sampler pm_sampler_t;
+typedef struct pm_sample  pm_sample_t;
+
+/* The usage of one process, as sampled by pm_sampler_run(). */
+struct pm_sample {
+    pid_t pid;
+    pm_memusage_t usage;
+    /* Hash of /proc/<pid>/maps and /proc/<pid>/statm */
+    uint64_t signature;
+    /* 0, or the error that left usage empty */
+    int error;
+    /* 0 if usage was carried over from the previous run */
+    int fresh;
+};
+
+/* Create a pm_sampler_t, which samples the usage of many processes on
+ * num_threads threads at the lowest priority, with the kpage cache of ker
+ * enabled. */
+int pm_sampler_create(pm_kernel_t *ker, int num_threads,
+                      pm_sampler_t **sampler_out);
+
+/* Sample the usage of the num_pids processes in pids (see
+ * pm_process_usage_flags()). If incremental != 0, a process whose signature
+ * did not change since the previous run keeps its usage, without reading its
+ * pagemap again. The array of samples, in the order of pids, is returned
+ * through *samples_out and belongs to the sampler until its next run. */
+int pm_sampler_run(pm_sampler_t *sampler, const pid_t *pids, size_t num_pids,
+                   uint64_t flags_mask, uint64_t required_flags,
+                   int incremental, pm_sample_t **samples_out, size_t *len);
+
+/* Destroy a pm_sampler_t. */
+int pm_sampler_destroy(pm_sampler_t *sampler);
+
 #endif
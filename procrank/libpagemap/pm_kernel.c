@@ -17,8 +17,10 @@
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -113,42 +115,179 @@ int pm_kernel_pids(pm_kernel_t *ker, pid_t **pids_out, size_t *len) {
     return 0;
 }
 
-int pm_kernel_count(pm_kernel_t *ker, uint64_t pfn, uint64_t *count_out) {
-    off64_t off;
+/* PM_KPAGE_BLOCK entries of /proc/kpagecount or /proc/kpageflags */
+struct pm_kpage_block {
+    size_t valid;
+    uint64_t entries[PM_KPAGE_BLOCK];
+};
+
+struct pm_kpage_cache {
+    pthread_mutex_t lock;
+    int fd;
+
+    struct pm_kpage_block **blocks;
+    size_t num_blocks;
+};
+
+static int kpage_read(int fd, uint64_t pfn, uint64_t *entry_out) {
+    ssize_t ret;
+
+    ret = pread64(fd, entry_out, sizeof(uint64_t), pfn * sizeof(uint64_t));
+    if (ret < (ssize_t)sizeof(uint64_t))
+        return (ret < 0) ? errno : -1;
+
+    return 0;
+}
+
+static struct pm_kpage_cache *kpage_cache_create(int fd) {
+    struct pm_kpage_cache *cache;
+
+    cache = calloc(1, sizeof(*cache));
+    if (!cache)
+        return NULL;
+
+    pthread_mutex_init(&cache->lock, NULL);
+    cache->fd = fd;
+
+    return cache;
+}
+
+static void kpage_cache_flush(struct pm_kpage_cache *cache) {
+    size_t i;
+
+    pthread_mutex_lock(&cache->lock);
+    for (i = 0; i < cache->num_blocks; i++) {
+        free(cache->blocks[i]);
+        cache->blocks[i] = NULL;
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+static void kpage_cache_destroy(struct pm_kpage_cache *cache) {
+    if (!cache)
+        return;
+
+    kpage_cache_flush(cache);
+    free(cache->blocks);
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
+
+static int kpage_cache_get(struct pm_kpage_cache *cache, uint64_t pfn,
+                           uint64_t *entry_out) {
+    uint64_t index = pfn / PM_KPAGE_BLOCK;
+    size_t slot = pfn % PM_KPAGE_BLOCK;
+    struct pm_kpage_block *block, **new_blocks;
+    size_t new_num;
+    ssize_t ret;
+    int error = 0;
+
+    pthread_mutex_lock(&cache->lock);
+
+    if (index >= cache->num_blocks) {
+        new_num = cache->num_blocks ? cache->num_blocks : 64;
+        while (new_num <= index)
+            new_num *= 2;
+        new_blocks = realloc(cache->blocks, new_num * sizeof(*new_blocks));
+        if (!new_blocks) {
+            error = errno;
+            goto out;
+        }
+        memset(new_blocks + cache->num_blocks, 0,
+               (new_num - cache->num_blocks) * sizeof(*new_blocks));
+        cache->blocks = new_blocks;
+        cache->num_blocks = new_num;
+    }
+
+    block = cache->blocks[index];
+    if (!block) {
+        block = malloc(sizeof(*block));
+        if (!block) {
+            error = errno;
+            goto out;
+        }
+        ret = pread64(cache->fd, block->entries, sizeof(block->entries),
+                      index * sizeof(block->entries));
+        if (ret < 0) {
+            error = errno;
+            free(block);
+            goto out;
+        }
+        block->valid = ret / sizeof(uint64_t);
+        cache->blocks[index] = block;
+    }
+
+    if (slot >= block->valid) {
+        /* Beyond the end of memory, as without the cache */
+        error = -1;
+        goto out;
+    }
+    *entry_out = block->entries[slot];
+
+out:
+    pthread_mutex_unlock(&cache->lock);
+
+    return error;
+}
 
+int pm_kernel_count(pm_kernel_t *ker, uint64_t pfn, uint64_t *count_out) {
     if (!ker || !count_out)
         return -1;
 
-    off = lseek64(ker->kpagecount_fd, pfn * sizeof(uint64_t), SEEK_SET);
-    if (off == (off_t)-1)
-        return errno;
-    if (read(ker->kpagecount_fd, count_out, sizeof(uint64_t)) <
-        (ssize_t)sizeof(uint64_t))
-        return errno;
+    if (ker->count_cache)
+        return kpage_cache_get(ker->count_cache, pfn, count_out);
 
-    return 0;
+    return kpage_read(ker->kpagecount_fd, pfn, count_out);
 }
 
 int pm_kernel_flags(pm_kernel_t *ker, uint64_t pfn, uint64_t *flags_out) {
-    off64_t off;
-
     if (!ker || !flags_out)
         return -1;
 
-    off = lseek64(ker->kpageflags_fd, pfn * sizeof(uint64_t), SEEK_SET);
-    if (off == (off_t)-1)
-        return errno;
-    if (read(ker->kpageflags_fd, flags_out, sizeof(uint64_t)) <
-        (ssize_t)sizeof(uint64_t))
-        return errno;
+    if (ker->flags_cache)
+        return kpage_cache_get(ker->flags_cache, pfn, flags_out);
+
+    return kpage_read(ker->kpageflags_fd, pfn, flags_out);
+}
+
+int pm_kernel_set_cache(pm_kernel_t *ker, int enable) {
+    if (!ker)
+        return -1;
+
+    if (!enable) {
+        kpage_cache_destroy(ker->count_cache);
+        kpage_cache_destroy(ker->flags_cache);
+        ker->count_cache = ker->flags_cache = NULL;
+        return 0;
+    }
+
+    if (!ker->count_cache)
+        ker->count_cache = kpage_cache_create(ker->kpagecount_fd);
+    if (!ker->flags_cache)
+        ker->flags_cache = kpage_cache_create(ker->kpageflags_fd);
+    if (!ker->count_cache || !ker->flags_cache) {
+        pm_kernel_set_cache(ker, 0);
+        return ENOMEM;
+    }
 
     return 0;
 }
 
+void pm_kernel_flush_cache(pm_kernel_t *ker) {
+    if (!ker)
+        return;
+
+    if (ker->count_cache)
+        kpage_cache_flush(ker->count_cache);
+    if (ker->flags_cache)
+        kpage_cache_flush(ker->flags_cache);
+}
+
 int pm_kernel_destroy(pm_kernel_t *ker) {
     if (!ker)
         return -1;
 
+    pm_kernel_set_cache(ker, 0);
     close(ker->kpagecount_fd);
     close(ker->kpageflags_fd);
 
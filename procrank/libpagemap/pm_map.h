@@ -21,4 +21,12 @@
 
 int pm_map_destroy(pm_map_t *map);
 
+/* Read numpages entries of pagemap from the page at addr into
+ * proc->pagemap_buf, returned through *pagemap_out. *len is 0 past the end
+ * of the userspace mapping range. numpages must not be more than
+ * PM_PAGEMAP_BATCH. */
+int pm_process_pagemap_batch(pm_process_t *proc, uint64_t addr,
+                             size_t numpages, uint64_t **pagemap_out,
+                             size_t *len);
+
 #endif
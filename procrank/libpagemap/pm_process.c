@@ -150,6 +150,37 @@ int pm_process_pagemap_range(pm_process_t *proc,
     return 0;
 }
 
+int pm_process_pagemap_batch(pm_process_t *proc, uint64_t addr,
+                             size_t numpages, uint64_t **pagemap_out,
+                             size_t *len) {
+    ssize_t ret;
+
+    if (!proc || numpages > PM_PAGEMAP_BATCH || !pagemap_out || !len)
+        return -1;
+
+    if (!proc->pagemap_buf) {
+        proc->pagemap_buf = malloc(PM_PAGEMAP_BATCH * sizeof(uint64_t));
+        if (!proc->pagemap_buf)
+            return errno;
+    }
+
+    ret = pread64(proc->pagemap_fd, proc->pagemap_buf,
+                  numpages * sizeof(uint64_t),
+                  addr / proc->ker->pagesize * sizeof(uint64_t));
+    if (ret == 0) {
+        /* EOF, mapping is not in userspace mapping range (probably vectors) */
+        *len = 0;
+    } else if (ret < (ssize_t)(numpages * sizeof(uint64_t))) {
+        return (ret < 0) ? errno : -1;
+    } else {
+        *len = numpages;
+    }
+
+    *pagemap_out = proc->pagemap_buf;
+
+    return 0;
+}
+
 int pm_process_maps(pm_process_t *proc, pm_map_t ***maps_out, size_t *len) {
     pm_map_t **maps;
 
@@ -224,6 +255,7 @@ int pm_process_destroy(pm_process_t *proc) {
         pm_map_destroy(proc->maps[i]);
     }
     free(proc->maps);
+    free(proc->pagemap_buf);
     close(proc->pagemap_fd);
     free(proc);
 
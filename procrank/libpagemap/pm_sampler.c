@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) 2008 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <pagemap/pagemap.h>
+
+#define MAX_FILENAME 64
+#define MAX_THREADS 16
+
+/* The sampling threads must not steal the CPU from what they measure */
+#define SAMPLER_NICE 19
+
+struct pm_sampler {
+    pm_kernel_t *ker;
+    int num_threads;
+
+    /* Samples of the current run, or of the previous one during a run */
+    pm_sample_t *samples;
+    size_t num_samples;
+
+    /* The previous samples, sorted by pid, during a run */
+    pm_sample_t *prev;
+    size_t num_prev;
+    uint64_t prev_flags_mask;
+    uint64_t prev_required_flags;
+
+    /* State of the current run */
+    const pid_t *pids;
+    uint64_t flags_mask;
+    uint64_t required_flags;
+    int incremental;
+
+    pthread_mutex_t lock;
+    size_t next;
+};
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME  0x100000001b3ULL
+
+static int hash_file(const char *filename, uint64_t *hash) {
+    char buf[4096];
+    ssize_t ret;
+    ssize_t i;
+    int fd;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return errno;
+
+    while ((ret = read(fd, buf, sizeof(buf))) > 0) {
+        for (i = 0; i < ret; i++) {
+            *hash ^= (unsigned char)buf[i];
+            *hash *= FNV_PRIME;
+        }
+    }
+    if (ret < 0)
+        ret = errno;
+    close(fd);
+
+    return ret;
+}
+
+/* A process whose maps and page counts are unchanged is unlikely to use
+ * memory differently; statm changes with rss. */
+static int process_signature(pid_t pid, uint64_t *signature_out) {
+    char filename[MAX_FILENAME];
+    uint64_t hash = FNV_OFFSET;
+    int error;
+
+    snprintf(filename, MAX_FILENAME, "/proc/%d/maps", pid);
+    error = hash_file(filename, &hash);
+    if (error) return error;
+
+    snprintf(filename, MAX_FILENAME, "/proc/%d/statm", pid);
+    error = hash_file(filename, &hash);
+    if (error) return error;
+
+    *signature_out = hash;
+
+    return 0;
+}
+
+static int sample_compare(const void *a, const void *b) {
+    pid_t pa = ((const pm_sample_t *)a)->pid;
+    pid_t pb = ((const pm_sample_t *)b)->pid;
+
+    return (pa > pb) - (pa < pb);
+}
+
+static const pm_sample_t *find_prev(pm_sampler_t *sampler, pid_t pid) {
+    pm_sample_t key;
+
+    if (!sampler->num_prev)
+        return NULL;
+
+    key.pid = pid;
+    return bsearch(&key, sampler->prev, sampler->num_prev,
+                   sizeof(pm_sample_t), sample_compare);
+}
+
+static void sample_process(pm_sampler_t *sampler, pm_sample_t *sample) {
+    const pm_sample_t *prev;
+    pm_process_t *proc;
+
+    sample->fresh = 1;
+    pm_memusage_zero(&sample->usage);
+
+    sample->error = process_signature(sample->pid, &sample->signature);
+    if (sample->error)
+        return;
+
+    if (sampler->incremental &&
+        sampler->flags_mask == sampler->prev_flags_mask &&
+        sampler->required_flags == sampler->prev_required_flags) {
+        prev = find_prev(sampler, sample->pid);
+        if (prev && !prev->error && prev->signature == sample->signature) {
+            sample->usage = prev->usage;
+            sample->fresh = 0;
+            return;
+        }
+    }
+
+    sample->error = pm_process_create(sampler->ker, sample->pid, &proc);
+    if (sample->error)
+        return;
+
+    sample->error = pm_process_usage_flags(proc, &sample->usage,
+                                           sampler->flags_mask,
+                                           sampler->required_flags);
+    pm_process_destroy(proc);
+}
+
+static void *sampler_thread(void *arg) {
+    pm_sampler_t *sampler = arg;
+    size_t i;
+
+    /* Threads have their own nice value on Linux */
+    setpriority(PRIO_PROCESS, syscall(SYS_gettid), SAMPLER_NICE);
+
+    for (;;) {
+        pthread_mutex_lock(&sampler->lock);
+        i = sampler->next++;
+        pthread_mutex_unlock(&sampler->lock);
+
+        if (i >= sampler->num_samples)
+            break;
+
+        sampler->samples[i].pid = sampler->pids[i];
+        sample_process(sampler, &sampler->samples[i]);
+    }
+
+    return NULL;
+}
+
+int pm_sampler_create(pm_kernel_t *ker, int num_threads,
+                      pm_sampler_t **sampler_out) {
+    pm_sampler_t *sampler;
+    int error;
+
+    if (!ker || num_threads < 1 || !sampler_out)
+        return -1;
+
+    if (num_threads > MAX_THREADS)
+        num_threads = MAX_THREADS;
+
+    sampler = calloc(1, sizeof(*sampler));
+    if (!sampler)
+        return errno;
+
+    error = pm_kernel_set_cache(ker, 1);
+    if (error) {
+        free(sampler);
+        return error;
+    }
+
+    sampler->ker = ker;
+    sampler->num_threads = num_threads;
+    pthread_mutex_init(&sampler->lock, NULL);
+
+    *sampler_out = sampler;
+
+    return 0;
+}
+
+int pm_sampler_run(pm_sampler_t *sampler, const pid_t *pids, size_t num_pids,
+                   uint64_t flags_mask, uint64_t required_flags,
+                   int incremental, pm_sample_t **samples_out, size_t *len) {
+    pthread_t threads[MAX_THREADS];
+    pm_sample_t *samples;
+    int num_threads;
+    int error = 0;
+    int i;
+
+    if (!sampler || (num_pids && !pids) || !samples_out || !len)
+        return -1;
+
+    samples = calloc(num_pids ? num_pids : 1, sizeof(*samples));
+    if (!samples)
+        return errno;
+
+    /* The previous samples are looked up by pid */
+    free(sampler->prev);
+    sampler->prev = sampler->samples;
+    sampler->num_prev = sampler->num_samples;
+    if (sampler->num_prev)
+        qsort(sampler->prev, sampler->num_prev, sizeof(pm_sample_t),
+              sample_compare);
+
+    sampler->samples = samples;
+    sampler->num_samples = num_pids;
+    sampler->pids = pids;
+    sampler->incremental = incremental;
+    sampler->flags_mask = flags_mask;
+    sampler->required_flags = required_flags;
+    sampler->next = 0;
+
+    /* Page counts must be those of this run */
+    pm_kernel_flush_cache(sampler->ker);
+
+    num_threads = sampler->num_threads;
+    if ((size_t)num_threads > num_pids)
+        num_threads = num_pids;
+
+    for (i = 0; i < num_threads; i++) {
+        error = pthread_create(&threads[i], NULL, sampler_thread, sampler);
+        if (error) {
+            num_threads = i;
+            break;
+        }
+    }
+    /* Without any thread, sample on this one rather than fail */
+    if (!num_threads)
+        sampler_thread(sampler);
+    for (i = 0; i < num_threads; i++)
+        pthread_join(threads[i], NULL);
+
+    free(sampler->prev);
+    sampler->prev = NULL;
+    sampler->num_prev = 0;
+    sampler->prev_flags_mask = flags_mask;
+    sampler->prev_required_flags = required_flags;
+    sampler->pids = NULL;
+
+    *samples_out = sampler->samples;
+    *len = sampler->num_samples;
+
+    return 0;
+}
+
+int pm_sampler_destroy(pm_sampler_t *sampler) {
+    if (!sampler)
+        return -1;
+
+    pm_kernel_set_cache(sampler->ker, 0);
+    pthread_mutex_destroy(&sampler->lock);
+    free(sampler->prev);
+    free(sampler->samples);
+    free(sampler);
+
+    return 0;
+}
@@ -119,122 +119,13 @@ void print_mem_info() {
             mem[0], mem[1], mem[2], mem[3], mem[4], mem[5]);
 }
 
-int main(int argc, char *argv[]) {
-    pm_kernel_t *ker;
-    pm_process_t *proc;
-    pid_t *pids;
-    struct proc_info **procs;
-    size_t num_procs;
+static void print_procs(struct proc_info **procs, size_t num_procs, int ws,
+                        bool has_swap) {
     uint64_t total_pss;
     uint64_t total_uss;
     uint64_t total_swap;
     char cmdline[256]; // this must be within the range of int
-    int error;
-    bool has_swap = false;
-    uint64_t required_flags = 0;
-    uint64_t flags_mask = 0;
-
-    #define WS_OFF   0
-    #define WS_ONLY  1
-    #define WS_RESET 2
-    int ws;
-
-    int arg;
-    size_t i, j;
-
-    signal(SIGPIPE, SIG_IGN);
-    compfn = &sort_by_pss;
-    order = -1;
-    ws = WS_OFF;
-
-    for (arg = 1; arg < argc; arg++) {
-        if (!strcmp(argv[arg], "-v")) { compfn = &sort_by_vss; continue; }
-        if (!strcmp(argv[arg], "-r")) { compfn = &sort_by_rss; continue; }
-        if (!strcmp(argv[arg], "-p")) { compfn = &sort_by_pss; continue; }
-        if (!strcmp(argv[arg], "-u")) { compfn = &sort_by_uss; continue; }
-        if (!strcmp(argv[arg], "-s")) { compfn = &sort_by_swap; continue; }
-        if (!strcmp(argv[arg], "-c")) { required_flags = 0; flags_mask = PM_PAGE_SWAPBACKED; continue; }
-        if (!strcmp(argv[arg], "-C")) { required_flags = flags_mask = PM_PAGE_SWAPBACKED; continue; }
-        if (!strcmp(argv[arg], "-k")) { required_flags = flags_mask = PM_PAGE_KSM; continue; }
-        if (!strcmp(argv[arg], "-w")) { ws = WS_ONLY; continue; }
-        if (!strcmp(argv[arg], "-W")) { ws = WS_RESET; continue; }
-        if (!strcmp(argv[arg], "-R")) { order *= -1; continue; }
-        if (!strcmp(argv[arg], "-h")) { usage(argv[0]); exit(0); }
-        fprintf(stderr, "Invalid argument \"%s\".\n", argv[arg]);
-        usage(argv[0]);
-        exit(EXIT_FAILURE);
-    }
-
-    error = pm_kernel_create(&ker);
-    if (error) {
-        fprintf(stderr, "Error creating kernel interface -- "
-                        "does this kernel have pagemap?\n");
-        exit(EXIT_FAILURE);
-    }
-
-    error = pm_kernel_pids(ker, &pids, &num_procs);
-    if (error) {
-        fprintf(stderr, "Error listing processes.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    procs = calloc(num_procs, sizeof(struct proc_info*));
-    if (procs == NULL) {
-        fprintf(stderr, "calloc: %s", strerror(errno));
-        exit(EXIT_FAILURE);
-    }
-
-    for (i = 0; i < num_procs; i++) {
-        procs[i] = malloc(sizeof(struct proc_info));
-        if (procs[i] == NULL) {
-            fprintf(stderr, "malloc: %s\n", strerror(errno));
-            exit(EXIT_FAILURE);
-        }
-        procs[i]->pid = pids[i];
-        pm_memusage_zero(&procs[i]->usage);
-        error = pm_process_create(ker, pids[i], &proc);
-        if (error) {
-            fprintf(stderr, "warning: could not create process interface for %d\n", pids[i]);
-            continue;
-        }
-
-        switch (ws) {
-        case WS_OFF:
-            error = pm_process_usage_flags(proc, &procs[i]->usage, flags_mask,
-                                           required_flags);
-            break;
-        case WS_ONLY:
-            error = pm_process_workingset(proc, &procs[i]->usage, 0);
-            break;
-        case WS_RESET:
-            error = pm_process_workingset(proc, NULL, 1);
-            break;
-        }
-
-        if (error) {
-            fprintf(stderr, "warning: could not read usage for %d\n", pids[i]);
-        }
-
-        if (ws != WS_RESET && procs[i]->usage.swap) {
-            has_swap = true;
-        }
-
-        pm_process_destroy(proc);
-    }
-
-    free(pids);
-
-    if (ws == WS_RESET) exit(0);
-
-    j = 0;
-    for (i = 0; i < num_procs; i++) {
-        if (procs[i]->usage.vss) {
-            procs[j++] = procs[i];
-        } else {
-            free(procs[i]);
-        }
-    }
-    num_procs = j;
+    size_t i;
 
     qsort(procs, num_procs, sizeof(procs[0]), compfn);
 
@@ -297,8 +188,6 @@ int main(int argc, char *argv[]) {
         free(procs[i]);
     }
 
-    free(procs);
-
     /* Print the separator line */
     printf("%5s  ", "");
 
@@ -332,12 +221,191 @@ int main(int argc, char *argv[]) {
 
     printf("\n");
     print_mem_info();
+}
+
+int main(int argc, char *argv[]) {
+    pm_kernel_t *ker;
+    pm_process_t *proc;
+    pm_sampler_t *sampler;
+    pm_sample_t *samples;
+    size_t num_samples;
+    pid_t *pids;
+    struct proc_info **procs;
+    size_t num_procs;
+    int error;
+    bool has_swap;
+    uint64_t required_flags = 0;
+    uint64_t flags_mask = 0;
+    int num_threads = 0;
+    int interval = 0;
+
+    #define WS_OFF   0
+    #define WS_ONLY  1
+    #define WS_RESET 2
+    int ws;
+
+    int arg;
+    size_t i, j;
+
+    signal(SIGPIPE, SIG_IGN);
+    compfn = &sort_by_pss;
+    order = -1;
+    ws = WS_OFF;
+
+    for (arg = 1; arg < argc; arg++) {
+        if (!strcmp(argv[arg], "-v")) { compfn = &sort_by_vss; continue; }
+        if (!strcmp(argv[arg], "-r")) { compfn = &sort_by_rss; continue; }
+        if (!strcmp(argv[arg], "-p")) { compfn = &sort_by_pss; continue; }
+        if (!strcmp(argv[arg], "-u")) { compfn = &sort_by_uss; continue; }
+        if (!strcmp(argv[arg], "-s")) { compfn = &sort_by_swap; continue; }
+        if (!strcmp(argv[arg], "-c")) { required_flags = 0; flags_mask = PM_PAGE_SWAPBACKED; continue; }
+        if (!strcmp(argv[arg], "-C")) { required_flags = flags_mask = PM_PAGE_SWAPBACKED; continue; }
+        if (!strcmp(argv[arg], "-k")) { required_flags = flags_mask = PM_PAGE_KSM; continue; }
+        if (!strcmp(argv[arg], "-w")) { ws = WS_ONLY; continue; }
+        if (!strcmp(argv[arg], "-W")) { ws = WS_RESET; continue; }
+        if (!strcmp(argv[arg], "-R")) { order *= -1; continue; }
+        if (!strcmp(argv[arg], "-j") && arg + 1 < argc) {
+            num_threads = atoi(argv[++arg]);
+            if (num_threads > 0) continue;
+        }
+        if (!strcmp(argv[arg], "-i") && arg + 1 < argc) {
+            interval = atoi(argv[++arg]);
+            if (interval > 0) continue;
+        }
+        if (!strcmp(argv[arg], "-h")) { usage(argv[0]); exit(0); }
+        fprintf(stderr, "Invalid argument \"%s\".\n", argv[arg]);
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    error = pm_kernel_create(&ker);
+    if (error) {
+        fprintf(stderr, "Error creating kernel interface -- "
+                        "does this kernel have pagemap?\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* The working set is sampled the old way, one process after another */
+    sampler = NULL;
+    if ((num_threads || interval) && ws == WS_OFF) {
+        error = pm_sampler_create(ker, num_threads ? num_threads : 1, &sampler);
+        if (error) {
+            fprintf(stderr, "Error creating sampler.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (;;) {
+        error = pm_kernel_pids(ker, &pids, &num_procs);
+        if (error) {
+            fprintf(stderr, "Error listing processes.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        procs = calloc(num_procs, sizeof(struct proc_info*));
+        if (procs == NULL) {
+            fprintf(stderr, "calloc: %s", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+
+        if (sampler) {
+            /* Processes unchanged since the last interval are not sampled
+             * again. */
+            error = pm_sampler_run(sampler, pids, num_procs, flags_mask,
+                                   required_flags, interval != 0,
+                                   &samples, &num_samples);
+            if (error) {
+                fprintf(stderr, "Error sampling processes.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        has_swap = false;
+
+        for (i = 0; i < num_procs; i++) {
+            procs[i] = malloc(sizeof(struct proc_info));
+            if (procs[i] == NULL) {
+                fprintf(stderr, "malloc: %s\n", strerror(errno));
+                exit(EXIT_FAILURE);
+            }
+            procs[i]->pid = pids[i];
+            pm_memusage_zero(&procs[i]->usage);
+
+            if (sampler) {
+                if (samples[i].error) {
+                    fprintf(stderr, "warning: could not read usage for %d\n", pids[i]);
+                    continue;
+                }
+                procs[i]->usage = samples[i].usage;
+                if (procs[i]->usage.swap) {
+                    has_swap = true;
+                }
+                continue;
+            }
+
+            error = pm_process_create(ker, pids[i], &proc);
+            if (error) {
+                fprintf(stderr, "warning: could not create process interface for %d\n", pids[i]);
+                continue;
+            }
+
+            switch (ws) {
+            case WS_OFF:
+                error = pm_process_usage_flags(proc, &procs[i]->usage, flags_mask,
+                                               required_flags);
+                break;
+            case WS_ONLY:
+                error = pm_process_workingset(proc, &procs[i]->usage, 0);
+                break;
+            case WS_RESET:
+                error = pm_process_workingset(proc, NULL, 1);
+                break;
+            }
+
+            if (error) {
+                fprintf(stderr, "warning: could not read usage for %d\n", pids[i]);
+            }
+
+            if (ws != WS_RESET && procs[i]->usage.swap) {
+                has_swap = true;
+            }
+
+            pm_process_destroy(proc);
+        }
+
+        free(pids);
+
+        if (ws == WS_RESET) exit(0);
+
+        j = 0;
+        for (i = 0; i < num_procs; i++) {
+            if (procs[i]->usage.vss) {
+                procs[j++] = procs[i];
+            } else {
+                free(procs[i]);
+            }
+        }
+        num_procs = j;
+
+        print_procs(procs, num_procs, ws, has_swap);
+
+        free(procs);
+
+        if (!interval)
+            break;
+
+        printf("\n");
+        fflush(stdout);
+        sleep(interval);
+    }
+
+    pm_sampler_destroy(sampler);
 
     return 0;
 }
 
 static void usage(char *myname) {
-    fprintf(stderr, "Usage: %s [ -W ] [ -v | -r | -p | -u | -s | -h ]\n"
+    fprintf(stderr, "Usage: %s [ -W ] [ -v | -r | -p | -u | -s | -h ] [ -j <threads> ] [ -i <seconds> ]\n"
                     "    -v  Sort by VSS.\n"
                     "    -r  Sort by RSS.\n"
                     "    -p  Sort by PSS.\n"
@@ -350,6 +418,9 @@ static void usage(char *myname) {
                     "    -k  Only show pages collapsed by KSM\n"
                     "    -w  Display statistics for working set only.\n"
                     "    -W  Reset working set of all processes.\n"
+                    "    -j  Sample processes on this many threads.\n"
+                    "    -i  Sample again every this many seconds, only\n"
+                    "        reading the processes that changed.\n"
                     "    -h  Display this help screen.\n",
     myname);
 }
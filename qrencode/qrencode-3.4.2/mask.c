@@ -26,6 +26,11 @@
 #include <string.h>
 #include <limits.h>
 #include <errno.h>
+#include <stdint.h>
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 #include "qrencode.h"
 #include "qrspec.h"
@@ -218,105 +223,332 @@ __STATIC int Mask_calcN1N3(int length, int *runLength)
 	return demerit;
 }
 
-__STATIC int Mask_calcN2(int width, unsigned char *frame)
+/**
+ * A symbol packed one bit per module (the lowest bit of each byte of the
+ * frame), row by row and column by column, so that the demerits are
+ * computed a word at a time.
+ */
+#define MASK_WORDS ((QRSPEC_WIDTH_MAX + 31) / 32)
+
+typedef struct {
+	uint32_t rows[QRSPEC_WIDTH_MAX][MASK_WORDS];
+	uint32_t cols[QRSPEC_WIDTH_MAX][MASK_WORDS];
+} MaskBits;
+
+#ifdef __GNUC__
+#define Mask_popcount(__x__) __builtin_popcount(__x__)
+#define Mask_ctz(__x__) __builtin_ctz(__x__)
+#else
+static int Mask_popcount(uint32_t x)
+{
+	x = x - ((x >> 1) & 0x55555555);
+	x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+	x = (x + (x >> 4)) & 0x0f0f0f0f;
+	return (int)((x * 0x01010101) >> 24);
+}
+
+static int Mask_ctz(uint32_t x)
+{
+	return Mask_popcount((x & -x) - 1);
+}
+#endif
+
+/* Bits of the last word of a line of width modules */
+#define MASK_LASTBITS(__width__) \
+	(((__width__) & 31) ? ((1U << ((__width__) & 31)) - 1) : ~0U)
+
+static void Mask_pack(int width, unsigned char *frame, MaskBits *bits)
 {
 	int x, y;
-	unsigned char *p;
-	unsigned char b22, w22;
+	int words = (width + 31) / 32;
+	uint32_t word, bit;
+
+	for(x=0; x<width; x++) {
+		memset(bits->cols[x], 0, words * sizeof(uint32_t));
+	}
+
+	/* without branches, as the modules are as good as random */
+	for(y=0; y<width; y++) {
+		word = 0;
+		for(x=0; x<width; x++) {
+			bit = *frame & 1;
+			word |= bit << (x & 31);
+			bits->cols[x][y >> 5] |= bit << (y & 31);
+			if((x & 31) == 31) {
+				bits->rows[y][x >> 5] = word;
+				word = 0;
+			}
+			frame++;
+		}
+		if(width & 31) {
+			bits->rows[y][width >> 5] = word;
+		}
+	}
+}
+
+static int Mask_calcN2Bits(int width, MaskBits *bits)
+{
+	int y, i;
+	int words = (width + 31) / 32;
+	uint32_t a, b, ca, cb, same;
 	int demerit = 0;
 
-	p = frame + width + 1;
 	for(y=1; y<width; y++) {
-		for(x=1; x<width; x++) {
-			b22 = p[0] & p[-1] & p[-width] & p [-width-1];
-			w22 = p[0] | p[-1] | p[-width] | p [-width-1];
-			if((b22 | (w22 ^ 1))&1) {
-				demerit += N2;
-			}
-			p++;
+		ca = cb = 0;
+		for(i=0; i<words; i++) {
+			a = bits->rows[y][i];
+			b = bits->rows[y-1][i];
+			/* the module, the one on its left, and the two above them */
+			same = ~(a ^ b) & ~(a ^ ((a << 1) | ca)) & ~(b ^ ((b << 1) | cb));
+			ca = a >> 31;
+			cb = b >> 31;
+			if(i == 0) same &= ~1U;
+			if(i == words - 1) same &= MASK_LASTBITS(width);
+			demerit += Mask_popcount(same) * N2;
 		}
-		p++;
 	}
 
 	return demerit;
 }
 
-__STATIC int Mask_calcRunLength(int width, unsigned char *frame, int dir, int *runLength)
+static int Mask_calcRunLengthBits(int width, uint32_t *line, int *runLength)
 {
 	int head;
 	int i;
-	unsigned char *p;
-	int pitch;
+	int pos, last;
+	int words = (width + 31) / 32;
+	uint32_t edges, carry;
 
-	pitch = (dir==0)?1:width;
-	if(frame[0] & 1) {
+	if(line[0] & 1) {
 		runLength[0] = -1;
 		head = 1;
 	} else {
 		head = 0;
 	}
-	runLength[head] = 1;
-	p = frame + pitch;
 
-	for(i=1; i<width; i++) {
-		if((p[0] ^ p[-pitch]) & 1) {
+	/* a run ends where a module differs from the one before it */
+	last = 0;
+	carry = line[0] & 1;
+	for(i=0; i<words; i++) {
+		edges = line[i] ^ ((line[i] << 1) | carry);
+		carry = line[i] >> 31;
+		if(i == words - 1) edges &= MASK_LASTBITS(width);
+		while(edges) {
+			pos = i * 32 + Mask_ctz(edges);
+			runLength[head] = pos - last;
 			head++;
-			runLength[head] = 1;
-		} else {
-			runLength[head]++;
+			last = pos;
+			edges &= edges - 1;
 		}
-		p += pitch;
 	}
+	runLength[head] = width - last;
 
 	return head + 1;
 }
 
+#ifdef WITH_TESTS
+int Mask_calcN2(int width, unsigned char *frame)
+{
+	MaskBits bits;
+
+	Mask_pack(width, frame, &bits);
+
+	return Mask_calcN2Bits(width, &bits);
+}
+
+int Mask_calcRunLength(int width, unsigned char *frame, int dir, int *runLength)
+{
+	uint32_t line[MASK_WORDS];
+	int pitch;
+	int i;
+
+	pitch = (dir==0)?1:width;
+	memset(line, 0, sizeof(line));
+	for(i=0; i<width; i++) {
+		if(frame[i * pitch] & 1) {
+			line[i >> 5] |= 1U << (i & 31);
+		}
+	}
+
+	return Mask_calcRunLengthBits(width, line, runLength);
+}
+#endif
+
 __STATIC int Mask_evaluateSymbol(int width, unsigned char *frame)
 {
 	int x, y;
 	int demerit = 0;
 	int runLength[QRSPEC_WIDTH_MAX + 1];
 	int length;
+	MaskBits bits;
+
+	Mask_pack(width, frame, &bits);
 
-	demerit += Mask_calcN2(width, frame);
+	demerit += Mask_calcN2Bits(width, &bits);
 
 	for(y=0; y<width; y++) {
-		length = Mask_calcRunLength(width, frame + y * width, 0, runLength);
+		length = Mask_calcRunLengthBits(width, bits.rows[y], runLength);
 		demerit += Mask_calcN1N3(length, runLength);
 	}
 
 	for(x=0; x<width; x++) {
-		length = Mask_calcRunLength(width, frame + x, 1, runLength);
+		length = Mask_calcRunLengthBits(width, bits.cols[x], runLength);
 		demerit += Mask_calcN1N3(length, runLength);
 	}
 
 	return demerit;
 }
 
+/**
+ * Apply a mask to the frame and evaluate the result.
+ * @param masked width * width buffer that receives the masked symbol
+ * @return demerit
+ */
+static int Mask_evaluateMask(int width, unsigned char *frame, int mask, QRecLevel level, unsigned char *masked)
+{
+	int blacks;
+	int bratio;
+	int demerit;
+	int w2 = width * width;
+
+	blacks = maskMakers[mask](width, frame, masked);
+	blacks += Mask_writeFormatInformation(width, masked, mask, level);
+	bratio = (200 * blacks + w2) / w2 / 2; /* (int)(100*blacks/w2+0.5) */
+	demerit = (abs(bratio - 50) / 5) * N4;
+	demerit += Mask_evaluateSymbol(width, masked);
+
+	return demerit;
+}
+
+#ifdef HAVE_LIBPTHREAD
+/**
+ * Smaller symbols are evaluated faster than threads are started.
+ */
+#define MASK_PARALLEL_WIDTH_MIN (77) /* version 15 */
+
+typedef struct {
+	int width;
+	unsigned char *frame;
+	QRecLevel level;
+	int step;
+	/* -1 if the mask could not be evaluated */
+	int demerit[maskNum];
+} MaskJob;
+
+typedef struct {
+	MaskJob *job;
+	int first;
+} MaskWorker;
+
+static void *Mask_evaluateMasks(void *arg)
+{
+	MaskWorker *worker = (MaskWorker *)arg;
+	MaskJob *job = worker->job;
+	unsigned char *masked;
+	int i;
+
+	masked = (unsigned char *)malloc(job->width * job->width);
+	for(i=worker->first; i<maskNum; i+=job->step) {
+		if(masked == NULL) {
+			job->demerit[i] = -1;
+		} else {
+			job->demerit[i] = Mask_evaluateMask(job->width, job->frame, i, job->level, masked);
+		}
+	}
+	free(masked);
+
+	return NULL;
+}
+
+static int Mask_numThreads(void)
+{
+	static int threads = 0;
+	long cpus;
+
+	if(threads == 0) {
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		if(cpus < 1) cpus = 1;
+		if(cpus > maskNum) cpus = maskNum;
+		threads = (int)cpus;
+	}
+
+	return threads;
+}
+
+/**
+ * Evaluate the masks on up to threads threads, this one included. The same
+ * mask as Mask_mask() would pick is returned: the first one of the lowest
+ * demerit.
+ */
+static unsigned char *Mask_maskParallel(int width, unsigned char *frame, QRecLevel level, int threads)
+{
+	MaskJob job;
+	MaskWorker workers[maskNum];
+	pthread_t tids[maskNum];
+	unsigned char *masked;
+	int started;
+	int i, best;
+
+	job.width = width;
+	job.frame = frame;
+	job.level = level;
+	job.step = threads;
+	for(i=0; i<threads; i++) {
+		workers[i].job = &job;
+		workers[i].first = i;
+	}
+
+	for(started=1; started<threads; started++) {
+		if(pthread_create(&tids[started], NULL, Mask_evaluateMasks, &workers[started]) != 0) break;
+	}
+	/* This thread takes the share of the threads that did not start. */
+	Mask_evaluateMasks(&workers[0]);
+	for(i=started; i<threads; i++) {
+		Mask_evaluateMasks(&workers[i]);
+	}
+	for(i=1; i<started; i++) {
+		pthread_join(tids[i], NULL);
+	}
+
+	best = 0;
+	for(i=0; i<maskNum; i++) {
+		if(job.demerit[i] < 0) {
+			errno = ENOMEM;
+			return NULL;
+		}
+		if(job.demerit[i] < job.demerit[best]) best = i;
+	}
+
+	masked = (unsigned char *)malloc(width * width);
+	if(masked == NULL) return NULL;
+
+	maskMakers[best](width, frame, masked);
+	Mask_writeFormatInformation(width, masked, best, level);
+
+	return masked;
+}
+#endif
+
 unsigned char *Mask_mask(int width, unsigned char *frame, QRecLevel level)
 {
 	int i;
 	unsigned char *mask, *bestMask;
 	int minDemerit = INT_MAX;
-	int blacks;
-	int bratio;
 	int demerit;
 	int w2 = width * width;
 
+#ifdef HAVE_LIBPTHREAD
+	if(width >= MASK_PARALLEL_WIDTH_MIN && Mask_numThreads() > 1) {
+		return Mask_maskParallel(width, frame, level, Mask_numThreads());
+	}
+#endif
+
 	mask = (unsigned char *)malloc(w2);
 	if(mask == NULL) return NULL;
 	bestMask = NULL;
 
 	for(i=0; i<maskNum; i++) {
-//		n1 = n2 = n3 = n4 = 0;
-		demerit = 0;
-		blacks = maskMakers[i](width, frame, mask);
-		blacks += Mask_writeFormatInformation(width, mask, i, level);
-		bratio = (200 * blacks + w2) / w2 / 2; /* (int)(100*blacks/w2+0.5) */
-		demerit = (abs(bratio - 50) / 5) * N4;
-//		n4 = demerit;
-		demerit += Mask_evaluateSymbol(width, mask);
-//		printf("(%d,%d,%d,%d)=%d\n", n1, n2, n3 ,n4, demerit);
+		demerit = Mask_evaluateMask(width, frame, i, level, mask);
 		if(demerit < minDemerit) {
 			minDemerit = demerit;
 			free(bestMask);
@@ -733,6 +733,283 @@ QRcode *QRcode_encodeString8bitMQR(const char *string, int version, QRecLevel le
 }
 
 
+/******************************************************************************
+ * Cached QR-code encoding
+ *****************************************************************************/
+
+struct _QRcode_Cache {
+	int version;
+	QRecLevel level;
+	int width;
+	int spec[5];
+	int dataLength;
+	int eccLength;
+	/* data codes then ecc codes, block by block, of the last payload */
+	unsigned char *codes;
+	RSblock *rsblock;
+	int blocks;
+	/* index in codes of each interleaved code */
+	int *order;
+	/* interleaved codes in the frame, and their first module */
+	unsigned char *placed;
+	int *modules;
+	/* function patterns, and the data area of the last payload */
+	unsigned char *frame;
+	/* masked symbol of the last payload, NULL if none */
+	unsigned char *masked;
+};
+
+QRcode_Cache *QRcode_Cache_new(int version, QRecLevel level)
+{
+	QRcode_Cache *cache;
+	FrameFiller *filler;
+	unsigned char *p;
+	int i, j, row, col, total;
+	int dl1, el1, dl2, el2, b1;
+
+	if(version < 1 || version > QRSPEC_VERSION_MAX || level > QR_ECLEVEL_H) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	cache = (QRcode_Cache *)calloc(1, sizeof(QRcode_Cache));
+	if(cache == NULL) return NULL;
+
+	cache->version = version;
+	cache->level = level;
+	cache->width = QRspec_getWidth(version);
+	QRspec_getEccSpec(version, level, cache->spec);
+	cache->dataLength = QRspec_rsDataLength(cache->spec);
+	cache->eccLength = QRspec_rsEccLength(cache->spec);
+	cache->blocks = QRspec_rsBlockNum(cache->spec);
+	total = cache->dataLength + cache->eccLength;
+
+	cache->codes = (unsigned char *)malloc(total);
+	cache->rsblock = (RSblock *)calloc(cache->blocks, sizeof(RSblock));
+	cache->order = (int *)malloc(total * sizeof(int));
+	cache->placed = (unsigned char *)malloc(total);
+	cache->modules = (int *)malloc(total * 8 * sizeof(int));
+	cache->frame = QRspec_newFrame(version);
+	if(cache->codes == NULL || cache->rsblock == NULL || cache->order == NULL ||
+	   cache->placed == NULL || cache->modules == NULL || cache->frame == NULL) {
+		QRcode_Cache_free(cache);
+		return NULL;
+	}
+
+	b1 = QRspec_rsBlockNum1(cache->spec);
+	dl1 = QRspec_rsDataCodes1(cache->spec);
+	el1 = QRspec_rsEccCodes1(cache->spec);
+	dl2 = QRspec_rsDataCodes2(cache->spec);
+	el2 = QRspec_rsEccCodes2(cache->spec);
+	for(i=0; i<cache->blocks; i++) {
+		if(i < b1) {
+			cache->rsblock[i].dataLength = dl1;
+			cache->rsblock[i].data = cache->codes + i * dl1;
+			cache->rsblock[i].eccLength = el1;
+			cache->rsblock[i].ecc = cache->codes + cache->dataLength + i * el1;
+		} else {
+			cache->rsblock[i].dataLength = dl2;
+			cache->rsblock[i].data = cache->codes + b1 * dl1 + (i - b1) * dl2;
+			cache->rsblock[i].eccLength = el2;
+			cache->rsblock[i].ecc = cache->codes + cache->dataLength + b1 * el1 + (i - b1) * el2;
+		}
+	}
+
+	/* Same interleaving as QRraw_getCode(). */
+	for(i=0; i<total; i++) {
+		if(i < cache->dataLength) {
+			row = i % cache->blocks;
+			col = i / cache->blocks;
+			if(col >= dl1) {
+				row += b1;
+			}
+			cache->order[i] = cache->rsblock[row].data + col - cache->codes;
+		} else {
+			row = (i - cache->dataLength) % cache->blocks;
+			col = (i - cache->dataLength) / cache->blocks;
+			cache->order[i] = cache->rsblock[row].ecc + col - cache->codes;
+		}
+	}
+
+	/* The data modules do not depend on the data: find them once. */
+	filler = FrameFiller_new(cache->width, cache->frame, 0);
+	if(filler == NULL) {
+		QRcode_Cache_free(cache);
+		return NULL;
+	}
+	for(i=0; i<total * 8; i++) {
+		p = FrameFiller_next(filler);
+		if(p == NULL) break;
+		*p = 0x02;
+		cache->modules[i] = p - cache->frame;
+	}
+	if(i != total * 8) {
+		free(filler);
+		QRcode_Cache_free(cache);
+		errno = EINVAL;
+		return NULL;
+	}
+	for(j = QRspec_getRemainder(version); j>0; j--) {
+		p = FrameFiller_next(filler);
+		if(p == NULL) break;
+		*p = 0x02;
+	}
+	free(filler);
+
+	return cache;
+}
+
+void QRcode_Cache_free(QRcode_Cache *cache)
+{
+	if(cache != NULL) {
+		free(cache->codes);
+		free(cache->rsblock);
+		free(cache->order);
+		free(cache->placed);
+		free(cache->modules);
+		free(cache->frame);
+		free(cache->masked);
+		free(cache);
+	}
+}
+
+static QRcode *QRcode_Cache_result(QRcode_Cache *cache)
+{
+	unsigned char *data;
+	QRcode *qrcode;
+	int w2 = cache->width * cache->width;
+
+	data = (unsigned char *)malloc(w2);
+	if(data == NULL) return NULL;
+	memcpy(data, cache->masked, w2);
+
+	qrcode = QRcode_new(cache->version, cache->width, data);
+	if(qrcode == NULL) free(data);
+
+	return qrcode;
+}
+
+static QRcode *QRcode_Cache_encodeInput(QRcode_Cache *cache, QRinput *input)
+{
+	unsigned char *datacode, *masked;
+	unsigned char *frame, *q, code, bit;
+	int *modules;
+	RSblock *block;
+	RS *rs;
+	int offset;
+	int i, j;
+
+	datacode = QRinput_getByteStream(input);
+	if(datacode == NULL) return NULL;
+	if(input->version != cache->version) {
+		free(datacode);
+		errno = ERANGE;
+		return NULL;
+	}
+
+	if(cache->masked != NULL && memcmp(datacode, cache->codes, cache->dataLength) == 0) {
+		free(datacode);
+		return QRcode_Cache_result(cache);
+	}
+
+	/* Only the blocks whose data changed get new ecc codes. */
+	for(i=0; i<cache->blocks; i++) {
+		block = &cache->rsblock[i];
+		offset = block->data - cache->codes;
+		if(cache->masked != NULL && memcmp(block->data, datacode + offset, block->dataLength) == 0) continue;
+
+		memcpy(block->data, datacode + offset, block->dataLength);
+		rs = init_rs(8, 0x11d, 0, 1, block->eccLength, 255 - block->dataLength - block->eccLength);
+		if(rs == NULL) {
+			free(datacode);
+			free(cache->masked);
+			cache->masked = NULL;
+			return NULL;
+		}
+		encode_rs_char(rs, block->data, block->ecc);
+	}
+	free(datacode);
+
+	/* Only the changed codes are written again. */
+	frame = cache->frame;
+	for(i=0; i<cache->dataLength + cache->eccLength; i++) {
+		code = cache->codes[cache->order[i]];
+		if(cache->masked != NULL && cache->placed[i] == code) continue;
+
+		cache->placed[i] = code;
+		modules = cache->modules + i * 8;
+		bit = 0x80;
+		for(j=0; j<8; j++) {
+			q = frame + modules[j];
+			*q = 0x02 | ((bit & code) != 0);
+			bit = bit >> 1;
+		}
+	}
+
+	free(cache->masked);
+	masked = Mask_mask(cache->width, frame, cache->level);
+	/* On failure, everything is written again at the next call. */
+	cache->masked = masked;
+	if(masked == NULL) return NULL;
+
+	return QRcode_Cache_result(cache);
+}
+
+QRcode *QRcode_Cache_encodeString(QRcode_Cache *cache, const char *string, QRencodeMode hint, int casesensitive)
+{
+	QRinput *input;
+	QRcode *code;
+	int ret;
+
+	if(cache == NULL || string == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+	if(hint != QR_MODE_8 && hint != QR_MODE_KANJI) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	input = QRinput_new2(cache->version, cache->level);
+	if(input == NULL) return NULL;
+
+	ret = Split_splitStringToQRinput(string, input, hint, casesensitive);
+	if(ret < 0) {
+		QRinput_free(input);
+		return NULL;
+	}
+	code = QRcode_Cache_encodeInput(cache, input);
+	QRinput_free(input);
+
+	return code;
+}
+
+QRcode *QRcode_Cache_encodeData(QRcode_Cache *cache, int size, const unsigned char *data)
+{
+	QRinput *input;
+	QRcode *code;
+	int ret;
+
+	if(cache == NULL || data == NULL || size == 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	input = QRinput_new2(cache->version, cache->level);
+	if(input == NULL) return NULL;
+
+	ret = QRinput_append(input, QR_MODE_8, size, data);
+	if(ret < 0) {
+		QRinput_free(input);
+		return NULL;
+	}
+	code = QRcode_Cache_encodeInput(cache, input);
+	QRinput_free(input);
+
+	return code;
+}
+
+
 /******************************************************************************
  * Structured QR-code encoding
  *****************************************************************************/
@@ -532,6 +532,54 @@ extern int QRcode_List_size(QRcode_List *qrlist);
  */
 extern void QRcode_List_free(QRcode_List *qrlist);
 
+/**
+ * Cache for encoding symbols of one version and level again and again, e.g.
+ * with a rotating token: the function patterns and the position of the data
+ * modules are computed once, and only the codes that changed since the
+ * previous symbol are computed and written again. The symbols are the same
+ * as QRcode_encodeString() or QRcode_encodeData() would create at that
+ * version.
+ * @warning An instance must not be used by two threads at once.
+ */
+typedef struct _QRcode_Cache QRcode_Cache;
+
+/**
+ * Create a cache for symbols of a version and level.
+ * @param version version of the symbols. It must not be 0.
+ * @param level error correction level.
+ * @return an instance of QRcode_Cache. On error, NULL is returned and errno
+ *         is set to indicate the error.
+ * @throw EINVAL invalid version or level.
+ * @throw ENOMEM unable to allocate memory.
+ */
+extern QRcode_Cache *QRcode_Cache_new(int version, QRecLevel level);
+
+/**
+ * Same to QRcode_encodeString(), at the version and level of the cache.
+ * @param cache an instance of QRcode_Cache.
+ * @return an instance of QRcode class, to be freed by QRcode_free(). On
+ *         error, NULL is returned, and errno is set to indicate the error.
+ * @throw EINVAL invalid input object.
+ * @throw ENOMEM unable to allocate memory for input objects.
+ * @throw ERANGE input data is too large for the version.
+ */
+extern QRcode *QRcode_Cache_encodeString(QRcode_Cache *cache, const char *string, QRencodeMode hint, int casesensitive);
+
+/**
+ * Same to QRcode_encodeData(), at the version and level of the cache.
+ * @param cache an instance of QRcode_Cache.
+ * @throw EINVAL invalid input object.
+ * @throw ENOMEM unable to allocate memory for input objects.
+ * @throw ERANGE input data is too large for the version.
+ */
+extern QRcode *QRcode_Cache_encodeData(QRcode_Cache *cache, int size, const unsigned char *data);
+
+/**
+ * Free the QRcode_Cache.
+ * @param cache an instance of QRcode_Cache.
+ */
+extern void QRcode_Cache_free(QRcode_Cache *cache);
+
 
 /******************************************************************************
  * System utilities
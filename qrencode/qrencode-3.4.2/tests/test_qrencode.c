@@ -623,6 +623,60 @@ void test_null_free(void)
 	testFinish();
 }
 
+void test_cache(void)
+{
+	QRcode_Cache *cache;
+	QRcode *code, *ref;
+	char str[64];
+	int version, level, i;
+	int err = 0;
+
+	testStart("Testing cached encoding");
+	for(version=1; version<=40; version+=13) {
+		for(level=0; level<4; level++) {
+			cache = QRcode_Cache_new(version, level);
+			assert_nonnull(cache, "QRcode_Cache_new(%d, %d) failed.\n", version, level);
+			if(cache == NULL) continue;
+			/* rotating tokens, and the same token twice */
+			for(i=0; i<6; i++) {
+				snprintf(str, sizeof(str), "pairing:%06d", (i / 2) * 7919);
+				code = QRcode_Cache_encodeString(cache, str, QR_MODE_8, 1);
+				ref = QRcode_encodeString(str, version, level, QR_MODE_8, 1);
+				if(ref != NULL && ref->version != version) {
+					/* does not fit, the version of the cache is kept */
+					if(code != NULL || errno != ERANGE) err++;
+				} else if(code == NULL || ref == NULL || code->version != ref->version ||
+				   memcmp(code->data, ref->data, ref->width * ref->width) != 0) {
+					printf("Version %d level %d token %d differs.\n", version, level, i);
+					err++;
+				}
+				QRcode_free(code);
+				QRcode_free(ref);
+			}
+			QRcode_Cache_free(cache);
+		}
+	}
+	assert_zero(err, "Cached symbols differ from QRcode_encodeString().\n");
+
+	cache = QRcode_Cache_new(1, QR_ECLEVEL_H);
+	code = QRcode_Cache_encodeString(cache, "this string does not fit in version 1", QR_MODE_8, 1);
+	assert_null(code, "too large data was accepted.\n");
+	assert_equal(errno, ERANGE, "errno != ERANGE\n");
+	code = QRcode_Cache_encodeData(cache, 3, (unsigned char *)"abc");
+	ref = QRcode_encodeData(3, (unsigned char *)"abc", 1, QR_ECLEVEL_H);
+	assert_nonnull(code, "small data was rejected after too large data.\n");
+	if(code != NULL && ref != NULL) {
+		assert_zero(memcmp(code->data, ref->data, ref->width * ref->width), "Cached symbol differs from QRcode_encodeData().\n");
+	}
+	QRcode_free(code);
+	QRcode_free(ref);
+	QRcode_Cache_free(cache);
+
+	assert_null(QRcode_Cache_new(0, QR_ECLEVEL_L), "version 0 was accepted.\n");
+	assert_nothing(QRcode_Cache_free(NULL), "Check QRcode_Cache_free(NULL).\n");
+	testFinish();
+}
+
 void test_encodeTooLongMQR(void)
 {
 	QRcode *code;
@@ -955,6 +1009,7 @@ int main(void)
 	test_fillerMQR();
 	test_formatInfoMQR();
 	test_encodeTooLongMQR();
+	test_cache();
 	test_decodeShortMQR();
 	test_oddBitCalcMQR();
 	test_mqrencode();
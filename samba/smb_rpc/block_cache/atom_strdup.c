@@ -32,66 +32,44 @@ extern int _cm (void);
 #define _xm(...)
 #endif
 
+/*
+ * Interned strings are spread over ATOM_SHARDS shards by their hash, each
+ * with its own lock and buckets, so that threads interning different
+ * strings seldom wait for each other. The hash is computed before taking
+ * a lock. A string handed out by atom_new() is preceded by its entry, so
+ * atom_ref() and atom_unref() find the entry and its shard without hashing.
+ */
+#define ATOM_SHARDS 16
+#define ATOM_BUCKETS 31 /* per shard */
+
 struct htable {
     struct htable *next;
+    unsigned int hv;
     int len;
     int refcnt;
     char *str;
 };
 
-/*static struct htable *buckets[23] = {NULL};*/
-static struct htable *buckets[11] = {NULL};
-static unsigned int rt[256] = {0};
-
-static pthread_mutex_t p_mutex;
-static int mtx_inited = 0;
-
-static void MEM_LOCK (void)
-{
-    if (mtx_inited == 0)
-    {
-        pthread_mutexattr_t t_attr_mx;
-        if (pthread_mutexattr_init (&t_attr_mx) != 0)
-        {
-            return;
-        }
-        if (pthread_mutexattr_settype (&t_attr_mx, PTHREAD_MUTEX_RECURSIVE) != 0)
-        {
-            pthread_mutexattr_destroy (&t_attr_mx);
-            return;
-        }
+struct atom_shard {
+    pthread_mutex_t lock;
+    struct htable *buckets[ATOM_BUCKETS];
+};
 
-        if (pthread_mutex_init (&p_mutex, &t_attr_mx) != 0)
-        {
-            pthread_mutexattr_destroy (&t_attr_mx);
-            return;
-        }
-        pthread_mutexattr_destroy (&t_attr_mx);
-        mtx_inited = 1;
-    }
-    pthread_mutex_lock (&p_mutex);
-}
+#define ATOM_SHARD_INITIALIZER {PTHREAD_MUTEX_INITIALIZER, {NULL}}
+static struct atom_shard shards[ATOM_SHARDS] = {
+    ATOM_SHARD_INITIALIZER, ATOM_SHARD_INITIALIZER, ATOM_SHARD_INITIALIZER, ATOM_SHARD_INITIALIZER,
+    ATOM_SHARD_INITIALIZER, ATOM_SHARD_INITIALIZER, ATOM_SHARD_INITIALIZER, ATOM_SHARD_INITIALIZER,
+    ATOM_SHARD_INITIALIZER, ATOM_SHARD_INITIALIZER, ATOM_SHARD_INITIALIZER, ATOM_SHARD_INITIALIZER,
+    ATOM_SHARD_INITIALIZER, ATOM_SHARD_INITIALIZER, ATOM_SHARD_INITIALIZER, ATOM_SHARD_INITIALIZER
+};
 
-static void MEM_UNLOCK (void)
-{
-    pthread_mutex_unlock (&p_mutex);
-}
+#define ATOM_SHARD(hv) (&shards[(hv) % ATOM_SHARDS])
+#define ATOM_BUCKET(hv) (((hv) / ATOM_SHARDS) % ATOM_BUCKETS)
 
 int atom_init (int r)
 {
-    /*time_t t = time (NULL);*/
-    int i;
-
-#if 1
-    srand (time(NULL)); /* 85, 91, 93 */
-#endif
-    for (i=0;i<256;i++)
-    {
-        rt[i] = rand();
-        /*rt[i] = rand (0x00FFFFFF);*/
-    }
-
-    if (r) return 0; /* dummy */
+    /* dummy: the hash needs no table, see _atom_hvalue () */
+    if (r) return 0;
     return 0;
 }
 
@@ -114,23 +92,17 @@ static int _mms (void* data, int a, const char* f, int line)
 
 void _adm (int len)
 {
-    MEM_LOCK ();
-    int_mem += len;
-    MEM_UNLOCK ();
+    __sync_fetch_and_add (&int_mem, len);
 }
 
 void _aam (void* p, const char* f, int line)
 {
-    MEM_LOCK ();
-    int_mem += _mms (p, 1, f, line);
-    MEM_UNLOCK ();
+    __sync_fetch_and_add (&int_mem, _mms (p, 1, f, line));
 }
 
 void _xxm (void* p, const char* f, int line)
 {
-    MEM_LOCK ();
-    int_mem -= _mms (p, 0, f, line);
-    MEM_UNLOCK ();
+    __sync_fetch_and_sub (&int_mem, _mms (p, 0, f, line));
 }
 
 int _cm (void)
@@ -138,19 +110,21 @@ int _cm (void)
     return int_mem;
 }
 
-struct htable* _atom_search (const char *str, int len, int *hv);
+unsigned int _atom_hvalue (const char *str, int len);
+struct htable* _atom_search (struct atom_shard *shard, const char *str, int len, unsigned int hv);
 
 const char *atom_new (const char *str, int len)
 {
-    int h;
+    unsigned int h = _atom_hvalue (str, len);
+    struct atom_shard *shard = ATOM_SHARD (h);
     struct htable *pht;
 
-    MEM_LOCK ();
-    pht = _atom_search (str, len, &h);
+    pthread_mutex_lock (&shard->lock);
+    pht = _atom_search (shard, str, len, h);
     if (pht != NULL)
     {
         ++pht->refcnt;
-        MEM_UNLOCK ();
+        pthread_mutex_unlock (&shard->lock);
         return pht->str;
     }
 
@@ -158,86 +132,116 @@ const char *atom_new (const char *str, int len)
     pht = (struct htable*) malloc (sizeof (struct htable) + len + 1);
     if (pht == NULL)
     {
-        MEM_UNLOCK ();
+        pthread_mutex_unlock (&shard->lock);
         return NULL;
     }
     _am (pht);
 
-    pht->next = buckets[h];
+    pht->next = shard->buckets[ATOM_BUCKET (h)];
+    pht->hv = h;
     pht->len = len;
     pht->str = (char*)(pht + 1);
     strncpy (pht->str, str, len);
     pht->str[len] = '\0';
     pht->refcnt = 1;
 
-    buckets[h] = pht;
+    shard->buckets[ATOM_BUCKET (h)] = pht;
 
-    MEM_UNLOCK ();
+    pthread_mutex_unlock (&shard->lock);
 
     return pht->str;
 }
 
+/* unlinks |pht| from |shard|, which is locked, and frees it */
+static void _atom_remove (struct atom_shard *shard, struct htable *pht)
+{
+    struct htable **pp;
+
+    for (pp = &shard->buckets[ATOM_BUCKET (pht->hv)]; *pp != NULL; pp = &(*pp)->next)
+    {
+        if (*pp == pht)
+        {
+            *pp = pht->next;
+            _xm (pht);
+            free (pht);
+            return;
+        }
+    }
+
+    printf ("Oops!!\n");
+}
+
 int atom_free (const char *str)
 {
-    int h;
+    int len = strlen (str);
+    unsigned int h = _atom_hvalue (str, len);
+    struct atom_shard *shard = ATOM_SHARD (h);
     struct htable *pht;
-    struct htable *p, *lp;
+    int refcnt;
 
-    MEM_LOCK ();
-    if ((pht = _atom_search (str, strlen (str), &h)) == NULL)
+    pthread_mutex_lock (&shard->lock);
+    if ((pht = _atom_search (shard, str, len, h)) == NULL)
     {
-        MEM_UNLOCK ();
+        pthread_mutex_unlock (&shard->lock);
         return 0;
     }
 
-    if (--pht->refcnt > 0)
-    {
-        MEM_UNLOCK ();
-        return pht->refcnt;
-    }
+    if ((refcnt = --pht->refcnt) == 0)
+        _atom_remove (shard, pht);
+    pthread_mutex_unlock (&shard->lock);
 
-    lp = NULL;
-    for (p = buckets[h]; p != NULL; p = p->next)
-    {
-        if (p == pht)
-        {
-            if (lp == NULL)
-                buckets[h] = p->next;
-            else
-                lp->next = p->next;
-            _xm (p);
-            free (p);
-
-            MEM_UNLOCK ();
-            return 0;
-        }
-        lp = p;
-    }
-    MEM_UNLOCK ();
+    return refcnt;
+}
 
-    printf ("Oops!!\n");
-    return 0;
+const char *atom_ref (const char *atom)
+{
+    struct htable *pht = ((struct htable*) atom) - 1;
+    struct atom_shard *shard = ATOM_SHARD (pht->hv);
+
+    pthread_mutex_lock (&shard->lock);
+    ++pht->refcnt;
+    pthread_mutex_unlock (&shard->lock);
+
+    return atom;
+}
+
+int atom_unref (const char *atom)
+{
+    struct htable *pht = ((struct htable*) atom) - 1;
+    struct atom_shard *shard = ATOM_SHARD (pht->hv);
+    int refcnt;
+
+    pthread_mutex_lock (&shard->lock);
+    if ((refcnt = --pht->refcnt) == 0)
+        _atom_remove (shard, pht);
+    pthread_mutex_unlock (&shard->lock);
+
+    return refcnt;
 }
 
 void atom_reset (void)
 {
-    int ht_cnt = sizeof (buckets) / sizeof (buckets[0]);
-    int i;
+    int i, j;
 
-    MEM_LOCK ();
-    for (i = 0; i < ht_cnt; i++)
+    for (i = 0; i < ATOM_SHARDS; i++)
     {
-        struct htable *pt, *p;
-        for (pt = buckets[i]; pt != NULL; )
+        struct atom_shard *shard = &shards[i];
+
+        pthread_mutex_lock (&shard->lock);
+        for (j = 0; j < ATOM_BUCKETS; j++)
         {
-            p = pt;
-            pt = pt->next;
-            _xm (p);
-            free (p);
+            struct htable *pt, *p;
+            for (pt = shard->buckets[j]; pt != NULL; )
+            {
+                p = pt;
+                pt = pt->next;
+                _xm (p);
+                free (p);
+            }
+            shard->buckets[j] = NULL;
         }
-        buckets[i] = NULL;
+        pthread_mutex_unlock (&shard->lock);
     }
-    MEM_UNLOCK ();
 }
 
 char *atom_strdup(const char *str)
@@ -254,34 +258,28 @@ const char *atom_int (unsigned int n)
     return atom_new (s, strlen(s));
 }
 
-int _atom_hvalue (const char *str, int len)
+/* FNV-1a: needs no seeding, and spreads paths sharing a long prefix */
+unsigned int _atom_hvalue (const char *str, int len)
 {
-    int i, h;
+    unsigned int h = 2166136261U;
+    int i;
 
-    for (h = 0, i = 0; i < len; i++)
+    for (i = 0; i < len; i++)
     {
-        h = (h<<1) + rt[(unsigned char)str[i]];
+        h = (h ^ (unsigned char)str[i]) * 16777619U;
     }
 
     return h;
 }
 
-struct htable* _atom_search (const char *str, int len, int *hv)
+/* with |shard| locked */
+struct htable* _atom_search (struct atom_shard *shard, const char *str, int len, unsigned int hv)
 {
-    int h = _atom_hvalue (str, len) % (sizeof (buckets) / sizeof (buckets[0]));
     struct htable *pht;
 
-    if (hv != NULL)
-        *hv = h;
-
-    if ((pht = buckets[h]) == NULL)
+    for (pht = shard->buckets[ATOM_BUCKET (hv)]; pht != NULL; pht = pht->next)
     {
-        return NULL;
-    }
-
-    for ( ; pht != NULL; pht = pht->next)
-    {
-        if (pht->len == len && strcmp (pht->str, str) == 0)
+        if (pht->hv == hv && pht->len == len && memcmp (pht->str, str, len) == 0)
         {
             return pht;
         }
@@ -325,26 +323,35 @@ int _atom_ltoa (unsigned int i, char *is, int len)
 
 int _atom_dump (void)
 {
-    int ht_cnt = sizeof (buckets) / sizeof (buckets[0]);
-    int i, hitem_total = 0, h_min = 0, h_max = 0;
+    int i, j, hitem_total = 0, h_min = 0, h_max = 0;
 
-    for (i = 0; i < ht_cnt; i++)
+    for (i = 0; i < ATOM_SHARDS; i++)
     {
-        struct htable *pht = NULL;
-        int hitem_cnt = 0;
+        struct atom_shard *shard = &shards[i];
+        int shard_cnt = 0;
 
-        for (pht = buckets[i]; pht != NULL; pht = pht->next)
+        pthread_mutex_lock (&shard->lock);
+        for (j = 0; j < ATOM_BUCKETS; j++)
         {
-            hitem_cnt++;
-        }
+            struct htable *pht = NULL;
+            int hitem_cnt = 0;
+
+            for (pht = shard->buckets[j]; pht != NULL; pht = pht->next)
+            {
+                hitem_cnt++;
+            }
 
-        if (i == 0) h_max = h_min = hitem_cnt;
-        if (hitem_cnt > h_max) h_max = hitem_cnt;
-        if (hitem_cnt < h_min) h_min = hitem_cnt;
+            if (i == 0 && j == 0) h_max = h_min = hitem_cnt;
+            if (hitem_cnt > h_max) h_max = hitem_cnt;
+            if (hitem_cnt < h_min) h_min = hitem_cnt;
 
-        hitem_total += hitem_cnt;
+            shard_cnt += hitem_cnt;
+        }
+        pthread_mutex_unlock (&shard->lock);
+
+        hitem_total += shard_cnt;
 
-        printf ("- atom_str.buckets[%d]: %d\n", i, hitem_cnt);
+        printf ("- atom_str.shards[%d]: %d\n", i, shard_cnt);
     }
     printf ("- atom_str total buckets size: %d (%d,%d)\n", hitem_total, h_min, h_max);
 
@@ -361,62 +368,91 @@ unsigned int _atom_time (void)
 }
 
 #if 0
-void _atom_test (int seed, int cnt)
+/*
+ * Throughput of interning from |threads| threads at once, as block cache
+ * readers do: each interns one of ATOM_TEST_PATHS paths, takes and drops
+ * a reference to it, as a block fill and its eviction do, and frees it.
+ */
+#define ATOM_TEST_PATHS 64
+
+struct atom_test_arg {
+    int id;
+    int cnt;
+};
+
+static void* _atom_test_main (void* arg)
 {
+    struct atom_test_arg *ta = (struct atom_test_arg*) arg;
     int i;
-    unsigned int t1, t2;
 
-    t1 = _atom_time ();
-
-    atom_init (seed);
+    for (i = 0; i < ta->cnt; i++)
+    {
+        char s[100] = "";
+        const char *a;
 
-    for (i = 0; i < cnt; i++) atom_int (i);
+        sprintf (s, "smb://192.168.1.2/video/%d/%d.avi", ta->id % 4, i % ATOM_TEST_PATHS);
+        a = atom_strdup (s);
+        atom_ref (a);
+        atom_unref (a);
+        atom_free (a);
+    }
 
-    t2 = _atom_time ();
-    printf ("create time: %d msec.\n", t2 - t1);
+    return NULL;
+}
 
-    _atom_dump ();
+void _atom_test (int threads, int cnt)
+{
+    pthread_t th[64];
+    struct atom_test_arg ta[64];
+    unsigned int t1, t2;
+    int i;
 
-    t1 = _atom_time ();
-    for (i = 0; i < cnt; i++) atom_int (i);
-    t2 = _atom_time ();
-    printf ("search time: %d msec.\n", t2 - t1);
+    /* keep the paths interned, so that the threads only look up */
+    for (i = 0; i < 4 * ATOM_TEST_PATHS; i++)
+    {
+        char s[100] = "";
+        sprintf (s, "smb://192.168.1.2/video/%d/%d.avi", i / ATOM_TEST_PATHS, i % ATOM_TEST_PATHS);
+        atom_strdup (s);
+    }
 
     t1 = _atom_time ();
-    for (i = 0; i < cnt; i++)
+    for (i = 0; i < threads; i++)
     {
-        char s[100] = "";
-        _atom_ltoa (i, s, sizeof (s));
-        atom_free (s);
+        ta[i].id = i;
+        ta[i].cnt = cnt;
+        pthread_create (&th[i], NULL, _atom_test_main, &ta[i]);
+    }
+    for (i = 0; i < threads; i++)
+    {
+        pthread_join (th[i], NULL);
     }
     t2 = _atom_time ();
-    printf ("free time: %d msec.\n\n", t2 - t1);
+
+    printf ("threads: %d, %d ops in %d msec: %d ops/msec.\n", threads, threads * cnt * 3,
+            t2 - t1, t2 - t1 ? threads * cnt * 3 / (int)(t2 - t1) : 0);
 
     atom_reset ();
 }
 
 int main (int argc, char **argv)
 {
-    int i, cnt;
+    int i, threads, cnt;
 
-#if 1
-    if (argc < 2)
+    if (argc < 3)
     {
-        fprintf (stderr, "Usage: %s hcount\n", argv[0]);
+        fprintf (stderr, "Usage: %s threads count\n", argv[0]);
         exit (-1);
     }
 
-    cnt = atoi (argv[1]);
-#else
-    cnt = 100000;
-    for (i = 0; i < 100; i++)
-#endif
+    threads = atoi (argv[1]);
+    cnt = atoi (argv[2]);
+    if (threads > 64) threads = 64;
+
+    for (i = 1; i <= threads; i *= 2)
     {
-        printf ("seed: %d, cnt: %d\n", i, cnt);
         _atom_test (i, cnt);
     }
 
     return 0;
 }
 #endif
-
@@ -4,5 +4,12 @@
 extern char *atom_strdup (const char *str);
 extern int atom_free (const char *str);
 
-#endif /* TEST_ATOM_STR_INCLUDE */
+/*
+ * For strings returned by atom_strdup () only: take or drop one more
+ * reference, without hashing the string again. atom_unref () returns the
+ * references left, as atom_free () does.
+ */
+extern const char *atom_ref (const char *atom);
+extern int atom_unref (const char *atom);
 
+#endif /* TEST_ATOM_STR_INCLUDE */
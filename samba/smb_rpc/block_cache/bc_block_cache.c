@@ -16,6 +16,7 @@
 #include "bc_hash.h"
 #include "bc_free_block.h"
 #include "bc_file_index.h"
+#include "x_block_cache.h"
 
 static int _hash_fun(void* data)
 {
@@ -50,9 +51,66 @@ static int _align_4byte(int len)
 struct bc_tag {
     int blocks_per_task;
     int block_size;
-    int threshold_percent;
+    int threshold_percent; /* share of the blocks that read-ahead may hold */
 };
 
+/*
+ * Locking.
+ *
+ * The hash is split in BC_HASH_SHARDS shards, locked separately, so that
+ * readers of different files seldom wait for each other. A shard lock is
+ * held across a lookup and the copy out of the block found, and the CLOCK
+ * of the free block list takes it to evict a block, so a block cannot be
+ * reused while it is being read. A block is put in the hash with
+ * block_status 1 before its data is read; whoever finds it so waits on the
+ * shard instead of reading it again. Seek and read on a NAS descriptor are
+ * serialized by one of BC_IO_LOCKS locks, picked by descriptor.
+ *
+ * Sequential read-ahead.
+ *
+ * Each handle remembers the block it last read from. Moving on to the next
+ * block doubles the number of blocks kept fetched ahead of the reader, up to
+ * BC_READAHEAD_MAX_BLOCKS; any other move stops read-ahead for the handle.
+ * The prefetch thread fills the requested blocks as a reader would.
+ *
+ * Lock order: prefetch_mutex, then the clock of the free block list, then a
+ * shard, then an I/O lock.
+ */
+#define BC_IO_LOCKS 8
+#define BC_READAHEAD_FIRST_BLOCKS 2
+#define BC_READAHEAD_MAX_BLOCKS 8
+#define BC_BLOCK_WAIT_MS 1000
+
+struct bc_readahead {
+    int in_use;
+    off_t last_offset; /* block last read through the handle, -1 if none */
+    int window;        /* blocks kept fetched ahead of it */
+};
+
+struct bc_prefetch_req {
+    char* path;
+    int fd;
+    off_t offset;
+};
+
+static pthread_mutex_t bc_io_mutex[BC_IO_LOCKS] = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER
+};
+
+/* indexed by handle slot, only used by the thread reading the handle */
+static struct bc_readahead readaheads[BC_MAX_HANDLES];
+
+static pthread_mutex_t prefetch_mutex = PTHREAD_MUTEX_INITIALIZER; /* guards the prefetch state below */
+static pthread_cond_t prefetch_cond = PTHREAD_COND_INITIALIZER;    /* a prefetch was requested */
+static pthread_cond_t prefetch_idle_cond = PTHREAD_COND_INITIALIZER; /* a prefetch finished */
+static void* prefetch_list = NULL;
+static pthread_t prefetch_thread;
+static int prefetch_running = 0;
+static int prefetch_fd = -1; /* descriptor the prefetch thread is reading, -1 if idle */
+
+static struct bc_stats stats;
+
 void* bc_create(int blocks_per_task, int block_size, int threshold_percent)
 {
     struct bc_tag* tag = NULL;
@@ -81,18 +139,12 @@ void* bc_create(int blocks_per_task, int block_size, int threshold_percent)
             return NULL;
         }
         block->block_size_only = tag->block_size;
-        bc_free_block_list_add_head(block);
+        bc_free_block_list_add(block);
     }
 
     return hash;
 }
 
-typedef int (*_io_open)(const char* path, int flags, mode_t mode);
-typedef int (*_io_close)(int fd);
-typedef ssize_t (*_io_read)(int fd, void* buf, size_t count);
-typedef off_t (*_io_lseek)(int fd, off_t offset, int whence);
-typedef int (*_io_stat)(const char*, struct stat*);
-
 static _io_open io_open;
 static _io_read io_read;
 static _io_lseek io_lseek;
@@ -110,16 +162,52 @@ int bc_set_io_fun(_io_open nio_open, _io_read nio_read, _io_lseek nio_lseek, _io
     return 0;
 }
 
-int bc_destroy(void* bc)
+static void* bc_g = NULL;
+
+/* takes |data| off the hash for reuse, unless it is being filled, read or pinned */
+static int _evict_block(void* data)
 {
-    int count = bc_free_block_list_count();
-    if (count != 0) {
-        LOG("== bc: 0x%08x, free block count: %d ==\n", (int)bc, count);
+    struct bc_block* blk = (struct bc_block*)data;
+    int shard = -1;
+
+    if (blk->block_status == 1) return -1; /* locked */
+
+    if (blk->block_status == 2) {
+        shard = bc_hash_get_shard(bc_g, blk);
+        bc_hash_lock_shard(bc_g, shard);
+        if (blk->pins > 0) {
+            /* borrowed through bc_read_ref() */
+            bc_hash_unlock_shard(bc_g, shard);
+            return -1;
+        }
+        bc_hash_remove_by_data(bc_g, blk);
+        blk->block_status = 1;
+        bc_hash_unlock_shard(bc_g, shard);
+        __sync_fetch_and_add(&stats.evictions, 1);
+        return 0;
     }
+
+    /* never used or freed, not in the hash */
+    blk->block_status = 1;
+    return 0;
+}
+
+int bc_destroy(void* bc)
+{
+    LOG("== bc: 0x%08x, blocks: %d, hits: %u, misses: %u, waits: %u, evictions: %u, prefetches: %u ==\n", (int)bc, bc_free_block_list_count(), stats.hits, stats.misses, stats.waits, stats.evictions, stats.prefetches);
+    /* take every block off the hash: once all are locked, the clock finds none */
+    while (bc_free_block_list_get(_evict_block) != NULL);
     bc_free_block_list_deinit();
     return bc_hash_destroy (bc);
 }
 
+int bc_get_stats(struct bc_stats* pstats)
+{
+    if (pstats == NULL) return -1;
+    *pstats = stats;
+    return 0;
+}
+
 static off_t _align_block(off_t offset, int block_size)
 {
     return ((offset + block_size) / block_size - 1) * block_size;
@@ -142,45 +230,278 @@ static int _block_comp_fun(void* data1, void* data2)
     return -1;
 }
 
-static void* bc_get_block(void* bc, const char* path, int fd, off_t offset)
+/* returns the number of bytes read into |blk|, or -1 on seek error */
+static int bc_fill_block(struct bc_block* blk)
 {
-    struct bc_block blk = {-1, (char*)path, fd, offset, 0, 0, {0}};
-    struct bc_tag* tag = NULL;
-    struct bc_block* pblock = NULL;
+    pthread_mutex_t* io_mutex = &bc_io_mutex[(unsigned int)blk->fd % BC_IO_LOCKS];
+    int rlen = 0;
+    int rtotal = 0;
+
+    bc_lock(io_mutex);
+
+    /* seek */
+    if (bc_file_index_list_get_pos_by_fd(blk->fd) != blk->offset) {
+        if (io_lseek(blk->fd, blk->offset, SEEK_SET) < 0) {
+            bc_unlock(io_mutex);
+            LOG("seek error\n");
+            return -1;
+        }
+    }
+    while ((rlen = io_read(blk->fd, blk->data + rtotal, blk->block_size_only - rtotal)) > 0) {
+        rtotal += rlen;
+        if (rtotal >= blk->block_size_only) break;
+    }
+    if (rlen < 0) {
+        LOG("io_Read error\n");
+    }
+    /* after an error the position is unknown, seek next time */
+    bc_file_index_list_update_pos_by_fd(blk->fd, rlen < 0 ? -1 : blk->offset + rtotal);
+
+    bc_unlock(io_mutex);
+
+    return rtotal;
+}
+
+/*
+ * Returns the block holding |offset| of the file, with its shard locked and
+ * *pshard set, reading it through the NAS first if it is not cached. Returns
+ * NULL, with no lock held, on error, or when |prefetch| is set: the prefetch
+ * thread only fills blocks that nobody has, and never waits. |path| is the
+ * handle's interned path; a block filled takes a reference to it.
+ */
+static struct bc_block* bc_get_block(const char* path, int fd, off_t offset, int prefetch, int* pshard, int* perror)
+{
+    struct bc_block key = {-1, (char*)path, fd, offset, 0, 0, 0, 0, {0}};
+    struct bc_tag* tag = bc_hash_get_tag(bc_g);
+    struct bc_block* blk = NULL;
+    struct bc_block* victim = NULL;
+    int shard = -1;
+    int rtotal = 0;
     int x = 0;
 
-    tag = bc_hash_get_tag(bc);
-    if (tag == NULL) return NULL;
+    key.offset = _align_block(offset, tag->block_size);
+    shard = bc_hash_get_shard(bc_g, &key);
+
+    bc_hash_lock_shard(bc_g, shard);
+    for (;;) {
+        blk = bc_hash_search(bc_g, &key, _block_comp_fun);
+        if (blk && victim) {
+            /* found by someone else while we were looking for a block */
+            victim->block_status = 0;
+            victim = NULL;
+        }
+        if (blk && (prefetch || blk->block_status != 1)) break;
+        if (blk) {
+            /* being filled by a reader or by read-ahead */
+            if (x++ == 0) __sync_fetch_and_add(&stats.waits, 1);
+            if (bc_hash_wait_shard(bc_g, shard, BC_BLOCK_WAIT_MS) != 0) {
+                LOG("??? loop wait: block info: %d, %d, %lld, %s\n", blk->block_status, blk->fd, blk->offset, blk->path);
+            }
+            continue;
+        }
+        if (victim) break;
+
+        bc_hash_unlock_shard(bc_g, shard);
+        victim = bc_free_block_list_get(_evict_block);
+        if (victim == NULL) {
+            LOG("no free block\n");
+            *perror = -4;
+            return NULL;
+        }
+        bc_hash_lock_shard(bc_g, shard);
+    }
+
+    if (blk) {
+        if (prefetch) {
+            bc_hash_unlock_shard(bc_g, shard);
+            return NULL;
+        }
+        __sync_fetch_and_add(&stats.hits, 1);
+        blk->referenced = 1;
+        *pshard = shard;
+        return blk;
+    }
+
+    /* in the hash before reading, so nobody else reads it meanwhile */
+    blk = victim;
+    if (blk->path) atom_unref(blk->path);
+    blk->path = (char*)atom_ref(path);
+    blk->fd = fd;
+    blk->offset = key.offset;
+    blk->block_size_only = tag->block_size;
+    blk->data_len = 0;
+    blk->referenced = 0;
+    bc_hash_add(bc_g, blk);
+    bc_hash_unlock_shard(bc_g, shard);
+
+    rtotal = bc_fill_block(blk);
+
+    bc_hash_lock_shard(bc_g, shard);
+    if (rtotal < 0) {
+        bc_hash_remove_by_data(bc_g, blk);
+        blk->block_status = 3; /* freed */
+        bc_hash_wake_shard(bc_g, shard);
+        bc_hash_unlock_shard(bc_g, shard);
+        *perror = -5;
+        return NULL;
+    }
+    blk->data_len = rtotal;
+    blk->block_status = 2;
+    bc_hash_wake_shard(bc_g, shard);
+
+    if (prefetch) {
+        __sync_fetch_and_add(&stats.prefetches, 1);
+        bc_hash_unlock_shard(bc_g, shard);
+        return NULL;
+    }
+    __sync_fetch_and_add(&stats.misses, 1);
+    blk->referenced = 1;
+    *pshard = shard;
+    return blk;
+}
+
+static int _is_cached(const char* path, int fd, off_t offset)
+{
+    struct bc_block key = {-1, (char*)path, fd, offset, 0, 0, 0, 0, {0}};
+    int shard = bc_hash_get_shard(bc_g, &key);
+    int cached = 0;
+
+    bc_hash_lock_shard(bc_g, shard);
+    cached = bc_hash_search(bc_g, &key, _block_comp_fun) != NULL;
+    bc_hash_unlock_shard(bc_g, shard);
+
+    return cached;
+}
+
+static int _comp_prefetch_req(void* data1, void* data2)
+{
+    struct bc_prefetch_req* req1 = (struct bc_prefetch_req*)data1;
+    struct bc_prefetch_req* req2 = (struct bc_prefetch_req*)data2;
+    if (req1 == NULL || req2 == NULL) return -1;
+    if (req1->fd != req2->fd) return -1;
+    if (req2->path && (req1->offset != req2->offset || strcmp(req1->path, req2->path) != 0)) return -1;
+    return 0;
+}
+
+static void* _prefetch_main(void* arg)
+{
+    struct bc_prefetch_req* req = NULL;
+    int shard = -1;
+    int error = 0;
+
+    bc_lock(&prefetch_mutex);
+    while (prefetch_running) {
+        req = bc_dlist_remove_head(prefetch_list);
+        if (req == NULL) {
+            pthread_cond_wait(&prefetch_cond, &prefetch_mutex);
+            continue;
+        }
+
+        prefetch_fd = req->fd;
+        bc_unlock(&prefetch_mutex);
+
+        bc_get_block(req->path, req->fd, req->offset, 1, &shard, &error);
+        atom_unref(req->path);
+        free(req);
+
+        bc_lock(&prefetch_mutex);
+        prefetch_fd = -1;
+        pthread_cond_broadcast(&prefetch_idle_cond);
+    }
+    bc_unlock(&prefetch_mutex);
+
+    return NULL;
+}
 
-    blk.offset = _align_block(offset, tag->block_size);
-    /*if (blk.offset != offset) {
-        LOG("offset: %lld -> %lld\n", offset, blk.offset);
-    }*/
-
-    pblock = bc_hash_search(bc, &blk, _block_comp_fun);
-    if (pblock) {
-        while (pblock->block_status == 1) { /* lock */
-            usleep(1000);
-            if ((++x % 1000) == 0) {
-                LOG("??? loop wait: block info: %d, %d, %lld, %s\n", pblock->block_status, pblock->fd, pblock->offset, pblock->path);
+static void bc_readahead(int handle, const char* path, int fd, off_t offset, off_t size)
+{
+    struct bc_tag* tag = bc_hash_get_tag(bc_g);
+    struct bc_readahead* ra = NULL;
+    int slot = bc_file_index_handle_slot(handle);
+    int max_window = 0;
+    int queued = 0;
+    int i = 0;
+
+    if (tag == NULL || slot < 0 || !prefetch_running) return;
+
+    ra = &readaheads[slot];
+    if (!ra->in_use || offset == ra->last_offset) return;
+
+    max_window = tag->blocks_per_task * tag->threshold_percent / 100;
+    if (max_window > BC_READAHEAD_MAX_BLOCKS) max_window = BC_READAHEAD_MAX_BLOCKS;
+
+    if (ra->last_offset >= 0 && offset == ra->last_offset + tag->block_size) {
+        ra->window = ra->window ? ra->window * 2 : BC_READAHEAD_FIRST_BLOCKS;
+        if (ra->window > max_window) ra->window = max_window;
+    } else {
+        ra->window = 0;
+    }
+    ra->last_offset = offset;
+
+    for (i = 1; i <= ra->window; i++) {
+        struct bc_prefetch_req search_req = {(char*)path, fd, offset + (off_t)i * tag->block_size};
+        struct bc_prefetch_req* req = NULL;
+
+        if (size > 0 && search_req.offset >= size) break;
+        if (_is_cached(path, fd, search_req.offset)) continue;
+
+        bc_lock(&prefetch_mutex);
+        if (bc_dlist_search(prefetch_list, &search_req, _comp_prefetch_req) == NULL) {
+            req = malloc(sizeof(*req));
+            if (req) {
+                req->path = (char*)atom_ref(path);
+                req->fd = fd;
+                req->offset = search_req.offset;
+                if (bc_dlist_add_tail(prefetch_list, req) == 0) {
+                    queued = 1;
+                } else {
+                    atom_unref(req->path);
+                    free(req);
+                }
             }
         }
+        bc_unlock(&prefetch_mutex);
     }
 
-    return pblock;
+    if (queued) pthread_cond_signal(&prefetch_cond);
 }
 
-static void* bc_get_free_block(void* bc)
+static int bc_prefetch_start(void)
 {
-    struct bc_block* block = bc_free_block_list_remove_head();
-    if (block) {
-        bc_hash_remove_by_data(bc, block);
-        /*LOG("== FREE BLOCK: status: %d, path: %s, offset: %lld, block_size: %d, data_len: %d ==\n", block->block_status, block->path, block->offset, block->block_size_only, block->data_len);*/
+    prefetch_list = bc_dlist_create();
+    if (prefetch_list == NULL) {
+        LOG("Error: out of memory\n");
+        return -1;
+    }
+
+    prefetch_running = 1;
+    if (pthread_create(&prefetch_thread, NULL, _prefetch_main, NULL) != 0) {
+        LOG("prefetch thread error, read-ahead disabled\n");
+        prefetch_running = 0;
     }
-    return block;
+    return 0;
 }
 
-static void* bc_g = NULL;
+static void bc_prefetch_stop(void)
+{
+    struct bc_prefetch_req* req = NULL;
+
+    bc_lock(&prefetch_mutex);
+    if (prefetch_running) {
+        prefetch_running = 0;
+        pthread_cond_signal(&prefetch_cond);
+        bc_unlock(&prefetch_mutex);
+        pthread_join(prefetch_thread, NULL);
+        bc_lock(&prefetch_mutex);
+    }
+    while ((req = bc_dlist_remove_head(prefetch_list)) != NULL) {
+        atom_unref(req->path);
+        free(req);
+    }
+    bc_dlist_destroy(prefetch_list);
+    prefetch_list = NULL;
+    bc_unlock(&prefetch_mutex);
+}
 
 int bc_init(int blocks_per_task, int block_size, int threshold_percent)
 {
@@ -189,13 +510,22 @@ int bc_init(int blocks_per_task, int block_size, int threshold_percent)
             LOG("bc_create error\n");
             return -1;
         }
+        if (bc_prefetch_start() != 0) {
+            bc_prefetch_stop();
+            bc_destroy(bc_g);
+            bc_g = NULL;
+            return -1;
+        }
     }
     return 0;
 }
 
 int bc_deinit(void)
 {
-    if (bc_g) bc_destroy(bc_g);
+    if (bc_g) {
+        bc_prefetch_stop();
+        bc_destroy(bc_g);
+    }
     bc_g = NULL;
     return 0;
 }
@@ -237,112 +567,113 @@ int bc_open(const char* path, int flags, mode_t mode)
 
     bc_file_index_list_add_handle(path, fd, handle, size);
 
+    {
+        struct bc_readahead* ra = &readaheads[bc_file_index_handle_slot(handle)];
+        ra->in_use = 1;
+        ra->last_offset = -1;
+        ra->window = 0;
+    }
+
     return handle;
 }
 
-int bc_read(int handle, void* buf, size_t count)
+/*
+ * Reads up to |count| bytes at the handle position from a single block.
+ * With |pref| NULL they are copied to |buf|. Otherwise nothing is copied:
+ * the block is pinned, *pdata points at the bytes in it and *pref is the
+ * block to hand back to bc_read_release().
+ */
+static int _bc_read(int handle, void* buf, size_t count, const void** pdata, void** pref)
 {
     int fd = -1;
     off_t handle_pos = 0;
-    off_t fd_pos = 0;
     off_t size = 0;
     struct bc_block* blk = NULL;
-    char path[4096] = "";
-    struct bc_tag* tag = NULL;
+    const char* path = NULL;
+    int shard = -1;
+    int error = -1;
 
     /*LOG("==== read(handle %d, buf 0x%08x, count: %u)\n", handle, (int)buf, count);*/
 
-    if (bc_file_index_list_search_handle_info_by_handle(handle, path, &fd, &fd_pos, &size, &handle_pos) != 0) {
+    if (bc_file_index_list_search_handle_info_by_handle(handle, NULL, &fd, NULL, &size, &handle_pos) != 0) {
         LOG("error handle not found\n");
         return -2;
     }
+    /* interned once by bc_open(), and kept while the handle is open */
+    path = bc_file_index_list_search_path_by_handle(handle);
 
     if (size > 0 && handle_pos == size) {
         LOG("EOF\n");
         return 0;
     }
 
-    blk = bc_get_block(bc_g, path, fd, handle_pos);
-    /*LOG("fd: %d, handle_pos: %lld, blk: 0x%08x\n", fd, handle_pos, (int)blk);*/
-
-    if (blk == NULL) {
-    tag = bc_hash_get_tag(bc_g);
-    if (tag == NULL) {
+    if (bc_hash_get_tag(bc_g) == NULL) {
         LOG("no tag\n");
         return -3;
     }
 
-    blk = bc_get_free_block(bc_g);
-    if (blk == NULL) {
-        LOG("no free block\n");
-        return -4;
-    }
-
-    if (blk->path && fd >= 0) {
-        bc_file_index_list_remove_offset(blk->path, blk->fd, blk->offset);
-        bc_hash_remove_by_data(bc_g, blk);
-    }
-
-    blk->block_status = 1; /* locked */
-
-    if (blk->path) atom_free(blk->path);
-    blk->path = atom_strdup(path);
-    blk->fd = fd;
-    blk->offset = _align_block(handle_pos, tag->block_size);
-    blk->block_size_only = tag->block_size;
-    blk->data_len = 0;
-
-    {
-        int rlen = 0;
-        int rtotal = 0;
-        /*off_t pos = bc_file_index_list_get_pos_by_fd(blk->fd);*/
-        /* seek */
-        if (fd_pos != handle_pos) {
-        /*if (_align_block(fd_pos, tag->block_size) != _align_block(handle_pos, tag->block_size)) {*/
-            if (io_lseek(fd, blk->offset, SEEK_SET) < 0) {
-                blk->block_status = 3; /* freed */
-                bc_free_block_list_add_tail(blk);
-                LOG("seek error\n");
-                return -5;
-            }
-            /*LOG("seek-> handle %d, fd %d seek -> %lld\n", handle, fd, blk->offset);*/
-        }
-        while ((rlen = io_read(fd, blk->data + rtotal, tag->block_size - rtotal)) > 0) {
-            rtotal += rlen;
-            if (rtotal >= blk->block_size_only) break;
-        }
-        blk->data_len = rtotal;
-        if (rlen < 0) {
-            LOG("io_Read error\n");
-        }
-        bc_file_index_list_update_pos_by_fd(blk->fd, blk->offset + rtotal);
-        bc_hash_add(bc_g, blk);
-        bc_file_index_list_add_offset(blk->path, blk->fd, blk->offset);
-        /*LOG("update fd %d pos: %lld\n", fd, blk->offset + rtotal);*/
-    }
-
-    blk->block_status = 2;
-    }
+    blk = bc_get_block(path, fd, handle_pos, 0, &shard, &error);
+    /*LOG("fd: %d, handle_pos: %lld, blk: 0x%08x\n", fd, handle_pos, (int)blk);*/
 
     if (blk) {
-        int blk_x = blk->data_len - (handle_pos - blk->offset);
+        off_t blk_offset = blk->offset;
+        int blk_pos = handle_pos - blk->offset;
+        int blk_x = blk->data_len - blk_pos;
         int return_count = count;
         /*LOG("blk_x: %d = blk->data_len: %d - (handle_pos: %lld - blk->offset: %lld)\n", blk_x, blk->data_len, handle_pos, blk->offset);*/
+        if (blk_x < 0) blk_x = 0; /* short block at the end of the file */
         if (blk_x < count) return_count = blk_x;
-        memcpy(buf, blk->data + (handle_pos - blk->offset), return_count);
-        if (return_count >= blk->data_len) {
-            /* add free block list */
-            bc_file_index_list_remove_offset(blk->path, blk->fd, blk->offset);
-            bc_free_block_list_add_tail(blk);
+        if (pref) {
+            blk->pins++;
+            *pdata = blk->data + blk_pos;
+            *pref = blk;
+        } else {
+            memcpy(buf, blk->data + blk_pos, return_count);
         }
+        bc_hash_unlock_shard(bc_g, shard);
+
         bc_file_index_list_update_handle_pos_by_handle(handle, handle_pos + return_count);
+        bc_readahead(handle, path, fd, blk_offset, size);
         /*LOG("update handle %d pos: %lld\n", handle, handle_pos + return_count);*/
         /*LOG("read rc %d\n", return_count);*/
         return return_count;
     }
 
     LOG("no blk\n");
-    return -1;
+    return error;
+}
+
+int bc_read(int handle, void* buf, size_t count)
+{
+    return _bc_read(handle, buf, count, NULL, NULL);
+}
+
+int bc_read_ref(int handle, size_t count, const void** pdata, void** pref)
+{
+    if (pdata == NULL || pref == NULL) return -1;
+    *pdata = NULL;
+    *pref = NULL;
+    return _bc_read(handle, NULL, count, pdata, pref);
+}
+
+int bc_read_release(void* ref)
+{
+    struct bc_block* blk = (struct bc_block*)ref;
+    int shard = -1;
+
+    if (blk == NULL || bc_g == NULL) return -1;
+
+    shard = bc_hash_get_shard(bc_g, blk);
+    bc_hash_lock_shard(bc_g, shard);
+    if (blk->pins <= 0) {
+        bc_hash_unlock_shard(bc_g, shard);
+        LOG("block not pinned: %d, %lld, %s\n", blk->fd, blk->offset, blk->path);
+        return -1;
+    }
+    blk->pins--;
+    bc_hash_unlock_shard(bc_g, shard);
+
+    return 0;
 }
 
 off_t bc_lseek(int handle, off_t offset, int whence)
@@ -374,13 +705,6 @@ off_t bc_lseek(int handle, off_t offset, int whence)
 
 int bc_close(int handle)
 {
-    /* TODO */
-    /*
-     * handle -> fd
-     * remove file_index handle and all offset
-     * all offset <-> block add into free list (add_tail)
-     * if all handle removed, del and close fd
-     */
     int fd = -1;
     int count = 0;
     char path[4096] = "";
@@ -389,28 +713,31 @@ int bc_close(int handle)
     if (bc_file_index_list_search_handle_info_by_handle(handle, path, &fd, NULL, NULL, NULL) != 0) return -1;
 
     LOG("fd: %d, path: %s\n", fd, path);
+
+    readaheads[bc_file_index_handle_slot(handle)].in_use = 0;
     bc_file_index_list_remove_handle(path, fd, handle);
     bc_file_index_remove_handle(handle);
 
     count = bc_file_index_list_get_handle_count(path, fd);
     LOG("count: %d\n", count);
     if (count <= 0) {
-        /* free all fd's blocks */
-        off_t offset = -1;
-        while ((offset = bc_file_index_list_remove_offset_1by1(path, fd)) != -1) {
-            struct bc_block blk = {-1, (char*)path, fd, offset, 0, 0, {0}};
-            struct bc_tag* tag = bc_hash_get_tag(bc_g);
-            struct bc_block* pblock = NULL;
-
-            if (tag == NULL) continue;
-
-            blk.offset = _align_block(offset, tag->block_size);
-            pblock = bc_hash_search(bc_g, &blk, _block_comp_fun);
-            if (pblock) {
-                bc_hash_remove_by_data(bc_g, pblock);
-                bc_free_block_list_add_head(pblock);
-            }
+        /*
+         * The fd's blocks stay cached by path until the clock reuses them.
+         * Drop its read-ahead and wait for the one being read.
+         */
+        struct bc_prefetch_req search_req = {NULL, fd, 0};
+        struct bc_prefetch_req* req = NULL;
+
+        bc_lock(&prefetch_mutex);
+        while ((req = bc_dlist_search_and_remove(prefetch_list, &search_req, _comp_prefetch_req)) != NULL) {
+            atom_unref(req->path);
+            free(req);
         }
+        while (prefetch_fd == fd) {
+            pthread_cond_wait(&prefetch_idle_cond, &prefetch_mutex);
+        }
+        bc_unlock(&prefetch_mutex);
+
         if (fd >= 0) io_close(fd);
     }
 
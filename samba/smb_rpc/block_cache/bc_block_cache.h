@@ -3,7 +3,14 @@
 
 /*
  * block_status:
- * 0: invalid, 1: locked, 2: valid, 3: freed, 4: destroyed
+ * 0: invalid, 1: locked (being filled, by a reader or by read-ahead),
+ * 2: valid, 3: freed, 4: destroyed
+ *
+ * Valid blocks stay in the hash until the CLOCK of the free block list
+ * reuses them; referenced is set each time a block is read and gives it
+ * one more sweep of the clock. pins counts the references handed out by
+ * bc_read_ref() and not yet released; the clock skips a pinned block.
+ * Both pins and the block's identity are guarded by its hash shard.
  */
 struct bc_block {
     volatile int block_status;
@@ -12,6 +19,8 @@ struct bc_block {
     off_t offset;
     int block_size_only;
     int data_len;
+    volatile int referenced;
+    int pins;
     char data[1];
 };
 
@@ -340,6 +340,7 @@ void* bc_dlist_search_and_remove(void* list, void* org, bc_comp_fun fun)
             pnode->next->prev = pnode->prev;
             pnode->prev = pnode->next = NULL;
             plist->count--;
+            free(pnode);
         }
         break;
     }
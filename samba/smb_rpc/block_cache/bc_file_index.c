@@ -10,9 +10,11 @@
 
 #include "atom_strdup.h"
 #include "bc_dlist.h"
+#include "bc_file_index.h"
 
 static void* file_index_list = NULL;
-static int handles[1024] = {-1};
+static int handles[BC_MAX_HANDLES] = {-1};
+static pthread_mutex_t handles_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 int bc_file_index_list_init(void)
 {
@@ -42,25 +44,34 @@ int bc_file_index_list_count(void)
 int bc_file_index_new_handle(void)
 {
     int i = 0;
+    bc_lock(&handles_mutex);
     for (i = 0; i < sizeof(handles) / sizeof(handles[0]); i++) {
         if (handles[i] == -1) {
-            handles[i] = 10000 + i;
+            handles[i] = BC_FIRST_HANDLE + i;
+            bc_unlock(&handles_mutex);
             return handles[i];
         }
     }
+    bc_unlock(&handles_mutex);
     return -1;
 }
 
 int bc_file_index_remove_handle(int handle)
 {
-    int i = 0;
-    for (i = 0; i < sizeof(handles) / sizeof(handles[0]); i++) {
-        if (handles[i] == handle) {
-            handles[i] = -1;
-            return 0;
-        }
-    }
-    return -1;
+    int i = bc_file_index_handle_slot(handle);
+    if (i < 0) return -1;
+    bc_lock(&handles_mutex);
+    handles[i] = -1;
+    bc_unlock(&handles_mutex);
+    return 0;
+}
+
+/* index of |handle| in the handle table, -1 if it is not open */
+int bc_file_index_handle_slot(int handle)
+{
+    int i = handle - BC_FIRST_HANDLE;
+    if (i < 0 || i >= BC_MAX_HANDLES || handles[i] != handle) return -1;
+    return i;
 }
 
 struct bc_file_index {
@@ -235,6 +246,21 @@ struct handle_pos_map {
     off_t pos;
 };
 
+/* handle -> file index, so that bc_read finds its file without a search */
+struct handle_slot {
+    struct bc_file_index* pindex;
+    struct handle_pos_map* phandle;
+};
+
+static struct handle_slot handle_table[BC_MAX_HANDLES];
+
+static struct handle_slot* _get_handle_slot(int handle)
+{
+    int i = bc_file_index_handle_slot(handle);
+    if (i < 0 || handle_table[i].pindex == NULL) return NULL;
+    return &handle_table[i];
+}
+
 /* handle */
 int bc_file_index_list_add_handle(const char* path, int fd, int handle, off_t size)
 {
@@ -291,6 +317,14 @@ int bc_file_index_list_add_handle(const char* path, int fd, int handle, off_t si
         return -1;
     }
 
+    {
+        int i = bc_file_index_handle_slot(handle);
+        if (i >= 0) {
+            handle_table[i].pindex = pindex;
+            handle_table[i].phandle = phandle;
+        }
+    }
+
     return 0;
 }
 
@@ -337,6 +371,14 @@ int bc_file_index_list_remove_handle(const char* path, int fd, int handle)
     if (phandle && phandle->handle != handle) {
         LOG("handle %d not removed (%d)\n", handle, phandle->handle);
     }
+    if (phandle) {
+        int i = bc_file_index_handle_slot(handle);
+        if (i >= 0) {
+            handle_table[i].pindex = NULL;
+            handle_table[i].phandle = NULL;
+        }
+        free(phandle);
+    }
 
     /* ?? */
     if (bc_dlist_count(pindex->offset_list) == 0 &&
@@ -381,29 +423,11 @@ int bc_file_index_list_print(void)
     return 0;
 }
 
-static int _file_index_comp_handle(void* data1, void* data2)
-{
-    struct bc_file_index* pindex = (struct bc_file_index*)data1;
-#if 0
-    struct handle_pos_map* phandle = (struct handle_pos_map*)data2;
-
-    if (phandle == NULL || phandle->handle < 0) return -1;
-
-    if (bc_dlist_search(pindex->handle_list, (void*)phandle->handle, _comp_handle) == NULL) return -1;
-#else
-    int handle = (int)data2;
-
-    if (bc_dlist_search(pindex->handle_list, (void*)handle, _comp_handle) == NULL) return -1;
-#endif
-
-    return 0;
-}
-
 int bc_file_index_list_search_fd_by_handle(int handle)
 {
-    struct bc_file_index* findex1 = bc_dlist_search(file_index_list, (void*)handle, _file_index_comp_handle);
-    if (findex1 == NULL) return -1;
-    return findex1->fd;
+    struct handle_slot* slot = _get_handle_slot(handle);
+    if (slot == NULL) return -1;
+    return slot->pindex->fd;
 }
 
 static int _comp_path(void* data1, void* data2)
@@ -428,9 +452,9 @@ int bc_file_index_list_search_fd_by_path(const char* path)
 
 char* bc_file_index_list_search_path_by_handle(int handle)
 {
-    struct bc_file_index* findex1 = bc_dlist_search(file_index_list, (void*)handle, _file_index_comp_handle);
-    if (findex1 == NULL) return NULL;
-    return findex1->path;
+    struct handle_slot* slot = _get_handle_slot(handle);
+    if (slot == NULL) return NULL;
+    return slot->pindex->path;
 }
 
 static int _comp_fd(void* data1, void* data2)
@@ -466,59 +490,45 @@ char* bc_file_index_list_search_path_by_fd(int fd)
 
 int bc_file_index_list_search_handle_info_by_handle(int handle, char* path, int* fd, off_t *fd_pos, off_t* size, off_t *handle_pos)
 {
-    struct bc_file_index* findex1 = bc_dlist_search(file_index_list, (void*)handle, _file_index_comp_handle);
-    struct handle_pos_map* phandle = NULL;
-
-    if (findex1 == NULL) return -1;
+    struct handle_slot* slot = _get_handle_slot(handle);
 
-    if (fd) *fd = findex1->fd;
-    if (path) strcpy(path, findex1->path);
-    if (fd_pos) *fd_pos = findex1->pos;
-    if (size) *size = findex1->size;
+    if (slot == NULL) return -1;
 
-    if (handle_pos) {
-        phandle = bc_dlist_search(findex1->handle_list, (void*)handle, _comp_handle);
-        if (phandle == NULL) return -1;
-        *handle_pos = phandle->pos;
-    }
+    if (fd) *fd = slot->pindex->fd;
+    if (path) strcpy(path, slot->pindex->path);
+    if (fd_pos) *fd_pos = slot->pindex->pos;
+    if (size) *size = slot->pindex->size;
+    if (handle_pos) *handle_pos = slot->phandle->pos;
 
     return 0;
 }
 
 off_t bc_file_index_list_get_handle_pos_by_handle(int handle)
 {
-    struct bc_file_index* findex1 = bc_dlist_search(file_index_list, (void*)handle, _file_index_comp_handle);
-    struct handle_pos_map* phandle = NULL;
-
-    if (findex1 == NULL) return -1;
+    struct handle_slot* slot = _get_handle_slot(handle);
 
-    phandle = bc_dlist_search(findex1->handle_list, (void*)handle, _comp_handle);
-    if (phandle == NULL) return -1;
+    if (slot == NULL) return -1;
 
-    return phandle->pos;
+    return slot->phandle->pos;
 }
 
 off_t bc_file_index_list_update_handle_pos_by_handle(int handle, off_t pos)
 {
-    struct bc_file_index* findex1 = bc_dlist_search(file_index_list, (void*)handle, _file_index_comp_handle);
-    struct handle_pos_map* phandle = NULL;
-
-    if (findex1 == NULL) return -1;
+    struct handle_slot* slot = _get_handle_slot(handle);
 
-    phandle = bc_dlist_search(findex1->handle_list, (void*)handle, _comp_handle);
-    if (phandle == NULL) return -1;
-    phandle->pos = pos;
+    if (slot == NULL) return -1;
+    slot->phandle->pos = pos;
 
     return pos;
 }
 
 off_t bc_file_index_list_update_fd_pos_by_handle(int handle, off_t pos)
 {
-    struct bc_file_index* findex1 = bc_dlist_search(file_index_list, (void*)handle, _file_index_comp_handle);
+    struct handle_slot* slot = _get_handle_slot(handle);
 
-    if (findex1 == NULL) return -1;
+    if (slot == NULL) return -1;
 
-    findex1->pos = pos;
+    slot->pindex->pos = pos;
 
     return pos;
 }
@@ -1,12 +1,17 @@
 #ifndef _BLOCK_CACHE_FILE_INDEX_H_
 #define _BLOCK_CACHE_FILE_INDEX_H_
 
+/* handles are BC_FIRST_HANDLE + their index in the handle table */
+#define BC_FIRST_HANDLE 10000
+#define BC_MAX_HANDLES 1024
+
 extern int bc_file_index_list_init(void);
 extern int bc_file_index_list_deinit(void);
 extern int bc_file_index_list_count(void);
 
 extern int bc_file_index_new_handle(void);
 extern int bc_file_index_remove_handle(int handle);
+extern int bc_file_index_handle_slot(int handle);
 
 extern int bc_file_index_list_add_offset(const char* path, int fd, off_t offset);
 extern int bc_file_index_list_remove_offset(const char* path, int fd, off_t offset);
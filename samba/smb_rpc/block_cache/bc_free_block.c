@@ -12,141 +12,97 @@
 #include "bc_dlist.h"
 
 #include "bc_block_cache.h"
-
-static void* free_block_list = NULL;
+#include "bc_free_block.h"
+
+/*
+ * All the blocks of the cache, reused in CLOCK order: the hand sweeps over
+ * them, giving a block read since the last sweep (referenced) another turn
+ * and offering the others to the caller's eviction function.
+ */
+static struct bc_block** blocks = NULL;
+static int block_count = 0;
+static int block_max = 0;
+static int clock_hand = 0;
+static pthread_mutex_t clock_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 int bc_free_block_list_init(void)
 {
-    if (free_block_list) return 0;
-
-    free_block_list = bc_dlist_create();
-    if (free_block_list == NULL) {
-        return -1;
-    }
-
     return 0;
 }
 
 int bc_free_block_list_deinit(void)
 {
-    return bc_dlist_destroy(free_block_list);
-}
-
-int bc_free_block_list_count(void)
-{
-    if (free_block_list == NULL) return -1;
-    return bc_dlist_count(free_block_list);
-}
-
-int bc_free_block_list_add_head(void* block)
-{
-    return bc_dlist_add_head(free_block_list, block);
-}
+    int i = 0;
 
-int bc_free_block_list_add_tail(void* block)
-{
-    return bc_dlist_add_tail(free_block_list, block);
-}
+    bc_lock(&clock_mutex);
+    for (i = 0; i < block_count; i++) {
+        if (blocks[i]->path) atom_unref(blocks[i]->path);
+        free(blocks[i]);
+    }
+    free(blocks);
+    blocks = NULL;
+    block_count = block_max = clock_hand = 0;
+    bc_unlock(&clock_mutex);
 
-void* bc_free_block_list_remove_head(void)
-{
-    return bc_dlist_remove_head(free_block_list);
+    return 0;
 }
 
-void* bc_free_block_list_remove_tail(void)
+int bc_free_block_list_count(void)
 {
-    return bc_dlist_remove_tail(free_block_list);
+    return block_count;
 }
 
-static int _comp_block(void* data1, void* data2)
+int bc_free_block_list_add(void* block)
 {
-    struct bc_block* b1 = (struct bc_block*)data1;
-    struct bc_block* b2 = (struct bc_block*)data2;
-    if (b1 == NULL || b2 == NULL) return -1;
-    if (b1->path == NULL || b2->path == NULL) return -1;
-
-    if (b1->offset != b2->offset ||
-        (b1->path != b2->path && strcmp(b1->path, b2->path) != 0)) {
-        return -1;
+    if (block == NULL) return -1;
+
+    bc_lock(&clock_mutex);
+    if (block_count == block_max) {
+        int nmax = block_max ? block_max * 2 : 16;
+        struct bc_block** nblocks = realloc(blocks, nmax * sizeof(*nblocks));
+        if (nblocks == NULL) {
+            bc_unlock(&clock_mutex);
+            return -1;
+        }
+        blocks = nblocks;
+        block_max = nmax;
     }
+    blocks[block_count++] = (struct bc_block*)block;
+    bc_unlock(&clock_mutex);
+
     return 0;
 }
 
-void* bc_free_block_list_remove_by_block(void* block)
+void* bc_free_block_list_get(bc_evict_fun fun)
 {
-    void* data = bc_dlist_remove_by_data(free_block_list, block);
-    if (data) return data;
-    return bc_dlist_search_and_remove(free_block_list, block, _comp_block);
-}
+    struct bc_block* victim = NULL;
+    int i = 0;
 
-static void _print_block(void* data)
-{
-    struct bc_block* pblock = (struct bc_block*)data;
-    if (pblock) {
-        printf("-> status: %d, size: %d, len: %d, offset: %lld, path: %s", pblock->block_status, pblock->block_size_only, pblock->data_len, pblock->offset, pblock->path);
+    bc_lock(&clock_mutex);
+    /* two sweeps: the first may only clear the referenced marks */
+    for (i = 0; i < 2 * block_count && victim == NULL; i++) {
+        struct bc_block* block = blocks[clock_hand];
+
+        clock_hand = (clock_hand + 1) % block_count;
+        if (block->referenced) {
+            block->referenced = 0;
+            continue;
+        }
+        if (fun(block) == 0) victim = block;
     }
-}
+    bc_unlock(&clock_mutex);
 
-int bc_free_block_list_print(void)
-{
-    printf ("==== free_block_list count: %d\n", bc_dlist_count(free_block_list));
-    bc_dlist_print(free_block_list, _print_block);
-    return 0;
+    return victim;
 }
 
-#if 0 /* for tesing only */
-int main(void)
+int bc_free_block_list_print(void)
 {
     int i = 0;
-    struct bc_block* pblock = NULL;
-
-    struct bc_block bc1 = {0, "smb://192.168.1.25/video/1.avi", (off_t)9876543210LL, 65534, 655};
-    struct bc_block bc2 = {0, "smb://192.168.1.25/video/1.avi", (off_t)0, 65534, 65534};
-    struct bc_block bc3 = {0, "smb://192.168.1.25/video/1.avi", (off_t)65534000, 65534, 65534};
-    struct bc_block bc4 = {0, "smb://192.168.1.21/usrs/dj/test/media/video/authentication/case101.mpg", (off_t)6553400, 65534, 65534};
-
-    struct bc_block bc_i[10] = {{0},};
 
-    bc_free_block_list_init();
-
-    bc_free_block_list_add_head(&bc1);
-    bc_free_block_list_add_tail(&bc2);
-
-    bc_free_block_list_add_head(&bc3);
-
-    for (i = 0; i < 10; i++) {
-        bc_i[i] = bc4;
-        bc_i[i].offset += i * 65534;
-        bc_free_block_list_add_head(&bc_i[i]);
-    }
-
-    bc_free_block_list_print();
-
-    i = 0;
-    pblock = bc_free_block_list_remove_by_block(&bc4);
-    LOG("%d, remove by block 0x%08x, %lld, %s\n", i++, (int)pblock, pblock ? pblock->offset : (off_t)-1, pblock ? pblock->path : "");
-
-    pblock = bc_free_block_list_remove_tail();
-    LOG("%d, remove tail 0x%08x, %lld, %s\n", i++, (int)pblock, pblock ? pblock->offset : (off_t)-1, pblock ? pblock->path : "");
-    pblock = bc_free_block_list_remove_head();
-    LOG("%d, remove head 0x%08x, %lld, %s\n", i++, (int)pblock, pblock ? pblock->offset : (off_t)-1, pblock ? pblock->path : "");
-    pblock = bc_free_block_list_remove_head();
-    LOG("%d, remove head 0x%08x, %lld, %s\n", i++, (int)pblock, pblock ? pblock->offset : (off_t)-1, pblock ? pblock->path : "");
-    pblock = bc_free_block_list_remove_tail();
-    LOG("%d, remove tail 0x%08x, %lld, %s\n", i++, (int)pblock, pblock ? pblock->offset : (off_t)-1, pblock ? pblock->path : "");
-    pblock = bc_free_block_list_remove_head();
-    LOG("%d, remove head 0x%08x, %lld, %s\n", i++, (int)pblock, pblock ? pblock->offset : (off_t)-1, pblock ? pblock->path : "");
-
-    while ((pblock = bc_free_block_list_remove_tail()) != NULL) {
-        LOG("%d, remove block 0x%08x, %lld, %s\n", i++, (int)pblock, pblock ? pblock->offset : (off_t)-1, pblock ? pblock->path : "");
+    printf ("==== free_block_list count: %d, hand: %d\n", block_count, clock_hand);
+    for (i = 0; i < block_count; i++) {
+        struct bc_block* pblock = blocks[i];
+        printf("-> status: %d, ref: %d, size: %d, len: %d, offset: %lld, path: %s\n", pblock->block_status, pblock->referenced, pblock->block_size_only, pblock->data_len, pblock->offset, pblock->path);
     }
-
-    //bc_free_block_list_remove_head();
-
-    LOG("deinit rc %d\n", bc_free_block_list_deinit());
-
     return 0;
 }
-
-#endif
-
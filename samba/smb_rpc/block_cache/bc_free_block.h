@@ -1,15 +1,14 @@
 #ifndef _BLOCK_CACHE_FREE_BLOCK_H_
 #define _BLOCK_CACHE_FREE_BLOCK_H_
 
+/* returns 0 if |block| was taken for reuse */
+typedef int (*bc_evict_fun)(void* block);
+
 extern int bc_free_block_list_init(void);
 extern int bc_free_block_list_deinit(void);
 extern int bc_free_block_list_count(void);
-extern int bc_free_block_list_add_head(void* block);
-extern int bc_free_block_list_add_tail(void* block);
-extern void* bc_free_block_list_remove_head(void);
-extern void* bc_free_block_list_remove_tail(void);
-extern void* bc_free_block_list_remove_by_block(void* block);
+extern int bc_free_block_list_add(void* block);
+extern void* bc_free_block_list_get(bc_evict_fun fun);
 extern int bc_free_block_list_print(void);
 
 #endif /* _BLOCK_CACHE_FREE_BLOCK_H_ */
-
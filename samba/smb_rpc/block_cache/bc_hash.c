@@ -5,6 +5,7 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#include <time.h>
 #include <fcntl.h>
 #include <pthread.h>
 
@@ -13,12 +14,23 @@
 
 #include "bc_hash.h"
 
+/*
+ * The buckets are grouped in shards of BC_HASH_SHARDS, each with a lock
+ * for the callers to hold across a lookup and the use of what they found,
+ * and a condition to wait on changes of the shard's entries.
+ */
+struct bc_hash_shard {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+};
+
 struct bc_hash {
     int hsize;
     int count;
     hash_fun hfun;
     void* tag;
     struct bc_dlist** buckets;
+    struct bc_hash_shard shards[BC_HASH_SHARDS];
 };
 
 static int hsizes[] = {67, 257, 521, 1031, 2053, 4093 };
@@ -70,6 +82,11 @@ void* bc_hash_create(unsigned int hsize, void* tag, hash_fun fun)
             LOG("%d create dlist error\n", i);
         }
     }
+
+    for (i = 0; i < BC_HASH_SHARDS; i++) {
+        pthread_mutex_init(&phash->shards[i].mutex, NULL);
+        pthread_cond_init(&phash->shards[i].cond, NULL);
+    }
     return phash;
 }
 
@@ -87,6 +104,11 @@ int bc_hash_destroy (void* hash)
         phash->buckets[i] = NULL;
     }
 
+    for (i = 0; i < BC_HASH_SHARDS; i++) {
+        pthread_mutex_destroy(&phash->shards[i].mutex);
+        pthread_cond_destroy(&phash->shards[i].cond);
+    }
+
     free(phash->buckets);
     free(phash);
 
@@ -104,6 +126,54 @@ static struct bc_dlist* bc_hash_get_bucket(void* hash, void* data)
     return phash->buckets[hvalue];
 }
 
+int bc_hash_get_shard(void* hash, void* data)
+{
+    struct bc_hash* phash = (struct bc_hash*)hash;
+
+    if (phash == NULL || data == NULL) return -1;
+
+    return (phash->hfun(data) % phash->hsize) % BC_HASH_SHARDS;
+}
+
+int bc_hash_lock_shard(void* hash, int shard)
+{
+    struct bc_hash* phash = (struct bc_hash*)hash;
+    if (phash == NULL || shard < 0 || shard >= BC_HASH_SHARDS) return -1;
+    return pthread_mutex_lock(&phash->shards[shard].mutex);
+}
+
+int bc_hash_unlock_shard(void* hash, int shard)
+{
+    struct bc_hash* phash = (struct bc_hash*)hash;
+    if (phash == NULL || shard < 0 || shard >= BC_HASH_SHARDS) return -1;
+    return pthread_mutex_unlock(&phash->shards[shard].mutex);
+}
+
+/* the shard must be locked; returns 0 when woken up, ETIMEDOUT after |ms| */
+int bc_hash_wait_shard(void* hash, int shard, int ms)
+{
+    struct bc_hash* phash = (struct bc_hash*)hash;
+    struct timespec ts = {0, 0};
+
+    if (phash == NULL || shard < 0 || shard >= BC_HASH_SHARDS) return -1;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (ms % 1000) * 1000 * 1000;
+    if (ts.tv_nsec >= 1000 * 1000 * 1000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000 * 1000 * 1000;
+    }
+    return pthread_cond_timedwait(&phash->shards[shard].cond, &phash->shards[shard].mutex, &ts);
+}
+
+int bc_hash_wake_shard(void* hash, int shard)
+{
+    struct bc_hash* phash = (struct bc_hash*)hash;
+    if (phash == NULL || shard < 0 || shard >= BC_HASH_SHARDS) return -1;
+    return pthread_cond_broadcast(&phash->shards[shard].cond);
+}
+
 void* bc_hash_remove_by_data(void* hash, void *data)
 {
     if (data == NULL) return NULL;
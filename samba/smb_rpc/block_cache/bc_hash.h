@@ -1,11 +1,18 @@
 #ifndef _BLOCK_CACHE_HASH_H_
 #define _BLOCK_CACHE_HASH_H_
 
+#define BC_HASH_SHARDS 16
+
 typedef int (*hash_fun)(void* data);
 
 extern void* bc_hash_create(unsigned int hsize, void* tag, hash_fun fun);
 extern int bc_hash_destroy (void* hash);
 extern void* bc_hash_get_tag(void* hash);
+extern int bc_hash_get_shard(void* hash, void* data);
+extern int bc_hash_lock_shard(void* hash, int shard);
+extern int bc_hash_unlock_shard(void* hash, int shard);
+extern int bc_hash_wait_shard(void* hash, int shard, int ms);
+extern int bc_hash_wake_shard(void* hash, int shard);
 extern int bc_hash_add(void* hash, void *data);
 extern void* bc_hash_remove_by_data(void* hash, void *data);
 extern void* bc_hash_remove(void* hash, void *data, bc_comp_fun comp_fun);
@@ -7,13 +7,31 @@ typedef ssize_t (*_io_read)(int fd, void* buf, size_t count);
 typedef off_t (*_io_lseek)(int fd, off_t offset, int whence);
 typedef int (*_io_stat)(const char*, struct stat*);
 
+struct bc_stats {
+    unsigned int hits;       /* reads served from a cached block */
+    unsigned int misses;     /* reads that had to fill a block */
+    unsigned int waits;      /* reads that waited for a block being filled */
+    unsigned int evictions;  /* cached blocks reused for other data */
+    unsigned int prefetches; /* blocks filled by read-ahead */
+};
+
 extern int bc_init(int blocks_per_task, int block_size, int threshold_percent);
 extern int bc_set_io_fun(_io_open nio_open, _io_read nio_read, _io_lseek nio_lseek, _io_close nio_close, _io_stat nio_stat);
 
 extern int bc_open(const char* path, int flags, mode_t mode);
 extern int bc_read(int handle, void* buf, size_t count);
-extern int bc_lseek(int handle, off_t offset, int whence);
+/*
+ * As bc_read(), without the copy: *data points into the cached block, which
+ * stays valid, and is not evicted, until bc_read_release(*ref). Returns at
+ * most the bytes left in that block. Release every reference before
+ * bc_deinit().
+ */
+extern int bc_read_ref(int handle, size_t count, const void** data, void** ref);
+extern int bc_read_release(void* ref);
+extern off_t bc_lseek(int handle, off_t offset, int whence);
 extern int bc_close(int handle);
 
+extern int bc_get_stats(struct bc_stats* stats);
+
 #endif /* _BLOCK_CACHE_X_BLOCK_CACHE_H_ */
 
@@ -0,0 +1,642 @@
+/*
+ * sampling heap profiler
+ *
+ * The malloc hooks of net_memleak.c record every allocation with its
+ * backtrace, under one lock; that is too slow to leave running on a
+ * device in the field.  This records only about one allocation per
+ * NET_MEMLEAK_SAMPLE_RATE bytes allocated (a random, exponentially
+ * distributed interval, so that allocations of every size keep their
+ * chance of being seen), and keeps one set of counters per distinct
+ * call stack.  Allocations which are not sampled cost a thread local
+ * subtraction in malloc and an array lookup in free.
+ *
+ * Build with "make MEMLEAK_SAMPLE=true"; the library then replaces
+ * malloc and friends of every program linked with -lmemleak.  Sending
+ * NET_MEMLEAK_SAMPLE_SIGNAL (default SIGUSR2) to the process writes
+ * NET_MEMLEAK_SAMPLE_PATH.<pid>.<seq>.heap (default /tmp/heap_sample),
+ * in the heap profile format of gperftools, so that
+ *     pprof --text <program> <file>
+ * shows the estimated live bytes per call stack.  Comparing two dumps
+ * taken some time apart (pprof --base) shows what is leaking.
+ *
+ * Environment:
+ *     NET_MEMLEAK_SAMPLE_RATE    mean bytes between samples, 0 disables
+ *     NET_MEMLEAK_SAMPLE_PATH    dump file prefix
+ *     NET_MEMLEAK_SAMPLE_SIGNAL  signal number which dumps
+ */
+#ifdef NET_MEMLEAK_SAMPLE
+
+#ifdef NET_MEMLEAK_CK_ALL_MEMORY_HOOK
+#error "MEMLEAK_SAMPLE and MEMLEAK_HOOK can not be used together"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+#include <execinfo.h>
+
+#include "heap_sample.h"
+
+extern void* __libc_malloc (size_t);
+extern void* __libc_calloc (size_t, size_t);
+extern void* __libc_realloc (void*, size_t);
+extern void* __libc_memalign (size_t, size_t);
+extern void  __libc_free (void*);
+
+#define HS_DEFAULT_RATE     (512 * 1024)
+#define HS_DEFAULT_PATH     "/tmp/heap_sample"
+#define HS_MAX_DEPTH        16
+#define HS_STACK_SIZE       4096    /* distinct call stacks, power of 2 */
+#define HS_LIVE_SIZE        65536   /* sampled blocks not freed yet, power of 2 */
+#define HS_FILTER_SIZE      16384   /* power of 2 */
+#define HS_MAX_PROBE        64
+
+#define HS_EMPTY            ((uintptr_t)0)
+#define HS_DELETED          ((uintptr_t)1)
+
+#define HS_TLS __thread __attribute__ ((tls_model ("initial-exec")))
+
+typedef struct _HS_STACK
+{
+    volatile unsigned int       ui4_hash;   /* 0: free slot */
+    volatile int                i4_ready;
+    int                         i4_depth;
+    void*                       apv_pc[HS_MAX_DEPTH];
+    volatile unsigned long      ui4_alloc_cnt;
+    volatile unsigned long long ui8_alloc_size;
+    volatile unsigned long      ui4_live_cnt;
+    volatile unsigned long long ui8_live_size;
+} HS_STACK;
+
+typedef struct _HS_LIVE
+{
+    volatile uintptr_t ui_addr;
+    HS_STACK*          pt_stack;
+    size_t             z_size;
+} HS_LIVE;
+
+typedef struct _HS_THREAD
+{
+    long         i8_countdown;  /* bytes until the next sample */
+    unsigned int ui4_seed;      /* 0: not started yet */
+    int          i4_busy;       /* inside the profiler itself */
+} HS_THREAD;
+
+static volatile long i8_hs_rate = HS_DEFAULT_RATE;
+static int i4_hs_signal = SIGUSR2;
+static char as_hs_path[256] = HS_DEFAULT_PATH;
+static volatile unsigned int ui4_hs_seq = 0;
+
+static HS_STACK at_hs_stack[HS_STACK_SIZE];
+static HS_LIVE at_hs_live[HS_LIVE_SIZE];
+/* number of live samples per address hash: a zero tells free() quickly
+ * that the block was not sampled, without probing at_hs_live */
+static volatile unsigned short aui2_hs_filter[HS_FILTER_SIZE];
+static volatile unsigned int ui4_hs_live = 0;
+
+static HS_TLS HS_THREAD t_hs_thread;
+
+static unsigned int _hs_ptr_hash (const void *pv)
+{
+    uintptr_t ui = (uintptr_t)pv;
+
+    ui ^= ui >> 16;
+    return (unsigned int)ui * 0x45d9f3bU;
+}
+
+static unsigned int _hs_xorshift (unsigned int *pui4_seed)
+{
+    unsigned int x = *pui4_seed;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *pui4_seed = x;
+    return x;
+}
+
+/* exponentially distributed, with mean rate: -ln(u) * rate for u in (0, 1] */
+static long _hs_next_interval (unsigned int *pui4_seed, long rate)
+{
+    unsigned int r = _hs_xorshift (pui4_seed);
+    double d_log2;
+    double d_next;
+    int e;
+
+    if (rate <= 0)
+        return LONG_MAX;
+
+    /* log2 (r), with the mantissa taken as linear; close enough here */
+    for (e = 31; e > 0 && !(r & (1U << e)); e--)
+        ;
+    d_log2 = e + (r == 0 ? 0.0 : (double)(r - (1U << e)) / (double)(1U << e));
+
+    d_next = (32.0 - d_log2) * 0.69314718 * rate;
+    if (d_next < 1.0)
+        return 1;
+    if (d_next > 32.0 * rate)
+        return 32 * rate;
+    return (long)d_next;
+}
+
+#if defined (NET_MEMLEAK_SAMPLE_FP) && (defined (__i386__) || defined (__x86_64__))
+/* walk the frame pointers; all of the program must be built with
+ * -fno-omit-frame-pointer */
+#define HS_SKIP 2
+static int __attribute__ ((noinline)) _hs_backtrace (void **ppv_pc, int i4_max)
+{
+    void **ppv_fp = (void**)__builtin_frame_address (0);
+    int i4_depth = 0;
+
+    while (i4_depth < i4_max && ppv_fp != NULL)
+    {
+        void **ppv_next = (void**)ppv_fp[0];
+
+        ppv_pc[i4_depth++] = ppv_fp[1];
+        if (ppv_next <= ppv_fp ||
+            (char*)ppv_next - (char*)ppv_fp > 1024 * 1024 ||
+            ((uintptr_t)ppv_next & (sizeof (void*) - 1)) != 0)
+        {
+            break;
+        }
+        ppv_fp = ppv_next;
+    }
+    return i4_depth;
+}
+#else
+/* the unwind tables, which also work without frame pointers */
+#define HS_SKIP 3
+static int __attribute__ ((noinline)) _hs_backtrace (void **ppv_pc, int i4_max)
+{
+    return backtrace (ppv_pc, i4_max);
+}
+#endif
+
+/* find the counters of a call stack, or add them; lock free */
+static HS_STACK* _hs_stack_get (void **ppv_pc, int i4_depth)
+{
+    unsigned int h = 2166136261U;
+    unsigned int ui4_idx;
+    int i;
+
+    for (i = 0; i < i4_depth; i++)
+        h = (h ^ _hs_ptr_hash (ppv_pc[i])) * 16777619U;
+    if (h == 0)
+        h = 1;
+
+    ui4_idx = h;
+    for (i = 0; i < HS_STACK_SIZE; i++, ui4_idx++)
+    {
+        HS_STACK *pt_stack = &at_hs_stack[ui4_idx & (HS_STACK_SIZE - 1)];
+        unsigned int ui4_cur = pt_stack->ui4_hash;
+
+        if (ui4_cur == 0)
+        {
+            if (__sync_bool_compare_and_swap (&pt_stack->ui4_hash, 0, h))
+            {
+                pt_stack->i4_depth = i4_depth;
+                memcpy (pt_stack->apv_pc, ppv_pc, i4_depth * sizeof (void*));
+                __sync_synchronize ();
+                pt_stack->i4_ready = 1;
+                return pt_stack;
+            }
+            ui4_cur = pt_stack->ui4_hash;
+        }
+        if (ui4_cur == h)
+        {
+            while (!pt_stack->i4_ready)
+                __sync_synchronize ();  /* another thread is filling it */
+            if (pt_stack->i4_depth == i4_depth &&
+                memcmp (pt_stack->apv_pc, ppv_pc, i4_depth * sizeof (void*)) == 0)
+            {
+                return pt_stack;
+            }
+        }
+    }
+    return NULL; /* table full */
+}
+
+static void _hs_live_add (void *pv, HS_STACK *pt_stack, size_t z_size)
+{
+    unsigned int ui4_h = _hs_ptr_hash (pv);
+    unsigned int ui4_idx = ui4_h;
+    int i;
+
+    for (i = 0; i < HS_MAX_PROBE; i++, ui4_idx++)
+    {
+        HS_LIVE *pt_live = &at_hs_live[ui4_idx & (HS_LIVE_SIZE - 1)];
+        uintptr_t ui_cur = pt_live->ui_addr;
+
+        if ((ui_cur == HS_EMPTY || ui_cur == HS_DELETED) &&
+            __sync_bool_compare_and_swap (&pt_live->ui_addr, ui_cur, (uintptr_t)pv))
+        {
+            pt_live->pt_stack = pt_stack;
+            pt_live->z_size = z_size;
+            __sync_fetch_and_add (&pt_stack->ui4_live_cnt, 1);
+            __sync_fetch_and_add (&pt_stack->ui8_live_size, z_size);
+            __sync_fetch_and_add (&aui2_hs_filter[ui4_h & (HS_FILTER_SIZE - 1)], 1);
+            __sync_fetch_and_add (&ui4_hs_live, 1);
+            return;
+        }
+    }
+    /* too many live samples around; this one is only counted as allocated */
+}
+
+/* returns 1 if pv was a sampled block, with its call stack and size */
+static int _hs_live_remove (const void *pv, HS_STACK **ppt_stack, size_t *pz_size)
+{
+    unsigned int ui4_h = _hs_ptr_hash (pv);
+    unsigned int ui4_idx = ui4_h;
+    int i;
+
+    if (aui2_hs_filter[ui4_h & (HS_FILTER_SIZE - 1)] == 0)
+        return 0;
+
+    for (i = 0; i < HS_MAX_PROBE; i++, ui4_idx++)
+    {
+        HS_LIVE *pt_live = &at_hs_live[ui4_idx & (HS_LIVE_SIZE - 1)];
+        uintptr_t ui_cur = pt_live->ui_addr;
+
+        if (ui_cur == HS_EMPTY)
+            break;
+        if (ui_cur == (uintptr_t)pv)
+        {
+            HS_STACK *pt_stack = pt_live->pt_stack;
+            size_t z_size = pt_live->z_size;
+
+            /* read the entry before anybody may reuse it */
+            __sync_synchronize ();
+            pt_live->ui_addr = HS_DELETED;
+            __sync_fetch_and_sub (&pt_stack->ui4_live_cnt, 1);
+            __sync_fetch_and_sub (&pt_stack->ui8_live_size, z_size);
+            __sync_fetch_and_sub (&aui2_hs_filter[ui4_h & (HS_FILTER_SIZE - 1)], 1);
+            __sync_fetch_and_sub (&ui4_hs_live, 1);
+            if (ppt_stack != NULL)
+                *ppt_stack = pt_stack;
+            if (pz_size != NULL)
+                *pz_size = z_size;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* slow path of the allocation functions: take a sample, or start the
+ * sampling of a new thread */
+static void __attribute__ ((noinline)) _hs_sample (void *pv, size_t z_size)
+{
+    HS_THREAD *pt_thread = &t_hs_thread;
+    void *apv_pc[HS_MAX_DEPTH + HS_SKIP];
+    HS_STACK *pt_stack;
+    int i4_depth;
+
+    if (pt_thread->i4_busy)
+    {
+        /* allocation by backtrace () itself, not the program */
+        pt_thread->i8_countdown = 0;
+        return;
+    }
+    pt_thread->i4_busy = 1;
+
+    if (pt_thread->ui4_seed == 0)
+    {
+        /* new thread: just set up its first interval */
+        pt_thread->ui4_seed = (unsigned int)(uintptr_t)pt_thread ^ (unsigned int)time (NULL);
+        if (pt_thread->ui4_seed == 0)
+            pt_thread->ui4_seed = 1;
+        pt_thread->i8_countdown = _hs_next_interval (&pt_thread->ui4_seed, i8_hs_rate);
+        pt_thread->i4_busy = 0;
+        return;
+    }
+    pt_thread->i8_countdown = _hs_next_interval (&pt_thread->ui4_seed, i8_hs_rate);
+
+    i4_depth = _hs_backtrace (apv_pc, HS_MAX_DEPTH + HS_SKIP) - HS_SKIP;
+    if (i4_depth > 0)
+    {
+        pt_stack = _hs_stack_get (apv_pc + HS_SKIP, i4_depth);
+        if (pt_stack != NULL)
+        {
+            __sync_fetch_and_add (&pt_stack->ui4_alloc_cnt, 1);
+            __sync_fetch_and_add (&pt_stack->ui8_alloc_size, z_size);
+            _hs_live_add (pv, pt_stack, z_size);
+        }
+    }
+
+    pt_thread->i4_busy = 0;
+}
+
+#define HS_ACCOUNT(pv, z_size) \
+    do { \
+        if ((pv) != NULL && \
+            (t_hs_thread.i8_countdown -= (long)(z_size)) < 0) \
+        { \
+            _hs_sample ((pv), (z_size)); \
+        } \
+    } while (0)
+
+#define HS_FORGET(pv) \
+    do { \
+        if ((pv) != NULL && ui4_hs_live != 0) \
+            _hs_live_remove ((pv), NULL, NULL); \
+    } while (0)
+
+void* malloc (size_t z_size)
+{
+    void *pv = __libc_malloc (z_size);
+
+    HS_ACCOUNT (pv, z_size);
+    return pv;
+}
+
+void* calloc (size_t z_num, size_t z_size)
+{
+    void *pv = __libc_calloc (z_num, z_size);
+
+    /* no overflow, or it would have failed */
+    HS_ACCOUNT (pv, z_num * z_size);
+    return pv;
+}
+
+void* realloc (void *pv_old, size_t z_size)
+{
+    HS_STACK *pt_stack = NULL;
+    size_t z_old = 0;
+    int i4_sampled = 0;
+    void *pv;
+
+    /* forget the old block first: once freed, its address may be
+     * sampled again by another thread */
+    if (pv_old != NULL && ui4_hs_live != 0)
+        i4_sampled = _hs_live_remove (pv_old, &pt_stack, &z_old);
+
+    pv = __libc_realloc (pv_old, z_size);
+    if (pv == NULL && z_size != 0)
+    {
+        /* failed, pv_old is still there */
+        if (i4_sampled)
+            _hs_live_add (pv_old, pt_stack, z_old);
+        return NULL;
+    }
+
+    HS_ACCOUNT (pv, z_size);
+    return pv;
+}
+
+void free (void *pv)
+{
+    HS_FORGET (pv);
+    __libc_free (pv);
+}
+
+void* memalign (size_t z_align, size_t z_size)
+{
+    void *pv = __libc_memalign (z_align, z_size);
+
+    HS_ACCOUNT (pv, z_size);
+    return pv;
+}
+
+int posix_memalign (void **ppv, size_t z_align, size_t z_size)
+{
+    void *pv;
+
+    if (z_align < sizeof (void*) || (z_align & (z_align - 1)) != 0)
+        return EINVAL;
+    pv = __libc_memalign (z_align, z_size);
+    if (pv == NULL)
+        return ENOMEM;
+    HS_ACCOUNT (pv, z_size);
+    *ppv = pv;
+    return 0;
+}
+
+/*
+ * Dump, also from the signal handler: only async signal safe calls from
+ * here on, no stdio and no malloc.
+ */
+typedef struct _HS_OUT
+{
+    int  i4_fd;
+    int  i4_len;
+    char ac_buf[1024];
+} HS_OUT;
+
+static void _hs_flush (HS_OUT *pt_out)
+{
+    int i4_off = 0;
+
+    while (i4_off < pt_out->i4_len)
+    {
+        ssize_t i4_ret = write (pt_out->i4_fd, pt_out->ac_buf + i4_off, pt_out->i4_len - i4_off);
+
+        if (i4_ret < 0 && errno == EINTR)
+            continue;
+        if (i4_ret <= 0)
+            break;
+        i4_off += i4_ret;
+    }
+    pt_out->i4_len = 0;
+}
+
+static void _hs_put_str (HS_OUT *pt_out, const char *ps)
+{
+    while (*ps)
+    {
+        if (pt_out->i4_len == (int)sizeof (pt_out->ac_buf))
+            _hs_flush (pt_out);
+        pt_out->ac_buf[pt_out->i4_len++] = *ps++;
+    }
+}
+
+static char* _hs_fmt_dec (char *ps_end, unsigned long long ui8)
+{
+    *--ps_end = '\0';
+    do
+    {
+        *--ps_end = '0' + (char)(ui8 % 10);
+        ui8 /= 10;
+    } while (ui8 != 0);
+    return ps_end;
+}
+
+static void _hs_put_dec (HS_OUT *pt_out, unsigned long long ui8)
+{
+    char ac[24];
+
+    _hs_put_str (pt_out, _hs_fmt_dec (ac + sizeof (ac), ui8));
+}
+
+static void _hs_put_hex (HS_OUT *pt_out, uintptr_t ui)
+{
+    char ac[2 + 2 * sizeof (uintptr_t) + 1];
+    char *ps = ac + sizeof (ac);
+
+    *--ps = '\0';
+    do
+    {
+        *--ps = "0123456789abcdef"[ui & 0xf];
+        ui >>= 4;
+    } while (ui != 0);
+    *--ps = 'x';
+    *--ps = '0';
+    _hs_put_str (pt_out, ps);
+}
+
+static void _hs_put_counts (HS_OUT *pt_out,
+                            unsigned long long ui8_live_cnt,
+                            unsigned long long ui8_live_size,
+                            unsigned long long ui8_alloc_cnt,
+                            unsigned long long ui8_alloc_size)
+{
+    _hs_put_dec (pt_out, ui8_live_cnt);
+    _hs_put_str (pt_out, ": ");
+    _hs_put_dec (pt_out, ui8_live_size);
+    _hs_put_str (pt_out, " [");
+    _hs_put_dec (pt_out, ui8_alloc_cnt);
+    _hs_put_str (pt_out, ": ");
+    _hs_put_dec (pt_out, ui8_alloc_size);
+    _hs_put_str (pt_out, "] @");
+}
+
+int heap_sample_dump (const char *ps_path)
+{
+    unsigned long long ui8_live_cnt = 0, ui8_live_size = 0;
+    unsigned long long ui8_alloc_cnt = 0, ui8_alloc_size = 0;
+    char as_file[sizeof (as_hs_path) + 48];
+    HS_OUT t_out;
+    int i, j, fd;
+
+    if (ps_path == NULL)
+    {
+        /* <path>.<pid>.<seq>.heap */
+        char ac[24];
+        size_t z_len = strlen (as_hs_path);
+
+        memcpy (as_file, as_hs_path, z_len);
+        as_file[z_len++] = '.';
+        strcpy (as_file + z_len, _hs_fmt_dec (ac + sizeof (ac), (unsigned long long)getpid ()));
+        z_len = strlen (as_file);
+        as_file[z_len++] = '.';
+        strcpy (as_file + z_len, _hs_fmt_dec (ac + sizeof (ac), __sync_fetch_and_add (&ui4_hs_seq, 1)));
+        strcat (as_file, ".heap");
+        ps_path = as_file;
+    }
+
+    fd = open (ps_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return -1;
+    t_out.i4_fd = fd;
+    t_out.i4_len = 0;
+
+    for (i = 0; i < HS_STACK_SIZE; i++)
+    {
+        HS_STACK *pt_stack = &at_hs_stack[i];
+
+        if (!pt_stack->i4_ready)
+            continue;
+        ui8_live_cnt += pt_stack->ui4_live_cnt;
+        ui8_live_size += pt_stack->ui8_live_size;
+        ui8_alloc_cnt += pt_stack->ui4_alloc_cnt;
+        ui8_alloc_size += pt_stack->ui8_alloc_size;
+    }
+
+    _hs_put_str (&t_out, "heap profile: ");
+    _hs_put_counts (&t_out, ui8_live_cnt, ui8_live_size, ui8_alloc_cnt, ui8_alloc_size);
+    _hs_put_str (&t_out, " heap_v2/");
+    _hs_put_dec (&t_out, i8_hs_rate);
+    _hs_put_str (&t_out, "\n");
+
+    for (i = 0; i < HS_STACK_SIZE; i++)
+    {
+        HS_STACK *pt_stack = &at_hs_stack[i];
+
+        if (!pt_stack->i4_ready)
+            continue;
+        _hs_put_counts (&t_out, pt_stack->ui4_live_cnt, pt_stack->ui8_live_size,
+                        pt_stack->ui4_alloc_cnt, pt_stack->ui8_alloc_size);
+        for (j = 0; j < pt_stack->i4_depth; j++)
+        {
+            _hs_put_str (&t_out, " ");
+            _hs_put_hex (&t_out, (uintptr_t)pt_stack->apv_pc[j]);
+        }
+        _hs_put_str (&t_out, "\n");
+    }
+
+    /* for pprof to find the symbols */
+    _hs_put_str (&t_out, "\nMAPPED_LIBRARIES:\n");
+    _hs_flush (&t_out);
+    {
+        int i4_maps = open ("/proc/self/maps", O_RDONLY);
+
+        if (i4_maps >= 0)
+        {
+            ssize_t i4_ret;
+
+            while ((i4_ret = read (i4_maps, t_out.ac_buf, sizeof (t_out.ac_buf))) > 0 ||
+                   (i4_ret < 0 && errno == EINTR))
+            {
+                if (i4_ret < 0)
+                    continue;
+                t_out.i4_len = i4_ret;
+                _hs_flush (&t_out);
+            }
+            close (i4_maps);
+        }
+    }
+
+    close (fd);
+    return 0;
+}
+
+static void _hs_on_signal (int sig)
+{
+    int i4_errno = errno;
+
+    heap_sample_dump (NULL);
+    errno = i4_errno;
+    (void)sig;
+}
+
+static void __attribute__ ((constructor)) _hs_init (void)
+{
+    struct sigaction t_sa;
+    const char *ps;
+    void *apv_pc[4];
+
+    ps = getenv ("NET_MEMLEAK_SAMPLE_RATE");
+    if (ps != NULL)
+        i8_hs_rate = atol (ps);
+    ps = getenv ("NET_MEMLEAK_SAMPLE_PATH");
+    if (ps != NULL && *ps != '\0')
+    {
+        strncpy (as_hs_path, ps, sizeof (as_hs_path) - 1);
+        as_hs_path[sizeof (as_hs_path) - 1] = '\0';
+    }
+    ps = getenv ("NET_MEMLEAK_SAMPLE_SIGNAL");
+    if (ps != NULL)
+        i4_hs_signal = atoi (ps);
+
+    /* the first backtrace () loads libgcc_s, which allocates */
+    t_hs_thread.i4_busy = 1;
+    _hs_backtrace (apv_pc, 4);
+    t_hs_thread.i4_busy = 0;
+
+    if (i4_hs_signal > 0)
+    {
+        memset (&t_sa, 0, sizeof (t_sa));
+        t_sa.sa_handler = _hs_on_signal;
+        t_sa.sa_flags = SA_RESTART;
+        sigemptyset (&t_sa.sa_mask);
+        sigaction (i4_hs_signal, &t_sa, NULL);
+    }
+}
+
+#endif /* NET_MEMLEAK_SAMPLE */
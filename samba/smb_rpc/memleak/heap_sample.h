@@ -0,0 +1,16 @@
+#ifndef _HEAP_SAMPLE_H_
+#define _HEAP_SAMPLE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* write the sampled heap profile to ps_path, or to the default
+ * NET_MEMLEAK_SAMPLE_PATH.<pid>.<seq>.heap file if ps_path is NULL */
+extern int heap_sample_dump (const char *ps_path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HEAP_SAMPLE_H_ */
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "mw_common.h"
+
+extern int _mws_need_buf_size (const char* buf);
+
+/*
+ * Round trip latency of the mw server: forks N client processes that each
+ * issue M calls of a trivial service, as the UI processes do. With a depth,
+ * the calls go |depth| at a time, in one batch or pipelined.
+ *
+ * Usage: mw_bench [clients] [calls] [call|batch|pipe] [depth]
+ */
+
+#define MW_BENCH_FIELD_SEQ MW_FIELD_LONG_BGN + 1
+
+struct _MW_BENCH_RESULT {
+    int calls;
+    int errors;
+    long long total_us;
+    long long max_us;
+};
+
+static long long _now_us (void)
+{
+    struct timespec tp = {0, 0};
+    clock_gettime (CLOCK_MONOTONIC, &tp);
+    return (long long) tp.tv_sec * 1000000 + tp.tv_nsec / 1000;
+}
+
+static void* _srv_bench_echo (void* buf)
+{
+    return mws_return (0, buf);
+}
+
+#define MW_BENCH_DEPTH_MAX MWC_MAX_IN_FLIGHT
+
+/* issues |depth| calls; returns the number that failed */
+static int _bench_calls (int fd, const char* mode, int depth, char** bufs, char* batch, int seq)
+{
+    int ids[MW_BENCH_DEPTH_MAX];
+    char* reply = NULL;
+    int errors = 0;
+    int i = 0;
+
+    for (i = 0; i < depth; i++) {
+        int n = seq + i;
+        mw_memset (bufs[i]);
+        mw_append (bufs[i], MW_BENCH_FIELD_SEQ, (char*) &n, 0);
+    }
+
+    if (strcmp (mode, "batch") == 0) {
+        mw_memset (batch);
+        for (i = 0; i < depth; i++) {
+            if (mwc_batch_add (batch, "_bench_echo", bufs[i]) != 0) errors++;
+        }
+        if (mwc_call_batch (fd, batch, _mws_need_buf_size (batch), &reply, NULL) != 0) return depth;
+        for (i = 0; i < depth; i++) {
+            char* r = mwc_batch_reply (reply, i);
+            int rc = -1;
+            if (r == NULL || mw_get (r, 0, MW_FIELD_SYS_RETURN_CODE, (char*) &rc, NULL) != 0 || rc != 0) errors++;
+            mw_free (r);
+        }
+    } else if (strcmp (mode, "pipe") == 0) {
+        for (i = 0; i < depth; i++) {
+            ids[i] = mwc_send (fd, "_bench_echo", bufs[i], 256);
+        }
+        for (i = 0; i < depth; i++) {
+            int n = -1;
+            if (ids[i] < 0 || mwc_recv (fd, ids[i], &reply, NULL) != 0) {
+                errors++;
+                continue;
+            }
+            if (mw_get (reply, 0, MW_BENCH_FIELD_SEQ, (char*) &n, NULL) != 0 || n != seq + i) errors++;
+            mw_free (reply);
+        }
+    } else {
+        for (i = 0; i < depth; i++) {
+            if (mwc_call (fd, "_bench_echo", bufs[i], 256, NULL, NULL) != 0) errors++;
+        }
+    }
+
+    return errors;
+}
+
+static void _bench_client (const char* path, int calls, const char* mode, int depth, int wfd)
+{
+    struct _MW_BENCH_RESULT result = {0, 0, 0, 0};
+    char* bufs[MW_BENCH_DEPTH_MAX];
+    char* batch = NULL;
+    int fd = -1;
+    int i = 0;
+
+    fd = mwc_open (path);
+    for (i = 0; i < depth; i++) {
+        bufs[i] = mw_alloc (256);
+    }
+    batch = mw_alloc (depth * 264 + 256);
+    if (fd < 0 || batch == NULL) {
+        result.errors = calls;
+        write (wfd, &result, sizeof(result));
+        return;
+    }
+
+    for (i = 0; i + depth <= calls; i += depth) {
+        long long t = _now_us ();
+        result.errors += _bench_calls (fd, mode, depth, bufs, batch, i);
+        t = (_now_us () - t) / depth;
+        result.calls += depth;
+        result.total_us += t * depth;
+        if (t > result.max_us) result.max_us = t;
+    }
+
+    for (i = 0; i < depth; i++) {
+        mw_free (bufs[i]);
+    }
+    mw_free (batch);
+    mwc_close (fd);
+    write (wfd, &result, sizeof(result));
+}
+
+int main (int argc, char** argv)
+{
+    struct _MW_BENCH_RESULT total = {0, 0, 0, 0};
+    char path[128] = "";
+    int clients = argc > 1 ? atoi (argv[1]) : 8;
+    int calls = argc > 2 ? atoi (argv[2]) : 10000;
+    const char* mode = argc > 3 ? argv[3] : "call";
+    int depth = argc > 4 ? atoi (argv[4]) : 1;
+    int pfd[2] = {-1, -1};
+    long long t = 0;
+    int fd = -1;
+    int i = 0;
+
+    if (depth < 1) depth = 1;
+    if (depth > MW_BENCH_DEPTH_MAX) depth = MW_BENCH_DEPTH_MAX;
+
+    sprintf (path, "/tmp/mw_bench_%u", getpid ());
+    unlink (path);
+
+    fd = mws_open (path);
+    if (fd < 0 || mws_reg_service (fd, "_bench_echo", _srv_bench_echo, NULL) != 0) {
+        fprintf (stderr, "open mws %s error, %d, %s\n", path, errno, strerror (errno));
+        return -1;
+    }
+    if (pipe (pfd) != 0) return -1;
+
+    t = _now_us ();
+    for (i = 0; i < clients; i++) {
+        if (fork () == 0) {
+            close (pfd[0]);
+            _bench_client (path, calls, mode, depth, pfd[1]);
+            _exit (0);
+        }
+    }
+    close (pfd[1]);
+
+    for (i = 0; i < clients; i++) {
+        struct _MW_BENCH_RESULT result;
+        if (read (pfd[0], &result, sizeof(result)) != sizeof(result)) break;
+        total.calls += result.calls;
+        total.errors += result.errors;
+        total.total_us += result.total_us;
+        if (result.max_us > total.max_us) total.max_us = result.max_us;
+    }
+    while (wait (NULL) > 0);
+    t = _now_us () - t;
+
+    printf ("%s x%d, clients: %d, calls: %d, errors: %d, avg: %lld us, max: %lld us, %lld calls/s\n",
+            mode, depth, clients, total.calls, total.errors,
+            total.calls ? total.total_us / total.calls : 0, total.max_us,
+            t > 0 ? (long long) total.calls * 1000000 / t : 0);
+
+    mws_close (path);
+    unlink (path);
+
+    return 0;
+}
@@ -24,6 +24,15 @@ extern int _get_ms (void);
 struct _MW_CLIENT {
     int fd;
     char* path;
+    int next_id;
+    int in_flight;      /* requests sent by mwc_send, not read yet */
+    handle_t h_replies; /* replies read ahead of their mwc_recv */
+};
+
+struct _MW_REPLY {
+    int id;
+    char* buf;
+    int size;
 };
 
 static handle_t h_mwc_list = null_handle;
@@ -94,6 +103,7 @@ int mwc_open (const char* path)
 
     pmwc->fd = fd;
     pmwc->path = strdup (path);
+    my_list_create (&pmwc->h_replies);
 
     my_list_add_tail (h_mwc_list, pmwc);
 
@@ -110,6 +120,13 @@ int mwc_close (int fd)
     pdata = my_list_delete (h_mwc_list, h_clt);
     if (pdata)
     {
+        struct _MW_REPLY *preply = NULL;
+        while ((preply = my_list_delete_head (pdata->h_replies)) != NULL)
+        {
+            mw_free (preply->buf);
+            free (preply);
+        }
+        my_list_destroy (pdata->h_replies, NULL);
         close (pdata->fd);
         free (pdata->path);
         pdata->path = NULL;
@@ -129,39 +146,171 @@ int mwc_close (int fd)
 
 extern int mw_append (void* data, int field_id, const char* presult, int len);
 extern int mw_get (const void* data, int idx, int field_id, char* presult, int *size);
+extern int _mws_need_buf_size (const char* buf);
 #define MW_BIG_BUF_SIZE 262144
+#define MW_SMALL_BUF_SIZE 256
+
+/*
+ * Both buffers are kept across calls, under the client lock: the reply is
+ * handed to the caller, valid until the next call, and grown when a reply
+ * does not fit.
+ */
+static char* prbuf = NULL;
+static int prbuf_size = 0;
+static char* psbuf = NULL;
+
+static int _mwc_recv_all (int fd, char* buf, int len)
+{
+    int rlen = 0;
+    int rt1 = 0;
+
+    while (rlen < len)
+    {
+        if ((rt1 = recv (fd, buf + rlen, len - rlen, 0)) <= 0)
+        {
+            if (rt1 < 0 && errno == EINTR) continue;
+            PRINTF ("WARN: %d recv rc %d, %d, %s\n", fd, rt1, errno, strerror(errno));
+            return rt1;
+        }
+        rlen += rt1;
+    }
+
+    return rlen;
+}
+
+/*
+ * Reads one reply into *pbuf, growing it to fit. Returns its length, 0 if
+ * the server hung up, in which case the connection is closed, or -1.
+ */
+static int _mwc_read_reply (struct _MW_CLIENT* pmwc, char** pbuf, int* pcap)
+{
+    char rbuf[MW_FIRST_READ_SIZE] = "";
+    int* pi = NULL;
+    int nlen = 0;
+    int rlen = 0;
+
+    rlen = _mwc_recv_all (pmwc->fd, rbuf, MW_FIRST_READ_SIZE);
+    if (rlen <= 0)
+    {
+        if (rlen == 0) {
+            close (pmwc->fd);
+            pmwc->fd = -1;
+        }
+        PRINTF ("ERROR: %d recv msg %d, %s\n", pmwc->fd, errno, strerror(errno));
+        return rlen < 0 ? -1 : 0;
+    }
+
+    pi = (int*) rbuf;
+    if (htonl(*pi) != MW_FIELD_SYS_MAGIC_ID)
+    {
+        PRINTF ("recv unknown data\n");
+        return -1;
+    }
+    pi = (int*) (rbuf + 4);
+    nlen = ntohl (*pi);
+    if (nlen < MW_FIRST_READ_SIZE)
+    {
+        return -1;
+    }
+
+    if (*pcap < nlen)
+    {
+        free (*pbuf);
+        *pcap = 0;
+        if ((*pbuf = malloc (nlen)) == NULL)
+        {
+            PRINTF ("out of memory\n");
+            return -1;
+        }
+        *pcap = nlen;
+    }
+    /*memset (*pbuf, 0, *pcap);*/
+
+    memcpy (*pbuf, rbuf, MW_FIRST_READ_SIZE);
+
+    if (nlen > MW_FIRST_READ_SIZE)
+    {
+        rlen = _mwc_recv_all (pmwc->fd, *pbuf + MW_FIRST_READ_SIZE, nlen - MW_FIRST_READ_SIZE);
+        /*PRINTF (" >>>> recv %d-byte, need recv %d\n", rlen, nlen);*/
+        if (rlen <= 0) /* FIXME: =? */
+        {
+            if (rlen == 0) {
+                close (pmwc->fd);
+                pmwc->fd = -1;
+            }
+            return -1;
+        }
+    }
+
+    return nlen;
+}
+
+static int _mwc_send (struct _MW_CLIENT* pmwc, const char* name, char* snd_buf, int snd_size)
+{
+    int slen = 0;
+
+    if (mw_append (snd_buf, MW_FIELD_SYS_SERVICE_NAME, name, 63) != 0)
+    {
+        return -1;
+    }
+
+    slen = send (pmwc->fd, snd_buf, snd_size, MSG_NOSIGNAL);
+    if (slen <= 0)
+    {
+        PRINTF ("ERROR: %d send msg to '%s` %d, %s\n", pmwc->fd, name, errno, strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+static struct _MW_CLIENT* _get_clt_call (int fd)
+{
+    handle_t h_clt = _get_clt (fd);
+
+    if (h_clt == null_handle)
+    {
+        PRINTF ("clt: 0x%08x, fd: %d\n", (int) h_clt, fd);
+        return NULL;
+    }
+
+    /* FIXME: may be comment */
+    if (my_list_search (h_mwc_list, h_clt) == NULL)
+    {
+        return NULL;
+    }
+
+    return (struct _MW_CLIENT*) h_clt;
+}
+
 int mwc_call (int fd, const char* name, char* snd_buf, int snd_size, char** pp_rcv_buf, int* p_rcv_size)
 {
     struct _MW_CLIENT* pmwc = NULL;
-    int snd_buf_need_free = 0;
-    int slen = 0;
     int rc = -1;
 
     mwc_lock ();
 
     do {
-        handle_t h_clt = _get_clt (fd);
-
-        pmwc = (struct _MW_CLIENT*) h_clt;
-        /*PRINTF ("call service '%s`, hdl: 0x%08x\n", name, (int) h_clt);*/
+        int nlen = 0;
 
-        if (h_clt == null_handle || name == NULL)
+        pmwc = name ? _get_clt_call (fd) : NULL;
+        /*PRINTF ("call service '%s`, clt: 0x%08x\n", name, (int) pmwc);*/
+        if (pmwc == NULL)
         {
-            PRINTF ("clt: 0x%08x, name: %s\n", (int) h_clt, name);
             break;
         }
 
-        /* FIXME: may be comment */
-        if (my_list_search (h_mwc_list, h_clt) == NULL)
+        if (pmwc->in_flight > 0)
         {
+            PRINTF ("'%s`: %d call(s) in flight on %d\n", name, pmwc->in_flight, fd);
             break;
         }
 
         if (snd_buf == NULL)
         {
-            snd_buf = mw_alloc (256);
-            snd_size = 256;
-            snd_buf_need_free = 1;
+            if (psbuf == NULL) psbuf = mw_alloc (MW_SMALL_BUF_SIZE);
+            snd_buf = mw_memset (psbuf);
+            snd_size = MW_SMALL_BUF_SIZE;
         }
 
         if (snd_buf == NULL)
@@ -169,114 +318,239 @@ int mwc_call (int fd, const char* name, char* snd_buf, int snd_size, char** pp_r
             break;
         }
 
-        if (mw_append (snd_buf, MW_FIELD_SYS_SERVICE_NAME, name, 63) != 0)
+        if (_mwc_send (pmwc, name, snd_buf, snd_size) != 0)
         {
             break;
         }
 
-        slen = send (pmwc->fd, snd_buf, snd_size, 0);
-        if (slen <= 0)
+        if (prbuf == NULL && (prbuf = malloc (MW_BIG_BUF_SIZE)) != NULL)
+        {
+            prbuf_size = MW_BIG_BUF_SIZE;
+        }
+
+        nlen = _mwc_read_reply (pmwc, &prbuf, &prbuf_size);
+        if (nlen <= 0)
+        {
+            if (nlen == 0) rc = 0;
+            break;
+        }
+        else if (nlen == MW_FIRST_READ_SIZE)
         {
-            PRINTF ("ERROR: %d send msg to '%s` %d, %s\n", pmwc->fd, name, errno, strerror(errno));
+            if (p_rcv_size) *p_rcv_size = 0;
+            rc = 0;
             break;
         }
 
+        rc = 0;
+        mw_get (prbuf, 0, MW_FIELD_SYS_RETURN_CODE, (char*) &rc, NULL);
+        if (pp_rcv_buf)
         {
-            int rlen = 0;
-            char rbuf[16] = "";
-            int* pi = NULL;
-            static char* prbuf = NULL;
-            int nlen = 0;
-
-            rlen = recv (pmwc->fd, rbuf, MW_FIRST_READ_SIZE, 0);
-            if (rlen <= 0)
-            {
-                if (rlen == 0) {
-                    rc = 0;
-                    close (pmwc->fd);
-                    pmwc->fd = -1;
-                }
-                PRINTF ("ERROR: %d recv msg %d, %s\n", pmwc->fd, errno, strerror(errno));
-                break;
-            }
+            *pp_rcv_buf = prbuf;
+            if (p_rcv_size) *p_rcv_size = nlen;
+        }
+    } while (0);
 
-            pi = (int*) rbuf;
-            if (htonl(*pi) != MW_FIELD_SYS_MAGIC_ID)
-            {
-                PRINTF ("recv unknown data\n");
-                break;
-            }
-            pi = (int*) (rbuf + 4);
-            nlen = ntohl (*pi);
-            if (nlen < MW_FIRST_READ_SIZE)
-            {
-                break;
-            }
-            else if (nlen == MW_FIRST_READ_SIZE)
-            {
-                if (p_rcv_size) *p_rcv_size = 0;
-                rc = 0;
-                break;
-            }
+    mwc_unlock ();
 
-            if (prbuf == NULL && (prbuf = malloc (MW_BIG_BUF_SIZE)) == NULL)
+    return rc;
+}
+
+int mwc_send (int fd, const char* name, char* snd_buf, int snd_size)
+{
+    struct _MW_CLIENT* pmwc = NULL;
+    int id = -1;
+
+    if (snd_buf == NULL) return -1;
+
+    mwc_lock ();
+
+    do {
+        pmwc = name ? _get_clt_call (fd) : NULL;
+        /*PRINTF ("call service '%s`, clt: 0x%08x\n", name, (int) pmwc);*/
+        if (pmwc == NULL)
+        {
+            break;
+        }
+
+        /* the server stops reading while its replies are not read */
+        if (pmwc->in_flight >= MWC_MAX_IN_FLIGHT)
+        {
+            PRINTF ("'%s`: too many calls in flight on %d\n", name, fd);
+            break;
+        }
+
+        if (++pmwc->next_id <= 0) pmwc->next_id = 1;
+        if (mw_append (snd_buf, MW_FIELD_SYS_REQUEST_ID, (char*) &pmwc->next_id, 0) != 0)
+        {
+            break;
+        }
+
+        if (_mwc_send (pmwc, name, snd_buf, snd_size) != 0)
+        {
+            break;
+        }
+
+        pmwc->in_flight++;
+        id = pmwc->next_id;
+    } while (0);
+
+    mwc_unlock ();
+
+    return id;
+}
+
+static int _cmp_reply_id (const void* pv1, const void* pv2)
+{
+    struct _MW_REPLY* preply = (struct _MW_REPLY*) pv1;
+    int id = (int) pv2;
+
+    if (preply == NULL) return -1;
+
+    if (id != preply->id) return 1;
+
+    return 0;
+}
+
+int mwc_recv (int fd, int id, char** pp_rcv_buf, int* p_rcv_size)
+{
+    struct _MW_CLIENT* pmwc = NULL;
+    struct _MW_REPLY* preply = NULL;
+    char* buf = NULL;
+    int nlen = -1;
+    int rc = -1;
+
+    if (pp_rcv_buf) *pp_rcv_buf = NULL;
+
+    mwc_lock ();
+
+    do {
+        pmwc = _get_clt_call (fd);
+        if (pmwc == NULL)
+        {
+            break;
+        }
+
+        preply = my_list_delete2 (pmwc->h_replies, (void*) id, _cmp_reply_id);
+        if (preply)
+        {
+            buf = preply->buf;
+            nlen = preply->size;
+            free (preply);
+            break;
+        }
+
+        /* replies come in the order of the requests, keep the others */
+        while (pmwc->in_flight > 0)
+        {
+            int cap = 0;
+            int rid = 0;
+
+            buf = NULL;
+            nlen = _mwc_read_reply (pmwc, &buf, &cap);
+            if (nlen <= 0)
             {
-                PRINTF ("out of memory\n");
+                free (buf);
+                buf = NULL;
+                pmwc->in_flight = 0;
                 break;
             }
-            /*memset (prbuf, 0, MW_BIG_BUF_SIZE);*/
+            pmwc->in_flight--;
 
-            memcpy (prbuf, rbuf, MW_FIRST_READ_SIZE);
+            mw_get (buf, 0, MW_FIELD_SYS_REQUEST_ID, (char*) &rid, NULL);
+            if (rid == id) break;
 
+            preply = malloc (sizeof(*preply));
+            if (preply == NULL || my_list_add_tail (pmwc->h_replies, preply) != 0)
+            {
+                free (preply);
+                mw_free (buf);
+            }
+            else
             {
-                int rt1 = 0;
-                /*rlen = MW_FIRST_READ_SIZE;*/
-                while (rlen < nlen)
-                {
-                    if ((rt1 = recv (pmwc->fd, prbuf + rlen, nlen - rlen, 0)) <= 0)
-                    {
-                        PRINTF ("WARN: %d recv rc %d, %d, %s\n", pmwc->fd, rt1, errno, strerror(errno));
-                        break;
-                    }
-                    rlen += rt1;
-                }
-                /*PRINTF (" >>>> recv %d-byte, need recv %d\n", rlen, nlen);*/
-                if (rt1 <= 0) /* FIXME: =? */
-                {
-                    if (rt1 == 0) {
-                        close (pmwc->fd);
-                        pmwc->fd = -1;
-                    }
-                    break;
-                }
-                rt1 = 0;
-                mw_get (prbuf, 0, MW_FIELD_SYS_RETURN_CODE, (char*) &rt1, NULL);
-                if (pp_rcv_buf)
-                {
-                    *pp_rcv_buf = prbuf;
-                    if (p_rcv_size) *p_rcv_size = nlen;
-                }
-                else
-                {
-                    free (prbuf);
-                    prbuf = NULL;
-                }
-
-                rc = rt1;
+                preply->id = rid;
+                preply->buf = buf;
+                preply->size = nlen;
             }
+            buf = NULL;
         }
     } while (0);
 
-    if (snd_buf_need_free) {
-        free (snd_buf);
-        snd_buf = NULL;
+    mwc_unlock ();
+
+    if (buf == NULL)
+    {
+        PRINTF ("no reply for request %d on %d\n", id, fd);
+        return -1;
     }
 
-    mwc_unlock ();
+    rc = 0;
+    mw_get (buf, 0, MW_FIELD_SYS_RETURN_CODE, (char*) &rc, NULL);
+    if (pp_rcv_buf)
+    {
+        *pp_rcv_buf = buf;
+        if (p_rcv_size) *p_rcv_size = nlen;
+    }
+    else
+    {
+        mw_free (buf);
+    }
 
     return rc;
 }
 
+int mwc_batch_add (void* batch, const char* name, char* req)
+{
+    if (batch == NULL || name == NULL || req == NULL) return -1;
+
+    if (mw_append (req, MW_FIELD_SYS_SERVICE_NAME, name, 63) != 0)
+    {
+        return -1;
+    }
+
+    return mw_append (batch, MW_FIELD_SYS_BATCH, req, _mws_need_buf_size (req));
+}
+
+int mwc_call_batch (int fd, char* batch, int size, char** pp_rcv_buf, int* p_rcv_size)
+{
+    if (batch == NULL) return -1;
+
+    return mwc_call (fd, MW_BATCH_SERVICE_NAME, batch, size, pp_rcv_buf, p_rcv_size);
+}
+
+void* mwc_batch_reply (const char* reply, int idx)
+{
+    char head[8] = "";
+    char* buf = NULL;
+    int size = sizeof(head);
+    int nlen = 0;
+
+    if (mw_get (reply, idx, MW_FIELD_SYS_BATCH, head, &size) != 0 || size < sizeof(head))
+    {
+        return NULL;
+    }
+
+    nlen = _mws_need_buf_size (head);
+    if (nlen < MW_FIRST_READ_SIZE)
+    {
+        return NULL;
+    }
+
+    buf = malloc (nlen);
+    if (buf == NULL)
+    {
+        return NULL;
+    }
+
+    size = nlen;
+    if (mw_get (reply, idx, MW_FIELD_SYS_BATCH, buf, &size) != 0 || size != nlen)
+    {
+        free (buf);
+        return NULL;
+    }
+
+    return buf;
+}
+
 extern int mw_lock_init(pthread_mutex_t* p_mutex);
 extern int mw_lock(pthread_mutex_t* p_mutex);
 extern int mw_unlock(pthread_mutex_t* p_mutex);
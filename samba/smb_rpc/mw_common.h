@@ -13,6 +13,8 @@ extern "C" {
 #define MW_FIELD_SYS_SERVICE_NAME 0x00010001
 #define MW_FIELD_SYS_RETURN_CODE  0x00010002
 #define MW_FIELD_SYS_DELAY_FREE   0x00010003
+#define MW_FIELD_SYS_REQUEST_ID   0x00010004
+#define MW_FIELD_SYS_BATCH        0x00010005
 
 /* 0x00010000 - 0x0001FFFF  system
  * 0x00100000 - 0x001FFFFF  long
@@ -21,6 +23,8 @@ extern "C" {
  *
  * 0x00010001 - service name
  * 0x00010002 - return code
+ * 0x00010004 - request id, echoed in the reply
+ * 0x00010005 - a whole request (or reply) of a batch, as data
  */
 #define MW_FIELD_LONG_BGN         0x00100000
 #define MW_FIELD_STR_BGN          0x00200000
@@ -28,6 +32,9 @@ extern "C" {
 
 #define MW_FIRST_READ_SIZE 16
 
+/* service name of a batch: its MW_FIELD_SYS_BATCH requests are served in order */
+#define MW_BATCH_SERVICE_NAME "_mw_batch"
+
 extern int mws_open (const char* path);
 extern int mws_close (const char* path);
 extern int mws_fd (const char* path);
@@ -49,6 +56,22 @@ extern int mwc_close (int fd);
 
 extern int mwc_call (int fd, const char* name, char* snd_buf, int snd_size, char** pp_rcv_buf, int* p_rcv_size);
 
+/* Pipelining: mwc_send returns the request id, or -1. Up to MWC_MAX_IN_FLIGHT
+ * calls may be pending on a connection; mwc_call fails while any is. mwc_recv
+ * returns the return code of call |id|, and its reply in *pp_rcv_buf, to be
+ * released with mw_free. */
+#define MWC_MAX_IN_FLIGHT 16
+extern int mwc_send (int fd, const char* name, char* snd_buf, int snd_size);
+extern int mwc_recv (int fd, int id, char** pp_rcv_buf, int* p_rcv_size);
+
+/* Batching: requests added to |batch| (from mw_alloc) are sent in a single
+ * frame by mwc_call_batch, and the server runs them all in one dispatch. The
+ * reply of request |idx| is copied out by mwc_batch_reply, to be released with
+ * mw_free; the return code of each is in its own reply. */
+extern int mwc_batch_add (void* batch, const char* name, char* req);
+extern int mwc_call_batch (int fd, char* batch, int size, char** pp_rcv_buf, int* p_rcv_size);
+extern void* mwc_batch_reply (const char* reply, int idx);
+
 extern int mwc_lock_init (void);
 extern int mwc_lock (void);
 extern int mwc_unlock (void);
@@ -12,6 +12,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <ctype.h>
+#include <sys/epoll.h>
 
 #if 0
 #include <linux/types.h>
@@ -93,13 +94,28 @@ void _prn_mem (const char* data, int len)
     fflush (stderr);
 }
 
+/*
+ * Request buffers are kept for reuse by the server thread, in size classes
+ * of MW_POOL_MIN_SIZE << n. Larger requests are allocated as they come.
+ */
+#define MW_POOL_CLASSES 8
+#define MW_POOL_DEPTH 8
+#define MW_POOL_MIN_SIZE 256
+
+struct _MW_BUF_POOL {
+    char* bufs[MW_POOL_CLASSES][MW_POOL_DEPTH];
+    int count[MW_POOL_CLASSES];
+};
+
 struct _MW_SERVER {
     char* path;
     int fd;
+    int epfd;
     handle_t h_mws_list;
     handle_t h_clt_list;
     pthread_t t_thread;
     int cleaned;
+    struct _MW_BUF_POOL pool;
 };
 
 struct _MW_SERVICE {
@@ -119,8 +135,16 @@ struct _MW_CLIENT_END {
     char* rbuf;
     int wlen;
     char* wbuf;
+    int wpos;       /* bytes of wbuf already sent */
+    int epfd;       /* epoll set of the server */
+    int wait_out;   /* registered for EPOLLOUT instead of EPOLLIN */
+    char* pbuf;     /* buffer taken from the pool, rbuf or wbuf */
+    int pcap;
+    struct _MW_BUF_POOL* pool;
 };
 
+#define MW_EPOLL_EVENTS 32
+
 #define MW_SERVER_MAX 64
 struct _MW_SERVER mws[MW_SERVER_MAX];
 /*static int _mws_inited = 0;*/
@@ -181,6 +205,7 @@ int mws_open (const char* path)
     memset(&mws[mwidx], 0, sizeof(mws[mwidx]));
     mws[mwidx].path = NULL;
     mws[mwidx].fd = -1;
+    mws[mwidx].epfd = -1;
     mws[mwidx].h_mws_list = null_handle;
     mws[mwidx].h_clt_list = null_handle;
     mws[mwidx].cleaned = 0;
@@ -251,7 +276,7 @@ int mws_open (const char* path)
 }
 
 int mws_unreg_services_all(int fd);
-static int _mws_clean_clts_all(handle_t h_clt_list);
+static void _mws_server_release(int mwidx);
 int mws_close(const char* path)
 {
     int fd = -1;
@@ -281,10 +306,7 @@ int mws_close(const char* path)
     }
 
     if (mws[mwidx].cleaned == 0) {
-        _mws_clean_clts_all(mws[mwidx].h_clt_list);
-        my_list_destroy(mws[mwidx].h_mws_list, NULL);
-        my_list_destroy(mws[mwidx].h_clt_list, NULL);
-        mws[mwidx].cleaned = 1;
+        _mws_server_release(mwidx);
     }
 
     mws[mwidx].path = NULL;
@@ -320,13 +342,6 @@ int mws_fd(const char* path)
     return fd;
 }
 
-struct _MW_SERVER_TAG {
-    int maxfd;
-    int basefd;
-    fd_set* prset;
-    fd_set* pwset;
-};
-
 extern int _mws_need_buf_size (const char* buf);
 /*#define MW_FIELD_SYS_SERVICE_NAME 0x00010001
 #define MW_FIELD_SYS_RETURN_CODE  0x00010002*/
@@ -379,93 +394,166 @@ void _prn_services (void)
     mws_unlock();
 }
 
-static int _rwset_apply (void* pv_data, void* pv_tag)
+static char* _mws_buf_get (struct _MW_BUF_POOL* pool, int size, int* pcap)
+{
+    int c = 0;
+
+    for (c = 0; c < MW_POOL_CLASSES; c++)
+    {
+        if ((MW_POOL_MIN_SIZE << c) >= size) break;
+    }
+    if (c >= MW_POOL_CLASSES)
+    {
+        *pcap = size;
+        return malloc (size);
+    }
+
+    *pcap = MW_POOL_MIN_SIZE << c;
+    if (pool->count[c] > 0)
+    {
+        return pool->bufs[c][--pool->count[c]];
+    }
+    return malloc (*pcap);
+}
+
+static void _mws_buf_put (struct _MW_BUF_POOL* pool, char* buf, int cap)
 {
-    struct _MW_CLIENT_END *pclt = (struct _MW_CLIENT_END*) pv_data;
-    struct _MW_SERVER_TAG *ptag = (struct _MW_SERVER_TAG*) pv_tag;
+    int c = 0;
 
-    if (pclt == NULL || ptag == NULL) return 0;
+    if (buf == NULL) return;
 
-    /* check if a same server */
-    if (pclt->sfd != ptag->basefd) return 0;
+    /* as mw_free, so that a stale pointer is not taken for a message */
+    *(int*) buf = 0;
 
-    if ((pclt->wlen > 0) ||
-        (pclt->rlen > 0 && pclt->rlen == _mws_need_buf_size (pclt->rbuf))) /* prevent blocking */
+    for (c = 0; c < MW_POOL_CLASSES; c++)
     {
-        FD_SET (pclt->fd, ptag->pwset);
-        if (pclt->fd > ptag->maxfd)
-        {
-            ptag->maxfd = pclt->fd;
-        }
+        if ((MW_POOL_MIN_SIZE << c) == cap) break;
+    }
+    if (c >= MW_POOL_CLASSES || pool->count[c] >= MW_POOL_DEPTH)
+    {
+        free (buf);
+        return;
     }
+    pool->bufs[c][pool->count[c]++] = buf;
+}
+
+static void _mws_pool_destroy (struct _MW_BUF_POOL* pool)
+{
+    int c = 0;
 
-    if (pclt->rlen == 0 || pclt->rlen < _mws_need_buf_size (pclt->rbuf))
+    for (c = 0; c < MW_POOL_CLASSES; c++)
     {
-        FD_SET (pclt->fd, ptag->prset);
-        if (pclt->fd > ptag->maxfd)
+        while (pool->count[c] > 0)
         {
-            ptag->maxfd = pclt->fd;
+            free (pool->bufs[c][--pool->count[c]]);
         }
     }
+}
 
-    return 0;
+/* frees a request or reply buffer of |pclt|, back to the pool if it came from it */
+static void _mws_release_buf (struct _MW_CLIENT_END* pclt, char* buf)
+{
+    if (buf == NULL) return;
+
+    if (buf == pclt->pbuf)
+    {
+        _mws_buf_put (pclt->pool, buf, pclt->pcap);
+        pclt->pbuf = NULL;
+        pclt->pcap = 0;
+        return;
+    }
+    mw_free (buf);
 }
 
-static void _free_wbuf (char** pwbuf)
+static void _free_wbuf (struct _MW_CLIENT_END* pclt)
 {
     int delay = 0;
-    if (pwbuf == NULL || *pwbuf == NULL) return;
-    if (mw_get (*pwbuf, 0, MW_FIELD_SYS_DELAY_FREE, (char*) &delay, 0) != 0 || delay != 1)
+    if (pclt->wbuf == NULL) return;
+    if (pclt->wbuf == pclt->pbuf)
     {
-        mw_free (*pwbuf);
+        /* the request buffer, returned by the service */
+        _mws_release_buf (pclt, pclt->wbuf);
     }
-    *pwbuf = NULL;
+    else if (mw_get (pclt->wbuf, 0, MW_FIELD_SYS_DELAY_FREE, (char*) &delay, 0) != 0 || delay != 1)
+    {
+        mw_free (pclt->wbuf);
+    }
+    pclt->wbuf = NULL;
 }
 
-static int _deal_wset_apply (void* pv_data, void* pv_tag)
+static void _mws_close_clt (struct _MW_CLIENT_END* pclt)
 {
-    struct _MW_CLIENT_END *pclt = (struct _MW_CLIENT_END*) pv_data;
-    struct _MW_SERVER_TAG *ptag = (struct _MW_SERVER_TAG*) pv_tag;
+    if (pclt->fd >= 0)
+    {
+        /* explicitly: a forked child may hold a copy of the socket */
+        epoll_ctl (pclt->epfd, EPOLL_CTL_DEL, pclt->fd, NULL);
+        close (pclt->fd);
+        pclt->fd = -1;
+    }
 
-    if (pclt == NULL || ptag == NULL) return 0;
+    if (pclt->rbuf != pclt->wbuf)
+    {
+        _mws_release_buf (pclt, pclt->rbuf);
+    }
+    pclt->rbuf = NULL;
+    _free_wbuf (pclt);
+
+    pclt->rlen = pclt->wlen = pclt->wpos = 0;
+}
+
+static int _mws_want (struct _MW_CLIENT_END* pclt, int out)
+{
+    struct epoll_event ev;
 
-    /* check if a same server */
-    if (pclt->sfd != ptag->basefd) return 0;
+    if (pclt->wait_out == out) return 0;
 
-    if (FD_ISSET (pclt->fd, ptag->pwset))
+    memset (&ev, 0, sizeof(ev));
+    ev.events = out ? EPOLLOUT : EPOLLIN;
+    ev.data.ptr = pclt;
+    if (epoll_ctl (pclt->epfd, EPOLL_CTL_MOD, pclt->fd, &ev) != 0)
     {
-        if (pclt->wlen <= 0) return 0;
+        PRINTF ("ERROR: %d epoll_ctl, %d, %s\n", pclt->fd, errno, strerror(errno));
+        return -1;
+    }
+    pclt->wait_out = out;
+
+    return 0;
+}
+
+/* sends what it can of the reply, waiting for EPOLLOUT for the rest */
+static void _mws_send_clt (struct _MW_CLIENT_END* pclt)
+{
+    int len = 0;
 
-        if (pclt->wlen == _mws_need_buf_size (pclt->wbuf))
+    while (pclt->wpos < pclt->wlen)
+    {
+        if ((len = send (pclt->fd, ((char*)pclt->wbuf) + pclt->wpos, pclt->wlen - pclt->wpos, MSG_NOSIGNAL)) <= 0)
         {
-            int slen = 0;
-            int len = 0;
-            while (slen < pclt->wlen)
+            if (len < 0 && errno == EINTR) continue;
+            if (len < 0 && errno == EAGAIN)
             {
-                if ((len = send (pclt->fd, ((char*)pclt->wbuf) + slen, pclt->wlen - slen, 0)) <= 0)
-                {
-                    if (errno == EAGAIN)
-                    {
-                        /*usleep (1000);*/
-                        /*PRINTF (" >>>> send rc %d, %d, %s\n", len, errno, strerror(errno));*/
-                        continue;
-                    }
-                    if (len == 0) {
-                        PRINTF ("WARN: %d send %d-byte, need send %d. %d, %s\n", pclt->fd, slen, pclt->wlen, errno, strerror(errno));
-                    } else {
-                        PRINTF ("ERROR: %d send %d, %s\n", pclt->fd, errno, strerror(errno));
-                    }
-                    break;
-                }
-                slen += len;
+                if (_mws_want (pclt, 1) != 0) _mws_close_clt (pclt);
+                return;
             }
-            /*PRINTF (" >>>> send %d-byte, need send %d\n", slen, pclt->wlen);*/
-            _free_wbuf (&(pclt->wbuf));
-            pclt->wlen = 0;
+            if (len == 0) {
+                PRINTF ("WARN: %d send %d-byte, need send %d. %d, %s\n", pclt->fd, pclt->wpos, pclt->wlen, errno, strerror(errno));
+            } else {
+                PRINTF ("ERROR: %d send %d, %s\n", pclt->fd, errno, strerror(errno));
+            }
+            _mws_close_clt (pclt);
+            return;
         }
+        pclt->wpos += len;
     }
+    /*PRINTF (" >>>> send %d-byte, need send %d\n", pclt->wpos, pclt->wlen);*/
+    _free_wbuf (pclt);
+    pclt->wlen = 0;
+    pclt->wpos = 0;
 
-    return 0;
+    if (_mws_want (pclt, 0) != 0)
+    {
+        _mws_close_clt (pclt);
+    }
 }
 
 extern void* mw_alloc (int size);
@@ -536,7 +624,7 @@ static int _deal_mw_call_apply (void *pv_data, void* pv_tag)
         pclt->rlen = 0;
         if (rbuf != wbuf)
         {
-            mw_free (rbuf);
+            _mws_release_buf (pclt, rbuf);
             rbuf = NULL;
         }
 
@@ -567,82 +655,192 @@ static int _print_mw_call_apply (void *pv_data, void* pv_tag)
     return 0;
 }
 
-extern void* mw_nodelay (void* ptr);
-static int _deal_rset_apply (void* pv_data, void* pv_tag)
+static void _mws_call_one (int mwidx, struct _MW_CLIENT_END *pclt)
 {
-    struct _MW_CLIENT_END *pclt = (struct _MW_CLIENT_END*) pv_data;
-    struct _MW_SERVER_TAG *ptag = (struct _MW_SERVER_TAG*) pv_tag;
-    int nlen = 0;
+    my_list_map (mws[mwidx].h_mws_list, _deal_mw_call_apply, pclt);
 
-    if (pclt == NULL || ptag == NULL) return 0;
+    if (pclt->rlen > 0)
+    {
+        /* TODO */
+        /*assert (0);*/
+        void* rbuf = pclt->rbuf;
+        void *wbuf = mws_return (-1, pclt->rbuf);
 
-    /* check if a same server */
-    if (pclt->sfd != ptag->basefd) return 0;
+        PRINTF (">>> WARN: What's wrong? Service Not Found. mws[%d].fd %d, pclt->sfd %d, mws.svc.cnt: %p, %d\n",
+                mwidx, mws[mwidx].fd, pclt->sfd, mws[mwidx].h_mws_list, my_list_size(mws[mwidx].h_mws_list));
+        _prn_mem (pclt->rbuf, 128);
+        my_list_map (mws[mwidx].h_mws_list, _print_mw_call_apply, pclt);
 
-    if (pclt->fd < 0) return 0;
+        pclt->wlen = _mws_need_buf_size (wbuf);
+        pclt->wbuf = wbuf;
+        pclt->rbuf = NULL;
+        pclt->rlen = 0;
+        if (rbuf != wbuf)
+        {
+            _mws_release_buf (pclt, rbuf);
+            rbuf = NULL;
+        }
+    }
+}
+
+extern void* mw_nodelay (void* ptr);
 
-    nlen = _mws_need_buf_size (pclt->rbuf);
+#define MW_BATCH_MAX 64
+
+/* serves each request of a batch in turn, replying with all their replies */
+static void _mws_call_batch (int mwidx, struct _MW_CLIENT_END *pclt)
+{
+    char* replies[MW_BATCH_MAX];
+    struct _MW_CLIENT_END sub;
+    char head[8] = "";
+    void* rbuf = pclt->rbuf;
+    char* wbuf = NULL;
+    int count = 0;
+    int total = 0;
+    int rc = 0;
+    int i = 0;
 
-    if (pclt->rlen > 0 && pclt->rlen == nlen)
+    for (count = 0; count < MW_BATCH_MAX; count++)
     {
-        int i = 0;
-        if (pclt->wlen != 0)
-        {
-            return 0;
-        }
-        for (i = 0; i < MW_SERVER_MAX; i++) {
-            if (mws[i].fd == pclt->sfd) {
-                my_list_map (mws[i].h_mws_list, _deal_mw_call_apply, pclt);
-                break;
-            }
-        }
-        if (pclt->rlen > 0)
-        {
-            /* TODO */
-            /*assert (0);*/
-            void* rbuf = pclt->rbuf;
-            void *wbuf = mws_return (-1, pclt->rbuf);
+        int size = sizeof(head);
+        int nlen = 0;
+
+        if (mw_get (rbuf, count, MW_FIELD_SYS_BATCH, head, &size) != 0 || size < sizeof(head)) break;
+        nlen = _mws_need_buf_size (head);
+        if (nlen < MW_FIRST_READ_SIZE || nlen > pclt->rlen) break;
+
+        /* as a client of its own, so that the service owns its buffer */
+        memset (&sub, 0, sizeof(sub));
+        sub.fd = pclt->fd;
+        sub.sfd = pclt->sfd;
+        sub.epfd = pclt->epfd;
+        sub.pool = pclt->pool;
+        sub.rbuf = malloc (nlen);
+        if (sub.rbuf == NULL) break;
+        size = nlen;
+        mw_get (rbuf, count, MW_FIELD_SYS_BATCH, sub.rbuf, &size);
+        sub.rlen = nlen;
+        mw_nodelay (sub.rbuf);
+
+        _mws_call_one (mwidx, &sub);
+
+        replies[count] = sub.wbuf;
+        total += 8 + ((_mws_need_buf_size (sub.wbuf) + 3) & ~3);
+    }
 
-            PRINTF (">>> WARN: What's wrong? Service Not Found. i %d, mws[%d].fd %d, pclt->sfd %d, mws.svc.cnt: %p, %d (next: %p, %d)\n",
-                    i, i, mws[i].fd, pclt->sfd, mws[i].h_mws_list, my_list_size(mws[i].h_mws_list), mws[i+1].h_mws_list, my_list_size(mws[i+1].h_mws_list));
-            _prn_mem (pclt->rbuf, 128);
-            my_list_map (mws[i].h_mws_list, _print_mw_call_apply, pclt);
+    i = sizeof(head);
+    if (mw_get (rbuf, count, MW_FIELD_SYS_BATCH, head, &i) == 0)
+    {
+        PRINTF ("WARN: %d batch request %d not served\n", pclt->fd, count);
+        rc = -1;
+    }
 
-            pclt->wlen = _mws_need_buf_size (wbuf);
-            pclt->wbuf = wbuf;
-            pclt->rbuf = NULL;
-            pclt->rlen = 0;
-            if (rbuf != wbuf)
-            {
-                mw_free (rbuf);
-                rbuf = NULL;
-            }
+    /* header, replies and return code */
+    wbuf = mw_alloc (8 + total + 8);
+    for (i = 0; i < count; i++)
+    {
+        if (wbuf) mw_append (wbuf, MW_FIELD_SYS_BATCH, replies[i], _mws_need_buf_size (replies[i]));
+        memset (&sub, 0, sizeof(sub));
+        sub.wbuf = replies[i];
+        _free_wbuf (&sub);
+    }
+    if (wbuf == NULL)
+    {
+        wbuf = rbuf;
+        rc = -1;
+    }
+    mws_return (rc, wbuf);
 
-            return 0;
-        }
-        return 0;
+    pclt->wlen = _mws_need_buf_size (wbuf);
+    pclt->wbuf = wbuf;
+    pclt->rbuf = NULL;
+    pclt->rlen = 0;
+    if (rbuf != wbuf)
+    {
+        _mws_release_buf (pclt, rbuf);
+    }
+}
+
+/* makes sure the reply carries |req_id|, for a client with calls in flight */
+static void _mws_tag_reply (struct _MW_CLIENT_END *pclt, int req_id)
+{
+    char* buf = NULL;
+    int delay = 0;
+    int id = 0;
+
+    if (pclt->wbuf == NULL) return;
+
+    if (pclt->wbuf == pclt->pbuf && mw_get (pclt->wbuf, 0, MW_FIELD_SYS_REQUEST_ID, (char*) &id, 0) == 0)
+    {
+        /* the request buffer, the id is there */
+        return;
+    }
+
+    /* the service may keep a delay free buffer, leave it untouched */
+    if ((mw_get (pclt->wbuf, 0, MW_FIELD_SYS_DELAY_FREE, (char*) &delay, 0) != 0 || delay != 1) &&
+        mw_append (pclt->wbuf, MW_FIELD_SYS_REQUEST_ID, (char*) &req_id, 0) == 0)
+    {
+        return;
     }
 
-    if (FD_ISSET (pclt->fd, ptag->prset))
+    /* no room, or not ours: reply with a copy */
+    buf = mw_alloc (pclt->wlen + 8);
+    if (buf == NULL) return;
+    memcpy (buf + 8, pclt->wbuf + 8, pclt->wlen - 8);
+    mw_nodelay (buf);
+    mw_append (buf, MW_FIELD_SYS_REQUEST_ID, (char*) &req_id, 0);
+
+    if (pclt->rbuf == pclt->wbuf) pclt->rbuf = NULL;
+    _free_wbuf (pclt);
+    pclt->wbuf = buf;
+    pclt->wlen = _mws_need_buf_size (buf);
+}
+
+static void _mws_call_service (int mwidx, struct _MW_CLIENT_END *pclt)
+{
+    char name[64] = "";
+    int req_id = 0;
+    int tagged = 0;
+
+    tagged = mw_get (pclt->rbuf, 0, MW_FIELD_SYS_REQUEST_ID, (char*) &req_id, 0) == 0;
+    _mws_get_service_name (pclt->rbuf, name);
+
+    if (strcmp (name, MW_BATCH_SERVICE_NAME) == 0)
+    {
+        _mws_call_batch (mwidx, pclt);
+    }
+    else
     {
-        int rlen = 0;
+        _mws_call_one (mwidx, pclt);
+    }
+
+    if (tagged) _mws_tag_reply (pclt, req_id);
+}
 
-        if (pclt->rlen < 0) pclt->rlen = 0;
+/* reads what is available of a request; returns 1 once it is complete */
+static int _mws_recv_clt (struct _MW_CLIENT_END *pclt)
+{
+    int nlen = 0;
+    int rlen = 0;
 
-        if (pclt->rlen == 0)
+    while (pclt->fd >= 0)
+    {
+        if (pclt->rlen <= 0)
         {
             char rbuf[MW_FIRST_READ_SIZE] = "";
             int err = 0;
 
             rlen = recv (pclt->fd, rbuf, MW_FIRST_READ_SIZE, 0);
+            if (rlen < 0 && (errno == EAGAIN || errno == EINTR)) return 0;
             nlen = _mws_need_buf_size (rbuf);
 
             if (rlen < MW_FIRST_READ_SIZE || nlen <= 0 || nlen > 2*1024*1024) err = 1;
 
             if (err == 0)
             {
-                if (pclt->rbuf == NULL) pclt->rbuf = malloc (nlen);
+                pclt->rbuf = _mws_buf_get (pclt->pool, nlen, &pclt->pcap);
                 if (pclt->rbuf == NULL) err = 2;
+                pclt->pbuf = pclt->rbuf;
             }
 
             if (err)
@@ -652,15 +850,7 @@ static int _deal_rset_apply (void* pv_data, void* pv_tag)
                 } else if (rlen < 0) {
                     PRINTF ("ERROR: %d recv, %d, %s\n", pclt->fd, errno, strerror(errno));
                 }
-                close (pclt->fd);
-                pclt->fd = -1;
-
-                mw_free (pclt->rbuf);
-                pclt->rbuf = NULL;
-                _free_wbuf (&(pclt->wbuf));
-
-                pclt->rlen = pclt->wlen = 0;
-
+                _mws_close_clt (pclt);
                 return 0;
             }
 
@@ -671,32 +861,99 @@ static int _deal_rset_apply (void* pv_data, void* pv_tag)
             /* delete DELAY flag to prevent from memleak */
             mw_nodelay (pclt->rbuf);
         }
-        else if (pclt->rlen < nlen)
-        {
-            rlen = recv (pclt->fd, pclt->rbuf + pclt->rlen, nlen - pclt->rlen, 0);
-            if (rlen <= 0)
-            {
-                if (rlen < 0) {
-                    PRINTF ("ERROR: %d recv, %d, %s\n", pclt->fd, errno, strerror(errno));
-                }
-                close (pclt->fd);
-                pclt->fd = -1;
-
-                mw_free (pclt->rbuf);
-                pclt->rbuf = NULL;
-                _free_wbuf (&(pclt->wbuf));
 
-                pclt->rlen = pclt->wlen = 0;
+        nlen = _mws_need_buf_size (pclt->rbuf);
+        if (pclt->rlen >= nlen) return 1;
 
-                return 0;
+        rlen = recv (pclt->fd, pclt->rbuf + pclt->rlen, nlen - pclt->rlen, 0);
+        if (rlen < 0 && (errno == EAGAIN || errno == EINTR)) return 0;
+        if (rlen <= 0)
+        {
+            if (rlen < 0) {
+                PRINTF ("ERROR: %d recv, %d, %s\n", pclt->fd, errno, strerror(errno));
             }
-            pclt->rlen += rlen;
+            _mws_close_clt (pclt);
+            return 0;
         }
+        pclt->rlen += rlen;
     }
 
     return 0;
 }
 
+static void _mws_deal_clt (int mwidx, struct _MW_CLIENT_END *pclt, unsigned int events)
+{
+    if (pclt->fd < 0) return;
+
+    if (pclt->wlen > 0)
+    {
+        /* a reply is pending, the next request waits for it */
+        if (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) _mws_send_clt (pclt);
+        return;
+    }
+
+    if (events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+    {
+        int n = 0;
+
+        /* requests pipelined behind this one are served in the same wakeup */
+        while (n++ < MWC_MAX_IN_FLIGHT && pclt->fd >= 0 && pclt->wlen == 0 && _mws_recv_clt (pclt) == 1)
+        {
+            _mws_call_service (mwidx, pclt);
+            pclt->wpos = 0;
+            _mws_send_clt (pclt);
+        }
+    }
+}
+
+static void _mws_accept_clts (int mwidx)
+{
+    int fd = mws[mwidx].fd;
+
+    while (1)
+    {
+        struct sockaddr_in cliaddr = {0};
+        int clen = sizeof(cliaddr);
+        int cfd = -1;
+        struct _MW_CLIENT_END* pclt = NULL;
+        struct epoll_event ev;
+
+        cfd = accept (fd, (struct sockaddr*) &cliaddr, (socklen_t*) &clen);
+        if (cfd < 0)
+        {
+            break;
+        }
+
+        _mw_nonblock (cfd);
+
+        pclt = malloc (sizeof(*pclt));
+        if (pclt == NULL)
+        {
+            close (cfd);
+            break;
+        }
+
+        memset (pclt, 0, sizeof(*pclt));
+        pclt->fd = cfd;
+        pclt->sfd = fd;
+        pclt->pool = &mws[mwidx].pool;
+        pclt->epfd = mws[mwidx].epfd;
+
+        memset (&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = pclt;
+        if (epoll_ctl (mws[mwidx].epfd, EPOLL_CTL_ADD, cfd, &ev) != 0)
+        {
+            PRINTF ("ERROR: %d epoll_ctl, %d, %s\n", cfd, errno, strerror(errno));
+            close (cfd);
+            free (pclt);
+            continue;
+        }
+
+        my_list_add_tail (mws[mwidx].h_clt_list, pclt);
+    }
+}
+
 static int _clean_clt_cmp (const void *pv1, const void* pv2)
 {
     struct _MW_CLIENT_END *pclt = (struct _MW_CLIENT_END*) pv1;
@@ -726,40 +983,35 @@ static int _mws_clean_clts_all(handle_t h_clt_list)
 
     while ((pclt = my_list_delete_head(h_clt_list)) != NULL)
     {
-        if (pclt->fd >= 0) {
-            close (pclt->fd);
-            pclt->fd = -1;
-        }
+        _mws_close_clt (pclt);
         free(pclt->sname);
         pclt->sname = NULL;
-        if (pclt->rbuf == pclt->wbuf) {
-            mw_free(pclt->rbuf);
-            pclt->rbuf = pclt->wbuf = NULL;
-        }
-        if (pclt->rbuf) {
-            mw_free(pclt->rbuf);
-            pclt->rbuf = NULL;
-        }
-        if (pclt->wbuf) {
-            mw_free(pclt->wbuf);
-            pclt->wbuf = NULL;
-        }
         free (pclt);
     }
 
     return 0;
 }
 
+static void _mws_server_release(int mwidx)
+{
+    _mws_clean_clts_all(mws[mwidx].h_clt_list);
+    my_list_destroy(mws[mwidx].h_mws_list, NULL);
+    my_list_destroy(mws[mwidx].h_clt_list, NULL);
+    _mws_pool_destroy(&mws[mwidx].pool);
+    if (mws[mwidx].epfd >= 0) {
+        close(mws[mwidx].epfd);
+        mws[mwidx].epfd = -1;
+    }
+    mws[mwidx].cleaned = 1;
+}
+
 static void _mws_server_cleanup(void* tag)
 {
     int mwidx = (int)tag;
 
     mws_lock();
 
-    _mws_clean_clts_all(mws[mwidx].h_clt_list);
-    my_list_destroy(mws[mwidx].h_mws_list, NULL);
-    my_list_destroy(mws[mwidx].h_clt_list, NULL);
-    mws[mwidx].cleaned = 1;
+    _mws_server_release(mwidx);
 
     mws_unlock();
 }
@@ -768,6 +1020,7 @@ static void* _mws_server (void *pvtag)
 {
     int fd = -1;
     int mwidx = 0;
+    struct epoll_event ev;
 
     fd = (int) pvtag;
     if (fd < 0)
@@ -795,74 +1048,47 @@ static void* _mws_server (void *pvtag)
     {
         my_list_create (&mws[mwidx].h_clt_list);
     }
+
+    /* clients stay registered for their lifetime, the listener with a NULL ptr */
+    mws[mwidx].epfd = epoll_create (MW_EPOLL_EVENTS);
+    memset (&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (mws[mwidx].epfd < 0 || epoll_ctl (mws[mwidx].epfd, EPOLL_CTL_ADD, fd, &ev) != 0)
+    {
+        mws_unlock();
+        PRINTF ("epoll init error, %d, %s\n", errno, strerror(errno));
+        return NULL;
+    }
     mws_unlock();
 
     while (1)
     {
-        fd_set rset;
-        fd_set wset;
-        struct _MW_SERVER_TAG t_st = {-1, -1, NULL, NULL};
+        struct epoll_event events[MW_EPOLL_EVENTS];
         int ready = 0;
+        int i = 0;
 
-        FD_ZERO (&rset);
-        FD_ZERO (&wset);
-
-        FD_SET (fd, &rset);
-
-        t_st.maxfd = fd;
-        t_st.basefd = fd;
-        t_st.prset = &rset;
-        t_st.pwset = &wset;
-
-        mws_lock();
-        my_list_map (mws[mwidx].h_clt_list, _rwset_apply, (void*) &t_st);
-        mws_unlock();
-
-        ready = select (t_st.maxfd + 1, t_st.prset, t_st.pwset, NULL, NULL);
+        ready = epoll_wait (mws[mwidx].epfd, events, MW_EPOLL_EVENTS, -1);
 
-        if (ready == 0) continue;
+        if (ready <= 0) continue;
 
         mws_lock ();
 
         pthread_cleanup_push(_mws_server_cleanup, (void*)mwidx);
 
-        do {
-            if (FD_ISSET (fd, t_st.prset))
+        for (i = 0; i < ready; i++)
+        {
+            if (events[i].data.ptr == NULL)
             {
-                struct sockaddr_in cliaddr = {0};
-                int clen = sizeof(cliaddr);
-                int cfd = -1;
-                struct _MW_CLIENT_END* pclt = NULL;
-
-                --ready;
-
-                cfd = accept (fd, (struct sockaddr*) &cliaddr, (socklen_t*) &clen);
-                if (cfd < 0)
-                {
-                    break;
-                }
-
-                _mw_nonblock (cfd);
-
-                pclt = malloc (sizeof(*pclt));
-                if (pclt == NULL)
-                {
-                    break;
-                }
-
-                memset (pclt, 0, sizeof(*pclt));
-                pclt->fd = cfd;
-                pclt->sfd = fd;
-
-                my_list_add_tail (mws[mwidx].h_clt_list, pclt);
+                _mws_accept_clts (mwidx);
             }
-        } while (0);
-
-        /* check write */
-        my_list_map (mws[mwidx].h_clt_list, _deal_wset_apply, (void*) &t_st);
-        /* check read */
-        my_list_map (mws[mwidx].h_clt_list, _deal_rset_apply, (void*) &t_st);
+            else
+            {
+                _mws_deal_clt (mwidx, (struct _MW_CLIENT_END*) events[i].data.ptr, events[i].events);
+            }
+        }
 
+        /* closed clients are off the epoll set, and freed only after the batch */
         _mws_clean_clts (mws[mwidx].h_clt_list);
 
         pthread_cleanup_pop(0);
@@ -870,10 +1096,7 @@ static void* _mws_server (void *pvtag)
         mws_unlock ();
     }
 
-    _mws_clean_clts_all(mws[mwidx].h_clt_list);
-    my_list_destroy(mws[mwidx].h_mws_list, NULL);
-    my_list_destroy(mws[mwidx].h_clt_list, NULL);
-    mws[mwidx].cleaned = 1;
+    _mws_server_release(mwidx);
 
     return NULL;
 }
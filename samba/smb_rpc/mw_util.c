@@ -218,6 +218,17 @@ int mw_get (const void* data, int idx, int field_id, char* presult, int *size)
                 {
                     pi = (int*) (cur + 4);
                 }
+                else if (fid == MW_FIELD_SYS_REQUEST_ID) /* 0x00010004 */
+                {
+                    pi = (int*) (cur + 4);
+                }
+                else if (fid == MW_FIELD_SYS_BATCH) /* 0x00010005, data */
+                {
+                    int* pdlen = (int*) (cur + 4);
+                    dlen = ntohl (*pdlen);
+                    if (dlen < 0 || dlen >= nlen) break;
+                    pdata = cur + 8;
+                }
                 else
                 {
                     break;
@@ -358,6 +369,14 @@ int mw_append (void* data, int field_id, const char* presult, int len)
                 {
                     pi = (int*) presult;
                 }
+                else if (field_id == MW_FIELD_SYS_REQUEST_ID) /* 0x00010004 */
+                {
+                    pi = (int*) presult;
+                }
+                else if (field_id == MW_FIELD_SYS_BATCH) /* 0x00010005, data */
+                {
+                    pdata = (void*) presult;
+                }
                 else
                 {
                     break;
@@ -444,6 +463,17 @@ int mw_append (void* data, int field_id, const char* presult, int len)
                 {
                     pi = (int*) (cur + 4);
                 }
+                else if (fid == MW_FIELD_SYS_REQUEST_ID) /* 0x00010004 */
+                {
+                    pi = (int*) (cur + 4);
+                }
+                else if (fid == MW_FIELD_SYS_BATCH) /* 0x00010005, data */
+                {
+                    int* pdlen = (int*) (cur + 4);
+                    dlen = ntohl (*pdlen);
+                    if (dlen < 0 || dlen >= nlen) break;
+                    pdata = cur + 8;
+                }
                 else
                 {
                     break;
@@ -541,6 +571,17 @@ int _mw_get_real_size (const void* data)
                 {
                     pi = (int*) (cur + 4);
                 }
+                else if (fid == MW_FIELD_SYS_REQUEST_ID) /* 0x00010004 */
+                {
+                    pi = (int*) (cur + 4);
+                }
+                else if (fid == MW_FIELD_SYS_BATCH) /* 0x00010005, data */
+                {
+                    int* pdlen = (int*) (cur + 4);
+                    dlen = ntohl (*pdlen);
+                    if (dlen < 0 || dlen >= nlen) break;
+                    pdata = cur + 8;
+                }
                 else
                 {
                     break;
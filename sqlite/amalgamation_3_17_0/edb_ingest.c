@@ -0,0 +1,812 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "edb_ingest.h"
+#include "edb_search.h"
+
+/*
+ * Reference document https://www.sqlite.org/wal.html, https://www.sqlite.org/pragma.html
+ *
+ * A full EIT schedule refresh puts tens of thousands of events. Each
+ * transaction on eMMC costs a couple of journal and database syncs, so
+ * rows are committed batch_rows at a time; in WAL mode with synchronous
+ * NORMAL a commit is a sequential append to the -wal file and the sync is
+ * only paid at checkpoint.
+ */
+
+/* 0: the sqlite default, which the emmc VFS makes the eMMC program unit */
+#define EDB_DEFAULT_PAGE_SIZE   0
+#define EDB_DEFAULT_CACHE_KB    512
+#define EDB_DEFAULT_BATCH_ROWS  500
+
+/* details shorter than that are not worth deflating */
+#define EDB_COMPRESS_MIN        128
+
+#define EDB_ZHDR                4
+
+/*
+ * An event detail is well under 4K: a 4K window and a small hash keep the
+ * deflate state at about 20K, allocated once instead of the 256K that
+ * compress2() allocates and frees for every call.
+ */
+#define EDB_Z_WINDOW_BITS       12
+#define EDB_Z_MEM_LEVEL         5
+
+struct edb_ingest
+{
+    sqlite3*            db;
+    edb_ingest_config_t cfg;
+
+    sqlite3_stmt*       stmt_begin;
+    sqlite3_stmt*       stmt_commit;
+    sqlite3_stmt*       stmt_put;
+    sqlite3_stmt*       stmt_expire;
+    sqlite3_stmt*       stmt_get;
+
+    /* full-text index upkeep, when t_edb_fts exists */
+    int                 fts;
+    sqlite3_stmt*       stmt_touch;
+    sqlite3_stmt*       stmt_fts_add;
+    sqlite3_stmt*       stmt_fts_del;
+    sqlite3_stmt*       stmt_expire_list;
+
+    int                 pending;        /* statements in the open transaction */
+    edb_ingest_stats_t  stats;
+
+    z_stream            zs;
+    int                 zs_ready;
+    unsigned char*      zbuf;           /* compression buffer */
+    unsigned long       zcap;
+};
+
+static const char* const journal_modes[] = {"DELETE", "WAL"};
+static const char* const sync_levels[]   = {"OFF", "NORMAL", "FULL"};
+
+void edb_ingest_default_config(edb_ingest_config_t* cfg)
+{
+    cfg->page_size   = EDB_DEFAULT_PAGE_SIZE;
+    cfg->cache_kb    = EDB_DEFAULT_CACHE_KB;
+    cfg->wal         = 1;
+    cfg->synchronous = EDB_SYNC_NORMAL;
+    cfg->batch_rows  = EDB_DEFAULT_BATCH_ROWS;
+    cfg->compress    = 0;
+    cfg->search      = 1;
+}
+
+static int execSql(sqlite3* db, const char* sql)
+{
+    char*   err = NULL;
+    int     rc  = sqlite3_exec(db, sql, NULL, NULL, &err);
+
+    if(rc != SQLITE_OK)
+    {
+        printf("edb: %s fail,err=%d %s\n", sql, rc, err ? err : "");
+        sqlite3_free(err);
+    }
+    return rc;
+}
+
+static int pragmaInt(sqlite3* db, const char* pragma)
+{
+    char            sql[64];
+    sqlite3_stmt*   stmt  = NULL;
+    int             value = -1;
+
+    sqlite3_snprintf(sizeof(sql), sql, "PRAGMA %s", pragma);
+    if(sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK &&
+       sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        value = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return value;
+}
+
+/*
+ ** Decompress a detail of |n| bytes stored as a BLOB. Return a buffer to
+ ** free with sqlite3_free and its length in *p_len, or NULL.
+ */
+static char* inflateDetail(const unsigned char* blob, int n, int* p_len)
+{
+    uLongf  len = 0;
+    char*   out = NULL;
+
+    if(n < EDB_ZHDR)
+    {
+        return NULL;
+    }
+    len = ((uLongf)blob[0] << 24) | ((uLongf)blob[1] << 16) | ((uLongf)blob[2] << 8) | blob[3];
+    out = sqlite3_malloc64(len + 1);
+    if(out == NULL)
+    {
+        return NULL;
+    }
+    if(uncompress((Bytef*)out, &len, blob + EDB_ZHDR, n - EDB_ZHDR) != Z_OK)
+    {
+        sqlite3_free(out);
+        return NULL;
+    }
+    out[len] = 0;
+    *p_len = (int)len;
+    return out;
+}
+
+/*
+ ** SQL function edb_detail(eventDetail): the detail as TEXT, compressed or not.
+ */
+static void detailFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv)
+{
+    char*   text = NULL;
+    int     len  = 0;
+
+    if(sqlite3_value_type(argv[0]) != SQLITE_BLOB)
+    {
+        sqlite3_result_value(ctx, argv[0]);
+        return;
+    }
+    text = inflateDetail(sqlite3_value_blob(argv[0]), sqlite3_value_bytes(argv[0]), &len);
+    if(text == NULL)
+    {
+        sqlite3_result_error(ctx, "corrupted eventDetail", -1);
+        return;
+    }
+    sqlite3_result_text(ctx, text, len, sqlite3_free);
+}
+
+/*
+ ** The detail in column |col| of the current row of |stmt|, with its length
+ ** in *p_len. A compressed one is inflated into *p_tmp, to free with
+ ** sqlite3_free. Return NULL if it is corrupted.
+ */
+static const char* columnDetail(sqlite3_stmt* stmt, int col, int* p_len, char** p_tmp)
+{
+    const char* text = NULL;
+
+    *p_tmp = NULL;
+    if(sqlite3_column_type(stmt, col) == SQLITE_BLOB)
+    {
+        *p_tmp = inflateDetail(sqlite3_column_blob(stmt, col), sqlite3_column_bytes(stmt, col), p_len);
+        return *p_tmp;
+    }
+    text   = (const char*)sqlite3_column_text(stmt, col);
+    *p_len = sqlite3_column_bytes(stmt, col);
+    return text;
+}
+
+static int prepare(edb_ingest_t* ingest, const char* sql, sqlite3_stmt** pp_stmt)
+{
+    int rc = sqlite3_prepare_v2(ingest->db, sql, -1, pp_stmt, NULL);
+    if(rc != SQLITE_OK)
+    {
+        printf("edb: prepare %s fail,err=%d %s\n", sql, rc, sqlite3_errmsg(ingest->db));
+    }
+    return rc;
+}
+
+/*
+ ** Create or upgrade the schema. A table from before version 1 is dropped;
+ ** a fresh database gets the configured page size, so does one whose
+ ** table was dropped, by a VACUUM while it is empty.
+ */
+static int setupSchema(edb_ingest_t* ingest)
+{
+    sqlite3*    db      = ingest->db;
+    int         version = pragmaInt(db, "user_version");
+    char        sql[64];
+    int         rc      = SQLITE_OK;
+
+    if(version == EDB_SCHEMA_VERSION)
+    {
+        return SQLITE_OK;
+    }
+    if(version > EDB_SCHEMA_VERSION)
+    {
+        printf("edb: schema version %d is newer than %d\n", version, EDB_SCHEMA_VERSION);
+        return SQLITE_MISMATCH;
+    }
+
+    if(version < 1)
+    {
+        rc = execSql(db, "DROP TABLE IF EXISTS t_edb");
+        if(rc == SQLITE_OK && ingest->cfg.page_size > 0 &&
+           pragmaInt(db, "page_size") != ingest->cfg.page_size)
+        {
+            /* page_size only changes by VACUUM, which WAL mode does not allow */
+            execSql(db, "PRAGMA journal_mode=DELETE");
+            sqlite3_snprintf(sizeof(sql), sql, "PRAGMA page_size=%d", ingest->cfg.page_size);
+            execSql(db, sql);
+            rc = execSql(db, "VACUUM");
+        }
+    }
+    if(rc != SQLITE_OK)
+    {
+        return rc;
+    }
+
+    rc = execSql(db, "BEGIN");
+    if(rc == SQLITE_OK && version < 1)
+    {
+        rc = execSql(db,
+                     "CREATE TABLE t_edb(channelId INT, eventId INT, startTime INT, duration INT, eventDetail);"
+                     "CREATE UNIQUE INDEX index_ch_event on t_edb(channelId,eventId);");
+    }
+    if(rc == SQLITE_OK && version < 2)
+    {
+        rc = execSql(db, "CREATE INDEX index_ch_time on t_edb(channelId,startTime,duration,eventId)");
+    }
+    if(rc == SQLITE_OK)
+    {
+        sqlite3_snprintf(sizeof(sql), sql, "PRAGMA user_version=%d", EDB_SCHEMA_VERSION);
+        rc = execSql(db, sql);
+    }
+    if(rc == SQLITE_OK)
+    {
+        return execSql(db, "COMMIT");
+    }
+    execSql(db, "ROLLBACK");
+    return rc;
+}
+
+/*
+ ** Create the full-text index from the table if search is set and it does
+ ** not exist, or drop it if search is not set.
+ */
+static int setupSearch(edb_ingest_t* ingest)
+{
+    sqlite3*        db     = ingest->db;
+    sqlite3_stmt*   stmt   = NULL;
+    int             exists = 0;
+    int             rc     = SQLITE_OK;
+
+    rc = sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE name='t_edb_fts'", -1, &stmt, NULL);
+    if(rc == SQLITE_OK)
+    {
+        exists = sqlite3_step(stmt) == SQLITE_ROW;
+    }
+    sqlite3_finalize(stmt);
+
+    /* writing the index needs the tokenizer, and so does dropping it */
+    if(rc == SQLITE_OK && (exists || ingest->cfg.search))
+    {
+        rc = edb_search_register(db);
+    }
+    if(rc != SQLITE_OK || exists == ingest->cfg.search)
+    {
+        ingest->fts = exists;
+        return rc;
+    }
+
+    rc = execSql(db, "BEGIN");
+    if(rc == SQLITE_OK && exists)
+    {
+        rc = execSql(db, "DROP TABLE t_edb_fts");
+    }
+    if(rc == SQLITE_OK && !exists)
+    {
+        rc = execSql(db,
+                     "CREATE VIRTUAL TABLE t_edb_fts USING fts5(detail, content='', tokenize='edb');"
+                     "INSERT INTO t_edb_fts(rowid,detail) SELECT rowid,edb_detail(eventDetail) FROM t_edb;");
+    }
+    if(rc == SQLITE_OK)
+    {
+        rc = execSql(db, "COMMIT");
+    }
+    if(rc != SQLITE_OK)
+    {
+        execSql(db, "ROLLBACK");
+        return rc;
+    }
+    ingest->fts = !exists;
+    return SQLITE_OK;
+}
+
+int edb_ingest_open(const char* path, const edb_ingest_config_t* cfg, edb_ingest_t** pp_ingest)
+{
+    edb_ingest_t*   ingest = NULL;
+    char            sql[64];
+    int             rc     = SQLITE_OK;
+
+    *pp_ingest = NULL;
+    ingest = sqlite3_malloc(sizeof(*ingest));
+    if(ingest == NULL)
+    {
+        return SQLITE_NOMEM;
+    }
+    memset(ingest, 0, sizeof(*ingest));
+    if(cfg != NULL)
+    {
+        ingest->cfg = *cfg;
+    }
+    else
+    {
+        edb_ingest_default_config(&ingest->cfg);
+    }
+    if(ingest->cfg.batch_rows < 1)
+    {
+        ingest->cfg.batch_rows = 1;
+    }
+    if(ingest->cfg.synchronous < EDB_SYNC_OFF || ingest->cfg.synchronous > EDB_SYNC_FULL)
+    {
+        ingest->cfg.synchronous = EDB_SYNC_FULL;
+    }
+
+    rc = sqlite3_open(path, &ingest->db);
+    if(rc != SQLITE_OK)
+    {
+        printf("Can't open database: %s\n", path);
+        edb_ingest_close(ingest);
+        return rc;
+    }
+    sqlite3_busy_timeout(ingest->db, 1000);
+
+    /* page_size must come before the first table of a new database */
+    if(ingest->cfg.page_size > 0)
+    {
+        sqlite3_snprintf(sizeof(sql), sql, "PRAGMA page_size=%d", ingest->cfg.page_size);
+        execSql(ingest->db, sql);
+    }
+    rc = setupSchema(ingest);
+
+    if(rc == SQLITE_OK)
+    {
+        sqlite3_snprintf(sizeof(sql), sql, "PRAGMA journal_mode=%s", journal_modes[ingest->cfg.wal ? 1 : 0]);
+        rc = execSql(ingest->db, sql);
+    }
+    if(rc == SQLITE_OK)
+    {
+        sqlite3_snprintf(sizeof(sql), sql, "PRAGMA synchronous=%s", sync_levels[ingest->cfg.synchronous]);
+        rc = execSql(ingest->db, sql);
+    }
+    if(rc == SQLITE_OK && ingest->cfg.cache_kb > 0)
+    {
+        sqlite3_snprintf(sizeof(sql), sql, "PRAGMA cache_size=-%d", ingest->cfg.cache_kb);
+        rc = execSql(ingest->db, sql);
+    }
+    if(rc == SQLITE_OK)
+    {
+        rc = sqlite3_create_function(ingest->db, "edb_detail", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+                                     NULL, detailFunc, NULL, NULL);
+    }
+    if(rc == SQLITE_OK)
+    {
+        rc = setupSearch(ingest);
+    }
+
+    if(rc == SQLITE_OK) rc = prepare(ingest, "BEGIN IMMEDIATE", &ingest->stmt_begin);
+    if(rc == SQLITE_OK) rc = prepare(ingest, "COMMIT", &ingest->stmt_commit);
+    if(rc == SQLITE_OK) rc = prepare(ingest,
+                                     "INSERT OR REPLACE INTO t_edb(channelId,eventId,startTime,duration,eventDetail) "
+                                     "VALUES(?1,?2,?3,?4,?5)", &ingest->stmt_put);
+    if(rc == SQLITE_OK) rc = prepare(ingest,
+                                     "DELETE FROM t_edb WHERE (?1<0 OR channelId=?1) AND startTime+duration<?2",
+                                     &ingest->stmt_expire);
+    if(rc == SQLITE_OK) rc = prepare(ingest,
+                                     "SELECT eventDetail,rowid FROM t_edb WHERE channelId=?1 AND eventId=?2",
+                                     &ingest->stmt_get);
+    if(rc == SQLITE_OK && ingest->fts)
+    {
+        rc = prepare(ingest, "UPDATE t_edb SET startTime=?2,duration=?3 WHERE rowid=?1", &ingest->stmt_touch);
+        if(rc == SQLITE_OK) rc = prepare(ingest, "INSERT INTO t_edb_fts(rowid,detail) VALUES(?1,?2)",
+                                         &ingest->stmt_fts_add);
+        if(rc == SQLITE_OK) rc = prepare(ingest,
+                                         "INSERT INTO t_edb_fts(t_edb_fts,rowid,detail) VALUES('delete',?1,?2)",
+                                         &ingest->stmt_fts_del);
+        if(rc == SQLITE_OK) rc = prepare(ingest,
+                                         "SELECT eventDetail,rowid FROM t_edb "
+                                         "WHERE (?1<0 OR channelId=?1) AND startTime+duration<?2",
+                                         &ingest->stmt_expire_list);
+    }
+
+    if(rc != SQLITE_OK)
+    {
+        edb_ingest_close(ingest);
+        return rc;
+    }
+    *pp_ingest = ingest;
+    return SQLITE_OK;
+}
+
+int edb_ingest_close(edb_ingest_t* ingest)
+{
+    int rc = SQLITE_OK;
+
+    if(ingest == NULL)
+    {
+        return SQLITE_OK;
+    }
+    rc = edb_ingest_flush(ingest);
+
+    sqlite3_finalize(ingest->stmt_begin);
+    sqlite3_finalize(ingest->stmt_commit);
+    sqlite3_finalize(ingest->stmt_put);
+    sqlite3_finalize(ingest->stmt_expire);
+    sqlite3_finalize(ingest->stmt_get);
+    sqlite3_finalize(ingest->stmt_touch);
+    sqlite3_finalize(ingest->stmt_fts_add);
+    sqlite3_finalize(ingest->stmt_fts_del);
+    sqlite3_finalize(ingest->stmt_expire_list);
+    if(ingest->db != NULL)
+    {
+        sqlite3_close(ingest->db);
+    }
+    if(ingest->zs_ready)
+    {
+        deflateEnd(&ingest->zs);
+    }
+    sqlite3_free(ingest->zbuf);
+    sqlite3_free(ingest);
+    return rc;
+}
+
+static int stepReset(sqlite3_stmt* stmt)
+{
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    return rc;
+}
+
+/*
+ ** Open the batch transaction before a write, if not yet.
+ */
+static int beginBatch(edb_ingest_t* ingest)
+{
+    int rc = SQLITE_OK;
+
+    if(ingest->pending == 0 && sqlite3_get_autocommit(ingest->db))
+    {
+        rc = stepReset(ingest->stmt_begin);
+        if(rc != SQLITE_DONE)
+        {
+            printf("edb: begin fail,err=%d %s\n", rc, sqlite3_errmsg(ingest->db));
+            return rc;
+        }
+    }
+    return SQLITE_OK;
+}
+
+/*
+ ** Count a write of the batch and commit once it is full.
+ */
+static int endWrite(edb_ingest_t* ingest)
+{
+    ingest->pending++;
+    if(ingest->pending >= ingest->cfg.batch_rows)
+    {
+        return edb_ingest_flush(ingest);
+    }
+    return SQLITE_OK;
+}
+
+int edb_ingest_flush(edb_ingest_t* ingest)
+{
+    int rc = SQLITE_OK;
+
+    if(ingest->pending == 0 || sqlite3_get_autocommit(ingest->db))
+    {
+        ingest->pending = 0;
+        return SQLITE_OK;
+    }
+    rc = stepReset(ingest->stmt_commit);
+    if(rc != SQLITE_DONE)
+    {
+        printf("edb: commit fail,err=%d %s\n", rc, sqlite3_errmsg(ingest->db));
+        return rc;
+    }
+    ingest->pending = 0;
+    ingest->stats.commits++;
+    return SQLITE_OK;
+}
+
+/*
+ ** Deflate |len| bytes of |detail| into zbuf after the header.
+ ** Return the compressed size, or 0 if that failed or did not pay.
+ */
+static unsigned long deflateDetail(edb_ingest_t* ingest, const char* detail, int len)
+{
+    z_stream*       zs   = &ingest->zs;
+    unsigned long   zlen = 0;
+
+    if(!ingest->zs_ready)
+    {
+        memset(zs, 0, sizeof(*zs));
+        if(deflateInit2(zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, EDB_Z_WINDOW_BITS,
+                        EDB_Z_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            return 0;
+        }
+        ingest->zs_ready = 1;
+    }
+    else if(deflateReset(zs) != Z_OK)
+    {
+        return 0;
+    }
+
+    zlen = deflateBound(zs, len);
+    if(ingest->zcap < zlen + EDB_ZHDR)
+    {
+        sqlite3_free(ingest->zbuf);
+        ingest->zcap = 0;
+        ingest->zbuf = sqlite3_malloc64(zlen + EDB_ZHDR);
+        if(ingest->zbuf == NULL)
+        {
+            return 0;
+        }
+        ingest->zcap = zlen + EDB_ZHDR;
+    }
+
+    zs->next_in   = (Bytef*)detail;
+    zs->avail_in  = len;
+    zs->next_out  = ingest->zbuf + EDB_ZHDR;
+    zs->avail_out = zlen;
+    if(deflate(zs, Z_FINISH) != Z_STREAM_END || zs->total_out + EDB_ZHDR >= (unsigned long)len)
+    {
+        return 0;
+    }
+    ingest->zbuf[0] = (unsigned char)(len >> 24);
+    ingest->zbuf[1] = (unsigned char)(len >> 16);
+    ingest->zbuf[2] = (unsigned char)(len >> 8);
+    ingest->zbuf[3] = (unsigned char)len;
+    return zs->total_out;
+}
+
+/*
+ ** Bind |detail| to parameter 5 of the put statement, deflated when that
+ ** makes it smaller. The compression buffer stays bound until the step.
+ */
+static int bindDetail(edb_ingest_t* ingest, const char* detail, int len)
+{
+    sqlite3_stmt*   stmt = ingest->stmt_put;
+    unsigned long   zlen = 0;
+
+    ingest->stats.detail_bytes += len;
+    if(ingest->cfg.compress && len >= EDB_COMPRESS_MIN)
+    {
+        zlen = deflateDetail(ingest, detail, len);
+    }
+    if(zlen > 0)
+    {
+        ingest->stats.compressed++;
+        ingest->stats.stored_bytes += zlen + EDB_ZHDR;
+        return sqlite3_bind_blob(stmt, 5, ingest->zbuf, (int)zlen + EDB_ZHDR, SQLITE_STATIC);
+    }
+    ingest->stats.stored_bytes += len;
+    return sqlite3_bind_text(stmt, 5, detail, len, SQLITE_STATIC);
+}
+
+static int putRow(edb_ingest_t* ingest, int channelId, int eventId,
+                  int startTime, int duration, const char* detail, int len)
+{
+    sqlite3_stmt*   stmt = ingest->stmt_put;
+    int             rc   = SQLITE_OK;
+
+    sqlite3_bind_int(stmt, 1, channelId);
+    sqlite3_bind_int(stmt, 2, eventId);
+    sqlite3_bind_int(stmt, 3, startTime);
+    sqlite3_bind_int(stmt, 4, duration);
+    rc = bindDetail(ingest, detail, len);
+    if(rc == SQLITE_OK)
+    {
+        rc = sqlite3_step(stmt);
+    }
+    /* unbind the detail, which belongs to the caller or to zbuf */
+    sqlite3_clear_bindings(stmt);
+    sqlite3_reset(stmt);
+    if(rc != SQLITE_DONE)
+    {
+        printf("edb: put %d/%d fail,err=%d %s\n", channelId, eventId, rc, sqlite3_errmsg(ingest->db));
+        return rc == SQLITE_OK ? SQLITE_ERROR : rc;
+    }
+    return SQLITE_OK;
+}
+
+/*
+ ** Add the detail of the event at |rowid| to the full-text index with
+ ** stmt_fts_add, or take the previous one out with stmt_fts_del.
+ */
+static int indexDetail(edb_ingest_t* ingest, sqlite3_stmt* stmt, sqlite3_int64 rowid,
+                       const char* detail, int len)
+{
+    int rc = SQLITE_OK;
+
+    sqlite3_bind_int64(stmt, 1, rowid);
+    sqlite3_bind_text(stmt, 2, detail, len, SQLITE_STATIC);
+    rc = sqlite3_step(stmt);
+    sqlite3_clear_bindings(stmt);
+    sqlite3_reset(stmt);
+    if(rc != SQLITE_DONE)
+    {
+        printf("edb: index %lld fail,err=%d %s\n", (long long)rowid, rc, sqlite3_errmsg(ingest->db));
+        return rc == SQLITE_OK ? SQLITE_ERROR : rc;
+    }
+    return SQLITE_OK;
+}
+
+/*
+ ** Put an event and keep the full-text index in step. A refresh mostly
+ ** puts events again as they are: then only the times are updated and the
+ ** index is left alone; otherwise the old detail is taken out of it and
+ ** the new one added.
+ */
+static int putIndexed(edb_ingest_t* ingest, int channelId, int eventId,
+                      int startTime, int duration, const char* detail, int len)
+{
+    sqlite3_stmt*   get   = ingest->stmt_get;
+    sqlite3_int64   rowid = 0;
+    int             same  = 0;
+    int             rc    = SQLITE_OK;
+
+    sqlite3_bind_int(get, 1, channelId);
+    sqlite3_bind_int(get, 2, eventId);
+    if(sqlite3_step(get) == SQLITE_ROW)
+    {
+        char*       tmp     = NULL;
+        int         old_len = 0;
+        const char* old     = columnDetail(get, 0, &old_len, &tmp);
+
+        rowid = sqlite3_column_int64(get, 1);
+        same  = old != NULL && old_len == len && memcmp(old, detail, len) == 0;
+        if(old != NULL && !same)
+        {
+            rc = indexDetail(ingest, ingest->stmt_fts_del, rowid, old, old_len);
+        }
+        sqlite3_free(tmp);
+    }
+    sqlite3_reset(get);
+    if(rc != SQLITE_OK)
+    {
+        return rc;
+    }
+
+    if(same)
+    {
+        sqlite3_bind_int64(ingest->stmt_touch, 1, rowid);
+        sqlite3_bind_int(ingest->stmt_touch, 2, startTime);
+        sqlite3_bind_int(ingest->stmt_touch, 3, duration);
+        rc = stepReset(ingest->stmt_touch);
+        if(rc != SQLITE_DONE)
+        {
+            printf("edb: put %d/%d fail,err=%d %s\n", channelId, eventId, rc, sqlite3_errmsg(ingest->db));
+            return rc;
+        }
+        ingest->stats.detail_bytes += len;
+        ingest->stats.unchanged++;
+        return SQLITE_OK;
+    }
+
+    rc = putRow(ingest, channelId, eventId, startTime, duration, detail, len);
+    if(rc == SQLITE_OK)
+    {
+        rc = indexDetail(ingest, ingest->stmt_fts_add, sqlite3_last_insert_rowid(ingest->db), detail, len);
+    }
+    if(rc == SQLITE_OK)
+    {
+        ingest->stats.indexed++;
+    }
+    return rc;
+}
+
+int edb_ingest_put(edb_ingest_t* ingest, int channelId, int eventId,
+                   int startTime, int duration, const char* detail, int len)
+{
+    int rc = SQLITE_OK;
+
+    if(detail == NULL)
+    {
+        detail = "";
+        len    = 0;
+    }
+    else if(len < 0)
+    {
+        len = strlen(detail);
+    }
+
+    rc = beginBatch(ingest);
+    if(rc != SQLITE_OK)
+    {
+        return rc;
+    }
+    if(ingest->fts)
+    {
+        rc = putIndexed(ingest, channelId, eventId, startTime, duration, detail, len);
+    }
+    else
+    {
+        rc = putRow(ingest, channelId, eventId, startTime, duration, detail, len);
+    }
+    if(rc != SQLITE_OK)
+    {
+        return rc;
+    }
+    ingest->stats.rows++;
+    return endWrite(ingest);
+}
+
+/*
+ ** Take the details of the events edb_ingest_expire() deletes out of the
+ ** full-text index.
+ */
+static int unindexExpired(edb_ingest_t* ingest, int channelId, int before)
+{
+    sqlite3_stmt*   list = ingest->stmt_expire_list;
+    int             rc   = SQLITE_OK;
+
+    sqlite3_bind_int(list, 1, channelId);
+    sqlite3_bind_int(list, 2, before);
+    while(rc == SQLITE_OK && sqlite3_step(list) == SQLITE_ROW)
+    {
+        char*       tmp  = NULL;
+        int         len  = 0;
+        const char* text = columnDetail(list, 0, &len, &tmp);
+
+        if(text != NULL)
+        {
+            rc = indexDetail(ingest, ingest->stmt_fts_del, sqlite3_column_int64(list, 1), text, len);
+        }
+        sqlite3_free(tmp);
+    }
+    sqlite3_reset(list);
+    return rc;
+}
+
+int edb_ingest_expire(edb_ingest_t* ingest, int channelId, int before)
+{
+    int rc = beginBatch(ingest);
+
+    if(rc == SQLITE_OK && ingest->fts)
+    {
+        rc = unindexExpired(ingest, channelId, before);
+    }
+    if(rc != SQLITE_OK)
+    {
+        return rc;
+    }
+    sqlite3_bind_int(ingest->stmt_expire, 1, channelId);
+    sqlite3_bind_int(ingest->stmt_expire, 2, before);
+    rc = stepReset(ingest->stmt_expire);
+    if(rc != SQLITE_DONE)
+    {
+        printf("edb: expire %d fail,err=%d %s\n", channelId, rc, sqlite3_errmsg(ingest->db));
+        return rc;
+    }
+    return endWrite(ingest);
+}
+
+int edb_ingest_get_detail(edb_ingest_t* ingest, int channelId, int eventId, char* buf, int size)
+{
+    sqlite3_stmt*   stmt = ingest->stmt_get;
+    const char*     text = NULL;
+    char*           tmp  = NULL;
+    int             len  = -1;
+
+    sqlite3_bind_int(stmt, 1, channelId);
+    sqlite3_bind_int(stmt, 2, eventId);
+    if(sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        text = columnDetail(stmt, 0, &len, &tmp);
+        if(text == NULL)
+        {
+            len = -1;
+        }
+        else if(size > 0)
+        {
+            int n = len < size - 1 ? len : size - 1;
+            memcpy(buf, text, n);
+            buf[n] = 0;
+        }
+    }
+    sqlite3_reset(stmt);
+    sqlite3_free(tmp);
+    return len;
+}
+
+void edb_ingest_get_stats(edb_ingest_t* ingest, edb_ingest_stats_t* stats)
+{
+    *stats = ingest->stats;
+}
+
+sqlite3* edb_ingest_db(edb_ingest_t* ingest)
+{
+    return ingest->db;
+}
@@ -0,0 +1,129 @@
+/*
+ * EPG database ingestion
+ *
+ * Writes EIT events into the EPG store (/3rd_rw/edb.db) in batched
+ * transactions with cached prepared statements. Events are upserted by
+ * (channelId, eventId), so a schedule refresh simply puts every event it
+ * receives again.
+ *
+ * # Table define (schema version 2)
+ * CREATE TABLE t_edb(channelId INT, eventId INT, startTime INT,
+ *                    duration INT, eventDetail);
+ * CREATE UNIQUE INDEX index_ch_event on t_edb(channelId,eventId)
+ * CREATE INDEX index_ch_time on t_edb(channelId,startTime,duration,eventId)
+ *
+ * index_ch_time covers the grid queries of edb_query.h, by time window.
+ *
+ * eventDetail is TEXT, or a BLOB when it was stored compressed: a 4 byte
+ * big endian original length followed by the deflate stream. Readers that
+ * use plain SQL can wrap the column in edb_detail(), which returns the
+ * text in both cases.
+ *
+ * The full-text index t_edb_fts of edb_search.h is optional: it is built
+ * from the table when a handle with search set opens the database, and
+ * dropped by one without, so that it is never out of date. While it exists
+ * a put whose detail did not change only updates the event times, and
+ * only changed details are indexed again.
+ *
+ * A handle is not thread safe; the EIT parser owns it.
+ */
+#ifndef _EDB_INGEST_H_
+#define _EDB_INGEST_H_
+
+#include "sqlite3.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EDB_SCHEMA_VERSION      2
+
+/* synchronous levels, as PRAGMA synchronous */
+#define EDB_SYNC_OFF            0
+#define EDB_SYNC_NORMAL         1
+#define EDB_SYNC_FULL           2
+
+typedef struct edb_ingest_config
+{
+    int     page_size;      /* bytes, only applies to a new database; 0 keeps the default */
+    int     cache_kb;       /* page cache size; 0 keeps the default */
+    int     wal;            /* journal_mode=WAL instead of DELETE */
+    int     synchronous;    /* EDB_SYNC_xxx */
+    int     batch_rows;     /* rows per transaction; 1 commits every row */
+    int     compress;       /* store eventDetail deflated when it gets smaller */
+    int     search;         /* keep the full-text index of edb_search.h */
+} edb_ingest_config_t;
+
+typedef struct edb_ingest_stats
+{
+    unsigned int    rows;           /* rows put */
+    unsigned int    commits;        /* transactions committed */
+    unsigned int    compressed;     /* details stored compressed */
+    unsigned int    detail_bytes;   /* detail bytes given */
+    unsigned int    stored_bytes;   /* detail bytes written */
+    unsigned int    indexed;        /* details added to the full-text index */
+    unsigned int    unchanged;      /* puts of an event with the same detail */
+} edb_ingest_stats_t;
+
+typedef struct edb_ingest edb_ingest_t;
+
+/*
+ ** Fill |cfg| with the settings used for the EPG store on eMMC:
+ ** WAL, synchronous NORMAL, default page size (the eMMC program unit with
+ ** the emmc VFS, see emmc_vfs.h), 500 rows per transaction, with the
+** full-text index.
+ */
+void edb_ingest_default_config(edb_ingest_config_t* cfg);
+
+/*
+ ** Open (and create or migrate) the EPG database at |path|. A table from
+ ** before schema version 1 is dropped, the EPG being rebuilt from the
+ ** broadcast anyway; later versions are upgraded in place. |cfg| may be
+ ** NULL for the defaults.
+ ** Return SQLITE_OK, or a sqlite error code with *pp_ingest set to NULL.
+ */
+int edb_ingest_open(const char* path, const edb_ingest_config_t* cfg, edb_ingest_t** pp_ingest);
+
+/*
+ ** Commit the pending batch and close the database. |ingest| may be NULL.
+ */
+int edb_ingest_close(edb_ingest_t* ingest);
+
+/*
+ ** Insert or replace one event. |detail| of |len| bytes (-1 for a NUL
+ ** terminated string) is copied. The row is committed at the latest once
+ ** batch_rows rows are pending, or by edb_ingest_flush().
+ */
+int edb_ingest_put(edb_ingest_t* ingest, int channelId, int eventId,
+                   int startTime, int duration, const char* detail, int len);
+
+/*
+ ** Delete the events of |channelId|, or of all channels if it is -1, that
+ ** ended before |before|. Part of the pending batch.
+ */
+int edb_ingest_expire(edb_ingest_t* ingest, int channelId, int before);
+
+/*
+ ** Commit the pending batch, if any.
+ */
+int edb_ingest_flush(edb_ingest_t* ingest);
+
+/*
+ ** Copy the detail of an event, decompressed, into |buf| of |size| bytes,
+ ** NUL terminated and truncated if needed.
+ ** Return the full detail length, or -1 if the event is not found.
+ */
+int edb_ingest_get_detail(edb_ingest_t* ingest, int channelId, int eventId, char* buf, int size);
+
+void edb_ingest_get_stats(edb_ingest_t* ingest, edb_ingest_stats_t* stats);
+
+/*
+ ** The database connection, for queries of the caller's own.
+ */
+sqlite3* edb_ingest_db(edb_ingest_t* ingest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _EDB_INGEST_H_ */
@@ -0,0 +1,713 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "sqlite3.h"
+#include "edb_ingest.h"
+#include "edb_query.h"
+
+/*
+ * A tile holds the events of one channel overlapping [slot, slot + 1) *
+ * tile_seconds, so an event crossing a tile boundary is in both tiles; a
+ * window emits it from the first of its tiles only.
+ *
+ * The tiles are a plain array searched linearly: a window is a few dozen
+ * tiles and max_tiles a few hundred, which costs less than a hash would
+ * to maintain. The least recently used tile is replaced.
+ */
+
+#define EDB_DEFAULT_TILE_SECONDS    (2 * 3600)
+#define EDB_DEFAULT_MAX_TILES       512
+
+/* longest event looked back for from the start of a tile */
+#define EDB_MAX_DURATION            (24 * 3600)
+
+#define EDB_PREFETCH_QUEUE          128
+
+/*
+ * PRAGMA data_version takes the database read lock, which costs more than
+ * a whole window served from memory; an EIT update can wait that long to
+ * show up.
+ */
+#define EDB_VERSION_CHECK_US        500000
+
+typedef struct edb_tile
+{
+    int                 used;
+    int                 channelId;
+    int                 slot;
+    unsigned int        stamp;
+    int                 count;
+    edb_grid_event_t*   events;
+} edb_tile_t;
+
+typedef struct edb_tile_req
+{
+    int                 channelId;
+    int                 slot;
+} edb_tile_req_t;
+
+struct edb_query
+{
+    edb_query_config_t  cfg;
+
+    sqlite3*            db;
+    sqlite3_stmt*       stmt_range;
+    sqlite3_stmt*       stmt_version;
+    int                 data_version;
+    unsigned int        version_checked;    /* nowUs() of the last check */
+
+    int*                channels;
+    int                 channel_count;
+
+    /* tiles, prefetch queue and stats; the UI thread and prefetcher share them */
+    pthread_mutex_t     lock;
+    edb_tile_t*         tiles;
+    unsigned int        clock;
+    unsigned int        generation;     /* bumped when tiles are dropped */
+    edb_query_stats_t   stats;
+
+    /* previous window, for the scroll direction */
+    int                 have_prev;
+    int                 prev_row0;
+    int                 prev_t0;
+
+    unsigned int        samples[EDB_QUERY_SAMPLES];
+    unsigned int        sample_count;
+
+    /* prefetch thread */
+    int                 prefetch_running;
+    int                 prefetch_stop;
+    pthread_t           prefetch_thread;
+    pthread_cond_t      prefetch_cond;
+    sqlite3*            pdb;
+    sqlite3_stmt*       pstmt_range;
+    edb_tile_req_t      queue[EDB_PREFETCH_QUEUE];
+    int                 queue_head;
+    int                 queue_count;
+};
+
+static const char rangeSql[] =
+    "SELECT eventId,startTime,duration FROM t_edb "
+    "WHERE channelId=?1 AND startTime>?2 AND startTime<?3 AND startTime+duration>?4 "
+    "ORDER BY startTime";
+
+void edb_query_default_config(edb_query_config_t* cfg)
+{
+    cfg->tile_seconds = EDB_DEFAULT_TILE_SECONDS;
+    cfg->max_tiles    = EDB_DEFAULT_MAX_TILES;
+    cfg->prefetch     = 1;
+    cfg->cache        = 1;
+}
+
+static unsigned int nowUs(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (unsigned int)(tp.tv_sec * 1000000 + tp.tv_nsec / 1000);
+}
+
+/* floor division, for times before the epoch */
+static int slotOf(edb_query_t* query, int t)
+{
+    int w = query->cfg.tile_seconds;
+    return t >= 0 ? t / w : -((-t + w - 1) / w);
+}
+
+/*
+ ** Load the events of |channelId| overlapping [begin, end) by start time.
+ ** Return their number with the array in *p_events, to free with
+ ** sqlite3_free, or -1.
+ */
+static int loadRange(sqlite3_stmt* stmt, int channelId, int begin, int end, edb_grid_event_t** p_events)
+{
+    edb_grid_event_t*   events = NULL;
+    int                 count  = 0;
+    int                 cap    = 0;
+    int                 rc     = SQLITE_OK;
+
+    sqlite3_bind_int(stmt, 1, channelId);
+    sqlite3_bind_int(stmt, 2, begin - EDB_MAX_DURATION);
+    sqlite3_bind_int(stmt, 3, end);
+    sqlite3_bind_int(stmt, 4, begin);
+    while((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        if(count == cap)
+        {
+            edb_grid_event_t* grown = NULL;
+
+            cap   = cap ? cap * 2 : 16;
+            grown = sqlite3_realloc(events, cap * sizeof(*events));
+            if(grown == NULL)
+            {
+                rc = SQLITE_NOMEM;
+                break;
+            }
+            events = grown;
+        }
+        events[count].channelId = channelId;
+        events[count].eventId   = sqlite3_column_int(stmt, 0);
+        events[count].startTime = sqlite3_column_int(stmt, 1);
+        events[count].duration  = sqlite3_column_int(stmt, 2);
+        count++;
+    }
+    sqlite3_reset(stmt);
+
+    if(rc != SQLITE_DONE)
+    {
+        printf("edb: query channel %d fail,err=%d\n", channelId, rc);
+        sqlite3_free(events);
+        return -1;
+    }
+    *p_events = events;
+    return count;
+}
+
+static edb_tile_t* findTile(edb_query_t* query, int channelId, int slot)
+{
+    int i = 0;
+
+    for(i = 0; i < query->cfg.max_tiles; i++)
+    {
+        edb_tile_t* tile = &query->tiles[i];
+        if(tile->used && tile->channelId == channelId && tile->slot == slot)
+        {
+            return tile;
+        }
+    }
+    return NULL;
+}
+
+static void dropTile(edb_tile_t* tile)
+{
+    sqlite3_free(tile->events);
+    tile->events = NULL;
+    tile->count  = 0;
+    tile->used   = 0;
+}
+
+/*
+ ** Store a loaded tile, replacing the least recently used one, unless it
+ ** got there meanwhile. Takes |events|. Called locked.
+ */
+static edb_tile_t* insertTile(edb_query_t* query, int channelId, int slot, edb_grid_event_t* events, int count)
+{
+    edb_tile_t* tile   = findTile(query, channelId, slot);
+    edb_tile_t* victim = NULL;
+    int         i      = 0;
+
+    if(tile != NULL)
+    {
+        sqlite3_free(events);
+        return tile;
+    }
+    for(i = 0; i < query->cfg.max_tiles; i++)
+    {
+        tile = &query->tiles[i];
+        if(!tile->used)
+        {
+            victim = tile;
+            break;
+        }
+        if(victim == NULL || (int)(tile->stamp - victim->stamp) < 0)
+        {
+            victim = tile;
+        }
+    }
+    dropTile(victim);
+    victim->used      = 1;
+    victim->channelId = channelId;
+    victim->slot      = slot;
+    victim->stamp     = query->clock;
+    victim->events    = events;
+    victim->count     = count;
+    return victim;
+}
+
+/*
+ ** Drop the tiles of |channelId|, or all for -1, and the queued
+ ** prefetches, whose results would be stale. Called locked.
+ */
+static void invalidateLocked(edb_query_t* query, int channelId)
+{
+    int i = 0;
+
+    for(i = 0; i < query->cfg.max_tiles; i++)
+    {
+        if(query->tiles[i].used && (channelId < 0 || query->tiles[i].channelId == channelId))
+        {
+            dropTile(&query->tiles[i]);
+        }
+    }
+    query->generation++;
+    query->queue_count = 0;
+}
+
+/*
+ ** Drop everything if another connection committed since the last check.
+ */
+static void checkDataVersion(edb_query_t* query, unsigned int now)
+{
+    int version = query->data_version;
+
+    if(now - query->version_checked < EDB_VERSION_CHECK_US)
+    {
+        return;
+    }
+    query->version_checked = now;
+    if(sqlite3_step(query->stmt_version) == SQLITE_ROW)
+    {
+        version = sqlite3_column_int(query->stmt_version, 0);
+    }
+    sqlite3_reset(query->stmt_version);
+
+    if(version != query->data_version)
+    {
+        query->data_version = version;
+        pthread_mutex_lock(&query->lock);
+        invalidateLocked(query, -1);
+        query->stats.invalidations++;
+        pthread_mutex_unlock(&query->lock);
+    }
+}
+
+static void *prefetchMain(void* arg)
+{
+    edb_query_t* query = arg;
+
+    pthread_mutex_lock(&query->lock);
+    while(!query->prefetch_stop)
+    {
+        edb_tile_req_t      req;
+        edb_grid_event_t*   events     = NULL;
+        unsigned int        generation = 0;
+        int                 count      = 0;
+
+        if(query->queue_count == 0)
+        {
+            pthread_cond_wait(&query->prefetch_cond, &query->lock);
+            continue;
+        }
+        req = query->queue[query->queue_head];
+        query->queue_head = (query->queue_head + 1) % EDB_PREFETCH_QUEUE;
+        query->queue_count--;
+        if(findTile(query, req.channelId, req.slot) != NULL)
+        {
+            continue;
+        }
+        generation = query->generation;
+        pthread_mutex_unlock(&query->lock);
+
+        count = loadRange(query->pstmt_range, req.channelId, req.slot * query->cfg.tile_seconds,
+                          (req.slot + 1) * query->cfg.tile_seconds, &events);
+
+        pthread_mutex_lock(&query->lock);
+        if(count >= 0 && generation == query->generation)
+        {
+            insertTile(query, req.channelId, req.slot, events, count);
+            query->stats.prefetches++;
+        }
+        else if(count >= 0)
+        {
+            sqlite3_free(events);
+        }
+    }
+    pthread_mutex_unlock(&query->lock);
+    return NULL;
+}
+
+/*
+ ** Queue the tiles of rows [row0, row1) by slots [s0, s1) that are not in
+ ** memory. Called locked.
+ */
+static void queueTiles(edb_query_t* query, int row0, int row1, int s0, int s1)
+{
+    int row  = 0;
+    int slot = 0;
+
+    if(row0 < 0) row0 = 0;
+    if(row1 > query->channel_count) row1 = query->channel_count;
+    for(row = row0; row < row1; row++)
+    {
+        for(slot = s0; slot < s1; slot++)
+        {
+            int channelId = query->channels[row];
+            int tail      = (query->queue_head + query->queue_count) % EDB_PREFETCH_QUEUE;
+
+            if(query->queue_count == EDB_PREFETCH_QUEUE)
+            {
+                return;
+            }
+            if(findTile(query, channelId, slot) == NULL)
+            {
+                query->queue[tail].channelId = channelId;
+                query->queue[tail].slot      = slot;
+                query->queue_count++;
+            }
+        }
+    }
+}
+
+/*
+ ** Replace the prefetch queue by the tiles next to the window in the
+ ** direction it moved to, or on all sides when it did not move.
+ */
+static void prefetchAround(edb_query_t* query, int row0, int rows, int s0, int s1, int t0)
+{
+    int dr  = query->have_prev ? row0 - query->prev_row0 : 0;
+    int dt  = query->have_prev ? t0 - query->prev_t0 : 0;
+    int any = dr == 0 && dt == 0;
+
+    pthread_mutex_lock(&query->lock);
+    query->queue_count = 0;
+    if(dt > 0 || any) queueTiles(query, row0, row0 + rows, s1, s1 + 1);
+    if(dt < 0 || any) queueTiles(query, row0, row0 + rows, s0 - 1, s0);
+    if(dr > 0 || any) queueTiles(query, row0 + rows, row0 + 2 * rows, s0, s1);
+    if(dr < 0 || any) queueTiles(query, row0 - rows, row0, s0, s1);
+    if(query->queue_count > 0)
+    {
+        pthread_cond_signal(&query->prefetch_cond);
+    }
+    pthread_mutex_unlock(&query->lock);
+}
+
+/*
+ ** Append the events of |tile| overlapping [t0, t1) to |events|; those
+ ** starting before the tile only if it is the first one of the window.
+ */
+static int emitEvents(const edb_grid_event_t* tile, int count, int begin, int first,
+                      int t0, int t1, edb_grid_event_t* events, int n, int max)
+{
+    int i = 0;
+
+    for(i = 0; i < count; i++)
+    {
+        const edb_grid_event_t* e = &tile[i];
+
+        if(e->startTime >= t1 || e->startTime + e->duration <= t0)
+        {
+            continue;
+        }
+        if(!first && e->startTime < begin)
+        {
+            continue;
+        }
+        if(n < max)
+        {
+            events[n] = *e;
+        }
+        n++;
+    }
+    return n;
+}
+
+static void addSample(edb_query_t* query, unsigned int us)
+{
+    query->samples[query->sample_count % EDB_QUERY_SAMPLES] = us;
+    query->sample_count++;
+}
+
+int edb_query_window(edb_query_t* query, int row0, int rows, int t0, int t1,
+                     edb_grid_event_t* events, int max)
+{
+    unsigned int    start = nowUs();
+    int             s0    = slotOf(query, t0);
+    int             s1    = slotOf(query, t1 - 1) + 1;
+    int             n     = 0;
+    int             row   = 0;
+    int             slot  = 0;
+
+    if(row0 < 0)
+    {
+        rows += row0;
+        row0  = 0;
+    }
+    if(row0 + rows > query->channel_count)
+    {
+        rows = query->channel_count - row0;
+    }
+    if(rows <= 0 || t1 <= t0)
+    {
+        return 0;
+    }
+
+    if(!query->cfg.cache)
+    {
+        for(row = row0; row < row0 + rows; row++)
+        {
+            edb_grid_event_t*   loaded = NULL;
+            int                 count  = loadRange(query->stmt_range, query->channels[row], t0, t1, &loaded);
+
+            if(count < 0)
+            {
+                return -1;
+            }
+            n = emitEvents(loaded, count, t0, 1, t0, t1, events, n, max);
+            sqlite3_free(loaded);
+        }
+        pthread_mutex_lock(&query->lock);
+        query->stats.windows++;
+        addSample(query, nowUs() - start);
+        pthread_mutex_unlock(&query->lock);
+        return n;
+    }
+
+    checkDataVersion(query, start);
+
+    pthread_mutex_lock(&query->lock);
+    query->clock++;
+    for(row = row0; row < row0 + rows; row++)
+    {
+        int channelId = query->channels[row];
+
+        for(slot = s0; slot < s1; slot++)
+        {
+            edb_tile_t* tile = findTile(query, channelId, slot);
+
+            if(tile != NULL)
+            {
+                query->stats.tile_hits++;
+            }
+            else
+            {
+                edb_grid_event_t*   loaded     = NULL;
+                unsigned int        generation = query->generation;
+                int                 count      = 0;
+
+                pthread_mutex_unlock(&query->lock);
+                count = loadRange(query->stmt_range, channelId, slot * query->cfg.tile_seconds,
+                                  (slot + 1) * query->cfg.tile_seconds, &loaded);
+                pthread_mutex_lock(&query->lock);
+                if(count < 0)
+                {
+                    pthread_mutex_unlock(&query->lock);
+                    return -1;
+                }
+                query->stats.tile_loads++;
+                if(generation != query->generation)
+                {
+                    /* only edb_query_invalidate() from another thread gets here */
+                    sqlite3_free(loaded);
+                    slot--;
+                    continue;
+                }
+                tile = insertTile(query, channelId, slot, loaded, count);
+            }
+            tile->stamp = query->clock;
+            n = emitEvents(tile->events, tile->count, slot * query->cfg.tile_seconds,
+                           slot == s0, t0, t1, events, n, max);
+        }
+    }
+    query->stats.windows++;
+    addSample(query, nowUs() - start);
+    pthread_mutex_unlock(&query->lock);
+
+    if(query->prefetch_running)
+    {
+        prefetchAround(query, row0, rows, s0, s1, t0);
+    }
+    query->have_prev = 1;
+    query->prev_row0 = row0;
+    query->prev_t0   = t0;
+    return n;
+}
+
+int edb_query_set_channels(edb_query_t* query, const int* channels, int count)
+{
+    int* copy = NULL;
+
+    if(count > 0)
+    {
+        copy = sqlite3_malloc(count * sizeof(*copy));
+        if(copy == NULL)
+        {
+            return SQLITE_NOMEM;
+        }
+        memcpy(copy, channels, count * sizeof(*copy));
+    }
+    pthread_mutex_lock(&query->lock);
+    sqlite3_free(query->channels);
+    query->channels      = copy;
+    query->channel_count = count > 0 ? count : 0;
+    query->queue_count   = 0;
+    query->have_prev     = 0;
+    pthread_mutex_unlock(&query->lock);
+    return SQLITE_OK;
+}
+
+void edb_query_invalidate(edb_query_t* query, int channelId)
+{
+    pthread_mutex_lock(&query->lock);
+    invalidateLocked(query, channelId);
+    pthread_mutex_unlock(&query->lock);
+}
+
+static int compareUint(const void* a, const void* b)
+{
+    unsigned int x = *(const unsigned int*)a;
+    unsigned int y = *(const unsigned int*)b;
+    return x < y ? -1 : x > y;
+}
+
+void edb_query_get_stats(edb_query_t* query, edb_query_stats_t* stats)
+{
+    unsigned int    sorted[EDB_QUERY_SAMPLES];
+    unsigned int    n = 0;
+
+    pthread_mutex_lock(&query->lock);
+    *stats = query->stats;
+    n = query->sample_count < EDB_QUERY_SAMPLES ? query->sample_count : EDB_QUERY_SAMPLES;
+    memcpy(sorted, query->samples, n * sizeof(sorted[0]));
+    pthread_mutex_unlock(&query->lock);
+
+    if(n > 0)
+    {
+        qsort(sorted, n, sizeof(sorted[0]), compareUint);
+        stats->p50_us = sorted[n * 50 / 100];
+        stats->p90_us = sorted[n * 90 / 100];
+        stats->p99_us = sorted[n * 99 / 100];
+        stats->max_us = sorted[n - 1];
+    }
+}
+
+static int openConnection(const char* path, sqlite3** pp_db, sqlite3_stmt** pp_range)
+{
+    int rc = sqlite3_open_v2(path, pp_db, SQLITE_OPEN_READONLY, NULL);
+
+    if(rc != SQLITE_OK)
+    {
+        printf("Can't open database: %s\n", path);
+        return rc;
+    }
+    sqlite3_busy_timeout(*pp_db, 1000);
+    rc = sqlite3_prepare_v2(*pp_db, rangeSql, -1, pp_range, NULL);
+    if(rc != SQLITE_OK)
+    {
+        printf("edb: prepare %s fail,err=%d %s\n", rangeSql, rc, sqlite3_errmsg(*pp_db));
+    }
+    return rc;
+}
+
+int edb_query_open(const char* path, const edb_query_config_t* cfg, edb_query_t** pp_query)
+{
+    edb_query_t*    query = NULL;
+    int             rc    = SQLITE_OK;
+
+    *pp_query = NULL;
+    query = sqlite3_malloc(sizeof(*query));
+    if(query == NULL)
+    {
+        return SQLITE_NOMEM;
+    }
+    memset(query, 0, sizeof(*query));
+    if(cfg != NULL)
+    {
+        query->cfg = *cfg;
+    }
+    else
+    {
+        edb_query_default_config(&query->cfg);
+    }
+    if(query->cfg.tile_seconds <= 0)
+    {
+        query->cfg.tile_seconds = EDB_DEFAULT_TILE_SECONDS;
+    }
+    if(query->cfg.max_tiles <= 0)
+    {
+        query->cfg.max_tiles = EDB_DEFAULT_MAX_TILES;
+    }
+    pthread_mutex_init(&query->lock, NULL);
+    pthread_cond_init(&query->prefetch_cond, NULL);
+
+    query->tiles = sqlite3_malloc(query->cfg.max_tiles * sizeof(*query->tiles));
+    if(query->tiles == NULL)
+    {
+        edb_query_close(query);
+        return SQLITE_NOMEM;
+    }
+    memset(query->tiles, 0, query->cfg.max_tiles * sizeof(*query->tiles));
+
+    rc = openConnection(path, &query->db, &query->stmt_range);
+    if(rc == SQLITE_OK && sqlite3_prepare_v2(query->db, "PRAGMA user_version", -1, &query->stmt_version, NULL) == SQLITE_OK &&
+       sqlite3_step(query->stmt_version) == SQLITE_ROW &&
+       sqlite3_column_int(query->stmt_version, 0) != EDB_SCHEMA_VERSION)
+    {
+        printf("edb: schema version %d, expected %d\n", sqlite3_column_int(query->stmt_version, 0), EDB_SCHEMA_VERSION);
+        rc = SQLITE_MISMATCH;
+    }
+    sqlite3_finalize(query->stmt_version);
+    query->stmt_version = NULL;
+    if(rc == SQLITE_OK)
+    {
+        rc = sqlite3_prepare_v2(query->db, "PRAGMA data_version", -1, &query->stmt_version, NULL);
+    }
+    if(rc == SQLITE_OK && sqlite3_step(query->stmt_version) == SQLITE_ROW)
+    {
+        query->data_version    = sqlite3_column_int(query->stmt_version, 0);
+        query->version_checked = nowUs();
+    }
+    sqlite3_reset(query->stmt_version);
+
+    if(rc == SQLITE_OK && query->cfg.cache && query->cfg.prefetch)
+    {
+        rc = openConnection(path, &query->pdb, &query->pstmt_range);
+        if(rc == SQLITE_OK)
+        {
+            if(pthread_create(&query->prefetch_thread, NULL, prefetchMain, query) == 0)
+            {
+                query->prefetch_running = 1;
+            }
+            else
+            {
+                printf("edb: no prefetch thread\n");
+            }
+        }
+    }
+
+    if(rc != SQLITE_OK)
+    {
+        edb_query_close(query);
+        return rc;
+    }
+    *pp_query = query;
+    return SQLITE_OK;
+}
+
+void edb_query_close(edb_query_t* query)
+{
+    int i = 0;
+
+    if(query == NULL)
+    {
+        return;
+    }
+    if(query->prefetch_running)
+    {
+        pthread_mutex_lock(&query->lock);
+        query->prefetch_stop = 1;
+        pthread_cond_signal(&query->prefetch_cond);
+        pthread_mutex_unlock(&query->lock);
+        pthread_join(query->prefetch_thread, NULL);
+    }
+
+    sqlite3_finalize(query->pstmt_range);
+    sqlite3_close(query->pdb);
+    sqlite3_finalize(query->stmt_range);
+    sqlite3_finalize(query->stmt_version);
+    sqlite3_close(query->db);
+
+    if(query->tiles != NULL)
+    {
+        for(i = 0; i < query->cfg.max_tiles; i++)
+        {
+            dropTile(&query->tiles[i]);
+        }
+    }
+    sqlite3_free(query->tiles);
+    sqlite3_free(query->channels);
+    pthread_cond_destroy(&query->prefetch_cond);
+    pthread_mutex_destroy(&query->lock);
+    sqlite3_free(query);
+}
@@ -0,0 +1,102 @@
+/*
+ * EPG grid queries
+ *
+ * The EPG grid shows a window of channel rows by a time range and scrolls
+ * in both directions. Each grid redraw would be one query per row; instead
+ * the events are kept in memory in tiles of one channel by tile_seconds,
+ * loaded through the covering index index_ch_time (see edb_ingest.h).
+ * The tiles of the visible window are loaded on demand, those next to it
+ * in the scroll direction by a prefetch thread with its own connection,
+ * so that the next scroll step is usually served from memory.
+ *
+ * Tiles are dropped when another connection commits to the database, as
+ * told by PRAGMA data_version, so a running EIT refresh shows up on the
+ * next redraw.
+ *
+ * A handle belongs to the UI thread.
+ */
+#ifndef _EDB_QUERY_H_
+#define _EDB_QUERY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* latency samples kept for edb_query_get_stats() */
+#define EDB_QUERY_SAMPLES       1024
+
+typedef struct edb_query_config
+{
+    int     tile_seconds;   /* time span of a tile */
+    int     max_tiles;      /* tiles kept in memory */
+    int     prefetch;       /* load the tiles next to the window in the background */
+    int     cache;          /* 0 queries the database for every window, for comparison */
+} edb_query_config_t;
+
+typedef struct edb_grid_event
+{
+    int     channelId;
+    int     eventId;
+    int     startTime;
+    int     duration;
+} edb_grid_event_t;
+
+typedef struct edb_query_stats
+{
+    unsigned int    windows;        /* edb_query_window() calls */
+    unsigned int    tile_hits;      /* tiles found in memory */
+    unsigned int    tile_loads;     /* tiles loaded by the UI thread */
+    unsigned int    prefetches;     /* tiles loaded by the prefetch thread */
+    unsigned int    invalidations;  /* cache drops on database change */
+    /* window latency over the last EDB_QUERY_SAMPLES calls, in us */
+    unsigned int    p50_us;
+    unsigned int    p90_us;
+    unsigned int    p99_us;
+    unsigned int    max_us;
+} edb_query_stats_t;
+
+typedef struct edb_query edb_query_t;
+
+/*
+ ** Fill |cfg| with the defaults: 2 hour tiles, 512 tiles, prefetch on.
+ */
+void edb_query_default_config(edb_query_config_t* cfg);
+
+/*
+ ** Open the EPG database at |path| for reading. The database must be at
+ ** EDB_SCHEMA_VERSION, i.e. opened once by edb_ingest_open(). |cfg| may be
+ ** NULL for the defaults.
+ ** Return SQLITE_OK, or a sqlite error code with *pp_query set to NULL.
+ */
+int edb_query_open(const char* path, const edb_query_config_t* cfg, edb_query_t** pp_query);
+
+void edb_query_close(edb_query_t* query);
+
+/*
+ ** Set the channel list the grid rows are indexes in. |channels| is copied.
+ */
+int edb_query_set_channels(edb_query_t* query, const int* channels, int count);
+
+/*
+ ** Get the events of grid rows [row0, row0 + rows) overlapping the time
+ ** range [t0, t1), row by row and by start time. Up to |max| events are
+ ** stored in |events|.
+ ** Return the number of events in the window, which may be more than
+ ** |max|, or -1 on error.
+ */
+int edb_query_window(edb_query_t* query, int row0, int rows, int t0, int t1,
+                     edb_grid_event_t* events, int max);
+
+/*
+ ** Drop the cached events of |channelId|, or all if it is -1. Commits to
+ ** the database are noticed without it.
+ */
+void edb_query_invalidate(edb_query_t* query, int channelId);
+
+void edb_query_get_stats(edb_query_t* query, edb_query_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _EDB_QUERY_H_ */
@@ -0,0 +1,363 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef EDB_SEARCH_ICU
+#include <unicode/ubrk.h>
+#include <unicode/ustring.h>
+#include <unicode/utext.h>
+#endif
+
+#include "sqlite3.h"
+#include "edb_search.h"
+
+/*
+ * Reference document https://www.sqlite.org/fts5.html
+ *
+ * bm25() weighs a word by how rare it is over all the events, so "final"
+ * ranks a match in a short title above one deep in a long synopsis. The
+ * word break iterator is opened once per tokenizer, i.e. per connection,
+ * as opening one loads the break rules and dictionaries.
+ */
+
+/* longest word case folded, in UTF-16 units; longer ones are indexed as is */
+#define EDB_TOKEN_MAX           64
+
+struct edb_search
+{
+    sqlite3*        db;
+    sqlite3_stmt*   stmt_match;
+};
+
+#ifdef EDB_SEARCH_ICU
+
+typedef struct edb_tokenizer
+{
+    UBreakIterator* brk;
+} edb_tokenizer_t;
+
+static int tokCreate(void* ctx, const char** azArg, int nArg, Fts5Tokenizer** ppOut)
+{
+    edb_tokenizer_t*    tok    = NULL;
+    UErrorCode          status = U_ZERO_ERROR;
+
+    tok = sqlite3_malloc(sizeof(*tok));
+    if(tok == NULL)
+    {
+        return SQLITE_NOMEM;
+    }
+    /* tokenize='edb th_TH' for the rules of a locale, the root ones otherwise */
+    tok->brk = ubrk_open(UBRK_WORD, nArg > 0 ? azArg[0] : "", NULL, 0, &status);
+    if(U_FAILURE(status))
+    {
+        printf("edb: word break iterator fail,err=%s\n", u_errorName(status));
+        sqlite3_free(tok);
+        return SQLITE_ERROR;
+    }
+    *ppOut = (Fts5Tokenizer*)tok;
+    return SQLITE_OK;
+}
+
+static void tokDelete(Fts5Tokenizer* p)
+{
+    edb_tokenizer_t* tok = (edb_tokenizer_t*)p;
+
+    ubrk_close(tok->brk);
+    sqlite3_free(tok);
+}
+
+/*
+ ** Case fold the word of |n| bytes at |word| into |out|.
+ ** Return its length, or -1 if it does not fit.
+ */
+static int foldWord(const char* word, int n, char* out, int size)
+{
+    UChar       src[EDB_TOKEN_MAX];
+    UChar       dst[EDB_TOKEN_MAX];
+    int32_t     len    = 0;
+    UErrorCode  status = U_ZERO_ERROR;
+
+    u_strFromUTF8(src, EDB_TOKEN_MAX, &len, word, n, &status);
+    if(U_SUCCESS(status))
+    {
+        len = u_strFoldCase(dst, EDB_TOKEN_MAX, src, len, U_FOLD_CASE_DEFAULT, &status);
+    }
+    if(U_SUCCESS(status))
+    {
+        u_strToUTF8(out, size, &len, dst, len, &status);
+    }
+    return U_SUCCESS(status) && status != U_STRING_NOT_TERMINATED_WARNING ? len : -1;
+}
+
+static int tokTokenize(Fts5Tokenizer* p, void* ctx, int flags, const char* text, int n,
+                       int (*xToken)(void*, int, const char*, int, int, int))
+{
+    edb_tokenizer_t*    tok    = (edb_tokenizer_t*)p;
+    UText               ut     = UTEXT_INITIALIZER;
+    UErrorCode          status = U_ZERO_ERROR;
+    char                folded[EDB_TOKEN_MAX * 3 + 1];
+    int32_t             start  = 0;
+    int32_t             end    = 0;
+    int                 rc     = SQLITE_OK;
+
+    /* on UTF-8 text the boundaries are byte offsets, as FTS5 wants them */
+    utext_openUTF8(&ut, text, n, &status);
+    ubrk_setUText(tok->brk, &ut, &status);
+    if(U_FAILURE(status))
+    {
+        utext_close(&ut);
+        return SQLITE_ERROR;
+    }
+
+    start = ubrk_first(tok->brk);
+    while(rc == SQLITE_OK && (end = ubrk_next(tok->brk)) != UBRK_DONE)
+    {
+        /* spaces and punctuation have the UBRK_WORD_NONE status */
+        if(ubrk_getRuleStatus(tok->brk) >= UBRK_WORD_NONE_LIMIT)
+        {
+            int len = foldWord(text + start, end - start, folded, sizeof(folded));
+
+            if(len >= 0)
+            {
+                rc = xToken(ctx, 0, folded, len, start, end);
+            }
+            else
+            {
+                rc = xToken(ctx, 0, text + start, end - start, start, end);
+            }
+        }
+        start = end;
+    }
+    utext_close(&ut);
+    return rc;
+}
+
+#else
+
+/* unicode61 under the name of the ICU tokenizer, so the schema is the same */
+typedef struct edb_tokenizer
+{
+    fts5_tokenizer  base;
+    Fts5Tokenizer*  inner;
+} edb_tokenizer_t;
+
+static int tokCreate(void* ctx, const char** azArg, int nArg, Fts5Tokenizer** ppOut)
+{
+    fts5_api*           api  = (fts5_api*)ctx;
+    edb_tokenizer_t*    tok  = NULL;
+    void*               data = NULL;
+    int                 rc   = SQLITE_OK;
+
+    tok = sqlite3_malloc(sizeof(*tok));
+    if(tok == NULL)
+    {
+        return SQLITE_NOMEM;
+    }
+    /* the locale argument of the ICU tokenizer does not apply */
+    rc = api->xFindTokenizer(api, "unicode61", &data, &tok->base);
+    if(rc == SQLITE_OK)
+    {
+        rc = tok->base.xCreate(data, NULL, 0, &tok->inner);
+    }
+    if(rc != SQLITE_OK)
+    {
+        sqlite3_free(tok);
+        return rc;
+    }
+    *ppOut = (Fts5Tokenizer*)tok;
+    return SQLITE_OK;
+}
+
+static void tokDelete(Fts5Tokenizer* p)
+{
+    edb_tokenizer_t* tok = (edb_tokenizer_t*)p;
+
+    tok->base.xDelete(tok->inner);
+    sqlite3_free(tok);
+}
+
+static int tokTokenize(Fts5Tokenizer* p, void* ctx, int flags, const char* text, int n,
+                       int (*xToken)(void*, int, const char*, int, int, int))
+{
+    edb_tokenizer_t* tok = (edb_tokenizer_t*)p;
+
+    return tok->base.xTokenize(tok->inner, ctx, flags, text, n, xToken);
+}
+
+#endif /* EDB_SEARCH_ICU */
+
+/*
+ ** The FTS5 API of |db|, or NULL if FTS5 is not built in.
+ */
+static fts5_api* fts5Api(sqlite3* db)
+{
+    sqlite3_stmt*   stmt = NULL;
+    fts5_api*       api  = NULL;
+
+    if(sqlite3_prepare_v2(db, "SELECT fts5()", -1, &stmt, NULL) == SQLITE_OK &&
+       sqlite3_step(stmt) == SQLITE_ROW &&
+       sqlite3_column_bytes(stmt, 0) == sizeof(api))
+    {
+        memcpy(&api, sqlite3_column_blob(stmt, 0), sizeof(api));
+    }
+    sqlite3_finalize(stmt);
+    return api;
+}
+
+int edb_search_register(sqlite3* db)
+{
+    fts5_tokenizer  tokenizer = {tokCreate, tokDelete, tokTokenize};
+    fts5_api*       api       = fts5Api(db);
+
+    if(api == NULL)
+    {
+        printf("edb: no fts5 in sqlite, build it with SQLITE_ENABLE_FTS5\n");
+        return SQLITE_ERROR;
+    }
+    return api->xCreateTokenizer(api, "edb", api, &tokenizer, NULL);
+}
+
+int edb_search_open(const char* path, edb_search_t** pp_search)
+{
+    static const char matchSql[] =
+        "SELECT e.channelId,e.eventId,e.startTime,e.duration,t_edb_fts.rank "
+        "FROM t_edb_fts JOIN t_edb e ON e.rowid=t_edb_fts.rowid "
+        "WHERE t_edb_fts MATCH ?1 AND e.startTime+e.duration>?2 "
+        "ORDER BY t_edb_fts.rank LIMIT ?3";
+    edb_search_t*   search = NULL;
+    int             rc     = SQLITE_OK;
+
+    *pp_search = NULL;
+    search = sqlite3_malloc(sizeof(*search));
+    if(search == NULL)
+    {
+        return SQLITE_NOMEM;
+    }
+    memset(search, 0, sizeof(*search));
+
+    rc = sqlite3_open_v2(path, &search->db, SQLITE_OPEN_READONLY, NULL);
+    if(rc != SQLITE_OK)
+    {
+        printf("Can't open database: %s\n", path);
+        edb_search_close(search);
+        return rc;
+    }
+    sqlite3_busy_timeout(search->db, 1000);
+
+    rc = edb_search_register(search->db);
+    if(rc == SQLITE_OK)
+    {
+        rc = sqlite3_prepare_v2(search->db, matchSql, -1, &search->stmt_match, NULL);
+        if(rc != SQLITE_OK)
+        {
+            printf("edb: prepare %s fail,err=%d %s\n", matchSql, rc, sqlite3_errmsg(search->db));
+        }
+    }
+    if(rc != SQLITE_OK)
+    {
+        edb_search_close(search);
+        return rc;
+    }
+    *pp_search = search;
+    return SQLITE_OK;
+}
+
+void edb_search_close(edb_search_t* search)
+{
+    if(search == NULL)
+    {
+        return;
+    }
+    sqlite3_finalize(search->stmt_match);
+    if(search->db != NULL)
+    {
+        sqlite3_close(search->db);
+    }
+    sqlite3_free(search);
+}
+
+/*
+ ** Turn the words of |text| into an FTS5 query of quoted strings, so that
+ ** what the user types is never taken for query syntax, the last one a
+ ** prefix. A word of several tokens, as CJK or Thai text typed without
+ ** spaces, is a phrase. Return a buffer to free with sqlite3_free, NULL if
+ ** there is no word.
+ */
+static char* matchQuery(const char* text)
+{
+    char*   query = sqlite3_malloc64(strlen(text) * 2 + 4);
+    char*   q     = query;
+
+    if(query == NULL)
+    {
+        return NULL;
+    }
+    while(*text != 0)
+    {
+        while(*text == ' ' || *text == '\t')
+        {
+            text++;
+        }
+        if(*text == 0)
+        {
+            break;
+        }
+        if(q != query)
+        {
+            *q++ = ' ';
+        }
+        *q++ = '"';
+        while(*text != 0 && *text != ' ' && *text != '\t')
+        {
+            if(*text == '"')
+            {
+                *q++ = '"';
+            }
+            *q++ = *text++;
+        }
+        *q++ = '"';
+    }
+    if(q == query)
+    {
+        sqlite3_free(query);
+        return NULL;
+    }
+    *q++ = '*';
+    *q   = 0;
+    return query;
+}
+
+int edb_search_query(edb_search_t* search, const char* text, int after,
+                     edb_search_hit_t* hits, int max)
+{
+    sqlite3_stmt*   stmt  = search->stmt_match;
+    char*           query = matchQuery(text);
+    int             count = 0;
+    int             rc    = SQLITE_OK;
+
+    if(query == NULL || max <= 0)
+    {
+        sqlite3_free(query);
+        return 0;
+    }
+    sqlite3_bind_text(stmt, 1, query, -1, sqlite3_free);
+    sqlite3_bind_int(stmt, 2, after);
+    sqlite3_bind_int(stmt, 3, max);
+    while((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        hits[count].channelId = sqlite3_column_int(stmt, 0);
+        hits[count].eventId   = sqlite3_column_int(stmt, 1);
+        hits[count].startTime = sqlite3_column_int(stmt, 2);
+        hits[count].duration  = sqlite3_column_int(stmt, 3);
+        hits[count].score     = -sqlite3_column_double(stmt, 4);
+        count++;
+    }
+    if(rc != SQLITE_DONE)
+    {
+        printf("edb: search fail,err=%d %s\n", rc, sqlite3_errmsg(search->db));
+        count = -1;
+    }
+    sqlite3_clear_bindings(stmt);
+    sqlite3_reset(stmt);
+    return count;
+}
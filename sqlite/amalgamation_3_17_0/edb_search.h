@@ -0,0 +1,69 @@
+/*
+ * EPG full-text search
+ *
+ * Finds the events whose detail holds all the words of a search ("find all
+ * football") through the FTS5 index t_edb_fts instead of a LIKE '%...%'
+ * scan of every row:
+ *
+ * CREATE VIRTUAL TABLE t_edb_fts USING fts5(detail, content='', tokenize='edb')
+ *
+ * The table is contentless, its rowid being the t_edb rowid, and is kept
+ * up to date by edb_ingest_put() and edb_ingest_expire() when the ingest
+ * config has search set (see edb_ingest.h).
+ *
+ * The "edb" tokenizer splits words with the ICU word break iterator, which
+ * segments Chinese, Japanese and Thai text by dictionary, and case folds
+ * them. Without EDB_SEARCH_ICU it is the FTS5 unicode61 tokenizer, which
+ * only splits on spaces and punctuation. Every connection that writes or
+ * queries t_edb_fts must have it, by edb_search_register().
+ *
+ * A handle belongs to one thread.
+ */
+#ifndef _EDB_SEARCH_H_
+#define _EDB_SEARCH_H_
+
+#include "sqlite3.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct edb_search_hit
+{
+    int     channelId;
+    int     eventId;
+    int     startTime;
+    int     duration;
+    double  score;          /* bm25 relevance, higher is better */
+} edb_search_hit_t;
+
+typedef struct edb_search edb_search_t;
+
+/*
+ ** Register the "edb" tokenizer on |db|.
+ */
+int edb_search_register(sqlite3* db);
+
+/*
+ ** Open the EPG database at |path| for searching. The index is made by
+ ** edb_ingest_open() with search set.
+ ** Return SQLITE_OK, or a sqlite error code with *pp_search set to NULL.
+ */
+int edb_search_open(const char* path, edb_search_t** pp_search);
+
+void edb_search_close(edb_search_t* search);
+
+/*
+ ** Find the events ending after |after| whose detail holds every word of
+ ** |text|, the last one as a prefix, as typed. Up to |max| events are
+ ** stored in |hits|, most relevant first.
+ ** Return the number of events stored, or -1 on error.
+ */
+int edb_search_query(edb_search_t* search, const char* text, int after,
+                     edb_search_hit_t* hits, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _EDB_SEARCH_H_ */
@@ -1,11 +1,19 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
 #include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "sqlite3.h"
+#include "edb_ingest.h"
+#include "edb_query.h"
+#include "edb_search.h"
+#include "emmc_vfs.h"
 
 #define edb_sqlite      "/3rd_rw/edb.db"
+#define edb_bench       "/3rd_rw/edb_bench.db"
 /* 
  * Reference document https://www.sqlite.org
  *
@@ -281,6 +289,534 @@ int testDelete(void)
 }
 
 
+static const char* const benchWords[] = {
+    "news", "weather", "the", "live", "match", "of", "and", "series", "episode",
+    "documentary", "about", "a", "family", "in", "film", "drama", "season", "final",
+    "report", "with", "music", "show", "kids", "world", "history", "cooking",
+};
+
+/*
+ ** Fill |detail| with |len|-1 bytes of EIT like text.
+ */
+static void benchDetail(char* detail, int len, unsigned int seed)
+{
+    int pos = 0;
+
+    while(pos < len - 1)
+    {
+        const char* w = benchWords[(seed >> 8) % (sizeof(benchWords) / sizeof(benchWords[0]))];
+        int         n = strlen(w);
+
+        seed = seed * 1103515245 + 12345;
+        if(pos + n + 1 > len - 1)
+        {
+            n = len - 1 - pos - 1;
+        }
+        if(n > 0)
+        {
+            memcpy(detail + pos, w, n);
+            pos += n;
+        }
+        detail[pos++] = ' ';
+    }
+    detail[len - 1] = 0;
+}
+
+static double wallTime(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 0.000001;
+}
+
+static void removeBenchDB(void)
+{
+    unlink(edb_bench);
+    unlink(edb_bench "-wal");
+    unlink(edb_bench "-shm");
+    unlink(edb_bench "-journal");
+}
+
+static long fileSize(const char* path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : 0;
+}
+
+/*
+ ** Write a |count| events schedule twice, as an EIT refresh does, with the
+ ** ingestion settings of |mode|:
+ **   row    one transaction per event, rollback journal, synchronous FULL
+ **   batch  500 events per transaction, rollback journal, synchronous FULL
+ **   wal    500 events per transaction, WAL, synchronous NORMAL
+ **   walz   as wal, with compressed details
+ **   walfull 10 events per transaction, WAL, synchronous FULL, as app settings
+ **   walsync as walfull, with the emmc VFS batching the WAL syncs over 200ms
+ */
+static int benchIngest(const char* mode, int count)
+{
+    edb_ingest_config_t cfg;
+    edb_ingest_stats_t  stats;
+    emmc_vfs_config_t   vfs     = {0, 0};
+    emmc_vfs_stats_t    io;
+    edb_ingest_t*       ingest  = NULL;
+    char                detail[500];
+    double              t       = 0;
+    int                 pass    = 0;
+    int                 i       = 0;
+    int                 rc      = 0;
+
+    edb_ingest_default_config(&cfg);
+    if(strcmp(mode, "row") == 0 || strcmp(mode, "batch") == 0)
+    {
+        cfg.wal         = 0;
+        cfg.synchronous = EDB_SYNC_FULL;
+        cfg.batch_rows  = mode[0] == 'r' ? 1 : cfg.batch_rows;
+    }
+    else if(strcmp(mode, "walz") == 0)
+    {
+        cfg.compress = 1;
+    }
+    else if(strcmp(mode, "walfull") == 0 || strcmp(mode, "walsync") == 0)
+    {
+        cfg.synchronous      = EDB_SYNC_FULL;
+        cfg.batch_rows       = 10;
+        vfs.sync_interval_ms = mode[3] == 's' ? 200 : 0;
+    }
+    else if(strcmp(mode, "wal") != 0)
+    {
+        printf("unknown mode %s\n", mode);
+        return -1;
+    }
+
+    emmc_vfs_register(&vfs, 1);
+    removeBenchDB();
+    rc = edb_ingest_open(edb_bench, &cfg, &ingest);
+    if(rc != SQLITE_OK)
+    {
+        return -1;
+    }
+
+    t = wallTime();
+    BEGIN_TIMER;
+    for(pass = 0; pass < 2 && rc == SQLITE_OK; pass++)
+    {
+        for(i = 0; i < count && rc == SQLITE_OK; i++)
+        {
+            benchDetail(detail, 200 + (i * 37) % 300, i + pass);
+            rc = edb_ingest_put(ingest, i % 64, i / 64, i / 64 * 1800, 1800, detail, -1);
+        }
+        if(rc == SQLITE_OK)
+        {
+            rc = edb_ingest_flush(ingest);
+        }
+    }
+    t = wallTime() - t;
+
+    edb_ingest_get_stats(ingest, &stats);
+    printf("%-7s %8u %6u %10.3f\t", mode, stats.rows, stats.commits, t);
+    END_TIMER;
+    printf("       detail %u bytes, stored %u bytes (%u compressed), db %ld + wal %ld bytes\n",
+           stats.detail_bytes, stats.stored_bytes, stats.compressed,
+           fileSize(edb_bench), fileSize(edb_bench "-wal"));
+    if(emmc_vfs_get_stats(edb_ingest_db(ingest), NULL, &io, 0) == SQLITE_OK)
+    {
+        printf("       io %u writes (%u unaligned to %d), %u syncs, %u skipped, %u deferred\n",
+               io.writes, io.unaligned_writes, io.page_unit, io.syncs, io.syncs_skipped, io.syncs_deferred);
+    }
+
+    if(rc == SQLITE_OK && edb_ingest_get_detail(ingest, 1, 0, detail, sizeof(detail)) < 0)
+    {
+        printf("       read back fail\n");
+        rc = -1;
+    }
+    edb_ingest_close(ingest);
+    removeBenchDB();
+    return rc;
+}
+
+/*
+ ** Whether the comma separated |list| holds |name|.
+ */
+static int listHas(const char* list, const char* name)
+{
+    int n = strlen(name);
+
+    while(list != NULL)
+    {
+        if(strncmp(list, name, n) == 0 && (list[n] == ',' || list[n] == 0))
+        {
+            return 1;
+        }
+        list = strchr(list, ',');
+        if(list != NULL) list++;
+    }
+    return 0;
+}
+
+/*
+ ** Compare the ingestion modes of |modes| (all if NULL) for |count| events.
+ */
+static int benchIngestModes(const char* modes, int count)
+{
+    static const char* const all[] = {"row", "batch", "wal", "walz", "walfull", "walsync"};
+    int i  = 0;
+    int rc = 0;
+
+    printf("Ingest 2 times * %d events to database\n", count);
+    printf("Mode        Rows Commit   Wall time\tUser time\tSys time\tMemory used\n");
+    printf("===========================================\n");
+    for(i = 0; i < (int)(sizeof(all) / sizeof(all[0])); i++)
+    {
+        if(modes == NULL || listHas(modes, all[i]))
+        {
+            rc |= benchIngest(all[i], count);
+        }
+    }
+    printf("===========================================\n\n");
+    return rc;
+}
+
+#define GRID_CHANNELS       64
+#define GRID_ROWS           8
+#define GRID_SPAN           (3 * 3600)
+#define GRID_STEP           (30 * 60)
+#define GRID_FRAME_US       16000
+
+/*
+ ** Fill the bench database with |days| of 30 to 90 minute events on
+ ** GRID_CHANNELS channels.
+ */
+static int gridFill(int days)
+{
+    edb_ingest_t*   ingest  = NULL;
+    char            detail[200];
+    int             ch      = 0;
+    int             rc      = 0;
+
+    removeBenchDB();
+    rc = edb_ingest_open(edb_bench, NULL, &ingest);
+    for(ch = 0; ch < GRID_CHANNELS && rc == SQLITE_OK; ch++)
+    {
+        int t  = 0;
+        int id = 0;
+
+        while(t < days * 24 * 3600 && rc == SQLITE_OK)
+        {
+            int duration = 1800 * (1 + (ch + id) % 3);
+
+            benchDetail(detail, sizeof(detail), ch * 1000 + id);
+            rc = edb_ingest_put(ingest, ch, id++, t, duration, detail, -1);
+            t += duration;
+        }
+    }
+    rc |= edb_ingest_close(ingest);
+    return rc;
+}
+
+/*
+ ** Scroll a GRID_ROWS x GRID_SPAN window over the grid as a user does:
+ ** right half an hour at a time, down a channel at a time, then back,
+ ** one redraw per GRID_FRAME_US frame.
+ */
+static int benchGrid(const char* mode, int steps)
+{
+    static const int    moves[][2] = {{0, GRID_STEP}, {1, 0}, {0, -GRID_STEP}, {-1, 0}};
+    edb_query_config_t  cfg;
+    edb_query_stats_t   stats;
+    edb_query_t*        query   = NULL;
+    edb_grid_event_t    events[256];
+    int                 channels[GRID_CHANNELS];
+    int                 row0    = 0;
+    int                 t0      = 0;
+    int                 i       = 0;
+    int                 n       = 0;
+
+    edb_query_default_config(&cfg);
+    cfg.cache    = strcmp(mode, "direct") != 0;
+    cfg.prefetch = strcmp(mode, "prefetch") == 0;
+    if(edb_query_open(edb_bench, &cfg, &query) != SQLITE_OK)
+    {
+        return -1;
+    }
+    for(i = 0; i < GRID_CHANNELS; i++)
+    {
+        channels[i] = i;
+    }
+    edb_query_set_channels(query, channels, GRID_CHANNELS);
+
+    for(i = 0; i < steps && n >= 0; i++)
+    {
+        /* a run of 12 moves the same way, as key repeat does */
+        const int* move = moves[i / 12 % 4];
+
+        row0 += move[0];
+        t0   += move[1];
+        if(row0 < 0) row0 = 0;
+        if(row0 > GRID_CHANNELS - GRID_ROWS) row0 = GRID_CHANNELS - GRID_ROWS;
+        if(t0 < 0) t0 = 0;
+        n = edb_query_window(query, row0, GRID_ROWS, t0, t0 + GRID_SPAN, events, 256);
+        usleep(GRID_FRAME_US);
+    }
+
+    edb_query_get_stats(query, &stats);
+    printf("%-9s %6u %6u %6u %6u %8u %8u %8u %8u\n", mode, stats.windows,
+           stats.tile_hits, stats.tile_loads, stats.prefetches,
+           stats.p50_us, stats.p90_us, stats.p99_us, stats.max_us);
+    edb_query_close(query);
+    return n < 0 ? -1 : 0;
+}
+
+/*
+ ** Compare the grid query modes of |modes| (all if NULL) over |steps|
+ ** scroll steps.
+ */
+static int benchGridModes(const char* modes, int steps)
+{
+    static const char* const all[] = {"direct", "cache", "prefetch"};
+    int i  = 0;
+    int rc = 0;
+
+    if(gridFill(8) != SQLITE_OK)
+    {
+        return -1;
+    }
+    printf("Scroll a %d channels x %d hours grid %d steps\n", GRID_ROWS, GRID_SPAN / 3600, steps);
+    printf("Mode      Window   Hits  Loads  Prefet   p50 us   p90 us   p99 us   max us\n");
+    printf("===========================================\n");
+    for(i = 0; i < (int)(sizeof(all) / sizeof(all[0])); i++)
+    {
+        if(modes == NULL || listHas(modes, all[i]))
+        {
+            rc |= benchGrid(all[i], steps);
+        }
+    }
+    printf("===========================================\n\n");
+    removeBenchDB();
+    return rc;
+}
+
+#define SEARCH_CHANNELS     140
+#define SEARCH_DAYS         7
+#define SEARCH_MAX_HITS     200
+
+/*
+ * EIT text of the countries of the channels: the sport searched for and
+ * eight common words, written with or without spaces between words.
+ */
+typedef struct searchLang
+{
+    const char*         sep;
+    const char*         keyword;
+    const char* const   words[8];
+} searchLang_t;
+
+static const searchLang_t searchLangs[] = {
+    {" ", "football", {"news", "weather", "live", "match", "documentary", "family", "drama", "history"}},
+    {" ", "Fu\xc3\x9f" "ball", {"Nachrichten", "Wetter", "live", "Spiel", "Dokumentation", "Familie", "Krimi", "Geschichte"}},
+    {" ", "football", {"journal", "m\xc3\xa9t\xc3\xa9o", "direct", "match", "documentaire", "famille", "s\xc3\xa9rie", "histoire"}},
+    {" ", "f\xc3\xba" "tbol", {"noticias", "tiempo", "directo", "partido", "documental", "familia", "serie", "historia"}},
+    /* zh, ja and th are written without spaces */
+    {"", "\xe8\xb6\xb3\xe7\x90\x83", {"\xe6\x96\xb0\xe9\x97\xbb", "\xe5\xa4\xa9\xe6\xb0\x94", "\xe7\x9b\xb4\xe6\x92\xad", "\xe6\xaf\x94\xe8\xb5\x9b",
+                                              "\xe7\xba\xaa\xe5\xbd\x95\xe7\x89\x87", "\xe5\xae\xb6\xe5\xba\xad", "\xe7\x94\xb5\xe8\xa7\x86\xe5\x89\xa7", "\xe5\x8e\x86\xe5\x8f\xb2"}},
+    {"", "\xe3\x82\xb5\xe3\x83\x83\xe3\x82\xab\xe3\x83\xbc", {"\xe3\x83\x8b\xe3\x83\xa5\xe3\x83\xbc\xe3\x82\xb9", "\xe5\xa4\xa9\xe6\xb0\x97", "\xe7\x94\x9f\xe4\xb8\xad\xe7\xb6\x99", "\xe8\xa9\xa6\xe5\x90\x88",
+                                                              "\xe3\x83\x89\xe3\x82\xad\xe3\x83\xa5\xe3\x83\xa1\xe3\x83\xb3\xe3\x82\xbf\xe3\x83\xaa\xe3\x83\xbc", "\xe5\xae\xb6\xe6\x97\x8f", "\xe3\x83\x89\xe3\x83\xa9\xe3\x83\x9e", "\xe6\xad\xb4\xe5\x8f\xb2"}},
+    {"", "\xe0\xb8\x9f\xe0\xb8\xb8\xe0\xb8\x95\xe0\xb8\x9a\xe0\xb8\xad\xe0\xb8\xa5",
+     {"\xe0\xb8\x82\xe0\xb9\x88\xe0\xb8\xb2\xe0\xb8\xa7", "\xe0\xb8\xad\xe0\xb8\xb2\xe0\xb8\x81\xe0\xb8\xb2\xe0\xb8\xa8",
+      "\xe0\xb8\x96\xe0\xb9\x88\xe0\xb8\xb2\xe0\xb8\xa2\xe0\xb8\x97\xe0\xb8\xad\xe0\xb8\x94\xe0\xb8\xaa\xe0\xb8\x94",
+      "\xe0\xb8\x81\xe0\xb8\xb2\xe0\xb8\xa3\xe0\xb9\x81\xe0\xb8\x82\xe0\xb9\x88\xe0\xb8\x87\xe0\xb8\x82\xe0\xb8\xb1\xe0\xb8\x99",
+      "\xe0\xb8\xaa\xe0\xb8\xb2\xe0\xb8\xa3\xe0\xb8\x84\xe0\xb8\x94\xe0\xb8\xb5",
+      "\xe0\xb8\x84\xe0\xb8\xa3\xe0\xb8\xad\xe0\xb8\x9a\xe0\xb8\x84\xe0\xb8\xa3\xe0\xb8\xb1\xe0\xb8\xa7",
+      "\xe0\xb8\xa5\xe0\xb8\xb0\xe0\xb8\x84\xe0\xb8\xa3",
+      "\xe0\xb8\x9b\xe0\xb8\xa3\xe0\xb8\xb0\xe0\xb8\xa7\xe0\xb8\xb1\xe0\xb8\x95\xe0\xb8\xb4\xe0\xb8\xa8\xe0\xb8\xb2\xe0\xb8\xaa\xe0\xb8\x95\xe0\xb8\xa3\xe0\xb9\x8c"}},
+};
+
+#define SEARCH_LANGS        ((int)(sizeof(searchLangs) / sizeof(searchLangs[0])))
+
+/*
+ ** Fill |detail| of |size| bytes with an event text in |lang|, one in
+ ** twelve about the sport, named amid the other words.
+ */
+static void searchDetail(char* detail, int size, const searchLang_t* lang, unsigned int seed)
+{
+    int pos     = 0;
+    int words   = 20 + seed % 40;
+    int keyword = seed % 12 == 0 ? words / 2 : -1;
+
+    detail[0] = 0;
+    while(words-- > 0 && pos < size - 64)
+    {
+        seed = seed * 1103515245 + 12345;
+        pos += snprintf(detail + pos, size - pos, "%s%s",
+                        words == keyword ? lang->keyword : lang->words[(seed >> 16) % 8],
+                        words % 9 == 0 ? ". " : lang->sep);
+    }
+}
+
+static int compareUs(const void* a, const void* b)
+{
+    unsigned int x = *(const unsigned int*)a;
+    unsigned int y = *(const unsigned int*)b;
+    return x < y ? -1 : x > y;
+}
+
+/*
+ ** Put a week of SEARCH_CHANNELS channels, the channels of each country
+ ** in its language, then refresh it with one event in twenty changed.
+ */
+static int searchFill(edb_ingest_t* ingest, int refresh, double* p_time)
+{
+    char    detail[1024];
+    double  t  = wallTime();
+    int     ch = 0;
+    int     rc = SQLITE_OK;
+
+    for(ch = 0; ch < SEARCH_CHANNELS && rc == SQLITE_OK; ch++)
+    {
+        int start = 0;
+        int id    = 0;
+
+        while(start < SEARCH_DAYS * 24 * 3600 && rc == SQLITE_OK)
+        {
+            int duration = 1800 * (1 + (ch + id) % 3);
+
+            searchDetail(detail, sizeof(detail), &searchLangs[ch % SEARCH_LANGS],
+                         ch * 1000 + id + (refresh && id % 20 == 0));
+            rc = edb_ingest_put(ingest, ch, id++, start, duration, detail, -1);
+            start += duration;
+        }
+    }
+    if(rc == SQLITE_OK)
+    {
+        rc = edb_ingest_flush(ingest);
+    }
+    *p_time = wallTime() - t;
+    return rc;
+}
+
+/*
+ ** Search the keyword of every language |count| times in all, from the
+ ** middle of the week, the like mode by a LIKE '%...%' scan as before the
+ ** full-text index.
+ */
+static int benchSearch(const char* mode, int count)
+{
+    static const char       likeSql[] =
+        "SELECT channelId,eventId FROM t_edb "
+        "WHERE edb_detail(eventDetail) LIKE '%'||?1||'%' AND startTime+duration>?2 "
+        "ORDER BY startTime LIMIT ?3";
+    edb_ingest_config_t     cfg;
+    edb_ingest_stats_t      stats;
+    edb_ingest_t*           ingest  = NULL;
+    edb_search_t*           search  = NULL;
+    sqlite3_stmt*           like    = NULL;
+    edb_search_hit_t        hits[SEARCH_MAX_HITS];
+    int                     found[SEARCH_LANGS];
+    unsigned int*           us      = NULL;
+    double                  fill    = 0;
+    double                  update  = 0;
+    int                     after   = SEARCH_DAYS * 24 * 3600 / 2;
+    int                     i       = 0;
+    int                     n       = 0;
+    int                     rc      = 0;
+
+    edb_ingest_default_config(&cfg);
+    cfg.search = strcmp(mode, "fts") == 0;
+    removeBenchDB();
+    if(edb_ingest_open(edb_bench, &cfg, &ingest) != SQLITE_OK)
+    {
+        return -1;
+    }
+    rc = searchFill(ingest, 0, &fill);
+    if(rc == SQLITE_OK)
+    {
+        rc = searchFill(ingest, 1, &update);
+    }
+    if(rc == SQLITE_OK)
+    {
+        sqlite3_exec(edb_ingest_db(ingest), "PRAGMA wal_checkpoint(TRUNCATE)", NULL, NULL, NULL);
+        rc = cfg.search ? edb_search_open(edb_bench, &search)
+                        : sqlite3_prepare_v2(edb_ingest_db(ingest), likeSql, -1, &like, NULL);
+    }
+    us = malloc(count * sizeof(*us));
+    if(rc != SQLITE_OK || us == NULL)
+    {
+        free(us);
+        edb_ingest_close(ingest);
+        return -1;
+    }
+
+    for(i = 0; i < count && n >= 0; i++)
+    {
+        const char* keyword = searchLangs[i % SEARCH_LANGS].keyword;
+        double      t       = wallTime();
+
+        if(search != NULL)
+        {
+            n = edb_search_query(search, keyword, after, hits, SEARCH_MAX_HITS);
+        }
+        else
+        {
+            sqlite3_bind_text(like, 1, keyword, -1, SQLITE_STATIC);
+            sqlite3_bind_int(like, 2, after);
+            sqlite3_bind_int(like, 3, SEARCH_MAX_HITS);
+            for(n = 0; sqlite3_step(like) == SQLITE_ROW; n++)
+            {
+            }
+            sqlite3_reset(like);
+        }
+        us[i] = (unsigned int)((wallTime() - t) * 1000000);
+        if(i < SEARCH_LANGS)
+        {
+            found[i] = n;
+        }
+    }
+    qsort(us, count, sizeof(*us), compareUs);
+
+    edb_ingest_get_stats(ingest, &stats);
+    printf("%-5s %8u %8u %8u %8.3f %8.3f %8ld %8u %8u %8u\n", mode, stats.rows, stats.indexed,
+           stats.unchanged, fill, update, fileSize(edb_bench) / 1024,
+           us[count / 2], us[count * 9 / 10], us[count - 1]);
+    printf("      hits");
+    for(i = 0; i < SEARCH_LANGS; i++)
+    {
+        printf(" %s %d", searchLangs[i].keyword, found[i]);
+    }
+    printf("\n");
+
+    free(us);
+    sqlite3_finalize(like);
+    edb_search_close(search);
+    edb_ingest_close(ingest);
+    removeBenchDB();
+    return n < 0 ? -1 : 0;
+}
+
+/*
+ ** Compare the search modes of |modes| (all if NULL) over |count| searches.
+ */
+static int benchSearchModes(const char* modes, int count)
+{
+    static const char* const all[] = {"like", "fts"};
+    int i  = 0;
+    int rc = 0;
+
+    printf("Search %d channels x %d days of EPG in %d languages %d times\n",
+           SEARCH_CHANNELS, SEARCH_DAYS, SEARCH_LANGS, count);
+    printf("Mode      Rows  Indexed    Unchg   Fill s Update s  db KiB   p50 us   p90 us   max us\n");
+    printf("===========================================\n");
+    for(i = 0; i < (int)(sizeof(all) / sizeof(all[0])); i++)
+    {
+        if(modes == NULL || listHas(modes, all[i]))
+        {
+            rc |= benchSearch(all[i], count);
+        }
+    }
+    printf("===========================================\n\n");
+    return rc;
+}
+
+
 int main(int argc,char** args)
 {
     int             i           = 0;
@@ -290,7 +826,7 @@ int main(int argc,char** args)
 
     if(argc < 3)
     {
-        printf("./test limit_memory_size(bytes) InsertRowNumber\n");
+        printf("./test limit_memory_size(bytes) InsertRowNumber [ingest [row,batch,wal,walz,walfull,walsync] | grid [direct,cache,prefetch] | search [like,fts]]\n");
         return -1;
     }
 
@@ -311,6 +847,21 @@ int main(int argc,char** args)
     printf("Limit memory size = %ld insertRows=%ld\n",limit_size,insert_row_number);
 
     sqlite3_soft_heap_limit(limit_size);//default limit 1M memory
+
+    if(argc > 3 && strcmp(args[3], "ingest") == 0)
+    {
+        return benchIngestModes(argc > 4 ? args[4] : NULL, insert_row_number) ? -1 : 0;
+    }
+    if(argc > 3 && strcmp(args[3], "grid") == 0)
+    {
+        return benchGridModes(argc > 4 ? args[4] : NULL, insert_row_number) ? -1 : 0;
+    }
+
+    if(argc > 3 && strcmp(args[3], "search") == 0)
+    {
+        return benchSearchModes(argc > 4 ? args[4] : NULL, insert_row_number) ? -1 : 0;
+    }
+
     rc = openDB(); 
     if(rc != 0)
     {
@@ -0,0 +1,705 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+
+#include "emmc_vfs.h"
+
+/*
+ * Reference document https://www.sqlite.org/vfs.html
+ *
+ * Every file opened through the VFS is an emmc_file followed by the file
+ * of the real VFS. The files of a database (main, journal, WAL) share an
+ * emmc_db, found by the main file name, which holds the statistics and the
+ * WAL files with a deferred sync. All the shared state is under one static
+ * mutex; it is only held for bookkeeping, never across I/O.
+ */
+
+#define EMMC_DEFAULT_PAGE_UNIT      4096
+#define EMMC_MIN_PAGE_UNIT          512
+#define EMMC_MAX_PAGE_UNIT          65536
+
+typedef struct emmc_file emmc_file;
+typedef struct emmc_db emmc_db;
+
+struct emmc_db
+{
+    emmc_db*            next;
+    int                 ref;
+    int                 page_unit;
+    emmc_file*          wals;           /* open WAL files */
+    int                 deferred;       /* WAL files with a deferred sync */
+    emmc_vfs_stats_t    stats;
+    char                name[1];        /* main file name, allocated longer */
+};
+
+struct emmc_file
+{
+    sqlite3_file        base;
+    sqlite3_file*       real;           /* right after this struct */
+    emmc_db*            db;
+    int                 flags;          /* SQLITE_OPEN_xxx of xOpen */
+    int                 dirty;          /* written since the last sync */
+    int                 sync_flags;     /* of the deferred sync, 0 if none */
+    sqlite3_int64       synced_ms;      /* time of the last sync */
+    emmc_file*          next_wal;
+};
+
+static sqlite3_vfs*         real_vfs = NULL;
+static emmc_vfs_config_t    config   = {0, 0};
+static emmc_db*             dbs      = NULL;
+
+static sqlite3_mutex* lockMutex(void)
+{
+    sqlite3_mutex* mutex = sqlite3_mutex_alloc(SQLITE_MUTEX_STATIC_APP1);
+    sqlite3_mutex_enter(mutex);
+    return mutex;
+}
+
+static sqlite3_int64 nowMs(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (sqlite3_int64)tp.tv_sec * 1000 + tp.tv_nsec / 1000000;
+}
+
+static int readSysfsInt(const char* fmt, dev_t dev)
+{
+    char    path[96];
+    FILE*   fp    = NULL;
+    int     value = 0;
+
+    snprintf(path, sizeof(path), fmt, major(dev), minor(dev));
+    fp = fopen(path, "r");
+    if(fp != NULL)
+    {
+        if(fscanf(fp, "%d", &value) != 1)
+        {
+            value = 0;
+        }
+        fclose(fp);
+    }
+    return value;
+}
+
+/*
+ ** Program unit of the block device holding |path|: minimum_io_size of its
+ ** queue, which a partition takes from its disk.
+ */
+static int detectPageUnit(const char* path)
+{
+    struct stat st;
+    int         unit = 0;
+
+    if(config.page_unit > 0)
+    {
+        return config.page_unit;
+    }
+    if(path != NULL && stat(path, &st) == 0 && major(st.st_dev) != 0)
+    {
+        unit = readSysfsInt("/sys/dev/block/%u:%u/queue/minimum_io_size", st.st_dev);
+        if(unit <= 0)
+        {
+            unit = readSysfsInt("/sys/dev/block/%u:%u/../queue/minimum_io_size", st.st_dev);
+        }
+    }
+    /* a power of two sqlite can use as page size */
+    if(unit < EMMC_MIN_PAGE_UNIT || unit > EMMC_MAX_PAGE_UNIT || (unit & (unit - 1)) != 0)
+    {
+        unit = EMMC_DEFAULT_PAGE_UNIT;
+    }
+    return unit;
+}
+
+/*
+ ** Find or create the emmc_db of the database file |name|, given the name
+ ** of any of its files.
+ */
+static emmc_db* getDb(const char* name, int flags)
+{
+    static const char* const suffixes[] = {"-journal", "-wal"};
+    sqlite3_mutex*  mutex = NULL;
+    emmc_db*        db    = NULL;
+    int             len   = strlen(name);
+    int             i     = 0;
+
+    if(flags & (SQLITE_OPEN_MAIN_JOURNAL | SQLITE_OPEN_WAL))
+    {
+        for(i = 0; i < (int)(sizeof(suffixes) / sizeof(suffixes[0])); i++)
+        {
+            int n = strlen(suffixes[i]);
+            if(len > n && strcmp(name + len - n, suffixes[i]) == 0)
+            {
+                len -= n;
+                break;
+            }
+        }
+    }
+
+    mutex = lockMutex();
+    for(db = dbs; db != NULL; db = db->next)
+    {
+        if((int)strlen(db->name) == len && memcmp(db->name, name, len) == 0)
+        {
+            db->ref++;
+            break;
+        }
+    }
+    if(db == NULL)
+    {
+        db = sqlite3_malloc(sizeof(*db) + len);
+        if(db != NULL)
+        {
+            memset(db, 0, sizeof(*db));
+            memcpy(db->name, name, len);
+            db->name[len] = 0;
+            db->ref       = 1;
+            db->page_unit = EMMC_DEFAULT_PAGE_UNIT;
+            db->next      = dbs;
+            dbs           = db;
+        }
+    }
+    sqlite3_mutex_leave(mutex);
+    return db;
+}
+
+static void putDb(emmc_db* db)
+{
+    sqlite3_mutex*  mutex = lockMutex();
+    emmc_db**       pp    = NULL;
+
+    if(--db->ref == 0)
+    {
+        for(pp = &dbs; *pp != NULL; pp = &(*pp)->next)
+        {
+            if(*pp == db)
+            {
+                *pp = db->next;
+                break;
+            }
+        }
+        sqlite3_free(db);
+    }
+    sqlite3_mutex_leave(mutex);
+}
+
+/*
+ ** Do the sync of |file|, deferred or asked for, and count it.
+ */
+static int doSync(emmc_file* file, int flags)
+{
+    sqlite3_mutex*  mutex = NULL;
+    int             rc    = file->real->pMethods->xSync(file->real, flags);
+
+    if(rc == SQLITE_OK)
+    {
+        mutex = lockMutex();
+        if(file->sync_flags)
+        {
+            file->sync_flags = 0;
+            file->db->deferred--;
+        }
+        file->dirty     = 0;
+        file->synced_ms = nowMs();
+        file->db->stats.syncs++;
+        sqlite3_mutex_leave(mutex);
+    }
+    return rc;
+}
+
+/*
+ ** Do the deferred WAL syncs of |db| before its database file is written:
+ ** a checkpoint must not overwrite pages whose WAL frames are not durable.
+ */
+static int flushDeferred(emmc_db* db)
+{
+    sqlite3_mutex*  mutex = NULL;
+    emmc_file*      wal   = NULL;
+    int             flags = 0;
+    int             rc    = SQLITE_OK;
+
+    while(rc == SQLITE_OK)
+    {
+        mutex = lockMutex();
+        if(db->deferred == 0)
+        {
+            sqlite3_mutex_leave(mutex);
+            break;
+        }
+        for(wal = db->wals; wal != NULL && wal->sync_flags == 0; wal = wal->next_wal);
+        flags = wal != NULL ? wal->sync_flags : 0;
+        sqlite3_mutex_leave(mutex);
+
+        if(wal == NULL)
+        {
+            break;
+        }
+        /* another thread may sync it meanwhile; that one counts it off */
+        rc = doSync(wal, flags);
+    }
+    return rc;
+}
+
+static int isWal(emmc_file* file)
+{
+    return (file->flags & SQLITE_OPEN_WAL) != 0;
+}
+
+static int isMainDb(emmc_file* file)
+{
+    return (file->flags & SQLITE_OPEN_MAIN_DB) != 0;
+}
+
+static void countWrite(emmc_file* file, int amt, sqlite3_int64 ofst)
+{
+    sqlite3_mutex*  mutex = lockMutex();
+    emmc_db*        db    = file->db;
+
+    file->dirty = 1;
+    db->stats.writes++;
+    db->stats.write_bytes += amt;
+    if(ofst % db->page_unit != 0 || amt % db->page_unit != 0)
+    {
+        db->stats.unaligned_writes++;
+    }
+    sqlite3_mutex_leave(mutex);
+}
+
+/*
+** sqlite3_io_methods
+*/
+
+static int emmcClose(sqlite3_file* pFile)
+{
+    emmc_file*      file  = (emmc_file*)pFile;
+    sqlite3_mutex*  mutex = NULL;
+    emmc_file**     pp    = NULL;
+    int             rc    = SQLITE_OK;
+
+    if(file->sync_flags)
+    {
+        doSync(file, file->sync_flags);
+    }
+    if(isWal(file))
+    {
+        mutex = lockMutex();
+        for(pp = &file->db->wals; *pp != NULL; pp = &(*pp)->next_wal)
+        {
+            if(*pp == file)
+            {
+                *pp = file->next_wal;
+                break;
+            }
+        }
+        if(file->sync_flags)
+        {
+            /* the sync failed; nothing more can be done for it */
+            file->sync_flags = 0;
+            file->db->deferred--;
+        }
+        sqlite3_mutex_leave(mutex);
+    }
+    rc = file->real->pMethods->xClose(file->real);
+    putDb(file->db);
+    return rc;
+}
+
+static int emmcRead(sqlite3_file* pFile, void* buf, int amt, sqlite3_int64 ofst)
+{
+    emmc_file*      file  = (emmc_file*)pFile;
+    sqlite3_mutex*  mutex = lockMutex();
+
+    file->db->stats.reads++;
+    file->db->stats.read_bytes += amt;
+    sqlite3_mutex_leave(mutex);
+    return file->real->pMethods->xRead(file->real, buf, amt, ofst);
+}
+
+static int emmcWrite(sqlite3_file* pFile, const void* buf, int amt, sqlite3_int64 ofst)
+{
+    emmc_file*  file = (emmc_file*)pFile;
+    int         rc   = SQLITE_OK;
+
+    if(isMainDb(file))
+    {
+        rc = flushDeferred(file->db);
+        if(rc != SQLITE_OK)
+        {
+            return rc;
+        }
+    }
+    countWrite(file, amt, ofst);
+    return file->real->pMethods->xWrite(file->real, buf, amt, ofst);
+}
+
+static int emmcTruncate(sqlite3_file* pFile, sqlite3_int64 size)
+{
+    emmc_file*      file  = (emmc_file*)pFile;
+    sqlite3_mutex*  mutex = NULL;
+    int             rc    = SQLITE_OK;
+
+    if(isMainDb(file))
+    {
+        rc = flushDeferred(file->db);
+        if(rc != SQLITE_OK)
+        {
+            return rc;
+        }
+    }
+    mutex = lockMutex();
+    file->dirty = 1;
+    sqlite3_mutex_leave(mutex);
+    return file->real->pMethods->xTruncate(file->real, size);
+}
+
+static int emmcSync(sqlite3_file* pFile, int flags)
+{
+    emmc_file*      file  = (emmc_file*)pFile;
+    sqlite3_mutex*  mutex = NULL;
+    int             rc    = SQLITE_OK;
+
+    if(isMainDb(file))
+    {
+        rc = flushDeferred(file->db);
+        if(rc != SQLITE_OK)
+        {
+            return rc;
+        }
+    }
+
+    mutex = lockMutex();
+    if(!file->dirty && file->sync_flags == 0)
+    {
+        file->db->stats.syncs_skipped++;
+        sqlite3_mutex_leave(mutex);
+        return SQLITE_OK;
+    }
+    if(isWal(file) && config.sync_interval_ms > 0 &&
+       nowMs() - file->synced_ms < config.sync_interval_ms)
+    {
+        if(file->sync_flags == 0)
+        {
+            file->db->deferred++;
+        }
+        file->sync_flags |= flags;
+        file->dirty = 0;
+        file->db->stats.syncs_deferred++;
+        sqlite3_mutex_leave(mutex);
+        return SQLITE_OK;
+    }
+    flags |= file->sync_flags;
+    sqlite3_mutex_leave(mutex);
+
+    return doSync(file, flags);
+}
+
+static int emmcFileSize(sqlite3_file* pFile, sqlite3_int64* pSize)
+{
+    emmc_file* file = (emmc_file*)pFile;
+    return file->real->pMethods->xFileSize(file->real, pSize);
+}
+
+static int emmcLock(sqlite3_file* pFile, int lock)
+{
+    emmc_file* file = (emmc_file*)pFile;
+    return file->real->pMethods->xLock(file->real, lock);
+}
+
+static int emmcUnlock(sqlite3_file* pFile, int lock)
+{
+    emmc_file* file = (emmc_file*)pFile;
+    return file->real->pMethods->xUnlock(file->real, lock);
+}
+
+static int emmcCheckReservedLock(sqlite3_file* pFile, int* pResOut)
+{
+    emmc_file* file = (emmc_file*)pFile;
+    return file->real->pMethods->xCheckReservedLock(file->real, pResOut);
+}
+
+static int emmcFileControl(sqlite3_file* pFile, int op, void* pArg)
+{
+    emmc_file*  file = (emmc_file*)pFile;
+    int         rc   = file->real->pMethods->xFileControl(file->real, op, pArg);
+
+    if(op == SQLITE_FCNTL_VFSNAME && rc == SQLITE_OK)
+    {
+        *(char**)pArg = sqlite3_mprintf(EMMC_VFS_NAME "/%z", *(char**)pArg);
+    }
+    return rc;
+}
+
+static int emmcSectorSize(sqlite3_file* pFile)
+{
+    emmc_file*  file = (emmc_file*)pFile;
+    int         size = file->real->pMethods->xSectorSize(file->real);
+
+    return size > file->db->page_unit ? size : file->db->page_unit;
+}
+
+/*
+ ** The eMMC rewrites a whole program unit for any write into it, so it is
+ ** no powersafe overwrite device. Without that flag sqlite takes the
+ ** sector size into account: a new database gets the unit as page size,
+ ** and WAL commits synced with synchronous=FULL are padded to whole units.
+ */
+static int emmcDeviceCharacteristics(sqlite3_file* pFile)
+{
+    emmc_file* file = (emmc_file*)pFile;
+    return file->real->pMethods->xDeviceCharacteristics(file->real) & ~SQLITE_IOCAP_POWERSAFE_OVERWRITE;
+}
+
+static int emmcShmMap(sqlite3_file* pFile, int iPg, int pgsz, int bExtend, void volatile** pp)
+{
+    emmc_file* file = (emmc_file*)pFile;
+    return file->real->pMethods->xShmMap(file->real, iPg, pgsz, bExtend, pp);
+}
+
+static int emmcShmLock(sqlite3_file* pFile, int offset, int n, int flags)
+{
+    emmc_file* file = (emmc_file*)pFile;
+    return file->real->pMethods->xShmLock(file->real, offset, n, flags);
+}
+
+static void emmcShmBarrier(sqlite3_file* pFile)
+{
+    emmc_file* file = (emmc_file*)pFile;
+    file->real->pMethods->xShmBarrier(file->real);
+}
+
+static int emmcShmUnmap(sqlite3_file* pFile, int deleteFlag)
+{
+    emmc_file* file = (emmc_file*)pFile;
+    return file->real->pMethods->xShmUnmap(file->real, deleteFlag);
+}
+
+static int emmcFetch(sqlite3_file* pFile, sqlite3_int64 ofst, int amt, void** pp)
+{
+    emmc_file*      file  = (emmc_file*)pFile;
+    sqlite3_mutex*  mutex = NULL;
+    int             rc    = file->real->pMethods->xFetch(file->real, ofst, amt, pp);
+
+    if(rc == SQLITE_OK && *pp != NULL)
+    {
+        mutex = lockMutex();
+        file->db->stats.fetches++;
+        sqlite3_mutex_leave(mutex);
+    }
+    return rc;
+}
+
+static int emmcUnfetch(sqlite3_file* pFile, sqlite3_int64 ofst, void* p)
+{
+    emmc_file* file = (emmc_file*)pFile;
+    return file->real->pMethods->xUnfetch(file->real, ofst, p);
+}
+
+static const sqlite3_io_methods emmc_io_methods =
+{
+    3,
+    emmcClose,
+    emmcRead,
+    emmcWrite,
+    emmcTruncate,
+    emmcSync,
+    emmcFileSize,
+    emmcLock,
+    emmcUnlock,
+    emmcCheckReservedLock,
+    emmcFileControl,
+    emmcSectorSize,
+    emmcDeviceCharacteristics,
+    emmcShmMap,
+    emmcShmLock,
+    emmcShmBarrier,
+    emmcShmUnmap,
+    emmcFetch,
+    emmcUnfetch
+};
+
+/*
+** sqlite3_vfs
+*/
+
+static int emmcOpen(sqlite3_vfs* pVfs, const char* zName, sqlite3_file* pFile, int flags, int* pOutFlags)
+{
+    emmc_file*      file  = (emmc_file*)pFile;
+    sqlite3_mutex*  mutex = NULL;
+    int             unit  = 0;
+    int             rc    = SQLITE_OK;
+
+    memset(file, 0, sizeof(*file));
+    file->real  = (sqlite3_file*)&file[1];
+    file->flags = flags;
+    file->db    = getDb(zName ? zName : "", flags);
+    if(file->db == NULL)
+    {
+        return SQLITE_NOMEM;
+    }
+
+    rc = real_vfs->xOpen(real_vfs, zName, file->real, flags, pOutFlags);
+    if(rc != SQLITE_OK)
+    {
+        putDb(file->db);
+        return rc;
+    }
+    file->synced_ms = nowMs();
+    unit = isMainDb(file) ? detectPageUnit(zName) : 0;
+
+    mutex = lockMutex();
+    if(unit > 0)
+    {
+        file->db->page_unit       = unit;
+        file->db->stats.page_unit = unit;
+    }
+    if(isWal(file))
+    {
+        file->next_wal = file->db->wals;
+        file->db->wals = file;
+    }
+    sqlite3_mutex_leave(mutex);
+
+    pFile->pMethods = &emmc_io_methods;
+    return SQLITE_OK;
+}
+
+static int emmcDelete(sqlite3_vfs* pVfs, const char* zName, int syncDir)
+{
+    return real_vfs->xDelete(real_vfs, zName, syncDir);
+}
+
+static int emmcAccess(sqlite3_vfs* pVfs, const char* zName, int flags, int* pResOut)
+{
+    return real_vfs->xAccess(real_vfs, zName, flags, pResOut);
+}
+
+static int emmcFullPathname(sqlite3_vfs* pVfs, const char* zName, int nOut, char* zOut)
+{
+    return real_vfs->xFullPathname(real_vfs, zName, nOut, zOut);
+}
+
+static void* emmcDlOpen(sqlite3_vfs* pVfs, const char* zPath)
+{
+    return real_vfs->xDlOpen(real_vfs, zPath);
+}
+
+static void emmcDlError(sqlite3_vfs* pVfs, int nByte, char* zErrMsg)
+{
+    real_vfs->xDlError(real_vfs, nByte, zErrMsg);
+}
+
+static void (*emmcDlSym(sqlite3_vfs* pVfs, void* p, const char* zSym))(void)
+{
+    return real_vfs->xDlSym(real_vfs, p, zSym);
+}
+
+static void emmcDlClose(sqlite3_vfs* pVfs, void* p)
+{
+    real_vfs->xDlClose(real_vfs, p);
+}
+
+static int emmcRandomness(sqlite3_vfs* pVfs, int nByte, char* zOut)
+{
+    return real_vfs->xRandomness(real_vfs, nByte, zOut);
+}
+
+static int emmcSleep(sqlite3_vfs* pVfs, int us)
+{
+    return real_vfs->xSleep(real_vfs, us);
+}
+
+static int emmcCurrentTime(sqlite3_vfs* pVfs, double* pTime)
+{
+    return real_vfs->xCurrentTime(real_vfs, pTime);
+}
+
+static int emmcGetLastError(sqlite3_vfs* pVfs, int n, char* z)
+{
+    return real_vfs->xGetLastError(real_vfs, n, z);
+}
+
+static int emmcCurrentTimeInt64(sqlite3_vfs* pVfs, sqlite3_int64* pTime)
+{
+    return real_vfs->xCurrentTimeInt64(real_vfs, pTime);
+}
+
+static sqlite3_vfs emmc_vfs =
+{
+    2,                      /* iVersion */
+    0,                      /* szOsFile, set at registration */
+    0,                      /* mxPathname, set at registration */
+    NULL,                   /* pNext */
+    EMMC_VFS_NAME,          /* zName */
+    NULL,                   /* pAppData */
+    emmcOpen,
+    emmcDelete,
+    emmcAccess,
+    emmcFullPathname,
+    emmcDlOpen,
+    emmcDlError,
+    emmcDlSym,
+    emmcDlClose,
+    emmcRandomness,
+    emmcSleep,
+    emmcCurrentTime,
+    emmcGetLastError,
+    emmcCurrentTimeInt64
+};
+
+int emmc_vfs_register(const emmc_vfs_config_t* cfg, int makeDefault)
+{
+    /* with SQLITE_EXTRA_INIT, this registers the VFS once already */
+    int rc = sqlite3_initialize();
+
+    if(rc != SQLITE_OK)
+    {
+        return rc;
+    }
+    if(cfg != NULL)
+    {
+        config = *cfg;
+    }
+    if(real_vfs == NULL)
+    {
+        real_vfs = sqlite3_vfs_find(NULL);
+        if(real_vfs == NULL || real_vfs == &emmc_vfs)
+        {
+            real_vfs = NULL;
+            return SQLITE_ERROR;
+        }
+        emmc_vfs.szOsFile   = sizeof(emmc_file) + real_vfs->szOsFile;
+        emmc_vfs.mxPathname = real_vfs->mxPathname;
+    }
+    return sqlite3_vfs_register(&emmc_vfs, makeDefault);
+}
+
+int emmc_vfs_init(const char* unused)
+{
+    return emmc_vfs_register(NULL, 1);
+}
+
+int emmc_vfs_get_stats(sqlite3* db, const char* zDbName, emmc_vfs_stats_t* stats, int reset)
+{
+    sqlite3_file*   pFile = NULL;
+    sqlite3_mutex*  mutex = NULL;
+    emmc_db*        edb   = NULL;
+
+    if(sqlite3_file_control(db, zDbName ? zDbName : "main", SQLITE_FCNTL_FILE_POINTER, &pFile) != SQLITE_OK ||
+       pFile == NULL || pFile->pMethods != &emmc_io_methods)
+    {
+        return SQLITE_NOTFOUND;
+    }
+    edb   = ((emmc_file*)pFile)->db;
+    mutex = lockMutex();
+    *stats = edb->stats;
+    if(reset)
+    {
+        memset(&edb->stats, 0, sizeof(edb->stats));
+        edb->stats.page_unit = edb->page_unit;
+    }
+    sqlite3_mutex_leave(mutex);
+    return SQLITE_OK;
+}
@@ -0,0 +1,76 @@
+/*
+ * eMMC tuned VFS for the bundled SQLite 3.17
+ *
+ * "emmc" is a shim over the default unix VFS, registered as the default
+ * VFS when libsqlite_3_17_0.so initializes (SQLITE_EXTRA_INIT), so that
+ * every app linking the library uses it without code changes. It
+ *
+ *  - reports the program unit of the eMMC holding a database as its
+ *    sector size, which makes new databases use it as their page size
+ *    (up to SQLITE_MAX_DEFAULT_PAGE_SIZE),
+ *  - skips syncs of files that were not written since their last sync,
+ *  - with sync_interval_ms, batches WAL syncs: a WAL sync within that time
+ *    of the previous one is deferred, and done before the database file
+ *    is next written or synced (a checkpoint), or when the WAL closes.
+ *    The database stays consistent; commits of the last interval may be
+ *    lost on power loss, as with synchronous=NORMAL,
+ *  - counts reads, writes, syncs and mmap fetches per database.
+ *
+ * mmap I/O is enabled library wide by SQLITE_DEFAULT_MMAP_SIZE (see the
+ * Makefile); PRAGMA mmap_size still applies per connection.
+ */
+#ifndef _EMMC_VFS_H_
+#define _EMMC_VFS_H_
+
+#include "sqlite3.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EMMC_VFS_NAME               "emmc"
+
+typedef struct emmc_vfs_config
+{
+    int     page_unit;          /* program unit in bytes; 0 reads it from sysfs */
+    int     sync_interval_ms;   /* WAL sync batching; 0 syncs as asked */
+} emmc_vfs_config_t;
+
+typedef struct emmc_vfs_stats
+{
+    sqlite3_uint64  read_bytes;
+    sqlite3_uint64  write_bytes;
+    unsigned int    reads;
+    unsigned int    writes;
+    unsigned int    unaligned_writes;   /* not on page_unit boundaries, journals included */
+    unsigned int    syncs;              /* done */
+    unsigned int    syncs_skipped;      /* of files not written since their last sync */
+    unsigned int    syncs_deferred;     /* WAL syncs batched */
+    unsigned int    fetches;            /* pages served by mmap */
+    int             page_unit;          /* program unit in use for the database */
+} emmc_vfs_stats_t;
+
+/*
+ ** Register the "emmc" VFS over the current default VFS with |cfg| (NULL
+ ** for the defaults). Calling it again updates the configuration.
+ */
+int emmc_vfs_register(const emmc_vfs_config_t* cfg, int makeDefault);
+
+/*
+ ** SQLITE_EXTRA_INIT entry: registers the VFS as the default one.
+ */
+int emmc_vfs_init(const char* unused);
+
+/*
+ ** Get (and with |reset| clear) the I/O statistics of the database
+ ** |zDbName| ("main" if NULL) of |db|, which includes its journal or WAL,
+ ** over all the connections of the process.
+ ** Return SQLITE_OK, or SQLITE_NOTFOUND if it does not use the "emmc" VFS.
+ */
+int emmc_vfs_get_stats(sqlite3* db, const char* zDbName, emmc_vfs_stats_t* stats, int reset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _EMMC_VFS_H_ */
@@ -161,24 +161,296 @@ static int is_dm_leaf(const char *devname)
 	return ret;
 }
 
+/*
+ * Device generations.
+ *
+ * Every blkid or mount helper started on hotplug probes all devices again,
+ * and re-reads the superblocks of those the cache file has not verified in
+ * the last two seconds. To avoid that, the devices verified by the last
+ * probe are saved next to the cache file together with
+ *
+ *  - the kernel uevent sequence number at the time of the probe: if it has
+ *    not changed, no device has been added, removed or changed since, and
+ *  - for each device, the inode of its /sys/dev/block/<maj>:<min> directory
+ *    and its size: sysfs creates a new directory for every device that is
+ *    plugged in, so a different stick which got the same device number is
+ *    told apart from the one that was probed.
+ *
+ * A device whose generation is unchanged is taken from the cache without
+ * reading it. Devices looked up with BLKID_DEV_VERIFY are still verified.
+ */
+#define UEVENT_SEQNUM	"/sys/kernel/uevent_seqnum"
+#define GEN_SUFFIX	".gen"
+
+struct probe_gen {
+	dev_t			devno;
+	ino_t			ino;
+	unsigned long long	size;
+};
+
+struct probe_gens {
+	unsigned long long	seqnum;		/* at the start of this probe */
+	unsigned long long	saved_seqnum;	/* of the previous probe */
+	struct probe_gen	*saved;
+	int			nsaved;
+	struct probe_gen	*cur;		/* devices found by this probe */
+	int			ncur;
+	int			maxcur;
+};
+
+static unsigned long long read_seqnum(void)
+{
+	unsigned long long seqnum = 0;
+	FILE *f = fopen(UEVENT_SEQNUM, "r");
+
+	if (f) {
+		if (fscanf(f, "%llu", &seqnum) != 1)
+			seqnum = 0;
+		fclose(f);
+	}
+	return seqnum;
+}
+
+static int get_gen(dev_t devno, struct probe_gen *gen)
+{
+	char path[64];
+	struct stat st;
+	FILE *f;
+	int ret = -1;
+
+	snprintf(path, sizeof(path), "/sys/dev/block/%u:%u",
+		 major(devno), minor(devno));
+	if (stat(path, &st) != 0)
+		return -1;
+	strcat(path, "/size");
+	f = fopen(path, "r");
+	if (!f)
+		return -1;
+	if (fscanf(f, "%llu", &gen->size) == 1) {
+		gen->devno = devno;
+		gen->ino = st.st_ino;
+		ret = 0;
+	}
+	fclose(f);
+	return ret;
+}
+
+static char *gen_filename(blkid_cache cache)
+{
+	char *name;
+
+	/* e.g. blkid_get_cache(&cache, "/dev/null") */
+	if (!cache->bic_filename || !strncmp(cache->bic_filename, "/dev/", 5))
+		return NULL;
+	name = malloc(strlen(cache->bic_filename) + sizeof(GEN_SUFFIX));
+	if (name)
+		sprintf(name, "%s" GEN_SUFFIX, cache->bic_filename);
+	return name;
+}
+
+static void read_gens(blkid_cache cache, struct probe_gens *gens)
+{
+	char *name = gen_filename(cache);
+	unsigned long long devno, ino, size;
+	FILE *f;
+	int max = 0;
+
+	memset(gens, 0, sizeof(*gens));
+
+	/* Read the sequence number before anything is probed, so that
+	 * events during the probe make the next one look again. */
+	gens->seqnum = read_seqnum();
+
+	f = name ? fopen(name, "r") : NULL;
+	free(name);
+	if (!f)
+		return;
+	if (fscanf(f, "seqnum %llu\n", &gens->saved_seqnum) != 1)
+		goto done;
+	while (fscanf(f, "%llx %llu %llu\n", &devno, &ino, &size) == 3) {
+		if (gens->nsaved == max) {
+			struct probe_gen *tmp;
+
+			max = max ? max * 2 : 16;
+			tmp = realloc(gens->saved, max * sizeof(*tmp));
+			if (!tmp)
+				break;
+			gens->saved = tmp;
+		}
+		gens->saved[gens->nsaved].devno = devno;
+		gens->saved[gens->nsaved].ino = ino;
+		gens->saved[gens->nsaved].size = size;
+		gens->nsaved++;
+	}
+done:
+	fclose(f);
+	DBG(DEBUG_DEVNAME, printf("%d device generations at seqnum %llu, "
+				  "now %llu\n", gens->nsaved,
+				  gens->saved_seqnum, gens->seqnum));
+}
+
+static void write_gens(blkid_cache cache, struct probe_gens *gens)
+{
+	char *name, *tmp;
+	FILE *f;
+	int fd, i;
+
+	/* The generations vouch for the cache file contents */
+	if (cache->bic_flags & BLKID_BIC_FL_CHANGED)
+		return;
+	if (!gens->seqnum || (gens->seqnum == gens->saved_seqnum &&
+			      gens->ncur == gens->nsaved))
+		return;
+	if (!(name = gen_filename(cache)))
+		return;
+	tmp = malloc(strlen(name) + 8);
+	if (!tmp)
+		goto out;
+	sprintf(tmp, "%s-XXXXXX", name);
+	fd = mkstemp(tmp);
+	if (fd < 0)
+		goto out;
+	fchmod(fd, 0644);
+	f = fdopen(fd, "w");
+	if (!f) {
+		close(fd);
+		unlink(tmp);
+		goto out;
+	}
+	fprintf(f, "seqnum %llu\n", gens->seqnum);
+	for (i = 0; i < gens->ncur; i++)
+		fprintf(f, "%llx %llu %llu\n",
+			(unsigned long long) gens->cur[i].devno,
+			(unsigned long long) gens->cur[i].ino,
+			gens->cur[i].size);
+	if (fclose(f) != 0 || rename(tmp, name) != 0)
+		unlink(tmp);
+out:
+	free(tmp);
+	free(name);
+}
+
+static void free_gens(struct probe_gens *gens)
+{
+	free(gens->saved);
+	free(gens->cur);
+}
+
+static struct probe_gen *find_saved_gen(struct probe_gens *gens, dev_t devno)
+{
+	int i;
+
+	for (i = 0; i < gens->nsaved; i++)
+		if (gens->saved[i].devno == devno)
+			return &gens->saved[i];
+	return NULL;
+}
+
+/*
+ * Look up the generation of @devno. Returns 1 if the device is the one
+ * which was verified by the previous probe, 0 if not, or -1 if the
+ * generation is not known.
+ */
+static int check_gen(struct probe_gens *gens, dev_t devno,
+		     struct probe_gen *gen)
+{
+	struct probe_gen *saved = find_saved_gen(gens, devno);
+
+	if (saved && gens->seqnum && gens->seqnum == gens->saved_seqnum) {
+		*gen = *saved;
+		return 1;
+	}
+	if (get_gen(devno, gen) != 0)
+		return -1;
+	return saved && saved->ino == gen->ino && saved->size == gen->size;
+}
+
+static void add_gen(struct probe_gens *gens, const struct probe_gen *gen)
+{
+	int i;
+
+	for (i = 0; i < gens->ncur; i++)
+		if (gens->cur[i].devno == gen->devno)
+			return;
+	if (gens->ncur == gens->maxcur) {
+		struct probe_gen *tmp;
+		int max = gens->maxcur ? gens->maxcur * 2 : 16;
+
+		tmp = realloc(gens->cur, max * sizeof(*tmp));
+		if (!tmp)
+			return;
+		gens->cur = tmp;
+		gens->maxcur = max;
+	}
+	gens->cur[gens->ncur++] = *gen;
+}
+
+/*
+ * Superblock read-ahead.
+ *
+ * Superblocks are probed one device after another. When several
+ * partitions are plugged in at once, the reads of the area where the
+ * common superblocks live (FAT, exFAT and NTFS at 0, ext2/3/4 and HFS+ at
+ * 1 KiB, ISO9660 and UDF at 32 KiB, btrfs at 64 KiB) are started for all
+ * new devices first, so that they proceed in parallel and the probes are
+ * served from the page cache.
+ */
+#define SB_READAHEAD_SIZE	(68 * 1024)
+
+static void readahead_sb(const char *ptname, dev_t devno)
+{
+	const char **dir;
+
+	for (dir = dirlist; *dir; dir++) {
+		char device[256];
+		struct stat st;
+		int fd;
+
+		snprintf(device, sizeof(device), "%s/%s", *dir, ptname);
+		if (stat(device, &st) != 0 || !S_ISBLK(st.st_mode) ||
+		    st.st_rdev != devno)
+			continue;
+		fd = open(device, O_RDONLY | O_NONBLOCK);
+		if (fd < 0)
+			return;
+		DBG(DEBUG_DEVNAME, printf("reading ahead %s\n", device));
+		posix_fadvise(fd, 0, SB_READAHEAD_SIZE, POSIX_FADV_WILLNEED);
+		close(fd);
+		return;
+	}
+}
+
 /*
  * Probe a single block device to add to the device cache.
  */
 static void probe_one(blkid_cache cache, const char *ptname,
-		      dev_t devno, int pri, int only_if_new, int removable)
+		      dev_t devno, int pri, int only_if_new, int removable,
+		      struct probe_gens *gens)
 {
 	blkid_dev dev = NULL;
 	struct list_head *p, *pnext;
 	const char **dir;
 	char *devname = NULL;
+	struct probe_gen gen;
+	int known = gens ? check_gen(gens, devno, &gen) : -1;
 
 	/* See if we already have this device number in the cache. */
 	list_for_each_safe(p, pnext, &cache->bic_devs) {
 		blkid_dev tmp = list_entry(p, struct blkid_struct_dev,
 					   bid_devs);
 		if (tmp->bid_devno == devno) {
-			if (only_if_new && !access(tmp->bid_name, F_OK))
+			if (only_if_new && !access(tmp->bid_name, F_OK)) {
+				if (known == 1)
+					add_gen(gens, &gen);
 				return;
+			}
+			if (known == 1 && !access(tmp->bid_name, F_OK)) {
+				DBG(DEBUG_DEVNAME, printf("%s unchanged since "
+						"last probe\n", tmp->bid_name));
+				tmp->bid_flags |= BLKID_BID_FL_VERIFIED;
+				dev = tmp;
+				break;
+			}
 			dev = blkid_verify(cache, tmp);
 			if (dev && (dev->bid_flags & BLKID_BID_FL_VERIFIED))
 				break;
@@ -247,6 +519,8 @@ set_pri:
 			dev->bid_pri = BLKID_PRI_MD;
 		if (removable)
 			dev->bid_flags |= BLKID_BID_FL_REMOVABLE;
+		if (known >= 0 && (dev->bid_flags & BLKID_BID_FL_VERIFIED))
+			add_gen(gens, &gen);
 	}
 	return;
 }
@@ -338,7 +612,7 @@ static void lvm_probe_all(blkid_cache cache, int only_if_new)
 						  lvm_device,
 						  (unsigned int) dev));
 			probe_one(cache, lvm_device, dev, BLKID_PRI_LVM,
-				  only_if_new, 0);
+				  only_if_new, 0, NULL);
 			free(lvm_device);
 		}
 		closedir(lv_list);
@@ -370,7 +644,7 @@ evms_probe_all(blkid_cache cache, int only_if_new)
 					  device, ma, mi));
 
 		probe_one(cache, device, makedev(ma, mi), BLKID_PRI_EVMS,
-			  only_if_new, 0);
+			  only_if_new, 0, NULL);
 		num++;
 	}
 	fclose(procpt);
@@ -418,12 +692,45 @@ ubi_probe_all(blkid_cache cache, int only_if_new)
 				continue;
 			DBG(DEBUG_DEVNAME, printf("UBI vol %s/%s: devno 0x%04X\n",
 				  *dirname, name, (int) dev));
-			probe_one(cache, name, dev, BLKID_PRI_UBI, only_if_new, 0);
+			probe_one(cache, name, dev, BLKID_PRI_UBI, only_if_new, 0,
+				  NULL);
 		}
 		closedir(dir);
 	}
 }
 
+/*
+ *modify by xiaojun.zheng, to skip the device of non-mmcblk and sdm, but not sdX
+ */
+static int skip_ptname(const char *ptname)
+{
+	return (strncmp(ptname, "sd", strlen("sd")) != 0 &&
+		strncmp(ptname, "mmcblk", strlen("mmcblk")) != 0) ||
+		strncmp(ptname, "sdm", strlen("sdm")) == 0;
+}
+
+/*
+ * Start reading the superblocks of the devices in /proc/partitions which
+ * have changed since the last probe.
+ */
+static void readahead_new(FILE *proc, struct probe_gens *gens)
+{
+	char line[1024], ptname[129];
+	struct probe_gen gen;
+	unsigned long long sz;
+	int ma, mi;
+
+	while (fgets(line, sizeof(line), proc)) {
+		if (sscanf(line, " %d %d %llu %128[^\n ]",
+			   &ma, &mi, &sz, ptname) != 4 ||
+		    skip_ptname(ptname) || sz <= 1)
+			continue;
+		if (check_gen(gens, makedev(ma, mi), &gen) != 1)
+			readahead_sb(ptname, makedev(ma, mi));
+	}
+	rewind(proc);
+}
+
 /*
  * Read the device data for all available block devices in the system.
  */
@@ -439,6 +746,7 @@ static int probe_all(blkid_cache cache, int only_if_new)
 	int lens[2] = { 0, 0 };
 	int which = 0, last = 0;
 	struct list_head *p, *pnext;
+	struct probe_gens gens;
 
 	ptnames[0] = ptname0;
 	ptnames[1] = ptname1;
@@ -451,6 +759,7 @@ static int probe_all(blkid_cache cache, int only_if_new)
 		return 0;
 
 	blkid_read_cache(cache);
+	read_gens(cache, &gens);
 	evms_probe_all(cache, only_if_new);
 #ifdef VG_DIR
 	lvm_probe_all(cache, only_if_new);
@@ -458,21 +767,19 @@ static int probe_all(blkid_cache cache, int only_if_new)
 	ubi_probe_all(cache, only_if_new);
 
 	proc = fopen(PROC_PARTITIONS, "r");
-	if (!proc)
+	if (!proc) {
+		free_gens(&gens);
 		return -BLKID_ERR_PROC;
+	}
+	readahead_new(proc, &gens);
 
 	while (fgets(line, sizeof(line), proc)) {
 		last = which;
 		which ^= 1;
 		ptname = ptnames[which];
-        /*
-        *modify by xiaojun.zheng, to skip the device of non-mmcblk and sdm, but not sdX
-        */
 		if (sscanf(line, " %d %d %llu %128[^\n ]",
 			   &ma, &mi, &sz, ptname) != 4 ||
-			(strncmp(ptname, "sd", strlen("sd")) != 0 &&
-		    strncmp(ptname, "mmcblk", strlen("mmcblk")) != 0) ||
-		    strncmp(ptname, "sdm", strlen("sdm")) == 0)
+		    skip_ptname(ptname))
 			continue;
 		devs[which] = makedev(ma, mi);
 
@@ -500,7 +807,7 @@ static int probe_all(blkid_cache cache, int only_if_new)
 
 			if (sz > 1)
 				probe_one(cache, ptname, devs[which], 0,
-					  only_if_new, 0);
+					  only_if_new, 0, &gens);
 			lens[which] = 0;	/* mark as checked */
 		}
 
@@ -537,17 +844,20 @@ static int probe_all(blkid_cache cache, int only_if_new)
 			    printf("whole dev %s, devno 0x%04X\n",
 				   ptnames[last], (unsigned int) devs[last]));
 			probe_one(cache, ptnames[last], devs[last], 0,
-				  only_if_new, 0);
+				  only_if_new, 0, &gens);
 			lens[last] = 0;
 		}
 	}
 
 	/* Handle the last device if it wasn't partitioned */
 	if (lens[which])
-		probe_one(cache, ptname, devs[which], 0, only_if_new, 0);
+		probe_one(cache, ptname, devs[which], 0, only_if_new, 0,
+			  &gens);
 
 	fclose(proc);
 	blkid_flush_cache(cache);
+	write_gens(cache, &gens);
+	free_gens(&gens);
 	return 0;
 }
 
@@ -604,7 +914,7 @@ static int probe_all_removable(blkid_cache cache)
 		if (sscanf(buf, "%d:%d", &ma, &mi) != 2)
 			continue;
 
-		probe_one(cache, d->d_name, makedev(ma, mi), 0, 0, 1);
+		probe_one(cache, d->d_name, makedev(ma, mi), 0, 0, 1, NULL);
 	}
 
 	closedir(dir);
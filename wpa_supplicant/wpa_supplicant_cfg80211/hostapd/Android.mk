@@ -721,6 +721,7 @@ endif
 ifneq ($(CONFIG_TLS), openssl)
 SHA1OBJS += src/crypto/sha1-pbkdf2.c
 endif
+SHA1OBJS += src/crypto/pbkdf2_cache.c
 ifdef NEED_T_PRF
 SHA1OBJS += src/crypto/sha1-tprf.c
 endif
@@ -10,6 +10,7 @@
 
 #include "utils/common.h"
 #include "crypto/sha1.h"
+#include "crypto/pbkdf2_cache.h"
 #include "radius/radius_client.h"
 #include "common/ieee802_11_defs.h"
 #include "common/eapol_common.h"
@@ -269,8 +270,8 @@ static int hostapd_config_read_wpa_psk(const char *fname,
 		if (len == 64 && hexstr2bin(pos, psk->psk, PMK_LEN) == 0)
 			ok = 1;
 		else if (len >= 8 && len < 64) {
-			pbkdf2_sha1(pos, ssid->ssid, ssid->ssid_len,
-				    4096, psk->psk, PMK_LEN);
+			pbkdf2_sha1_cached(pos, ssid->ssid, ssid->ssid_len,
+					   4096, psk->psk, PMK_LEN);
 			ok = 1;
 		}
 		if (!ok) {
@@ -303,9 +304,9 @@ static int hostapd_derive_psk(struct hostapd_ssid *ssid)
 	wpa_hexdump_ascii_key(MSG_DEBUG, "PSK (ASCII passphrase)",
 			      (u8 *) ssid->wpa_passphrase,
 			      os_strlen(ssid->wpa_passphrase));
-	pbkdf2_sha1(ssid->wpa_passphrase,
-		    ssid->ssid, ssid->ssid_len,
-		    4096, ssid->wpa_psk->psk, PMK_LEN);
+	pbkdf2_sha1_cached(ssid->wpa_passphrase,
+			   ssid->ssid, ssid->ssid_len,
+			   4096, ssid->wpa_psk->psk, PMK_LEN);
 	wpa_hexdump_key(MSG_DEBUG, "PSK (from passphrase)",
 			ssid->wpa_psk->psk, PMK_LEN);
 	return 0;
@@ -16,6 +16,7 @@
 #include "utils/common.h"
 #include "utils/eloop.h"
 #include "crypto/sha1.h"
+#include "crypto/pbkdf2_cache.h"
 #include "radius/radius.h"
 #include "radius/radius_client.h"
 #include "hostapd.h"
@@ -442,16 +443,16 @@ static void decode_tunnel_passwords(struct hostapd_data *hapd,
 			break;
 		/*
 		 * passphrase does not contain the NULL termination.
-		 * Add it here as pbkdf2_sha1() requires it.
+		 * Add it here as pbkdf2_sha1_cached() requires it.
 		 */
 		strpassphrase = os_zalloc(passphraselen + 1);
 		psk = os_zalloc(sizeof(struct hostapd_sta_wpa_psk_short));
 		if (strpassphrase && psk) {
 			os_memcpy(strpassphrase, passphrase, passphraselen);
-			pbkdf2_sha1(strpassphrase,
-				    hapd->conf->ssid.ssid,
-				    hapd->conf->ssid.ssid_len, 4096,
-				    psk->psk, PMK_LEN);
+			pbkdf2_sha1_cached(strpassphrase,
+					   hapd->conf->ssid.ssid,
+					   hapd->conf->ssid.ssid_len, 4096,
+					   psk->psk, PMK_LEN);
 			psk->next = cache->psk;
 			cache->psk = psk;
 			psk = NULL;
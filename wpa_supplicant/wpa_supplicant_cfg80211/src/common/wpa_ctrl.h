@@ -28,6 +28,8 @@ extern "C" {
 #define WPA_EVENT_DISCONNECTED "CTRL-EVENT-DISCONNECTED "
 /** Association rejected during connection attempt */
 #define WPA_EVENT_ASSOC_REJECT "CTRL-EVENT-ASSOC-REJECT "
+/** Connection completed after system resume, with the time of each phase */
+#define WPA_EVENT_RESUME_CONNECTED "CTRL-EVENT-RESUME-CONNECTED "
 /** wpa_supplicant is exiting */
 #define WPA_EVENT_TERMINATING "CTRL-EVENT-TERMINATING "
 /** Password change was completed successfully */
@@ -136,6 +138,8 @@ extern "C" {
 #define P2P_EVENT_GROUP_FORMATION_SUCCESS "P2P-GROUP-FORMATION-SUCCESS "
 #define P2P_EVENT_GROUP_FORMATION_FAILURE "P2P-GROUP-FORMATION-FAILURE "
 #define P2P_EVENT_GROUP_STARTED "P2P-GROUP-STARTED "
+/* phase=<phase> path=<go-neg|join|reinvoke|peer> elapsed_ms=<ms> */
+#define P2P_EVENT_FORMATION_TIMING "P2P-FORMATION-TIMING "
 #define P2P_EVENT_GROUP_REMOVED "P2P-GROUP-REMOVED "
 #define P2P_EVENT_CROSS_CONNECT_ENABLE "P2P-CROSS-CONNECT-ENABLE "
 #define P2P_EVENT_CROSS_CONNECT_DISABLE "P2P-CROSS-CONNECT-DISABLE "
@@ -254,6 +258,41 @@ extern "C" {
 #define WPA_BSS_MASK_WIFI_DISPLAY	BIT(16)
 #define WPA_BSS_MASK_DELIM		BIT(17)
 
+/*
+ * SCAN_RESULTS_BIN [since=<update>] [first=<id>] response
+ *
+ * All multi-octet fields are in little endian byte order.
+ *
+ * Header (WPA_SCAN_BIN_HDR_LEN octets):
+ *   magic[4] = WPA_SCAN_BIN_MAGIC
+ *   u32 update - BSS table update counter; use as since=<update> in the next
+ *	request to receive only the entries that changed after this snapshot
+ *   u16 num_ids - number of u32 BSS ids that follow (all entries in the BSS
+ *	table; entries not listed here have been removed); 0 if first=<id>
+ *	was used
+ *   u16 num_entries - number of entries following the id list
+ *   u32 next_id - 0 if the response is complete; otherwise, the remaining
+ *	entries are returned with first=<next_id>
+ * Entry (WPA_SCAN_BIN_ENTRY_LEN octets followed by ssid_len octets of SSID):
+ *   u32 id, u8 bssid[6], u16 freq, s16 level, u16 flags (WPA_SCAN_BIN_*),
+ *   u32 age (milliseconds), u8 ssid_len
+ */
+#define WPA_SCAN_BIN_MAGIC		"WSR1"
+#define WPA_SCAN_BIN_HDR_LEN		16
+#define WPA_SCAN_BIN_ENTRY_LEN		21
+
+#define WPA_SCAN_BIN_WPA		BIT(0)
+#define WPA_SCAN_BIN_RSN		BIT(1)
+#define WPA_SCAN_BIN_WEP		BIT(2)
+#define WPA_SCAN_BIN_PSK		BIT(3)
+#define WPA_SCAN_BIN_EAP		BIT(4)
+#define WPA_SCAN_BIN_WPS		BIT(5)
+#define WPA_SCAN_BIN_WPS_PBC		BIT(6)
+#define WPA_SCAN_BIN_ESS		BIT(7)
+#define WPA_SCAN_BIN_IBSS		BIT(8)
+#define WPA_SCAN_BIN_P2P		BIT(9)
+#define WPA_SCAN_BIN_HS20		BIT(10)
+
 
 /* VENDOR_ELEM_* frame id values */
 enum wpa_vendor_elem_frame {
@@ -0,0 +1,351 @@
+/*
+ * Cached PBKDF2-SHA1 passphrase-to-PSK derivation
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * The 4096 iteration PBKDF2-SHA1 used to turn a WPA passphrase into a PSK
+ * costs 16384 SHA-1 block operations and is done again on every
+ * association, soft-AP start and RADIUS-provided passphrase. This file caches
+ * the last derived keys and computes new ones with the HMAC pads hashed only
+ * once and both 20 octet output blocks of the PSK interleaved, using the
+ * ARMv8 SHA-1 instructions when the compiler targets them.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "sha1.h"
+#include "crypto.h"
+#include "pbkdf2_cache.h"
+
+#if defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2)
+#include <arm_neon.h>
+#define PBKDF2_SHA1_ARMV8
+#endif
+
+#define PBKDF2_CACHE_SIZE 8
+#define PBKDF2_CACHE_MAX_SSID 32
+/* Two SHA-1 outputs; enough for the 32 octet PSK */
+#define PBKDF2_CACHE_MAX_LEN (2 * SHA1_MAC_LEN)
+
+struct pbkdf2_cache_entry {
+	unsigned int used; /* LRU stamp; 0 = unused entry */
+	u8 pass_hash[SHA1_MAC_LEN];
+	u8 ssid[PBKDF2_CACHE_MAX_SSID];
+	size_t ssid_len;
+	int iterations;
+	size_t len;
+	u8 buf[PBKDF2_CACHE_MAX_LEN];
+};
+
+static struct pbkdf2_cache_entry pbkdf2_cache[PBKDF2_CACHE_SIZE];
+static unsigned int pbkdf2_cache_stamp;
+
+static const u32 sha1_iv[5] = {
+	0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0
+};
+
+
+#ifdef PBKDF2_SHA1_ARMV8
+
+/*
+ * Run one SHA-1 block on each of the two states. w[] holds the message
+ * words of each block and is used as scratch space.
+ */
+static void pbkdf2_sha1_compress2(u32 state[2][5], u32 w[2][16])
+{
+	static const u32 k[4] = {
+		0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6
+	};
+	uint32x4_t abcd[2], abcd_saved[2], msg[2][4], tmp[2];
+	u32 e[2], e_next[2];
+	int g, l;
+
+	for (l = 0; l < 2; l++) {
+		abcd[l] = abcd_saved[l] = vld1q_u32(state[l]);
+		e[l] = state[l][4];
+		msg[l][0] = vld1q_u32(&w[l][0]);
+		msg[l][1] = vld1q_u32(&w[l][4]);
+		msg[l][2] = vld1q_u32(&w[l][8]);
+		msg[l][3] = vld1q_u32(&w[l][12]);
+	}
+
+	/* Four rounds per step; w[4g..4g+3] is in msg[g & 3] */
+	for (g = 0; g < 20; g++) {
+		for (l = 0; l < 2; l++) {
+			tmp[l] = vaddq_u32(msg[l][g & 3],
+					   vdupq_n_u32(k[g / 5]));
+			e_next[l] = vsha1h_u32(vgetq_lane_u32(abcd[l], 0));
+			if (g < 5)
+				abcd[l] = vsha1cq_u32(abcd[l], e[l], tmp[l]);
+			else if (g < 10 || g >= 15)
+				abcd[l] = vsha1pq_u32(abcd[l], e[l], tmp[l]);
+			else
+				abcd[l] = vsha1mq_u32(abcd[l], e[l], tmp[l]);
+			e[l] = e_next[l];
+			if (g < 16)
+				msg[l][g & 3] = vsha1su1q_u32(
+					vsha1su0q_u32(msg[l][g & 3],
+						      msg[l][(g + 1) & 3],
+						      msg[l][(g + 2) & 3]),
+					msg[l][(g + 3) & 3]);
+		}
+	}
+
+	for (l = 0; l < 2; l++) {
+		vst1q_u32(state[l], vaddq_u32(abcd[l], abcd_saved[l]));
+		state[l][4] += e[l];
+	}
+}
+
+#else /* PBKDF2_SHA1_ARMV8 */
+
+#define ROL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+/*
+ * Run one SHA-1 block on each of the two states. w[] holds the message
+ * words of each block and is used as scratch space. The two blocks are
+ * independent, so their rounds are interleaved to keep the pipeline busy.
+ */
+static void pbkdf2_sha1_compress2(u32 state[2][5], u32 w[2][16])
+{
+	u32 a[2], b[2], c[2], d[2], e[2], f, t, k;
+	int i, l;
+
+	for (l = 0; l < 2; l++) {
+		a[l] = state[l][0];
+		b[l] = state[l][1];
+		c[l] = state[l][2];
+		d[l] = state[l][3];
+		e[l] = state[l][4];
+	}
+
+	for (i = 0; i < 80; i++) {
+		if (i < 20)
+			k = 0x5a827999;
+		else if (i < 40)
+			k = 0x6ed9eba1;
+		else if (i < 60)
+			k = 0x8f1bbcdc;
+		else
+			k = 0xca62c1d6;
+		for (l = 0; l < 2; l++) {
+			u32 *x = w[l];
+
+			if (i >= 16)
+				x[i & 15] = ROL(x[(i + 13) & 15] ^
+						x[(i + 8) & 15] ^
+						x[(i + 2) & 15] ^ x[i & 15], 1);
+			if (i < 20)
+				f = (b[l] & (c[l] ^ d[l])) ^ d[l];
+			else if (i < 40 || i >= 60)
+				f = b[l] ^ c[l] ^ d[l];
+			else
+				f = (b[l] & c[l]) | (d[l] & (b[l] | c[l]));
+			t = ROL(a[l], 5) + f + e[l] + k + x[i & 15];
+			e[l] = d[l];
+			d[l] = c[l];
+			c[l] = ROL(b[l], 30);
+			b[l] = a[l];
+			a[l] = t;
+		}
+	}
+
+	for (l = 0; l < 2; l++) {
+		state[l][0] += a[l];
+		state[l][1] += b[l];
+		state[l][2] += c[l];
+		state[l][3] += d[l];
+		state[l][4] += e[l];
+	}
+}
+
+#endif /* PBKDF2_SHA1_ARMV8 */
+
+
+/* Padded block holding a digest that follows the 64 octet HMAC pad */
+static void pbkdf2_sha1_digest_block(u32 *w, const u32 *digest)
+{
+	os_memcpy(w, digest, SHA1_MAC_LEN);
+	w[5] = 0x80000000;
+	os_memset(&w[6], 0, 9 * sizeof(u32));
+	w[15] = (64 + SHA1_MAC_LEN) * 8;
+}
+
+
+static void pbkdf2_sha1_block_words(u32 *w, const u8 *block, u32 mask)
+{
+	int i;
+
+	for (i = 0; i < 16; i++)
+		w[i] = WPA_GET_BE32(block + 4 * i) ^ mask;
+}
+
+
+/*
+ * PBKDF2-SHA1 for a key of at most 64 octets (the HMAC key, i.e., the
+ * passphrase or its hash), an SSID of at most 32 octets and at most two
+ * output blocks.
+ */
+static void pbkdf2_sha1_fast(const u8 *key, size_t key_len, const u8 *ssid,
+			     size_t ssid_len, int iterations, u8 *buf,
+			     size_t buflen)
+{
+	u32 ipad[5], opad[5], st[2][5], w[2][16], u[2][5], t[2][5];
+	u8 block[64];
+	int i, j, l;
+
+	/* Hash the HMAC pads once instead of twice per iteration */
+	os_memset(block, 0, sizeof(block));
+	os_memcpy(block, key, key_len);
+	pbkdf2_sha1_block_words(w[0], block, 0x36363636);
+	pbkdf2_sha1_block_words(w[1], block, 0x5c5c5c5c);
+	os_memcpy(st[0], sha1_iv, sizeof(sha1_iv));
+	os_memcpy(st[1], sha1_iv, sizeof(sha1_iv));
+	pbkdf2_sha1_compress2(st, w);
+	os_memcpy(ipad, st[0], sizeof(ipad));
+	os_memcpy(opad, st[1], sizeof(opad));
+
+	/* U_1 = PRF(P, S || INT(l + 1)) for both output blocks */
+	for (l = 0; l < 2; l++) {
+		os_memset(block, 0, sizeof(block));
+		os_memcpy(block, ssid, ssid_len);
+		WPA_PUT_BE32(block + ssid_len, l + 1);
+		block[ssid_len + 4] = 0x80;
+		WPA_PUT_BE32(block + 60, (64 + ssid_len + 4) * 8);
+		pbkdf2_sha1_block_words(w[l], block, 0);
+		os_memcpy(st[l], ipad, sizeof(ipad));
+	}
+	pbkdf2_sha1_compress2(st, w);
+	for (l = 0; l < 2; l++) {
+		pbkdf2_sha1_digest_block(w[l], st[l]);
+		os_memcpy(st[l], opad, sizeof(opad));
+	}
+	pbkdf2_sha1_compress2(st, w);
+	os_memcpy(u, st, sizeof(u));
+	os_memcpy(t, st, sizeof(t));
+
+	/* U_i = PRF(P, U_{i-1}); T = U_1 xor U_2 xor ... xor U_c */
+	for (i = 1; i < iterations; i++) {
+		for (l = 0; l < 2; l++) {
+			pbkdf2_sha1_digest_block(w[l], u[l]);
+			os_memcpy(st[l], ipad, sizeof(ipad));
+		}
+		pbkdf2_sha1_compress2(st, w);
+		for (l = 0; l < 2; l++) {
+			pbkdf2_sha1_digest_block(w[l], st[l]);
+			os_memcpy(st[l], opad, sizeof(opad));
+		}
+		pbkdf2_sha1_compress2(st, w);
+		for (l = 0; l < 2; l++) {
+			for (j = 0; j < 5; j++) {
+				u[l][j] = st[l][j];
+				t[l][j] ^= st[l][j];
+			}
+		}
+	}
+
+	for (l = 0; l < 2; l++) {
+		for (j = 0; j < 5; j++)
+			WPA_PUT_BE32(block + l * SHA1_MAC_LEN + 4 * j,
+				     t[l][j]);
+	}
+	os_memcpy(buf, block, buflen);
+
+	os_memset(block, 0, sizeof(block));
+	os_memset(ipad, 0, sizeof(ipad));
+	os_memset(opad, 0, sizeof(opad));
+	os_memset(st, 0, sizeof(st));
+	os_memset(w, 0, sizeof(w));
+	os_memset(u, 0, sizeof(u));
+	os_memset(t, 0, sizeof(t));
+}
+
+
+/**
+ * pbkdf2_sha1_cached - SHA1-based key derivation function (PBKDF2) with cache
+ * @passphrase: ASCII passphrase
+ * @ssid: SSID
+ * @ssid_len: SSID length in bytes
+ * @iterations: Number of iterations to run
+ * @buf: Buffer for the generated key
+ * @buflen: Length of the buffer in bytes
+ * Returns: 0 on success, -1 of failure
+ *
+ * Same as pbkdf2_sha1(), but the most recently derived keys are remembered,
+ * so that deriving the PSK of the same network again does not cost the full
+ * iteration count. Keys of up to 40 octets for SSIDs of up to 32 octets are
+ * cached; anything else is passed to pbkdf2_sha1().
+ */
+int pbkdf2_sha1_cached(const char *passphrase, const u8 *ssid,
+		       size_t ssid_len, int iterations, u8 *buf,
+		       size_t buflen)
+{
+	struct pbkdf2_cache_entry *e, *lru = NULL;
+	size_t pass_len = os_strlen(passphrase);
+	const u8 *addr[1];
+	size_t len[1];
+	u8 hash[SHA1_MAC_LEN];
+	int i;
+
+	if (ssid_len > PBKDF2_CACHE_MAX_SSID ||
+	    buflen > PBKDF2_CACHE_MAX_LEN || iterations < 1)
+		return pbkdf2_sha1(passphrase, ssid, ssid_len, iterations,
+				   buf, buflen);
+
+	addr[0] = (const u8 *) passphrase;
+	len[0] = pass_len;
+	if (sha1_vector(1, addr, len, hash))
+		return pbkdf2_sha1(passphrase, ssid, ssid_len, iterations,
+				   buf, buflen);
+
+	if (++pbkdf2_cache_stamp == 0) {
+		pbkdf2_sha1_cache_flush();
+		pbkdf2_cache_stamp = 1;
+	}
+
+	for (i = 0; i < PBKDF2_CACHE_SIZE; i++) {
+		e = &pbkdf2_cache[i];
+		if (e->used && e->iterations == iterations &&
+		    e->len == buflen && e->ssid_len == ssid_len &&
+		    os_memcmp(e->ssid, ssid, ssid_len) == 0 &&
+		    os_memcmp(e->pass_hash, hash, SHA1_MAC_LEN) == 0) {
+			e->used = pbkdf2_cache_stamp;
+			os_memcpy(buf, e->buf, buflen);
+			os_memset(hash, 0, sizeof(hash));
+			return 0;
+		}
+		if (lru == NULL || e->used < lru->used)
+			lru = e;
+	}
+
+	/* HMAC keys longer than the SHA-1 block are replaced by their hash */
+	if (pass_len > 64)
+		pbkdf2_sha1_fast(hash, sizeof(hash), ssid, ssid_len,
+				 iterations, buf, buflen);
+	else
+		pbkdf2_sha1_fast((const u8 *) passphrase, pass_len, ssid,
+				 ssid_len, iterations, buf, buflen);
+
+	lru->used = pbkdf2_cache_stamp;
+	os_memcpy(lru->pass_hash, hash, SHA1_MAC_LEN);
+	os_memcpy(lru->ssid, ssid, ssid_len);
+	lru->ssid_len = ssid_len;
+	lru->iterations = iterations;
+	lru->len = buflen;
+	os_memcpy(lru->buf, buf, buflen);
+	os_memset(hash, 0, sizeof(hash));
+
+	return 0;
+}
+
+
+/**
+ * pbkdf2_sha1_cache_flush - Forget all cached derived keys
+ */
+void pbkdf2_sha1_cache_flush(void)
+{
+	os_memset(pbkdf2_cache, 0, sizeof(pbkdf2_cache));
+	pbkdf2_cache_stamp = 0;
+}
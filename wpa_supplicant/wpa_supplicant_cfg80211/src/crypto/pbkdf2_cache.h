@@ -0,0 +1,16 @@
+/*
+ * Cached PBKDF2-SHA1 passphrase-to-PSK derivation
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef PBKDF2_CACHE_H
+#define PBKDF2_CACHE_H
+
+int pbkdf2_sha1_cached(const char *passphrase, const u8 *ssid,
+		       size_t ssid_len, int iterations, u8 *buf,
+		       size_t buflen);
+void pbkdf2_sha1_cache_flush(void);
+
+#endif /* PBKDF2_CACHE_H */
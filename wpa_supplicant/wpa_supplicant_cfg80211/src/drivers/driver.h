@@ -204,6 +204,9 @@ struct hostapd_hw_modes {
  * ago the last Beacon or Probe Response frame was received)
  * @ie_len: length of the following IE field in octets
  * @beacon_ie_len: length of the following Beacon IE field in octets
+ * @ie_hash: hash of the IE and Beacon IE octets following this structure or 0
+ * if the driver wrapper did not calculate one; used by the BSS table to skip
+ * comparing and copying IEs that have not changed since the previous scan
  *
  * This structure is used as a generic format for scan results from the
  * driver. Each driver interface implementation is responsible for converting
@@ -227,6 +230,7 @@ struct wpa_scan_res {
 	unsigned int age;
 	size_t ie_len;
 	size_t beacon_ie_len;
+	u32 ie_hash;
 	/*
 	 * Followed by ie_len octets of IEs from Probe Response frame (or if
 	 * the driver does not indicate source of IEs, these may also be from
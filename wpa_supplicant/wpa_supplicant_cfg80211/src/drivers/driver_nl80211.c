@@ -631,6 +631,11 @@ struct nl80211_bss_info_arg {
 	unsigned int assoc_freq;
 	unsigned int ibss_freq;
 	u8 assoc_bssid[ETH_ALEN];
+	/* scan result dump statistics */
+	unsigned int allocs;
+	size_t alloc_bytes;
+	unsigned int dups;
+	unsigned int reused;
 };
 
 static int bss_info_handler(struct nl_msg *msg, void *arg);
@@ -5470,6 +5475,67 @@ static int nl80211_scan_filtered(struct wpa_driver_nl80211_data *drv,
 }
 
 
+/*
+ * FNV-1a over the Probe Response and Beacon IEs. This is calculated directly
+ * over the attribute data in the netlink receive buffer so that the BSS table
+ * can detect unchanged IEs without comparing them octet by octet. 0 is
+ * reserved for "no hash".
+ */
+static u32 nl80211_ie_hash(const u8 *ie, size_t ie_len,
+			   const u8 *beacon_ie, size_t beacon_ie_len)
+{
+	u32 hash = 2166136261U;
+	size_t i;
+
+	for (i = 0; i < ie_len; i++) {
+		hash ^= ie[i];
+		hash *= 16777619U;
+	}
+	for (i = 0; i < beacon_ie_len; i++) {
+		hash ^= beacon_ie[i];
+		hash *= 16777619U;
+	}
+
+	return hash ? hash : 1;
+}
+
+
+static void nl80211_fill_scan_res(struct wpa_scan_res *dst,
+				  const struct wpa_scan_res *src,
+				  const u8 *ie, const u8 *beacon_ie)
+{
+	u8 *pos;
+
+	os_memcpy(dst, src, sizeof(*dst));
+	pos = (u8 *) (dst + 1);
+	if (ie) {
+		os_memcpy(pos, ie, src->ie_len);
+		pos += src->ie_len;
+	}
+	if (beacon_ie)
+		os_memcpy(pos, beacon_ie, src->beacon_ie_len);
+}
+
+
+static struct wpa_scan_res *
+nl80211_alloc_scan_res(struct nl80211_bss_info_arg *arg,
+		       const struct wpa_scan_res *src,
+		       const u8 *ie, const u8 *beacon_ie)
+{
+	struct wpa_scan_res *r;
+	size_t len = sizeof(*r) + src->ie_len + src->beacon_ie_len;
+
+	r = os_malloc(len);
+	if (r == NULL)
+		return NULL;
+	arg->allocs++;
+	arg->alloc_bytes += len;
+	nl80211_fill_scan_res(r, src, ie, beacon_ie);
+
+	return r;
+}
+
+
 static int bss_info_handler(struct nl_msg *msg, void *arg)
 {
 	struct nlattr *tb[NL80211_ATTR_MAX + 1];
@@ -5491,10 +5557,9 @@ static int bss_info_handler(struct nl_msg *msg, void *arg)
 	struct nl80211_bss_info_arg *_arg = arg;
 	struct wpa_scan_results *res = _arg->res;
 	struct wpa_scan_res **tmp;
-	struct wpa_scan_res *r;
-	const u8 *ie, *beacon_ie;
+	struct wpa_scan_res tmp_r, *r, *new_r;
+	const u8 *ie, *beacon_ie, *s2;
 	size_t ie_len, beacon_ie_len;
-	u8 *pos;
 	size_t i;
 
 	nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0),
@@ -5550,9 +5615,13 @@ static int bss_info_handler(struct nl_msg *msg, void *arg)
 				  ie ? ie_len : beacon_ie_len))
 		return NL_SKIP;
 
-	r = os_zalloc(sizeof(*r) + ie_len + beacon_ie_len);
-	if (r == NULL)
-		return NL_SKIP;
+	/*
+	 * Parse the fixed fields into a stack copy first and only allocate
+	 * (and copy the IEs out of the netlink buffer) once it is known that
+	 * this entry is going to be kept.
+	 */
+	os_memset(&tmp_r, 0, sizeof(tmp_r));
+	r = &tmp_r;
 	if (bss[NL80211_BSS_BSSID])
 		os_memcpy(r->bssid, nla_data(bss[NL80211_BSS_BSSID]),
 			  ETH_ALEN);
@@ -5577,14 +5646,8 @@ static int bss_info_handler(struct nl_msg *msg, void *arg)
 	if (bss[NL80211_BSS_SEEN_MS_AGO])
 		r->age = nla_get_u32(bss[NL80211_BSS_SEEN_MS_AGO]);
 	r->ie_len = ie_len;
-	pos = (u8 *) (r + 1);
-	if (ie) {
-		os_memcpy(pos, ie, ie_len);
-		pos += ie_len;
-	}
 	r->beacon_ie_len = beacon_ie_len;
-	if (beacon_ie)
-		os_memcpy(pos, beacon_ie, beacon_ie_len);
+	r->ie_hash = nl80211_ie_hash(ie, ie_len, beacon_ie, beacon_ie_len);
 
 	if (bss[NL80211_BSS_STATUS]) {
 		enum nl80211_bss_status status;
@@ -5609,39 +5672,56 @@ static int bss_info_handler(struct nl_msg *msg, void *arg)
 	 * order to get the correct frequency into the BSS table. Similarly,
 	 * prefer newer entries over older.
 	 */
-	for (i = 0; i < res->num; i++) {
-		const u8 *s1, *s2;
-		if (os_memcmp(res->res[i]->bssid, r->bssid, ETH_ALEN) != 0)
+	s2 = nl80211_get_ie(ie, ie_len, WLAN_EID_SSID);
+	for (i = 0; s2 && i < res->num; i++) {
+		struct wpa_scan_res *old = res->res[i];
+		const u8 *s1;
+
+		if (os_memcmp(old->bssid, r->bssid, ETH_ALEN) != 0)
 			continue;
 
-		s1 = nl80211_get_ie((u8 *) (res->res[i] + 1),
-				    res->res[i]->ie_len, WLAN_EID_SSID);
-		s2 = nl80211_get_ie((u8 *) (r + 1), r->ie_len, WLAN_EID_SSID);
-		if (s1 == NULL || s2 == NULL || s1[1] != s2[1] ||
+		s1 = nl80211_get_ie((u8 *) (old + 1), old->ie_len,
+				    WLAN_EID_SSID);
+		if (s1 == NULL || s1[1] != s2[1] ||
 		    os_memcmp(s1, s2, 2 + s1[1]) != 0)
 			continue;
 
 		/* Same BSSID,SSID was already included in scan results */
 		wpa_printf(MSG_DEBUG, "nl80211: Remove duplicated scan result "
 			   "for " MACSTR, MAC2STR(r->bssid));
+		_arg->dups++;
 
-		if (((r->flags & WPA_SCAN_ASSOCIATED) &&
-		     !(res->res[i]->flags & WPA_SCAN_ASSOCIATED)) ||
-		    r->age < res->res[i]->age) {
-			os_free(res->res[i]);
-			res->res[i] = r;
-		} else
-			os_free(r);
+		if (!((r->flags & WPA_SCAN_ASSOCIATED) &&
+		      !(old->flags & WPA_SCAN_ASSOCIATED)) &&
+		    r->age >= old->age)
+			return NL_SKIP; /* keep the old entry, nothing copied */
+
+		if (old->ie_len + old->beacon_ie_len >= ie_len + beacon_ie_len) {
+			/* New entry fits into the old allocation */
+			_arg->reused++;
+			nl80211_fill_scan_res(old, r, ie, beacon_ie);
+			return NL_SKIP;
+		}
+
+		new_r = nl80211_alloc_scan_res(_arg, r, ie, beacon_ie);
+		if (new_r == NULL)
+			return NL_SKIP;
+		os_free(old);
+		res->res[i] = new_r;
 		return NL_SKIP;
 	}
 
+	new_r = nl80211_alloc_scan_res(_arg, r, ie, beacon_ie);
+	if (new_r == NULL)
+		return NL_SKIP;
+
 	tmp = os_realloc_array(res->res, res->num + 1,
 			       sizeof(struct wpa_scan_res *));
 	if (tmp == NULL) {
-		os_free(r);
+		os_free(new_r);
 		return NL_SKIP;
 	}
-	tmp[res->num++] = r;
+	tmp[res->num++] = new_r;
 	res->res = tmp;
 
 	return NL_SKIP;
@@ -5731,13 +5811,17 @@ nl80211_get_scan_results(struct wpa_driver_nl80211_data *drv)
 	if (nl80211_set_iface_id(msg, drv->first_bss) < 0)
 		goto nla_put_failure;
 
+	os_memset(&arg, 0, sizeof(arg));
 	arg.drv = drv;
 	arg.res = res;
 	ret = send_and_recv_msgs(drv, msg, bss_info_handler, &arg);
 	msg = NULL;
 	if (ret == 0) {
 		wpa_printf(MSG_DEBUG, "nl80211: Received scan results (%lu "
-			   "BSSes)", (unsigned long) res->num);
+			   "BSSes; %u allocations, %lu bytes; %u duplicates, "
+			   "%u reused)", (unsigned long) res->num, arg.allocs,
+			   (unsigned long) arg.alloc_bytes, arg.dups,
+			   arg.reused);
 		nl80211_get_noise_for_scan_results(drv, res);
 		return res;
 	}
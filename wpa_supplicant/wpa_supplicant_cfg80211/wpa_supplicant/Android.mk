@@ -1278,6 +1278,7 @@ else
 ifneq ($(CONFIG_TLS), openssl)
 SHA1OBJS += src/crypto/sha1-pbkdf2.c
 endif
+SHA1OBJS += src/crypto/pbkdf2_cache.c
 endif
 ifdef NEED_T_PRF
 SHA1OBJS += src/crypto/sha1-tprf.c
@@ -1532,6 +1533,12 @@ OBJS += bgscan_learn.c
 NEED_BGSCAN=y
 endif
 
+ifdef CONFIG_BGSCAN_STATIC
+L_CFLAGS += -DCONFIG_BGSCAN_STATIC
+OBJS += bgscan_static.c
+NEED_BGSCAN=y
+endif
+
 ifdef NEED_BGSCAN
 L_CFLAGS += -DCONFIG_BGSCAN
 OBJS += bgscan.c
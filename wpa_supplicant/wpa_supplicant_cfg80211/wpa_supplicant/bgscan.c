@@ -19,6 +19,9 @@ extern const struct bgscan_ops bgscan_simple_ops;
 #ifdef CONFIG_BGSCAN_LEARN
 extern const struct bgscan_ops bgscan_learn_ops;
 #endif /* CONFIG_BGSCAN_LEARN */
+#ifdef CONFIG_BGSCAN_STATIC
+extern const struct bgscan_ops bgscan_static_ops;
+#endif /* CONFIG_BGSCAN_STATIC */
 
 static const struct bgscan_ops * bgscan_modules[] = {
 #ifdef CONFIG_BGSCAN_SIMPLE
@@ -27,6 +30,9 @@ static const struct bgscan_ops * bgscan_modules[] = {
 #ifdef CONFIG_BGSCAN_LEARN
 	&bgscan_learn_ops,
 #endif /* CONFIG_BGSCAN_LEARN */
+#ifdef CONFIG_BGSCAN_STATIC
+	&bgscan_static_ops,
+#endif /* CONFIG_BGSCAN_STATIC */
 	NULL
 };
 
@@ -115,3 +121,32 @@ void bgscan_notify_signal_change(struct wpa_supplicant *wpa_s, int above,
 						    current_noise,
 						    current_txrate);
 }
+
+
+int bgscan_trigger(struct wpa_supplicant *wpa_s)
+{
+	if (wpa_s->bgscan && wpa_s->bgscan_priv && wpa_s->bgscan->trigger)
+		return wpa_s->bgscan->trigger(wpa_s->bgscan_priv);
+	return -1;
+}
+
+
+int bgscan_get_status(struct wpa_supplicant *wpa_s, char *buf, size_t buflen)
+{
+	int ret, len;
+
+	if (wpa_s->bgscan == NULL || wpa_s->bgscan_priv == NULL)
+		return -1;
+
+	ret = os_snprintf(buf, buflen, "MODULE=%s\n", wpa_s->bgscan->name);
+	if (ret < 0 || (size_t) ret >= buflen)
+		return -1;
+	if (wpa_s->bgscan->get_status == NULL)
+		return ret;
+
+	len = wpa_s->bgscan->get_status(wpa_s->bgscan_priv, buf + ret,
+					buflen - ret);
+	if (len < 0)
+		return -1;
+	return ret + len;
+}
@@ -25,6 +25,11 @@ struct bgscan_ops {
 				     int current_signal,
 				     int current_noise,
 				     int current_txrate);
+
+	/* Optional: request a background scan now */
+	int (*trigger)(void *priv);
+	/* Optional: write module state and statistics as text into buf */
+	int (*get_status)(void *priv, char *buf, size_t buflen);
 };
 
 #ifdef CONFIG_BGSCAN
@@ -38,6 +43,8 @@ void bgscan_notify_beacon_loss(struct wpa_supplicant *wpa_s);
 void bgscan_notify_signal_change(struct wpa_supplicant *wpa_s, int above,
 				 int current_signal, int current_noise,
 				 int current_txrate);
+int bgscan_trigger(struct wpa_supplicant *wpa_s);
+int bgscan_get_status(struct wpa_supplicant *wpa_s, char *buf, size_t buflen);
 
 #else /* CONFIG_BGSCAN */
 
@@ -68,6 +75,17 @@ static inline void bgscan_notify_signal_change(struct wpa_supplicant *wpa_s,
 {
 }
 
+static inline int bgscan_trigger(struct wpa_supplicant *wpa_s)
+{
+	return -1;
+}
+
+static inline int bgscan_get_status(struct wpa_supplicant *wpa_s, char *buf,
+				    size_t buflen)
+{
+	return -1;
+}
+
 #endif /* CONFIG_BGSCAN */
 
 #endif /* BGSCAN_H */
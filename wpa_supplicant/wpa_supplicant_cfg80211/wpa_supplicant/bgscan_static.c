@@ -0,0 +1,632 @@
+/*
+ * WPA Supplicant - background scan and roaming module: static
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * This module is meant for devices that are never moved (e.g., a TV). After
+ * a short learning phase with periodic scans, no more periodic background
+ * scans are done. Instead, the signal strength of the current AP is polled
+ * and compared against the learned baseline and its variation. Scans are
+ * requested only on the learned channels when the signal drops clearly below
+ * the baseline, on beacon loss, or when explicitly triggered.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "eloop.h"
+#include "list.h"
+#include "common/ieee802_11_defs.h"
+#include "drivers/driver.h"
+#include "config_ssid.h"
+#include "wpa_supplicant_i.h"
+#include "driver_i.h"
+#include "scan.h"
+#include "bgscan.h"
+
+/* Number of scans used to learn the ESS before going quiet */
+#define BGSCAN_STATIC_LEARN_SCANS 3
+/* Signal poll interval in seconds */
+#define BGSCAN_STATIC_POLL_INTERVAL 10
+/* Signal samples needed before the baseline is trusted */
+#define BGSCAN_STATIC_MIN_SAMPLES 6
+/* Signal drop, in units of mean deviation, considered a degradation */
+#define BGSCAN_STATIC_DEV_MULT 3
+
+struct bgscan_static_bss {
+	struct dl_list list;
+	u8 bssid[ETH_ALEN];
+	int freq;
+};
+
+struct bgscan_static_data {
+	struct wpa_supplicant *wpa_s;
+	const struct wpa_ssid *ssid;
+	int scan_interval; /* periodic interval while learning */
+	int margin; /* minimum signal drop (dB) that triggers a scan */
+	int max_interval; /* full refresh scan interval; 0 = never */
+	char *fname;
+	struct dl_list bss;
+	int learn_left; /* scans left in the learning phase */
+	int avg8; /* signal baseline (dBm), scaled by 8 */
+	int dev4; /* mean deviation from the baseline (dB), scaled by 4 */
+	int samples;
+	int no_poll; /* driver does not support signal polling */
+	struct os_reltime last_bgscan;
+	struct os_reltime last_due; /* last time a periodic scan was due */
+	unsigned int scans;
+	unsigned int scans_triggered;
+	unsigned int scans_avoided;
+	unsigned int neigh_changes;
+};
+
+
+static void bgscan_static_timeout(void *eloop_ctx, void *timeout_ctx);
+static void bgscan_static_poll(void *eloop_ctx, void *timeout_ctx);
+
+
+static struct bgscan_static_bss * bgscan_static_get_bss(
+	struct bgscan_static_data *data, const u8 *bssid)
+{
+	struct bgscan_static_bss *bss;
+
+	dl_list_for_each(bss, &data->bss, struct bgscan_static_bss, list) {
+		if (os_memcmp(bss->bssid, bssid, ETH_ALEN) == 0)
+			return bss;
+	}
+	return NULL;
+}
+
+
+static struct bgscan_static_bss * bgscan_static_add_bss(
+	struct bgscan_static_data *data, const u8 *bssid, int freq)
+{
+	struct bgscan_static_bss *bss;
+
+	bss = os_zalloc(sizeof(*bss));
+	if (bss == NULL)
+		return NULL;
+	os_memcpy(bss->bssid, bssid, ETH_ALEN);
+	bss->freq = freq;
+	dl_list_add(&data->bss, &bss->list);
+	return bss;
+}
+
+
+static int bgscan_static_learning(struct bgscan_static_data *data)
+{
+	return data->learn_left > 0 ||
+		data->samples < BGSCAN_STATIC_MIN_SAMPLES;
+}
+
+
+static int bgscan_static_threshold(struct bgscan_static_data *data)
+{
+	int drop;
+
+	drop = BGSCAN_STATIC_DEV_MULT * data->dev4 / 4;
+	if (drop < data->margin)
+		drop = data->margin;
+	return data->avg8 / 8 - drop;
+}
+
+
+static int bgscan_static_load(struct bgscan_static_data *data)
+{
+	FILE *f;
+	char buf[128];
+	struct bgscan_static_bss *bss;
+	u8 addr[ETH_ALEN];
+
+	if (data->fname == NULL)
+		return 0;
+
+	f = fopen(data->fname, "r");
+	if (f == NULL)
+		return 0;
+
+	wpa_printf(MSG_DEBUG, "bgscan static: Loading data from %s",
+		   data->fname);
+
+	if (fgets(buf, sizeof(buf), f) == NULL ||
+	    os_strncmp(buf, "wpa_supplicant-bgscan-static\n", 29) != 0) {
+		wpa_printf(MSG_INFO, "bgscan static: Invalid data file %s",
+			   data->fname);
+		fclose(f);
+		return -1;
+	}
+
+	while (fgets(buf, sizeof(buf), f)) {
+		if (os_strncmp(buf, "BASELINE ", 9) == 0) {
+			char *pos;
+
+			data->avg8 = atoi(buf + 9);
+			pos = os_strchr(buf + 9, ' ');
+			if (pos == NULL)
+				continue;
+			data->dev4 = atoi(pos + 1);
+			/*
+			 * Trust the stored baseline, but let it adapt quickly
+			 * if the environment changed while we were away.
+			 */
+			data->samples = BGSCAN_STATIC_MIN_SAMPLES;
+		}
+
+		if (os_strncmp(buf, "BSS ", 4) == 0) {
+			if (hwaddr_aton(buf + 4, addr) < 0 ||
+			    bgscan_static_get_bss(data, addr))
+				continue;
+			bss = bgscan_static_add_bss(data, addr,
+						    atoi(buf + 4 + 18));
+			if (bss == NULL)
+				continue;
+			wpa_printf(MSG_DEBUG, "bgscan static: Loaded BSS "
+				   "entry: " MACSTR " freq=%d",
+				   MAC2STR(bss->bssid), bss->freq);
+		}
+	}
+
+	fclose(f);
+
+	if (!dl_list_empty(&data->bss) && data->samples)
+		data->learn_left = 0;
+
+	return 0;
+}
+
+
+static void bgscan_static_save(struct bgscan_static_data *data)
+{
+	FILE *f;
+	struct bgscan_static_bss *bss;
+
+	if (data->fname == NULL || bgscan_static_learning(data))
+		return;
+
+	wpa_printf(MSG_DEBUG, "bgscan static: Saving data to %s",
+		   data->fname);
+
+	f = fopen(data->fname, "w");
+	if (f == NULL)
+		return;
+	fprintf(f, "wpa_supplicant-bgscan-static\n");
+	fprintf(f, "BASELINE %d %d\n", data->avg8, data->dev4);
+
+	dl_list_for_each(bss, &data->bss, struct bgscan_static_bss, list) {
+		fprintf(f, "BSS " MACSTR " %d\n",
+			MAC2STR(bss->bssid), bss->freq);
+	}
+
+	fclose(f);
+}
+
+
+static int in_array(int *array, int val)
+{
+	int i;
+
+	if (array == NULL)
+		return 0;
+
+	for (i = 0; array[i]; i++) {
+		if (array[i] == val)
+			return 1;
+	}
+
+	return 0;
+}
+
+
+static int * bgscan_static_get_freqs(struct bgscan_static_data *data,
+				     size_t *count)
+{
+	struct bgscan_static_bss *bss;
+	int *freqs = NULL, *n;
+
+	*count = 0;
+
+	dl_list_for_each(bss, &data->bss, struct bgscan_static_bss, list) {
+		if (in_array(freqs, bss->freq))
+			continue;
+		n = os_realloc_array(freqs, *count + 2, sizeof(int));
+		if (n == NULL)
+			return freqs;
+		freqs = n;
+		freqs[*count] = bss->freq;
+		(*count)++;
+		freqs[*count] = 0;
+	}
+
+	return freqs;
+}
+
+
+static void bgscan_static_scan(struct bgscan_static_data *data, int full)
+{
+	struct wpa_supplicant *wpa_s = data->wpa_s;
+	struct wpa_driver_scan_params params;
+	int *freqs = NULL;
+	size_t count = 0;
+
+	os_memset(&params, 0, sizeof(params));
+	params.num_ssids = 1;
+	params.ssids[0].ssid = data->ssid->ssid;
+	params.ssids[0].ssid_len = data->ssid->ssid_len;
+	if (data->ssid->scan_freq)
+		params.freqs = data->ssid->scan_freq;
+	else if (!full) {
+		freqs = bgscan_static_get_freqs(data, &count);
+		params.freqs = freqs;
+	}
+
+	wpa_printf(MSG_DEBUG, "bgscan static: Request a background scan "
+		   "(%s)", params.freqs ? "learned channels" : "all channels");
+	if (wpa_supplicant_trigger_scan(wpa_s, &params)) {
+		wpa_printf(MSG_DEBUG, "bgscan static: Failed to trigger scan");
+		eloop_cancel_timeout(bgscan_static_timeout, data, NULL);
+		eloop_register_timeout(data->scan_interval, 0,
+				       bgscan_static_timeout, data, NULL);
+	} else {
+		data->scans++;
+		os_get_reltime(&data->last_bgscan);
+		data->last_due = data->last_bgscan;
+	}
+	os_free(freqs);
+}
+
+
+static void bgscan_static_timeout(void *eloop_ctx, void *timeout_ctx)
+{
+	struct bgscan_static_data *data = eloop_ctx;
+
+	/*
+	 * Periodic scans are only used while learning (to find the channels
+	 * of the ESS) and for the optional full refresh scan.
+	 */
+	bgscan_static_scan(data, 1);
+}
+
+
+static void bgscan_static_check(struct bgscan_static_data *data, int signal,
+				int update)
+{
+	struct os_reltime now;
+	int threshold, diff;
+
+	if (update) {
+		/* Same estimator as TCP uses for RTT (RFC 6298) */
+		if (data->samples == 0) {
+			data->avg8 = signal * 8;
+			data->dev4 = 0;
+		} else {
+			diff = signal - data->avg8 / 8;
+			data->avg8 += diff;
+			if (diff < 0)
+				diff = -diff;
+			data->dev4 += diff - data->dev4 / 4;
+		}
+		if (data->samples < BGSCAN_STATIC_MIN_SAMPLES)
+			data->samples++;
+	}
+
+	if (bgscan_static_learning(data))
+		return;
+
+	os_get_reltime(&now);
+	threshold = bgscan_static_threshold(data);
+	if (signal < threshold &&
+	    now.sec >= data->last_bgscan.sec + data->scan_interval) {
+		wpa_printf(MSG_DEBUG, "bgscan static: Signal %d below learned "
+			   "threshold %d (baseline %d deviation %d) - scan",
+			   signal, threshold, data->avg8 / 8, data->dev4 / 4);
+		data->scans_triggered++;
+		bgscan_static_scan(data, 0);
+		return;
+	}
+
+	/* Count the periodic scans that a fixed interval would have done */
+	if (now.sec >= data->last_due.sec + data->scan_interval) {
+		data->scans_avoided++;
+		data->last_due = now;
+	}
+}
+
+
+static void bgscan_static_poll(void *eloop_ctx, void *timeout_ctx)
+{
+	struct bgscan_static_data *data = eloop_ctx;
+	struct wpa_signal_info siginfo;
+
+	eloop_register_timeout(BGSCAN_STATIC_POLL_INTERVAL, 0,
+			       bgscan_static_poll, data, NULL);
+
+	if (wpa_drv_signal_poll(data->wpa_s, &siginfo) < 0) {
+		if (!data->no_poll) {
+			wpa_printf(MSG_INFO, "bgscan static: Signal poll not "
+				   "supported - use periodic scans");
+			data->no_poll = 1;
+		}
+		if (!eloop_is_timeout_registered(bgscan_static_timeout, data,
+						 NULL))
+			eloop_register_timeout(data->scan_interval, 0,
+					       bgscan_static_timeout, data,
+					       NULL);
+		return;
+	}
+	data->no_poll = 0;
+
+	bgscan_static_check(data, siginfo.current_signal, 1);
+}
+
+
+static int bgscan_static_get_params(struct bgscan_static_data *data,
+				    const char *params)
+{
+	const char *pos;
+
+	if (params == NULL)
+		return 0;
+
+	data->scan_interval = atoi(params);
+
+	pos = os_strchr(params, ':');
+	if (pos == NULL)
+		return 0;
+	pos++;
+	data->margin = atoi(pos);
+	pos = os_strchr(pos, ':');
+	if (pos == NULL)
+		return 0;
+	pos++;
+	data->max_interval = atoi(pos);
+	pos = os_strchr(pos, ':');
+	if (pos) {
+		pos++;
+		data->fname = os_strdup(pos);
+	}
+
+	return 0;
+}
+
+
+static void * bgscan_static_init(struct wpa_supplicant *wpa_s,
+				 const char *params,
+				 const struct wpa_ssid *ssid)
+{
+	struct bgscan_static_data *data;
+
+	data = os_zalloc(sizeof(*data));
+	if (data == NULL)
+		return NULL;
+	dl_list_init(&data->bss);
+	data->wpa_s = wpa_s;
+	data->ssid = ssid;
+	data->learn_left = BGSCAN_STATIC_LEARN_SCANS;
+	if (bgscan_static_get_params(data, params) < 0) {
+		os_free(data->fname);
+		os_free(data);
+		return NULL;
+	}
+	if (data->scan_interval <= 0)
+		data->scan_interval = 30;
+	if (data->margin <= 0)
+		data->margin = 8;
+	if (data->max_interval < 0)
+		data->max_interval = 0;
+
+	if (bgscan_static_load(data) < 0) {
+		os_free(data->fname);
+		os_free(data);
+		return NULL;
+	}
+
+	wpa_printf(MSG_DEBUG, "bgscan static: Scan interval %d  Signal "
+		   "margin %d  Refresh interval %d  Learning scans %d",
+		   data->scan_interval, data->margin, data->max_interval,
+		   data->learn_left);
+
+	if (data->learn_left)
+		eloop_register_timeout(data->scan_interval, 0,
+				       bgscan_static_timeout, data, NULL);
+	else if (data->max_interval)
+		eloop_register_timeout(data->max_interval, 0,
+				       bgscan_static_timeout, data, NULL);
+	eloop_register_timeout(BGSCAN_STATIC_POLL_INTERVAL, 0,
+			       bgscan_static_poll, data, NULL);
+
+	/*
+	 * This function is called immediately after an association, so it is
+	 * reasonable to assume that a scan was completed recently.
+	 */
+	os_get_reltime(&data->last_bgscan);
+	data->last_due = data->last_bgscan;
+
+	return data;
+}
+
+
+static void bgscan_static_deinit(void *priv)
+{
+	struct bgscan_static_data *data = priv;
+	struct bgscan_static_bss *bss, *n;
+
+	bgscan_static_save(data);
+	eloop_cancel_timeout(bgscan_static_timeout, data, NULL);
+	eloop_cancel_timeout(bgscan_static_poll, data, NULL);
+	os_free(data->fname);
+	dl_list_for_each_safe(bss, n, &data->bss, struct bgscan_static_bss,
+			      list) {
+		dl_list_del(&bss->list);
+		os_free(bss);
+	}
+	os_free(data);
+}
+
+
+static int bgscan_static_bss_match(struct bgscan_static_data *data,
+				   struct wpa_scan_res *bss)
+{
+	const u8 *ie;
+
+	ie = wpa_scan_get_ie(bss, WLAN_EID_SSID);
+	if (ie == NULL)
+		return 0;
+
+	if (data->ssid->ssid_len != ie[1] ||
+	    os_memcmp(data->ssid->ssid, ie + 2, ie[1]) != 0)
+		return 0; /* SSID mismatch */
+
+	return 1;
+}
+
+
+static int bgscan_static_notify_scan(void *priv,
+				     struct wpa_scan_results *scan_res)
+{
+	struct bgscan_static_data *data = priv;
+	struct bgscan_static_bss *bss;
+	size_t i;
+	int learning = bgscan_static_learning(data);
+
+	wpa_printf(MSG_DEBUG, "bgscan static: scan result notification");
+
+	eloop_cancel_timeout(bgscan_static_timeout, data, NULL);
+
+	for (i = 0; i < scan_res->num; i++) {
+		struct wpa_scan_res *res = scan_res->res[i];
+
+		if (!bgscan_static_bss_match(data, res))
+			continue;
+
+		bss = bgscan_static_get_bss(data, res->bssid);
+		if (bss && bss->freq != res->freq) {
+			wpa_printf(MSG_DEBUG, "bgscan static: Update BSS "
+				   MACSTR " freq %d -> %d",
+				   MAC2STR(res->bssid), bss->freq, res->freq);
+			bss->freq = res->freq;
+			if (!learning)
+				data->neigh_changes++;
+		} else if (!bss) {
+			wpa_printf(MSG_DEBUG, "bgscan static: Add BSS " MACSTR
+				   " freq=%d", MAC2STR(res->bssid), res->freq);
+			if (bgscan_static_add_bss(data, res->bssid,
+						  res->freq) && !learning)
+				data->neigh_changes++;
+		}
+	}
+
+	if (data->learn_left > 0) {
+		data->learn_left--;
+		if (data->learn_left == 0)
+			wpa_printf(MSG_DEBUG, "bgscan static: Learned %u "
+				   "BSSes of the ESS", (unsigned int)
+				   dl_list_len(&data->bss));
+	}
+
+	if (data->learn_left > 0 || data->no_poll)
+		eloop_register_timeout(data->scan_interval, 0,
+				       bgscan_static_timeout, data, NULL);
+	else if (data->max_interval)
+		eloop_register_timeout(data->max_interval, 0,
+				       bgscan_static_timeout, data, NULL);
+
+	/* Use the existing BSS/ESS selection routine */
+	return 0;
+}
+
+
+static void bgscan_static_notify_beacon_loss(void *priv)
+{
+	struct bgscan_static_data *data = priv;
+	struct os_reltime now;
+
+	wpa_printf(MSG_DEBUG, "bgscan static: beacon loss");
+
+	os_get_reltime(&now);
+	if (now.sec > data->last_bgscan.sec + 1) {
+		data->scans_triggered++;
+		bgscan_static_scan(data, 0);
+	}
+}
+
+
+static void bgscan_static_notify_signal_change(void *priv, int above,
+					       int current_signal,
+					       int current_noise,
+					       int current_txrate)
+{
+	struct bgscan_static_data *data = priv;
+
+	if (above)
+		return;
+
+	wpa_printf(MSG_DEBUG, "bgscan static: signal level changed "
+		   "(above=%d current_signal=%d current_noise=%d "
+		   "current_txrate=%d)", above, current_signal,
+		   current_noise, current_txrate);
+	bgscan_static_check(data, current_signal, 0);
+}
+
+
+static int bgscan_static_trigger(void *priv)
+{
+	struct bgscan_static_data *data = priv;
+
+	wpa_printf(MSG_DEBUG, "bgscan static: Explicit scan trigger");
+	data->scans_triggered++;
+	bgscan_static_scan(data, 1);
+	return 0;
+}
+
+
+static int bgscan_static_get_status(void *priv, char *buf, size_t buflen)
+{
+	struct bgscan_static_data *data = priv;
+	char *pos = buf, *end = buf + buflen;
+	int *freqs, ret;
+	size_t count, i;
+
+	ret = os_snprintf(pos, end - pos, "STATE=%s\nBASELINE=%d\n"
+			  "DEVIATION=%d\nTHRESHOLD=%d\nBSSES=%u\n"
+			  "SCANS=%u\nSCANS_TRIGGERED=%u\nSCANS_AVOIDED=%u\n"
+			  "NEIGHBOR_CHANGES=%u\nCHANNELS=",
+			  bgscan_static_learning(data) ? "LEARNING" : "STABLE",
+			  data->avg8 / 8, data->dev4 / 4,
+			  bgscan_static_threshold(data),
+			  (unsigned int) dl_list_len(&data->bss), data->scans,
+			  data->scans_triggered, data->scans_avoided,
+			  data->neigh_changes);
+	if (ret < 0 || ret >= end - pos)
+		return -1;
+	pos += ret;
+
+	freqs = bgscan_static_get_freqs(data, &count);
+	for (i = 0; i < count; i++) {
+		ret = os_snprintf(pos, end - pos, "%s%d", i ? " " : "",
+				  freqs[i]);
+		if (ret < 0 || ret >= end - pos)
+			break;
+		pos += ret;
+	}
+	os_free(freqs);
+
+	ret = os_snprintf(pos, end - pos, "\n");
+	if (ret < 0 || ret >= end - pos)
+		return -1;
+	pos += ret;
+
+	return pos - buf;
+}
+
+
+const struct bgscan_ops bgscan_static_ops = {
+	.name = "static",
+	.init = bgscan_static_init,
+	.deinit = bgscan_static_deinit,
+	.notify_scan = bgscan_static_notify_scan,
+	.notify_beacon_loss = bgscan_static_notify_beacon_loss,
+	.notify_signal_change = bgscan_static_notify_signal_change,
+	.trigger = bgscan_static_trigger,
+	.get_status = bgscan_static_get_status,
+};
@@ -218,6 +218,7 @@ static void wpa_bss_remove(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 	wpa_bss_update_pending_connect(wpa_s, bss, NULL);
 	dl_list_del(&bss->list);
 	dl_list_del(&bss->list_id);
+	dl_list_del(&bss->list_hash);
 	wpa_s->num_bss--;
 	wpa_dbg(wpa_s, MSG_DEBUG, "BSS: Remove id %u BSSID " MACSTR
 		" SSID '%s' due to %s", bss->id, MAC2STR(bss->bssid),
@@ -242,7 +243,8 @@ struct wpa_bss * wpa_bss_get(struct wpa_supplicant *wpa_s, const u8 *bssid,
 	struct wpa_bss *bss;
 	if (!wpa_supplicant_filter_bssid_match(wpa_s, bssid))
 		return NULL;
-	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
+	dl_list_for_each(bss, &wpa_s->bss_hash[WPA_BSS_HASH(bssid)],
+			 struct wpa_bss, list_hash) {
 		if (os_memcmp(bss->bssid, bssid, ETH_ALEN) == 0 &&
 		    bss->ssid_len == ssid_len &&
 		    os_memcmp(bss->ssid, ssid, ssid_len) == 0)
@@ -363,12 +365,16 @@ static struct wpa_bss * wpa_bss_add(struct wpa_supplicant *wpa_s,
 		return NULL;
 	bss->id = wpa_s->bss_next_id++;
 	bss->last_update_idx = wpa_s->bss_update_idx;
+	bss->last_change_idx = wpa_s->bss_update_idx;
+	bss->last_change_level = res->level;
 	wpa_bss_copy_res(bss, res, fetch_time);
 	os_memcpy(bss->ssid, ssid, ssid_len);
 	bss->ssid_len = ssid_len;
 	bss->ie_len = res->ie_len;
 	bss->beacon_ie_len = res->beacon_ie_len;
+	bss->ie_hash = res->ie_hash;
 	os_memcpy(bss + 1, res + 1, res->ie_len + res->beacon_ie_len);
+	wpa_s->bss_ie_copies++;
 	wpa_bss_set_hessid(bss);
 
 	if (wpa_s->num_bss + 1 > wpa_s->conf->bss_max_count &&
@@ -381,6 +387,8 @@ static struct wpa_bss * wpa_bss_add(struct wpa_supplicant *wpa_s,
 
 	dl_list_add_tail(&wpa_s->bss, &bss->list);
 	dl_list_add_tail(&wpa_s->bss_id, &bss->list_id);
+	dl_list_add_tail(&wpa_s->bss_hash[WPA_BSS_HASH(bss->bssid)],
+			 &bss->list_hash);
 	wpa_s->num_bss++;
 	wpa_dbg(wpa_s, MSG_DEBUG, "BSS: Add new id %u BSSID " MACSTR
 		" SSID '%s'",
@@ -447,7 +455,7 @@ static int are_ies_equal(const struct wpa_bss *old,
 
 
 static u32 wpa_bss_compare_res(const struct wpa_bss *old,
-			       const struct wpa_scan_res *new)
+			       const struct wpa_scan_res *new, int same_ies)
 {
 	u32 changes = 0;
 	int caps_diff = old->caps ^ new->caps;
@@ -464,8 +472,9 @@ static u32 wpa_bss_compare_res(const struct wpa_bss *old,
 	if (caps_diff & IEEE80211_CAP_IBSS)
 		changes |= WPA_BSS_MODE_CHANGED_FLAG;
 
-	if (old->ie_len == new->ie_len &&
-	    os_memcmp(old + 1, new + 1, old->ie_len) == 0)
+	if (same_ies ||
+	    (old->ie_len == new->ie_len &&
+	     os_memcmp(old + 1, new + 1, old->ie_len) == 0))
 		return changes;
 	changes |= WPA_BSS_IES_CHANGED_FLAG;
 
@@ -525,13 +534,36 @@ wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 	       struct wpa_scan_res *res, struct os_reltime *fetch_time)
 {
 	u32 changes;
-
-	changes = wpa_bss_compare_res(bss, res);
+	/*
+	 * Only an entry which was already updated in this round can be in
+	 * last_scan_res.
+	 */
+	int listed = bss->last_update_idx == wpa_s->bss_update_idx;
+	/*
+	 * The driver wrapper may provide a hash of the IEs; if it matches and
+	 * the lengths are unchanged, the IEs do not need to be compared or
+	 * copied again.
+	 */
+	int same_ies = res->ie_hash && res->ie_hash == bss->ie_hash &&
+		res->ie_len == bss->ie_len &&
+		res->beacon_ie_len == bss->beacon_ie_len;
+
+	changes = wpa_bss_compare_res(bss, res, same_ies);
+	if ((changes & ~WPA_BSS_SIGNAL_CHANGED_FLAG) ||
+	    abs(res->level - bss->last_change_level) >=
+	    WPA_BSS_CHANGE_LEVEL_DB) {
+		bss->last_change_idx = wpa_s->bss_update_idx;
+		bss->last_change_level = res->level;
+	}
 	bss->scan_miss_count = 0;
 	bss->last_update_idx = wpa_s->bss_update_idx;
 	wpa_bss_copy_res(bss, res, fetch_time);
-	/* Move the entry to the end of the list */
+	/* Move the entry to the end of the list and of its hash bucket */
 	dl_list_del(&bss->list);
+	dl_list_del(&bss->list_hash);
+	if (same_ies)
+		wpa_s->bss_ie_copies_skipped++;
+	else
 #ifdef CONFIG_P2P
 	if (wpa_bss_get_vendor_ie(bss, P2P_IE_VENDOR_TYPE) &&
 	    !wpa_scan_get_vendor_ie(res, P2P_IE_VENDOR_TYPE)) {
@@ -553,6 +585,8 @@ wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 		os_memcpy(bss + 1, res + 1, res->ie_len + res->beacon_ie_len);
 		bss->ie_len = res->ie_len;
 		bss->beacon_ie_len = res->beacon_ie_len;
+		bss->ie_hash = res->ie_hash;
+		wpa_s->bss_ie_copies++;
 	} else {
 		struct wpa_bss *nbss;
 		struct dl_list *prev = bss->list_id.prev;
@@ -561,7 +595,8 @@ wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 				  res->beacon_ie_len);
 		if (nbss) {
 			unsigned int i;
-			for (i = 0; i < wpa_s->last_scan_res_used; i++) {
+			for (i = 0; listed && i < wpa_s->last_scan_res_used;
+			     i++) {
 				if (wpa_s->last_scan_res[i] == bss) {
 					wpa_s->last_scan_res[i] = nbss;
 					break;
@@ -575,12 +610,16 @@ wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 				  res->ie_len + res->beacon_ie_len);
 			bss->ie_len = res->ie_len;
 			bss->beacon_ie_len = res->beacon_ie_len;
+			bss->ie_hash = res->ie_hash;
+			wpa_s->bss_ie_copies++;
 		}
 		dl_list_add(prev, &bss->list_id);
 	}
 	if (changes & WPA_BSS_IES_CHANGED_FLAG)
 		wpa_bss_set_hessid(bss);
 	dl_list_add_tail(&wpa_s->bss, &bss->list);
+	dl_list_add_tail(&wpa_s->bss_hash[WPA_BSS_HASH(bss->bssid)],
+			 &bss->list_hash);
 
 	notify_bss_changes(wpa_s, changes, bss);
 
@@ -603,6 +642,8 @@ void wpa_bss_update_start(struct wpa_supplicant *wpa_s)
 	wpa_dbg(wpa_s, MSG_DEBUG, "BSS: Start scan result update %u",
 		wpa_s->bss_update_idx);
 	wpa_s->last_scan_res_used = 0;
+	wpa_s->bss_ie_copies = 0;
+	wpa_s->bss_ie_copies_skipped = 0;
 }
 
 
@@ -674,16 +715,10 @@ void wpa_bss_update_scan_res(struct wpa_supplicant *wpa_s,
 	if (bss == NULL)
 		bss = wpa_bss_add(wpa_s, ssid + 2, ssid[1], res, fetch_time);
 	else {
+		int listed = bss->last_update_idx == wpa_s->bss_update_idx;
 		bss = wpa_bss_update(wpa_s, bss, res, fetch_time);
-		if (wpa_s->last_scan_res) {
-			unsigned int i;
-			for (i = 0; i < wpa_s->last_scan_res_used; i++) {
-				if (bss == wpa_s->last_scan_res[i]) {
-					/* Already in the list */
-					return;
-				}
-			}
-		}
+		if (listed)
+			return; /* Already in the list */
 	}
 
 	if (bss == NULL)
@@ -781,8 +816,10 @@ void wpa_bss_update_end(struct wpa_supplicant *wpa_s, struct scan_info *info,
 		}
 	}
 
-	wpa_printf(MSG_DEBUG, "BSS: last_scan_res_used=%u/%u",
-		   wpa_s->last_scan_res_used, wpa_s->last_scan_res_size);
+	wpa_printf(MSG_DEBUG, "BSS: last_scan_res_used=%u/%u ie_copies=%u "
+		   "ie_copies_skipped=%u",
+		   wpa_s->last_scan_res_used, wpa_s->last_scan_res_size,
+		   wpa_s->bss_ie_copies, wpa_s->bss_ie_copies_skipped);
 }
 
 
@@ -836,8 +873,12 @@ static void wpa_bss_timeout(void *eloop_ctx, void *timeout_ctx)
  */
 int wpa_bss_init(struct wpa_supplicant *wpa_s)
 {
+	unsigned int i;
+
 	dl_list_init(&wpa_s->bss);
 	dl_list_init(&wpa_s->bss_id);
+	for (i = 0; i < WPA_BSS_HASH_SIZE; i++)
+		dl_list_init(&wpa_s->bss_hash[i]);
 	eloop_register_timeout(WPA_BSS_EXPIRATION_PERIOD, 0,
 			       wpa_bss_timeout, wpa_s, NULL);
 	return 0;
@@ -888,7 +929,8 @@ struct wpa_bss * wpa_bss_get_bssid(struct wpa_supplicant *wpa_s,
 	struct wpa_bss *bss;
 	if (!wpa_supplicant_filter_bssid_match(wpa_s, bssid))
 		return NULL;
-	dl_list_for_each_reverse(bss, &wpa_s->bss, struct wpa_bss, list) {
+	dl_list_for_each_reverse(bss, &wpa_s->bss_hash[WPA_BSS_HASH(bssid)],
+				 struct wpa_bss, list_hash) {
 		if (os_memcmp(bss->bssid, bssid, ETH_ALEN) == 0)
 			return bss;
 	}
@@ -913,7 +955,8 @@ struct wpa_bss * wpa_bss_get_bssid_latest(struct wpa_supplicant *wpa_s,
 	struct wpa_bss *bss, *found = NULL;
 	if (!wpa_supplicant_filter_bssid_match(wpa_s, bssid))
 		return NULL;
-	dl_list_for_each_reverse(bss, &wpa_s->bss, struct wpa_bss, list) {
+	dl_list_for_each_reverse(bss, &wpa_s->bss_hash[WPA_BSS_HASH(bssid)],
+				 struct wpa_bss, list_hash) {
 		if (os_memcmp(bss->bssid, bssid, ETH_ALEN) != 0)
 			continue;
 		if (found == NULL ||
@@ -43,6 +43,9 @@ struct wpa_bss_anqp {
 #endif /* CONFIG_HS20 */
 };
 
+/* Signal level change (dB) that is reported as a change (last_change_idx) */
+#define WPA_BSS_CHANGE_LEVEL_DB 3
+
 /**
  * struct wpa_bss - BSS table
  *
@@ -54,12 +57,21 @@ struct wpa_bss {
 	struct dl_list list;
 	/** List entry for struct wpa_supplicant::bss_id */
 	struct dl_list list_id;
+	/** List entry for struct wpa_supplicant::bss_hash */
+	struct dl_list list_hash;
 	/** Unique identifier for this BSS entry */
 	unsigned int id;
 	/** Number of counts without seeing this BSS */
 	unsigned int scan_miss_count;
 	/** Index of the last scan update */
 	unsigned int last_update_idx;
+	/**
+	 * Index of the last scan update that changed this entry (other than
+	 * by a signal level change of less than WPA_BSS_CHANGE_LEVEL_DB)
+	 */
+	unsigned int last_change_idx;
+	/** Signal level at last_change_idx */
+	int last_change_level;
 	/** Information flags about the BSS/IBSS (WPA_BSS_*) */
 	unsigned int flags;
 	/** BSSID */
@@ -92,6 +104,8 @@ struct wpa_bss {
 	size_t ie_len;
 	/** Length of the following Beacon IE field in octets */
 	size_t beacon_ie_len;
+	/** Driver provided hash of the IEs (struct wpa_scan_res::ie_hash) */
+	u32 ie_hash;
 	/* followed by ie_len octets of IEs */
 	/* followed by beacon_ie_len octets of IEs */
 };
@@ -12,6 +12,7 @@
 #include "utils/uuid.h"
 #include "utils/ip_addr.h"
 #include "crypto/sha1.h"
+#include "crypto/pbkdf2_cache.h"
 #include "rsn_supp/wpa.h"
 #include "eap_peer/eap.h"
 #include "p2p/p2p.h"
@@ -2435,8 +2436,8 @@ char * wpa_config_get_no_key(struct wpa_ssid *ssid, const char *var)
 void wpa_config_update_psk(struct wpa_ssid *ssid)
 {
 #ifndef CONFIG_NO_PBKDF2
-	pbkdf2_sha1(ssid->passphrase, ssid->ssid, ssid->ssid_len, 4096,
-		    ssid->psk, PMK_LEN);
+	pbkdf2_sha1_cached(ssid->passphrase, ssid->ssid, ssid->ssid_len, 4096,
+			   ssid->psk, PMK_LEN);
 	wpa_hexdump_key(MSG_MSGDUMP, "PSK (from passphrase)",
 			ssid->psk, PMK_LEN);
 	ssid->psk_set = 1;
@@ -3284,6 +3285,9 @@ struct wpa_config * wpa_config_alloc_empty(const char *ctrl_interface,
 	config->max_num_sta = DEFAULT_MAX_NUM_STA;
 	config->access_network_type = DEFAULT_ACCESS_NETWORK_TYPE;
 	config->scan_cur_freq = DEFAULT_SCAN_CUR_FREQ;
+	config->scan_defer_max = DEFAULT_SCAN_DEFER_MAX;
+	config->scan_split_interval = DEFAULT_SCAN_SPLIT_INTERVAL;
+	config->fast_resume = DEFAULT_FAST_RESUME;
 	config->wmm_ac_params[0] = ac_be;
 	config->wmm_ac_params[1] = ac_bk;
 	config->wmm_ac_params[2] = ac_vi;
@@ -3876,6 +3880,7 @@ static const struct global_parse_data global_fields[] = {
 	{ INT(p2p_disabled), 0 },
 	{ INT(p2p_no_group_iface), 0 },
 	{ INT_RANGE(p2p_ignore_shared_freq, 0, 1), 0 },
+	{ INT_RANGE(p2p_fast_reconnect, 0, 1), 0 },
 	{ IPV4(ip_addr_go), 0 },
 	{ IPV4(ip_addr_mask), 0 },
 	{ IPV4(ip_addr_start), 0 },
@@ -3914,6 +3919,11 @@ static const struct global_parse_data global_fields[] = {
 	{ INT_RANGE(ignore_old_scan_res, 0, 1), 0 },
 	{ FUNC(freq_list), 0 },
 	{ INT(scan_cur_freq), 0 },
+	{ INT_RANGE(scan_defer_traffic, 0, 1000000), 0 },
+	{ INT_RANGE(scan_defer_max, 0, 3600), 0 },
+	{ INT_RANGE(scan_split_chan, 0, 255), 0 },
+	{ INT_RANGE(scan_split_interval, 0, 60000), 0 },
+	{ INT_RANGE(fast_resume, 0, 1), 0 },
 	{ INT(sched_scan_interval), 0 },
 	{ INT(tdls_external_control), 0},
 	{ STR(osu_dir), 0 },
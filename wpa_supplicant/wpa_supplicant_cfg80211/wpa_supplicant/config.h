@@ -26,6 +26,9 @@
 #define DEFAULT_MAX_NUM_STA 128
 #define DEFAULT_ACCESS_NETWORK_TYPE 15
 #define DEFAULT_SCAN_CUR_FREQ 0
+#define DEFAULT_SCAN_DEFER_MAX 60
+#define DEFAULT_SCAN_SPLIT_INTERVAL 500
+#define DEFAULT_FAST_RESUME 0
 #define DEFAULT_P2P_SEARCH_DELAY 500
 #define DEFAULT_RAND_ADDR_LIFETIME 60
 
@@ -699,6 +702,16 @@ struct wpa_config {
 	int p2p_ignore_shared_freq;
 	int p2p_optimize_listen_chan;
 
+	/**
+	 * p2p_fast_reconnect - Re-invoke persistent groups on P2P_CONNECT
+	 *
+	 * 0 = P2P_CONNECT always uses GO Negotiation (default)
+	 * 1 = if a persistent group with the peer is stored, P2P_CONNECT
+	 *	re-invokes it with the stored credentials on its last operating
+	 *	channel and falls back to GO Negotiation if the invitation fails
+	 */
+	int p2p_fast_reconnect;
+
 	struct wpabuf *wps_vendor_ext_m1;
 
 #define MAX_WPS_VENDOR_EXT 10
@@ -794,6 +807,50 @@ struct wpa_config {
 	 */
 	int scan_cur_freq;
 
+	/**
+	 * scan_defer_traffic - Traffic level that postpones scans
+	 *
+	 * While associated, scans which were not requested by the user are
+	 * postponed as long as at least this many packets per second are
+	 * received or sent on the interface, so that going off-channel does
+	 * not disturb streaming. 0 = disabled (default).
+	 */
+	int scan_defer_traffic;
+
+	/**
+	 * scan_defer_max - Maximum time in seconds to postpone a scan
+	 *
+	 * A scan is started even with traffic above scan_defer_traffic once it
+	 * has been postponed for this long.
+	 */
+	int scan_defer_max;
+
+	/**
+	 * scan_split_chan - Number of channels per scan burst
+	 *
+	 * While associated, a full scan which was not requested by the user is
+	 * split into bursts of this many channels. Channels on which BSSes
+	 * were seen earlier are scanned first. 0 = scan all channels at once
+	 * (default).
+	 */
+	int scan_split_chan;
+
+	/**
+	 * scan_split_interval - Time in milliseconds between scan bursts
+	 */
+	int scan_split_interval;
+
+	/**
+	 * fast_resume - Reconnect to the previous BSS after system resume
+	 *
+	 * If enabled, the BSS which was used at system suspend is searched
+	 * for first after resume with a directed probe on its channel only,
+	 * so that the connection can be re-established (with PMKSA caching
+	 * where possible) without a full scan. A full scan follows if this
+	 * does not lead to a connection.
+	 */
+	int fast_resume;
+
 	/**
 	 * changed_parameters - Bitmap of changed parameters since last update
 	 */
@@ -1058,6 +1058,9 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 	if (config->p2p_ignore_shared_freq)
 		fprintf(f, "p2p_ignore_shared_freq=%u\n",
 			config->p2p_ignore_shared_freq);
+	if (config->p2p_fast_reconnect)
+		fprintf(f, "p2p_fast_reconnect=%u\n",
+			config->p2p_fast_reconnect);
 #endif /* CONFIG_P2P */
 	if (config->country[0] && config->country[1]) {
 		fprintf(f, "country=%c%c\n",
@@ -1158,6 +1161,18 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 	}
 	if (config->scan_cur_freq != DEFAULT_SCAN_CUR_FREQ)
 		fprintf(f, "scan_cur_freq=%d\n", config->scan_cur_freq);
+	if (config->scan_defer_traffic)
+		fprintf(f, "scan_defer_traffic=%d\n",
+			config->scan_defer_traffic);
+	if (config->scan_defer_max != DEFAULT_SCAN_DEFER_MAX)
+		fprintf(f, "scan_defer_max=%d\n", config->scan_defer_max);
+	if (config->scan_split_chan)
+		fprintf(f, "scan_split_chan=%d\n", config->scan_split_chan);
+	if (config->scan_split_interval != DEFAULT_SCAN_SPLIT_INTERVAL)
+		fprintf(f, "scan_split_interval=%d\n",
+			config->scan_split_interval);
+	if (config->fast_resume != DEFAULT_FAST_RESUME)
+		fprintf(f, "fast_resume=%d\n", config->fast_resume);
 
 	if (config->sched_scan_interval)
 		fprintf(f, "sched_scan_interval=%u\n",
@@ -488,6 +488,15 @@ struct wpa_ssid {
 	 */
 	int p2p_persistent_group;
 
+	/**
+	 * p2p_last_oper_freq - Last operating frequency of a persistent group
+	 *
+	 * This is maintained only in memory (i.e., it is not written into the
+	 * configuration file) and used as the preferred channel when the
+	 * group is re-invoked with p2p_fast_reconnect=1.
+	 */
+	int p2p_last_oper_freq;
+
 	/**
 	 * temporary - Whether this network is temporary and not to be saved
 	 */
@@ -39,6 +39,7 @@
 #include "interworking.h"
 #include "blacklist.h"
 #include "autoscan.h"
+#include "bgscan.h"
 #include "wnm_sta.h"
 #include "offchannel.h"
 #include "drivers/driver.h"
@@ -2465,6 +2466,157 @@ static int wpa_supplicant_ctrl_iface_scan_results(
 }
 
 
+static u16 wpa_supplicant_bss_bin_akm(const u8 *ie)
+{
+	struct wpa_ie_data data;
+	u16 flags = 0;
+
+	if (wpa_parse_wpa_ie(ie, 2 + ie[1], &data) < 0)
+		return 0;
+	if (wpa_key_mgmt_wpa_psk(data.key_mgmt) ||
+	    wpa_key_mgmt_sae(data.key_mgmt))
+		flags |= WPA_SCAN_BIN_PSK;
+	if (wpa_key_mgmt_wpa_ieee8021x(data.key_mgmt))
+		flags |= WPA_SCAN_BIN_EAP;
+	return flags;
+}
+
+
+/* Binary counterpart of wpa_supplicant_ctrl_iface_scan_result() flags. */
+static u16 wpa_supplicant_bss_bin_flags(const struct wpa_bss *bss)
+{
+	const u8 *ie;
+	u16 flags = 0;
+#ifdef CONFIG_WPS
+	struct wpabuf *wps_ie;
+#endif /* CONFIG_WPS */
+
+	ie = wpa_bss_get_vendor_ie(bss, WPA_IE_VENDOR_TYPE);
+	if (ie)
+		flags |= WPA_SCAN_BIN_WPA | wpa_supplicant_bss_bin_akm(ie);
+	ie = wpa_bss_get_ie(bss, WLAN_EID_RSN);
+	if (ie) {
+		flags |= WPA_SCAN_BIN_RSN | wpa_supplicant_bss_bin_akm(ie);
+#ifdef CONFIG_HS20
+		if (wpa_bss_get_vendor_ie(bss, HS20_IE_VENDOR_TYPE))
+			flags |= WPA_SCAN_BIN_HS20;
+#endif /* CONFIG_HS20 */
+	}
+	if (!(flags & (WPA_SCAN_BIN_WPA | WPA_SCAN_BIN_RSN)) &&
+	    (bss->caps & IEEE80211_CAP_PRIVACY))
+		flags |= WPA_SCAN_BIN_WEP;
+#ifdef CONFIG_WPS
+	wps_ie = wpa_bss_get_vendor_ie_multi(bss, WPS_IE_VENDOR_TYPE);
+	if (wps_ie) {
+		flags |= WPA_SCAN_BIN_WPS;
+		if (wps_is_selected_pbc_registrar(wps_ie))
+			flags |= WPA_SCAN_BIN_WPS_PBC;
+		wpabuf_free(wps_ie);
+	}
+#endif /* CONFIG_WPS */
+	if (!bss_is_dmg(bss)) {
+		if (bss->caps & IEEE80211_CAP_ESS)
+			flags |= WPA_SCAN_BIN_ESS;
+		if (bss->caps & IEEE80211_CAP_IBSS)
+			flags |= WPA_SCAN_BIN_IBSS;
+	}
+	if (wpa_bss_get_vendor_ie(bss, P2P_IE_VENDOR_TYPE) ||
+	    wpa_bss_get_vendor_ie_beacon(bss, P2P_IE_VENDOR_TYPE))
+		flags |= WPA_SCAN_BIN_P2P;
+
+	return flags;
+}
+
+
+static int wpa_supplicant_bss_bin_listed(const struct wpa_bss *bss)
+{
+	/* Same P2P listen discovery result filter as in SCAN_RESULTS */
+	return !(bss->ssid_len == P2P_WILDCARD_SSID_LEN &&
+		 os_memcmp(bss->ssid, P2P_WILDCARD_SSID,
+			   P2P_WILDCARD_SSID_LEN) == 0 &&
+		 (wpa_bss_get_vendor_ie(bss, P2P_IE_VENDOR_TYPE) ||
+		  wpa_bss_get_vendor_ie_beacon(bss, P2P_IE_VENDOR_TYPE)));
+}
+
+
+/*
+ * SCAN_RESULTS_BIN [since=<update>] [first=<id>] - see WPA_SCAN_BIN_MAGIC in
+ * wpa_ctrl.h for the response format.
+ */
+static int wpa_supplicant_ctrl_iface_scan_results_bin(
+	struct wpa_supplicant *wpa_s, const char *cmd, char *buf,
+	size_t buflen)
+{
+	u8 *pos, *end, *hdr;
+	struct wpa_bss *bss;
+	struct os_reltime now, age;
+	unsigned int since = 0, first = 0, num_ids = 0, num_entries = 0;
+	unsigned int next_id = 0;
+	const char *param;
+
+	param = os_strstr(cmd, "since=");
+	if (param)
+		since = strtoul(param + 6, NULL, 10);
+	param = os_strstr(cmd, "first=");
+	if (param)
+		first = strtoul(param + 6, NULL, 10);
+
+	if (buflen < WPA_SCAN_BIN_HDR_LEN)
+		return -1;
+	hdr = (u8 *) buf;
+	pos = hdr + WPA_SCAN_BIN_HDR_LEN;
+	end = hdr + buflen;
+
+	/*
+	 * The id list lets the client drop the entries that were removed
+	 * since its previous snapshot without any tombstones being kept here.
+	 */
+	if (first == 0) {
+		dl_list_for_each(bss, &wpa_s->bss_id, struct wpa_bss, list_id) {
+			if (!wpa_supplicant_bss_bin_listed(bss))
+				continue;
+			if (end - pos < 4)
+				return -1;
+			WPA_PUT_LE32(pos, bss->id);
+			pos += 4;
+			num_ids++;
+		}
+	}
+
+	os_get_reltime(&now);
+	dl_list_for_each(bss, &wpa_s->bss_id, struct wpa_bss, list_id) {
+		if (bss->id < first || bss->last_change_idx <= since ||
+		    !wpa_supplicant_bss_bin_listed(bss))
+			continue;
+		if ((size_t) (end - pos) < WPA_SCAN_BIN_ENTRY_LEN +
+		    bss->ssid_len || num_entries == 0xffff) {
+			next_id = bss->id;
+			break;
+		}
+		os_reltime_sub(&now, &bss->last_update, &age);
+		WPA_PUT_LE32(pos, bss->id);
+		os_memcpy(pos + 4, bss->bssid, ETH_ALEN);
+		WPA_PUT_LE16(pos + 10, bss->freq);
+		WPA_PUT_LE16(pos + 12, (u16) bss->level);
+		WPA_PUT_LE16(pos + 14, wpa_supplicant_bss_bin_flags(bss));
+		WPA_PUT_LE32(pos + 16, age.sec * 1000 + age.usec / 1000);
+		pos[20] = bss->ssid_len;
+		os_memcpy(pos + WPA_SCAN_BIN_ENTRY_LEN, bss->ssid,
+			  bss->ssid_len);
+		pos += WPA_SCAN_BIN_ENTRY_LEN + bss->ssid_len;
+		num_entries++;
+	}
+
+	os_memcpy(hdr, WPA_SCAN_BIN_MAGIC, 4);
+	WPA_PUT_LE32(hdr + 4, wpa_s->bss_update_idx);
+	WPA_PUT_LE16(hdr + 8, num_ids);
+	WPA_PUT_LE16(hdr + 10, num_entries);
+	WPA_PUT_LE32(hdr + 12, next_id);
+
+	return pos - hdr;
+}
+
+
 static int wpa_supplicant_ctrl_iface_select_network(
 	struct wpa_supplicant *wpa_s, char *cmd)
 {
@@ -6194,6 +6346,36 @@ static int wpa_supplicant_pktcnt_poll(struct wpa_supplicant *wpa_s, char *buf,
 }
 
 
+static int wpa_supplicant_scan_stats(struct wpa_supplicant *wpa_s, char *buf,
+				     size_t buflen)
+{
+	struct os_reltime now, diff;
+	unsigned int busy, total, duty;
+	int ret;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, &wpa_s->scan_stats_start, &diff);
+	total = diff.sec * 1000 + diff.usec / 1000;
+	busy = wpa_s->scan_busy_ms;
+	if (wpa_s->scanning &&
+	    os_reltime_initialized(&wpa_s->scan_busy_start)) {
+		os_reltime_sub(&now, &wpa_s->scan_busy_start, &diff);
+		busy += diff.sec * 1000 + diff.usec / 1000;
+	}
+	/* in 1/100 of percent */
+	duty = total ? (unsigned int) ((u64) busy * 10000 / total) : 0;
+
+	ret = os_snprintf(buf, buflen, "SCAN_TIME=%u\nTOTAL_TIME=%u\n"
+			  "DUTY_CYCLE=%u.%02u\nSCAN_BURSTS=%u\n"
+			  "SCAN_DEFERRALS=%u\n",
+			  busy, total, duty / 100, duty % 100,
+			  wpa_s->scan_split_bursts, wpa_s->scan_deferrals);
+	if (ret < 0 || (size_t) ret > buflen)
+		return -1;
+	return ret;
+}
+
+
 #if defined(ANDROID) || defined(PRIVATE_CMD)
 static int wpa_supplicant_driver_cmd(struct wpa_supplicant *wpa_s, char *cmd,
 				     char *buf, size_t buflen)
@@ -7539,6 +7721,10 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strcmp(buf, "SCAN_RESULTS") == 0) {
 		reply_len = wpa_supplicant_ctrl_iface_scan_results(
 			wpa_s, reply, reply_size);
+	} else if (os_strcmp(buf, "SCAN_RESULTS_BIN") == 0 ||
+		   os_strncmp(buf, "SCAN_RESULTS_BIN ", 17) == 0) {
+		reply_len = wpa_supplicant_ctrl_iface_scan_results_bin(
+			wpa_s, buf + 16, reply, reply_size);
 	} else if (os_strncmp(buf, "SELECT_NETWORK ", 15) == 0) {
 		if (wpa_supplicant_ctrl_iface_select_network(wpa_s, buf + 15))
 			reply_len = -1;
@@ -7673,6 +7859,14 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "PKTCNT_POLL", 11) == 0) {
 		reply_len = wpa_supplicant_pktcnt_poll(wpa_s, reply,
 						       reply_size);
+	} else if (os_strcmp(buf, "SCAN_STATS") == 0) {
+		reply_len = wpa_supplicant_scan_stats(wpa_s, reply,
+						      reply_size);
+	} else if (os_strcmp(buf, "BGSCAN_STATUS") == 0) {
+		reply_len = bgscan_get_status(wpa_s, reply, reply_size);
+	} else if (os_strcmp(buf, "BGSCAN_TRIGGER") == 0) {
+		if (bgscan_trigger(wpa_s))
+			reply_len = -1;
 #ifdef CONFIG_AUTOSCAN
 	} else if (os_strncmp(buf, "AUTOSCAN ", 9) == 0) {
 		if (wpa_supplicant_ctrl_iface_autoscan(wpa_s, buf + 9))
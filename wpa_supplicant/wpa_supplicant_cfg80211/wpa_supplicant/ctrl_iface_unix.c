@@ -40,8 +40,20 @@ struct wpa_ctrl_dst {
 	socklen_t addrlen;
 	int debug_level;
 	int errors;
+	/*
+	 * Events are coalesced for batch_ms milliseconds (ATTACH batch=<ms>)
+	 * into a single datagram of newline separated messages in batch.
+	 */
+	unsigned int batch_ms;
+	struct wpabuf *batch;
+	struct ctrl_iface_priv *batch_priv;
+	struct ctrl_iface_global_priv *batch_gp;
 };
 
+/* Keep coalesced events within the common 4096 octet receive buffer */
+#define CTRL_IFACE_BATCH_MAX 4000
+#define CTRL_IFACE_BATCH_MAX_MS 10000
+
 
 struct ctrl_iface_priv {
 	struct wpa_supplicant *wpa_s;
@@ -68,14 +80,38 @@ static int wpas_ctrl_iface_reinit(struct wpa_supplicant *wpa_s,
 				  struct ctrl_iface_priv *priv);
 static int wpas_ctrl_iface_global_reinit(struct wpa_global *global,
 					 struct ctrl_iface_global_priv *priv);
+static void wpa_supplicant_ctrl_iface_batch_timeout(void *eloop_ctx,
+						    void *timeout_ctx);
+static int wpa_supplicant_ctrl_iface_batch_flush(struct wpa_ctrl_dst *dst);
+
+
+static void wpa_ctrl_dst_free(struct wpa_ctrl_dst *dst)
+{
+	eloop_cancel_timeout(wpa_supplicant_ctrl_iface_batch_timeout, dst,
+			     ELOOP_ALL_CTX);
+	wpabuf_free(dst->batch);
+	os_free(dst);
+}
 
 
 static int wpa_supplicant_ctrl_iface_attach(struct dl_list *ctrl_dst,
 					    struct sockaddr_un *from,
-					    socklen_t fromlen)
+					    socklen_t fromlen,
+					    const char *params)
 {
 	struct wpa_ctrl_dst *dst;
 	char addr_txt[200];
+	const char *pos;
+	unsigned int batch_ms = 0;
+
+	if (params) {
+		pos = os_strstr(params, "batch=");
+		if (pos) {
+			batch_ms = atoi(pos + 6);
+			if (batch_ms > CTRL_IFACE_BATCH_MAX_MS)
+				return -1;
+		}
+	}
 
 	dst = os_zalloc(sizeof(*dst));
 	if (dst == NULL)
@@ -83,11 +119,13 @@ static int wpa_supplicant_ctrl_iface_attach(struct dl_list *ctrl_dst,
 	os_memcpy(&dst->addr, from, sizeof(struct sockaddr_un));
 	dst->addrlen = fromlen;
 	dst->debug_level = MSG_INFO;
+	dst->batch_ms = batch_ms;
 	dl_list_add(ctrl_dst, &dst->list);
 	printf_encode(addr_txt, sizeof(addr_txt),
 		      (u8 *) from->sun_path,
 		      fromlen - offsetof(struct sockaddr_un, sun_path));
-	wpa_printf(MSG_DEBUG, "CTRL_IFACE monitor attached %s", addr_txt);
+	wpa_printf(MSG_DEBUG, "CTRL_IFACE monitor attached %s (batch=%u ms)",
+		   addr_txt, batch_ms);
 	return 0;
 }
 
@@ -111,7 +149,7 @@ static int wpa_supplicant_ctrl_iface_detach(struct dl_list *ctrl_dst,
 			wpa_printf(MSG_DEBUG, "CTRL_IFACE monitor detached %s",
 				   addr_txt);
 			dl_list_del(&dst->list);
-			os_free(dst);
+			wpa_ctrl_dst_free(dst);
 			return 0;
 		}
 	}
@@ -170,9 +208,10 @@ static void wpa_supplicant_ctrl_iface_receive(int sock, void *eloop_ctx,
 	}
 	buf[res] = '\0';
 
-	if (os_strcmp(buf, "ATTACH") == 0) {
+	if (os_strcmp(buf, "ATTACH") == 0 ||
+	    os_strncmp(buf, "ATTACH ", 7) == 0) {
 		if (wpa_supplicant_ctrl_iface_attach(&priv->ctrl_dst, &from,
-						     fromlen))
+						     fromlen, buf + 6))
 			reply_len = 1;
 		else {
 			new_attached = 1;
@@ -573,6 +612,9 @@ void wpa_supplicant_ctrl_iface_deinit(struct ctrl_iface_priv *priv)
 	if (priv->sock > -1) {
 		char *fname;
 		char *buf, *dir = NULL;
+		dl_list_for_each_safe(dst, prev, &priv->ctrl_dst,
+				      struct wpa_ctrl_dst, list)
+			wpa_supplicant_ctrl_iface_batch_flush(dst);
 		eloop_unregister_read_sock(priv->sock);
 		if (!dl_list_empty(&priv->ctrl_dst)) {
 			/*
@@ -623,11 +665,113 @@ void wpa_supplicant_ctrl_iface_deinit(struct ctrl_iface_priv *priv)
 free_dst:
 	dl_list_for_each_safe(dst, prev, &priv->ctrl_dst, struct wpa_ctrl_dst,
 			      list)
-		os_free(dst);
+		wpa_ctrl_dst_free(dst);
 	os_free(priv);
 }
 
 
+/* Returns -1 if the monitor was detached (and dst freed), 0 otherwise */
+static int wpa_supplicant_ctrl_iface_batch_flush(struct wpa_ctrl_dst *dst)
+{
+	struct dl_list *ctrl_dst;
+	int sock, _errno;
+	char addr_txt[200];
+
+	eloop_cancel_timeout(wpa_supplicant_ctrl_iface_batch_timeout, dst,
+			     ELOOP_ALL_CTX);
+	if (dst->batch == NULL || wpabuf_len(dst->batch) == 0)
+		return 0;
+
+	if (dst->batch_priv) {
+		sock = dst->batch_priv->sock;
+		ctrl_dst = &dst->batch_priv->ctrl_dst;
+	} else {
+		sock = dst->batch_gp->sock;
+		ctrl_dst = &dst->batch_gp->ctrl_dst;
+	}
+
+	printf_encode(addr_txt, sizeof(addr_txt),
+		      (u8 *) dst->addr.sun_path, dst->addrlen -
+		      offsetof(struct sockaddr_un, sun_path));
+	if (sock >= 0 &&
+	    sendto(sock, wpabuf_head(dst->batch), wpabuf_len(dst->batch),
+		   MSG_DONTWAIT, (struct sockaddr *) &dst->addr,
+		   dst->addrlen) >= 0) {
+		wpa_printf(MSG_DEBUG, "CTRL_IFACE monitor sent %u octets of coalesced events to %s",
+			   (unsigned int) wpabuf_len(dst->batch), addr_txt);
+		dst->errors = 0;
+		dst->batch->used = 0;
+		return 0;
+	}
+
+	_errno = errno;
+	wpa_printf(MSG_DEBUG, "CTRL_IFACE monitor[%s]: %d - %s",
+		   addr_txt, _errno, strerror(_errno));
+	dst->batch->used = 0;
+	dst->errors++;
+	if (dst->errors > 10 || _errno == ENOENT || _errno == EPERM) {
+		wpa_printf(MSG_INFO, "CTRL_IFACE: Detach monitor %s that cannot receive messages",
+			   addr_txt);
+		wpa_supplicant_ctrl_iface_detach(ctrl_dst, &dst->addr,
+						 dst->addrlen);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+static void wpa_supplicant_ctrl_iface_batch_timeout(void *eloop_ctx,
+						    void *timeout_ctx)
+{
+	wpa_supplicant_ctrl_iface_batch_flush(eloop_ctx);
+}
+
+
+/*
+ * Append a message to the pending coalesced events of a monitor. Returns 0 if
+ * the message was queued (or the monitor was detached) or -1 if it needs to
+ * be sent on its own (any previously queued events have been sent at that
+ * point).
+ */
+static int wpa_supplicant_ctrl_iface_batch(struct wpa_ctrl_dst *dst,
+					   const struct iovec *io, int iovcnt,
+					   struct ctrl_iface_priv *priv,
+					   struct ctrl_iface_global_priv *gp)
+{
+	size_t len = 0;
+	int i;
+
+	for (i = 0; i < iovcnt; i++)
+		len += io[i].iov_len;
+
+	if (dst->batch &&
+	    wpabuf_len(dst->batch) + len + 1 > CTRL_IFACE_BATCH_MAX &&
+	    wpa_supplicant_ctrl_iface_batch_flush(dst) < 0)
+		return 0;
+	if (len + 1 > CTRL_IFACE_BATCH_MAX)
+		return -1;
+	if (dst->batch == NULL) {
+		dst->batch = wpabuf_alloc(CTRL_IFACE_BATCH_MAX);
+		if (dst->batch == NULL)
+			return -1;
+	}
+
+	if (wpabuf_len(dst->batch) == 0)
+		eloop_register_timeout(dst->batch_ms / 1000,
+				       (dst->batch_ms % 1000) * 1000,
+				       wpa_supplicant_ctrl_iface_batch_timeout,
+				       dst, NULL);
+	dst->batch_priv = priv;
+	dst->batch_gp = gp;
+	for (i = 0; i < iovcnt; i++)
+		wpabuf_put_data(dst->batch, io[i].iov_base, io[i].iov_len);
+	wpabuf_put_u8(dst->batch, '\n');
+
+	return 0;
+}
+
+
 /**
  * wpa_supplicant_ctrl_iface_send - Send a control interface packet to monitors
  * @ifname: Interface name for global control socket or %NULL
@@ -688,6 +832,10 @@ static void wpa_supplicant_ctrl_iface_send(struct wpa_supplicant *wpa_s,
 		if (level < dst->debug_level)
 			continue;
 
+		if (dst->batch_ms &&
+		    wpa_supplicant_ctrl_iface_batch(dst, io, idx, priv, gp) == 0)
+			continue;
+
 		printf_encode(addr_txt, sizeof(addr_txt),
 			      (u8 *) dst->addr.sun_path, dst->addrlen -
 			      offsetof(struct sockaddr_un, sun_path));
@@ -761,7 +909,8 @@ void wpa_supplicant_ctrl_iface_wait(struct ctrl_iface_priv *priv)
 		if (os_strcmp(buf, "ATTACH") == 0) {
 			/* handle ATTACH signal of first monitor interface */
 			if (!wpa_supplicant_ctrl_iface_attach(&priv->ctrl_dst,
-							      &from, fromlen)) {
+							      &from, fromlen,
+							      NULL)) {
 				if (sendto(priv->sock, "OK\n", 3, 0,
 					   (struct sockaddr *) &from, fromlen) <
 				    0) {
@@ -814,9 +963,10 @@ static void wpa_supplicant_global_ctrl_iface_receive(int sock, void *eloop_ctx,
 	}
 	buf[res] = '\0';
 
-	if (os_strcmp(buf, "ATTACH") == 0) {
+	if (os_strcmp(buf, "ATTACH") == 0 ||
+	    os_strncmp(buf, "ATTACH ", 7) == 0) {
 		if (wpa_supplicant_ctrl_iface_attach(&priv->ctrl_dst, &from,
-						     fromlen))
+						     fromlen, buf + 6))
 			reply_len = 1;
 		else
 			reply_len = 2;
@@ -1080,6 +1230,9 @@ wpa_supplicant_global_ctrl_iface_deinit(struct ctrl_iface_global_priv *priv)
 	struct wpa_ctrl_dst *dst, *prev;
 
 	if (priv->sock >= 0) {
+		dl_list_for_each_safe(dst, prev, &priv->ctrl_dst,
+				      struct wpa_ctrl_dst, list)
+			wpa_supplicant_ctrl_iface_batch_flush(dst);
 		eloop_unregister_read_sock(priv->sock);
 		close(priv->sock);
 	}
@@ -1087,6 +1240,6 @@ wpa_supplicant_global_ctrl_iface_deinit(struct ctrl_iface_global_priv *priv)
 		unlink(priv->global->params.ctrl_interface);
 	dl_list_for_each_safe(dst, prev, &priv->ctrl_dst, struct wpa_ctrl_dst,
 			      list)
-		os_free(dst);
+		wpa_ctrl_dst_free(dst);
 	os_free(priv);
 }
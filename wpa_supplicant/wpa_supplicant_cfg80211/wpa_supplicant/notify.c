@@ -387,8 +387,10 @@ void wpas_notify_suspend(struct wpa_global *global)
 
 	os_get_time(&global->suspend_time);
 	wpa_printf(MSG_DEBUG, "System suspend notification");
-	for (wpa_s = global->ifaces; wpa_s; wpa_s = wpa_s->next)
+	for (wpa_s = global->ifaces; wpa_s; wpa_s = wpa_s->next) {
+		wpas_resume_save(wpa_s);
 		wpa_drv_suspend(wpa_s);
+	}
 }
 
 
@@ -408,6 +410,7 @@ void wpas_notify_resume(struct wpa_global *global)
 		   slept);
 
 	for (wpa_s = global->ifaces; wpa_s; wpa_s = wpa_s->next) {
+		wpas_resume_start(wpa_s);
 		wpa_drv_resume(wpa_s);
 		if (wpa_s->wpa_state == WPA_DISCONNECTED)
 			wpa_supplicant_req_scan(wpa_s, 0, 100000);
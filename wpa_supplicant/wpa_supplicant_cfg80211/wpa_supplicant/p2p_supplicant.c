@@ -667,7 +667,7 @@ static int wpas_p2p_persistent_group(struct wpa_supplicant *wpa_s,
 
 static int wpas_p2p_store_persistent_group(struct wpa_supplicant *wpa_s,
 					   struct wpa_ssid *ssid,
-					   const u8 *go_dev_addr)
+					   const u8 *go_dev_addr, int freq)
 {
 	struct wpa_ssid *s;
 	int changed = 0;
@@ -721,6 +721,8 @@ static int wpas_p2p_store_persistent_group(struct wpa_supplicant *wpa_s,
 	s->proto = WPA_PROTO_RSN;
 	s->pairwise_cipher = WPA_CIPHER_CCMP;
 	s->export_keys = 1;
+	if (freq > 0)
+		s->p2p_last_oper_freq = freq;
 	if (ssid->passphrase) {
 		os_free(s->passphrase);
 		s->passphrase = os_strdup(ssid->passphrase);
@@ -822,6 +824,37 @@ static void wpas_p2p_add_persistent_group_client(struct wpa_supplicant *wpa_s,
 }
 
 
+static void wpas_p2p_formation_timing(struct wpa_supplicant *wpa_s,
+				      const char *phase)
+{
+	struct wpa_global *global = wpa_s->global;
+	struct os_reltime age;
+
+	if (!os_reltime_initialized(&global->p2p_formation_start))
+		return; /* not measuring this group formation */
+
+	os_reltime_age(&global->p2p_formation_start, &age);
+	wpa_msg_global(wpa_s->parent, MSG_INFO, P2P_EVENT_FORMATION_TIMING
+		       "phase=%s path=%s elapsed_ms=%ld", phase,
+		       global->p2p_formation_path,
+		       (long) (age.sec * 1000 + age.usec / 1000));
+
+	if (os_strcmp(phase, "group-started") == 0 ||
+	    os_strcmp(phase, "failed") == 0)
+		os_memset(&global->p2p_formation_start, 0,
+			  sizeof(global->p2p_formation_start));
+}
+
+
+static void wpas_p2p_formation_timing_start(struct wpa_supplicant *wpa_s,
+					    const char *path)
+{
+	os_get_reltime(&wpa_s->global->p2p_formation_start);
+	wpa_s->global->p2p_formation_path = path;
+	wpas_p2p_formation_timing(wpa_s, "start");
+}
+
+
 static void wpas_p2p_group_started(struct wpa_supplicant *wpa_s,
 				   int go, struct wpa_ssid *ssid, int freq,
 				   const u8 *psk, const char *passphrase,
@@ -869,6 +902,7 @@ static void wpas_p2p_group_started(struct wpa_supplicant *wpa_s,
 			    passphrase ? "\"" : "",
 			    MAC2STR(go_dev_addr),
 			    persistent ? " [PERSISTENT]" : "", extra);
+	wpas_p2p_formation_timing(wpa_s, "group-started");
 }
 
 
@@ -897,6 +931,7 @@ static void wpas_group_formation_completed(struct wpa_supplicant *wpa_s,
 	if (!success) {
 		wpa_msg_global(wpa_s->parent, MSG_INFO,
 			       P2P_EVENT_GROUP_FORMATION_FAILURE);
+		wpas_p2p_formation_timing(wpa_s, "failed");
 		wpas_p2p_group_delete(wpa_s,
 				      P2P_GROUP_REMOVAL_FORMATION_FAILED);
 		return;
@@ -950,8 +985,9 @@ static void wpas_group_formation_completed(struct wpa_supplicant *wpa_s,
 	}
 
 	if (persistent)
-		network_id = wpas_p2p_store_persistent_group(wpa_s->parent,
-							     ssid, go_dev_addr);
+		network_id = wpas_p2p_store_persistent_group(
+			wpa_s->parent, ssid, go_dev_addr,
+			ssid ? ssid->frequency : 0);
 	else {
 		os_free(wpa_s->global->add_psk);
 		wpa_s->global->add_psk = NULL;
@@ -1273,7 +1309,7 @@ static void p2p_go_configured(void *ctx, void *data)
 		if (params->persistent_group) {
 			network_id = wpas_p2p_store_persistent_group(
 				wpa_s->parent, ssid,
-				wpa_s->global->p2p_dev_addr);
+				wpa_s->global->p2p_dev_addr, ssid->frequency);
 			wpas_p2p_add_psk_list(wpa_s, ssid);
 		}
 		if (network_id < 0)
@@ -1640,11 +1676,16 @@ static void wpas_go_neg_completed(void *ctx, struct p2p_go_neg_results *res)
 		wpa_msg_global(wpa_s, MSG_INFO,
 			       P2P_EVENT_GO_NEG_FAILURE "status=%d",
 			       res->status);
+		wpas_p2p_formation_timing(wpa_s, "failed");
 		wpas_notify_p2p_go_neg_completed(wpa_s, res);
 		wpas_p2p_remove_pending_group_interface(wpa_s);
 		return;
 	}
 
+	if (!os_reltime_initialized(&wpa_s->global->p2p_formation_start))
+		wpas_p2p_formation_timing_start(wpa_s, "peer");
+	wpas_p2p_formation_timing(wpa_s, "go-neg-done");
+
 	if (wpa_s->p2p_go_ht40)
 		res->ht40 = 1;
 	if (wpa_s->p2p_go_vht)
@@ -3017,6 +3058,7 @@ static void wpas_prov_disc_resp(void *ctx, const u8 *peer, u16 config_methods)
 		wpa_s->pending_pd_before_join = 0;
 		wpa_printf(MSG_DEBUG, "P2P: Starting pending "
 			   "join-existing-group operation");
+		wpas_p2p_formation_timing(wpa_s, "pd-done");
 		wpas_p2p_join_start(wpa_s, 0, NULL, 0);
 		return;
 	}
@@ -3296,6 +3338,9 @@ static void wpas_invitation_received(void *ctx, const u8 *sa, const u8 *bssid,
 			       MAC2STR(sa),  op_freq);	
 #endif
 			   
+		if (!os_reltime_initialized(&wpa_s->global->p2p_formation_start))
+			wpas_p2p_formation_timing_start(wpa_s, "peer");
+		wpas_p2p_formation_timing(wpa_s, "invitation-done");
 		if (s) {
 			int go = s->mode == WPAS_MODE_P2P_GO;
 			wpas_p2p_group_add_persistent(
@@ -3447,9 +3492,38 @@ static void wpas_invitation_result(void *ctx, int status, const u8 *bssid,
 			wpas_remove_persistent_peer(wpa_s, ssid, peer, 1);
 		}
 		wpas_p2p_remove_pending_group_interface(wpa_s);
+		if (wpa_s->p2p_fast_reconnect &&
+		    status != P2P_SC_FAIL_INFO_CURRENTLY_UNAVAILABLE) {
+			/*
+			 * The group was re-invoked from P2P_CONNECT, so
+			 * complete the request with GO Negotiation.
+			 */
+			wpa_printf(MSG_DEBUG, "P2P: Fast reconnect failed - "
+				   "fall back to GO Negotiation");
+			wpa_s->p2p_fast_reconnect = 0;
+			wpas_p2p_formation_timing(wpa_s, "invitation-failed");
+			wpa_s->p2p_fast_reconnect_fallback = 1;
+			wpas_p2p_connect(wpa_s, peer, wpa_s->p2p_pin,
+					 wpa_s->p2p_wps_method,
+					 wpa_s->p2p_persistent_group, 0, 0, 0,
+					 wpa_s->p2p_go_intent,
+					 wpa_s->p2p_connect_freq,
+					 wpa_s->p2p_persistent_id,
+					 wpa_s->p2p_pd_before_go_neg,
+					 wpa_s->p2p_go_ht40,
+					 wpa_s->p2p_go_vht);
+			wpa_s->p2p_fast_reconnect_fallback = 0;
+			return;
+		}
+		wpa_s->p2p_fast_reconnect = 0;
+		if (status != P2P_SC_FAIL_INFO_CURRENTLY_UNAVAILABLE)
+			wpas_p2p_formation_timing(wpa_s, "failed");
 		return;
 	}
 
+	wpa_s->p2p_fast_reconnect = 0;
+	wpas_p2p_formation_timing(wpa_s, "invitation-done");
+
 	ssid = wpa_config_get_network(wpa_s->conf,
 				      wpa_s->pending_invite_ssid_id);
 	if (ssid == NULL) {
@@ -4756,6 +4830,35 @@ static int wpas_p2p_join(struct wpa_supplicant *wpa_s, const u8 *iface_addr,
 	wpas_p2p_stop_find(wpa_s);
 
 	wpa_s->p2p_join_scan_count = 0;
+
+	if (wpa_s->conf->p2p_fast_reconnect) {
+		struct wpa_bss *bss;
+		struct os_reltime now;
+
+		if (ssid && ssid_len)
+			bss = wpa_bss_get(wpa_s, iface_addr, ssid, ssid_len);
+		else
+			bss = wpa_bss_get_bssid_latest(wpa_s, iface_addr);
+		os_get_reltime(&now);
+		if (bss && !os_reltime_expired(&now, &bss->last_update, 1)) {
+			/*
+			 * The GO was seen within the last second, so there is
+			 * no need to wait for another scan before Provision
+			 * Discovery.
+			 */
+			wpa_printf(MSG_DEBUG, "P2P: Fresh BSS entry for the "
+				   "target GO at %d MHz - skip join scan",
+				   bss->freq);
+			if (ssid && ssid_len) {
+				os_memcpy(wpa_s->p2p_join_ssid, ssid, ssid_len);
+				wpa_s->p2p_join_ssid_len = ssid_len;
+			} else
+				wpa_s->p2p_join_ssid_len = 0;
+			wpas_p2p_scan_res_join(wpa_s, NULL);
+			return 0;
+		}
+	}
+
 	wpas_p2p_join_scan_req(wpa_s, op_freq, ssid, ssid_len);
 	return 0;
 }
@@ -5035,6 +5138,37 @@ int wpas_p2p_connect(struct wpa_supplicant *wpa_s, const u8 *peer_addr,
 	} else
 		wpa_s->p2p_pin[0] = '\0';
 
+	if (!join && !auth && !auto_join && persistent_group &&
+	    wpa_s->conf->p2p_fast_reconnect &&
+	    !wpa_s->p2p_fast_reconnect_fallback) {
+		struct wpa_ssid *s;
+
+		s = wpas_p2p_get_persistent(wpa_s, peer_addr, NULL, 0);
+		if (s && (persistent_id < 0 || s->id == persistent_id)) {
+			wpa_printf(MSG_DEBUG, "P2P: Fast reconnect - re-invoke "
+				   "persistent group %d with " MACSTR
+				   " (last operating frequency %d MHz)",
+				   s->id, MAC2STR(peer_addr),
+				   s->p2p_last_oper_freq);
+			wpas_p2p_formation_timing_start(wpa_s, "reinvoke");
+			wpa_s->p2p_fast_reconnect = 1;
+			res = wpas_p2p_invite(wpa_s, peer_addr, s, NULL, freq,
+					      ht40, vht,
+					      freq ? 0 : s->p2p_last_oper_freq);
+			if (res == 0)
+				return ret;
+			wpa_s->p2p_fast_reconnect = 0;
+			wpas_p2p_remove_pending_group_interface(wpa_s);
+			wpa_printf(MSG_DEBUG, "P2P: Could not re-invoke the "
+				   "persistent group (%d) - use GO Negotiation",
+				   res);
+		}
+	}
+
+	if (!auth && !wpa_s->p2p_fast_reconnect_fallback)
+		wpas_p2p_formation_timing_start(
+			wpa_s, (join || auto_join) ? "join" : "go-neg");
+
 	if (join || auto_join) {
 		u8 iface_addr[ETH_ALEN], dev_addr[ETH_ALEN];
 		if (auth) {
@@ -5812,6 +5946,7 @@ void wpas_p2p_wps_success(struct wpa_supplicant *wpa_s, const u8 *peer_addr,
 		 */
 		wpa_s->p2p_go_group_formation_completed = 0;
 	}
+	wpas_p2p_formation_timing(wpa_s, "wps-done");
 	if (wpa_s->global->p2p)
 		p2p_wps_success_cb(wpa_s->global->p2p, peer_addr);
 	wpas_group_formation_completed(wpa_s, 1);
@@ -6306,7 +6441,8 @@ void wpas_p2p_completed(struct wpa_supplicant *wpa_s)
 
 	if (persistent)
 		network_id = wpas_p2p_store_persistent_group(wpa_s->parent,
-							     ssid, go_dev_addr);
+							     ssid, go_dev_addr,
+							     freq);
 	if (network_id < 0)
 		network_id = ssid->id;
 	wpas_notify_p2p_group_started(wpa_s, ssid, network_id, 1);
@@ -6881,6 +7017,9 @@ int wpas_p2p_cancel(struct wpa_supplicant *wpa_s)
 		return -1;
 
 	wpa_printf(MSG_DEBUG, "P2P: Request to cancel group formation");
+	wpa_s->p2p_fast_reconnect = 0;
+	os_memset(&global->p2p_formation_start, 0,
+		  sizeof(global->p2p_formation_start));
 
 	if (wpa_s->pending_interface_name[0] &&
 	    !is_zero_ether_addr(wpa_s->pending_interface_addr))
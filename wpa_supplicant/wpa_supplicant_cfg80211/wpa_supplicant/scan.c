@@ -596,10 +596,191 @@ static void wpa_set_scan_ssids(struct wpa_supplicant *wpa_s,
 }
 
 
+/* Time in seconds over which the traffic level is measured */
+#define SCAN_TRAFFIC_SAMPLE_TIME 1
+/* Traffic samples older than this (in seconds) are not used */
+#define SCAN_TRAFFIC_SAMPLE_MAX_AGE 10
+/* Time in seconds by which a scan is postponed due to traffic */
+#define SCAN_DEFER_INTERVAL 5
+
+static int wpas_scan_defer_traffic(struct wpa_supplicant *wpa_s)
+{
+	struct hostap_sta_driver_data sta;
+	struct os_reltime now, age;
+	unsigned long pkts, rate, ms;
+
+	if (wpa_s->conf->scan_defer_traffic <= 0 ||
+	    wpa_s->wpa_state != WPA_COMPLETED ||
+	    wpa_s->scan_req == MANUAL_SCAN_REQ || wpa_s->reattach) {
+		os_memset(&wpa_s->scan_defer_start, 0,
+			  sizeof(wpa_s->scan_defer_start));
+		return 0;
+	}
+
+	os_memset(&sta, 0, sizeof(sta));
+	if (wpa_drv_pktcnt_poll(wpa_s, &sta) < 0)
+		return 0;
+	pkts = sta.rx_packets + sta.tx_packets;
+	os_get_reltime(&now);
+
+	if (!os_reltime_initialized(&wpa_s->traffic_sample_time) ||
+	    os_reltime_expired(&now, &wpa_s->traffic_sample_time,
+			       SCAN_TRAFFIC_SAMPLE_MAX_AGE)) {
+		/* Measure the traffic before deciding */
+		wpa_s->traffic_sample_time = now;
+		wpa_s->traffic_sample_pkts = pkts;
+		wpa_supplicant_req_scan(wpa_s, SCAN_TRAFFIC_SAMPLE_TIME, 0);
+		return 1;
+	}
+
+	os_reltime_sub(&now, &wpa_s->traffic_sample_time, &age);
+	ms = age.sec * 1000 + age.usec / 1000;
+	if (ms == 0)
+		ms = 1;
+	rate = (pkts - wpa_s->traffic_sample_pkts) * 1000 / ms;
+	wpa_s->traffic_sample_time = now;
+	wpa_s->traffic_sample_pkts = pkts;
+
+	if (rate < (unsigned long) wpa_s->conf->scan_defer_traffic) {
+		os_memset(&wpa_s->scan_defer_start, 0,
+			  sizeof(wpa_s->scan_defer_start));
+		return 0;
+	}
+
+	if (!os_reltime_initialized(&wpa_s->scan_defer_start)) {
+		wpa_s->scan_defer_start = now;
+	} else if (os_reltime_expired(&now, &wpa_s->scan_defer_start,
+				      wpa_s->conf->scan_defer_max)) {
+		wpa_dbg(wpa_s, MSG_DEBUG, "Scan despite %lu packets/s traffic since it has been postponed for %d seconds",
+			rate, wpa_s->conf->scan_defer_max);
+		os_memset(&wpa_s->scan_defer_start, 0,
+			  sizeof(wpa_s->scan_defer_start));
+		return 0;
+	}
+
+	wpa_s->scan_deferrals++;
+	wpa_dbg(wpa_s, MSG_DEBUG, "Postpone scan - %lu packets/s traffic",
+		rate);
+	wpa_supplicant_req_scan(wpa_s, SCAN_DEFER_INTERVAL, 0);
+	return 1;
+}
+
+
+static int wpas_scan_split_mode_ok(struct wpa_supplicant *wpa_s,
+				   struct hostapd_hw_modes *mode)
+{
+	if (wpa_s->setband == WPA_SETBAND_5G)
+		return mode->mode == HOSTAPD_MODE_IEEE80211A;
+	if (wpa_s->setband == WPA_SETBAND_2G)
+		return mode->mode == HOSTAPD_MODE_IEEE80211G;
+	return 1;
+}
+
+
+static int wpas_scan_split_freq_ok(struct wpa_supplicant *wpa_s, int freq)
+{
+	struct hostapd_hw_modes *mode;
+	u16 m;
+	int i;
+
+	for (m = 0; m < wpa_s->hw.num_modes; m++) {
+		mode = &wpa_s->hw.modes[m];
+		if (!wpas_scan_split_mode_ok(wpa_s, mode))
+			continue;
+		for (i = 0; i < mode->num_channels; i++) {
+			if (mode->channels[i].freq == freq &&
+			    !(mode->channels[i].flag & HOSTAPD_CHAN_DISABLED))
+				return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+static int * wpas_scan_split_channels(struct wpa_supplicant *wpa_s)
+{
+	struct hostapd_hw_modes *mode;
+	struct wpa_bss *bss;
+	int *freqs = NULL;
+	u16 m;
+	int i;
+
+	/* Channels on which BSSes were seen earlier go first */
+	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
+		if (wpas_scan_split_freq_ok(wpa_s, bss->freq))
+			int_array_add_unique(&freqs, bss->freq);
+	}
+
+	for (m = 0; m < wpa_s->hw.num_modes; m++) {
+		mode = &wpa_s->hw.modes[m];
+		if (!wpas_scan_split_mode_ok(wpa_s, mode))
+			continue;
+		for (i = 0; i < mode->num_channels; i++) {
+			if (mode->channels[i].flag & HOSTAPD_CHAN_DISABLED)
+				continue;
+			int_array_add_unique(&freqs, mode->channels[i].freq);
+		}
+	}
+
+	return freqs;
+}
+
+
+/*
+ * Limit a full scan to the next burst of channels while associated. The rest
+ * of the channels are left in wpa_s->scan_split_freqs for the following
+ * bursts.
+ */
+static void wpas_scan_split(struct wpa_supplicant *wpa_s,
+			    struct wpa_driver_scan_params *params)
+{
+	int n, len;
+
+	if (wpa_s->conf->scan_split_chan <= 0 || wpa_s->hw.modes == NULL ||
+	    wpa_s->wpa_state != WPA_COMPLETED ||
+	    wpa_s->last_scan_req == MANUAL_SCAN_REQ) {
+		os_free(wpa_s->scan_split_freqs);
+		wpa_s->scan_split_freqs = NULL;
+		return;
+	}
+
+	if (params->freqs)
+		return; /* already using a limited channel set */
+
+	if (wpa_s->scan_split_freqs == NULL) {
+		wpa_s->scan_split_freqs = wpas_scan_split_channels(wpa_s);
+		if (wpa_s->scan_split_freqs == NULL)
+			return;
+	}
+
+	len = int_array_len(wpa_s->scan_split_freqs);
+	n = wpa_s->conf->scan_split_chan;
+	if (n >= len) {
+		params->freqs = wpa_s->scan_split_freqs;
+		wpa_s->scan_split_freqs = NULL;
+	} else {
+		params->freqs = os_calloc(n + 1, sizeof(int));
+		if (params->freqs == NULL)
+			return;
+		os_memcpy(params->freqs, wpa_s->scan_split_freqs,
+			  n * sizeof(int));
+		os_memmove(wpa_s->scan_split_freqs,
+			   wpa_s->scan_split_freqs + n,
+			   (len - n + 1) * sizeof(int));
+	}
+	wpa_s->scan_split_bursts++;
+	wpa_dbg(wpa_s, MSG_DEBUG, "Scan burst of %d channels (%d left)",
+		int_array_len(params->freqs),
+		wpa_s->scan_split_freqs ?
+		int_array_len(wpa_s->scan_split_freqs) : 0);
+}
+
+
 static void wpa_supplicant_scan(void *eloop_ctx, void *timeout_ctx)
 {
 	struct wpa_supplicant *wpa_s = eloop_ctx;
-	struct wpa_ssid *ssid;
+	struct wpa_ssid *ssid, *resume_ssid = NULL;
 	int ret;
 	struct wpabuf *extra_ie = NULL;
 	struct wpa_driver_scan_params params;
@@ -659,6 +840,9 @@ static void wpa_supplicant_scan(void *eloop_ctx, void *timeout_ctx)
 		return;
 	}
 
+	if (wpas_scan_defer_traffic(wpa_s))
+		return;
+
 	if (wpa_s->conf->ap_scan == 2)
 		max_ssids = 1;
 	else {
@@ -738,6 +922,15 @@ static void wpa_supplicant_scan(void *eloop_ctx, void *timeout_ctx)
 		}
 	}
 
+	if (wpa_s->resume.fast_scan &&
+	    wpa_s->last_scan_req != MANUAL_SCAN_REQ) {
+		wpa_s->resume.fast_scan = 0;
+		resume_ssid = wpa_config_get_network(wpa_s->conf,
+						     wpa_s->resume.network_id);
+		if (resume_ssid && wpas_network_disabled(wpa_s, resume_ssid))
+			resume_ssid = NULL;
+	}
+
 	if (wpa_s->last_scan_req != MANUAL_SCAN_REQ &&
 	    wpa_s->conf->ap_scan == 2) {
 		wpa_s->connect_without_scan = NULL;
@@ -750,6 +943,28 @@ static void wpa_supplicant_scan(void *eloop_ctx, void *timeout_ctx)
 		 * wildcard SSID.
 		 */
 		ssid = NULL;
+	} else if (resume_ssid) {
+		/*
+		 * Directed single-channel probe for the BSS that was used at
+		 * system suspend. If this does not result in a connection, the
+		 * following scans are full scans.
+		 */
+		ssid = resume_ssid;
+		wpa_dbg(wpa_s, MSG_DEBUG, "Resume: Probe for " MACSTR
+			" on %d MHz", MAC2STR(wpa_s->resume.bssid),
+			wpa_s->resume.freq);
+		params.ssids[0].ssid = ssid->ssid;
+		params.ssids[0].ssid_len = ssid->ssid_len;
+		params.num_ssids = 1;
+
+		params.freqs = os_malloc(sizeof(int) * 2);
+		if (params.freqs == NULL) {
+			wpa_dbg(wpa_s, MSG_ERROR, "Memory allocation failed");
+			return;
+		}
+		params.freqs[0] = wpa_s->resume.freq;
+		params.freqs[1] = 0;
+		wpa_s->resume.fast = 1;
 	} else if (wpa_s->reattach && wpa_s->current_ssid != NULL) {
 		/*
 		 * Perform single-channel single-SSID scan for
@@ -917,6 +1132,8 @@ ssid_list_set:
 		}
 	}
 
+	wpas_scan_split(wpa_s, &params);
+
 	params.filter_ssids = wpa_supplicant_build_filter_ssids(
 		wpa_s->conf, &params.num_filter_ssids);
 	if (extra_ie) {
@@ -988,9 +1205,19 @@ scan:
 			wpa_supplicant_set_state(wpa_s, prev_state);
 		/* Restore scan_req since we will try to scan again */
 		wpa_s->scan_req = wpa_s->last_scan_req;
+		/* Start over with a full channel list */
+		os_free(wpa_s->scan_split_freqs);
+		wpa_s->scan_split_freqs = NULL;
 		wpa_supplicant_req_scan(wpa_s, 1, 0);
 	} else {
 		wpa_s->scan_for_connection = 0;
+		if (wpa_s->resume.tracking && !resume_ssid)
+			wpa_s->resume.full_scans++;
+		if (wpa_s->scan_split_freqs) {
+			int ms = wpa_s->conf->scan_split_interval;
+			wpa_supplicant_req_scan(wpa_s, ms / 1000,
+						(ms % 1000) * 1000);
+		}
 	}
 }
 
@@ -1374,6 +1601,16 @@ void wpa_supplicant_notify_scanning(struct wpa_supplicant *wpa_s,
 				    int scanning)
 {
 	if (wpa_s->scanning != scanning) {
+		struct os_reltime now, diff;
+
+		os_get_reltime(&now);
+		if (scanning) {
+			wpa_s->scan_busy_start = now;
+		} else if (os_reltime_initialized(&wpa_s->scan_busy_start)) {
+			os_reltime_sub(&now, &wpa_s->scan_busy_start, &diff);
+			wpa_s->scan_busy_ms += diff.sec * 1000 +
+				diff.usec / 1000;
+		}
 		wpa_s->scanning = scanning;
 		wpas_notify_scanning(wpa_s);
 	}
@@ -1548,24 +1785,36 @@ struct wpabuf * wpa_scan_get_vendor_ie_multi(const struct wpa_scan_res *res,
  */
 #define GREAT_SNR 30
 
+/*
+ * Scan result with the properties the compare functions need. These are parsed
+ * from the IEs once per result instead of once per comparison.
+ */
+struct wpa_scan_res_sort {
+	struct wpa_scan_res *res;
+	int wpa;
+	int maxrate;
+#ifdef CONFIG_WPS
+	int uses_wps;
+	struct wpabuf *wps;
+#endif /* CONFIG_WPS */
+};
+
 /* Compare function for sorting scan results. Return >0 if @b is considered
  * better. */
 static int wpa_scan_result_compar(const void *a, const void *b)
 {
 #define IS_5GHZ(n) (n > 4000)
 #define MIN(a,b) a < b ? a : b
-	struct wpa_scan_res **_wa = (void *) a;
-	struct wpa_scan_res **_wb = (void *) b;
-	struct wpa_scan_res *wa = *_wa;
-	struct wpa_scan_res *wb = *_wb;
+	const struct wpa_scan_res_sort *sa = a;
+	const struct wpa_scan_res_sort *sb = b;
+	struct wpa_scan_res *wa = sa->res;
+	struct wpa_scan_res *wb = sb->res;
 	int wpa_a, wpa_b, maxrate_a, maxrate_b;
 	int snr_a, snr_b;
 
 	/* WPA/WPA2 support preferred */
-	wpa_a = wpa_scan_get_vendor_ie(wa, WPA_IE_VENDOR_TYPE) != NULL ||
-		wpa_scan_get_ie(wa, WLAN_EID_RSN) != NULL;
-	wpa_b = wpa_scan_get_vendor_ie(wb, WPA_IE_VENDOR_TYPE) != NULL ||
-		wpa_scan_get_ie(wb, WLAN_EID_RSN) != NULL;
+	wpa_a = sa->wpa;
+	wpa_b = sb->wpa;
 
 	if (wpa_b && !wpa_a)
 		return 1;
@@ -1593,8 +1842,8 @@ static int wpa_scan_result_compar(const void *a, const void *b)
 	/* best/max rate preferred if SNR close enough */
         if ((snr_a && snr_b && abs(snr_b - snr_a) < 5) ||
 	    (wa->qual && wb->qual && abs(wb->qual - wa->qual) < 10)) {
-		maxrate_a = wpa_scan_get_max_rate(wa);
-		maxrate_b = wpa_scan_get_max_rate(wb);
+		maxrate_a = sa->maxrate;
+		maxrate_b = sb->maxrate;
 		if (maxrate_a != maxrate_b)
 			return maxrate_b - maxrate_a;
 		if (IS_5GHZ(wa->freq) ^ IS_5GHZ(wb->freq))
@@ -1619,29 +1868,19 @@ static int wpa_scan_result_compar(const void *a, const void *b)
  * provisioning. Return >0 if @b is considered better. */
 static int wpa_scan_result_wps_compar(const void *a, const void *b)
 {
-	struct wpa_scan_res **_wa = (void *) a;
-	struct wpa_scan_res **_wb = (void *) b;
-	struct wpa_scan_res *wa = *_wa;
-	struct wpa_scan_res *wb = *_wb;
-	int uses_wps_a, uses_wps_b;
-	struct wpabuf *wps_a, *wps_b;
+	const struct wpa_scan_res_sort *sa = a;
+	const struct wpa_scan_res_sort *sb = b;
+	struct wpa_scan_res *wa = sa->res;
+	struct wpa_scan_res *wb = sb->res;
 	int res;
 
-	/* Optimization - check WPS IE existence before allocated memory and
-	 * doing full reassembly. */
-	uses_wps_a = wpa_scan_get_vendor_ie(wa, WPS_IE_VENDOR_TYPE) != NULL;
-	uses_wps_b = wpa_scan_get_vendor_ie(wb, WPS_IE_VENDOR_TYPE) != NULL;
-	if (uses_wps_a && !uses_wps_b)
+	if (sa->uses_wps && !sb->uses_wps)
 		return -1;
-	if (!uses_wps_a && uses_wps_b)
+	if (!sa->uses_wps && sb->uses_wps)
 		return 1;
 
-	if (uses_wps_a && uses_wps_b) {
-		wps_a = wpa_scan_get_vendor_ie_multi(wa, WPS_IE_VENDOR_TYPE);
-		wps_b = wpa_scan_get_vendor_ie_multi(wb, WPS_IE_VENDOR_TYPE);
-		res = wps_ap_priority_compar(wps_a, wps_b);
-		wpabuf_free(wps_a);
-		wpabuf_free(wps_b);
+	if (sa->uses_wps && sb->uses_wps) {
+		res = wps_ap_priority_compar(sa->wps, sb->wps);
 		if (res)
 			return res;
 	}
@@ -1662,6 +1901,51 @@ static int wpa_scan_result_wps_compar(const void *a, const void *b)
 #endif /* CONFIG_WPS */
 
 
+static void sort_scan_res(struct wpa_scan_results *scan_res,
+			  int (*compar)(const void *, const void *))
+{
+	struct wpa_scan_res_sort *sort;
+	size_t i;
+
+	if (scan_res->num < 2)
+		return;
+
+	sort = os_calloc(scan_res->num, sizeof(*sort));
+	if (sort == NULL) {
+		wpa_printf(MSG_DEBUG, "Could not sort scan results");
+		return;
+	}
+
+	for (i = 0; i < scan_res->num; i++) {
+		struct wpa_scan_res *r = scan_res->res[i];
+
+		sort[i].res = r;
+		sort[i].wpa = wpa_scan_get_vendor_ie(r, WPA_IE_VENDOR_TYPE) !=
+			NULL || wpa_scan_get_ie(r, WLAN_EID_RSN) != NULL;
+		sort[i].maxrate = wpa_scan_get_max_rate(r);
+#ifdef CONFIG_WPS
+		/* Check WPS IE existence before allocating memory and doing
+		 * full reassembly. */
+		sort[i].uses_wps = wpa_scan_get_vendor_ie(r, WPS_IE_VENDOR_TYPE)
+			!= NULL;
+		if (sort[i].uses_wps && compar == wpa_scan_result_wps_compar)
+			sort[i].wps = wpa_scan_get_vendor_ie_multi(
+				r, WPS_IE_VENDOR_TYPE);
+#endif /* CONFIG_WPS */
+	}
+
+	qsort(sort, scan_res->num, sizeof(*sort), compar);
+
+	for (i = 0; i < scan_res->num; i++) {
+		scan_res->res[i] = sort[i].res;
+#ifdef CONFIG_WPS
+		wpabuf_free(sort[i].wps);
+#endif /* CONFIG_WPS */
+	}
+	os_free(sort);
+}
+
+
 static void dump_scan_res(struct wpa_scan_results *scan_res)
 {
 #ifndef CONFIG_NO_STDOUT_DEBUG
@@ -1797,8 +2081,7 @@ wpa_supplicant_get_scan_results(struct wpa_supplicant *wpa_s,
 	}
 #endif /* CONFIG_WPS */
 
-	qsort(scan_res->res, scan_res->num, sizeof(struct wpa_scan_res *),
-	      compar);
+	sort_scan_res(scan_res, compar);
 	dump_scan_res(scan_res);
 
 	wpa_bss_update_start(wpa_s);
@@ -625,7 +625,8 @@ static char ** wpa_cli_complete_set(const char *str, int pos)
 		"p2p_no_go_freq",
 		"p2p_go_ht40", "p2p_disabled", "p2p_no_group_iface",
 		"p2p_go_vht",
-		"p2p_ignore_shared_freq", "country", "bss_max_count",
+		"p2p_ignore_shared_freq", "p2p_fast_reconnect",
+		"country", "bss_max_count",
 		"bss_expiration_age", "bss_expiration_scan_count",
 		"filter_ssids", "filter_rssi", "max_num_sta",
 		"disassoc_low_ack", "hs20", "interworking", "hessid",
@@ -2510,6 +2511,27 @@ static int wpa_cli_cmd_pktcnt_poll(struct wpa_ctrl *ctrl, int argc,
 }
 
 
+static int wpa_cli_cmd_scan_stats(struct wpa_ctrl *ctrl, int argc,
+				  char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "SCAN_STATS");
+}
+
+
+static int wpa_cli_cmd_bgscan_status(struct wpa_ctrl *ctrl, int argc,
+				     char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "BGSCAN_STATUS");
+}
+
+
+static int wpa_cli_cmd_bgscan_trigger(struct wpa_ctrl *ctrl, int argc,
+				      char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "BGSCAN_TRIGGER");
+}
+
+
 static int wpa_cli_cmd_reauthenticate(struct wpa_ctrl *ctrl, int argc,
 				      char *argv[])
 {
@@ -3094,6 +3116,15 @@ static struct wpa_cli_cmd wpa_cli_commands[] = {
 	{ "pktcnt_poll", wpa_cli_cmd_pktcnt_poll, NULL,
 	  cli_cmd_flag_none,
 	  "= get TX/RX packet counters" },
+	{ "scan_stats", wpa_cli_cmd_scan_stats, NULL,
+	  cli_cmd_flag_none,
+	  "= get scan duty cycle and postponed scan count" },
+	{ "bgscan_status", wpa_cli_cmd_bgscan_status, NULL,
+	  cli_cmd_flag_none,
+	  "= get bgscan module state and statistics" },
+	{ "bgscan_trigger", wpa_cli_cmd_bgscan_trigger, NULL,
+	  cli_cmd_flag_none,
+	  "= request a background scan from the bgscan module" },
 	{ "reauthenticate", wpa_cli_cmd_reauthenticate, NULL,
 	  cli_cmd_flag_none,
 	  "= trigger IEEE 802.1X/EAPOL reauthentication" },
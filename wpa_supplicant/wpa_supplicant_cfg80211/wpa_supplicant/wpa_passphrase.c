@@ -10,6 +10,7 @@
 
 #include "common.h"
 #include "crypto/sha1.h"
+#include "crypto/pbkdf2_cache.h"
 
 
 int main(int argc, char *argv[])
@@ -52,7 +53,8 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 
-	pbkdf2_sha1(passphrase, (u8 *) ssid, os_strlen(ssid), 4096, psk, 32);
+	pbkdf2_sha1_cached(passphrase, (u8 *) ssid, os_strlen(ssid), 4096,
+			   psk, 32);
 
 	printf("network={\n");
 	printf("\tssid=\"%s\"\n", ssid);
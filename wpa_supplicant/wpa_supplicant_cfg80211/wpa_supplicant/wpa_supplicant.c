@@ -15,6 +15,7 @@
 #include "common.h"
 #include "crypto/random.h"
 #include "crypto/sha1.h"
+#include "crypto/pbkdf2_cache.h"
 #include "eapol_supp/eapol_supp_sm.h"
 #include "eap_peer/eap.h"
 #include "eap_peer/eap_proxy.h"
@@ -378,6 +379,20 @@ void free_hw_features(struct wpa_supplicant *wpa_s)
 }
 
 
+/* Time in seconds after resume to wait for the reconnection to complete */
+#define WPAS_RESUME_TIMEOUT 60
+
+static void wpas_resume_timeout(void *eloop_ctx, void *timeout_ctx)
+{
+	struct wpa_supplicant *wpa_s = eloop_ctx;
+
+	wpa_dbg(wpa_s, MSG_DEBUG, "Resume: No reconnection within %d seconds",
+		WPAS_RESUME_TIMEOUT);
+	wpa_s->resume.tracking = 0;
+	wpa_s->resume.fast_scan = 0;
+}
+
+
 static void wpa_supplicant_cleanup(struct wpa_supplicant *wpa_s)
 {
 	int i;
@@ -460,6 +475,11 @@ static void wpa_supplicant_cleanup(struct wpa_supplicant *wpa_s)
 	os_free(wpa_s->next_scan_freqs);
 	wpa_s->next_scan_freqs = NULL;
 
+	os_free(wpa_s->scan_split_freqs);
+	wpa_s->scan_split_freqs = NULL;
+
+	eloop_cancel_timeout(wpas_resume_timeout, wpa_s, NULL);
+
 	os_free(wpa_s->manual_scan_freqs);
 	wpa_s->manual_scan_freqs = NULL;
 
@@ -661,6 +681,110 @@ void wpa_supplicant_reinit_autoscan(struct wpa_supplicant *wpa_s)
 }
 
 
+/**
+ * wpas_resume_save - Remember the current BSS at system suspend
+ * @wpa_s: Pointer to wpa_supplicant data
+ */
+void wpas_resume_save(struct wpa_supplicant *wpa_s)
+{
+	eloop_cancel_timeout(wpas_resume_timeout, wpa_s, NULL);
+	os_memset(&wpa_s->resume, 0, sizeof(wpa_s->resume));
+
+	if (wpa_s->wpa_state != WPA_COMPLETED || wpa_s->current_ssid == NULL ||
+	    wpa_s->assoc_freq <= 0)
+		return;
+
+	os_memcpy(wpa_s->resume.bssid, wpa_s->bssid, ETH_ALEN);
+	wpa_s->resume.freq = wpa_s->assoc_freq;
+	wpa_s->resume.network_id = wpa_s->current_ssid->id;
+	wpa_s->resume.saved = 1;
+	wpa_dbg(wpa_s, MSG_DEBUG, "Resume: Remember " MACSTR
+		" on %d MHz (id=%d) for reconnection",
+		MAC2STR(wpa_s->resume.bssid), wpa_s->resume.freq,
+		wpa_s->resume.network_id);
+}
+
+
+/**
+ * wpas_resume_start - Start reconnection after system resume
+ * @wpa_s: Pointer to wpa_supplicant data
+ *
+ * With fast_resume enabled, the next scan is a directed probe on the channel
+ * of the BSS remembered by wpas_resume_save(). The phases of the reconnection
+ * are timed until the connection is completed.
+ */
+void wpas_resume_start(struct wpa_supplicant *wpa_s)
+{
+	os_memset(&wpa_s->resume.scan, 0, sizeof(wpa_s->resume.scan));
+	os_memset(&wpa_s->resume.assoc, 0, sizeof(wpa_s->resume.assoc));
+	os_memset(&wpa_s->resume.associated, 0,
+		  sizeof(wpa_s->resume.associated));
+	os_get_reltime(&wpa_s->resume.start);
+	wpa_s->resume.full_scans = 0;
+	wpa_s->resume.fast = 0;
+	wpa_s->resume.fast_scan = wpa_s->conf->fast_resume &&
+		wpa_s->resume.saved;
+	wpa_s->resume.tracking = 1;
+
+	eloop_cancel_timeout(wpas_resume_timeout, wpa_s, NULL);
+	eloop_register_timeout(WPAS_RESUME_TIMEOUT, 0, wpas_resume_timeout,
+			       wpa_s, NULL);
+}
+
+
+static unsigned int wpas_resume_ms(struct os_reltime *from,
+				   struct os_reltime *to)
+{
+	struct os_reltime diff;
+
+	if (!os_reltime_initialized(from) || !os_reltime_initialized(to))
+		return 0;
+	os_reltime_sub(to, from, &diff);
+	return diff.sec * 1000 + diff.usec / 1000;
+}
+
+
+static void wpas_resume_state_changed(struct wpa_supplicant *wpa_s)
+{
+	struct os_reltime now;
+
+	os_get_reltime(&now);
+	switch (wpa_s->wpa_state) {
+	case WPA_SCANNING:
+		if (!os_reltime_initialized(&wpa_s->resume.scan))
+			wpa_s->resume.scan = now;
+		break;
+	case WPA_AUTHENTICATING:
+	case WPA_ASSOCIATING:
+		if (!os_reltime_initialized(&wpa_s->resume.assoc))
+			wpa_s->resume.assoc = now;
+		break;
+	case WPA_ASSOCIATED:
+		if (!os_reltime_initialized(&wpa_s->resume.associated))
+			wpa_s->resume.associated = now;
+		break;
+	case WPA_COMPLETED:
+		wpa_msg(wpa_s, MSG_INFO, WPA_EVENT_RESUME_CONNECTED
+			"fast=%d full_scans=%u scan=%u assoc=%u handshake=%u "
+			"total=%u",
+			wpa_s->resume.fast && !wpa_s->resume.full_scans,
+			wpa_s->resume.full_scans,
+			wpas_resume_ms(&wpa_s->resume.scan,
+				       &wpa_s->resume.assoc),
+			wpas_resume_ms(&wpa_s->resume.assoc,
+				       &wpa_s->resume.associated),
+			wpas_resume_ms(&wpa_s->resume.associated, &now),
+			wpas_resume_ms(&wpa_s->resume.start, &now));
+		wpa_s->resume.tracking = 0;
+		wpa_s->resume.fast_scan = 0;
+		eloop_cancel_timeout(wpas_resume_timeout, wpa_s, NULL);
+		break;
+	default:
+		break;
+	}
+}
+
+
 /**
  * wpa_supplicant_set_state - Set current connection state
  * @wpa_s: Pointer to wpa_supplicant data
@@ -740,6 +864,9 @@ void wpa_supplicant_set_state(struct wpa_supplicant *wpa_s,
 	if (wpa_s->wpa_state != old_state) {
 		wpas_notify_state_changed(wpa_s, wpa_s->wpa_state, old_state);
 
+		if (wpa_s->resume.tracking)
+			wpas_resume_state_changed(wpa_s);
+
 		/*
 		 * Notify the P2P Device interface about a state change in one
 		 * of the interfaces.
@@ -1239,8 +1366,8 @@ int wpa_supplicant_set_suites(struct wpa_supplicant *wpa_s,
 		if (bss && ssid->bssid_set && ssid->ssid_len == 0 &&
 		    ssid->passphrase) {
 			u8 psk[PMK_LEN];
-		        pbkdf2_sha1(ssid->passphrase, bss->ssid, bss->ssid_len,
-				    4096, psk, PMK_LEN);
+		        pbkdf2_sha1_cached(ssid->passphrase, bss->ssid,
+					   bss->ssid_len, 4096, psk, PMK_LEN);
 		        wpa_hexdump_key(MSG_MSGDUMP, "PSK (from passphrase)",
 					psk, PMK_LEN);
 			wpa_sm_set_pmk(wpa_s->wpa, psk, PMK_LEN);
@@ -1273,8 +1400,9 @@ int wpa_supplicant_set_suites(struct wpa_supplicant *wpa_s,
 #ifndef CONFIG_NO_PBKDF2
 			if (wpabuf_len(pw) >= 8 && wpabuf_len(pw) < 64 && bss)
 			{
-				pbkdf2_sha1(pw_str, bss->ssid, bss->ssid_len,
-					    4096, psk, PMK_LEN);
+				pbkdf2_sha1_cached(pw_str, bss->ssid,
+						   bss->ssid_len, 4096, psk,
+						   PMK_LEN);
 				os_memset(pw_str, 0, sizeof(pw_str));
 				wpa_hexdump_key(MSG_MSGDUMP, "PSK (from "
 						"external passphrase)",
@@ -3890,6 +4018,7 @@ static int wpa_supplicant_init_iface(struct wpa_supplicant *wpa_s,
 
 	if (wpa_bss_init(wpa_s) < 0)
 		return -1;
+	os_get_reltime(&wpa_s->scan_stats_start);
 
 	/*
 	 * Set Wake-on-WLAN triggers, if configured.
@@ -4322,6 +4451,9 @@ void wpa_supplicant_deinit(struct wpa_global *global)
 	}
 	os_free(global->drv_priv);
 
+#ifndef CONFIG_NO_PBKDF2
+	pbkdf2_sha1_cache_flush();
+#endif /* CONFIG_NO_PBKDF2 */
 	random_deinit();
 
 	eloop_destroy();
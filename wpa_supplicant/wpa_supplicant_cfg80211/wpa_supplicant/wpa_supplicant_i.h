@@ -267,6 +267,9 @@ struct wpa_global {
 	struct wpa_supplicant *p2p_invite_group;
 	u8 p2p_dev_addr[ETH_ALEN];
 	struct os_reltime p2p_go_wait_client;
+	/* Start of the current group formation for P2P-FORMATION-TIMING */
+	struct os_reltime p2p_formation_start;
+	const char *p2p_formation_path;
 	struct dl_list p2p_srv_bonjour; /* struct p2p_srv_bonjour */
 	struct dl_list p2p_srv_upnp; /* struct p2p_srv_upnp */
 	int p2p_disabled;
@@ -477,9 +480,16 @@ struct wpa_supplicant {
 				 struct wpa_scan_results *scan_res);
 	struct dl_list bss; /* struct wpa_bss::list */
 	struct dl_list bss_id; /* struct wpa_bss::list_id */
+#define WPA_BSS_HASH_SIZE 64
+#define WPA_BSS_HASH(bssid) ((bssid)[5] & (WPA_BSS_HASH_SIZE - 1))
+	/* struct wpa_bss::list_hash, bucketed by BSSID */
+	struct dl_list bss_hash[WPA_BSS_HASH_SIZE];
 	size_t num_bss;
 	unsigned int bss_update_idx;
 	unsigned int bss_next_id;
+	/* IE buffers copied/left untouched in the current BSS table update */
+	unsigned int bss_ie_copies;
+	unsigned int bss_ie_copies_skipped;
 
 	 /*
 	  * Pointers to BSS entries in the order they were in the last scan
@@ -577,6 +587,28 @@ struct wpa_supplicant {
 	int normal_scans; /* normal scans run before sched_scan */
 	int scan_for_connection; /* whether the scan request was triggered for
 				  * finding a connection */
+	int *scan_split_freqs; /* channels left in a split full scan */
+	unsigned int scan_split_bursts;
+	unsigned int scan_deferrals;
+	struct os_reltime scan_defer_start; /* first postponement of the scan */
+	struct os_reltime traffic_sample_time;
+	unsigned long traffic_sample_pkts;
+	struct os_reltime scan_busy_start; /* when the radio started scanning */
+	unsigned int scan_busy_ms; /* total time spent scanning */
+	struct os_reltime scan_stats_start;
+
+	/* Reconnection after system resume */
+	struct {
+		unsigned int saved:1; /* BSS used at suspend is known */
+		unsigned int fast_scan:1; /* directed probe still to be sent */
+		unsigned int fast:1; /* directed probe was sent */
+		unsigned int tracking:1; /* phases are being timed */
+		u8 bssid[ETH_ALEN];
+		int freq;
+		int network_id;
+		unsigned int full_scans;
+		struct os_reltime start, scan, assoc, associated;
+	} resume;
 #define MAX_SCAN_ID 16
 	int scan_id[MAX_SCAN_ID];
 	unsigned int scan_id_count;
@@ -763,6 +795,8 @@ struct wpa_supplicant {
 	unsigned int p2p_go_vht:1;
 	unsigned int user_initiated_pd:1;
 	unsigned int p2p_go_group_formation_completed:1;
+	unsigned int p2p_fast_reconnect:1; /* invitation from P2P_CONNECT */
+	unsigned int p2p_fast_reconnect_fallback:1;
 	unsigned int waiting_presence_resp;
 	int p2p_first_connection_timeout;
 	unsigned int p2p_nfc_tag_enabled:1;
@@ -909,6 +943,8 @@ void wpa_clear_keys(struct wpa_supplicant *wpa_s, const u8 *addr);
 void wpa_supplicant_req_auth_timeout(struct wpa_supplicant *wpa_s,
 				     int sec, int usec);
 void wpa_supplicant_reinit_autoscan(struct wpa_supplicant *wpa_s);
+void wpas_resume_save(struct wpa_supplicant *wpa_s);
+void wpas_resume_start(struct wpa_supplicant *wpa_s);
 void wpa_supplicant_set_state(struct wpa_supplicant *wpa_s,
 			      enum wpa_states state);
 struct wpa_ssid * wpa_supplicant_get_ssid(struct wpa_supplicant *wpa_s);
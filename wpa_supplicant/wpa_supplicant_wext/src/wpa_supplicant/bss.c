@@ -45,6 +45,7 @@ static void wpa_bss_remove(struct wpa_supplicant *wpa_s, struct wpa_bss *bss)
 {
 	dl_list_del(&bss->list);
 	dl_list_del(&bss->list_id);
+	dl_list_del(&bss->list_hash);
 	wpa_s->num_bss--;
 	wpa_dbg(wpa_s, MSG_DEBUG, "BSS: Remove id %u BSSID " MACSTR
 		" SSID '%s'", bss->id, MAC2STR(bss->bssid),
@@ -58,7 +59,8 @@ struct wpa_bss * wpa_bss_get(struct wpa_supplicant *wpa_s, const u8 *bssid,
 			     const u8 *ssid, size_t ssid_len)
 {
 	struct wpa_bss *bss;
-	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
+	dl_list_for_each(bss, &wpa_s->bss_hash[WPA_BSS_HASH(bssid)],
+			 struct wpa_bss, list_hash) {
 		if (os_memcmp(bss->bssid, bssid, ETH_ALEN) == 0 &&
 		    bss->ssid_len == ssid_len &&
 		    os_memcmp(bss->ssid, ssid, ssid_len) == 0)
@@ -115,6 +117,8 @@ static void wpa_bss_add(struct wpa_supplicant *wpa_s,
 
 	dl_list_add_tail(&wpa_s->bss, &bss->list);
 	dl_list_add_tail(&wpa_s->bss_id, &bss->list_id);
+	dl_list_add_tail(&wpa_s->bss_hash[WPA_BSS_HASH(bss->bssid)],
+			 &bss->list_hash);
 	wpa_s->num_bss++;
 	wpa_dbg(wpa_s, MSG_DEBUG, "BSS: Add new id %u BSSID " MACSTR
 		" SSID '%s'",
@@ -265,8 +269,9 @@ static void wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 	bss->scan_miss_count = 0;
 	bss->last_update_idx = wpa_s->bss_update_idx;
 	wpa_bss_copy_res(bss, res);
-	/* Move the entry to the end of the list */
+	/* Move the entry to the end of the list and of its hash bucket */
 	dl_list_del(&bss->list);
+	dl_list_del(&bss->list_hash);
 	if (bss->ie_len + bss->beacon_ie_len >=
 	    res->ie_len + res->beacon_ie_len) {
 		os_memcpy(bss + 1, res + 1, res->ie_len + res->beacon_ie_len);
@@ -288,6 +293,8 @@ static void wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 		dl_list_add(prev, &bss->list_id);
 	}
 	dl_list_add_tail(&wpa_s->bss, &bss->list);
+	dl_list_add_tail(&wpa_s->bss_hash[WPA_BSS_HASH(bss->bssid)],
+			 &bss->list_hash);
 
 	notify_bss_changes(wpa_s, changes, bss);
 }
@@ -445,8 +452,12 @@ static void wpa_bss_timeout(void *eloop_ctx, void *timeout_ctx)
 
 int wpa_bss_init(struct wpa_supplicant *wpa_s)
 {
+	unsigned int i;
+
 	dl_list_init(&wpa_s->bss);
 	dl_list_init(&wpa_s->bss_id);
+	for (i = 0; i < WPA_BSS_HASH_SIZE; i++)
+		dl_list_init(&wpa_s->bss_hash[i]);
 	eloop_register_timeout(WPA_BSS_EXPIRATION_PERIOD, 0,
 			       wpa_bss_timeout, wpa_s, NULL);
 	return 0;
@@ -479,7 +490,8 @@ struct wpa_bss * wpa_bss_get_bssid(struct wpa_supplicant *wpa_s,
 				   const u8 *bssid)
 {
 	struct wpa_bss *bss;
-	dl_list_for_each_reverse(bss, &wpa_s->bss, struct wpa_bss, list) {
+	dl_list_for_each_reverse(bss, &wpa_s->bss_hash[WPA_BSS_HASH(bssid)],
+				 struct wpa_bss, list_hash) {
 		if (os_memcmp(bss->bssid, bssid, ETH_ALEN) == 0)
 			return bss;
 	}
@@ -28,6 +28,7 @@ struct wpa_scan_res;
  * struct wpa_bss - BSS table
  * @list: List entry for struct wpa_supplicant::bss
  * @list_id: List entry for struct wpa_supplicant::bss_id
+ * @list_hash: List entry for struct wpa_supplicant::bss_hash
  * @id: Unique identifier for this BSS entry
  * @scan_miss_count: Number of counts without seeing this BSS
  * @flags: information flags about the BSS/IBSS (WPA_BSS_*)
@@ -50,6 +51,7 @@ struct wpa_scan_res;
 struct wpa_bss {
 	struct dl_list list;
 	struct dl_list list_id;
+	struct dl_list list_hash;
 	unsigned int id;
 	unsigned int scan_miss_count;
 	unsigned int last_update_idx;
@@ -649,21 +649,33 @@ struct wpabuf * wpa_scan_get_vendor_ie_multi_beacon(
 }
 
 
+/*
+ * Scan result with the properties the compare functions need. These are parsed
+ * from the IEs once per result instead of once per comparison.
+ */
+struct wpa_scan_res_sort {
+	struct wpa_scan_res *res;
+	int wpa;
+	int maxrate;
+#ifdef CONFIG_WPS
+	int uses_wps;
+	struct wpabuf *wps;
+#endif /* CONFIG_WPS */
+};
+
 /* Compare function for sorting scan results. Return >0 if @b is considered
  * better. */
 static int wpa_scan_result_compar(const void *a, const void *b)
 {
-	struct wpa_scan_res **_wa = (void *) a;
-	struct wpa_scan_res **_wb = (void *) b;
-	struct wpa_scan_res *wa = *_wa;
-	struct wpa_scan_res *wb = *_wb;
+	const struct wpa_scan_res_sort *sa = a;
+	const struct wpa_scan_res_sort *sb = b;
+	struct wpa_scan_res *wa = sa->res;
+	struct wpa_scan_res *wb = sb->res;
 	int wpa_a, wpa_b, maxrate_a, maxrate_b;
 
 	/* WPA/WPA2 support preferred */
-	wpa_a = wpa_scan_get_vendor_ie(wa, WPA_IE_VENDOR_TYPE) != NULL ||
-		wpa_scan_get_ie(wa, WLAN_EID_RSN) != NULL;
-	wpa_b = wpa_scan_get_vendor_ie(wb, WPA_IE_VENDOR_TYPE) != NULL ||
-		wpa_scan_get_ie(wb, WLAN_EID_RSN) != NULL;
+	wpa_a = sa->wpa;
+	wpa_b = sb->wpa;
 
 	if (wpa_b && !wpa_a)
 		return 1;
@@ -681,8 +693,8 @@ static int wpa_scan_result_compar(const void *a, const void *b)
 	/* best/max rate preferred if signal level close enough XXX */
 	if ((wa->level && wb->level && abs(wb->level - wa->level) < 5) ||
 	    (wa->qual && wb->qual && abs(wb->qual - wa->qual) < 10)) {
-		maxrate_a = wpa_scan_get_max_rate(wa);
-		maxrate_b = wpa_scan_get_max_rate(wb);
+		maxrate_a = sa->maxrate;
+		maxrate_b = sb->maxrate;
 		if (maxrate_a != maxrate_b)
 			return maxrate_b - maxrate_a;
 	}
@@ -703,29 +715,19 @@ static int wpa_scan_result_compar(const void *a, const void *b)
  * provisioning. Return >0 if @b is considered better. */
 static int wpa_scan_result_wps_compar(const void *a, const void *b)
 {
-	struct wpa_scan_res **_wa = (void *) a;
-	struct wpa_scan_res **_wb = (void *) b;
-	struct wpa_scan_res *wa = *_wa;
-	struct wpa_scan_res *wb = *_wb;
-	int uses_wps_a, uses_wps_b;
-	struct wpabuf *wps_a, *wps_b;
+	const struct wpa_scan_res_sort *sa = a;
+	const struct wpa_scan_res_sort *sb = b;
+	struct wpa_scan_res *wa = sa->res;
+	struct wpa_scan_res *wb = sb->res;
 	int res;
 
-	/* Optimization - check WPS IE existence before allocated memory and
-	 * doing full reassembly. */
-	uses_wps_a = wpa_scan_get_vendor_ie(wa, WPS_IE_VENDOR_TYPE) != NULL;
-	uses_wps_b = wpa_scan_get_vendor_ie(wb, WPS_IE_VENDOR_TYPE) != NULL;
-	if (uses_wps_a && !uses_wps_b)
+	if (sa->uses_wps && !sb->uses_wps)
 		return -1;
-	if (!uses_wps_a && uses_wps_b)
+	if (!sa->uses_wps && sb->uses_wps)
 		return 1;
 
-	if (uses_wps_a && uses_wps_b) {
-		wps_a = wpa_scan_get_vendor_ie_multi(wa, WPS_IE_VENDOR_TYPE);
-		wps_b = wpa_scan_get_vendor_ie_multi(wb, WPS_IE_VENDOR_TYPE);
-		res = wps_ap_priority_compar(wps_a, wps_b);
-		wpabuf_free(wps_a);
-		wpabuf_free(wps_b);
+	if (sa->uses_wps && sb->uses_wps) {
+		res = wps_ap_priority_compar(sa->wps, sb->wps);
 		if (res)
 			return res;
 	}
@@ -746,6 +748,51 @@ static int wpa_scan_result_wps_compar(const void *a, const void *b)
 #endif /* CONFIG_WPS */
 
 
+static void sort_scan_res(struct wpa_scan_results *scan_res,
+			  int (*compar)(const void *, const void *))
+{
+	struct wpa_scan_res_sort *sort;
+	size_t i;
+
+	if (scan_res->num < 2)
+		return;
+
+	sort = os_zalloc(scan_res->num * sizeof(*sort));
+	if (sort == NULL) {
+		wpa_printf(MSG_DEBUG, "Could not sort scan results");
+		return;
+	}
+
+	for (i = 0; i < scan_res->num; i++) {
+		struct wpa_scan_res *r = scan_res->res[i];
+
+		sort[i].res = r;
+		sort[i].wpa = wpa_scan_get_vendor_ie(r, WPA_IE_VENDOR_TYPE) !=
+			NULL || wpa_scan_get_ie(r, WLAN_EID_RSN) != NULL;
+		sort[i].maxrate = wpa_scan_get_max_rate(r);
+#ifdef CONFIG_WPS
+		/* Check WPS IE existence before allocating memory and doing
+		 * full reassembly. */
+		sort[i].uses_wps = wpa_scan_get_vendor_ie(r, WPS_IE_VENDOR_TYPE)
+			!= NULL;
+		if (sort[i].uses_wps && compar == wpa_scan_result_wps_compar)
+			sort[i].wps = wpa_scan_get_vendor_ie_multi(
+				r, WPS_IE_VENDOR_TYPE);
+#endif /* CONFIG_WPS */
+	}
+
+	qsort(sort, scan_res->num, sizeof(*sort), compar);
+
+	for (i = 0; i < scan_res->num; i++) {
+		scan_res->res[i] = sort[i].res;
+#ifdef CONFIG_WPS
+		wpabuf_free(sort[i].wps);
+#endif /* CONFIG_WPS */
+	}
+	os_free(sort);
+}
+
+
 /**
  * wpa_supplicant_get_scan_results - Get scan results
  * @wpa_s: Pointer to wpa_supplicant data
@@ -782,8 +829,7 @@ wpa_supplicant_get_scan_results(struct wpa_supplicant *wpa_s,
 	}
 #endif /* CONFIG_WPS */
 
-	qsort(scan_res->res, scan_res->num, sizeof(struct wpa_scan_res *),
-	      compar);
+	sort_scan_res(scan_res, compar);
 
 	wpa_bss_update_start(wpa_s);
 	for (i = 0; i < scan_res->num; i++)